@@ -116,6 +116,12 @@ uint32 *ROM = NULL;
 /* Main memory. */
 uint32 *RAM = NULL;
 
+/* Write generation of each 2KB page of main memory */
+uint32 *RAM_GEN = NULL;
+
+/* Decoded instruction cache */
+static dcache_entry dcache[DCACHE_SIZE];
+
 /* Save environment for setjmp/longjmp */
 jmp_buf save_env;
 volatile uint32 abort_context;
@@ -802,9 +808,10 @@ t_stat cpu_load_rom(uint8 *arrayp, uint32 len)
     rom_size = len;
 
     if (ROM != NULL) {
-        free(ROM);
+        sim_mem_free(ROM);
     }
-    ROM = (uint32 *) calloc((size_t)(len >> 2), sizeof(uint32));
+    /* Shareable among instances running the same ROM */
+    ROM = (uint32 *) sim_mem_alloc((size_t)len);
     if (ROM == NULL) {
         return SCPE_MEM;
     }
@@ -818,6 +825,8 @@ t_stat cpu_load_rom(uint8 *arrayp, uint32 len)
         ROM[index] = (ROM[index] & ~mask) | (val << sc);
     }
 
+    cpu_dcache_flush();
+
     return SCPE_OK;
 }
 
@@ -1031,13 +1040,24 @@ t_stat cpu_reset(DEVICE *dptr)
 
         /* Always re-allocate RAM */
         if (RAM != NULL) {
-            free(RAM);
+            sim_mem_free(RAM);
         }
-        RAM = (uint32 *) calloc((size_t)(MEM_SIZE >> 2), sizeof(uint32));
+        RAM = (uint32 *) sim_mem_alloc((size_t) MEM_SIZE);
         if (RAM == NULL) {
             return SCPE_MEM;
         }
 
+        if (RAM_GEN != NULL) {
+            free(RAM_GEN);
+        }
+        RAM_GEN = (uint32 *) calloc((size_t)(MEM_SIZE >> DCACHE_PG_SHIFT) + 1,
+                                    sizeof(uint32));
+        if (RAM_GEN == NULL) {
+            return SCPE_MEM;
+        }
+
+        cpu_dcache_flush();
+
         sim_vm_is_subroutine_call = cpu_is_pc_a_subroutine_call;
     }
 
@@ -1584,6 +1604,7 @@ void cpu_show_operand(FILE *st, operand *op)
 t_stat cpu_set_size(UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 {
     uint32 *nRAM = NULL;
+    uint32 *nRAM_GEN = NULL;
     uint32 uval = (uint32) val;
 
     if ((val <= 0) || (val > MAXMEMSIZE)) {
@@ -1592,17 +1613,29 @@ t_stat cpu_set_size(UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 
     /* Do (re-)allocation for memory. */
 
-    nRAM = (uint32 *) calloc(uval >> 2, sizeof(uint32));
+    nRAM = (uint32 *) sim_mem_alloc((size_t) uval);
 
     if (nRAM == NULL) {
         return SCPE_MEM;
     }
 
-    free(RAM);
+    nRAM_GEN = (uint32 *) calloc((uval >> DCACHE_PG_SHIFT) + 1, sizeof(uint32));
+
+    if (nRAM_GEN == NULL) {
+        sim_mem_free(nRAM);
+        return SCPE_MEM;
+    }
+
+    sim_mem_free(RAM);
     RAM = nRAM;
 
+    free(RAM_GEN);
+    RAM_GEN = nRAM_GEN;
+
     MEM_SIZE = uval;
 
+    cpu_dcache_flush();
+
     memset(RAM, 0, (size_t)(MEM_SIZE >> 2));
 
     return SCPE_OK;
@@ -1870,6 +1903,115 @@ uint8 decode_instruction(instr *instr)
     return offset;
 }
 
+/*
+ * Return the write generation of the page holding a physical
+ * address. ROM is never written, so its generation is always 0.
+ */
+static SIM_INLINE uint32 dcache_gen(uint32 pa)
+{
+    if (addr_is_mem(pa)) {
+        return RAM_GEN[(pa - PHYS_MEM_BASE) >> DCACHE_PG_SHIFT];
+    }
+
+    return 0;
+}
+
+/*
+ * Invalidate every entry in the decoded instruction cache.
+ */
+void cpu_dcache_flush()
+{
+    uint32 i;
+
+    for (i = 0; i < DCACHE_SIZE; i++) {
+        dcache[i].valid = FALSE;
+    }
+}
+
+/*
+ * Decode the instruction pointed at by the PC, using the decoded
+ * instruction cache where possible.
+ *
+ * Entries are keyed by the physical address of the opcode and carry
+ * the write generation of the page they were decoded from, so any
+ * store to that page retires them. Because the key is physical, an
+ * MMU flush does not need to touch the cache: the PC and the last
+ * byte of the instruction are translated again on every hit, which
+ * takes the same faults and updates the same R bits as fetching the
+ * instruction a byte at a time. If either translation fails, or the
+ * bytes are no longer contiguous, the instruction is decoded the slow
+ * way so that faults are reported exactly as before.
+ *
+ * returns: the length of the instruction in bytes.
+ */
+static uint8 cpu_decode_cached(instr *inst)
+{
+    dcache_entry *e;
+    operand *oper;
+    uint32 va, pa, pa_last;
+    uint8 len;
+    int i;
+
+    va = R[NUM_PC];
+
+    if (mmu_decode_va(va, ACC_IF, TRUE, &pa) != SCPE_OK) {
+        return decode_instruction(inst);
+    }
+
+    e = &dcache[pa & DCACHE_MASK];
+
+    if (e->valid && e->pa == pa && e->gen == dcache_gen(pa)) {
+        if (e->len > 1 &&
+            (mmu_decode_va(va + e->len - 1, ACC_IF, TRUE, &pa_last) != SCPE_OK ||
+             pa_last != pa + e->len - 1)) {
+            return decode_instruction(inst);
+        }
+
+        if (e->var) {
+            mmu_state.var = va + e->len - 1;
+        }
+
+        *inst = e->inst;
+        inst->psw = R[NUM_PSW];
+        inst->sp  = R[NUM_SP];
+        inst->pc  = va;
+
+        /* Register mode operands pick up the register at decode time */
+        for (i = 0; i < 4; i++) {
+            oper = &inst->operands[i];
+            if ((oper->mode == 4 || oper->mode == 5) && oper->reg != 15) {
+                oper->data = R[oper->reg];
+            }
+        }
+
+        return e->len;
+    }
+
+    len = decode_instruction(inst);
+
+    /* Only cache instructions that sit in one page of RAM or ROM */
+    if (((pa ^ (pa + len - 1)) >> DCACHE_PG_SHIFT) != 0 ||
+        !((addr_is_mem(pa) && addr_is_mem(pa + len - 1)) ||
+          (addr_is_rom(pa) && addr_is_rom(pa + len - 1)))) {
+        return len;
+    }
+
+    if (len > 1 &&
+        (mmu_decode_va(va + len - 1, ACC_IF, FALSE, &pa_last) != SCPE_OK ||
+         pa_last != pa + len - 1)) {
+        return len;
+    }
+
+    e->pa = pa;
+    e->gen = dcache_gen(pa);
+    e->len = len;
+    e->var = len > ((inst->mn->opcode > 0xff) ? 2 : 1);
+    e->inst = *inst;
+    e->valid = TRUE;
+
+    return len;
+}
+
 static SIM_INLINE void cpu_context_switch_3(uint32 new_pcbp)
 {
     if (R[NUM_PSW] & PSW_R_MASK) {
@@ -2180,7 +2322,7 @@ t_stat sim_instr(void)
         }
 
         /* Decode the instruction */
-        pc_incr = decode_instruction(cpu_instr);
+        pc_incr = cpu_decode_cached(cpu_instr);
 
         /* Make sure to update the valid bit for history keeping (if
          * enabled) */
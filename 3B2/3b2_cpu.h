@@ -43,6 +43,11 @@
 #define MIN_HIST_SIZE         64
 #define MEM_SIZE              (cpu_unit.capac)
 
+/* Decoded instruction cache */
+#define DCACHE_SIZE           4096
+#define DCACHE_MASK           (DCACHE_SIZE - 1)
+#define DCACHE_PG_SHIFT       11      /* RAM write generations are per 2KB */
+
 #define UNIT_V_MSIZE          (UNIT_V_UF)
 #define UNIT_MSIZE            (1 << UNIT_V_MSIZE)
 
@@ -562,6 +567,19 @@ typedef struct {
     operand operands[4];
 } instr;
 
+/*
+ * A decoded instruction cache entry, keyed by the physical address
+ * of the opcode.
+ */
+typedef struct {
+    uint32 pa;           /* Physical address of the opcode */
+    uint32 gen;          /* Write generation of its page when decoded */
+    uint8  len;          /* Length of the instruction in bytes */
+    t_bool var;          /* Decoding left the last byte's VA in the VAR */
+    t_bool valid;
+    instr  inst;
+} dcache_entry;
+
 /*
  * A mapping of CIO identifier word to CIO device name.
  *
@@ -602,6 +620,7 @@ t_stat fprint_sym_m(FILE *of, t_addr addr, t_value *val);
 instr *cpu_next_instruction(void);
 
 uint8 decode_instruction(instr *instr);
+void cpu_dcache_flush();
 void cpu_on_interrupt(uint16 vec);
 void cpu_abort(uint8 et, uint8 isc);
 
@@ -657,6 +676,7 @@ extern instr *cpu_instr;
 extern t_bool cpu_nmi;
 extern uint32 *ROM;
 extern uint32 *RAM;
+extern uint32 *RAM_GEN;
 extern uint32 R[NUM_REGISTERS];
 extern REG cpu_reg[];
 extern UNIT cpu_unit;
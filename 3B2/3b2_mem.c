@@ -110,6 +110,7 @@ void pwrite_w(uint32 pa, uint32 val)
 
     if (addr_is_mem(pa)) {
         RAM[(pa - PHYS_MEM_BASE) >> 2] = val;
+        RAM_GEN[(pa - PHYS_MEM_BASE) >> DCACHE_PG_SHIFT]++;
         return;
     }
 }
@@ -185,6 +186,8 @@ void pwrite_h(uint32 pa, uint16 val)
     } else {
         m[index] = (m[index] & HALF_MASK) | (wval << 16);
     }
+
+    RAM_GEN[(pa - PHYS_MEM_BASE) >> DCACHE_PG_SHIFT]++;
 }
 
 /*
@@ -227,8 +230,77 @@ void pwrite_b(uint32 pa, uint8 val)
         m = RAM;
         index = (pa - PHYS_MEM_BASE) >> 2;
         m[index] = (m[index] & ~mask) | (uint32) (val << sc);
+        RAM_GEN[(pa - PHYS_MEM_BASE) >> DCACHE_PG_SHIFT]++;
+        return;
+    }
+}
+
+/*
+ * Read a block of bytes (Physical Address) into a buffer. Blocks that
+ * lie entirely in main memory are copied a word at a time; anything
+ * else goes through pread_b() byte by byte.
+ */
+void pread_buf(uint32 pa, uint8 *buf, uint32 len)
+{
+    uint32 i = 0;
+    uint32 data;
+
+    if (len == 0) {
         return;
     }
+
+    if (addr_is_mem(pa) && addr_is_mem(pa + len - 1)) {
+        for (; i < len && ((pa + i) & 3); i++) {
+            buf[i] = pread_b(pa + i);
+        }
+        for (; i + 4 <= len; i += 4) {
+            data = RAM[(pa + i - PHYS_MEM_BASE) >> 2];
+            buf[i]     = (data >> 24) & BYTE_MASK;
+            buf[i + 1] = (data >> 16) & BYTE_MASK;
+            buf[i + 2] = (data >> 8) & BYTE_MASK;
+            buf[i + 3] = data & BYTE_MASK;
+        }
+    }
+
+    for (; i < len; i++) {
+        buf[i] = pread_b(pa + i);
+    }
+}
+
+/*
+ * Write a buffer to a block of bytes (Physical Address). Blocks that
+ * lie entirely in main memory are stored a word at a time, and the
+ * write generation of each page touched is bumped once; anything
+ * else goes through pwrite_b() byte by byte.
+ */
+void pwrite_buf(uint32 pa, const uint8 *buf, uint32 len)
+{
+    uint32 i = 0;
+    uint32 pg;
+
+    if (len == 0) {
+        return;
+    }
+
+    if (addr_is_mem(pa) && addr_is_mem(pa + len - 1)) {
+        for (; i < len && ((pa + i) & 3); i++) {
+            pwrite_b(pa + i, buf[i]);
+        }
+        for (; i + 4 <= len; i += 4) {
+            RAM[(pa + i - PHYS_MEM_BASE) >> 2] =
+                ((uint32) buf[i] << 24) | ((uint32) buf[i + 1] << 16) |
+                ((uint32) buf[i + 2] << 8) | (uint32) buf[i + 3];
+        }
+        for (pg = (pa - PHYS_MEM_BASE) >> DCACHE_PG_SHIFT;
+             pg <= ((pa + len - 1 - PHYS_MEM_BASE) >> DCACHE_PG_SHIFT);
+             pg++) {
+            RAM_GEN[pg]++;
+        }
+    }
+
+    for (; i < len; i++) {
+        pwrite_b(pa + i, buf[i]);
+    }
 }
 
 /* Read Byte (Virtual Address) */
@@ -39,6 +39,8 @@ uint8  pread_b(uint32 pa);
 void   pwrite_b(uint32 pa, uint8 val);
 uint16 pread_h(uint32 pa);
 void   pwrite_h(uint32 pa, uint16 val);
+void   pread_buf(uint32 pa, uint8 *buf, uint32 len);
+void   pwrite_buf(uint32 pa, const uint8 *buf, uint32 len);
 
 uint8  read_b(uint32 va, uint8 r_acc);
 uint16 read_h(uint32 va, uint8 r_acc);
@@ -296,7 +296,7 @@ static void ni_disable()
 
 static void ni_cmd(uint8 cid, cio_entry *rentry, uint8 *rapp_data, t_bool is_exp)
 {
-    int i, j;
+    int i;
     int32 delay;
     uint16 hdrsize;
     t_stat status;
@@ -474,9 +474,8 @@ static void ni_cmd(uint8 cid, cio_entry *rentry, uint8 *rapp_data, t_bool is_exp
         hdrsize = pread_h(rentry->address + EIG_TABLE_SIZE);
 
         /* Read out the packet frame */
-        for (i = 0; i < rentry->byte_count; i++) {
-            ni.wr_buf.msg[i] = pread_b(rentry->address + PKT_START_OFFSET + i);
-        }
+        pread_buf(rentry->address + PKT_START_OFFSET, ni.wr_buf.msg,
+                  rentry->byte_count);
 
         /* Get a pointer to the buffer containing the protocol data */
         prot_info_offset = 0;
@@ -488,9 +487,8 @@ static void ni_cmd(uint8 cid, cio_entry *rentry, uint8 *rapp_data, t_bool is_exp
             prot_info_offset += 8;
 
             /* Fill in the frame from this buffer */
-            for (j=0; j < ni.prot.size; i++, j++) {
-                ni.wr_buf.msg[hdrsize + i] = pread_b(ni.prot.addr + j);
-            }
+            pread_buf(ni.prot.addr, &ni.wr_buf.msg[hdrsize + i], ni.prot.size);
+            i += ni.prot.size;
         } while (!ni.prot.last);
 
         /* Fill in packet details */
@@ -765,6 +763,7 @@ t_stat ni_reset(DEVICE *dptr)
 t_stat ni_rcv_svc(UNIT *uptr)
 {
     t_stat read_succ;
+    t_bool rcvd = FALSE;
 
     UNUSED(uptr);
 
@@ -779,6 +778,12 @@ t_stat ni_rcv_svc(UNIT *uptr)
         }
         /* Attempt to process the packet that was received. */
         ni_process_packet();
+        rcvd = TRUE;
+    }
+
+    /* One interrupt covers every packet drained on this pass */
+    if (rcvd && cio[ni.cid].ivec > 0) {
+        CIO_SET_INT(ni.cid);
     }
 
     return SCPE_OK;
@@ -896,7 +901,7 @@ t_stat ni_cio_svc(UNIT *uptr)
  */
 void ni_process_packet()
 {
-    int i, rp;
+    int rp;
     uint32 addr;
     uint8 slot;
     cio_entry centry = {0};
@@ -929,9 +934,7 @@ void ni_process_packet()
               slot, addr);
 
     /* Store the packet into main memory */
-    for (i = 0; i < len; i++) {
-        pwrite_b(addr + i, rbuf[i]);
-    }
+    pwrite_buf(addr, rbuf, len);
 
     if (ni_dev.dctrl & DBG_DAT) {
         dump_packet("RCV", &ni.rd_buf);
@@ -949,11 +952,6 @@ void ni_process_packet()
 
     /* TODO: We should probably also check status here. */
     cio_cqueue(ni.cid, CIO_STAT, NIQESIZE, &centry, capp_data);
-
-    /* Trigger an interrupt */
-    if (cio[ni.cid].ivec > 0) {
-        CIO_SET_INT(ni.cid);
-    }
 }
 
 t_stat ni_attach(UNIT *uptr, CONST char *cptr)
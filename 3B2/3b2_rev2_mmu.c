@@ -37,6 +37,9 @@ UNIT mmu_unit = { UDATA(NULL, 0, 0) };
 
 MMU_STATE mmu_state;
 
+/* Descriptor cache statistics, cleared on reset */
+MMU_STATS mmu_stats;
+
 REG mmu_reg[] = {
     { HRDATAD (ENABLE, mmu_state.enabled, 1, "Enabled?")        },
     { HRDATAD (CONFIG, mmu_state.conf,   32, "Configuration")   },
@@ -54,11 +57,17 @@ REG mmu_reg[] = {
     { NULL }
 };
 
+MTAB mmu_mod[] = {
+    { MTAB_XTD|MTAB_VDV|MTAB_NMO, 0, "STATS", NULL,
+      NULL, &mmu_show_stats, NULL, "Display descriptor cache statistics" },
+    { 0 }
+};
+
 DEVICE mmu_dev = {
     "MMU",                          /* name */
     &mmu_unit,                      /* units */
     mmu_reg,                        /* registers */
-    NULL,                           /* modifiers */
+    mmu_mod,                        /* modifiers */
     1,                              /* #units */
     16,                             /* address radix */
     8,                              /* address width */
@@ -335,6 +344,7 @@ static SIM_INLINE void mmu_update_pd(uint32 va, uint32 pd_addr, uint32 mask)
 t_stat mmu_init(DEVICE *dptr)
 {
     flush_caches();
+    memset(&mmu_stats, 0, sizeof(mmu_stats));
     return SCPE_OK;
 }
 
@@ -714,6 +724,12 @@ t_stat mmu_decode_va(uint32 va, uint8 r_acc, t_bool fc, uint32 *pa)
     sd_cached = get_sdce(va, &sd0, &sd1);
     pd_cached = get_pdce(va, &pd, &pd_acc);
 
+    if (sd_cached == SCPE_OK) {
+        mmu_stats.sdc_hit++;
+    } else {
+        mmu_stats.sdc_miss++;
+    }
+
     if (sd_cached == SCPE_OK && pd_cached != SCPE_OK) {
         if (SD_PAGED(sd0) && mmu_get_pd(va, r_acc, fc, sd0, sd1, &pd, &pd_acc) != SCPE_OK) {
             sim_debug(EXECUTE_MSG, &mmu_dev,
@@ -745,6 +761,11 @@ t_stat mmu_decode_va(uint32 va, uint8 r_acc, t_bool fc, uint32 *pa)
     }
 
     if (SD_PAGED(sd0)) {
+        if (pd_cached == SCPE_OK) {
+            mmu_stats.pdc_hit++;
+        } else {
+            mmu_stats.pdc_miss++;
+        }
         if (fc && mmu_check_perm(pd_acc, r_acc) != SCPE_OK) {
             sim_debug(EXECUTE_MSG, &mmu_dev,
                       "[%08x] PAGED: NO ACCESS TO MEMORY AT %08x.\n"
@@ -824,3 +845,30 @@ CONST char *mmu_description(DEVICE *dptr)
 {
     return "WE32101";
 }
+
+/*
+ * Display descriptor cache statistics
+ */
+t_stat mmu_show_stats(FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+    t_uint64 sdc_total = mmu_stats.sdc_hit + mmu_stats.sdc_miss;
+    t_uint64 pdc_total = mmu_stats.pdc_hit + mmu_stats.pdc_miss;
+
+    fprintf(st, "SD cache: %" LL_FMT "u hits, %" LL_FMT "u misses",
+            mmu_stats.sdc_hit, mmu_stats.sdc_miss);
+    if (sdc_total > 0) {
+        fprintf(st, " (%.1f%% hit)",
+                (100.0 * (double) mmu_stats.sdc_hit) / (double) sdc_total);
+    }
+    fprintf(st, "\n");
+
+    fprintf(st, "PD cache: %" LL_FMT "u hits, %" LL_FMT "u misses",
+            mmu_stats.pdc_hit, mmu_stats.pdc_miss);
+    if (pdc_total > 0) {
+        fprintf(st, " (%.1f%% hit)",
+                (100.0 * (double) mmu_stats.pdc_hit) / (double) pdc_total);
+    }
+    fprintf(st, "\n");
+
+    return SCPE_OK;
+}
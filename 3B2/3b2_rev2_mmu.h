@@ -321,10 +321,18 @@ typedef struct _mmu_state {
 
 } MMU_STATE;
 
+typedef struct {
+    t_uint64 sdc_hit;       /* SD cache hits */
+    t_uint64 sdc_miss;      /* SD cache misses */
+    t_uint64 pdc_hit;       /* PD cache hits */
+    t_uint64 pdc_miss;      /* PD cache misses */
+} MMU_STATS;
+
 t_stat mmu_init(DEVICE *dptr);
 uint32 mmu_read(uint32 pa, size_t size);
 void mmu_write(uint32 pa, uint32 val, size_t size);
 CONST char *mmu_description(DEVICE *dptr);
+t_stat mmu_show_stats(FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 
 /* Physical memory read/write */
 uint8  pread_b(uint32 pa);
@@ -38,6 +38,9 @@ UNIT mmu_unit = { UDATA(NULL, 0, 0) };
 
 MMU_STATE mmu_state;
 
+/* Descriptor cache statistics, cleared on reset */
+MMU_STATS mmu_stats;
+
 REG mmu_reg[] = {
     { HRDATAD (ENABLE, mmu_state.enabled, 1, "Enabled?")        },
     { HRDATAD (CONFIG, mmu_state.conf,   32, "Configuration")   },
@@ -77,6 +80,8 @@ MTAB mmu_mod[] = {
       NULL, &mmu_show_sdc, NULL, "Display SD Cache" },
     { MTAB_XTD|MTAB_VDV|MTAB_NMO, 0, "PDC", NULL,
       NULL, &mmu_show_pdc, NULL, "Display PD Cache" },
+    { MTAB_XTD|MTAB_VDV|MTAB_NMO, 0, "STATS", NULL,
+      NULL, &mmu_show_stats, NULL, "Display descriptor cache statistics" },
     { 0 }
 };
 
@@ -444,6 +449,7 @@ static t_stat get_idnc(uint32 va, uint8 *id)
 t_stat mmu_init(DEVICE *dptr)
 {
     flush_caches();
+    memset(&mmu_stats, 0, sizeof(mmu_stats));
     return SCPE_OK;
 }
 
@@ -726,6 +732,16 @@ static t_stat mmu_update_history(uint32 va, uint8 r_acc, uint32 pdc_idx, t_bool
         update_sdc = FALSE;
     }
 
+    /* Once the R and M bits the access needs are set in both caches
+       there is nothing to write back, so don't go to memory for the
+       SD at all. This is by far the most common case. */
+    if (!(MMU_CONF_M && r_acc == ACC_W && (mmu_state.sdcl[SDC_IDX(va)] & SDC_M_MASK) == 0) &&
+        !(MMU_CONF_R && (mmu_state.sdcl[SDC_IDX(va)] & SDC_R_MASK) == 0) &&
+        !(r_acc == ACC_W && (mmu_state.pdcl[pdc_idx] & PDC_M_MASK) == 0) &&
+        (mmu_state.pdcl[pdc_idx] & PDC_R_MASK) != 0) {
+        return SCPE_OK;
+    }
+
     sd_lo = pread_w(SD_ADDR(va));
     sd_hi = pread_w(SD_ADDR(va) + 4);
 
@@ -835,12 +851,15 @@ t_stat mmu_pdc_miss(uint32 va, uint8 r_acc, t_bool fc,
             /* This was a miss, so we need to load the SD out of
              * memory. */
             sdc_miss = TRUE;
+            mmu_stats.sdc_miss++;
 
             sd_lo = pread_w(sd_ptr);      /* Control Bits */
             sd_hi = pread_w(sd_ptr + 4);  /* Address Bits */
             sim_debug(MMU_CACHE_DBG, &mmu_dev,
                       "[%08x] SDC miss. Read sd_ptr=%08x sd_lo=%08x sd_hi=%08x va=%08x\n",
                       R[NUM_PC], sd_ptr, sd_lo, sd_hi, va);
+        } else {
+            mmu_stats.sdc_hit++;
         }
 
         if (!SD_VALID(sd_lo)) {
@@ -1016,6 +1035,7 @@ t_stat mmu_decode_va(uint32 va, uint8 r_acc, t_bool fc, uint32 *pa)
      * 1. Check PDC for an entry.
      */
     if (get_pdce(va, &pd, &pd_acc, &pdc_idx) == SCPE_OK) {
+        mmu_stats.pdc_hit++;
         if (mmu_check_perm(pd_acc, r_acc) != SCPE_OK) {
             sim_debug(MMU_FAULT_DBG, &mmu_dev,
                       "[%08x] Access to Memory Denied (va=%08x ckm=%d pd_acc=%02x r_acc=%02x)\n",
@@ -1032,6 +1052,7 @@ t_stat mmu_decode_va(uint32 va, uint8 r_acc, t_bool fc, uint32 *pa)
             return SCPE_NXM;
         }
     } else {
+        mmu_stats.pdc_miss++;
         /* Do miss processing. This will cache the PD if necessary. */
         succ = mmu_pdc_miss(va, r_acc, fc, &pd, &pdc_idx);
         if (succ != SCPE_OK) {
@@ -1160,6 +1181,33 @@ t_stat mmu_show_pdc(FILE *st, UNIT *uptr, int32 val, CONST void *desc)
     return SCPE_OK;
 }
 
+/*
+ * Display descriptor cache statistics
+ */
+t_stat mmu_show_stats(FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+    t_uint64 sdc_total = mmu_stats.sdc_hit + mmu_stats.sdc_miss;
+    t_uint64 pdc_total = mmu_stats.pdc_hit + mmu_stats.pdc_miss;
+
+    fprintf(st, "SD cache: %" LL_FMT "u hits, %" LL_FMT "u misses",
+            mmu_stats.sdc_hit, mmu_stats.sdc_miss);
+    if (sdc_total > 0) {
+        fprintf(st, " (%.1f%% hit)",
+                (100.0 * (double) mmu_stats.sdc_hit) / (double) sdc_total);
+    }
+    fprintf(st, "\n");
+
+    fprintf(st, "PD cache: %" LL_FMT "u hits, %" LL_FMT "u misses",
+            mmu_stats.pdc_hit, mmu_stats.pdc_miss);
+    if (pdc_total > 0) {
+        fprintf(st, " (%.1f%% hit)",
+                (100.0 * (double) mmu_stats.pdc_hit) / (double) pdc_total);
+    }
+    fprintf(st, "\n");
+
+    return SCPE_OK;
+}
+
 /*
  * Display the segment table for a section.
  */
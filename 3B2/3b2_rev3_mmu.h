@@ -335,6 +335,13 @@ typedef struct _mmu_state {
 
 } MMU_STATE;
 
+typedef struct {
+    t_uint64 sdc_hit;       /* SD cache hits */
+    t_uint64 sdc_miss;      /* SD cache misses */
+    t_uint64 pdc_hit;       /* PD cache hits */
+    t_uint64 pdc_miss;      /* PD cache misses */
+} MMU_STATS;
+
 t_stat mmu_init(DEVICE *dptr);
 uint32 mmu_read(uint32 pa, size_t size);
 void   mmu_write(uint32 pa, uint32 val, size_t size);
@@ -350,7 +357,10 @@ void   mmu_enable();
 void   mmu_disable();
 
 t_stat mmu_show_sdt(FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+t_stat mmu_show_stats(FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat mmu_show_sdc(FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat mmu_show_pdc(FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 
+extern MMU_STATE mmu_state;
+
 #endif /* _3B2_1000_MMU_H_ */
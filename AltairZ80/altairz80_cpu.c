@@ -1804,10 +1804,24 @@ static MDEV RAM_PAGE    =   {TRUE,  FALSE,  NULL, "RAM"};       /* this makes a
 static MDEV EMPTY_PAGE  =   {FALSE, TRUE,   NULL, "NONEXIST"};  /* this is non-existing memory  */
 static MDEV mmu_table[MAXMEMORY >> LOG2PAGESIZE];
 
+/* Direct host pointers to the pages of M that can be read or written without
+   going through mmu_table, NULL where the page needs the slow path. Only
+   change mmu_table through mmu_set_page so that these stay in step. */
+static uint8 *mmu_rd_ptr[MAXMEMORY >> LOG2PAGESIZE];
+static uint8 *mmu_wr_ptr[MAXMEMORY >> LOG2PAGESIZE];
+
+static void mmu_set_page(const uint32 page, const MDEV m) {
+    mmu_table[page] = m;
+    mmu_wr_ptr[page] = m.isRAM ? &M[page << LOG2PAGESIZE] : NULL;
+    mmu_rd_ptr[page] = (m.isRAM || ((m.routine == NULL) && !m.isEmpty)) ?
+        &M[page << LOG2PAGESIZE] : NULL;
+}
+
 /* Memory and I/O Resource Mapping and Unmapping routine. */
 uint32 sim_map_resource(uint32 baseaddr, uint32 size, uint32 resource_type,
                         int32 (*routine)(const int32, const int32, const int32), const char* name, uint8 unmap) {
     uint32 page, i, addr;
+    MDEV m;
     if (resource_type == RESOURCE_TYPE_MEMORY) {
         for (i = 0; i < (size >> LOG2PAGESIZE); i++) {
             addr = (baseaddr & 0xfff00) + (i << LOG2PAGESIZE);
@@ -1821,16 +1835,17 @@ uint32 sim_map_resource(uint32 baseaddr, uint32 size, uint32 resource_type,
                 if (mmu_table[page].routine == routine) {   /* unmap only if it was mapped */
                     if (MEMORYSIZE < MAXBANKSIZE)
                         if (addr < MEMORYSIZE)
-                            mmu_table[page] = RAM_PAGE;
+                            mmu_set_page(page, RAM_PAGE);
                         else
-                            mmu_table[page] = EMPTY_PAGE;
+                            mmu_set_page(page, EMPTY_PAGE);
                     else
-                        mmu_table[page] = RAM_PAGE;
+                        mmu_set_page(page, RAM_PAGE);
                 }
             } else {
-                mmu_table[page] = ROM_PAGE;
-                mmu_table[page].routine = routine;
-                mmu_table[page].name = name;
+                m = ROM_PAGE;
+                m.routine = routine;
+                m.name = name;
+                mmu_set_page(page, m);
             }
         }
     } else if (resource_type == RESOURCE_TYPE_IO) {
@@ -1857,11 +1872,18 @@ uint32 sim_map_resource(uint32 baseaddr, uint32 size, uint32 resource_type,
 
 static void PutBYTE(register uint32 Addr, const register uint32 Value) {
     MDEV m;
+    uint8 *p;
 
     Addr &= ADDRMASK;   /* registers are NOT guaranteed to be always 16-bit values */
     if ((cpu_unit.flags & UNIT_CPU_BANKED) && (((common_low == 0) && (Addr < common)) || ((common_low == 1) && (Addr >= common))))
         Addr |= bankSelect << MAXBANKSIZELOG2;
 
+    p = mmu_wr_ptr[Addr >> LOG2PAGESIZE];
+    if (p) {
+        p[Addr & (PAGESIZE - 1)] = Value;
+        return;
+    }
+
     m = mmu_table[Addr >> LOG2PAGESIZE];
 
     if (m.isRAM)
@@ -1878,8 +1900,15 @@ static void PutBYTE(register uint32 Addr, const register uint32 Value) {
 
 void PutBYTEExtended(register uint32 Addr, const register uint32 Value) {
     MDEV m;
+    uint8 *p;
 
     Addr &= ADDRMASKEXTENDED;
+    p = mmu_wr_ptr[Addr >> LOG2PAGESIZE];
+    if (p) {
+        p[Addr & (PAGESIZE - 1)] = Value;
+        return;
+    }
+
     m = mmu_table[Addr >> LOG2PAGESIZE];
 
     if (m.isRAM)
@@ -1901,10 +1930,14 @@ static void PutWORD(register uint32 Addr, const register uint32 Value) {
 
 static uint32 GetBYTE(register uint32 Addr) {
     MDEV m;
+    uint8 *p;
 
     Addr &= ADDRMASK;   /* registers are NOT guaranteed to be always 16-bit values */
     if ((cpu_unit.flags & UNIT_CPU_BANKED) && (((common_low == 0) && (Addr < common)) || ((common_low == 1) && (Addr >= common))))
         Addr |= bankSelect << MAXBANKSIZELOG2;
+    p = mmu_rd_ptr[Addr >> LOG2PAGESIZE];
+    if (p)
+        return p[Addr & (PAGESIZE - 1)]; /* RAM or ROM */
     m = mmu_table[Addr >> LOG2PAGESIZE];
 
     if (m.isRAM)
@@ -1921,8 +1954,12 @@ static uint32 GetBYTE(register uint32 Addr) {
 
 uint32 GetBYTEExtended(register uint32 Addr) {
     MDEV m;
+    uint8 *p;
 
     Addr &= ADDRMASKEXTENDED;
+    p = mmu_rd_ptr[Addr >> LOG2PAGESIZE];
+    if (p)
+        return p[Addr & (PAGESIZE - 1)];
     m = mmu_table[Addr >> LOG2PAGESIZE];
 
     if (m.isRAM)
@@ -1984,6 +2021,58 @@ void PutByteDMA(const uint32 Addr, const uint32 Value) {
         MOPT[Addr & ADDRMASK] = Value & 0xff;
 }
 
+/* Direct pointer for Addr from table in *ptr, and the number of bytes from
+   Addr in the direction dir that stay on its page and on its side of the
+   common memory boundary. Returns 0 if the page needs the slow path. */
+static uint32 mmu_run(uint32 Addr, const int32 dir, uint8 ** const table, uint8 **ptr) {
+    uint32 run;
+    uint8 *p;
+
+    Addr &= ADDRMASK;
+    run = (dir > 0) ? PAGESIZE - (Addr & (PAGESIZE - 1)) : (Addr & (PAGESIZE - 1)) + 1;
+    if (cpu_unit.flags & UNIT_CPU_BANKED) {
+        if (Addr < common) {
+            if ((dir > 0) && (common - Addr < run))
+                run = common - Addr;
+        } else if ((dir < 0) && (Addr - common + 1 < run))
+            run = Addr - common + 1;
+        if (((common_low == 0) && (Addr < common)) || ((common_low == 1) && (Addr >= common)))
+            Addr |= bankSelect << MAXBANKSIZELOG2;
+    }
+    p = table[Addr >> LOG2PAGESIZE];
+    if (p == NULL)
+        return 0;
+    *ptr = p + (Addr & (PAGESIZE - 1));
+    return run;
+}
+
+/* Block moves. Copy up to count bytes from src to dst, one byte at a time
+   in the direction dir (+1 or -1) so that overlapping moves behave exactly
+   as the instruction does, but only while both addresses stay on pages with
+   direct pointers and on the same side of the common memory boundary.
+   Returns the number of bytes copied, 0 if either side needs the slow path. */
+static uint32 mmu_block_move(const uint32 src, const uint32 dst, uint32 count,
+                             const int32 dir) {
+    uint8 *s, *d;
+    uint32 n, run;
+
+    n = mmu_run(src, dir, mmu_rd_ptr, &s);
+    if (n < count)
+        count = n;
+    run = mmu_run(dst, dir, mmu_wr_ptr, &d);
+    if (run < count)
+        count = run;
+    if (count == 0)
+        return 0;
+    if (dir > 0)
+        for (n = count; n; n--)
+            *d++ = *s++;
+    else
+        for (n = count; n; n--)
+            *d-- = *s--;
+    return count;
+}
+
 #define RAM_PP(Addr) GetBYTE(Addr++)
 #define RAM_MM(Addr) GetBYTE(Addr--)
 #define GET_WORD(Addr) (GetBYTE(Addr) | (GetBYTE(Addr + 1) << 8))
@@ -5270,12 +5359,23 @@ static t_stat sim_instr_mmu (void) {
                         if (BC == 0)
                             BC = 0x10000;
                         do {
+                            if (!(sim_brk_summ & SWMASK('M')) &&
+                                (temp = mmu_block_move(HL, DE, BC, 1))) {
+                                tStates += 21 * temp;
+                                INCR(2 * temp);
+                                HL += temp;
+                                DE += temp;
+                                BC -= temp;
+                                acu = GetBYTE(DE - 1);      /* last byte moved */
+                                continue;
+                            }
                             tStates += 21;
                             INCR(2);
                             CHECK_BREAK_TWO_BYTES(HL, DE);
                             acu = RAM_PP(HL);
                             PUT_BYTE_PP(DE, acu);
-                        } while (--BC);
+                            --BC;
+                        } while (BC);
                         acu += HIGH_REGISTER(AF);
                         AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4);
                         break;
@@ -5345,12 +5445,23 @@ static t_stat sim_instr_mmu (void) {
                         if (BC == 0)
                             BC = 0x10000;
                         do {
+                            if (!(sim_brk_summ & SWMASK('M')) &&
+                                (temp = mmu_block_move(HL, DE, BC, -1))) {
+                                tStates += 21 * temp;
+                                INCR(2 * temp);
+                                HL -= temp;
+                                DE -= temp;
+                                BC -= temp;
+                                acu = GetBYTE(DE + 1);      /* last byte moved */
+                                continue;
+                            }
                             tStates += 21;
                             INCR(2);
                             CHECK_BREAK_TWO_BYTES(HL, DE);
                             acu = RAM_MM(HL);
                             PUT_BYTE_MM(DE, acu);
-                        } while (--BC);
+                            --BC;
+                        } while (BC);
                         acu += HIGH_REGISTER(AF);
                         AF = (AF & ~0x3e) | (acu & 8) | ((acu & 2) << 4);
                         break;
@@ -6401,7 +6512,7 @@ t_stat install_bootrom(const int32 bootrom[], const int32 size, const int32 addr
         return SCPE_IERR;
     for (i = 0; i < size; i++) {
         if (makeROM && ((i & (PAGESIZE - 1)) == 0))
-            mmu_table[(i + addr) >> LOG2PAGESIZE] = ROM_PAGE;
+            mmu_set_page((i + addr) >> LOG2PAGESIZE, ROM_PAGE);
         M[i + addr] = bootrom[i] & 0xff;
     }
     return SCPE_OK;
@@ -6591,9 +6702,9 @@ static void cpu_clear(void) {
     for (i = 0; i < MAXMEMORY; i++)
         M[i] = 0;
     for (i = 0; i < (MAXMEMORY >> LOG2PAGESIZE); i++)
-        mmu_table[i] = RAM_PAGE;
+        mmu_set_page(i, RAM_PAGE);
     for (i = (MEMORYSIZE >> LOG2PAGESIZE); i < (MAXMEMORY >> LOG2PAGESIZE); i++)
-        mmu_table[i] = EMPTY_PAGE;
+        mmu_set_page(i, EMPTY_PAGE);
     if (cpu_unit.flags & UNIT_CPU_ALTAIRROM)
         install_ALTAIRbootROM();
     m68k_clear_memory();
@@ -6611,8 +6722,8 @@ static t_stat cpu_set_altairrom(UNIT *uptr, int32 value, CONST char *cptr, void
 }
 
 static t_stat cpu_set_noaltairrom(UNIT *uptr, int32 value, CONST char *cptr, void *desc) {
-    mmu_table[ALTAIR_ROM_LOW >> LOG2PAGESIZE] = MEMORYSIZE < MAXBANKSIZE ?
-        EMPTY_PAGE : RAM_PAGE;
+    mmu_set_page(ALTAIR_ROM_LOW >> LOG2PAGESIZE, MEMORYSIZE < MAXBANKSIZE ?
+        EMPTY_PAGE : RAM_PAGE);
     return SCPE_OK;
 }
 
@@ -7197,12 +7308,12 @@ t_stat sim_load(FILE *fileref, CONST char *cptr, CONST char *fnam, int flag) {
         while ((addr < MAXMEMORY) && ((i = getc(fileref)) != EOF)) {
             m = mmu_table[addr >> LOG2PAGESIZE];
             if (!m.isRAM && m.isEmpty) {
-                mmu_table[addr >> LOG2PAGESIZE] = RAM_PAGE;
+                mmu_set_page(addr >> LOG2PAGESIZE, RAM_PAGE);
                 pagesModified++;
                 m = RAM_PAGE;
             }
             if (makeROM) {
-                mmu_table[addr >> LOG2PAGESIZE] = ROM_PAGE;
+                mmu_set_page(addr >> LOG2PAGESIZE, ROM_PAGE);
                 m = ROM_PAGE;
             }
             if (!m.isRAM && m.routine)
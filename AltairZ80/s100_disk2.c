@@ -309,6 +309,10 @@ static t_stat disk2_detach(UNIT *uptr)
     if (uptr->flags & UNIT_DISK2_VERBOSE)
         sim_printf("Detach DISK2%d\n", i);
 
+    if (uptr->u3 == IMAGE_TYPE_IMD) {
+        diskClose(&disk2_info->drive[i].imd);
+    }
+
     r = detach_unit(uptr);  /* detach unit */
     if ( r != SCPE_OK)
         return r;
@@ -380,6 +380,10 @@ static t_stat disk3_detach(UNIT *uptr)
     if (uptr->flags & UNIT_DISK3_VERBOSE)
         sim_printf("Detach DISK3%d\n", i);
 
+    if (uptr->u3 == IMAGE_TYPE_IMD) {
+        diskClose(&disk3_info->drive[i].imd);
+    }
+
     r = detach_unit(uptr);  /* detach unit */
     if ( r != SCPE_OK)
         return r;
@@ -144,6 +144,7 @@
 
 t_stat              dtc_srv(UNIT *);
 t_stat              dtco_srv(UNIT *);
+t_bool              dtc_ready(UNIT *);
 t_stat              dtc_attach(UNIT *, CONST char *);
 t_stat              dtc_detach(UNIT *);
 t_stat              dtc_reset(DEVICE *);
@@ -407,44 +408,44 @@ t_stat dtc_srv(UNIT * uptr)
                 break;
         }
 
-        if (chan_read_char(chan, &ch, dtc_bufptr[line] >= dtc_blimit[line])) {
-                sim_debug(DEBUG_DETAIL, &dtc_dev, "Datacomm write done %d %d ",
-                         line, dtc_bufptr[line]);
-                dtc_bsize[line] = dtc_bufptr[line];
-                dtc_bufptr[line] = 0;
-                if (dtc_lstatus[line] & BufAbnormal) {
-                    chan_set_wcflg(chan);
-                }
-                /* Empty write, clears flags */
-                if (dtc_bsize[line] == 0) {
-                    sim_debug(DEBUG_DETAIL, &dtc_dev, "empty\n");
-                    if ((dtc_lstatus[line] & BufSMASK) != BufIdle) {
-                        dtc_lstatus[line] = BufIRQ|BufIdle;
-                        IAR |= IRQ_12;
-                    }
-                /* Check if we filled up buffer */
-                } else if (dtc_bsize[line] >= dtc_blimit[line]) {
-                     dtc_lstatus[line] = BufOutBusy;
-                     chan_set_gm(chan);
-                     sim_debug(DEBUG_DETAIL, &dtc_dev, "full ");
-                } else {
-                     dtc_lstatus[line] = BufOutBusy|BufGM;
-                     sim_debug(DEBUG_DETAIL, &dtc_dev, "gm ");
-                }
-                sim_debug(DEBUG_DETAIL, &dtc_dev, "\n");
-                for (ttu = 1; line > 15; ttu++)
-                    line -= 15;
-                chan_set_wc(chan, (ttu << 5) | line);
-                chan_set_end(chan);
-                uptr->CMD = DTC_RDY;
-                return SCPE_OK;
-        } else {
+        /* Move the whole record into the buffer in one pass, the
+           channel ends it at the buffer limit or the group mark */
+        while (chan_read_char(chan, &ch, dtc_bufptr[line] >= dtc_blimit[line]) == 0) {
               dtc_lstatus[line] = BufWrite;
               dtc_buf[line][dtc_bufptr[line]++] = ch & 077;
               sim_debug(DEBUG_DATA, &dtc_dev, "Datacomm write data %d %02o %d\n",
                           line, ch&077, dtc_bufptr[line]);
         }
-        sim_activate(uptr, 5000);
+        sim_debug(DEBUG_DETAIL, &dtc_dev, "Datacomm write done %d %d ",
+                 line, dtc_bufptr[line]);
+        dtc_bsize[line] = dtc_bufptr[line];
+        dtc_bufptr[line] = 0;
+        if (dtc_lstatus[line] & BufAbnormal) {
+            chan_set_wcflg(chan);
+        }
+        /* Empty write, clears flags */
+        if (dtc_bsize[line] == 0) {
+            sim_debug(DEBUG_DETAIL, &dtc_dev, "empty\n");
+            if ((dtc_lstatus[line] & BufSMASK) != BufIdle) {
+                dtc_lstatus[line] = BufIRQ|BufIdle;
+                IAR |= IRQ_12;
+            }
+        /* Check if we filled up buffer */
+        } else if (dtc_bsize[line] >= dtc_blimit[line]) {
+             dtc_lstatus[line] = BufOutBusy;
+             chan_set_gm(chan);
+             sim_debug(DEBUG_DETAIL, &dtc_dev, "full ");
+        } else {
+             dtc_lstatus[line] = BufOutBusy|BufGM;
+             sim_debug(DEBUG_DETAIL, &dtc_dev, "gm ");
+        }
+        sim_debug(DEBUG_DETAIL, &dtc_dev, "\n");
+        for (ttu = 1; line > 15; ttu++)
+            line -= 15;
+        chan_set_wc(chan, (ttu << 5) | line);
+        chan_set_end(chan);
+        uptr->CMD = DTC_RDY;
+        return SCPE_OK;
     }
 
     if (uptr->CMD & DTC_RD) {
@@ -492,39 +493,58 @@ t_stat dtc_srv(UNIT * uptr)
                 break;
         }
 
-        ch = dtc_buf[line][dtc_bufptr[line]++];
-        /* If no buffer, error out */
-        if (chan_write_char(chan, &ch, dtc_bufptr[line] >= dtc_bsize[line])) {
-                /* Check if we filled up buffer */
-                if (dtc_lstatus[line] & BufGM) {
-                     chan_set_gm(chan);
-                     sim_debug(DEBUG_DETAIL, &dtc_dev, "gm ");
-                }
-                if (dtc_lstatus[line] & BufAbnormal)
-                     chan_set_wcflg(chan);
-                if (dtc_ldsc[line].conn == 0)   /* connected? */
-                    dtc_lstatus[line] = BufIRQ|BufAbnormal|BufIRQ|BufIdle;
-                else
-                    dtc_lstatus[line] = BufIRQ|BufIdle;
-                dtc_bsize[line] = 0;
-                sim_debug(DEBUG_DETAIL, &dtc_dev, "Datacomm read done %d\n",
-                         line);
-                for (ttu = 1; line > 15; ttu++)
-                    line -= 15;
-                chan_set_wc(chan, (ttu << 5) | line);
-                chan_set_end(chan);
-                uptr->CMD = DTC_RDY;
-                IAR |= IRQ_12;
-                return SCPE_OK;
-        } else {
-             sim_debug(DEBUG_DATA, &dtc_dev, "Datacomm read data %d %02o %d\n",
+        /* Hand the whole buffer to the channel in one pass */
+        for (;;) {
+            ch = dtc_buf[line][dtc_bufptr[line]++];
+            /* If no buffer, error out */
+            if (chan_write_char(chan, &ch, dtc_bufptr[line] >= dtc_bsize[line]))
+                break;
+            sim_debug(DEBUG_DATA, &dtc_dev, "Datacomm read data %d %02o %d\n",
                           line, ch & 077, dtc_bufptr[line]);
         }
-        sim_activate(uptr, 5000);
+        /* Check if we filled up buffer */
+        if (dtc_lstatus[line] & BufGM) {
+             chan_set_gm(chan);
+             sim_debug(DEBUG_DETAIL, &dtc_dev, "gm ");
+        }
+        if (dtc_lstatus[line] & BufAbnormal)
+             chan_set_wcflg(chan);
+        if (dtc_ldsc[line].conn == 0)   /* connected? */
+            dtc_lstatus[line] = BufIRQ|BufAbnormal|BufIRQ|BufIdle;
+        else
+            dtc_lstatus[line] = BufIRQ|BufIdle;
+        dtc_bsize[line] = 0;
+        sim_debug(DEBUG_DETAIL, &dtc_dev, "Datacomm read done %d\n",
+                 line);
+        for (ttu = 1; line > 15; ttu++)
+            line -= 15;
+        chan_set_wc(chan, (ttu << 5) | line);
+        chan_set_end(chan);
+        uptr->CMD = DTC_RDY;
+        IAR |= IRQ_12;
     }
     return SCPE_OK;
 }
 
+/* Poll group readiness test, the poll only has work when input or a
+   connection arrives, a buffer is being output, or a line has dropped
+   and the system has not been told yet. */
+
+t_bool
+dtc_ready(UNIT * uptr)
+{
+    int                 ln;
+
+    for (ln = 0; ln < dtc_desc.lines; ln++) {
+        if ((dtc_lstatus[ln] & BufSMASK) == BufOutBusy)
+            return TRUE;
+        if (dtc_ldsc[ln].conn == 0 && (dtc_lstatus[ln] & BufDisco) == 0 &&
+            (dtc_lstatus[ln] & BufSMASK) != BufNotReady)
+            return TRUE;
+    }
+    return tmxr_input_ready(&dtc_desc);
+}
+
 /* Unit service - receive side
 
    Poll all active lines for input
@@ -782,6 +802,7 @@ dtc_attach(UNIT * uptr, CONST char *cptr)
     if (r != SCPE_OK)
         return r;               /* error */
     sim_activate(&dtc_unit[1], 100);    /* quick poll */
+    sim_poll_group_add(&dtc_unit[1], &dtc_ready); /* poll only when needed */
     for (i = 0; i < DTC_MLINES; i++) {
         dtc_lstatus[i] = BufNotReady;   /* Device not connected */
     }
@@ -802,6 +823,7 @@ dtc_detach(UNIT * uptr)
     for (i = 0; i < dtc_desc.lines; i++)
         dtc_ldsc[i].rcve = 0;   /* disable rcv */
     sim_cancel(uptr);           /* stop poll */
+    sim_poll_group_remove(&dtc_unit[1]);
     uptr->CMD = 0;
     iostatus &= ~DTC_FLAG;
     return r;
@@ -70,6 +70,11 @@ static void negate (alureg_t *val)
  */
 int besm6_highest_bit (t_value val)
 {
+#if defined (__GNUC__)
+    if (val == 0)
+        return 48;
+    return __builtin_clzll (val) - 15;
+#else
     int n = 32, cnt = 0;
     do {
         t_value tmp = val;
@@ -79,6 +84,7 @@ int besm6_highest_bit (t_value val)
         }
     } while (n >>= 1);
     return 48 - cnt;
+#endif
 }
 
 /*
@@ -277,9 +283,13 @@ static alureg_t nrdiv (alureg_t n, alureg_t d)
         if (nn == 0)
             break;
 
-        if (ABS(nn) < BIT40)
-            nn *= 2;        /* magic shortcut */
-        else if ((nn > 0) ^ (dd > 0)) {
+        if (ABS(nn) < BIT40) {
+            /* magic shortcut: skip the whole run of zero digits at once */
+            int cnt = besm6_highest_bit (ABS(nn)) - 9;
+            nn *= (t_int64) 1 << cnt;
+            q >>= cnt;
+            continue;
+        } else if ((nn > 0) ^ (dd > 0)) {
             res -= q;
             nn = 2*nn+dd;
         } else {
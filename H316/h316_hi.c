@@ -386,6 +386,10 @@ void hi_start_rx (uint16 line)
   }
   PHIDB(line)->rxpending = TRUE;  PHIDB(line)->rxerror = FALSE;
   CLR_RX_IRQ(line);
+
+  //   Data left over from the last packet, or a packet which arrived while no
+  // read was pending, is waiting for us now.  Go get it.
+  if (PUNIT(line)->flags & UNIT_ATT) sim_activate(PUNIT(line), PUNIT(line)->wait);
 }
 
 // Poll for receiver data ...
@@ -592,11 +596,11 @@ int32 hi_io (uint16 host, int32 inst, int32 fnc, int32 dat, int32 dev)
 t_stat hi_rx_service (UNIT *uptr)
 {
   //   This is the standard simh "service" routine that's called when an event
-  // queue entry expires.  It just polls the receiver and reschedules itself.
-  // That's it!
+  // queue entry expires.  The UDP poller activates it whenever a packet has
+  // arrived for this line, and hi_start_rx() does when the IMP starts input,
+  // so it never needs to reschedule itself.  That's it!
   uint16 line = uptr->hline;
   if (PHIDB(line)->rxpending) hi_poll_rx(line);
-  sim_activate(uptr, uptr->wait);
   return SCPE_OK;
 }
 
@@ -104,15 +104,15 @@
    AND since the RTC determines when the transmit done occurs, it guarantees
    that the IMP always sees exactly the same delay.
 
-   The modem receiver is completely independent of the transmitter and is polled
-   by the usual simh event queue mechanism and mi_service() routine. When the
-   IMP code executes a "start modem input" OCP a read pending flag is set in the
-   modem status but nothing else occurs.  Each poll checks the UDP socket for
-   incoming data and, if a packet was received AND a read operation is pending,
-   then the read completes that moment and the interrupt request is asserted.
-   The UDP socket is polled regardless of whether a read is pending and if data
-   arrives without a read then it's discarded.  That's exactly what a real modem
-   would do.
+   The modem receiver is completely independent of the transmitter and is
+   driven by the usual simh event queue mechanism and mi_rx_service() routine.
+   When the IMP code executes a "start modem input" OCP a read pending flag is
+   set in the modem status but nothing else occurs.  The UDP receive poller in
+   h316_udp.c watches all the links at once and activates the modem's unit as
+   soon as a packet arrives.  If a read operation is pending then the read
+   completes that moment and the interrupt request is asserted.  Packets are
+   taken regardless of whether a read is pending and if data arrives without a
+   read then it's discarded.  That's exactly what a real modem would do.
 
    ERROR HANDLING
 
@@ -142,7 +142,7 @@
 
    Modem state is maintained in the following variables -
 
-        RXPOLL  24      receiver polling interval
+        RXPOLL  24      receiver polling interval while packets are flowing
         RXPEND   1      an input operation is pending
         RXERR    1      receiver error flag
         RXIEN    1      receiver interrupt enable
@@ -641,11 +641,10 @@ int32 mi_io (uint16 line, int32 inst, int32 fnc, int32 dat, int32 dev)
 t_stat mi_rx_service (UNIT *uptr)
 {
   //   This is the standard simh "service" routine that's called when an event
-  // queue entry expires.  It just polls the receiver and reschedules itself.
-  // That's it!
+  // queue entry expires.  The UDP poller activates it whenever a packet has
+  // arrived for this line, so it just takes the packet.  That's it!
   uint16 line = uptr->mline;
   mi_poll_rx(line);
-  sim_activate(uptr, uptr->wait);
   return SCPE_OK;
 }
 
@@ -120,6 +120,20 @@
         udp_send        send an IMP message to the other end
         udp_receive     receive (w/o blocking!) a message if available
 
+   RECEIVE POLLING
+
+   The modem and host interfaces don't poll their own links.  A single
+   internal unit (INT-UDP) reads all the links at once - one tmxr_poll_rx()
+   asks the host, through the tmxr readiness set, which sockets have a
+   datagram waiting and leaves at most one packet in each line's buffer.  The
+   MI or HI unit that owns a link with a new packet is then activated to take
+   it.  While packets are flowing the poller runs as often as the fastest
+   attached unit's polling interval, so the IMP sees the same receive latency
+   it always did.  After UDP_POLL_LINGER polls without a packet it falls back
+   to once every UDP_POLL_IDLE microseconds, so an idle IMP hardly costs any
+   host time at all.  Sending a packet puts it right back on the fast rate,
+   since an answer is usually on the way.
+
    Note that each connection is assigned a unique "handle", a small integer,
    which is used as an index into our internal connection data table.  There
    is a limit on the maximum number of connections available, as set my the
@@ -135,6 +149,8 @@
 
 // Local constants ...
 #define MAXLINKS        10      // maximum number of simultaneous connections
+#define UDP_POLL_LINGER 1000    // empty polls before the poller slows down
+#define UDP_POLL_IDLE   1000    // idle polling interval (microseconds)
 // UDP connection data structure ...
 //   One of these blocks is allocated for every simulated modem link. 
 struct _UDP_LINK {
@@ -144,6 +160,8 @@ struct _UDP_LINK {
   uint32  rxsequence;           // next message sequence number for receive
   uint32  txsequence;           // next message sequence number for transmit
   DEVICE  *dptr;                // Device associated with link
+  UNIT    *uptr;                // Unit to activate when a packet arrives
+  int32   rxcnt;                // line receive count at the last poll
 };
 typedef struct _UDP_LINK UDP_LINK;
 
@@ -171,6 +189,20 @@ typedef struct _UDP_PACKET UDP_PACKET;
 UDP_LINK udp_links[MAXLINKS] = { {0} };         // data for every active connection
 TMLN udp_lines[MAXLINKS] = { {0} };             // line descriptors
 TMXR udp_tmxr = { MAXLINKS, NULL, 0, udp_lines};// datagram mux
+uint32 udp_quiet_polls = UDP_POLL_LINGER;       // polls since a packet arrived
+
+t_stat udp_poll_service (UNIT *uptr);
+t_stat udp_poll_reset (DEVICE *dptr);
+const char *udp_poll_description (DEVICE *dptr) {return "IMP UDP receive poller";}
+UNIT udp_poll_unit = { UDATA (&udp_poll_service, 0, 0) };
+DEVICE udp_poll_dev = {
+  "INT-UDP", &udp_poll_unit, NULL, NULL,
+  1, 0, 0, 0, 0, 0,
+  NULL, NULL, &udp_poll_reset, NULL, NULL, NULL,
+  NULL, DEV_NOSAVE, 0,
+  NULL, NULL, NULL, NULL, NULL, NULL,
+  &udp_poll_description
+};
 
 int32 udp_find_free_link (void)
 {
@@ -268,10 +300,15 @@ t_stat udp_create (DEVICE *dptr, const char *premote, int32 *pln)
   // All done - mark the TCP_LINK data as "used" and return the index.
   udp_links[link].used = TRUE;  *pln = link;
   udp_lines[link].dptr = udp_links[link].dptr = dptr;      // save device
+  udp_links[link].uptr = dptr->units;
+  udp_lines[link].rcve = TRUE;          // the poller reads every link
   udp_tmxr.uptr = dptr->units;
   udp_tmxr.last_poll_time = 1;          // h316's use of TMXR doesn't poll periodically for connects
   (void)tmxr_poll_conn (&udp_tmxr);     // force connection initialization now
   udp_tmxr.last_poll_time = 1;          // h316's use of TMXR doesn't poll periodically for connects
+  udp_links[link].rxcnt = udp_lines[link].rxcnt;
+  sim_register_internal_device (&udp_poll_dev);
+  udp_poll_reset (&udp_poll_dev);       // and start polling
   sim_debug(IMP_DBG_UDP, dptr, "link %d - listening on port %s and sending to %s\n", link, udp_links[link].lport, udp_links[link].rhostport);
   return SCPE_OK;
 }
@@ -320,6 +357,13 @@ t_stat udp_send (DEVICE *dptr, int32 link, uint16 *pdata, uint16 count)
   iret = tmxr_put_packet_ln (&udp_lines[link], (const uint8 *)&pkt, (size_t)pktlen);
   if (iret != SCPE_OK) return sim_messagef(iret, "UDP%d - tmxr_put_packet_ln() failed with error %s\n", link, sim_error_text(iret));
   sim_debug(IMP_DBG_UDP, dptr, "link %d - packet sent (sequence=%d, length=%d)\n", link, ntohl(pkt.sequence), ntohs(pkt.count));
+
+  //   If the poller has gone idle, wake it up - the other end is likely to
+  // answer this one soon.
+  if (udp_quiet_polls >= UDP_POLL_LINGER) {
+    udp_quiet_polls = 0;
+    sim_activate_abs (&udp_poll_unit, udp_links[link].uptr->wait);
+  }
   return SCPE_OK;
 }
 
@@ -347,10 +391,11 @@ int32 udp_receive_packet (int32 link, UDP_PACKET *ppkt)
   const uint8 *pbuf;
   t_stat ret;
 
-  udp_lines[link].rcve = TRUE;          // Enable receiver
-  tmxr_poll_rx (&udp_tmxr);
+  //   The poller usually has the packet waiting in the line buffer already;
+  // only go to the host for one if it doesn't.
+  if (tmxr_rqln (&udp_lines[link]) == 0)
+    tmxr_poll_rx (&udp_tmxr);
   ret = tmxr_get_packet_ln (&udp_lines[link], &pbuf, &pktsiz);
-  udp_lines[link].rcve = FALSE;          // Disable receiver
   if (ret != SCPE_OK) {
     sim_messagef (ret, "UDP%d - tmxr_get_packet_ln() failed with error %s\n", link, sim_error_text(ret));
     return NOLINK;
@@ -448,4 +493,53 @@ int32 udp_receive (DEVICE *dptr, int32 link, uint16 *pdata, uint16 maxbuf)
   return pktlen;
 }
 
+t_stat udp_poll_service (UNIT *uptr)
+{
+  //   This is the service routine for the receive poller (see RECEIVE POLLING
+  // above).  One tmxr_poll_rx() reads a waiting datagram, if any, into the
+  // buffer of every link and then the unit of each link that received one is
+  // activated to take it.  A line's receive count changes whenever data is
+  // read into its buffer, so that's what tells us something new is there.
+  int32 i, interval = 0;  t_bool busy = FALSE;
+
+  tmxr_poll_rx (&udp_tmxr);
+  for (i = 0;  i < MAXLINKS;  ++i) {
+    if (!udp_links[i].used) continue;
+    if ((interval == 0) || (udp_links[i].uptr->wait < interval))
+      interval = udp_links[i].uptr->wait;
+    if (udp_lines[i].rxcnt != udp_links[i].rxcnt) {
+      udp_links[i].rxcnt = udp_lines[i].rxcnt;
+      sim_activate_abs (udp_links[i].uptr, 0);
+      busy = TRUE;
+    }
+  }
+  if (interval == 0) return SCPE_OK;    // no links left - stop polling
+
+  if (busy)
+    udp_quiet_polls = 0;
+  else if (udp_quiet_polls < UDP_POLL_LINGER)
+    udp_quiet_polls++;
+  if (udp_quiet_polls < UDP_POLL_LINGER)
+    sim_activate (uptr, interval);
+  else
+    sim_activate_after (uptr, UDP_POLL_IDLE);
+  return SCPE_OK;
+}
+
+t_stat udp_poll_reset (DEVICE *dptr)
+{
+  //   Restart the poller if any links are open.  RESET and BOOT flush the
+  // event queue, and the MI and HI devices restart themselves the same way.
+  int32 i;
+  sim_cancel (&udp_poll_unit);
+  udp_quiet_polls = 0;
+  for (i = 0;  i < MAXLINKS;  ++i) {
+    if (udp_links[i].used) {
+      sim_activate (&udp_poll_unit, udp_links[i].uptr->wait);
+      break;
+    }
+  }
+  return SCPE_OK;
+}
+
 #endif // ifdef VM_IMPTIP
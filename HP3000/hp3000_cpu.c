@@ -2246,7 +2246,7 @@ return;
     1. SR must be less than 4 on entry, so that TR [SR] is the first unused TOS
        register.
 
-    2. SM and SR must not be modified within the call to cpu_read_memory.  For
+    2. SM and SR must not be modified within the call to cpu_read_stack.  For
        example, SR++ cannot be passed as a parameter.
 */
 
@@ -2256,7 +2256,7 @@ if (SM <= DB && NPRV)                                   /* if SM isn't above DB
     MICRO_ABORT (trap_Stack_Underflow);                 /*   then trap with a Stack Underflow */
 
 else {                                                  /* otherwise */
-    cpu_read_memory (stack, SM, &TR [SR]);              /*   read the value from memory into a TOS register */
+    cpu_read_stack (SM, &TR [SR]);                      /*   read the value from memory into a TOS register */
 
     SM = SM - 1 & R_MASK;                               /* decrement the stack memory register */
     SR = SR + 1;                                        /*   and increment the register-in-use count */
@@ -2284,7 +2284,7 @@ return;
     1. SR must be greater than 0 on entry, so that TR [SR - 1] is the last TOS
        register in use.
 
-    2. SM and SR must not be modified within the call to cpu_write_memory.  For
+    2. SM and SR must not be modified within the call to cpu_write_stack.  For
        example, SR-- cannot be passed as a parameter.
 */
 
@@ -2296,7 +2296,7 @@ if (SM >= Z)                                            /* if SM isn't below Z *
 SM = SM + 1 & R_MASK;                                   /* increment the stack memory register */
 SR = SR - 1;                                            /*   and decrement the register-in-use count */
 
-cpu_write_memory (stack, SM, TR [SR]);                  /* write the value from a TOS register to memory */
+cpu_write_stack (SM, TR [SR]);                          /* write the value from a TOS register to memory */
 
 return;
 }
@@ -2318,7 +2318,7 @@ while (SR > 0) {                                        /* while one or more reg
     SM = SM + 1 & R_MASK;                               /*   increment the stack memory register */
     SR = SR - 1;                                        /*     and decrement the register-in-use count */
 
-    cpu_write_memory (stack, SM, TR [SR]);              /* write the value from a TOS register to memory */
+    cpu_write_stack (SM, TR [SR]);                      /* write the value from a TOS register to memory */
     }
 
 return;
@@ -2340,7 +2340,7 @@ return;
     1. SR must be greater than 0 on entry, so that TR [SR - 1] is the last TOS
        register in use.
 
-    2. SM and SR must not be modified within the call to cpu_read_memory.  For
+    2. SM and SR must not be modified within the call to cpu_read_stack.  For
        example, SR++ cannot be passed as a parameter.
 
     3. The cpu_queue_up routine isn't used, as that routine checks for a stack
@@ -2350,7 +2350,7 @@ return;
 void cpu_adjust_sr (uint32 target)
 {
 do {
-    cpu_read_memory (stack, SM, &TR [SR]);              /* read the value from memory into a TOS register */
+    cpu_read_stack (SM, &TR [SR]);                      /* read the value from memory into a TOS register */
 
     SM = SM - 1 & R_MASK;                               /* decrement the stack memory register */
     SR = SR + 1;                                        /*   and increment the register-in-use count */
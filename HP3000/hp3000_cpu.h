@@ -117,6 +117,9 @@
 #define cpu_read_memory(c,o,v)      mem_read  (&cpu_dev, c, o, v)
 #define cpu_write_memory(c,o,v)     mem_write (&cpu_dev, c, o, v)
 
+#define cpu_read_stack(o,v)         mem_read_stack  (&cpu_dev, o, v)
+#define cpu_write_stack(o,v)        mem_write_stack (&cpu_dev, o, v)
+
 
 
 /* System power state.
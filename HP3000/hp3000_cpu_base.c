@@ -2604,7 +2604,13 @@ return SCPE_OK;                                         /*   and return the succ
        for each byte moved.  This is inefficient -- each word is read and
        updated twice -- but it is necessary, as interrupts are checked after
        each byte is moved, and it is how the microcode handles these
-       instructions.
+       instructions.  However, as the MVB and CMPB ranges are bounds-checked
+       before the loop begins, the source word (and the target word for CMPB)
+       is held between bytes and read only when the byte address crosses into
+       the next word.  An MVB target write that lands in the held source word
+       updates the held copy, so overlapping "propagating" moves still see each
+       byte as it is stored.  The buffered words do not survive an interrupt
+       exit, so a resumed instruction rereads them from memory.
 
     5. The MVBW instruction microcode performs bounds checks on the movement by
        determining the number of words from the source and target starting
@@ -2650,7 +2656,8 @@ HP_WORD      operand, bank, offset, base;
 HP_WORD      byte, test_byte, terminal_byte, increment, byte_class, loop_condition;
 HP_WORD      source_bank, source, source_end, target_bank, target, target_end;
 HP_WORD      stack_db, ics_q, delta_qi, disp_counter, delta_q, new_q, new_sm, device;
-t_bool       q_is_qi, disp_active;
+HP_WORD      source_word, target_word;
+t_bool       q_is_qi, disp_active, source_valid, target_valid;
 ACCESS_CLASS class;
 t_stat       status = SCPE_OK;
 
@@ -2740,16 +2747,23 @@ switch (operation) {                                    /* dispatch the move or
 
             target = cpu_byte_ea (data_checked, RC, RA);    /* convert the target byte address and check the bounds */
 
+            source_valid = FALSE;                           /* the source word has not been read yet */
+
             while (RA != 0) {                               /* while there are bytes to move */
-                cpu_read_memory (class, source, &operand);  /*   read a source word */
+                if (! source_valid) {                               /* if the source word is not buffered */
+                    cpu_read_memory (class, source, &source_word);  /*   then read a source word */
+                    source_valid = TRUE;                            /*     and mark it as buffered */
+                    }
 
                 if (RB & 1)                                 /* if the byte address is odd */
-                    byte = LOWER_BYTE (operand);            /*   then get the lower byte */
+                    byte = LOWER_BYTE (source_word);        /*   then get the lower byte */
                 else                                        /* otherwise the address is even */
-                    byte = UPPER_BYTE (operand);            /*   so get the upper byte */
+                    byte = UPPER_BYTE (source_word);        /*   so get the upper byte */
 
-                if ((RB & 1) == (HP_WORD) (increment == 1)) /* if the last byte of the source word was accessed */
-                    source = source + increment & LA_MASK;  /*   then update the word address */
+                if ((RB & 1) == (HP_WORD) (increment == 1)) {   /* if the last byte of the source word was accessed */
+                    source = source + increment & LA_MASK;      /*   then update the word address */
+                    source_valid = FALSE;                       /*     and read the next word on the next byte */
+                    }
 
                 cpu_read_memory (data, target, &operand);   /* read the target word */
 
@@ -2760,6 +2774,9 @@ switch (operation) {                                    /* dispatch the move or
 
                 cpu_write_memory (data, target, operand);   /* write the word back */
 
+                if (class == data && target == source)      /* if the move overlaps the buffered source word */
+                    source_word = operand;                  /*   then keep the buffer in step with memory */
+
                 if ((RC & 1) == (HP_WORD) (increment == 1)) /* if the last byte of the target word was accessed */
                     target = target + increment & LA_MASK;  /*   then update the word address */
 
@@ -3036,29 +3053,42 @@ switch (operation) {                                    /* dispatch the move or
 
             target = cpu_byte_ea (data_checked, RC, RA);    /* convert the target byte address and check the bounds */
 
+            source_valid = FALSE;                           /* neither the source word */
+            target_valid = FALSE;                           /*   nor the target word has been read yet */
+
             while (RA != 0) {                               /* while there are bytes to compare */
-                cpu_read_memory (class, source, &operand);  /*   read a source word */
+                if (! source_valid) {                               /* if the source word is not buffered */
+                    cpu_read_memory (class, source, &source_word);  /*   then read a source word */
+                    source_valid = TRUE;                            /*     and mark it as buffered */
+                    }
 
                 if (RB & 1)                                 /* if the byte address is odd */
-                    byte = LOWER_BYTE (operand);            /*   then get the lower byte */
+                    byte = LOWER_BYTE (source_word);        /*   then get the lower byte */
                 else                                        /* otherwise the address is even */
-                    byte = UPPER_BYTE (operand);            /*   so get the upper byte */
+                    byte = UPPER_BYTE (source_word);        /*   so get the upper byte */
 
-                if ((RB & 1) == (HP_WORD) (increment == 1)) /* if the last byte of the source word was accessed */
-                    source = source + increment & LA_MASK;  /*   then update the word address */
+                if ((RB & 1) == (HP_WORD) (increment == 1)) {   /* if the last byte of the source word was accessed */
+                    source = source + increment & LA_MASK;      /*   then update the word address */
+                    source_valid = FALSE;                       /*     and read the next word on the next byte */
+                    }
 
-                cpu_read_memory (data, target, &operand);   /* read the target word */
+                if (! target_valid) {                               /* if the target word is not buffered */
+                    cpu_read_memory (data, target, &target_word);   /*   then read the target word */
+                    target_valid = TRUE;                            /*     and mark it as buffered */
+                    }
 
                 if (RC & 1)                                 /* if the byte address is odd */
-                    test_byte = LOWER_BYTE (operand);       /*   then get the lower byte */
+                    test_byte = LOWER_BYTE (target_word);   /*   then get the lower byte */
                 else                                        /* otherwise the address is even */
-                    test_byte = UPPER_BYTE (operand);       /*   so get the upper byte */
+                    test_byte = UPPER_BYTE (target_word);   /*   so get the upper byte */
 
                 if (test_byte != byte)                      /* if the bytes do not compare */
                     break;                                  /*   then terminate the loop */
 
-                if ((RC & 1) == (HP_WORD) (increment == 1)) /* if the last byte of the target word was accessed */
-                    target = target + increment & LA_MASK;  /*   then update the word address */
+                if ((RC & 1) == (HP_WORD) (increment == 1)) {   /* if the last byte of the target word was accessed */
+                    target = target + increment & LA_MASK;      /*   then update the word address */
+                    target_valid = FALSE;                       /*     and read the next word on the next byte */
+                    }
 
                 RA = RA - increment & R_MASK;               /* update the count */
                 RB = RB + increment & R_MASK;               /*   and the source */
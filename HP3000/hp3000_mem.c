@@ -578,6 +578,57 @@ else {                                                  /* otherwise the access
 }
 
 
+/* Read or write a word at the top of the memory stack.
+
+   These routines are streamlined versions of "mem_read" and "mem_write" for the
+   "stack" access classification.  They are called by the TOS register queue
+   routines to move words between the register file and the memory stack.  The
+   offset supplied is always the SM value, which never lies within the TOS
+   registers, so the TOS and classification checks are unnecessary and the
+   access goes directly to memory in the stack bank.  As with the general
+   routines, an access outside of physical memory sets the Illegal Address
+   interrupt for CPU accesses and returns FALSE.
+*/
+
+t_bool mem_read_stack (DEVICE *dptr, uint32 offset, HP_WORD *value)
+{
+const uint32 address = TO_PA (SBANK, offset);          /* form the physical address in the stack bank */
+
+if (address >= MEMSIZE) {                               /* if this access is beyond the memory size */
+    if (dptr == &cpu_dev)                               /*   then if an interrupt is requested */
+        CPX1 |= cpx1_ILLADDR;                           /*     then set the Illegal Address interrupt */
+
+    *value = 0;                                         /* return a zero value */
+    return FALSE;                                       /*   and indicate failure to the caller */
+    }
+
+*value = (HP_WORD) M [address];                         /* the value comes from memory */
+
+dpprintf (dptr, DEB_MDATA, BOV_FORMAT "  stack read\n", SBANK, offset, *value);
+
+return TRUE;                                            /* indicate success with the returned value stored */
+}
+
+
+t_bool mem_write_stack (DEVICE *dptr, uint32 offset, HP_WORD value)
+{
+const uint32 address = TO_PA (SBANK, offset);          /* form the physical address in the stack bank */
+
+if (address >= MEMSIZE) {                               /* if this access is beyond the memory size */
+    if (dptr == &cpu_dev)                               /*   then if an interrupt is requested */
+        CPX1 |= cpx1_ILLADDR;                           /*     then set the Illegal Address interrupt */
+
+    return FALSE;                                       /* indicate failure to the caller */
+    }
+
+M [address] = (MEMORY_WORD) value;                      /* write the value to memory */
+
+dpprintf (dptr, DEB_MDATA, BOV_FORMAT "  stack write\n", SBANK, offset, value);
+
+return TRUE;                                            /* indicate success with the value written */
+}
+
+
 /* Initialize a byte accessor.
 
    The supplied byte accessor structure is initialized for the starting relative
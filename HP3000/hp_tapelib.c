@@ -752,8 +752,16 @@ static const char *const unit_names [] = {      /* unit names, in unit number or
    whether the call may have read or written an erase gap in the tape image
    file and whether the call returned a valid data length value.  These are used
    to interpret the tape positional change as a result of the call to separate
-   the gap length from the data record length.  The table also contains strings
-   describing the call actions that are used when tracing library calls.
+   the gap length from the data record length.  The table also indicates
+   whether the call is made asynchronously, and it contains strings describing
+   the call actions that are used when tracing library calls.
+
+   Record reads, writes, and spacing are issued with the asynchronous library
+   entry points, so that host I/O overlaps simulated execution when the
+   simulator is built with asynchronous I/O support.  Gap and tape mark writes
+   are short and are only done in paths that would need additional reentry
+   handling, and a rewind does no host I/O, so these calls are made
+   synchronously.
 */
 
 typedef enum {
@@ -771,25 +779,43 @@ typedef enum {
 typedef struct {
     t_bool      gap_is_valid;                   /* call may involve an erase gap */
     t_bool      data_is_valid;                  /* call may involve a data record */
+    t_bool      is_async;                       /* call is made asynchronously */
     const char  *action;                        /* string describing the call action */
     } TAPELIB_PROPERTIES;
 
 
 static const TAPELIB_PROPERTIES lib_props [] = {    /* indexed by TAPELIB_CALL */
-/*     gap   data                     */
-/*    valid  valid        action      */
-/*    -----  -----  ----------------- */
-    {   T,     T,   "forward space"   },        /* lib_space_fwd */
-    {   T,     T,   "backspace"       },        /* lib_space_rev */
-    {   T,     T,   "read"            },        /* lib_read_fwd  */
-    {   T,     T,   "reverse read"    },        /* lib_read_rev  */
-    {   F,     T,   "write"           },        /* lib_write     */
-    {   T,     F,   "write gap"       },        /* lib_write_gap */
-    {   F,     F,   "write tape mark" },        /* lib_write_tmk */
-    {   T,     F,   "rewind"          },        /* lib_rewind    */
+/*     gap   data                            */
+/*    valid  valid  async        action      */
+/*    -----  -----  -----  ----------------- */
+    {   T,     T,     T,   "forward space"   },     /* lib_space_fwd */
+    {   T,     T,     T,   "backspace"       },     /* lib_space_rev */
+    {   T,     T,     T,   "read"            },     /* lib_read_fwd  */
+    {   T,     T,     T,   "reverse read"    },     /* lib_read_rev  */
+    {   F,     T,     T,   "write"           },     /* lib_write     */
+    {   T,     F,     F,   "write gap"       },     /* lib_write_gap */
+    {   F,     F,     F,   "write tape mark" },     /* lib_write_tmk */
+    {   T,     F,     F,   "rewind"          },     /* lib_rewind    */
     };
 
 
+/* Support library call states.
+
+   A unit's CALL_STATE field tracks a support library call from issue to
+   completion.  An asynchronous call is pending until the completion routine
+   is invoked with the call status, which is held in the unit's CALL_STATUS
+   field until the command phase that issued the call is reentered.  A
+   synchronous call, or an asynchronous call made when asynchronous I/O is not
+   available, completes before the issuing routine returns.
+*/
+
+typedef enum {
+    Call_Idle,                                  /* no call is outstanding */
+    Call_Pending,                               /* the call is executing in the I/O thread */
+    Call_Complete                               /* the call has completed */
+    } CALL_STATE_TYPE;
+
+
 /* Simulator tape support library status values */
 
 static const char *status_name [] = {           /* indexed by MTSE value */
@@ -815,6 +841,8 @@ static CNTLR_IFN_IBUS continue_command (CVPTR cvptr, UNIT *uptr, CNTLR_FLAG_SET
 static CNTLR_IFN_IBUS end_command      (CVPTR cvptr, UNIT *uptr);
 static CNTLR_IFN_IBUS poll_drives      (CVPTR cvptr);
 static CNTLR_IFN_IBUS call_tapelib     (CVPTR cvptr, UNIT *uptr, TAPELIB_CALL lib_call, t_mtrlnt parameter);
+static void           call_complete    (UNIT *uptr, t_stat status);
+static void           wait_for_call    (UNIT *uptr);
 static CNTLR_IFN_IBUS abort_command    (CVPTR cvptr, UNIT *uptr, t_stat status);
 static void           reject_command   (CVPTR cvptr, UNIT *uptr);
 static void           add_crcc_lrcc    (CVPTR cvptr, CNTLR_OPCODE opcode);
@@ -1064,6 +1092,7 @@ for (unit = 0; unit < cvptr->device->numunits; unit++) {    /* reset all of the
     sim_tape_reset (uptr);                                  /* reset the tape support library status */
     sim_cancel (uptr);                                      /*   and cancel any in-process operation */
     uptr->wait = NO_EVENT;                                  /*     and any scheduled operation */
+    uptr->CALL_STATE = Call_Idle;                           /*       and discard any library call result */
 
     uptr->PHASE = Idle_Phase;                               /* idle the unit */
     uptr->OPCODE = Invalid_Opcode;                          /*   and clear the opcode */
@@ -1124,7 +1153,11 @@ return SCPE_OK;
        In simulation, the record is written with the "bad data" indicator.
 
     4. The only unit that may be in a non-idle phase without being active is the
-       controller unit.
+       controller unit, or a drive unit waiting for an asynchronous library call
+       to complete.  The call is allowed to finish before the unit is examined,
+       so that its completion event is not delivered after the clear.  If the
+       stop phase write of a partial record is itself made asynchronously, it is
+       also waited for and completed here.
 */
 
 void tl_clear (CVPTR cvptr)
@@ -1138,6 +1171,11 @@ t_mtrlnt marker;
 for (unit = 0; unit < cvptr->device->numunits; unit++) {    /* look for a write or gap traverse in progress */
     uptr = cvptr->device->units + unit;                     /* get a pointer to the unit */
 
+    if (uptr->CALL_STATE != Call_Idle) {                    /* if a library call is outstanding */
+        wait_for_call (uptr);                               /*   then let it finish */
+        uptr->CALL_STATE = Call_Idle;                       /*     and abandon the command that issued it */
+        }
+
     remaining_time = sim_activate_time (uptr);              /* get the remaining unit delay time, if any */
 
     if (remaining_time) {                                   /* if the unit is currently active */
@@ -1202,6 +1240,11 @@ for (unit = 0; unit < cvptr->device->numunits; unit++) {    /* look for a write
             uptr->PHASE = Stop_Phase;                           /* execute the stop phase of the command */
             continue_command (cvptr, uptr, NO_FLAGS, NO_DATA);  /*   to ensure a partial record is written */
 
+            if (uptr->CALL_STATE == Call_Pending) {                 /* if the write is executing asynchronously */
+                wait_for_call (uptr);                               /*   then wait for it */
+                continue_command (cvptr, uptr, NO_FLAGS, NO_DATA);  /*     and complete the stop phase */
+                }
+
             sim_tape_reset (uptr);                              /* reset the tape support library status */
             }
         }
@@ -1337,13 +1380,20 @@ return result;                                          /* return the result of
    detached.  Unloading a tape leaves the drive offline.  A command in progress
    is allowed to continue to completion, unless it attempts to access the file.
    If it does, the command will abort and simulation will stop with a "Unit not
-   attached" error message.
+   attached" error message.  An outstanding asynchronous library call is
+   allowed to finish before the file is detached, and the unit is rescheduled
+   so that the command continues with the call status.
 */
 
 t_stat tl_detach (UNIT *uptr)
 {
 uptr->flags &= ~UNIT_OFFLINE;                           /* set the unit offline */
 
+if (uptr->CALL_STATE == Call_Pending) {                 /* if a library call is outstanding */
+    wait_for_call (uptr);                               /*   then let it finish */
+    sim_activate (uptr, 0);                             /*     and resume the command */
+    }
+
 return sim_tape_detach (uptr);                          /* detach the tape image file from the unit */
 }
 
@@ -2096,12 +2146,14 @@ switch (phase) {                                        /* dispatch the phase */
 
 
     case Start_Phase:
-        dpprintf (cvptr->device, TL_DEB_INCO, "Unit %d %s started at position %" T_ADDR_FMT "u\n",
-                  unit, opcode_names [opcode], uptr->pos);
-
         pptr = &drive_props [PROP_INDEX (uptr)];        /* get the drive property pointer */
 
-        cvptr->initial_position = uptr->pos;            /* save the initial tape position */
+        if (uptr->CALL_STATE == Call_Idle) {            /* if the phase is not being reentered on call completion */
+            dpprintf (cvptr->device, TL_DEB_INCO, "Unit %d %s started at position %" T_ADDR_FMT "u\n",
+                      unit, opcode_names [opcode], uptr->pos);
+
+            cvptr->initial_position = uptr->pos;        /*   then save the initial tape position */
+            }
 
         switch (opcode) {                               /* dispatch the current operation */
 
@@ -2592,7 +2644,8 @@ switch (phase) {                                        /* dispatch the phase */
         if (cvptr->call_status == MTSE_RECE)            /* a bad data record */
             cvptr->state = Error_State;                 /*   is now treated as an error */
 
-        if (uptr->PHASE == Stop_Phase) {                /* if the stop completed normally */
+        if (uptr->PHASE == Stop_Phase                   /* if the stop completed normally */
+          && uptr->CALL_STATE == Call_Idle) {           /*   and the write is not still in progress */
             outbound |= end_command (cvptr, uptr);      /*   then terminate the command */
             complete = TRUE;                            /*     and mark it as complete */
             }
@@ -2725,6 +2778,16 @@ return NO_ACTION;                                       /* no drives are request
    occurred, and the rest of the phase processing should be bypassed, as the
    phase and timing have been set appropriately by this routine.
 
+   Calls designated as asynchronous in the library properties table are issued
+   with the asynchronous library entry points.  If the call is still executing
+   when the entry point returns, the unit's call state is left pending, the
+   unit is not scheduled, and the SCPE function is returned with SCPE_OK
+   status, so that the caller bypasses the rest of its phase processing.  When
+   the call completes, the library schedules the unit, and the unit service
+   reenters the same phase, which calls this routine again with the same
+   parameters.  The saved call status is then processed as though the call had
+   just returned.
+
 
    Implementation notes:
 
@@ -2782,6 +2845,17 @@ return NO_ACTION;                                       /* no drives are request
        allows the current command to complete normally before Unit Ready is
        denied.  Taking a unit offline with the DETACH <unit> command causes a
        "Unit not attached" simulator stop.
+
+   11. The asynchronous library entry points return an internal error without
+       invoking the completion routine if the unit is not attached.  To obtain
+       the same MTSE_UNATT status that the synchronous entry points return, the
+       attachment is checked before the call is issued.
+
+   12. The buffer and record length passed to an asynchronous call are part of
+       the controller state, so they remain valid while the call executes.  A
+       controller has only one buffer, so it can have only one call outstanding
+       at a time, and a pending call must finish before its controller is
+       cleared or its unit is detached.
 */
 
 static CNTLR_IFN_IBUS call_tapelib (CVPTR cvptr, UNIT *uptr, TAPELIB_CALL lib_call, t_mtrlnt parameter)
@@ -2791,47 +2865,64 @@ int32          unit;
 uint32         gap_inches, gap_tenths;
 CNTLR_IFN_IBUS result = (CNTLR_IFN_IBUS) NO_FUNCTIONS;  /* the expected case */
 
-switch (lib_call) {                                     /* dispatch to the selected routine */
+if (uptr->CALL_STATE == Call_Idle) {                    /* if the call has not been issued yet */
+    uptr->CALL_STATE = Call_Pending;                    /*   then it is now outstanding */
 
-    case lib_space_fwd:                                 /* space record forward */
-        cvptr->call_status = sim_tape_sprecf (uptr, &cvptr->length);
-        break;
+    if ((uptr->flags & UNIT_ATT) == 0                   /* if the unit is not attached */
+      && lib_props [lib_call].is_async)                 /*   and the call would be made asynchronously */
+        call_complete (uptr, MTSE_UNATT);               /*     then fail it here (see note 11) */
 
-    case lib_space_rev:                                 /* space record reverse */
-        cvptr->call_status = sim_tape_sprecr (uptr, &cvptr->length);
-        break;
+    else switch (lib_call) {                            /* otherwise dispatch to the selected routine */
 
-    case lib_read_fwd:                                  /* read record forward */
-        cvptr->call_status = sim_tape_rdrecf (uptr, cvptr->buffer,
-                                              &cvptr->length, parameter);
-        break;
+        case lib_space_fwd:                             /* space record forward */
+            sim_tape_sprecf_a (uptr, &cvptr->length, call_complete);
+            break;
 
-    case lib_read_rev:                                  /* read record reverse */
-        cvptr->call_status = sim_tape_rdrecr (uptr, cvptr->buffer,
-                                              &cvptr->length, parameter);
-        break;
+        case lib_space_rev:                             /* space record reverse */
+            sim_tape_sprecr_a (uptr, &cvptr->length, call_complete);
+            break;
 
-    case lib_write:                                     /* write record forward */
-        cvptr->call_status = sim_tape_wrrecf (uptr, cvptr->buffer,
-                                              parameter | cvptr->length);
+        case lib_read_fwd:                              /* read record forward */
+            sim_tape_rdrecf_a (uptr, cvptr->buffer, &cvptr->length,
+                               parameter, call_complete);
+            break;
 
-        if (parameter && cvptr->call_status == MTSE_OK) /* if the record is bad and the write succeeded */
-            cvptr->call_status = MTSE_RECE;             /*   then report a read-after-write failure */
-        break;
+        case lib_read_rev:                              /* read record reverse */
+            sim_tape_rdrecr_a (uptr, cvptr->buffer, &cvptr->length,
+                               parameter, call_complete);
+            break;
 
-    case lib_write_gap:                                 /* write erase gap */
-        cvptr->call_status = sim_tape_wrgap (uptr, (uint32) parameter);
-        break;
+        case lib_write:                                 /* write record forward */
+            sim_tape_wrrecf_a (uptr, cvptr->buffer,
+                               parameter | cvptr->length, call_complete);
+            break;
 
-    case lib_write_tmk:                                 /* write tape mark */
-        cvptr->call_status = sim_tape_wrtmk (uptr);
-        break;
+        case lib_write_gap:                             /* write erase gap */
+            call_complete (uptr, sim_tape_wrgap (uptr, (uint32) parameter));
+            break;
 
-    case lib_rewind:                                    /* rewind tape */
-        cvptr->call_status = sim_tape_rewind (uptr);
-        break;
+        case lib_write_tmk:                             /* write tape mark */
+            call_complete (uptr, sim_tape_wrtmk (uptr));
+            break;
+
+        case lib_rewind:                                /* rewind tape */
+            call_complete (uptr, sim_tape_rewind (uptr));
+            break;
+        }
+
+    if (uptr->CALL_STATE == Call_Pending) {             /* if the call is executing asynchronously */
+        uptr->wait = NO_EVENT;                          /*   then the library will schedule the unit */
+        return SCP_STATUS (SCPE_OK);                    /*     when it completes */
+        }
     }
 
+cvptr->call_status = uptr->CALL_STATUS;                 /* get the call completion status */
+uptr->CALL_STATE = Call_Idle;                           /*   and idle the call */
+
+if (lib_call == lib_write                               /* if the write is of a bad record */
+  && parameter && cvptr->call_status == MTSE_OK)        /*   and it succeeded */
+    cvptr->call_status = MTSE_RECE;                     /*     then report a read-after-write failure */
+
 
 if (cvptr->initial_position < uptr->pos)                                /* calculate the preliminary gap size */
     cvptr->gaplen = (t_mtrlnt) (uptr->pos - cvptr->initial_position);   /*   for either forward motion */
@@ -3141,6 +3232,42 @@ return;
 /* Tape library local utility routines */
 
 
+/* Complete a support library call.
+
+   This routine is called by the simulator tape support library when the call
+   issued for the unit specified by "uptr" completes.  The call "status" is
+   saved, and the call is marked as complete.  For a call executing
+   asynchronously, the routine is called on the simulation thread just before
+   the library schedules the unit for service.  For a synchronous call, it is
+   called before the library routine returns.
+*/
+
+static void call_complete (UNIT *uptr, t_stat status)
+{
+uptr->CALL_STATUS = (uint16) status;                    /* save the completion status */
+uptr->CALL_STATE = Call_Complete;                       /*   and indicate that the call has completed */
+
+return;
+}
+
+
+/* Wait for a support library call to complete.
+
+   An outstanding asynchronous call for the unit specified by "uptr" is allowed
+   to finish, and the unit service event that the library scheduled for its
+   completion is removed.  Cancelling the unit waits for the I/O thread and then
+   delivers the call status before removing the event, so the unit's call state
+   is complete on return.
+*/
+
+static void wait_for_call (UNIT *uptr)
+{
+sim_cancel (uptr);                                      /* wait for the call and cancel its completion event */
+
+return;
+}
+
+
 /* Activate the unit.
 
    The specified unit is activated using the unit's "wait" time.  If tracing
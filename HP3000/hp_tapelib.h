@@ -89,6 +89,8 @@ typedef uint8               TL_BUFFER;          /* a buffer containing 8-bit tap
 #define STATUS              u4                  /* drive status */
 #define OPCODE              u5                  /* drive current operation */
 #define PHASE               u6                  /* drive current operation phase */
+#define CALL_STATE          us9                 /* support library call state */
+#define CALL_STATUS         us10                /* support library call completion status */
 
 
 /* Device flags and accessors */
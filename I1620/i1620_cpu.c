@@ -199,6 +199,10 @@ t_stat mul_field (uint32 mpc, uint32 mpy);
 t_stat mul_one_digit (uint32 mpyd, uint32 mpcp, uint32 prop, uint32 last);
 t_stat div_field (uint32 dvd, uint32 dvr, int32 *ez);
 t_stat div_one_digit (uint32 dvd, uint32 dvr, uint32 max, uint32 *quod, uint32 *quop);
+t_bool std_tables (void);
+int32 get_fast_field (uint32 a, uint8 *dig, int32 max, uint32 lo, uint32 hi);
+t_bool mul_field_fast (uint32 mpc, uint32 mpy);
+t_bool div_field_fast (uint32 dvd, uint32 dvr, int32 *ez);
 t_stat oct_to_dec (uint32 tbl, uint32 s);
 t_stat dec_to_oct (uint32 d, uint32 tbl, int32 *ez);
 t_stat or_field (uint32 d, uint32 s);
@@ -1585,6 +1589,143 @@ if (res & DIGIT)                                        /* nz? clr ind */
 return res & DIGIT;
 }
 
+/* Fast multiply and divide
+
+   While the add and multiply tables in core are the standard ones, the
+   table driven digit loops below compute ordinary decimal arithmetic.
+   Multiply and divide then run on host integers instead, provided the
+   operands are short enough that the result stays inside the product
+   area and the operands do not overlap it.  Every other case (altered
+   tables, invalid digits, quotient overflow, long fields) falls back to
+   the digit serial emulation, which also produces the error stops.
+   Memory, flags and indicators are left exactly as the emulation would
+   leave them.
+*/
+
+t_bool std_tables (void)
+{
+if (memcmp (&M[MUL_TABLE], std_mul_table, MUL_TABLE_LEN) != 0)
+    return FALSE;
+if (((cpu_unit.flags & IF_MII) == 0) &&                 /* Model 1 adds by table */
+    (memcmp (&M[ADD_TABLE], std_add_table, ADD_TABLE_LEN) != 0))
+    return FALSE;
+return TRUE;
+}
+
+/* Get operand digits, low order first; the flag on the low order digit
+   is the sign, so a field is at least two digits.  Returns the length,
+   or -1 if the field is invalid, longer than max, or touches [lo,hi).
+*/
+
+int32 get_fast_field (uint32 a, uint8 *dig, int32 max, uint32 lo, uint32 hi)
+{
+int32 n;
+
+for (n = 0; n < max; n++) {
+    if ((a >= lo) && (a < hi))                          /* overlaps result? */
+        return -1;
+    dig[n] = M[a] & DIGIT;
+    if (BAD_DIGIT (dig[n]))                             /* bad? */
+        return -1;
+    if ((n != 0) && (M[a] & FLAG))                      /* flag ends field */
+        return n + 1;
+    MM (a);
+    }
+return -1;
+}
+
+t_bool mul_field_fast (uint32 mpc, uint32 mpy)
+{
+uint8 mpcd[PROD_AREA_LEN], mpyd[PROD_AREA_LEN];
+uint32 acc[PROD_AREA_LEN];
+uint32 sign, cry;
+int32 i, j, n, m;
+t_bool nz;
+
+if (!std_tables ())
+    return FALSE;
+n = get_fast_field (mpc, mpcd, PROD_AREA_LEN - 2, PROD_AREA, PROD_AREA_END);
+if (n < 0)
+    return FALSE;
+m = get_fast_field (mpy, mpyd, PROD_AREA_LEN - n, PROD_AREA, PROD_AREA_END);
+if (m < 0)
+    return FALSE;
+for (i = 0; i < PROD_AREA_LEN; i++)
+    acc[i] = 0;
+for (i = 0; i < n; i++) {                               /* partial products */
+    for (j = 0; j < m; j++)
+        acc[i + j] += mpcd[i] * mpyd[j];
+    }
+PR1 = 1;                                                /* step on PR1 */
+sign = (M[mpc] & FLAG) ^ (M[mpy] & FLAG);               /* get final sign */
+nz = FALSE;
+for (i = 0, cry = 0; i < PROD_AREA_LEN; i++) {          /* store product */
+    acc[i] += cry;
+    cry = acc[i] / 10;
+    M[PROD_AREA_END - 1 - i] = acc[i] % 10;
+    if (acc[i] % 10)
+        nz = TRUE;
+    }
+M[PROD_AREA_END - n - m] |= FLAG;                       /* flag high product */
+M[PROD_AREA_END - 1] |= sign;                           /* set final sign */
+ind[IN_HP] = (sign == 0) && nz;                         /* set indicators */
+ind[IN_EZ] = !nz;
+return TRUE;
+}
+
+/* The divide loop leaves the quotient digit in the position just above
+   each window of divisor length + 1 dividend digits, and the remainder
+   in the window; windows are limited to what fits in a t_uint64.
+*/
+
+t_bool div_field_fast (uint32 dvd, uint32 dvr, int32 *ez)
+{
+uint8 dvrd[17];
+uint8 dig[PROD_AREA_END];
+t_uint64 dv, w, q;
+uint32 a, lo, dvds, quos;
+int32 k, l;
+t_bool nz;
+
+if ((dvd >= PROD_AREA_END) || !std_tables ())
+    return FALSE;
+l = get_fast_field (dvr, dvrd, 17, 0, PROD_AREA_END);  /* len, clear of dvd? */
+if ((l < 0) || (dvd < (uint32) l))
+    return FALSE;
+lo = dvd - l;                                           /* high quotient digit */
+for (k = l - 1, dv = 0; k >= 0; k--)                    /* divisor value */
+    dv = (dv * 10) + dvrd[k];
+for (a = lo; a < PROD_AREA_END; a++) {                  /* copy dividend */
+    dig[a] = M[a] & DIGIT;
+    if (BAD_DIGIT (dig[a]))
+        return FALSE;
+    }
+for (a = dvd, nz = FALSE; a < PROD_AREA_END; a++) {     /* develop quotient */
+    for (k = l, w = 0; k >= 0; k--)                     /* window value */
+        w = (w * 10) + dig[a - k];
+    if (w >= (dv * 10))                                 /* overflow, dvr = 0? */
+        return FALSE;
+    q = w / dv;
+    w = w - (q * dv);                                   /* remainder */
+    for (k = 0; k < l; k++, w = w / 10)
+        dig[a - k] = (uint8) (w % 10);
+    dig[a - l] = (uint8) q;                             /* quotient digit */
+    if (q)
+        nz = TRUE;
+    }
+dvds = (M[PROD_AREA_END - 1]) & FLAG;                   /* dividend sign */
+quos = dvds ^ (M[dvr] & FLAG);                          /* quotient sign */
+for (a = lo; a < PROD_AREA_END; a++)                    /* store result */
+    M[a] = dig[a];
+M[lo] |= FLAG;                                          /* flag on quo */
+M[PROD_AREA_END - 1] |= dvds;                           /* remainder sign */
+M[PROD_AREA_END - 1 - l] |= quos;                       /* quotient sign */
+M[PROD_AREA_END - l] |= FLAG;                           /* high remainder */
+ind[IN_HP] = (quos == 0) && nz;                         /* set indicators */
+*ez = !nz;
+return TRUE;
+}
+
 /* Multiply routine 
 
    Inputs:
@@ -1606,6 +1747,8 @@ uint32 cnt = 0;                                         /* counter */
 uint8 sign;                                             /* final sign */
 t_stat r;
 
+if (mul_field_fast (mpc, mpy))                          /* std tables, short? */
+    return SCPE_OK;
 PR1 = 1;                                                /* step on PR1 */
 for (i = 0; i < PROD_AREA_LEN; i++)                     /* clr prod area */
     M[PROD_AREA + i] = 0;
@@ -1857,6 +2000,8 @@ uint32 dvds;                                            /* dvd sign */
 t_bool first = TRUE;                                    /* first pass */
 t_stat r;
 
+if (div_field_fast (dvd, dvr, ez))                      /* std tables, short? */
+    return SCPE_OK;
 dvds = (M[PROD_AREA + PROD_AREA_LEN - 1]) & FLAG;       /* dividend sign */
 quos = dvds ^ (M[dvr] & FLAG);                          /* quotient sign */
 ind[IN_HP] = (quos == 0);                               /* set indicators */
@@ -108,6 +108,9 @@
 #define COM_INIT_POLL   8000    /* polling interval */
 #define COMC_WAIT       2       /* channel delay time */
 #define COML_WAIT       500     /* char delay time */
+#define COML_BURST      8       /* chars sent per line event */
+#define COMI_BURST      8       /* chars taken per line per poll */
+#define COMI_QHIGH      128     /* input queue entries to stop burst */
 #define COM_LBASE       4       /* start of lines */
 
 /* Input threads */
@@ -701,7 +704,7 @@ comti_svc(UNIT * uptr)
 t_stat
 comi_svc(UNIT * uptr)
 {
-    int32               c, ln, t;
+    int32               c, ln, t, i;
     t_stat              r;
 
     if ((uptr->flags & UNIT_ATT) == 0)
@@ -727,8 +730,14 @@ comi_svc(UNIT * uptr)
         if (com_ldsc[ln].conn) {        /* connected? */
             if (coml_unit[ln].NEEDID)
                 com_send_id(ln);
-            c = tmxr_getc_ln(&com_ldsc[ln]);    /* get char */
-            if (c) {            /* any char? */
+            /* Take what has arrived, up to a burst, while the
+               input queue has room */
+            for (i = 0; i < COMI_BURST; i++) {
+                if (i > 0 && in_count >= COMI_QHIGH)
+                    break;
+                c = tmxr_getc_ln(&com_ldsc[ln]);        /* get char */
+                if (c == 0)     /* any char? */
+                    break;
                 c = c & 0177;   /* mask to 7b */
                 r = com_queue_in(ln, c);
                 if (r != SCPE_OK)
@@ -742,7 +751,7 @@ comi_svc(UNIT * uptr)
                     if (c == '\r')      /* add LF after CR */
                         tmxr_putc_ln(&com_ldsc[ln], '\n');
                 }               /* end if enabled */
-            }                   /* end if char */
+            }                   /* end for chars */
         } /* end if conn */
         else if (coml_unit[ln].CONN) {  /* not conn, was conn? */
             coml_unit[ln].CONN = 0;     /* clear connected */
@@ -782,17 +791,21 @@ como_svc(UNIT * uptr)
 {
     uint16              c, c1;
     int32               ln = uptr - coml_unit;  /* line # */
+    int                 i;
 
     if (com_out_head[ln] == 0)  /* no more characters? */
         return com_send_ccmp(ln);       /* free any remaining */
     if (com_ldsc[ln].conn) {    /* connected? */
-        if (com_ldsc[ln].xmte) {        /* output enabled? */
+        /* Send a burst per event, so the line is written to the host
+           in one piece rather than a character at a time */
+        for (i = 0; i < COML_BURST && com_ldsc[ln].xmte && /* output enabled? */
+             com_out_head[ln] != 0 && com_comp_cnt[ln] < COMI_CMAX; i++) {
             c = com_queue_out(ln, &c1); /* get character, cvt */
             if (c)
                 tmxr_putc_ln(&com_ldsc[ln], c); /* printable? output */
             if (c1)
                 tmxr_putc_ln(&com_ldsc[ln], c1);        /* print second */
-        }                       /* end if */
+        }                       /* end for */
         tmxr_poll_tx(&com_desc);        /* poll xmt */
         sim_activate(uptr, uptr->wait); /* next char */
         if (com_comp_cnt[ln] >= COMI_CMAX)      /* completion needed? */
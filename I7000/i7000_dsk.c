@@ -42,6 +42,10 @@
    Limitiation of this are that the address field for each record can not
    be more then 16 bytes.
 
+   While a drive is attached the whole image is held in memory. Tracks
+   are read from and written to this cache, and changed pages are written
+   back to the file on detach and when simulated files are flushed.
+
 */
 
 #include "i7000_defs.h"
@@ -51,6 +55,7 @@
 #define FORMAT_OK       (1 << (UNIT_V_LOCAL+0))
 #define HA2_OK          (1 << (UNIT_V_LOCAL+1))
 #define CTSS_BOOT       (1 << (UNIT_V_MODE))
+#define SEEK_FAST       (1 << (UNIT_V_LOCAL+2))
 
 /* Device status information stored in u5 */
 #define DSKSTA_CMD      0x0000100       /* Unit has recieved a cmd */
@@ -101,6 +106,7 @@
 #define PROG_INVSEQ     0x48000         /* Invalid sequence */
 
 #define MAXTRACK        6020    /* Max size per track */
+#define CPAGE           4096    /* Size of cache write back page */
 
 uint32              dsk_cmd(UNIT *, uint16, uint16);
 t_stat              dsk_srv(UNIT *);
@@ -118,6 +124,9 @@ t_stat              dsk_get_type(FILE * st, UNIT * uptr, int32 v,
 t_stat              dsk_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag,
                         const char *cptr);
 const char          *dsk_description (DEVICE *dptr);
+t_stat              dsk_attach(UNIT *, CONST char *);
+t_stat              dsk_detach(UNIT *);
+void                dsk_flush(UNIT *);
 
 int                 disk_rblock(UNIT * uptr, int track);
 int                 disk_wblock(UNIT * uptr);
@@ -127,8 +136,11 @@ int                 disk_cmd(UNIT * uptr);
 int                 disk_write(UNIT * uptr, uint8 data, int chan,
                                int eor);
 int                 disk_read(UNIT * uptr, uint8 * data, int chan);
-int                 disk_format(UNIT * uptr, FILE * f, int cyl,
-                                UNIT * base);
+int                 disk_format(UNIT * uptr, int cyl, UNIT * base);
+void                disk_cread(UNIT * base, t_addr pos, uint8 * buf,
+                               uint32 len);
+void                disk_cwrite(UNIT * base, t_addr pos, uint8 * buf,
+                                uint32 len);
 int                 bcd_to_track(uint32 addr);
 
 /* Data buffer for track */
@@ -145,6 +157,16 @@ uint16              dtrack[NUM_DEVS_DSK * 4];
 
 /* Arm position */
 uint16              arm_cyl[NUM_DEVS_DSK * 4];
+
+/* Image cache for each drive */
+struct dsk_cache
+{
+    uint8              *image;  /* Contents of image file */
+    uint8              *dirty;  /* Page needs to be written */
+    t_addr              size;   /* Size of cache */
+    t_addr              fsize;  /* Size of image file */
+}
+dcache[NUM_DEVS_DSK];
 uint32              sense[NUM_CHAN * 2];
 uint32              sense_unit[NUM_CHAN * 2];
 uint8               cmd_buffer[NUM_CHAN];       /* Command buffer per channel */
@@ -270,6 +292,9 @@ MTAB                dsk_mod[] = {
     {HA2_OK, 0, 0, "NOHA2", NULL, NULL, NULL, "No writing of Home Address"},
     {HA2_OK, HA2_OK, "HA2", "HA2", NULL, NULL, NULL,
             "Allow writing of Home Address"},
+    {SEEK_FAST, 0, 0, "NOFAST", NULL, NULL, NULL, "Seeks take arm movement time"},
+    {SEEK_FAST, SEEK_FAST, "FAST", "FAST", NULL, NULL, NULL,
+            "Seeks take select time only"},
 #ifdef I7090
     {CTSS_BOOT, 0, 0, "IBSYS", NULL, NULL, NULL, "IBSYS Boot Card"},
     {CTSS_BOOT, CTSS_BOOT, "CTSS", "CTSS", NULL, NULL, NULL, "CTSS Boot Card"},
@@ -290,7 +315,7 @@ MTAB                dsk_mod[] = {
 DEVICE              dsk_dev = {
     "DK", dsk_unit, NULL /* Registers */ , dsk_mod,
     NUM_DEVS_DSK, 8, 15, 1, 8, 8,
-    NULL, NULL, &dsk_reset, &dsk_boot, NULL, NULL,
+    NULL, NULL, &dsk_reset, &dsk_boot, &dsk_attach, &dsk_detach,
     &dsk_dib, DEV_DISABLE | DEV_DEBUG, 0, dev_debug,
     NULL, NULL, &dsk_help, NULL, NULL, &dsk_description
 };
@@ -835,7 +860,7 @@ clear_drive:
     /* Do command */
     switch (cmd_buffer[chan]) {
     case DSAI:          /* Set Access Inoperative */
-        detach_unit(base);
+        dsk_detach(base);
         disk_cmderr(up, 0);
         return 1;
 
@@ -860,7 +885,7 @@ clear_drive:
         up->wait = 0;
         /* From documentation, it looks like seeks were a fixed time
          * based on movement between cylinder groups */
-        if (t == 0)     /* At cylinder, give attention */
+        if (t == 0 || (base->flags & SEEK_FAST))
             up->wait = 2;       /* Electronic select time */
         else if (t > 50)
             up->wait = (1800);
@@ -1000,9 +1025,8 @@ disk_rblock(UNIT * uptr, int trk)
     int                 u = uptr - dsk_unit;
     struct disk_t      *dsk = &disk_type[uptr->u4];
     UNIT               *base = &dsk_unit[(uptr->u3 >> 8) & 0xf];
-    FILE               *f = base->fileref;
-    int                 offset = 0;
-    int                 fbase = 0;
+    t_addr              offset = 0;
+    t_addr              fbase = 0;
 
     offset = dsk->cyl * dsk->track * dsk->bpt;
     fbase = dsk->fmtsz;
@@ -1015,8 +1039,7 @@ disk_rblock(UNIT * uptr, int trk)
     }
 
     if (arm_cyl[u] != fmt_cyl[u]) {
-        (void)sim_fseek(f, fbase + arm_cyl[u] * dsk->fbpt, SEEK_SET);
-        (void)sim_fread(fbuffer[u], 1, dsk->fbpt, f);
+        disk_cread(base, fbase + arm_cyl[u] * dsk->fbpt, fbuffer[u], dsk->fbpt);
         fmt_cyl[u] = arm_cyl[u];
         print_format(uptr);
     }
@@ -1024,9 +1047,7 @@ disk_rblock(UNIT * uptr, int trk)
     if (dtrack[u] != trk) {
         sim_debug(DEBUG_DETAIL, &dsk_dev, "unit=%d Read track %d\n", u,
                   trk);
-        (void)sim_fseek(f, offset + trk * dsk->bpt, SEEK_SET);
-        if (sim_fread(dbuffer[u], 1, dsk->bpt, f) != dsk->bpt)
-            memset(dbuffer[u], 0, dsk->bpt);
+        disk_cread(base, offset + trk * dsk->bpt, dbuffer[u], dsk->bpt);
         dtrack[u] = trk;
     }
     return 1;
@@ -1038,8 +1059,7 @@ disk_wblock(UNIT * uptr)
     int                 u = uptr - dsk_unit;
     struct disk_t      *dsk = &disk_type[uptr->u4];
     UNIT               *base = &dsk_unit[(uptr->u3 >> 8) & 0xf];
-    FILE               *f = base->fileref;
-    int                 offset = 0;
+    t_addr              offset = 0;
 
     offset = dsk->cyl * dsk->track * dsk->bpt;
     offset *= u / (NUM_DEVS_DSK);
@@ -1048,7 +1068,7 @@ disk_wblock(UNIT * uptr)
     /* Check if new format data */
     if ((uptr->u5 & DSKSTA_CMSK) == DWRF) {
         if (uptr->u5 & (DSKSTA_CHECK|DSKSTA_DIRTY)) {
-            switch (disk_format(uptr, f, arm_cyl[u], base)) {
+            switch (disk_format(uptr, arm_cyl[u], base)) {
             case 2:
                 if (uptr->u5 & DSKSTA_CHECK) {
                     disk_posterr(uptr, PROG_FMTCHK|EXPT_DSKCHK);
@@ -1075,15 +1095,14 @@ disk_wblock(UNIT * uptr)
     sim_debug(DEBUG_DETAIL, &dsk_dev, "unit=%d Write track %d\n",
               u, dtrack[u]);
     /* Write in actualy track data */
-    (void)sim_fseek(f, offset + dtrack[u] * dsk->bpt, SEEK_SET);
-    (void)sim_fwrite(dbuffer[u], 1, dsk->bpt, f);
+    disk_cwrite(base, offset + dtrack[u] * dsk->bpt, dbuffer[u], dsk->bpt);
     uptr->u5 &= ~DSKSTA_DIRTY;
     return 1;
 }
 
 /* Convert a format pattern into a format track */
 int
-disk_format(UNIT * uptr, FILE * f, int cyl, UNIT * base)
+disk_format(UNIT * uptr, int cyl, UNIT * base)
 {
     uint8               tbuffer[MAXTRACK];
     struct disk_t      *dsk = &disk_type[uptr->u4];
@@ -1091,9 +1110,7 @@ disk_format(UNIT * uptr, FILE * f, int cyl, UNIT * base)
     int                 out = 0;
     int                 u = uptr - dsk_unit;
     uint8               ch;
-    int                 offset;
-
-    f = base->fileref;
+    t_addr              offset;
 
     offset = dsk->fmtsz;
     offset *= u / (NUM_DEVS_DSK);
@@ -1211,8 +1228,7 @@ disk_format(UNIT * uptr, FILE * f, int cyl, UNIT * base)
     fbuffer[u][dsk->fbpt-1] = (FMT_END<<6)|(FMT_END<<4)|(FMT_END<<2)|FMT_END;
 
     /* Now write the buffer to the file */
-    (void)sim_fseek(f, offset + cyl * dsk->fbpt, SEEK_SET);
-    (void)sim_fwrite(fbuffer[u], 1, dsk->fbpt, f);
+    disk_cwrite(base, offset + cyl * dsk->fbpt, fbuffer[u], dsk->fbpt);
 
     /* Make sure we did not pass size of track */
     if (out > (int)dsk->bpt)
@@ -1590,6 +1606,72 @@ disk_read(UNIT * uptr, uint8 * data, int chan)
     return 0;
 }
 
+/* Copy data from the image cache, area past end of cache reads as zero */
+void
+disk_cread(UNIT * base, t_addr pos, uint8 * buf, uint32 len)
+{
+    struct dsk_cache   *cp = &dcache[base - dsk_unit];
+    uint32              n = 0;
+
+    if (cp->image != NULL && pos < cp->size) {
+        n = len;
+        if (pos + n > cp->size)
+            n = (uint32)(cp->size - pos);
+        memcpy(buf, &cp->image[pos], n);
+    }
+    memset(&buf[n], 0, len - n);
+}
+
+/* Copy data into the image cache and mark pages to be written back */
+void
+disk_cwrite(UNIT * base, t_addr pos, uint8 * buf, uint32 len)
+{
+    struct dsk_cache   *cp = &dcache[base - dsk_unit];
+    t_addr              pg;
+
+    if (cp->image == NULL || pos >= cp->size)
+        return;
+    if (pos + len > cp->size)
+        len = (uint32)(cp->size - pos);
+    memcpy(&cp->image[pos], buf, len);
+    for (pg = pos / CPAGE; pg <= (pos + len - 1) / CPAGE; pg++)
+        cp->dirty[pg] = 1;
+    if (pos + len > cp->fsize)
+        cp->fsize = pos + len;
+}
+
+/* Write changed pages of the image cache back to the file */
+void
+dsk_flush(UNIT * uptr)
+{
+    struct dsk_cache   *cp = &dcache[uptr - dsk_unit];
+    t_addr              pages;
+    t_addr              pg, end;
+    t_addr              start, last;
+
+    if (cp->image == NULL || (uptr->flags & UNIT_RO))
+        return;
+    pages = (cp->size + CPAGE - 1) / CPAGE;
+    for (pg = 0; pg < pages; pg++) {
+        if (cp->dirty[pg] == 0)
+            continue;
+        /* Gather run of changed pages */
+        for (end = pg; end < pages && cp->dirty[end]; end++)
+            cp->dirty[end] = 0;
+        start = pg * CPAGE;
+        last = end * CPAGE;
+        if (last > cp->fsize)
+            last = cp->fsize;
+        if (start < last) {
+            (void)sim_fseek(uptr->fileref, start, SEEK_SET);
+            (void)sim_fwrite(&cp->image[start], 1, (size_t)(last - start),
+                             uptr->fileref);
+        }
+        pg = end;
+    }
+    fflush(uptr->fileref);
+}
+
 /* Convert BCD track address to binary address */
 int
 bcd_to_track(uint32 addr)
@@ -1835,6 +1917,75 @@ dsk_get_module(FILE * st, UNIT * uptr, int32 v, CONST void *desc)
     return SCPE_OK;
 }
 
+/* Attach a drive and load its image into the cache */
+t_stat
+dsk_attach(UNIT * uptr, CONST char *file)
+{
+    struct dsk_cache   *cp = &dcache[uptr - dsk_unit];
+    struct disk_t      *dsk = &disk_type[uptr->u4];
+    t_addr              fend, dend;
+    t_offset            fsize;
+    int                 n;
+    int                 j;
+    t_stat              r;
+
+    if ((r = attach_unit(uptr, file)) != SCPE_OK)
+        return r;
+
+    /* Find highest arm image used, tracks may address one cylinder
+     * past the last one. */
+    n = ((dsk->mods - 1) * 2) + (dsk->arms - 1);
+    fend = (t_addr)dsk->fmtsz * n + (t_addr)(dsk->cyl + 1) * dsk->fbpt;
+    dend = (t_addr)dsk->fmtsz * dsk->mods * dsk->arms +
+           (t_addr)dsk->cyl * dsk->track * dsk->bpt * n +
+           (t_addr)(dsk->cyl + 1) * dsk->track * dsk->bpt;
+    cp->size = (fend > dend) ? fend : dend;
+    cp->image = (uint8 *)calloc((size_t)cp->size, sizeof(uint8));
+    cp->dirty = (uint8 *)calloc((size_t)((cp->size + CPAGE - 1) / CPAGE),
+                                sizeof(uint8));
+    if (cp->image == NULL || cp->dirty == NULL) {
+        free(cp->image);
+        free(cp->dirty);
+        cp->image = cp->dirty = NULL;
+        detach_unit(uptr);
+        return SCPE_MEM;
+    }
+
+    /* Load in current image */
+    fsize = sim_fsize_ex(uptr->fileref);
+    cp->fsize = (t_addr)fsize;
+    if ((t_offset)cp->size < fsize)
+        fsize = cp->size;
+    (void)sim_fseek(uptr->fileref, 0, SEEK_SET);
+    (void)sim_fread(cp->image, 1, (size_t)fsize, uptr->fileref);
+
+    /* Drop any track still buffered from previous image */
+    for (j = uptr - dsk_unit; j < NUM_DEVS_DSK * 4; j += NUM_DEVS_DSK) {
+        dtrack[j] = 077777;
+        fmt_cyl[j] = 077777;
+        dsk_unit[j].u5 &= ~DSKSTA_DIRTY;
+    }
+    uptr->io_flush = &dsk_flush;
+    uptr->dynflags |= UNIT_SYNC_FLUSH;
+    return SCPE_OK;
+}
+
+/* Write back cache and detach drive */
+t_stat
+dsk_detach(UNIT * uptr)
+{
+    struct dsk_cache   *cp = &dcache[uptr - dsk_unit];
+
+    if (uptr->flags & UNIT_ATT)
+        dsk_flush(uptr);
+    free(cp->image);
+    free(cp->dirty);
+    cp->image = cp->dirty = NULL;
+    uptr->io_flush = NULL;
+    uptr->dynflags &= ~UNIT_SYNC_FLUSH;
+    return detach_unit(uptr);
+}
+
 t_stat dsk_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag,
     const char *cptr)
 {
@@ -1871,6 +2022,11 @@ fprintf (st, "To do this:\n\n");
 fprintf (st, "     sim> SET DKn FORMAT HA2\n\n");
 fprintf (st, "To prevent accidental formating of the drive use:\n\n");
 fprintf (st, "     sim> SET DKn NOFORMAT NOHA2\n\n");
+fprintf (st, "The image of an attached drive is held in memory, changes are ");
+fprintf (st, "written back to\nthe file when it is flushed or detached. ");
+fprintf (st, "Seeks normally take time\nbased on the distance the arm ");
+fprintf (st, "moves, to have them complete in select\ntime use:\n\n");
+fprintf (st, "     sim> SET DKn FAST\n\n");
 help_set_chan_type(st, dptr, "IBM 7631 Disk File");
 fprint_set_help (st, dptr);
 fprint_show_help (st, dptr);
@@ -2268,7 +2268,7 @@ drmod = 0;
 blk_io.dfl = blk_io.cur = blk_io.end = 0;               /* no block I/O */
 sim_brk_types = sim_brk_dflt = SWMASK ('E');            /* init bkpts */
 if (M == NULL)
-    M = (uint32 *) calloc (MAXMEMSIZE32 >> 2, sizeof (uint32));
+    M = (uint32 *) sim_mem_alloc (MAXMEMSIZE32);
 if (M == NULL)
     return SCPE_MEM;
 pcq_r = find_reg ("PCQ", NULL, dptr);                   /* init PCQ */
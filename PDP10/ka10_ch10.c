@@ -80,6 +80,8 @@ BITFIELD ch10_csr_bits[] = {
 };
 
 #define CHUDP_HEADER 4
+#define CH_POLL_BUSY   2000 /* Instructions between polls while traffic flows */
+#define CH_POLL_LINGER 50   /* Empty polls before falling back to clock polls */
 #define IOLN_CH 020
 #define DBG_TRC  0x0001
 #define DBG_REG  0x0002
@@ -108,6 +110,7 @@ static int rx_count;
 static int tx_count;
 static uint8 rx_buffer[512+100];
 static uint8 tx_buffer[512+100];
+static int32 quiet_polls = CH_POLL_LINGER;  /* Empty polls since last traffic */
 
 TMLN ch10_lines[1] = { {0} };
 TMXR ch10_tmxr = { 1, NULL, 0, ch10_lines};
@@ -160,7 +163,13 @@ uint16 ch10_checksum (const uint8 *p, int count)
 {
   int32 sum = 0;
 
-  while (count > 1) {
+  while (count > 3) {                   /* Two words per pass, fold once */
+    sum += ((p[0]<<8) | p[1]) + ((p[2]<<8) | p[3]);
+    p += 4;
+    count -= 4;
+  }
+
+  if (count > 1) {
     sum += (p[0]<<8) | p[1];
     p += 2;
     count -= 2;
@@ -245,6 +254,10 @@ t_stat ch10_transmit ()
   if (r == SCPE_OK) {
     sim_debug (DBG_PKT, &ch10_dev, "Sent UDP packet, %d bytes.\n", (int)len);
     tmxr_poll_tx (&ch10_tmxr);
+    if (quiet_polls != 0) {             /* Expect an answer soon */
+      quiet_polls = 0;
+      sim_activate_abs (&ch10_unit[0], CH_POLL_BUSY);
+    }
   } else {
     sim_debug (DBG_ERR, &ch10_dev, "Sending UDP failed: %d.\n", r);
     ch10_status |= OVER;
@@ -254,25 +267,33 @@ t_stat ch10_transmit ()
   return SCPE_OK;
 }
 
-void ch10_receive (void)
+/* Returns TRUE if any packet arrived.  Packets addressed to other nodes
+   are dropped and the next queued one is read right away, so traffic on
+   a busy shared network does not hold ours back a poll at a time. */
+
+t_bool ch10_receive (void)
 {
   size_t count;
   const uint8 *p;
   uint16 dest;
+  t_bool seen = FALSE;
 
-  tmxr_poll_rx (&ch10_tmxr);
-  if (tmxr_get_packet_ln (&ch10_lines[0], &p, &count) != SCPE_OK) {
-    sim_debug (DBG_ERR, &ch10_dev, "TMXR error receiving packet\n");
-    return;
+  for (;;) {
+    tmxr_poll_rx (&ch10_tmxr);
+    if (tmxr_get_packet_ln (&ch10_lines[0], &p, &count) != SCPE_OK) {
+      sim_debug (DBG_ERR, &ch10_dev, "TMXR error receiving packet\n");
+      return seen;
+    }
+    if (p == NULL)
+      return seen;
+    seen = TRUE;
+    dest = ((p[4+CHUDP_HEADER] & 0xff) << 8) + (p[5+CHUDP_HEADER] & 0xff);
+
+    sim_debug (DBG_PKT, &ch10_dev, "Received UDP packet, %d bytes for: %o\n", (int)count, dest);
+    /* Check if packet for us. */
+    if (dest == address || dest == 0 || (ch10_status & SPY) != 0)
+      break;
   }
-  if (p == NULL)
-    return;
-  dest = ((p[4+CHUDP_HEADER] & 0xff) << 8) + (p[5+CHUDP_HEADER] & 0xff);
-
-  sim_debug (DBG_PKT, &ch10_dev, "Received UDP packet, %d bytes for: %o\n", (int)count, dest);
-  /* Check if packet for us. */
-  if (dest != address && dest != 0 && (ch10_status & SPY) == 0)
-    return;
 
   if ((RXD & ch10_status) == 0) {
     count = (count + 1) & 0776;
@@ -289,6 +310,7 @@ void ch10_receive (void)
     if ((ch10_status & LOST) < LOST)
       ch10_status += 01000;
   }
+  return TRUE;
 }
 
 void ch10_clear (void)
@@ -314,6 +336,9 @@ void ch10_command (uint32 data)
      rx_count = 0;
      ch10_lines[0].rcve = TRUE;
      rx_count = 0;
+     quiet_polls = 0;
+     if (ch10_unit[0].flags & UNIT_ATT)
+       sim_activate_abs (&ch10_unit[0], 100); /* Read next packet */
   }
   if (data & RESET) {
     /* Do this first so other bits can do their things. */
@@ -404,13 +429,24 @@ t_stat ch10_devio(uint32 dev, uint64 *data)
     return SCPE_OK;
 }
 
+/* While packets are flowing the line is polled every CH_POLL_BUSY
+   instructions, so a reply is picked up as soon as the peer sends it
+   instead of at the next clock tick.  After CH_POLL_LINGER empty polls
+   the unit goes back to polling once per clock tick.  With asynchronous
+   multiplexer support the poll thread also activates the unit as soon
+   as a datagram arrives. */
+
 t_stat ch10_svc(UNIT *uptr)
 {
-  sim_clock_coschedule (uptr, 1000);
   (void)tmxr_poll_conn (&ch10_tmxr);
-  if (ch10_lines[0].conn) {
-    ch10_receive ();
-  }
+  if (ch10_lines[0].conn && ch10_receive ())
+    quiet_polls = 0;
+  else if (quiet_polls < CH_POLL_LINGER)
+    quiet_polls++;
+  if (quiet_polls < CH_POLL_LINGER)
+    sim_activate (uptr, CH_POLL_BUSY);
+  else
+    sim_clock_coschedule (uptr, 1000);
   if (tx_count == 0)
     ch10_status |= TXD;
   ch10_test_int ();
@@ -104,6 +104,8 @@
 #define NIA_CMD_RNSA  0010                     /* Read Station Address */
 #define NIA_CMD_WNSA  0011                     /* Write Station Address */
 
+#define NIA_CMD_BURST 16                       /* Commands handled per service call */
+
 /* 20 Bit shift */
 #define NIA_FLG_RESP  0001                     /* Command wants a response */
 #define NIA_FLG_CLRC  0002                     /* Clear counters (Read counters) */
@@ -1201,9 +1203,11 @@ int nia_send_pkt(uint64 cmd)
 }
 
 /*
- * Process commands.
+ * Process one command.  Returns 1 if it was completed and the queue
+ * should be checked again, 0 if the unit is idle or has rescheduled
+ * itself.
  */
-t_stat nia_cmd_srv(UNIT * uptr)
+static int nia_cmd_one(UNIT * uptr)
 {
     uint64    word1, word2;
     uint32    cmd;
@@ -1215,34 +1219,34 @@ t_stat nia_cmd_srv(UNIT * uptr)
        /* Have to put this either on response queue or free queue */
        if (nia_putq(nia_data.cmd_rply, &nia_data.cmd_entry) == 0){
            sim_activate(uptr, 200); /* Reschedule ourselves to deal with it */
-           return SCPE_OK;
+           return 0;
        }
        nia_data.cmd_rply = 0;
     }
 
     /* Check if we are running */
     if ((nia_data.status & NIA_MRN) == 0 || (nia_data.status & NIA_CQA) == 0) {
-        return SCPE_OK;
+        return 0;
     }
 
     /* or no commands pending, just idle out */
     /* Try to get command off queue */
     if (nia_getq(nia_data.cmd_hdr, &nia_data.cmd_entry) == 0) {
        sim_activate(uptr, 200); /* Reschedule ourselves to deal with it */
-       return SCPE_OK;
+       return 0;
     }
 
     /* Check if we got one */
     if (nia_data.cmd_entry == 0) {
        /* Nothing to do */
        nia_data.status &= ~NIA_CQA;
-       return SCPE_OK;
+       return 0;
     }
 
     /* Get command */
     if (Mem_read_word(nia_data.cmd_entry + 3, &word1, 0)) {
         nia_error(EBSERR);
-        return SCPE_OK;
+        return 0;
     }
     cmd = (uint32)(word1 >> 12);
     /* Save initial status */
@@ -1270,7 +1274,7 @@ t_stat nia_cmd_srv(UNIT * uptr)
              word1 = nia_data.pcnt[i];
              if (Mem_write_word(nia_data.cnt_addr + i, &word1, 0)) {
                  nia_error(EBSERR);
-                 return SCPE_OK;
+                 return 0;
              }
              if ((cmd & (NIA_FLG_CLRC << 20)) != 0)
                 nia_data.pcnt[i] = 0;
@@ -1290,11 +1294,11 @@ t_stat nia_cmd_srv(UNIT * uptr)
          word2 |= ((uint64)nia_data.mac[5]) << 20;
          if (Mem_write_word(nia_data.cmd_entry + 4, &word1, 0)) {
              nia_error(EBSERR);
-             return SCPE_OK;
+             return 0;
          }
          if (Mem_write_word(nia_data.cmd_entry + 5, &word2, 0)) {
              nia_error(EBSERR);
-             return SCPE_OK;
+             return 0;
          }
          word1 = (uint64)((nia_data.amc << 2)| (nia_data.h4000 << 1)
                                              | nia_data.prmsc);
@@ -1302,31 +1306,31 @@ t_stat nia_cmd_srv(UNIT * uptr)
          word2 = (nia_data.uver[3] << 12) |(0xF << 6)|0xF;
          if (Mem_write_word(nia_data.cmd_entry + 6, &word1, 0)) {
              nia_error(EBSERR);
-             return SCPE_OK;
+             return 0;
          }
          if (Mem_write_word(nia_data.cmd_entry + 7, &word2, 0)) {
              nia_error(EBSERR);
-             return SCPE_OK;
+             return 0;
          }
          break;
     case NIA_CMD_WNSA: /* Write Station Address */
          len = 8;
          if (Mem_read_word(nia_data.cmd_entry + 4, &word1, 0)) {
              nia_error(EBSERR);
-             return SCPE_OK;
+             return 0;
          }
          if (Mem_read_word(nia_data.cmd_entry + 5, &word2, 0)) {
              nia_error(EBSERR);
-             return SCPE_OK;
+             return 0;
          }
          nia_cpy_mac(word1, word2, &nia_data.mac);
          if (Mem_read_word(nia_data.cmd_entry + 6, &word1, 0)) {
              nia_error(EBSERR);
-             return SCPE_OK;
+             return 0;
          }
          if (Mem_read_word(nia_data.cmd_entry + 7, &word2, 0)) {
              nia_error(EBSERR);
-             return SCPE_OK;
+             return 0;
          }
          nia_data.prmsc = (int)(word1 & 1);
          nia_data.h4000 = (int)((word1 & 2) != 0);
@@ -1347,14 +1351,14 @@ t_stat nia_cmd_srv(UNIT * uptr)
     word1 = ((uint64)cmd) << 12;
     if (Mem_write_word(nia_data.cmd_entry + 3, &word1, 0)) {
         nia_error(EBSERR);
-        return SCPE_OK;
+        return 0;
     }
     if (((cmd >> 16) & 1) != 0 || (cmd & (NIA_FLG_RESP << 8)) != 0) {
        nia_data.cmd_rply = nia_data.resp_hdr;
     } else if ((cmd & 0xff) == NIA_CMD_SND) {
        if (Mem_read_word(nia_data.cmd_entry + 5, &word1, 0)) {
            nia_error(EBSERR);
-           return SCPE_OK;
+           return 0;
        }
        nia_data.cmd_rply = (t_addr)(word1 & AMASK);
     }
@@ -1362,6 +1366,21 @@ t_stat nia_cmd_srv(UNIT * uptr)
         sim_debug(DEBUG_DETAIL, &nia_dev, "NIA rcmd: %d %09llx %012llo\n",
                 i, M[nia_data.cmd_entry + i], M[nia_data.cmd_entry + i]);
     (void)nia_putq(nia_data.cmd_rply, &nia_data.cmd_entry);
+    return 1;
+}
+
+/*
+ * Process commands.  Up to NIA_CMD_BURST queued commands are handled
+ * per call before giving the CPU a turn.
+ */
+t_stat nia_cmd_srv(UNIT * uptr)
+{
+    int       n;
+
+    for (n = 0; n < NIA_CMD_BURST; n++) {
+        if (nia_cmd_one(uptr) == 0)
+            return SCPE_OK;
+    }
     sim_activate(uptr, 500);
     return SCPE_OK;
 }
@@ -66,6 +66,8 @@
 
 
 #define CHUDP_HEADER 4
+#define CH_POLL_BUSY   2000 /* Instructions between polls while traffic flows */
+#define CH_POLL_LINGER 50   /* Empty polls before falling back to clock polls */
 #define IOLN_CH 020
 #define DBG_TRC  0x0001
 #define DBG_REG  0x0002
@@ -79,7 +81,7 @@ int    ch11_read(DEVICE *dptr, t_addr addr, uint16 *data, int32 access);
 uint16 ch11_checksum (const uint8 *p, int count);
 void   ch11_validate (const uint8 *p, int count);
 t_stat ch11_transmit (struct pdp_dib *dibp);
-void   ch11_receive (struct pdp_dib *dibp);
+t_bool ch11_receive (struct pdp_dib *dibp);
 void   ch11_clear (struct pdp_dib *dibp);
 t_stat ch11_svc(UNIT *);
 t_stat ch11_reset (DEVICE *);
@@ -100,6 +102,7 @@ static int rx_count;
 static int tx_count;
 static uint8 rx_buffer[512+100];
 static uint8 tx_buffer[512+100];
+static int32 quiet_polls = CH_POLL_LINGER;  /* Empty polls since last traffic */
 
 TMLN ch11_lines[1] = { {0} };
 TMXR ch11_tmxr = { 1, NULL, 0, ch11_lines};
@@ -181,6 +184,9 @@ ch11_write(DEVICE *dptr, t_addr addr, uint16 data, int32 access)
             rx_count = 0;
             ch11_lines[0].rcve = TRUE;
             uba_clr_irq(dibp, dibp->uba_vect);
+            quiet_polls = 0;
+            if (ch11_unit[0].flags & UNIT_ATT)
+                sim_activate_abs (&ch11_unit[0], 100); /* Read next packet */
         }
         if (data & CSR_TCL) {
           sim_debug (DBG_REG, &ch11_dev, "Clear TX\n");
@@ -271,7 +277,13 @@ ch11_checksum (const uint8 *p, int count)
 {
   int32 sum = 0;
 
-  while (count > 1) {
+  while (count > 3) {                   /* Two words per pass, fold once */
+    sum += ((p[0]<<8) | p[1]) + ((p[2]<<8) | p[3]);
+    p += 4;
+    count -= 4;
+  }
+
+  if (count > 1) {
     sum += (p[0]<<8) | p[1];
     p += 2;
     count -= 2;
@@ -342,6 +354,10 @@ ch11_transmit (struct pdp_dib *dibp)
   if (r == SCPE_OK) {
     sim_debug (DBG_PKT, &ch11_dev, "Sent UDP packet, %d bytes.\n", (int)len);
     tmxr_poll_tx (&ch11_tmxr);
+    if (quiet_polls != 0) {             /* Expect an answer soon */
+      quiet_polls = 0;
+      sim_activate_abs (&ch11_unit[0], CH_POLL_BUSY);
+    }
   } else {
     sim_debug (DBG_ERR, &ch11_dev, "Sending UDP failed: %d.\n", r);
     ch11_csr |= CSR_TAB;
@@ -350,26 +366,34 @@ ch11_transmit (struct pdp_dib *dibp)
   return SCPE_OK;
 }
 
-void
+/* Returns TRUE if any packet arrived.  Packets addressed to other nodes
+   are dropped and the next queued one is read right away, so traffic on
+   a busy shared network does not hold ours back a poll at a time. */
+
+t_bool
 ch11_receive (struct pdp_dib *dibp)
 {
   size_t count;
   const uint8 *p;
   uint16 dest;
+  t_bool seen = FALSE;
 
-  tmxr_poll_rx (&ch11_tmxr);
-  if (tmxr_get_packet_ln (&ch11_lines[0], &p, &count) != SCPE_OK) {
-    sim_debug (DBG_ERR, &ch11_dev, "TMXR error receiving packet\n");
-    return;
+  for (;;) {
+    tmxr_poll_rx (&ch11_tmxr);
+    if (tmxr_get_packet_ln (&ch11_lines[0], &p, &count) != SCPE_OK) {
+      sim_debug (DBG_ERR, &ch11_dev, "TMXR error receiving packet\n");
+      return seen;
+    }
+    if (p == NULL)
+      return seen;
+    seen = TRUE;
+    dest = ((p[4+CHUDP_HEADER] & 0xff) << 8) + (p[5+CHUDP_HEADER] & 0xff);
+
+    sim_debug (DBG_PKT, &ch11_dev, "Received UDP packet, %d bytes for: %o\n", (int)count, dest);
+    /* Check if packet for us. */
+    if (dest == address || dest == 0 || (ch11_csr & CSR_SPY) != 0)
+      break;
   }
-  if (p == NULL)
-    return;
-  dest = ((p[4+CHUDP_HEADER] & 0xff) << 8) + (p[5+CHUDP_HEADER] & 0xff);
-
-  sim_debug (DBG_PKT, &ch11_dev, "Received UDP packet, %d bytes for: %o\n", (int)count, dest);
-  /* Check if packet for us. */
-  if (dest != address && dest != 0 && (ch11_csr & CSR_SPY) == 0)
-    return;
 
   if ((CSR_RDN & ch11_csr) == 0) {
     count = (count + 1) & 0776;
@@ -389,6 +413,7 @@ ch11_receive (struct pdp_dib *dibp)
     if ((ch11_csr & CSR_LOS) != CSR_LOS)
         ch11_csr = (ch11_csr & ~CSR_LOS) | (CSR_LOS & (ch11_csr + 01000));
   }
+  return TRUE;
 }
 
 void
@@ -407,17 +432,28 @@ ch11_clear (struct pdp_dib *dibp)
   uba_clr_irq(dibp, dibp->uba_vect);
 }
 
+/* While packets are flowing the line is polled every CH_POLL_BUSY
+   instructions, so a reply is picked up as soon as the peer sends it
+   instead of at the next clock tick.  After CH_POLL_LINGER empty polls
+   the unit goes back to polling once per clock tick.  With asynchronous
+   multiplexer support the poll thread also activates the unit as soon
+   as a datagram arrives. */
+
 t_stat
 ch11_svc(UNIT *uptr)
 {
    DEVICE           *dptr = find_dev_from_unit (uptr);
    struct pdp_dib   *dibp = (DIB *)dptr->ctxt;
 
-  sim_clock_coschedule (uptr, 1000);
   (void)tmxr_poll_conn (&ch11_tmxr);
-  if (ch11_lines[0].conn) {
-    ch11_receive (dibp);
-  }
+  if (ch11_lines[0].conn && ch11_receive (dibp))
+    quiet_polls = 0;
+  else if (quiet_polls < CH_POLL_LINGER)
+    quiet_polls++;
+  if (quiet_polls < CH_POLL_LINGER)
+    sim_activate (uptr, CH_POLL_BUSY);
+  else
+    sim_clock_coschedule (uptr, 1000);
   if (tx_count == 0) {
     ch11_csr |= CSR_TDN;
     if (ch11_csr & CSR_TEN) {
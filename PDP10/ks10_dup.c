@@ -894,7 +894,7 @@ if (!tmxr_tpbusyln(&dup_ldsc[dup])) {  /* Not Busy sending? */
         dup_xmtpacket[dup][dup_xmtpkoffset[dup]++] = crc16 >> 8;
         if ((dup_xmtpkoffset[dup] > 8) || (dup_xmtpacket[dup][0] == DDCMP_ENQ)) {
             dup_xmtpkbytes[dup] = dup_xmtpkoffset[dup];
-            ddcmp_tmxr_put_packet_ln (&dup_ldsc[dup], dup_xmtpacket[dup], dup_xmtpkbytes[dup], dup_corruption[dup]);
+            ddcmp_tmxr_put_packet_ln_ex (&dup_ldsc[dup], dup_xmtpacket[dup], dup_xmtpkbytes[dup], dup_corruption[dup], TRUE);
             }
         }
     breturn = TRUE;
@@ -625,7 +625,6 @@ if (uptr->DSTATE & DTC_MOT) {
            /* Set stop */
            sim_debug(DEBUG_DETAIL, &dt_dev, "DTA %o rev forward end\n", u);
            uptr->CMD |= DTC_FNC_STOP;
-           uptr->u6 = 0;
            dtsb |= DTB_END;
            dtsb &= ~DTB_IDL;
            if (dtsb & DTB_ENDENB)
@@ -707,7 +706,6 @@ if (uptr->DSTATE & DTC_MOT) {
                uptr->DSTATE &= ~(DTC_M_WORD << DTC_V_WORD);
                uptr->DSTATE |= (word - 1) << DTC_V_WORD;
            }
-           uptr->u6-=2;
            switch (DTC_GETFNC(uptr->CMD)) {
            case FNC_MOVE:
            case FNC_SRCH:
@@ -839,7 +837,6 @@ if (uptr->DSTATE & DTC_MOT) {
            sim_activate(uptr, DT_WRDTIM*10);
            sim_debug(DEBUG_DETAIL, &dt_dev, "DTA %o forward end\n", u);
            uptr->DSTATE = DTC_FBLK | (DTC_MOTMASK & uptr->DSTATE);  /* Move to first block */
-           uptr->u6 = 0;
            dtsb &= ~DTB_IDL;
            break;
 
@@ -1182,6 +1179,7 @@ t_stat dt_attach (UNIT *uptr, CONST char *cptr)
     else sim_printf ("18b/36b format");
     sim_printf (", buffering file in memory\n");
     uptr->io_flush = dt_flush;
+    uptr->dynflags |= UNIT_SYNC_FLUSH;                      /* checkpoint while running */
     if (uptr->flags & UNIT_8FMT) {                          /* 12b? */
         for (ba = 0; ba < uptr->capac; ) {                  /* loop thru file */
             k = fxread (pdp8b, sizeof (uint16), D8_NBSIZE, uptr->fileref);
@@ -1259,6 +1257,7 @@ void dt_flush (UNIT* uptr)
         }                                                   /* end if 16b */
         else fxwrite (uptr->filebuf, sizeof (uint32),       /* write file */
             uptr->hwmark, uptr->fileref);
+        fflush (uptr->fileref);
         if (ferror (uptr->fileref))
             sim_perror ("I/O error");
     }                                                        /* end if hwmark */
@@ -1289,6 +1288,7 @@ t_stat dt_detach (UNIT* uptr)
         dt_flush(uptr);
     }                                                       /* end if hwmark */
     free (uptr->filebuf);                                   /* release buf */
+    uptr->dynflags &= ~UNIT_SYNC_FLUSH;
     uptr->flags = uptr->flags & ~UNIT_BUF;                  /* clear buf flag */
     uptr->filebuf = NULL;                                   /* clear buf ptr */
     uptr->flags = uptr->flags & ~(UNIT_8FMT | UNIT_11FMT);  /* default fmt */
@@ -457,6 +457,7 @@ struct imp_device {
     in_addr_T         gwip;                    /* Gateway IP address */
     int               maskbits;                /* Mask length */
     struct imp_map    port_map[64];            /* Ports to adjust */
+    int               port_maps;               /* Entries in use in port_map */
     in_addr_T         dhcpip;                  /* DHCP server address */
     uint8             dhcp_state;              /* State of DHCP */
     uint32            dhcp_lease;              /* DHCP lease time */
@@ -516,7 +517,10 @@ t_stat         imp_show_arp (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat         imp_set_arp (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 void           imp_timer_task(struct imp_device *imp);
 void           imp_send_rfmn(struct imp_device *imp);
-void           imp_packet_in(struct imp_device *imp);
+int            imp_packet_in(struct imp_device *imp);
+void           imp_input_poll(UNIT *uptr);
+struct imp_map *imp_port_lookup(struct imp_device *imp, uint16 sport, uint16 dport, int create);
+void           imp_port_release(struct imp_device *imp, struct imp_map *map);
 void           imp_send_packet (struct imp_device *imp_data, int len);
 void           imp_free_packet(struct imp_device *imp, struct imp_packet *p);
 struct imp_packet * imp_get_packet(struct imp_device *imp);
@@ -861,6 +865,7 @@ t_stat imp_devio(uint32 dev, uint64 *data)
 {
     DEVICE *dptr = &imp_dev;
     UNIT   *uptr = imp_unit;
+    int     idone = (uptr->STATUS & IMPID) != 0;
 
     switch(dev & 07) {
     case CONO:
@@ -944,6 +949,9 @@ t_stat imp_devio(uint32 dev, uint64 *data)
              check_interrupts(uptr);
              break;
         }
+        /* If input done was just cleared, fetch the next packet now */
+        if (idone && (uptr->STATUS & IMPID) == 0 && !sim_is_active(uptr))
+            sim_activate(uptr, 100);
         break;
     case CONI:
         switch (GET_DTYPE(uptr->flags)) {
@@ -1212,11 +1220,28 @@ t_stat imp_srv(UNIT * uptr)
         check_interrupts (uptr);
     }
 #endif
-    if (uptr->ILEN == 0 && (uptr->STATUS & (IMPIB|IMPID)) == 0)
-        imp_packet_in(&imp_data);
+    imp_input_poll(uptr);
     return SCPE_OK;
 }
 
+/*
+ * Read frames until one is queued for the host or none are left.
+ * ARP, DHCP and frames not for us are handled here right away
+ * instead of one per service call.
+ */
+void
+imp_input_poll(UNIT *uptr)
+{
+    int     n;
+
+    for (n = 0; n < 32; n++) {
+        if (uptr->ILEN != 0 || (uptr->STATUS & (IMPIB|IMPID)) != 0)
+            break;
+        if (!imp_packet_in(&imp_data))
+            break;
+    }
+}
+
 void
 ip_checksum(uint8 *chksum, uint8 *ptr, int len)
 {
@@ -1296,8 +1321,7 @@ t_stat imp_eth_srv(UNIT * uptr)
     sim_clock_coschedule(uptr, 1000);              /* continue poll */
 
     imp_timer_task(&imp_data);
-    if (uptr->ILEN == 0 && (uptr->STATUS & (IMPIB|IMPID)) == 0)
-        imp_packet_in(&imp_data);
+    imp_input_poll(&imp_unit[0]);
 
     if (imp_data.init_state >= 3 && imp_data.init_state < 6) {
        if (imp_unit[0].flags & UNIT_DHCP &&
@@ -1339,13 +1363,10 @@ imp_timer_task(struct imp_device *imp)
     int                 n;
 
     /* Scan through adjusted ports and remove old ones */
-    for (n = 0; n < 64; n++) {
+    for (n = 0; n < 64 && imp->port_maps != 0; n++) {
         if (imp->port_map[n].cls_tim > 0) {
-            if (--imp->port_map[n].cls_tim == 0) {
-                imp->port_map[n].dport = 0;
-                imp->port_map[n].sport = 0;
-                imp->port_map[n].adj = 0;
-            }
+            if (--imp->port_map[n].cls_tim == 0)
+                imp_port_release(imp, &imp->port_map[n]);
         }
     }
 
@@ -1379,7 +1400,10 @@ t_stat imp_tim_srv(UNIT * uptr)
     return SCPE_OK;
 }
 
-void
+/*
+ * Process one received frame.  Returns 0 if there was none.
+ */
+int
 imp_packet_in(struct imp_device *imp)
 {
    ETH_PACK                read_buffer;
@@ -1402,7 +1426,7 @@ imp_packet_in(struct imp_device *imp)
                sim_activate(&imp_unit[0], 100);
            imp->rfnm_count--;
        }
-       return;
+       return 0;
    }
    imp_packet_debug(imp, "Received", &read_buffer);
    hdr = (struct imp_eth_hdr *)(&read_buffer.msg[0]);
@@ -1423,7 +1447,7 @@ imp_packet_in(struct imp_device *imp)
                ntohs(udp_hdr->udp_dport) == DHCP_UDP_PORT_CLIENT &&
                ntohs(udp_hdr->udp_sport) == DHCP_UDP_PORT_SERVER) {
               imp_do_dhcp_client(imp, &read_buffer);
-              return;
+              return 1;
            }
        }
        /* Process as IP if it is for us */
@@ -1475,27 +1499,22 @@ imp_packet_in(struct imp_device *imp)
                               (uint8 *)(&ip_hdr->ip_dst), sizeof(in_addr_T),
                               (uint8 *)(&imp_data.hostip), sizeof(in_addr_T));
                    if ((ntohs(tcp_hdr->flags) & 0x10) != 0) {
-                       for (n = 0; n < 64; n++) {
-                           if (imp->port_map[n].sport == sport &&
-                               imp->port_map[n].dport == dport) {
-                               /* Check if SYN */
-                               if (ntohs(tcp_hdr->flags) & 02) {
-                                   imp->port_map[n].sport = 0;
-                                   imp->port_map[n].dport = 0;
-                                   imp->port_map[n].adj = 0;
-                               } else {
-                                   uint32   new_seq = ntohl(tcp_hdr->ack);
-                                   if (new_seq > imp->port_map[n].lseq) {
-                                       new_seq = htonl(new_seq - imp->port_map[n].adj);
-                                       checksumadjust((uint8 *)&tcp_hdr->chksum,
-                                               (uint8 *)(&tcp_hdr->ack), 4,
-                                               (uint8 *)(&new_seq), 4);
-                                       tcp_hdr->ack = new_seq;
-                                   }
+                       struct imp_map *map = imp_port_lookup(imp, sport, dport, 0);
+                       if (map != NULL) {
+                           /* Check if SYN */
+                           if (ntohs(tcp_hdr->flags) & 02) {
+                               imp_port_release(imp, map);
+                           } else {
+                               uint32   new_seq = ntohl(tcp_hdr->ack);
+                               if (new_seq > map->lseq) {
+                                   new_seq = htonl(new_seq - map->adj);
+                                   checksumadjust((uint8 *)&tcp_hdr->chksum,
+                                           (uint8 *)(&tcp_hdr->ack), 4,
+                                           (uint8 *)(&new_seq), 4);
+                                   tcp_hdr->ack = new_seq;
                                }
                                if (ntohs(tcp_hdr->flags) & 01)
-                                   imp->port_map[n].cls_tim = 100;
-                               break;
+                                   map->cls_tim = 100;
                            }
                        }
                     }
@@ -1526,23 +1545,12 @@ imp_packet_in(struct imp_device *imp)
                        memcpy(tcp_payload, port_buffer, nlen);
                        /* Check if we need to update the sequence numbers */
                        if (nlen != l && (ntohs(tcp_hdr->flags) & 02) == 0) {
-                           int n = -1;
                            /* See if we need to change the sequence number */
-                           for (i = 0; i < 64; i++) {
-                               if (imp->port_map[i].sport == sport &&
-                                   imp->port_map[i].dport == dport) {
-                                   n = i;
-                                   break;
-                               }
-                               if (n < 0 && imp->port_map[i].dport == 0)
-                                   n = 0;
-                           }
-                           if (n >= 0) {
-                               imp->port_map[n].dport = dport;
-                               imp->port_map[n].sport = sport;
-                               imp->port_map[n].adj += nlen - l;
-                               imp->port_map[n].cls_tim = 0;
-                               imp->port_map[n].lseq = ntohl(tcp_hdr->seq);
+                           struct imp_map *map = imp_port_lookup(imp, sport, dport, 1);
+                           if (map != NULL) {
+                               map->adj += nlen - l;
+                               map->cls_tim = 0;
+                               map->lseq = ntohl(tcp_hdr->seq);
                            }
                        }
                        /* Now we need to update the checksums */
@@ -1567,7 +1575,7 @@ imp_packet_in(struct imp_device *imp)
                         htons(udp_hdr->udp_dport) == DHCP_UDP_PORT_CLIENT &&
                         htons(udp_hdr->udp_sport) == DHCP_UDP_PORT_SERVER) {
                         imp_do_dhcp_client(imp, &read_buffer);
-                        return;
+                        return 1;
                     }
                     checksumadjust((uint8 *)&udp_hdr->chksum,
                               (uint8 *)(&ip_hdr->ip_src), sizeof(in_addr_T),
@@ -1604,6 +1612,7 @@ imp_packet_in(struct imp_device *imp)
        }
          /* Otherwise just ignore it */
    }
+   return 1;
 }
 
 void
@@ -1696,6 +1705,48 @@ imp_send_packet (struct imp_device *imp, int len)
     return;
 }
 
+/*
+ * Find the sequence adjustment for a TCP port pair.  If create is set
+ * and there is none, claim a free entry for it.  Most connections never
+ * have one, so nothing is scanned while the table is empty.
+ */
+struct imp_map *
+imp_port_lookup(struct imp_device *imp, uint16 sport, uint16 dport, int create)
+{
+    struct imp_map *free_map = NULL;
+    int             i;
+
+    if (imp->port_maps == 0 && !create)
+        return NULL;
+    for (i = 0; i < 64; i++) {
+        struct imp_map *map = &imp->port_map[i];
+        if (map->sport == sport && map->dport == dport && map->dport != 0)
+            return map;
+        if (free_map == NULL && map->dport == 0)
+            free_map = map;
+    }
+    if (!create || free_map == NULL)
+        return NULL;
+    free_map->sport = sport;
+    free_map->dport = dport;
+    free_map->adj = 0;
+    free_map->cls_tim = 0;
+    imp->port_maps++;
+    return free_map;
+}
+
+void
+imp_port_release(struct imp_device *imp, struct imp_map *map)
+{
+    if (map->dport == 0)
+        return;
+    map->sport = 0;
+    map->dport = 0;
+    map->adj = 0;
+    map->cls_tim = 0;
+    imp->port_maps--;
+}
+
 /*
  * Check if this packet can be sent to given IP.
  * If it can we fill in the mac address and return false.
@@ -1727,27 +1778,24 @@ imp_packet_out(struct imp_device *imp, ETH_PACK *packet) {
                        (uint8 *)(&pkt->iphdr.ip_src), sizeof(in_addr_T),
                        (uint8 *)(&imp->ip), sizeof(in_addr_T));
            /* See if we need to change the sequence number */
-           for (i = 0; i < 64; i++) {
-               if (imp->port_map[i].sport == sport &&
-                   imp->port_map[i].dport == dport) {
+           {
+               struct imp_map *map = imp_port_lookup(imp, sport, dport, 0);
+               if (map != NULL) {
                    /* Check if SYN */
                    if (ntohs(tcp_hdr->flags) & 02) {
-                       imp->port_map[i].sport = 0;
-                       imp->port_map[i].dport = 0;
-                       imp->port_map[i].adj = 0;
+                       imp_port_release(imp, map);
                    } else {
                        uint32   new_seq = ntohl(tcp_hdr->seq);
-                       if (new_seq > imp->port_map[i].lseq) {
-                           new_seq = htonl(new_seq + imp->port_map[i].adj);
+                       if (new_seq > map->lseq) {
+                           new_seq = htonl(new_seq + map->adj);
                            checksumadjust((uint8 *)&tcp_hdr->chksum,
                                    (uint8 *)(&tcp_hdr->seq), 4,
                                    (uint8 *)(&new_seq), 4);
                            tcp_hdr->seq = new_seq;
                        }
+                       if (ntohs(tcp_hdr->flags) & 01)
+                           map->cls_tim = 100;
                    }
-                   if (ntohs(tcp_hdr->flags) & 01)
-                       imp->port_map[i].cls_tim = 100;
-                   break;
                }
            }
            /* Check if sending to FTP */
@@ -1774,23 +1822,12 @@ imp_packet_out(struct imp_device *imp, ETH_PACK *packet) {
                memcpy(tcp_payload, port_buffer, nlen);
                /* Check if we need to update the sequence numbers */
                if (nlen != l && (ntohs(tcp_hdr->flags) & 02) == 0) {
-                   int n = -1;
                    /* See if we need to change the sequence number */
-                   for (i = 0; i < 64; i++) {
-                       if (imp->port_map[i].sport == sport &&
-                           imp->port_map[i].dport == dport) {
-                           n = i;
-                           break;
-                       }
-                       if (n < 0 && imp->port_map[i].dport == 0)
-                           n = 0;
-                   }
-                   if (n >= 0) {
-                       imp->port_map[n].dport = dport;
-                       imp->port_map[n].sport = sport;
-                       imp->port_map[n].adj += nlen - l;
-                       imp->port_map[n].cls_tim = 0;
-                       imp->port_map[n].lseq = ntohl(tcp_hdr->seq);
+                   struct imp_map *map = imp_port_lookup(imp, sport, dport, 1);
+                   if (map != NULL) {
+                       map->adj += nlen - l;
+                       map->cls_tim = 0;
+                       map->lseq = ntohl(tcp_hdr->seq);
                    }
                }
                /* Now we need to update the checksums */
@@ -217,9 +217,11 @@ t_stat cpu_set_serial (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_show_serial (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 
 d10 adjsp (d10 val, a10 ea);
-void ibp (a10 ea, int32 pflgs);
+d10 ibp (a10 ea, int32 pflgs);
 d10 ldb (a10 ea, int32 pflgs);
+d10 ldbp (d10 bp, int32 pflgs);
 void dpb (d10 val, a10 ea, int32 pflgs);
+void dpbp (d10 val, d10 bp, int32 pflgs);
 void adjbp (int32 ac, a10 ea, int32 pflgs);
 d10 add (d10 val, d10 mb);
 d10 sub (d10 val, d10 mb);
@@ -542,7 +544,12 @@ static t_stat jrst_tab[16] = {
 
 /* Instruction operations */
 
-#define CIBP            if (!TSTF (F_FPD)) { ibp (ea, pflgs); SETF (F_FPD); }
+#define ILDB            if (TSTF (F_FPD)) LDB; \
+                        else { d10 bp = ibp (ea, pflgs); SETF (F_FPD); \
+                               AC(ac) = ldbp (bp, pflgs); }
+#define IDPB            if (TSTF (F_FPD)) DPB; \
+                        else { d10 bp = ibp (ea, pflgs); SETF (F_FPD); \
+                               dpbp (AC(ac), bp, pflgs); }
 #define LDB             AC(ac) = ldb (ea, pflgs)
 #define DPB             dpb (AC(ac), ea, pflgs)
 #define FAD(s)          fad (AC(ac), s, FALSE, 0)
@@ -972,9 +979,9 @@ case 0132:  AC(ac) = fsc (AC(ac), ea); break;           /* FSC */
 case 0133:  if (!ac) ibp (ea, pflgs);                   /* IBP */
             else adjbp (ac, ea, pflgs); 
             break;
-case 0134:  CIBP; LDB; CLRF (F_FPD); break;             /* ILBP */
+case 0134:  ILDB; CLRF (F_FPD); break;                  /* ILBP */
 case 0135:  LDB; break;                                 /* LDB */
-case 0136:  CIBP; DPB; CLRF (F_FPD); break;             /* IDBP */
+case 0136:  IDPB; CLRF (F_FPD); break;                  /* IDBP */
 case 0137:  DPB; break;                                 /* DPB */
 case 0140:  RD; AC(ac) = FAD (mb); break;               /* FAD */
 /* case 0141:   MUUO                                  *//* FADL */
@@ -1907,9 +1914,13 @@ return (mb & DMASK);
 
 /* Byte pointer routines */
 
-/* Increment byte pointer - checked against KS10 ucode */
+/* Increment byte pointer - checked against KS10 ucode
 
-void ibp (a10 ea, int32 pflgs)
+   The updated pointer is returned, so that ILDB and IDPB can use it
+   without reading it back through the pager.
+*/
+
+d10 ibp (a10 ea, int32 pflgs)
 {
 int32 p, s;
 d10 bp;
@@ -1924,18 +1935,22 @@ if (p < 0) {                                            /* end of word? */
     }
 bp = PUT_P (bp, p);                                     /* store new P */
 Write (ea, bp, MM_OPND);                                /* store byte ptr */
-return;
+return bp;
 }
 
 /* Load byte */
 
 d10 ldb (a10 ea, int32 pflgs)
 {
+return ldbp (Read (ea, MM_OPND), pflgs);                /* get byte ptr */
+}
+
+d10 ldbp (d10 bp, int32 pflgs)
+{
 a10 ba;
 int32 p, s;
-d10 bp, wd;
+d10 wd;
 
-bp = Read (ea, MM_OPND);                                /* get byte ptr */
 p = GET_P (bp);                                         /* get P and S */
 s = GET_S (bp);
 ba = calc_ea (bp, MM_EABP);                             /* get addr of byte */
@@ -1949,11 +1964,16 @@ return wd;
 
 void dpb (d10 val, a10 ea, int32 pflgs)
 {
+dpbp (val, Read (ea, MM_OPND), pflgs);                  /* get byte ptr */
+return;
+}
+
+void dpbp (d10 val, d10 bp, int32 pflgs)
+{
 a10 ba;
 int32 p, s;
-d10 bp, wd, mask;
+d10 wd, mask;
 
-bp = Read (ea, MM_OPND);                                /* get byte ptr */
 p = GET_P (bp);                                         /* get P and S */
 s = GET_S (bp);
 ba = calc_ea (bp, MM_EABP);                             /* get addr of byte */
@@ -2374,7 +2394,7 @@ set_dyn_ptrs ();
 set_ac_display (ac_cur);
 pi_eval ();
 if (M == NULL)
-    M = (d10 *) calloc (MAXMEMSIZE, sizeof (d10));
+    M = (d10 *) sim_mem_alloc (MAXMEMSIZE * sizeof (d10));
 if (M == NULL)
     return SCPE_MEM;
 sim_vm_pc_value = &pdp10_pc_value;
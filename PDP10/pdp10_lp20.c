@@ -185,6 +185,7 @@ static int32 dvptr = 0;                                 /* davfu pointer */
 static int32 dvlnt = 0;                                 /* davfu length */
 static int32 lp20_irq = 0;                              /* int request */
 static int32 lp20_stopioe = 0;                          /* stop on error */
+static int lp20_ioerr = 0;                              /* pending output error (errno) */
 static int32 dvld = 0;
 static int32 dvld_hold = 0;
 static int32 lpi = DEFAULT_LPI;                         /* Printer's LPI. */
@@ -208,6 +209,7 @@ static t_stat lp20_show_vfu_type (FILE *st, UNIT *up, int32 v, CONST void *dp);
 static t_stat lp20_show_vfu (FILE *st, UNIT *up, int32 v, CONST void *dp);
 static t_stat lp20_set_tof (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 static t_stat lp20_clear_vfu (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+static void lp20_putc (int32 c);
 static t_bool lp20_print (int32 c);
 static t_bool lp20_adv (int32 c, t_bool advdvu);
 static t_bool lp20_davfu (int32 c);
@@ -389,6 +391,8 @@ static MTAB lp20_mod[] = {
         NULL, "Advance to top-of-form" },
     { UNIT_DUMMY, 0, NULL, "VFUCLEAR", &lp20_clear_vfu, NULL,
         NULL, "Clear the VFU & Translation RAM" },
+    { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "SPOOL", "SPOOL=ROTATE=n{K|M|G};KEEP=n;{NO}COMPRESS",
+        &sim_spool_set, &sim_spool_show, NULL, "Output file rotation" },
     { 0 }
     };
 
@@ -725,9 +729,10 @@ lpbc = (lpbc + i) & BC_MASK;
 if (lpbc)                                               /* intr, but not done */
     update_lpcs (CSA_MBZ);
 else update_lpcs (CSA_DONE);                            /* intr and done */
-if ((fnc == FNC_PR) && ferror (uptr->fileref)) {
+if ((fnc == FNC_PR) && lp20_ioerr) {
+    errno = lp20_ioerr;
+    lp20_ioerr = 0;
     sim_perror ("LP I/O error");
-    clearerr (uptr->fileref);
     return SCPE_IOERR;
     }
 return SCPE_OK;
@@ -735,6 +740,7 @@ return SCPE_OK;
 
 /* Print routines
 
+   lp20_putc            spool a character to the output file
    lp20_print           print a character
    lp20_adv             advance n lines
    lp20_davfu           advance to channel on VFU
@@ -742,6 +748,13 @@ return SCPE_OK;
    Return TRUE to continue printing, FALSE to stop
 */
 
+static void lp20_putc (int32 c)
+{
+if (sim_spool_putc (lp20_unit, c) != SCPE_OK)
+    lp20_ioerr = errno ? errno : EIO;
+lp20_unit->pos = lp20_unit->pos + 1;
+}
+
 static t_bool lp20_print (int32 c)
 {
 t_bool r = TRUE;
@@ -771,8 +784,7 @@ else {
         r = lp20_adv (1, TRUE);                         /* adv carriage */
     }
 for (i = 0; i < rpt; i++)
-    fputc (lppdat, lp20_unit->fileref); 
-lp20_unit->pos = (t_addr)sim_ftell (lp20_unit->fileref);
+    lp20_putc (lppdat);
 lpcolc = lpcolc + rpt;
 return r;
 }
@@ -796,7 +808,7 @@ if (lpcsb & CSB_DVOF)
 
 lpcolc = 0;                                             /* reset col cntr */
 for (i = 0; i < cnt; i++) {                             /* print 'n' newlines; each can complete a page */
-    fputc ('\n', lp20_unit->fileref);
+    lp20_putc ('\n');
     if (dvuadv) {                                       /* update DAVFU ptr */
         dvptr = (dvptr + cnt) % dvlnt;
         if (davfu[dvptr] & (1 << DV_TOF)) {              /* at top of form? */
@@ -808,7 +820,6 @@ for (i = 0; i < cnt; i++) {                             /* print 'n' newlines; e
             } /* At TOF */
         } /* update pointer */
     }
-lp20_unit->pos = (t_addr)sim_ftell (lp20_unit->fileref);
 if (stoppc)                                            /* Crossed one or more TOFs? */
     return FALSE;
 
@@ -832,8 +843,7 @@ for (i = 0; i < dvlnt; i++) {                           /* search DAVFU */
             return lp20_adv (i + 1, FALSE);
         if (lpcolc)                                     /* TOF, need newline? */
             lp20_adv (1, FALSE);
-        fputc ('\f', lp20_unit->fileref);               /* print form feed */
-        lp20_unit->pos = (t_addr)sim_ftell (lp20_unit->fileref);
+        lp20_putc ('\f');                                /* print form feed */
         lppagc = (lppagc - 1) & PAGC_MASK;              /* decr page cntr */
         if (lppagc != 0)
             return TRUE;
@@ -939,7 +949,7 @@ lprdat = lppdat = lpcbuf = lpcsum = 0;
 lp20_irq = 0;                                           /* clear int req */
 sim_cancel (lp20_unit);                                /* deactivate unit */
 if (sim_is_active (lp20_unit+1)) {
-    fflush (lp20_unit->fileref);
+    sim_spool_flush (lp20_unit, FALSE);
     sim_cancel (lp20_unit+1);
     }
 update_lpcs (0);                                        /* update status */
@@ -951,7 +961,7 @@ static t_stat lp20_attach (UNIT *uptr, CONST char *cptr)
 t_stat reason;
 
 sim_switches |= SWMASK ('A');                           /* position to EOF */
-reason = attach_unit (uptr, cptr);                      /* attach file */
+reason = sim_spool_attach (uptr, cptr);                 /* attach file */
 if (lpcsa & CSA_DVON) {
     int i;
     for (i = 0; i < dvlnt; i++) {                       /* Align VFU with new file */
@@ -976,10 +986,8 @@ t_stat reason;
 
 if (!(uptr->flags & UNIT_ATT))                          /* attached? */
     return SCPE_OK;
-if (sim_is_active (lp20_unit+1)) {
-    fflush (lp20_unit->fileref);
-    sim_cancel (lp20_unit+1);
-}
+if (sim_is_active (lp20_unit+1))
+    sim_cancel (lp20_unit+1);                           /* detach writes out the spool */
 reason = detach_unit (uptr);
 sim_cancel (lp20_unit);
 lpcsa = lpcsa & ~CSA_GO;
@@ -1006,8 +1014,7 @@ if (--uptr->u4 > 0) {
     sim_activate_after (uptr, uptr->wait);
     return SCPE_OK;
 }
-uptr = lp20_unit+1;
-fflush (uptr->fileref);
+sim_spool_flush (lp20_unit, FALSE);                     /* let users see their output */
 return SCPE_OK;
 }
 
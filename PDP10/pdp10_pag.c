@@ -86,6 +86,7 @@
 #define PTBL_M          (1u << 31)                      /* must be sign bit */
 #define PTBL_V          (1u << 30)
 #define PTBL_MASK       (PAG_PPN | PTBL_M | PTBL_V)
+#define PTBL_LOG_MAX    64                              /* fill log size */
 
 /* NXM processing */
 
@@ -109,11 +110,19 @@ int32 uptbl[PTBL_MEMSIZE];                              /* user page table */
 int32 physptbl[PTBL_MEMSIZE];                           /* phys page table */
 int32 *ptbl_cur, *ptbl_prv;
 int32 save_ea;
+int32 ptbl_log[PTBL_LOG_MAX];                           /* filled entries */
+int32 ptbl_nlog = 0;                                    /* # logged, > max if lost */
+uint32 pag_fills = 0;                                   /* statistics */
+uint32 pag_flushes = 0;
+uint32 pag_full_flushes = 0;
 
 int32 ptbl_fill (a10 ea, int32 *ptbl, int32 mode);
+void ptbl_set (int32 *tbl, int32 vpn, int32 xpte);
+void pag_flush (void);
 t_stat pag_ex (t_value *vptr, t_addr addr, UNIT *uptr, int32 sw);
 t_stat pag_dep (t_value val, t_addr addr, UNIT *uptr, int32 sw);
 t_stat pag_reset (DEVICE *dptr);
+t_stat pag_show_stats (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 void pag_nxm (a10 pa, int32 phys, int32 trap);
 
 /* Pager data structures
@@ -121,6 +130,7 @@ void pag_nxm (a10 pa, int32 phys, int32 trap);
    pag_dev      pager device descriptor
    pag_unit     pager units
    pager_reg    pager register list
+   pag_mod      pager modifier list
 */
 
 UNIT pag_unit[] = {
@@ -133,8 +143,14 @@ REG pag_reg[] = {
     { NULL }
     };
 
+MTAB pag_mod[] = {
+    { MTAB_XTD|MTAB_VDV|MTAB_NMO, 0, "STATISTICS", NULL,
+      NULL, &pag_show_stats },
+    { 0 }
+    };
+
 DEVICE pag_dev = {
-    "PAG", pag_unit, pag_reg, NULL,
+    "PAG", pag_unit, pag_reg, pag_mod,
     2, 8, PTBL_ASIZE, 1, 8, 32,
     &pag_ex, &pag_dep, &pag_reset,
     NULL, NULL, NULL,
@@ -351,8 +367,8 @@ if (Q_ITS) {                                            /* ITS paging */
             ((acc == ITS_ACC_RW)? PTBL_M: 0);
         decvpn = PAG_GETVPN (ea);                       /* get tlb idx */
         if (!(mode & PTF_CON)) {
-            tbl[decvpn & ~1] = xpte;                    /* map lo ITS page */
-            tbl[decvpn | 1] = xpte + PAG_SIZE;          /* map hi */
+            ptbl_set (tbl, decvpn & ~1, xpte);          /* map lo ITS page */
+            ptbl_set (tbl, decvpn | 1, xpte + PAG_SIZE);/* map hi */
             }
         return (xpte + ((decvpn & 1)? PAG_SIZE: 0));
         }
@@ -393,7 +409,7 @@ else if (!T20PAG) {                                     /* TOPS-10 paging */
         xpte = ((pte & PTE_PPMASK) << PAG_V_PN) |       /* calc exp pte */
             PTBL_V | ((pte & PTE_T10_W)? PTBL_M: 0);
         if (!(mode & PTF_CON))                          /* set tbl if ~cons */
-            tbl[vpn] = xpte;
+            ptbl_set (tbl, vpn, xpte);
         return xpte;
         }
     PAGE_FAIL_TRAP;
@@ -561,11 +577,55 @@ else {                                                  /* TOPS-20 paging */
         ((acc & PTE_T20_W)? PF_T20_W: 0) |
         ((acc & PTE_T20_C)? PF_C: 0);
     if (!(mode & PTF_CON))                              /* set tbl if ~cons */
-        tbl[vpn] = xpte;
+        ptbl_set (tbl, vpn, xpte);
     return xpte;
     }                                                   /* end TOPS20 paging */
 }
 
+/* Page table entry set and flush
+
+   Every entry filled is recorded in a small log, so that a flush
+   (WREBR, WRUBR, the ITS base register loads) only has to clear the
+   entries actually in use.  Once the log overflows, or an entry is
+   deposited from the console, the next flush clears both tables.
+*/
+
+void ptbl_set (int32 *tbl, int32 vpn, int32 xpte)
+{
+tbl[vpn] = xpte;
+pag_fills = pag_fills + 1;
+if (ptbl_nlog < PTBL_LOG_MAX) {                         /* room in log? */
+    if (tbl == uptbl)
+        ptbl_log[ptbl_nlog++] = vpn + PTBL_MEMSIZE;
+    else if (tbl == eptbl)
+        ptbl_log[ptbl_nlog++] = vpn;
+    }
+else ptbl_nlog = PTBL_LOG_MAX + 1;                      /* log lost */
+return;
+}
+
+void pag_flush (void)
+{
+int32 i, idx;
+
+pag_flushes = pag_flushes + 1;
+if (ptbl_nlog > PTBL_LOG_MAX) {                         /* log lost? */
+    memset (eptbl, 0, sizeof (eptbl));
+    memset (uptbl, 0, sizeof (uptbl));
+    pag_full_flushes = pag_full_flushes + 1;
+    }
+else {
+    for (i = 0; i < ptbl_nlog; i++) {                   /* clear logged */
+        idx = ptbl_log[i];
+        if (idx >= PTBL_MEMSIZE)
+            uptbl[idx - PTBL_MEMSIZE] = 0;
+        else eptbl[idx] = 0;
+        }
+    }
+ptbl_nlog = 0;
+return;
+}
+
 /* Set up pointers for AC, memory, and process table access */
 
 void set_dyn_ptrs (void)
@@ -664,7 +724,7 @@ return FALSE;
 t_bool wrebr (a10 ea, int32 prv)
 {
 ebr = ea & EBR_MASK;                                    /* store EBR */
-pag_reset (&pag_dev);                                   /* clear page tables */
+pag_flush ();                                           /* clear page tables */
 set_dyn_ptrs ();                                        /* set dynamic ptrs */
 return FALSE;
 }
@@ -685,7 +745,7 @@ if (val & UBR_SETACB)                                   /* set AC's? */
 else val = val & ~UBR_ACBMASK;                          /* no, keep old val */
 if (val & UBR_SETUBR) {                                 /* set UBR? */
     ubr = ubr & ~ubr_mask;
-    pag_reset (&pag_dev);                               /* yes, clr pg tbls */
+    pag_flush ();                                       /* yes, clr pg tbls */
     }
 else val = val & ~ubr_mask;                             /* no, keep old val */
 ubr = (ubr | val) & (UBR_ACBMASK | ubr_mask);
@@ -776,7 +836,7 @@ return FALSE;
 t_bool ldbr1 (a10 ea, int32 prv)
 {
 dbr1 = ea;
-pag_reset (&pag_dev);
+pag_flush ();
 return FALSE;
 }
 
@@ -789,7 +849,7 @@ return FALSE;
 t_bool ldbr2 (a10 ea, int32 prv)
 {
 dbr2 = ea;
-pag_reset (&pag_dev);
+pag_flush ();
 return FALSE;
 }
 
@@ -802,7 +862,7 @@ return FALSE;
 t_bool ldbr3 (a10 ea, int32 prv)
 {
 dbr3 = ea;
-pag_reset (&pag_dev);
+pag_flush ();
 return FALSE;
 }
 
@@ -815,7 +875,7 @@ return FALSE;
 t_bool ldbr4 (a10 ea, int32 prv)
 {
 dbr4 = ea;
-pag_reset (&pag_dev);
+pag_flush ();
 return FALSE;
 }
 
@@ -845,7 +905,7 @@ val = Read (ADDA (ea, 2), prv);
 dbr1 = (a10) (Read (ea, prv) & AMASK);
 dbr2 = (a10) (Read (ADDA (ea, 1), prv) & AMASK);
 quant = val;
-pag_reset (&pag_dev);
+pag_flush ();
 return FALSE;
 }
 
@@ -880,6 +940,7 @@ if (addr >= PTBL_MEMSIZE)
 if (tbln)
     uptbl[addr] = (int32) val & PTBL_MASK;
 else eptbl[addr] = (int32) val & PTBL_MASK;
+ptbl_nlog = PTBL_LOG_MAX + 1;                           /* not logged */
 return SCPE_OK;
 }
 
@@ -891,5 +952,15 @@ for (i = 0; i < PTBL_MEMSIZE; i++) {
     eptbl[i] = uptbl[i] = 0;
     physptbl[i] = (i << PAG_V_PN) + PTBL_M + PTBL_V;
     }
+ptbl_nlog = 0;
+return SCPE_OK;
+}
+
+t_stat pag_show_stats (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+fprintf (st, "Page table fills:   %u\n", pag_fills);
+fprintf (st, "Page table flushes: %u (%u full)\n", pag_flushes, pag_full_flushes);
+if (sim_switches & SWMASK ('C'))                        /* -C, clear counts */
+    pag_fills = pag_flushes = pag_full_flushes = 0;
 return SCPE_OK;
 }
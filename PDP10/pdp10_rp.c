@@ -98,6 +98,8 @@
 
 #define CYL             u3                              /* current cylinder */
 #define FUNC            u4                              /* function */
+#define io_status       u5                              /* io status from callback */
+#define io_complete     u6                              /* io completion flag */
 
 /* RPCS1 - 176700 - control/status 1 */
 
@@ -358,6 +360,9 @@ uint16 rpec1[RP_NUMDR] = { 0 };                         /* ECC correction 1 */
 uint16 rpec2[RP_NUMDR] = { 0 };                         /* ECC correction 2 */
 int32 rpiff = 0;                                        /* INTR flip/flop */
 int32 rp_stopioe = 1;                                   /* stop on error */
+static d10 rpxb[RP_MAXFR];                              /* xfer buffer */
+static int32 rpxwc = 0;                                 /* words gathered for write */
+static t_seccnt rpxsects = 0;                           /* sectors read */
 int32 rp_swait = 10;                                    /* seek time */
 int32 rp_rwait = 10;                                    /* rotate time */
 static int32 reg_in_drive[32] = {
@@ -369,6 +374,7 @@ t_stat rp_rd (int32 *data, int32 PA, int32 access);
 t_stat rp_wr (int32 data, int32 PA, int32 access);
 int32 rp_inta (void);
 t_stat rp_svc (UNIT *uptr);
+void rp_io_complete (UNIT *uptr, t_stat status);
 t_stat rp_reset (DEVICE *dptr);
 t_stat rp_boot (int32 unitno, DEVICE *dptr);
 t_stat rp_attach (UNIT *uptr, CONST char *cptr);
@@ -859,11 +865,28 @@ update_rpcs (CS1_SC, drv);                              /* req intr */
 return;
 }
 
+/* I/O completion callback */
+
+void rp_io_complete (UNIT *uptr, t_stat status)
+{
+uptr->io_status = status;
+uptr->io_complete = 1;
+sim_activate (uptr, 0);                                 /* run bottom end */
+return;
+}
+
 /* Service unit timeout
 
    Complete movement or data transfer command
    Unit must exist - can't remove an active unit
    Unit must be attached - detach cancels in progress operations
+
+   Data transfers are done in two halves.  The top end gathers a write
+   from memory and starts the disk transfer; the bottom end, run from
+   the completion callback, scatters a read into memory and finishes
+   the command.  With asynchronous I/O, the simulator keeps running
+   while the host transfer is in progress; the drive is not ready and
+   GO stays set until the bottom end.
 */
 
 t_stat rp_svc (UNIT *uptr)
@@ -872,7 +895,6 @@ int32 i, dtype, drv;
 int32 ba, da, vpn;
 a10 pa10, mpa10;
 int32 wc10, twc10, awc10, fc10;
-static d10 dbuf[RP_MAXFR];
 t_stat r;
 
 dtype = GET_DTYPE (uptr->flags);                        /* get drive type */
@@ -884,6 +906,8 @@ if ((uptr->flags & UNIT_UTS) == 0) {                    /* Transition to up-to-s
     update_rpcs (CS1_SC, drv);
     return SCPE_OK;
     }
+if (uptr->io_complete)                                  /* transfer done? */
+    goto bottom;
 rpds[drv] = (rpds[drv] & ~DS_PIP) | DS_RDY;             /* change drive status */
 
 switch (uptr->FUNC) {                                   /* case on function */
@@ -896,7 +920,7 @@ switch (uptr->FUNC) {                                   /* case on function */
     case FNC_RETURN:                                    /* return to centerline */
         rpds[drv] = (rpds[drv] & ~DS_OF) | DS_ATA;      /* clear offset, set attn */
         update_rpcs (CS1_SC, drv);
-        break;  
+        break;
 
     case FNC_UNLOAD:                                    /* unload */
         rp_detach (uptr);                               /* detach unit */
@@ -956,72 +980,28 @@ switch (uptr->FUNC) {                                   /* case on function */
                     ubcs[0] = ubcs[0] | UBCS_TMO;       /* UBA times out */
                     break;
                     }
-                dbuf[twc10] = M[mpa10];                 /* write to disk */
+                rpxb[twc10] = M[mpa10];                 /* write to disk */
                 if ((rpcs2 & CS2_UAI) == 0)
                     ba = ba + 4;
                 }
             if ((fc10 = twc10 & (RP_NUMWD - 1))) {      /* fill? */
                 fc10 = RP_NUMWD - fc10;
                 for (i = 0; i < fc10; i++)
-                    dbuf[twc10 + i] = 0;
+                    rpxb[twc10 + i] = 0;
                 }
-            r = sim_disk_wrsect (uptr, da/RP_NUMWD, (uint8 *)dbuf,
-                                 NULL, (twc10 + fc10 + RP_NUMWD - 1)/RP_NUMWD);
+            rpxwc = twc10;                              /* save for bottom */
+            rpds[drv] = rpds[drv] & ~DS_RDY;            /* busy until done */
+            sim_disk_wrsect_a (uptr, da/RP_NUMWD, (uint8 *)rpxb,
+                               NULL, (twc10 + fc10 + RP_NUMWD - 1)/RP_NUMWD,
+                               rp_io_complete);
             }                                           /* end if */
         else {                                          /* read, wchk, readh */
-            t_seccnt sectsread;
-
-            r = sim_disk_rdsect (uptr, da/RP_NUMWD, (uint8 *)dbuf,
-                                 &sectsread, (wc10 + RP_NUMWD - 1)/RP_NUMWD);
-            awc10 = sectsread * RP_NUMWD;
-            for ( ; awc10 < wc10; awc10++)
-                dbuf[awc10] = 0;
-            for (twc10 = 0; twc10 < wc10; twc10++) {
-                pa10 = ba >> 2;
-                vpn = PAG_GETVPN (pa10);                /* map addr */
-                if ((vpn >= UMAP_MEMSIZE) || (ba & XBA_MBZ) || (rpwc & XWC_MBZ) ||
-                  ((ubmap[0][vpn] & (UMAP_VLD | UMAP_DSB | UMAP_RRV)) != UMAP_VLD)) {
-                    rpcs2 = rpcs2 | CS2_NEM;            /* set error */
-                    ubcs[0] = ubcs[0] | UBCS_TMO;       /* UBA times out */
-                    break;
-                    }
-                mpa10 = (ubmap[0][vpn] + PAG_GETOFF (pa10)) & PAMASK;
-                if (MEM_ADDR_NXM (mpa10)) {             /* nx memory? */
-                    rpcs2 = rpcs2 | CS2_NEM;            /* set error */
-                    ubcs[0] = ubcs[0] | UBCS_TMO;       /* UBA times out */
-                    break;
-                    }
-                if ((uptr->FUNC == FNC_READ) ||         /* read or */
-                    (uptr->FUNC == FNC_READH))          /* read header */
-                     M[mpa10] = dbuf[twc10];
-                else if (M[mpa10] != dbuf[twc10]) {     /* wchk, mismatch? */
-                     rpcs2 = rpcs2 | CS2_WCE;           /* set error */
-                     break;
-                     }
-                if ((rpcs2 & CS2_UAI) == 0)
-                    ba = ba + 4;
-                }
+            rpds[drv] = rpds[drv] & ~DS_RDY;            /* busy until done */
+            sim_disk_rdsect_a (uptr, da/RP_NUMWD, (uint8 *)rpxb,
+                               &rpxsects, (wc10 + RP_NUMWD - 1)/RP_NUMWD,
+                               rp_io_complete);
             }                                           /* end else */
-
-        rpwc = (rpwc + (twc10 << 1)) & 0177777;         /* final word count */
-        rpba = (ba & 0177777) & ~BA_MBZ;                /* lower 16b */
-        rpcs1 = (rpcs1 & ~ CS1_UAE) | ((ba >> (16 - CS1_V_UAE)) & CS1_UAE);
-        da = da + twc10 + (RP_NUMWD - 1);
-        if (da >= drv_tab[dtype].size)
-            rpds[drv] = rpds[drv] | DS_LST;
-        da = da / RP_NUMWD;
-        rpda[drv] = (uint16)(da % drv_tab[dtype].sect);
-        da = da / drv_tab[dtype].sect;
-        rpda[drv] = (uint16)(rpda[drv] | ((da % drv_tab[dtype].surf) << DA_V_SF));
-        rpdc[drv] = (uint16)(da / drv_tab[dtype].surf);
-
-        if (r != SCPE_OK) {                             /* error? */
-            set_rper (ER1_PAR, drv);                    /* set drive error */
-            update_rpcs (CS1_DONE | CS1_TRE, drv);      /* set done, err */
-            sim_printf ("RP I/O error");
-            return SCPE_IOERR;
-            }
-        /* fall through */
+        return SCPE_OK;
 
     case FNC_WRITEH:                                    /* write headers stub */
         update_rpcs (CS1_DONE, drv);                    /* set done */
@@ -1029,6 +1009,76 @@ switch (uptr->FUNC) {                                   /* case on function */
         }                                               /* end case func */
 
 return SCPE_OK;
+
+/* Bottom end of a read, write check, read headers or write */
+
+bottom:
+uptr->io_complete = 0;
+r = uptr->io_status;
+rpds[drv] = (rpds[drv] & ~DS_PIP) | DS_RDY;             /* change drive status */
+ba = GET_UAE (rpcs1) | rpba;                            /* get byte addr */
+wc10 = (0200000 - rpwc) >> 1;                           /* get PDP-10 wc */
+da = GET_DA (rpdc[drv], rpda[drv], dtype) * RP_NUMWD;   /* get disk addr */
+if ((da + wc10) > drv_tab[dtype].size) {                /* disk overrun? */
+    if (wc10 > (drv_tab[dtype].size - da))
+        wc10 = drv_tab[dtype].size - da;
+    }
+if (uptr->FUNC == FNC_WRITE) {                          /* write? */
+    twc10 = rpxwc;                                      /* words gathered */
+    if ((rpcs2 & CS2_UAI) == 0)
+        ba = ba + (twc10 << 2);
+    }
+else {                                                  /* read, wchk, readh */
+    awc10 = rpxsects * RP_NUMWD;
+    for ( ; awc10 < wc10; awc10++)
+        rpxb[awc10] = 0;
+    for (twc10 = 0; twc10 < wc10; twc10++) {
+        pa10 = ba >> 2;
+        vpn = PAG_GETVPN (pa10);                        /* map addr */
+        if ((vpn >= UMAP_MEMSIZE) || (ba & XBA_MBZ) || (rpwc & XWC_MBZ) ||
+          ((ubmap[0][vpn] & (UMAP_VLD | UMAP_DSB | UMAP_RRV)) != UMAP_VLD)) {
+            rpcs2 = rpcs2 | CS2_NEM;                    /* set error */
+            ubcs[0] = ubcs[0] | UBCS_TMO;               /* UBA times out */
+            break;
+            }
+        mpa10 = (ubmap[0][vpn] + PAG_GETOFF (pa10)) & PAMASK;
+        if (MEM_ADDR_NXM (mpa10)) {                     /* nx memory? */
+            rpcs2 = rpcs2 | CS2_NEM;                    /* set error */
+            ubcs[0] = ubcs[0] | UBCS_TMO;               /* UBA times out */
+            break;
+            }
+        if ((uptr->FUNC == FNC_READ) ||                 /* read or */
+            (uptr->FUNC == FNC_READH))                  /* read header */
+             M[mpa10] = rpxb[twc10];
+        else if (M[mpa10] != rpxb[twc10]) {             /* wchk, mismatch? */
+             rpcs2 = rpcs2 | CS2_WCE;                   /* set error */
+             break;
+             }
+        if ((rpcs2 & CS2_UAI) == 0)
+            ba = ba + 4;
+        }
+    }                                                   /* end else */
+
+rpwc = (rpwc + (twc10 << 1)) & 0177777;                 /* final word count */
+rpba = (ba & 0177777) & ~BA_MBZ;                        /* lower 16b */
+rpcs1 = (rpcs1 & ~ CS1_UAE) | ((ba >> (16 - CS1_V_UAE)) & CS1_UAE);
+da = da + twc10 + (RP_NUMWD - 1);
+if (da >= drv_tab[dtype].size)
+    rpds[drv] = rpds[drv] | DS_LST;
+da = da / RP_NUMWD;
+rpda[drv] = (uint16)(da % drv_tab[dtype].sect);
+da = da / drv_tab[dtype].sect;
+rpda[drv] = (uint16)(rpda[drv] | ((da % drv_tab[dtype].surf) << DA_V_SF));
+rpdc[drv] = (uint16)(da / drv_tab[dtype].surf);
+
+if (r != SCPE_OK) {                                     /* error? */
+    set_rper (ER1_PAR, drv);                            /* set drive error */
+    update_rpcs (CS1_DONE | CS1_TRE, drv);              /* set done, err */
+    sim_printf ("RP I/O error");
+    return SCPE_IOERR;
+    }
+update_rpcs (CS1_DONE, drv);                            /* set done */
+return SCPE_OK;
 }
 
 /* Set drive error */
@@ -1111,6 +1161,7 @@ int_req = int_req & ~INT_RP;                            /* clear intr req */
 for (i = 0; i < RP_NUMDR; i++) {
     uptr = rp_dev.units + i;
     uptr->CYL = uptr->FUNC = 0;
+    uptr->io_complete = 0;                              /* no xfer pending */
     if (uptr->flags & UNIT_ATT)
         if (uptr->flags & UNIT_UTS) {
             sim_cancel (uptr);
@@ -1174,6 +1225,7 @@ rpds[drv] = (rpds[drv] & ~(DS_MOL | DS_RDY | DS_WRL | DS_VV | DS_OF)) |
     DS_ATA;
 if (sim_is_active (uptr)) {                             /* unit active? */
     sim_cancel (uptr);                                  /* cancel operation */
+    uptr->io_complete = 0;
     if (uptr->flags & UNIT_UTS) {
         rper1[drv] = rper1[drv] | ER1_OPI;              /* set drive error */
         if (uptr->FUNC >= FNC_WCHK)                     /* data transfer? */
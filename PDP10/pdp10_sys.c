@@ -248,6 +248,19 @@ for ( ;; ) {                                            /* loop until JRST */
 return SCPE_OK;
 }
 
+/* Disk format (SAV and EXE) images are parsed in place from memory.
+   Their 36b words are stored as 64b little endian values, so runs of
+   words can be copied straight into M. */
+
+static t_bool load_word (const SIM_LOAD_IMAGE *image, size_t *wp, d10 *data)
+{
+if (((*wp + 1) * sizeof (d10)) > image->size)           /* past end? */
+    return FALSE;
+sim_buf_copy_swapped (data, image->data + (*wp * sizeof (d10)), sizeof (d10), 1);
+*wp = *wp + 1;
+return TRUE;
+}
+
 /* SAV file loader
 
    SAV format is a disk file format (36b words).  It consists of
@@ -261,20 +274,27 @@ return SCPE_OK;
         JRST start
 */
 
-t_stat load_sav (FILE *fileref)
+t_stat load_sav (const SIM_LOAD_IMAGE *image)
 {
 d10 count, data;
 a10 pa;
-int32 wc, op;
+int32 op;
+size_t wp = 0, wc;
 
 for ( ;; ) {                                            /* loop */
-    wc = fxread (&count, sizeof (d10), 1, fileref);     /* read IOWD */
-    if (wc == 0)                                        /* done? */
-        return SCPE_OK;
+    if (!load_word (image, &wp, &count))                /* read IOWD */
+        return SCPE_OK;                                 /* done */
     if (TSTS (count)) {                                 /* IOWD? */
+        wc = 01000000 - LRZ (count);                    /* word count */
+        pa = ((a10) count + 1) & AMASK;                 /* origin */
+        if ((((wp + wc) * sizeof (d10)) <= image->size) &&  /* all there and */
+            ((pa + wc - 1) <= AMASK)) {                 /* no wrap? */
+            sim_buf_copy_swapped (&M[pa], image->data + (wp * sizeof (d10)), sizeof (d10), wc);
+            wp = wp + wc;
+            continue;
+            }
         for ( ; TSTS (count); count = AOB (count)) {
-            wc = fxread (&data, sizeof (d10), 1, fileref);
-            if (wc == 0)
+            if (!load_word (image, &wp, &data))
                 return SCPE_FMT;
             pa = ((a10) count + 1) & AMASK;             /* store data */
             M[pa] = data;
@@ -317,18 +337,18 @@ return SCPE_OK;
 
 #define DIRSIZ  (2 * PAG_SIZE)
 
-t_stat load_exe (FILE *fileref)
+t_stat load_exe (const SIM_LOAD_IMAGE *image)
 {
-d10 data, dirbuf[DIRSIZ], pagbuf[PAG_SIZE], entbuf[2];
-int32 ndir, entvec, i, j, k, cont, bsz, bty, rpt, wc;
+d10 data, dirbuf[DIRSIZ], entbuf[2];
+int32 ndir, entvec, i, j, k, cont, bsz, bty, rpt;
 int32 fpage, mpage;
 a10 ma;
+size_t wp = 0;
 
 ndir = entvec = 0;                                      /* no dir, entvec */
 cont = 1;
 do {
-    wc = fxread (&data, sizeof (d10), 1, fileref);      /* read blk hdr */
-    if (wc == 0)                                        /* error? */
+    if (!load_word (image, &wp, &data))                 /* read blk hdr */
         return SCPE_FMT;
     bsz = (int32) ((data & RMASK) - 1);                 /* get count */
     if (bsz < 0)                                        /* zero? */
@@ -337,23 +357,25 @@ do {
     switch (bty) {                                      /* case type */
 
     case EXE_DIR:                                       /* directory */
-        if (ndir != 0)                                  /* got one */
-            return SCPE_FMT;
-        ndir = fxread (dirbuf, sizeof (d10), bsz, fileref);
-        if (ndir < bsz)                                 /* error */
+        if ((ndir != 0) || (bsz > DIRSIZ))              /* got one? */
             return SCPE_FMT;
+        for (ndir = 0; ndir < bsz; ndir++) {
+            if (!load_word (image, &wp, &dirbuf[ndir])) /* error */
+                return SCPE_FMT;
+            }
         break;
 
     case EXE_PDV:                                       /* optional */
-        (void)fseek (fileref, bsz * sizeof (d10), SEEK_CUR);/* skip data */
+        wp = wp + bsz;                                  /* skip data */
         break;
 
     case EXE_VEC:                                       /* entry vec */
         if (bsz != 2)                                   /* must be 2 wds */
             return SCPE_FMT;
-        entvec = fxread (entbuf, sizeof (d10), bsz, fileref);
-        if (entvec < 2)                                 /* error? */
-            return SCPE_FMT;
+        for (entvec = 0; entvec < bsz; entvec++) {
+            if (!load_word (image, &wp, &entbuf[entvec]))   /* error? */
+                return SCPE_FMT;
+            }
         cont = 0;                                       /* stop */
         break;
 
@@ -373,19 +395,22 @@ for (i = 0; i < ndir; i = i + 2) {                      /* loop thru dir */
     mpage = (int32) (dirbuf[i + 1] & RMASK);            /* memory page */
     rpt = ((int32) ((dirbuf[i + 1] >> 27) + 1)) & 0777; /* repeat count */
     for (j = 0; j < rpt; j++, mpage++) {                /* loop thru rpts */
-        if (fpage) {                                    /* file pages? */
-            (void)fseek (fileref, (fpage << PAG_V_PN) * sizeof (d10), SEEK_SET);
-            wc = fxread (pagbuf, sizeof (d10), PAG_SIZE, fileref);
-            if (wc < PAG_SIZE)
-                return SCPE_FMT;
+        size_t fpos = ((size_t) fpage << PAG_V_PN) * sizeof (d10);
+
+        if (fpage &&                                    /* file page short? */
+            ((fpos + (PAG_SIZE * sizeof (d10))) > image->size))
+            return SCPE_FMT;
+        ma = mpage << PAG_V_PN;                         /* mem addr */
+        if (MEM_ADDR_NXM (ma))                          /* pages are all */
+            return SCPE_NXM;                            /* in or out of mem */
+        if (fpage) {                                    /* copy page to mem */
+            sim_buf_copy_swapped (&M[ma], image->data + fpos, sizeof (d10), PAG_SIZE);
+            for (k = 0; k < PAG_SIZE; k++)
+                M[ma + k] = M[ma + k] & DMASK;
             fpage++;
             }
-        ma = mpage << PAG_V_PN;                         /* mem addr */
-        for (k = 0; k < PAG_SIZE; k++, ma++) {          /* copy buf to mem */
-            if (MEM_ADDR_NXM (ma))
-                return SCPE_NXM;
-            M[ma] = fpage? (pagbuf[k] & DMASK): 0;
-            }                                           /* end copy */
+        else
+            memset (&M[ma], 0, PAG_SIZE * sizeof (d10));
         }                                               /* end rpt */
     }                                                   /* end directory */
 if (entvec && entbuf[1])
@@ -399,6 +424,8 @@ t_stat sim_load (FILE *fileref, CONST char *cptr, CONST char *fnam, int flag)
 {
 d10 data;
 int32 wc, fmt;
+SIM_LOAD_IMAGE image;
+t_stat r;
 
 fmt = 0;                                                /* no fmt */
 if (sim_switches & SWMASK ('R'))                        /* -r? */
@@ -433,10 +460,13 @@ switch (fmt) {                                          /* case fmt */
         return load_rim (fileref);
 
     case FMT_S:                                         /* SAV */
-        return load_sav (fileref);
-
     case FMT_E:                                         /* EXE */
-        return load_exe (fileref);
+        r = sim_load_image_open (fileref, &image);
+        if (r != SCPE_OK)
+            return r;
+        r = (fmt == FMT_S)? load_sav (&image): load_exe (&image);
+        sim_load_image_close (&image);
+        return r;
         }
 
 sim_printf ("Can't determine load file format\n");
@@ -608,7 +608,12 @@ bp = PUT_P (bp, p);                                     /* store new P */
 return bp;
 }
 
-/* Increment and load byte, extended version - uses register log */
+/* Increment and load byte, extended version - uses register log
+
+   String instructions normally use plain local pointers, so the
+   effective address calculation is skipped unless the pointer is
+   indexed or indirect.
+*/
 
 d10 incloadbp (int32 ac, int32 pflgs)
 {
@@ -620,7 +625,9 @@ bp = AC(ac) = incbp (AC(ac));                           /* increment bp */
 XT_INSRLOG (ac, rlog);                                  /* log change */
 p = GET_P (bp);                                         /* get P and S */
 s = GET_S (bp);
-ba = calc_ea (bp, MM_EA_XSRC);                          /* calc bp eff addr */
+if (bp & (INST_IND | (INST_M_XR << INST_V_XR)))        /* indexed, indirect? */
+    ba = calc_ea (bp, MM_EA_XSRC);                      /* calc bp eff addr */
+else ba = GET_ADDR (bp);                                /* no, use Y */
 wd = Read (ba, MM_XSRC);                                /* read word */
 wd = (wd >> p) & bytemask[s];                           /* get byte */
 return wd;
@@ -638,7 +645,9 @@ bp = AC(ac) = incbp (AC(ac));                           /* increment bp */
 XT_INSRLOG (ac, rlog);                                  /* log change */
 p = GET_P (bp);                                         /* get P and S */
 s = GET_S (bp);
-ba = calc_ea (bp, MM_EA_XDST);                          /* calc bp eff addr */
+if (bp & (INST_IND | (INST_M_XR << INST_V_XR)))        /* indexed, indirect? */
+    ba = calc_ea (bp, MM_EA_XDST);                      /* calc bp eff addr */
+else ba = GET_ADDR (bp);                                /* no, use Y */
 wd = Read (ba, MM_XDST);                                /* read, write test */
 mask = bytemask[s] << p;                                /* shift mask, val */
 val = val << p;
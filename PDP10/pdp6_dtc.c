@@ -1195,6 +1195,7 @@ dtc_attach (UNIT *uptr, CONST char *cptr)
     sim_printf (", buffering file in memory\n");
     uptr->WRITTEN = 0;
     uptr->io_flush = dtc_flush;
+    uptr->dynflags |= UNIT_SYNC_FLUSH;                      /* checkpoint while running */
     if (uptr->flags & UNIT_8FMT) {                          /* 12b? */
         for (ba = 0; ba < uptr->capac; ) {                  /* loop thru file */
             k = fxread (pdp8b, sizeof (uint16), D8_NBSIZE, uptr->fileref);
@@ -1246,7 +1247,8 @@ dtc_flush (UNIT* uptr)
     uint32 ba, k, *fbuf;
     
     if (uptr->WRITTEN && uptr->hwmark && ((uptr->flags & UNIT_RO) == 0)) {   /* any data? */
-        sim_printf ("%s: writing buffer to file: %s\n", sim_uname (uptr), uptr->filename);
+        if (!sim_is_running)                                /* quiet checkpoint */
+            sim_printf ("%s: writing buffer to file: %s\n", sim_uname (uptr), uptr->filename);
         fbuf = (uint32 *) uptr->filebuf;                        /* file buffer */
         rewind (uptr->fileref);                             /* start of file */
         if (uptr->flags & UNIT_8FMT) {                      /* 12b? */
@@ -1272,6 +1274,7 @@ dtc_flush (UNIT* uptr)
             }                                              /* end loop file */
         } else fxwrite (uptr->filebuf, sizeof (uint32),    /* write file */
             uptr->hwmark, uptr->fileref);
+        fflush (uptr->fileref);
         if (ferror (uptr->fileref))
             sim_perror ("I/O error");
         uptr->WRITTEN = 0;
@@ -1292,6 +1295,7 @@ dtc_detach (UNIT* uptr)
     if (uptr->hwmark && ((uptr->flags & UNIT_RO) == 0))     /* any data? */
         dtc_flush (uptr);                                   /* end if hwmark */
     free (uptr->filebuf);                                   /* release buf */
+    uptr->dynflags &= ~UNIT_SYNC_FLUSH;
     uptr->flags = uptr->flags & ~UNIT_BUF;                  /* clear buf flag */
     uptr->filebuf = NULL;                                   /* clear buf ptr */
     uptr->flags = uptr->flags & ~(UNIT_8FMT | UNIT_11FMT);  /* default fmt */
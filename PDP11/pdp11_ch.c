@@ -79,6 +79,8 @@ BITFIELD ch_csr_bits[] = {
 };
 
 #define CHUDP_HEADER 4
+#define CH_POLL_BUSY   2000 /* Instructions between polls while traffic flows */
+#define CH_POLL_LINGER 50   /* Empty busy polls before falling back to clock polls */
 #define IOLN_CH 020
 #define DBG_TRC  0x0001
 #define DBG_REG  0x0002
@@ -110,6 +112,7 @@ static uint16 rx_count;
 static uint16 tx_count;
 static uint8 rx_buffer[512+100];
 static uint8 tx_buffer[512+100];
+static int32 quiet_polls = CH_POLL_LINGER;  /* Empty polls since last traffic */
 
 TMLN ch_lines[1] = { {0} };
 TMXR ch_tmxr = { 1, NULL, 0, ch_lines};
@@ -168,7 +171,9 @@ DEVICE ch_dev = {
 int ch_checksum (const uint8 *p, int length)
 {
   int i, sum = 0;
-  for (i = 0; i < length; i += 2)
+  for (i = 0; i + 4 <= length; i += 4)    /* Two words per pass, fold once */
+    sum += ((p[i] << 8) + p[i+1]) + ((p[i+2] << 8) + p[i+3]);
+  for (; i < length; i += 2)
     sum += (p[i] << 8) + p[i+1];
   while (sum > 0xffff)
     sum = (sum & 0xffff) + (sum >> 16);
@@ -239,6 +244,10 @@ t_stat ch_transmit ()
     tmxr_poll_tx (&ch_tmxr);
     status |= TXD;
     ch_test_int ();
+    if (quiet_polls != 0) {                 /* Expect an answer soon */
+      quiet_polls = 0;
+      sim_activate_abs (ch_unit, CH_POLL_BUSY);
+    }
   } else
     sim_debug (DBG_ERR, &ch_dev, "Sending UDP failed: %d.\n", r);
   return SCPE_OK;
@@ -272,7 +281,9 @@ void ch_validate (const uint8 *p, int count)
     sim_debug (DBG_TRC, &ch_dev, "Checksum: %05o\n", chksum);
 }
 
-void ch_receive (void)
+/* Returns TRUE if a packet arrived */
+
+t_bool ch_receive (void)
 {
   size_t count;
   const uint8 *p;
@@ -280,10 +291,10 @@ void ch_receive (void)
   tmxr_poll_rx (&ch_tmxr);
   if (tmxr_get_packet_ln (&ch_lines[0], &p, &count) != SCPE_OK) {
     sim_debug (DBG_ERR, &ch_dev, "TMXR error receiving packet\n");
-    return;
+    return FALSE;
   }
   if (p == NULL)
-    return;
+    return FALSE;
 
   sim_debug (DBG_PKT, &ch_dev, "Received UDP packet, %d bytes\n", (int)count);
   if ((status & RXD) == 0) {
@@ -302,6 +313,7 @@ void ch_receive (void)
     if ((status & LOST) < LOST)
       status += 01000;
   }
+  return TRUE;
 }
 
 t_stat ch_rd (int32 *data, int32 PA, int32 access)
@@ -363,6 +375,7 @@ void ch_command (int32 data)
     status &= ~(RXD|CRC|LOST);
     ch_lines[0].rcve = TRUE;
     sim_debug (DBG_TRC, &ch_dev, "Rx on\n");
+    quiet_polls = 0;
     sim_activate_abs (ch_unit, 100);   /* Force next packet read attempt */
   }
   if (data & CTX) {
@@ -402,12 +415,26 @@ t_stat ch_wr (int32 data, int32 PA, int32 access)
   return SCPE_OK;
 }
 
+/* While packets are flowing the line is polled every CH_POLL_BUSY
+   instructions, so a reply is picked up as soon as the peer sends it
+   instead of at the next clock tick.  After CH_POLL_LINGER empty polls
+   the unit goes back to polling once per clock tick.  With asynchronous
+   multiplexer support the poll thread also activates the unit as soon
+   as a datagram arrives. */
+
 t_stat ch_svc(UNIT *uptr)
 {
-  sim_clock_coschedule (uptr, 1000);
+  if ((uptr->flags & UNIT_ATT) == 0)
+    return SCPE_OK;
   (void)tmxr_poll_conn (&ch_tmxr);
-  if (ch_lines[0].conn)
-    ch_receive ();
+  if (ch_lines[0].conn && ch_receive ())
+    quiet_polls = 0;
+  else if (quiet_polls < CH_POLL_LINGER)
+    quiet_polls++;
+  if (quiet_polls < CH_POLL_LINGER)
+    sim_activate (uptr, CH_POLL_BUSY);
+  else
+    sim_clock_coschedule (uptr, 1000);
   return SCPE_OK;
 }
 
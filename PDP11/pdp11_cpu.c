@@ -205,6 +205,12 @@
       as isenable and dsenable for ispace and dspace, respectively, and
       must be recalculated whenever MMR0, MMR3, or PSW<cm> changes.
 
+      The relocation of each of the 64 pages (mode, I/D space, APR) is
+      also precalculated, in reloc_rd, reloc_wr, reloc_lo and reloc_hi,
+      and must be recalculated (calc_reloc) whenever a PAR, PDR or MMR3
+      changes.  A reference within the page whose access control permits
+      it without traps is then relocated by a single addition.
+
    2. Traps and interrupts.  Variable trap_req bit-encodes all possible
       traps.  In addition, an interrupt pending bit is encoded as the
       lowest priority trap.  Traps are processed by trap_vec and trap_clear,
@@ -244,12 +250,17 @@
 #define GET_Z(v)        ((v) == 0)
 #define JMP_PC(x)       PCQ_ENTRY; PC = (x)
 #define BRANCH_F(x)     PCQ_ENTRY; PC = (PC + (((x) + (x)) & 0377)) & 0177777
-#define BRANCH_B(x)     PCQ_ENTRY; PC = (PC + (((x) + (x)) | 0177400)) & 0177777
+#define BRANCH_B(x)     PCQ_ENTRY; PC = (PC + (((x) + (x)) | 0177400)) & 0177777; \
+                        if (sim_idle_spin_enab) \
+                            sim_idle_spin (TMR_CLK, (cm << 16) | PC, SPIN_STATE)
+/* Spin loop signature: the general registers and the count of stores */
+#define SPIN_STATE      ((uint32)(R[0] + R[1] + R[2] + R[3] + R[4] + R[5] + R[6]) + (cpu_stores << 20))
 #define UNIT_V_MSIZE    (UNIT_V_UF + 0)                 /* dummy */
 #define UNIT_MSIZE      (1u << UNIT_V_MSIZE)
 
 #define HIST_MIN        64
 #define HIST_MAX        (1u << 18)
+#define HIST_MAP_MAX    (1u << 30)                      /* memory mapped history max */
 #define HIST_VLD        1                               /* make PC odd */
 #define HIST_ILNT       4                               /* max inst length */
 
@@ -295,6 +306,8 @@ int32 MMR3 = 0;                                         /* MMR3 - 22b status */
 int32 cpu_bme = 0;                                      /* bus map enable */
 int32 cpu_astop = 0;                                    /* address stop */
 int32 isenable = 0, dsenable = 0;                       /* i, d space flags */
+int32 reloc_rd[64], reloc_wr[64];                       /* page pa base, -1 if slow */
+int32 reloc_lo[64], reloc_hi[64];                       /* valid page displacements */
 int32 stop_trap = 1;                                    /* stop on trap */
 int32 stop_vecabort = 1;                                /* stop on vec abort */
 int32 stop_spabort = 1;                                 /* stop on SP abort */
@@ -309,10 +322,14 @@ jmp_buf save_env;                                       /* abort handler */
 int32 hst_p = 0;                                        /* history pointer */
 int32 hst_lnt = 0;                                      /* history length */
 InstHistory *hst = NULL;                                /* instruction history */
+SIM_MMAP *hst_map = NULL;                               /* memory mapped history file */
+SIM_HIST_HDR hst_nohdr;                                 /* header when not mapped */
+SIM_HIST_HDR *hst_hdr = &hst_nohdr;                     /* history file header */
 int32 dsmask[4] = { MMR3_KDS, MMR3_SDS, 0, MMR3_UDS };  /* dspace enables */
 int16 inst_pc;                                          /* PC of current instr */
 int32 inst_psw;                                         /* PSW at instr. start */
 int16 reg_mods;                                         /* reg deltas */
+uint32 cpu_stores = 0;                                  /* stores, for spin detection */
 int32 last_pa;                                          /* pa from ReadMW/ReadMB */
 int32 saved_sim_interval;                               /* saved at inst start */
 t_stat reason;                                          /* stop reason */
@@ -327,6 +344,7 @@ t_stat cpu_dep (t_value val, t_addr addr, UNIT *uptr, int32 sw);
 t_stat cpu_reset (DEVICE *dptr);
 t_stat cpu_boot (int32 unitno, DEVICE *dptr);
 t_bool cpu_is_pc_a_subroutine_call (t_addr **ret_addrs);
+const char *cpu_pc_space (void);
 t_stat cpu_set_hist (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_show_hist (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat cpu_show_virt (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
@@ -339,6 +357,8 @@ int32 relocW (int32 addr);
 void relocR_test (int32 va, int32 apridx);
 void relocW_test (int32 va, int32 apridx);
 t_bool PLF_test (int32 va, int32 apr);
+void calc_reloc (int32 apridx);
+void calc_reloc_all (void);
 void reloc_abort (int32 err, int32 apridx);
 int32 ReadE (int32 addr);
 int32 ReadW (int32 addr);
@@ -659,7 +679,7 @@ MTAB cpu_mod[] = {
 #endif
     { MTAB_XTD|MTAB_VDV|MTAB_NMO, 0, "IOSPACE", NULL,
       NULL, &show_iospace, NULL, "Show I/O space address assignments" },
-    { MTAB_XTD|MTAB_VDV, 0, "IDLE", "IDLE", &sim_set_idle, &sim_show_idle, NULL, "Enable/Display idle detection" },
+    { MTAB_XTD|MTAB_VDV, 0, "IDLE", "IDLE", &sim_set_idle, &sim_show_idle, NULL, "Enable/Display idle detection (IDLE=SPIN also idles polling loops)" },
     { MTAB_XTD|MTAB_VDV, 0, NULL, "NOIDLE", &sim_clr_idle, NULL, NULL, "Disable idle detection" },
     { MTAB_XTD|MTAB_VDV|MTAB_NMO|MTAB_SHP|MTAB_NC, 0, "HISTORY", "HISTORY=n",
       &cpu_set_hist, &cpu_show_hist, NULL, "Enable/Display instruction history" },
@@ -694,11 +714,45 @@ t_value pdp11_pc_value (void)
 return (t_value)PC;
 }
 
+/* Instruction fetch
+
+   The common case is done in line: an even PC, no read breakpoints, a
+   page that the relocation fast path covers (or memory management off)
+   and a physical address in memory.  Everything else, including any
+   error, goes through ReadE.
+*/
+
+static SIM_INLINE int32 ReadI (int32 va)
+{
+int32 apridx, disp, pa;
+
+if (((va & 1) == 0) && !BPT_SUMM_RD) {
+    if (MMR0 & MMR0_MME) {                              /* if mmgt */
+        apridx = (va >> VA_V_APF) & 077;                /* index into APR */
+        disp = va & VA_DF;
+        if ((reloc_rd[apridx] >= 0) &&                  /* fast path ok? */
+            (disp >= reloc_lo[apridx]) &&
+            (disp <= reloc_hi[apridx])) {
+            pa = reloc_rd[apridx] + disp;
+            if (ADDR_IS_MEM (pa))
+                return RdMemW (pa);
+            }
+        }
+    else {
+        pa = va & 0177777;                              /* mmgt off */
+        if ((pa < 0160000) && ADDR_IS_MEM (pa))
+            return RdMemW (pa);
+        }
+    }
+return ReadE (va);
+}
+
 t_stat sim_instr (void)
 {
 int abortval, i;
 volatile int32 trapea;                                  /* used by setjmp */
 InstHistory *hst_ent = NULL;
+t_bool hooks;                                           /* history or breakpoints? */
 
 sim_vm_pc_value = &pdp11_pc_value;
 
@@ -725,6 +779,7 @@ for (i = 0; i < 6; i++)
 SP = STACKFILE[cm];
 isenable = calc_is (cm);
 dsenable = calc_ds (cm);
+calc_reloc_all ();                                      /* APRs may be changed */
 put_PIRQ (PIRQ);                                        /* rewrite PIRQ */
 STKLIM = STKLIM & STKLIM_RW;                            /* clean up STKLIM */
 MMR0 = MMR0 | MMR0_IC;                                  /* usually on */
@@ -802,8 +857,13 @@ else {
 
    Check for traps or interrupts.  If trap, locate the vector and check
    for stop condition.  If interrupt, locate the vector.
+
+   The per instruction history and breakpoint work is skipped with a
+   single test of hooks, which is only re-evaluated here and after event
+   dispatch, where commands entered while running take effect.
 */ 
 
+hooks = (hst_lnt || sim_brk_summ);
 while (reason == 0)  {
 
     int32 IR, srcspec, srcreg, dstspec, dstreg;
@@ -828,6 +888,7 @@ while (reason == 0)  {
         set_r_display (rs, cm);
 
         reason = sim_process_event ();                  /* process events */
+        hooks = (hst_lnt || sim_brk_summ);              /* may have been changed */
 
         /* restore simh register contents into running variables */
         PC = saved_PC;
@@ -933,10 +994,13 @@ while (reason == 0)  {
     /* Save PSW also because condition codes need to be preserved.  We
        just save the whole PSW because that is sufficient.  If
        restoring is needed, both the PSW and the components that need
-       to be restored are handled explicitly.  */
-    inst_psw = get_PSW ();
-    saved_sim_interval = sim_interval;
-    if (BPT_SUMM_PC) {                                  /* possible breakpoint */
+       to be restored are handled explicitly.  Only a breakpoint
+       restores them, so they are only saved when one can be set.  */
+    if (SIM_UNLIKELY (hooks)) {
+        inst_psw = get_PSW ();
+        saved_sim_interval = sim_interval;
+        }
+    if (SIM_UNLIKELY (hooks) && BPT_SUMM_PC) {          /* possible breakpoint */
         t_addr pa = relocR (PC | isenable);             /* relocate PC */
         if (sim_brk_test (PC, BPT_PCVIR) ||             /* Normal PC breakpoint? */
             sim_brk_test (pa, BPT_PCPHY))               /* Physical Address breakpoint? */
@@ -947,13 +1011,13 @@ while (reason == 0)  {
         MMR1 = 0;
         MMR2 = PC;
         }
-    IR = ReadE (PC | isenable);                         /* fetch instruction */
+    IR = ReadI (PC | isenable);                         /* fetch instruction */
     sim_interval = sim_interval - 1;
     srcspec = (IR >> 6) & 077;                          /* src, dst specs */
     dstspec = IR & 077;
     srcreg = (srcspec <= 07);                           /* src, dst = rmode? */
     dstreg = (dstspec <= 07);
-    if (hst_lnt) {                                      /* record history? */
+    if (SIM_UNLIKELY (hooks) && hst_lnt) {              /* record history? */
         t_value val;
         uint32 i;
         static int32 swmap[4] = {
@@ -975,6 +1039,7 @@ while (reason == 0)  {
         hst_p = (hst_p + 1);
         if (hst_p >= hst_lnt)
             hst_p = 0;
+        hst_hdr->next = hst_p;                          /* keep mapped file current */
         }
     PC = (PC + 2) & 0177777;                            /* incr PC, mod 65k */
     switch ((IR >> 12) & 017) {                         /* decode IR<15:12> */
@@ -1015,6 +1080,7 @@ while (reason == 0)  {
                     STKLIM = 0;                         /* clear STKLIM */
                     MMR0 = 0;                           /* clear MMR0 */
                     MMR3 = 0;                           /* clear MMR3 */
+                    calc_reloc_all ();
                     cpu_bme = 0;                        /* (also clear bme) */
                     for (i = 0; i < IPL_HLVL; i++)
                         int_req[i] = 0;
@@ -2787,6 +2853,7 @@ PWriteW (data, pa);
 
 void PWriteW (int32 data, int32 pa)
 {
+cpu_stores++;
 if (ADDR_IS_MEM (pa)) {                                 /* memory address? */
     WrMemW (pa, data);
     return;
@@ -2804,6 +2871,7 @@ return;
 
 void PWriteB (int32 data, int32 pa)
 {
+cpu_stores++;
 if (ADDR_IS_MEM (pa)) {                                 /* memory address? */
     WrMemB (pa, data);
     return;
@@ -2837,10 +2905,15 @@ return;
 
 int32 relocR (int32 va)
 {
-int32 apridx, apr, pa;
+int32 apridx, apr, pa, disp;
 
 if (MMR0 & MMR0_MME) {                                  /* if mmgt */
     apridx = (va >> VA_V_APF) & 077;                    /* index into APR */
+    disp = va & VA_DF;
+    if ((reloc_rd[apridx] >= 0) &&                      /* fast path ok? */
+        (disp >= reloc_lo[apridx]) &&
+        (disp <= reloc_hi[apridx]))
+        return reloc_rd[apridx] + disp;
     apr = APRFILE[apridx];                              /* with va<18:13> */
     if ((apr & PDR_PRD) != 2)                           /* not 2, 6? */
          relocR_test (va, apridx);                      /* long test */
@@ -2916,6 +2989,45 @@ int32 plf = (apr & PDR_PLF) >> 2;                       /* extr page length */
 return ((apr & PDR_ED)? (dbn < plf): (dbn > plf));      /* pg lnt error? */
 }
 
+/* Precalculate the relocation of a page
+
+   The fast path is only used if the whole page relocates without
+   wrapping the physical address space and, when 22b addressing is
+   off, without reaching the I/O page; all other cases are left to
+   the general relocation code.
+*/
+
+void calc_reloc (int32 apridx)
+{
+int32 apr = APRFILE[apridx];
+int32 base = (apr >> 10) & 017777700;
+int32 plf = (apr & PDR_PLF) >> 2;
+t_bool simple;
+
+if (MMR3 & MMR3_M22E)
+    simple = ((base + VA_DF) <= PAMASK);
+else
+    simple = ((base + VA_DF) < 0760000);
+if (apr & PDR_ED) {                                     /* expands down? */
+    reloc_lo[apridx] = plf;
+    reloc_hi[apridx] = VA_DF;
+    }
+else {
+    reloc_lo[apridx] = 0;
+    reloc_hi[apridx] = plf | (VA_DF & ~VA_BN);
+    }
+reloc_rd[apridx] = (simple && ((apr & PDR_PRD) == 2))? base: -1;
+reloc_wr[apridx] = (simple && ((apr & PDR_ACF) == 6))? base: -1;
+}
+
+void calc_reloc_all (void)
+{
+int32 i;
+
+for (i = 0; i < 64; i++)
+    calc_reloc (i);
+}
+
 void reloc_abort (int32 err, int32 apridx)
 {
 if (update_MM) MMR0 =                                   /* update MMR0 */
@@ -2944,10 +3056,17 @@ return;
 
 int32 relocW (int32 va)
 {
-int32 apridx, apr, pa;
+int32 apridx, apr, pa, disp;
 
 if (MMR0 & MMR0_MME) {                                  /* if mmgt */
     apridx = (va >> VA_V_APF) & 077;                    /* index into APR */
+    disp = va & VA_DF;
+    if ((reloc_wr[apridx] >= 0) &&                      /* fast path ok? */
+        (disp >= reloc_lo[apridx]) &&
+        (disp <= reloc_hi[apridx])) {
+        APRFILE[apridx] = APRFILE[apridx] | PDR_W;      /* set W */
+        return reloc_wr[apridx] + disp;
+        }
     apr = APRFILE[apridx];                              /* with va<18:13> */
     if ((apr & PDR_ACF) != 6)                           /* not writeable? */
         relocW_test (va, apridx);                       /* long test */
@@ -3130,6 +3249,7 @@ if (pa & 1)
 MMR3 = data & cpu_tab[cpu_model].mm3;
 cpu_bme = (MMR3 & MMR3_BME) && (cpu_opt & OPT_UBM);
 dsenable = calc_ds (cm);
+calc_reloc_all ();                                      /* M22E may change */
 return SCPE_OK;
 }
 
@@ -3187,6 +3307,7 @@ if (left)
         (((uint32) (data & cpu_tab[cpu_model].par)) << 16)) & ~(PDR_A|PDR_W);
 else APRFILE[idx] = ((APRFILE[idx] & ~0177777) |
     (data & cpu_tab[cpu_model].pdr)) & ~(PDR_A|PDR_W);
+calc_reloc (idx);
 return SCPE_OK;
 }
 
@@ -3349,6 +3470,62 @@ static const char *pdp11_clock_precalibrate_commands[] = {
     "PC 100",
     NULL};
 
+/*
+ * Standard workloads for the BENCHMARK command.  The floating
+ * point workload needs the FP11 and takes immediate single
+ * precision operands: 040200 is 1.0 and 040000 is 0.5.
+ */
+
+static const char *pdp11_bench_integer[] = {
+    "-m 1000 ADD  R1,R0",
+    "-m 1002 XOR  R0,R2",
+    "-m 1004 ASL  R2",
+    "-m 1006 SUB  R2,R0",
+    "-m 1010 INC  R1",
+    "-m 1012 BR   1000",
+    "PC 1000",
+    NULL};
+
+static const char *pdp11_bench_memory[] = {
+    "-m 1000 MOV  #40000,R1",
+    "-m 1004 MOV  #10000,R2",
+    "-m 1010 ADD  (R1),R0",
+    "-m 1012 MOV  R0,(R1)+",
+    "-m 1014 SOB  R2,1010",
+    "-m 1016 BR   1000",
+    "PC 1000",
+    NULL};
+
+static const char *pdp11_bench_string[] = {
+    "-m 1000 MOV  #40000,R1",
+    "-m 1004 MOV  #50000,R3",
+    "-m 1010 MOV  #2000,R2",
+    "-m 1014 MOVB (R1)+,(R3)+",
+    "-m 1016 SOB  R2,1014",
+    "-m 1020 BR   1000",
+    "PC 1000",
+    NULL};
+
+static const char *pdp11_bench_float[] = {
+    "-m 1000 SETF",
+    "-m 1002 LDF  F0,#40200",
+    "-m 1006 LDF  F1,#40000",
+    "-m 1012 MULF F0,F1",
+    "-m 1014 ADDF F0,#40200",
+    "-m 1020 DIVF F0,F1",
+    "-m 1022 CMPF F0,F1",
+    "-m 1024 BR   1000",
+    "PC 1000",
+    NULL};
+
+static BENCHTAB pdp11_benchmarks[] = {
+    { "INTEGER", "register arithmetic and shifts",         pdp11_bench_integer },
+    { "MEMORY",  "8KB word read/modify/write stream",      pdp11_bench_memory },
+    { "STRING",  "1KB MOVB/SOB byte copy",                 pdp11_bench_string },
+    { "FLOAT",   "FP11 load, multiply, add, divide",       pdp11_bench_float },
+    { NULL }
+    };
+
 /* Special boot command - linked into SCP by initial reset
 
    Syntax: BOOT {CPU}
@@ -3402,10 +3579,11 @@ MMR0 = 0;
 MMR1 = 0;
 MMR2 = 0;
 MMR3 = 0;
+calc_reloc_all ();
 trap_req = 0;
 wait_state = 0;
 if (M == NULL) {                    /* First time init */
-    M = (uint16 *) calloc (MEMSIZE >> 1, sizeof (uint16));
+    M = (uint16 *) sim_mem_alloc ((size_t) MEMSIZE);
     if (M == NULL)
         return SCPE_MEM;
     sim_set_pchar (0, "01000023640"); /* ESC, CR, LF, TAB, BS, BEL, ENQ */
@@ -3415,7 +3593,9 @@ if (M == NULL) {                    /* First time init */
                     SWMASK ('W')|SWMASK ('X');
     sim_brk_type_desc = cpu_breakpoints;
     sim_vm_is_subroutine_call = &cpu_is_pc_a_subroutine_call;
+    sim_vm_pc_space = &cpu_pc_space;
     sim_clock_precalibrate_commands = pdp11_clock_precalibrate_commands;
+    sim_vm_benchmarks = pdp11_benchmarks;
     auto_config(NULL, 0);           /* do an initial auto configure */
     }
 pcq_r = find_reg ("PCQ", NULL, dptr);
@@ -3439,6 +3619,15 @@ static const char *cpu_next_caveats =
 "locations due to a trap, stack unwind or any other reason, instruction\n"
 "execution will continue until some other reason causes execution to stop.\n";
 
+/* Mode of the current PC (for the profiler) */
+
+const char *cpu_pc_space (void)
+{
+static const char *modes[4] = {"K", "S", "-", "U"};
+
+return modes[cm & 03];
+}
+
 t_bool cpu_is_pc_a_subroutine_call (t_addr **ret_addrs)
 {
 #define MAX_SUB_RETURN_SKIP 10
@@ -3558,23 +3747,44 @@ return;
 t_stat cpu_set_hist (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 {
 int32 i, lnt;
+char gbuf[CBUFSIZE];
 t_stat r;
 
 if (cptr == NULL) {
     for (i = 0; i < hst_lnt; i++)
         hst[i].pc = 0;
     hst_p = 0;
+    hst_hdr->next = 0;
     return SCPE_OK;
     }
-lnt = (int32) get_uint (cptr, 10, HIST_MAX, &r);
+cptr = get_glyph (cptr, gbuf, ':');
+lnt = (int32) get_uint (gbuf, 10, (sim_switches & SWMASK ('M')) ? HIST_MAP_MAX : HIST_MAX, &r);
 if ((r != SCPE_OK) || (lnt && (lnt < HIST_MIN)))
     return SCPE_ARG;
+if ((sim_switches & SWMASK ('M')) ? ((cptr == NULL) || (*cptr == 0)) : (cptr && *cptr))
+    return SCPE_ARG;                                    /* file iff memory mapped */
 hst_p = 0;
 if (hst_lnt) {
-    free (hst);
+    if (hst_map)
+        sim_mmap_close (hst_map);
+    else
+        free (hst);
+    hst_map = NULL;
+    hst_hdr = &hst_nohdr;
     hst_lnt = 0;
     hst = NULL;
     }
+if (sim_switches & SWMASK ('M')) {                      /* memory mapped? */
+    r = sim_hist_open (cptr, sizeof (InstHistory), lnt, sim_switches, &hst_map, &hst_hdr);
+    if (r != SCPE_OK) {
+        hst_hdr = &hst_nohdr;
+        return r;
+        }
+    hst = (InstHistory *)(hst_hdr + 1);
+    hst_lnt = (int32)hst_hdr->entries;
+    hst_p = (int32)hst_hdr->next;
+    return SCPE_OK;
+    }
 if (lnt) {
     hst = (InstHistory *) calloc (lnt, sizeof (InstHistory));
     if (hst == NULL)
@@ -3714,8 +3924,12 @@ fprintf (st, "This is controlled by the SET CPU HISTORY and SHOW CPU HISTORY com
 fprintf (st, "     SET CPU HISTORY          clear history buffer\n");
 fprintf (st, "     SET CPU HISTORY=0        disable history\n");
 fprintf (st, "     SET CPU HISTORY=n        enable history, length = n\n");
+fprintf (st, "     SET CPU -M HISTORY=n:file  enable history kept in memory mapped file\n");
+fprintf (st, "     SET CPU -M HISTORY=0:file  reopen an existing memory mapped history\n");
 fprintf (st, "     SHOW CPU HISTORY         print CPU history\n");
 fprintf (st, "     SHOW CPU HISTORY=n       print first n entries of CPU history\n\n");
+fprintf (st, "A memory mapped history may have up to %u entries and survives the\n", HIST_MAP_MAX);
+fprintf (st, "simulator exiting or crashing, so it can be reopened and displayed later.\n\n");
 fprintf (st, "The maximum length for the history is 262144 entries.\n\n");
 
 fprintf (st, "Unibus and Qbus DMA Devices\n\n");
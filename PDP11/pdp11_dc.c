@@ -560,6 +560,7 @@ t_stat r;
 r = tmxr_attach (&dcx_desc, uptr, cptr);                /* attach */
 if (r != SCPE_OK)                                       /* error? */
     return r;
+sim_poll_group_add (uptr, &tmxr_poll_ready);            /* poll only when needed */
 sim_activate (uptr, 0);                                 /* start poll at once */
 return SCPE_OK;
 }
@@ -575,6 +576,7 @@ r = tmxr_detach (&dcx_desc, uptr);                      /* detach */
 for (i = 0; i < DCX_LINES; i++)                         /* all lines, */
     dcx_ldsc[i].rcve = 0;                               /* disable rcv */
 sim_cancel (uptr);                                      /* stop poll */
+sim_poll_group_remove (uptr);
 return r;
 }
 
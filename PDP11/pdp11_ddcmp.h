@@ -343,8 +343,13 @@ return SCPE_LOST;
     1. If the line is not connected, SCPE_LOST is returned.
     2. If prior packet transmission still in progress, SCPE_STALL is 
        returned and no packet data is stored.  The caller must retry later.
+    3. The _ex forms take a flush argument.  When it is FALSE, a packet
+       which fit completely in the line buffer is left there, so that a
+       caller sending several packets in a row can have them all go out
+       in a single write by flushing (tmxr_send_buffered_data) after the
+       last one.
 */
-static t_stat ddcmp_tmxr_put_packet_ln (TMLN *lp, const uint8 *buf, size_t size, int32 corruptrate)
+static t_stat ddcmp_tmxr_put_packet_ln_ex (TMLN *lp, const uint8 *buf, size_t size, int32 corruptrate, t_bool flush)
 {
 t_stat r;
 char msg[32];
@@ -372,7 +377,8 @@ if (!ddcmp_feedCorruptionTroll (lp, lp->txpb, FALSE, corruptrate)) {
     while ((lp->txppoffset < lp->txppsize) && 
            (SCPE_OK == (r = tmxr_putc_ln (lp, lp->txpb[lp->txppoffset]))))
        ++lp->txppoffset;
-    tmxr_send_buffered_data (lp);
+    if (flush || (lp->txppoffset < lp->txppsize))
+        tmxr_send_buffered_data (lp);
     }
 else {/* Packet eaten, so discard it */
     lp->txppoffset = lp->txppsize; /* Act like all data was sent */
@@ -380,7 +386,7 @@ else {/* Packet eaten, so discard it */
 return lp->conn ? SCPE_OK : SCPE_LOST;
 }
 
-static t_stat ddcmp_tmxr_put_packet_crc_ln (TMLN *lp, uint8 *buf, size_t size, int32 corruptrate)
+static t_stat ddcmp_tmxr_put_packet_crc_ln_ex (TMLN *lp, uint8 *buf, size_t size, int32 corruptrate, t_bool flush)
 {
 uint16 hdr_crc16 = ddcmp_crc16(0, buf, DDCMP_HEADER_SIZE-DDCMP_CRC_SIZE);
 
@@ -391,7 +397,12 @@ if (size > DDCMP_HEADER_SIZE) {
     buf[size-DDCMP_CRC_SIZE] = data_crc16 & 0xFF;
     buf[size-DDCMP_CRC_SIZE+1] = (data_crc16>>8) & 0xFF;
     }
-return ddcmp_tmxr_put_packet_ln (lp, buf, size, corruptrate);
+return ddcmp_tmxr_put_packet_ln_ex (lp, buf, size, corruptrate, flush);
+}
+
+static t_stat ddcmp_tmxr_put_packet_crc_ln (TMLN *lp, uint8 *buf, size_t size, int32 corruptrate)
+{
+return ddcmp_tmxr_put_packet_crc_ln_ex (lp, buf, size, corruptrate, TRUE);
 }
 
 static void ddcmp_build_data_packet (uint8 *buf, size_t size, uint8 flags, uint8 sequence, uint8 ack)
@@ -571,6 +571,7 @@ sim_debug(DBG_TRC, &dli_dev, "dlx_attach()\n");
 r = tmxr_attach (&dlx_desc, uptr, cptr);                /* attach */
 if (r != SCPE_OK)                                       /* error */
     return r;
+sim_poll_group_add (uptr, &tmxr_poll_ready);            /* poll only when needed */
 sim_activate (uptr, 0);                                 /* start poll at once */
 return SCPE_OK;
 }
@@ -588,6 +589,7 @@ r = tmxr_detach (&dlx_desc, uptr);                      /* detach */
 for (i = 0; i < DLX_LINES; i++)                         /* all lines, */
     dlx_ldsc[i].rcve = 0;                               /* disable rcv */
 sim_cancel (uptr);                                      /* stop poll */
+sim_poll_group_remove (uptr);
 return r;
 }
 
@@ -1905,6 +1905,13 @@ const char helpString[] =
     " RS232_DCE.  The \"speed\" argument is the bit rate for the line.\n"
     " In SYNC mode, the \"PEER\" parameter is not used and need not be set.\n"
     " You can use \"SHOW SYNC\" to see the list of synchronous DDCMP devices.\n"
+    "\n"
+    " Two simulators on the same host can instead be linked through shared\n"
+    " memory, by attaching a unit in each of them to the same link name:\n"
+    "\n"
+    "+sim> ATTACH %U SHM=name\n"
+    "\n"
+    " In SHM mode, the \"PEER\" parameter is not used either.\n"
     "2 Examples\n"
     " To configure two simulators to talk to each other use the following\n"
     " example:\n"
@@ -3609,13 +3616,15 @@ if ((controller->link.xmt_buffer) ||        /* if Already Transmitting */
     return;                                 /* Do nothing */
 while (buffer) {
     if (buffer->transfer_buffer[0] == 0)
-        return;
+        break;
     if ((controller->link.state != Maintenance) && (buffer->transfer_buffer[DDCMP_RESP_OFFSET] != controller->link.R)) {
         sim_debug(DBG_INF, controller->device, "%s%d: Packet RESP fixup from %d to %d %s\n", controller->device->name, controller->index, buffer->transfer_buffer[DDCMP_RESP_OFFSET], controller->link.R, controller_queue_state(controller));
         buffer->transfer_buffer[DDCMP_RESP_OFFSET] = controller->link.R; /* Make sure that ACK or implied ACK is always up to date */
         }
     /* Need to make sure we dynamically compute the packet CRCs since header details can change */
-    r = ddcmp_tmxr_put_packet_crc_ln (controller->line, buffer->transfer_buffer, buffer->count, *controller->corruption_factor);
+    /* Unrestricted stream lines collect back to back packets and write them together below */
+    r = ddcmp_tmxr_put_packet_crc_ln_ex (controller->line, buffer->transfer_buffer, buffer->count, *controller->corruption_factor, 
+                                         (controller->byte_wait != 0) || controller->line->datagram);
     if (r == SCPE_OK) {
         controller->link.xmt_buffer = buffer;
         controller->ddcmp_control_packets_sent += (buffer->transfer_buffer[0] == DDCMP_ENQ) ? 1 : 0;
@@ -3630,6 +3639,7 @@ while (buffer) {
         }
     break;
     }
+tmxr_send_buffered_data (controller->line);     /* write everything collected */
 }
 
 void dmc_check_romi(CTLR *controller)
@@ -3988,7 +3998,8 @@ if (!cptr || !*cptr)
     return SCPE_ARG;
 if (!(uptr->flags & UNIT_ATTABLE))
     return SCPE_NOATT;
-if (0 == strncasecmp (cptr, "SYNC", 4)) {
+if ((0 == strncasecmp (cptr, "SYNC", 4)) ||
+    (0 == strncasecmp (cptr, "SHM", 3))) {
     sprintf (attach_string, "Line=%d,%s", dmc, cptr);
     ans = tmxr_open_master (mp, attach_string);
 }
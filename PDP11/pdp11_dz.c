@@ -831,6 +831,7 @@ if (r != SCPE_OK) {                                     /* error? */
     tmxr_clear_modem_control_passthru (&dz_desc);
     return r;
     }
+sim_poll_group_add (uptr, &tmxr_poll_ready);            /* poll only when needed */
 if (sim_switches & SWMASK ('M')) {                      /* modem control? */
     dz_mctl = 1;
     sim_printf ("Modem control activated\n");
@@ -867,6 +868,7 @@ t_stat dz_detach (UNIT *uptr)
 int32 dz, muxln;
 t_stat r = tmxr_detach (&dz_desc, uptr);
 
+sim_poll_group_remove (uptr);
 dz_mctl = dz_auto = 0;                                  /* modem ctl off */
 tmxr_clear_modem_control_passthru (&dz_desc);
 for (dz = 0; dz < dz_desc.lines/DZ_LINES; dz++) {
@@ -1181,59 +1181,40 @@ return round_and_pack (facp, facexp, &facfrac, 0);
 
    Note: the inputs are unguarded; the output is guarded.
 
-   This routine performs a classic shift-and-add multiply.  The low
-   order bit of the multiplier is tested; if 1, the multiplicand is
-   added into the high part of the double precision result.  The
-   result and the multiplier are both shifted right 1.
-
-   For the 24b x 24b case, this routine develops 48b of result.
-   For the 56b x 56b case, this routine only develops the top 64b
-   of the the result.  Because the inputs are normalized fractions,
+   The result is the product shifted right 56, truncated; that is what
+   a classic shift-and-add multiply develops, since each bit shifted off
+   the right is lost the same way.  The product is formed with host
+   64b multiplies on 32b halves, so it is exact for every operand.
+
+   For the 24b x 24b case, the product fits in 64b and needs a single
+   multiply.  For the 56b x 56b case, only the top 64b of the 128b
+   product are kept.  Because the inputs are normalized fractions,
    the interesting part of the result is the high 56+guard bits.
    Everything shifted off to the right, beyond 64b, plays no part
    in rounding or the result.
-
-   There are many possible optimizations in this routine: scanning
-   for groups of zeroes, particularly in the 56b x 56b case; using
-   "extended multiply" capability if available in the hardware.
 */
 
 void frac_mulfp11 (fpac_t *f1p, fpac_t *f2p)
 {
-fpac_t result, mpy, mpc;
-int32 i;
+fpac_t mpy, mpc;
+t_uint64 p0, p1, p2, mid, hi, lo, result;
 
-result = zero_fac;                                      /* clear result */
 mpy = *f1p;                                             /* get operands */
 mpc = *f2p;
 F_LSH_GUARD (mpc);                                      /* guard multipicand */
-if ((mpy.l | mpc.l) == 0) {                             /* 24b x 24b? */
-    for (i = 0; i < 24; i++) {
-        if (mpy.h & 1)
-            result.h = result.h + mpc.h;
-        F_RSH_1 (result);
-        mpy.h = mpy.h >> 1;
-        }
-    }
+if ((mpy.l | mpc.l) == 0)                               /* 24b x 24b? */
+    result = ((t_uint64) mpy.h * mpc.h) << 8;
 else {
-    if (mpy.l != 0) {                                   /* 24b x 56b? */
-        for (i = 0; i < 32; i++) {
-            if (mpy.l & 1) {
-                F_ADD (mpc, result, result);
-                }
-            F_RSH_1 (result);
-            mpy.l = mpy.l >> 1;
-            }
-        }
-    for (i = 0; i < 24; i++) {
-        if (mpy.h & 1) {
-            F_ADD (mpc, result, result);
-            }
-        F_RSH_1 (result);
-        mpy.h = mpy.h >> 1;
-        }
+    p0 = (t_uint64) mpy.l * mpc.l;                      /* partial products */
+    p1 = (t_uint64) mpy.l * mpc.h;
+    p2 = (t_uint64) mpy.h * mpc.l;
+    mid = (p0 >> 32) + (p1 & 0xFFFFFFFF) + (p2 & 0xFFFFFFFF);
+    hi = ((t_uint64) mpy.h * mpc.h) + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+    lo = (mid << 32) | (p0 & 0xFFFFFFFF);
+    result = (hi << 8) | (lo >> 56);                    /* product >> 56 */
     }
-*f1p = result;
+f1p->h = (uint32) (result >> 32);
+f1p->l = (uint32) result;
 return;
 }
 
@@ -1269,18 +1250,22 @@ qd = FPS & FPS_D;
 count = FP_V_HB + FP_GUARD + (qd? 33: 1);               /* count = 56b/24b */
 
 quo = zero_fac;
-for (i = count; (i > 0) && ((facfrac.h | facfrac.l) != 0); i--) {
-    F_LSH_1 (quo);                                      /* shift quotient */
-    if (!F_LT (facfrac, fsrcfrac)) {                    /* divd >= divr? */
-        F_SUB (fsrcfrac, facfrac, facfrac);             /* divd - divr */
-        if (qd)                                         /* double or single? */
-            quo.l = quo.l | 1;
-        else quo.h = quo.h | 1;
+if (!qd && ((facfrac.l | fsrcfrac.l) == 0))            /* 24b / 24b? */
+    quo.h = (uint32) (((t_uint64) facfrac.h << (count - 1)) / fsrcfrac.h);
+else {
+    for (i = count; (i > 0) && ((facfrac.h | facfrac.l) != 0); i--) {
+        F_LSH_1 (quo);                                  /* shift quotient */
+        if (!F_LT (facfrac, fsrcfrac)) {                /* divd >= divr? */
+            F_SUB (fsrcfrac, facfrac, facfrac);         /* divd - divr */
+            if (qd)                                     /* double or single? */
+                quo.l = quo.l | 1;
+            else quo.h = quo.h | 1;
+            }
+        F_LSH_1 (facfrac);                              /* shift divd */
+        }
+    if (i > 0) {                                        /* early exit? */
+        F_LSH_V (quo, i, quo);
         }
-    F_LSH_1 (facfrac);                                  /* shift divd */
-    }
-if (i > 0) {                                            /* early exit? */
-    F_LSH_V (quo, i, quo);
     }
 
 /* Dividing two numbers in the range [.5,1) produces a result in the
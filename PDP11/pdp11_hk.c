@@ -1512,6 +1512,7 @@ r = sim_disk_attach_ex (uptr, cptr, HK_NUMWD * sizeof (uint16),
                         (uptr->flags & UNIT_NOAUTO) ? NULL : drives);
 if (r != SCPE_OK)                                       /* error? */
     return r;
+sim_disk_set_track (uptr, HK_NUMSC);                    /* cache by track */
 drv = (uint32) (uptr - hk_dev.units);                   /* get drv number */
 old_hkds = hkds[drv];                                   /* save hkds */
 hkds[drv] = DS_ATA | DS_RDY |
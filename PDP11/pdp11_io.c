@@ -55,6 +55,14 @@ extern int32 ub_map[UBM_LNT_LW];
 extern int32 trap_req, ipl;
 extern int32 uba_last;
 
+#if defined (UC15)                                      /* memory is the PDP-15's */
+#define MAP_RUNW        FALSE
+#define MAP_RUNB        FALSE
+#else
+#define MAP_RUNW        TRUE                            /* word runs, any host */
+#define MAP_RUNB        sim_end                         /* byte runs, little endian */
+#endif
+
 int32 calc_ints (int32 nipl, int32 trq);
 
 extern t_stat cpu_build_dib (void);
@@ -154,25 +162,44 @@ return (trq & ~TRAP_INT);
 }
 
 /* Find vector for highest priority interrupt
-   In a Qbus system, all device interrupts are treated as BR4 */
+   In a Qbus system, all device interrupts are treated as BR4
+
+   Within a level, the lowest numbered pending request wins; it is
+   located by halving the search field instead of testing each bit. */
 
 int32 get_vector (int32 nipl)
 {
-int32 i, j, t, vec;
+int32 i, j;
+uint32 t;
 t_bool all_int = (UNIBUS || (nipl < IPL_HMIN));
 
 for (i = IPL_HLVL - 1; i > nipl; i--) {                 /* loop thru lvls */
     t = all_int? int_req[i]: (int_req[i] & int_internal[i]);
-    for (j = 0; t && (j < 32); j++) {                   /* srch level */
-        if ((t >> j) & 1) {                             /* irq found? */
-            int_req[i] = int_req[i] & ~(1u << j);       /* clr irq */
-            if (int_ack[i][j])
-                vec = int_ack[i][j]();
-            else
-                vec = int_vec[i][j];
-            return vec;                                 /* return vector */
-            }                                           /* end if t */
-        }                                               /* end for j */
+    if (t == 0)                                         /* none at level? */
+        continue;
+    j = 0;                                              /* find lowest set */
+    if ((t & 0xFFFF) == 0) {
+        t = t >> 16;
+        j = j + 16;
+        }
+    if ((t & 0xFF) == 0) {
+        t = t >> 8;
+        j = j + 8;
+        }
+    if ((t & 0xF) == 0) {
+        t = t >> 4;
+        j = j + 4;
+        }
+    if ((t & 0x3) == 0) {
+        t = t >> 2;
+        j = j + 2;
+        }
+    if ((t & 0x1) == 0)
+        j = j + 1;
+    int_req[i] = int_req[i] & ~(1u << j);               /* clr irq */
+    if (int_ack[i][j])
+        return int_ack[i][j]();
+    return int_vec[i][j];                               /* return vector */
     }                                                   /* end for i */
 return 0;
 }
@@ -249,11 +276,43 @@ return uba_last;
      trimmed to 18b.
    - In a Qbus configuration, the map is always disabled.
      Device addresses are trimmed to 22b.
+
+   Memory transfers are done as runs, each moved with one memcpy.  Word
+   buffers have the layout of memory on any host, byte buffers only on
+   a little endian host (MAP_RUNW, MAP_RUNB); otherwise, and in the
+   UC15, whose memory belongs to the PDP-15, transfers go a unit at a
+   time.  Map_Run maps ba and follows the Unibus map through the pages
+   after it for as long as they are physically contiguous, up to bc
+   bytes or the end of memory.  It returns the length of the run,
+   with *ma its memory address, or 0 if ba is not mapped to memory, and
+   leaves uba_last as mapping each unit of lnt bytes would leave it.
 */
 
+static int32 Map_Run (uint32 ba, int32 bc, int32 lnt, uint32 *ma)
+{
+int32 n, pg;
+
+*ma = Map_Addr (ba);                                    /* map addr */
+if (!ADDR_IS_MEM (*ma))                                 /* NXM? err */
+    return 0;
+n = UBM_PAGSIZE - UBM_GETOFF (ba);                      /* left in page */
+for (pg = UBM_GETPN (ba) + 1; (n < bc) && (pg < UBM_M_PN); pg++) {
+    if ((uint32) (ub_map[pg] & PAMASK) != (*ma + n))    /* not contiguous? */
+        break;
+    n = n + UBM_PAGSIZE;
+    }
+if (n > bc)                                             /* limit to rem xfr */
+    n = bc;
+if (!ADDR_IS_MEM (*ma + n - 1))                         /* limit to memory */
+    n = (int32) (MEMSIZE - *ma);
+uba_last = *ma + n - lnt;                               /* last unit mapped */
+return n;
+}
+
 int32 Map_ReadB (uint32 ba, int32 bc, uint8 *buf)
 {
 uint32 alim, lim, ma;
+int32 n;
 
 /* I/O Page DMA only on Unibus systems */
 if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
@@ -272,6 +331,14 @@ if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
 ba = ba & BUSMASK;                                      /* trim address */
 lim = ba + bc;
 if (cpu_bme) {                                          /* map enabled? */
+    if (MAP_RUNB) {                                     /* byte runs? */
+        for ( ; ba < lim; ba = ba + n, buf = buf + n) { /* by runs */
+            if ((n = Map_Run (ba, lim - ba, 1, &ma)) == 0) /* NXM? err */
+                return (lim - ba);
+            memcpy (buf, ((uint8 *) M) + ma, n);
+            }
+        return 0;
+        }
     for ( ; ba < lim; ba++) {                           /* by bytes */
         ma = Map_Addr (ba);                             /* map addr */
         if (!ADDR_IS_MEM (ma))                          /* NXM? err */
@@ -286,7 +353,9 @@ else {                                                  /* physical */
     else if (ADDR_IS_MEM (ba))                          /* no, strt ok? */
         alim = MEMSIZE;
     else return bc;                                     /* no, err */
-    for ( ; ba < alim; ba++) {                          /* by bytes */
+    if (MAP_RUNB)                                       /* byte runs? */
+        memcpy (buf, ((uint8 *) M) + ba, alim - ba);
+    else for ( ; ba < alim; ba++) {                     /* by bytes */
         *buf++ = (uint8) RdMemB (ba);                   /* get byte */
         }
     return (lim - alim);
@@ -296,6 +365,7 @@ else {                                                  /* physical */
 int32 Map_ReadW (uint32 ba, int32 bc, uint16 *buf)
 {
 uint32 alim, lim, ma;
+int32 n;
 
 /* I/O Page DMA only on Unibus systems */
 if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
@@ -315,6 +385,14 @@ if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
 ba = (ba & BUSMASK) & ~01;                              /* trim, align addr */
 lim = ba + (bc & ~01);
 if (cpu_bme) {                                          /* map enabled? */
+    if (MAP_RUNW) {                                     /* word runs? */
+        for (; ba < lim; ba = ba + n, buf = buf + (n >> 1)) { /* by runs */
+            if ((n = Map_Run (ba, lim - ba, 2, &ma)) == 0) /* NXM? err */
+                return (lim - ba);
+            memcpy (buf, M + (ma >> 1), n);
+            }
+        return 0;
+        }
     for (; ba < lim; ba = ba + 2) {                     /* by words */
         ma = Map_Addr (ba);                             /* map addr */
         if (!ADDR_IS_MEM (ma))                          /* NXM? err */
@@ -329,7 +407,9 @@ else {                                                  /* physical */
     else if (ADDR_IS_MEM (ba))                          /* no, strt ok? */
         alim = MEMSIZE;
     else return bc;                                     /* no, err */
-    for ( ; ba < alim; ba = ba + 2) {                   /* by words */
+    if (MAP_RUNW)                                       /* word runs? */
+        memcpy (buf, M + (ba >> 1), alim - ba);
+    else for ( ; ba < alim; ba = ba + 2) {              /* by words */
         *buf++ = (uint16) RdMemW (ba);
         }
     return (lim - alim);
@@ -339,6 +419,7 @@ else {                                                  /* physical */
 int32 Map_WriteB (uint32 ba, int32 bc, const uint8 *buf)
 {
 uint32 alim, lim, ma;
+int32 n;
 
 /* I/O Page DMA only on Unibus systems */
 if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
@@ -354,6 +435,14 @@ if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
 ba = ba & BUSMASK;                                      /* trim address */
 lim = ba + bc;
 if (cpu_bme) {                                          /* map enabled? */
+    if (MAP_RUNB) {                                     /* byte runs? */
+        for ( ; ba < lim; ba = ba + n, buf = buf + n) { /* by runs */
+            if ((n = Map_Run (ba, lim - ba, 1, &ma)) == 0) /* NXM? err */
+                return (lim - ba);
+            memcpy (((uint8 *) M) + ma, buf, n);
+            }
+        return 0;
+        }
     for ( ; ba < lim; ba++) {                           /* by bytes */
         ma = Map_Addr (ba);                             /* map addr */
         if (!ADDR_IS_MEM (ma))                          /* NXM? err */
@@ -368,7 +457,9 @@ else {                                                  /* physical */
     else if (ADDR_IS_MEM (ba))                          /* no, strt ok? */
         alim = MEMSIZE;
     else return bc;                                     /* no, err */
-    for ( ; ba < alim; ba++) {                          /* by bytes */
+    if (MAP_RUNB)                                       /* byte runs? */
+        memcpy (((uint8 *) M) + ba, buf, alim - ba);
+    else for ( ; ba < alim; ba++) {                     /* by bytes */
         WrMemB (ba, ((uint16) *buf++));
         }
     return (lim - alim);
@@ -378,6 +469,7 @@ else {                                                  /* physical */
 int32 Map_WriteW (uint32 ba, int32 bc, const uint16 *buf)
 {
 uint32 alim, lim, ma;
+int32 n;
 
 /* I/O Page DMA only on Unibus systems */
 if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
@@ -395,6 +487,14 @@ if (UNIBUS && (ba >= (uint32)(IOPAGEBASE & UNIMASK))) {
 ba = (ba & BUSMASK) & ~01;                              /* trim, align addr */
 lim = ba + (bc & ~01);
 if (cpu_bme) {                                          /* map enabled? */
+    if (MAP_RUNW) {                                     /* word runs? */
+        for (; ba < lim; ba = ba + n, buf = buf + (n >> 1)) { /* by runs */
+            if ((n = Map_Run (ba, lim - ba, 2, &ma)) == 0) /* NXM? err */
+                return (lim - ba);
+            memcpy (M + (ma >> 1), buf, n);
+            }
+        return 0;
+        }
     for (; ba < lim; ba = ba + 2) {                     /* by words */
         ma = Map_Addr (ba);                             /* map addr */
         if (!ADDR_IS_MEM (ma))                          /* NXM? err */
@@ -409,7 +509,9 @@ else {                                                  /* physical */
     else if (ADDR_IS_MEM (ba))                          /* no, strt ok? */
         alim = MEMSIZE;
     else return bc;                                     /* no, err */
-    for ( ; ba < alim; ba = ba + 2) {                   /* by words */
+    if (MAP_RUNW)                                       /* word runs? */
+        memcpy (M + (ba >> 1), buf, alim - ba);
+    else for ( ; ba < alim; ba = ba + 2) {              /* by words */
         WrMemW (ba, *buf++);
         }
     return (lim - alim);
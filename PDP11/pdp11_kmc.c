@@ -111,6 +111,11 @@
 
 #define DFLT_SPEED (19200)
 
+/* A line speed of zero means unlimited: buffer descriptors are not paced,
+ * so a whole message moves between host memory and the DUP in one pass.
+ */
+#define UNLIMITED_SPEED (0)
+
 
 /* Transmission (or reception) time of a buffer of n
  * characters at speed bits/sec.  8 bit chars (sync line)
@@ -612,7 +617,7 @@ MTAB kmc_mod[] = {
     { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "VECTOR", "VECTOR",
         &set_vec, &show_vec, NULL, "Interrupt vector" },
     { MTAB_XTD|MTAB_VDV|MTAB_VALR|MTAB_NMO, 0, "SPEED", "SPEED=dup=bps",
-        &kmc_setLineSpeed, &kmc_showLineSpeed, NULL, "Line speed (bps)" },
+        &kmc_setLineSpeed, &kmc_showLineSpeed, NULL, "Line speed (bps or UNLIMITED)" },
     { MTAB_XTD|MTAB_VUN|MTAB_NMO, 1, "STATUS", NULL, NULL, &kmc_showStatus, NULL, "Display KMC status" },
 #if KMC_UNITS > 1
     { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "DEVICES", "DEVICES=n",
@@ -1036,7 +1041,8 @@ static t_stat kmc_txService (UNIT *txup) {
     /* Provide the illusion of progress. */
     upc = 1 + ((upc + 1) % (KMC_CRAMSIZE -1));
 
-    /* Process one buffer descriptor per cycle
+    /* Process one buffer descriptor per cycle, or a whole message
+     * per cycle if the line speed is unlimited.
      * CAUTION: this switch statement uses fall-through cases.
      */
 
@@ -1044,12 +1050,13 @@ static t_stat kmc_txService (UNIT *txup) {
  *
  * All exit the current statement (think "break" or "continue")
  *
- * Change to newstate and process immediately
+ * Change to newstate.  An unlimited line processes it immediately;
+ * otherwise it is processed on the next cycle.
  */
 
 #define TXSTATE(newstate) {    \
     d->txstate = newstate;     \
-    more = FALSE;              \
+    more = (d->linespeed == UNLIMITED_SPEED); \
     continue;            }
 
 /* Change to newstate after a delay of time. */
@@ -1129,7 +1136,10 @@ static t_stat kmc_txService (UNIT *txup) {
             if (!kmc_txAppendBuffer(d)) {       /* NXM - Try next list */
                 TXDELAY (TXDONE, TXDONE_DELAY);
             }
-            TXDELAY (TXHDRX, XTIME (d->tx.bd[1], d->linespeed));
+            if (d->linespeed != UNLIMITED_SPEED) {
+                TXDELAY (TXHDRX, XTIME (d->tx.bd[1], d->linespeed));
+            }
+            d->txstate = TXHDRX;
 
         case TXHDRX:                            /* Report header descriptor done */
             if (!kmc_bufferAddressOut (k, 0, 0, d->line, d->tx.bda)) {
@@ -1177,7 +1187,10 @@ static t_stat kmc_txService (UNIT *txup) {
             if (!kmc_txAppendBuffer(d)) {       /* NXM */
                 TXDELAY (TXDONE, TXDONE_DELAY);
             }
-            TXDELAY (TXDATAX, XTIME (d->tx.bd[1], d->linespeed));
+            if (d->linespeed != UNLIMITED_SPEED) {
+                TXDELAY (TXDATAX, XTIME (d->tx.bd[1], d->linespeed));
+            }
+            d->txstate = TXDATAX;
 
         case TXDATAX:                           /* Report BD completion */
             if (!kmc_bufferAddressOut (k, 0, 0, d->line, d->tx.bda)) {
@@ -1379,6 +1392,7 @@ static t_stat kmc_rxService (UNIT *rxup) {
         }
 
     case RXBDL:
+    rxbdl:
         if (!(bdl = (BDL *)remqueue(d->rxqh.next, &d->rxavail))) {
             rxup->wait = RXBDL_DELAY;
             d->rxstate = RXNOBUF;
@@ -1398,6 +1412,7 @@ static t_stat kmc_rxService (UNIT *rxup) {
         d->rxstate = RXBUF;
 
     case RXBUF:
+    rxbuf:
         d->rx.ba = ((d->rx.bd[2] & BDL_XAD) << BDL_S_XAD) | d->rx.bd[0];
         if (d->rx.bd[1] == 0) {
             sim_debug (DF_ERR, &kmc_dev, "KMC%u line %u: RX buffer descriptor size is zero\n", k, d->line);
@@ -1470,9 +1485,12 @@ static t_stat kmc_rxService (UNIT *rxup) {
 
             /* Issue completion after the nominal reception delay */
 
-            rxup->wait = XTIME (d->rx.rcvc+2, d->linespeed);
             d->rxstate = RXLAST;
-            break;
+            if (d->linespeed != UNLIMITED_SPEED) {
+                rxup->wait = XTIME (d->rx.rcvc+2, d->linespeed);
+                break;
+            }
+            goto rxlast;
         }
         if (d->rx.rcvc < d->rx.bd[1]) {
             goto more;
@@ -1482,10 +1500,14 @@ static t_stat kmc_rxService (UNIT *rxup) {
          * Issue the completion after the nominal reception delay.
          */
         d->rxstate = RXFULL;
-        rxup->wait = XTIME (d->rx.bd[1], d->linespeed);
-        break;
+        if (d->linespeed != UNLIMITED_SPEED) {
+            rxup->wait = XTIME (d->rx.bd[1], d->linespeed);
+            break;
+        }
+        goto rxfull;
 
     case RXLAST:
+    rxlast:
         /* End of message.  Update final BD count, check data CRC & report either
          * BUFFER OUT (with EOM) or error CONTROL OUT (NXM or DCRC).
          */
@@ -1517,12 +1539,18 @@ static t_stat kmc_rxService (UNIT *rxup) {
         break;
 
     case RXFULL:
+    rxfull:
         kmc_bufferAddressOut (k, 0, SEL2_IOT, d->line, d->rx.bda);
 
-        /* Advance to next descriptor */
+        /* Advance to next descriptor.  An unlimited line carries on
+         * with it immediately.
+         */
 
         if (d->rx.bd[2] & BDL_LDS) {
             d->rxstate = RXBDL;
+            if (d->linespeed == UNLIMITED_SPEED) {
+                goto rxbdl;
+            }
         } else {
             d->rx.bda += 3*2;
             if (Map_ReadW (d->rx.bda, 3*2, d->rx.bd)) {
@@ -1534,6 +1562,9 @@ static t_stat kmc_rxService (UNIT *rxup) {
                        k, rxup->unit_line, d->rx.bda);
             d->rx.rcvc = 0;                     /* Set here in case of kill */
             d->rxstate = RXBUF;
+            if (d->linespeed == UNLIMITED_SPEED) {
+                goto rxbuf;
+            }
         }
         rxup->wait = RXNEWBD_DELAY;
        break;
@@ -2853,6 +2884,10 @@ static t_stat kmc_showDeviceCount (FILE *st, UNIT *txup, int32 val, CONST void *
  * practical limit was about 19,200 BPS.  The higher limit is a rate that
  * the typicaly host software could handle, even if the line couldn't.
  *
+ * UNLIMITED removes the pacing altogether, for hosts that keep up with
+ * an unthrottled DUP link.  Each message's descriptors are then processed
+ * in one pass.
+ *
  * Note that the DUP line speed can also be set.
  *
  * To allow setting the speed before a DUP has been assigned to a KMC by
@@ -2882,9 +2917,13 @@ static t_stat kmc_setLineSpeed (UNIT *txup, int32 val, CONST char *cptr, void *d
     cptr = gbuf;
     if (!strcmp (cptr, "DUP"))
         cptr += 3;
-    newspeed = (int32) get_uint (cptr, 10, MAX_SPEED, &r);
-    if ((r != SCPE_OK) || (newspeed < 300))     /* error? */
-        return SCPE_ARG;
+    if (!strcmp (cptr, "UNLIMITED")) {
+        newspeed = UNLIMITED_SPEED;
+    } else {
+        newspeed = (int32) get_uint (cptr, 10, MAX_SPEED, &r);
+        if ((r != SCPE_OK) || (newspeed < 300)) /* error? */
+            return SCPE_ARG;
+    }
 
     d = &dupState[dupidx];
     d->linespeed = newspeed;
@@ -2907,7 +2946,11 @@ static t_stat kmc_showLineSpeed (FILE *st, UNIT *txup, int32 val, CONST void *de
         } else {
             fprintf (st, "%3u %3u", d->kmc, d->line);
         }
-        fprintf (st, " %8u\n", d->linespeed);
+        if (d->linespeed == UNLIMITED_SPEED) {
+            fprintf (st, " unlimited\n");
+        } else {
+            fprintf (st, " %8u\n", d->linespeed);
+        }
     }
 
     return SCPE_OK;
@@ -3059,7 +3102,13 @@ static t_stat kmc_help (FILE *st, DEVICE *dptr,
 #endif
 " Line speed - this is the speed at which each communication line\n"
 " operates.  The DUP11's line speed should be set to 'unlimited' to\n"
-" avoid unpredictable interactions.\n"
+" avoid unpredictable interactions.  The KDP line speed may also be\n"
+" set to UNLIMITED, in which case each message moves between host\n"
+" memory and the DUP11 in a single pass:\n"
+"\n"
+"+SET KDP SPEED=dup=UNLIMITED\n"
+"\n"
+" Only do this if the host software keeps up with an unthrottled link.\n"
 #if KMC_TROLL
 " Troll - the KDP emulation includes a process that will intentionally\n"
 " drop or corrupt some messages.  This emulates the less-than-perfect\n"
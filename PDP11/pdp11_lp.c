@@ -101,6 +101,8 @@ MTAB lpt_mod[] = {
       &set_addr, &show_addr, NULL, "Bus address" },
     { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "VECTOR", "VECTOR",
       &set_vec, &show_vec, NULL, "Interrupt vector" },
+    { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "SPOOL", "SPOOL=ROTATE=n{K|M|G};KEEP=n;{NO}COMPRESS",
+      &sim_spool_set, &sim_spool_show, NULL, "Output file rotation" },
     { 0 }
     };
 
@@ -162,10 +164,8 @@ if (lpt_csr & CSR_IE)
     SET_INT (LPT);
 if ((uptr->flags & UNIT_ATT) == 0)
     return IORETURN (lpt_stopioe, SCPE_UNATT);
-fputc (uptr->buf & 0177, uptr->fileref);
-if (ferror (uptr->fileref)) {
+if (sim_spool_putc (uptr, uptr->buf & 0177) != SCPE_OK) {
     sim_perror ("LPT I/O error");
-    clearerr (uptr->fileref);
     return SCPE_IOERR;
     }
 uptr->pos = uptr->pos + 1;
@@ -190,7 +190,7 @@ t_stat reason;
 
 lpt_csr = lpt_csr & ~CSR_ERR;
 sim_switches |= SWMASK('A');
-reason = attach_unit (uptr, cptr);
+reason = sim_spool_attach (uptr, cptr);
 if ((lpt_unit.flags & UNIT_ATT) == 0)
     lpt_csr = lpt_csr | CSR_ERR;
 return reason;
@@ -210,6 +210,10 @@ fprintf (st, "the number of the next data item to be written.  Thus, by changing
 fprintf (st, "user can backspace or advance the printer.\n\n");
 fprintf (st, "The default position after ATTACH is to position at the end of an existing file.\n");
 fprintf (st, "A new file can be created if you attach with the -N switch.\n\n");
+fprintf (st, "Output is buffered in memory and written in the background.  It is written\n");
+fprintf (st, "out at each form feed, periodically and when the simulator stops.  SET LPT\n");
+fprintf (st, "SPOOL=ROTATE=10M;KEEP=4 starts a new file each time the output file reaches\n");
+fprintf (st, "10MB, keeping the previous four as file.1 through file.4.\n\n");
 fprint_set_help (st, dptr);
 fprint_show_help (st, dptr);
 fprint_reg_help (st, dptr);
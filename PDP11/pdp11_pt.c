@@ -165,6 +165,8 @@ MTAB ptp_mod[] = {
       NULL, &show_addr, NULL },
     { MTAB_XTD|MTAB_VDV, 0, "VECTOR", NULL,
       NULL, &show_vec, NULL },
+    { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "SPOOL", "SPOOL=ROTATE=n{K|M|G};KEEP=n;{NO}COMPRESS",
+      &sim_spool_set, &sim_spool_show, NULL, "Output file rotation" },
     { 0 }
     };
 
@@ -337,9 +339,8 @@ if (ptp_csr & CSR_IE)
     SET_INT (PTP);
 if ((ptp_unit.flags & UNIT_ATT) == 0)
     return IORETURN (ptp_stopioe, SCPE_UNATT);
-if (putc (ptp_unit.buf, ptp_unit.fileref) == EOF) {
+if (sim_spool_putc (&ptp_unit, ptp_unit.buf) != SCPE_OK) {
     sim_perror ("PTP I/O error");
-    clearerr (ptp_unit.fileref);
     return SCPE_IOERR;
     }
 ptp_csr = ptp_csr & ~CSR_ERR;
@@ -364,7 +365,7 @@ t_stat ptp_attach (UNIT *uptr, CONST char *cptr)
 {
 t_stat reason;
 
-reason = attach_unit (uptr, cptr);
+reason = sim_spool_attach (uptr, cptr);
 if ((ptp_unit.flags & UNIT_ATT) == 0)
     ptp_csr = ptp_csr | CSR_ERR;
 else ptp_csr = ptp_csr & ~CSR_ERR;
@@ -926,6 +926,7 @@ r = sim_disk_attach_ex2 (uptr, cptr, RK_NUMWD * sizeof (uint16),
                          RK_RSRVSEC);
 if (r != SCPE_OK)                                       /* error? */
     return r;
+sim_disk_set_track (uptr, RK_NUMSC);                    /* cache by track */
 return SCPE_OK;
 }
 
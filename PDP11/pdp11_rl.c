@@ -1031,6 +1031,7 @@ r = sim_disk_attach_ex (uptr, cptr, RL_NUMWD * sizeof (uint16),
                         (uptr->flags & UNIT_NOAUTO) ? NULL : drives);
 if (r != SCPE_OK)                                       /* error? */
     return r;
+sim_disk_set_track (uptr, RL_NUMSC);                    /* cache by track */
 /*
 For compatibility with existing SIMH behavior, set the drive state
 as if the load procedure had already executed.
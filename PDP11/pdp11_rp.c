@@ -1381,6 +1381,7 @@ r = sim_disk_attach_ex (uptr, cptr, RP_NUMWD * sizeof (uint16),
                         0, (uptr->flags & UNIT_AUTO) ? drives : NULL);
 if (r != SCPE_OK)                                       /* error? */
     return r;
+sim_disk_set_track (uptr, drv_tab[GET_DTYPE (uptr->flags)].sect); /* cache by track */
 drv = (int32) (uptr - dptr->units);                     /* get drv number */
 rpds[drv] = DS_MOL | DS_RDY | DS_DPR |                  /* upd drv status */
     ((uptr->flags & UNIT_WPRT)? DS_WRL: 0);
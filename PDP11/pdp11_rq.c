@@ -996,6 +996,7 @@ t_bool rq_step4 (MSC *cp);
 t_bool rq_mscp (MSC *cp, uint16 pkt, t_bool q);
 t_bool rq_abo (MSC *cp, uint16 pkt, t_bool q);
 t_bool rq_avl (MSC *cp, uint16 pkt, t_bool q);
+t_bool rq_flu (MSC *cp, uint16 pkt, t_bool q);
 t_bool rq_fmt (MSC *cp, uint16 pkt, t_bool q);
 t_bool rq_gcs (MSC *cp, uint16 pkt, t_bool q);
 t_bool rq_gus (MSC *cp, uint16 pkt, t_bool q);
@@ -1779,9 +1780,11 @@ switch (cmd) {
     case OP_WR:                                         /* write */
         return rq_rw (cp, pkt, q);
 
+    case OP_FLU:                                        /* flush */
+        return rq_flu (cp, pkt, q);
+
     case OP_CCD:                                        /* nops */
     case OP_DAP:
-    case OP_FLU:
         cmd = cmd | OP_END;                             /* set end flag */
         sts = ST_SUC;                                   /* success */
         break;
@@ -1871,6 +1874,28 @@ rq_putr (cp, pkt, cmd | OP_END, 0, sts, AVL_LNT, UQ_TYP_SEQ);
 return rq_putpkt (cp, pkt, TRUE);
 }
 
+/* Flush - commit the unit's writes to stable storage - defer if q'd cmds,
+   so that every write issued before the flush is complete and committed */
+
+t_bool rq_flu (MSC *cp, uint16 pkt, t_bool q)
+{
+uint16 lu = cp->pak[pkt].d[CMD_UN];                     /* unit # */
+uint16 cmd = GETP (pkt, CMD_OPC, OPC);                  /* opcode */
+UNIT *uptr;
+
+sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_flu\n");
+
+if ((uptr = rq_getucb (cp, lu))) {                      /* unit exist? */
+    if (q && (uptr->cpkt || uptr->pktq)) {              /* need to queue? */
+        rq_enqt (cp, &uptr->pktq, pkt);                 /* do later */
+        return OK;
+        }
+    sim_disk_sync (uptr);                               /* commit writes */
+    }
+rq_putr (cp, pkt, cmd | OP_END, 0, ST_SUC, RSP_LNT, UQ_TYP_SEQ);
+return rq_putpkt (cp, pkt, TRUE);
+}
+
 /* Get command status - only interested in active xfr cmd */
 
 t_bool rq_gcs (MSC *cp, uint16 pkt, t_bool q)
@@ -2408,7 +2433,12 @@ else rq_rw_end (cp, uptr, 0, ST_SUC);                   /* done! */
 return SCPE_OK;
 }
 
-/* Transfer command complete */
+/* Transfer command complete
+
+   Units overlap with each other, but a unit runs one transfer at a time:
+   sim_disk allows a single outstanding request per unit and the unit has
+   one transfer buffer.  Commands queued behind it start here, as soon as
+   the current one ends, rather than waiting for the queue thread. */
 
 t_bool rq_rw_end (MSC *cp, UNIT *uptr, uint16 flg, uint16 sts)
 {
@@ -2416,7 +2446,6 @@ uint16 pkt = uptr->cpkt;                                /* packet */
 uint16 cmd = GETP (pkt, CMD_OPC, OPC);                  /* get cmd */
 uint32 bc = GETP32 (pkt, RW_BCL);                       /* init bc */
 uint32 wbc = GETP32 (pkt, RW_WBCL);                     /* work bc */
-DEVICE *dptr = rq_devmap[uptr->cnum];
 
 sim_debug (DBG_TRC, rq_devmap[cp->cnum], "rq_rw_end\n");
 
@@ -2433,8 +2462,10 @@ cp->pak[pkt].d[RW_WMPH] = 0;
 rq_putr (cp, pkt, cmd | OP_END, flg, sts, RW_LNT_D, UQ_TYP_SEQ); /* fill pkt */
 if (!rq_putpkt (cp, pkt, TRUE))                         /* send pkt */
     return ERR;
-if (uptr->pktq)                                         /* more to do? */
-    sim_activate (dptr->units + RQ_QUEUE, rq_qtime);    /* activate thread */
+if (uptr->pktq) {                                       /* more to do? */
+    pkt = rq_deqh (cp, &uptr->pktq);                    /* start next now */
+    return rq_mscp (cp, pkt, FALSE);
+    }
 return OK;
 }
 
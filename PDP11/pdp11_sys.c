@@ -264,22 +264,23 @@ const char *sim_stop_messages[SCPE_BASE] = {
    If the byte count is exactly six, the block is the last on the tape, and
    there is no checksum.  If the origin is not 000001, then the origin is
    the PC at which to start the program.
+
+   The tape image is parsed in place from memory, and the data of a block
+   which lies wholly in memory is deposited in one piece.
 */
 
-t_stat sim_load (FILE *fileref, CONST char *cptr, CONST char *fnam, int flag)
+static t_stat sim_load_blocks (const uint8 *img, size_t size)
 {
 int32 c[6], d, i, cnt, csum;
 uint32 org;
+size_t p = 0;
 
-if (*cptr != 0)
-    return SCPE_ARG;
-if (flag != 0)
-    return sim_messagef (SCPE_NOFNC, "Command Not Implemented\n");
 do {                                                    /* block loop */
     csum = 0;                                           /* init checksum */
     for (i = 0; i < 6; ) {                              /* 6 char header */
-        if ((c[i] = Fgetc (fileref)) == EOF)
+        if (p >= size)
             return SCPE_FMT;
+        c[i] = img[p++];
         if ((i != 0) || (c[i] == 1))                    /* 1st must be 1 */
             csum = csum + c[i++];                       /* add into csum */
         }
@@ -292,22 +293,51 @@ do {                                                    /* block loop */
             saved_PC = org & 0177776;
         return SCPE_OK;
         }
+#if !defined (UC15)
+    if (((p + cnt - 6) <= size) &&                      /* whole block in memory? */
+        ((org + cnt - 6) <= 0200000) &&
+        ADDR_IS_MEM (org + cnt - 7)) {
+        for (i = 6; i < cnt; i++)                       /* exclude hdr */
+            csum = csum + img[p + i - 6];               /* add into csum */
+        sim_mem_load_bytes (M, sizeof (*M), org, &img[p], cnt - 6);
+        p = p + cnt - 6;
+        }
+    else
+#endif
     for (i = 6; i < cnt; i++) {                         /* exclude hdr */
-        if ((d = Fgetc (fileref)) == EOF)                /* data char */
+        if (p >= size)                                  /* data char */
             return SCPE_FMT;
+        d = img[p++];
         csum = csum + d;                                /* add into csum */
         if (!ADDR_IS_MEM (org))                         /* invalid addr? */
             return SCPE_NXM;
         WrMemB (org, ((uint16) d));
         org = (org + 1) & 0177777;                      /* inc origin */
         }
-    if ((d = Fgetc (fileref)) == EOF)                    /* get csum */
+    if (p >= size)                                      /* get csum */
         return SCPE_FMT;
-    csum = csum + d;                                    /* add in */
+    csum = csum + img[p++];                             /* add in */
     } while ((csum & 0377) == 0);                       /* result mbz */
 return SCPE_CSUM;
 }
 
+t_stat sim_load (FILE *fileref, CONST char *cptr, CONST char *fnam, int flag)
+{
+SIM_LOAD_IMAGE image;
+t_stat r;
+
+if (*cptr != 0)
+    return SCPE_ARG;
+if (flag != 0)
+    return sim_messagef (SCPE_NOFNC, "Command Not Implemented\n");
+r = sim_load_image_open (fileref, &image);
+if (r != SCPE_OK)
+    return r;
+r = sim_load_blocks (image.data, image.size);
+sim_load_image_close (&image);
+return r;
+}
+
 /* Symbol tables */
 
 #define I_V_L           16                              /* long mode */
@@ -120,11 +120,14 @@
 #define DT_M_NUMDR      (DT_NUMDR - 1)
 #define UNIT_V_8FMT     (UNIT_V_UF + 0)                 /* 12b format */
 #define UNIT_V_11FMT    (UNIT_V_UF + 1)                 /* 16b format */
+#define UNIT_V_INST     (UNIT_V_UF + 2)                 /* instant motion */
 #define UNIT_8FMT       (1 << UNIT_V_8FMT)
 #define UNIT_11FMT      (1 << UNIT_V_11FMT)
+#define UNIT_INST       (1 << UNIT_V_INST)
 #define STATE           u3                              /* unit state */
 #define LASTT           u4                              /* last time update */
 #define WRITTEN         u5                              /* device buffer is dirty and needs flushing */
+#define SKIPT           u6                              /* motion time skipped */
 
 /* System independent DECtape constants */
 
@@ -303,6 +306,7 @@ t_stat dt_boot (int32 unitno, DEVICE *dptr);
 void dt_deselect (int32 oldf);
 void dt_newsa (int32 newf);
 void dt_newfnc (UNIT *uptr, int32 newsta);
+void dt_sched (UNIT *uptr, int32 delay);
 t_bool dt_setpos (UNIT *uptr);
 void dt_schedez (UNIT *uptr, int32 dir);
 void dt_seterr (UNIT *uptr, int32 e);
@@ -373,6 +377,8 @@ REG dt_reg[] = {
               DT_NUMDR, REG_RO, "unit state, units 0 to 7") },
     { URDATA (LASTT, dt_unit[0].LASTT, 10, 32, 0,
               DT_NUMDR, REG_HRO) },
+    { URDATA (SKIPT, dt_unit[0].SKIPT, 10, 32, 0,
+              DT_NUMDR, REG_HRO) },
     { FLDATAD (STOP_OFFR, dt_stopoffr, 0, "stop on off-reel error") },
     { ORDATA (DEVADDR, dt_dib.ba, 32), REG_HRO },
     { ORDATA (DEVVEC, dt_dib.vec, 16), REG_HRO },
@@ -387,6 +393,10 @@ MTAB dt_mod[] = {
     { UNIT_8FMT + UNIT_11FMT,          0, "18b", NULL },
     { UNIT_8FMT + UNIT_11FMT,  UNIT_8FMT, "12b", NULL },
     { UNIT_8FMT + UNIT_11FMT, UNIT_11FMT, "16b", NULL },
+    { UNIT_INST, UNIT_INST, "instant motion", "INSTANT",
+        NULL, NULL, NULL, "Complete tape motion at the next service" },
+    { UNIT_INST,         0, NULL, "REALTIME",
+        NULL, NULL, NULL, "Model tape motion at transport speed" },
     { MTAB_XTD|MTAB_VDV|MTAB_VALR, 010, "ADDRESS", "ADDRESS",
         &set_addr, &show_addr, NULL, "Bus address" },
     { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "VECTOR", "VECTOR",
@@ -623,7 +633,7 @@ if (prev_mot == DTS_STOP) {                             /* start? */
     if (dt_setpos (uptr))                               /* update pos */
         return;
     sim_cancel (uptr);                                  /* stop current */
-    sim_activate (uptr, dt_dctime - (dt_dctime >> 2));  /* sched accel */
+    dt_sched (uptr, dt_dctime - (dt_dctime >> 2));      /* sched accel */
     DTS_SETSTA (DTS_ACCF | new_dir, 0);                 /* state = accel */
     DTS_SET2ND (DTS_ATSF | new_dir, new_fnc);           /* next = fnc */
     return;
@@ -640,7 +650,7 @@ if (prev_mot < DTS_ACCF) {                              /* not accel/at speed? *
     if (dt_setpos (uptr))                               /* update pos */
         return;
     sim_cancel (uptr);                                  /* cancel cur */
-    sim_activate (uptr, dt_dctime - (dt_dctime >> 2));  /* sched accel */
+    dt_sched (uptr, dt_dctime - (dt_dctime >> 2));      /* sched accel */
     DTS_SETSTA (DTS_ACCF | new_dir, 0);                 /* state = accel */
     DTS_SET2ND (DTS_ATSF | new_dir, new_fnc);           /* next = fnc */
     return;
@@ -765,7 +775,29 @@ switch (fnc) {                                          /* case function */
         return;
         }
 
-sim_activate (uptr, ABS (newpos - ((int32) uptr->pos)) * dt_ltime);
+dt_sched (uptr, ABS (newpos - ((int32) uptr->pos)) * dt_ltime);
+return;
+}
+
+/* Schedule DECtape motion
+
+   In instant motion mode, an interval longer than the fast command time
+   is cut to the fast command time, and the time skipped is recorded.  The
+   unit service adds it back to the elapsed time before updating the
+   position, so the tape arrives exactly where it would have at speed,
+   and the program sees the same blocks in the same order.  Intervals in
+   which the program must respond (end zone after done, read all, write
+   all) are not scheduled through here and run at transport speed.
+*/
+
+void dt_sched (UNIT *uptr, int32 delay)
+{
+uptr->SKIPT = 0;
+if ((uptr->flags & UNIT_INST) && (delay > dt_ctime)) {
+    uptr->SKIPT = delay - dt_ctime;
+    delay = dt_ctime;
+    }
+sim_activate (uptr, delay);
 return;
 }
 
@@ -859,6 +891,9 @@ int32 blk, wrd, relpos, dat;
 uint32 ba, ma;
 uint16 wbuf;
 
+uptr->LASTT = uptr->LASTT - uptr->SKIPT;                /* credit skipped time */
+uptr->SKIPT = 0;
+
 /* Motion cases
 
    Decelerating - if next state != stopped, must be accel reverse
@@ -873,7 +908,7 @@ switch (mot) {
             return IORETURN (dt_stopoffr, STOP_DTOFF);
         uptr->STATE = DTS_NXTSTA (uptr->STATE);         /* advance state */
         if (uptr->STATE)                                /* not stopped? */
-            sim_activate (uptr, dt_dctime - (dt_dctime >> 2)); /* reversing */
+            dt_sched (uptr, dt_dctime - (dt_dctime >> 2)); /* reversing */
         return SCPE_OK;
 
     case DTS_ACCF: case DTS_ACCR:                       /* accelerating */
@@ -948,7 +983,7 @@ switch (fnc) {                                          /* at speed, check fnc *
             dt_schedez (uptr, dir);                     /* sched end zone */
             DT_SETDONE;                                 /* set done */
             }
-        else sim_activate (uptr, ((2 * DT_HTLIN) + DT_WSIZE) * dt_ltime);
+        else dt_sched (uptr, ((2 * DT_HTLIN) + DT_WSIZE) * dt_ltime);
         break;                  
 
 /* Write
@@ -990,7 +1025,7 @@ switch (fnc) {                                          /* at speed, check fnc *
             dt_schedez (uptr, dir);                     /* sched end zone */
             DT_SETDONE;
             }
-        else sim_activate (uptr, ((2 * DT_HTLIN) + DT_WSIZE) * dt_ltime);
+        else dt_sched (uptr, ((2 * DT_HTLIN) + DT_WSIZE) * dt_ltime);
         break;                  
 
 /* Read all - read current header or data word */
@@ -1066,7 +1101,7 @@ if (mot >= DTS_ACCF) {                                  /* ~stopped or stopping?
     sim_cancel (uptr);                                  /* cancel activity */
     if (dt_setpos (uptr))                               /* update position */
         return;
-    sim_activate (uptr, dt_dctime);                     /* sched decel */
+    dt_sched (uptr, dt_dctime);                         /* sched decel */
     DTS_SETSTA (DTS_DECF | (mot & DTS_DIR), 0);         /* state = decel */
     }
 else DTS_SETSTA (mot, 0);                               /* clear 2nd, 3rd */
@@ -1085,7 +1120,7 @@ if ((mot & ~DTS_DIR) != DTS_DECF) {                     /* !already stopping? */
     if (dt_setpos (uptr))                               /* update pos */
         return;
     sim_cancel (uptr);                                  /* stop current */
-    sim_activate (uptr, dt_dctime);                     /* schedule decel */
+    dt_sched (uptr, dt_dctime);                         /* schedule decel */
     }
 DTS_SETSTA (DTS_DECF | dir, 0);                         /* state = decel */
 return;
@@ -1100,6 +1135,7 @@ int32 newpos;
 if (dir)                                                /* rev? rev ez */
     newpos = DT_EZLIN - DT_WSIZE;
 else newpos = DTU_FWDEZ (uptr) + DT_WSIZE;              /* fwd? fwd ez */
+uptr->SKIPT = 0;
 sim_activate (uptr, ABS (newpos - ((int32) uptr->pos)) * dt_ltime);
 return;
 }
@@ -1163,7 +1199,7 @@ for (i = 0; i < DT_NUMDR; i++) {                        /* stop all activity */
             if (dt_setpos (uptr))                       /* update pos */
                 continue;
             sim_cancel (uptr);
-            sim_activate (uptr, dt_dctime);             /* sched decel */
+            dt_sched (uptr, dt_dctime);                 /* sched decel */
             DTS_SETSTA (DTS_DECF | (prev_mot & DTS_DIR), 0);
             }
         }
@@ -1171,6 +1207,7 @@ for (i = 0; i < DT_NUMDR; i++) {                        /* stop all activity */
         sim_cancel (uptr);                              /* sim reset */
         uptr->STATE = 0;  
         uptr->LASTT = sim_grtime ();
+        uptr->SKIPT = 0;
         }
     }
 tcst =  tcwc = tcba = tcdt = 0;                         /* clear reg */
@@ -1301,6 +1338,7 @@ else if (uptr->flags & UNIT_11FMT)
 else sim_printf ("18b/36b format");
 sim_printf (", buffering file in memory\n");
 uptr->io_flush = dt_flush;
+uptr->dynflags |= UNIT_SYNC_FLUSH;                      /* checkpoint while running */
 if (uptr->flags & UNIT_8FMT) {                          /* 12b? */
     for (ba = 0; ba < uptr->capac; ) {                  /* loop thru file */
         k = fxread (pdp8b, sizeof (int16), D8_NBSIZE, uptr->fileref);
@@ -1335,6 +1373,8 @@ else uptr->hwmark = fxread (uptr->filebuf, sizeof (uint32),
 uptr->flags = uptr->flags | UNIT_BUF;                   /* set buf flag */
 uptr->pos = DT_EZLIN;                                   /* beyond leader */
 uptr->LASTT = sim_grtime ();                            /* last pos update */
+uptr->SKIPT = 0;
+uptr->WRITTEN = FALSE;
 return SCPE_OK;
 }
 
@@ -1345,6 +1385,10 @@ return SCPE_OK;
    If 16b, convert 18b buffer to 16b and write to file
    If 18b/36b, write buffer to file
    Deallocate buffer
+
+   The flush routine also runs from the periodic buffered file flush while
+   the simulator is running, so a modified tape is checkpointed to its
+   file without waiting for detach.
 */
 
 void dt_flush (UNIT* uptr)
@@ -1355,7 +1399,8 @@ int32 k;
 uint32 ba, *fbuf;
 
 if (uptr->WRITTEN && uptr->hwmark && ((uptr->flags & UNIT_WPRT)== 0)) {    /* any data? */
-    sim_printf ("%s: writing buffer to file: %s\n", sim_uname (uptr), uptr->filename);
+    if (!sim_is_running)                                /* quiet checkpoint */
+        sim_printf ("%s: writing buffer to file: %s\n", sim_uname (uptr), uptr->filename);
     rewind (uptr->fileref);                             /* start of file */
     fbuf = (uint32 *) uptr->filebuf;                    /* file buffer */
     if (uptr->flags & UNIT_8FMT) {                      /* 12b? */
@@ -1385,6 +1430,7 @@ if (uptr->WRITTEN && uptr->hwmark && ((uptr->flags & UNIT_WPRT)== 0)) {    /* an
         else 
             fxwrite (uptr->filebuf, sizeof (uint32),    /* write file */
                      uptr->hwmark, uptr->fileref);
+    fflush (uptr->fileref);
     if (ferror (uptr->fileref))
         sim_perror ("I/O error");
     }
@@ -1410,6 +1456,7 @@ if (sim_is_active (uptr)) {                             /* active? cancel op */
 if (uptr->hwmark && ((uptr->flags & UNIT_WPRT) == 0))   /* any data? */
     dt_flush (uptr);                                    /* end if hwmark */
 free (uptr->filebuf);                                   /* release buf */
+uptr->dynflags &= ~UNIT_SYNC_FLUSH;
 uptr->flags = uptr->flags & ~(UNIT_BUF | UNIT_RO);      /* clear buf & read only flags */
 uptr->filebuf = NULL;                                   /* clear buf ptr */
 uptr->flags = (uptr->flags | UNIT_11FMT) & ~UNIT_8FMT;  /* default fmt */
@@ -1560,7 +1607,18 @@ text2 =
 "    -  LTIME must be at least 6\n"
 "    -  DCTIME needs to be at least 100 times LTIME\n"
 "\n"
-" Acceleration time is set to 75% of deceleration time.\n";
+" Acceleration time is set to 75% of deceleration time.\n"
+"\n"
+/*567901234567890123456789012345678901234567890123456789012345678901234567890*/
+" SET TCn INSTANT makes acceleration, deceleration, searches and the gaps\n"
+" between blocks complete in CTIME instructions.  The tape position still\n"
+" advances as if the transport were at speed, so the program sees the same\n"
+" block numbers in the same order.  Motion after done is set, and READ ALL\n"
+" and WRITE ALL, stay at transport speed so the program has its usual time\n"
+" to respond.  SET TCn REALTIME restores full motion timing.\n"
+"\n"
+" A modified tape is written back to its file by the periodic flush of\n"
+" buffered files (every 30 seconds by default), as well as at detach.\n";
 fprintf (st, "%s", text2);
 return SCPE_OK;
 }
@@ -106,6 +106,8 @@
 #define TQ_DCTMO        120                             /* def ctrl timeout */
 #define TQ_NUMDR        4                               /* # drives */
 #define TQ_MAXFR        (1 << 16)                       /* max xfer */
+#define TQ_MAXRA        8                               /* max read ahead */
+#define TQ_WBOVH        (2 * sizeof (t_mtrlnt) + 1)     /* rec overhead */
 
 #define UNIT_V_ONL      (MTUF_V_UF + 0)                 /* online */
 #define UNIT_V_ATP      (MTUF_V_UF + 1)                 /* attn pending */
@@ -269,6 +271,7 @@ int32 tq_qtime = 200;                                   /* queue time */
 int32 tq_xtime = 500;                                   /* transfer time */
 int32 tq_rwtime = 2000000;                              /* rewind time 2 sec (adjusted later) */
 int32 tq_typ = INIT_TYPE;                               /* device type */
+int32 tq_stream = 0;                                    /* read ahead depth */
 
 /* Command table - legal modifiers (low 16b) and flags (high 16b) */
 
@@ -357,6 +360,8 @@ t_stat tq_set_type (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat tq_show_type (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat tq_set_plug (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat tq_show_plug (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+t_stat tq_set_stream (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat tq_show_stream (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 static t_stat tq_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr);
 const char *tq_description (DEVICE *dptr);
 
@@ -383,6 +388,11 @@ void tq_rdbuff_top (UNIT *uptr, t_mtrlnt *tbc);
 uint32 tq_rdbuff_bottom (UNIT *uptr, t_mtrlnt *tbc);
 void tq_rdbufr_top (UNIT *uptr, t_mtrlnt *tbc);
 uint32 tq_rdbufr_bottom (UNIT *uptr, t_mtrlnt *tbc);
+t_stat tq_ra_next (UNIT *uptr);
+t_bool tq_ra_get (UNIT *uptr);
+void tq_ra_flush (UNIT *uptr);
+void tq_ra_complete (UNIT *uptr, t_stat status);
+void tq_wb_complete (UNIT *uptr, t_stat status);
 t_bool tq_deqf (uint16 *pkt);
 uint16 tq_deqh (uint16 *lh);
 void tq_enqh (uint16 *lh, int16 pkt);
@@ -490,6 +500,8 @@ MTAB tq_mod[] = {
         NULL, &tq_show_type, NULL, "Display device type" },
     { MTAB_XTD|MTAB_VUN|MTAB_VALR, 0, "UNIT", "UNIT=val (0-65534)",
       &tq_set_plug, &tq_show_plug, NULL, "Set/Display Unit plug value" },
+    { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "STREAM", "STREAM=n (0-8)",
+      &tq_set_stream, &tq_show_stream, NULL, "Set/Display streaming read ahead depth" },
     { MTAB_XTD|MTAB_VDV|MTAB_NMO, TQ_SH_RI, "RINGS", NULL,
         NULL, &tq_show_ctrl, NULL, "Display command and response rings" },
     { MTAB_XTD|MTAB_VDV|MTAB_NMO, TQ_SH_FR, "FREEQ", NULL,
@@ -563,9 +575,22 @@ struct tq_req_results {           /* intermediate State during tape motion comma
     uint32 skrec;
     t_mtrlnt tbc;
     int32 objupd;
-    uint8 tqxb[TQ_MAXFR];
+    uint8 tqxb[TQ_MAXFR];                               /* must follow state */
+    /* streaming state, kept across commands */
+    uint32 ra_head;                                     /* oldest read ahead */
+    uint32 ra_cnt;                                      /* records read ahead */
+    t_bool ra_busy;                                     /* read ahead active */
+    t_addr ra_pos[TQ_MAXRA];                            /* pos before record */
+    t_stat ra_st[TQ_MAXRA];                             /* read status */
+    t_mtrlnt ra_bc[TQ_MAXRA];                           /* record length */
+    uint8 *ra_buf;                                      /* read ahead buffers */
+    t_bool wb_busy;                                     /* write behind active */
+    t_bool wb_dls;                                      /* cached data lost */
     };
 
+#define TQ_RES(u)       ((struct tq_req_results *) (u)->results)
+#define TQ_STRBSY(u)    (TQ_RES (u)->ra_busy || TQ_RES (u)->wb_busy)
+
 /* I/O dispatch routines, I/O addresses 17774500 - 17774502
 
    17774500     IP      read/write
@@ -735,7 +760,7 @@ for (i = 0; i < TQ_NUMDR; i++) {                        /* chk unit q's */
     uint16 tpkt;
 
     nuptr = tq_dev.units + i;                           /* ptr to unit */
-    if (nuptr->cpkt || (nuptr->pktq == 0))
+    if (nuptr->cpkt || (nuptr->pktq == 0) || TQ_STRBSY (nuptr))
         continue;
     tpkt = nuptr->pktq;
     pkt = tq_deqh (&tpkt);                              /* get top of q */
@@ -842,15 +867,16 @@ else if (mdf & ~tq_cmf[cmd]) {                          /* invalid mod? */
 else {                                                  /* valid cmd */
     if ((uptr = tq_getucb (lu))) {                      /* valid unit? */
         if (q && (tq_cmf[cmd] & CMF_SEQ) &&             /* queueing, seq, */
-            (uptr->cpkt || uptr->pktq)) {               /* and active? */
+            (uptr->cpkt || uptr->pktq || TQ_STRBSY (uptr))) { /* and active? */
             tq_enqt (&uptr->pktq, pkt);                 /* do later */
             return OK;
             }
-//      if (tq_cmf[cmd] & MD_CDL)                       /* clr cch lost? */
-//          uptr->flags = uptr->flags & ~UNIT_CDL;
+        if (mdf & MD_CDL)                               /* clr cch lost? */
+            TQ_RES (uptr)->wb_dls = FALSE;
         if ((mdf & MD_CSE) && (uptr->flags & UNIT_SXC)) /* clr ser exc? */
             uptr->flags = uptr->flags & ~UNIT_SXC;
-        memset (uptr->results, 0, sizeof (struct tq_req_results)); /* init request state */
+        if (tq_cmf[cmd] & CMF_SEQ)                      /* init request state */
+            memset (uptr->results, 0, offsetof (struct tq_req_results, tqxb));
         }
     switch (cmd) {
 
@@ -971,6 +997,7 @@ if ((uptr = tq_getucb (lu))) {                          /* unit exist? */
         sts = ST_SXC;
     else {
         uptr->flags = uptr->flags & ~(UNIT_ONL | UNIT_TMK | UNIT_POL);
+        tq_ra_flush (uptr);                             /* drop read ahead */
         sim_tape_rewind (uptr);                         /* rewind */
         uptr->uf = uptr->objp = 0;                      /* clr flags */
         if (uptr->flags & UNIT_ATT) {                   /* attached? */
@@ -1059,6 +1086,7 @@ if ((uptr = tq_getucb (lu))) {                          /* unit exist? */
         sts = ST_SUC | SB_SUC_ON;
     else {
         sts = ST_SUC;                                   /* mark online */
+        tq_ra_flush (uptr);                             /* drop read ahead */
         sim_tape_rewind (uptr);                         /* rewind */
         uptr->objp = 0;                                 /* clear flags */
         uptr->flags = (uptr->flags | UNIT_ONL) &
@@ -1329,8 +1357,8 @@ sim_debug (DBG_TRC, &tq_dev, "tq_svc(unit=%d, pkt=%d, cmd=%s, mdf=0x%0X, bc=0x%0
            uptr->io_complete ? "bottom" : "top");
 
 res->io_complete = 0;
-if (pkt == 0)                                           /* what??? */
-    return SCPE_IERR;
+if (pkt == 0)                                           /* stream wakeup? */
+    return tq_ra_next (uptr);
 if ((uptr->flags & UNIT_ATT) == 0) {                    /* not attached? */
     tq_mot_end (uptr, 0, ST_OFL | SB_OFL_NV, 0);        /* offl no vol */
     return SCPE_OK;
@@ -1351,6 +1379,9 @@ if (tq_cmf[cmd] & CMF_WR) {                             /* write op? */
 if (!io_complete) {
     res->sts = ST_SUC;                                  /* assume success */
     res->tbc = 0;                                       /* assume zero rec */
+    if (((cmd != OP_RD) && (cmd != OP_ACC) && (cmd != OP_CMP)) ||
+        (mdf & MD_REV))                                 /* not read fwd? */
+        tq_ra_flush (uptr);                             /* drop read ahead */
     }
 switch (cmd) {                                          /* case on command */
 
@@ -1358,7 +1389,7 @@ switch (cmd) {                                          /* case on command */
         if (!io_complete) {
             if (mdf & MD_REV)                           /* read record */
                 tq_rdbufr_top (uptr, &res->tbc);
-            else
+            else if (!tq_ra_get (uptr))                 /* not read ahead? */
                 tq_rdbuff_top (uptr, &res->tbc);
             return SCPE_OK;
             }
@@ -1428,7 +1459,14 @@ switch (cmd) {                                          /* case on command */
                     tq_mot_end (uptr, EF_LOG, ST_HST | SB_HST_NXM, bc);     
                 return SCPE_OK;                         /* end else wr */
                 }
-            sim_tape_wrrecf_a (uptr, res->tqxb, bc, tq_io_complete); /* write rec fwd */
+            if (tq_stream && (uptr->uf & UF_CAC) &&     /* write back, */
+                ((uptr->capac == 0) ||                  /* well short of EOT? */
+                 ((uptr->pos + bc + TQ_WBOVH) < uptr->capac))) {
+                res->wb_busy = TRUE;                    /* write behind */
+                tq_io_complete (uptr, MTSE_OK);         /* don't wait */
+                sim_tape_wrrecf_a (uptr, res->tqxb, bc, tq_wb_complete);
+                }
+            else sim_tape_wrrecf_a (uptr, res->tqxb, bc, tq_io_complete); /* write rec fwd */
             return SCPE_OK;
             } 
         if (res->io_status)
@@ -1498,6 +1536,9 @@ switch (cmd) {                                          /* case on command */
         }
 
 tq_mot_end (uptr, 0, (uint16)res->sts, res->tbc);       /* done */
+if ((tq_cmf[cmd] & CMF_RW) && (cmd != OP_WR) &&         /* good read fwd? */
+    !(mdf & MD_REV) && (res->sts == ST_SUC))
+    tq_ra_next (uptr);                                  /* read ahead */
 return SCPE_OK;
 }
 
@@ -1644,6 +1685,118 @@ uptr->objp = uptr->objp - 1;                            /* upd obj cnt */
 return ST_SUC;
 }
 
+/* Streaming
+
+   With SET TQ STREAM=n, a unit that has just completed a good forward read
+   goes on reading the next n records into a ring of buffers while the host
+   digests the data, and later forward reads are answered from the ring.
+   Read ahead stops with the first tape mark or error, whose status is kept
+   for the read that would have encountered it.  Any other motion command,
+   and AVAILABLE or ONLINE, drops the ring and puts the tape back where the
+   host thinks it is.  Only SIMH and E11 format images, on which a record's
+   starting position is all the state there is, are read ahead.
+
+   If the host has also enabled write back caching (UF_CAC) in the unit
+   flags, a write well short of EOT is acknowledged as soon as its data has
+   been fetched.  If the write then fails, the failure is reported on the
+   next command as a serious exception with position and cached data lost.
+
+   Only one tape operation is outstanding per unit, so sequential commands
+   for a unit wait in its queue while read ahead or write behind is active.
+*/
+
+t_stat tq_ra_next (UNIT *uptr)
+{
+struct tq_req_results *res = TQ_RES (uptr);
+uint32 i;
+
+if ((tq_stream == 0) || uptr->cpkt || uptr->pktq ||     /* off or busy? */
+    TQ_STRBSY (uptr) || (res->ra_cnt >= (uint32) tq_stream) ||
+    ((uptr->flags & (UNIT_ATT | UNIT_ONL | UNIT_SXC)) != (UNIT_ATT | UNIT_ONL)) ||
+    ((MT_GET_FMT (uptr) != MTUF_F_STD) && (MT_GET_FMT (uptr) != MTUF_F_E11)))
+    return SCPE_OK;
+i = (res->ra_head + res->ra_cnt - 1) % TQ_MAXRA;        /* last read ahead */
+if (res->ra_cnt && (res->ra_st[i] != MTSE_OK))          /* stopped there? */
+    return SCPE_OK;
+if ((res->ra_buf == NULL) &&                            /* first use? */
+    ((res->ra_buf = (uint8 *) malloc (TQ_MAXRA * TQ_MAXFR)) == NULL))
+    return SCPE_OK;
+i = (res->ra_head + res->ra_cnt) % TQ_MAXRA;            /* next slot */
+res->ra_pos[i] = uptr->pos;
+res->ra_busy = TRUE;
+sim_tape_rdrecf_a (uptr, res->ra_buf + (i * TQ_MAXFR), &res->ra_bc[i],
+                   TQ_MAXFR, tq_ra_complete);
+return SCPE_OK;
+}
+
+void tq_ra_complete (UNIT *uptr, t_stat status)
+{
+struct tq_req_results *res = TQ_RES (uptr);
+
+sim_debug(DBG_TRC, &tq_dev, "tq_ra_complete(status=%d)\n", status);
+
+if (!res->ra_busy)                                      /* dropped? */
+    return;
+res->ra_busy = FALSE;
+res->ra_st[(res->ra_head + res->ra_cnt) % TQ_MAXRA] = status;
+res->ra_cnt = res->ra_cnt + 1;
+if (uptr->pktq)                                         /* cmds waiting? */
+    sim_activate (&tq_unit[TQ_QUEUE], tq_qtime);
+else sim_activate (uptr, 0);                            /* read more */
+}
+
+/* Answer a forward read from the ring */
+
+t_bool tq_ra_get (UNIT *uptr)
+{
+struct tq_req_results *res = TQ_RES (uptr);
+uint32 i = res->ra_head;
+
+if (res->ra_cnt == 0)
+    return FALSE;
+res->tbc = res->ra_bc[i];
+memcpy (res->tqxb, res->ra_buf + (i * TQ_MAXFR), res->tbc);
+res->ra_head = (i + 1) % TQ_MAXRA;
+res->ra_cnt = res->ra_cnt - 1;
+tq_io_complete (uptr, res->ra_st[i]);
+return TRUE;
+}
+
+/* Drop the ring, backing up over the records read ahead */
+
+void tq_ra_flush (UNIT *uptr)
+{
+struct tq_req_results *res = TQ_RES (uptr);
+
+if (res->ra_cnt || res->ra_busy) {
+    uptr->pos = res->ra_pos[res->ra_head];
+    MT_CLR_PNU (uptr);
+    }
+res->ra_cnt = 0;
+res->ra_busy = FALSE;
+}
+
+/* Write behind completion */
+
+void tq_wb_complete (UNIT *uptr, t_stat status)
+{
+struct tq_req_results *res = TQ_RES (uptr);
+
+sim_debug(DBG_TRC, &tq_dev, "tq_wb_complete(status=%d)\n", status);
+
+if (!res->wb_busy)                                      /* dropped? */
+    return;
+res->wb_busy = FALSE;
+if (uptr->cpkt)                                         /* write not done? */
+    res->io_status = status;                            /* report there */
+else if (status != MTSE_OK) {                           /* already acked? */
+    uptr->flags = uptr->flags | UNIT_SXC | UNIT_POL;
+    res->wb_dls = TRUE;                                 /* cached data lost */
+    }
+if (uptr->pktq)                                         /* cmds waiting? */
+    sim_activate (&tq_unit[TQ_QUEUE], tq_qtime);
+}
+
 /* Data transfer error log packet */
 
 t_bool tq_dte (UNIT *uptr, uint16 err)
@@ -1935,7 +2088,8 @@ return NULL;
 
 void tq_setf_unit (int16 pkt, UNIT *uptr)
 {
-uptr->uf = tq_pkt[pkt].d[ONL_UFL] & UF_MSK;             /* settable flags */
+uptr->uf = tq_pkt[pkt].d[ONL_UFL] &                     /* settable flags */
+    (UF_MSK | (tq_stream ? UF_CAC : 0));
 if ((tq_pkt[pkt].d[CMD_MOD] & MD_SWP) &&                /* swre wrp enb? */
     (tq_pkt[pkt].d[ONL_UFL] & UF_WPS))                  /* swre wrp on? */
     uptr->uf = uptr->uf | UF_WPS;                       /* simon says... */
@@ -1955,6 +2109,8 @@ if (uptr) {                                             /* any unit? */
         t = t | EF_SXC;
     if (TEST_EOT (uptr))                                /* note EOT */
         t = t | EF_EOT;
+    if (TQ_RES (uptr)->wb_dls)                          /* note data lost */
+        t = t | EF_DLS;
     }
 return t;
 }
@@ -2064,6 +2220,11 @@ if (r != SCPE_OK)
     return r;
 uptr->flags = uptr->flags & ~(UNIT_ONL | UNIT_ATP | UNIT_SXC | UNIT_POL | UNIT_TMK);
 uptr->uf = 0;                                           /* clr unit flgs */
+if (uptr->results) {                                    /* drop stream state */
+    TQ_RES (uptr)->ra_cnt = 0;
+    TQ_RES (uptr)->ra_busy = TQ_RES (uptr)->wb_busy = FALSE;
+    TQ_RES (uptr)->wb_dls = FALSE;
+    }
 return SCPE_OK;
 } 
 
@@ -2127,6 +2288,8 @@ for (i = 0; i < TQ_NUMDR + 2; i++) {                    /* init units */
         uptr->results = calloc (1, sizeof (struct tq_req_results));
     if (uptr->results == NULL)
         return SCPE_MEM;
+    tq_ra_flush (uptr);                                 /* drop stream state */
+    TQ_RES (uptr)->wb_busy = TQ_RES (uptr)->wb_dls = FALSE;
     }
 return SCPE_OK;
 }
@@ -2413,6 +2576,30 @@ for (i = 0; i < TQ_NUMDR; i++)
 return SCPE_OK;
 }
 
+/* Set/show streaming read ahead depth */
+
+t_stat tq_set_stream (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+int32 n;
+t_stat r;
+
+if (cptr == NULL)
+    return SCPE_ARG;
+n = (int32) get_uint (cptr, 10, TQ_MAXRA, &r);
+if (r != SCPE_OK)
+    return r;
+tq_stream = n;
+return SCPE_OK;
+}
+
+t_stat tq_show_stream (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+if (tq_stream)
+    fprintf (st, "stream=%d", tq_stream);
+else fprintf (st, "nostream");
+return SCPE_OK;
+}
+
 /* Show controller type and capacity */
 
 t_stat tq_show_type (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
@@ -2461,6 +2648,11 @@ fprintf (st, "The TQ controller simulates the %s TMSCP tape controller.  TQ opti
 fprintf (st, "include the ability to set units write enabled or write locked, and to\n");
 fprintf (st, "specify the controller type and tape length:\n");
 fprint_set_help (st, dptr);
+fprintf (st, "\nSET TQ STREAM=n lets each unit read up to n records ahead of forward\n");
+fprintf (st, "reads, and acknowledge writes before they complete if the host enables\n");
+fprintf (st, "write back caching.  Write behind errors are reported on the following\n");
+fprintf (st, "command.  Streaming applies to SIMH and E11 format tapes and is most\n");
+fprintf (st, "useful with SET TQ ASYNCH.  STREAM=0, the default, turns it off.\n");
 fprintf (st, "\nThe %s device supports the BOOT command.\n", devtype);
 fprint_show_help (st, dptr);
 fprint_reg_help (st, dptr);
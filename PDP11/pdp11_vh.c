@@ -429,6 +429,8 @@ typedef struct {
 #define TXS_DMA_PENDING 3
 } TMLX;
 
+#define TX_DMA_CHUNK    256     /* DMA transmit characters per transfer */
+
 static TMLN vh_ldsc[VH_MUXES * VH_LINES_ALLOC] = { { 0 } };
 static TMXR vh_desc = { VH_MUXES * VH_LINES_ALLOC, 0, 0, vh_ldsc };
 static TMLX vh_parm[VH_MUXES * VH_LINES_ALLOC] = { { 0 } };
@@ -1384,23 +1386,43 @@ static void doDMA ( int32   vh,
         pa |= (lp->tbuf2 & TB2_M_TBUFFAD) << 16;
         status = 0;
         while (tmxr_txdone_ln (lp->tmln) && (lp->tbuffct > 0)) {
-            uint8   buf;
+            uint8   buf[TX_DMA_CHUNK];
+            int32   i, cnt, got;
+            size_t  put;
+
             if (lp->lnctrl & LNCTRL_TX_ABORT) {
                 lp->tbuf2 &= ~TB2_TX_DMA_START;
                 q_tx_report (lp, 0);
                 break;
             }
-            if (Map_ReadB (pa, 1, &buf)) {
+            if ((lp->lnctrl >> LNCTRL_V_MAINT) & LNCTRL_M_MAINT) {
+                /* maintenance modes move one character at a time */
+                if (Map_ReadB (pa, 1, buf)) {
+                    status |= CSR_TX_DMA_ERR;
+                    lp->tbuffct = 0;
+                    break;
+                }
+                if (vh_putc (vh, lp, chan, buf[0]) == SCPE_STALL)
+                    break;
+                ++sent;
+                /* pa = (pa + 1) & PAMASK; */
+                pa = (pa + 1) & ((1 << 22) - 1);
+                lp->tbuffct--;
+                break;
+            }
+            /* normal mode moves as much of the buffer as the line takes */
+            cnt = (lp->tbuffct < TX_DMA_CHUNK) ? lp->tbuffct : TX_DMA_CHUNK;
+            got = cnt - Map_ReadB (pa, cnt, buf);
+            for (i = 0; i < got; i++)
+                buf[i] &= bitmask[(lp->lpr >> LPR_V_CHAR_LGTH) & LPR_M_CHAR_LGTH];
+            tmxr_put_buf_ln (lp->tmln, buf, (size_t)got, &put);
+            sent += (int32)put;
+            pa = (pa + (uint32)put) & ((1 << 22) - 1);
+            lp->tbuffct -= (uint16)put;
+            if ((got < cnt) && ((int32)put == got)) {   /* reached NXM? */
                 status |= CSR_TX_DMA_ERR;
                 lp->tbuffct = 0;
-                break;
             }
-            if (vh_putc (vh, lp, chan, buf) == SCPE_STALL)
-                break;
-            ++sent;
-            /* pa = (pa + 1) & PAMASK; */
-            pa = (pa + 1) & ((1 << 22) - 1);
-            lp->tbuffct--;
             break;
         }
         lp->tbuf1 = pa & 0177777;
@@ -1714,13 +1736,19 @@ static t_stat vh_reset (    DEVICE  *dptr   )
 static t_stat vh_attach (   UNIT    *uptr,
                 CONST char    *cptr   )
 {
-    if (uptr == vh_unit)
-        return tmxr_attach (&vh_desc, uptr, cptr);
-    return SCPE_NOATT;
+    t_stat r;
+
+    if (uptr != vh_unit)
+        return SCPE_NOATT;
+    r = tmxr_attach (&vh_desc, uptr, cptr);
+    if (r == SCPE_OK)
+        sim_poll_group_add (vh_poll_unit, &tmxr_poll_ready);
+    return r;
 }
 
 static t_stat vh_detach (   UNIT    *uptr   )
 {
+    sim_poll_group_remove (vh_poll_unit);
     return (tmxr_detach (&vh_desc, uptr));
 }
 
@@ -68,6 +68,16 @@
  */
 #define VT11_DELAY 1
 
+/*
+ * run up to this many VT11/VS60 cycles per service event; the display
+ * processor state lives in display/vt11.c and is driven from the event
+ * queue, so rather than scheduling one event per display instruction,
+ * each event runs a batch and is rescheduled for the time the batch
+ * represents.  a batch ends early when the display processor stops or
+ * requests an interrupt, so the CPU still sees interrupts promptly.
+ */
+#define VT11_BATCH 16
+
 /*
  * memory cycle time
  */
@@ -120,8 +130,11 @@ DIB vt_dib = { IOBA_AUTO, IOLN_VT11, &vt_rd, &vt_wr,
 UNIT vt_unit = {
     UDATA (&vt_svc, 0, 0),      VT11_DELAY};
 
+static int32 vt_batch = VT11_BATCH;
+
 REG vt_reg[] = {
     { DRDATAD (CYCLE,  vt_unit.wait, 24, "VT11/VS60 cycle"), REG_NZ + PV_LEFT },
+    { DRDATAD (BATCH,  vt_batch, 16, "VT11/VS60 cycles per service event"), REG_NZ + PV_LEFT },
     { GRDATA (DEVADDR, vt_dib.ba, DEV_RDX, 32, 0), REG_HRO },
     { GRDATA (DEVVEC, vt_dib.vec, DEV_RDX, 16, 0), REG_HRO },
     { NULL }  };
@@ -311,15 +324,23 @@ vt_wr(int32 data, int32 PA, int32 access)
 }
 
 /*
- * here to run a display processor cycle, called as a SIMH
+ * here to run a batch of display processor cycles, called as a SIMH
  * "device service routine".
  */
 t_stat
 vt_svc(UNIT *uptr)
 {
+    int32 n;
+
     sim_debug (DEB_TRC, &vt_dev, "vt_svc(wait=%d,DPC=0%o)\n", uptr->wait, vt11_get_dpc());
-    if (vt11_cycle(uptr->wait, 0))
-        sim_activate_after (uptr, uptr->wait);  /* running; reschedule */
+    for (n = 1; vt11_cycle(uptr->wait, 0); n++) {
+        if ((n >= vt_batch) || vt_stop_flag ||  /* batch done, or */
+            INT_IS_SET(VTST) || INT_IS_SET(VTLP) || /* interrupt requested? */
+            INT_IS_SET(VTCH) || INT_IS_SET(VTNM)) {
+            sim_activate_after (uptr, n * uptr->wait); /* running; reschedule */
+            break;
+            }
+        }
     if (vt_stop_flag) {
         vt_stop_flag = FALSE;                   /* reset flag after we notice it */
         return SCPE_STOP;
@@ -89,7 +89,8 @@
   31-Jan-08  MP   Added the ability to Coalesce received packet interrupts.  This
                   is enabled by SET XQ POLL=DELAY=nnn where nnn is a number of 
                   microseconds to delay the triggering of an interrupt when a packet
-                  is received.
+                  is received.  SET XQ POLL=DELAY=nnn;COUNT=n ends the delay as soon
+                  as n packets are waiting.
   29-Jan-08  MP   Added SET XQ POLL=DISABLE (aka SET XQ POLL=0) to operate without 
                   polling for packet read completion.
   29-Jan-08  MP   Changed the sanity and id timer mechanisms to use a separate timer
@@ -282,6 +283,7 @@ t_stat xq_show_poll (FILE* st, UNIT* uptr, int32 val, CONST void* desc);
 t_stat xq_set_poll (UNIT* uptr, int32 val, CONST char* cptr, void* desc);
 t_stat xq_show_leds (FILE* st, UNIT* uptr, int32 val, CONST void* desc);
 t_stat xq_process_xbdl(CTLR* xq);
+int32 xq_gather_xbdl(CTLR* xq);
 t_stat xq_dispatch_xbdl(CTLR* xq);
 t_stat xq_process_turbo_rbdl(CTLR* xq);
 t_stat xq_process_turbo_xbdl(CTLR* xq);
@@ -313,7 +315,7 @@ struct xq_device    xqa = {
   XQ_T_DELQA_PLUS,                          /* type */
   XQ_T_DELQA,                               /* mode */
   XQ_SERVICE_INTERVAL,                      /* poll */
-  0, 0,                                     /* coalesce */
+  0, 0, 0,                                  /* coalesce */
   {0},                                      /* sanity */
   0,                                        /* DEQNA-Lock mode */
   ETH_THROT_DEFAULT_TIME,                   /* ms throttle window */
@@ -329,7 +331,7 @@ struct xq_device    xqb = {
   XQ_T_DELQA_PLUS,                          /* type */
   XQ_T_DELQA,                               /* mode */
   XQ_SERVICE_INTERVAL,                      /* poll */
-  0, 0,                                     /* coalesce */
+  0, 0, 0,                                  /* coalesce */
   {0},                                      /* sanity */
   0,                                        /* DEQNA-Lock mode */
   ETH_THROT_DEFAULT_TIME,                   /* ms throttle window */
@@ -392,6 +394,7 @@ REG xqa_reg[] = {
   { GRDATA ( POLL, xqa.poll, XQ_RDX, 16, 0), REG_HRO},
   { GRDATA ( CLAT, xqa.coalesce_latency, XQ_RDX, 16, 0), REG_HRO},
   { GRDATA ( CLATT, xqa.coalesce_latency_ticks, XQ_RDX, 16, 0), REG_HRO},
+  { GRDATA ( CCNT, xqa.coalesce_count, XQ_RDX, 16, 0), REG_HRO},
   { GRDATA ( RBDL_BA, xqa.rbdl_ba, XQ_RDX, 32, 0), REG_HRO},
   { GRDATA ( XBDL_BA, xqa.xbdl_ba, XQ_RDX, 32, 0), REG_HRO},
   { GRDATA ( SETUP_PRM, xqa.setup.promiscuous, XQ_RDX, 32, 0), REG_HRO},
@@ -456,6 +459,7 @@ REG xqb_reg[] = {
   { GRDATA ( POLL, xqb.poll, XQ_RDX, 16, 0), REG_HRO},
   { GRDATA ( CLAT, xqb.coalesce_latency, XQ_RDX, 16, 0), REG_HRO},
   { GRDATA ( CLATT, xqb.coalesce_latency_ticks, XQ_RDX, 16, 0), REG_HRO},
+  { GRDATA ( CCNT, xqb.coalesce_count, XQ_RDX, 16, 0), REG_HRO},
   { GRDATA ( RBDL_BA, xqb.rbdl_ba, XQ_RDX, 32, 0), REG_HRO},
   { GRDATA ( XBDL_BA, xqb.xbdl_ba, XQ_RDX, 32, 0), REG_HRO},
   { GRDATA ( SETUP_PRM, xqb.setup.promiscuous, XQ_RDX, 32, 0), REG_HRO},
@@ -504,7 +508,7 @@ MTAB xq_mod[] = {
   { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "TYPE", "TYPE={DEQNA|DELQA|DELQA-T}",
     &xq_set_type, &xq_show_type, NULL, "Display current device type being simulated" },
 #ifdef USE_READER_THREAD
-  { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "POLL", "POLL={DEFAULT|DISABLED|4..2500|DELAY=nnn}",
+  { MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "POLL", "POLL={DEFAULT|DISABLED|4..2500|DELAY=nnn{;COUNT=n}}",
     &xq_set_poll, &xq_show_poll, NULL, "Display the current polling mode" },
 #else
   { MTAB_XTD|MTAB_VDV, 0, "POLL", "POLL={DEFAULT|DISABLED|4..2500}",
@@ -820,6 +824,8 @@ t_stat xq_show_poll (FILE* st, UNIT* uptr, int32 val, CONST void* desc)
     fprintf(st, "polling=disabled");
     if (xq->var->coalesce_latency)
       fprintf(st, ",latency=%d", xq->var->coalesce_latency);
+    if (xq->var->coalesce_latency && xq->var->coalesce_count)
+      fprintf(st, ",count=%d", xq->var->coalesce_count);
   }
   return SCPE_OK;
 }
@@ -835,10 +841,16 @@ t_stat xq_set_poll (UNIT* uptr, int32 val, CONST char* cptr, void* desc)
     xq->var->poll = XQ_SERVICE_INTERVAL;
   else if ((!strcmp(cptr, "DISABLED")) || (!strncmp(cptr, "DELAY=", 6))) {
     xq->var->poll = 0;
+    xq->var->coalesce_count = 0;
     if (!strncmp(cptr, "DELAY=", 6)) {
       int delay = 0;
+      int count = 0;
+      const char *cnt = strchr(cptr, ';');
       if (1 != sscanf(cptr+6, "%d", &delay))
         return SCPE_ARG;
+      if (cnt && (strncmp(cnt, ";COUNT=", 7) || (1 != sscanf(cnt+7, "%d", &count)) || (count < 0)))
+        return SCPE_ARG;
+      xq->var->coalesce_count = count;
       xq->var->coalesce_latency = delay;
       xq->var->coalesce_latency_ticks = (tmr_poll * clk_tps * xq->var->coalesce_latency) / 1000000;
       }
@@ -1501,6 +1513,7 @@ t_stat xq_process_xbdl(CTLR* xq)
   xq->var->write_buffer.len = 0;
   free (xq->var->write_buffer.oversize);
   xq->var->write_buffer.oversize = NULL;
+  xq->var->xmt_iovcnt = 0;
 
   /* process buffer descriptors until not valid */
   while (1) {
@@ -1537,18 +1550,24 @@ t_stat xq_process_xbdl(CTLR* xq)
     }
     if (xq->var->xbdl_buf[1] & XQ_DSC_L) b_length -= 1;
 
-    /* add to transmit buffer, making sure it's not too big */
-    if ((xq->var->write_buffer.len + b_length) > sizeof(xq->var->write_buffer.msg)) {
-      xq->var->write_buffer.oversize = (uint8*)realloc (xq->var->write_buffer.oversize, xq->var->write_buffer.len + b_length);
-      if (xq->var->write_buffer.len <= sizeof(xq->var->write_buffer.msg))
-        memcpy (xq->var->write_buffer.oversize, xq->var->write_buffer.msg, xq->var->write_buffer.len);
-      }
-    rstatus = Map_ReadB(address, b_length, xq->var->write_buffer.oversize ? &xq->var->write_buffer.oversize[xq->var->write_buffer.len] : &xq->var->write_buffer.msg[xq->var->write_buffer.len]);
-    if (rstatus) return xq_nxm_error(xq);
-    xq->var->write_buffer.len += b_length;
+    /* add to transmit segments, reading the ones held so far if full */
+    if (xq->var->xmt_iovcnt == XQ_XMT_IOV) {
+      rstatus = xq_gather_xbdl(xq);
+      if (rstatus) return xq_nxm_error(xq);
+    }
+    xq->var->xmt_iov[xq->var->xmt_iovcnt].ba = address;
+    xq->var->xmt_iov[xq->var->xmt_iovcnt].len = b_length;
+    xq->var->xmt_iovcnt++;
 
     /* end of message? */
     if (xq->var->xbdl_buf[1] & XQ_DSC_E) {
+      if (((~xq->var->csr & XQ_CSR_IL) || (xq->var->csr & XQ_CSR_EL)) ||  /* loopback */
+           (xq->var->xbdl_buf[1] & XQ_DSC_S) || /* or setup packet (forces loopback regardless of state) */
+           (xq->var->write_buffer.len != 0) ||  /* or segments already read */
+           (DBG_PCK & xq->dev->dctrl)) {        /* or packet tracing */
+        rstatus = xq_gather_xbdl(xq);
+        if (rstatus) return xq_nxm_error(xq);
+      }
       if (((~xq->var->csr & XQ_CSR_IL) || (xq->var->csr & XQ_CSR_EL)) ||  /* loopback */
            (xq->var->xbdl_buf[1] & XQ_DSC_S)) { /* or setup packet (forces loopback regardless of state) */
         if (xq->var->xbdl_buf[1] & XQ_DSC_S) { /* setup packet */
@@ -1591,7 +1610,17 @@ t_stat xq_process_xbdl(CTLR* xq)
 
       } else { /* not loopback */
 
-        status = eth_write(xq->var->etherface, &xq->var->write_buffer, xq->var->wcallback);
+        if (xq->var->xmt_iovcnt) {     /* segments still in memory? */
+          int i;
+
+          for (i = 0; i < xq->var->xmt_iovcnt; i++)
+            xq->var->write_buffer.len += xq->var->xmt_iov[i].len;
+          status = eth_writev(xq->var->etherface, xq->var->xmt_iov, xq->var->xmt_iovcnt, &Map_ReadB, xq->var->wcallback);
+          xq->var->xmt_iovcnt = 0;
+          if (status == SCPE_NXM)
+            return xq_nxm_error(xq);
+        } else
+          status = eth_write(xq->var->etherface, &xq->var->write_buffer, xq->var->wcallback);
         if (status != SCPE_OK)           /* not implemented or unattached */
           xq_write_callback(xq, 1);      /* fake failure */
         else {
@@ -1616,6 +1645,38 @@ t_stat xq_process_xbdl(CTLR* xq)
   } /* while */
 }
 
+/*
+  Read the transmit segments held so far into the write buffer.
+
+  Ordinary frames are not read until their end of message descriptor is
+  seen, and are then handed to eth_writev, which reads them straight into
+  the packet that goes to the wire.  Setup and loopback frames, frames
+  being traced and frames with more segments than can be held are read
+  here instead, since they are needed in the write buffer.
+*/
+int32 xq_gather_xbdl(CTLR* xq)
+{
+  int i;
+  int32 rstatus;
+
+  for (i = 0; i < xq->var->xmt_iovcnt; i++) {
+    uint32 address = xq->var->xmt_iov[i].ba;
+    uint32 b_length = xq->var->xmt_iov[i].len;
+
+    /* add to transmit buffer, making sure it's not too big */
+    if ((xq->var->write_buffer.len + b_length) > sizeof(xq->var->write_buffer.msg)) {
+      xq->var->write_buffer.oversize = (uint8*)realloc (xq->var->write_buffer.oversize, xq->var->write_buffer.len + b_length);
+      if (xq->var->write_buffer.len <= sizeof(xq->var->write_buffer.msg))
+        memcpy (xq->var->write_buffer.oversize, xq->var->write_buffer.msg, xq->var->write_buffer.len);
+      }
+    rstatus = Map_ReadB(address, b_length, xq->var->write_buffer.oversize ? &xq->var->write_buffer.oversize[xq->var->write_buffer.len] : &xq->var->write_buffer.msg[xq->var->write_buffer.len]);
+    if (rstatus) return rstatus;
+    xq->var->write_buffer.len += b_length;
+  }
+  xq->var->xmt_iovcnt = 0;
+  return 0;
+}
+
 void xq_show_debug_bdl(CTLR* xq, uint32 bdl_ba)
 {
   uint16 bdl_buf[6];
@@ -1714,6 +1775,7 @@ t_stat xq_dispatch_xbdl(CTLR* xq)
   xq->var->write_buffer.len = 0;
   free (xq->var->write_buffer.oversize);
   xq->var->write_buffer.oversize = NULL;
+  xq->var->xmt_iovcnt = 0;
 
   /* get base address of first transmit descriptor */
   xq->var->xbdl_ba = ((xq->var->xbdl[1] & 0x3F) << 16) | (xq->var->xbdl[0] & ~01);
@@ -2348,8 +2410,10 @@ void xq_start_receiver(CTLR* xq)
       sim_activate(xq->unit, (tmr_poll*clk_tps)/xq->var->poll);
     }
   else
-    if ((xq->var->poll == 0) || (xq->var->mode == XQ_T_DELQA_PLUS))
+    if ((xq->var->poll == 0) || (xq->var->mode == XQ_T_DELQA_PLUS)) {
       eth_set_async(xq->var->etherface, xq->var->coalesce_latency_ticks);
+      eth_set_async_burst(xq->var->etherface, xq->var->coalesce_count);
+      }
     else
       if (sim_idle_enab)
         sim_clock_coschedule(xq->unit, tmxr_poll);
@@ -2896,6 +2960,7 @@ t_stat xq_attach(UNIT* uptr, CONST char* cptr)
   eth_set_throttle (xq->var->etherface, xq->var->throttle_time, xq->var->throttle_burst, xq->var->throttle_delay);
   if (xq->var->poll == 0) {
     status = eth_set_async(xq->var->etherface, xq->var->coalesce_latency_ticks);
+    eth_set_async_burst(xq->var->etherface, xq->var->coalesce_count);
     if (status != SCPE_OK) {
       eth_close(xq->var->etherface);
       free(tptr);
@@ -84,6 +84,7 @@
 
 #define XQ_QUE_MAX           500                        /* read queue size in packets */
 #define XQ_FILTER_MAX         14                        /* number of filters allowed */
+#define XQ_XMT_IOV            16                        /* transmit segments held before reading */
 #if defined(SIM_ASYNCH_IO) && defined(USE_READER_THREAD)
 #define XQ_SERVICE_INTERVAL  0                          /* polling interval - No Polling with Asynch I/O */
 #else
@@ -263,6 +264,7 @@ struct xq_device {
   uint32            poll;                               /* configured poll ethernet times/sec for receive */
   uint32            coalesce_latency;                   /* microseconds to hold-off interrupts when not polling */
   uint32            coalesce_latency_ticks;             /* instructions in coalesce_latency microseconds */
+  uint32            coalesce_count;                     /* received packets which end the hold-off early */
   struct xq_sanity  sanity;                             /* sanity timer information */
   t_bool            lockmode;                           /* DEQNA-Lock mode */
   uint32            throttle_time;                      /* ms burst time window */
@@ -305,6 +307,8 @@ struct xq_device {
   ETH_DEV*          etherface;
   ETH_PACK          read_buffer;
   ETH_PACK          write_buffer;
+  ETH_IOVEC         xmt_iov[XQ_XMT_IOV];                /* transmit segments not yet read */
+  int               xmt_iovcnt;
   ETH_QUE           ReadQ;
   int32             idtmr;                              /* countdown for ID Timer */
   uint32            must_poll;                          /* receiver must poll instead of counting on asynch polls */
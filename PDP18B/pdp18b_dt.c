@@ -1461,6 +1461,7 @@ else if (uptr->flags & UNIT_11FMT)
 else sim_printf ("18b/36b format");
 sim_printf (", buffering file in memory\n");
 uptr->io_flush = dt_flush;
+uptr->dynflags |= UNIT_SYNC_FLUSH;                      /* checkpoint while running */
 if (uptr->flags & UNIT_8FMT) {                          /* 12b? */
     for (ba = 0; ba < uptr->capac; ) {                  /* loop thru file */
         k = fxread (pdp8b, sizeof (uint16), D8_NBSIZE, uptr->fileref);
@@ -1515,7 +1516,8 @@ int32 k;
 uint32 ba, *fbuf;
 
 if (uptr->WRITTEN && uptr->hwmark && ((uptr->flags & UNIT_RO)== 0)) {    /* any data? */
-    sim_printf ("%s: writing buffer to file: %s\n", sim_uname (uptr), uptr->filename);
+    if (!sim_is_running)                                /* quiet checkpoint */
+        sim_printf ("%s: writing buffer to file: %s\n", sim_uname (uptr), uptr->filename);
     rewind (uptr->fileref);                             /* start of file */
     fbuf = (uint32 *) uptr->filebuf;                    /* file buffer */
     if (uptr->flags & UNIT_8FMT) {                      /* 12b? */
@@ -1545,6 +1547,7 @@ if (uptr->WRITTEN && uptr->hwmark && ((uptr->flags & UNIT_RO)== 0)) {    /* any
         else 
             fxwrite (uptr->filebuf, sizeof (uint32),       /* write file */
                      uptr->hwmark, uptr->fileref);
+    fflush (uptr->fileref);
     if (ferror (uptr->fileref))
         sim_perror ("I/O error");
     }
@@ -1568,6 +1571,7 @@ if (sim_is_active (uptr)) {
 if (uptr->hwmark && ((uptr->flags & UNIT_RO) == 0))     /* any data? */
     dt_flush (uptr);                                    /* end if hwmark */
 free (uptr->filebuf);                                   /* release buf */
+uptr->dynflags &= ~UNIT_SYNC_FLUSH;
 uptr->flags = uptr->flags & ~UNIT_BUF;                  /* clear buf flag */
 uptr->filebuf = NULL;                                   /* clear buf ptr */
 uptr->flags = uptr->flags & ~(UNIT_8FMT | UNIT_11FMT);  /* default fmt */
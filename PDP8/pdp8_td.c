@@ -808,6 +808,7 @@ else if (uptr->flags & UNIT_11FMT)
 else sim_printf ("18b/36b format");
 sim_printf (", buffering file in memory\n");
 uptr->io_flush = td_flush;
+uptr->dynflags |= UNIT_SYNC_FLUSH;                      /* checkpoint while running */
 if (uptr->flags & UNIT_8FMT)                            /* 12b? */
     uptr->hwmark = fxread (uptr->filebuf, sizeof (uint16),
             uptr->capac, uptr->fileref);
@@ -869,7 +870,8 @@ int32 i, k;
 uint32 ba;
 
 if (uptr->WRITTEN && uptr->hwmark && ((uptr->flags & UNIT_RO)== 0)) {    /* any data? */
-    sim_printf ("%s: writing buffer to file: %s\n", sim_uname (uptr), uptr->filename);
+    if (!sim_is_running)                                /* quiet checkpoint */
+        sim_printf ("%s: writing buffer to file: %s\n", sim_uname (uptr), uptr->filename);
     rewind (uptr->fileref);                             /* start of file */
     fbuf = (uint16 *) uptr->filebuf;                    /* file buffer */
     if (uptr->flags & UNIT_8FMT)                        /* PDP8? */
@@ -894,6 +896,7 @@ if (uptr->WRITTEN && uptr->hwmark && ((uptr->flags & UNIT_RO)== 0)) {    /* any
                 D18_NBSIZE, uptr->fileref);
             }                                           /* end loop buf */
         }                                               /* end else */
+    fflush (uptr->fileref);
     if (ferror (uptr->fileref))
         sim_perror ("I/O error");
     }
@@ -909,6 +912,7 @@ if (!(uptr->flags & UNIT_ATT))
 if (uptr->hwmark && ((uptr->flags & UNIT_RO)== 0))      /* any data? */
     td_flush (uptr);
 free (uptr->filebuf);                                   /* release buf */
+uptr->dynflags &= ~UNIT_SYNC_FLUSH;
 uptr->flags = uptr->flags & ~UNIT_BUF;                  /* clear buf flag */
 uptr->filebuf = NULL;                                   /* clear buf ptr */
 uptr->flags = (uptr->flags | UNIT_8FMT) & ~UNIT_11FMT;  /* default fmt */
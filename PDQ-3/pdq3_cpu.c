@@ -197,6 +197,77 @@ DEVICE cpu_dev = {
   NULL         /*lname*/
 };
 
+/* Call cache
+ * A call resolves segno -> SIB -> segment base through the segment dictionary,
+ * and procno -> entry point -> data size through the procedure dictionary
+ * at the end of the code segment. Both are cached here. Every word an entry
+ * was read from is marked in M_watch, and Write() flushes the cache when one
+ * of them changes, i.e. when the OS swaps in, moves or releases a segment.
+ * Words in the ROM/IO area are never cached.
+ */
+#define SEGCACHE_SIZE 256
+#define PROCCACHE_SIZE 1024
+typedef struct _segcache {
+  t_bool valid;
+  uint16 dict;      /* address of segment dictionary entry */
+  uint16 sib;
+  uint16 segbase;
+} SEGCACHE;
+typedef struct _proccache {
+  t_bool valid;
+  uint16 segb;
+  uint16 ptbl;
+  uint8 procno;
+  uint16 procstart; /* word index into segment */
+  uint16 datasz;
+} PROCCACHE;
+static SEGCACHE segcache[SEGCACHE_SIZE];
+static PROCCACHE proccache[PROCCACHE_SIZE];
+static t_bool callcache_empty = TRUE;
+
+void cpu_flushCallCache() {
+  if (callcache_empty) return;
+  memset(segcache, 0, sizeof(segcache));
+  memset(proccache, 0, sizeof(proccache));
+  memset(M_watch, 0, 65536/8);
+  callcache_empty = TRUE;
+}
+
+static t_bool Watch(uint16 ea) {
+  if (ea >= 0xf000) return FALSE;
+  M_watch[ea >> 3] |= (1 << (ea & 7));
+  callcache_empty = FALSE;
+  return TRUE;
+}
+
+static SEGCACHE* LookupSeg(uint8 segno) {
+  SEGCACHE* sc;
+  uint16 dict = segno < 128 ?
+    reg_ssv + segno :
+    Get(reg_ctp + OFF_SIBS) + segno - 128;
+  sc = &segcache[dict & (SEGCACHE_SIZE-1)];
+  if (!sc->valid || sc->dict != dict) {
+    sc->dict = dict;
+    Read(dict, 0, &sc->sib, DBG_NONE);
+    Read(sc->sib, OFF_SEGBASE, &sc->segbase, DBG_NONE);
+    sc->valid = Watch(dict) && Watch(sc->sib + OFF_SEGBASE);
+  }
+  return sc;
+}
+
+static PROCCACHE* LookupProc(uint16 ptbl, uint8 procno) {
+  PROCCACHE* pc = &proccache[((reg_segb >> 2) ^ (procno << 3)) & (PROCCACHE_SIZE-1)];
+  if (!pc->valid || pc->segb != reg_segb || pc->ptbl != ptbl || pc->procno != procno) {
+    pc->segb = reg_segb;
+    pc->ptbl = ptbl;
+    pc->procno = procno;
+    pc->procstart = Get(ptbl - procno);
+    pc->datasz = Get(reg_segb + pc->procstart);
+    pc->valid = Watch(ptbl - procno) && Watch(reg_segb + pc->procstart);
+  }
+  return pc;
+}
+
 /* return start address of proctbl of current code segment */
 static uint16 GetPtbl() {
   uint16 ptbl;
@@ -206,10 +277,7 @@ static uint16 GetPtbl() {
 
 /* return segment base of segment */
 static uint16 GetSegbase(uint8 segno) {
-  uint16 data, sib;
-  sib = GetSIB(segno);
-  Read(sib,OFF_SEGBASE, &data, DBG_NONE);
-  return data;
+  return LookupSeg(segno)->segbase;
 }
 
 /* get segment# from code segment:
@@ -224,11 +292,8 @@ static uint8 GetSegno() {
 
 /* set SEGB and return address of proc tbl (optimization for segb + segb[0] ) */
 static uint16 SetSEGB(uint8 segno) {
-  /* obtain pointer to SIB for segno */
-  uint16 sib = GetSIB(segno); 
-
-  /* set SEGB and get pointer to proc tbl */
-  Read(sib, OFF_SEGBASE, &reg_segb, DBG_NONE);
+  /* set SEGB from SIB for segno and get pointer to proc tbl */
+  reg_segb = LookupSeg(segno)->segbase;
   return GetPtbl();
 }
 
@@ -694,9 +759,7 @@ static uint16 GetMask(int lowbit,int nbits) {
 
 /* get address of SIB entry of segment */
 static uint16 GetSIB(uint8 segno) {
-  return segno < 128 ?
-    Get(reg_ssv + segno) :
-    Get(Get(reg_ctp + OFF_SIBS) + segno - 128);
+  return LookupSeg(segno)->sib;
 }
 
 /* do a CXG instruction into segment SEGNO to procedure procno */
@@ -743,8 +806,9 @@ static int GetBit(t_addr base, int bitno)
 }
 
 static uint16 createMSCW(uint16 ptbl, uint8 procno, uint16 stat, uint8 segno, uint16 osegb) {
-  uint16 procstart = Get(ptbl - procno); /* word index into segment */
-  uint16 datasz = Get(reg_segb + procstart); /* word index */
+  PROCCACHE* pc = LookupProc(ptbl, procno);
+  uint16 procstart = pc->procstart; /* word index into segment */
+  uint16 datasz = pc->datasz; /* word index */
   dbg_segtrack(reg_segb);
 //  sim_printf("createMSCW: ptbl=%x procno=%d stat=%x segno=%x\n",ptbl,procno,stat,segno);
   
@@ -1554,6 +1618,9 @@ t_stat sim_instr(void)
 {
   t_stat rc = SCPE_OK;
   
+  /* memory may have been changed by LOAD or DEPOSIT */
+  cpu_flushCallCache();
+
   /* mandatory idling */
   sim_rtcn_init(TMR_IDLECNT, TMR_IDLE);
   sim_set_idle(&cpu_unit, 10, NULL, NULL);
@@ -361,12 +361,17 @@ const char* find_procname(PROCINFO* p) {
 }
 
 static PROCINFO* procroot = NULL;
+static PROCINFO* procfree = NULL; /* recycled entries, saves a malloc per call */
 
 static PROCINFO* new_procinfo(uint16 segbase, uint16 procno, uint16 mscw, uint16 osegb) {
   int dummy;
   uint16 procbase, procaddr;
   uint16 exitic, sz1, sz2;
-  PROCINFO* p = (PROCINFO*)malloc(sizeof(PROCINFO));
+  PROCINFO* p = procfree;
+  if (p)
+    procfree = p->next;
+  else
+    p = (PROCINFO*)malloc(sizeof(PROCINFO));
   p->procno = procno;
   p->mscw = mscw;
   p->seg = find_seginfo(segbase, &dummy);
@@ -404,7 +409,8 @@ t_stat dbg_procleave() {
     pipc = p->ipc;
     if ((rc=ReadEx(p->mscw,OFF_MSIPC, &ipc)) != SCPE_OK) return rc;
     procroot = p->next;
-    free(p);
+    p->next = procfree;
+    procfree = p;
     if (pipc == ipc) break;
     p = procroot;
   }
@@ -378,6 +378,10 @@ extern t_stat cpu_setIntVec(uint16 vector,int level);
 extern void   cpu_setRegs(uint16 ctp, uint16 ssv, uint16 rq);
 extern void   cpu_finishAutoload();
 extern t_stat cpu_buserror();
+extern void   cpu_flushCallCache();
+
+extern uint8 M_watch[];
+#define WATCHED(ea) (M_watch[(ea) >> 3] & (1 << ((ea) & 7)))
 
 typedef t_stat (*IOREAD)(t_addr ioaddr, uint16 *data);
 typedef t_stat (*IOWRITE)(t_addr ioaddr, uint16 data);
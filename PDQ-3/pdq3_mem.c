@@ -30,6 +30,9 @@
 /* the memory */
 uint16 M[MAXMEMSIZE];
 
+/* words the CPU call cache was resolved from, one bit per word */
+uint8 M_watch[65536/8];
+
 /******************************************************************************
  * IO dispatcher
  *****************************************************************************/
@@ -249,6 +252,7 @@ t_stat Write(t_addr base, t_addr woffset, uint16 data, uint32 dctrl) {
   uint16 ea = base + woffset;
   if (ea < 0xf000) {
     M[ea] = data;
+    if (WATCHED(ea)) cpu_flushCallCache(); /* segment swapped or moved */
     rc = SCPE_OK;
   } else {
     IOWRITE write = iowriters[ea & IOPAGEMASK];
@@ -98,6 +98,8 @@ CHANP   *find_chanp_ptr(uint16 chsa);           /* find chanp pointer */
 UNIT    *find_unit_ptr(uint16 chsa);            /* find unit pointer */
 int     chan_read_byte(uint16 chsa, uint8 *data);
 int     chan_write_byte(uint16 chsa, uint8 *data);
+int     chan_read_buf(uint16 chsa, uint8 *buf, uint32 len, uint32 *cnt);
+int     chan_write_buf(uint16 chsa, uint8 *buf, uint32 len, uint32 *cnt);
 void    set_devattn(uint16 chsa, uint16 flags);
 void    set_devwake(uint16 chsa, uint16 flags); /* wakeup O/S for async line */
 void    chan_end(uint16 chsa, uint16 flags);
@@ -927,6 +929,86 @@ int chan_write_byte(uint16 chsa, uint8 *data)
     return 0;
 }
 
+/* read a buffer of bytes from memory */
+/* write to device */
+/* moves whole runs of the current IOCD at once, otherwise */
+/* falls back to chan_read_byte for chaining and errors */
+/* *cnt is set to the number of bytes transferred */
+int chan_read_buf(uint16 chsa, uint8 *buf, uint32 len, uint32 *cnt)
+{
+    CHANP   *chp = find_chanp_ptr(chsa);        /* get channel prog pointer */
+    uint32  done = 0;                           /* bytes transferred */
+    uint32  addr, n, i;
+
+    while (done < len) {
+        n = len - done;                         /* bytes still wanted */
+        if (n > chp->ccw_count)
+            n = chp->ccw_count;                 /* limit to this IOCD */
+        addr = chp->ccw_addr & MASK24;          /* channel buffer address */
+        if ((n == 0) || (chp->chan_status & STATUS_ERROR) ||
+            (chp->chan_byte == BUFF_CHNEND) ||
+            ((addr + n) > MEMSIZE) ||           /* run must be in memory */
+            (cpu_dev.dctrl & DEBUG_DATA)) {     /* keep byte tracing */
+            if (chan_read_byte(chsa, &buf[done])) {
+                *cnt = done;                    /* bytes moved before error */
+                return 1;                       /* return error */
+            }
+            done++;
+            continue;
+        }
+        for (i = 0; i < n; i++, addr++)
+            buf[done + i] = RMB(addr);          /* get the run of bytes */
+        chp->chan_buf = buf[done + n - 1];      /* last byte read */
+        chp->ccw_addr += n;                     /* next byte address */
+        chp->ccw_count -= n;                    /* chars less to process */
+        done += n;
+    }
+    *cnt = done;                                /* all bytes transferred */
+    return 0;                                   /* good return */
+}
+
+/* write a buffer of bytes to memory */
+/* read from device */
+/* moves whole runs of the current IOCD at once, otherwise */
+/* falls back to chan_write_byte for chaining, skip, backward */
+/* reads and errors */
+/* *cnt is set to the number of bytes transferred */
+int chan_write_buf(uint16 chsa, uint8 *buf, uint32 len, uint32 *cnt)
+{
+    CHANP   *chp = find_chanp_ptr(chsa);        /* get channel prog pointer */
+    uint32  done = 0;                           /* bytes transferred */
+    uint32  addr, n, i;
+
+    while (done < len) {
+        n = len - done;                         /* bytes still wanted */
+        if (n > chp->ccw_count)
+            n = chp->ccw_count;                 /* limit to this IOCD */
+        addr = chp->ccw_addr & MASK24;          /* channel buffer address */
+        if ((n == 0) || (chp->chan_status & STATUS_ERROR) ||
+            (chp->chan_byte == BUFF_CHNEND) ||
+            (chp->ccw_flags & FLAG_SKIP) ||
+            ((chp->ccw_cmd & 0xff) == CMD_RDBWD) ||
+            ((addr + n) > MEMSIZE) ||           /* run must be in memory */
+            (cpu_dev.dctrl & DEBUG_DATA)) {     /* keep byte tracing */
+            if (chan_write_byte(chsa, &buf[done])) {
+                *cnt = done;                    /* bytes moved before error */
+                return 1;                       /* return error */
+            }
+            done++;
+            continue;
+        }
+        for (i = 0; i < n; i++, addr++)
+            WMB(addr, buf[done + i]);           /* write the run of bytes */
+        chp->chan_buf = buf[done + n - 1];      /* last byte written */
+        chp->ccw_addr += n;                     /* next byte address */
+        chp->ccw_count -= n;                    /* reduce count */
+        chp->chan_byte = BUFF_BUSY;             /* busy, but no data */
+        done += n;
+    }
+    *cnt = done;                                /* all bytes transferred */
+    return 0;                                   /* good return */
+}
+
 /* post wakeup interrupt for specified async line */
 void set_devwake(uint16 chsa, uint16 flags)
 {
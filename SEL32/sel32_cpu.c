@@ -146,6 +146,15 @@ uint32          TLB[2048];                  /* Translated addresses for each map
 /* bits 8-18 has map reg contents for this page (Map << 13) */
 /* bit 19-31 is zero for page offset of zero */
 
+uint32          RTLB[2048];                 /* Resolved translation for each map entry */
+/* flat logical page to real page table, filled by RealAddr on first use */
+/* and flushed by load_maps, so a mapped access is a lookup and a bit test */
+/* bits 0-4 are TLB bits 0-4, quarter page write protect for 27-97 */
+/* bits 8-18 has real page address */
+/* bits 29-30 are V6 & V9 p1 & p2 access bits from the map */
+/* bit 31 is set when the entry is valid */
+#define RTLB_OK     0x1                     /* resolved translation is valid */
+
 uint32          dummy2=0;
 uint8           wait4int = 0;               /* waiting for interrupt if set */
 int32           irq_auto = 0;               /* auto reset interrupt processing flag */
@@ -182,6 +191,7 @@ t_stat cpu_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cpt
 const char *cpu_description (DEVICE *dptr);
 t_stat RealAddr(uint32 addr, uint32 *realaddr, uint32 *prot, uint32 access);
 t_stat load_maps(uint32 thepsd[2], uint32 lmap);
+void flush_rtlb(void);
 t_stat read_instruction(uint32 thepsd[2], uint32 *instr);
 t_stat Mem_read(uint32 addr, uint32 *data);
 t_stat Mem_write(uint32 addr, uint32 *data);
@@ -629,6 +639,15 @@ int base_mode[] = {
 /* The RMR and WMR macros are used to read/write the MAPC cache registers */
 /* RMR(addr) or WMR(addr, data) where addr is a half word alligned address */
 /* We will only get here if the retain maps bit is not set in PSD word 2 */
+/* invalidate all resolved translations */
+void flush_rtlb(void)
+{
+    uint32 i;
+
+    for (i=0; i<2048; i++)
+        RTLB[i] = 0;                                /* clear resolved translation */
+}
+
 t_stat load_maps(uint32 thepsd[2], uint32 lmap)
 {
     uint32 num, sdc, spc, onlyos=0;
@@ -640,6 +659,8 @@ t_stat load_maps(uint32 thepsd[2], uint32 lmap)
         "Load Maps Entry PSD %08x %08x STATUS %08x lmap %1x CPU Mode %2x\n",
         thepsd[0], thepsd[1], CPUSTATUS, lmap, CPU_MODEL);
 
+    flush_rtlb();                                   /* maps are changing */
+
     /* process 32/7X computers */
     if (CPU_MODEL < MODEL_27) {
         MAXMAP = MAX32;                             /* 32 maps for 32/77 */
@@ -1266,6 +1287,25 @@ t_stat RealAddr(uint32 addr, uint32 *realaddr, uint32 *prot, uint32 access)
     index = (word >> 13) & 0x7ff;                   /* get 11 bit page value */
     offset = word & 0x1fff;                         /* get 13 bit page offset */
 
+    /* use the resolved translation if we have one for this page */
+    /* 32/27 & 32/87 still want the user midl checked on each access */
+    raddr = RTLB[index];                            /* get resolved base & bits */
+    if ((raddr & RTLB_OK) && (((CPU_MODEL != MODEL_27) && (CPU_MODEL != MODEL_87)) ||
+        MEM_ADDR_OK(RMW(mpl+CPIX+4) & MASK24))) {
+        word = (raddr & 0xffe000) | offset;         /* combine real addr and offset */
+        *realaddr = word;                           /* return the real address */
+        if (CPU_MODEL >= MODEL_V6) {
+            *prot = raddr & 0x6;                    /* p1 & p2 access bits */
+            if (MODES & PRIVBIT)                    /* all access if privledged */
+                *prot |= 0x8;                       /* set priv bit */
+        } else
+        if ((MODES & PRIVBIT) == 0) {               /* OK if privledged */
+            if ((BIT1 >> ((word >> 11) & 0x3)) & raddr) /* is 1/4 page write protected */
+                *prot = 1;                          /* return memory write protection status */
+        }
+        return ALLOK;                               /* all OK, return instruction */
+    }
+
     /* make sure map index is valid */
       if (index >= (BPIX + CPIXPL)) {
             sim_debug(DEBUG_TRAP, &cpu_dev,
@@ -1313,6 +1353,7 @@ t_stat RealAddr(uint32 addr, uint32 *realaddr, uint32 *prot, uint32 access)
         }
         word = (raddr & 0xffe000) | offset;         /* combine real addr and offset */
         *realaddr = word;                           /* return the real address */
+        RTLB[index] = (raddr & 0xf8ffe000) | RTLB_OK;   /* save resolved translation */
         if (MODES & PRIVBIT)                        /* all OK if privledged */
             return ALLOK;                           /* all OK, return instruction */
 
@@ -1354,6 +1395,8 @@ t_stat RealAddr(uint32 addr, uint32 *realaddr, uint32 *prot, uint32 access)
         map = RMR((index<<1));                      /* read the map reg contents */
         word = (raddr & 0xffe000) | offset;         /* combine map and offset */
         *realaddr = word;                           /* return the real address */
+        /* save resolved translation with the V6 & V9 access bits */
+        RTLB[index] = (raddr & 0xf8ffe000) | ((map >> 12) & 0x6) | RTLB_OK;
 
         /* handle 32/67 & 32/97 protection here */
         if (CPU_MODEL < MODEL_V6) {
@@ -1648,6 +1691,7 @@ t_stat Mem_read(uint32 addr, uint32 *data)
                     map |= 0x800;                   /* set the accessed bit in the map cache entry */
                     WMR((page<<1), map);            /* store the map reg contents into cache */
                     TLB[page] |= 0x0c000000;        /* set the accessed bit in TLB too */
+                    RTLB[page] = 0;                 /* resolve it again */
                     WMH(msdl+(mix<<1), map);        /* save modified map with access bit set */
                     sim_debug(DEBUG_DETAIL, &cpu_dev,
                         "Mem_read Yaddr %06x page %04x set access bit TLB %08x map %04x nmap %04x\n",
@@ -1737,6 +1781,7 @@ t_stat Mem_write(uint32 addr, uint32 *data)
                     nmap |= 0x1800;                 /* set the modify/accessed bit in the map cache entry */
                     WMR((page<<1), nmap);           /* store the map reg contents into cache */
                     TLB[page] |= 0x18000000;        /* set the modify/accessed bits in TLB too */
+                    RTLB[page] = 0;                 /* resolve it again */
                     WMH((msdl+(mix << 1)), nmap);   /* save modified map with access bit set */
                     sim_debug(DEBUG_DETAIL, &cpu_dev,
                         "Mem_write Waddr %06x page %04x set access bit TLB %08x map %04x nmap %04x raddr %08x\n",
@@ -1865,6 +1910,9 @@ t_stat sim_instr(void) {
     int32               ii;                         /* temp int */
 #endif
 
+    /* TLB and MAPC may have been changed by DEPOSIT or RESTORE */
+    flush_rtlb();                                   /* resolve translations again */
+
 wait_loop:
     while (reason == 0) {                           /* loop until halted */
 
@@ -4715,6 +4763,7 @@ doovr3:
                     map |= 0x800;                   /* set the accessed bit in the memory map entry */
                     WMR((nix<<1), map);             /* store the map reg contents into cache */
                     TLB[nix] |= 0x0c000000;         /* set the accessed & hit bits in TLB too */
+                    RTLB[nix] = 0;                  /* resolve it again */
                     WMH(msdl+(mix<<1), mmap);       /* save modified memory map with access bit set */
                     sim_debug(DEBUG_EXP, &cpu_dev,
                         "LEAR Laddr %06x page %04x set access bit TLB %08x map %04x nmap %04x\n",
@@ -7368,6 +7417,7 @@ t_stat cpu_reset(DEVICE *dptr)
     PSD1 = 0x80000000;                              /* privileged, non mapped, non extended, address 0 */
     PSD2 = 0x00004000;                              /* blocked interrupts mode */
     MODES = (PRIVBIT | BLKMODE);                    /* set modes to privileged and blocked interrupts */
+    flush_rtlb();                                   /* no resolved translations */
     CC = 0;                                         /* no CCs too */
     CPUSTATUS = CPU_MODEL;                          /* clear all cpu status except cpu type */
     CPUSTATUS |= PRIVBIT;                           /* set privleged state bit 0 */
@@ -7528,6 +7578,7 @@ t_stat cpu_set_size(UNIT *uptr, int32 sval, CONST char *cptr, void *desc)
     cpu_unit.flags &= ~UNIT_MSIZE;                  /* clear old size value 0-31 */
     cpu_unit.flags |= val << UNIT_V_MSIZE;          /* set new memory size index value (0-31) */
     cpu_unit.capac = (t_addr)msize;                 /* set new size */
+    flush_rtlb();                                   /* recheck real addresses */
     return SCPE_OK;                                 /* we done */
 }
 
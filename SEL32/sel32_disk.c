@@ -1111,6 +1111,7 @@ t_stat disk_srv(UNIT *uptr)
     int             unit = (uptr - dptr->units);
     int             len = chp->ccw_count;
     int             i,j,k;
+    uint32          cnt;                        /* bytes moved by the channel */
     uint32          mema, ecc, cecc;            /* memory address / ecc */
     uint8           ch;
     uint16          ssize = disk_type[type].ssiz * 4;   /* disk sector size in bytes */
@@ -1946,22 +1947,19 @@ if ((chp->ccw_addr == 0x3cde0) && (buf[0] == 0x4a)) {
 #endif
             uptr->CHS++;                        /* next sector number */
             /* process the next sector of data */
-            for (i=0; i<len; i++) {
-                ch = buf[i];                    /* get a char from buffer */
-                if (chan_write_byte(chsa, &ch)) {   /* put a byte to memory */
-                    if (chp->chan_status & STATUS_PCHK) /* test for memory error */
-                        uptr->SNS |= SNS_INAD;  /* invalid address */
-                    sim_debug(DEBUG_EXP, dptr,
-                        "DISK READ4 %04x bytes leaving %04x from diskfile %04x/%02x/%02x\n",
-                        i, chp->ccw_count, ((uptr->CHS)>>16)&0xffff,
-                        ((uptr->CHS)>>8)&0xff, (uptr->CHS)&0xff);
-                    uptr->CMD &= LMASK;         /* remove old status bits & cmd */
-                    if (chp->chan_status & STATUS_PCHK) /* test for memory error */
-                        chan_end(chsa, SNS_CHNEND|SNS_DEVEND|STATUS_PCHK);
-                    else
-                        chan_end(chsa, SNS_CHNEND|SNS_DEVEND);
-                    return SCPE_OK;
-                }
+            if (chan_write_buf(chsa, buf, len, &cnt)) { /* put the sector to memory */
+                if (chp->chan_status & STATUS_PCHK) /* test for memory error */
+                    uptr->SNS |= SNS_INAD;      /* invalid address */
+                sim_debug(DEBUG_EXP, dptr,
+                    "DISK READ4 %04x bytes leaving %04x from diskfile %04x/%02x/%02x\n",
+                    cnt, chp->ccw_count, ((uptr->CHS)>>16)&0xffff,
+                    ((uptr->CHS)>>8)&0xff, (uptr->CHS)&0xff);
+                uptr->CMD &= LMASK;             /* remove old status bits & cmd */
+                if (chp->chan_status & STATUS_PCHK) /* test for memory error */
+                    chan_end(chsa, SNS_CHNEND|SNS_DEVEND|STATUS_PCHK);
+                else
+                    chan_end(chsa, SNS_CHNEND|SNS_DEVEND);
+                return SCPE_OK;
             }
 
             /* get current sector offset */
@@ -2126,8 +2124,10 @@ if ((chp->ccw_addr == 0x3cde0) && (buf[0] == 0x4a)) {
 
             /* process the next sector of data */
             tcyl = 0;                           /* used here as a flag for short read */
-            for (i=0; i<ssize; i++) {
-                if (chan_read_byte(chsa, &ch)) {/* get a byte from memory */
+            /* burst the sector, a short IOCL finishes a byte at a time */
+            chan_read_buf(chsa, buf2, ssize, &cnt);
+            for (i=cnt; i<ssize; i++) {
+                if ((i == cnt) || chan_read_byte(chsa, &ch)) {/* get a byte from memory */
                     if (chp->chan_status & STATUS_PCHK) /* test for memory error */
                         uptr->SNS |= SNS_INAD;  /* invalid address */
                     /* if error on reading 1st byte, we are done writing */
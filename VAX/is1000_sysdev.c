@@ -229,7 +229,7 @@ DEVICE sysd_dev = {
 int32 eval_int (void)
 {
 int32 ipl = PSL_GETIPL (PSL);
-int32 i, t;
+int32 t;
 
 static const int32 sw_int_mask[IPL_SMAX] = {
     0xFFFE, 0xFFFC, 0xFFF8, 0xFFF0,                     /* 0 - 3 */
@@ -252,11 +252,7 @@ if (ipl >= IPL_SMAX)                                    /* ipl >= sw max? */
     return 0;
 if ((t = SISR & sw_int_mask[ipl]) == 0)                 /* eligible req */
     return 0;
-for (i = IPL_SMAX; i > ipl; i--) {                      /* check swre int */
-    if ((t >> i) & 1)                                   /* req != 0? int */
-        return i;
-    }
-return 0;
+return SISR_HIGH (t);                                  /* highest swre int */
 }
 
 /* Return vector for highest priority hardware interrupt at IPL lvl */
@@ -320,15 +316,46 @@ return TRUE;
    Map_ReadW    -       fetch word buffer from memory
    Map_WriteB   -       store byte buffer into memory
    Map_WriteW   -       store word buffer into memory
+
+   On a little endian host a byte or word buffer has the layout of
+   memory, and each page is moved with one memcpy.  dma_map_run maps da
+   and returns the length of the run to the end of its page, at most bc
+   bytes, with *ma its memory address.  It returns -1 if da is not
+   mapped, and 0 if the page is not all memory, the memory address is
+   not aligned to lnt or the host is big endian; the unit at a time
+   loops then do the rest of the transfer.
 */
 
+static int32 dma_map_run (uint32 da, int32 bc, int32 lnt, uint32 *ma, t_bool map)
+{
+int32 n;
+
+if (!sim_end || (bc <= 0))                              /* big endian or done? */
+    return 0;
+if (!dma_map_addr (da, ma, map))                        /* inv or NXM? */
+    return -1;
+n = VA_PAGSIZE - VA_GETOFF (*ma);                       /* left in page */
+if (n > bc)                                             /* limit to rem xfr */
+    n = bc;
+if ((*ma & (lnt - 1)) || !ADDR_IS_MEM (*ma + n - 1))    /* unaligned or I/O? */
+    return 0;
+return n;
+}
+
 int32 Map_ReadB (uint32 ba, int32 bc, uint8 *buf, t_bool map)
 {
-int32 i;
+int32 i, n;
 uint32 ma, dat;
 
 if (map)                                                /* using map? */
     ba = ba + ka_boff;
+for (i = 0; (n = dma_map_run (ba + i, bc - i, L_BYTE, &ma, map)) > 0; i = i + n)
+    memcpy (buf + i, ((uint8 *) M) + ma, n);            /* by pages */
+if (n < 0)                                              /* inv or NXM? */
+    return (bc - i);
+ba = ba + i;                                            /* rest by units */
+bc = bc - i;
+buf = buf + i;
 if ((ba | bc) & 03) {                                   /* check alignment */
     for (i = ma = 0; i < bc; i++, buf++) {              /* by bytes */
         if ((ma & VA_M_OFF) == 0) {                     /* need map? */
@@ -358,13 +385,20 @@ return 0;
 
 int32 Map_ReadW (uint32 ba, int32 bc, uint16 *buf, t_bool map)
 {
-int32 i;
+int32 i, n;
 uint32 ma,dat;
 
 if (map)                                                /* using map? */
     ba = ba + ka_boff;
 ba = ba & ~01;
 bc = bc & ~01;
+for (i = 0; (n = dma_map_run (ba + i, bc - i, L_WORD, &ma, map)) > 0; i = i + n)
+    memcpy (((uint8 *) buf) + i, ((uint8 *) M) + ma, n); /* by pages */
+if (n < 0)                                              /* inv or NXM? */
+    return (bc - i);
+ba = ba + i;                                            /* rest by units */
+bc = bc - i;
+buf = buf + (i >> 1);
 if ((ba | bc) & 03) {                                   /* check alignment */
     for (i = ma = 0; i < bc; i = i + 2, buf++) {        /* by words */
         if ((ma & VA_M_OFF) == 0) {                     /* need map? */
@@ -392,11 +426,18 @@ return 0;
 
 int32 Map_WriteB (uint32 ba, int32 bc, uint8 *buf, t_bool map)
 {
-int32 i;
+int32 i, n;
 uint32 ma, dat;
 
 if (map)                                                /* using map? */
     ba = ba + ka_boff;
+for (i = 0; (n = dma_map_run (ba + i, bc - i, L_BYTE, &ma, map)) > 0; i = i + n)
+    memcpy (((uint8 *) M) + ma, buf + i, n);            /* by pages */
+if (n < 0)                                              /* inv or NXM? */
+    return (bc - i);
+ba = ba + i;                                            /* rest by units */
+bc = bc - i;
+buf = buf + i;
 if ((ba | bc) & 03) {                                   /* check alignment */
     for (i = ma = 0; i < bc; i++, buf++) {              /* by bytes */
         if ((ma & VA_M_OFF) == 0) {                     /* need map? */
@@ -426,13 +467,20 @@ return 0;
 
 int32 Map_WriteW (uint32 ba, int32 bc, uint16 *buf, t_bool map)
 {
-int32 i;
+int32 i, n;
 uint32 ma, dat;
 
 if (map)                                                /* using map? */
     ba = ba + ka_boff;
 ba = ba & ~01;
 bc = bc & ~01;
+for (i = 0; (n = dma_map_run (ba + i, bc - i, L_WORD, &ma, map)) > 0; i = i + n)
+    memcpy (((uint8 *) M) + ma, ((uint8 *) buf) + i, n); /* by pages */
+if (n < 0)                                              /* inv or NXM? */
+    return (bc - i);
+ba = ba + i;                                            /* rest by units */
+bc = bc - i;
+buf = buf + (i >> 1);
 if ((ba | bc) & 03) {                                   /* check alignment */
     for (i = ma = 0; i < bc; i = i + 2, buf++) {        /* by words */
         if ((ma & VA_M_OFF) == 0) {                     /* need map? */
@@ -657,6 +705,8 @@ struct reglink regtable[] = {
     { 0, 0, NULL, NULL }
     };
 
+static uint8 regidx[REGIDX_PAGES];                     /* regtable dispatch index */
+
 /* ReadReg - read register space
 
    Inputs:
@@ -669,7 +719,7 @@ struct reglink regtable[] = {
 int32 ReadReg (uint32 pa, int32 lnt)
 {
 struct reglink *p;
-for (p = &regtable[0]; p->low != 0; p++) {
+for (p = REGIDX_FIRST (regtable, regidx, pa); p->low != 0; p++) {
     if ((pa >= p->low) && (pa < p->high) && p->read)
         return p->read (pa);
     }
@@ -704,7 +754,7 @@ void WriteReg (uint32 pa, int32 val, int32 lnt)
 {
 struct reglink *p;
 
-for (p = &regtable[0]; p->low != 0; p++) {
+for (p = REGIDX_FIRST (regtable, regidx, pa); p->low != 0; p++) {
     if ((pa >= p->low) && (pa < p->high) && p->write) {
         p->write (pa, val, lnt);  
         return;
@@ -884,6 +934,7 @@ else STK[temp] = SP;                                    /* save stack */
 if (mapen)                                              /* mapping on? */
     conpsl = conpsl | CON_MAPON;
 mapen = 0;                                              /* turn off map */
+FLUSH_IPAGE;                                            /* forget I-stream xlate */
 SP = IS;                                                /* set SP from IS */
 PSL = PSL_IS | PSL_IPL1F;                               /* PSL = 41F0000 */
 JUMP (ROMBASE);                                         /* PC = 20040000 */
@@ -933,6 +984,7 @@ return SCPE_OK;
 
 t_stat sysd_reset (DEVICE *dptr)
 {
+vax_regidx_build (regidx, regtable, sizeof (regtable[0]));
 ka_hltcod = 0;
 ka_cfgtst = 0xFFAB;
 ka_mapbase = 0;
@@ -79,7 +79,6 @@ DEVICE *sim_devices[] = {
 t_stat sim_load (FILE *fileref, CONST char *cptr, CONST char *fnam, int flag)
 {
 t_stat r;
-int32 i;
 uint32 origin, limit;
 
 if (flag)                                               /* dump? */
@@ -101,13 +100,6 @@ else {
             return SCPE_ARG;
         }
     }
-while ((i = Fgetc (fileref)) != EOF) {                  /* read byte stream */
-    if (origin >= limit)                                /* NXM? */
-        return SCPE_NXM;
-    if (sim_switches & SWMASK ('R'))                    /* ROM? */
-        rom_wr_B (origin, i);                           /* not writeable */
-    else WriteB (origin, i);                            /* store byte */
-    origin = origin + 1;
-    }
-return SCPE_OK;
+return vax_load_bytes (fileref, origin, limit, 1,              /* load byte stream */
+                       (sim_switches & SWMASK ('R')) ? &rom_wr_B : NULL);
 }
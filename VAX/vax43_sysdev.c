@@ -172,7 +172,7 @@ DEVICE sysd_dev = {
 int32 eval_int (void)
 {
 int32 ipl = PSL_GETIPL (PSL);
-int32 i, t;
+int32 t;
 
 static const int32 sw_int_mask[IPL_SMAX] = {
     0xFFFE, 0xFFFC, 0xFFF8, 0xFFF0,                     /* 0 - 3 */
@@ -193,11 +193,7 @@ if (ipl >= IPL_SMAX)                                    /* ipl >= sw max? */
     return 0;
 if ((t = SISR & sw_int_mask[ipl]) == 0)                 /* eligible req */
     return 0;
-for (i = IPL_SMAX; i > ipl; i--) {                      /* check swre int */
-    if ((t >> i) & 1)                                   /* req != 0? int */
-        return i;
-    }
-return 0;
+return SISR_HIGH (t);                                  /* highest swre int */
 }
 
 /* Return vector for highest priority hardware interrupt at IPL lvl */
@@ -703,6 +699,8 @@ struct reglink regtable[] = {
     { 0, 0, NULL, NULL }
     };
 
+static uint8 regidx[REGIDX_PAGES];                     /* regtable dispatch index */
+
 /* ReadReg - read register space
 
    Inputs:
@@ -716,7 +714,7 @@ int32 ReadReg (uint32 pa, int32 lnt)
 {
 struct reglink *p;
 
-for (p = &regtable[0]; p->low != 0; p++) {
+for (p = REGIDX_FIRST (regtable, regidx, pa); p->low != 0; p++) {
     if ((pa >= p->low) && (pa < p->high) && p->read)
         return p->read (pa);
     }
@@ -751,7 +749,7 @@ void WriteReg (uint32 pa, int32 val, int32 lnt)
 {
 struct reglink *p;
 
-for (p = &regtable[0]; p->low != 0; p++) {
+for (p = REGIDX_FIRST (regtable, regidx, pa); p->low != 0; p++) {
     if ((pa >= p->low) && (pa < p->high) && p->write) {
         p->write (pa, val, lnt);  
         return;
@@ -943,6 +941,7 @@ else STK[temp] = SP;                                    /* save stack */
 if (mapen)                                              /* mapping on? */
     conpsl = conpsl | CON_MAPON;
 mapen = 0;                                              /* turn off map */
+FLUSH_IPAGE;                                            /* forget I-stream xlate */
 SP = IS;                                                /* set SP from IS */
 PSL = PSL_IS | PSL_IPL1F;                               /* PSL = 41F0000 */
 JUMP (ROMBASE);                                         /* PC = 20040000 */
@@ -1005,6 +1004,7 @@ return SCPE_OK;
 
 t_stat sysd_reset (DEVICE *dptr)
 {
+vax_regidx_build (regidx, regtable, sizeof (regtable[0]));
 sim_cancel (&sysd_unit);
 ka_mser = 0;
 ka_mear = 0;
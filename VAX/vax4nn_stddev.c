@@ -220,7 +220,7 @@ return SCPE_OK;
 t_stat rom_reset (DEVICE *dptr)
 {
 if (rom == NULL)
-    rom = (uint32 *) calloc (ROMSIZE >> 2, sizeof (uint32));
+    rom = (uint32 *) sim_mem_alloc (ROMSIZE);       /* shareable among instances */
 if (rom == NULL)
     return SCPE_MEM;
 return SCPE_OK;
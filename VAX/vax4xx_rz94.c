@@ -570,14 +570,18 @@ switch (cmd & 0x7f) {
         break;
 
     case 0x42:                                          /* select with ATN */
-        sim_debug (DBG_CMD, &rz_dev, "select with atn\n");
+    case 0x46:                                          /* select with ATN3 */
+        sim_debug (DBG_CMD, &rz_dev, "select with atn%s\n", ((cmd & 0x7F) == 0x46) ? "3" : "");
         rz_seq = 0;
         if (!scsi_arbitrate (&rz_bus, ini)) {
             rz_int |= INT_DIS;                          /* disconnect */
             sim_activate (&rz_unit[8], 100);
             break;
             }
-        scsi_set_atn (&rz_bus);
+        if ((cmd & 0x7F) == 0x46)
+            scsi_set_atn3 (&rz_bus);                    /* identify + queue tag */
+        else
+            scsi_set_atn (&rz_bus);
         if (!scsi_select (&rz_bus, tgt)) {
             rz_seq = 0;
             rz_int |= INT_DIS;                          /* disconnect */
@@ -634,16 +638,6 @@ switch (cmd & 0x7f) {
         sim_debug (DBG_CMD, &rz_dev, "enable selection/reselection\n");
         break;
     
-    case 0x46:                                          /* select with ATN3 */
-        sim_debug (DBG_CMD, &rz_dev, "select with atn3\n");
-        scsi_set_atn (&rz_bus);
-        if (!scsi_select (&rz_bus, tgt)) {
-            rz_int |= INT_DIS;                          /* disconnect */
-            scsi_release (&rz_bus);
-            }
-        sim_activate (&rz_unit[8], 50);
-        break;
-
     case 0x1A:                                          /* set ATN */
         sim_debug (DBG_CMD, &rz_dev, "set atn\n");
         scsi_set_atn (&rz_bus);
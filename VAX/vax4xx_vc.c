@@ -281,6 +281,8 @@ if (lnt < L_LONG) {                                     /* byte or word? */
     nval = ((val & mask) << sc) | (t & ~(mask << sc));
     }
 else nval = val;
+if (vc_buf[rg] == nval)                                 /* unchanged? */
+    return;
 vc_buf[rg] = nval;                                      /* update buffer */
 scrln = ((rg >> 5) + VC_BYSIZE - (vc_org << VC_ORSC)) & (VC_BYSIZE - 1);
 if (scrln < VC_YSIZE)
@@ -366,7 +368,8 @@ SIM_MOUSE_EVENT mev;
 SIM_KEY_EVENT kev;
 t_bool updated = FALSE;                                 /* flag for refresh */
 uint32 lines;
-uint32 ln, col, off;
+uint32 ln, col, off, data, i;
+uint32 *line;
 uint16 *plna, *plnb;
 uint16 bita, bitb;
 uint32 c;
@@ -413,9 +416,12 @@ lines = 0;
 for (ln = 0; ln < VC_YSIZE; ln++) {
     if (vc_updated[ln]) {                               /* line invalid? */
         off = ((ln + (vc_org << VC_ORSC)) << 5) & VC_BUFMASK; /* get video buf offet */
-        for (col = 0; col < VC_XSIZE; col++)  
-            vc_lines[ln*VC_XSIZE + col] = vc_palette[(vc_buf[off + (col >> 5)] >> (col & 0x1F)) & 1];
-                                                        /* 1bpp to 32bpp */
+        line = &vc_lines[ln*VC_XSIZE];
+        for (col = 0; col < (VC_XSIZE >> 5); col++) {   /* for each word */
+            data = vc_buf[off + col];
+            for (i = 0; i < 32; i++, data >>= 1)
+                *line++ = vc_palette[data & 1];         /* 1bpp to 32bpp */
+            }
         if (CUR_V &&                                    /* cursor visible && need to draw cursor? */
             (vc_input_captured || (vc_dev.dctrl & DBG_CURSOR))) {
             if ((ln >= CUR_Y) && (ln < (CUR_Y + 16))) { /* cursor on this line? */
@@ -270,6 +270,8 @@ struct reglink regtable[] = {
     { 0, 0, NULL, NULL }
     };
 
+static uint8 regidx[REGIDX_PAGES];                     /* regtable dispatch index */
+
 /* ReadReg - read register space
 
    Inputs:
@@ -283,7 +285,7 @@ int32 ReadReg (uint32 pa, int32 lnt)
 {
 struct reglink *p;
 
-for (p = &regtable[0]; p->low != 0; p++) {
+for (p = REGIDX_FIRST (regtable, regidx, pa); p->low != 0; p++) {
     if ((pa >= p->low) && (pa < p->high) && p->read)
         return p->read (pa, lnt);
     }
@@ -318,7 +320,7 @@ void WriteReg (uint32 pa, int32 val, int32 lnt)
 {
 struct reglink *p;
 
-for (p = &regtable[0]; p->low != 0; p++) {
+for (p = REGIDX_FIRST (regtable, regidx, pa); p->low != 0; p++) {
     if ((pa >= p->low) && (pa < p->high) && p->write) {
         p->write (pa, val, lnt);  
         return;
@@ -529,6 +531,7 @@ return sim_messagef (SCPE_ARG, "Unknown/Unsupported instruction set: %s\n", gbuf
 
 t_stat sysd_reset (DEVICE *dptr)
 {
+vax_regidx_build (regidx, regtable, sizeof (regtable[0]));
 sim_vm_cmd = vax610_cmd;
 return SCPE_OK;
 }
@@ -112,7 +112,6 @@ DEVICE *sim_devices[] = {
 t_stat sim_load (FILE *fileref, CONST char *cptr, CONST char *fnam, int flag)
 {
 t_stat r;
-int32 val;
 uint32 origin, limit;
 
 if (flag)                                               /* dump? */
@@ -124,20 +123,7 @@ if (sim_switches & SWMASK ('O')) {                      /* origin? */
     if (r != SCPE_OK)
         return SCPE_ARG;
     }
-
-while ((val = Fgetc (fileref)) != EOF) {                 /* read byte stream */
-    if (sim_switches & SWMASK ('R')) {                  /* ROM0? */
-        return SCPE_NXM;
-        }
-    else if (sim_switches & SWMASK ('S')) {             /* ROM1? */
-        return SCPE_NXM;
-        }
-    else {
-        if (origin >= limit)                            /* NXM? */
-            return SCPE_NXM;
-        WriteB (origin, val);                           /* memory */
-        }
-    origin = origin + 1;
-    }
-return SCPE_OK;
+if (sim_switches & (SWMASK ('R') | SWMASK ('S')))       /* ROM0 or ROM1? */
+    limit = origin;                                     /* not loadable */
+return vax_load_bytes (fileref, origin, limit, 1, NULL);     /* load byte stream */
 }
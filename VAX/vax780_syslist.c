@@ -118,7 +118,6 @@ DEVICE *sim_devices[] = {
 t_stat sim_load (FILE *fileref, CONST char *cptr, CONST char *fnam, int flag)
 {
 t_stat r;
-int32 val;
 uint32 origin, limit;
 
 if (flag)                                               /* dump? */
@@ -130,26 +129,11 @@ if (sim_switches & SWMASK ('O')) {                      /* origin? */
     if (r != SCPE_OK)
         return SCPE_ARG;
     }
-
-while ((val = Fgetc (fileref)) != EOF) {                 /* read byte stream */
-    if (sim_switches & SWMASK ('R')) {                  /* ROM0? */
-        if (origin >= ROMSIZE)
-            return SCPE_NXM;
-        rom_wr_B (ROM0BASE + origin, val);
-        }
-    else if (sim_switches & SWMASK ('S')) {             /* ROM1? */
-        if (origin >= ROMSIZE)
-            return SCPE_NXM;
-        rom_wr_B (ROM1BASE + origin, val);
-        }
-    else {
-        if (origin >= limit)                            /* NXM? */
-            return SCPE_NXM;
-        WriteB (origin, val);                           /* memory */
-        }
-    origin = origin + 1;
-    }
-return SCPE_OK;
+if (sim_switches & SWMASK ('R'))                        /* ROM0? */
+    return vax_load_bytes (fileref, ROM0BASE + origin, ROM0BASE + ROMSIZE, 1, &rom_wr_B);
+if (sim_switches & SWMASK ('S'))                        /* ROM1? */
+    return vax_load_bytes (fileref, ROM1BASE + origin, ROM1BASE + ROMSIZE, 1, &rom_wr_B);
+return vax_load_bytes (fileref, origin, limit, 1, NULL);     /* load byte stream */
 }
 
 
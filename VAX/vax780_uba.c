@@ -608,6 +608,9 @@ return vec;
    Map_ReadW    -       fetch word buffer from memory
    Map_WriteB   -       store byte buffer into memory
    Map_WriteW   -       store word buffer into memory
+
+   On a little endian host a byte or word buffer has the layout of
+   memory, and each page is moved with one memcpy.
 */
 
 int32 Map_ReadB (uint32 ba, int32 bc, uint8 *buf)
@@ -624,7 +627,11 @@ for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
         pbc = bc - i;
     if (DEBUG_PRI (uba_dev, UBA_DEB_XFR))
         fprintf (sim_deb, ">>UBA: 8b read, ma = %X, bc = %X\n", ma, pbc);
-    if ((ma | pbc) & 3) {                               /* aligned LW? */
+    if (sim_end) {                                      /* little endian? */
+        memcpy (buf, ((uint8 *) M) + ma, pbc);          /* copy page */
+        buf = buf + pbc;
+        }
+    else if ((ma | pbc) & 3) {                               /* aligned LW? */
         for (j = 0; j < pbc; ma++, j++) {               /* no, do by bytes */
             *buf++ = ReadB (ma);
             }
@@ -658,7 +665,9 @@ for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
         pbc = bc - i;
     if (DEBUG_PRI (uba_dev, UBA_DEB_XFR))
         fprintf (sim_deb, ">>UBA: 16b read, ma = %X, bc = %X\n", ma, pbc);
-    if ((ma | pbc) & 1) {                               /* aligned word? */
+    if (sim_end)                                        /* little endian? */
+        memcpy (((uint8 *) buf) + i, ((uint8 *) M) + ma, pbc);
+    else if ((ma | pbc) & 1) {                               /* aligned word? */
         for (j = 0; j < pbc; ma++, j++) {               /* no, do by bytes */
             if ((i + j) & 1) {                          /* odd byte? */
                 *buf = (*buf & BMASK) | (ReadB (ma) << 8);
@@ -698,7 +707,11 @@ for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
         pbc = bc - i;
     if (DEBUG_PRI (uba_dev, UBA_DEB_XFR))
         fprintf (sim_deb, ">>UBA: 8b write, ma = %X, bc = %X\n", ma, pbc);
-    if ((ma | pbc) & 3) {                               /* aligned LW? */
+    if (sim_end) {                                      /* little endian? */
+        memcpy (((uint8 *) M) + ma, buf, pbc);          /* copy page */
+        buf = buf + pbc;
+        }
+    else if ((ma | pbc) & 3) {                               /* aligned LW? */
         for (j = 0; j < pbc; ma++, j++) {               /* no, do by bytes */
             WriteB (ma, *buf);
             buf++;
@@ -733,7 +746,9 @@ for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
         pbc = bc - i;
     if (DEBUG_PRI (uba_dev, UBA_DEB_XFR))
         fprintf (sim_deb, ">>UBA: 16b write, ma = %X, bc = %X\n", ma, pbc);
-    if ((ma | pbc) & 1) {                               /* aligned word? */
+    if (sim_end)                                        /* little endian? */
+        memcpy (((uint8 *) M) + ma, ((const uint8 *) buf) + i, pbc);
+    else if ((ma | pbc) & 1) {                               /* aligned word? */
         for (j = 0; j < pbc; ma++, j++) {               /* no, bytes */
             if ((i + j) & 1) {
                 WriteB (ma, (*buf >> 8) & BMASK);
@@ -591,6 +591,9 @@ return SCPE_OK;
    mb_chbufW    -       compare word buffer with memory
 
    Returns number of bytes successfully transferred/checked
+
+   On a little endian host a word buffer has the layout of memory, and
+   each page is moved (or compared) with one memcpy (memcmp).
 */
 
 int32 mba_rdbufW (uint32 mb, int32 bc, uint16 *buf)
@@ -615,7 +618,9 @@ for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
     if (pbc > (bc - i))                                 /* limit to rem xfr */
         pbc = bc - i;
     sim_debug (MBA_DEB_XFR, &mba_dev[mb], "mba_rdbufW(pa=0x%X, bc=0x%X)\n", pa, pbc);
-    if ((pa | pbc) & 1) {                               /* aligned word? */
+    if (sim_end)                                        /* little endian? */
+        memcpy (((uint8 *) buf) + i, ((uint8 *) M) + pa, pbc);
+    else if ((pa | pbc) & 1) {                          /* aligned word? */
         for (j = 0; j < pbc; pa++, j++) {               /* no, bytes */
             if ((i + j) & 1) {                          /* odd byte? */
                 *buf = (*buf & BMASK) | (ReadB (pa) << 8);
@@ -664,7 +669,9 @@ for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
     if (pbc > (bc - i))                                 /* limit to rem xfr */
         pbc = bc - i;
     sim_debug (MBA_DEB_XFR, &mba_dev[mb], "mba_wrbufW(pa=0x%X, bc=0x%X)\n", pa, pbc);
-    if ((pa | pbc) & 1) {                               /* aligned word? */
+    if (sim_end)                                        /* little endian? */
+        memcpy (((uint8 *) M) + pa, ((const uint8 *) buf) + i, pbc);
+    else if ((pa | pbc) & 1) {                          /* aligned word? */
         for (j = 0; j < pbc; pa++, j++) {               /* no, bytes */
             if ((i + j) & 1) {
                 WriteB (pa, (*buf >> 8) & BMASK);
@@ -714,6 +721,11 @@ for (i = 0; i < bc; i = i + pbc) {                      /* loop by pages */
     sim_debug (MBA_DEB_XFR, &mba_dev[mb], "mba_chbufW(pa=0x%X, bc=0x%X)\n", pa, pbc);
     if (pbc > (bc - i))                                 /* limit to rem xfr */
         pbc = bc - i;
+    if (sim_end && (((i | pbc) & 1) == 0) &&            /* little endian, words, */
+        (memcmp (buf, ((uint8 *) M) + pa, pbc) == 0)) { /* and page matches? */
+        buf = buf + (pbc >> 1);
+        continue;
+        }
     for (j = 0; j < pbc; j++, pa++) {                   /* byte by byte */
         cmp = ReadB (pa);
         if ((i + j) & 1)
@@ -115,7 +115,6 @@ DEVICE *sim_devices[] = {
 t_stat sim_load (FILE *fileref, CONST char *cptr, CONST char *fnam, int flag)
 {
 t_stat r;
-int32 val;
 uint32 origin, limit;
 
 if (flag)                                               /* dump? */
@@ -128,11 +127,5 @@ if (sim_switches & SWMASK ('O')) {                      /* origin? */
         return SCPE_ARG;
     }
 
-while ((val = Fgetc (fileref)) != EOF) {                 /* read byte stream */
-    if (origin >= limit)                                /* NXM? */
-        return SCPE_NXM;
-    WriteB (origin, val);                               /* memory */
-    origin = origin + 1;
-    }
-return SCPE_OK;
+return vax_load_bytes (fileref, origin, limit, 1, NULL);     /* load byte stream */
 }
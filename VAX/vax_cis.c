@@ -1215,16 +1215,25 @@ return cc;
 
    To simplify the code elsewhere, digits are range checked,
    and bad digits cause a fault.
+
+   A string that lies within one page is read straight from memory.
 */
 
 int32 ReadDstr (int32 lnt, int32 adr, DSTR *src, int32 acc)
 {
 int32 c, i, end, t = 0;
+uint32 off;
+uint8 *p;
 
 *src = Dstr_zero;                                       /* clear result */
 end = lnt / 2;                                          /* last byte */
+p = MemPtr (adr, RA, &off);                             /* one page? */
+if ((p != NULL) && ((off + end) >= VA_PAGSIZE))
+    p = NULL;
 for (i = 0; i <= end; i++) {                            /* loop thru string */
-    c = Read ((adr + end - i) & LMASK, L_BYTE, RA);     /* get byte */
+    if (p)
+        c = p[end - i];
+    else c = Read ((adr + end - i) & LMASK, L_BYTE, RA);/* get byte */
     if (i == 0) {                                       /* sign char? */
         t = c & 0xF;                                    /* save sign */
         c = c & 0xF0;                                   /* erase sign */
@@ -1266,19 +1275,29 @@ return TestDstr (src);                                  /* clean -0 */
    Thus, the stored sign and the PSL sign will differ in one case:
    a negative zero generated by overflow is stored with a negative
    sign, but PSL.N is clear
+
+   A string that lies within one page is stored straight to memory.
 */
 
 int32 WriteDstr (int32 lnt, int32 adr, DSTR *dst, int32 pslv, int32 acc)
 {
 int32 c, i, cc, end;
+uint32 off;
+uint8 *p;
 
 end = lnt / 2;                                          /* end of string */
-ProbeDstr (end, adr, WA);                               /* test writeability */
+p = MemPtr (adr, WA, &off);                             /* one page? */
+if ((p == NULL) || ((off + end) >= VA_PAGSIZE)) {
+    p = NULL;
+    ProbeDstr (end, adr, WA);                           /* test writeability */
+    }
 cc = SetCCDstr (lnt, dst, pslv);                        /* set cond codes */
 dst->val[0] = dst->val[0] | 0xC | dst->sign;            /* set sign */
 for (i = 0; i <= end; i++) {                            /* store string */
     c = (dst->val[i / 4] >> ((i % 4) * 8)) & 0xFF;
-    Write ((adr + end - i) & LMASK, c, L_BYTE, WA);
+    if (p)
+        p[end - i] = (uint8) c;
+    else Write ((adr + end - i) & LMASK, c, L_BYTE, WA);
     }                                                   /* end for */
 return cc;
 }
@@ -267,6 +267,8 @@ int32 cpu_astop = 0;
 int32 mchk_va, mchk_ref;                                /* mem ref param */
 int32 ibufl, ibufh;                                     /* prefetch buf */
 int32 ibcnt, ppc;                                       /* prefetch ctl */
+int32 ipg_va = -1, ipg_pa;                              /* prefetch page xlate */
+int32 watch_hit = 0;                                    /* watchpoint taken */
 uint32 cpu_idle_mask =                                  /* idle mask */
 #if defined (VAX_411) || defined (VAX_412)
                        VAX_IDLE_INFOSERVER;
@@ -285,6 +287,9 @@ int32 hst_lnt = 0;                                      /* history length */
 int32 hst_switches;                                     /* history option switches */
 FILE *hst_log;                                          /* history log file */
 int32 hst_log_p;                                        /* history last log written pointer */
+SIM_MMAP *hst_map = NULL;                               /* memory mapped history file */
+SIM_HIST_HDR hst_nohdr;                                 /* header when not mapped */
+SIM_HIST_HDR *hst_hdr = &hst_nohdr;                     /* history file header */
 int32 step_out_nest_level = 0;                          /* step to call return - nest level */
 
 const uint32 byte_mask[33] = { 0x00000000,
@@ -317,12 +322,19 @@ extern int32 sys_model;
 
 t_stat cpu_reset (DEVICE *dptr);
 t_bool cpu_is_pc_a_subroutine_call (t_addr **ret_addrs);
+const char *cpu_pc_space (void);
+void cpu_watch_change (void);
 t_stat cpu_ex (t_value *vptr, t_addr exta, UNIT *uptr, int32 sw);
 t_stat cpu_dep (t_value val, t_addr exta, UNIT *uptr, int32 sw);
 t_stat cpu_set_size (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_set_hist (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_show_hist (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat cpu_show_virt (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+t_stat cpu_set_tlb (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat cpu_show_tlb (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+t_stat cpu_set_tlbctx (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat cpu_set_tlbstats (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat cpu_show_tlbstats (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat cpu_set_idle (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_show_idle (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat cpu_set_instruction_set (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
@@ -437,6 +449,14 @@ MTAB cpu_mod[] = {
       &cpu_set_hist, &cpu_show_hist, NULL, "Enable/Display instruction history" },
     { MTAB_XTD|MTAB_VDV|MTAB_NMO|MTAB_SHP, 0, "VIRTUAL", NULL,
       NULL, &cpu_show_virt, NULL, "show translation for address arg in KESU mode" },
+    { MTAB_XTD|MTAB_VDV, 0, "TLB", "TLB=n{:ways}",
+      &cpu_set_tlb, &cpu_show_tlb, NULL, "Set/Display translation buffer size and associativity" },
+    { MTAB_XTD|MTAB_VDV, 1, NULL, "TLBTAG",
+      &cpu_set_tlbctx, NULL, NULL, "Retain tagged process TB entries across LDPCTX" },
+    { MTAB_XTD|MTAB_VDV, 0, NULL, "NOTLBTAG",
+      &cpu_set_tlbctx, NULL, NULL, "Flush the process TB on LDPCTX (default)" },
+    { MTAB_XTD|MTAB_VDV|MTAB_NMO, 0, "TLBSTATS", "TLBSTATS",
+      &cpu_set_tlbstats, &cpu_show_tlbstats, NULL, "Clear/Display translation buffer statistics" },
     CPU_MODEL_MODIFIERS  /* Model specific cpu modifiers from vaxXXX_defs.h */
     CPU_INST_MODIFIERS   /* Model specific cpu instruction modifiers from vaxXXX_defs.h */
     { 0 }
@@ -455,6 +475,13 @@ DEBTAB cpu_deb[] = {
     { NULL, 0 }
     };
 
+BRKTYPTAB cpu_breakpoints [] = {
+    BRKTYPE('E',"Execute Instruction at Virtual Address"),
+    BRKTYPE('R',"Read from Virtual Address"),
+    BRKTYPE('W',"Write to Virtual Address"),
+    { 0 }
+    };
+
 DEVICE cpu_dev = {
     "CPU", &cpu_unit, cpu_reg, cpu_mod,
     1, 16, 32, 1, 16, 8,
@@ -500,6 +527,7 @@ int32 spec = 0, disp = 0, rn = 0, index = 0, numspec = 0;
 int32 vfldrp1 = 0, brdisp = 0, flg = 0, mstat = 0;
 uint32 va = 0, iad = 0;
 int32 opnd[OPND_SIZE];                                  /* operand queue */
+t_bool hooks;                                           /* history or breakpoints? */
 
 if ((ret = build_dib_tab ()) != SCPE_OK)                /* build, chk dib_tab */
     return ret;
@@ -516,6 +544,8 @@ set_map_reg ();                                         /* set map reg */
 GET_CUR;                                                /* set access mask */
 SET_IRQL;                                               /* eval interrupts */
 FLUSH_ISTR;                                             /* clear prefetch */
+FLUSH_IPAGE;
+watch_hit = 0;
 
 abortval = setjmp (save_env);                           /* set abort hdlr */
 if (abortval > 0) {                                     /* sim stop? */
@@ -604,14 +634,20 @@ else if (abortval < 0) {                                /* mm or rsrv or int */
         }                                               /* end case */
     }                                                   /* end else */
 
-/* Main instruction loop */
+/* Main instruction loop
 
+   The per instruction history and breakpoint work is skipped with a
+   single test of hooks, which is only re-evaluated here and after event
+   dispatch, where commands entered while running take effect.
+*/
+
+hooks = (hst_lnt || sim_brk_summ);
 for ( ;; ) {
     int32 i, j;
 
 /* Optionally record instruction history results from prior instruction */
 
-    if (hst_lnt) {
+    if (SIM_UNLIKELY (hooks) && hst_lnt) {
         InstHistory *hlast = &hst[hst_p ? hst_p-1 : hst_lnt -1];
 
         switch (DR_GETRES(drom[hlast->opc][0]) << DR_V_RESMASK) {
@@ -660,6 +696,7 @@ for ( ;; ) {
         temp = sim_process_event ();
         if (temp)
             ABORT (temp);
+        hooks = (hst_lnt || sim_brk_summ);              /* may have been changed */
         SET_IRQL;                                       /* update interrupts */
         }
 
@@ -721,9 +758,13 @@ for ( ;; ) {
             }
         }                                               /* end PSL event */
 
-    if (sim_brk_summ &&
-        sim_brk_test ((uint32) PC, SWMASK ('E'))) {     /* breakpoint? */
-        ABORT (STOP_IBKPT);                             /* stop simulation */
+    if (SIM_UNLIKELY (hooks) && sim_brk_summ) {
+        if (watch_hit) {                                /* watchpoint in last inst? */
+            watch_hit = 0;
+            ABORT (STOP_IBKPT);                         /* stop simulation */
+            }
+        if (sim_brk_test ((uint32) PC, SWMASK ('E')))   /* breakpoint? */
+            ABORT (STOP_IBKPT);                         /* stop simulation */
         }
 
     sim_interval = sim_interval - (1 + (extra_bytes>>5));/* count instr */
@@ -1560,7 +1601,7 @@ for ( ;; ) {
 
 /* Optionally record instruction history */
 
-    if (hst_lnt) {
+    if (SIM_UNLIKELY (hooks) && hst_lnt) {
         int32 lim;
         t_value wd;
         InstHistory *h = &hst[hst_p];
@@ -1586,6 +1627,7 @@ for ( ;; ) {
         hst_p = hst_p + 1;
         if (hst_p >= hst_lnt)
             hst_p = 0;
+        hst_hdr->next = hst_p;                          /* keep mapped file current */
         if (hst_log && (hst_p == hst_log_p))
             cpu_show_hist_records (hst_log, FALSE, hst_log_p, hst_lnt);
         }
@@ -3193,6 +3235,13 @@ for ( ;; ) {
    have enough bytes, enough prefetch words are fetched until there
    are.  A longword is only prefetched if data is needed from it,
    so any translation errors are real.
+
+   The translation of the most recently fetched I-stream page is
+   remembered (ipg_va, ipg_pa), so that branches and page crossings
+   within recently used code do not have to go through the TB.  The
+   access mode it was checked in is kept in the (otherwise zero) low
+   bits of ipg_va, so a mode change forces a new protection check.  The
+   remembered translation is discarded whenever the TB is changed.
 */
 
 static SIM_INLINE int32 get_istr (int32 lnt, int32 acc)
@@ -3202,9 +3251,19 @@ int32 sc, val, t;
 
 while ((bo + lnt) > ibcnt) {                            /* until enuf bytes */
     if ((ppc < 0) || (VA_GETOFF (ppc) == 0)) {          /* PPC inv, xpg? */
-        ppc = Test ((PC + ibcnt) & ~03, RD, &t);        /* xlate PC */
-        if (ppc < 0)
-            Read ((PC + ibcnt) & ~03, L_LONG, RA);
+        int32 iva = (PC + ibcnt) & ~03;
+
+        if (((iva & ~VA_M_OFF) | PSL_GETCUR (PSL)) == ipg_va) /* same page, mode? */
+            ppc = ipg_pa | VA_GETOFF (iva);
+        else {
+            ppc = Test (iva, RD, &t);                   /* xlate PC */
+            if (ppc < 0)
+                Read (iva, L_LONG, RA);
+            else {
+                ipg_va = (iva & ~VA_M_OFF) | PSL_GETCUR (PSL); /* remember xlate */
+                ipg_pa = ppc & ~VA_M_OFF;
+                }
+            }
         }
     if (ibcnt == 0)                                     /* fill low */
         ibufl = ReadLP (ppc);
@@ -3318,6 +3377,58 @@ static const char *vax_clock_precalibrate_commands[] = {
     "PC 100",
     NULL};
 
+/*
+ * Standard workloads for the BENCHMARK command.  The floating
+ * point operands are short literals: S^#8 is 1.0 and S^#0 is 0.5.
+ */
+
+static const char *vax_bench_integer[] = {
+    "-m 1000 ADDL2  R1,R0",
+    "-m 1003 XORL2  R0,R2",
+    "-m 1006 ASHL   #3,R2,R3",
+    "-m 100A SUBL2  R3,R0",
+    "-m 100D INCL   R1",
+    "-m 100F BRB    1000",
+    "PC 1000",
+    NULL};
+
+static const char *vax_bench_memory[] = {
+    "-m 1000 MOVL   #100000,R6",
+    "-m 1007 MOVL   #40000,R7",
+    "-m 100E ADDL2  (R6),R0",
+    "-m 1011 MOVL   R0,(R6)+",
+    "-m 1014 SOBGTR R7,100E",
+    "-m 1017 BRB    1000",
+    "PC 1000",
+    NULL};
+
+static const char *vax_bench_string[] = {
+    "-m 1000 MOVC3  #400,@#100000,@#110000",
+    "-m 100E CMPC3  #400,@#100000,@#110000",
+    "-m 101C LOCC   #1,#400,@#100000",
+    "-m 1026 BRB    1000",
+    "PC 1000",
+    NULL};
+
+static const char *vax_bench_float[] = {
+    "-m 1000 MOVF   #8,R0",
+    "-m 1003 MOVF   #0,R1",
+    "-m 1006 MULF2  R1,R0",
+    "-m 1009 ADDF2  #8,R0",
+    "-m 100C DIVF3  R1,R0,R2",
+    "-m 1010 CMPF   R2,R0",
+    "-m 1013 BRB    1000",
+    "PC 1000",
+    NULL};
+
+static BENCHTAB vax_benchmarks[] = {
+    { "INTEGER", "register arithmetic and shifts",         vax_bench_integer },
+    { "MEMORY",  "1MB longword read/modify/write stream",  vax_bench_memory },
+    { "STRING",  "MOVC3, CMPC3 and LOCC of 1KB",           vax_bench_string },
+    { "FLOAT",   "F_floating move, multiply, add, divide", vax_bench_float },
+    { NULL }
+    };
+
 /* Reset */
 
 t_stat cpu_reset (DEVICE *dptr)
@@ -3330,17 +3441,25 @@ SISR = 0;
 ASTLVL = 4;
 mapen = 0;
 FLUSH_ISTR;                             /* init I-stream */
+FLUSH_IPAGE;
 if (M == NULL) {                        /* first time init? */
     vax_init();
-    sim_brk_types = sim_brk_dflt = SWMASK ('E');
+    sim_brk_dflt = SWMASK ('E');
+    sim_brk_types = sim_brk_dflt|SWMASK ('R')|SWMASK ('W');
+    sim_brk_type_desc = cpu_breakpoints;
+    sim_brk_watch_types = SWMASK ('R')|SWMASK ('W');
+    sim_brk_watch_shift = VA_N_OFF;
+    sim_vm_watch_change = &cpu_watch_change;
     sim_vm_is_subroutine_call = cpu_is_pc_a_subroutine_call;
+    sim_vm_pc_space = &cpu_pc_space;
     sim_clock_precalibrate_commands = vax_clock_precalibrate_commands;
+    sim_vm_benchmarks = vax_benchmarks;
     sim_vm_initial_ips = SIM_INITIAL_IPS;
     pcq_r = find_reg ("PCQ", NULL, dptr);
     if (pcq_r == NULL)
         return SCPE_IERR;
     pcq_r->qptr = 0;
-    M = (uint32 *) calloc (((uint32) MEMSIZE) >> 2, sizeof (uint32));
+    M = (uint32 *) sim_mem_alloc ((size_t) MEMSIZE);
     if (M == NULL)
         return SCPE_MEM;
     auto_config(NULL, 0);               /* do an initial auto configure */
@@ -3360,6 +3479,30 @@ static const char *cpu_next_caveats =
 "locations due to a trap, stack unwind or any other reason, instruction\n"
 "execution will continue until some other reason causes execution to stop.\n";
 
+/* Memory watchpoints
+
+   Pages with read or write watchpoints are never entered in the TB, so
+   every data access to them misses and goes through fill, which checks
+   the watchpoints exactly.  Accesses to other pages run at full speed.
+   A watchpoint stops the simulator at the end of the instruction which
+   took it.  A newly watched page may already be in the TB, so the TB
+   is flushed whenever the set of watched pages grows.
+*/
+
+void cpu_watch_change (void)
+{
+zap_tb (1);
+}
+
+/* Access mode of the current PC (for the profiler) */
+
+const char *cpu_pc_space (void)
+{
+static const char *modes[4] = {"K", "E", "S", "U"};
+
+return modes[PSL_GETCUR (PSL)];
+}
+
 t_bool cpu_is_pc_a_subroutine_call (t_addr **ret_addrs)
 {
 #define MAX_SUB_RETURN_SKIP 9
@@ -3445,7 +3588,7 @@ return SCPE_NXM;
 t_stat cpu_set_size (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 {
 int32 mc = 0;
-uint32 i, clim, uval = (uint32)val;
+uint32 i, uval = (uint32)val;
 uint32 *nM = NULL;
 
 if ((val <= 0) || (val > MAXMEMSIZE_X))
@@ -3454,13 +3597,9 @@ for (i = val; i < MEMSIZE; i = i + 4)
     mc = mc | M[i >> 2];
 if ((mc != 0) && !get_yn ("Really truncate memory [N]?", FALSE))
     return SCPE_OK;
-nM = (uint32 *) calloc (uval >> 2, sizeof (uint32));
+nM = (uint32 *) sim_mem_realloc (M, (size_t) uval);  /* preserves contents */
 if (nM == NULL)
     return SCPE_MEM;
-clim = (uint32)((uval < MEMSIZE)? uval: MEMSIZE);
-for (i = 0; i < clim; i = i + 4)
-    nM[i >> 2] = M[i >> 2];
-free (M);
 M = nM;
 MEMSIZE = uval; 
 reset_all (0);
@@ -3531,6 +3670,7 @@ if (cptr == NULL) {
     for (i = 0; i < hst_lnt; i++)
         hst[i].iPC = 0;
     hst_p = 0;
+    hst_hdr->next = 0;
     if (hst_log) {
         sim_set_fsize (hst_log, (t_addr)0);
         hst_log_p = 0;
@@ -3539,14 +3679,21 @@ if (cptr == NULL) {
     return SCPE_OK;
     }
 cptr = get_glyph (cptr, gbuf, ':');
-lnt = (int32) get_uint (gbuf, 10, HIST_MAX, &r);
+lnt = (int32) get_uint (gbuf, 10, (sim_switches & SWMASK ('M')) ? HIST_MAP_MAX : HIST_MAX, &r);
 if (r != SCPE_OK)
     return sim_messagef (SCPE_ARG, "Invalid Numeric Value: %s\n", gbuf);
 if (lnt && (lnt < HIST_MIN))
     return sim_messagef (SCPE_ARG, "%d is less than the minumum history value of %d\n", lnt, HIST_MIN);
+if ((sim_switches & SWMASK ('M')) && ((cptr == NULL) || (*cptr == 0)))
+    return sim_messagef (SCPE_ARG, "A memory mapped history needs a file name\n");
 hst_p = 0;
 if (hst_lnt) {
-    free (hst);
+    if (hst_map)
+        sim_mmap_close (hst_map);
+    else
+        free (hst);
+    hst_map = NULL;
+    hst_hdr = &hst_nohdr;
     hst_lnt = 0;
     hst = NULL;
     if (hst_log) {
@@ -3554,6 +3701,18 @@ if (hst_lnt) {
         hst_log = NULL;
         }
     }
+if (sim_switches & SWMASK ('M')) {                      /* memory mapped? */
+    r = sim_hist_open (cptr, sizeof (InstHistory), lnt, sim_switches, &hst_map, &hst_hdr);
+    if (r != SCPE_OK) {
+        hst_hdr = &hst_nohdr;
+        return r;
+        }
+    hst = (InstHistory *)(hst_hdr + 1);
+    hst_lnt = (int32)hst_hdr->entries;
+    hst_p = (int32)hst_hdr->next;
+    hst_switches = (int32)hst_hdr->switches;
+    return SCPE_OK;
+    }
 if (lnt) {
     hst = (InstHistory *) calloc (lnt, sizeof (InstHistory));
     if (hst == NULL)
@@ -3999,6 +4158,8 @@ fprintf (st, "This is controlled by the SET CPU HISTORY and SHOW CPU HISTORY com
 fprintf (st, "   sim> SET CPU HISTORY                 clear history buffer\n");
 fprintf (st, "   sim> SET CPU HISTORY=0               disable history\n");
 fprintf (st, "   sim> SET CPU {-T} HISTORY=n{:file}   enable history, length = n\n");
+fprintf (st, "   sim> SET CPU -M {-T} HISTORY=n:file  enable history kept in memory mapped file\n");
+fprintf (st, "   sim> SET CPU -M HISTORY=0:file       reopen an existing memory mapped history\n");
 fprintf (st, "   sim> SHOW CPU HISTORY                print CPU history\n");
 fprintf (st, "   sim> SHOW CPU HISTORY=n              print first n entries of CPU history\n\n");
 fprintf (st, "The -T switch causes simulator time to be recorded (and displayed)\n");
@@ -4006,6 +4167,12 @@ fprintf (st, "with each history entry.\n");
 fprintf (st, "When writing history to a file (SET CPU HISTORY=n:file), 'n' specifies\n");
 fprintf (st, "the buffer flush frequency.  Warning: prodigious amounts of disk space\n");
 fprintf (st, "may be comsumed.  The maximum length for the history is %d entries.\n\n", HIST_MAX);
+fprintf (st, "With -M the history records themselves live in 'file', which is memory\n");
+fprintf (st, "mapped, so recording costs no more than a history kept in memory, the\n");
+fprintf (st, "history may have up to %u entries, and it survives the simulator exiting\n", HIST_MAP_MAX);
+fprintf (st, "or crashing.  A history left behind this way can be examined later by\n");
+fprintf (st, "reopening it with SET CPU -M HISTORY=0:file and using SHOW CPU HISTORY.\n");
+fprintf (st, "Recording continues into a reopened history when the simulator runs.\n\n");
 fprintf (st, "Different VAX systems implemented different VAX architecture instructions\n");
 fprintf (st, "in hardware with other instructions possibly emulated by software in the\n");
 fprintf (st, "system.  The instructions that a particular simulator implements can be\n");
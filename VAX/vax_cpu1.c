@@ -781,6 +781,99 @@ return 0;                                               /* q can't be empty */
 #define MVC_M_STATE     3
 #define MVC_V_CC        2
 
+/* String instruction page runs
+
+   The string instructions work through memory a page at a time when
+   they can.  MemPtr returns a host pointer to the byte at va, and the
+   rest of its page is processed with memmove, memset, memcmp or memchr.
+   When MemPtr returns NULL, the original loops do the work and take
+   any fault.
+
+   str_units approximates the units the byte/longword loops would have
+   counted in extra_bytes for n bytes moved at destination address d.
+*/
+
+static int32 str_units (uint32 d, uint32 n)
+{
+uint32 head = (4 - d) & 3;
+
+if (head > n)
+    head = n;
+return head + ((n - head) >> 2) + ((n - head) & 3);
+}
+
+/* Move forward by page runs, R1 = src, R2 = length, R3 = dst */
+
+static void str_move_frwd (int32 acc)
+{
+uint8 *src, *dst;
+uint32 soff, doff, n;
+
+while (R[2] > 0) {
+    if ((src = MemPtr (R[1], RA, &soff)) == NULL)
+        return;
+    if ((dst = MemPtr (R[3], WA, &doff)) == NULL)
+        return;
+    n = VA_PAGSIZE - ((soff > doff) ? soff : doff);     /* to nearer page end */
+    if (n > (uint32) R[2])
+        n = R[2];
+    if ((dst > src) && (dst < src + n))                 /* aliased overlap? */
+        return;
+    memmove (dst, src, n);
+    extra_bytes += str_units (R[3], n);
+    R[1] = R[1] + n;
+    R[3] = R[3] + n;
+    R[2] = R[2] - n;
+    }
+}
+
+/* Move backward by page runs, R1 = src end, R2 = length, R3 = dst end */
+
+static void str_move_back (int32 acc)
+{
+uint8 *src, *dst;
+uint32 soff, doff, n;
+
+while (R[2] > 0) {
+    if ((src = MemPtr (R[1] - 1, RA, &soff)) == NULL)
+        return;
+    if ((dst = MemPtr (R[3] - 1, WA, &doff)) == NULL)
+        return;
+    n = ((soff < doff) ? soff : doff) + 1;              /* to nearer page start */
+    if (n > (uint32) R[2])
+        n = R[2];
+    src = src + 1 - n;
+    dst = dst + 1 - n;
+    if ((dst < src) && (dst + n > src))                 /* aliased overlap? */
+        return;
+    memmove (dst, src, n);
+    extra_bytes += str_units (R[3] - n, n);
+    R[1] = R[1] - n;
+    R[3] = R[3] - n;
+    R[2] = R[2] - n;
+    }
+}
+
+/* Fill by page runs, R3 = dst, R4 = length */
+
+static void str_fill (int32 fill, int32 acc)
+{
+uint8 *dst;
+uint32 doff, n;
+
+while (R[4] > 0) {
+    if ((dst = MemPtr (R[3], WA, &doff)) == NULL)
+        return;
+    n = VA_PAGSIZE - doff;
+    if (n > (uint32) R[4])
+        n = R[4];
+    memset (dst, fill & BMASK, n);
+    extra_bytes += str_units (R[3], n);
+    R[3] = R[3] + n;
+    R[4] = R[4] - n;
+    }
+}
+
 /* MOVC3, MOVC5
 
    if PSL<fpd> = 0 and MOVC3,
@@ -859,6 +952,7 @@ else {
 switch (R[5] & MVC_M_STATE) {                           /* case on state */
 
     case MVC_FRWD:                                      /* move forward */
+        str_move_frwd (acc);                            /* whole runs */
         mlnt[0] = (4 - R[3]) & 3;                       /* length to align */
         if (mlnt[0] > R[2])                             /* cant exceed total */
             mlnt[0] = R[2];
@@ -877,6 +971,7 @@ switch (R[5] & MVC_M_STATE) {                           /* case on state */
         goto FILL;                                      /* check for fill */
 
     case MVC_BACK:                                      /* move backward */
+        str_move_back (acc);                            /* whole runs */
         mlnt[0] = R[3] & 03;                            /* length to align */
         if (mlnt[0] > R[2])                             /* cant exceed total */
             mlnt[0] = R[2];
@@ -900,6 +995,7 @@ switch (R[5] & MVC_M_STATE) {                           /* case on state */
         if (R[4] <= 0)                                  /* any fill? */
             break;
         R[5] = R[5] | MVC_FILL;                         /* set state */
+        str_fill (fill, acc);                           /* whole runs */
         mlnt[0] = (4 - R[3]) & 3;                       /* length to align */
         if (mlnt[0] > R[4])                             /* cant exceed total */
             mlnt[0] = R[4];
@@ -974,6 +1070,29 @@ else {
     PSL = PSL | PSL_FPD;
     }
 R[2] = R[2] & STR_LNMASK;                               /* mask src2len */
+while ((R[0] & STR_LNMASK) && R[2]) {                   /* page runs of both */
+    uint8 *p1, *p2;
+    uint32 off1, off2, n, i;
+
+    if (((p1 = MemPtr (R[1], RA, &off1)) == NULL) ||
+        ((p2 = MemPtr (R[3], RA, &off2)) == NULL))
+        break;
+    n = VA_PAGSIZE - ((off1 > off2) ? off1 : off2);
+    if (n > (uint32) (R[0] & STR_LNMASK))
+        n = R[0] & STR_LNMASK;
+    if (n > (uint32) R[2])
+        n = R[2];
+    if (memcmp (p1, p2, n) == 0)
+        i = n;
+    else for (i = 0; p1[i] == p2[i]; i++) ;             /* find the mismatch */
+    extra_bytes += i;
+    R[0] = (R[0] & ~STR_LNMASK) | ((R[0] - i) & STR_LNMASK);
+    R[1] = R[1] + i;
+    R[2] = R[2] - i;
+    R[3] = R[3] + i;
+    if (i < n)                                          /* loop below finishes */
+        break;
+    }
 for (s1 = s2 = 0; ((R[0] | R[2]) & STR_LNMASK) != 0; extra_bytes++) {
     if (R[0] & STR_LNMASK)                              /* src1? read */
         s1 = Read (R[1], L_BYTE, RA);
@@ -1024,6 +1143,27 @@ else {
     R[1] = opnd[2];                                     /* src addr */
     PSL = PSL | PSL_FPD;
     }
+while (R[0] & STR_LNMASK) {                             /* page runs */
+    uint8 *p, *q;
+    uint32 off, n, i;
+
+    if ((p = MemPtr (R[1], RA, &off)) == NULL)
+        break;
+    n = VA_PAGSIZE - off;
+    if (n > (uint32) (R[0] & STR_LNMASK))
+        n = R[0] & STR_LNMASK;
+    if (skpc)
+        for (i = 0; (i < n) && (p[i] == match); i++) ;
+    else {
+        q = (uint8 *) memchr (p, match, n);
+        i = q ? (uint32) (q - p) : n;
+        }
+    extra_bytes += i;
+    R[0] = (R[0] & ~STR_LNMASK) | ((R[0] - i) & STR_LNMASK);
+    R[1] = R[1] + i;
+    if (i < n)                                          /* loop below finishes */
+        break;
+    }
 for ( ; (R[0] & STR_LNMASK) != 0; extra_bytes++ ) {    /* loop thru string */
     c = Read (R[1], L_BYTE, RA);                        /* get src byte */
     if ((c == match) ^ skpc)                            /* match & locc? */
@@ -1065,6 +1205,27 @@ else {
     R[0] = STR_PACK (mask, opnd[0]);                    /* srclen + FPD data */
     PSL = PSL | PSL_FPD;
     }
+while (R[0] & STR_LNMASK) {                             /* page runs */
+    uint8 *p, *tbl;
+    uint32 off, toff, n, i;
+
+    if ((p = MemPtr (R[1], RA, &off)) == NULL)
+        break;
+    if ((VA_GETOFF (R[3]) + 256) > VA_PAGSIZE)          /* table crosses pages? */
+        break;
+    if ((tbl = MemPtr (R[3] + p[0], RA, &toff)) == NULL)
+        break;
+    tbl = tbl - p[0];
+    n = VA_PAGSIZE - off;
+    if (n > (uint32) (R[0] & STR_LNMASK))
+        n = R[0] & STR_LNMASK;
+    for (i = 0; (i < n) && (((tbl[p[i]] & mask) == 0) ^ spanc); i++) ;
+    extra_bytes += i;
+    R[0] = (R[0] & ~STR_LNMASK) | ((R[0] - i) & STR_LNMASK);
+    R[1] = R[1] + i;
+    if (i < n)                                          /* loop below finishes */
+        break;
+    }
 for ( ; (R[0] & STR_LNMASK) != 0; extra_bytes++ ) {    /* loop thru string */
     c = Read (R[1], L_BYTE, RA);                        /* get byte */
     t = Read (R[3] + c, L_BYTE, RA);                    /* get table ent */
@@ -1309,7 +1470,7 @@ ML_LR_TEST (t & LR_MASK);                               /* validate P1LR */
 P1LR = t & LR_MASK;                                     /* restore P1LR */
 pme = (t >> 31) & 1;                                    /* restore PME */
 
-zap_tb (0);                                             /* clear process TB */
+zap_tb_ctx ();                                          /* switch process TB */
 set_map_reg ();
 sim_debug (LOG_CPU_P, &cpu_dev, ">>LDP: PC=%08x, PSL=%08x, SP=%08x, nPC=%08x, nPSL=%08x, nSP=%08x\n",
              PC, PSL, SP, newpc, newpsl, KSP);
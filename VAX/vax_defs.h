@@ -312,6 +312,21 @@ extern jmp_buf save_env;
 #define GET_TRAP(x)     (((x) >> TIR_V_TRAP) & TIR_M_TRAP)
 #define GET_IRQL(x)     (((x) >> TIR_V_IRQL) & PSL_M_IPL)
 
+/* Highest pending software interrupt in a non-zero, masked SISR */
+
+#if defined (__GNUC__)
+#define SISR_HIGH(t)    (31 - __builtin_clz ((uint32) (t)))
+#else
+#define SISR_HIGH(t)    sisr_high ((uint32) (t))
+static SIM_INLINE int32 sisr_high (uint32 t)
+{
+int32 i;
+
+for (i = 31; ((t >> i) & 1) == 0; i--) ;
+return i;
+}
+#endif
+
 /* Floating point fault parameters */
 
 #define FLT_OVRFLO      0x8                             /* flt overflow */
@@ -699,6 +714,7 @@ enum opcodes {
 #define CMODE_JUMP(d)   do {PCQ_ENTRY; PC = (d); CHECK_FOR_IDLE_LOOP; } while (0)
 #define SETPC(d)        PC = (d), FLUSH_ISTR
 #define FLUSH_ISTR      ibcnt = 0, ppc = -1
+#define FLUSH_IPAGE     ipg_va = -1
 
 /* Character string instructions */
 
@@ -849,6 +865,7 @@ void cpu_idle (void);
 /* Instruction History */
 #define HIST_MIN        64
 #define HIST_MAX        250000
+#define HIST_MAP_MAX    (1u << 30)                      /* memory mapped history max */
 
 #define OPND_SIZE       16
 #define INST_SIZE       52
@@ -886,6 +903,8 @@ extern int32 pcq[PCQ_SIZE];                             /* PC queue */
 extern int32 pcq_p;                                     /* PC queue ptr */
 extern int32 in_ie;                                     /* in exc, int */
 extern int32 ibcnt, ppc;                                /* prefetch ctl */
+extern int32 ipg_va, ipg_pa;                            /* prefetch page xlate */
+extern int32 watch_hit;                                 /* watchpoint taken */
 extern int32 hlt_pin;                                   /* HLT pin intr */
 extern int32 mxpr_cc_vc;                                /* cc V & C bits from mtpr/mfpr operations */
 extern int32 mem_err;
@@ -1023,12 +1042,26 @@ extern int32 cpu_instruction_set;
 
 #include "vax_watch.h"                  /* Watch chip definitions */
 
+/* Register space dispatch index
+
+   The system files' ReadReg/WriteReg search a regtable of address
+   ranges.  A dispatch index maps each 64KB page of physical address
+   space to the regtable entry to start that search at: the one entry
+   overlapping the page, the terminating entry if none do, or the start
+   of the table if several do.  An index of zeroes is a full search. */
+
+#define REGIDX_V_PG     16                              /* index page size */
+#define REGIDX_PAGES    (1u << (32 - REGIDX_V_PG))
+#define REGIDX_FIRST(tab,idx,pa) (&(tab)[(idx)[((uint32)(pa)) >> REGIDX_V_PG]])
+
 #ifdef DONT_USE_INTERNAL_ROM
 #define BOOT_CODE_ARRAY NULL
 #define BOOT_CODE_SIZE 0
 #endif
 
 extern t_stat cpu_load_bootcode (const char *filename, const unsigned char *builtin_code, size_t size, t_bool rom, t_addr offset);
+extern void vax_regidx_build (uint8 *idx, const void *table, size_t stride);
+extern t_stat vax_load_bytes (FILE *fileref, uint32 origin, uint32 limit, uint32 step, void (*wr_B)(int32 pa, int32 val));
 extern t_stat cpu_print_model (FILE *st);
 extern t_stat cpu_show_model (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 extern t_stat cpu_set_model (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
@@ -58,6 +58,8 @@
 
 #include "vax_defs.h"
 #include <setjmp.h>
+#include <float.h>
+#include <math.h>
 
 #if defined (USE_INT64)
 
@@ -1314,6 +1316,162 @@ return r->sign | (r->exp << G_V_EXP) |
 
 #endif
 
+/* Host floating point
+
+   Where the host double is IEEE binary64, evaluated in double precision,
+   F_floating add, subtract, multiply and divide and G_floating add and
+   subtract are done with host arithmetic when that gives exactly the
+   VAX result; anything else returns FALSE and goes through the unpacked
+   routines above.  Define DONT_USE_HOST_FP to always use them.
+
+   - Every F_floating value is a normal double, and the F sum (exponent
+     difference at most 29) and product are exact in double.  The F
+     quotient is within a double rounding of the exact quotient, which
+     is never that close to an F rounding point.  So VAX rounding (add
+     half an lsb and truncate) can be applied to the double result.
+   - A G_floating sum with an exponent difference of at most 11 loses
+     nothing in vax_fadd, and differs from the double sum only when the
+     exact sum is halfway between two doubles: the host rounds to even,
+     the VAX away from zero.  The error term of the double sum shows
+     when that has happened.
+
+   Operands that are zero or reserved, results that overflow or
+   underflow, and G values outside the normal double range fall back.
+*/
+
+#if !defined (DONT_USE_HOST_FP) && defined (FLT_EVAL_METHOD) && \
+    (FLT_EVAL_METHOD == 0) && (DBL_MANT_DIG == 53)
+#define USE_HOST_FP     1
+
+#define HFP_F_BIAS      894                             /* double - F exp */
+#define HFP_G_BIAS      2                               /* G - double exp */
+#define HFP_EXP(b)      ((int32) (((b) >> 52) & 0x7FF))
+#define HFP_FRAC        0x000FFFFFFFFFFFFF
+
+static SIM_INLINE double hfp_bits2d (t_uint64 b)
+{
+double d;
+
+memcpy (&d, &b, sizeof (d));
+return d;
+}
+
+static SIM_INLINE t_uint64 hfp_d2bits (double d)
+{
+t_uint64 b;
+
+memcpy (&b, &d, sizeof (b));
+return b;
+}
+
+static SIM_INLINE double hfp_f2d (int32 v)
+{
+return hfp_bits2d ((((t_uint64) (v & FPSIGN)) << 48) |
+    (((t_uint64) (FD_GETEXP (v) + HFP_F_BIAS)) << 52) |
+    (((t_uint64) (v & 0x7F)) << 45) |
+    (((t_uint64) ((v >> 16) & WMASK)) << 29));
+}
+
+static t_bool hfp_d2f (double d, int32 *r)
+{
+t_uint64 b = hfp_d2bits (d);
+t_uint64 m;
+int32 e;
+uint32 f;
+
+if ((b << 1) == 0) {                                    /* zero? */
+    *r = 0;
+    return TRUE;
+    }
+e = HFP_EXP (b) - HFP_F_BIAS;
+m = (b & HFP_FRAC) | (HFP_FRAC + 1);                    /* 53b fraction */
+m = m + (((t_uint64) 1) << 28);                         /* VAX round */
+if (m >> 53) {                                          /* carry out? */
+    m = m >> 1;
+    e = e + 1;
+    }
+if ((e <= 0) || (e > (int32) FD_M_EXP))                 /* out of range? */
+    return FALSE;
+f = (uint32) (m >> 29);
+*r = (int32) (((b >> 48) & FPSIGN) | (e << FD_V_EXP) |
+    ((f >> 16) & 0x7F) | ((f & WMASK) << 16));
+return TRUE;
+}
+
+static SIM_INLINE t_uint64 hfp_g2bits (int32 hi, int32 lo)
+{
+return (((t_uint64) (hi & WMASK)) << 48) |
+    (((t_uint64) ((hi >> 16) & WMASK)) << 32) |
+    (((t_uint64) (lo & WMASK)) << 16) |
+    ((t_uint64) ((lo >> 16) & WMASK));
+}
+
+/* F_floating add, multiply, divide; opc is '+', '*' or '/' */
+
+static t_bool hfp_opf (int32 *opnd, int32 opc, t_bool sub, int32 *r)
+{
+double a, b;
+
+if ((FD_GETEXP (opnd[0]) == 0) || (FD_GETEXP (opnd[1]) == 0))
+    return FALSE;
+a = hfp_f2d (opnd[0]);
+b = hfp_f2d (opnd[1]);
+switch (opc) {
+    case '+':
+        if (abs (FD_GETEXP (opnd[0]) - FD_GETEXP (opnd[1])) > 29)
+            return FALSE;
+        return hfp_d2f (sub? b - a: b + a, r);
+    case '*':
+        return hfp_d2f (b * a, r);
+    default:
+        return hfp_d2f (b / a, r);
+        }
+}
+
+/* G_floating add */
+
+static t_bool hfp_addg (int32 *opnd, int32 *rh, t_bool sub, int32 *r)
+{
+t_uint64 ba = hfp_g2bits (opnd[0], opnd[1]);
+t_uint64 bb = hfp_g2bits (opnd[2], opnd[3]);
+t_uint64 bs;
+int32 ea = HFP_EXP (ba), eb = HFP_EXP (bb), es;
+double a, b, s, bv, err;
+
+if ((ea <= HFP_G_BIAS) || (eb <= HFP_G_BIAS) ||         /* zero, rsvd, */
+    (abs (ea - eb) > 11))                               /* tiny or far? */
+    return FALSE;
+a = hfp_bits2d (ba - (((t_uint64) HFP_G_BIAS) << 52));
+b = hfp_bits2d (bb - (((t_uint64) HFP_G_BIAS) << 52));
+if (sub)
+    a = -a;
+s = a + b;
+bs = hfp_d2bits (s);
+if ((bs << 1) == 0) {                                   /* exact zero? */
+    *r = *rh = 0;
+    return TRUE;
+    }
+es = HFP_EXP (bs);
+bv = s - a;                                             /* error of sum */
+err = (a - (s - bv)) + (b - bv);
+if (err != 0.0) {
+    if (es <= 53)
+        return FALSE;
+    if ((fabs (err) == hfp_bits2d (((t_uint64) (es - 53)) << 52)) &&
+        ((err < 0.0) == (s < 0.0))) {                   /* tie, rounded in? */
+        bs = bs + 1;                                    /* round away */
+        es = HFP_EXP (bs);
+        }
+    }
+if ((es == 0) || ((es + HFP_G_BIAS) > (int32) G_M_EXP)) /* out of range? */
+    return FALSE;
+bs = bs + (((t_uint64) HFP_G_BIAS) << 52);
+*r = (int32) (((bs >> 48) & WMASK) | (((bs >> 32) & WMASK) << 16));
+*rh = (int32) (((bs >> 16) & WMASK) | ((bs & WMASK) << 16));
+return TRUE;
+}
+#endif
+
 /* Floating point instructions */
 
 /* Move/test/move negated floating
@@ -1391,7 +1549,12 @@ return rpackfd (&a, NULL);
 int32 op_addf (int32 *opnd, t_bool sub)
 {
 UFP a, b;
+#if defined (USE_HOST_FP)
+int32 r;
 
+if (hfp_opf (opnd, '+', sub, &r))
+    return r;
+#endif
 unpackf (opnd[0], &a);                                  /* F format */
 unpackf (opnd[1], &b);
 if (sub)                                                /* sub? -s1 */
@@ -1415,7 +1578,12 @@ return rpackfd (&a, rh);
 int32 op_addg (int32 *opnd, int32 *rh, t_bool sub)
 {
 UFP a, b;
+#if defined (USE_HOST_FP)
+int32 r;
 
+if (hfp_addg (opnd, rh, sub, &r))
+    return r;
+#endif
 unpackg (opnd[0], opnd[1], &a);
 unpackg (opnd[2], opnd[3], &b);
 if (sub)                                                /* sub? -s1 */
@@ -1429,7 +1597,12 @@ return rpackg (&a, rh);                                 /* round and pack */
 int32 op_mulf (int32 *opnd)
 {
 UFP a, b;
-    
+#if defined (USE_HOST_FP)
+int32 r;
+
+if (hfp_opf (opnd, '*', FALSE, &r))
+    return r;
+#endif
 unpackf (opnd[0], &a);                                  /* F format */
 unpackf (opnd[1], &b);
 vax_fmul (&a, &b, 0, FD_BIAS, 0, 0);                    /* do multiply */
@@ -1461,7 +1634,12 @@ return rpackg (&a, rh);                                 /* round and pack */
 int32 op_divf (int32 *opnd)
 {
 UFP a, b;
+#if defined (USE_HOST_FP)
+int32 r;
 
+if (hfp_opf (opnd, '/', FALSE, &r))
+    return r;
+#endif
 unpackf (opnd[0], &a);                                  /* F format */
 unpackf (opnd[1], &b);
 vax_fdiv (&a, &b, 26, FD_BIAS);                         /* do divide */
@@ -63,6 +63,8 @@ VA_LINE s2_slow, s2_fast;
 int32 dx, dy;
 int32 s2_pixf, s2_pixs;
 uint32 s2_xmask, s2_ymask;
+uint32 va_rop_and[16];                                  /* combined viper ROP, by x & 0xF */
+uint32 va_rop_xor[16];
 DEVICE *gpx_dev;
 
 const char *va_adp_rgd[] = {                            /* address processor registers */
@@ -185,6 +187,7 @@ void va_scmd (int32 cmd);
 void va_fill_setup (void);
 void va_adp_setup (void);
 void va_erase (uint32 x0, uint32 x1, uint32 y0, uint32 y1);
+void va_viper_rop_setup (void);
 
 void va_adpstat (uint32 set, uint32 clr)
 {
@@ -554,6 +557,34 @@ dest = (dest << va_vdp[cn].rg[VDP_PA]);
 *pix = (*pix & ~mask) | (dest & mask);
 }
 
+/* Combine the selected vipers into a single operation per pixel
+
+   Each viper only reads and writes its own plane bit, and with no source
+   loads in progress its source and mask registers are constant, so the
+   result for each bit is one of 0, 1, D or NOT (D).  Running the vipers
+   once on an all zeros and once on an all ones pixel yields that function
+   for every plane, which is then applied as (pixel & and) ^ xor.
+*/
+
+void va_viper_rop_setup (void)
+{
+uint32 sc, p0, p1;
+int32 sel, cn;
+
+for (sc = 0; sc < 16; sc++) {
+    p0 = 0;
+    p1 = 0xFFFFFFFF;
+    for (sel = va_ucs, cn = 0; sel; sel >>=1, cn++) {
+        if (sel & 1) {                                  /* chip selected? */
+            va_viper_rop (cn, sc, &p0);
+            va_viper_rop (cn, sc, &p1);
+            }
+        }
+    va_rop_and[sc] = p0 ^ p1;                           /* bits that follow dest */
+    va_rop_xor[sc] = p0;                                /* bits that are set or inverted */
+    }
+}
+
 t_stat va_fill (UNIT *uptr)
 {
 uint32 cmd = va_adp[ADP_CMD1];
@@ -563,6 +594,7 @@ int32 bs2 = -1;
 t_bool clip;
 uint32 s2_temp;
 uint32 s2_csr;
+uint32 sc;
 
 if (cmd & 0x4)
     s2_csr = VDP_CSR5;
@@ -578,6 +610,8 @@ for (sel = va_ucs, cn = 0; sel; sel >>=1, cn++) {
             }
         }
     }
+if ((cmd & 0x1000) == 0)                                /* viper registers constant? */
+    va_viper_rop_setup ();
 
 for (;;) {
     x0 = (dst_slow.x + va_adp[ADP_DXO]);
@@ -657,10 +691,16 @@ for (;;) {
             clip = TRUE;
             }
         if ((cmd & 0x400) && (va_adp[ADP_MDE] & 0x80) && !clip) {    /* dest enabled, pen down? */
-            /* Call all enabled Vipers to process the current pixel */
-            for (sel = va_ucs, cn = 0; sel; sel >>=1, cn++) {
-                if (sel & 1)                            /* chip selected? */
-                    va_viper_rop (cn, (dst_fast.x & 0xF), &va_buf[dst_fast.pix]);
+            if ((cmd & 0x1000) == 0) {                  /* combined viper ROP */
+                sc = dst_fast.x & 0xF;
+                va_buf[dst_fast.pix] = (va_buf[dst_fast.pix] & va_rop_and[sc]) ^ va_rop_xor[sc];
+                }
+            else {
+                /* Call all enabled Vipers to process the current pixel */
+                for (sel = va_ucs, cn = 0; sel; sel >>=1, cn++) {
+                    if (sel & 1)                        /* chip selected? */
+                        va_viper_rop (cn, (dst_fast.x & 0xF), &va_buf[dst_fast.pix]);
+                    }
                 }
             sim_debug (DBG_ROP, gpx_dev, "-> Dest X: %d, Y: %d, pix: %X\n", dst_fast.x, dst_slow.y, va_buf[dst_fast.pix]);
             va_updated[dst_slow.y + dst_fast.y + dy] = TRUE;
@@ -706,6 +746,7 @@ uint32 s1_csr;
 uint32 s2_csr;
 uint32 acf = 0;                                         /* fast scale accumulator */
 uint32 acs = 0;                                         /* slow scale accumulator */
+uint32 sc;
 
 scale = FALSE;
 if ((va_adp[ADP_FS] & 0x1FFF) != 0x1FFF)                /* fast scale != unity? */
@@ -736,6 +777,8 @@ for (sel = va_ucs, cn = 0; sel; sel >>=1, cn++) {
             }
         }
     }
+if ((cmd & 0x1800) == 0)                                /* viper registers constant? */
+    va_viper_rop_setup ();
 
 for (;;) {
     if (cmd & 0x800) {                                  /* source 1 enabled? */
@@ -857,10 +900,16 @@ for (;;) {
         clip = TRUE;
         }
     if ((cmd & 0x400) && (va_adp[ADP_MDE] & 0x80) && !clip) {    /* dest enabled, pen down? */
-        /* Call all enabled Vipers to process the current pixel */
-        for (sel = va_ucs, cn = 0; sel; sel >>=1, cn++) {
-            if (sel & 1)                                /* chip selected? */
-                va_viper_rop (cn, (dst_fast.x & 0xF), &va_buf[dst_fast.pix]);
+        if ((cmd & 0x1800) == 0) {                      /* combined viper ROP */
+            sc = dst_fast.x & 0xF;
+            va_buf[dst_fast.pix] = (va_buf[dst_fast.pix] & va_rop_and[sc]) ^ va_rop_xor[sc];
+            }
+        else {
+            /* Call all enabled Vipers to process the current pixel */
+            for (sel = va_ucs, cn = 0; sel; sel >>=1, cn++) {
+                if (sel & 1)                            /* chip selected? */
+                    va_viper_rop (cn, (dst_fast.x & 0xF), &va_buf[dst_fast.pix]);
+                }
             }
         sim_debug (DBG_ROP, gpx_dev, "-> Dest X: %d, Y: %d, pix: %X\n", dst_fast.x, dst_slow.y, va_buf[dst_fast.pix]);
         va_updated[dst_slow.y + dst_fast.y + dy] = TRUE;
@@ -409,11 +409,7 @@ if (ipl >= IPL_SMAX)                                    /* ipl >= sw max? */
     return 0;
 if ((t = SISR & sw_int_mask[ipl]) == 0)                 /* eligible req */
     return 0;
-for (i = IPL_SMAX; i > ipl; i--) {                      /* check swre int */
-    if ((t >> i) & 1)                                   /* req != 0? int */
-        return i;
-    }
-return 0;
+return SISR_HIGH (t);                                  /* highest swre int */
 }
 
 /* Return vector for highest priority hardware interrupt at IPL lvl */
@@ -758,13 +754,51 @@ return SCPE_OK;
    Map_ReadW    -       fetch word buffer from memory
    Map_WriteB   -       store byte buffer into memory
    Map_WriteW   -       store word buffer into memory
+
+   On a little endian host a byte or word buffer has the layout of
+   memory, and the transfer is done as a series of runs, each moved with
+   one memcpy.  qba_map_run maps qa as qba_map_addr does, then follows
+   the map through the pages after it for as long as they are valid
+   and physically contiguous, up to bc bytes.  It returns the length of
+   the run, with *ma its memory address, or 0 if qa is not mapped.  The
+   page which ends a run is mapped again by qba_map_addr, so any error
+   is recorded exactly as the longword loops would record it.
 */
 
+static int32 qba_map_run (uint32 qa, int32 bc, uint32 *ma)
+{
+int32 n, qmma, qmap;
+
+if (!qba_map_addr (qa, ma))                             /* inv or NXM? */
+    return 0;
+n = VA_PAGSIZE - VA_GETOFF (qa);                        /* left in page */
+while (n < bc) {                                        /* more to go? */
+    qmma = ((((qa + n) >> VA_V_VPN) << 2) & CQMAPAMASK) + cq_mbr;
+    if (!ADDR_IS_MEM (qmma))                            /* map entry legit? */
+        break;
+    qmap = M[qmma >> 2];                                /* get map */
+    if (((qmap & CQMAP_VLD) == 0) ||                    /* invalid or */
+        ((uint32) ((qmap & CQMAP_PAG) << VA_V_VPN) != (*ma + n)) ||
+        !ADDR_IS_MEM (*ma + n))                         /* not contiguous? */
+        break;
+    n = n + VA_PAGSIZE;
+    }
+return ((n < bc)? n: bc);
+}
+
 int32 Map_ReadB (uint32 ba, int32 bc, uint8 *buf)
 {
-int32 i;
+int32 i, n;
 uint32 ma, dat;
 
+if (sim_end) {                                          /* little endian? */
+    for (i = 0; i < bc; i = i + n) {                    /* by runs */
+        if ((n = qba_map_run (ba + i, bc - i, &ma)) == 0)
+            return (bc - i);
+        memcpy (buf + i, ((uint8 *) M) + ma, n);
+        }
+    return 0;
+    }
 if ((ba | bc) & 03) {                                   /* check alignment */
     for (i = ma = 0; i < bc; i++, buf++) {              /* by bytes */
         if ((ma & VA_M_OFF) == 0) {                     /* need map? */
@@ -794,11 +828,19 @@ return 0;
 
 int32 Map_ReadW (uint32 ba, int32 bc, uint16 *buf)
 {
-int32 i;
+int32 i, n;
 uint32 ma,dat;
 
 ba = ba & ~01;
 bc = bc & ~01;
+if (sim_end) {                                          /* little endian? */
+    for (i = 0; i < bc; i = i + n) {                    /* by runs */
+        if ((n = qba_map_run (ba + i, bc - i, &ma)) == 0)
+            return (bc - i);
+        memcpy (((uint8 *) buf) + i, ((uint8 *) M) + ma, n);
+        }
+    return 0;
+    }
 if ((ba | bc) & 03) {                                   /* check alignment */
     for (i = ma = 0; i < bc; i = i + 2, buf++) {        /* by words */
         if ((ma & VA_M_OFF) == 0) {                     /* need map? */
@@ -826,9 +868,17 @@ return 0;
 
 int32 Map_WriteB (uint32 ba, int32 bc, const uint8 *buf)
 {
-int32 i;
+int32 i, n;
 uint32 ma, dat;
 
+if (sim_end) {                                          /* little endian? */
+    for (i = 0; i < bc; i = i + n) {                    /* by runs */
+        if ((n = qba_map_run (ba + i, bc - i, &ma)) == 0)
+            return (bc - i);
+        memcpy (((uint8 *) M) + ma, buf + i, n);
+        }
+    return 0;
+    }
 if ((ba | bc) & 03) {                                   /* check alignment */
     for (i = ma = 0; i < bc; i++, buf++) {              /* by bytes */
         if ((ma & VA_M_OFF) == 0) {                     /* need map? */
@@ -858,11 +908,19 @@ return 0;
 
 int32 Map_WriteW (uint32 ba, int32 bc, const uint16 *buf)
 {
-int32 i;
+int32 i, n;
 uint32 ma, dat;
 
 ba = ba & ~01;
 bc = bc & ~01;
+if (sim_end) {                                          /* little endian? */
+    for (i = 0; i < bc; i = i + n) {                    /* by runs */
+        if ((n = qba_map_run (ba + i, bc - i, &ma)) == 0)
+            return (bc - i);
+        memcpy (((uint8 *) M) + ma, ((const uint8 *) buf) + i, n);
+        }
+    return 0;
+    }
 if ((ba | bc) & 03) {                                   /* check alignment */
     for (i = ma = 0; i < bc; i = i + 2, buf++) {        /* by words */
         if ((ma & VA_M_OFF) == 0) {                     /* need map? */
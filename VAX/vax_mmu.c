@@ -45,6 +45,7 @@
 
         zap_tb          -       clear TB
         zap_tb_ent      -       clear TB entry
+        zap_tb_ctx      -       switch TB process context
         chk_tb_ent      -       check TB entry
         set_map_reg     -       set up working map registers
 */
@@ -56,7 +57,42 @@
 int32 d_p0br, d_p0lr;                                   /* dynamic copies */
 int32 d_p1br, d_p1lr;                                   /* altered per ucode */
 int32 d_sbr, d_slr;
-TLBENT stlb[VA_TBSIZE], ptlb[VA_TBSIZE];
+static TLBENT stlb_dflt[VA_TBSIZE], ptlb_dflt[VA_TBSIZE];
+TLBENT *stlb = stlb_dflt;                               /* system TB */
+TLBENT *ptlb = ptlb_dflt;                               /* process TB */
+uint32 tlb_smask = VA_M_TBI;                            /* set index mask */
+uint32 tlb_ways = 1;                                    /* associativity */
+int32 tlb_ptag = 0;                                     /* process tag */
+uint32 tlb_phash = 0;                                   /* process set hash */
+t_uint64 tlb_hits = 0;                                  /* statistics (hits only if VAX_TLB_STATS) */
+t_uint64 tlb_misses = 0;
+t_uint64 tlb_flushes = 0;
+t_uint64 tlb_ctx_hits = 0;
+t_uint64 tlb_ctx_misses = 0;
+t_bool tlb_ctx_tag = FALSE;                             /* process tagging */
+
+/* Process tags
+
+   With process tagging enabled, LDPCTX selects a tag for the new
+   process instead of flushing the process TB.  A process is identified
+   by its PCB address and page table base registers.  The tag of the
+   least recently loaded context is reused (and its entries flushed)
+   when a new context is seen.
+*/
+
+#define TLB_N_CTX       255                             /* process tags */
+#define TLB_V_CTX       VA_N_VPN                        /* tag position */
+
+typedef struct {
+    int32       pcbb;                                   /* PCB address */
+    int32       p0br;                                   /* P0 base */
+    int32       p1br;                                   /* P1 base */
+    uint32      used;                                   /* last use stamp */
+    } TLBCTX;
+
+static TLBCTX tlb_ctx[TLB_N_CTX + 1];                   /* [0] = untagged */
+static int32 tlb_cur_ctx = 0;
+static uint32 tlb_ctx_clock = 0;
 static const int32 cvtacc[16] = { 0, 0,
     TLB_ACCW (KERN)+TLB_ACCR (KERN),
     TLB_ACCR (KERN),
@@ -84,6 +120,8 @@ t_stat tlb_ex (t_value *vptr, t_addr addr, UNIT *uptr, int32 sw);
 t_stat tlb_dep (t_value val, t_addr addr, UNIT *uptr, int32 sw);
 t_stat tlb_reset (DEVICE *dptr);
 const char *tlb_description (DEVICE *dptr);
+static TLBENT tlb_store (uint32 va, int32 vpn, int32 pte);
+static void tlb_inval (TLBENT *tbp, int32 ptag);
 
 TLBENT fill (uint32 va, int32 lnt, int32 acc, int32 *stat);
 extern int32 ReadIO (uint32 pa, int32 lnt);
@@ -141,9 +179,12 @@ DEVICE tlb_dev = {
 TLBENT fill (uint32 va, int32 lnt, int32 acc, int32 *stat)
 {
 int32 ptidx = (((uint32) va) >> 7) & ~03;
-int32 tlbpte, ptead, pte, tbi, vpn;
+int32 tlbpte, ptead, pte, vpn;
+TLBENT xpte;
 static TLBENT zero_pte = { 0, 0 };
 
+tlb_misses = tlb_misses + 1;
+
 if (va & VA_S0) {                                       /* system space? */
     if (ptidx >= d_slr)                                 /* system */
         MM_ERR (PR_LNV);
@@ -163,9 +204,9 @@ else {
 #if !defined (VAX_620)
     if ((ptead & VA_S0) == 0)
         ABORT (STOP_PPTE);                              /* ppte must be sys */
-    vpn = VA_GETVPN (ptead);                            /* get vpn, tbi */
-    tbi = VA_GETTBI (vpn);
-    if (stlb[tbi].tag != vpn) {                         /* in sys tlb? */
+    vpn = VA_GETVPN (ptead);                            /* get vpn */
+    xpte = tlb_lookup (ptead, vpn);
+    if (xpte.tag != vpn) {                              /* in sys tlb? */
         ptidx = ((uint32) ptead) >> 7;                  /* xlate like sys */
         if (ptidx >= d_slr)
             MM_ERR (PR_PLNV);
@@ -176,11 +217,10 @@ else {
 #endif
         if ((pte & PTE_V) == 0)                         /* spte TNV? */
             MM_ERR (PR_PTNV);
-        stlb[tbi].tag = vpn;                            /* set stlb tag */
-        stlb[tbi].pte = cvtacc[PTE_GETACC (pte)] |
-            ((pte << VA_N_OFF) & TLB_PFN);              /* set stlb data */
+        xpte = tlb_store (ptead, vpn, cvtacc[PTE_GETACC (pte)] |
+            ((pte << VA_N_OFF) & TLB_PFN));             /* set stlb entry */
         }
-    ptead = (stlb[tbi].pte & TLB_PFN) | VA_GETOFF (ptead);
+    ptead = (xpte.pte & TLB_PFN) | VA_GETOFF (ptead);
 #endif
     }
 pte = ReadL (ptead);                                    /* read pte */
@@ -195,16 +235,65 @@ if (acc & TLB_WACC) {                                   /* write? */
         WriteL (ptead, pte | PTE_M);
     tlbpte = tlbpte | TLB_M;                            /* set M */
     }
+if ((stat == NULL) && (sim_brk_summ & sim_brk_watch_types)) /* data access, watching? */
+    watch_test (va, lnt, acc);
 vpn = VA_GETVPN (va);
-tbi = VA_GETTBI (vpn);
-if ((va & VA_S0) == 0) {                                /* process space? */
-    ptlb[tbi].tag = vpn;                                /* store tlb ent */
-    ptlb[tbi].pte = tlbpte;
-    return ptlb[tbi];
+return tlb_store (va, vpn, tlbpte);                     /* store tlb ent */
+}
+
+/* Test a data access for memory watchpoints, noting any hit for the
+   end of the current instruction.  Called from fill on a TB miss, and
+   for every data access with mapping disabled.
+*/
+
+void watch_test (uint32 va, int32 lnt, int32 acc)
+{
+uint32 typ = (acc & TLB_WACC)? SWMASK ('W'): SWMASK ('R');
+int32 i;
+
+if (!SIM_BRK_WATCHED (va) && !SIM_BRK_WATCHED (va + lnt - 1))
+    return;
+for (i = 0; i < lnt; i++) {
+    if (sim_brk_test (va + i, typ)) {
+        watch_hit = 1;
+        return;
+        }
+    }
+}
+
+/* Store a TB entry as the most recently used entry of its set,
+   replacing an entry with the same tag, or else the least recently
+   used entry.
+*/
+
+static TLBENT tlb_store (uint32 va, int32 vpn, int32 pte)
+{
+TLBENT *tset;
+TLBENT xpte;
+int32 tag;
+uint32 w;
+
+xpte.tag = vpn;
+xpte.pte = pte;
+if ((sim_brk_summ & sim_brk_watch_types) && SIM_BRK_WATCHED (va))
+    return xpte;                                        /* watched, keep out of TB */
+if (va & VA_S0) {                                       /* system space? */
+    tset = &stlb[(vpn & tlb_smask) * tlb_ways];
+    tag = vpn;
     }
-stlb[tbi].tag = vpn;                                    /* system space */
-stlb[tbi].pte = tlbpte;                                 /* store tlb ent */
-return stlb[tbi];
+else {
+    tset = &ptlb[((vpn ^ tlb_phash) & tlb_smask) * tlb_ways];
+    tag = vpn | tlb_ptag;
+    }
+for (w = 0; w < (tlb_ways - 1); w++) {                  /* find victim */
+    if (tset[w].tag == tag)
+        break;
+    }
+for ( ; w > 0; w--)                                     /* age others */
+    tset[w] = tset[w - 1];
+tset[0].tag = tag;
+tset[0].pte = pte;
+return xpte;
 }
 
 /* Utility routines */
@@ -219,28 +308,116 @@ d_p1lr = (P1LR << 2) + 0x800000;                        /* VA<30> >> 7 */
 d_slr = (SLR << 2) + 0x1000000;                         /* VA<31> >> 7 */
 }
 
-/* Zap process (0) or whole (1) tb */
+/* Invalidate entries in a TB; ptag < 0 invalidates all entries,
+   otherwise only process entries with the specified tag */
+
+static void tlb_inval (TLBENT *tbp, int32 ptag)
+{
+uint32 i, lnt = (tlb_smask + 1) * tlb_ways;
+
+for (i = 0; i < lnt; i++) {
+    if ((ptag < 0) ||
+        ((tbp[i].tag != -1) && ((tbp[i].tag & ~VA_M_VPN) == ptag)))
+        tbp[i].tag = tbp[i].pte = -1;
+    }
+}
+
+/* Zap process (0) or whole (1) tb
+
+   With process tagging, zapping the process TB only discards the
+   entries of the current process; other processes' entries are left
+   alone.  The current process's identity is refreshed, since the
+   page table base registers may have been changed.
+*/
 
 void zap_tb (int stb)
 {
-size_t i;
+FLUSH_IPAGE;
+tlb_flushes = tlb_flushes + 1;
+if (stb) {
+    tlb_inval (stlb, -1);
+    tlb_inval (ptlb, -1);
+    memset (tlb_ctx, 0, sizeof (tlb_ctx));
+    tlb_cur_ctx = 0;
+    tlb_ptag = 0;
+    tlb_phash = 0;
+    }
+else {
+    tlb_inval (ptlb, tlb_ctx_tag ? tlb_ptag : -1);
+    if (tlb_cur_ctx) {
+        tlb_ctx[tlb_cur_ctx].p0br = P0BR;
+        tlb_ctx[tlb_cur_ctx].p1br = P1BR;
+        }
+    }
+}
+
+/* Switch process context (LDPCTX)
+
+   Without process tagging, this is equivalent to zapping the process
+   TB.  Otherwise, the tag of a recently loaded context with the same
+   identity is reused, preserving its TB entries, or the least recently
+   used tag is recycled.
+*/
+
+void zap_tb_ctx (void)
+{
+int32 i, ctx;
 
-for (i = 0; i < VA_TBSIZE; i++) {
-    ptlb[i].tag = ptlb[i].pte = -1;
-    if (stb)
-        stlb[i].tag = stlb[i].pte = -1;
+FLUSH_IPAGE;
+if (!tlb_ctx_tag) {
+    zap_tb (0);
+    return;
     }
+tlb_ctx_clock = tlb_ctx_clock + 1;
+for (i = 1, ctx = 1; i <= TLB_N_CTX; i++) {
+    if ((tlb_ctx[i].used != 0) &&
+        (tlb_ctx[i].pcbb == PCBB) &&
+        (tlb_ctx[i].p0br == P0BR) &&
+        (tlb_ctx[i].p1br == P1BR))
+        break;
+    if (tlb_ctx[i].used < tlb_ctx[ctx].used)            /* track LRU */
+        ctx = i;
+    }
+if (i <= TLB_N_CTX) {                                   /* known context? */
+    ctx = i;
+    tlb_ctx_hits = tlb_ctx_hits + 1;
+    }
+else {                                                  /* recycle LRU tag */
+    tlb_ctx_misses = tlb_ctx_misses + 1;
+    tlb_flushes = tlb_flushes + 1;
+    tlb_inval (ptlb, ctx << TLB_V_CTX);
+    tlb_ctx[ctx].pcbb = PCBB;
+    tlb_ctx[ctx].p0br = P0BR;
+    tlb_ctx[ctx].p1br = P1BR;
+    }
+tlb_ctx[ctx].used = tlb_ctx_clock;
+tlb_cur_ctx = ctx;
+tlb_ptag = ctx << TLB_V_CTX;
+tlb_phash = ((uint32) ctx * 0x9E5) & tlb_smask;
 }
 
 /* Zap single tb entry corresponding to va */
 
 void zap_tb_ent (uint32 va)
 {
-int32 tbi = VA_GETTBI (VA_GETVPN (va));
-
-if (va & VA_S0)
-    stlb[tbi].tag = stlb[tbi].pte = -1;
-else ptlb[tbi].tag = ptlb[tbi].pte = -1;
+int32 vpn = VA_GETVPN (va);
+TLBENT *tset;
+int32 tag;
+uint32 w;
+
+FLUSH_IPAGE;
+if (va & VA_S0) {
+    tset = &stlb[(vpn & tlb_smask) * tlb_ways];
+    tag = vpn;
+    }
+else {
+    tset = &ptlb[((vpn ^ tlb_phash) & tlb_smask) * tlb_ways];
+    tag = vpn | tlb_ptag;
+    }
+for (w = 0; w < tlb_ways; w++) {
+    if (tset[w].tag == tag)
+        tset[w].tag = tset[w].pte = -1;
+    }
 }
 
 /* Check for tlb entry corresponding to va */
@@ -248,15 +425,109 @@ else ptlb[tbi].tag = ptlb[tbi].pte = -1;
 t_bool chk_tb_ent (uint32 va)
 {
 int32 vpn = VA_GETVPN (va);
-int32 tbi = VA_GETTBI (vpn);
 TLBENT xpte;
 
-xpte = (va & VA_S0)? stlb[tbi]: ptlb[tbi];
+xpte = tlb_lookup (va, vpn);
 if (xpte.tag == vpn)
     return TRUE;
 return FALSE;
 }
 
+/* Set translation buffer geometry: TLB=entries{:ways} */
+
+t_stat cpu_set_tlb (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+char gbuf[CBUFSIZE];
+uint32 lnt, ways = 1;
+TLBENT *ns, *np;
+t_stat r;
+
+if (cptr == NULL)
+    return SCPE_ARG;
+cptr = get_glyph (cptr, gbuf, ':');
+lnt = (uint32) get_uint (gbuf, 10, 1u << 16, &r);
+if ((r != SCPE_OK) || (lnt < 256) || (lnt & (lnt - 1)))
+    return sim_messagef (SCPE_ARG, "TLB size must be a power of 2 from 256 to 65536: %s\n", gbuf);
+if (*cptr) {
+    ways = (uint32) get_uint (cptr, 10, 8, &r);
+    if ((r != SCPE_OK) || (ways == 0) || (ways & (ways - 1)))
+        return sim_messagef (SCPE_ARG, "TLB associativity must be 1, 2, 4 or 8: %s\n", cptr);
+    }
+if (lnt == VA_TBSIZE) {                                 /* default size? */
+    ns = stlb_dflt;
+    np = ptlb_dflt;
+    }
+else {
+    ns = (TLBENT *) calloc (lnt, sizeof (TLBENT));
+    np = (TLBENT *) calloc (lnt, sizeof (TLBENT));
+    if ((ns == NULL) || (np == NULL)) {
+        free (ns);
+        free (np);
+        return SCPE_MEM;
+        }
+    }
+if (stlb != stlb_dflt) {
+    free (stlb);
+    free (ptlb);
+    }
+stlb = ns;
+ptlb = np;
+tlb_ways = ways;
+tlb_smask = (lnt / ways) - 1;
+tlb_unit[0].capac = tlb_unit[1].capac = lnt * 2;
+zap_tb (1);
+return SCPE_OK;
+}
+
+t_stat cpu_show_tlb (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+fprintf (st, "TLB=%u", (tlb_smask + 1) * tlb_ways);
+if (tlb_ways > 1)
+    fprintf (st, ":%u", tlb_ways);
+if (tlb_ctx_tag)
+    fprintf (st, " process tagged");
+return SCPE_OK;
+}
+
+/* Enable/disable process tagging */
+
+t_stat cpu_set_tlbctx (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+if (cptr)
+    return SCPE_ARG;
+tlb_ctx_tag = (val != 0);
+zap_tb (1);
+return SCPE_OK;
+}
+
+/* Show/clear translation buffer statistics */
+
+t_stat cpu_set_tlbstats (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+if (cptr)
+    return SCPE_ARG;
+tlb_hits = tlb_misses = tlb_flushes = 0;
+tlb_ctx_hits = tlb_ctx_misses = 0;
+return SCPE_OK;
+}
+
+t_stat cpu_show_tlbstats (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+fprintf (st, "TLB statistics:\n");
+fprintf (st, "  Misses/fills:     %s\n", sim_fmt_numeric ((double)tlb_misses));
+#if defined (VAX_TLB_STATS)                             /* hits only counted then */
+fprintf (st, "  Hits:             %s\n", sim_fmt_numeric ((double)tlb_hits));
+if ((tlb_hits + tlb_misses) > 0)
+    fprintf (st, "  Hit rate:         %.2f%%\n", (100.0 * (double)tlb_hits) / (double)(tlb_hits + tlb_misses));
+#endif
+fprintf (st, "  Flushes:          %s\n", sim_fmt_numeric ((double)tlb_flushes));
+if (tlb_ctx_tag) {
+    fprintf (st, "  Context reuses:   %s\n", sim_fmt_numeric ((double)tlb_ctx_hits));
+    fprintf (st, "  Context recycles: %s\n", sim_fmt_numeric ((double)tlb_ctx_misses));
+    }
+return SCPE_OK;
+}
+
 /* TLB examine */
 
 t_stat tlb_ex (t_value *vptr, t_addr addr, UNIT *uptr, int32 sw)
@@ -264,7 +535,7 @@ t_stat tlb_ex (t_value *vptr, t_addr addr, UNIT *uptr, int32 sw)
 int32 tlbn = uptr - tlb_unit;
 uint32 idx = (uint32) addr >> 1;
 
-if (idx >= VA_TBSIZE)
+if (idx >= ((tlb_smask + 1) * tlb_ways))
     return SCPE_NXM;
 if (addr & 1)
     *vptr = ((uint32) (tlbn? stlb[idx].pte: ptlb[idx].pte));
@@ -279,8 +550,9 @@ t_stat tlb_dep (t_value val, t_addr addr, UNIT *uptr, int32 sw)
 int32 tlbn = uptr - tlb_unit;
 uint32 idx = (uint32) addr >> 1;
 
-if (idx >= VA_TBSIZE)
+if (idx >= ((tlb_smask + 1) * tlb_ways))
     return SCPE_NXM;
+FLUSH_IPAGE;
 if (addr & 1) {
     if (tlbn) stlb[idx].pte = (int32) val;
     else ptlb[idx].pte = (int32) val;
@@ -296,10 +568,13 @@ return SCPE_OK;
 
 t_stat tlb_reset (DEVICE *dptr)
 {
-size_t i;
-
-for (i = 0; i < VA_TBSIZE; i++)
-    stlb[i].tag = ptlb[i].tag = stlb[i].pte = ptlb[i].pte = -1;
+FLUSH_IPAGE;
+tlb_inval (stlb, -1);
+tlb_inval (ptlb, -1);
+memset (tlb_ctx, 0, sizeof (tlb_ctx));
+tlb_cur_ctx = 0;
+tlb_ptag = 0;
+tlb_phash = 0;
 return SCPE_OK;
 }
 
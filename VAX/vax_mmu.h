@@ -42,6 +42,7 @@
         ReadB(W)        -       read aligned physical byte (word)
         WriteB(W)       -       write aligned physical byte (word)
         Test            -       test acccess
+        MemPtr          -       host pointer to virtual byte
 
 */
 
@@ -62,7 +63,18 @@ extern DEVICE cpu_dev;
 extern int32 mapen;                                     /* map enable */
 
 extern int32 mchk_va, mchk_ref;                         /* for mcheck */
-extern TLBENT stlb[VA_TBSIZE], ptlb[VA_TBSIZE];
+extern TLBENT *stlb, *ptlb;
+extern uint32 tlb_smask;                                /* TB set index mask */
+extern uint32 tlb_ways;                                 /* TB associativity */
+extern int32 tlb_ptag;                                  /* process TB tag */
+extern uint32 tlb_phash;                                /* process TB set hash */
+extern t_uint64 tlb_hits;                               /* TB hit count */
+
+#if defined (VAX_TLB_STATS)                             /* count hits, a store per reference */
+#define TLB_HIT         tlb_hits = tlb_hits + 1
+#else
+#define TLB_HIT
+#endif
 
 static const int32 insert[4] = {
     0x00000000, 0x000000FF, 0x0000FFFF, 0x00FFFFFF
@@ -70,6 +82,7 @@ static const int32 insert[4] = {
 
 extern void zap_tb (int stb);
 extern void zap_tb_ent (uint32 va);
+extern void zap_tb_ctx (void);
 extern t_bool chk_tb_ent (uint32 va);
 extern void set_map_reg (void);
 extern int32 ReadIO (uint32 pa, int32 lnt);
@@ -77,8 +90,11 @@ extern void WriteIO (uint32 pa, int32 val, int32 lnt);
 extern int32 ReadReg (uint32 pa, int32 lnt);
 extern void WriteReg (uint32 pa, int32 val, int32 lnt);
 extern TLBENT fill (uint32 va, int32 lnt, int32 acc, int32 *stat);
+extern void watch_test (uint32 va, int32 lnt, int32 acc);
 static SIM_INLINE int32 ReadU (uint32 pa, int32 lnt);
 static SIM_INLINE void WriteU (uint32 pa, int32 val, int32 lnt);
+static SIM_INLINE int32 ReadMU (uint32 pa, int32 lnt);
+static SIM_INLINE void WriteMU (uint32 pa, int32 val, int32 lnt);
 static SIM_INLINE int32 ReadB (uint32 pa);
 static SIM_INLINE int32 ReadW (uint32 pa);
 static SIM_INLINE int32 ReadL (uint32 pa);
@@ -87,6 +103,55 @@ static SIM_INLINE void WriteB (uint32 pa, int32 val);
 static SIM_INLINE void WriteW (uint32 pa, int32 val);
 static SIM_INLINE void WriteL (uint32 pa, int32 val);
 
+/* Translation buffer lookup
+
+   The system and process translation buffers are each organized as
+   tlb_smask + 1 sets of tlb_ways entries, most recently used first.
+   Process entries are tagged with the current process tag (zero unless
+   process tagging is enabled), and the set index is hashed with it, so
+   entries of other recently active processes can survive LDPCTX.
+
+   A hit returns a copy of the entry, with the tag stripped to the vpn.
+   A miss returns an entry with no access rights, which forces a fill.
+*/
+
+static SIM_INLINE TLBENT tlb_lookup (uint32 va, int32 vpn)
+{
+TLBENT *tset;
+TLBENT xpte;
+int32 tag;
+uint32 w;
+
+if (va & VA_S0) {                                       /* system space? */
+    tset = &stlb[(vpn & tlb_smask) * tlb_ways];
+    tag = vpn;
+    }
+else {
+    tset = &ptlb[((vpn ^ tlb_phash) & tlb_smask) * tlb_ways];
+    tag = vpn | tlb_ptag;
+    }
+xpte.tag = vpn;
+if (tset[0].tag == tag) {                               /* MRU hit? */
+    TLB_HIT;
+    xpte.pte = tset[0].pte;
+    return xpte;
+    }
+for (w = 1; w < tlb_ways; w++) {
+    if (tset[w].tag == tag) {                           /* hit? */
+        xpte.pte = tset[w].pte;
+        for ( ; w > 0; w--)                             /* move to front */
+            tset[w] = tset[w - 1];
+        tset[0].tag = tag;
+        tset[0].pte = xpte.pte;
+        TLB_HIT;
+        return xpte;
+        }
+    }
+xpte.tag = -1;                                          /* miss */
+xpte.pte = 0;
+return xpte;
+}
+
 /* Read and write virtual
 
    These routines logically fall into three phases:
@@ -96,7 +161,9 @@ static SIM_INLINE void WriteL (uint32 pa, int32 val);
         tlb entries have access = 0 and thus always mismatch).  The
         fill routine handles all errors.  If the resulting physical
         address is aligned, do an aligned physical read or write.
-   2.   Test for unaligned across page boundaries.  If cross page, look
+   2.   Test for unaligned across page boundaries.  If not cross page
+        and the reference lies entirely in memory, do it directly with
+        a single unaligned memory read or write.  If cross page, look
         up the physical address of the second page.  If not cross page,
         the second physical address is the same as the first.
    3.   Using the two physical addresses, do an unaligned read or
@@ -118,7 +185,7 @@ static SIM_INLINE void WriteL (uint32 pa, int32 val);
 
 static SIM_INLINE int32 Read (uint32 va, int32 lnt, int32 acc)
 {
-int32 vpn, off, tbi, pa;
+int32 vpn, off, pa;
 int32 pa1, bo, sc, wl, wh;
 TLBENT xpte;
 
@@ -126,8 +193,7 @@ mchk_va = va;
 if (mapen) {                                            /* mapping on? */
     vpn = VA_GETVPN (va);                               /* get vpn, offset */
     off = VA_GETOFF (va);
-    tbi = VA_GETTBI (vpn);
-    xpte = (va & VA_S0)? stlb[tbi]: ptlb[tbi];          /* access tlb */
+    xpte = tlb_lookup (va, vpn);                        /* access tlb */
     if (((xpte.pte & acc) == 0) || (xpte.tag != vpn) ||
         ((acc & TLB_WACC) && ((xpte.pte & TLB_M) == 0)))
         xpte = fill (va, lnt, acc, NULL);               /* fill if needed */
@@ -136,6 +202,8 @@ if (mapen) {                                            /* mapping on? */
 else {
     pa = va & PAMASK;
     off = 0;
+    if (sim_brk_summ & sim_brk_watch_types)             /* watchpoints? */
+        watch_test (va, lnt, acc);
     }
 if ((pa & (lnt - 1)) == 0) {                            /* aligned? */
     if (lnt >= L_LONG)                                  /* long, quad? */
@@ -144,17 +212,19 @@ if ((pa & (lnt - 1)) == 0) {                            /* aligned? */
         return ReadW (pa);
     return ReadB (pa);                                  /* byte */
     }
-if (mapen && ((uint32)(off + lnt) > VA_PAGSIZE)) {      /* cross page? */
+if (!mapen || ((uint32)(off + lnt) <= VA_PAGSIZE)) {    /* within page? */
+    if (ADDR_IS_MEM (pa + lnt - 1))                     /* all memory? */
+        return ReadMU (pa, lnt);
+    pa1 = ((pa + 4) & PAMASK) & ~03;                    /* not cross page */
+    }
+else {                                                  /* cross page */
     vpn = VA_GETVPN (va + lnt);                         /* vpn 2nd page */
-    tbi = VA_GETTBI (vpn);
-    xpte = (va & VA_S0)? stlb[tbi]: ptlb[tbi];          /* access tlb */
+    xpte = tlb_lookup (va, vpn);                        /* access tlb */
     if (((xpte.pte & acc) == 0) || (xpte.tag != vpn) ||
         ((acc & TLB_WACC) && ((xpte.pte & TLB_M) == 0)))
         xpte = fill (va + lnt, lnt, acc, NULL);         /* fill if needed */
     pa1 = ((xpte.pte & TLB_PFN) | VA_GETOFF (va + 4)) & ~03;
     }
-else
-    pa1 = ((pa + 4) & PAMASK) & ~03;                   /* not cross page */
 bo = pa & 3;
 if (lnt >= L_LONG) {                                    /* lw unaligned? */
     sc = bo << 3;
@@ -184,7 +254,7 @@ else {
 
 static SIM_INLINE void Write (uint32 va, int32 val, int32 lnt, int32 acc)
 {
-int32 vpn, off, tbi, pa;
+int32 vpn, off, pa;
 int32 pa1, bo, sc;
 TLBENT xpte;
 
@@ -192,8 +262,7 @@ mchk_va = va;
 if (mapen) {
     vpn = VA_GETVPN (va);
     off = VA_GETOFF (va);
-    tbi = VA_GETTBI (vpn);
-    xpte = (va & VA_S0)? stlb[tbi]: ptlb[tbi];          /* access tlb */
+    xpte = tlb_lookup (va, vpn);                        /* access tlb */
     if (((xpte.pte & acc) == 0) || (xpte.tag != vpn) ||
         ((xpte.pte & TLB_M) == 0))
         xpte = fill (va, lnt, acc, NULL);
@@ -202,6 +271,8 @@ if (mapen) {
 else {
     pa = va & PAMASK;
     off = 0;
+    if (sim_brk_summ & sim_brk_watch_types)             /* watchpoints? */
+        watch_test (va, lnt, acc);
     }
 if ((pa & (lnt - 1)) == 0) {                            /* aligned? */
     if (lnt >= L_LONG)                                  /* long, quad? */
@@ -214,17 +285,21 @@ if ((pa & (lnt - 1)) == 0) {                            /* aligned? */
         }
     return;
     }
-if (mapen && ((uint32)(off + lnt) > VA_PAGSIZE)) {
+if (!mapen || ((uint32)(off + lnt) <= VA_PAGSIZE)) {    /* within page? */
+    if (ADDR_IS_MEM (pa + lnt - 1)) {                   /* all memory? */
+        WriteMU (pa, val, lnt);
+        return;
+        }
+    pa1 = ((pa + 4) & PAMASK) & ~03;
+    }
+else {                                                  /* cross page */
     vpn = VA_GETVPN (va + 4);
-    tbi = VA_GETTBI (vpn);
-    xpte = (va & VA_S0)? stlb[tbi]: ptlb[tbi];          /* access tlb */
+    xpte = tlb_lookup (va, vpn);                        /* access tlb */
     if (((xpte.pte & acc) == 0) || (xpte.tag != vpn) ||
         ((xpte.pte & TLB_M) == 0))
         xpte = fill (va + lnt, lnt, acc, NULL);
     pa1 = ((xpte.pte & TLB_PFN) | VA_GETOFF (va + 4)) & ~03;
     }
-else
-    pa1 = ((pa + 4) & PAMASK) & ~03;
 bo = pa & 3;
 if (lnt >= L_LONG) {
     sc = bo << 3;
@@ -244,15 +319,14 @@ return;
 
 static SIM_INLINE int32 Test (uint32 va, int32 acc, int32 *status)
 {
-int32 vpn, off, tbi;
+int32 vpn, off;
 TLBENT xpte;
 
 *status = PR_OK;                                        /* assume ok */
 if (mapen) {                                            /* mapping on? */
     vpn = VA_GETVPN (va);                               /* get vpn, off */
     off = VA_GETOFF (va);
-    tbi = VA_GETTBI (vpn);
-    xpte = (va & VA_S0)? stlb[tbi]: ptlb[tbi];          /* access tlb */
+    xpte = tlb_lookup (va, vpn);                        /* access tlb */
     if ((xpte.pte & acc) && (xpte.tag == vpn))          /* TB hit, acc ok? */ 
         return (xpte.pte & TLB_PFN) | off;
     xpte = fill (va, L_BYTE, acc, status);              /* fill TB */
@@ -264,6 +338,41 @@ if (mapen) {                                            /* mapping on? */
 return va & PAMASK;                                     /* ret phys addr */
 }
 
+/* Host pointer to a virtual byte
+
+   Translates va as Read or Write would, but probes rather than faults,
+   and returns a pointer to the byte in M, with its page offset in off.
+   The rest of the page can then be accessed directly.  NULL is
+   returned if the access would fault, if the page is not all memory,
+   if the host is big endian or if watchpoints are set.
+*/
+
+static SIM_INLINE uint8 *MemPtr (uint32 va, int32 acc, uint32 *off)
+{
+int32 vpn, stat = PR_OK;
+uint32 pa;
+TLBENT xpte;
+
+if (!sim_end || (sim_brk_summ & sim_brk_watch_types))
+    return NULL;
+mchk_va = va;
+*off = VA_GETOFF (va);
+if (mapen) {                                            /* mapping on? */
+    vpn = VA_GETVPN (va);
+    xpte = tlb_lookup (va, vpn);                        /* access tlb */
+    if (((xpte.pte & acc) == 0) || (xpte.tag != vpn) ||
+        ((acc & TLB_WACC) && ((xpte.pte & TLB_M) == 0)))
+        xpte = fill (va, L_BYTE, acc, &stat);           /* probe if needed */
+    if (stat != PR_OK)                                  /* would fault? */
+        return NULL;
+    pa = (xpte.pte & TLB_PFN) | *off;
+    }
+else pa = va & PAMASK;
+if (!ADDR_IS_MEM (pa | VA_M_OFF))                       /* whole page memory? */
+    return NULL;
+return ((uint8 *) M) + pa;
+}
+
 /* Read aligned physical (in virtual context, unless indicated)
 
    Inputs:
@@ -350,6 +459,38 @@ else {
 return ((dat >> sc) & insert[lnt]);
 }
 
+/* Read unaligned memory
+
+   Inputs:
+        pa      =       physical address, unaligned, with the whole
+                        reference in memory
+        lnt     =       length code (WL)
+   Output:
+        returned data, right justified in 32b longword
+
+   On a little endian host the bytes of M are in VAX order, so a
+   longword is a single host unaligned load.  Otherwise, the two
+   longwords spanned are merged and shifted.
+*/
+
+static SIM_INLINE int32 ReadMU (uint32 pa, int32 lnt)
+{
+uint32 id = pa >> 2;
+t_uint64 dat;
+
+if (sim_end && (lnt >= L_LONG)) {
+    uint32 lw;
+
+    memcpy (&lw, ((uint8 *) M) + pa, sizeof (lw));
+    return (int32) lw;
+    }
+dat = (uint32) M[id];
+if (((pa & 3) + lnt) > 4)                               /* spans 2 lw? */
+    dat |= ((t_uint64) (uint32) M[id + 1]) << 32;
+dat = dat >> ((pa & 3) << 3);
+return (lnt >= L_LONG)? (int32) (uint32) dat: (int32) (dat & WMASK);
+}
+
 /* Write aligned physical (in virtual context, unless indicated)
 
    Inputs:
@@ -450,4 +591,35 @@ else {
 return;
 }
 
+/* Write unaligned memory
+
+   Inputs:
+        pa      =       physical address, unaligned, with the whole
+                        reference in memory
+        val     =       data to be written, right justified in 32b longword
+        lnt     =       length code (WL)
+   Output:
+        none
+*/
+
+static SIM_INLINE void WriteMU (uint32 pa, int32 val, int32 lnt)
+{
+uint32 id = pa >> 2;
+int32 sc = (pa & 3) << 3;
+t_uint64 dat, mask;
+
+if (sim_end && (lnt >= L_LONG)) {
+    uint32 lw = (uint32) val;
+
+    memcpy (((uint8 *) M) + pa, &lw, sizeof (lw));
+    return;
+    }
+mask = ((lnt >= L_LONG)? (t_uint64) LMASK: (t_uint64) WMASK) << sc;
+dat = (((t_uint64) (uint32) val) << sc) & mask;
+M[id] = (M[id] & ~((uint32) mask)) | ((uint32) dat);
+if (((pa & 3) + lnt) > 4)                               /* spans 2 lw? */
+    M[id + 1] = (M[id + 1] & ~((uint32) (mask >> 32))) | ((uint32) (dat >> 32));
+return;
+}
+
 #endif /* VAX_MMU_H_ */
@@ -68,6 +68,30 @@ typedef struct {
 #define UH_HRND         0x00004000                      /* H round */
 #define UH_V_NM         127
 
+/* Hosts with a native 128b integer type do the fraction arithmetic in
+   it.  The results are bit for bit those of the 32b code, which remains
+   for other hosts (or if DONT_USE_INT128 is defined).
+*/
+
+#if defined (__SIZEOF_INT128__) && !defined (DONT_USE_INT128)
+#define USE_INT128      1
+typedef unsigned __int128 t_uint128;
+
+static SIM_INLINE t_uint128 qp_get (const UQP *a)
+{
+return (((t_uint128) (((t_uint64) a->f3 << 32) | a->f2)) << 64) |
+    (((t_uint64) a->f1 << 32) | a->f0);
+}
+
+static SIM_INLINE void qp_put (UQP *a, t_uint128 v)
+{
+a->f0 = (uint32) v;
+a->f1 = (uint32) (v >> 32);
+a->f2 = (uint32) (v >> 64);
+a->f3 = (uint32) (v >> 96);
+}
+#endif
+
 int32 op_tsth (int32 val);
 int32 op_cmph (int32 *hf1, int32 *hf2);
 int32 op_cvtih (int32 val, int32 *hf);
@@ -721,7 +745,12 @@ return;
 
 void vax_hmul (UFPH *a, UFPH *b, uint32 mlo)
 {
+#if defined (USE_INT128)
+t_uint128 x, y, ll, lh, hl, mid;
+t_uint64 xh, xl, yh, yl;
+#else
 int32 i, c;
+#endif
 UQP accum = { 0, 0, 0, 0 };
 
 if ((a->exp == 0) || (b->exp == 0)) {                   /* zero argument? */
@@ -732,6 +761,19 @@ if ((a->exp == 0) || (b->exp == 0)) {                   /* zero argument? */
     }
 a->sign = a->sign ^ b->sign;                            /* sign of result */
 a->exp = a->exp + b->exp - H_BIAS;                      /* add exponents */
+#if defined (USE_INT128)
+x = qp_get (&a->frac);                                  /* hi 128b of product */
+y = qp_get (&b->frac);
+xh = (t_uint64) (x >> 64);
+xl = (t_uint64) x;
+yh = (t_uint64) (y >> 64);
+yl = (t_uint64) y;
+ll = (t_uint128) xl * yl;                               /* partial products */
+lh = (t_uint128) xl * yh;
+hl = (t_uint128) xh * yl;
+mid = (ll >> 64) + (t_uint64) lh + (t_uint64) hl;       /* carry into hi */
+qp_put (&accum, ((t_uint128) xh * yh) + (lh >> 64) + (hl >> 64) + (mid >> 64));
+#else
 for (i = 0; i < 128; i++) {                             /* quad precision */
     if (a->frac.f0 & 1)                                 /* mplr low? add */
         c = qp_add (&accum, &b->frac);
@@ -741,6 +783,7 @@ for (i = 0; i < 128; i++) {                             /* quad precision */
         accum.f3 = accum.f3 | UH_NM_H;
     qp_rsh (&a->frac, 1);                               /* shift mplr */
     }
+#endif
 a->frac = accum;                                        /* result */
 a->frac.f0 = a->frac.f0 & ~mlo;                         /* mask low frac */
 h_normh (a);                                            /* normalize */
@@ -803,6 +846,9 @@ void vax_hdiv (UFPH *a, UFPH *b)
 {
 int32 i;
 UQP quo = { 0, 0, 0, 0 };
+#if defined (USE_INT128)
+t_uint128 dvr, dvd, q = 0;
+#endif
 
 if (a->exp == 0)                                        /* divr = 0? */
     FLT_DZRO_FAULT;
@@ -812,6 +858,19 @@ b->sign = b->sign ^ a->sign;                            /* result sign */
 b->exp = b->exp - a->exp + H_BIAS + 1;                  /* unbiased exp */
 qp_rsh (&a->frac, 1);                                   /* allow 1 bit left */
 qp_rsh (&b->frac, 1);
+#if defined (USE_INT128)
+dvr = qp_get (&a->frac);
+dvd = qp_get (&b->frac);
+for (i = 0; i < 128; i++) {                             /* divide loop */
+    q = q << 1;                                         /* shift quo */
+    if (dvd >= dvr) {                                   /* div step ok? */
+        dvd = dvd - dvr;                                /* subtract */
+        q = q | 1;                                      /* quo bit = 1 */
+        }
+    dvd = dvd << 1;                                     /* shift divd */
+    }
+qp_put (&quo, q);
+#else
 for (i = 0; i < 128; i++) {                             /* divide loop */
     qp_lsh (&quo, 1);                                   /* shift quo */
     if (qp_cmp (&b->frac, &a->frac) >= 0) {             /* div step ok? */
@@ -820,6 +879,7 @@ for (i = 0; i < 128; i++) {                             /* divide loop */
         }
     qp_lsh (&b->frac, 1);                               /* shift divd */
     }
+#endif
 b->frac = quo;
 h_normh (b);                                            /* normalize */
 return;
@@ -829,6 +889,11 @@ return;
 
 int32 qp_cmp (UQP *a, UQP *b)
 {
+#if defined (USE_INT128)
+t_uint128 x = qp_get (a), y = qp_get (b);
+
+return (x < y)? -1: (x > y);
+#else
 if (a->f3 < b->f3)                                      /* compare hi */
     return -1;
 if (a->f3 > b->f3)
@@ -846,10 +911,17 @@ if (a->f0 < b->f0)                                      /* mid2 =, compare lo */
 if (a->f0 > b->f0)
     return +1;
 return 0;                                               /* all equal */
+#endif
 }
 
 uint32 qp_add (UQP *a, UQP *b)
 {
+#if defined (USE_INT128)
+t_uint128 x = qp_get (a), s = x + qp_get (b);
+
+qp_put (a, s);
+return (s < x);                                         /* carry out */
+#else
 uint32 cry1, cry2, cry3, cry4;
 
 a->f0 = (a->f0 + b->f0) & LMASK;                        /* add lo */
@@ -861,6 +933,7 @@ cry3 = (a->f2 < b->f2) || (cry2 && (a->f2 == b->f2));   /* carry? */
 a->f3 = (a->f3 + b->f3 + cry3) & LMASK;                 /* add hi */
 cry4 = (a->f3 < b->f3) || (cry3 && (a->f3 == b->f3));   /* carry? */
 return cry4;                                            /* return carry out */
+#endif
 }
 
 void qp_inc (UQP *a)
@@ -880,6 +953,12 @@ return;
 
 uint32 qp_sub (UQP *a, UQP *b)
 {
+#if defined (USE_INT128)
+t_uint128 x = qp_get (a), y = qp_get (b);
+
+qp_put (a, x - y);
+return (x < y);                                         /* borrow out */
+#else
 uint32 brw1, brw2, brw3, brw4;
 
 brw1 = (a->f0 < b->f0);                                 /* borrow? */
@@ -891,6 +970,7 @@ a->f2 = (a->f2 - b->f2 - brw2) & LMASK;                 /* sub mid2 */
 brw4 = (a->f3 < b->f3) || (brw3 && (a->f3 == b->f3));   /* borrow? */
 a->f3 = (a->f3 - b->f3 - brw3) & LMASK;                 /* sub high */
 return brw4;
+#endif
 }
 
 void qp_neg (UQP *a)
@@ -913,6 +993,9 @@ return;
 
 void qp_lsh (UQP *r, uint32 sc)
 {
+#if defined (USE_INT128)
+qp_put (r, (sc >= 128)? 0: (qp_get (r) << sc));
+#else
 if (sc >= 128)                                          /* > 127? result 0 */
     r->f3 = r->f2 = r->f1 = r->f0 = 0;
 else if (sc >= 96) {                                    /* [96,127]? */
@@ -947,11 +1030,15 @@ else if (sc != 0) {                                     /* [31,1]? */
     r->f1 = ((r->f1 << sc) | (r->f0 >> (32 - sc))) & LMASK;
     r->f0 = (r->f0 << sc) & LMASK;
     }
+#endif
 return;
 }
 
 void qp_rsh (UQP *r, uint32 sc)
 {
+#if defined (USE_INT128)
+qp_put (r, (sc >= 128)? 0: (qp_get (r) >> sc));
+#else
 if (sc >= 128)                                          /* > 127? result 0 */
     r->f3 = r->f2 = r->f1 = r->f0 = 0;
 else if (sc >= 96) {                                    /* [96,127]? */
@@ -986,6 +1073,7 @@ else if (sc != 0) {                                     /* [31,1]? */
     r->f2 = ((r->f2 >> sc) | (r->f3 << (32 - sc))) & LMASK;
     r->f3 = (r->f3 >> sc) & LMASK;
     }
+#endif
 return;
 }
 
@@ -458,6 +458,7 @@ int32 t;
 
 if (clk_csr & CSR_IE)
     SET_INT (CLK);
+sysd_fastboot_check ();                                 /* fast boot done? */
 t = sim_rtcn_calb (clk_tps, TMR_CLK);                   /* calibrate clock */
 sim_activate_after (&clk_unit, 1000000/clk_tps);        /* reactivate unit */
 tmr_poll = t;                                           /* set tmr poll */
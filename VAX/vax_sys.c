@@ -105,6 +105,76 @@ const char *sim_stop_messages[SCPE_BASE] = {
     "DECtape off reel"
     };
 
+/* Build a register space dispatch index for a regtable
+
+   Each table entry must start with its uint32 low and high (exclusive)
+   addresses; the table ends with a zero low address.  A table too large
+   for a byte index gets an index of zeroes, which always searches the
+   whole table.
+*/
+
+void vax_regidx_build (uint8 *idx, const void *table, size_t stride)
+{
+const uint32 *ent;
+uint32 n, cnt, pg;
+
+for (cnt = 0; ((const uint32 *)(((const uint8 *)table) + cnt * stride))[0] != 0; cnt++)
+    continue;
+memset (idx, 0, REGIDX_PAGES);
+if (cnt > 0xFF)                                         /* too big to index? */
+    return;
+memset (idx, cnt, REGIDX_PAGES);                        /* unclaimed pages */
+for (n = 0; n < cnt; n++) {
+    ent = (const uint32 *)(((const uint8 *)table) + n * stride);
+    if (ent[1] <= ent[0])                               /* empty range? */
+        continue;
+    for (pg = ent[0] >> REGIDX_V_PG; pg <= ((ent[1] - 1) >> REGIDX_V_PG); pg++)
+        idx[pg] = (uint8)((idx[pg] == cnt) ? n : 0);    /* first or shared */
+    }
+}
+
+/* Byte stream loader, shared by the models' sim_load routines
+
+   Stores the whole of the load file at origin, one byte every step
+   addresses, failing with SCPE_NXM at limit.  A run of main memory is
+   deposited in one piece; anything else is written a byte at a time
+   with wr_B, or WriteB if wr_B is NULL.
+*/
+
+t_stat vax_load_bytes (FILE *fileref, uint32 origin, uint32 limit, uint32 step, void (*wr_B)(int32 pa, int32 val))
+{
+SIM_LOAD_IMAGE image;
+size_t i = 0;
+t_stat r;
+
+r = sim_load_image_open (fileref, &image);
+if (r != SCPE_OK)
+    return r;
+if ((wr_B == NULL) && (step == 1) &&                    /* main memory? */
+    (origin < limit) && ADDR_IS_MEM (origin)) {
+    i = image.size;
+    if (i > (limit - origin))
+        i = limit - origin;
+    if (i > (MEMSIZE - origin))
+        i = MEMSIZE - origin;
+    sim_mem_load_bytes (M, sizeof (*M), origin, image.data, i);
+    origin = origin + (uint32)i;
+    }
+for ( ; i < image.size; i++) {                          /* the rest */
+    if (origin >= limit) {                              /* NXM? */
+        r = SCPE_NXM;
+        break;
+        }
+    if (wr_B)
+        wr_B (origin, image.data[i]);
+    else
+        WriteB (origin, image.data[i]);
+    origin = origin + step;
+    }
+sim_load_image_close (&image);
+return r;
+}
+
 /* Dispatch/decoder table
 
    The first entry contains:
@@ -67,6 +67,7 @@
 
 #define UNIT_V_NODELAY  (UNIT_V_UF + 0)                 /* ROM access equal to RAM access */
 #define UNIT_NODELAY    (1u << UNIT_V_NODELAY)
+#define KA_FASTBOOT_IPS 1000000                         /* rate the ROM tests presume */
 
 t_stat vax_boot (int32 flag, CONST char *ptr);
 int32 sys_model = 0;
@@ -241,6 +242,8 @@ int32 cmctl_reg[CMCTLSIZE >> 2] = { 0 };                /* CMCTL reg */
 int32 ka_cacr = 0;                                      /* KA655 cache ctl */
 int32 ka_bdr = BDR_BRKENB;                              /* KA655 boot diag */
 t_bool ka_hltenab = 1;                                  /* Halt Enable / Autoboot flag */
+t_bool ka_fastboot = 0;                                 /* fast power-up tests */
+t_bool ka_fastboot_run = FALSE;                         /* power-up ROM on virtual time */
 int32 ssc_base = SSCBASE;                               /* SSC base */
 int32 ssc_cnf = 0;                                      /* SSC conf */
 int32 ssc_bto = 0;                                      /* SSC timeout */
@@ -497,6 +500,7 @@ REG sysd_reg[] = {
     { HRDATAD (ADSK1,  ssc_adsk[1], 32, "SSC address match 1 mask") },
     { BRDATAD (CDGDAT, cdg_dat, 16, 32, CDASIZE >> 2, "cache diagnostic data store") },
     { FLDATAD (HLTENAB, ka_hltenab,  0, "KA655 Autoboot/Halt Enable") },
+    { FLDATAD (FASTBOOT, ka_fastboot, 0, "KA655 fast power-up tests") },
     { NULL }
     };
 
@@ -548,7 +552,7 @@ int32 rom_rd (int32 pa)
 int32 rg = ((pa - ROMBASE) & ROMAMASK) >> 2;
 int32 val = rom[rg];
 
-if (rom_unit.flags & UNIT_NODELAY)
+if ((rom_unit.flags & UNIT_NODELAY) || ka_fastboot_run)
     return val;
 
 return sim_rom_read_with_delay (val);
@@ -595,7 +599,7 @@ return SCPE_OK;
 t_stat rom_reset (DEVICE *dptr)
 {
 if (rom == NULL)
-    rom = (uint32 *) calloc (ROMSIZE >> 2, sizeof (uint32));
+    rom = (uint32 *) sim_mem_alloc (ROMSIZE);       /* shareable among instances */
 
 if (rom == NULL)
     return SCPE_MEM;
@@ -1011,6 +1015,8 @@ struct reglink regtable[] = {
     { 0, 0, NULL, NULL }
     };
 
+static uint8 regidx[REGIDX_PAGES];                     /* regtable dispatch index */
+
 /* ReadReg - read register space
 
    Inputs:
@@ -1024,7 +1030,7 @@ int32 ReadReg (uint32 pa, int32 lnt)
 {
 struct reglink *p;
 
-for (p = &regtable[0]; p->low != 0; p++) {
+for (p = REGIDX_FIRST (regtable, regidx, pa); p->low != 0; p++) {
     if ((pa >= p->low) && (pa < p->high) && p->read)
         return p->read (pa);
     }
@@ -1061,7 +1067,7 @@ void WriteReg (uint32 pa, int32 val, int32 lnt)
 {
 struct reglink *p;
 
-for (p = &regtable[0]; p->low != 0; p++) {
+for (p = REGIDX_FIRST (regtable, regidx, pa); p->low != 0; p++) {
     if ((pa >= p->low) && (pa < p->high) && p->write) {
         p->write (pa, val, lnt);  
         return;
@@ -1684,6 +1690,7 @@ else STK[temp] = SP;                                    /* save stack */
 if (mapen)                                              /* mapping on? */
     conpsl = conpsl | CON_MAPON;
 mapen = 0;                                              /* turn off map */
+FLUSH_IPAGE;                                            /* forget I-stream xlate */
 SP = IS;                                                /* set SP from IS */
 PSL = PSL_IS | PSL_IPL1F;                               /* PSL = 41F0000 */
 JUMP (ROMBASE);                                         /* PC = 20040000 */
@@ -1728,9 +1735,47 @@ if (*rom == 0) {                                        /* no boot? */
     }
 rom_wr_B (ROMBASE+4, sys_model ? 1 : 2);                /* Set Magic Byte to determine system type */
 sysd_powerup ();
+if (ka_fastboot)                                        /* tests on virtual time? */
+    ka_fastboot_run = sim_timer_fastboot_start (KA_FASTBOOT_IPS);
+return SCPE_OK;
+}
+
+/* Fast boot
+
+   The power-up tests are paced by the SSC interval timers, the TODR and
+   the calibrated ROM access delay, all of which presume the real KA655's
+   rate of about one instruction per microsecond.  With FASTBOOT the ROM
+   runs without the access delay and the clocks run on virtual time at
+   that rate until the ROM first transfers control to memory.  The tests
+   see the timing they expect, but finish in a fraction of the time.
+*/
+
+t_stat sysd_set_fastboot (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+ka_fastboot = val;
+if (!ka_fastboot)
+    sysd_fastboot_check ();
+return SCPE_OK;
+}
+
+t_stat sysd_show_fastboot (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+fprintf(st, "%s", ka_fastboot ? "FASTBOOT" : "NOFASTBOOT");
 return SCPE_OK;
 }
 
+/* Called on each clock tick, returns to real time once out of ROM */
+
+void sysd_fastboot_check (void)
+{
+if (!ka_fastboot_run)
+    return;
+if (ka_fastboot && ADDR_IS_ROM (fault_PC))
+    return;
+ka_fastboot_run = FALSE;
+sim_timer_fastboot_end ();
+}
+
 t_stat sysd_set_halt (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 {
 ka_hltenab = val;
@@ -1753,6 +1798,7 @@ t_stat sysd_reset (DEVICE *dptr)
 {
 int32 i;
 
+vax_regidx_build (regidx, regtable, sizeof (regtable[0]));
 if (sim_switches & SWMASK ('P')) sysd_powerup ();       /* powerup? */
 for (i = 0; i < 2; i++) {
     tmr_csr[i] = tmr_tnir[i] = tmr_tir[i] = 0;
@@ -1808,6 +1854,9 @@ fprintf (st, "command mode.  If BDR<7> is clear, the console firmware boots the
 fprintf (st, "system in response to these conditions.  This bit can be set and cleared by\n");
 fprintf (st, "the command \"SET CPU AUTOBOOT\" (clearing the flag) and \"SET CPU NOAUTOBOOT\"\n");
 fprintf (st, "setting the flag.  The default value is set.\n");
+fprintf (st, "\nThe power-up tests normally run at the speed of the real KA655.  After\n");
+fprintf (st, "\"SET CPU FASTBOOT\" they run on virtual time instead, taking a fraction of\n");
+fprintf (st, "a second, until the console firmware starts the loaded software.\n");
 return SCPE_OK;
 }
 
@@ -186,6 +186,7 @@ BITFIELD vc_ic_mode_bits[] = {
 
 #define VCMAP_VLD       0x80000000                      /* valid */
 #define VCMAP_LN        0x00000FFF                      /* buffer line */
+#define VC_BUFLINES     (VC_MEMSIZE >> 5)               /* buffer lines (32 words each) */
 
 #define VC_OFF(x,y)     ((x >> 5) | (y << 5))           /* index into framebuffer */
 #define CUR_X           (vc_curx & 0x3FF)               /* cursor X */
@@ -229,6 +230,7 @@ uint32 vc_icsr = 0;                                     /* Interrupt controller
 uint32 *vc_map;                                         /* Scanline map */
 uint32 *vc_buf = NULL;                                  /* Video memory */
 uint32 *vc_lines = NULL;                                /* Video Display Lines */
+uint32 vc_dirty[VC_BUFLINES];                           /* Written words, by buffer line */
 uint8 vc_cur[256];                                      /* Cursor image */
 uint32 vc_palette[2];                                   /* Monochrome palette */
 t_bool vc_active = FALSE;
@@ -719,13 +721,28 @@ else if (rg >= 0xFE00) {                                /* scanline map */
             }
         }
     }
-bufln = rg / 32;
-for (scrln = 0; scrln < 1024; scrln++) {
-    if ((vc_map[scrln] & 0x7FF) == bufln) {
-        vc_map[scrln] &= ~VCMAP_VLD;                    /* invalidate map */
-        }
+if (vc_buf[rg] != nval) {
+    vc_buf[rg] = nval;
+    vc_dirty[rg >> 5] |= (1u << (rg & 0x1F));           /* flag word as updated */
     }
-vc_buf[rg] = nval;
+}
+
+/* Expand one 32 pixel word of video memory to 32bpp */
+
+static SIM_INLINE void vc_expand (uint32 *pix, uint32 data)
+{
+uint32 i;
+
+for (i = 0; i < 32; i++, data >>= 1)
+    pix[i] = vc_palette[data & 1];                      /* 1bpp to 32bpp */
+}
+
+/* Screen line needs redrawing? */
+
+static SIM_INLINE t_bool vc_stale (uint32 ln)
+{
+return ((vc_map[ln] & VCMAP_VLD) == 0) ||               /* map invalid or */
+       (vc_dirty[vc_map[ln] & 0x7FF] != 0);             /* buffer line written? */
 }
 
 static SIM_INLINE void vc_invalidate (uint32 y1, uint32 y2)
@@ -872,8 +889,9 @@ t_stat vc_svc (UNIT *uptr)
 SIM_MOUSE_EVENT mev;
 SIM_KEY_EVENT kev;
 t_bool updated = FALSE;                                 /* flag for refresh */
+t_bool sw_cursor;
 uint32 lines;
-uint32 ln, col, off;
+uint32 ln, col, off, dirty;
 int32 xpos, ypos, dx, dy;
 uint8 *cur;
 
@@ -940,15 +958,22 @@ if (vid_poll_mouse (&mev) == SCPE_OK) {                 /* poll mouse */
     vs_event (&mev);                                    /* push event */
     }
 
+sw_cursor = CUR_V &&                                    /* cursor visible && need to draw cursor? */
+    (vc_input_captured || (vc_dev.dctrl & DBG_CURSOR));
 lines = 0;
 for (ln = 0; ln < VC_YSIZE; ln++) {
-    if ((vc_map[ln] & VCMAP_VLD) == 0) {                /* line invalid? */
-        off = vc_map[ln] * 32;                          /* get video buf offset */
-        for (col = 0; col < VC_XSIZE; col++)  
-            vc_lines[ln*VC_XSIZE + col] = vc_palette[(vc_buf[off + (col >> 5)] >> (col & 0x1F)) & 1];
-                                                        /* 1bpp to 32bpp */
-        if (CUR_V &&                                    /* cursor visible && need to draw cursor? */
-            (vc_input_captured || (vc_dev.dctrl & DBG_CURSOR))) {
+    if (vc_stale (ln)) {                                /* line invalid? */
+        off = (vc_map[ln] & 0x7FF) * 32;                /* get video buf offset */
+        dirty = vc_dirty[vc_map[ln] & 0x7FF];
+        if (((vc_map[ln] & VCMAP_VLD) == 0) ||          /* map invalid or */
+            (sw_cursor &&                               /* cursor drawn on this line? */
+             (ln >= CUR_Y) && (ln < (CUR_Y + 16))))
+            dirty = 0xFFFFFFFF;                         /* expand whole line */
+        for (col = 0; dirty != 0; col++, dirty >>= 1) { /* expand updated words */
+            if (dirty & 1)
+                vc_expand (&vc_lines[ln*VC_XSIZE + (col << 5)], vc_buf[off + col]);
+            }
+        if (sw_cursor) {
             if ((ln >= CUR_Y) && (ln < (CUR_Y + 16))) { /* cursor on this line? */
                 cur = &vc_cur[((ln - CUR_Y) << 4)];     /* get image base */
                 for (col = 0; col < 16; col++) {
@@ -963,7 +988,7 @@ for (ln = 0; ln < VC_YSIZE; ln++) {
             }
         vc_map[ln] |= VCMAP_VLD;                        /* set valid */
         if ((ln == (VC_YSIZE-1)) ||                     /* if end of window OR */
-            (vc_map[ln+1] & VCMAP_VLD)) {               /* next is already valid? */
+            !vc_stale (ln+1)) {                         /* next is already valid? */
             vid_draw (0, ln-lines, VC_XSIZE, lines+1, vc_lines+(ln-lines)*VC_XSIZE); /* update region */
             lines = 0;
             }
@@ -973,6 +998,8 @@ for (ln = 0; ln < VC_YSIZE; ln++) {
         }
     }
 
+memset (vc_dirty, 0, sizeof (vc_dirty));               /* all written lines now displayed */
+
 if (updated)                                            /* video updated? */
     vid_refresh ();                                     /* put to screen */
 
@@ -45,6 +45,7 @@ extern int32 tmxr_poll;
 t_stat xs_svc (UNIT *uptr);
 void xs_process_receive(CTLR* xs);
 void xs_process_transmit (CTLR* xs);
+t_stat xs_ring_read (uint32 base, uint32 rlen, uint32 idx, t_bool first, uint16 *ring, uint32 *pf, uint16 *hdr);
 void xs_dump_rxring(CTLR* xs);
 void xs_dump_txring(CTLR* xs);
 t_stat xs_init (CTLR* xs);
@@ -274,6 +275,9 @@ if ((xs->var->csr0 & (CSR0_STRT | CSR0_INIT)) == CSR0_INIT) {
     return SCPE_OK;
     }
 
+if (!(xs->var->csr0 & CSR0_STRT))                       /* stopped? (async wakeup) */
+    return SCPE_OK;
+
 if (!(xs->var->mode & MODE_DRX)) {
      /* First pump any queued packets into the system */
     if (xs->var->ReadQ.count > 0)
@@ -295,10 +299,34 @@ if (!(xs->var->mode & MODE_DRX)) {
 if (!(xs->var->mode & MODE_DTX))
     xs_process_transmit(xs);
 
+xs_updateint (xs);                                      /* one interrupt for the whole pass */
+
 sim_clock_coschedule (uptr, tmxr_poll);
 return SCPE_OK;
 }
 
+/* Fetch ring descriptor "idx" into "hdr".
+
+   The first descriptor of a pass is read on its own, since most passes
+   find it still owned by the host.  After that, the rest of the ring up
+   to the wrap point is read with a single transfer into "ring", and the
+   following descriptors of the pass come from that copy.  "pf" holds the
+   first prefetched index, or "rlen" when nothing is prefetched. */
+
+t_stat xs_ring_read (uint32 base, uint32 rlen, uint32 idx, t_bool first, uint16 *ring, uint32 *pf, uint16 *hdr)
+{
+uint32 n;
+
+if (first || (idx < *pf)) {                             /* not prefetched? */
+    n = first ? 1 : rlen - idx;
+    if (XS_READW (base + (XS_RING_ELEN * 2) * idx, (XS_RING_ELEN * 2) * n, &ring[XS_RING_ELEN * idx]))
+        return SCPE_IOERR;
+    *pf = first ? rlen : idx;
+    }
+memcpy (hdr, &ring[XS_RING_ELEN * idx], XS_RING_ELEN * sizeof (*hdr));
+return SCPE_OK;
+}
+
 /* Transfer received packets into receive ring. */
 void xs_process_receive(CTLR* xs)
 {
@@ -308,6 +336,8 @@ int slen, wlen, off = 0;
 t_stat rstatus, wstatus;
 ETH_ITEM* item = 0;
 int no_buffers = xs->var->csr0 & CSR0_MISS;
+uint16 ring[XS_RING_MAX * XS_RING_ELEN];
+uint32 pf = xs->var->rrlen, used = 0;
 
 sim_debug(DBG_TRC, xs->dev, "xs_process_receive(), buffers: %d\n", xs->var->rrlen);
 
@@ -327,7 +357,7 @@ while (xs->var->ReadQ.count > 0) {
 
     /* get next receive buffer */
     ba = xs->var->rdrb + (xs->var->relen * 2) * xs->var->rxnext;
-    rstatus = XS_READW (ba, 8, xs->var->rxhdr);
+    rstatus = xs_ring_read (xs->var->rdrb, xs->var->rrlen, xs->var->rxnext, (used++ == 0), ring, &pf, xs->var->rxhdr);
     if (rstatus) {
         /* tell host bus read failed */
         xs->var->csr0 |= CSR0_MERR;
@@ -445,8 +475,7 @@ while (xs->var->ReadQ.count > 0) {
         xs->var->csr0 |= CSR0_MISS;
         }
 
-    /* set or clear interrupt, depending on what happened */
-    xs_updateint (xs);
+    /* interrupt is raised by the caller once the pass is done */
     // xs_dump_rxring(xs); /* debug receive ring */
 }
 
@@ -455,6 +484,8 @@ void xs_process_transmit (CTLR* xs)
 uint32 segb, ba;
 int slen, wlen, off, giant, runt;
 t_stat rstatus, wstatus;
+uint16 ring[XS_RING_MAX * XS_RING_ELEN];
+uint32 pf = xs->var->trlen, used = 0;
 
 /* sim_debug(DBG_TRC, xs->dev, "xs_process_transmit()\n"); */
 
@@ -463,7 +494,7 @@ for (;;) {
 
     /* get next transmit buffer */
     ba = xs->var->tdrb + (xs->var->telen * 2) * xs->var->txnext;
-    rstatus = XS_READW (ba, 8, xs->var->txhdr);
+    rstatus = xs_ring_read (xs->var->tdrb, xs->var->trlen, xs->var->txnext, (used++ == 0), ring, &pf, xs->var->txhdr);
     if (rstatus) {
         /* tell host bus read failed */
         xs->var->csr0 |= CSR0_MERR;
@@ -518,7 +549,16 @@ for (;;) {
 
         /* are we in internal loopback mode ? */
         if ((xs->var->mode & MODE_LOOP) && (xs->var->mode & MODE_INTL)) {
-            /* just put packet in  receive buffer */
+            /* just put packet in  receive buffer, with the CRC receive expects */
+            uint8 *msg = xs->var->write_buffer.msg;
+            size_t len = xs->var->write_buffer.len;
+            uint32 crc = eth_crc32 (0, msg, len);
+
+            msg[len] = (crc >> 24) & 0xFF;
+            msg[len + 1] = (crc >> 16) & 0xFF;
+            msg[len + 2] = (crc >> 8) & 0xFF;
+            msg[len + 3] = crc & 0xFF;
+            xs->var->write_buffer.crc_len = len + 4;
             ethq_insert (&xs->var->ReadQ, 1, &xs->var->write_buffer, 0);
             sim_debug(DBG_TRC, xs->dev, "loopback packet\n");
             }
@@ -572,7 +612,7 @@ for (;;) {
         xs->var->txnext = 0;
 
     }
-xs_updateint (xs);
+/* interrupt is raised by the caller once the pass is done */
 }
 
 t_stat xs_init (CTLR* xs)
@@ -751,6 +791,10 @@ uptr->filename = tptr;
 uptr->flags |= UNIT_ATT;
 eth_setcrc(xs->var->etherface, 1); /* enable CRC */
 
+/* wake xs_svc as frames arrive when the ethernet layer can, rather than waiting for the next poll */
+if (SCPE_OK == eth_clr_async(xs->var->etherface))
+    eth_set_async(xs->var->etherface, 0);
+
 /* reset the device with the new attach info */
 xs_reset(xs->dev);
 
@@ -32,6 +32,8 @@
 
 #define XS_QUE_MAX       500                            /* message queue array */
 #define XS_FILTER_MAX    11                             /* mac + 10 multicast addrs */
+#define XS_RING_MAX      128                            /* max descriptors in a ring */
+#define XS_RING_ELEN     4                              /* words in a ring descriptor */
 
 struct xs_setup {
     int32               promiscuous;                    /* promiscuous mode enabled */
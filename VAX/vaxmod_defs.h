@@ -139,7 +139,11 @@ extern t_stat cpu_show_memory (FILE* st, UNIT* uptr, int32 val, CONST void* desc
                             { MTAB_XTD|MTAB_VDV, 0,          "AUTOBOOT",   "AUTOBOOT",                      \
                               &sysd_set_halt, &sysd_show_halt, NULL, "Enable autoboot (Disable Halt)" },    \
                             { MTAB_XTD|MTAB_VDV|MTAB_NMO, 1, "NOAUTOBOOT", "NOAUTOBOOT",                    \
-                              &sysd_set_halt, &sysd_show_halt, NULL, "Disable autoboot (Enable Halt)" },
+                              &sysd_set_halt, &sysd_show_halt, NULL, "Disable autoboot (Enable Halt)" },    \
+                            { MTAB_XTD|MTAB_VDV, 1,          "FASTBOOT",   "FASTBOOT",                      \
+                              &sysd_set_fastboot, &sysd_show_fastboot, NULL, "Run power-up tests at full speed" }, \
+                            { MTAB_XTD|MTAB_VDV|MTAB_NMO, 0, "NOFASTBOOT", "NOFASTBOOT",                    \
+                              &sysd_set_fastboot, &sysd_show_fastboot, NULL, "Run power-up tests at ROM speed" },
 
 
 /* Cache diagnostic space */
@@ -459,6 +463,9 @@ int32 Map_WriteW (uint32 ba, int32 bc, const uint16 *buf);
 
 extern t_stat sysd_set_halt (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 extern t_stat sysd_show_halt (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+extern t_stat sysd_set_fastboot (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+extern t_stat sysd_show_fastboot (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+extern void sysd_fastboot_check (void);
 
 /* Function prototypes for system-specific unaligned support */
 
@@ -1657,7 +1657,7 @@ vax_flag = 0;
 lock_flag = 0;
 trap_summ = 0;
 trap_mask = 0;
-if (M == NULL) M = (t_uint64 *) calloc (((uint32) MEMSIZE) >> 3, sizeof (t_uint64));
+if (M == NULL) M = (t_uint64 *) sim_mem_alloc ((size_t) MEMSIZE);
 if (M == NULL) return SCPE_MEM;
 pcq_r = find_reg ("PCQ", NULL, dptr);
 if (pcq_r) pcq_r->qptr = 0;
@@ -1709,17 +1709,14 @@ return SCPE_NXM;
 t_stat cpu_set_size (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 {
 t_uint64 mc = 0;
-uint32 i, clim;
+uint32 i;
 t_uint64 *nM = NULL;
 
 for (i = val; i < MEMSIZE; i = i + 8) mc = mc | M[i >> 3];
 if ((mc != 0) && !get_yn ("Really truncate memory [N]?", FALSE))
     return SCPE_OK;
-nM = (t_uint64 *) calloc (val >> 3, sizeof (t_uint64));
+nM = (t_uint64 *) sim_mem_realloc (M, (size_t) val);   /* preserves contents */
 if (nM == NULL) return SCPE_MEM;
-clim = (uint32) ((((uint32) val) < MEMSIZE)? val: MEMSIZE);
-for (i = 0; i < clim; i = i + 8) nM[i >> 3] = M[i >>3];
-free (M);
 M = nM;
 MEMSIZE = val;
 return SCPE_OK;
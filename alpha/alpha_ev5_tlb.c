@@ -51,10 +51,18 @@
 #include "alpha_defs.h"
 #include "alpha_ev5_defs.h"
 
-#define ITLB_SORT       qsort (itlb, ITLB_SIZE, sizeof (TLBENT), &tlb_comp);
-#define DTLB_SORT       qsort (dtlb, DTLB_SIZE, sizeof (TLBENT), &tlb_comp);
+#define ITLB_SORT       qsort (itlb, ITLB_SIZE, sizeof (TLBENT), &tlb_comp); \
+                        memset (itlb_hash, 0, sizeof (itlb_hash));
+#define DTLB_SORT       qsort (dtlb, DTLB_SIZE, sizeof (TLBENT), &tlb_comp); \
+                        memset (dtlb_hash, 0, sizeof (dtlb_hash));
 #define TLB_ESIZE       (sizeof (TLBENT)/sizeof (uint32))
 #define MM_RW(x)        (((x) & PTE_FOW)? EXC_W: EXC_R)
+#define TLB_HWIDTH      8                               /* hash front end */
+#define TLB_HSIZE       (1u << TLB_HWIDTH)
+#define TLB_HMASK       (TLB_HSIZE - 1)
+#define TLB_HASH(v,a)   (((v) ^ ((a) << 5)) & TLB_HMASK)
+#define TLB_MATCH(e,v,a) (((a) == (e)->asn) && \
+                        ((((v) ^ (e)->tag) & ~((uint32) (e)->gh_mask)) == 0))
 
 uint32 itlb_cm = 0;                                     /* current modes */
 uint32 itlb_spage = 0;                                  /* superpage enables */
@@ -68,6 +76,8 @@ uint32 dtlb_asn = 0;
 uint32 dtlb_nlu = 0;
 TLBENT d_mini_tlb;
 TLBENT dtlb[DTLB_SIZE];
+uint8 itlb_hash[TLB_HSIZE];                             /* vpn/asn to TLB index */
+uint8 dtlb_hash[TLB_HSIZE];
 
 uint32 cm_eacc = ACC_E (MODE_K);                        /* precomputed */
 uint32 cm_racc = ACC_R (MODE_K);                        /* access checks */
@@ -82,6 +92,8 @@ void tlb_inval (TLBENT *tlbp);
 t_stat itlb_reset (void);
 t_stat dtlb_reset (void);
 int tlb_comp (const void *e1, const void *e2);
+int32 itlb_search (uint32 vpn);
+int32 dtlb_search (uint32 vpn);
 t_stat tlb_reset (DEVICE *dptr);
 
 /* TLB data structures
@@ -239,62 +251,90 @@ if (flags & TLB_CD) {
 return;
 }
 
-/* TLB lookup */
+/* TLB lookup
+
+   The hash table remembers which sorted TLB entry last matched a vpn/asn
+   pair.  The remembered entry is rechecked, so a stale slot just falls
+   back to the binary search of the sorted TLB. */
 
 TLBENT *itlb_lookup (uint32 vpn)
 {
-int32 p, hi, lo;
+uint32 h;
+int32 p;
 
 if (vpn == i_mini_tlb.tag) return &i_mini_tlb;
+h = TLB_HASH (vpn, itlb_asn);
+p = itlb_hash[h];                                       /* hashed probe */
+if (!TLB_MATCH (&itlb[p], vpn, itlb_asn)) {             /* no match? */
+    if ((p = itlb_search (vpn)) < 0) return NULL;       /* search TLB */
+    itlb_hash[h] = (uint8) p;
+    }
+i_mini_tlb.tag = vpn;
+i_mini_tlb.pte = itlb[p].pte;
+i_mini_tlb.pfn = itlb[p].pfn;
+itlb_nlu = itlb[p].idx + 1;
+if (itlb_nlu >= ITLB_SIZE) itlb_nlu = 0;
+return &i_mini_tlb;
+}
+
+TLBENT *dtlb_lookup (uint32 vpn)
+{
+uint32 h;
+int32 p;
+
+if (vpn == d_mini_tlb.tag) return &d_mini_tlb;
+h = TLB_HASH (vpn, dtlb_asn);
+p = dtlb_hash[h];                                       /* hashed probe */
+if (!TLB_MATCH (&dtlb[p], vpn, dtlb_asn)) {             /* no match? */
+    if ((p = dtlb_search (vpn)) < 0) return NULL;       /* search TLB */
+    dtlb_hash[h] = (uint8) p;
+    }
+d_mini_tlb.tag = vpn;
+d_mini_tlb.pte = dtlb[p].pte;
+d_mini_tlb.pfn = dtlb[p].pfn;
+dtlb_nlu = dtlb[p].idx + 1;
+if (dtlb_nlu >= DTLB_SIZE) dtlb_nlu = 0;
+return &d_mini_tlb;
+}
+
+/* Binary search of sorted TLB, returns index or -1 */
+
+int32 itlb_search (uint32 vpn)
+{
+int32 p, hi, lo;
+
 lo = 0;                                                 /* initial bounds */
 hi = ITLB_SIZE - 1;
 do {
     p = (lo + hi) >> 1;                                 /* probe */
-    if ((itlb_asn == itlb[p].asn) && 
-        (((vpn ^ itlb[p].tag) &
-         ~((uint32) itlb[p].gh_mask)) == 0)) {          /* match to TLB? */
-        i_mini_tlb.tag = vpn;
-        i_mini_tlb.pte = itlb[p].pte;
-        i_mini_tlb.pfn = itlb[p].pfn;
-        itlb_nlu = itlb[p].idx + 1;
-        if (itlb_nlu >= ITLB_SIZE) itlb_nlu = 0;
-        return &i_mini_tlb;
-        }
+    if (TLB_MATCH (&itlb[p], vpn, itlb_asn))            /* match to TLB? */
+        return p;
     if ((itlb_asn < itlb[p].asn) ||
         ((itlb_asn == itlb[p].asn) && (vpn < itlb[p].tag)))
         hi = p - 1;                                     /* go down? p is upper */
     else lo = p + 1;                                    /* go up? p is lower */
     }
 while (lo <= hi);
-return NULL;
+return -1;
 }
 
-TLBENT *dtlb_lookup (uint32 vpn)
+int32 dtlb_search (uint32 vpn)
 {
 int32 p, hi, lo;
 
-if (vpn == d_mini_tlb.tag) return &d_mini_tlb;
 lo = 0;                                                 /* initial bounds */
 hi = DTLB_SIZE - 1;
 do {
     p = (lo + hi) >> 1;                                 /* probe */
-    if ((dtlb_asn == dtlb[p].asn) && 
-        (((vpn ^ dtlb[p].tag) &
-         ~((uint32) dtlb[p].gh_mask)) == 0)) {          /* match to TLB? */
-        d_mini_tlb.tag = vpn;
-        d_mini_tlb.pte = dtlb[p].pte;
-        d_mini_tlb.pfn = dtlb[p].pfn;
-        dtlb_nlu = dtlb[p].idx + 1;
-        if (dtlb_nlu >= DTLB_SIZE) dtlb_nlu = 0;
-        return &d_mini_tlb;
-        }
+    if (TLB_MATCH (&dtlb[p], vpn, dtlb_asn))            /* match to TLB? */
+        return p;
     if ((dtlb_asn < dtlb[p].asn) ||
         ((dtlb_asn == dtlb[p].asn) && (vpn < dtlb[p].tag)))
         hi = p - 1;                                     /* go down? p is upper */
     else lo = p + 1;                                    /* go up? p is lower */
     }
 while (lo <= hi);
-return NULL;
+return -1;
 }
 
 /* Load TLB entry at NLU pointer, advance NLU pointer */
@@ -500,6 +540,7 @@ for (i = 0; i < ITLB_SIZE; i++) {
     itlb[i].idx = i;
     }
 tlb_inval (&i_mini_tlb);
+memset (itlb_hash, 0, sizeof (itlb_hash));
 return SCPE_OK;
 }
 /* DTLB reset */
@@ -518,6 +559,7 @@ for (i = 0; i < DTLB_SIZE; i++) {
     dtlb[i].idx = i;
     }
 tlb_inval (&d_mini_tlb);
+memset (dtlb_hash, 0, sizeof (dtlb_hash));
 return SCPE_OK;
 }
 
@@ -824,7 +824,7 @@ xline (int x, int y, int x2, int dx, int dy, int level)
 
     ay = dy/2;
     for (;;) {
-        display_point (x, y, level, 0);
+        intensify (x, y, level, 0);
         if (x == x2)
             break;
         if (ay > 0) {
@@ -848,7 +848,7 @@ yline (int x, int y, int y2, int dx, int dy, int level)
 
     ax = dx/2;
     for (;;) {
-        display_point (x, y, level, 0);
+        intensify (x, y, level, 0);
         if (y == y2)
             break;
         if (ax > 0) {
@@ -867,8 +867,35 @@ display_line(int x1,        /* 0..xpixels (unscaled) */
           int y2,           /* 0..ypixels (unscaled) */
           int level)        /* DISPLAY_INT_xxx */
 {
-    int dx = x2 - x1;
-    int dy = y2 - y1;
+    int dx, dy;
+
+    if (!initialized && !display_init(DISPLAY_TYPE, PIX_SCALE, NULL))
+        return;
+
+    /*
+     * scale the end points once and step in displayed pixels
+     * so each lit pixel is intensified only once
+     */
+    if (scale > 1) {
+        if (scale == 2) {
+            x1 >>= 1;
+            y1 >>= 1;
+            x2 >>= 1;
+            y2 >>= 1;
+            }
+        else {
+            x1 /= scale;
+            y1 /= scale;
+            x2 /= scale;
+            y2 /= scale;
+            }
+        }
+
+#if DISPLAY_INT_MIN > 0
+    level -= DISPLAY_INT_MIN;       /* make zero based */
+#endif
+    dx = x2 - x1;
+    dy = y2 - y1;
     if (ABS (dx) > ABS(dy))
         xline (x1, y1, x2, dx, dy, level);
     else
@@ -76,6 +76,7 @@ static uint32 *colors = NULL;
 static uint32 ncolors = 0, size_colors = 0;
 static uint32 *surface = NULL;
 static uint32 ws_palette[2];                            /* Monochrome palette */
+static int dirty_lo, dirty_hi;                          /* surface rows changed since ws_sync */
 typedef struct cursor {
     Uint8 *data;
     Uint8 *mask;
@@ -402,6 +403,8 @@ ws_init(const char *name, int xp, int yp, int colors, void *dptr)
     ws_palette[1] = vid_map_rgb (0xFF, 0xFF, 0xFF);     /* white */
     for (i=0; i<xpixels*ypixels; i++)
         surface[i] = ws_palette[0];
+    dirty_lo = 0;                       /* first sync shows everything */
+    dirty_hi = ypixels - 1;
     return ret;
 }
 
@@ -458,6 +461,10 @@ ws_display_point(int x, int y, void *color)
         return;
 
     y = ypixels - 1 - y;                /* invert y, top left origin */
+    if (y < dirty_lo)
+        dirty_lo = y;
+    if (y + pix_size - 1 > dirty_hi)
+        dirty_hi = y + pix_size - 1;
 
     if (brush == NULL)
         brush = (uint32 *)ws_color_black ();
@@ -472,10 +479,23 @@ ws_display_point(int x, int y, void *color)
         surface[y*xpixels + x] = *brush;
 }
   
+/*
+ * only the band of rows touched since the last sync is passed on
+ * (whole rows are contiguous in the surface), and nothing at all
+ * when the display hasn't changed
+ */
 void
 ws_sync(void) {
-    vid_draw (0, 0, xpixels, ypixels, surface);
+    if (dirty_lo > dirty_hi)
+        return;
+    if (dirty_lo < 0)
+        dirty_lo = 0;
+    if (dirty_hi >= ypixels)
+        dirty_hi = ypixels - 1;
+    vid_draw (0, dirty_lo, xpixels, dirty_hi - dirty_lo + 1, &surface[dirty_lo*xpixels]);
     vid_refresh ();
+    dirty_lo = ypixels;
+    dirty_hi = -1;
 }
 
 void
@@ -29,6 +29,12 @@
 /* Debug */
 #define DBG             0001
 
+/* Display instructions run per service event.  Rather than one event
+   per 2 microsecond display cycle, each event runs a batch and is
+   rescheduled for the time the batch represents.  A batch ends early
+   when the display halts or hits a breakpoint. */
+#define DP_BATCH        16
+
 static t_addr DPC;
 static t_addr DT[8];
 static uint16 SP = 0;
@@ -41,6 +47,7 @@ static uint16 BLOCK = 0;
 static uint16 MIT8K;
 static uint16 SGR;
 static uint16 SYNC = 1;
+static int32 dp_batch = DP_BATCH;
 
 /* Function declaration. */
 static uint16 dp_iot (uint16, uint16);
@@ -72,6 +79,7 @@ static REG dp_reg[] = {
   { ORDATAD (BLOCK, BLOCK, 3, "Block") },
   { ORDATAD (MIT8K, MIT8K, 1, "MIT 8K addressing") },
   { ORDATAD (SGR, SGR, 1, "Suppressed grid mode") },
+  { DRDATAD (BATCH, dp_batch, 16, "Instructions per service event"), REG_NZ + PV_LEFT },
   { NULL }
 };
 
@@ -448,29 +456,35 @@ static t_stat
 dp_svc(UNIT * uptr)
 {
   uint16 insn;
+  int32 n;
 
-  if (sim_brk_summ && sim_brk_test(DPC, SWMASK('D'))) {
-    sim_activate_abs (&dp_unit, 0);
-    return sim_messagef (SCPE_STOP, "Display processor breakpoint.\n");
-  }
-
-  sim_debug (DBG, &dp_dev, "%06o ", DPC);
-  insn = M[DPC];
-  DPC++;
-  if (MODE) {
-    sim_debug (DBG, &dp_dev, "INC ");
-    dp_inc (insn >> 8);
-    if (MODE) {
-      sim_debug (DBG, &dp_dev, ",");
-      dp_inc (insn & 0377);
+  for (n = 1; ; n++) {
+    if (sim_brk_summ && sim_brk_test(DPC, SWMASK('D'))) {
+      sim_activate_abs (&dp_unit, 0);
+      return sim_messagef (SCPE_STOP, "Display processor breakpoint.\n");
     }
-    sim_debug (DBG, &dp_dev, "\n");
-  } else
-    dp_insn (insn);
 
-  if (ON)
-    sim_activate_after (&dp_unit, 2);
+    sim_debug (DBG, &dp_dev, "%06o ", DPC);
+    insn = M[DPC];
+    DPC++;
+    if (MODE) {
+      sim_debug (DBG, &dp_dev, "INC ");
+      dp_inc (insn >> 8);
+      if (MODE) {
+        sim_debug (DBG, &dp_dev, ",");
+        dp_inc (insn & 0377);
+      }
+      sim_debug (DBG, &dp_dev, "\n");
+    } else
+      dp_insn (insn);
+
+    if (!ON)
+      return SCPE_OK;
+    if (n >= dp_batch)
+      break;
+  }
 
+  sim_activate_after (&dp_unit, 2 * n);
   return SCPE_OK;
 }
 
@@ -241,6 +241,13 @@
 #if defined(SIM_HAVE_DLOPEN)                                /* Dynamic Readline support */
 #include <dlfcn.h>
 #endif
+#if defined (HAVE_ZLIB)                                     /* compressed SAVE images */
+#include <zlib.h>
+#endif
+#if !defined (_WIN32) && !defined (VMS) && !defined (__OS2__)  /* CLONE */
+#include <sys/wait.h>
+#include <sys/utsname.h>
+#endif
 
 #ifndef MAX
 #define MAX(a,b)  (((a) >= (b)) ? (a) : (b))
@@ -268,7 +275,13 @@
 
 #define MAX_DO_NEST_LVL 20                              /* DO cmd nesting level limit */
 #define SRBSIZ          1024                            /* save/restore buffer */
+#define SRB_M_CNT       0xFFFF                          /* [V4.1] block record count */
+#define SRB_DEFLATE     0x10000                         /* [V4.1] deflated block */
+#define SRB_BASE        0x20000                         /* [V4.1] block unchanged from base file */
 #define SIM_BRK_INILNT  4096                            /* bpt tbl length */
+#define SIM_BRK_MAP_SHIFT 4                             /* log2 addresses per map bit */
+#define SIM_BRK_MAP_BITS 16384                          /* bpt address map bits (power of 2) */
+#define SIM_BRK_MAP_IDX(loc) (((uint32)((loc) >> SIM_BRK_MAP_SHIFT)) & (SIM_BRK_MAP_BITS - 1))
 #define SIM_BRK_ALLTYP  0xFFFFFFFB
 #define UPDATE_SIM_TIME                                         \
     if (1) {                                                    \
@@ -371,6 +384,75 @@ int32 sim_asynch_check;
 int32 sim_asynch_latency = 4000;      /* 4 usec interrupt latency */
 int32 sim_asynch_inst_latency = 20;   /* assume 5 mip simulator */
 
+#if defined (USE_AIO_INTRINSICS)
+/* Lock free: the whole pending list is taken with a single exchange and
+   dispatched without touching sim_asynch_lock */
+int sim_aio_update_queue (void)
+{
+int migrated = 0;
+UNIT *q, *uptr;
+ACTIVATE_API a_activate_call;
+int32 a_event_time;
+t_uint64 start_nsec;
+
+if (sim_asynch_queue == QUEUE_LIST_END)         /* List Empty? */
+    return 0;
+start_nsec = sim_host_nsec ();
+SIM_HOST_MARK_BEGIN (SIM_MARK_AIO, NULL);
+do {                                            /* Grab current queue */
+    q = AIO_QUEUE_VAL;
+    } while (q != AIO_QUEUE_SET(QUEUE_LIST_END, q));
+while (q != QUEUE_LIST_END) {                   /* List !Empty */
+    sim_debug (SIM_DBG_AIO_QUEUE, &sim_scp_dev, "Migrating Asynch event for %s after %d %s\n", sim_uname(q), q->a_event_time, sim_vm_interval_units);
+    ++migrated;
+    uptr = q;
+    q = q->a_next;
+    a_activate_call = uptr->a_activate_call;
+    a_event_time = uptr->a_event_time;
+    AIO_UNIT_RELEASE (uptr);                    /* may be requeued from here on */
+    if (a_activate_call != &sim_activate_notbefore) {
+        a_event_time -= ((sim_asynch_inst_latency+1)/2);
+        if (a_event_time < 0)
+            a_event_time = 0;
+        }
+    a_activate_call (uptr, a_event_time);
+    if (uptr->a_check_completion) {
+        sim_debug (SIM_DBG_AIO_QUEUE, &sim_scp_dev, "Calling Completion Check for asynch event on %s\n", sim_uname(uptr));
+        uptr->a_check_completion (uptr);
+        }
+    }
+SIM_HOST_MARK_END (SIM_MARK_AIO);
+sim_perf.aio_count += migrated;
+sim_perf.aio_nsec += sim_host_nsec () - start_nsec;
+return migrated;
+}
+
+void sim_aio_activate (ACTIVATE_API caller, UNIT *uptr, int32 event_time)
+{
+UNIT *q = NULL;
+
+sim_debug (SIM_DBG_AIO_QUEUE, &sim_scp_dev, "Queueing Asynch event for %s after %d %s\n", sim_uname(uptr), event_time, sim_vm_interval_units);
+if (!AIO_UNIT_CLAIM (uptr))                     /* already queued? */
+    uptr->a_activate_call = sim_activate_abs;
+else {
+    uptr->a_event_time = event_time;
+    uptr->a_activate_call = caller;
+    do {
+        q = AIO_QUEUE_VAL;
+        uptr->a_next = q;                       /* Link (still marked as on list) */
+        } while (q != AIO_QUEUE_SET(uptr, q));
+    }
+sim_asynch_check = 0;                           /* try to force check */
+if (q == QUEUE_LIST_END) {                      /* first pending event rings the doorbell */
+    pthread_mutex_lock (&sim_asynch_lock);
+    if (sim_idle_wait) {
+        sim_debug (TIMER_DBG_IDLE, &sim_timer_dev, "waking due to event on %s after %d %s\n", sim_uname(uptr), event_time, sim_vm_interval_units);
+        pthread_cond_signal (&sim_asynch_wake);
+        }
+    pthread_mutex_unlock (&sim_asynch_lock);
+    }
+}
+#else /* !USE_AIO_INTRINSICS */
 int sim_aio_update_queue (void)
 {
 int migrated = 0;
@@ -379,6 +461,9 @@ AIO_ILOCK;
 if (AIO_QUEUE_VAL != QUEUE_LIST_END) {  /* List !Empty */
     UNIT *q, *uptr;
     int32 a_event_time;
+    t_uint64 start_nsec = sim_host_nsec ();
+
+    SIM_HOST_MARK_BEGIN (SIM_MARK_AIO, NULL);
     do {                                /* Grab current queue */
         q = AIO_QUEUE_VAL;
         } while (q != AIO_QUEUE_SET(QUEUE_LIST_END, q));
@@ -403,6 +488,9 @@ if (AIO_QUEUE_VAL != QUEUE_LIST_END) {  /* List !Empty */
             }
         AIO_ILOCK;
         }
+    SIM_HOST_MARK_END (SIM_MARK_AIO);
+    sim_perf.aio_count += migrated;
+    sim_perf.aio_nsec += sim_host_nsec () - start_nsec;
     }
 AIO_IUNLOCK;
 return migrated;
@@ -431,6 +519,7 @@ if (sim_idle_wait) {
     pthread_cond_signal (&sim_asynch_wake);
     }
 }
+#endif /* USE_AIO_INTRINSICS */
 #else
 t_bool sim_asynch_enabled = FALSE;
 #endif
@@ -453,12 +542,15 @@ void (*sim_vm_sprint_addr) (char *buf, DEVICE *dptr, t_addr addr) = NULL;
 void (*sim_vm_fprint_addr) (FILE *st, DEVICE *dptr, t_addr addr) = NULL;
 t_addr (*sim_vm_parse_addr) (DEVICE *dptr, CONST char *cptr, CONST char **tptr) = NULL;
 t_value (*sim_vm_pc_value) (void) = NULL;
+const char *(*sim_vm_pc_space) (void) = NULL;
 t_bool (*sim_vm_is_subroutine_call) (t_addr **ret_addrs) = NULL;
+void (*sim_vm_watch_change) (void) = NULL;
 void (*sim_vm_reg_update) (REG *rptr, uint32 idx, t_value prev_val, t_value new_val) = NULL;
 t_bool (*sim_vm_fprint_stopped) (FILE *st, t_stat reason) = NULL;
 const char *sim_vm_release = NULL;
 const char *sim_vm_release_message = NULL;
 const char **sim_clock_precalibrate_commands = NULL;
+BENCHTAB *sim_vm_benchmarks = NULL;
 
 
 /* Prototypes */
@@ -475,6 +567,7 @@ t_stat show_cmd_fi (FILE *ofile, int32 flag, CONST char *cptr);
 t_stat show_config (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_queue (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_time (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
+t_stat show_startup (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_mod_names (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_show_commands (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_log_names (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
@@ -483,6 +576,7 @@ t_stat show_dev_debug (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST cha
 t_stat show_dev_logicals (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_dev_modifiers (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_dev_show_commands (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
+t_stat show_dev_statistics (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_version (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_default (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_break (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
@@ -531,6 +625,8 @@ void fprint_stopped (FILE *st, t_stat r);
 void fprint_capac (FILE *st, DEVICE *dptr, UNIT *uptr);
 void fprint_sep (FILE *st, int32 *tokens);
 REG *find_reg_glob (CONST char *ptr, CONST char **optr, DEVICE **gdptr);
+static void sim_name_invalidate (void);
+static CONST char *find_reg_name_end (CONST char *cptr);
 REG *find_reg_glob_reason (CONST char *cptr, CONST char **optr, DEVICE **gdptr, t_stat *stat);
 const char *sim_eval_expression (const char *cptr, t_svalue *value, t_bool parens_required, t_stat *stat);
 
@@ -556,8 +652,10 @@ t_stat dep_addr (int32 flag, const char *cptr, t_addr addr, DEVICE *dptr,
 void fprint_fields (FILE *stream, t_value before, t_value after, BITFIELD* bitdefs);
 t_stat step_svc (UNIT *ptr);
 t_stat runlimit_svc (UNIT *ptr);
+t_stat profile_svc (UNIT *ptr);
 t_stat expect_svc (UNIT *ptr);
 t_stat flush_svc (UNIT *ptr);
+t_stat migrate_svc (UNIT *ptr);
 t_stat shift_args (char *do_arg[], size_t arg_count);
 t_stat set_on (int32 flag, CONST char *cptr);
 t_stat set_verify (int32 flag, CONST char *cptr);
@@ -580,6 +678,8 @@ static t_stat _sim_debug_flush (void);
 const char *sim_prog_name = NULL;                       /* pointer to the executable name */
 DEVICE *sim_dflt_dev = NULL;
 UNIT *sim_clock_queue = QUEUE_LIST_END;
+static UNIT *sim_clock_skip[SIM_QUEUE_LEVELS-1];        /* event queue skip list level heads */
+static uint32 sim_clock_skip_seed = 1;                  /* skip list level generator state */
 int32 sim_interval = 0;
 const char *sim_vm_interval_units = "instructions";     /* Simulator can change to "cycles" as needed */
 const char *sim_vm_step_unit = "instruction";           /* Simulator can change */
@@ -609,6 +709,10 @@ BRKTAB **sim_brk_tab = NULL;
 int32 sim_brk_ent = 0;
 int32 sim_brk_lnt = 0;
 int32 sim_brk_ins = 0;
+static uint32 sim_brk_map[SIM_BRK_MAP_BITS / 32];   /* addresses which may have a breakpoint */
+uint32 sim_brk_watch_types = 0;                     /* types which watch data accesses */
+uint32 sim_brk_watch_shift = 9;                     /* log2 watch page size */
+uint32 sim_brk_watch_map[SIM_BRK_WATCH_BITS / 32];  /* pages which may have a watchpoint */
 int32 sim_quiet = 0;
 int32 sim_show_message = 1;                         /* the message display status of the currently open do file */
 int32 sim_step = 0;
@@ -644,7 +748,21 @@ size_t sim_debug_buffer_offset = 0;                     /* debug memory buffer i
 size_t sim_debug_buffer_inuse = 0;                      /* debug memory buffer inuse count */
 struct timespec sim_deb_basetime;                       /* debug timestamp relative base time */
 char *sim_prompt = NULL;                                /* prompt string */
-static FILE *sim_gotofile;                              /* the currently open do file */
+typedef struct DO_SCRIPT DO_SCRIPT;
+struct DO_SCRIPT {
+    char        *path;                                  /* full path of the do file */
+    time_t      mtime;                                  /* modification time when loaded */
+    t_offset    size;                                   /* file size when loaded */
+    int32       refs;                                   /* active do levels plus cache reference */
+    int32       line_count;
+    char        **lines;                                /* file lines (line endings removed) */
+    int32       label_count;
+    char        **labels;                               /* label names (upper case) */
+    int32       *label_line;                            /* line number of each label */
+    DO_SCRIPT   *next;
+    };
+static DO_SCRIPT *sim_do_scripts = NULL;                /* loaded do files */
+static DO_SCRIPT *sim_goto_script;                      /* the currently executing do file */
 static int32 sim_goto_line[MAX_DO_NEST_LVL+1];          /* the current line number in the currently open do file */
 static int32 sim_do_echo = 0;                           /* the echo status of the currently open do file */
 static int32 sim_on_inherit = 0;                        /* the inherit status of on state and conditions when executing do files */
@@ -714,6 +832,22 @@ DEVICE sim_runlimit_dev = {
     NULL, NULL, NULL, NULL, NULL, NULL,
     sim_int_runlimit_description};
 
+static const char *sim_int_profile_description (DEVICE *dptr)
+{
+return "PC sampling profiler";
+}
+
+static t_stat sim_int_profile_reset (DEVICE *dptr);
+
+static UNIT sim_profile_unit = { UDATA (&profile_svc, 0, 0) };
+DEVICE sim_profile_dev = {
+    "INT-PROFILE", &sim_profile_unit, NULL, NULL, 
+    1, 0, 0, 0, 0, 0, 
+    NULL, NULL, &sim_int_profile_reset, NULL, NULL, NULL, 
+    NULL, DEV_NOSAVE, 0, 
+    NULL, NULL, NULL, NULL, NULL, NULL,
+    sim_int_profile_description};
+
 static const char *sim_int_expect_description (DEVICE *dptr)
 {
 return "Expect facility";
@@ -748,6 +882,20 @@ DEVICE sim_flush_dev = {
     NULL, NULL, NULL, NULL, NULL, NULL,
     sim_int_flush_description};
 
+static const char *sim_int_migrate_description (DEVICE *dptr)
+{
+return "Live migration memory pre-copy";
+}
+
+static UNIT sim_migrate_unit = { UDATA (&migrate_svc, 0, 0) };
+DEVICE sim_migrate_dev = {
+    "INT-MIGRATE", &sim_migrate_unit, NULL, NULL, 
+    1, 0, 0, 0, 0, 0, 
+    NULL, NULL, NULL, NULL, NULL, NULL, 
+    NULL, DEV_NOSAVE, 0, 
+    NULL, NULL, NULL, NULL, NULL, NULL,
+    sim_int_migrate_description};
+
 #if defined USE_INT64
 static const char *sim_si64 = "64b data";
 #else
@@ -763,6 +911,8 @@ const char *sim_savename = sim_name;      /* Simulator Name used in SAVE/RESTORE
 /* Tables and strings */
 
 const char save_vercur[] = "V4.0";
+const char save_ver41[] = "V4.1";
+const char save_migrate_base[] = "*MIGRATION*";         /* [V4.1] base is the target's memory */
 const char save_ver40[] = "V4.0";
 const char save_ver35[] = "V3.5";
 const char save_ver32[] = "V3.2";
@@ -1009,7 +1159,13 @@ static const char simh_help1[] =
       " The SAVE command (abbreviation SA) save the complete state of the simulator\n"
       " to a file.  This includes the contents of main memory and all registers,\n"
       " and the I/O connections of devices:\n\n"
-      "++SAVE <filename>\n\n"
+      "++SAVE {-C} {-I} <filename>\n\n"
+      " The -C switch deflates the memory contents in the file.\n\n"
+      " The -I switch makes an incremental save: memory blocks which have not\n"
+      " changed since the last full SAVE are not written, but refer to that\n"
+      " file, which must still be present and unchanged when the incremental\n"
+      " save is restored.  Each SAVE without -I becomes the base for later\n"
+      " incremental saves.\n\n"
 #define HLP_RESTORE     "*Commands Saving_and_Restoring_State RESTORE"
       "3RESTORE\n"
       " The RESTORE command (abbreviation REST, alternately GET) restores a\n"
@@ -1318,6 +1474,11 @@ static const char simh_help1[] =
       "++++++++                     range [31,0]\n"
       "+SET CONSOLE SPEED=speed{*factor}\n"
       "++++++++                     specify console input data rate\n"
+      "+SET CONSOLE OUTBUFFER{=size}\n"
+      "++++++++                     buffer console output (default 8192 bytes)\n"
+      "+SET CONSOLE NOOUTBUFFER     write each console output character at once\n"
+      "+SET CONSOLE OUTLATENCY=ms   maximum time output stays buffered\n"
+      "++++++++                     (default 20 ms)\n"
       "+SET CONSOLE TELNET=port     specify console telnet port\n"
       "+SET CONSOLE TELNET=LOG=log_file\n"
       "++++++++                     specify console telnet logging to the\n"
@@ -1349,6 +1510,13 @@ static const char simh_help1[] =
       "++++++++                     before automatic continue\n"
       "+SET REMOTE MASTER           enable master mode remote console\n"
       "+SET REMOTE NOMASTER         disable remote master mode console\n"
+      "+SET REMOTE METRICS=port     serve Prometheus format metrics over HTTP\n"
+      "+SET REMOTE NOMETRICS        stop serving metrics\n\n"
+      " The metrics endpoint answers GET /metrics (or /) requests with a\n"
+      " snapshot of instruction rate, idle and throttle state, multiplexer line,\n"
+      " disk unit and Ethernet device counters.  The snapshot is refreshed about\n"
+      " once a second while the simulator runs and whenever it stops.  Requests\n"
+      " are answered by a separate thread and don't delay the simulation.\n"
 #define HLP_SET_DEFAULT "*Commands SET Working_Directory"
       "3Working Directory\n"
       "+SET DEFAULT <dir>           set the current directory\n"
@@ -1408,6 +1576,14 @@ static const char simh_help1[] =
       " The size of the circular memory buffer that is used is specified on\n"
       " the SET DEBUG command line, for example:\n\n"
       "++SET DEBUG -B <sizeinMB> <debug-destination>\n\n"
+      "5-Z\n"
+      " The -Z switch records debug messages in a binary trace file rather than\n"
+      " formatting them as they happen, which lets the simulator run at close\n"
+      " to its normal speed while devices are being debugged.  The trace is\n"
+      " displayed later with the TRACE DECODE command:\n\n"
+      "++SET DEBUG -Z {-T} {-P} trace.bin\n"
+      "++TRACE DECODE trace.bin {debug.log}\n\n"
+      " Duplicate lines are not summarized in a decoded trace.\n"
 #define HLP_SET_BREAK  "*Commands SET Breakpoints"
       "3Breakpoints\n"
       "+SET BREAK <list>            set breakpoints\n"
@@ -1447,15 +1623,46 @@ static const char simh_help1[] =
 #endif
       "+SET CLOCK nocatchup         disable catchup clock ticks\n"
       "+SET CLOCK catchup           enable catchup clock ticks\n"
+#if defined (SIM_ASYNCH_IO)
+      "+SET CLOCK notickless        idle in multiples of the minimum host sleep\n"
+      "+SET CLOCK tickless          idle for exactly the time to the next event\n"
+#endif
       "+SET CLOCK calib=n%%          specify idle calibration skip %%\n"
       "+SET CLOCK calib=ALWAYS      specify calibration independent of idle\n"
+      "+SET CLOCK fastforward{=n}   run clocks on virtual time at n %C/sec\n"
+      "+SET CLOCK nofastforward     run clocks calibrated to wall clock time\n"
       "+SET CLOCK stop=n            stop execution after n %C\n\n"
       " The SET CLOCK STOP command allows execution to have a bound when\n"
-      " execution starts with a BOOT, NEXT or CONTINUE command.\n"
+      " execution starts with a BOOT, NEXT or CONTINUE command.\n\n"
+      " The SET CLOCK FASTFORWARD command decouples simulated time from the\n"
+      " host's wall clock.  Clocks tick and timed events expire purely based\n"
+      " on the count of executed %C at a fixed rate (by default the\n"
+      " simulator's nominal rate) and whenever the simulated system idles,\n"
+      " execution skips directly to the next pending event.  This allows\n"
+      " batch runs of diagnostics and test suites to complete as fast as the\n"
+      " host can execute them.  Fast forward mode disables throttling and\n"
+      " asynchronous clocks.\n"
 #define HLP_SET_ASYNCH "*Commands SET Asynch"
       "3Asynch\n"
       "+SET ASYNCH                  enable asynchronous I/O\n"
       "+SET NOASYNCH                disable asynchronous I/O\n"
+      "+SET ASYNCH CPUAFFINITY=list run instructions on host processors in list\n"
+      "+SET ASYNCH IOAFFINITY=list  run I/O threads on host processors in list\n"
+      "+SET ASYNCH TIMERAFFINITY=list run the wall clock timer thread on list\n"
+      "+SET ASYNCH AFFINITY=list    run I/O and timer threads on list\n"
+      "+SET ASYNCH CPUPRIORITY=pri  set instruction thread priority\n"
+      "+SET ASYNCH IOPRIORITY=pri   set I/O thread priority\n"
+      "+SET ASYNCH TIMERPRIORITY=pri set wall clock timer thread priority\n\n"
+      " A processor list is a comma separated list of host processor numbers\n"
+      " and ranges (for example 0-3,8), ALL, or NODEn for the processors of\n"
+      " NUMA node n.  Giving a NUMA node for CPUAFFINITY also makes that node\n"
+      " preferred for the simulator's memory and moves memory already\n"
+      " allocated, including simulated memory, to it.  A priority is BELOW,\n"
+      " NORMAL or ABOVE.  By default I/O threads run at above normal priority,\n"
+      " which lets them preempt the instruction thread; IOPRIORITY=NORMAL\n"
+      " avoids that when the I/O threads have processors of their own.\n"
+      " Several settings can be given in one command.  SHOW ASYNCH displays\n"
+      " the current placement.\n"
 #define HLP_SET_ENVIRON "*Commands SET Environment"
       "3Environment\n"
       "4Explicitily Changing a Variable\n"
@@ -1552,7 +1759,44 @@ static const char simh_help1[] =
       "++++++++                     available\n"
 #define HLP_NOAUTOSIZE  "*Commands SET NoAutosize"
       "3NoAutosize\n"
-      "+SET NOAUTOSIZE              disables disk autosizing for all disks\n";
+      "+SET NOAUTOSIZE              disables disk autosizing for all disks\n"
+#define HLP_SET_DISK    "*Commands SET Disk"
+      "3Disk\n"
+      "+SET DISK CACHE=size{K|M|G}  enables a sector cache shared by all disks\n"
+      "++++++++                     (size in megabytes by default)\n"
+      "+SET DISK NOCACHE            disables the shared sector cache\n"
+      "+SET DISK WRITEBACK          defers disk writes until flushed or replaced\n"
+      "+SET DISK WRITETHROUGH       writes to the disk file immediately (default)\n"
+      "+SET DISK COMPACT=<unit>     reclaims unused space in a SIMHZ disk container\n"
+      "+SET DISK DISCARD            releases zeroed sectors to the host (default)\n"
+      "+SET DISK NODISCARD          writes zeroed sectors to the disk file\n"
+      "+SET DISK SYNC{=msec}        commits disk writes to stable storage at most\n"
+      "++++++++                     msec milliseconds (1000 by default) after they\n"
+      "++++++++                     are made, and at once on guest flush commands\n"
+      "+SET DISK NOSYNC             leaves committing disk writes to the host\n"
+      "++++++++                     (default)\n"
+#define HLP_SET_MEMORY  "*Commands SET Memory"
+      "3Memory\n"
+      "+SET MEMORY SHARING          offers guest memory to the host's page merging\n"
+      "++++++++                     (KSM on Linux) so that identical pages of\n"
+      "++++++++                     instances running the same image are stored\n"
+      "++++++++                     once.  This saves host memory, but merged\n"
+      "++++++++                     pages are slower to write, a timing side\n"
+      "++++++++                     channel between instances, and merging\n"
+      "++++++++                     splits huge pages, slowing the simulator.\n"
+      "++++++++                     Use it only among instances which trust\n"
+      "++++++++                     each other\n"
+      "+SET MEMORY NOSHARING        keeps guest memory private, and huge pages\n"
+      "++++++++                     intact (default)\n"
+#define HLP_SET_VIDEO   "*Commands SET Video"
+      "3Video\n"
+      "+SET VIDEO FPS=n             composites video windows at most n times a\n"
+      "++++++++                     second, independent of the simulator\n"
+      "+SET VIDEO FPS=0             refreshes windows when the simulator asks\n"
+      "++++++++                     (default)\n"
+      "+SET VIDEO RECORD=file       records the video window to file as raw\n"
+      "++++++++                     ARGB8888 frames, written in the background\n"
+      "+SET VIDEO NORECORD          stops recording\n";
 static const char simh_help2[] =
       /***************** 80 character line width template *************************/
 #define HLP_SHOW        "*Commands SHOW"
@@ -1567,6 +1811,8 @@ static const char simh_help2[] =
       "+sh{ow} n{ames}              show logical names\n"
       "+sh{ow} q{ueue}              show event queue\n"
       "+sh{ow} ti{me}               show simulated time\n"
+      "+sh{ow} star{tup}            show host time spent starting the simulator\n"
+      "++++++++                     and initializing subsystems on first use\n"
       "+sh{ow} th{rottle}           show simulation rate\n"
       "+sh{ow} a{synch}             show asynchronous I/O state\n" 
       "+sh{ow} ve{rsion}            show simulator version\n"
@@ -1577,6 +1823,9 @@ static const char simh_help2[] =
       "+sh{ow} <dev> MODIFIERS      show device modifiers\n"
       "+sh{ow} <dev> NAMES          show device logical name\n"
       "+sh{ow} <dev> SHOW           show device SHOW commands\n"
+      "+sh{ow} {-C} <dev>|<unit> STATISTICS\n"
+      "++++++++                     show disk, tape and network I/O latency\n"
+      "++++++++                     (-C resets the statistics afterwards)\n"
       "+sh{ow} <dev> {arg,...}      show device parameters\n"
       "+sh{ow} <unit> {arg,...}     show unit parameters\n"
       "+sh{ow} ethernet             show ethernet devices\n"
@@ -1586,9 +1835,13 @@ static const char simh_help2[] =
       "+sh{ow} video                show video capabilities\n"
       "+sh{ow} clocks               show calibrated timer information\n"
       "+sh{ow} throttle             show throttle info\n"
+      "+sh{ow} performance          show where host time is spent\n"
+      "++++++++                     (-M machine readable, -C then clear)\n"
       "+sh{ow} on                   show on condition actions\n"
       "+sh{ow} do                   show do nesting state\n"
       "+sh{ow} runlimit             show execution limit states\n"
+      "+sh{ow} disk                 show shared disk sector cache statistics\n"
+      "+sh{ow} mem{ory} {sharing}   show host memory used and shared by guest memory\n"
       "+h{elp} <dev> show           displays the device specific show commands\n"
       "++++++++                     available\n"
 #define HLP_SHOW_CONFIG         "*Commands SHOW"
@@ -1596,6 +1849,7 @@ static const char simh_help2[] =
 #define HLP_SHOW_FEATURES       "*Commands SHOW"
 #define HLP_SHOW_QUEUE          "*Commands SHOW"
 #define HLP_SHOW_TIME           "*Commands SHOW"
+#define HLP_SHOW_STARTUP        "*Commands SHOW"
 #define HLP_SHOW_MODIFIERS      "*Commands SHOW"
 #define HLP_SHOW_NAMES          "*Commands SHOW"
 #define HLP_SHOW_SHOW           "*Commands SHOW"
@@ -1614,9 +1868,12 @@ static const char simh_help2[] =
 #define HLP_SHOW_MULTIPLEXER    "*Commands SHOW"
 #define HLP_SHOW_VIDEO          "*Commands SHOW"
 #define HLP_SHOW_CLOCKS         "*Commands SHOW"
+#define HLP_SHOW_PERFORMANCE    "*Commands SHOW"
 #define HLP_SHOW_ON             "*Commands SHOW"
 #define HLP_SHOW_DO             "*Commands SHOW"
 #define HLP_SHOW_RUNLIMIT       "*Commands SHOW"
+#define HLP_SHOW_DISK           "*Commands SHOW"
+#define HLP_SHOW_MEMORY         "*Commands SHOW"
 #define HLP_SHOW_SEND           "*Commands SHOW"
 #define HLP_SHOW_EXPECT         "*Commands SHOW"
 #define HLP_HELP                "*Commands HELP"
@@ -2451,6 +2708,103 @@ static const char simh_help2[] =
       " The exit status from the command which was executed is set as the command\n"
       " completion status for the ! command.  This may influence any enabled ON\n"
       " condition traps\n"
+#define HLP_TRACE       "*Commands Decoding_Debug_Traces"
+      "2Decoding Debug Traces\n"
+      " Debug output recorded with SET DEBUG -Z is written in a binary form\n"
+      " which the TRACE DECODE command turns into the text that ordinary\n"
+      " debug output would have contained:\n\n"
+      "++TRACE DECODE tracefile {outputfile}\n\n"
+      " The output is written to the console if no output file is given.  The\n"
+      " trace being recorded can be decoded while it is active.  Messages from\n"
+      " threads other than the simulator's are in order relative to each other,\n"
+      " but may appear a little later than the simulator's messages around\n"
+      " them.\n"
+#define HLP_CLONE       "*Commands Cloning_The_Simulator"
+      "2Cloning The Simulator\n"
+      " On hosts which support fork(), the CLONE command starts copies of the\n"
+      " simulator in its current state, each of which executes a command:\n\n"
+      "++CLONE {-W} <count> <command>\n\n"
+      " The copies (clones) share the memory of the simulator that was cloned\n"
+      " until one of them changes it, so a large configuration starts quickly\n"
+      " and many clones can run from one checkpoint.  Each clone has the\n"
+      " environment variable SIM_CLONE set to its number (1 to <count>) and\n"
+      " exits once its command completes, for instance:\n\n"
+      "++CLONE 4 DO test.sim %%%%SIM_CLONE%%%%\n\n"
+      " The command is evaluated once more in each clone, so %%%% is needed\n"
+      " for a substitution (such as SIM_CLONE) to be made there.\n\n"
+      " In each clone, attached units are adjusted so that the clones don't\n"
+      " interfere with each other.  Writes to disks go to a private copy-on-write\n"
+      " overlay, which is discarded when the clone exits.  Other attached files\n"
+      " are reopened so the clone has its own file position, though data written\n"
+      " still goes to the shared file.  Multiplexer connections stay with the\n"
+      " cloned simulator and listeners are reopened on their port plus the\n"
+      " clone number.\n\n"
+      " Asynchronous I/O threads don't survive fork(), so SET NOASYNCH is\n"
+      " required before cloning.  While clones are running, the cloned\n"
+      " simulator should not write to the disks they use.  The -W switch\n"
+      " waits for all the clones to exit and reports their exit status.\n"
+#define HLP_MIGRATE     "*Commands Migrating_The_Simulator"
+      "2Migrating The Simulator\n"
+      " The MIGRATE command moves a running simulator to another simulator of\n"
+      " the same type and configuration, usually on another host, with only a\n"
+      " short pause in execution.  The target simulator waits for it with:\n\n"
+      "++MIGRATE -L {host:}port\n\n"
+      " and the simulator being moved is then sent there with:\n\n"
+      "++MIGRATE host:port\n\n"
+      " The target accepts memory and a SAVE file (which can attach any file\n"
+      " the simulator can open) from whoever connects first, without any\n"
+      " authentication.  With only a port, it therefore listens on localhost,\n"
+      " for example for a migration through an ssh tunnel.  To accept a\n"
+      " migration from another host, give the address of the interface to\n"
+      " listen on (or 0.0.0.0 for all of them), and only do so on a trusted\n"
+      " network.\n\n"
+      " Memory is copied to the target while the simulated system continues to\n"
+      " run, with blocks changed since they were copied being sent again on\n"
+      " each pass.  When a pass finds few enough changed blocks (or after\n"
+      " several passes), execution stops and the rest of the state is sent as\n"
+      " an incremental SAVE file based on the memory the target already has.\n"
+      " The source then detaches all its units and the target restores the\n"
+      " state, attaching the same files and opening the same multiplexer and\n"
+      " network listeners, so attached files must be visible to both hosts at\n"
+      " the same path.  Network and terminal sessions are not carried over,\n"
+      " clients reconnect to the target.  Once the target has the state, the\n"
+      " source simulator exits, and execution resumes on the target with\n"
+      " CONTINUE.  If the target can't restore the state, the source restores\n"
+      " it locally and remains stopped.  Stopping the source before the copy\n"
+      " completes abandons the migration.\n"
+#define HLP_PROFILE     "*Commands Profiling_The_Simulated_Program"
+      "2Profiling The Simulated Program\n"
+      " The PROFILE command samples the PC of the simulated program while it\n"
+      " runs and reports where it spends its time:\n\n"
+      "++PROFILE START {interval}   start sampling\n"
+      "++PROFILE STOP               stop sampling\n"
+      "++PROFILE SHOW {count}       display the most frequently sampled PCs\n\n"
+      " A sample is taken on average once every 'interval' instructions (1000\n"
+      " by default).  Starting a profile discards any earlier samples.  PROFILE\n"
+      " SHOW lists the top 'count' (default 20, 0 for all) PCs with their share\n"
+      " of the samples, and the instruction at each PC.  Simulators which\n"
+      " distinguish processor modes record and display samples for each mode\n"
+      " separately.  Instructions are displayed using the memory mapping which\n"
+      " is current when PROFILE SHOW is run.\n"
+#define HLP_PERF        "*Commands Timing_Script_Phases"
+      "2Timing Script Phases\n"
+      " The PERF command times named phases of a command script, such as the\n"
+      " individual diagnostics a test script runs, so that the simulator's\n"
+      " speed can be tracked from release to release:\n\n"
+      "++PERF START name              begin timing the named phase\n"
+      "++PERF STOP                    end the current phase\n"
+      "++PERF SHOW                    display the recorded phases\n"
+      "++PERF CLEAR                   discard the recorded phases\n"
+      "++PERF SAVE file               write the phases to a baseline file\n"
+      "++PERF COMPARE file {percent}  compare the phases with a baseline\n\n"
+      " Each phase records the instructions executed, the host time spent\n"
+      " executing them and the elapsed host time, and its rate in millions\n"
+      " of instructions per second.  Starting a phase ends any phase already\n"
+      " being timed, and starting a phase again replaces its earlier results.\n"
+      " PERF COMPARE displays each phase's rate next to its baseline rate and\n"
+      " fails, as an ASSERT does, if any of them is more than 'percent' (10 by\n"
+      " default) slower than the baseline.  Phases missing from either side are\n"
+      " not compared.\n"
 #define HLP_TESTLIB     "*Commands Testing_Device_Libraries"
       "2Testing Device Libraries\n"
       " A simulator developer may need to invoke the simh internal device library\n"
@@ -2492,7 +2846,37 @@ static const char simh_help2[] =
 #define HLP_DISKINFO    "*Commands Disk_Container_Information"
       "2Disk Container Information\n"
       " Information about a Disk Container can be displayed with the DISKINFO command:\n\n"
-      "++DISKINFO container-spec    show information about a disk container\n\n";
+      "++DISKINFO container-spec    show information about a disk container\n\n"
+#define HLP_BENCHMARK   "*Commands Benchmarking_CPU_Disk_and_Tape"
+      "2Benchmarking CPU Disk and Tape\n"
+      " The host storage performance seen by an attached disk or tape unit can be\n"
+      " measured with the BENCHMARK command:\n\n"
+      "++BENCHMARK CPU {workload|ALL} {count}\n"
+      "++BENCHMARK {DISK|TAPE} unit {options}\n\n"
+      " The workload is issued through the same library routines the simulated\n"
+      " device uses, so caching, container format and asynchronous I/O settings\n"
+      " all apply.  The number of operations per second, the data rate and the\n"
+      " distribution of operation latencies are reported.  Options are:\n\n"
+      "++READ or WRITE         operation to perform (default READ)\n"
+      "++SEQUENTIAL or RANDOM  positioning (default SEQUENTIAL, disks only)\n"
+      "++SYNC or ASYNC         issue synchronous or asynchronous requests\n"
+      "++COUNT=n               number of operations (default 1000)\n"
+      "++SIZE=n                disk sectors per transfer (default 1) or tape\n"
+      "++                      record length written (default 512 bytes)\n\n"
+      " A disk WRITE benchmark rewrites each range with the data it already\n"
+      " contains.  A tape WRITE benchmark replaces the tape's contents and must be\n"
+      " confirmed with the -F switch.  A tape is left rewound after a benchmark.\n"
+      " The simulated device should be idle while a benchmark is run.\n\n"
+      " BENCHMARK CPU measures how fast the simulator executes a set of standard\n"
+      " workloads supplied by the simulated CPU.  Each workload is loaded into\n"
+      " memory and run for 'count' instructions (10,000,000 by default) with\n"
+      " throttling, idling and all device activity suspended, and the execution\n"
+      " rate is reported in millions of instructions per second.  Without a\n"
+      " workload name all of them are run and their geometric mean is displayed\n"
+      " as well.  The workloads cover an integer loop, a memory stream, string\n"
+      " or byte moves and floating point, as the CPU provides them.  BENCHMARK\n"
+      " CPU overwrites memory and registers and resets all devices, so it is\n"
+      " best run before a simulated operating system is loaded.\n\n";
 
 
 static CTAB cmd_table[] = {
@@ -2560,6 +2944,11 @@ static CTAB cmd_table[] = {
     { "NOEXPECT",   &expect_cmd,    0,          HLP_EXPECT,     NULL, NULL },
     { "SLEEP",      &sleep_cmd,     0,          HLP_SLEEP,      NULL, NULL },
     { "!",          &spawn_cmd,     0,          HLP_SPAWN,      NULL, NULL },
+    { "TRACE",      &trace_cmd,     0,          HLP_TRACE,      NULL, NULL },
+    { "CLONE",      &clone_cmd,     0,          HLP_CLONE,      NULL, NULL },
+    { "MIGRATE",    &migrate_cmd,   0,          HLP_MIGRATE,    NULL, NULL },
+    { "PROFILE",    &profile_cmd,   0,          HLP_PROFILE,    NULL, NULL },
+    { "PERF",       &sim_perf_cmd,  0,          HLP_PERF,       NULL, NULL },
     { "HELP",       &help_cmd,      0,          HLP_HELP,       NULL, NULL },
     { "SCREENSHOT", &screenshot_cmd,0,          HLP_SCREENSHOT, NULL, NULL },
     { "TAR",        &tar_cmd,       0,          HLP_TAR,        NULL, NULL },
@@ -2568,6 +2957,7 @@ static CTAB cmd_table[] = {
     { "NORUNLIMIT", &runlimit_cmd,  0,          HLP_RUNLIMIT,   NULL, NULL },
     { "TESTLIB",    &test_lib_cmd,  0,          HLP_TESTLIB,    NULL, NULL },
     { "DISKINFO",   &sim_disk_info_cmd,  0,     HLP_DISKINFO,   NULL, NULL },
+    { "BENCHMARK",  &benchmark_cmd, 0,          HLP_BENCHMARK,  NULL, NULL },
     { "ZAPTYPE",    &sim_disk_info_cmd,  1,     NULL,           NULL, NULL },
     { NULL,         NULL,           0,          NULL,           NULL, NULL }
     };
@@ -2604,6 +2994,9 @@ static CTAB set_glob_tab[] = {
     { "RUNLIMIT",   &set_runlimit,              1, HLP_RUNLIMIT },
     { "NORUNLIMIT", &set_runlimit,              0, HLP_RUNLIMIT },
     { "NOAUTOSIZE", &sim_disk_set_noautosize,   1, HLP_NOAUTOSIZE },
+    { "DISK",       &sim_disk_set_cache,        1, HLP_SET_DISK },
+    { "MEMORY",     &sim_mem_set,               1, HLP_SET_MEMORY },
+    { "VIDEO",      &vid_set_video,             1, HLP_SET_VIDEO },
     { NULL,         NULL,                       0 }
     };
 
@@ -2637,6 +3030,7 @@ static SHTAB show_glob_tab[] = {
     { "FEATURES",       &show_config,               2, HLP_SHOW_FEATURES },
     { "QUEUE",          &show_queue,                0, HLP_SHOW_QUEUE },
     { "TIME",           &show_time,                 0, HLP_SHOW_TIME },
+    { "STARTUP",        &show_startup,              0, HLP_SHOW_STARTUP },
     { "MODIFIERS",      &show_mod_names,            0, HLP_SHOW_MODIFIERS },
     { "NAMES",          &show_log_names,            0, HLP_SHOW_NAMES },
     { "SHOW",           &show_show_commands,        0, HLP_SHOW_SHOW },
@@ -2657,11 +3051,14 @@ static SHTAB show_glob_tab[] = {
     { "MUX",            &tmxr_show_open_devices,    0, HLP_SHOW_MULTIPLEXER },
     { "VIDEO",          &vid_show,                  0, HLP_SHOW_VIDEO },
     { "CLOCKS",         &sim_show_timers,           0, HLP_SHOW_CLOCKS },
+    { "PERFORMANCE",    &sim_show_performance,      0, HLP_SHOW_PERFORMANCE },
     { "SEND",           &sim_show_send,             0, HLP_SHOW_SEND },
     { "EXPECT",         &sim_show_expect,           0, HLP_SHOW_EXPECT },
     { "ON",             &show_on,                  -1, HLP_SHOW_ON },
     { "DO",             &show_do,                   0, HLP_SHOW_DO },
     { "RUNLIMIT",       &show_runlimit,             0, HLP_SHOW_RUNLIMIT },
+    { "DISK",           &sim_disk_show_cache,       0, HLP_SHOW_DISK },
+    { "MEMORY",         &sim_mem_show,              0, HLP_SHOW_MEMORY },
     { NULL,             NULL,                       0 }
     };
 
@@ -2671,11 +3068,13 @@ static SHTAB show_dev_tab[] = {
     { "MODIFIERS",  &show_dev_modifiers,        0 },
     { "NAMES",      &show_dev_logicals,         0 },
     { "SHOW",       &show_dev_show_commands,    0 },
+    { "STATISTICS", &show_dev_statistics,       0 },
     { NULL,         NULL,                       0 }
     };
 
 static SHTAB show_unit_tab[] = {
     { "DEBUG",      &show_dev_debug,            1 },
+    { "STATISTICS", &show_dev_statistics,       1 },
     { NULL, NULL, 0 }
     };
 
@@ -2709,6 +3108,76 @@ t_stat process_stdin_commands (t_stat stat, char *argv[], t_bool do_called);
 
 /* Main command loop */
 
+/* Startup timing
+
+   main records the host time taken by each step of starting the
+   simulator, and subsystems which initialize themselves on first use
+   (rather than at startup) record what that first use cost, so SHOW
+   STARTUP can show where the time to get to the first command went.
+*/
+
+#define SIM_STARTUP_MAX 32
+
+static struct {
+    const char  *phase;
+    double      secs;
+    t_bool      deferred;
+    } sim_startup[SIM_STARTUP_MAX];
+static int32 sim_startup_count = 0;
+static double sim_startup_last = 0.0;
+
+static void _sim_startup_add (const char *phase, double secs, t_bool deferred)
+{
+if (sim_startup_count >= SIM_STARTUP_MAX)
+    return;
+sim_startup[sim_startup_count].phase = phase;
+sim_startup[sim_startup_count].secs = secs;
+sim_startup[sim_startup_count].deferred = deferred;
+++sim_startup_count;
+}
+
+static void _sim_startup_mark (const char *phase)
+{
+double now = sim_timenow_double ();
+
+_sim_startup_add (phase, now - sim_startup_last, FALSE);
+sim_startup_last = now;
+}
+
+/* Record the cost of a subsystem initialized on first use, which began at 'start' */
+
+void sim_startup_record (const char *phase, double start)
+{
+_sim_startup_add (phase, sim_timenow_double () - start, TRUE);
+}
+
+t_stat show_startup (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr)
+{
+int32 i;
+double total = 0.0;
+t_bool deferred = FALSE;
+
+if (cptr && (*cptr != 0))
+    return SCPE_2MARG;
+fprintf (st, "%-40s %10s\n", "Startup step", "msecs");
+for (i = 0; i < sim_startup_count; i++) {
+    if (sim_startup[i].deferred)
+        continue;
+    fprintf (st, "  %-38s %10.3f\n", sim_startup[i].phase, 1000.0 * sim_startup[i].secs);
+    total += sim_startup[i].secs;
+    }
+fprintf (st, "  %-38s %10.3f\n", "Total", 1000.0 * total);
+for (i = 0; i < sim_startup_count; i++) {
+    if (!sim_startup[i].deferred)
+        continue;
+    if (!deferred)
+        fprintf (st, "%-40s %10s\n", "Initialized on first use", "msecs");
+    deferred = TRUE;
+    fprintf (st, "  %-38s %10.3f\n", sim_startup[i].phase, 1000.0 * sim_startup[i].secs);
+    }
+return SCPE_OK;
+}
+
 int main (int argc, char *argv[])
 {
 char cbuf[4*CBUFSIZE], *cptr, *cptr2;
@@ -2786,11 +3255,15 @@ if (*argv[0]) {                                         /* sim name arg? */
 sim_quiet = sim_switches & SWMASK ('Q');                /* -q means quiet */
 sim_on_inherit = sim_switches & SWMASK ('O');           /* -o means inherit on state */
 
+sim_startup_last = sim_timenow_double ();
 sim_init_sock ();                                       /* init socket capabilities */
+_sim_startup_mark ("Sockets");
 AIO_INIT;                                               /* init Asynch I/O */
+_sim_startup_mark ("Asynchronous I/O");
 sim_finit ();                                           /* init fio package */
 sim_disk_init ();                                       /* init disk package */
 sim_tape_init ();                                       /* init tape package */
+_sim_startup_mark ("File, disk and tape packages");
 for (i = 0; cmd_table[i].name; i++) {
     size_t alias_len = strlen (cmd_table[i].name);
     char *cmd_name = (char *)calloc (1 + alias_len, sizeof (*cmd_name));
@@ -2821,10 +3294,12 @@ sim_interval = 0;
 sim_time = sim_rtime = 0;
 noqueue_time = 0;
 sim_clock_queue = QUEUE_LIST_END;
+memset (sim_clock_skip, 0, sizeof (sim_clock_skip));
 sim_is_running = FALSE;
 sim_log = NULL;
 if (sim_emax <= 0)
     sim_emax = 1;
+_sim_startup_mark ("Command aliases");
 if (sim_timer_init ()) {
     fprintf (stderr, "Fatal timer initialization error\n");
     if (sim_ttisatty())
@@ -2837,6 +3312,9 @@ sim_register_internal_device (&sim_expect_dev);
 sim_register_internal_device (&sim_step_dev);
 sim_register_internal_device (&sim_flush_dev);
 sim_register_internal_device (&sim_runlimit_dev);
+sim_register_internal_device (&sim_profile_dev);
+sim_register_internal_device (&sim_migrate_dev);
+_sim_startup_mark ("Timers");
 
 if ((stat = sim_ttinit ()) != SCPE_OK) {
     fprintf (stderr, "Fatal terminal initialization error\n%s\n",
@@ -2855,6 +3333,7 @@ if ((sim_eval = (t_value *) calloc (sim_emax, sizeof (t_value))) == NULL) {
     };
 if (sim_dflt_dev == NULL)                               /* if no default */
     sim_dflt_dev = sim_devices[0];
+_sim_startup_mark ("Console");
 if ((stat = reset_all_p (0)) != SCPE_OK) {
     fprintf (stderr, "Fatal simulator initialization error\nDevice %s initial reset call returned: %s\n",
         sim_failed_reset_dptr->name, sim_error_text (stat));
@@ -2863,6 +3342,7 @@ if ((stat = reset_all_p (0)) != SCPE_OK) {
     sim_exit_status = EXIT_FAILURE;
     goto cleanup_and_exit;
     }
+_sim_startup_mark ("Device reset");
 if (register_check) {
     /* This test is explicitly run after the above reset_all_p() so that any devices 
        which dynamically manipulate their register lists have already done that. */
@@ -2890,14 +3370,18 @@ if ((stat = sim_brk_init ()) != SCPE_OK) {
     }
 /* always check for register definition problems */
 sim_sanity_check_register_declarations (NULL);
+_sim_startup_mark ("Breakpoints and register checks");
 
 signal (SIGINT, int_handler);
 if (!sim_quiet) {
     printf ("\n");
     show_version (stdout, NULL, NULL, 0, NULL);
     }
+_sim_startup_mark ("Version banner");
 sim_timer_precalibrate_execution_rate ();
+_sim_startup_mark ("Execution rate precalibration");
 show_version (stdnul, NULL, NULL, 1, NULL);             /* Quietly set SIM_OSTYPE */
+_sim_startup_mark ("Version environment");
 #if defined (HAVE_PCRE_H)
 setenv ("SIM_REGEX_TYPE", "PCRE", 1);                   /* Publish regex type */
 #endif
@@ -3936,6 +4420,126 @@ for (i = 0; i < sim_external_env_count; i++)
 return status;
 }
 
+/* Clone command */
+
+t_stat clone_cmd (int32 flag, CONST char *cptr)
+{
+#if defined (_WIN32) || defined (VMS) || defined (__OS2__)
+return sim_messagef (SCPE_NOFNC, "CLONE is not supported on this host\n");
+#else
+char gbuf[CBUFSIZE];
+int32 count, n, i, j;
+pid_t *pids;
+t_stat r;
+
+while (waitpid (-1, NULL, WNOHANG) > 0)                 /* reap clones which have exited */
+    ;
+GET_SWITCHES (cptr);                                    /* get switches */
+cptr = get_glyph (cptr, gbuf, 0);
+count = (int32)get_uint (gbuf, 10, 1024, &r);
+if ((r != SCPE_OK) || (count == 0))
+    return sim_messagef (SCPE_ARG, "Invalid clone count: %s\n", gbuf);
+if (*cptr == '\0')
+    return sim_messagef (SCPE_2FARG, "Missing clone command\n");
+if (sim_asynch_enabled)
+    return sim_messagef (SCPE_NOFNC, "CLONE requires SET NOASYNCH\n");
+pids = (pid_t *)calloc (count, sizeof (*pids));
+if (pids == NULL)
+    return SCPE_MEM;
+sim_flush_buffered_files ();                            /* nothing pending to be written twice */
+for (n = 1; n <= count; n++) {
+    pid_t pid;
+
+    fflush (NULL);
+    pid = fork ();
+
+    if (pid < 0) {
+        sim_printf ("Can't start clone %d: %s\n", n, strerror (errno));
+        break;
+        }
+    if (pid == 0) {                                     /* clone */
+        CTAB *cmdp;
+        DEVICE *dptr;
+        char cbuf[4*CBUFSIZE];
+        int status;
+
+        sprintf (gbuf, "%d", n);
+        setenv ("SIM_CLONE", gbuf, 1);
+        for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {
+            for (j = 0; j < (int32)dptr->numunits; j++) {
+                UNIT *uptr = dptr->units + j;
+                FILE *f;
+                t_offset pos;
+
+                if (!(uptr->flags & UNIT_ATT))
+                    continue;
+                if (DEV_TYPE (dptr) == DEV_DISK) {
+                    r = sim_disk_clone (uptr);
+                    if (r != SCPE_NOFNC) {
+                        if (r != SCPE_OK)
+                            _exit (EXIT_FAILURE);
+                        continue;
+                        }
+                    }
+                if ((uptr->flags & UNIT_BUF) ||         /* data in (copy-on-write) memory */
+                    (uptr->fileref == NULL) ||          /* or not a */
+                    (uptr->dynflags & UNIT_NO_FIO))     /* stdio file? */
+                    continue;
+                pos = sim_ftell (uptr->fileref);
+                f = sim_fopen (uptr->filename, (uptr->flags & UNIT_RO) ? "rb" : "r+b");
+                if (f == NULL) {
+                    sim_printf ("%s: Can't reopen %s: %s\n", sim_uname (uptr), uptr->filename, strerror (errno));
+                    continue;                           /* keep the shared stream */
+                    }
+                fclose (uptr->fileref);
+                uptr->fileref = f;
+                (void)sim_fseeko (f, pos, SEEK_SET);
+                }
+            }
+        if (tmxr_clone (n) != SCPE_OK)
+            _exit (EXIT_FAILURE);
+        strlcpy (cbuf, cptr, sizeof (cbuf));            /* %%SIM_CLONE%% becomes the clone number */
+        sim_sub_args (cbuf, sizeof (cbuf), sim_exp_argv);
+        cptr = get_glyph_cmd (cbuf, gbuf);              /* get command glyph */
+        sim_switches = 0;
+        if ((cmdp = find_cmd (gbuf)))
+            r = cmdp->action (cmdp->arg, cptr);
+        else
+            r = SCPE_UNK;
+        if (SCPE_BARE_STATUS (r) == SCPE_EXIT)
+            status = sim_exit_status;
+        else {
+            if (!(r & SCPE_NOMESSAGE) && (SCPE_BARE_STATUS (r) >= SCPE_BASE))
+                sim_printf ("%s\n", sim_error_text (SCPE_BARE_STATUS (r)));
+            status = (SCPE_BARE_STATUS (r) >= SCPE_BASE) ? EXIT_FAILURE : EXIT_SUCCESS;
+            }
+        if (sim_log)
+            fflush (sim_log);
+        if (sim_deb)
+            _sim_debug_flush ();
+        fflush (NULL);
+        _exit (status);                                 /* without detaching anything */
+        }
+    pids[n - 1] = pid;
+    sim_printf ("Clone %d: pid %d\n", n, (int)pid);
+    }
+if (sim_switches & SWMASK ('W')) {
+    for (i = 0; i < n - 1; i++) {
+        int status;
+
+        if (waitpid (pids[i], &status, 0) < 0)
+            continue;
+        if (WIFEXITED (status))
+            sim_printf ("Clone %d: exit status %d\n", i + 1, WEXITSTATUS (status));
+        else
+            sim_printf ("Clone %d: terminated by signal %d\n", i + 1, WIFSIGNALED (status) ? WTERMSIG (status) : 0);
+        }
+    }
+free (pids);
+return (n > count) ? SCPE_OK : SCPE_IERR;
+#endif
+}
+
 /* Screenshot command */
 
 t_stat screenshot_cmd (int32 flag, CONST char *cptr)
@@ -4022,6 +4626,158 @@ t_stat do_cmd (int32 flag, CONST char *fcptr)
 return do_cmd_label (flag, fcptr, NULL);
 }
 
+/* Do file cache
+
+   A do file is read once and kept in memory as an array of lines along
+   with an index of the labels it contains.  Subsequent DO or CALL
+   references to the same file reuse the loaded copy unless the file's
+   modification time or size have changed.  Execution then walks the line
+   array and GOTO jumps directly to the indexed label line.
+*/
+
+static char *do_trim_line (char *cptr);
+
+static void do_script_release (DO_SCRIPT *scr)
+{
+if ((scr == NULL) || (--scr->refs > 0))
+    return;
+free (scr->path);
+free (scr->lines);                                      /* line text shares the lines allocation */
+while (scr->label_count > 0)
+    free (scr->labels[--scr->label_count]);
+free (scr->labels);
+free (scr->label_line);
+free (scr);
+}
+
+static DO_SCRIPT *do_script_load (FILE *fpin)
+{
+char buf[4*CBUFSIZE], gbuf[4*CBUFSIZE], *tptr, *cptr;
+DO_SCRIPT *scr;
+size_t text_size = 0, text_used = 0, len;
+char *text = NULL, **lines;
+int32 line_alloc = 0, i;
+size_t *line_off = NULL;
+
+scr = (DO_SCRIPT *)calloc (1, sizeof (*scr));
+if (scr == NULL)
+    return NULL;
+while (fgets (buf, sizeof (buf), fpin)) {
+    for (tptr = buf; tptr < (buf + sizeof (buf)); tptr++) { /* remove cr or nl */
+        if ((*tptr == '\n') || (*tptr == '\r') ||
+            (tptr == (buf + sizeof (buf) - 1))) {       /* str max length? */
+            *tptr = 0;                                  /* terminate */
+            break;
+            }
+        }
+    len = strlen (buf) + 1;
+    if (text_used + len > text_size) {
+        text_size = 2 * (text_size + len);
+        if (NULL == (tptr = (char *)realloc (text, text_size)))
+            goto Error;
+        text = tptr;
+        }
+    if (scr->line_count >= line_alloc) {
+        line_alloc = 2 * (line_alloc + 32);
+        if (NULL == (line_off = (size_t *)realloc (line_off, line_alloc * sizeof (*line_off))))
+            goto Error;
+        }
+    memcpy (text + text_used, buf, len);
+    line_off[scr->line_count++] = text_used;
+    text_used += len;
+    }
+/* lines and text are kept in a single allocation */
+lines = (char **)malloc (scr->line_count * sizeof (*lines) + text_used + 1);
+scr->labels = (char **)malloc ((scr->line_count + 1) * sizeof (*scr->labels));
+scr->label_line = (int32 *)malloc ((scr->line_count + 1) * sizeof (*scr->label_line));
+if ((lines == NULL) || (scr->labels == NULL) || (scr->label_line == NULL)) {
+    free (lines);
+    goto Error;
+    }
+scr->lines = lines;
+tptr = (char *)(lines + scr->line_count);
+if (text_used)
+    memcpy (tptr, text, text_used);
+for (i = 0; i < scr->line_count; i++) {
+    lines[i] = tptr + line_off[i];
+    cptr = lines[i];                                    /* locate labels */
+    if (0 == memcmp (cptr, "\xEF\xBB\xBF", 3))         /* Skip/ignore UTF8_BOM */
+        cptr += 3;
+    while (sim_isspace (*cptr))
+        cptr++;
+    if (*cptr != ':')
+        continue;
+    ++cptr;                                             /* skip : */
+    while (sim_isspace (*cptr))
+        cptr++;
+    get_glyph (cptr, gbuf, 0);                          /* get label glyph */
+    scr->labels[scr->label_count] = (char *)malloc (1 + strlen (gbuf));
+    if (scr->labels[scr->label_count] == NULL)
+        goto Error;
+    strcpy (scr->labels[scr->label_count], gbuf);
+    scr->label_line[scr->label_count++] = i + 1;
+    }
+free (text);
+free (line_off);
+return scr;
+
+Error:
+free (text);
+free (line_off);
+scr->refs = 1;
+do_script_release (scr);
+return NULL;
+}
+
+static DO_SCRIPT *do_script_open (FILE *fpin, const char *path)
+{
+struct stat filestat;
+DO_SCRIPT *scr, **pscr;
+
+memset (&filestat, 0, sizeof (filestat));
+if (sim_stat (path, &filestat))
+    filestat.st_mtime = 0;
+for (pscr = &sim_do_scripts; (scr = *pscr) != NULL; pscr = &scr->next) {
+    if (0 != strcmp (scr->path, path))
+        continue;
+    if ((filestat.st_mtime != 0) &&
+        (filestat.st_mtime == scr->mtime) &&
+        ((t_offset)filestat.st_size == scr->size)) {
+        ++scr->refs;
+        return scr;
+        }
+    *pscr = scr->next;                                  /* stale, drop from cache */
+    do_script_release (scr);
+    break;
+    }
+scr = do_script_load (fpin);
+if (scr == NULL)
+    return NULL;
+scr->path = (char *)malloc (1 + strlen (path));
+if (scr->path == NULL) {
+    scr->refs = 1;
+    do_script_release (scr);
+    return NULL;
+    }
+strcpy (scr->path, path);
+scr->mtime = filestat.st_mtime;
+scr->size = (t_offset)filestat.st_size;
+scr->refs = 2;                                          /* cache + caller */
+scr->next = sim_do_scripts;
+sim_do_scripts = scr;
+return scr;
+}
+
+/* Fetch a line from a loaded do file as read_line would present it */
+
+static char *do_script_line (DO_SCRIPT *scr, int32 line, char *cbuf, size_t size)
+{
+if ((line < 0) || (line >= scr->line_count))
+    return NULL;
+strlcpy (cbuf, scr->lines[line], size);
+return do_trim_line (cbuf);
+}
+
 static char *do_position(void)
 {
 static char cbuf[4*CBUFSIZE];
@@ -4035,6 +4791,7 @@ t_stat do_cmd_label (int32 flag, CONST char *fcptr, CONST char *label)
 char cbuf[4*CBUFSIZE], gbuf[CBUFSIZE], abuf[4*CBUFSIZE], quote, *c, *do_arg[11];
 CONST char *cptr;
 FILE *fpin = NULL;
+DO_SCRIPT *script = NULL;
 CTAB *cmdp = NULL;
 int32 echo, nargs, errabort, i;
 int32 saved_sim_do_echo = sim_do_echo, 
@@ -4121,10 +4878,19 @@ if (NULL == (c = sim_filepath_parts (cbuf, "f"))) {
 strlcpy( sim_do_filename[sim_do_depth], strcasecmp (cbuf, "<stdin>") ? c : cbuf, 
          sizeof (sim_do_filename[sim_do_depth]));       /* stash away full path of do file name for possible use by 'call' command */
 free (c);
+if (fpin) {
+    script = do_script_open (fpin, sim_do_filename[sim_do_depth]);
+    fclose (fpin);
+    fpin = NULL;
+    if (script == NULL) {
+        stat = SCPE_MEM;
+        goto Cleanup_Return;
+        }
+    }
 sim_do_label[sim_do_depth] = label;                     /* stash away do label for possible use in messages */
 sim_goto_line[sim_do_depth] = 0;
 if (label) {
-    sim_gotofile = fpin;
+    sim_goto_script = script;
     sim_do_echo = echo;
     stat = goto_cmd (0, label);
     if (stat != SCPE_OK) {
@@ -4153,7 +4919,7 @@ do {
         }
     sim_do_ocptr[sim_do_depth] = cptr = sim_brk_getact (cbuf, sizeof(cbuf)); /* get bkpt action */
     if (!sim_do_ocptr[sim_do_depth]) {                  /* no pending action? */
-        sim_do_ocptr[sim_do_depth] = cptr = read_line (cbuf, sizeof(cbuf), fpin);/* get cmd line */
+        sim_do_ocptr[sim_do_depth] = cptr = do_script_line (script, sim_goto_line[sim_do_depth], cbuf, sizeof(cbuf));/* get cmd line */
         sim_goto_line[sim_do_depth] += 1;
         sim_cptr_is_action[sim_do_depth] = FALSE;
         }
@@ -4175,7 +4941,7 @@ do {
         continue;
     cptr = get_glyph_cmd (cptr, gbuf);                  /* get command glyph */
     sim_switches = 0;                                   /* init switches */
-    sim_gotofile = fpin;
+    sim_goto_script = script;
     sim_do_echo = echo;
     if (!sim_cptr_is_action[sim_do_depth]) {
         sim_if_cmd_last[sim_do_depth] = sim_if_cmd[sim_do_depth];
@@ -4257,7 +5023,8 @@ do {
 Cleanup_Return:
 if (fpin)
     fclose (fpin);                                      /* close file */
-sim_gotofile = NULL;
+do_script_release (script);
+sim_goto_script = NULL;
 if (flag >= 0) {
     sim_do_echo = saved_sim_do_echo;                    /* restore echo state we entered with */
     sim_show_message = saved_sim_show_message;          /* restore message display state we entered with */
@@ -5519,53 +6286,33 @@ return SCPE_OK;
 
 t_stat goto_cmd (int32 flag, CONST char *fcptr)
 {
-char cbuf[CBUFSIZE], gbuf[CBUFSIZE], gbuf1[CBUFSIZE];
-const char *cptr;
-long fpos;
-int32 saved_do_echo = sim_do_echo;
-int32 saved_goto_line = sim_goto_line[sim_do_depth];
+char cbuf[4*CBUFSIZE], gbuf1[CBUFSIZE];
+int32 i;
 
-if ((NULL == sim_gotofile) || 
+if ((NULL == sim_goto_script) || 
     (0 == strcasecmp (sim_do_filename[sim_do_depth], "<stdin>")))
     return SCPE_UNK;                                    /* only valid inside of do_cmd */
 
 get_glyph (fcptr, gbuf1, 0);
 if ('\0' == gbuf1[0])                                   /* unspecified goto target */
     return sim_messagef (SCPE_ARG, "Missing goto target\n");
-fpos = ftell(sim_gotofile);                             /* Save start position */
-if (fpos < 0)
-    return sim_messagef (SCPE_IERR, "goto ftell error: %s\n", strerror (errno));
 if (strcasecmp(":EOF", gbuf1) == 0) {
-    if (fseek (sim_gotofile, 0, SEEK_END))
-        return sim_messagef (SCPE_IERR, "goto seek error: %s\n", strerror (errno));
+    sim_goto_line[sim_do_depth] = sim_goto_script->line_count;
     sim_brk_clract ();                                  /* goto defangs current actions */
-    sim_do_echo = saved_do_echo;                        /* restore echo mode */
     return SCPE_OK;
     }
-rewind(sim_gotofile);                                   /* start search for label */
-sim_goto_line[sim_do_depth] = 0;                        /* reset line number */
-sim_do_echo = 0;                                        /* Don't echo while searching for label */
-while (1) {
-    cptr = read_line (cbuf, sizeof(cbuf), sim_gotofile);/* get cmd line */
-    if (cptr == NULL) break;                            /* exit on eof */
-    sim_goto_line[sim_do_depth] += 1;                   /* record line number */
-    if (*cptr == 0) continue;                           /* ignore blank */
-    if (*cptr != ':') continue;                         /* ignore non-labels */
-    ++cptr;                                             /* skip : */
-    while (sim_isspace (*cptr)) ++cptr;                 /* skip blanks */
-    get_glyph (cptr, gbuf, 0);                          /* get label glyph */
-    if (0 == strcmp(gbuf, gbuf1)) {
+for (i = 0; i < sim_goto_script->label_count; i++) {    /* search label index */
+    if (0 == strcmp (sim_goto_script->labels[i], gbuf1)) {
+        sim_goto_line[sim_do_depth] = sim_goto_script->label_line[i];
         sim_brk_clract ();                              /* goto defangs current actions */
-        sim_do_echo = saved_do_echo;                    /* restore echo mode */
-        if (sim_do_echo)                                /* echo if -v */
+        if (sim_do_echo) {                              /* echo if -v */
+            strlcpy (cbuf, sim_goto_script->lines[sim_goto_line[sim_do_depth] - 1], sizeof (cbuf));
+            do_trim_line (cbuf);
             sim_printf("%s> %s\n", do_position(), cbuf);
+            }
         return SCPE_OK;
         }
     }
-sim_do_echo = saved_do_echo;                            /* restore echo mode */
-sim_goto_line[sim_do_depth] = saved_goto_line;          /* restore start line number */
-if (fseek(sim_gotofile, fpos, SEEK_SET))                /* restore start position */
-    return sim_messagef (SCPE_IERR, "goto seek error: %s\n", strerror (errno));
 return sim_messagef (SCPE_ARG, "goto target '%s' not found\n", gbuf1);
 }
 
@@ -5603,7 +6350,7 @@ t_stat call_cmd (int32 flag, CONST char *fcptr)
 char cbuf[2*CBUFSIZE], gbuf[CBUFSIZE];
 const char *cptr;
 
-if (NULL == sim_gotofile) return SCPE_UNK;              /* only valid inside of do_cmd */
+if (NULL == sim_goto_script) return SCPE_UNK;              /* only valid inside of do_cmd */
 cptr = get_glyph (fcptr, gbuf, 0);
 if ('\0' == gbuf[0]) return SCPE_ARG;                   /* unspecified goto target */
 snprintf (cbuf, sizeof (cbuf), "%s%s%s %s", (NULL != strchr (sim_do_filename[sim_do_depth], ' ')) ? "\"" : "", 
@@ -5733,8 +6480,11 @@ return SCPE_OK;
 
 t_stat sim_set_asynch (int32 flag, CONST char *cptr)
 {
-if (cptr && (*cptr != 0))                               /* now eol? */
-    return SCPE_2MARG;
+if (cptr && (*cptr != 0)) {                             /* now eol? */
+    if (flag == 0)
+        return SCPE_2MARG;
+    return sim_set_thread_placement (cptr);             /* thread placement */
+    }
 #ifdef SIM_ASYNCH_IO
 if (flag == sim_asynch_enabled)                         /* already set correctly? */
     return SCPE_OK;
@@ -5787,6 +6537,7 @@ fprintf (st, "Asynchronous Clock is %sabled\n", (sim_asynch_timer) ? "en" : "dis
 #else
 fprintf (st, "Asynchronous I/O is not available in this simulator\n");
 #endif
+sim_show_thread_placement (st);
 return SCPE_OK;
 }
 
@@ -6457,6 +7208,14 @@ if (uptr->flags & UNIT_ATT) {
     fprintf (st, "attached to %s", uptr->filename);
     if (uptr->flags & UNIT_RO)
         fprintf (st, ", read only");
+    if (DEV_TYPE (dptr) == DEV_DISK) {
+        const char *stats = sim_disk_cache_stats (uptr);
+
+        if (stats) {
+            fprint_sep (st, &toks);
+            fprintf (st, "%s", stats);
+            }
+        }
     }
 else {
     if (uptr->flags & UNIT_ATTABLE) {
@@ -6631,6 +7390,7 @@ if (1) {
 #endif
 if (flag) {
     t_bool idle_capable;
+    t_bool probe_host = (st != stdnul);                 /* quiet calls skip host tool probes */
     uint32 os_ms_sleep_1, os_tick_size;
     char os_type[128] = "Unknown";
 
@@ -6711,7 +7471,8 @@ if (flag) {
     fprintf (st, "\n        Memory Access: %s Endian", sim_end ? "Little" : "Big");
     fprintf (st, "\n        Memory Pointer Size: %d bits", (int)sizeof(dptr)*8);
     fprintf (st, "\n        %s", sim_toffset_64 ? "Large File (>2GB) support" : "No Large File support");
-    fprintf (st, "\n        SDL Video support: %s", vid_version());
+    if (probe_host)
+        fprintf (st, "\n        SDL Video support: %s", vid_version());
 #if defined (HAVE_PCRE_H)
     fprintf (st, "\n        PCRE RegEx (Version %s) support for EXPECT commands", pcre_version());
 #else
@@ -6719,7 +7480,7 @@ if (flag) {
 #endif
     fprintf (st, "\n        OS clock resolution: %dms", os_tick_size);
     fprintf (st, "\n        Time taken by msleep(1): %dms", os_ms_sleep_1);
-    if (eth_version ())
+    if (probe_host && eth_version ())
         fprintf (st, "\n        Ethernet packet info: %s", eth_version());
 #if defined(__VMS)
     if (1) {
@@ -6750,7 +7511,7 @@ if (flag) {
         char proc_name[CBUFSIZE] = "";
         FILE *f;
 
-        if ((f = _popen ("ver", "r"))) {
+        if (probe_host && (f = _popen ("ver", "r"))) {
             memset (osversion, 0, sizeof(osversion));
             do {
                 if (NULL == fgets (osversion, sizeof(osversion)-1, f))
@@ -6762,7 +7523,8 @@ if (flag) {
         fprintf (st, "\n        OS: %s", osversion);
         fprintf (st, "\n        Architecture: %s%s%s, Processors: %s", arch, proc_arch3264 ? " on " : "", proc_arch3264 ? proc_arch3264  : "", procs);
         fprintf (st, "\n        Processor Id: %s, Level: %s, Revision: %s", proc_id ? proc_id : "", proc_level ? proc_level : "", proc_rev ? proc_rev : "");
-        strlcpy (wmicpath, sim_get_tool_path ("wmic"), sizeof (wmicpath));
+        if (probe_host)
+            strlcpy (wmicpath, sim_get_tool_path ("wmic"), sizeof (wmicpath));
         if (wmicpath[0]) {
             strlcat (wmicpath, " cpu get name", sizeof (wmicpath));
             if ((f = _popen (wmicpath, "r"))) {
@@ -6780,10 +7542,12 @@ if (flag) {
                 fprintf (st, "\n        Processor Name: %s", proc_name);
             }
         strlcpy (os_type, "Windows", sizeof (os_type));
-        strlcpy (tarversion, _get_tool_version ("tar"), sizeof (tarversion));
+        if (probe_host) {
+            strlcpy (tarversion, _get_tool_version ("tar"), sizeof (tarversion));
+            strlcpy (curlversion, _get_tool_version ("curl"), sizeof (curlversion));
+            }
         if (tarversion[0])
             fprintf (st, "\n        tar tool: %s", tarversion);
-        strlcpy (curlversion, _get_tool_version ("curl"), sizeof (curlversion));
         if (curlversion[0])
             fprintf (st, "\n        curl tool: %s", curlversion);
         }
@@ -6792,9 +7556,10 @@ if (flag) {
         char osversion[2*PATH_MAX+1] = "";
         char tarversion[PATH_MAX+1] = "";
         char curlversion[PATH_MAX+1] = "";
+        struct utsname uts;
         FILE *f;
         
-        if ((f = popen ("uname -a", "r"))) {
+        if (probe_host && (f = popen ("uname -a", "r"))) {
             memset (osversion, 0, sizeof (osversion));
             do {
                 if (NULL == fgets (osversion, sizeof (osversion)-1, f))
@@ -6804,17 +7569,10 @@ if (flag) {
             pclose (f);
             }
         fprintf (st, "\n        OS: %s", osversion);
-        if ((f = popen ("uname", "r"))) {
-            memset (os_type, 0, sizeof (os_type));
-            do {
-                if (NULL == fgets (os_type, sizeof (os_type)-1, f))
-                    break;
-                sim_trim_endspc (os_type);
-                } while (os_type[0] == '\0');
-            pclose (f);
-            }
+        if (uname (&uts) == 0)                          /* same as the uname command's output */
+            strlcpy (os_type, uts.sysname, sizeof (os_type));
 #if (defined(__linux) || defined(__linux__))
-        if ((f = popen ("lscpu 2>/dev/null | grep 'Model name:'", "r"))) {
+        if (probe_host && (f = popen ("lscpu 2>/dev/null | grep 'Model name:'", "r"))) {
             char proc_name[PATH_MAX+1] = "";
 
             memset (proc_name, 0, sizeof (proc_name));
@@ -6834,7 +7592,7 @@ if (flag) {
                 }
             }
 #elif defined (__APPLE__)
-        if ((f = popen ("sysctl -n machdep.cpu.brand_string 2>/dev/null", "r"))) {
+        if (probe_host && (f = popen ("sysctl -n machdep.cpu.brand_string 2>/dev/null", "r"))) {
             char proc_name[PATH_MAX+1] = "";
 
             memset (proc_name, 0, sizeof (proc_name));
@@ -6848,10 +7606,12 @@ if (flag) {
                 fprintf (st, "\n        Processor Name: %s", proc_name);
             }
 #endif
-        strlcpy (tarversion, _get_tool_version ("tar"), sizeof (tarversion));
+        if (probe_host) {
+            strlcpy (tarversion, _get_tool_version ("tar"), sizeof (tarversion));
+            strlcpy (curlversion, _get_tool_version ("curl"), sizeof (curlversion));
+            }
         if (tarversion[0])
             fprintf (st, "\n        tar tool: %s", tarversion);
-        strlcpy (curlversion, _get_tool_version ("curl"), sizeof (curlversion));
         if (curlversion[0])
             fprintf (st, "\n        curl tool: %s", curlversion);
         }
@@ -7104,6 +7864,34 @@ if ((dptr->flags & DEV_DEBUG) || (dptr->debflags)) {
 else return SCPE_NOFNC;
 }
 
+/* Show I/O latency statistics for a device or unit (-C clears them
+   after they are displayed) */
+
+t_stat show_dev_statistics (FILE *st, DEVICE *dptr, UNIT *uptr, int32 uflag, CONST char *cptr)
+{
+t_bool clear = ((sim_switches & SWMASK ('C')) != 0);
+t_bool any = FALSE;
+uint32 unit;
+
+if (cptr && (*cptr != 0))
+    return SCPE_2MARG;
+for (unit = 0; unit < dptr->numunits; unit++) {
+    UNIT *u = &dptr->units[unit];
+
+    if (uflag && (u != uptr))
+        continue;
+    if (DEV_TYPE (dptr) == DEV_DISK)
+        any |= sim_disk_show_statistics (st, u, clear);
+    else if (DEV_TYPE (dptr) == DEV_TAPE)
+        any |= sim_tape_show_statistics (st, u, clear);
+    }
+if (!uflag || (uptr == dptr->units))
+    any |= eth_show_statistics (st, dptr, clear);
+if (!any)
+    fprintf (st, "%s: no I/O statistics\n", uflag ? sim_uname (uptr) : sim_dname (dptr));
+return SCPE_OK;
+}
+
 /* Show On actions for one level (default current level) */
 
 t_stat show_on (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr)
@@ -8389,6 +9177,8 @@ if ((uptr->flags & UNIT_BUF) && (uptr->filebuf)) {
         }
     uptr->flags = uptr->flags & ~UNIT_BUF;
     }
+if (uptr->spool && (sim_spool_close (uptr) != SCPE_OK)) /* write out spooled output */
+    sim_printf ("%s: I/O error - %s\n", sim_uname (uptr), strerror (errno));
 uptr->flags = uptr->flags & ~(UNIT_ATT | ((uptr->flags & UNIT_ROABLE) ? UNIT_RO : 0));
 free (uptr->filename);
 uptr->filename = NULL;
@@ -8433,6 +9223,7 @@ return assign_device (dptr, gbuf);
 
 t_stat assign_device (DEVICE *dptr, const char *cptr)
 {
+sim_name_invalidate ();
 dptr->lname = (char *) calloc (1 + strlen (cptr), sizeof (char));
 if (dptr->lname == NULL)
     return SCPE_MEM;
@@ -8464,6 +9255,7 @@ return deassign_device (dptr);
 
 t_stat deassign_device (DEVICE *dptr)
 {
+sim_name_invalidate ();
 free (dptr->lname);
 dptr->lname = NULL;
 return SCPE_OK;
@@ -8507,8 +9299,56 @@ return uptr->uname = strcpy ((char *)malloc (1 + strlen (uname)), uname);
 /* Save command
 
    sa[ve] filename              save state to specified file
+
+   Switches:
+        -c                      [V4.1] deflate memory blocks
+        -i                      [V4.1] incremental: memory blocks which are
+                                unchanged since the last full save are
+                                written as references to that file
+
+   Every full SAVE made with this command becomes the base for later
+   incremental saves.  For each memory block it remembers a hash of the
+   contents and the position of the block's record in the file; an
+   incremental save writes the position instead of the data of a block
+   whose hash is unchanged, so RESTORE can read that block directly from
+   the base file.
 */
 
+typedef struct {
+    UNIT                *uptr;                          /* memory unit */
+    t_addr              capac;                          /* its size when saved */
+    uint32              blocks;                         /* block count */
+    t_uint64            *hash;                          /* block content hashes */
+    t_offset            *pos;                           /* block record offsets in base file */
+    } SAVE_BASE_UNIT;
+
+static char *save_file_name = NULL;                     /* file being saved by save_cmd */
+static char *save_base_name = NULL;                     /* last full save file */
+static t_offset save_base_size = 0;                     /* and its size */
+static SAVE_BASE_UNIT *save_base_units = NULL;
+static uint32 save_base_count = 0;
+
+static void save_base_free (SAVE_BASE_UNIT *units, uint32 count)
+{
+uint32 i;
+
+for (i = 0; i < count; i++) {
+    free (units[i].hash);
+    free (units[i].pos);
+    }
+free (units);
+}
+
+static t_uint64 save_block_hash (const void *buf, size_t lnt)
+{
+const uint8 *bp = (const uint8 *) buf;
+t_uint64 hash = 14695981039346656037ull;                 /* FNV-1a */
+
+while (lnt--)
+    hash = (hash ^ *bp++) * 1099511628211ull;
+return hash;
+}
+
 t_stat save_cmd (int32 flag, CONST char *cptr)
 {
 FILE *sfile;
@@ -8521,11 +9361,23 @@ if (*cptr == 0)                                         /* must be more */
 gbuf[sizeof(gbuf)-1] = '\0';
 strlcpy (gbuf, cptr, sizeof(gbuf));
 sim_trim_endspc (gbuf);
+if (sim_switches & SWMASK ('I')) {                      /* incremental? */
+    if (save_base_name == NULL)
+        return sim_messagef (SCPE_ARG, "No full SAVE to base an incremental save on\n");
+    if (strcmp (gbuf, save_base_name) == 0)
+        return sim_messagef (SCPE_ARG, "An incremental save can't overwrite its base file: %s\n", gbuf);
+    }
+#if !defined (HAVE_ZLIB)
+if (sim_switches & SWMASK ('C'))
+    return sim_messagef (SCPE_NOFNC, "Compressed SAVE files are not supported in this build\n");
+#endif
 if ((sfile = sim_fopen (gbuf, "r+b")) == NULL) {    /* try existing file */
     if ((sfile = sim_fopen (gbuf, "wb")) == NULL)   /* create new empty file */
         return SCPE_OPENERR;
     }
+save_file_name = gbuf;
 r = sim_save (sfile);
+save_file_name = NULL;
 fclose (sfile);
 return r;
 }
@@ -8534,7 +9386,7 @@ t_stat sim_save (FILE *sfile)
 {
 void *mbuf;
 int32 l, t;
-uint32 i, j, device_count;
+uint32 i, j, b, device_count;
 t_addr k, high;
 t_value val;
 t_stat r;
@@ -8543,6 +9395,18 @@ size_t sz;
 DEVICE *dptr;
 UNIT *uptr;
 REG *rptr;
+t_bool incremental = ((sim_switches & SWMASK ('I')) != 0) && (save_base_name != NULL);
+t_bool compress = (sim_switches & SWMASK ('C')) != 0;
+t_bool record = !incremental && (save_file_name != NULL);
+SAVE_BASE_UNIT *units = NULL, *bunit, *nunit;
+uint32 nunits = 0;
+t_uint64 hash = 0;
+t_offset pos = 0;
+#if defined (HAVE_ZLIB)
+Bytef *zbuf = NULL;
+uLongf zlnt;
+uint32 clnt;
+#endif
 
 #define WRITE_I(xx) sim_fwrite (&(xx), sizeof (xx), 1, sfile)
 
@@ -8551,7 +9415,7 @@ sim_debug(SIM_DBG_SAVE, &sim_scp_dev, "sim_save ()\n");
 /* Don't make changes below without also changing save_vercur above */
 
 fprintf (sfile, "%s\n%s\n%s\n%s\n%s\n%.0f\n",
-    save_vercur,                                        /* [V2.5] save format */
+    (incremental || compress)? save_ver41: save_vercur, /* [V2.5] save format */
     sim_savename,                                       /* sim name */
     sim_si64, sim_sa64, eth_capabilities(),             /* [V3.5] options */
     sim_time);                                          /* [V3.2] sim time */
@@ -8565,6 +9429,11 @@ fprintf (sfile, "git commit id: %8.8s\n", S_xstr(SIM_GIT_COMMIT_ID));
 #else
 fprintf (sfile, "git commit id: unknown\n");
 #endif
+if (incremental || compress) {                          /* [V4.1] base file */
+    fprintf (sfile, "%s\n", incremental? save_base_name: "");
+    if (incremental)
+        WRITE_I (save_base_size);
+    }
 
 for (device_count = 0; sim_devices[device_count]; device_count++);/* count devices */
 for (i = 0; i < (device_count + sim_internal_device_count); i++) {/* loop thru devices */
@@ -8618,26 +9487,89 @@ for (i = 0; i < (device_count + sim_internal_device_count); i++) {/* loop thru d
             WRITE_I (high);                             /* [V2.5] write size */
             sz = SZ_D (dptr);
             if ((mbuf = calloc (SRBSIZ, sz)) == NULL) {
+                save_base_free (units, nunits);
                 fclose (sfile);
                 return SCPE_MEM;
                 }
-            for (k = 0; k < high; ) {                   /* loop thru mem */
+#if defined (HAVE_ZLIB)
+            if (compress &&
+                ((zbuf = (Bytef *) realloc (zbuf, compressBound ((uLong)(SRBSIZ * sz)))) == NULL)) {
+                free (mbuf);
+                save_base_free (units, nunits);
+                return SCPE_MEM;
+                }
+#endif
+            for (b = 0, bunit = NULL; incremental && (b < save_base_count); b++) {
+                if ((save_base_units[b].uptr == uptr) &&    /* same unit and size? */
+                    (save_base_units[b].capac == high))
+                    bunit = &save_base_units[b];
+                }
+            nunit = NULL;
+            if (record) {                               /* remember blocks for -I */
+                uint32 blocks = (uint32)((high + (SRBSIZ * dptr->aincr) - 1) / (SRBSIZ * dptr->aincr));
+
+                nunit = (SAVE_BASE_UNIT *) realloc (units, (nunits + 1) * sizeof (*units));
+                if (nunit != NULL) {
+                    units = nunit;
+                    nunit = &units[nunits++];
+                    nunit->uptr = uptr;
+                    nunit->capac = high;
+                    nunit->blocks = blocks;
+                    nunit->hash = (t_uint64 *) calloc (blocks, sizeof (*nunit->hash));
+                    nunit->pos = (t_offset *) calloc (blocks, sizeof (*nunit->pos));
+                    }
+                if ((nunit == NULL) || (nunit->hash == NULL) || (nunit->pos == NULL)) {
+                    free (mbuf);
+                    save_base_free (units, nunits);
+                    return SCPE_MEM;
+                    }
+                }
+            for (k = 0, b = 0; k < high; b++) {         /* loop thru mem */
                 zeroflg = TRUE;
                 for (l = 0; (l < SRBSIZ) && (k < high); l++,
                      k = k + (dptr->aincr)) {           /* check for 0 block */
                     r = dptr->examine (&val, k, uptr, SIM_SW_REST);
                     if (r != SCPE_OK) {
                         free (mbuf);
+#if defined (HAVE_ZLIB)
+                        free (zbuf);
+#endif
+                        save_base_free (units, nunits);
                         return r;
                         }
                     if (val) zeroflg = FALSE;
                     SZ_STORE (sz, val, mbuf, l);
                     }                                   /* end for l */
+                if (nunit || bunit)
+                    hash = save_block_hash (mbuf, l * sz);
+                if (nunit) {
+                    nunit->hash[b] = hash;
+                    nunit->pos[b] = pos = sim_ftell (sfile);
+                    }
                 if (zeroflg) {                          /* all zero's? */
                     l = -l;                             /* invert block count */
                     WRITE_I (l);                        /* write only count */
                     }
+                else if (bunit && (b < bunit->blocks) && /* unchanged from base? */
+                         (bunit->hash[b] == hash)) {
+                    t = SRB_BASE | l;
+                    WRITE_I (t);                        /* [V4.1] write reference */
+                    WRITE_I (bunit->pos[b]);
+                    }
                 else {
+#if defined (HAVE_ZLIB)
+                    zlnt = compressBound ((uLong)(l * sz));
+                    if (compress &&
+                        (compress2 (zbuf, &zlnt, (Bytef *) mbuf, (uLong)(l * sz), Z_DEFAULT_COMPRESSION) == Z_OK) &&
+                        (zlnt < (l * sz))) {
+                        t = SRB_DEFLATE | l;
+                        clnt = (uint32) zlnt;
+                        WRITE_I (t);                    /* [V4.1] write deflated */
+                        WRITE_I (clnt);
+                        sim_fwrite (zbuf, 1, clnt, sfile);
+                        continue;
+                        }
+#endif
                     WRITE_I (l);                        /* block count */
                     sim_fwrite (mbuf, sz, l, sfile);
                     }
@@ -8664,13 +9596,35 @@ for (i = 0; i < (device_count + sim_internal_device_count); i++) {/* loop thru d
     fputc ('\n', sfile);                                /* end registers */
     }
 fputc ('\n', sfile);                                    /* end devices */
+#if defined (HAVE_ZLIB)
+free (zbuf);
+#endif
 if (!ferror (sfile)) {
-    t_offset pos = sim_ftell (sfile);                   /* get current position */
+    pos = sim_ftell (sfile);                            /* get current position */
 
-    if (pos < 0)                                        /* error? */
+    if (pos < 0) {                                      /* error? */
+        save_base_free (units, nunits);
         return SCPE_IOERR;                              /* done! */
+        }
     sim_set_fsize (sfile, (t_addr)pos);                 /* truncate the save file */
     }
+if (record) {                                           /* new base for -I? */
+    save_base_free (save_base_units, save_base_count);
+    free (save_base_name);
+    save_base_units = NULL;
+    save_base_count = 0;
+    save_base_name = NULL;
+    if (!ferror (sfile) &&
+        ((save_base_name = (char *) malloc (1 + strlen (save_file_name))) != NULL)) {
+        strcpy (save_base_name, save_file_name);
+        save_base_size = pos;
+        save_base_units = units;
+        save_base_count = nunits;
+        units = NULL;
+        nunits = 0;
+        }
+    save_base_free (units, nunits);
+    }
 return (ferror (sfile))? SCPE_IOERR: SCPE_OK;           /* error during save? */
 }
 
@@ -8679,6 +9633,67 @@ return (ferror (sfile))? SCPE_IOERR: SCPE_OK;           /* error during save? */
    re[store] filename           restore state from specified file
 */
 
+/* Read one memory block record into mbuf.  Returns the number of values
+   in the block, with *zero set if they are all zero, or 0 on error.  The
+   [V4.1] records are only recognized if ext is set; a block which is
+   unchanged from the base file is read from its record there.  When the
+   base is the memory a migration has already copied, such a block is
+   left in place and *keep is set instead.
+*/
+
+static t_bool rest_migrate = FALSE;                     /* restoring a migration? */
+
+static int32 sim_rest_block (FILE *rfile, FILE *bfile, void *mbuf, size_t sz, t_bool ext, t_bool *zero, t_bool *keep)
+{
+int32 blkcnt, l;
+t_offset pos;
+
+*zero = *keep = FALSE;
+if (sim_fread (&blkcnt, sizeof (blkcnt), 1, rfile) == 0)/* block count */
+    return 0;
+if (blkcnt < 0) {                                       /* compressed? */
+    *zero = TRUE;
+    return -blkcnt;
+    }
+if (!ext || (blkcnt <= SRBSIZ))                         /* plain data? */
+    return (int32)sim_fread (mbuf, sz, blkcnt, rfile);
+l = blkcnt & SRB_M_CNT;
+if ((l == 0) || (l > SRBSIZ))
+    return 0;
+if (blkcnt & SRB_BASE) {                                /* in base file? */
+    if ((bfile == NULL) && rest_migrate) {              /* already in memory? */
+        if (sim_fread (&pos, sizeof (pos), 1, rfile) == 0)
+            return 0;
+        *keep = TRUE;
+        return l;
+        }
+    if ((bfile == NULL) ||
+        (sim_fread (&pos, sizeof (pos), 1, rfile) == 0) ||
+        (sim_fseeko (bfile, pos, SEEK_SET) != 0))
+        return 0;
+    return (sim_rest_block (bfile, NULL, mbuf, sz, TRUE, zero, keep) == l)? l: 0;
+    }
+#if defined (HAVE_ZLIB)
+if (blkcnt & SRB_DEFLATE) {                             /* deflated? */
+    uint32 clnt;
+    uLongf ulnt = (uLongf)(l * sz);
+    Bytef *zbuf;
+    int zr;
+
+    if ((sim_fread (&clnt, sizeof (clnt), 1, rfile) == 0) ||
+        ((zbuf = (Bytef *) malloc (clnt)) == NULL))
+        return 0;
+    if (sim_fread (zbuf, 1, clnt, rfile) != clnt)
+        zr = Z_DATA_ERROR;
+    else
+        zr = uncompress ((Bytef *) mbuf, &ulnt, zbuf, clnt);
+    free (zbuf);
+    return ((zr == Z_OK) && (ulnt == (uLongf)(l * sz)))? l: 0;
+    }
+#endif
+return 0;
+}
+
 t_stat restore_cmd (int32 flag, CONST char *cptr)
 {
 FILE *rfile;
@@ -8706,13 +9721,14 @@ UNIT **attunits = NULL;
 int32 *attswitches = NULL;
 int32 attcnt = 0;
 void *mbuf = NULL;
-int32 j, blkcnt, limit, unitno, time, flg;
+FILE *bfile = NULL;
+int32 j, limit, unitno, time, flg;
 uint32 us, depth;
 t_addr k, high, old_capac;
 t_value val, mask;
 t_stat r;
 size_t sz;
-t_bool v40, v35, v32;
+t_bool v41, v40, v35, v32, zeroflg, keepflg;
 DEVICE *dptr;
 UNIT *uptr;
 REG *rptr;
@@ -8739,8 +9755,10 @@ if (fstat (fileno (rfile), &rstat)) {
     }
 READ_S (buf);                                           /* [V2.5+] read version */
 sim_debug (SIM_DBG_RESTORE, &sim_scp_dev, "version=%s\n", buf);
-v40 = v35 = v32 = FALSE;
-if (strcmp (buf, save_ver40) == 0)                      /* version 4.0? */
+v41 = v40 = v35 = v32 = FALSE;
+if (strcmp (buf, save_ver41) == 0)                      /* version 4.1? */
+    v41 = v40 = v35 = v32 = TRUE;
+else if (strcmp (buf, save_ver40) == 0)                 /* version 4.0? */
     v40 = v35 = v32 = TRUE;
 else if (strcmp (buf, save_ver35) == 0)                 /* version 3.5? */
     v35 = v32 = TRUE;
@@ -8750,7 +9768,7 @@ else if (strcmp (buf, save_ver30) != 0) {               /* version 3.0? */
     sim_printf ("Invalid file version: %s\n", buf);
     return SCPE_INCOMP;
     }
-if ((strcmp (buf, save_ver40) != 0) && (!sim_quiet) && (!suppress_warning)) {
+if (!v40 && (!sim_quiet) && (!suppress_warning)) {
     sim_printf ("warning - attempting to restore a saved simulator image in %s image format.\n", buf);
     warned = TRUE;
     }
@@ -8793,6 +9811,35 @@ if (v40) {
 #undef S_xstr
 #endif
     }
+if (v41) {
+    READ_S (buf);                                       /* [V4.1] base file */
+    if (strcmp (buf, save_migrate_base) == 0) {         /* migration state? */
+        t_offset base_size;
+
+        READ_I (base_size);
+        if (!rest_migrate) {
+            sim_printf ("Migration state can only be restored by MIGRATE\n");
+            r = SCPE_INCOMP;
+            goto Cleanup_Return;
+            }
+        }
+    else if (buf[0] != '\0') {
+        t_offset base_size;
+
+        READ_I (base_size);
+        sim_debug (SIM_DBG_RESTORE, &sim_scp_dev, "base=%s\n", buf);
+        if ((bfile = sim_fopen (buf, "rb")) == NULL) {
+            sim_printf ("Can't open base save file: %s\n", buf);
+            r = SCPE_INCOMP;
+            goto Cleanup_Return;
+            }
+        if (sim_fsize_ex (bfile) != base_size) {
+            sim_printf ("Base save file has changed: %s\n", buf);
+            r = SCPE_INCOMP;
+            goto Cleanup_Return;
+            }
+        }
+    }
 if (!dont_detach_attach)
     detach_all (0, 0);                                  /* Detach everything to start from a consistent state */
 else {
@@ -8934,20 +9981,17 @@ for ( ;; ) {                                            /* device loop */
                 goto Cleanup_Return;
                 }
             for (k = 0; k < high; ) {                   /* loop thru mem */
-                if (sim_fread (&blkcnt, sizeof (blkcnt), 1, rfile) == 0) {/* block count */
-                    r = SCPE_IOERR;
-                    goto Cleanup_Return;
-                    }
-                if (blkcnt < 0)                         /* compressed? */
-                    limit = -blkcnt;
-                else
-                    limit = (int32)sim_fread (mbuf, sz, blkcnt, rfile);
+                limit = sim_rest_block (rfile, bfile, mbuf, sz, v41, &zeroflg, &keepflg);
                 if (limit <= 0) {                       /* invalid or err? */
                     r = SCPE_IOERR;
                     goto Cleanup_Return;
                     }
+                if (keepflg) {                          /* already in memory? */
+                    k = k + limit * dptr->aincr;
+                    continue;
+                    }
                 for (j = 0; j < limit; j++, k = k + (dptr->aincr)) {
-                    if (blkcnt < 0)                     /* compressed? */
+                    if (zeroflg)                        /* compressed? */
                         val = 0;
                     else 
                         SZ_LOAD (sz, val, mbuf, j);     /* saved value */
@@ -9034,6 +10078,8 @@ for (j=0, r = SCPE_OK; j<attcnt; j++) {
     }
 Cleanup_Return:
 free (mbuf);
+if (bfile)
+    fclose (bfile);
 for (j=0; j < attcnt; j++)
     free (attnames[j]);
 free (attnames);
@@ -9044,23 +10090,517 @@ if (warned)
 return r;
 }
 
-void sim_flush_buffered_files (void)
-{
-uint32 i, j;
-DEVICE *dptr;
-UNIT *uptr;
+/* Migrate command
 
-if (sim_log)                                            /* flush console log */
-    fflush (sim_log);
+   mi[grate] host:port          move the simulator to one waiting at host:port
+   mi[grate] -L {host:}port     wait for, receive and restore a migration
+
+   The source pre-copies memory while the simulated system keeps running.
+   The INT-MIGRATE unit walks the memory-like units (those SAVE writes) a
+   slice at a time, and sends each block of SRBSIZ values whose hash
+   differs from what was last sent; the target deposits it directly.
+   When a pass over memory finds few enough changed blocks, or after
+   MIG_MAX_PASSES passes, the unit stops execution.  The rest of the state
+   is then sent as an incremental save file whose base is the memory the
+   target already holds (save_migrate_base), so only blocks changed since
+   they were copied are included.  Writing it takes one more pass over
+   memory through the examine routines, which is most of the time
+   execution is stopped.  The source detaches everything, so the
+   target can attach the same files and listeners as it restores, and
+   exits once the target reports success.
+
+   Messages are a MIGRATE_HDR, followed by lnt bytes of data.
+*/
+
+#define MIG_BLOCK       1                               /* memory block */
+#define MIG_ZERO        2                               /* all zero memory block */
+#define MIG_STATE       3                               /* save file */
+#define MIG_GO          4                               /* source has detached, restore */
+
+#define MIG_SLICE       256                             /* blocks examined per service */
+#define MIG_INTERVAL    1000                            /* usecs between services */
+#define MIG_MAX_PASSES  8                               /* pre-copy passes before giving up */
+#define MIG_MIN_DIRTY   16                              /* converged at this many changed blocks */
+
+typedef struct {
+    uint32              type;                           /* MIG_xxx */
+    uint32              dev;                            /* device index */
+    uint32              unit;                           /* unit number */
+    uint32              block;                          /* block number */
+    uint32              count;                          /* values in block */
+    uint32              lnt;                            /* data bytes following */
+    } MIGRATE_HDR;
+
+static struct {
+    SOCKET              sock;                           /* connection to target */
+    SAVE_BASE_UNIT      *units;                         /* memory as the target has it */
+    uint32              *dev;                           /* device index of each unit */
+    uint32              nunits;
+    uint32              blocks;                         /* total blocks */
+    uint32              unit;                           /* pass position */
+    uint32              block;
+    uint32              passes;                         /* completed passes */
+    uint32              changed;                        /* blocks sent this pass */
+    t_uint64            sent;                           /* bytes sent */
+    t_bool              ready;                          /* pre-copy complete */
+    t_stat              error;                          /* error during pre-copy */
+    void                *buf;                           /* block buffer */
+    } mig;
+
+static t_stat migrate_write (SOCKET sock, const void *buf, size_t lnt)
+{
+const char *bp = (const char *) buf;
+
+while (lnt > 0) {
+    int n = sim_write_sock (sock, bp, (int)((lnt > 65536) ? 65536 : lnt));
+
+    if (n < 0)
+        return SCPE_IOERR;
+    bp += n;
+    lnt -= n;
+    }
+return SCPE_OK;
+}
+
+static t_stat migrate_read (SOCKET sock, void *buf, size_t lnt)
+{
+char *bp = (char *) buf;
+
+while (lnt > 0) {
+    int n = sim_read_sock (sock, bp, (int)((lnt > 65536) ? 65536 : lnt));
+
+    if (n < 0)
+        return SCPE_IOERR;
+    bp += n;
+    lnt -= n;
+    }
+return SCPE_OK;
+}
+
+/* Identification both ends must agree on */
+
+static void migrate_ident (char *buf, size_t lnt)
+{
+uint32 i;
+
+for (i = 0; sim_devices[i]; i++)
+    ;
+memset (buf, 0, lnt);
+snprintf (buf, lnt, "SIMH MIGRATE\n%s\n%s\n%s\n%s\n%u\n", sim_savename, sim_si64, sim_sa64,
+          sim_end ? "little" : "big", i);                /* messages and memory are in host order */
+}
+
+/* Send block b of unit i if it has changed since it was last sent */
+
+static t_stat migrate_send_block (uint32 i, uint32 b)
+{
+SAVE_BASE_UNIT *su = &mig.units[i];
+UNIT *uptr = su->uptr;
+DEVICE *dptr = find_dev_from_unit (uptr);
+size_t sz = SZ_D (dptr);
+t_addr k = (t_addr)b * SRBSIZ * dptr->aincr;
+t_bool zero = TRUE;
+t_uint64 hash;
+t_value val;
+MIGRATE_HDR hdr;
+int32 l;
+t_stat r;
+
+for (l = 0; (l < SRBSIZ) && (k < su->capac); l++, k = k + dptr->aincr) {
+    r = dptr->examine (&val, k, uptr, SIM_SW_REST);
+    if (r != SCPE_OK)
+        return r;
+    if (val)
+        zero = FALSE;
+    SZ_STORE (sz, val, mig.buf, l);
+    }
+hash = save_block_hash (mig.buf, l * sz);
+if (hash == su->hash[b])                                /* target has it? */
+    return SCPE_OK;
+hdr.type = zero ? MIG_ZERO : MIG_BLOCK;
+hdr.dev = mig.dev[i];
+hdr.unit = (uint32)(uptr - dptr->units);
+hdr.block = b;
+hdr.count = l;
+hdr.lnt = zero ? 0 : (uint32)(l * sz);
+if ((migrate_write (mig.sock, &hdr, sizeof (hdr)) != SCPE_OK) ||
+    (migrate_write (mig.sock, mig.buf, hdr.lnt) != SCPE_OK))
+    return sim_messagef (SCPE_IOERR, "Migration connection lost\n");
+su->hash[b] = hash;
+mig.sent += sizeof (hdr) + hdr.lnt;
+++mig.changed;
+return SCPE_OK;
+}
+
+/* Pre-copy service: examine the next slice of memory, and stop execution
+   once a pass has converged */
+
+t_stat migrate_svc (UNIT *uptr)
+{
+uint32 n;
+t_stat r;
+
+for (n = 0; n < MIG_SLICE; ) {
+    if (mig.unit >= mig.nunits) {                       /* pass done? */
+        ++mig.passes;
+        sim_debug (SIM_DBG_SAVE, &sim_scp_dev, "migrate pass %u: %u of %u blocks sent\n", mig.passes, mig.changed, mig.blocks);
+        if ((mig.changed <= MAX (MIG_MIN_DIRTY, mig.blocks / 256)) ||
+            (mig.passes >= MIG_MAX_PASSES)) {
+            mig.ready = TRUE;
+            return SCPE_STEP;                           /* stop at once, quietly */
+            }
+        mig.unit = mig.block = mig.changed = 0;
+        }
+    if (mig.block >= mig.units[mig.unit].blocks) {
+        ++mig.unit;
+        mig.block = 0;
+        continue;
+        }
+    r = migrate_send_block (mig.unit, mig.block++);
+    if (r != SCPE_OK) {
+        mig.error = r;
+        return SCPE_STEP;
+        }
+    ++n;
+    }
+return sim_activate_after (uptr, MIG_INTERVAL);
+}
+
+static void migrate_free (void)
+{
+save_base_free (mig.units, mig.nunits);
+free (mig.dev);
+free (mig.buf);
+if (mig.sock != INVALID_SOCKET)
+    sim_close_sock (mig.sock);
+memset (&mig, 0, sizeof (mig));
+mig.sock = INVALID_SOCKET;
+}
+
+/* Write the final state, relative to the memory the target holds */
+
+static t_stat migrate_save (FILE *sfile)
+{
+char *base_name = save_base_name;
+t_offset base_size = save_base_size;
+SAVE_BASE_UNIT *base_units = save_base_units;
+uint32 base_count = save_base_count;
+int32 saved_switches = sim_switches;
+t_stat r;
+
+save_base_name = (char *) save_migrate_base;
+save_base_size = 0;
+save_base_units = mig.units;
+save_base_count = mig.nunits;
+sim_switches = SWMASK ('I');
+r = sim_save (sfile);
+save_base_name = base_name;
+save_base_size = base_size;
+save_base_units = base_units;
+save_base_count = base_count;
+sim_switches = saved_switches;
+return r;
+}
+
+static t_stat migrate_rest (FILE *rfile)
+{
+t_stat r;
+
+rewind (rfile);
+rest_migrate = TRUE;
+sim_switches = 0;
+r = sim_rest (rfile);
+rest_migrate = FALSE;
+return r;
+}
+
+static t_stat migrate_source (CONST char *cptr)
+{
+char ident[256], peer[256], buf[65536];
+uint32 i, j, status;
+uint32 start;
+DEVICE *dptr;
+UNIT *uptr;
+MIGRATE_HDR hdr;
+FILE *sfile;
+t_offset lnt, state;
+t_stat r;
+
+memset (&mig, 0, sizeof (mig));
+mig.sock = sim_connect_sock_ex (NULL, cptr, NULL, NULL, SIM_SOCK_OPT_BLOCKING | SIM_SOCK_OPT_NODELAY);
+if (mig.sock == INVALID_SOCKET)
+    return sim_messagef (SCPE_OPENERR, "Can't connect to migration target %s\n", cptr);
+migrate_ident (ident, sizeof (ident));
+if ((migrate_write (mig.sock, ident, sizeof (ident)) != SCPE_OK) ||
+    (migrate_read (mig.sock, peer, sizeof (peer)) != SCPE_OK)) {
+    migrate_free ();
+    return sim_messagef (SCPE_IOERR, "Migration target %s didn't respond\n", cptr);
+    }
+if (memcmp (ident, peer, sizeof (ident)) != 0) {
+    migrate_free ();
+    return sim_messagef (SCPE_INCOMP, "Migration target %s is not the same type of simulator\n", cptr);
+    }
+mig.buf = malloc (SRBSIZ * sizeof (t_uint64));
+if (mig.buf == NULL) {
+    migrate_free ();
+    return SCPE_MEM;
+    }
+for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {     /* find memory */
+    if (dptr->flags & DEV_NOSAVE)
+        continue;
+    for (j = 0; j < dptr->numunits; j++) {
+        SAVE_BASE_UNIT *su;
+        uint32 *dev;
+
+        uptr = dptr->units + j;
+        if (((uptr->flags & (UNIT_FIX + UNIT_ATTABLE)) != UNIT_FIX) ||
+            (dptr->examine == NULL) || (uptr->capac == 0))
+            continue;
+        su = (SAVE_BASE_UNIT *) realloc (mig.units, (mig.nunits + 1) * sizeof (*su));
+        if (su != NULL)
+            mig.units = su;
+        dev = (uint32 *) realloc (mig.dev, (mig.nunits + 1) * sizeof (*dev));
+        if (dev != NULL)
+            mig.dev = dev;
+        if ((su == NULL) || (dev == NULL)) {
+            migrate_free ();
+            return SCPE_MEM;
+            }
+        su = &mig.units[mig.nunits];
+        memset (su, 0, sizeof (*su));
+        mig.dev[mig.nunits++] = i;
+        su->uptr = uptr;
+        su->capac = uptr->capac;
+        su->blocks = (uint32)((uptr->capac + (SRBSIZ * dptr->aincr) - 1) / (SRBSIZ * dptr->aincr));
+        su->hash = (t_uint64 *) calloc (su->blocks, sizeof (*su->hash));
+        su->pos = (t_offset *) calloc (su->blocks, sizeof (*su->pos));
+        if ((su->hash == NULL) || (su->pos == NULL)) {
+            migrate_free ();
+            return SCPE_MEM;
+            }
+        mig.blocks += su->blocks;
+        }
+    }
+sim_printf ("Migrating to %s, %u memory blocks\n", cptr, mig.blocks);
+sim_activate_after (&sim_migrate_unit, MIG_INTERVAL);   /* pre-copy while running */
+r = run_cmd (RU_CONT, "");
+sim_cancel (&sim_migrate_unit);
+if (!mig.ready || (mig.error != SCPE_OK)) {             /* stopped for another reason? */
+    if (mig.error == SCPE_OK)
+        run_cmd_message (NULL, r);
+    r = (mig.error == SCPE_OK) ? SCPE_OK : (mig.error | SCPE_NOMESSAGE);
+    migrate_free ();
+    sim_printf ("Migration abandoned, execution can continue here\n");
+    return r;
+    }
+start = sim_os_msec ();                                 /* execution stopped */
+sfile = tmpfile ();
+if (sfile == NULL) {
+    migrate_free ();
+    return sim_messagef (SCPE_OPENERR, "Can't create migration state file: %s\n", strerror (errno));
+    }
+r = migrate_save (sfile);                               /* changed blocks go here */
+lnt = state = sim_ftell (sfile);
+if ((r == SCPE_OK) && ((lnt <= 0) || (lnt > 0xFFFFFFFF)))
+    r = SCPE_IOERR;
+if (r != SCPE_OK) {
+    fclose (sfile);
+    migrate_free ();
+    return r;
+    }
+memset (&hdr, 0, sizeof (hdr));
+hdr.type = MIG_STATE;
+hdr.lnt = (uint32)lnt;
+rewind (sfile);
+r = migrate_write (mig.sock, &hdr, sizeof (hdr));
+while ((r == SCPE_OK) && (lnt > 0)) {
+    size_t rd = fread (buf, 1, sizeof (buf), sfile);
+
+    if (rd == 0) {
+        r = SCPE_IOERR;
+        break;
+        }
+    r = migrate_write (mig.sock, buf, rd);
+    lnt -= rd;
+    }
+if ((r != SCPE_OK) ||                                   /* target has the state? */
+    (migrate_read (mig.sock, &status, sizeof (status)) != SCPE_OK) ||
+    (status != SCPE_OK)) {
+    fclose (sfile);
+    migrate_free ();
+    return sim_messagef (SCPE_IOERR, "Migration target didn't accept the state, execution can continue here\n");
+    }
+detach_all (0, FALSE);                                  /* let go of files and listeners */
+memset (&hdr, 0, sizeof (hdr));
+hdr.type = MIG_GO;
+if ((migrate_write (mig.sock, &hdr, sizeof (hdr)) != SCPE_OK) ||
+    (migrate_read (mig.sock, &status, sizeof (status)) != SCPE_OK) ||
+    (status != SCPE_OK)) {
+    r = migrate_rest (sfile);                           /* take everything back */
+    fclose (sfile);
+    migrate_free ();
+    return sim_messagef ((r == SCPE_OK) ? SCPE_INCOMP : r, "Migration target failed to restore the state, %s\n",
+                         (r == SCPE_OK) ? "it has been restored here" : "and it can't be restored here");
+    }
+fclose (sfile);
+sim_printf ("Migration complete: %u passes, %.1f MB copied while running, %.1f MB and %.0f ms stopped\n",
+            mig.passes, (double)mig.sent / 1048576.0, (double)state / 1048576.0, (double)(sim_os_msec () - start));
+migrate_free ();
+return SCPE_EXIT;
+}
+
+static t_stat migrate_target (CONST char *cptr)
+{
+char ident[256], peer[256], buf[65536];
+char *peer_addr = NULL;
+SOCKET master, sock;
+int parse_status;
+uint32 status, blocks = 0, ndevs;
+MIGRATE_HDR hdr;
+FILE *rfile = NULL;
+DEVICE *dptr;
+UNIT *uptr;
+t_value val;
+t_addr k;
+size_t sz;
+uint32 j, lnt;
+t_stat r = SCPE_OK;
+
+master = sim_master_sock_ex (cptr, &parse_status, SIM_SOCK_OPT_REUSEADDR | SIM_SOCK_OPT_BLOCKING);
+if (master == INVALID_SOCKET)
+    return sim_messagef (SCPE_OPENERR, "Can't listen for a migration on %s\n", cptr);
+sim_printf ("Waiting for a migration on %s\n", cptr);
+sock = sim_accept_conn_ex (master, &peer_addr, SIM_SOCK_OPT_BLOCKING | SIM_SOCK_OPT_NODELAY);
+sim_close_sock (master);
+if (sock == INVALID_SOCKET)
+    return sim_messagef (SCPE_IOERR, "Migration connection failed\n");
+sim_printf ("Receiving migration from %s\n", peer_addr ? peer_addr : "unknown");
+free (peer_addr);
+migrate_ident (ident, sizeof (ident));
+for (ndevs = 0; sim_devices[ndevs]; ndevs++)
+    ;
+if ((migrate_read (sock, peer, sizeof (peer)) != SCPE_OK) ||
+    (migrate_write (sock, ident, sizeof (ident)) != SCPE_OK)) {
+    sim_close_sock (sock);
+    return sim_messagef (SCPE_IOERR, "Migration connection lost\n");
+    }
+if (memcmp (ident, peer, sizeof (ident)) != 0) {
+    sim_close_sock (sock);
+    return sim_messagef (SCPE_INCOMP, "Migration source is not the same type of simulator\n");
+    }
+while (1) {
+    if (migrate_read (sock, &hdr, sizeof (hdr)) != SCPE_OK) {
+        r = sim_messagef (SCPE_IOERR, "Migration connection lost\n");
+        break;
+        }
+    if ((hdr.type == MIG_BLOCK) || (hdr.type == MIG_ZERO)) {
+        dptr = (hdr.dev < ndevs) ? sim_devices[hdr.dev] : NULL;
+        uptr = (dptr && (hdr.unit < dptr->numunits)) ? dptr->units + hdr.unit : NULL;
+        sz = dptr ? SZ_D (dptr) : 0;
+        k = dptr ? (t_addr)hdr.block * SRBSIZ * dptr->aincr : 0;
+        if ((uptr == NULL) || (dptr->deposit == NULL) ||
+            (hdr.count == 0) || (hdr.count > SRBSIZ) ||
+            (hdr.lnt != ((hdr.type == MIG_ZERO) ? 0 : hdr.count * sz)) ||
+            ((k + (hdr.count - 1) * dptr->aincr) >= uptr->capac)) {
+            r = sim_messagef (SCPE_INCOMP, "Migrated memory doesn't fit this configuration\n");
+            break;
+            }
+        if (migrate_read (sock, buf, hdr.lnt) != SCPE_OK) {
+            r = sim_messagef (SCPE_IOERR, "Migration connection lost\n");
+            break;
+            }
+        for (j = 0; j < hdr.count; j++, k = k + dptr->aincr) {
+            if (hdr.type == MIG_ZERO)
+                val = 0;
+            else {
+                SZ_LOAD (sz, val, buf, j);
+                }
+            r = dptr->deposit (val, k, uptr, SIM_SW_REST);
+            if (r != SCPE_OK)
+                break;
+            }
+        if (r != SCPE_OK)
+            break;
+        ++blocks;
+        continue;
+        }
+    if (hdr.type == MIG_STATE) {
+        if (rfile)
+            fclose (rfile);
+        rfile = tmpfile ();
+        r = (rfile == NULL) ? SCPE_OPENERR : SCPE_OK;
+        for (lnt = hdr.lnt; (r == SCPE_OK) && (lnt > 0); ) {
+            uint32 l = (lnt > sizeof (buf)) ? sizeof (buf) : lnt;
+
+            r = migrate_read (sock, buf, l);
+            if ((r == SCPE_OK) && (fwrite (buf, 1, l, rfile) != l))
+                r = SCPE_IOERR;
+            lnt -= l;
+            }
+        status = r;
+        if ((migrate_write (sock, &status, sizeof (status)) != SCPE_OK) || (r != SCPE_OK)) {
+            r = sim_messagef (SCPE_IOERR, "Migration state transfer failed\n");
+            break;
+            }
+        continue;
+        }
+    if ((hdr.type == MIG_GO) && rfile) {
+        r = migrate_rest (rfile);
+        status = r;
+        (void)migrate_write (sock, &status, sizeof (status));
+        if (r == SCPE_OK)
+            sim_printf ("Migration received: %u memory blocks, execution can continue here\n", blocks);
+        break;
+        }
+    r = sim_messagef (SCPE_IERR, "Invalid migration message: %u\n", hdr.type);
+    break;
+    }
+if (rfile)
+    fclose (rfile);
+sim_close_sock (sock);
+return r;
+}
+
+t_stat migrate_cmd (int32 flag, CONST char *cptr)
+{
+char gbuf[CBUFSIZE], lbuf[CBUFSIZE + 16];
+
+GET_SWITCHES (cptr);                                    /* get switches */
+cptr = get_glyph_nc (cptr, gbuf, 0);
+if (gbuf[0] == '\0')
+    return SCPE_2FARG;
+if (*cptr != '\0')
+    return SCPE_2MARG;
+if (sim_switches & SWMASK ('L')) {
+    if (strchr (gbuf, ':') == NULL) {                   /* port only? */
+        snprintf (lbuf, sizeof (lbuf), "localhost:%s", gbuf);/* not reachable from elsewhere */
+        return migrate_target (lbuf);
+        }
+    return migrate_target (gbuf);
+    }
+return migrate_source (gbuf);
+}
+
+void sim_flush_buffered_files (void)
+{
+uint32 i, j;
+DEVICE *dptr;
+UNIT *uptr;
+
+if (sim_log)                                            /* flush console log */
+    fflush (sim_log);
 if (sim_deb)                                            /* flush debug log */
     _sim_debug_flush ();
 for (i = 1; (dptr = sim_devices[i]) != NULL; i++) {     /* flush attached files */
     for (j = 0; j < dptr->numunits; j++) {              /* if not buffered in mem */
         uptr = dptr->units + j;
         if (uptr->flags & UNIT_ATT) {                   /* attached, */
-            if (uptr->io_flush) {                       /* unit specific flush routine? */
+            if (uptr->spool)                            /* spooled output? */
+                sim_spool_flush (uptr, !sim_is_running);/* writer owns fileref */
+            else if (uptr->io_flush) {                  /* unit specific flush routine? */
                 if (!sim_asynch_enabled ||              /* and asynch I/O not possible? */
-                    !sim_is_running)
+                    !sim_is_running ||
+                    (uptr->dynflags & UNIT_SYNC_FLUSH))
                     uptr->io_flush (uptr);              /* call it */
                 }
             else {
@@ -9295,7 +10835,14 @@ do {
     t_addr *addrs;
 
     while (1) {
+        t_uint64 start_nsec = sim_host_nsec ();
+        double start_insts = sim_gtime ();
+
+        if (sim_perf.start_nsec == 0)
+            sim_perf_clear ();
         r = sim_instr();
+        sim_perf.run_nsec += sim_host_nsec () - start_nsec;
+        sim_perf.run_insts += sim_gtime () - start_insts;
         if (r != SCPE_REMOTE)
             break;
         sim_remote_process_command ();                  /* Process the command and resume processing */
@@ -9351,6 +10898,7 @@ if ((SCPE_BARE_STATUS(r) == SCPE_STOP) &&               /* WRU exit from sim_ins
     sim_os_ms_sleep (sim_stop_sleep_ms);                /* wait a bit for SIGINT */
 sim_is_running = FALSE;                                 /* flag idle */
 sim_stop_timer_services ();                             /* disable wall clock timing */
+sim_metrics_publish ();                                 /* refresh the metrics endpoint snapshot */
 sim_ttcmd ();                                           /* restore console */
 sim_brk_clrall (BRK_TYP_DYN_STEPOVER);                  /* cancel any step/over subroutine breakpoints */
 #ifdef SIGHUP
@@ -9475,6 +11023,222 @@ t_stat step_svc (UNIT *uptr)
 return SCPE_STEP;
 }
 
+/* PC sampling profiler
+
+   While profiling, the INT-PROFILE unit fires on average once every
+   sim_prof_interval instructions and counts the current PC (and, if the
+   simulator provides sim_vm_pc_space, the address space it belongs to)
+   in an open addressed hash table.  The sampling interval is jittered so
+   that samples don't lock step with loops in the simulated program.
+*/
+
+typedef struct PROFILE_BIN {
+    t_value             pc;                     /* sampled PC */
+    const char          *space;                 /* address space (or NULL) */
+    t_uint64            count;                  /* samples */
+    } PROFILE_BIN;
+
+static PROFILE_BIN *sim_prof_bins = NULL;       /* histogram */
+static uint32 sim_prof_size = 0;                /* histogram size (power of 2) */
+static uint32 sim_prof_used = 0;                /* bins in use */
+static t_uint64 sim_prof_samples = 0;           /* samples taken */
+static uint32 sim_prof_seed = 1;                /* interval jitter state */
+static int32 sim_prof_interval = 1000;          /* mean instructions per sample */
+static t_bool sim_prof_active = FALSE;
+
+static uint32 _sim_prof_hash (t_value pc, const char *space)
+{
+t_uint64 h = (t_uint64)pc ^ ((t_uint64)(size_t)space << 17);
+
+h *= 0x9E3779B97F4A7C15ull;
+return (uint32)(h >> 32);
+}
+
+static PROFILE_BIN *_sim_prof_find (PROFILE_BIN *bins, uint32 size, t_value pc, const char *space)
+{
+uint32 i = _sim_prof_hash (pc, space) & (size - 1);
+
+while ((bins[i].count != 0) &&
+       ((bins[i].pc != pc) || (bins[i].space != space)))
+    i = (i + 1) & (size - 1);
+return &bins[i];
+}
+
+static t_bool _sim_prof_grow (void)
+{
+uint32 i, size = sim_prof_size ? 2 * sim_prof_size : 4096;
+PROFILE_BIN *bins = (PROFILE_BIN *)calloc (size, sizeof (*bins));
+
+if (bins == NULL)
+    return FALSE;
+for (i = 0; i < sim_prof_size; i++)
+    if (sim_prof_bins[i].count)
+        *_sim_prof_find (bins, size, sim_prof_bins[i].pc, sim_prof_bins[i].space) = sim_prof_bins[i];
+free (sim_prof_bins);
+sim_prof_bins = bins;
+sim_prof_size = size;
+return TRUE;
+}
+
+static int32 _sim_prof_next (void)
+{
+sim_prof_seed = sim_prof_seed * 1103515245 + 12345;
+return (sim_prof_interval / 2) + (int32)((sim_prof_seed >> 8) % (uint32)sim_prof_interval) + 1;
+}
+
+t_stat profile_svc (UNIT *uptr)
+{
+t_value pc = sim_vm_pc_value ? (*sim_vm_pc_value)() : get_rval (sim_PC, 0);
+const char *space = sim_vm_pc_space ? (*sim_vm_pc_space)() : NULL;
+PROFILE_BIN *bin;
+
+if ((4 * (sim_prof_used + 1) > 3 * sim_prof_size) &&   /* keep the table at most 3/4 full */
+    (!_sim_prof_grow ()))
+    return sim_activate (uptr, _sim_prof_next ());      /* out of memory, lose sample */
+bin = _sim_prof_find (sim_prof_bins, sim_prof_size, pc, space);
+if (bin->count++ == 0) {
+    bin->pc = pc;
+    bin->space = space;
+    ++sim_prof_used;
+    }
+++sim_prof_samples;
+return sim_activate (uptr, _sim_prof_next ());
+}
+
+static int _sim_prof_compare (const void *pa, const void *pb)
+{
+const PROFILE_BIN *a = (const PROFILE_BIN *)pa;
+const PROFILE_BIN *b = (const PROFILE_BIN *)pb;
+
+if (a->count != b->count)
+    return (a->count < b->count) ? 1 : -1;
+return (a->pc < b->pc) ? -1 : (a->pc > b->pc);
+}
+
+static void _sim_prof_show (FILE *st, uint32 count)
+{
+DEVICE *dptr = sim_dflt_dev;
+PROFILE_BIN *sorted;
+double cumulative = 0.0;
+uint32 i, j, n;
+t_addr k;
+t_stat r;
+
+fprintf (st, "%s samples, %u distinct PCs, one sample per %d %s on average%s\n",
+             sim_fmt_numeric ((double)sim_prof_samples), sim_prof_used, sim_prof_interval,
+             sim_vm_interval_units, sim_prof_active ? "" : " (stopped)");
+if ((sim_prof_used == 0) || (sim_PC == NULL))
+    return;
+sorted = (PROFILE_BIN *)malloc (sim_prof_used * sizeof (*sorted));
+if (sorted == NULL)
+    return;
+for (i = n = 0; i < sim_prof_size; i++)
+    if (sim_prof_bins[i].count)
+        sorted[n++] = sim_prof_bins[i];
+qsort (sorted, n, sizeof (*sorted), _sim_prof_compare);
+if ((count == 0) || (count > n))
+    count = n;
+fprintf (st, "\n     Samples      %%    Cum%%  %s%s\n", sim_vm_pc_space ? "Mode " : "", sim_PC->name);
+for (i = 0; i < count; i++) {
+    double pct = (100.0 * sorted[i].count) / sim_prof_samples;
+
+    cumulative += pct;
+    fprintf (st, "%12" LL_FMT "u %6.2f %6.2f  ", (LL_TYPE)sorted[i].count, pct, cumulative);
+    if (sim_vm_pc_space)
+        fprintf (st, "%-4s ", sorted[i].space ? sorted[i].space : "");
+    if ((sim_PC->flags & REG_VMAD) && sim_vm_fprint_addr)
+        sim_vm_fprint_addr (st, dptr, (t_addr)sorted[i].pc);
+    else
+        fprint_val (st, sorted[i].pc, sim_PC->radix, sim_PC->width, sim_PC->flags & REG_FMT);
+    if ((dptr != NULL) && (dptr->examine != NULL)) {     /* symbolize with the current mapping */
+        for (j = 0; j < (uint32)sim_emax; j++)
+            sim_eval[j] = 0;
+        for (j = 0, k = (t_addr)sorted[i].pc, r = SCPE_OK; j < (uint32)sim_emax; j++, k = k + dptr->aincr) {
+            if ((r = dptr->examine (&sim_eval[j], k, dptr->units, SWMASK ('V'))) != SCPE_OK)
+                break;
+            }
+        if ((r == SCPE_OK) || (j > 0)) {
+            fprintf (st, "  ");
+            if (fprint_sym (st, (t_addr)sorted[i].pc, sim_eval, NULL, SWMASK ('M')) > 0)
+                fprint_val (st, sim_eval[0], dptr->dradix, dptr->dwidth, PV_RZRO);
+            }
+        }
+    fprintf (st, "\n");
+    }
+free (sorted);
+}
+
+static t_stat sim_int_profile_reset (DEVICE *dptr)
+{
+if (sim_prof_active && !sim_is_active (dptr->units))
+    return sim_activate (dptr->units, _sim_prof_next ());
+return SCPE_OK;
+}
+
+/* PROFILE command
+
+   PROFILE START {interval}     start (restart) sampling
+   PROFILE STOP                 stop sampling
+   PROFILE SHOW {count}         display the hottest sampled PCs
+*/
+
+t_stat profile_cmd (int32 flag, CONST char *cptr)
+{
+char gbuf[CBUFSIZE];
+int32 num = 0;
+t_stat r;
+
+GET_SWITCHES (cptr);                                    /* get switches */
+cptr = get_glyph (cptr, gbuf, 0);
+if (MATCH_CMD (gbuf, "START") == 0) {
+    if (*cptr) {
+        cptr = get_glyph (cptr, gbuf, 0);
+        num = (int32) get_uint (gbuf, 10, INT_MAX, &r);
+        if ((r != SCPE_OK) || (num < 2))
+            return sim_messagef (SCPE_ARG, "Invalid sampling interval: %s\n", gbuf);
+        sim_prof_interval = num;
+        }
+    if (*cptr)
+        return sim_messagef (SCPE_2MARG, "Too many arguments: %s\n", cptr);
+    if (sim_PC == NULL)
+        return sim_messagef (SCPE_NOFNC, "%s doesn't identify its PC\n", sim_name);
+    free (sim_prof_bins);
+    sim_prof_bins = NULL;
+    sim_prof_size = sim_prof_used = 0;
+    sim_prof_samples = 0;
+    if (!_sim_prof_grow ())
+        return SCPE_MEM;
+    sim_prof_active = TRUE;
+    sim_cancel (&sim_profile_unit);
+    return sim_activate (&sim_profile_unit, _sim_prof_next ());
+    }
+if (MATCH_CMD (gbuf, "STOP") == 0) {
+    if (*cptr)
+        return sim_messagef (SCPE_2MARG, "Too many arguments: %s\n", cptr);
+    sim_prof_active = FALSE;
+    return sim_cancel (&sim_profile_unit);
+    }
+if (MATCH_CMD (gbuf, "SHOW") == 0) {
+    if (*cptr) {
+        cptr = get_glyph (cptr, gbuf, 0);
+        num = (int32) get_uint (gbuf, 10, INT_MAX, &r);
+        if (r != SCPE_OK)
+            return sim_messagef (SCPE_ARG, "Invalid count: %s\n", gbuf);
+        }
+    else
+        num = 20;
+    if (*cptr)
+        return sim_messagef (SCPE_2MARG, "Too many arguments: %s\n", cptr);
+    if ((sim_prof_samples == 0) && !sim_prof_active)
+        return sim_messagef (SCPE_OK, "No profile has been recorded\n");
+    _sim_prof_show (stdout, (uint32)num);
+    if (sim_log)
+        _sim_prof_show (sim_log, (uint32)num);
+    return SCPE_OK;
+    }
+return sim_messagef (SCPE_ARG, "PROFILE needs START, STOP or SHOW: %s\n", gbuf);
+}
+
 /* Unit service for run for timeout, originally scheduled by RUNFOR n command
    Return runlimit timeout SCP code, will cause simulation to stop */
 
@@ -10342,6 +12106,20 @@ for (tptr = cptr; tptr < (cptr + size); tptr++) {       /* remove cr or nl */
         break;
         }
     }
+cptr = do_trim_line (cptr);
+
+#if defined (SIM_HAVE_DLOPEN)
+if (prompt && p_add_history && *cptr)                   /* Save non blank lines in history */
+    p_add_history (cptr);
+#endif
+
+return cptr;
+}
+
+/* Trim a command line, removing a UTF8 BOM, surrounding whitespace and comments */
+
+static char *do_trim_line (char *cptr)
+{
 if (0 == memcmp (cptr, "\xEF\xBB\xBF", 3))              /* Skip/ignore UTF8_BOM */
     memmove (cptr, cptr + 3, strlen (cptr + 3));
 while (sim_isspace (*cptr))                             /* trim leading spc */
@@ -10352,12 +12130,6 @@ if ((*cptr == ';') || (*cptr == '#')) {                 /* ignore comment */
         sim_printf("%s> %s\n", do_position(), cptr);
     *cptr = 0;
     }
-
-#if defined (SIM_HAVE_DLOPEN)
-if (prompt && p_add_history && *cptr)                   /* Save non blank lines in history */
-    p_add_history (cptr);
-#endif
-
 return cptr;
 }
 
@@ -10816,9 +12588,168 @@ free (string);
 }
 
 
-/* Find_device          find device matching input string
+/* Device and register name index
 
-   Inputs:
+   find_dev, find_reg and find_reg_glob look names up in a hash table
+   holding every device name, logical name and register name of the
+   devices in sim_devices and sim_internal_devices.  Entries for the same
+   name are held in device order, so lookups give the same answer as a
+   linear scan.  Disabled devices are filtered at lookup time, so enabling
+   or disabling a device needs no index maintenance.
+
+   The index is rebuilt when it is first used after the device list, a
+   device's name or logical name, or a device's register array changes;
+   these are checked against a snapshot taken when it was built.  REG
+   pointers returned are the entries of the device's register array, so
+   callers may hold on to them for repeated access.
+*/
+
+typedef struct {
+    const char          *name;                          /* name, NULL if empty */
+    size_t              lnt;                            /* name length */
+    DEVICE              *dptr;                          /* device */
+    REG                 *rptr;                          /* register, NULL for device names */
+    } NAME_ENT;
+
+typedef struct {
+    DEVICE              *dptr;
+    const char          *name;
+    const char          *lname;
+    REG                 *regs;
+    } NAME_SNAP;
+
+static NAME_ENT *sim_name_tab = NULL;                   /* hash table */
+static uint32 sim_name_mask = 0;                        /* table size - 1 */
+static NAME_SNAP *sim_name_snap = NULL;                 /* devices when built */
+static uint32 sim_name_nsnap = 0;
+static t_bool sim_name_valid = FALSE;
+
+static uint32 sim_name_hash (const char *name, size_t lnt)
+{
+uint32 hash = 2166136261u;                              /* FNV-1a */
+
+while (lnt--)
+    hash = (hash ^ (uint8)*name++) * 16777619u;
+return hash;
+}
+
+static void sim_name_invalidate (void)
+{
+sim_name_valid = FALSE;
+}
+
+static void sim_name_insert (const char *name, DEVICE *dptr, REG *rptr)
+{
+size_t lnt = strlen (name);
+uint32 i = sim_name_hash (name, lnt) & sim_name_mask;
+
+while (sim_name_tab[i].name != NULL)                    /* linear probe */
+    i = (i + 1) & sim_name_mask;
+sim_name_tab[i].name = name;
+sim_name_tab[i].lnt = lnt;
+sim_name_tab[i].dptr = dptr;
+sim_name_tab[i].rptr = rptr;
+}
+
+/* Make sure the index describes the current devices; returns FALSE if
+   it cannot be built, in which case callers fall back to linear scans */
+
+static t_bool sim_name_check (void)
+{
+DEVICE *dptr, **devs, **dptrptr[] = {sim_devices, sim_internal_devices, NULL};
+uint32 i, j, n, size;
+REG *rptr;
+
+if (sim_name_valid) {                                   /* validate snapshot */
+    n = 0;
+    for (j = 0; (devs = dptrptr[j]) != NULL; j++) {
+        for (i = 0; (dptr = devs[i]) != NULL; i++, n++) {
+            if ((n >= sim_name_nsnap) ||
+                (sim_name_snap[n].dptr != dptr) ||
+                (sim_name_snap[n].name != dptr->name) ||
+                (sim_name_snap[n].lname != dptr->lname) ||
+                (sim_name_snap[n].regs != dptr->registers))
+                break;
+            }
+        if (dptr != NULL)
+            break;
+        }
+    if ((devs == NULL) && (n == sim_name_nsnap))
+        return TRUE;
+    }
+n = size = 0;                                           /* count names */
+for (j = 0; (devs = dptrptr[j]) != NULL; j++) {
+    for (i = 0; (dptr = devs[i]) != NULL; i++, n++) {
+        size += 2;
+        for (rptr = dptr->registers; rptr && rptr->name; rptr++)
+            size++;
+        }
+    }
+free (sim_name_tab);
+free (sim_name_snap);
+for (sim_name_mask = 63; sim_name_mask < 2 * size; )    /* at most half full */
+    sim_name_mask = (sim_name_mask << 1) | 1;
+sim_name_tab = (NAME_ENT *) calloc (sim_name_mask + 1, sizeof (*sim_name_tab));
+sim_name_snap = (NAME_SNAP *) calloc (n + 1, sizeof (*sim_name_snap));
+sim_name_nsnap = n;
+if ((sim_name_tab == NULL) || (sim_name_snap == NULL)) {
+    free (sim_name_tab);
+    free (sim_name_snap);
+    sim_name_tab = NULL;
+    sim_name_snap = NULL;
+    sim_name_valid = FALSE;
+    return FALSE;
+    }
+n = 0;
+for (j = 0; (devs = dptrptr[j]) != NULL; j++) {         /* device names first */
+    for (i = 0; (dptr = devs[i]) != NULL; i++, n++) {
+        sim_name_snap[n].dptr = dptr;
+        sim_name_snap[n].name = dptr->name;
+        sim_name_snap[n].lname = dptr->lname;
+        sim_name_snap[n].regs = dptr->registers;
+        sim_name_insert (dptr->name, dptr, NULL);
+        if (dptr->lname)
+            sim_name_insert (dptr->lname, dptr, NULL);
+        }
+    }
+for (j = 0; (devs = dptrptr[j]) != NULL; j++) {         /* then registers */
+    for (i = 0; (dptr = devs[i]) != NULL; i++) {
+        for (rptr = dptr->registers; rptr && rptr->name; rptr++)
+            sim_name_insert (rptr->name, dptr, rptr);
+        }
+    }
+sim_name_valid = TRUE;
+return TRUE;
+}
+
+/* Return the first index entry for a name; successive entries for it are
+   found by continuing the probe with sim_name_next */
+
+#define SIM_NAME_STEP(nptr) (((nptr) == &sim_name_tab[sim_name_mask])? sim_name_tab: (nptr) + 1)
+
+static NAME_ENT *sim_name_find (NAME_ENT *nptr, const char *name, size_t lnt)
+{
+while (nptr->name != NULL) {
+    if ((nptr->lnt == lnt) && (memcmp (nptr->name, name, lnt) == 0))
+        return nptr;
+    nptr = SIM_NAME_STEP (nptr);
+    }
+return NULL;
+}
+
+static NAME_ENT *sim_name_first (const char *name, size_t lnt)
+{
+return sim_name_find (&sim_name_tab[sim_name_hash (name, lnt) & sim_name_mask], name, lnt);
+}
+
+static NAME_ENT *sim_name_next (NAME_ENT *nptr, const char *name, size_t lnt)
+{
+return sim_name_find (SIM_NAME_STEP (nptr), name, lnt);
+}
+
+/* Find_device          find device matching input string
+
+   Inputs:
         cptr    =       pointer to input string
    Outputs:
         result  =       pointer to device
@@ -10828,9 +12759,19 @@ DEVICE *find_dev (const char *cptr)
 {
 int32 i;
 DEVICE *dptr;
+NAME_ENT *nptr;
 
 if (cptr == NULL)
     return NULL;
+if (sim_name_check ()) {                                /* indexed? */
+    size_t lnt = strlen (cptr);
+
+    for (nptr = sim_name_first (cptr, lnt); nptr != NULL; nptr = sim_name_next (nptr, cptr, lnt)) {
+        if (nptr->rptr == NULL)
+            return nptr->dptr;
+        }
+    return NULL;
+    }
 for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {
     if ((strcmp (cptr, dptr->name) == 0) ||
         (dptr->lname &&
@@ -10921,6 +12862,7 @@ for (i = 0; i < sim_internal_device_count; i++)
 for (i = 0; (sim_devices[i] != NULL); i++)
     if (sim_devices[i] == dptr)
         return SCPE_OK;
+sim_name_invalidate ();
 ++sim_internal_device_count;
 sim_internal_devices = (DEVICE **)realloc(sim_internal_devices, (sim_internal_device_count+1)*sizeof(*sim_internal_devices));
 sim_internal_devices[sim_internal_device_count-1] = dptr;
@@ -10990,10 +12932,47 @@ REG *find_reg_glob_reason (CONST char *cptr, CONST char **optr, DEVICE **gdptr,
 int32 i, j;
 DEVICE *dptr, **devs, **dptrptr[] = {sim_devices, sim_internal_devices, NULL};
 REG *rptr, *srptr = NULL;
+NAME_ENT *nptr;
+CONST char *tptr;
 
 if (stat)
     *stat = SCPE_OK;
 *gdptr = NULL;
+if (cptr == NULL)
+    return NULL;
+if (sim_name_check ()) {                                /* indexed? */
+    tptr = find_reg_name_end (cptr);
+    for (nptr = sim_name_first (cptr, tptr - cptr); nptr != NULL;
+         nptr = sim_name_next (nptr, cptr, tptr - cptr)) {
+        if ((nptr->rptr == NULL) ||                     /* device name or */
+            (nptr->dptr->flags & DEV_DIS) ||            /* disabled device or */
+            (nptr->dptr == *gdptr))                     /* already found here? */
+            continue;
+        if (srptr) {                                    /* ambig? err */
+            if (stat) {
+                if (sim_show_message) {
+                    if (*stat == SCPE_OK)
+                        sim_printf ("Ambiguous register.  %s appears in devices %s and %s", cptr, (*gdptr)->name, nptr->dptr->name);
+                    else
+                        sim_printf (" and %s", nptr->dptr->name);
+                    }
+                *stat = SCPE_AMBREG|SCPE_NOMESSAGE;
+                }
+            else
+                return NULL;
+            }
+        srptr = nptr->rptr;                             /* save reg */
+        *gdptr = nptr->dptr;                            /* save unit */
+        if (optr != NULL)
+            *optr = tptr;
+        }
+    if (stat && (*stat != SCPE_OK)) {
+        if (sim_show_message)
+            sim_printf ("\n");
+        srptr = NULL;
+        }
+    return srptr;
+    }
 for (j = 0; (devs = dptrptr[j]) != NULL; j++) {
     for (i = 0; (dptr = devs[i]) != NULL; i++) {        /* all dev */
         if (dptr->flags & DEV_DIS)                          /* skip disabled */
@@ -11041,19 +13020,44 @@ return find_reg_glob_reason (cptr, optr, gdptr, NULL);
         *optr   =       pointer to next character in input string
 */
 
+static CONST char *find_reg_name_end (CONST char *cptr)
+{
+CONST char *tptr = cptr;
+
+do {
+    tptr++;
+    } while (sim_isalnum (*tptr) || (*tptr == '*') || (*tptr == '_') || (*tptr == '.'));
+return tptr;
+}
+
 REG *find_reg (CONST char *cptr, CONST char **optr, DEVICE *dptr)
 {
 CONST char *tptr;
 REG *rptr;
 size_t slnt;
+NAME_ENT *nptr;
 
 if ((cptr == NULL) || (dptr == NULL) || (dptr->registers == NULL))
     return NULL;
-tptr = cptr;
-do {
-    tptr++;
-    } while (sim_isalnum (*tptr) || (*tptr == '*') || (*tptr == '_') || (*tptr == '.'));
+tptr = find_reg_name_end (cptr);
 slnt = tptr - cptr;
+if (sim_name_check ()) {                                /* index built? */
+    size_t dlnt = strlen (dptr->name);
+
+    nptr = sim_name_first (dptr->name, dlnt);
+    while ((nptr != NULL) && (nptr->dptr != dptr))      /* device in it? */
+        nptr = sim_name_next (nptr, dptr->name, dlnt);
+    if (nptr != NULL) {
+        for (nptr = sim_name_first (cptr, slnt); nptr != NULL; nptr = sim_name_next (nptr, cptr, slnt)) {
+            if ((nptr->dptr == dptr) && (nptr->rptr != NULL)) {
+                if (optr != NULL)
+                    *optr = tptr;
+                return nptr->rptr;
+                }
+            }
+        return NULL;
+        }
+    }
 for (rptr = dptr->registers; rptr->name != NULL; rptr++) {
     if ((slnt == strlen (rptr->name)) &&
         (strncmp (cptr, rptr->name, slnt) == 0)) {
@@ -11893,6 +13897,15 @@ return buf;
    The event queue is maintained in clock order; entry timeouts are
    RELATIVE to the time in the previous entry.
 
+   To avoid walking the whole queue on every insertion, the queue is
+   also indexed by a skip list threaded through the queued units.  Each
+   queued unit carries an order key (q_key) such that the difference
+   between the keys of two entries is the sum of the relative times
+   between them.  Advancing time only changes the head entry's relative
+   time, so the keys never need to be adjusted.  Entries with the same
+   key are kept in insertion order, exactly as the linear scan did, and
+   the next chain remains the authoritative, ordered queue.
+
    sim_process_event - process event
 
    Inputs:
@@ -11902,6 +13915,100 @@ return buf;
                         or 0 (SCPE_OK) if no exceptions
 */
 
+static uint32 _sim_queue_level (void)
+{
+uint32 level = 1;
+uint32 bits;
+
+sim_clock_skip_seed = sim_clock_skip_seed * 1103515245 + 12345;
+bits = sim_clock_skip_seed >> 16;
+while ((level < SIM_QUEUE_LEVELS) && ((bits & 3) == 0)) {
+    ++level;
+    bits >>= 2;
+    }
+return level;
+}
+
+/* _sim_queue_insert - link a unit into the event queue after all entries
+                       whose key is less than or equal to its key
+
+   Returns the unit's predecessor on the queue (NULL if it's now the head)
+*/
+
+static UNIT *_sim_queue_insert (UNIT *uptr, double key)
+{
+UNIT *update[SIM_QUEUE_LEVELS-1];
+UNIT *prvptr = NULL;
+UNIT *nptr;
+int32 lvl;
+
+for (lvl = SIM_QUEUE_LEVELS - 2; lvl >= 0; lvl--) {
+    nptr = prvptr ? prvptr->q_fwd[lvl] : sim_clock_skip[lvl];
+    while ((nptr != NULL) && (nptr->q_key <= key)) {
+        prvptr = nptr;
+        nptr = nptr->q_fwd[lvl];
+        }
+    update[lvl] = prvptr;
+    }
+nptr = prvptr ? prvptr->next : sim_clock_queue;
+while ((nptr != QUEUE_LIST_END) && (nptr->q_key <= key)) {
+    prvptr = nptr;
+    nptr = nptr->next;
+    }
+uptr->q_key = key;
+uptr->next = nptr;
+uptr->q_prev = prvptr;
+if (prvptr)
+    prvptr->next = uptr;
+else
+    sim_clock_queue = uptr;
+if (nptr != QUEUE_LIST_END)
+    nptr->q_prev = uptr;
+uptr->q_level = _sim_queue_level ();
+for (lvl = 0; lvl < (int32)uptr->q_level - 1; lvl++) {
+    nptr = update[lvl] ? update[lvl]->q_fwd[lvl] : sim_clock_skip[lvl];
+    uptr->q_fwd[lvl] = nptr;
+    uptr->q_bwd[lvl] = update[lvl];
+    if (update[lvl])
+        update[lvl]->q_fwd[lvl] = uptr;
+    else
+        sim_clock_skip[lvl] = uptr;
+    if (nptr)
+        nptr->q_bwd[lvl] = uptr;
+    }
+return prvptr;
+}
+
+/* _sim_queue_remove - unlink a unit from the event queue
+
+   Returns the unit's successor on the queue
+*/
+
+static UNIT *_sim_queue_remove (UNIT *uptr)
+{
+UNIT *nptr = uptr->next;
+int32 lvl;
+
+if (uptr->q_prev)
+    uptr->q_prev->next = nptr;
+else
+    sim_clock_queue = nptr;
+if (nptr != QUEUE_LIST_END)
+    nptr->q_prev = uptr->q_prev;
+for (lvl = 0; lvl < (int32)uptr->q_level - 1; lvl++) {
+    if (uptr->q_bwd[lvl])
+        uptr->q_bwd[lvl]->q_fwd[lvl] = uptr->q_fwd[lvl];
+    else
+        sim_clock_skip[lvl] = uptr->q_fwd[lvl];
+    if (uptr->q_fwd[lvl])
+        uptr->q_fwd[lvl]->q_bwd[lvl] = uptr->q_bwd[lvl];
+    }
+uptr->next = NULL;                                      /* hygiene */
+uptr->q_prev = NULL;
+uptr->q_level = 0;
+return nptr;
+}
+
 t_stat sim_process_event (void)
 {
 UNIT *uptr;
@@ -11945,8 +14052,7 @@ else
     sim_interval_catchup = 0;
 do {
     uptr = sim_clock_queue;                             /* get first */
-    sim_clock_queue = uptr->next;                       /* remove first */
-    uptr->next = NULL;                                  /* hygiene */
+    _sim_queue_remove (uptr);                           /* remove first */
     uptr->time = 0;
     if (sim_clock_queue != QUEUE_LIST_END) {
         if (sim_interval_catchup < 0)
@@ -11962,13 +14068,28 @@ do {
         }
     else {
         sim_debug (SIM_DBG_EVENT, &sim_scp_dev, "Processing Event for %s\n", sim_uname (uptr));
-        if (uptr->action != NULL)
+        if (uptr->action != NULL) {
+            DEVICE *dptr = uptr->dptr ? uptr->dptr : find_dev_from_unit (uptr);
+            t_uint64 start_nsec = sim_host_nsec ();
+            t_uint64 nsec;
+
+            SIM_HOST_MARK_BEGIN (SIM_MARK_EVENT, dptr ? dptr->name : NULL);
             reason = uptr->action (uptr);
+            SIM_HOST_MARK_END (SIM_MARK_EVENT);
+            nsec = sim_host_nsec () - start_nsec;
+            sim_perf.event_count++;
+            sim_perf.event_nsec += nsec;
+            if (dptr) {
+                dptr->perf_events++;
+                dptr->perf_nsec += nsec;
+                }
+            }
         else
             reason = SCPE_OK;
         }
     AIO_EVENT_COMPLETE(uptr, reason);
-    if (sim_interval_catchup < -1) {
+    if ((sim_interval_catchup < -1) &&
+        (sim_clock_queue != QUEUE_LIST_END)) {          /* queue may have drained */
         sim_interval_catchup += sim_clock_queue->time;
         sim_time += sim_clock_queue->time;
         sim_rtime += sim_clock_queue->time;
@@ -12029,7 +14150,7 @@ return _sim_activate (uptr, event_time);
 t_stat _sim_activate (UNIT *uptr, int32 event_time)
 {
 UNIT *cptr, *prvptr;
-int32 accum;
+double key;
 
 AIO_ACTIVATE (_sim_activate, uptr, event_time);
 if (sim_is_active (uptr))                               /* already active? */
@@ -12038,23 +14159,16 @@ UPDATE_SIM_TIME;                                        /* update sim time */
 
 sim_debug (SIM_DBG_ACTIVATE, &sim_scp_dev, "Activating %s delay=%d\n", sim_uname (uptr), event_time);
 
-prvptr = NULL;
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (event_time < (accum + cptr->time))
-        break;
-    accum = accum + cptr->time;
-    prvptr = cptr;
-    }
-if (prvptr == NULL) {                                   /* insert at head */
-    cptr = uptr->next = sim_clock_queue;
-    sim_clock_queue = uptr;
-    }
-else {
-    cptr = uptr->next = prvptr->next;                   /* insert at prvptr */
-    prvptr->next = uptr;
-    }
-uptr->time = event_time - accum;
+if (sim_clock_queue == QUEUE_LIST_END)
+    key = (double)event_time;
+else
+    key = sim_clock_queue->q_key - sim_clock_queue->time + event_time;
+prvptr = _sim_queue_insert (uptr, key);
+cptr = uptr->next;
+if (prvptr == NULL)                                     /* inserted at head */
+    uptr->time = event_time;
+else
+    uptr->time = (int32)(key - prvptr->q_key);
 if (cptr != QUEUE_LIST_END)
     cptr->time = cptr->time - uptr->time;
 sim_interval = sim_clock_queue->time;
@@ -12156,7 +14270,7 @@ return sim_timer_activate_after (uptr, usec_delay);
 
 t_stat sim_cancel (UNIT *uptr)
 {
-UNIT *cptr, *nptr;
+UNIT *nptr;
 
 AIO_VALIDATE(uptr);
 if ((uptr->cancel) && uptr->cancel (uptr))
@@ -12173,19 +14287,8 @@ UPDATE_SIM_TIME;                                        /* update sim time */
 sim_debug (SIM_DBG_EVENT, &sim_scp_dev, "Canceling Event for %s\n", sim_uname(uptr));
 nptr = QUEUE_LIST_END;
 
-if (sim_clock_queue == uptr) {
-    nptr = sim_clock_queue = uptr->next;
-    uptr->next = NULL;                                  /* hygiene */
-    }
-else {
-    for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-        if (cptr->next == uptr) {
-            nptr = cptr->next = uptr->next;
-            uptr->next = NULL;                          /* hygiene */
-            break;                                      /* end queue scan */
-            }
-        }
-    }
+if (uptr->q_level)                                      /* on the clock queue? */
+    nptr = _sim_queue_remove (uptr);
 if (nptr != QUEUE_LIST_END)
     nptr->time += (uptr->next) ? 0 : uptr->time;
 if (!uptr->next)
@@ -12229,21 +14332,14 @@ return (((uptr->next) || AIO_IS_ACTIVE(uptr) || ((uptr->dynflags & UNIT_TMR_UNIT
 
 int32 _sim_activate_queue_time (UNIT *uptr)
 {
-UNIT *cptr;
 int32 accum;
 
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (cptr == sim_clock_queue) {
-        if (sim_interval > 0)
-            accum = accum + sim_interval;
-        }
-    else
-        accum = accum + cptr->time;
-    if (cptr == uptr)
-        return accum + 1;
-    }
-return 0;
+if ((uptr->q_level == 0) || (sim_clock_queue == QUEUE_LIST_END))
+    return 0;
+accum = (int32)(uptr->q_key - sim_clock_queue->q_key);
+if (sim_interval > 0)
+    accum = accum + sim_interval;
+return accum + 1;
 }
 
 int32 _sim_activate_time (UNIT *uptr)
@@ -12268,7 +14364,6 @@ return _sim_activate_time (uptr);
 
 double sim_activate_time_usecs (UNIT *uptr)
 {
-UNIT *cptr;
 int32 accum;
 double result;
 
@@ -12276,18 +14371,10 @@ AIO_VALIDATE(uptr);
 result = sim_timer_activate_time_usecs (uptr);
 if (result >= 0)
     return result;
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (cptr == sim_clock_queue) {
-        if (sim_interval > 0)
-            accum = accum + sim_interval;
-        }
-    else
-        accum = accum + cptr->time;
-    if (cptr == uptr)
-        return 1.0 + uptr->usecs_remaining + ((1000000.0 * accum) / sim_timer_inst_per_sec ());
-    }
-return 0.0;
+accum = _sim_activate_queue_time (uptr);
+if (accum == 0)
+    return 0.0;
+return 1.0 + uptr->usecs_remaining + ((1000000.0 * (accum - 1)) / sim_timer_inst_per_sec ());
 }
 
 /* sim_gtime - return global time
@@ -12349,6 +14436,22 @@ return cnt;
    is the bitwise OR of all the type fields).  A simulator need only check for
    a breakpoint of type X if bit SWMASK('X') is set in sim_brk_summ.
 
+   sim_brk_map summarizes the addresses which have breakpoints.  Each bit
+   covers a group of 2**SIM_BRK_MAP_SHIFT addresses, with the group number
+   folded modulo SIM_BRK_MAP_BITS.  A clear bit means no breakpoint exists
+   anywhere in the groups that fold onto it, so sim_brk_test can reject most
+   addresses with a single memory reference and only searches the table
+   when the bit is set.
+
+   sim_brk_watch_map is a similar summary, for the breakpoint types listed
+   in sim_brk_watch_types (memory read and write watchpoints), with one bit
+   per page of 2**sim_brk_watch_shift addresses.  A simulator tests it with
+   SIM_BRK_WATCHED (addr) instead of calling sim_brk_test on every data
+   access.  A simulator with a translation buffer can instead keep watched
+   pages out of its TB, so that only accesses to them take the slow path;
+   sim_vm_watch_change is called whenever a page becomes watched so that
+   any cached translations of it can be discarded.
+
    The package contains the following public routines:
 
         sim_brk_init            initialize
@@ -12386,6 +14489,8 @@ sim_brk_tab = (BRKTAB **) realloc (sim_brk_tab, sim_brk_lnt*sizeof (BRKTAB*));
 if (sim_brk_tab == NULL)
     return SCPE_MEM;
 memset (sim_brk_tab, 0, sim_brk_lnt*sizeof (BRKTAB*));
+memset (sim_brk_map, 0, sizeof (sim_brk_map));
+memset (sim_brk_watch_map, 0, sizeof (sim_brk_watch_map));
 sim_brk_ent = sim_brk_ins = 0;
 sim_brk_clract ();
 sim_brk_npc (0);
@@ -12474,6 +14579,7 @@ bp->addr = loc;
 bp->typ = btyp;
 bp->cnt = 0;
 bp->act = NULL;
+sim_brk_map[SIM_BRK_MAP_IDX (loc) >> 5] |= 1u << (SIM_BRK_MAP_IDX (loc) & 31);
 for (i = 0; i < SIM_BKPT_N_SPC; i++)
     bp->time_fired[i] = -1.0;
 return bp;
@@ -12519,6 +14625,11 @@ if ((act != NULL) && (*act != 0)) {                     /* new action? */
     bp->act = newp;                                     /* set pointer */
     }
 sim_brk_summ = sim_brk_summ | (sw & ~BRK_TYP_TEMP);
+if ((sw & sim_brk_watch_types) && !SIM_BRK_WATCHED (loc)) { /* newly watched page? */
+    sim_brk_watch_map[SIM_BRK_WATCH_IDX (loc) >> 5] |= 1u << (SIM_BRK_WATCH_IDX (loc) & 31);
+    if (sim_vm_watch_change)                            /* discard cached translations */
+        sim_vm_watch_change ();
+    }
 return SCPE_OK;
 }
 
@@ -12556,10 +14667,15 @@ if (sim_brk_tab[sim_brk_ins] == NULL) {                 /* erased entry */
         sim_brk_tab[i] = sim_brk_tab[i+1];
     }
 sim_brk_summ = 0;                                       /* recalc summary */
+memset (sim_brk_map, 0, sizeof (sim_brk_map));          /* and address maps */
+memset (sim_brk_watch_map, 0, sizeof (sim_brk_watch_map));
 for (i = 0; i < sim_brk_ent; i++) {
     bp = sim_brk_tab[i];
+    sim_brk_map[SIM_BRK_MAP_IDX (bp->addr) >> 5] |= 1u << (SIM_BRK_MAP_IDX (bp->addr) & 31);
     while (bp) {
         sim_brk_summ |= (bp->typ & ~BRK_TYP_TEMP);
+        if (bp->typ & sim_brk_watch_types)
+            sim_brk_watch_map[SIM_BRK_WATCH_IDX (bp->addr) >> 5] |= 1u << (SIM_BRK_WATCH_IDX (bp->addr) & 31);
         bp = bp->next;
         }
     }
@@ -12701,7 +14817,10 @@ uint32 sim_brk_test (t_addr loc, uint32 btyp)
 {
 BRKTAB *bp;
 uint32 spc = (btyp >> SIM_BKPT_V_SPC) & (SIM_BKPT_N_SPC - 1);
+uint32 idx = SIM_BRK_MAP_IDX (loc);
 
+if (!(sim_brk_map[idx >> 5] & (1u << (idx & 31))))    /* no breakpoint near here? */
+    return 0;
 if (sim_brk_summ & BRK_TYP_DYN_ALL)
     btyp |= BRK_TYP_DYN_ALL;
 
@@ -12994,6 +15113,111 @@ for (i=start_rule; i<exp->size; i++)
 return NULL;
 }
 
+/* Expect match automaton
+
+   All of the non regular expression rules in an expect context are
+   compiled into a single Aho-Corasick automaton so that each output
+   character costs one table lookup no matter how many rules are
+   active.  Characters which don't appear in any match string share
+   a single character class to keep the transition table small.  Each
+   state records the lowest numbered rule whose match string ends
+   there, so rule precedence is the same as a sequential scan of the
+   rules.  The automaton is discarded whenever the rule set changes
+   and is rebuilt by the next sim_exp_check.
+*/
+
+static void _sim_exp_ac_free (EXPECT *exp)
+{
+free (exp->ac_goto);
+exp->ac_goto = NULL;
+free (exp->ac_match);
+exp->ac_match = NULL;
+exp->ac_nodes = 0;
+exp->ac_state = 0;
+}
+
+static t_stat _sim_exp_ac_build (EXPECT *exp)
+{
+int32 i, c, nodes, head, tail;
+int32 *fail, *queue;
+uint32 j;
+
+_sim_exp_ac_free (exp);
+memset (exp->ac_class, 0, sizeof (exp->ac_class));
+exp->ac_classes = 1;                                    /* class 0 is characters in no match string */
+exp->regex_rules = 0;
+nodes = 1;                                              /* root state */
+for (i=0; i<exp->size; i++) {
+    EXPTAB *ep = &exp->rules[i];
+
+    if (ep->switches & EXP_TYP_REGEX) {
+        ++exp->regex_rules;
+        continue;
+        }
+    nodes += ep->size;
+    for (j=0; j<ep->size; j++)
+        if (exp->ac_class[ep->match[j]] == 0)
+            exp->ac_class[ep->match[j]] = (uint16)exp->ac_classes++;
+    }
+exp->ac_goto = (int32 *)calloc (nodes * exp->ac_classes, sizeof (*exp->ac_goto));
+exp->ac_match = (int32 *)malloc (nodes * sizeof (*exp->ac_match));
+fail = (int32 *)calloc (nodes, sizeof (*fail));
+queue = (int32 *)malloc (nodes * sizeof (*queue));
+if ((!exp->ac_goto) || (!exp->ac_match) || (!fail) || (!queue)) {
+    free (fail);
+    free (queue);
+    _sim_exp_ac_free (exp);
+    return SCPE_MEM;
+    }
+for (i=0; i<nodes; i++)
+    exp->ac_match[i] = -1;
+/* Build the trie of match strings */
+exp->ac_nodes = 1;
+for (i=0; i<exp->size; i++) {
+    EXPTAB *ep = &exp->rules[i];
+    int32 state = 0;
+
+    if (ep->switches & EXP_TYP_REGEX)
+        continue;
+    for (j=0; j<ep->size; j++) {
+        int32 *next = &exp->ac_goto[state * exp->ac_classes + exp->ac_class[ep->match[j]]];
+
+        if (*next == 0)
+            *next = exp->ac_nodes++;
+        state = *next;
+        }
+    if (exp->ac_match[state] < 0)
+        exp->ac_match[state] = i;                       /* earlier rules take precedence */
+    }
+/* Breadth first, complete the transition table from the failure links */
+head = tail = 0;
+queue[tail++] = 0;
+while (head < tail) {
+    int32 state = queue[head++];
+    int32 *row = &exp->ac_goto[state * exp->ac_classes];
+
+    for (c=0; c<exp->ac_classes; c++) {
+        int32 next = row[c];
+
+        if (next) {                                     /* trie edge? */
+            int32 m;
+
+            fail[next] = state ? exp->ac_goto[fail[state] * exp->ac_classes + c] : 0;
+            m = exp->ac_match[fail[next]];
+            if ((m >= 0) && ((exp->ac_match[next] < 0) || (m < exp->ac_match[next])))
+                exp->ac_match[next] = m;                /* inherit shorter suffix matches */
+            queue[tail++] = next;
+            }
+        else
+            row[c] = state ? exp->ac_goto[fail[state] * exp->ac_classes + c] : 0;
+        }
+    }
+free (fail);
+free (queue);
+sim_debug (exp->dbit, exp->dptr, "Expect automaton: %d states, %d character classes, %d RegEx rules\n", exp->ac_nodes, exp->ac_classes, exp->regex_rules);
+return SCPE_OK;
+}
+
 /* Clear (delete) an expect rule */
 
 t_stat sim_exp_clr_tab (EXPECT *exp, EXPTAB *ep)
@@ -13006,9 +15230,13 @@ free (ep->match);                                       /* deallocate match stri
 free (ep->match_pattern);                               /* deallocate the display format match string */
 free (ep->act);                                         /* deallocate action */
 #if defined(USE_REGEX)
-if (ep->switches & EXP_TYP_REGEX)
+if (ep->switches & EXP_TYP_REGEX) {
     pcre_free (ep->regex);                              /* release compiled regex */
+    pcre_free (ep->regex_extra);                        /* and its study data */
+    free (ep->re_ovector);
+    }
 #endif
+_sim_exp_ac_free (exp);                                 /* rule set changed */
 exp->size -= 1;                                         /* decrement count */
 for (i=ep-exp->rules; i<exp->size; i++)                 /* shuffle up remaining rules */
     exp->rules[i] = exp->rules[i+1];
@@ -13041,10 +15269,14 @@ for (i=0; i<exp->size; i++) {
     free (exp->rules[i].match_pattern);                 /* deallocate display format match string */
     free (exp->rules[i].act);                           /* deallocate action */
 #if defined(USE_REGEX)
-    if (exp->rules[i].switches & EXP_TYP_REGEX)
+    if (exp->rules[i].switches & EXP_TYP_REGEX) {
         pcre_free (exp->rules[i].regex);                /* release compiled regex */
+        pcre_free (exp->rules[i].regex_extra);          /* and its study data */
+        free (exp->rules[i].re_ovector);
+        }
 #endif
     }
+_sim_exp_ac_free (exp);
 free (exp->rules);
 exp->rules = NULL;
 exp->size = 0;
@@ -13114,6 +15346,7 @@ exp->rules = (EXPTAB *) realloc (exp->rules, sizeof (*exp->rules)*(exp->size + 1
 ep = &exp->rules[exp->size];
 exp->size += 1;
 memset (ep, 0, sizeof(*ep));
+_sim_exp_ac_free (exp);                                 /* rule set changed */
 ep->after = after;                                     /* set halt after value */
 ep->match_pattern = (char *)malloc (strlen (match) + 1);
 if (ep->match_pattern)
@@ -13135,6 +15368,13 @@ if (switches & EXP_TYP_REGEX) {
     match_buf[strlen(match)-2] = '\0';
     ep->regex = pcre_compile ((char *)match_buf, (switches & EXP_TYP_REGEX_I) ? PCRE_CASELESS : 0, &errmsg, &erroffset, NULL);
     (void)pcre_fullinfo(ep->regex, NULL, PCRE_INFO_CAPTURECOUNT, &ep->re_nsub);
+    ep->regex_extra = pcre_study (ep->regex, 0, &errmsg);  /* examined once per output character, so study it */
+    ep->re_ovector = (int *)malloc (3 * (ep->re_nsub + 1) * sizeof (*ep->re_ovector));
+    if (ep->re_ovector == NULL) {
+        sim_exp_clr_tab (exp, ep);
+        free (match_buf);
+        return SCPE_MEM;
+        }
 #endif
     free (match_buf);
     match_buf = NULL;
@@ -13202,6 +15442,7 @@ if (ep->cnt > 0)
 if (ep->act)
     fprintf (st, " %s", ep->act);
 fprintf (st, "\n");
+fprintf (st, "        Hits: %u\n", (unsigned)ep->hits);
 return SCPE_OK;
 }
 
@@ -13252,7 +15493,7 @@ return SCPE_OK;
 
 t_stat sim_exp_check (EXPECT *exp, uint8 data)
 {
-int32 i;
+int32 i, r;
 EXPTAB *ep = NULL;
 int regex_checks = 0;
 char *tstr = NULL;
@@ -13260,16 +15501,33 @@ char *tstr = NULL;
 if ((!exp) || (!exp->rules))                            /* Anying to check? */
     return SCPE_OK;
 
+if (exp->ac_nodes == 0) {                               /* rules changed since the last check? */
+    uint32 off;
+
+    if (_sim_exp_ac_build (exp) != SCPE_OK)
+        return SCPE_MEM;
+    /* Bring the new automaton up to date with data already in the buffer */
+    for (off=0; off < exp->buf_data; off++) {
+        uint8 c = exp->buf[(exp->buf_ins + exp->buf_size - exp->buf_data + off) % exp->buf_size];
+
+        exp->ac_state = exp->ac_goto[exp->ac_state * exp->ac_classes + exp->ac_class[c]];
+        }
+    }
+
 exp->buf[exp->buf_ins++] = data;                        /* Save new data */
 exp->buf[exp->buf_ins] = '\0';                          /* Nul terminate for RegEx match */
 if (exp->buf_data < exp->buf_size)
     ++exp->buf_data;                                    /* Record amount of data in buffer */
 
-for (i=0; i < exp->size; i++) {
-    ep = &exp->rules[i];
-    if (ep->switches & EXP_TYP_REGEX) {
+exp->ac_state = exp->ac_goto[exp->ac_state * exp->ac_classes + exp->ac_class[data]];
+i = exp->ac_match[exp->ac_state];                       /* earliest string rule matching here */
+if (i < 0)
+    i = exp->size;
+for (r=0; (r < i) && (regex_checks < exp->regex_rules); r++) {
+    ep = &exp->rules[r];
+    if (ep->switches & EXP_TYP_REGEX) {                 /* string rules are handled by the automaton */
 #if defined (USE_REGEX)
-        int *ovector = NULL;
+        int *ovector = ep->re_ovector;
         int rc;
         char *cbuf = (char *)exp->buf;
         static size_t sim_exp_match_sub_count = 0;
@@ -13288,14 +15546,13 @@ for (i=0; i < exp->size; i++) {
                 }
             }
         ++regex_checks;
-        ovector = (int *)malloc (3 * (ep->re_nsub + 1) * sizeof (*ovector));
         if (sim_deb && exp->dptr && (exp->dptr->dctrl & exp->dbit)) {
             char *estr = sim_encode_quoted_string (exp->buf, exp->buf_ins);
             sim_debug (exp->dbit, exp->dptr, "Checking String: %s\n", estr);
             sim_debug (exp->dbit, exp->dptr, "Against RegEx Match Rule: %s\n", ep->match_pattern);
             free (estr);
             }
-        rc = pcre_exec (ep->regex, NULL, cbuf, exp->buf_ins, 0, PCRE_NOTBOL, ovector, 3 * (ep->re_nsub + 1));
+        rc = pcre_exec (ep->regex, ep->regex_extra, cbuf, exp->buf_ins, 0, PCRE_NOTBOL, ovector, 3 * (ep->re_nsub + 1));
         if (rc >= 0) {
             size_t j;
             char *buf = (char *)malloc (1 + exp->buf_ins);
@@ -13316,66 +15573,15 @@ for (i=0; i < exp->size; i++) {
                 setenv (env_name, "", 1);      /* Remove previous extra environment variables */
                 }
             sim_exp_match_sub_count = ep->re_nsub;
-            free (ovector);
-            ovector = NULL;
             free (buf);
+            i = r;                              /* this rule precedes any string match */
             break;
             }
-        free (ovector);
 #endif
         }
-    else {
-        if (exp->buf_data < ep->size)                           /* Too little data to match yet? */
-            continue;                                           /* Yes, Try next one. */
-        if (exp->buf_ins < ep->size) {                          /* Match might stradle end of buffer */
-            /* 
-             * First compare the newly deposited data at the beginning 
-             * of buffer with the end of the match string
-             */
-            if (exp->buf_ins) {
-                if (sim_deb && exp->dptr && (exp->dptr->dctrl & exp->dbit)) {
-                    char *estr = sim_encode_quoted_string (exp->buf, exp->buf_ins);
-                    char *mstr = sim_encode_quoted_string (&ep->match[ep->size-exp->buf_ins], exp->buf_ins);
-
-                    sim_debug (exp->dbit, exp->dptr, "Checking String[0:%d]: %s\n", exp->buf_ins, estr);
-                    sim_debug (exp->dbit, exp->dptr, "Against Match Data: %s\n", mstr);
-                    free (estr);
-                    free (mstr);
-                    }
-                if (memcmp (exp->buf, &ep->match[ep->size-exp->buf_ins], exp->buf_ins)) /* Tail Match? */
-                    continue;                                   /* Nope, Try next one. */
-                }
-            if (sim_deb && exp->dptr && (exp->dptr->dctrl & exp->dbit)) {
-                char *estr = sim_encode_quoted_string (&exp->buf[exp->buf_size-(ep->size-exp->buf_ins)], ep->size-exp->buf_ins);
-                char *mstr = sim_encode_quoted_string (ep->match, ep->size-exp->buf_ins);
-
-                sim_debug (exp->dbit, exp->dptr, "Checking String[%d:%d]: %s\n", exp->buf_size-(ep->size-exp->buf_ins), ep->size-exp->buf_ins, estr);
-                sim_debug (exp->dbit, exp->dptr, "Against Match Data: %s\n", mstr);
-                free (estr);
-                free (mstr);
-                }
-            if (memcmp (&exp->buf[exp->buf_size-(ep->size-exp->buf_ins)], ep->match, ep->size-exp->buf_ins)) /* Front Match? */
-                continue;                                       /* Nope, Try next one. */
-            break;
-            }
-        else {
-            if (sim_deb && exp->dptr && (exp->dptr->dctrl & exp->dbit)) {
-                char *estr = sim_encode_quoted_string (&exp->buf[exp->buf_ins-ep->size], ep->size);
-                char *mstr = sim_encode_quoted_string (ep->match, ep->size);
-
-                sim_debug (exp->dbit, exp->dptr, "Checking String[%d:%d]: %s\n", exp->buf_ins-ep->size, ep->size, estr);
-                sim_debug (exp->dbit, exp->dptr, "Against Match Data: %s\n", mstr);
-                free (estr);
-                free (mstr);
-                }
-            if (memcmp (&exp->buf[exp->buf_ins-ep->size], ep->match, ep->size)) /* Whole string match? */
-                continue;                                       /* Nope, Try next one. */
-            break;
-            }
-        }
     }
 if (exp->buf_ins == exp->buf_size) {                    /* At end of match buffer? */
-    if (regex_checks) {
+    if (exp->regex_rules) {
         /* When processing regular expressions, let the match buffer fill 
            up and then shuffle the buffer contents down by half the buffer size
            so that the regular expression has a single contiguous buffer to 
@@ -13392,6 +15598,8 @@ if (exp->buf_ins == exp->buf_size) {                    /* At end of match buffe
         }
     }
 if (i != exp->size) {                                   /* Found? */
+    ep = &exp->rules[i];
+    ep->hits += 1;
     sim_debug (exp->dbit, exp->dptr, "Matched expect pattern: %s\n", ep->match_pattern);
     setenv ("_EXPECT_MATCH_PATTERN", ep->match_pattern, 1);   /* Make the match detail available as an environment variable */
     if (ep->cnt > 0) {
@@ -13423,6 +15631,7 @@ if (i != exp->size) {                                   /* Found? */
         }
     /* Matched data is no longer available for future matching */
     exp->buf_data = exp->buf_ins = 0;
+    exp->ac_state = 0;
     }
 free (tstr);
 return SCPE_OK;
@@ -13578,6 +15787,8 @@ size_t debug_line_bufsize = 0;
 size_t debug_line_offset = 0;
 size_t debug_line_count = 0;
 
+static void _trace_textf (uint32 dbits, DEVICE *dptr, const char *fmt, ...);
+
 static void _debug_fwrite_all (const char *buf, size_t len, FILE *f)
 {
 size_t len_written;
@@ -13718,6 +15929,12 @@ char saved_debug_filename[CBUFSIZE];
 if (sim_deb == NULL)                                    /* no debug? */
     return SCPE_OK;
 
+if (sim_trace_active ()) {                              /* binary trace? */
+    fflush (sim_deb);
+    sim_trace_flush ();
+    return SCPE_OK;
+    }
+
 _sim_debug_write_flush ("", 0, TRUE);
 
 if (sim_deb == sim_log) {                               /* debug is log */
@@ -13810,10 +16027,16 @@ sprintf(debug_line_prefix, "DBG(%s%s%.0f%s)%s> %s %s: ", tim_t, tim_a, sim_gtime
 return debug_line_prefix;
 }
 
-void fprint_fields (FILE *stream, t_value before, t_value after, BITFIELD* bitdefs)
+/* Render a register's bit translation/transition into a buffer */
+
+static void _sim_sprint_fields (char *buf, size_t size, t_value before, t_value after, BITFIELD* bitdefs)
 {
 int32 i, fields, offset;
 uint32 value, beforevalue, mask;
+size_t len = 0;
+
+#define FIELD_CAT (len += strlen (&buf[len]))
+buf[0] = '\0';
 
 for (fields=offset=0; bitdefs[fields].name; ++fields) {
     if (bitdefs[fields].offset == 0xffffffff)       /* fixup uninitialized offsets */
@@ -13827,7 +16050,8 @@ for (i = fields-1; i >= 0; i--) {                   /* print xlation, transition
         continue;
     if ((bitdefs[i].width == 1) && (bitdefs[i].valuenames == NULL)) {
         int off = ((after >> bitdefs[i].offset) & 1) + (((before ^ after) >> bitdefs[i].offset) & 1) * 2;
-        fprintf(stream, "%s%c ", bitdefs[i].name, debug_bstates[off]);
+        snprintf(&buf[len], size - len, "%s%c ", bitdefs[i].name, debug_bstates[off]);
+        FIELD_CAT;
         }
     else {
         const char *delta = "";
@@ -13840,17 +16064,29 @@ for (i = fields-1; i >= 0; i--) {                   /* print xlation, transition
         if (value > beforevalue)
             delta = "^";
         if (bitdefs[i].valuenames)
-            fprintf(stream, "%s=%s%s ", bitdefs[i].name, delta, bitdefs[i].valuenames[value]);
+            snprintf(&buf[len], size - len, "%s=%s%s ", bitdefs[i].name, delta, bitdefs[i].valuenames[value]);
         else
             if (bitdefs[i].format) {
-                fprintf(stream, "%s=%s", bitdefs[i].name, delta);
-                fprintf(stream, bitdefs[i].format, value);
-                fprintf(stream, " ");
+                snprintf(&buf[len], size - len, "%s=%s", bitdefs[i].name, delta);
+                FIELD_CAT;
+                snprintf(&buf[len], size - len, bitdefs[i].format, value);
+                FIELD_CAT;
+                snprintf(&buf[len], size - len, " ");
                 }
             else
-                fprintf(stream, "%s=%s0x%X ", bitdefs[i].name, delta, value);
+                snprintf(&buf[len], size - len, "%s=%s0x%X ", bitdefs[i].name, delta, value);
+        FIELD_CAT;
         }
     }
+#undef FIELD_CAT
+}
+
+void fprint_fields (FILE *stream, t_value before, t_value after, BITFIELD* bitdefs)
+{
+char buf[4*CBUFSIZE];
+
+_sim_sprint_fields (buf, sizeof (buf), before, after, bitdefs);
+fputs (buf, stream);
 }
 
 /* Prints state of a register: bit translation + state (0,1,_,^)
@@ -13863,6 +16099,13 @@ void sim_debug_bits_hdr(uint32 dbits, DEVICE* dptr, const char *header,
 if (sim_deb && dptr && (dptr->dctrl & dbits)) {
     TMLN *saved_oline = sim_oline;
 
+    if (sim_trace_active ()) {                                          /* binary trace? */
+        char buf[4*CBUFSIZE];
+
+        _sim_sprint_fields (buf, sizeof (buf), (t_value)before, (t_value)after, bitdefs);
+        _trace_textf (dbits, dptr, "%s%s%s%s", header ? header : "", header ? ": " : "", buf, terminate ? "\n" : "");
+        return;
+        }
     sim_oline = NULL;                                                   /* avoid potential debug to active socket */
     if (!debug_unterm)
         fprintf(sim_deb, "%s", sim_debug_prefix(dbits, dptr, NULL));    /* print prefix if required */
@@ -13917,128 +16160,1304 @@ while (1) {                                         /* format passed string, arg
     break;
     }
 
-if (sim_is_running) {
-    char *c, *remnant = buf;
+if (sim_is_running) {
+    char *c, *remnant = buf;
+
+    sim_putchar_flush ();                           /* keep order with console output */
+    while ((c = strchr (remnant, '\n'))) {
+        if ((c != buf) && (*(c - 1) != '\r'))
+            fprintf (stdout, "%.*s\r\n", (int)(c-remnant), remnant);
+        else
+            fprintf (stdout, "%.*s\n", (int)(c-remnant), remnant);
+        remnant = c + 1;
+        }
+    fprintf (stdout, "%s", remnant);
+    }
+else
+    fprintf (stdout, "%s", buf);
+if ((!sim_oline) && (sim_log && (sim_log != stdout)))
+    fprintf (sim_log, "%s", buf);
+if (sim_deb && (sim_deb != stdout) && (sim_deb != sim_log))
+    _sim_debug_write (buf, strlen (buf));
+
+if (buf != stackbuf)
+    free (buf);
+}
+
+void sim_perror (const char *msg)
+{
+int saved_errno = errno;
+
+perror (msg);
+sim_printf ("%s: %s\n", msg, strerror (saved_errno));
+}
+
+/* Print command result message to stdout, sim_log (if enabled) and sim_deb (if enabled) */
+t_stat sim_messagef (t_stat stat, const char* fmt, ...)
+{
+char stackbuf[STACKBUFSIZE];
+int32 bufsize = sizeof(stackbuf);
+char *buf = stackbuf;
+int32 len;
+va_list arglist;
+t_bool inhibit_message = (!sim_show_message || (stat & SCPE_NOMESSAGE));
+char msg_prefix[32] = "";
+size_t prefix_len;
+t_bool newline_prefix = (*fmt == '\n');
+
+if ((stat == SCPE_OK) && (sim_quiet || (sim_switches & SWMASK ('Q'))))
+    return stat;
+if (newline_prefix)
+    ++fmt;
+sprintf (msg_prefix, "%s%%SIM-%s: ", newline_prefix ? (sim_is_running ? "\r\n" : "\n") : "", (stat == SCPE_OK) ? "INFO" : "ERROR");
+prefix_len = strlen (msg_prefix);
+while (1) {                                         /* format passed string, args */
+    va_start (arglist, fmt);
+    strlcpy (buf, msg_prefix, bufsize);
+#if defined(NO_vsnprintf)
+    len = prefix_len + vsprintf (buf + prefix_len, fmt, arglist);
+#else                                               /* !defined(NO_vsnprintf) */
+    len = prefix_len + vsnprintf (buf + prefix_len, bufsize - (1 + prefix_len), fmt, arglist);
+#endif                                              /* NO_vsnprintf */
+    va_end (arglist);
+
+/* If the formatted result didn't fit into the buffer, then grow the buffer and try again */
+
+    if ((len < 0) || (len >= bufsize-1)) {
+        if (buf != stackbuf)
+            free (buf);
+        bufsize = bufsize * 2;
+        if (bufsize < len + 2)
+            bufsize = len + 2;
+        buf = (char *) malloc (bufsize);
+        if (buf == NULL)                            /* out of memory */
+            return SCPE_MEM;
+        buf[bufsize-1] = '\0';
+        continue;
+        }
+    break;
+    }
+
+if (sim_do_ocptr[sim_do_depth]) {
+    if (!sim_do_echo && !inhibit_message && !sim_cmd_echoed) {
+        sim_printf("%s> %s\n", do_position(), sim_do_ocptr[sim_do_depth]);
+        sim_cmd_echoed = TRUE;
+        }
+    else {
+        if (sim_deb) {                      /* Always put context in debug output */
+            TMLN *saved_oline = sim_oline;
+
+            sim_oline = NULL;               /* avoid potential debug to active socket */
+            fprintf (sim_deb, "%s> %s\n", do_position(), sim_do_ocptr[sim_do_depth]);
+            sim_oline = saved_oline;        /* restore original socket */
+            }
+        }
+    }
+if (sim_is_running && !inhibit_message) {
+    char *c, *remnant = buf;
+
+    sim_putchar_flush ();                           /* keep order with console output */
+    while ((c = strchr(remnant, '\n'))) {
+        if ((c != buf) && (*(c - 1) != '\r'))
+            fprintf (stdout, "%.*s\r\n", (int)(c-remnant), remnant);
+        else
+            fprintf (stdout, "%.*s\n", (int)(c-remnant), remnant);
+        remnant = c + 1;
+        }
+    fprintf (stdout, "%s", remnant);
+    }
+else {
+    if (!inhibit_message)
+        fprintf (stdout, "%s", buf);
+    }
+if ((!sim_oline) && (sim_log && (sim_log != stdout) && !inhibit_message))
+    fprintf (sim_log, "%s", buf);
+/* Always display messages in debug output */
+if (sim_deb && (((sim_deb != stdout) && (sim_deb != sim_log)) || inhibit_message)) {
+    TMLN *saved_oline = sim_oline;
+
+    sim_oline = NULL;                           /* avoid potential debug to active socket */
+    fprintf (sim_deb, "%s", buf);
+    sim_oline = saved_oline;                    /* restore original socket */
+    }
+
+if (buf != stackbuf)
+    free (buf);
+return stat | ((stat != SCPE_OK) ? SCPE_NOMESSAGE : 0);
+}
+
+/* Binary debug trace (SET DEBUG -Z)
+
+   Formatting every debug message as it happens costs far more than the
+   simulated activity being traced.  With SET DEBUG -Z, sim_debug() and
+   sim_debug_unit() messages are instead recorded in binary: the hot path
+   stores the time, device, debug bits, an id for the format string and
+   the raw argument values in a ring belonging to the calling thread, and
+   a writer thread copies the rings to the trace file.  Text written to
+   sim_deb directly (rather than through sim_debug) is recorded as is.
+   TRACE DECODE renders a trace file in the same form as ordinary debug
+   output.
+
+   Each ring has a single producer (its thread) and a single consumer (the
+   writer), so records change hands without a lock.  A full ring drops the
+   new record and the number lost is noted in the trace.  Format strings
+   and devices are identified by their position in open addressed tables
+   which are filled in (once per trace) with a compare and swap, and the
+   writer emits a definition record ahead of the first event which uses
+   each of them.  The argument types are taken from the format string, so
+   a format must be a string constant which outlives the trace.  A message
+   whose arguments can't be recorded (%n, wide strings, long doubles,
+   intmax_t or ptrdiff_t values) or which doesn't fit in a ring slot is
+   formatted on the spot and recorded as text.
+
+   A trace file holds one or more sessions, each starting with a TRACE_START
+   record.  Records are in host byte order and are decoded by the simulator
+   which wrote them.
+*/
+
+#define TRACE_MAGIC         "SIMHTRC1"
+#define TRACE_SLOT_SIZE     256                 /* ring slot (and largest event record) */
+#define TRACE_RING_SLOTS    65536               /* slots per ring (power of 2) */
+#define TRACE_FORMATS       8192                /* format table size (power of 2) */
+#define TRACE_DEVICES       512                 /* device table size (power of 2) */
+#define TRACE_NO_ID         0xFFFFFFFF
+
+#define TRACE_START         1                   /* session start */
+#define TRACE_FORMAT        2                   /* format string definition */
+#define TRACE_DEVICE        3                   /* device definition */
+#define TRACE_EVENT         4                   /* debug message */
+#define TRACE_TEXT          5                   /* text written directly to sim_deb */
+#define TRACE_LOST          6                   /* records dropped */
+
+#define TRACE_F_THREAD      1                   /* event not from the simulator thread */
+#define TRACE_F_CONT        2                   /* continues the previous event's text */
+
+typedef struct {
+    uint16              size;                   /* record bytes (including this header) */
+    uint8               type;                   /* TRACE_xxx */
+    uint8               flags;                  /* TRACE_F_xxx */
+    uint32              id;                     /* format/device id, count */
+    } TRACE_HDR;
+
+typedef struct {
+    TRACE_HDR           hdr;                    /* id is the format */
+    uint32              dev;                    /* device id */
+    uint32              dbits;                  /* matched debug bits */
+    double              gtime;                  /* simulated time */
+    t_uint64            pc;                     /* PC (with -P) */
+    t_int64             sec;                    /* time of day (with -T, -A or -R) */
+    int32               nsec;
+    uint32              spare;
+    } TRACE_EVENT_REC;                          /* followed by the arguments */
+
+typedef struct {
+    TRACE_HDR           hdr;                    /* id is the version (1) */
+    char                magic[8];
+    int32               switches;               /* sim_deb_switches */
+    int32               base_nsec;              /* -R base time */
+    t_int64             base_sec;
+    char                sim_name[64];
+    } TRACE_START_REC;
+
+typedef struct TRACE_RING TRACE_RING;
+
+struct TRACE_RING {
+    TRACE_RING          *next;                  /* list of rings */
+    uint8               *slot;                  /* TRACE_RING_SLOTS slots */
+    volatile uint32     head;                   /* producer index */
+    volatile uint32     tail;                   /* consumer index */
+    volatile uint32     lost;                   /* records dropped by the producer */
+    uint32              lost_noted;             /* lost count already in the trace */
+    };
+
+static volatile t_bool sim_trace_on = FALSE;    /* recording debug output? */
+static FILE *sim_trace_file = NULL;
+static TRACE_RING *sim_trace_rings = NULL;
+static uint32 sim_trace_lost = 0;
+static const char *volatile sim_trace_fmts[TRACE_FORMATS];
+static char *volatile sim_trace_sigs[TRACE_FORMATS];
+static DEVICE *volatile sim_trace_devs[TRACE_DEVICES];
+static uint8 sim_trace_fmt_written[TRACE_FORMATS];
+static uint8 sim_trace_dev_written[TRACE_DEVICES];
+static const char sim_trace_text_fmt[] = "%s";  /* format of messages recorded as text */
+static uint32 sim_trace_text_id;
+
+#if defined (SIM_ASYNCH_IO)
+static pthread_mutex_t sim_trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t sim_trace_writer;
+static volatile t_bool sim_trace_writer_run = FALSE;
+static AIO_TLS TRACE_RING *sim_trace_my_ring = NULL;
+#define TRACE_LOCK          pthread_mutex_lock (&sim_trace_lock)
+#define TRACE_UNLOCK        pthread_mutex_unlock (&sim_trace_lock)
+#else
+static TRACE_RING *sim_trace_my_ring = NULL;
+#define TRACE_LOCK
+#define TRACE_UNLOCK
+#endif
+
+#if defined (__GNUC__)
+#define _trace_barrier()    __sync_synchronize ()
+#define _trace_cas(p, o, n) __sync_bool_compare_and_swap (p, o, n)
+#else
+#define _trace_barrier()    do { TRACE_LOCK; TRACE_UNLOCK; } while (0)
+
+static t_bool _trace_cas_ptr (void *volatile *p, void *o, void *n)
+{
+t_bool ret;
+
+TRACE_LOCK;
+ret = (*p == o);
+if (ret)
+    *p = n;
+TRACE_UNLOCK;
+return ret;
+}
+#define _trace_cas(p, o, n) _trace_cas_ptr ((void *volatile *)(p), (void *)(o), (void *)(n))
+#endif
+
+/* Parse the conversion specification at fmt (just past the %), returning
+   the character after it.  The argument kinds it consumes are stored in
+   kinds ('*' widths and precisions as 'i', then 'i' int, 'l' long, 'q'
+   long long, 'z' size_t, 'd' double, 's' string, 'p' pointer), "%" for
+   a literal %, or "?" for something which can't be recorded.  spec gets
+   the specification text. */
+
+static const char *_trace_fmt_spec (const char *fmt, char *spec, size_t spec_size, char *kinds)
+{
+const char *start = fmt - 1;
+char length = 0;
+char *k = kinds;
+
+while (*fmt && strchr ("-+ #0'", *fmt))          /* flags */
+    ++fmt;
+if (*fmt == '*') {                              /* width */
+    *k++ = 'i';
+    ++fmt;
+    }
+else
+    while (isdigit ((unsigned char)*fmt))
+        ++fmt;
+if (*fmt == '.') {                              /* precision */
+    ++fmt;
+    if (*fmt == '*') {
+        *k++ = 'i';
+        ++fmt;
+        }
+    else
+        while (isdigit ((unsigned char)*fmt))
+            ++fmt;
+    }
+if ((fmt[0] == 'h') && (fmt[1] == 'h'))         /* length */
+    fmt += 2;
+else if (fmt[0] == 'h')
+    fmt += 1;
+else if ((fmt[0] == 'l') && (fmt[1] == 'l'))
+    length = 'q', fmt += 2;
+else if ((fmt[0] == 'I') && (fmt[1] == '6') && (fmt[2] == '4'))
+    length = 'q', fmt += 3;
+else if ((fmt[0] == 'I') && (fmt[1] == '3') && (fmt[2] == '2'))
+    fmt += 3;
+else if (fmt[0] == 'I')
+    length = 'z', fmt += 1;
+else if (fmt[0] && strchr ("lqzjtL", fmt[0]))
+    length = *fmt++;
+switch (*fmt) {
+    case '%':
+        k = kinds;
+        *k++ = '%';
+        break;
+    case 'd': case 'i': case 'o': case 'u': case 'x': case 'X': case 'c':
+        if ((length == 0) || (length == 'l') || (length == 'q') || (length == 'z'))
+            *k++ = length ? length : 'i';
+        else
+            *k++ = '?';
+        if ((*fmt == 'c') && length)
+            k[-1] = '?';                        /* wide character */
+        break;
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+        *k++ = ((length == 0) || (length == 'l')) ? 'd' : '?';
+        break;
+    case 's':
+        *k++ = (length == 0) ? 's' : '?';
+        break;
+    case 'p':
+        *k++ = 'p';
+        break;
+    default:                                    /* %n or unknown */
+        *k++ = '?';
+        break;
+        }
+*k = '\0';
+if (*fmt)
+    ++fmt;
+if (spec != NULL)
+    snprintf (spec, spec_size, "%.*s", (int)(fmt - start), start);
+return fmt;
+}
+
+/* Build the argument signature of a format, NULL if it can't be recorded */
+
+static char *_trace_fmt_sig (const char *fmt)
+{
+char kinds[4], *sig = (char *)malloc (strlen (fmt) + 1);
+size_t n = 0;
+
+if (sig == NULL)
+    return NULL;
+while (*fmt) {
+    if (*fmt++ != '%')
+        continue;
+    fmt = _trace_fmt_spec (fmt, NULL, 0, kinds);
+    if (strchr (kinds, '?')) {
+        free (sig);
+        return NULL;
+        }
+    if (kinds[0] != '%') {
+        strcpy (sig + n, kinds);
+        n += strlen (kinds);
+        }
+    }
+sig[n] = '\0';
+return sig;
+}
+
+static uint32 _trace_hash (const void *p, uint32 size)
+{
+return (uint32)((((t_uint64)(size_t)p) >> 3) * 2654435761u) & (size - 1);
+}
+
+/* Find (or claim) the table entry for a format string */
+
+static uint32 _trace_fmt_id (const char *fmt)
+{
+uint32 i = _trace_hash (fmt, TRACE_FORMATS);
+uint32 probes;
+
+for (probes = 0; probes < TRACE_FORMATS; probes++, i = (i + 1) & (TRACE_FORMATS - 1)) {
+    const char *f = sim_trace_fmts[i];
+
+    if (f == fmt)
+        return i;
+    if ((f == NULL) && _trace_cas (&sim_trace_fmts[i], NULL, fmt)) {
+        char *sig = _trace_fmt_sig (fmt);
+
+        sim_trace_sigs[i] = sig ? sig : (char *)sim_trace_text_fmt;
+        _trace_barrier ();
+        return i;
+        }
+    if ((f == NULL) && (sim_trace_fmts[i] == fmt))  /* lost the race to the same format */
+        return i;
+    }
+return TRACE_NO_ID;
+}
+
+static uint32 _trace_dev_id (DEVICE *dptr)
+{
+uint32 i = _trace_hash (dptr, TRACE_DEVICES);
+uint32 probes;
+
+for (probes = 0; probes < TRACE_DEVICES; probes++, i = (i + 1) & (TRACE_DEVICES - 1)) {
+    DEVICE *d = sim_trace_devs[i];
+
+    if ((d == dptr) ||
+        ((d == NULL) && (_trace_cas (&sim_trace_devs[i], NULL, dptr) || (sim_trace_devs[i] == dptr))))
+        return i;
+    }
+return TRACE_NO_ID;
+}
+
+/* The calling thread's ring */
+
+static TRACE_RING *_trace_ring (void)
+{
+TRACE_RING *ring = sim_trace_my_ring;
+
+if (ring != NULL)
+    return ring;
+ring = (TRACE_RING *)calloc (1, sizeof (*ring));
+if (ring == NULL)
+    return NULL;
+ring->slot = (uint8 *)malloc ((size_t)TRACE_RING_SLOTS * TRACE_SLOT_SIZE);
+if (ring->slot == NULL) {
+    free (ring);
+    return NULL;
+    }
+TRACE_LOCK;
+ring->next = sim_trace_rings;                   /* rings live as long as their thread */
+sim_trace_rings = ring;
+TRACE_UNLOCK;
+sim_trace_my_ring = ring;
+return ring;
+}
+
+static void _trace_drain (void);
+
+/* Reserve count slots in the calling thread's ring */
+
+static uint8 *_trace_reserve (TRACE_RING **pring, uint32 count)
+{
+TRACE_RING *ring = _trace_ring ();
+
+*pring = ring;
+if (ring == NULL)
+    return NULL;
+if ((ring->head - ring->tail) + count > TRACE_RING_SLOTS) {
+    ring->lost += count;
+    return NULL;
+    }
+return ring->slot + (size_t)(ring->head & (TRACE_RING_SLOTS - 1)) * TRACE_SLOT_SIZE;
+}
+
+static void _trace_publish (TRACE_RING *ring, uint32 count)
+{
+_trace_barrier ();                              /* slot contents before the index */
+ring->head += count;
+#if !defined (SIM_ASYNCH_IO)
+_trace_drain ();                                /* no writer thread */
+#endif
+}
+
+static uint8 *_trace_slot (TRACE_RING *ring, uint32 n)
+{
+return ring->slot + (size_t)((ring->head + n) & (TRACE_RING_SLOTS - 1)) * TRACE_SLOT_SIZE;
+}
+
+/* Fill in an event record header */
+
+static void _trace_event_hdr (TRACE_EVENT_REC *ev, uint32 id, uint32 dev, uint32 dbits, uint8 flags)
+{
+ev->hdr.type = TRACE_EVENT;
+ev->hdr.flags = flags | (AIO_MAIN_THREAD ? 0 : TRACE_F_THREAD);
+ev->hdr.id = id;
+ev->dev = dev;
+ev->dbits = dbits;
+ev->gtime = sim_gtime ();
+ev->pc = 0;
+ev->sec = 0;
+ev->nsec = 0;
+ev->spare = 0;
+if (sim_deb_switches & (SWMASK ('T') | SWMASK ('R') | SWMASK ('A'))) {
+    struct timespec time_now;
+
+    sim_rtcn_get_time (&time_now, 0);
+    ev->sec = (t_int64)time_now.tv_sec;
+    ev->nsec = (int32)time_now.tv_nsec;
+    }
+if ((sim_deb_switches & SWMASK ('P')) && sim_PC)
+    ev->pc = (t_uint64)(sim_vm_pc_value ? (*sim_vm_pc_value)() : get_rval (sim_PC, 0));
+}
+
+/* Record a message as formatted text (in as many slots as it needs) */
+
+static void _trace_text_event (uint32 dev, uint32 dbits, const char *fmt, va_list arglist)
+{
+char stackbuf[STACKBUFSIZE];
+char *buf = stackbuf;
+size_t chunk = TRACE_SLOT_SIZE - sizeof (TRACE_EVENT_REC) - 2;
+uint32 i, count;
+TRACE_RING *ring;
+va_list args;
+int len;
+
+va_copy (args, arglist);
+len = vsnprintf (stackbuf, sizeof (stackbuf), fmt, args);
+va_end (args);
+if (len < 0)
+    return;
+if ((size_t)len >= sizeof (stackbuf)) {         /* doesn't fit the stack buffer? */
+    buf = (char *)malloc (len + 1);
+    if (buf == NULL)
+        return;
+    }
+count = (uint32)((len + chunk - 1) / chunk);
+if (count == 0)
+    count = 1;
+if (_trace_reserve (&ring, count) != NULL) {
+    if (buf != stackbuf)
+        vsnprintf (buf, len + 1, fmt, arglist);
+    for (i = 0; i < count; i++) {
+        TRACE_EVENT_REC *ev = (TRACE_EVENT_REC *)_trace_slot (ring, i);
+        uint8 *p = (uint8 *)(ev + 1);
+        uint16 n = (uint16)MIN (chunk, len - i * chunk);
+
+        _trace_event_hdr (ev, sim_trace_text_id, dev, dbits, i ? TRACE_F_CONT : 0);
+        memcpy (p, &n, 2);
+        memcpy (p + 2, buf + i * chunk, n);
+        ev->hdr.size = (uint16)(sizeof (*ev) + 2 + n);
+        }
+    _trace_publish (ring, count);
+    }
+if (buf != stackbuf)
+    free (buf);
+}
+
+/* Record a debug message */
+
+static void _trace_event (uint32 dbits, DEVICE *dptr, UNIT *uptr, const char *fmt, va_list arglist)
+{
+uint32 id = _trace_fmt_id (fmt);
+uint32 dev = _trace_dev_id (dptr);
+const char *sig = (id != TRACE_NO_ID) ? sim_trace_sigs[id] : NULL;
+TRACE_EVENT_REC *ev;
+TRACE_RING *ring;
+uint8 *p, *end;
+va_list args;
+
+dbits &= (dptr->dctrl | (uptr ? uptr->dctrl : 0));
+if (dev == TRACE_NO_ID) {
+    sim_trace_lost++;
+    return;
+    }
+if ((sig == NULL) || (sig == sim_trace_text_fmt)) { /* not (yet) recordable as is? */
+    _trace_text_event (dev, dbits, fmt, arglist);
+    return;
+    }
+ev = (TRACE_EVENT_REC *)_trace_reserve (&ring, 1);
+if (ev == NULL)
+    return;
+p = (uint8 *)(ev + 1);
+end = (uint8 *)ev + TRACE_SLOT_SIZE;
+va_copy (args, arglist);
+for (; *sig; ++sig) {
+    int32 iv;
+    t_int64 qv;
+    double dv;
+    const char *sv;
+    uint16 n;
+
+    switch (*sig) {
+        case 'i':
+            iv = va_arg (args, int);
+            if (p + 4 > end)
+                goto Overflow;
+            memcpy (p, &iv, 4);
+            p += 4;
+            continue;
+        case 'l':
+            qv = (t_int64)va_arg (args, long);
+            break;
+        case 'q':
+            qv = (t_int64)va_arg (args, long long);
+            break;
+        case 'z':
+            qv = (t_int64)va_arg (args, size_t);
+            break;
+        case 'p':
+            qv = (t_int64)(size_t)va_arg (args, void *);
+            break;
+        case 'd':
+            dv = va_arg (args, double);
+            memcpy (&qv, &dv, 8);
+            break;
+        case 's':
+            sv = va_arg (args, const char *);
+            n = sv ? (uint16)strlen (sv) : 0xFFFF;
+            if ((sv && (strlen (sv) >= 0xFFFF)) || (p + 2 + (sv ? n : 0) > end))
+                goto Overflow;
+            memcpy (p, &n, 2);
+            if (sv)
+                memcpy (p + 2, sv, n);
+            p += 2 + (sv ? n : 0);
+            continue;
+        default:
+            goto Overflow;
+            }
+    if (p + 8 > end)
+        goto Overflow;
+    memcpy (p, &qv, 8);
+    p += 8;
+    }
+va_end (args);
+_trace_event_hdr (ev, id, dev, dbits, 0);
+ev->hdr.size = (uint16)(p - (uint8 *)ev);
+_trace_publish (ring, 1);
+return;
+
+Overflow:                                       /* too big for a slot */
+va_end (args);
+_trace_text_event (dev, dbits, fmt, arglist);
+}
+
+/* Record a message which is only available as text (i.e. sim_debug_bits) */
+
+static void _trace_textf (uint32 dbits, DEVICE *dptr, const char *fmt, ...)
+{
+uint32 dev = _trace_dev_id (dptr);
+va_list arglist;
+
+if (dev == TRACE_NO_ID) {
+    sim_trace_lost++;
+    return;
+    }
+va_start (arglist, fmt);
+_trace_text_event (dev, dbits & dptr->dctrl, fmt, arglist);
+va_end (arglist);
+}
+
+/* Record text written to sim_deb */
+
+static void _trace_text (const char *buf, size_t len)
+{
+size_t chunk = TRACE_SLOT_SIZE - sizeof (TRACE_HDR);
+
+while (len > 0) {
+    TRACE_RING *ring;
+    TRACE_HDR *hdr = (TRACE_HDR *)_trace_reserve (&ring, 1);
+    size_t n = MIN (chunk, len);
+
+    if (hdr == NULL)
+        return;
+    hdr->type = TRACE_TEXT;
+    hdr->flags = 0;
+    hdr->id = 0;
+    hdr->size = (uint16)(sizeof (*hdr) + n);
+    memcpy (hdr + 1, buf, n);
+    _trace_publish (ring, 1);
+    buf += n;
+    len -= n;
+    }
+}
+
+/* Writer side: copy the records in each ring to the trace file, writing
+   the definitions they depend on first.  Called with sim_trace_lock held
+   (the writer thread and sim_trace_flush are the only consumers). */
+
+static void _trace_write_defs (const TRACE_EVENT_REC *ev)
+{
+static uint8 buf[65536];
+TRACE_HDR *hdr = (TRACE_HDR *)buf;
+size_t n;
+
+if ((ev->hdr.id < TRACE_FORMATS) && !sim_trace_fmt_written[ev->hdr.id]) {
+    const char *fmt = sim_trace_fmts[ev->hdr.id];
+
+    n = MIN (strlen (fmt), sizeof (buf) - sizeof (*hdr) - 1);
+    hdr->type = TRACE_FORMAT;
+    hdr->flags = 0;
+    hdr->id = ev->hdr.id;
+    memcpy (hdr + 1, fmt, n);
+    buf[sizeof (*hdr) + n] = '\0';
+    hdr->size = (uint16)(sizeof (*hdr) + n + 1);
+    fwrite (buf, 1, hdr->size, sim_trace_file);
+    sim_trace_fmt_written[ev->hdr.id] = 1;
+    }
+if ((ev->dev < TRACE_DEVICES) && !sim_trace_dev_written[ev->dev]) {
+    DEVICE *dptr = sim_trace_devs[ev->dev];
+    uint8 *p = (uint8 *)(hdr + 1);
+    int32 i;
+
+    hdr->type = TRACE_DEVICE;
+    hdr->flags = 0;
+    hdr->id = ev->dev;
+    strlcpy ((char *)p, dptr->name, CBUFSIZE);
+    p += strlen ((char *)p) + 1;
+    for (i = 0; dptr->debflags && dptr->debflags[i].name && (i < 32); i++) {
+        memcpy (p, &dptr->debflags[i].mask, 4);
+        strlcpy ((char *)p + 4, dptr->debflags[i].name, CBUFSIZE);
+        p += 4 + strlen ((char *)p + 4) + 1;
+        }
+    hdr->size = (uint16)(p - buf);
+    fwrite (buf, 1, hdr->size, sim_trace_file);
+    sim_trace_dev_written[ev->dev] = 1;
+    }
+}
+
+static void _trace_drain (void)
+{
+TRACE_RING *ring;
+
+if (sim_trace_file == NULL)
+    return;
+for (ring = sim_trace_rings; ring != NULL; ring = ring->next) {
+    uint32 head = ring->head;
+
+    _trace_barrier ();                          /* index before the slot contents */
+    while (ring->tail != head) {
+        TRACE_HDR *hdr = (TRACE_HDR *)(ring->slot + (size_t)(ring->tail & (TRACE_RING_SLOTS - 1)) * TRACE_SLOT_SIZE);
+
+        if (hdr->type == TRACE_EVENT)
+            _trace_write_defs ((TRACE_EVENT_REC *)hdr);
+        fwrite (hdr, 1, hdr->size, sim_trace_file);
+        _trace_barrier ();                      /* done with the slot before it is freed */
+        ring->tail = ring->tail + 1;
+        }
+    if ((ring->lost != ring->lost_noted) || sim_trace_lost) {
+        TRACE_HDR lost;
+        uint32 count = ring->lost;
+
+        lost.type = TRACE_LOST;
+        lost.flags = 0;
+        lost.id = (count - ring->lost_noted) + sim_trace_lost;
+        lost.size = sizeof (lost);
+        fwrite (&lost, 1, sizeof (lost), sim_trace_file);
+        ring->lost_noted = count;
+        sim_trace_lost = 0;
+        }
+    }
+}
+
+#if defined (SIM_ASYNCH_IO)
+static void *_trace_writer (void *arg)
+{
+while (sim_trace_writer_run) {
+    TRACE_RING *ring;
+    t_bool idle = TRUE;
+
+    TRACE_LOCK;
+    for (ring = sim_trace_rings; ring != NULL; ring = ring->next)
+        if (ring->tail != ring->head)
+            idle = FALSE;
+    _trace_drain ();
+    TRACE_UNLOCK;
+    if (idle)
+        sim_os_ms_sleep (1);
+    }
+return NULL;
+}
+#endif
+
+/* Write everything recorded so far */
+
+void sim_trace_flush (void)
+{
+if (sim_trace_file == NULL)
+    return;
+TRACE_LOCK;
+_trace_drain ();
+fflush (sim_trace_file);
+TRACE_UNLOCK;
+}
+
+/* The sim_deb stream of a trace.  Text written to it is recorded, and
+   closing it ends the trace. */
+
+static ssize_t _trace_cookie_write (void *cookie, const char *buf, size_t size)
+{
+_trace_text (buf, size);
+return (ssize_t)size;
+}
+
+static int _trace_cookie_close (void *cookie)
+{
+TRACE_RING *ring;
+uint32 lost = 0;
+int ret;
+
+sim_trace_on = FALSE;
+#if defined (SIM_ASYNCH_IO)
+if (sim_trace_writer_run) {
+    sim_trace_writer_run = FALSE;
+    pthread_join (sim_trace_writer, NULL);
+    }
+#endif
+TRACE_LOCK;
+_trace_drain ();
+for (ring = sim_trace_rings; ring != NULL; ring = ring->next)
+    lost += ring->lost;
+ret = fclose (sim_trace_file);
+sim_trace_file = NULL;
+TRACE_UNLOCK;
+if (lost)
+    sim_messagef (SCPE_OK, "%u debug trace records were lost\n", lost);
+return ret;
+}
+
+#if !defined (__GLIBC__)
+static int _trace_cookie_bsd_write (void *cookie, const char *buf, int size)
+{
+return (int)_trace_cookie_write (cookie, buf, (size_t)size);
+}
+#endif
+
+/* Start a binary trace to filename, returning the sim_deb stream for it */
+
+t_stat sim_trace_open (const char *filename, FILE **pf, FILEREF **pref)
+{
+#if defined (__GLIBC__) || defined (__APPLE__) || \
+    defined (__FreeBSD__) || defined (__NetBSD__) || defined (__OpenBSD__)
+TRACE_START_REC start;
+TRACE_RING *ring;
+FILE *stream;
+int i;
+
+if ((strcmp (filename, "STDOUT") == 0) || (strcmp (filename, "STDERR") == 0) ||
+    (strcmp (filename, "LOG") == 0) || (strcmp (filename, "DEBUG") == 0))
+    return sim_messagef (SCPE_ARG, "A debug trace must be written to a file\n");
+*pref = (FILEREF *)calloc (1, sizeof (**pref));
+if (*pref == NULL)
+    return SCPE_MEM;
+sim_trace_file = sim_fopen (filename, (sim_switches & SWMASK ('N')) ? "w+b" : "a+b");
+if (sim_trace_file == NULL) {
+    free (*pref);
+    *pref = NULL;
+    return SCPE_OPENERR;
+    }
+setvbuf (sim_trace_file, NULL, _IOFBF, 1024*1024);
+#if defined (__GLIBC__)
+if (1) {
+    cookie_io_functions_t io;
 
-    while ((c = strchr (remnant, '\n'))) {
-        if ((c != buf) && (*(c - 1) != '\r'))
-            fprintf (stdout, "%.*s\r\n", (int)(c-remnant), remnant);
-        else
-            fprintf (stdout, "%.*s\n", (int)(c-remnant), remnant);
-        remnant = c + 1;
-        }
-    fprintf (stdout, "%s", remnant);
+    memset (&io, 0, sizeof (io));
+    io.write = _trace_cookie_write;
+    io.close = _trace_cookie_close;
+    stream = fopencookie (NULL, "w", io);
     }
-else
-    fprintf (stdout, "%s", buf);
-if ((!sim_oline) && (sim_log && (sim_log != stdout)))
-    fprintf (sim_log, "%s", buf);
-if (sim_deb && (sim_deb != stdout) && (sim_deb != sim_log))
-    _sim_debug_write (buf, strlen (buf));
+#else
+stream = funopen (NULL, NULL, _trace_cookie_bsd_write, NULL, _trace_cookie_close);
+#endif
+if (stream == NULL) {
+    fclose (sim_trace_file);
+    sim_trace_file = NULL;
+    free (*pref);
+    *pref = NULL;
+    return SCPE_OPENERR;
+    }
+setvbuf (stream, NULL, _IOLBF, TRACE_SLOT_SIZE);/* text is recorded a line at a time */
+for (i = 0; i < TRACE_FORMATS; i++) {           /* ids are per session */
+    if (sim_trace_sigs[i] != sim_trace_text_fmt)
+        free (sim_trace_sigs[i]);
+    sim_trace_sigs[i] = NULL;
+    sim_trace_fmts[i] = NULL;
+    }
+for (i = 0; i < TRACE_DEVICES; i++)
+    sim_trace_devs[i] = NULL;
+memset (sim_trace_fmt_written, 0, sizeof (sim_trace_fmt_written));
+memset (sim_trace_dev_written, 0, sizeof (sim_trace_dev_written));
+sim_trace_text_id = _trace_fmt_id (sim_trace_text_fmt);
+TRACE_LOCK;
+for (ring = sim_trace_rings; ring != NULL; ring = ring->next) {
+    ring->tail = ring->head;                    /* discard anything left over */
+    ring->lost_noted = ring->lost = 0;
+    }
+sim_trace_lost = 0;
+TRACE_UNLOCK;
+memset (&start, 0, sizeof (start));
+start.hdr.type = TRACE_START;
+start.hdr.id = 1;
+start.hdr.size = sizeof (start);
+memcpy (start.magic, TRACE_MAGIC, sizeof (start.magic));
+start.switches = sim_switches;
+sim_rtcn_get_time (&sim_deb_basetime, 0);
+start.base_sec = (t_int64)sim_deb_basetime.tv_sec;
+start.base_nsec = (int32)sim_deb_basetime.tv_nsec;
+strlcpy (start.sim_name, sim_name, sizeof (start.sim_name));
+fwrite (&start, 1, sizeof (start), sim_trace_file);
+strlcpy ((*pref)->name, filename, sizeof ((*pref)->name));
+(*pref)->file = *pf = stream;
+(*pref)->refcount = 1;
+sim_trace_on = TRUE;
+#if defined (SIM_ASYNCH_IO)
+sim_trace_writer_run = TRUE;
+if (pthread_create (&sim_trace_writer, NULL, _trace_writer, NULL))
+    sim_trace_writer_run = FALSE;               /* record synchronously at flush */
+#endif
+return SCPE_OK;
+#else
+return sim_messagef (SCPE_NOFNC, "Binary debug traces aren't supported on this host\n");
+#endif
+}
 
-if (buf != stackbuf)
-    free (buf);
+t_bool sim_trace_active (void)
+{
+return sim_trace_on;
 }
 
-void sim_perror (const char *msg)
+/* TRACE DECODE - render a trace file as debug output */
+
+typedef struct {
+    char                *name;
+    uint32              count;                  /* debug flags */
+    uint32              mask[32];
+    char                *flag[32];
+    } TRACE_DEC_DEV;
+
+typedef struct {
+    char                *buf;
+    size_t              len;
+    size_t              size;
+    } TRACE_DEC_BUF;
+
+static void _trace_buf_add (TRACE_DEC_BUF *b, const char *s, size_t n)
 {
-int saved_errno = errno;
+if (b->len + n + 1 > b->size) {
+    size_t size = MAX (2 * b->size, b->len + n + 1024);
+    char *buf = (char *)realloc (b->buf, size);
 
-perror (msg);
-sim_printf ("%s: %s\n", msg, strerror (saved_errno));
+    if (buf == NULL)
+        return;
+    b->buf = buf;
+    b->size = size;
+    }
+memcpy (b->buf + b->len, s, n);
+b->len += n;
+b->buf[b->len] = '\0';
 }
 
-/* Print command result message to stdout, sim_log (if enabled) and sim_deb (if enabled) */
-t_stat sim_messagef (t_stat stat, const char* fmt, ...)
+/* Render an event's format with its recorded arguments */
+
+static void _trace_render (TRACE_DEC_BUF *b, const char *fmt, const uint8 *p, const uint8 *end)
 {
-char stackbuf[STACKBUFSIZE];
-int32 bufsize = sizeof(stackbuf);
-char *buf = stackbuf;
-int32 len;
-va_list arglist;
-t_bool inhibit_message = (!sim_show_message || (stat & SCPE_NOMESSAGE));
-char msg_prefix[32] = "";
-size_t prefix_len;
-t_bool newline_prefix = (*fmt == '\n');
+char spec[64], kinds[4], cspec[96], *k;
+char num[32];
 
-if ((stat == SCPE_OK) && (sim_quiet || (sim_switches & SWMASK ('Q'))))
-    return stat;
-if (newline_prefix)
-    ++fmt;
-sprintf (msg_prefix, "%s%%SIM-%s: ", newline_prefix ? (sim_is_running ? "\r\n" : "\n") : "", (stat == SCPE_OK) ? "INFO" : "ERROR");
-prefix_len = strlen (msg_prefix);
-while (1) {                                         /* format passed string, args */
-    va_start (arglist, fmt);
-    strlcpy (buf, msg_prefix, bufsize);
-#if defined(NO_vsnprintf)
-    len = prefix_len + vsprintf (buf + prefix_len, fmt, arglist);
-#else                                               /* !defined(NO_vsnprintf) */
-    len = prefix_len + vsnprintf (buf + prefix_len, bufsize - (1 + prefix_len), fmt, arglist);
-#endif                                              /* NO_vsnprintf */
-    va_end (arglist);
+while (*fmt) {
+    const char *pct = strchr (fmt, '%');
+    int32 star[2];
+    int stars = 0;
+    size_t n;
+    char *out, *s;
 
-/* If the formatted result didn't fit into the buffer, then grow the buffer and try again */
+    if (pct == NULL) {
+        _trace_buf_add (b, fmt, strlen (fmt));
+        return;
+        }
+    _trace_buf_add (b, fmt, pct - fmt);
+    fmt = _trace_fmt_spec (pct + 1, spec, sizeof (spec), kinds);
+    if (kinds[0] == '%') {
+        _trace_buf_add (b, "%", 1);
+        continue;
+        }
+    for (k = kinds; *k && (k[1] != '\0'); ++k) {    /* '*' values */
+        if (p + 4 > end)
+            break;
+        memcpy (&star[stars++], p, 4);
+        p += 4;
+        }
+    for (s = spec, out = cspec, stars = 0; *s && (out < cspec + sizeof (cspec) - 16); ++s) {
+        if (*s == '*') {
+            sprintf (num, "%d", (int)star[stars++]);
+            strcpy (out, num);
+            out += strlen (num);
+            }
+        else
+            *out++ = *s;
+        }
+    *out = '\0';
+    if ((*k == 's') && (p + 2 <= end)) {
+        uint16 slen;
+        char *str;
 
-    if ((len < 0) || (len >= bufsize-1)) {
-        if (buf != stackbuf)
-            free (buf);
-        bufsize = bufsize * 2;
-        if (bufsize < len + 2)
-            bufsize = len + 2;
-        buf = (char *) malloc (bufsize);
-        if (buf == NULL)                            /* out of memory */
-            return SCPE_MEM;
-        buf[bufsize-1] = '\0';
+        memcpy (&slen, p, 2);
+        p += 2;
+        if ((slen == 0xFFFF) || (p + slen > end))
+            str = NULL;
+        else {
+            str = (char *)malloc (slen + 1);
+            if (str) {
+                memcpy (str, p, slen);
+                str[slen] = '\0';
+                }
+            p += slen;
+            }
+        n = (size_t)snprintf (NULL, 0, cspec, str ? str : "(null)");
+        out = (char *)malloc (n + 1);
+        if (out) {
+            snprintf (out, n + 1, cspec, str ? str : "(null)");
+            _trace_buf_add (b, out, n);
+            free (out);
+            }
+        free (str);
         continue;
         }
-    break;
-    }
+    if ((*k == 'i') && (p + 4 <= end)) {
+        int32 iv;
 
-if (sim_do_ocptr[sim_do_depth]) {
-    if (!sim_do_echo && !inhibit_message && !sim_cmd_echoed) {
-        sim_printf("%s> %s\n", do_position(), sim_do_ocptr[sim_do_depth]);
-        sim_cmd_echoed = TRUE;
+        memcpy (&iv, p, 4);
+        p += 4;
+        snprintf (num, sizeof (num), cspec, (int)iv);
         }
-    else {
-        if (sim_deb) {                      /* Always put context in debug output */
-            TMLN *saved_oline = sim_oline;
+    else if ((*k) && (*k != 's') && (p + 8 <= end)) {
+        t_int64 qv;
+        double dv;
 
-            sim_oline = NULL;               /* avoid potential debug to active socket */
-            fprintf (sim_deb, "%s> %s\n", do_position(), sim_do_ocptr[sim_do_depth]);
-            sim_oline = saved_oline;        /* restore original socket */
-            }
+        memcpy (&qv, p, 8);
+        p += 8;
+        switch (*k) {
+            case 'l':
+                snprintf (num, sizeof (num), cspec, (long)qv);
+                break;
+            case 'q':
+                snprintf (num, sizeof (num), cspec, (long long)qv);
+                break;
+            case 'z':
+                snprintf (num, sizeof (num), cspec, (size_t)qv);
+                break;
+            case 'p':
+                snprintf (num, sizeof (num), cspec, (void *)(size_t)qv);
+                break;
+            case 'd':
+                memcpy (&dv, &qv, 8);
+                n = (size_t)snprintf (NULL, 0, cspec, dv);
+                out = (char *)malloc (n + 1);
+                if (out) {
+                    snprintf (out, n + 1, cspec, dv);
+                    _trace_buf_add (b, out, n);
+                    free (out);
+                    }
+                continue;
+            default:
+                strcpy (num, "?");
+                break;
+                }
         }
+    else
+        strcpy (num, "?");                      /* argument missing */
+    _trace_buf_add (b, num, strlen (num));
     }
-if (sim_is_running && !inhibit_message) {
-    char *c, *remnant = buf;
+}
 
-    while ((c = strchr(remnant, '\n'))) {
-        if ((c != buf) && (*(c - 1) != '\r'))
-            fprintf (stdout, "%.*s\r\n", (int)(c-remnant), remnant);
-        else
-            fprintf (stdout, "%.*s\n", (int)(c-remnant), remnant);
-        remnant = c + 1;
+/* Write a rendered message the way _sim_vdebug does */
+
+static void _trace_emit (FILE *out, const char *prefix, const char *buf, size_t len, int32 *unterm)
+{
+size_t i, j;
+
+for (i = j = 0; i < len; ++i) {
+    if ('\n' == buf[i]) {
+        if ((i != j) || (i == 0)) {
+            if (!*unterm)
+                fputs (prefix, out);
+            fwrite (&buf[j], 1, i - j, out);
+            fputs ("\r\n", out);
+            }
+        *unterm = 0;
+        j = i + 1;
         }
-    fprintf (stdout, "%s", remnant);
     }
-else {
-    if (!inhibit_message)
-        fprintf (stdout, "%s", buf);
+if (i > j) {
+    if (!*unterm)
+        fputs (prefix, out);
+    fwrite (&buf[j], 1, i - j, out);
     }
-if ((!sim_oline) && (sim_log && (sim_log != stdout) && !inhibit_message))
-    fprintf (sim_log, "%s", buf);
-/* Always display messages in debug output */
-if (sim_deb && (((sim_deb != stdout) && (sim_deb != sim_log)) || inhibit_message)) {
-    TMLN *saved_oline = sim_oline;
+*unterm = len ? ((buf[len - 1] == '\n') ? 0 : 1) : *unterm;
+}
 
-    sim_oline = NULL;                           /* avoid potential debug to active socket */
-    fprintf (sim_deb, "%s", buf);
-    sim_oline = saved_oline;                    /* restore original socket */
+static t_stat sim_trace_decode (const char *filename, const char *outname)
+{
+FILE *in, *out;
+uint8 *rec = (uint8 *)malloc (65536);
+char **fmts = (char **)calloc (TRACE_FORMATS, sizeof (*fmts));
+TRACE_DEC_DEV *devs = (TRACE_DEC_DEV *)calloc (TRACE_DEVICES, sizeof (*devs));
+TRACE_DEC_BUF text = {NULL, 0, 0};
+TRACE_START_REC start;
+char prefix[CBUFSIZE + 128];
+int32 unterm = 0;
+uint32 events = 0, lost = 0;
+t_bool started = FALSE;
+t_stat r = SCPE_OK;
+uint32 i, j;
+
+memset (&start, 0, sizeof (start));
+if ((rec == NULL) || (fmts == NULL) || (devs == NULL)) {
+    free (rec);
+    free (fmts);
+    free (devs);
+    return SCPE_MEM;
     }
+in = sim_fopen (filename, "rb");
+if (in == NULL) {
+    free (rec);
+    free (fmts);
+    free (devs);
+    return sim_messagef (SCPE_OPENERR, "Can't open trace file %s: %s\n", filename, strerror (errno));
+    }
+out = outname ? sim_fopen (outname, "w") : stdout;
+if (out == NULL) {
+    fclose (in);
+    free (rec);
+    free (fmts);
+    free (devs);
+    return sim_messagef (SCPE_OPENERR, "Can't create %s: %s\n", outname, strerror (errno));
+    }
+while (1) {
+    TRACE_HDR *hdr = (TRACE_HDR *)rec;
+    size_t body;
 
-if (buf != stackbuf)
-    free (buf);
-return stat | ((stat != SCPE_OK) ? SCPE_NOMESSAGE : 0);
+    if (fread (rec, 1, sizeof (*hdr), in) != sizeof (*hdr))
+        break;
+    if ((hdr->size < sizeof (*hdr)) ||
+        (fread (rec + sizeof (*hdr), 1, hdr->size - sizeof (*hdr), in) != hdr->size - sizeof (*hdr))) {
+        r = sim_messagef (SCPE_FMT, "Truncated trace record in %s\n", filename);
+        break;
+        }
+    body = hdr->size - sizeof (*hdr);
+    rec[hdr->size] = '\0';
+    if ((hdr->type != TRACE_EVENT) || !(hdr->flags & TRACE_F_CONT)) {
+        if (text.len)                           /* finish the pending message */
+            _trace_emit (out, prefix, text.buf, text.len, &unterm);
+        text.len = 0;
+        }
+    switch (hdr->type) {
+        case TRACE_START:
+            if ((hdr->size < sizeof (start)) || (memcmp (rec + sizeof (*hdr), TRACE_MAGIC, 8) != 0)) {
+                r = sim_messagef (SCPE_FMT, "%s is not a debug trace file\n", filename);
+                goto Done;
+                }
+            memcpy (&start, rec, sizeof (start));
+            start.sim_name[sizeof (start.sim_name) - 1] = '\0';
+            if (strcmp (start.sim_name, sim_name) != 0)
+                sim_messagef (SCPE_OK, "Trace was recorded by the %s simulator\n", start.sim_name);
+            for (i = 0; i < TRACE_FORMATS; i++) {
+                free (fmts[i]);
+                fmts[i] = NULL;
+                }
+            for (i = 0; i < TRACE_DEVICES; i++) {
+                free (devs[i].name);
+                for (j = 0; j < devs[i].count; j++)
+                    free (devs[i].flag[j]);
+                memset (&devs[i], 0, sizeof (devs[i]));
+                }
+            started = TRUE;
+            break;
+        case TRACE_FORMAT:
+            if (hdr->id < TRACE_FORMATS) {
+                free (fmts[hdr->id]);
+                fmts[hdr->id] = strdup ((char *)(hdr + 1));
+                }
+            break;
+        case TRACE_DEVICE:
+            if (hdr->id < TRACE_DEVICES) {
+                TRACE_DEC_DEV *d = &devs[hdr->id];
+                const uint8 *p = (const uint8 *)(hdr + 1), *end = rec + hdr->size;
+
+                free (d->name);
+                d->name = strdup ((const char *)p);
+                p += strlen ((const char *)p) + 1;
+                for (j = 0; j < d->count; j++)
+                    free (d->flag[j]);
+                for (d->count = 0; (p + 5 <= end) && (d->count < 32); d->count++) {
+                    memcpy (&d->mask[d->count], p, 4);
+                    d->flag[d->count] = strdup ((const char *)p + 4);
+                    p += 4 + strlen ((const char *)p + 4) + 1;
+                    }
+                }
+            break;
+        case TRACE_TEXT:
+            fwrite (hdr + 1, 1, body, out);
+            break;
+        case TRACE_LOST:
+            fprintf (out, "*** %u debug trace records lost here\r\n", (unsigned int)hdr->id);
+            lost += hdr->id;
+            break;
+        case TRACE_EVENT:
+            if (1) {
+                TRACE_EVENT_REC *ev = (TRACE_EVENT_REC *)rec;
+                TRACE_DEC_DEV *d = (ev->dev < TRACE_DEVICES) ? &devs[ev->dev] : NULL;
+                const char *verb = "DEBTAB_NOMATCH";
+                const char *some_match = NULL;
+                char tim_t[32] = "";
+                char pc_s[MAX_WIDTH + CBUFSIZE] = "";
+
+                if (!started || (hdr->size < sizeof (*ev))) {
+                    r = sim_messagef (SCPE_FMT, "%s is not a debug trace file\n", filename);
+                    goto Done;
+                    }
+                ++events;
+                if (hdr->flags & TRACE_F_CONT) {
+                    _trace_render (&text, (hdr->id < TRACE_FORMATS) && fmts[hdr->id] ? fmts[hdr->id] : "", (uint8 *)(ev + 1), rec + hdr->size);
+                    break;
+                    }
+                if ((d == NULL) || (d->count == 0))
+                    verb = "DEBTAB_ISNULL";
+                else {
+                    for (j = 0; j < d->count; j++) {
+                        if (d->mask[j] == ev->dbits) {
+                            some_match = d->flag[j];
+                            break;
+                            }
+                        if (d->mask[j] & ev->dbits)
+                            some_match = d->flag[j];
+                        }
+                    if (some_match)
+                        verb = some_match;
+                    }
+                if (start.switches & (SWMASK ('T') | SWMASK ('R') | SWMASK ('A'))) {
+                    struct timespec now, base;
+
+                    now.tv_sec = (time_t)ev->sec;
+                    now.tv_nsec = ev->nsec;
+                    base.tv_sec = (time_t)start.base_sec;
+                    base.tv_nsec = start.base_nsec;
+                    if (start.switches & SWMASK ('R')) {
+                        struct tm loc_tm, gmt_tm;
+                        time_t t = base.tv_sec;
+
+                        loc_tm = *localtime (&t);       /* as sim_set_debon adjusts it */
+                        gmt_tm = *gmtime (&t);
+                        base.tv_sec -= mktime (&gmt_tm) - mktime (&loc_tm);
+                        sim_timespec_diff (&now, &now, &base);
+                        }
+                    if (start.switches & (SWMASK ('T') | SWMASK ('R'))) {
+                        time_t tnow = (time_t)now.tv_sec;
+                        struct tm *tm = localtime (&tnow);
+
+                        sprintf (tim_t, "%02d:%02d:%02d.%03d ", tm->tm_hour, tm->tm_min, tm->tm_sec, (int)(now.tv_nsec/1000000));
+                        }
+                    if (start.switches & SWMASK ('A'))
+                        sprintf (tim_t, "%" LL_FMT "d.%03d ", (LL_TYPE)(now.tv_sec), (int)(now.tv_nsec/1000000));
+                    }
+                if ((start.switches & SWMASK ('P')) && sim_PC) {
+                    sprintf (pc_s, "-%s:", sim_PC->name);
+                    sprint_val (&pc_s[strlen (pc_s)], (t_value)ev->pc, sim_PC->radix, sim_PC->width, sim_PC->flags & REG_FMT);
+                    }
+                snprintf (prefix, sizeof (prefix), "DBG(%s%.0f%s)%s> %s %s: ", tim_t, ev->gtime, pc_s,
+                          (hdr->flags & TRACE_F_THREAD) ? "+" : "", (d && d->name) ? d->name : "?", verb);
+                if ((hdr->id < TRACE_FORMATS) && fmts[hdr->id])
+                    _trace_render (&text, fmts[hdr->id], (uint8 *)(ev + 1), rec + hdr->size);
+                else
+                    _trace_buf_add (&text, "<unknown format>\n", 17);
+                }
+            break;
+        default:
+            r = sim_messagef (SCPE_FMT, "Unknown trace record type %d in %s\n", hdr->type, filename);
+            goto Done;
+            }
+    }
+if (text.len)
+    _trace_emit (out, prefix, text.buf, text.len, &unterm);
+Done:
+fclose (in);
+if (out != stdout)
+    fclose (out);
+else
+    fflush (stdout);
+if (r == SCPE_OK)
+    sim_messagef (SCPE_OK, "%u events decoded%s%s\n", (unsigned int)events, outname ? " to " : "", outname ? outname : "");
+if (lost)
+    sim_messagef (SCPE_OK, "%u events were lost while tracing\n", (unsigned int)lost);
+for (i = 0; i < TRACE_FORMATS; i++)
+    free (fmts[i]);
+for (i = 0; i < TRACE_DEVICES; i++) {
+    free (devs[i].name);
+    for (j = 0; j < devs[i].count; j++)
+        free (devs[i].flag[j]);
+    }
+free (fmts);
+free (devs);
+free (text.buf);
+free (rec);
+return r;
+}
+
+/* Trace command */
+
+t_stat trace_cmd (int32 flag, CONST char *cptr)
+{
+char gbuf[CBUFSIZE], fname[CBUFSIZE], oname[CBUFSIZE];
+
+GET_SWITCHES (cptr);                                    /* get switches */
+cptr = get_glyph (cptr, gbuf, 0);
+if (strcmp (gbuf, "DECODE") != 0)
+    return sim_messagef (SCPE_ARG, "Unknown TRACE command: %s\n", gbuf);
+cptr = get_glyph_nc (cptr, fname, 0);
+if (fname[0] == '\0')
+    return sim_messagef (SCPE_2FARG, "Missing trace file name\n");
+cptr = get_glyph_nc (cptr, oname, 0);
+if (*cptr)
+    return SCPE_2MARG;
+if (sim_trace_on && sim_deb_ref && (strcmp (sim_deb_ref->name, fname) == 0))
+    sim_trace_flush ();                                 /* decoding the active trace */
+return sim_trace_decode (fname, oname[0] ? oname : NULL);
 }
 
 /* Inline debugging - will print debug message if debug file is
@@ -14057,8 +17476,13 @@ if (sim_deb && dptr && ((dptr->dctrl | (uptr ? uptr->dctrl : 0)) & dbits)) {
     int32 bufsize = sizeof(stackbuf);
     char *buf = stackbuf;
     int32 i, j, len;
-    const char* debug_prefix = sim_debug_prefix(dbits, dptr, uptr);   /* prefix to print if required */
+    const char* debug_prefix;
 
+    if (sim_trace_on) {                                 /* binary trace? */
+        _trace_event (dbits, dptr, uptr, fmt, arglist);
+        return;
+        }
+    debug_prefix = sim_debug_prefix(dbits, dptr, uptr); /* prefix to print if required */
     sim_oline = NULL;                                   /* avoid potential debug to active socket */
     buf[bufsize-1] = '\0';
 
@@ -16606,3 +20030,136 @@ for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {
     }
 return stat;
 }
+
+/* CPU benchmark
+
+   BENCHMARK CPU {workload|ALL} {count}
+
+   Each workload is loaded by its deposit commands and run directly by
+   sim_instr for a fixed number of instructions, with the event queue
+   holding nothing but the unit which ends the run.
+*/
+
+#define BENCH_DFLT_COUNT    10000000
+
+static t_stat _sim_benchmark_run (BENCHTAB *bp, int32 count, double *secs)
+{
+const char **cmd;
+int32 saved_switches = sim_switches;
+UNIT bench_unit = { UDATA (&step_svc, 0, 0) };
+t_uint64 start;
+t_stat r;
+
+r = sim_run_boot_prep (RU_GO);                          /* reset devices and queue */
+while (sim_clock_queue != QUEUE_LIST_END)               /* drop what the resets scheduled */
+    sim_cancel (sim_clock_queue);
+for (cmd = bp->commands; (r == SCPE_OK) && *cmd; cmd++)
+    r = exdep_cmd (EX_D, *cmd);
+sim_switches = saved_switches;
+if (r != SCPE_OK)
+    return r;
+sim_activate (&bench_unit, count);
+start = sim_host_nsec ();
+r = sim_instr ();
+*secs = (double)(sim_host_nsec () - start) / 1000000000.0;
+sim_cancel (&bench_unit);
+return (r == SCPE_STEP) ? SCPE_OK : r;
+}
+
+static t_stat _sim_benchmark_cpu (CONST char *cptr)
+{
+char gbuf[CBUFSIZE];
+BENCHTAB *bp, *sel = NULL;
+int32 count = BENCH_DFLT_COUNT;
+int32 runs = 0;
+double secs, mips, logsum = 0.0;
+t_stat r;
+
+if ((sim_vm_benchmarks == NULL) || (sim_vm_benchmarks->name == NULL))
+    return sim_messagef (SCPE_NOFNC, "%s has no CPU benchmark workloads\n", sim_name);
+cptr = get_glyph (cptr, gbuf, 0);
+if (gbuf[0] && !sim_isdigit (gbuf[0])) {                /* workload name? */
+    if (MATCH_CMD (gbuf, "ALL") != 0) {
+        for (sel = sim_vm_benchmarks; sel->name; sel++)
+            if (MATCH_CMD (gbuf, sel->name) == 0)
+                break;
+        if (sel->name == NULL) {
+            sim_printf ("Unknown workload: %s\n", gbuf);
+            sim_printf ("Available workloads:\n");
+            for (bp = sim_vm_benchmarks; bp->name; bp++)
+                sim_printf ("  %-10s %s\n", bp->name, bp->desc);
+            return SCPE_ARG | SCPE_NOMESSAGE;
+            }
+        }
+    cptr = get_glyph (cptr, gbuf, 0);
+    }
+if (gbuf[0]) {
+    count = (int32) get_uint (gbuf, 10, INT_MAX, &r);
+    if ((r != SCPE_OK) || (count < 1000))
+        return sim_messagef (SCPE_ARG, "Invalid instruction count: %s\n", gbuf);
+    }
+if (*cptr)
+    return sim_messagef (SCPE_2MARG, "Too many arguments: %s\n", cptr);
+sim_printf ("Running %s instructions per workload\n", sim_fmt_numeric ((double)count));
+for (bp = (sel ? sel : sim_vm_benchmarks); bp->name; bp++) {
+    r = _sim_benchmark_run (bp, count, &secs);
+    if (r != SCPE_OK) {
+        sim_printf ("%-10s stopped: %s\n", bp->name, sim_error_text (r));
+        break;
+        }
+    mips = (secs > 0.0) ? ((double)count / secs) / 1000000.0 : 0.0;
+    sim_printf ("%-10s %10.2f MIPS %9.3f seconds  %s\n", bp->name, mips, secs, bp->desc);
+    if (mips > 0.0) {
+        logsum += log (mips);
+        ++runs;
+        }
+    if (sel)
+        break;
+    }
+if ((sel == NULL) && (runs > 1))
+    sim_printf ("%-10s %10.2f MIPS\n", "Mean", exp (logsum / runs));
+reset_all_p (0);                                        /* leave a clean machine */
+return (r == SCPE_OK) ? SCPE_OK : (r | SCPE_NOMESSAGE);
+}
+
+/* Benchmark command
+
+   BENCHMARK CPU {workload|ALL} {count}
+   BENCHMARK {DISK|TAPE} <unit> {options}
+
+   A CPU workload is supplied by the simulator, a disk or tape workload
+   is issued by the unit's device library */
+
+t_stat benchmark_cmd (int32 flag, CONST char *cptr)
+{
+char gbuf[CBUFSIZE];
+DEVICE *dptr;
+UNIT *uptr;
+uint32 type = 0;
+
+GET_SWITCHES (cptr);                                    /* get switches */
+cptr = get_glyph (cptr, gbuf, 0);
+if (strcmp (gbuf, "CPU") == 0)
+    return _sim_benchmark_cpu (cptr);
+if ((strcmp (gbuf, "DISK") == 0) || (strcmp (gbuf, "TAPE") == 0)) {
+    type = (gbuf[0] == 'D') ? DEV_DISK : DEV_TAPE;
+    cptr = get_glyph (cptr, gbuf, 0);
+    }
+if (gbuf[0] == '\0')
+    return SCPE_2FARG;
+dptr = find_unit (gbuf, &uptr);
+if ((dptr == NULL) || (uptr == NULL))
+    return sim_messagef (SCPE_NXUN, "No such unit: %s\n", gbuf);
+GET_SWITCHES (cptr);                                    /* get switches after the unit */
+if ((type != 0) && (DEV_TYPE (dptr) != type))
+    return sim_messagef (SCPE_NOFNC, "%s is not a %s device\n", sim_uname (uptr), (type == DEV_DISK) ? "disk" : "tape");
+switch (DEV_TYPE (dptr)) {
+    case DEV_DISK:
+        return sim_disk_benchmark (uptr, cptr);
+    case DEV_TAPE:
+        return sim_tape_benchmark (uptr, cptr);
+    default:
+        break;
+    }
+return sim_messagef (SCPE_NOFNC, "%s is not a disk or tape device\n", sim_uname (uptr));
+}
@@ -113,6 +113,11 @@ t_stat sleep_cmd (int32 flag, CONST char *ptr);
 t_stat help_cmd (int32 flag, CONST char *ptr);
 t_stat screenshot_cmd (int32 flag, CONST char *ptr);
 t_stat spawn_cmd (int32 flag, CONST char *ptr);
+t_stat clone_cmd (int32 flag, CONST char *ptr);
+t_stat migrate_cmd (int32 flag, CONST char *ptr);
+t_stat profile_cmd (int32 flag, CONST char *ptr);
+t_stat benchmark_cmd (int32 flag, CONST char *ptr);
+t_stat trace_cmd (int32 flag, CONST char *ptr);
 t_stat echo_cmd (int32 flag, CONST char *ptr);
 t_stat echof_cmd (int32 flag, CONST char *ptr);
 t_stat debug_cmd (int32 flag, CONST char *ptr);
@@ -261,6 +266,9 @@ void sim_debug_bits (uint32 dbits, DEVICE* dptr, BITFIELD* bitdefs,
 #define CANT_USE_MACRO_VA_ARGS 1
 #endif
 void _sim_vdebug (uint32 dbits, DEVICE* dptr, UNIT *uptr, const char* fmt, va_list arglist);
+t_stat sim_trace_open (const char *filename, FILE **pf, FILEREF **pref);
+t_bool sim_trace_active (void);
+void sim_trace_flush (void);
 #ifdef CANT_USE_MACRO_VA_ARGS
 #define _sim_debug_device sim_debug
 void sim_debug (uint32 dbits, DEVICE* dptr, const char *fmt, ...) GCC_FMT_ATTR(3, 4);
@@ -273,6 +281,7 @@ void _sim_debug_device (uint32 dbits, DEVICE* dptr, const char* fmt, ...) GCC_FM
 #define sim_debug_unit(dbits, uptr, ...) do { if ((sim_deb != NULL) && ((uptr) != NULL) && (uptr->dptr != NULL) && (((uptr)->dctrl | (uptr)->dptr->dctrl) & (dbits))) _sim_debug_unit (dbits, uptr, __VA_ARGS__);} while (0)
 #endif
 void sim_flush_buffered_files (void);
+void sim_startup_record (const char *phase, double start);
 
 void fprint_stopped_gen (FILE *st, t_stat v, REG *pc, DEVICE *dptr);
 #define SCP_HELP_FLAT   (1u << 31)       /* Force flat help when prompting is not possible */
@@ -332,6 +341,12 @@ extern uint32 sim_brk_summ;
 extern uint32 sim_brk_match_type;
 extern t_addr sim_brk_match_addr;
 extern BRKTYPTAB *sim_brk_type_desc;                    /* type descriptions */
+extern uint32 sim_brk_watch_types;                      /* watchpoint types */
+extern uint32 sim_brk_watch_shift;                      /* log2 watch page size */
+extern uint32 sim_brk_watch_map[];                      /* watched page map */
+#define SIM_BRK_WATCH_BITS      65536                   /* watched page map bits (power of 2) */
+#define SIM_BRK_WATCH_IDX(loc)  (((uint32)((loc) >> sim_brk_watch_shift)) & (SIM_BRK_WATCH_BITS - 1))
+#define SIM_BRK_WATCHED(loc)    (sim_brk_watch_map[SIM_BRK_WATCH_IDX (loc) >> 5] & (1u << (SIM_BRK_WATCH_IDX (loc) & 31)))
 extern const char *sim_prog_name;                       /* executable program name */
 extern FILE *stdnul;
 extern t_bool sim_asynch_enabled;
@@ -375,9 +390,12 @@ extern void (*sim_vm_fprint_addr) (FILE *st, DEVICE *dptr, t_addr addr);
 extern t_addr (*sim_vm_parse_addr) (DEVICE *dptr, CONST char *cptr, CONST char **tptr);
 extern t_bool (*sim_vm_fprint_stopped) (FILE *st, t_stat reason);
 extern t_value (*sim_vm_pc_value) (void);
+extern const char *(*sim_vm_pc_space) (void);
 extern t_bool (*sim_vm_is_subroutine_call) (t_addr **ret_addrs);
+extern void (*sim_vm_watch_change) (void);
 extern void (*sim_vm_reg_update) (REG *rptr, uint32 idx, t_value prev_val, t_value new_val);
 extern const char **sim_clock_precalibrate_commands;
+extern BENCHTAB *sim_vm_benchmarks;
 extern int32 sim_vm_initial_ips;                        /* base estimate of simulated instructions per second */
 extern const char *sim_vm_interval_units;               /* Simulator can change this - default "instructions" */
 extern const char *sim_vm_step_unit;                    /* Simulator can change this - default "instruction" */
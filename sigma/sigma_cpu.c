@@ -2512,7 +2512,7 @@ cons_alarm = 0;
 cons_pcf = 0;
 set_rf_display (R);
 if (M == NULL)
-    M = (uint32 *) calloc (MAXMEMSIZE, sizeof (uint32));
+    M = (uint32 *) sim_mem_alloc (MAXMEMSIZE * sizeof (uint32));
 if (M == NULL)
     return SCPE_MEM;
 pcq_r = find_reg ("PCQ", NULL, dptr);
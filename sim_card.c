@@ -86,9 +86,28 @@
 
 #define CARD_EOF          0x1000         /* This card is end of file card. */
 #define CARD_ERR          0x2000         /* Return error for this card */
-#define DECK_SIZE         1000           /* Number of cards to allocate at a time */
+#define CARD_CTL          0xffff         /* Text character handled by the parser */
+#define DECK_SIZE         1000           /* Number of cards to allocate at first */
+#define CARD_WINDOW       0x10000000     /* Most deck data a single card parse sees */
 
 
+struct card_deck                         /* A deck file loaded into the hopper */
+{
+    struct card_deck   *next;
+    SIM_MMAP           *map;             /* Mapping, NULL if read into memory */
+    const uint8        *data;            /* Deck contents */
+    size_t              size;            /* Bytes in deck */
+    uint32              flags;           /* Unit format flags when loaded */
+    uint16              xlat[256];       /* Text character to hollerith */
+};
+
+struct card_index                        /* A card in the hopper */
+{
+    struct card_deck   *deck;            /* Deck holding card, NULL for EOF card */
+    size_t              offset;          /* Start of card in deck */
+    uint16              flags;           /* CARD_EOF and CARD_ERR */
+};
+
 struct card_context
 {
     t_addr              punch_count;     /* Number of cards punched */
@@ -96,9 +115,12 @@ struct card_context
     uint8               hol_to_ascii[4096]; /* Back conversion table */
     t_addr              hopper_size;     /* Size of hopper */
     t_addr              hopper_cards;    /* Number of cards in hopper */
-    uint16              (*images)[1][80];
+    struct card_index  *cards;           /* Cards in hopper */
+    struct card_deck   *decks;           /* Decks the cards came from */
 };
 
+static void _sim_card_image(const struct card_index *card, uint16 (*image)[80]);
+
 /* Character conversion tables */
 
 const char          sim_six_to_ascii[64] = {
@@ -395,6 +417,7 @@ static uint16 ebcdic_to_hol[256] = {
 };
 
 static uint16 hol_to_ebcdic[4096];
+static uint16 bcd_to_hol[64];
 
 const uint8        sim_parity_table[64] = {
     /* 0    1    2    3    4    5    6    7 */
@@ -559,13 +582,13 @@ sim_card_input_hopper_count(UNIT *uptr) {
     struct card_context  *data = (struct card_context *)uptr->card_ctx;
     uint16                col;
 
-    if (data == NULL || data->images == NULL)
+    if (data == NULL || data->cards == NULL)
         return 0;           /* attached? */
 
     if (uptr->pos >= data->hopper_cards)
         return 0;
 
-    col = (*data->images)[data->hopper_cards-1][0];
+    col = data->cards[data->hopper_cards-1].flags;
 
     return (int)((data->hopper_cards - uptr->pos) - ((col & CARD_EOF) ? 1 : 0));
 }
@@ -587,7 +610,8 @@ sim_read_card(UNIT * uptr, uint16 image[80])
     int                   i;
     struct card_context  *data = (struct card_context *)uptr->card_ctx;
     DEVICE               *dptr;
-    uint16               (*img)[80];
+    uint16                card[80];
+    uint16               (*img)[80] = &card;
     t_stat                r = CDSE_OK;
 
     if (data == NULL || (uptr->flags & UNIT_ATT) == 0)
@@ -596,11 +620,11 @@ sim_read_card(UNIT * uptr, uint16 image[80])
         return CDSE_EMPTY;
 
     dptr = find_dev_from_unit( uptr);
-    img = &(*data->images)[uptr->pos];
+    _sim_card_image(&data->cards[uptr->pos], img);
     if (sim_deb && dptr && ((dptr)->dctrl & DEBUG_CARD)) {
-         if (image[0] & CARD_EOF) {
+         if ((*img)[0] & CARD_EOF) {
              sim_debug(DEBUG_CARD, dptr, "Read hopper EOF\n");
-         } else if (image[0] & CARD_ERR) {
+         } else if ((*img)[0] & CARD_ERR) {
              sim_debug(DEBUG_CARD, dptr, "Read hopper ERR\n");
          } else {
              uint8        out[81];
@@ -642,13 +666,13 @@ sim_card_eof(UNIT *uptr)
     struct card_context  *data = (struct card_context *)uptr->card_ctx;
     uint16                col;
 
-    if (data == NULL || data->images == NULL)
+    if (data == NULL || data->cards == NULL)
         return SCPE_UNATT;      /* attached? */
 
     if (uptr->pos >= data->hopper_cards)
         return SCPE_UNATT;
 
-    col = (*data->images)[uptr->pos][0];
+    col = data->cards[uptr->pos].flags;
 
     if (col & CARD_EOF)
         return 1;
@@ -658,32 +682,35 @@ sim_card_eof(UNIT *uptr)
 
 
 struct _card_buffer {
-   uint8                 buffer[8192+500];    /* Buffer data */
+   const uint8          *buffer;              /* Card data (rest of the deck) */
    int                   len;                 /* Amount of data in buffer */
    int                   size;                /* Size of last card read */
 };
 
-static int _cmpcard(const uint8 *p, const char *s) {
+/* Record mark bit of the first character of a BCD or CBN card is ignored */
+#define CARD_BYTE(b, i)   (((i) == 0) ? ((b)->buffer[0] & 0x7f) : (b)->buffer[i])
+
+static int _cmpcard(const struct _card_buffer *buf, const char *s) {
    int  i;
-   if (p[0] != '~')
+   if (buf->len < 4 || buf->buffer[0] != '~')
         return 0;
    for(i = 0; i < 3; i++) {
-        if (tolower(p[i+1]) != s[i])
+        if (tolower(buf->buffer[i+1]) != s[i])
            return 0;
    }
    return 1;
 }
 
 t_stat
-_sim_parse_card(UNIT *uptr, DEVICE *dptr, struct _card_buffer *buf, uint16 (*image)[80]) {
+_sim_parse_card(const struct card_deck *deck, DEVICE *dptr, struct _card_buffer *buf, uint16 (*image)[80]) {
     unsigned int          mode;
     uint16                temp;
     int                   i;
-    char                  c;
+    uint8                 c;
     int                   col;
 
     sim_debug(DEBUG_CARD, dptr, "Read card ");
-    if ((uptr->flags & UNIT_CARD_MODE) == MODE_AUTO) {
+    if ((deck->flags & UNIT_CARD_MODE) == MODE_AUTO) {
         mode = MODE_TEXT;   /* Default is text */
 
         /* Check buffer to see if binary card in it. */
@@ -693,15 +720,13 @@ _sim_parse_card(UNIT *uptr, DEVICE *dptr, struct _card_buffer *buf, uint16 (*ima
         if ((temp & 0x0f) == 0 && i == 160)
             mode = MODE_BIN;        /* Probably binary */
         /* Check if maybe BCD or CBN */
-        if (buf->buffer[0] & 0x80) {
+        if (buf->len > 0 && (buf->buffer[0] & 0x80)) {
             int     odd = 0;
             int     even = 0;
 
-            /* Clear record mark */
-            buf->buffer[0] &= 0x7f;
             /* Check all chars for correct parity */
             for(i = 0, temp = 0; i < buf->len; i++) {
-               uint8        ch = buf->buffer[i];
+               uint8        ch = CARD_BYTE(buf, i);
                /* Stop at EOR */
                if (ch & 0x80)
                    break;
@@ -711,8 +736,6 @@ _sim_parse_card(UNIT *uptr, DEVICE *dptr, struct _card_buffer *buf, uint16 (*ima
                else
                     odd++;
            }
-           /* Restore it */
-           buf->buffer[0] |= 0x80;
            if (i == 160 && odd == i)
                mode = MODE_CBN;
            else if (i < 80 && even == i)
@@ -720,21 +743,21 @@ _sim_parse_card(UNIT *uptr, DEVICE *dptr, struct _card_buffer *buf, uint16 (*ima
         }
 
         /* Check if modes match */
-        if ((uptr->flags & UNIT_CARD_MODE) != MODE_AUTO &&
-            (uptr->flags & UNIT_CARD_MODE) != mode) {
+        if ((deck->flags & UNIT_CARD_MODE) != MODE_AUTO &&
+            (deck->flags & UNIT_CARD_MODE) != mode) {
             (*image)[0] = CARD_ERR;
             sim_debug(DEBUG_CARD, dptr, "invalid mode\n");
             return SCPE_OPENERR;
         }
     } else
-        mode = uptr->flags & UNIT_CARD_MODE;
+        mode = deck->flags & UNIT_CARD_MODE;
 
     switch(mode) {
     default:
     case MODE_TEXT:
         sim_debug(DEBUG_CARD, dptr, "text: [");
         /* Check for special codes */
-        if (buf->buffer[0] == '~') {
+        if (buf->len > 0 && buf->buffer[0] == '~') {
             int f = 1;
             for(col = i = 1; col < 80 && f && i < buf->len; i++) {
                 c = buf->buffer[i];
@@ -758,7 +781,7 @@ _sim_parse_card(UNIT *uptr, DEVICE *dptr, struct _card_buffer *buf, uint16 (*ima
                 goto end_card;
              }
         }
-        if (_cmpcard(&buf->buffer[0], "raw")) {
+        if (_cmpcard(buf, "raw")) {
             int         j = 0;
             sim_debug(DEBUG_CARD, dptr, "-octal-");
             for(col = 0, i = 4; col < 80 && i < buf->len; i++) {
@@ -776,65 +799,60 @@ _sim_parse_card(UNIT *uptr, DEVICE *dptr, struct _card_buffer *buf, uint16 (*ima
                    j = 0;
                 }
             }
-        } else if (_cmpcard(&buf->buffer[0], "eor")) {
+        } else if (_cmpcard(buf, "eor")) {
             sim_debug(DEBUG_CARD, dptr, "-eor-");
             (*image)[0] = 07;        /* 7/8/9 punch */
             i = 4;
-        } else if (_cmpcard(&buf->buffer[0], "eof")) {
+        } else if (_cmpcard(buf, "eof")) {
             sim_debug(DEBUG_CARD, dptr, "-eof-");
             (*image)[0] = 015;       /* 6/7/9 punch */
             i = 4;
-        } else if (_cmpcard(&buf->buffer[0], "eoi")) {
+        } else if (_cmpcard(buf, "eoi")) {
             sim_debug(DEBUG_CARD, dptr, "-eoi-");
             (*image)[0] = 017;       /* 6/7/8/9 punch */
             i = 4;
         } else {
-            /* Convert text line into card image */
+            /* Convert text line into card image, the deck's translation
+               table folds case and selects the keypunch code */
             for (col = 0, i = 0; col < 80 && i < buf->len; i++) {
                 c = buf->buffer[i];
-                switch (c) {
-                case '\0':
-                case '\r':
-                    break;              /* Ignore these */
-                case '\t':
-                    col = (col | 7) + 1;        /* Mult of 8 */
-                    break;
-                case '\n':
-                    col = 80;
-                    i--;
-                    break;
-                default:
-                    sim_debug(DEBUG_CARD, dptr, "%c", c);
-                    if ((uptr->flags & MODE_LOWER) == 0)
-                        c = toupper(c);
-                    switch(uptr->flags & MODE_CHAR) {
+                temp = deck->xlat[c];
+                if (temp == CARD_CTL) {
+                    switch (c) {
+                    case '\t':
+                        col = (col | 7) + 1;        /* Mult of 8 */
+                        break;
+                    case '\n':
+                        col = 80;
+                        i--;
+                        break;
                     default:
-                    case MODE_026:
-                           temp = ascii_to_hol_026[(int)c];
-                           break;
-                    case MODE_029:
-                           temp = ascii_to_hol_029[(int)c];
-                           break;
-                    case MODE_DEC29:
-                           temp = ascii_to_dec_029[(int)c];
-                           break;
+                        break;              /* Ignore '\0' and '\r' */
                     }
-                    if (temp & 0xf000)
-                        (*image)[0] |= CARD_ERR;
-                    (*image)[col++] = temp & 0xfff;
+                    continue;
                 }
+                sim_debug(DEBUG_CARD, dptr, "%c", c);
+                if (temp & 0xf000)
+                    (*image)[0] |= CARD_ERR;
+                (*image)[col++] = temp & 0xfff;
             }
         }
     end_card:
         sim_debug(DEBUG_CARD, dptr, "-%d-", i);
 
         /* Scan to end of line, ignore anything after last column */
-        while (buf->buffer[i] != '\n' && buf->buffer[i] != '\r' && i < buf->len) {
-            i++;
+        if (i < buf->len && buf->buffer[i] != '\n' && buf->buffer[i] != '\r') {
+            const uint8 *eol = (const uint8 *)memchr(&buf->buffer[i], '\n', buf->len - i);
+            const uint8 *cr = (const uint8 *)memchr(&buf->buffer[i], '\r',
+                                  (eol ? (int)(eol - buf->buffer) : buf->len) - i);
+
+            if (cr)
+                eol = cr;
+            i = eol ? (int)(eol - buf->buffer) : buf->len;
         }
-        if (buf->buffer[i] == '\r')
+        if (i < buf->len && buf->buffer[i] == '\r')
             i++;
-        if (buf->buffer[i] == '\n')
+        if (i < buf->len && buf->buffer[i] == '\n')
             i++;
         sim_debug(DEBUG_CARD, dptr, "]\n");
         break;
@@ -868,72 +886,59 @@ _sim_parse_card(UNIT *uptr, DEVICE *dptr, struct _card_buffer *buf, uint16 (*ima
             break;
         }
 
-        /* Clear record mark */
-        buf->buffer[0] &= 0x7f;
-
         /* Convert card and check for errors */
         for (col = i = 0; i < buf->len && col < 80;) {
-            uint8       c;
-
-            if (buf->buffer[i] & 0x80)
+            c = CARD_BYTE(buf, i);
+            if (c & 0x80)
                 break;
-            c = buf->buffer[i] & 077;
-            if (sim_parity_table[(int)c] == (buf->buffer[i++] & 0100))
+            if (sim_parity_table[c & 077] == (c & 0100))
                 (*image)[0] |= CARD_ERR;
-            (*image)[col] = ((uint16)c) << 6;
-            if (buf->buffer[i] & 0x80)
+            (*image)[col] = ((uint16)(c & 077)) << 6;
+            if (++i >= buf->len || (buf->buffer[i] & 0x80))
                 break;
-            c = buf->buffer[i] & 077;
-            if (sim_parity_table[(int)c] == (buf->buffer[i++] & 0100))
+            c = buf->buffer[i++];
+            if (sim_parity_table[c & 077] == (c & 0100))
                 (*image)[0] |= CARD_ERR;
-            (*image)[col++] |= c;
+            (*image)[col++] |= c & 077;
         }
 
-        if (i < buf->len && col >= 80 && (buf->buffer[i] & 0x80) == 0) {
+        if (i < buf->len && col >= 80 && (CARD_BYTE(buf, i) & 0x80) == 0) {
            (*image)[0] |= CARD_ERR;
         }
         /* Record over length of card, skip until next */
-        while ((buf->buffer[i] & 0x80) == 0) {
-            if (i > buf->len)
-               break;
+        while (i < buf->len && (CARD_BYTE(buf, i) & 0x80) == 0)
             i++;
-        }
         break;
 
     case MODE_BCD:
         sim_debug(DEBUG_CARD, dptr, "bcd [");
         /* Check if first character is a tape mark */
-        if (buf->buffer[0] == 0217 && (buf->buffer[1] & 0200) != 0) {
+        if (buf->buffer[0] == 0217 && buf->len > 1 && (buf->buffer[1] & 0200) != 0) {
             i = 1;
             (*image)[0] |= CARD_EOF;
             break;
         }
 
-        /* Clear record mark */
-        buf->buffer[0] &= 0x7f;
-
         /* Convert text line into card image */
         for (col = 0, i = 0; col < 80 && i < buf->len; i++) {
-            if (buf->buffer[i] & 0x80)
+            c = CARD_BYTE(buf, i);
+            if (c & 0x80)
                 break;
-            c = buf->buffer[i] & 077;
-            if (sim_parity_table[(int)c] != (buf->buffer[i] & 0100))
+            if (sim_parity_table[c & 077] != (c & 0100))
                 (*image)[0] |= CARD_ERR;
+            c &= 077;
             sim_debug(DEBUG_CARD, dptr, "%c", sim_six_to_ascii[(int)c]);
             /* Convert to top column */
-            (*image)[col++] = sim_bcd_to_hol(c);
+            (*image)[col++] = bcd_to_hol[c];
         }
 
-        if (i < buf->len && col >= 80 && (buf->buffer[i] & 0x80) == 0) {
+        if (i < buf->len && col >= 80 && (CARD_BYTE(buf, i) & 0x80) == 0) {
            (*image)[0] |= CARD_ERR;
         }
 
         /* Record over length of card, skip until next */
-        while ((buf->buffer[i] & 0x80) == 0) {
-            if (i > buf->len)
-               break;
+        while (i < buf->len && (CARD_BYTE(buf, i) & 0x80) == 0)
             i++;
-        }
 
         sim_debug(DEBUG_CARD, dptr, "]\n");
         break;
@@ -943,10 +948,8 @@ _sim_parse_card(UNIT *uptr, DEVICE *dptr, struct _card_buffer *buf, uint16 (*ima
         if (buf->len < 80)
             (*image)[0] |= CARD_ERR;
         /* Move data to buffer */
-        for (i = 0; i < 80 && i < buf->len; i++) {
-            temp = (uint16)(buf->buffer[i]) & 0xFF;
-            (*image)[i] = ebcdic_to_hol[temp];
-        }
+        for (i = 0; i < 80 && i < buf->len; i++)
+            (*image)[i] = ebcdic_to_hol[buf->buffer[i]];
         break;
 
     }
@@ -954,15 +957,157 @@ _sim_parse_card(UNIT *uptr, DEVICE *dptr, struct _card_buffer *buf, uint16 (*ima
     return SCPE_OK;
 }
 
+/* Translate a card of the hopper into image on its way to being read */
+
+static void
+_sim_card_image(const struct card_index *card, uint16 (*image)[80])
+{
+    struct _card_buffer   buf;
+    size_t                left;
+
+    memset(image, 0, sizeof(*image));
+    if (card->deck == NULL) {           /* Generated EOF card */
+        (*image)[0] = card->flags;
+        return;
+    }
+    left = card->deck->size - card->offset;
+    buf.buffer = card->deck->data + card->offset;
+    buf.len = (int)((left < CARD_WINDOW) ? left : CARD_WINDOW);
+    buf.size = 0;
+    _sim_parse_card(card->deck, NULL, &buf, image);
+}
+
+/* Build the translation of text characters for a deck */
+
+static void
+_sim_card_xlat(struct card_deck *deck)
+{
+    const uint16         *to_hol;
+    int                   i;
+
+    switch(deck->flags & MODE_CHAR) {
+    default:
+    case MODE_026:
+           to_hol = ascii_to_hol_026;
+           break;
+    case MODE_029:
+           to_hol = ascii_to_hol_029;
+           break;
+    case MODE_DEC29:
+           to_hol = ascii_to_dec_029;
+           break;
+    }
+    for (i = 0; i < 256; i++) {
+        int       c = i;
+
+        if ((deck->flags & MODE_LOWER) == 0)
+            c = toupper(c);
+        deck->xlat[i] = (c < 128) ? to_hol[c] : 0xf000;
+    }
+    deck->xlat['\0'] = deck->xlat['\r'] = CARD_CTL;
+    deck->xlat['\t'] = deck->xlat['\n'] = CARD_CTL;
+}
+
+/* Load a deck file.  The file is memory mapped when the -M switch
+   was given, otherwise it is read into memory.  Either way cards are
+   only translated to images as they are read. */
+
+static t_stat
+_sim_card_load(UNIT * uptr, t_bool map, struct card_deck **pdeck)
+{
+    struct card_deck     *deck;
+    size_t                cap = 65536;
+    size_t                l;
+    uint8                *data;
+
+    *pdeck = NULL;
+    deck = (struct card_deck *)calloc(1, sizeof(*deck));
+    if (deck == NULL)
+        return SCPE_MEM;
+    deck->flags = uptr->flags & (UNIT_CARD_MODE | MODE_LOWER | MODE_CHAR);
+    _sim_card_xlat(deck);
+    if (map && sim_can_seek(uptr->fileref) && (sim_fsize_ex(uptr->fileref) > 0)) {
+        const void       *addr;
+        t_offset          size;
+
+        if (sim_mmap_open_readonly(uptr->filename, &deck->map, &addr, &size) == SCPE_OK) {
+            deck->data = (const uint8 *)addr;
+            deck->size = (size_t)size;
+            *pdeck = deck;
+            return SCPE_OK;
+        }
+    }
+    if (sim_can_seek(uptr->fileref))
+        cap = (size_t)sim_fsize_ex(uptr->fileref) + 1;
+    data = (uint8 *)malloc(cap);
+    while (data != NULL) {
+        l = sim_fread(&data[deck->size], 1, cap - deck->size, uptr->fileref);
+        deck->size += l;
+        if (deck->size < cap) {
+            if (ferror(uptr->fileref)) {
+                free(data);
+                free(deck);
+                return SCPE_IOERR;
+            }
+            break;
+        }
+        cap *= 2;
+        data = (uint8 *)realloc(data, cap);
+    }
+    if (data == NULL) {
+        free(deck);
+        return SCPE_MEM;
+    }
+    data[deck->size] = 0;               /* Room left for this above */
+    deck->data = data;
+    *pdeck = deck;
+    return SCPE_OK;
+}
+
+static void
+_sim_card_free_decks(struct card_context *data)
+{
+    while (data->decks != NULL) {
+        struct card_deck *deck = data->decks;
+
+        data->decks = deck->next;
+        if (deck->map != NULL)
+            sim_mmap_close(deck->map);
+        else
+            free((void *)deck->data);
+        free(deck);
+    }
+}
+
+/* Make room for another card in the hopper */
+
+static t_stat
+_sim_card_room(struct card_context *data)
+{
+    struct card_index    *cards;
+    t_addr                size;
+
+    if (data->hopper_cards < data->hopper_size)
+        return SCPE_OK;
+    size = data->hopper_size ? 2 * data->hopper_size : DECK_SIZE;
+    cards = (struct card_index *)realloc(data->cards, (size_t)size * sizeof(*cards));
+    if (cards == NULL)
+        return SCPE_MEM;
+    data->cards = cards;
+    data->hopper_size = size;
+    return SCPE_OK;
+}
+
 t_stat
 _sim_read_deck(UNIT * uptr, int eof)
 {
     struct _card_buffer   buf;
     struct card_context  *data;
+    struct card_deck     *deck;
+    struct card_index    *card;
     DEVICE               *dptr;
-    int                   i;
-    int                   j;
-    int                   l;
+    uint16                image[80];
+    size_t                offset = 0;
     int                   cards = 0;
     t_stat                r = SCPE_OK;
 
@@ -972,69 +1117,56 @@ _sim_read_deck(UNIT * uptr, int eof)
     dptr = find_dev_from_unit( uptr);
     data = (struct card_context *)uptr->card_ctx;
 
-    buf.len = 0;
-    buf.size = 0;
-    buf.buffer[0] = 0; /* Initialize bufer to empty */
+    r = _sim_card_load(uptr, (sim_switches & SWMASK ('M')) != 0, &deck);
+    if (r != SCPE_OK)
+        return sim_messagef(SCPE_OPENERR, "%s: %s Error (%s) reading deck\n",
+               sim_uname(uptr), uptr->filename, sim_error_text(r));
+    deck->next = data->decks;
+    data->decks = deck;
 
-    /* Slurp up current file */
+    /* Index the deck: find where each card starts and which are EOF or
+       error cards.  Images are produced again as the cards are read. */
     do {
-        if (buf.len < 500 && !feof(uptr->fileref)) {
-            l = sim_fread(&buf.buffer[buf.len], 1, 8192, uptr->fileref);
-            if (l < 0)
-                r = SCPE_OPENERR;
-            else
-                buf.len += l;
-        }
-
-        /* Allocate space for some more cards if needed */
-        if (data->hopper_cards >= data->hopper_size) {
-            data->hopper_size += DECK_SIZE;
-            data->images = (uint16 (*)[1][80])realloc(data->images,
-                       (size_t)data->hopper_size * sizeof(*(data->images)));
-            memset(&data->images[data->hopper_cards], 0,
-                       (size_t)(data->hopper_size - data->hopper_cards) *
-                             sizeof(*(data->images)));
-        }
+        if ((r = _sim_card_room(data)) != SCPE_OK)
+            break;
+        buf.buffer = deck->data + offset;
+        buf.len = (int)(((deck->size - offset) < CARD_WINDOW) ? (deck->size - offset) : CARD_WINDOW);
+        buf.size = 0;
 
         /* Process one card */
         cards++;
-        if (_sim_parse_card(uptr, dptr, &buf, &(*data->images)[data->hopper_cards])
-                != SCPE_OK) {
+        memset(image, 0, sizeof(image));
+        card = &data->cards[data->hopper_cards];
+        card->deck = deck;
+        card->offset = offset;
+        if (_sim_parse_card(deck, dptr, &buf, &image) != SCPE_OK) {
             r = sim_messagef(SCPE_OPENERR, "%s: %s Error (%s) in card %d\n",
                    sim_uname(uptr), uptr->filename, sim_error_text(r), cards);
         }
+        card->flags = image[0] & (CARD_EOF | CARD_ERR);
         data->hopper_cards++;
-        /* Move data to start at begining of buffer */
-        /* Data is moved down to simplify the decoding of one card */
-        l = buf.len - buf.size;
-        j = buf.size;
-        for(i = 0; i < l; i++, j++)
-            buf.buffer[i] = buf.buffer[j];
-        buf.len -= buf.size;
-    } while (buf.len > 0 && r == SCPE_OK);
+        offset += buf.size;
+    } while (offset < deck->size && buf.size > 0 && r == SCPE_OK);
 
     /* If there is an error, free just read deck */
     if (r == SCPE_OK) {
        if (eof) {
           /* Allocate space for some more cards if needed */
-          if (data->hopper_cards >= data->hopper_size) {
-              data->hopper_size += DECK_SIZE;
-              data->images = (uint16 (*)[1][80])realloc(data->images,
-                         (size_t)data->hopper_size * sizeof(*(data->images)));
-              memset(&data->images[data->hopper_cards], 0,
-                         (size_t)(data->hopper_size - data->hopper_cards) *
-                               sizeof(*(data->images)));
-          }
+          if ((r = _sim_card_room(data)) != SCPE_OK)
+              return r;
 
           /* Create empty card */
-          (*data->images)[data->hopper_cards][0] = CARD_EOF;
+          card = &data->cards[data->hopper_cards];
+          card->deck = NULL;
+          card->offset = 0;
+          card->flags = CARD_EOF;
           data->hopper_cards++;
        }
     }
     return r;
 }
 
-
+
 /* Card punch routine
 
    Modifiers have been checked by the caller
@@ -1311,6 +1443,8 @@ sim_card_attach(UNIT * uptr, CONST char *cptr)
                 hol_to_ebcdic[temp] = i;
             }
         }
+        for (i = 0; i < 64; i++)
+            bcd_to_hol[i] = sim_bcd_to_hol((uint8)i);
         ebcdic_init = 1;
     }
 
@@ -1344,8 +1478,9 @@ sim_card_attach(UNIT * uptr, CONST char *cptr)
            data->hopper_cards = 0;
            data->hopper_size = 0;
            data->punch_count = 0;
-           free(data->images);
-           data->images = NULL;
+           free(data->cards);
+           data->cards = NULL;
+           _sim_card_free_decks(data);
            free(saved_filename);
            saved_filename = NULL;
            saved_pos = 0;
@@ -1399,7 +1534,8 @@ sim_card_detach(UNIT * uptr)
     if (uptr->card_ctx != 0) {
         struct card_context * data = (struct card_context *)uptr->card_ctx;
         /* No clear any existing decks on stack */
-        free(data->images);
+        free(data->cards);
+        _sim_card_free_decks(data);
         free(uptr->card_ctx);
         uptr->card_ctx = 0;
     }
@@ -1450,6 +1586,9 @@ t_stat sim_card_attach_help(FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, cons
     if (readers != 0) {
         fprintf (st, "    -E          Return EOF after deck read\n");
         fprintf (st, "    -S          Append deck to cards currently waiting to be read\n");
+        fprintf (st, "    -M          Memory map the deck file rather than reading it into\n");
+        fprintf (st, "                memory (for very large decks, the file must not change\n");
+        fprintf (st, "                while it is attached)\n");
     }
     return SCPE_OK;
 }
@@ -91,6 +91,7 @@
    sim_poll_kbd                 poll for keyboard input
    sim_putchar                  output character to console
    sim_putchar_s                output character to console, stall if congested
+   sim_putchar_flush            write buffered console output
    sim_set_console              set console parameters
    sim_show_console             show console parameters
    sim_set_remote_console       set remote console parameters
@@ -114,6 +115,7 @@
    sim_ttisatty                 called to determine if running interactively
    sim_os_poll_kbd              poll for keyboard input
    sim_os_putchar               output character to console
+   sim_os_putchars              output buffered characters to console
    sim_set_noconsole_port       Enable automatic WRU console polling
    sim_set_stable_registers_state Declare that all registers are always stable
 
@@ -131,6 +133,8 @@
 #include "sim_tmxr.h"
 #include "sim_serial.h"
 #include "sim_timer.h"
+#include "sim_disk.h"
+#include "sim_ether.h"
 #include <ctype.h>
 #include <math.h>
 
@@ -147,17 +151,29 @@
 static t_stat sim_os_poll_kbd (void);
 static t_bool sim_os_poll_kbd_ready (int ms_timeout);
 static t_stat sim_os_putchar (int32 out);
+static t_stat sim_os_putchars (const char *buf, size_t len);
 static t_stat sim_os_ttinit (void);
 static t_stat sim_os_ttrun (void);
 static t_stat sim_os_ttcmd (void);
 static t_stat sim_os_ttclose (void);
 static t_bool sim_os_fd_isatty (int fd);
 
+/* Keyboard wait thread (wakes the console input unit on host keyboard input) */
+
+#if defined(SIM_ASYNCH_IO) && !defined(SIM_ASYNCH_MUX) && !defined(VMS)
+#define SIM_CON_KBD_THREAD 1
+static void sim_con_kbd_run (t_bool running);
+static void sim_con_kbd_polled (void);
+static void sim_con_kbd_shutdown (void);
+#endif
+
 static t_stat sim_set_rem_telnet (int32 flag, CONST char *cptr);
 static t_stat sim_set_rem_bufsize (int32 flag, CONST char *cptr);
 static t_stat sim_set_rem_connections (int32 flag, CONST char *cptr);
 static t_stat sim_set_rem_timeout (int32 flag, CONST char *cptr);
 static t_stat sim_set_rem_master (int32 flag, CONST char *cptr);
+static t_stat sim_set_rem_metrics (int32 flag, CONST char *cptr);
+static void sim_show_rem_metrics (FILE *st);
 
 /* Deprecated CONSOLE HALT, CONSOLE RESPONSE and CONSOLE DELAY support */
 static t_stat sim_set_halt (int32 flag, CONST char *cptr);
@@ -196,9 +212,33 @@ static t_stat sim_con_poll_svc (UNIT *uptr);                /* console connectio
 static t_stat sim_con_reset (DEVICE *dptr);                 /* console reset routine */
 static t_stat sim_con_attach (UNIT *uptr, CONST char *ptr); /* console attach routine (save,restore) */
 static t_stat sim_con_detach (UNIT *uptr);                  /* console detach routine (save,restore) */
+static t_stat sim_con_out_svc (UNIT *uptr);                 /* console output flush routine */
 
-UNIT sim_con_units[2] = {{ UDATA (&sim_con_poll_svc, UNIT_ATTABLE, 0)}}; /* console connection unit */
+UNIT sim_con_units[3] = {{ UDATA (&sim_con_poll_svc, UNIT_ATTABLE, 0)}, /* console connection unit */
+                         { 0 },
+                         { UDATA (&sim_con_out_svc, UNIT_DIS, 0)}};     /* console output flush unit */
 #define sim_con_unit sim_con_units[0]
+#define sim_con_out_unit sim_con_units[2]
+
+/* Console output buffering
+
+   Characters written to the in-window console while the simulator runs are
+   collected in sim_con_obuf and written to the terminal and the console log
+   with a single call, instead of a system call per character.  The buffer is
+   written when it fills, when the keyboard is polled, when its oldest
+   character has waited sim_con_obuf_latency milliseconds, and when the
+   simulator stops or prints a message of its own.
+*/
+
+#define CON_OBUF_DFLT       8192                        /* default output buffer size */
+#define CON_OBUF_MAX        (1024*1024)
+#define CON_OLAT_DFLT       20                          /* default output latency (ms) */
+#define CON_OLAT_MAX        1000
+
+static char *sim_con_obuf = NULL;                       /* output buffer */
+static size_t sim_con_obuf_size = CON_OBUF_DFLT;        /* size, 0 if unbuffered */
+static size_t sim_con_obuf_cnt = 0;                     /* characters buffered */
+static uint32 sim_con_obuf_latency = CON_OLAT_DFLT;     /* maximum latency (ms) */
 
 /* debugging bitmaps */
 #define DBG_TRC  TMXR_DBG_TRC                           /* trace routine calls */
@@ -228,6 +268,7 @@ static REG sim_con_reg[] = {
     { ORDATAD (DEL,         sim_del_char,  8, "delete character ") },
     { ORDATAD (PCHAR,       sim_tt_pchar, 32, "printable character mask") },
     { DRDATAD (CONSOLE_POS, sim_con_pos,  32, "character output count") },
+    { DRDATAD (OUTLATENCY, sim_con_obuf_latency, 32, "output buffer latency (ms)") },
   { 0 },
 };
 
@@ -242,7 +283,7 @@ return "Console telnet support";
 
 DEVICE sim_con_telnet = {
     "CON-TELNET", sim_con_units, sim_con_reg, sim_con_mod, 
-    2, 0, 0, 0, 0, 0, 
+    3, 0, 0, 0, 0, 0, 
     NULL, NULL, sim_con_reset, NULL, sim_con_attach, sim_con_detach, 
     NULL, DEV_DEBUG | DEV_NOSAVE, 0, sim_con_debug,
     NULL, NULL, NULL, NULL, NULL, sim_con_telnet_description};
@@ -318,6 +359,9 @@ static CTAB set_con_tab[] = {
     { "DBGINT",  &sim_set_kmap, KMAP_DBGINT | KMAP_NZ },
     { "PCHAR",   &sim_set_pchar, 0 },
     { "SPEED",   &sim_set_cons_speed, 0 },
+    { "OUTBUFFER", &sim_set_cons_obuf, 1 },
+    { "NOOUTBUFFER", &sim_set_cons_obuf, 0 },
+    { "OUTLATENCY", &sim_set_cons_olatency, 0 },
     { "TELNET",  &sim_set_telnet, 0 },
     { "NOTELNET", &sim_set_notelnet, 0 },
     { "SERIAL",  &sim_set_serial, 0 },
@@ -343,6 +387,8 @@ static CTAB set_rem_con_tab[] = {
     { "TIMEOUT", &sim_set_rem_timeout, 0 },
     { "MASTER", &sim_set_rem_master, 1 },
     { "NOMASTER", &sim_set_rem_master, 0 },
+    { "METRICS", &sim_set_rem_metrics, 1 },
+    { "NOMETRICS", &sim_set_rem_metrics, 0 },
     { NULL, NULL, 0 }
     };
 
@@ -355,6 +401,7 @@ static SHTAB show_con_tab[] = {
 #endif
     { "PCHAR", &sim_show_pchar, 0 },
     { "SPEED", &sim_show_cons_speed, 0 },
+    { "OUTBUFFER", &sim_show_cons_obuf, 0 },
     { "LOG", &sim_show_cons_log, 0 },
     { "TELNET", &sim_show_telnet, 0 },
     { "DEBUG", &sim_show_cons_debug, 0 },
@@ -451,12 +498,14 @@ t_stat sim_rem_con_poll_svc (UNIT *uptr);               /* remote console connec
 t_stat sim_rem_con_data_svc (UNIT *uptr);               /* remote console connection data routine */
 t_stat sim_rem_con_repeat_svc (UNIT *uptr);             /* remote auto repeat command console timing routine */
 t_stat sim_rem_con_smp_collect_svc (UNIT *uptr);        /* remote remote register data sampling routine */
+t_stat sim_rem_con_pub_svc (UNIT *uptr);                /* remote register shared memory publishing routine */
 t_stat sim_rem_con_reset (DEVICE *dptr);                /* remote console reset routine */
 #define rem_con_poll_unit (&sim_remote_console.units[0])
 #define rem_con_data_unit (&sim_remote_console.units[1])
 #define REM_CON_BASE_UNITS 2
 #define rem_con_repeat_units (&sim_remote_console.units[REM_CON_BASE_UNITS])
 #define rem_con_smp_smpl_units (&sim_remote_console.units[REM_CON_BASE_UNITS+sim_rem_con_tmxr.lines])
+#define rem_con_pub_units (&sim_remote_console.units[REM_CON_BASE_UNITS+2*sim_rem_con_tmxr.lines])
 
 #define DBG_MOD  0x00000004                             /* Remote Console Mode activities */
 #define DBG_REP  0x00000008                             /* Remote Console Repeat activities */
@@ -491,13 +540,6 @@ DEVICE sim_remote_console = {
     NULL, DEV_DEBUG | DEV_NOSAVE, 0, sim_rem_con_debug,
     NULL, NULL, NULL, NULL, NULL, sim_rem_con_description};
 
-typedef struct BITSAMPLE BITSAMPLE;
-struct BITSAMPLE {
-    int             tot;            /* total of all values */
-    int             ptr;            /* pointer to next value cell */
-    int             depth;          /* number of values */
-    int             *vals;          /* values */
-    };
 typedef struct BITSAMPLE_REG BITSAMPLE_REG;
 struct BITSAMPLE_REG {
     REG             *reg;           /* Register to be sampled */
@@ -506,7 +548,23 @@ struct BITSAMPLE_REG {
     DEVICE          *dptr;          /* Device register is part of */
     UNIT            *uptr;          /* Unit Register is related to */
     uint32          width;          /* number of bits to sample */
-    BITSAMPLE       *bits;
+    void            *loc;           /* resolved register storage (NULL if circular) */
+    size_t          size;           /* storage size in bytes */
+    t_value         mask;           /* register value mask */
+    };
+typedef struct PUBLISH_REG PUBLISH_REG;
+struct PUBLISH_REG {
+    REG             *reg;           /* Register to be published */
+    uint32          idx;            /* First register index */
+    uint32          count;          /* number of elements published */
+    };
+/* Published register snapshot.  This layout is shared with sim_frontpanel.c */
+typedef struct PUBLISH_DATA PUBLISH_DATA;
+struct PUBLISH_DATA {
+    int32           sequence;       /* odd while an update is in progress */
+    uint32          count;          /* number of values which follow */
+    t_uint64        time;           /* simulation time of the snapshot */
+    t_uint64        values[1];      /* register values in request order */
     };
 typedef struct REMOTE REMOTE;
 struct REMOTE {
@@ -528,6 +586,23 @@ struct REMOTE {
     int             smp_sample_dither_pct;  /* dithering of cycles interval */
     uint32          smp_reg_count;          /* sample register count */
     BITSAMPLE_REG   *smp_regs;              /* registers being sampled */
+    uint32          smp_depth;              /* samples kept per register */
+    uint32          smp_ptr;                /* next sample ring slot */
+    t_value         *smp_ring;              /* sample ring (depth rows of reg_count) */
+    t_bool          smp_stream;             /* push binary frames as the ring fills */
+    uint32          smp_pending;            /* samples since last pushed frame */
+    uint32          smp_dropped;            /* frames dropped for lack of buffer */
+    size_t          smp_frame_size;         /* binary frame size */
+    uint8           *smp_frame;             /* binary frame buffer */
+    uint32          pub_interval;           /* usecs between register publications */
+    uint32          pub_reg_count;          /* published register count */
+    PUBLISH_REG     *pub_regs;              /* registers being published */
+    SHMEM           *pub_shmem;             /* shared memory segment */
+    PUBLISH_DATA    *pub_data;              /* published register snapshot */
+    char            *bulk_name;             /* bulk transfer segment name */
+    size_t          bulk_size;              /* bulk transfer segment size */
+    SHMEM           *bulk_shmem;            /* bulk transfer segment */
+    void            *bulk_data;             /* bulk transfer data */
     };
 REMOTE *sim_rem_consoles = NULL;
 
@@ -554,20 +629,181 @@ if (rem->smp_reg_count == 0) {
     return SCPE_OK;
     }
 for (reg = 0; reg < rem->smp_reg_count; reg++) {
-    uint32 bit;
+    uint32 bit, smp;
 
     if (rem->smp_regs[reg].reg->depth > 1)
-        fprintf (st, "}%s %s[%d] %s %d:", rem->smp_regs[reg].dptr->name, rem->smp_regs[reg].reg->name, rem->smp_regs[reg].idx, rem->smp_regs[reg].indirect ? " -I" : "", rem->smp_regs[reg].bits[0].depth);
+        fprintf (st, "}%s %s[%d] %s %d:", rem->smp_regs[reg].dptr->name, rem->smp_regs[reg].reg->name, rem->smp_regs[reg].idx, rem->smp_regs[reg].indirect ? " -I" : "", rem->smp_depth);
     else
-        fprintf (st, "}%s %s%s %d:", rem->smp_regs[reg].dptr->name, rem->smp_regs[reg].reg->name, rem->smp_regs[reg].indirect ? " -I" : "", rem->smp_regs[reg].bits[0].depth);
-    for (bit = 0; bit < rem->smp_regs[reg].width; bit++)
-        fprintf (st, "%s%d", (bit != 0) ? "," : "", rem->smp_regs[reg].bits[bit].tot);
+        fprintf (st, "}%s %s%s %d:", rem->smp_regs[reg].dptr->name, rem->smp_regs[reg].reg->name, rem->smp_regs[reg].indirect ? " -I" : "", rem->smp_depth);
+    for (bit = 0; bit < rem->smp_regs[reg].width; bit++) {
+        int tot = 0;
+
+        for (smp = 0; smp < rem->smp_depth; smp++)
+            tot += (int)((rem->smp_ring[smp * rem->smp_reg_count + reg] >> bit) & 1);
+        fprintf (st, "%s%d", (bit != 0) ? "," : "", tot);
+        }
     fprintf (st, "\n");
     }
 return SCPE_OK;
 }
 
 
+static t_value sim_rem_width_mask (uint32 width)
+{
+if (width >= (8 * sizeof (t_value)))
+    return ~((t_value)0);
+return (((t_value)1) << width) - 1;
+}
+
+/* Resolve a sampled register to its storage once, so that collecting a
+   sample is a direct load rather than a get_rval call.  The layout rules
+   mirror get_rval.  Circular registers move with their queue pointer and
+   are still read through get_rval. */
+
+static void sim_rem_resolve_reg (BITSAMPLE_REG *smp)
+{
+REG *rptr = smp->reg;
+uint32 idx = smp->idx;
+size_t sz;
+
+switch ((rptr->width + rptr->offset + 7) / 8) {
+    case 0:
+    case 1:
+        sz = sizeof (uint8);
+        break;
+    case 2:
+        sz = sizeof (uint16);
+        break;
+    case 3:
+    case 4:
+        sz = sizeof (uint32);
+        break;
+    default:
+        sz = sizeof (t_value);
+        break;
+    }
+smp->mask = sim_rem_width_mask (rptr->width);
+smp->loc = NULL;
+smp->size = sz;
+if ((rptr->depth > 1) && (rptr->flags & REG_CIRC))
+    return;
+if ((rptr->depth > 1) && (rptr->flags & (REG_UNIT | REG_STRUCT))) {
+    if (rptr->flags & REG_UNIT)
+        smp->loc = (void *)(((UNIT *) rptr->loc) + idx);
+    else
+        smp->loc = (void *)(((char *) rptr->loc) + (idx * rptr->str_size));
+    smp->size = (sz <= sizeof (uint32)) ? sizeof (uint32) : sz;
+    }
+else if (((rptr->depth > 1) || (rptr->flags & REG_FIT)) &&
+    (sz == sizeof (uint8)))
+    smp->loc = (void *)(((uint8 *) rptr->loc) + idx);
+else if (((rptr->depth > 1) || (rptr->flags & REG_FIT)) &&
+    (sz == sizeof (uint16)))
+    smp->loc = (void *)(((uint16 *) rptr->loc) + idx);
+#if defined (USE_INT64)
+else if (sz <= sizeof (uint32)) {
+    smp->loc = (void *)(((uint32 *) rptr->loc) + idx);
+    smp->size = sizeof (uint32);
+    }
+else
+    smp->loc = (void *)(((t_uint64 *) rptr->loc) + idx);
+#else
+else {
+    smp->loc = (void *)(((uint32 *) rptr->loc) + idx);
+    smp->size = sizeof (uint32);
+    }
+#endif
+}
+
+/* Binary sample frame.  All fields are little endian:
+
+     '}' 'B'            frame marker
+     uint16             number of registers
+     uint32             samples per register
+     uint8[registers]   register sample widths in bits
+
+   followed by the samples, oldest first.  Each sample holds every
+   register's value in (width + 7) / 8 bytes.  A frame is sent whole or
+   not at all; frames which don't fit in the line's output buffer are
+   counted as dropped. */
+
+#define SMP_FRAME_GUARD 16                              /* output buffer slack */
+
+static t_bool sim_rem_sample_frame (REMOTE *rem)
+{
+TMLN *lp = rem->lp;
+uint8 *fp = rem->smp_frame;
+uint32 reg, smp, slot, bit;
+size_t sent;
+
+if ((!lp->conn) ||                                      /* need whole frame (+ IACs) room */
+    ((size_t)(lp->txbsz - tmxr_tqln (lp)) < (2 * rem->smp_frame_size + SMP_FRAME_GUARD))) {
+    ++rem->smp_dropped;
+    return FALSE;
+    }
+*fp++ = '}';
+*fp++ = 'B';
+*fp++ = (uint8)(rem->smp_reg_count & 0xFF);
+*fp++ = (uint8)((rem->smp_reg_count >> 8) & 0xFF);
+for (bit = 0; bit < 32; bit += 8)
+    *fp++ = (uint8)((rem->smp_depth >> bit) & 0xFF);
+for (reg = 0; reg < rem->smp_reg_count; reg++)
+    *fp++ = (uint8)rem->smp_regs[reg].width;
+slot = rem->smp_ptr;                                    /* oldest sample */
+for (smp = 0; smp < rem->smp_depth; smp++) {
+    t_value *row = &rem->smp_ring[slot * rem->smp_reg_count];
+
+    for (reg = 0; reg < rem->smp_reg_count; reg++) {
+        t_value val = row[reg];
+
+        for (bit = 0; bit < rem->smp_regs[reg].width; bit += 8) {
+            *fp++ = (uint8)(val & 0xFF);
+            val = val >> 8;
+            }
+        }
+    if (++slot >= rem->smp_depth)
+        slot = 0;
+    }
+tmxr_put_buf_ln (lp, rem->smp_frame, fp - rem->smp_frame, &sent);
+tmxr_send_buffered_data (lp);
+return TRUE;
+}
+
+/* Remote Console SAMPLEOUT command:
+       SAMPLEOUT               bit totals of the collected samples as text
+       SAMPLEOUT BINARY        the collected samples as one binary frame
+       SAMPLEOUT STREAM        push a binary frame each time the ring refills
+       SAMPLEOUT STOP          stop streaming binary frames
+ */
+static t_stat sim_rem_sampleout_cmd (int32 line, CONST char *cptr)
+{
+REMOTE *rem = &sim_rem_consoles[line];
+char gbuf[CBUFSIZE];
+
+if (*cptr == 0)
+    return sim_rem_sample_output (NULL, line);
+cptr = get_glyph (cptr, gbuf, 0);               /* get next glyph */
+if (*cptr != 0)
+    return SCPE_2MARG;
+if (MATCH_CMD (gbuf, "STOP") == 0) {
+    rem->smp_stream = FALSE;
+    return SCPE_OK;
+    }
+if ((MATCH_CMD (gbuf, "BINARY") != 0) &&
+    (MATCH_CMD (gbuf, "STREAM") != 0))
+    return sim_messagef (SCPE_ARG, "Expected BINARY, STREAM or STOP found: %s\n", gbuf);
+if (rem->smp_reg_count == 0)
+    return sim_messagef (SCPE_ARG, "Samples are not being collected\n");
+if (MATCH_CMD (gbuf, "STREAM") == 0) {
+    rem->smp_stream = TRUE;
+    rem->smp_pending = 0;
+    rem->smp_dropped = 0;
+    return SCPE_OK;
+    }
+return sim_rem_sample_frame (rem) ? SCPE_OK : SCPE_STALL;
+}
+
+
 /* SET REMOTE CONSOLE command */
 
 t_stat sim_set_remote_console (int32 flag, CONST char *cptr)
@@ -618,6 +854,7 @@ else {
     fprintf (st, "Remote Console Command Input listening on TCP port: %s\n", rem_con_poll_unit->filename);
     fprintf (st, "Remote Console Per Command Output buffer size:      %d bytes\n", sim_rem_con_tmxr.buffered);
     }
+sim_show_rem_metrics (st);
 for (i=connections=0; i<sim_rem_con_tmxr.lines; i++) {
     rem = &sim_rem_consoles[i];
     if (!rem->lp->conn)
@@ -657,9 +894,13 @@ for (i=connections=0; i<sim_rem_con_tmxr.lines; i++) {
             dptr = rem->smp_regs[reg].dptr;
             }
         fprintf (st, "\n");
+        if (rem->smp_stream)
+            fprintf (st, " Binary sample frames are being streamed (%u dropped)\n", rem->smp_dropped);
         if (sim_switches & SWMASK ('D'))
             sim_rem_sample_output (st, rem->line);
         }
+    if (rem->pub_reg_count)
+        fprintf (st, "%d Register values are published every %s\n", (int)rem->pub_data->count, sim_fmt_secs (rem->pub_interval / 1000000.0));
     }
 return SCPE_OK;
 }
@@ -738,6 +979,16 @@ static t_stat x_run_cmd (int32 flag, CONST char *cptr)
 return 7+SCPE_IERR;         /* This routine should never be called */
 }
 
+static t_stat x_publish_cmd (int32 flag, CONST char *cptr)
+{
+return 8+SCPE_IERR;         /* This routine should never be called */
+}
+
+static t_stat x_bulk_cmd (int32 flag, CONST char *cptr)
+{
+return 9+SCPE_IERR;         /* This routine should never be called */
+}
+
 static t_stat x_help_cmd (int32 flag, CONST char *cptr);
 
 static CTAB allowed_remote_cmds[] = {
@@ -752,6 +1003,8 @@ static CTAB allowed_remote_cmds[] = {
     { "REPEAT",   &x_repeat_cmd,      0 },
     { "COLLECT",  &x_collect_cmd,     0 },
     { "SAMPLEOUT",&x_sampleout_cmd,   0 },
+    { "PUBLISH",  &x_publish_cmd,     0 },
+    { "BULK",     &x_bulk_cmd,        0 },
     { "PWD",      &pwd_cmd,           0 },
     { "SAVE",     &save_cmd,          0 },
     { "DIR",      &dir_cmd,           0 },
@@ -777,6 +1030,8 @@ static CTAB allowed_master_remote_cmds[] = {
     { "REPEAT",   &x_repeat_cmd,      0 },
     { "COLLECT",  &x_collect_cmd,     0 },
     { "SAMPLEOUT",&x_sampleout_cmd,   0 },
+    { "PUBLISH",  &x_publish_cmd,     0 },
+    { "BULK",     &x_bulk_cmd,        0 },
     { "EXECUTE",  &x_execute_cmd,     0 },
     { "PWD",      &pwd_cmd,           0 },
     { "SAVE",     &save_cmd,          0 },
@@ -811,6 +1066,8 @@ static CTAB allowed_single_remote_cmds[] = {
     { "REPEAT",   &x_repeat_cmd,      0 },
     { "COLLECT",  &x_collect_cmd,     0 },
     { "SAMPLEOUT",&x_sampleout_cmd,   0 },
+    { "PUBLISH",  &x_publish_cmd,     0 },
+    { "BULK",     &x_bulk_cmd,        0 },
     { "EXECUTE",  &x_execute_cmd,     0 },
     { "PWD",      &pwd_cmd,           0 },
     { "DIR",      &dir_cmd,           0 },
@@ -828,6 +1085,8 @@ static CTAB remote_only_cmds[] = {
     { "REPEAT",   &x_repeat_cmd,      0 },
     { "COLLECT",  &x_collect_cmd,     0 },
     { "SAMPLEOUT",&x_sampleout_cmd,   0 },
+    { "PUBLISH",  &x_publish_cmd,     0 },
+    { "BULK",     &x_bulk_cmd,        0 },
     { "EXECUTE",  &x_execute_cmd,     0 },
     { NULL,       NULL }
     };
@@ -1112,17 +1371,18 @@ if ((stat != SCPE_OK) || (samples <= 0)) {      /* error? */
             }
         if (stat == SCPE_OK) {
             for (line = all_stop ? 0 : rem->line; line < (all_stop ? sim_rem_con_tmxr.lines : (rem->line + 1)); line++) {
-                uint32 i, j;
-
                 rem = &sim_rem_consoles[line];
-                for (i = 0; i< rem->smp_reg_count; i++) {
-                    for (j = 0; j < rem->smp_regs[i].width; j++)
-                        free (rem->smp_regs[i].bits[j].vals);
-                    free (rem->smp_regs[i].bits);
-                    }
                 free (rem->smp_regs);
                 rem->smp_regs = NULL;
                 rem->smp_reg_count = 0;
+                free (rem->smp_ring);
+                rem->smp_ring = NULL;
+                free (rem->smp_frame);
+                rem->smp_frame = NULL;
+                rem->smp_frame_size = 0;
+                rem->smp_depth = rem->smp_ptr = 0;
+                rem->smp_stream = FALSE;
+                rem->smp_pending = rem->smp_dropped = 0;
                 sim_cancel (&rem_con_smp_smpl_units[rem->line]);
                 rem->smp_sample_interval = 0;
                 }
@@ -1180,7 +1440,7 @@ else {
     while (cptr && *cptr) {
         const char *comma = strchr (cptr, ',');
         char tbuf[2*CBUFSIZE];
-        uint32 bit, width;
+        uint32 width;
         REG *reg;
         uint32 idx;
         int32 saved_switches = sim_switches;
@@ -1243,22 +1503,20 @@ else {
         smp_regs[rem->smp_reg_count].indirect = indirect;
         width = indirect ? sim_dfdev->dwidth : reg->width;
         smp_regs[rem->smp_reg_count].width = width;
-        smp_regs[rem->smp_reg_count].bits = (BITSAMPLE *)calloc (width, sizeof (*smp_regs[rem->smp_reg_count - 1].bits));
-        if (smp_regs[rem->smp_reg_count].bits == NULL) {
-            stat = SCPE_MEM;
-            break;
-            }
+        sim_rem_resolve_reg (&smp_regs[rem->smp_reg_count]);
         rem->smp_reg_count += 1;
-        for (bit = 0; bit < width; bit++) {
-            smp_regs[rem->smp_reg_count - 1].bits[bit].depth = samples;
-            smp_regs[rem->smp_reg_count - 1].bits[bit].vals = (int *)calloc (samples, sizeof (int));
-            if (smp_regs[rem->smp_reg_count - 1].bits[bit].vals == NULL) {
-                stat = SCPE_MEM;
-                break;
-                }
-            }
-        if (stat != SCPE_OK)
-            break;
+        }
+    if ((stat == SCPE_OK) && (rem->smp_reg_count != 0)) {
+        uint32 reg;
+
+        rem->smp_depth = samples;
+        rem->smp_ring = (t_value *)calloc ((size_t)samples * rem->smp_reg_count, sizeof (*rem->smp_ring));
+        rem->smp_frame_size = 8 + rem->smp_reg_count;
+        for (reg = 0; reg < rem->smp_reg_count; reg++)
+            rem->smp_frame_size += (size_t)samples * ((rem->smp_regs[reg].width + 7) / 8);
+        rem->smp_frame = (uint8 *)malloc (rem->smp_frame_size);
+        if ((rem->smp_ring == NULL) || (rem->smp_frame == NULL))
+            stat = SCPE_MEM;
         }
     if (stat != SCPE_OK) {                      /* Error? */
         *iptr = cptr;
@@ -1274,6 +1532,305 @@ else {
 return stat;
 }
 
+static void sim_rem_publish_stop (REMOTE *rem)
+{
+sim_cancel (&rem_con_pub_units[rem->line]);
+sim_shmem_close (rem->pub_shmem);
+rem->pub_shmem = NULL;
+rem->pub_data = NULL;
+free (rem->pub_regs);
+rem->pub_regs = NULL;
+rem->pub_reg_count = 0;
+rem->pub_interval = 0;
+}
+
+/* Register values are written between two increments of the sequence
+   number, so a reader which sees the same even sequence before and after
+   copying the values has a consistent snapshot.
+ */
+static void sim_rem_publish_registers (REMOTE *rem)
+{
+PUBLISH_DATA *pub = rem->pub_data;
+uint32 i, j, val = 0;
+
+sim_shmem_atomic_add (&pub->sequence, 1);               /* odd - update in progress */
+pub->time = (t_uint64)sim_gtime ();
+for (i = 0; i < rem->pub_reg_count; i++) {
+    PUBLISH_REG *preg = &rem->pub_regs[i];
+
+    for (j = 0; j < preg->count; j++)
+        pub->values[val++] = (t_uint64)get_rval (preg->reg, preg->idx + j);
+    }
+sim_shmem_atomic_add (&pub->sequence, 1);               /* even - snapshot complete */
+}
+
+/* 
+    Parse and setup Remote Console PUBLISH command:
+       PUBLISH name EVERY nnn USECS {dev} reg{,reg...}{;{dev} reg{,reg...}}
+       PUBLISH STOP {ALL}
+
+    Register values are published in a shared memory segment rather than
+    displayed, so a front panel can read them without any command parsing.
+ */
+static t_stat sim_rem_publish_cmd_setup (int32 line, CONST char **iptr)
+{
+char gbuf[CBUFSIZE], name[CBUFSIZE];
+int32 usecs;
+uint32 values = 0;
+t_stat stat = SCPE_OK;
+CONST char *cptr = *iptr;
+REMOTE *rem = &sim_rem_consoles[line];
+
+sim_debug (DBG_REP, &sim_remote_console, "Publish Setup: %s\n", cptr);
+if (*cptr == 0)         /* required argument? */
+    return SCPE_2FARG;
+cptr = get_glyph_nc (cptr, name, 0);            /* get segment name */
+if (MATCH_CMD (name, "STOP") == 0) {
+    if (*cptr) {                                /* more command arguments? */
+        cptr = get_glyph (cptr, gbuf, 0);       /* get next glyph */
+        if ((MATCH_CMD (gbuf, "ALL") != 0) ||   /*  */
+            (*cptr != 0)                   ||   /*  */
+            (line != 0))                        /* master line? */
+            stat = SCPE_ARG;
+        else {
+            for (line = 0; line < sim_rem_con_tmxr.lines; line++)
+                sim_rem_publish_stop (&sim_rem_consoles[line]);
+            }
+        }
+    else
+        sim_rem_publish_stop (rem);
+    *iptr = cptr;
+    return stat;
+    }
+cptr = get_glyph (cptr, gbuf, 0);               /* get next glyph */
+if (MATCH_CMD (gbuf, "EVERY") != 0) {
+    *iptr = cptr;
+    return sim_messagef (SCPE_ARG, "Expected EVERY found: %s\n", gbuf);
+    }
+cptr = get_glyph (cptr, gbuf, 0);               /* get next glyph */
+usecs = (int32) get_uint (gbuf, 10, INT_MAX, &stat);
+if ((stat != SCPE_OK) || (usecs <= 0)) {        /* error? */
+    *iptr = cptr;
+    return sim_messagef (SCPE_ARG, "Expected value found: %s\n", gbuf);
+    }
+cptr = get_glyph (cptr, gbuf, 0);               /* get next glyph */
+if ((MATCH_CMD (gbuf, "USECS") != 0) || (*cptr == 0)) {
+    *iptr = cptr;
+    return sim_messagef (SCPE_ARG, "Expected USECS found: %s\n", gbuf);
+    }
+sim_rem_publish_stop (rem);                     /* Start from a clean slate */
+while ((stat == SCPE_OK) && *cptr) {
+    const char *semi = strchr (cptr, ';');
+    char tbuf[CBUFSIZE];
+    CONST char *tptr;
+    int32 saved_switches = sim_switches;
+
+    if (semi) {
+        strlcpy (tbuf, cptr, MIN ((size_t)(semi - cptr) + 1, sizeof (tbuf)));
+        cptr = semi + 1;
+        }
+    else {
+        strlcpy (tbuf, cptr, sizeof (tbuf));
+        cptr += strlen (cptr);
+        }
+    sim_dfdev = sim_dflt_dev;
+    sim_dfunit = sim_dfdev->units;
+    tptr = tbuf;
+    if (strchr (tbuf, ' ')) {
+        tptr = get_sim_opt (CMD_OPT_DFT, tbuf, &stat);  /* get optional device */
+        sim_switches = saved_switches;
+        }
+    while ((stat == SCPE_OK) && tptr && *tptr) {
+        CONST char *rptr;
+        PUBLISH_REG *pub_regs;
+        REG *reg;
+        uint32 lo = 0, hi = 0;
+
+        tptr = get_glyph (tptr, gbuf, ',');     /* get next register */
+        reg = find_reg (gbuf, &rptr, sim_dfdev);
+        if (reg == NULL) {
+            stat = sim_messagef (SCPE_NXREG, "Nonexistent Register: %s\n", gbuf);
+            break;
+            }
+        if (*rptr == '[') {                     /* subscript? */
+            CONST char *tgptr = ++rptr;
+
+            if (reg->depth <= 1) {              /* array register? */
+                stat = sim_messagef (SCPE_SUB, "Not Array Register: %s\n", reg->name);
+                break;
+                }
+            lo = hi = (uint32) strtotv (tgptr, &rptr, 10);
+            if ((tgptr != rptr) && (*rptr == ':')) {
+                tgptr = ++rptr;
+                hi = (uint32) strtotv (tgptr, &rptr, 10);
+                }
+            if ((tgptr == rptr) || (*rptr++ != ']') || (*rptr != 0)) {
+                stat = sim_messagef (SCPE_SUB, "Missing or Invalid Register Subscript: %s\n", gbuf);
+                break;
+                }
+            if ((hi < lo) || (hi >= reg->depth)) {
+                stat = sim_messagef (SCPE_SUB, "Invalid Register Subscript: %s\n", gbuf);
+                break;
+                }
+            }
+        else {
+            if (*rptr != 0) {
+                stat = sim_messagef (SCPE_ARG, "Invalid Register Specification: %s\n", gbuf);
+                break;
+                }
+            }
+        pub_regs = (PUBLISH_REG *)realloc (rem->pub_regs, (rem->pub_reg_count + 1) * sizeof(*pub_regs));
+        if (pub_regs == NULL) {
+            stat = SCPE_MEM;
+            break;
+            }
+        rem->pub_regs = pub_regs;
+        pub_regs[rem->pub_reg_count].reg = reg;
+        pub_regs[rem->pub_reg_count].idx = lo;
+        pub_regs[rem->pub_reg_count].count = 1 + hi - lo;
+        rem->pub_reg_count += 1;
+        values += 1 + hi - lo;
+        }
+    }
+if ((stat == SCPE_OK) && (values == 0))
+    stat = SCPE_2FARG;
+if (stat == SCPE_OK)
+    stat = sim_shmem_open (name, sizeof (PUBLISH_DATA) + (values - 1) * sizeof (t_uint64), &rem->pub_shmem, (void **)&rem->pub_data);
+if (stat != SCPE_OK) {                          /* Error? */
+    sim_rem_publish_stop (rem);                 /* Cleanup mess */
+    *iptr = cptr;
+    return stat;
+    }
+rem->pub_data->sequence = 0;
+rem->pub_data->count = values;
+rem->pub_interval = usecs;
+sim_rem_publish_registers (rem);                /* initial snapshot */
+*iptr = cptr;
+return sim_activate_after (&rem_con_pub_units[line], usecs);
+}
+
+static void sim_rem_bulk_close (REMOTE *rem)
+{
+sim_shmem_close (rem->bulk_shmem);
+rem->bulk_shmem = NULL;
+rem->bulk_data = NULL;
+free (rem->bulk_name);
+rem->bulk_name = NULL;
+rem->bulk_size = 0;
+}
+
+/* 
+    Parse and perform Remote Console BULK command:
+       BULK EXAMINE name size bytes count {-switches} {dev} addr
+       BULK DEPOSIT name size bytes count {-switches} {dev} addr
+
+    count consecutive memory locations are moved between the device and 
+    the shared memory segment of size bytes created by the front panel.
+    Each value occupies bytes host order bytes in the segment.  The 
+    segment stays mapped until another segment is named or the session
+    ends.
+ */
+static t_stat sim_rem_bulk_cmd (int32 line, CONST char **iptr)
+{
+char gbuf[CBUFSIZE], name[CBUFSIZE];
+t_bool deposit;
+size_t size, bytes, count, i;
+t_addr addr;
+t_value val;
+t_stat stat = SCPE_OK;
+CONST char *cptr = *iptr;
+CONST char *tptr;
+int32 saved_switches = sim_switches;
+REMOTE *rem = &sim_rem_consoles[line];
+
+sim_debug (DBG_CMD, &sim_remote_console, "Bulk: %s\n", cptr);
+*iptr = cptr + strlen (cptr);
+cptr = get_glyph (cptr, gbuf, 0);               /* get operation */
+if ((*gbuf == 0) || 
+    ((MATCH_CMD (gbuf, "EXAMINE") != 0) && (MATCH_CMD (gbuf, "DEPOSIT") != 0)))
+    return sim_messagef (SCPE_ARG, "Expected EXAMINE or DEPOSIT found: %s\n", gbuf);
+deposit = (MATCH_CMD (gbuf, "DEPOSIT") == 0);
+cptr = get_glyph_nc (cptr, name, 0);            /* get segment name */
+cptr = get_glyph (cptr, gbuf, 0);
+size = (size_t) get_uint (gbuf, 10, INT_MAX, &stat);
+if ((*name == 0) || (stat != SCPE_OK) || (size == 0))
+    return sim_messagef (SCPE_ARG, "Expected segment name and size\n");
+cptr = get_glyph (cptr, gbuf, 0);
+bytes = (size_t) get_uint (gbuf, 10, sizeof (t_uint64), &stat);
+if ((stat != SCPE_OK) || 
+    ((bytes != 1) && (bytes != 2) && (bytes != 4) && (bytes != 8)))
+    return sim_messagef (SCPE_ARG, "Invalid value size: %s\n", gbuf);
+cptr = get_glyph (cptr, gbuf, 0);
+count = (size_t) get_uint (gbuf, 10, INT_MAX, &stat);
+if ((stat != SCPE_OK) || (count * bytes > size))
+    return sim_messagef (SCPE_ARG, "Invalid count: %s\n", gbuf);
+tptr = get_sim_opt (CMD_OPT_SW|CMD_OPT_DFT, cptr, &stat);  /* get switches and device */
+if (stat != SCPE_OK) {
+    sim_switches = saved_switches;
+    return stat;
+    }
+tptr = get_glyph (tptr, gbuf, 0);
+addr = (t_addr) strtotv (gbuf, &cptr, sim_dfdev->aradix);
+if ((*gbuf == 0) || (*cptr != 0) || (*tptr != 0)) {
+    sim_switches = saved_switches;
+    return sim_messagef (SCPE_ARG, "Invalid address: %s\n", gbuf);
+    }
+if ((deposit && (sim_dfdev->deposit == NULL)) || 
+    ((!deposit) && (sim_dfdev->examine == NULL))) {
+    sim_switches = saved_switches;
+    return SCPE_NOFNC;
+    }
+if ((rem->bulk_name == NULL) || strcmp (rem->bulk_name, name) || (rem->bulk_size != size)) {
+    sim_rem_bulk_close (rem);
+    stat = sim_shmem_open (name, size, &rem->bulk_shmem, &rem->bulk_data);
+    if (stat != SCPE_OK) {
+        sim_rem_bulk_close (rem);
+        sim_switches = saved_switches;
+        return stat;
+        }
+    rem->bulk_name = (char *)malloc (1 + strlen (name));
+    strcpy (rem->bulk_name, name);
+    rem->bulk_size = size;
+    }
+for (i = 0; (i < count) && (stat == SCPE_OK); i++, addr += sim_dfdev->aincr) {
+    uint8 *data = ((uint8 *)rem->bulk_data) + (i * bytes);
+
+    if (deposit) {
+        switch (bytes) {
+            case 1: val = *data; break;
+            case 2: val = *((uint16 *)data); break;
+            case 4: val = *((uint32 *)data); break;
+            default:val = (t_value)*((t_uint64 *)data); break;
+            }
+        stat = sim_dfdev->deposit (val, addr, sim_dfunit, sim_switches);
+        }
+    else {
+        val = 0;
+        stat = sim_dfdev->examine (&val, addr, sim_dfunit, sim_switches);
+        switch (bytes) {
+            case 1: *data = (uint8)val; break;
+            case 2: *((uint16 *)data) = (uint16)val; break;
+            case 4: *((uint32 *)data) = (uint32)val; break;
+            default:*((t_uint64 *)data) = (t_uint64)val; break;
+            }
+        }
+    }
+sim_switches = saved_switches;
+return stat;
+}
+
+t_stat sim_rem_con_pub_svc (UNIT *uptr)
+{
+int line = uptr - rem_con_pub_units;
+REMOTE *rem = &sim_rem_consoles[line];
+
+if (rem->pub_interval && rem->pub_data) {
+    sim_rem_publish_registers (rem);
+    sim_activate_after (uptr, rem->pub_interval);           /* reschedule */
+    }
+return SCPE_OK;
+}
+
 t_stat sim_rem_con_repeat_svc (UNIT *uptr)
 {
 int line = uptr - rem_con_repeat_units;
@@ -1288,48 +1845,61 @@ if (rem->repeat_interval) {
 return SCPE_OK;
 }
 
-static void sim_rem_record_reg_bit (BITSAMPLE *bit, int val)
-{
-bit->tot -= bit->vals[bit->ptr];    /* remove retired value */
-bit->tot += val;                    /* accumulate new value */
-bit->vals[bit->ptr] = val;          /* save new value */
-++bit->ptr;                         /* increment next pointer */
-if (bit->ptr >= bit->depth)         /* if too big */
-    bit->ptr = 0;                   /* wrap around */
-}
-
-static void sim_rem_set_reg_bit (BITSAMPLE *bit, int val)
+static t_value sim_rem_collect_reg (BITSAMPLE_REG *reg)
 {
-int i;
+t_value val;
 
-bit->tot = bit->depth * val;        /* compute total */
-for (i = 0; i < bit->depth; i++)    /* set all value bits */
-    bit->vals[i] = val;
-}
-
-static void sim_rem_collect_reg_bits (BITSAMPLE_REG *reg)
-{
-uint32 i;
-t_value val = get_rval (reg->reg, reg->idx);
-
-if (reg->indirect)
-    val = get_aval ((t_addr)val, reg->dptr, reg->uptr);
-val = val >> reg->reg->offset;
-for (i = 0; i < reg->width; i++) {
-    if (sim_is_running)
-        sim_rem_record_reg_bit (&reg->bits[i], val&1);
-    else
-        sim_rem_set_reg_bit (&reg->bits[i], val&1);
-    val = val >> 1;
+if (reg->loc == NULL)                       /* circular register? */
+    val = get_rval (reg->reg, reg->idx);
+else {
+    switch (reg->size) {
+        case sizeof (uint8):
+            val = *((uint8 *)reg->loc);
+            break;
+        case sizeof (uint16):
+            val = *((uint16 *)reg->loc);
+            break;
+#if defined (USE_INT64)
+        case sizeof (t_uint64):
+            val = *((t_uint64 *)reg->loc);
+            break;
+#endif
+        default:
+            val = *((uint32 *)reg->loc);
+            break;
+        }
+    val = (val >> reg->reg->offset) & reg->mask;
     }
+if (reg->indirect)
+    val = get_aval ((t_addr)val, reg->dptr, reg->uptr) & sim_rem_width_mask (reg->width);
+return val;
 }
 
+/* Store one sample of each register in the sample ring.  While the
+   simulator isn't running every ring slot gets the current values. */
+
 static void sim_rem_collect_registers (REMOTE *rem)
 {
 uint32 i;
+t_value *row;
 
+if (rem->smp_reg_count == 0)
+    return;
+row = &rem->smp_ring[rem->smp_ptr * rem->smp_reg_count];
 for (i = 0; i < rem->smp_reg_count; i++)
-    sim_rem_collect_reg_bits (&rem->smp_regs[i]);
+    row[i] = sim_rem_collect_reg (&rem->smp_regs[i]);
+if (!sim_is_running) {
+    for (i = 0; i < rem->smp_depth; i++)
+        if (i != rem->smp_ptr)
+            memcpy (&rem->smp_ring[i * rem->smp_reg_count], row, rem->smp_reg_count * sizeof (*row));
+    return;
+    }
+if (++rem->smp_ptr >= rem->smp_depth)
+    rem->smp_ptr = 0;
+if (rem->smp_stream && (++rem->smp_pending >= rem->smp_depth)) {
+    rem->smp_pending = 0;
+    sim_rem_sample_frame (rem);
+    }
 }
 
 static void sim_rem_collect_all_registers (void)
@@ -1392,6 +1962,10 @@ for (i=(was_active_command ? sim_rem_cmd_active_line : 0);
             cptr = strcpy (gbuf, "STOP");
             sim_rem_collect_cmd_setup (i, &cptr);   /* make sure it is now disabled */
             }
+        if (rem->pub_reg_count)                     /* were registers being published? */
+            sim_rem_publish_stop (rem);
+        if (rem->bulk_shmem)                        /* was a bulk transfer segment mapped? */
+            sim_rem_bulk_close (rem);
         continue;
         }
     if (master_session && !sim_rem_master_was_connected) {
@@ -1731,7 +2305,7 @@ for (i=(was_active_command ? sim_rem_cmd_active_line : 0);
                             if (cmdp->action == &x_sampleout_cmd) {
                                 sim_debug (DBG_CMD, &sim_remote_console, "sampleout_cmd executing\n");
                                 sim_oline = lp;                     /* specify output socket */
-                                stat = sim_rem_sample_output (NULL, i);
+                                stat = sim_rem_sampleout_cmd (i, cptr);
                                 }
                             else {
                                 if (cmdp->action == &x_repeat_cmd) {
@@ -1754,20 +2328,31 @@ for (i=(was_active_command ? sim_rem_cmd_active_line : 0);
                                             stat = sim_rem_collect_cmd_setup (i, &cptr);
                                             }
                                         else {
-                                            if ((sim_con_stable_registers &&    /* can we process command now? */
-                                                 sim_rem_master_mode) ||
-                                                (cmdp->action == &x_help_cmd)) {
-                                                sim_debug (DBG_CMD, &sim_remote_console, "Processing Command directly\n");
-                                                sim_oline = lp;         /* specify output socket */
-                                                if (cmdp->action == &x_help_cmd)
-                                                    x_help_cmd (0, cptr);
+                                            if ((cmdp->action == &x_publish_cmd) ||
+                                                (cmdp->action == &x_bulk_cmd)) {
+                                                sim_debug (DBG_CMD, &sim_remote_console, "%s executing\n", cmdp->name);
+                                                if (cmdp->action == &x_publish_cmd)
+                                                    stat = sim_rem_publish_cmd_setup (i, &cptr);
                                                 else
-                                                    sim_remote_process_command ();
-                                                stat = SCPE_OK;         /* any message has already been emitted */
+                                                    stat = sim_rem_bulk_cmd (i, &cptr);
+                                                sim_last_cmd_stat = SCPE_BARE_STATUS(stat);   /* status for a following ECHO */
                                                 }
                                             else {
-                                                sim_debug (DBG_CMD, &sim_remote_console, "Processing Command via SCPE_REMOTE\n");
-                                                stat = SCPE_REMOTE;     /* force processing outside of sim_instr() */
+                                                if ((sim_con_stable_registers &&    /* can we process command now? */
+                                                     sim_rem_master_mode) ||
+                                                    (cmdp->action == &x_help_cmd)) {
+                                                    sim_debug (DBG_CMD, &sim_remote_console, "Processing Command directly\n");
+                                                    sim_oline = lp;         /* specify output socket */
+                                                    if (cmdp->action == &x_help_cmd)
+                                                        x_help_cmd (0, cptr);
+                                                    else
+                                                        sim_remote_process_command ();
+                                                    stat = SCPE_OK;         /* any message has already been emitted */
+                                                    }
+                                                else {
+                                                    sim_debug (DBG_CMD, &sim_remote_console, "Processing Command via SCPE_REMOTE\n");
+                                                    stat = SCPE_REMOTE;     /* force processing outside of sim_instr() */
+                                                    }
                                                 }
                                             }
                                         }
@@ -1886,6 +2471,8 @@ if (sim_rem_con_tmxr.lines) {
             sim_activate_after (&rem_con_repeat_units[rem->line], rem->repeat_interval);    /* schedule */
         if (rem->smp_reg_count)
             sim_activate (&rem_con_smp_smpl_units[rem->line], rem->smp_sample_interval);    /* schedule */
+        if (rem->pub_interval)
+            sim_activate_after (&rem_con_pub_units[rem->line], rem->pub_interval);  /* schedule */
         }
     sim_activate_after (rem_con_data_unit, 100000);         /* continue polling for open sessions */
     return sim_rem_con_poll_svc (rem_con_poll_unit);        /* establish polling for new sessions */
@@ -1965,13 +2552,15 @@ for (i=0; i<sim_rem_con_tmxr.lines; i++) {
     free (rem->repeat_action);
     sim_cancel (&rem_con_repeat_units[i]);
     sim_cancel (&rem_con_smp_smpl_units[i]);
+    sim_rem_publish_stop (rem);
+    sim_rem_bulk_close (rem);
     }
 sim_rem_con_tmxr.lines = lines;
 sim_rem_con_tmxr.ldsc = (TMLN *)realloc (sim_rem_con_tmxr.ldsc, sizeof(*sim_rem_con_tmxr.ldsc)*lines);
 memset (sim_rem_con_tmxr.ldsc, 0, sizeof(*sim_rem_con_tmxr.ldsc)*lines);
-sim_remote_console.units = (UNIT *)realloc (sim_remote_console.units, sizeof(*sim_remote_console.units)*((2 * lines) + REM_CON_BASE_UNITS));
-memset (sim_remote_console.units, 0, sizeof(*sim_remote_console.units)*((2 * lines) + REM_CON_BASE_UNITS));
-sim_remote_console.numunits = (2 * lines) + REM_CON_BASE_UNITS;
+sim_remote_console.units = (UNIT *)realloc (sim_remote_console.units, sizeof(*sim_remote_console.units)*((3 * lines) + REM_CON_BASE_UNITS));
+memset (sim_remote_console.units, 0, sizeof(*sim_remote_console.units)*((3 * lines) + REM_CON_BASE_UNITS));
+sim_remote_console.numunits = (3 * lines) + REM_CON_BASE_UNITS;
 rem_con_poll_unit->action = &sim_rem_con_poll_svc;/* remote console connection polling unit */
 rem_con_poll_unit->flags |= UNIT_IDLE;
 rem_con_data_unit->action = &sim_rem_con_data_svc;/* console data handling unit */
@@ -1985,6 +2574,8 @@ for (i=0; i<lines; i++) {
     rem_con_repeat_units[i].action = &sim_rem_con_repeat_svc;
     rem_con_smp_smpl_units[i].flags = UNIT_DIS;
     rem_con_smp_smpl_units[i].action = &sim_rem_con_smp_collect_svc;
+    rem_con_pub_units[i].flags = UNIT_DIS;
+    rem_con_pub_units[i].action = &sim_rem_con_pub_svc;
     rem = &sim_rem_consoles[i];
     rem->line = i;
     rem->lp = &sim_rem_con_tmxr.ldsc[i];
@@ -2034,6 +2625,294 @@ return sim_rem_master_mode &&                                           /* maste
        (((TMLN *)lp) < sim_rem_con_tmxr.ldsc + sim_rem_con_tmxr.lines);
 }
 
+/* Metrics endpoint
+
+   SET REMOTE METRICS=port starts a thread which answers HTTP requests on
+   port with the most recent metrics snapshot in the Prometheus text
+   exposition format.  Snapshots are built by the INT-METRICS unit on the
+   simulator thread once a second (and when a run stops), so the server
+   thread never looks at simulator state and never delays instruction
+   execution.  A snapshot is handed over with a trylock; if the server
+   happens to be copying the previous one, the new one is discarded and
+   the next interval tries again.
+
+   Library and simulator code contributes samples with sim_metric().
+   Samples of the same metric family must be added consecutively.
+*/
+
+#define METRICS_INTERVAL_USECS  1000000                 /* snapshot refresh interval */
+#define METRICS_IO_TIMEOUT_MS   2000                    /* per request socket I/O limit */
+
+static t_stat sim_metrics_svc (UNIT *uptr);
+static t_stat sim_metrics_reset (DEVICE *dptr);
+
+static UNIT sim_metrics_unit = { UDATA (&sim_metrics_svc, UNIT_IDLE, 0) };
+
+static const char *sim_metrics_description (DEVICE *dptr)
+{
+return "Metrics endpoint snapshot publisher";
+}
+
+DEVICE sim_metrics_dev = {
+    "INT-METRICS", &sim_metrics_unit, NULL, NULL,
+    1, 0, 0, 0, 0, 0,
+    NULL, NULL, &sim_metrics_reset, NULL, NULL, NULL,
+    NULL, DEV_NOSAVE, 0,
+    NULL, NULL, NULL, NULL, NULL, NULL,
+    sim_metrics_description};
+
+static char *sim_metrics_port = NULL;                   /* listening port (NULL when disabled) */
+static char *sim_metrics_buf = NULL;                    /* snapshot being built */
+static size_t sim_metrics_size = 0;                     /*   its allocated size */
+static size_t sim_metrics_used = 0;                     /*   and its length */
+static char sim_metrics_family[CBUFSIZE];               /* family of the last sample added */
+
+#if defined(SIM_ASYNCH_IO)
+static uint32 sim_metrics_snapshots = 0;                /* snapshots handed to the server */
+static pthread_t sim_metrics_thread;                    /* HTTP server thread */
+static pthread_mutex_t sim_metrics_lock = PTHREAD_MUTEX_INITIALIZER;
+static char *sim_metrics_text = NULL;                   /* published snapshot (under lock) */
+static size_t sim_metrics_text_size = 0;
+static size_t sim_metrics_text_len = 0;
+static SOCKET sim_metrics_master = INVALID_SOCKET;      /* listening socket */
+static volatile t_bool sim_metrics_running = FALSE;     /* server thread should keep going */
+static volatile uint32 sim_metrics_requests = 0;        /* requests answered */
+#endif
+
+/* Add a sample to the snapshot being built.  type is "counter", "gauge"
+   or "histogram" (where the family name is the sample name without its
+   _bucket, _sum or _count suffix).  labelfmt, when not NULL, formats the
+   label list without its enclosing braces. */
+
+void sim_metric (const char *name, const char *type, double value, const char *labelfmt, ...)
+{
+char family[CBUFSIZE], labels[CBUFSIZE];
+char *suffix;
+size_t need;
+t_bool new_family;
+
+if (sim_metrics_port == NULL)
+    return;
+strlcpy (family, name, sizeof (family));
+if ((strcmp (type, "histogram") == 0) && ((suffix = strrchr (family, '_'))))
+    *suffix = '\0';
+labels[0] = '\0';
+if (labelfmt) {
+    va_list arglist;
+
+    va_start (arglist, labelfmt);
+    vsnprintf (labels, sizeof (labels), labelfmt, arglist);
+    va_end (arglist);
+    }
+new_family = (strcmp (family, sim_metrics_family) != 0);
+need = strlen (name) + strlen (labels) + 40 + (new_family ? strlen (family) + strlen (type) + 10 : 0);
+if (sim_metrics_used + need >= sim_metrics_size) {
+    size_t size = sim_metrics_size ? 2 * sim_metrics_size : 8192;
+    char *buf;
+
+    while (sim_metrics_used + need >= size)
+        size *= 2;
+    buf = (char *)realloc (sim_metrics_buf, size);
+    if (buf == NULL)
+        return;
+    sim_metrics_buf = buf;
+    sim_metrics_size = size;
+    }
+if (new_family) {
+    sim_metrics_used += sprintf (sim_metrics_buf + sim_metrics_used, "# TYPE %s %s\n", family, type);
+    strlcpy (sim_metrics_family, family, sizeof (sim_metrics_family));
+    }
+sim_metrics_used += sprintf (sim_metrics_buf + sim_metrics_used, "%s%s%s%s %.15g\n", name,
+                             labels[0] ? "{" : "", labels, labels[0] ? "}" : "", value);
+}
+
+/* Build a snapshot and hand it to the server thread */
+
+void sim_metrics_publish (void)
+{
+if (sim_metrics_port == NULL)
+    return;
+sim_metrics_used = 0;
+sim_metrics_family[0] = '\0';
+sim_metric ("simh_info", "gauge", 1, "simulator=\"%s\"", sim_name);
+sim_metric ("simh_running", "gauge", sim_is_running ? 1 : 0, NULL);
+sim_timer_publish_metrics ();
+tmxr_publish_metrics ();
+sim_disk_publish_metrics ();
+eth_publish_metrics ();
+#if defined(SIM_ASYNCH_IO)
+if (pthread_mutex_trylock (&sim_metrics_lock) == 0) {
+    char *text = sim_metrics_text;
+    size_t size = sim_metrics_text_size;
+
+    sim_metrics_text = sim_metrics_buf;                 /* swap buffers */
+    sim_metrics_text_size = sim_metrics_size;
+    sim_metrics_text_len = sim_metrics_used;
+    sim_metrics_buf = text;
+    sim_metrics_size = size;
+    pthread_mutex_unlock (&sim_metrics_lock);
+    ++sim_metrics_snapshots;
+    }
+#endif
+}
+
+static t_stat sim_metrics_svc (UNIT *uptr)
+{
+sim_metrics_publish ();
+return sim_activate_after (uptr, METRICS_INTERVAL_USECS);
+}
+
+static t_stat sim_metrics_reset (DEVICE *dptr)
+{
+if (sim_metrics_port && !sim_is_active (dptr->units))
+    return sim_activate_after (dptr->units, METRICS_INTERVAL_USECS);
+return SCPE_OK;
+}
+
+#if defined(SIM_ASYNCH_IO)
+/* Answer one request on a non blocking connection */
+
+static void _metrics_answer (SOCKET sock)
+{
+char req[2048], hdr[256];
+const char *status = "200 OK";
+char *text = NULL;
+size_t text_len = 0, sent;
+int len = 0, n, hlen, waited = 0;
+
+while ((len < (int)sizeof (req) - 1) && (waited < METRICS_IO_TIMEOUT_MS)) {
+    n = sim_read_sock (sock, req + len, (int)sizeof (req) - 1 - len);
+    if (n < 0)
+        return;
+    if (n == 0) {
+        sim_os_ms_sleep (10);
+        waited += 10;
+        continue;
+        }
+    len += n;
+    req[len] = '\0';
+    if (strstr (req, "\r\n\r\n") || strstr (req, "\n\n"))
+        break;
+    }
+req[len] = '\0';
+if (strncmp (req, "GET ", 4) != 0)
+    status = "405 Method Not Allowed";
+else if ((strncmp (req + 4, "/ ", 2) != 0) &&
+         (strncmp (req + 4, "/metrics ", 9) != 0) &&
+         (strncmp (req + 4, "/metrics?", 9) != 0))
+    status = "404 Not Found";
+else {
+    pthread_mutex_lock (&sim_metrics_lock);
+    if (sim_metrics_text_len && ((text = (char *)malloc (sim_metrics_text_len)))) {
+        memcpy (text, sim_metrics_text, sim_metrics_text_len);
+        text_len = sim_metrics_text_len;
+        }
+    pthread_mutex_unlock (&sim_metrics_lock);
+    }
+hlen = snprintf (hdr, sizeof (hdr), "HTTP/1.0 %s\r\n"
+                                    "Content-Type: text/plain; version=0.0.4\r\n"
+                                    "Content-Length: %u\r\n"
+                                    "Connection: close\r\n\r\n", status, (unsigned int)text_len);
+for (sent = 0, waited = 0; (sent < hlen + text_len) && (waited < METRICS_IO_TIMEOUT_MS); ) {
+    if (sent < (size_t)hlen)
+        n = sim_write_sock_v (sock, hdr + sent, hlen - (int)sent, text ? text : "", (int)text_len);
+    else
+        n = sim_write_sock (sock, text + (sent - hlen), (int)(text_len - (sent - hlen)));
+    if (n < 0)
+        break;
+    if (n == 0) {
+        sim_os_ms_sleep (10);
+        waited += 10;
+        }
+    sent += n;
+    }
+free (text);
+++sim_metrics_requests;
+}
+
+static void *
+_metrics_server (void *arg)
+{
+sim_os_set_thread_priority (PRIORITY_BELOW_NORMAL);
+while (sim_metrics_running) {
+    SOCKET sock = sim_accept_conn_ex (sim_metrics_master, NULL, 0);
+
+    if (sock == INVALID_SOCKET) {
+        sim_os_ms_sleep (50);
+        continue;
+        }
+    _metrics_answer (sock);
+    sim_close_sock (sock);
+    }
+return NULL;
+}
+#endif
+
+static t_stat sim_set_rem_metrics (int32 flag, CONST char *cptr)
+{
+#if defined(SIM_ASYNCH_IO)
+int parse_status;
+SOCKET master;
+
+if (!flag) {
+    if (cptr && *cptr)
+        return SCPE_2MARG;
+    if (sim_metrics_port == NULL)
+        return SCPE_OK;
+    sim_metrics_running = FALSE;
+    pthread_join (sim_metrics_thread, NULL);
+    sim_close_sock (sim_metrics_master);
+    sim_metrics_master = INVALID_SOCKET;
+    sim_cancel (&sim_metrics_unit);
+    free (sim_metrics_port);
+    sim_metrics_port = NULL;
+    free (sim_metrics_text);
+    sim_metrics_text = NULL;
+    sim_metrics_text_size = sim_metrics_text_len = 0;
+    return SCPE_OK;
+    }
+if ((cptr == NULL) || (*cptr == 0))
+    return SCPE_ARG;
+if (sim_metrics_port)
+    sim_set_rem_metrics (0, NULL);
+master = sim_master_sock_ex (cptr, &parse_status, SIM_SOCK_OPT_REUSEADDR);
+if (parse_status != SCPE_OK)
+    return sim_messagef (SCPE_ARG, "Invalid metrics port: %s\n", cptr);
+if (master == INVALID_SOCKET)
+    return sim_messagef (SCPE_OPENERR, "Can't listen for metrics requests on port: %s\n", cptr);
+sim_metrics_master = master;
+sim_metrics_port = (char *)malloc (strlen (cptr) + 1);
+strcpy (sim_metrics_port, cptr);
+sim_register_internal_device (&sim_metrics_dev);
+sim_metrics_publish ();                                 /* have something to serve right away */
+sim_metrics_running = TRUE;
+if (pthread_create (&sim_metrics_thread, NULL, _metrics_server, NULL)) {
+    sim_metrics_running = FALSE;
+    sim_close_sock (sim_metrics_master);
+    sim_metrics_master = INVALID_SOCKET;
+    free (sim_metrics_port);
+    sim_metrics_port = NULL;
+    return sim_messagef (SCPE_OPENERR, "Can't start the metrics server thread\n");
+    }
+sim_metrics_reset (&sim_metrics_dev);
+return SCPE_OK;
+#else
+if (!flag)
+    return SCPE_OK;
+return sim_messagef (SCPE_NOFNC, "The metrics endpoint requires a simulator built with asynchronous I/O support\n");
+#endif
+}
+
+static void sim_show_rem_metrics (FILE *st)
+{
+if (sim_metrics_port == NULL)
+    return;
+fprintf (st, "Remote Console Metrics endpoint listening on TCP port: %s\n", sim_metrics_port);
+#if defined(SIM_ASYNCH_IO)
+fprintf (st, "Remote Console Metrics: %u snapshots published, %u requests answered\n", sim_metrics_snapshots, sim_metrics_requests);
+#endif
+}
+
 /* Enable or disable Remote Console master mode */
 
 /* In master mode, commands are subsequently processed from the
@@ -2261,6 +3140,7 @@ if (cptr && (*cptr != 0))                               /* now eol? */
     return SCPE_2MARG;
 if (sim_log == NULL)                                    /* no log? */
     return SCPE_OK;
+sim_putchar_flush ();                                   /* log pending output */
 if ((!sim_quiet) && (!(sim_switches & SWMASK ('Q'))))
     fprintf (stdout, "Log file closed\n");
 fprintf (sim_log, "Log file closed\n");
@@ -2318,7 +3198,15 @@ if (sim_switches & SWMASK ('B')) {
 cptr = get_glyph_nc (cptr, gbuf, 0);                    /* get file name */
 if (*cptr != 0)                                         /* now eol? */
     return SCPE_2MARG;
-r = sim_open_logfile (gbuf, FALSE, &sim_deb, &sim_deb_ref);
+if (sim_switches & SWMASK ('Z')) {                      /* binary trace? */
+    if (sim_switches & SWMASK ('B'))
+        return sim_messagef (SCPE_ARG, "A debug trace can't be written to a memory buffer\n");
+    sim_close_logfile (&sim_deb_ref);
+    sim_deb = NULL;
+    r = sim_trace_open (gbuf, &sim_deb, &sim_deb_ref);
+    }
+else
+    r = sim_open_logfile (gbuf, FALSE, &sim_deb, &sim_deb_ref);
 
 if (r != SCPE_OK)
     return r;
@@ -2339,6 +3227,8 @@ if (sim_deb_switches & SWMASK ('R')) {
         sim_deb_switches |= SWMASK ('T');
     }
 sim_messagef (SCPE_OK, "Debug output to \"%s\"\n", sim_logfile_name (sim_deb, sim_deb_ref));
+if (sim_trace_active ())
+    sim_messagef (SCPE_OK, "   Debug messages are recorded as a binary trace (see TRACE DECODE)\n");
 if (sim_deb_switches & SWMASK ('P'))
     sim_messagef (SCPE_OK, "   Debug messages contain current PC value\n");
 if (sim_deb_switches & SWMASK ('T'))
@@ -2414,6 +3304,8 @@ if (cptr && (*cptr != 0))
 if (sim_deb) {
     fprintf (st, "Debug output enabled to \"%s\"\n", 
                  sim_logfile_name (sim_deb, sim_deb_ref));
+    if (sim_trace_active ())
+        fprintf (st, "   Debug messages are recorded as a binary trace (see TRACE DECODE)\n");
     if (sim_deb_switches & SWMASK ('P'))
         fprintf (st, "   Debug messages contain current PC value\n");
     if (sim_deb_switches & SWMASK ('T'))
@@ -2878,6 +3770,8 @@ t_stat sim_poll_kbd (void)
 t_stat c;
 
 sim_last_poll_kbd_time = sim_os_msec ();                    /* record when this poll happened */
+if (sim_con_obuf_cnt)                                       /* make pending output visible */
+    sim_putchar_flush ();
 if (sim_send_poll_data (&sim_con_send, &c))                 /* injected input characters available? */
     return c;
 if (!sim_rem_master_mode) {
@@ -2888,6 +3782,9 @@ if (!sim_rem_master_mode) {
         c = sim_os_poll_kbd ();                             /* get character */
     else
         c = SCPE_OK;
+#if defined(SIM_CON_KBD_THREAD)
+    sim_con_kbd_polled ();                                  /* keyboard wait thread can look again */
+#endif
     if (c == SCPE_STOP) {                                   /* ^E */
         stop_cpu = TRUE;                                    /* Force a stop (which is picked up by sim_process_event */
         return SCPE_OK;
@@ -2918,6 +3815,102 @@ if ((c = (t_stat)tmxr_getc_ln (&sim_con_ldsc))) {           /* any char? */
 return SCPE_OK;
 }
 
+/* Output character to the in-window console */
+
+static t_stat sim_con_putchar (int32 c)
+{
+if ((sim_con_obuf_size == 0) || !sim_is_running) {      /* unbuffered? */
+    sim_putchar_flush ();
+    if (sim_log)                                        /* log file? */
+        fputc (c, sim_log);
+    return sim_os_putchar (c);
+    }
+if (sim_con_obuf == NULL) {
+    sim_con_obuf = (char *)malloc (sim_con_obuf_size);
+    if (sim_con_obuf == NULL) {
+        sim_con_obuf_size = 0;
+        return sim_con_putchar (c);
+        }
+    }
+if (sim_con_obuf_cnt == 0)                              /* first character? */
+    sim_activate_after (&sim_con_out_unit, sim_con_obuf_latency * 1000);
+sim_con_obuf[sim_con_obuf_cnt++] = (char)c;
+if (sim_con_obuf_cnt == sim_con_obuf_size)              /* full? */
+    return sim_putchar_flush ();
+return SCPE_OK;
+}
+
+/* Write buffered console output */
+
+t_stat sim_putchar_flush (void)
+{
+size_t cnt = sim_con_obuf_cnt;
+
+if (cnt == 0)
+    return SCPE_OK;
+sim_con_obuf_cnt = 0;
+sim_cancel (&sim_con_out_unit);
+if (sim_log)                                            /* log file? */
+    fwrite (sim_con_obuf, 1, cnt, sim_log);
+return sim_os_putchars (sim_con_obuf, cnt);
+}
+
+static t_stat sim_con_out_svc (UNIT *uptr)
+{
+sim_putchar_flush ();
+return SCPE_OK;
+}
+
+/* Set/show console output buffering */
+
+t_stat sim_set_cons_obuf (int32 flag, CONST char *cptr)
+{
+uint32 size = 0;
+t_stat r;
+
+if (flag) {
+    if ((cptr == NULL) || (*cptr == 0))
+        size = CON_OBUF_DFLT;
+    else {
+        size = (uint32) get_uint (cptr, 10, CON_OBUF_MAX, &r);
+        if (r != SCPE_OK)
+            return r;
+        }
+    }
+else if (cptr && *cptr)
+    return SCPE_2MARG;
+sim_putchar_flush ();
+free (sim_con_obuf);
+sim_con_obuf = NULL;
+sim_con_obuf_size = size;
+return SCPE_OK;
+}
+
+t_stat sim_set_cons_olatency (int32 flag, CONST char *cptr)
+{
+uint32 latency;
+t_stat r;
+
+if ((cptr == NULL) || (*cptr == 0))
+    return SCPE_2FARG;
+latency = (uint32) get_uint (cptr, 10, CON_OLAT_MAX, &r);
+if (r != SCPE_OK)
+    return r;
+if (latency == 0)
+    return sim_messagef (SCPE_ARG, "Output latency must be at least 1 ms\n");
+sim_con_obuf_latency = latency;
+return SCPE_OK;
+}
+
+t_stat sim_show_cons_obuf (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr)
+{
+if (sim_con_obuf_size)
+    fprintf (st, "Output buffered, %d bytes, %d ms latency\n", (int)sim_con_obuf_size, (int)sim_con_obuf_latency);
+else
+    fprintf (st, "Output unbuffered\n");
+return SCPE_OK;
+}
+
 /* Output character */
 
 t_stat sim_putchar (int32 c)
@@ -2926,10 +3919,8 @@ sim_exp_check (&sim_con_expect, c);
 if ((sim_con_tmxr.master == 0) &&                       /* not Telnet? */
     (sim_con_ldsc.serport == 0)) {                      /* and not serial port */
     ++sim_con_pos;                                      /* bookkeeping */
-    if (sim_log)                                        /* log file? */
-        fputc (c, sim_log);
     sim_debug (DBG_XMT, &sim_con_telnet, "sim_putchar('%c' (0x%02X)\n", sim_isprint (c) ? c : '.', c);
-    return sim_os_putchar (c);                          /* in-window version */
+    return sim_con_putchar (c);                         /* in-window version */
     }
 if (!sim_con_ldsc.conn) {                               /* no Telnet or serial connection? */
     if (!sim_con_ldsc.txbfd)                            /* unbuffered? */
@@ -2951,10 +3942,8 @@ sim_exp_check (&sim_con_expect, c);
 if ((sim_con_tmxr.master == 0) &&                       /* not Telnet? */
     (sim_con_ldsc.serport == 0)) {                      /* and not serial port */
     ++sim_con_pos;                                      /* bookkeeping */
-    if (sim_log)                                        /* log file? */
-        fputc (c, sim_log);
     sim_debug (DBG_XMT, &sim_con_telnet, "sim_putchar('%c' (0x%02X)\n", sim_isprint (c) ? c : '.', c);
-    return sim_os_putchar (c);                          /* in-window version */
+    return sim_con_putchar (c);                         /* in-window version */
     }
 if (!sim_con_ldsc.conn) {                               /* no Telnet or serial connection? */
     if (!sim_con_ldsc.txbfd)                            /* non-buffered Telnet connection? */
@@ -3196,6 +4185,112 @@ return NULL;
 
 #endif /* defined(SIM_ASYNCH_IO) && defined(SIM_ASYNCH_MUX) */
 
+#if defined(SIM_CON_KBD_THREAD)
+/* Keyboard wait thread
+
+   While a simulator is running with asynchronous I/O enabled and an
+   in-window console, this thread waits for host keyboard input and
+   activates the console input polling unit (or the WRU polling unit
+   when the simulator has no console port) as soon as input arrives.
+   Keystrokes and WRU are then seen without waiting for the next
+   periodic poll.  After an activation the thread waits until the
+   keyboard has actually been polled before it looks for more input.
+*/
+
+static pthread_t           sim_con_kbd_thread;
+static pthread_mutex_t     sim_con_kbd_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t      sim_con_kbd_cond = PTHREAD_COND_INITIALIZER;
+static t_bool              sim_con_kbd_started = FALSE; /* thread exists */
+static t_bool              sim_con_kbd_active = FALSE;  /* simulator running, wake on input */
+static t_bool              sim_con_kbd_pending = FALSE; /* activation issued, awaiting poll */
+static t_bool              sim_con_kbd_exit = FALSE;
+static UNIT                *sim_con_kbd_uptr = NULL;
+
+static void *
+_console_kbd_wait (void *arg)
+{
+UNIT *uptr;
+t_bool ready;
+
+sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
+
+sim_debug (DBG_ASY, &sim_con_telnet, "_console_kbd_wait() - starting\n");
+
+pthread_mutex_lock (&sim_con_kbd_lock);
+while (!sim_con_kbd_exit) {
+    if (!sim_con_kbd_active || sim_con_kbd_pending) {
+        pthread_cond_wait (&sim_con_kbd_cond, &sim_con_kbd_lock);
+        continue;
+        }
+    pthread_mutex_unlock (&sim_con_kbd_lock);
+    ready = sim_os_poll_kbd_ready (100);
+    pthread_mutex_lock (&sim_con_kbd_lock);
+    if (!ready || !sim_con_kbd_active || sim_con_kbd_exit)
+        continue;
+    sim_con_kbd_pending = TRUE;
+    uptr = sim_con_kbd_uptr;
+    pthread_mutex_unlock (&sim_con_kbd_lock);
+    sim_debug (DBG_ASY, &sim_con_telnet, "_console_kbd_wait() - Keyboard Data available, activating %s\n", sim_uname (uptr));
+    sim_activate_abs (uptr, 0);
+    pthread_mutex_lock (&sim_con_kbd_lock);
+    }
+pthread_mutex_unlock (&sim_con_kbd_lock);
+
+sim_debug (DBG_ASY, &sim_con_telnet, "_console_kbd_wait() - exiting\n");
+
+return NULL;
+}
+
+static void sim_con_kbd_run (t_bool running)
+{
+UNIT *uptr = NULL;
+
+if (running &&
+    sim_asynch_enabled &&
+    sim_ttisatty () &&
+    (!sim_rem_master_mode) &&
+    (sim_con_tmxr.master == 0) &&                       /* not Telnet? */
+    (sim_con_ldsc.serport == 0))                        /* and not serial? */
+    uptr = sim_con_console_port ? sim_con_ldsc.uptr : &sim_con_units[0];
+pthread_mutex_lock (&sim_con_kbd_lock);
+if ((uptr != NULL) && (!sim_con_kbd_started)) {
+    pthread_attr_t attr;
+
+    pthread_attr_init (&attr);
+    pthread_attr_setscope (&attr, PTHREAD_SCOPE_SYSTEM);
+    sim_con_kbd_started = (0 == pthread_create (&sim_con_kbd_thread, &attr, _console_kbd_wait, NULL));
+    pthread_attr_destroy (&attr);
+    }
+sim_con_kbd_uptr = uptr;
+sim_con_kbd_active = (uptr != NULL) && sim_con_kbd_started;
+sim_con_kbd_pending = FALSE;
+pthread_cond_signal (&sim_con_kbd_cond);
+pthread_mutex_unlock (&sim_con_kbd_lock);
+}
+
+static void sim_con_kbd_polled (void)
+{
+if (!sim_con_kbd_pending)
+    return;
+pthread_mutex_lock (&sim_con_kbd_lock);
+sim_con_kbd_pending = FALSE;
+pthread_cond_signal (&sim_con_kbd_cond);
+pthread_mutex_unlock (&sim_con_kbd_lock);
+}
+
+static void sim_con_kbd_shutdown (void)
+{
+pthread_mutex_lock (&sim_con_kbd_lock);
+sim_con_kbd_active = FALSE;
+sim_con_kbd_exit = TRUE;
+pthread_cond_signal (&sim_con_kbd_cond);
+pthread_mutex_unlock (&sim_con_kbd_lock);
+if (sim_con_kbd_started)
+    pthread_join (sim_con_kbd_thread, NULL);
+sim_con_kbd_started = FALSE;
+}
+#endif /* defined(SIM_CON_KBD_THREAD) */
+
 
 t_stat sim_ttinit (void)
 {
@@ -3236,11 +4331,15 @@ if (sim_asynch_enabled) {
 pthread_mutex_unlock (&sim_tmxr_poll_lock);
 #endif
 tmxr_start_poll ();
+#if defined(SIM_CON_KBD_THREAD)
+sim_con_kbd_run (TRUE);
+#endif
 return sim_os_ttrun ();
 }
 
 t_stat sim_ttcmd (void)
 {
+sim_putchar_flush ();                                   /* write pending output */
 #if defined(SIM_ASYNCH_IO) && defined(SIM_ASYNCH_MUX)
 pthread_mutex_lock (&sim_tmxr_poll_lock);
 if (sim_console_poll_running) {
@@ -3252,14 +4351,24 @@ if (sim_console_poll_running) {
 else
     pthread_mutex_unlock (&sim_tmxr_poll_lock);
 #endif
+#if defined(SIM_CON_KBD_THREAD)
+sim_con_kbd_run (FALSE);
+#endif
 tmxr_stop_poll ();
 return sim_os_ttcmd ();
 }
 
 t_stat sim_ttclose (void)
 {
-t_stat r1 = tmxr_shutdown ();
-t_stat r2 = sim_os_ttclose ();
+t_stat r1, r2;
+
+sim_set_rem_metrics (0, NULL);                          /* stop any metrics server */
+sim_putchar_flush ();                                   /* write pending output */
+#if defined(SIM_CON_KBD_THREAD)
+sim_con_kbd_shutdown ();
+#endif
+r1 = tmxr_shutdown ();
+r2 = sim_os_ttclose ();
 
 if (r1 != SCPE_OK)
     return r1;
@@ -3456,6 +4565,24 @@ if ((status != SS$_NORMAL) || (iosb.status != SS$_NORMAL))
 return SCPE_OK;
 }
 
+static t_stat sim_os_putchars (const char *buf, size_t len)
+{
+unsigned int status;
+IOSB iosb;
+size_t cnt;
+
+while (len > 0) {
+    cnt = (len > 32767) ? 32767 : len;
+    status = sys$qiow (EFN, tty_chan, IO$_WRITELBLK | IO$M_NOFORMAT,
+        &iosb, 0, 0, buf, cnt, 0, 0, 0, 0);
+    if ((status != SS$_NORMAL) || (iosb.status != SS$_NORMAL))
+        return SCPE_TTOERR;
+    buf += cnt;
+    len -= cnt;
+    }
+return SCPE_OK;
+}
+
 /* Win32 routines */
 
 #elif defined (_WIN32)
@@ -3726,6 +4853,13 @@ if (c != 0177) {
 return SCPE_OK;
 }
 
+static t_stat sim_os_putchars (const char *buf, size_t len)
+{
+while (len--)
+    sim_os_putchar (*buf++ & 0377);
+return SCPE_OK;
+}
+
 /* OS/2 routines, from Bruce Ray and Holger Veit */
 
 #elif defined (__OS2__)
@@ -3809,6 +4943,13 @@ if (c != 0177) {
 return SCPE_OK;
 }
 
+static t_stat sim_os_putchars (const char *buf, size_t len)
+{
+while (len--)
+    sim_os_putchar (*buf++ & 0377);
+return SCPE_OK;
+}
+
 /* Metrowerks CodeWarrior Macintosh routines, from Louis Chretien and
    Peter Schorn */
 
@@ -4002,6 +5143,13 @@ if (c != 0177) {
 return SCPE_OK;
 }
 
+static t_stat sim_os_putchars (const char *buf, size_t len)
+{
+while (len--)
+    sim_os_putchar (*buf++ & 0377);
+return SCPE_OK;
+}
+
 /* BSD UNIX routines */
 
 #elif defined (BSDTTY)
@@ -4154,6 +5302,26 @@ write (1, &c, 1);
 return SCPE_OK;
 }
 
+static t_stat sim_os_putchars (const char *buf, size_t len)
+{
+ssize_t written;
+
+while (len > 0) {
+    written = write (1, buf, len);
+    if (written < 0) {
+        if ((errno == EINTR) || (errno == EAGAIN)) {
+            if (errno == EAGAIN)                        /* non blocking output full? */
+                sim_os_ms_sleep (1);                    /* wait a bit to retry */
+            continue;
+            }
+        return SCPE_TTOERR;
+        }
+    buf += written;
+    len -= (size_t)written;
+    }
+return SCPE_OK;
+}
+
 /* POSIX UNIX routines, from Leendert Van Doorn */
 
 #else
@@ -4328,6 +5496,26 @@ if (write (1, &c, 1)) {};
 return SCPE_OK;
 }
 
+static t_stat sim_os_putchars (const char *buf, size_t len)
+{
+ssize_t written;
+
+while (len > 0) {
+    written = write (1, buf, len);
+    if (written < 0) {
+        if ((errno == EINTR) || (errno == EAGAIN)) {
+            if (errno == EAGAIN)                        /* non blocking output full? */
+                sim_os_ms_sleep (1);                    /* wait a bit to retry */
+            continue;
+            }
+        return SCPE_TTOERR;
+        }
+    buf += written;
+    len -= (size_t)written;
+    }
+return SCPE_OK;
+}
+
 #endif
 
 /* Decode a string.
@@ -452,6 +452,14 @@ typedef uint32          t_addr;
 
 #define MATCH_CMD(ptr,cmd) ((NULL == (ptr)) || (!*(ptr)) || strncasecmp ((ptr), (cmd), strlen (ptr)))
 
+/* Branch hint for tests in hot loops which are almost always false */
+
+#if defined (__GNUC__)
+#define SIM_UNLIKELY(x) __builtin_expect (!!(x), 0)
+#else
+#define SIM_UNLIKELY(x) (x)
+#endif
+
 /* End of Linked List/Queue value                           */
 /* Chosen for 2 reasons:                                    */
 /*     1 - to not be NULL, this allowing the NULL value to  */
@@ -460,6 +468,9 @@ typedef uint32          t_addr;
 /*     2 - to not be a valid/possible pointer (alignment)   */
 #define QUEUE_LIST_END ((UNIT *)1)
 
+/* Event queue skip list index depth (including the base list) */
+#define SIM_QUEUE_LEVELS 8
+
 /* Typedefs for principal structures */
 
 typedef struct DEVICE DEVICE;
@@ -479,6 +490,7 @@ typedef struct DEBTAB DEBTAB;
 typedef struct FILEREF FILEREF;
 typedef struct MEMFILE MEMFILE;
 typedef struct BITFIELD BITFIELD;
+typedef struct BENCHTAB BENCHTAB;
 
 typedef t_stat (*ACTIVATE_API)(UNIT *unit, int32 interval);
 
@@ -522,6 +534,8 @@ struct DEVICE {
     const char          *(*description)(DEVICE *dptr);  /* Device Description */
     BRKTYPTAB           *brk_types;                     /* Breakpoint types */
     void                *type_ctx;                      /* Device Type/Library Context */
+    t_uint64            perf_events;                    /* events dispatched (maintained by SCP) */
+    t_uint64            perf_nsec;                      /* host time in their service routines */
     };
 
 /* Device flags */
@@ -600,6 +614,7 @@ struct UNIT {
     uint16              us10;                           /* device specific */
     uint32              disk_type;                      /* Disk specific info */
     void                *tmxr;                          /* TMXR linkage */
+    void                *spool;                         /* spooled output (sim_spool) */
     uint32              recsize;                        /* Tape specific info */
     t_addr              tape_eom;                       /* Tape specific info */
     t_bool              (*cancel)(UNIT *);
@@ -607,6 +622,12 @@ struct UNIT {
     char                *uname;                         /* Unit name */
     DEVICE              *dptr;                          /* DEVICE linkage (backpointer) */
     uint32              dctrl;                          /* debug control */
+    /* Event queue index (maintained by scp.c) */
+    double              q_key;                          /* event queue order key */
+    UNIT                *q_prev;                        /* previous active */
+    UNIT                *q_fwd[SIM_QUEUE_LEVELS-1];     /* skip list forward links */
+    UNIT                *q_bwd[SIM_QUEUE_LEVELS-1];     /* skip list backward links */
+    uint32              q_level;                        /* skip list level (0 if not queued) */
 #ifdef SIM_ASYNCH_IO
     void                (*a_check_completion)(UNIT *);
     t_bool              (*a_is_active)(UNIT *);
@@ -662,6 +683,8 @@ struct UNIT {
 #define UNIT_TM_POLL        0000002         /* TMXR Polling unit */
 #define UNIT_NO_FIO         0000004         /* fileref is NOT a FILE * */
 #define UNIT_DISK_CHK       0000010         /* disk data debug checking (sim_disk) */
+#define UNIT_SYNC_FLUSH     0000020         /* io_flush may be called while running */
+#define UNIT_POLL_GROUP     0000040         /* Unit polled via the poll group (sim_timer) */
 #define UNIT_TMR_UNIT       0000200         /* Unit registered as a calibrated timer */
 #define UNIT_TAPE_MRK       0000400         /* Tape Unit Tapemark */
 #define UNIT_TAPE_PNU       0001000         /* Tape Unit Position Not Updated */
@@ -750,6 +773,16 @@ struct SHTAB {
     const char          *help;                          /* help string */
     };
 
+/* Benchmark workload table - the commands are EXAMINE/DEPOSIT command
+   strings which load the workload (usually an endless loop) into memory
+   and set the PC at its start */
+
+struct BENCHTAB {
+    const char          *name;                          /* name */
+    const char          *desc;                          /* description */
+    const char          **commands;                     /* deposit commands */
+    };
+
 /* Modifier table - only extended entries have disp, reg, or flags */
 
 struct MTAB {
@@ -832,9 +865,12 @@ struct EXPTAB {
 #define EXP_TYP_TIME            (SWMASK ('T'))      /* halt delay is in microseconds instead of instructions */
 #if defined(USE_REGEX)
     pcre                *regex;                         /* compiled regular expression */
+    pcre_extra          *regex_extra;                   /* studied regular expression data */
     int                 re_nsub;                        /* regular expression sub expression count */
+    int                 *re_ovector;                    /* match offsets vector (3 * (re_nsub + 1)) */
 #endif
     char                *act;                           /* action string */
+    uint32              hits;                           /* times this rule has matched */
     };
 
 /* Expect Context */
@@ -848,6 +884,13 @@ struct EXPECT {
     uint32              buf_ins;                        /* buffer insertion point for the next output data */
     uint32              buf_size;                       /* buffer size */
     uint32              buf_data;                       /* count of data in buffer */
+    int32               *ac_goto;                       /* match automaton transitions (ac_nodes x ac_classes) */
+    int32               *ac_match;                      /* lowest rule index matched at each automaton state, -1 if none */
+    int32               ac_nodes;                       /* automaton state count (0 means needs building) */
+    int32               ac_classes;                     /* automaton input character class count */
+    int32               ac_state;                       /* current automaton state */
+    uint16              ac_class[256];                  /* input character to character class map */
+    int32               regex_rules;                    /* count of regular expression rules */
     };
 
 /* Send Context */
@@ -1202,6 +1245,10 @@ extern int32 sim_asynch_inst_latency;
 #if defined(_WIN32) || defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4) || defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8)
 #define USE_AIO_INTRINSICS 1
 #endif
+#if !defined(USE_AIO_INTRINSICS) && (__STDC_VERSION__ >= 201112) && !defined(__STDC_NO_ATOMICS__)
+#define USE_AIO_INTRINSICS 1
+#define USE_AIO_C11_ATOMICS 1
+#endif
 /* Provide a way to test both Intrinsic and Lock based queue manipulations  */
 /* when both are available on a particular platform                         */
 #if defined(DONT_USE_AIO_INTRINSICS) && defined(USE_AIO_INTRINSICS)
@@ -1211,6 +1258,11 @@ extern int32 sim_asynch_inst_latency;
 /* This approach uses intrinsics to manage access to the link list head     */
 /* sim_asynch_queue.  This implementation is a completely lock free design  */
 /* which avoids the potential ABA issues.                                   */
+/* Each unit is claimed (a_next NULL -> non NULL) before it is pushed, so   */
+/* the queue can never hold more entries than there are units and the      */
+/* consumer drains everything present with a single exchange.  Only the     */
+/* producer which finds the queue empty rings the doorbell (signals         */
+/* sim_asynch_wake), so bursts of completions cost one wakeup.              */
 #define AIO_QUEUE_MODE "Lock free asynchronous event queue"
 #define AIO_INIT                                                  \
     do {                                                          \
@@ -1234,13 +1286,25 @@ extern int32 sim_asynch_inst_latency;
 #define InterlockedCompareExchangePointer(Destination, Exchange, Comparand) __sync_val_compare_and_swap(Destination, Comparand, Exchange)
 #elif defined(__DECC_VER)
 #define InterlockedCompareExchangePointer(Destination, Exchange, Comparand) (void *)((int32)_InterlockedCompareExchange64(Destination, Exchange, Comparand))
+#elif defined(USE_AIO_C11_ATOMICS)
+#include <stdatomic.h>
+static inline void *_sim_aio_cas_ptr (void * volatile *Destination, void *Exchange, void *Comparand)
+{
+atomic_compare_exchange_strong ((_Atomic(void *) *)Destination, &Comparand, Exchange);
+return Comparand;
+}
+#define InterlockedCompareExchangePointer(Destination, Exchange, Comparand) _sim_aio_cas_ptr((void * volatile *)(Destination), (void *)(Exchange), (void *)(Comparand))
 #else
 #error "Implementation of function InterlockedCompareExchangePointer() is needed to build with USE_AIO_INTRINSICS"
 #endif
-#define AIO_ILOCK AIO_LOCK
-#define AIO_IUNLOCK AIO_UNLOCK
+#define AIO_ILOCK
+#define AIO_IUNLOCK
 #define AIO_QUEUE_VAL (UNIT *)(InterlockedCompareExchangePointer((void * volatile *)&sim_asynch_queue, (void *)sim_asynch_queue, NULL))
 #define AIO_QUEUE_SET(newval, oldval) (UNIT *)(InterlockedCompareExchangePointer((void * volatile *)&sim_asynch_queue, (void *)newval, oldval))
+/* Claim a unit for queueing, TRUE if it was not already queued */
+#define AIO_UNIT_CLAIM(uptr) (NULL == InterlockedCompareExchangePointer((void * volatile *)&(uptr)->a_next, (void *)QUEUE_LIST_END, NULL))
+/* Release a dequeued unit (a_next is only changed by its owner once set) */
+#define AIO_UNIT_RELEASE(uptr) (void)InterlockedCompareExchangePointer((void * volatile *)&(uptr)->a_next, NULL, (void *)(uptr)->a_next)
 #define AIO_UPDATE_QUEUE sim_aio_update_queue ()
 #define AIO_ACTIVATE(caller, uptr, event_time)                                   \
     if (!pthread_equal ( pthread_self(), sim_asynch_main_threadid )) {           \
@@ -1292,7 +1356,8 @@ extern int32 sim_asynch_inst_latency;
         uptr->a_activate_call = (ACTIVATE_API)&caller;                 \
         sim_asynch_queue = uptr;                                       \
       }                                                                \
-      if (sim_idle_wait) {                                             \
+      if (sim_idle_wait &&                      /* first pending? */   \
+          (uptr->a_next == QUEUE_LIST_END)) {                          \
         if (sim_deb) {  /* only while debug do lock/unlock overhead */ \
           AIO_UNLOCK;                                                  \
           sim_debug (TIMER_DBG_IDLE, &sim_timer_dev, "waking due to event on %s after %d instructions\n", sim_uname(uptr), event_time);\
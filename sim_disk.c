@@ -53,6 +53,9 @@ Public routines:
    sim_disk_set_async        enable asynchronous operation
    sim_disk_clr_async        disable asynchronous operation
    sim_disk_data_trace       debug support
+   sim_disk_set_cache        configure the shared sector cache
+   sim_disk_show_cache       show the shared sector cache
+   sim_disk_cache_stats      sector cache statistics for a unit
    sim_disk_test             unit test routine
 
 Internal routines:
@@ -87,6 +90,38 @@ Internal routines:
 #include <pthread.h>
 #endif
 
+#if defined (_WIN32)
+#include <io.h>
+#define _disk_fsync(fd)     _commit (fd)
+#define _disk_dup(fd)       _dup (fd)
+#define _disk_close(fd)     _close (fd)
+#define _disk_fileno(f)     _fileno (f)
+#else
+#include <unistd.h>
+#define _disk_fsync(fd)     fsync (fd)
+#define _disk_dup(fd)       dup (fd)
+#define _disk_close(fd)     close (fd)
+#define _disk_fileno(f)     fileno (f)
+#endif
+
+#if defined (__linux) || defined (__linux__)
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#define SIM_DISK_PIO 1          /* positional (pread/pwrite) container file I/O */
+#endif
+#if defined (__linux) || defined (__linux__) || defined (__APPLE__) || \
+    defined (__FreeBSD__) || defined (__NetBSD__) || defined (__OpenBSD__)
+#include <sys/mman.h>
+#define SIM_DISK_MMAP 1         /* memory mapped SIMH container support (ATTACH -P) */
+#endif
+#if defined (HAVE_ZLIB) &&                                                        \
+    (defined (__GLIBC__) || defined (__APPLE__) ||                                \
+     defined (__FreeBSD__) || defined (__NetBSD__) || defined (__OpenBSD__))
+#define SIM_DISK_SIMHZ 1        /* SIMHZ compressed containers are supported */
+#include <zlib.h>
+#endif
+
 /* Newly created SIMH (and possibly RAW) disk containers       */
 /* will have this data as the last 512 bytes of the container  */
 /* It will not be considered part of the data in the container */
@@ -103,7 +138,8 @@ struct simh_disk_footer {
     uint8       FooterVersion;          /* Initially 0 */
 #define FOOTER_VERSION  0
     uint8       AccessFormat;           /* 1 - SIMH, 2 - RAW */
-    uint8       Reserved[354];          /* Currently unused */
+    uint8       ProbeCache[32];         /* Cached file system probe result (see get_filesystem_size) */
+    uint8       Reserved[322];          /* Currently unused */
     uint8       DeviceName[16];         /* Name of the Device when created */
     uint32      Highwater[2];           /* Size before footer addition or furthest container point written */
     uint32      Unused;                 /* Currently unused */
@@ -165,8 +201,28 @@ struct disk_context {
     uint32              auto_format;        /* Format determined dynamically */
     uint32              read_count;         /* Number of read operations performed */
     uint32              write_count;        /* Number of write operations performed */
+    t_uint64            read_bytes;         /* Bytes read */
+    t_uint64            write_bytes;        /* Bytes written */
+    SIM_LATENCY         read_host;          /* Host time of each read */
+    SIM_LATENCY         write_host;         /* Host time of each write */
+    SIM_LATENCY         queued;             /* Asynch requests' wait for an I/O worker */
+    t_bool              probe_valid;        /* File system probe result is known */
+    uint32              probe_writes;       /* write_count when it was determined */
+    int32               probe_check;        /* Matching file system check (-1 for none) */
+    uint32              probe_sector_size;  /* Sector size it matched with (0 if the unit's) */
+    t_offset            probe_size;         /* File system size (or -1) */
     struct simh_disk_footer
                         *footer;
+    uint8               *map;               /* Memory mapped container data (ATTACH -P) */
+    t_offset            map_size;           /* Size of mapped region */
+    struct disk_overlay *overlay;           /* Copy-on-write overlay (ATTACH -S) */
+    struct disk_cache_file
+                        *cache_file;        /* Shared sector cache file (or NULL) */
+    t_uint64            cache_hits;         /* Sectors read from the cache */
+    t_uint64            cache_misses;       /* Sectors read from the container */
+    uint32              cache_dirty;        /* Modified sectors in the cache for this unit */
+    t_seccnt            track_sects;        /* Sectors read together on a cache miss (0 for none) */
+    uint32              sync_writes;        /* write_count at the last commit (SET DISK SYNC) */
 #if defined _WIN32
     HANDLE              disk_handle;        /* OS specific Raw device handle */
 #endif
@@ -174,12 +230,11 @@ struct disk_context {
     int                 asynch_io;          /* Asynchronous Interrupt scheduling enabled */
     int                 asynch_io_latency;  /* instructions to delay pending interrupt */
     pthread_mutex_t     lock;
-    pthread_t           io_thread;          /* I/O Thread Id */
+    SIM_IO_REQ          io_req;             /* Shared I/O worker pool request */
     pthread_mutex_t     io_lock;
-    pthread_cond_t      io_cond;
     pthread_cond_t      io_done;
-    pthread_cond_t      startup_cond;
     int                 io_dop;
+    t_uint64            io_submit_nsec;     /* host time the pending operation was queued */
     uint8               *buf;
     t_seccnt            *rsects;
     t_seccnt            sects;
@@ -216,7 +271,8 @@ if ((!callback) || !ctx->asynch_io)
         ctx->sects = _sects;                                    \
         ctx->rsects = _rsects;                                  \
         ctx->callback = _callback;                              \
-        pthread_cond_signal (&ctx->io_cond);                    \
+        ctx->io_submit_nsec = sim_host_nsec ();                 \
+        sim_io_pool_submit (&ctx->io_req);                      \
         pthread_mutex_unlock (&ctx->io_lock);                   \
         }                                                       \
     else                                                        \
@@ -229,47 +285,33 @@ if ((!callback) || !ctx->asynch_io)
 #define DOP_WSEC  2             /* sim_disk_wrsect_a */
 #define DOP_IAVL  3             /* sim_disk_isavailable_a */
 
-static void *
-_disk_io(void *arg)
+/* Perform the pending operation for a unit.  This runs on one of the
+   shared I/O pool worker threads (see sim_io_pool_submit in sim_fio.c). */
+
+static void
+_disk_io (UNIT *uptr)
 {
-UNIT* volatile uptr = (UNIT*)arg;
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
-/* Boost Priority for this I/O thread vs the CPU instruction execution
-   thread which in general won't be readily yielding the processor when
-   this thread needs to run */
-sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
-
-sim_debug_unit (ctx->dbit, uptr, "_disk_io(unit=%d) starting\n", (int)(uptr - ctx->dptr->units));
+sim_debug_unit (ctx->dbit, uptr, "_disk_io(unit=%d, dop=%d)\n", (int)(uptr - ctx->dptr->units), ctx->io_dop);
 
-pthread_mutex_lock (&ctx->io_lock);
-pthread_cond_signal (&ctx->startup_cond);   /* Signal we're ready to go */
-while (ctx->asynch_io) {
-    pthread_cond_wait (&ctx->io_cond, &ctx->io_lock);
-    if (ctx->io_dop == DOP_DONE)
+sim_latency_record (&ctx->queued, sim_host_nsec () - ctx->io_submit_nsec);
+switch (ctx->io_dop) {
+    case DOP_RSEC:
+        ctx->io_status = sim_disk_rdsect (uptr, ctx->lba, ctx->buf, ctx->rsects, ctx->sects);
+        break;
+    case DOP_WSEC:
+        ctx->io_status = sim_disk_wrsect (uptr, ctx->lba, ctx->buf, ctx->rsects, ctx->sects);
+        break;
+    case DOP_IAVL:
+        ctx->io_status = sim_disk_isavailable (uptr);
         break;
-    pthread_mutex_unlock (&ctx->io_lock);
-    switch (ctx->io_dop) {
-        case DOP_RSEC:
-            ctx->io_status = sim_disk_rdsect (uptr, ctx->lba, ctx->buf, ctx->rsects, ctx->sects);
-            break;
-        case DOP_WSEC:
-            ctx->io_status = sim_disk_wrsect (uptr, ctx->lba, ctx->buf, ctx->rsects, ctx->sects);
-            break;
-        case DOP_IAVL:
-            ctx->io_status = sim_disk_isavailable (uptr);
-            break;
-        }
-    pthread_mutex_lock (&ctx->io_lock);
-    ctx->io_dop = DOP_DONE;
-    pthread_cond_signal (&ctx->io_done);
-    sim_activate (uptr, ctx->asynch_io_latency);
     }
+pthread_mutex_lock (&ctx->io_lock);
+ctx->io_dop = DOP_DONE;
+pthread_cond_signal (&ctx->io_done);
+sim_activate (uptr, ctx->asynch_io_latency);
 pthread_mutex_unlock (&ctx->io_lock);
-
-sim_debug_unit (ctx->dbit, uptr, "_disk_io(unit=%d) exiting\n", (int)(uptr - ctx->dptr->units));
-
-return NULL;
 }
 
 /* This routine is called in the context of the main simulator thread before
@@ -341,12 +383,16 @@ static FILE *sim_vhd_disk_create_diff (const char *szVHDPath, const char *szPare
 static FILE *sim_vhd_disk_merge (const char *szVHDPath, char **ParentVHD);
 static int sim_vhd_disk_close (FILE *f);
 static void sim_vhd_disk_flush (FILE *f);
+static FILE *sim_vhd_disk_file (FILE *f);
 static t_offset sim_vhd_disk_size (FILE *f);
 static t_stat sim_vhd_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects);
 static t_stat sim_vhd_disk_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects);
 static t_stat sim_vhd_disk_clearerr (UNIT *uptr);
 static t_stat sim_vhd_disk_set_dtype (FILE *f, const char *dtype, uint32 SectorSize, uint32 xfer_element_size);
 static const char *sim_vhd_disk_get_dtype (FILE *f, uint32 *SectorSize, uint32 *xfer_element_size, char sim_name[64], time_t *creation_time);
+static t_stat sim_vhd_disk_set_probe (FILE *f, const uint8 probe[32]);
+static const uint8 *sim_vhd_disk_get_probe (FILE *f);
+static t_stat sim_disk_simhz_implemented (void);
 static t_stat sim_os_disk_implemented_raw (void);
 static FILE *sim_os_disk_open_raw (const char *rawdevicename, const char *openmode);
 static int sim_os_disk_close_raw (FILE *f);
@@ -375,6 +421,7 @@ static struct sim_disk_fmt fmts[] = {
     { "SIMH",        0, DKUF_F_STD,  NULL},
     { "RAW",         0, DKUF_F_RAW,  sim_os_disk_implemented_raw},
     { "VHD",         0, DKUF_F_VHD,  sim_vhd_disk_implemented},
+    { "SIMHZ",       0, DKUF_F_SIMHZ, sim_disk_simhz_implemented},
     { NULL,          0, 0,           NULL}
     };
 
@@ -472,6 +519,7 @@ if (!(uptr->flags & UNIT_ATT))                          /* attached? */
 ctx = (struct disk_context *)uptr->disk_ctx;
 switch (DK_GET_FMT (uptr)) {                            /* case on format */
     case DKUF_F_STD:                                    /* SIMH format */
+    case DKUF_F_SIMHZ:                                  /* SIMHZ format */
         is_available = TRUE;
         break;
     case DKUF_F_VHD:                                    /* VHD format */
@@ -584,7 +632,6 @@ sim_printf ("%s", msg);
 return SCPE_NOFNC;
 #else
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-pthread_attr_t attr;
 
 sim_debug_unit (ctx->dbit, uptr, "sim_disk_set_async(unit=%d)\n", (int)(uptr - ctx->dptr->units));
 
@@ -592,17 +639,8 @@ ctx->asynch_io = sim_asynch_enabled;
 ctx->asynch_io_latency = latency;
 if (ctx->asynch_io) {
     pthread_mutex_init (&ctx->io_lock, NULL);
-    pthread_cond_init (&ctx->io_cond, NULL);
     pthread_cond_init (&ctx->io_done, NULL);
-    pthread_cond_init (&ctx->startup_cond, NULL);
-    pthread_attr_init(&attr);
-    pthread_attr_setscope(&attr, PTHREAD_SCOPE_SYSTEM);
-    pthread_mutex_lock (&ctx->io_lock);
-    pthread_create (&ctx->io_thread, &attr, _disk_io, (void *)uptr);
-    pthread_attr_destroy(&attr);
-    pthread_cond_wait (&ctx->startup_cond, &ctx->io_lock); /* Wait for thread to stabilize */
-    pthread_mutex_unlock (&ctx->io_lock);
-    pthread_cond_destroy (&ctx->startup_cond);
+    sim_io_pool_register (&ctx->io_req, uptr, _disk_io);
     }
 uptr->a_check_completion = _disk_completion_dispatch;
 uptr->a_is_active = _disk_is_active;
@@ -625,127 +663,2399 @@ if (!ctx) return SCPE_UNATT;
 
 sim_debug_unit (ctx->dbit, uptr, "sim_disk_clr_async(unit=%d)\n", (int)(uptr - ctx->dptr->units));
 
-if (ctx->asynch_io) {
-    pthread_mutex_lock (&ctx->io_lock);
-    ctx->asynch_io = 0;
-    pthread_cond_signal (&ctx->io_cond);
-    pthread_mutex_unlock (&ctx->io_lock);
-    pthread_join (ctx->io_thread, NULL);
-    pthread_mutex_destroy (&ctx->io_lock);
-    pthread_cond_destroy (&ctx->io_cond);
-    pthread_cond_destroy (&ctx->io_done);
+if (ctx->asynch_io) {
+    pthread_mutex_lock (&ctx->io_lock);
+    while (ctx->io_dop != DOP_DONE)                     /* let any pending op finish */
+        pthread_cond_wait (&ctx->io_done, &ctx->io_lock);
+    ctx->asynch_io = 0;
+    pthread_mutex_unlock (&ctx->io_lock);
+    sim_io_pool_unregister (&ctx->io_req);
+    pthread_mutex_destroy (&ctx->io_lock);
+    pthread_cond_destroy (&ctx->io_done);
+    }
+return SCPE_OK;
+#endif
+}
+
+#if defined (SIM_DISK_PIO)
+/* Positional container file I/O
+
+   Where available, SIMH and VHD container data is transferred with
+   pread/pwrite on the stream's file descriptor rather than an fseek
+   followed by an fread/fwrite.  This avoids the seek system call and
+   the copy through the stdio buffer on every transfer, and since it
+   doesn't depend on the shared file position, transfers on different
+   units (or pool threads) never serialize on stream state.  Any data
+   stdio may still hold for the stream (for instance from reading or
+   writing the metadata at attach time) is flushed first so the two
+   views of the file stay coherent.
+*/
+
+static size_t _sim_disk_pio (FILE *f, void *buf, size_t bytes, t_offset addr, t_bool wr, t_bool *err)
+{
+int fd = fileno (f);
+size_t done = 0;
+
+*err = (fflush (f) != 0);
+while (!*err && (done < bytes)) {
+    ssize_t n = wr ? pwrite (fd, (uint8 *)buf + done, bytes - done, (off_t)(addr + done))
+                   : pread (fd, (uint8 *)buf + done, bytes - done, (off_t)(addr + done));
+
+    if (n < 0) {
+        if (errno == EINTR)
+            continue;
+        *err = TRUE;
+        break;
+        }
+    if (n == 0)                                         /* EOF */
+        break;
+    done += (size_t)n;
+    }
+return done;
+}
+#endif
+
+/* Host storage discard
+
+   Zeros written to a SIMH or VHD container (including those written by
+   an MSCP erase, a SCSI UNMAP or sim_disk_erase) are not stored.  The
+   range is instead released back to the host file system as a hole,
+   with fallocate(FALLOC_FL_PUNCH_HOLE) on Linux or FSCTL_SET_ZERO_DATA
+   on a sparse file on Windows, so that it no longer occupies space on
+   thin provisioned storage and reads back as zeros.  Where the host
+   can't do this the zeros are written as usual.  SET DISK NODISCARD
+   turns this off.
+*/
+
+static t_bool sim_disk_discard_zeros = TRUE;            /* SET DISK DISCARD/NODISCARD */
+
+static t_bool _sim_disk_is_zero (const uint8 *buf, size_t bytes)
+{
+return (bytes == 0) || ((buf[0] == 0) && (memcmp (buf, buf + 1, bytes - 1) == 0));
+}
+
+static t_bool _sim_disk_punch (FILE *f, t_offset addr, t_offset bytes)
+{
+if (!sim_disk_discard_zeros || (bytes == 0) || (fflush (f) != 0))
+    return FALSE;
+#if (defined (__linux) || defined (__linux__)) && defined (FALLOC_FL_PUNCH_HOLE)
+return (fallocate (fileno (f), FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, (off_t)addr, (off_t)bytes) == 0);
+#elif defined (_WIN32) && defined (FSCTL_SET_ZERO_DATA)
+if (1) {
+    HANDLE h = (HANDLE)_get_osfhandle (_fileno (f));
+    FILE_ZERO_DATA_INFORMATION zero;
+    DWORD ret;
+
+    if (h == INVALID_HANDLE_VALUE)
+        return FALSE;
+    DeviceIoControl (h, FSCTL_SET_SPARSE, NULL, 0, NULL, 0, &ret, NULL);
+    zero.FileOffset.QuadPart = addr;
+    zero.BeyondFinalZero.QuadPart = addr + bytes;
+    return DeviceIoControl (h, FSCTL_SET_ZERO_DATA, &zero, sizeof (zero), NULL, 0, &ret, NULL) != 0;
+    }
+#else
+return FALSE;
+#endif
+}
+
+/* Offset of the first byte at or after addr which may hold data, or -1
+   when everything from addr to the end of the file is a hole.  Hosts
+   which can't tell return addr.  The descriptor's offset is restored
+   so that the stream's idea of its position stays valid. */
+static t_offset _sim_disk_next_data (FILE *f, t_offset addr)
+{
+#if defined (SEEK_DATA) && !defined (_WIN32)
+int fd = fileno (f);
+off_t pos = lseek (fd, (off_t)0, SEEK_CUR);
+off_t data;
+int last_errno;
+
+if (pos == (off_t)-1)
+    return addr;
+data = lseek (fd, (off_t)addr, SEEK_DATA);
+last_errno = errno;
+(void)lseek (fd, pos, SEEK_SET);
+if (data != (off_t)-1)
+    return (t_offset)data;
+if (last_errno == ENXIO)                                /* only holes to end of file */
+    return (t_offset)-1;
+#endif
+return addr;
+}
+
+/* Memory mapped container transfers (ATTACH -P)
+
+   A fully populated SIMH format or RAW (regular file) container can be
+   mapped into the simulator's address space at attach time.  Sector
+   reads and writes are then simple copies to or from the mapping (with
+   byte swapping on writes from big endian hosts, reads are swapped by
+   the caller as usual), avoiding a system call per transfer.  Dirty
+   pages are written back with msync when the unit is flushed and when
+   it is detached.  Writes which extend past the mapped region fall
+   back to normal file I/O.
+*/
+
+static t_stat _sim_disk_map_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_offset da = ((t_offset)lba) * ctx->sector_size;
+size_t tbc = sects * ctx->sector_size;
+size_t i;
+
+i = (da >= ctx->map_size) ? 0 : ((ctx->map_size - da) < (t_offset)tbc) ? (size_t)(ctx->map_size - da) : tbc;
+memcpy (buf, ctx->map + (size_t)da, i);
+if (i < tbc)                                            /* data beyond the end reads as zeros */
+    memset (&buf[i], 0, tbc - i);
+if (sectsread)
+    *sectsread = sects;
+return SCPE_OK;
+}
+
+static t_stat _sim_disk_map_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_offset da = ((t_offset)lba) * ctx->sector_size;
+size_t tbc = sects * ctx->sector_size;
+
+if (sim_end || (ctx->xfer_element_size == 1))
+    memcpy (ctx->map + (size_t)da, buf, tbc);
+else
+    sim_buf_copy_swapped (ctx->map + (size_t)da, buf, ctx->xfer_element_size, tbc/ctx->xfer_element_size);
+if (sectswritten)
+    *sectswritten = sects;
+return SCPE_OK;
+}
+
+/* Copy-on-write overlay (ATTACH -S)
+
+   When a container is attached with -S it is opened read only and every
+   sector written by the simulated system lands in an overlay instead.
+   The overlay is an extent map of OVERLAY_CHUNK_SECTS sector chunks,
+   hashed by chunk number, each with a bitmap of the sectors it holds.
+   Sector data is kept in memory, or with -T in an anonymous temporary
+   file.  Reads merge the overlay over the container contents and the
+   container itself is never modified, so detaching the unit discards
+   all writes at once (the DETACH -DISCARD behavior) regardless of the
+   container format.  Overlay data is held in the simulator's byte order
+   so no byte swapping is needed in either direction.
+*/
+
+#define OVERLAY_CHUNK_SECTS     64                      /* sectors per extent (bits in valid) */
+#define OVERLAY_INIT_BUCKETS    1024                    /* initial hash table size */
+
+struct disk_overlay_extent {
+    struct disk_overlay_extent
+                        *next;              /* hash chain link */
+    t_lba               chunk;              /* lba / OVERLAY_CHUNK_SECTS */
+    t_uint64            valid;              /* bitmap of sectors present */
+    uint8               *data;              /* sector data (memory overlay) */
+    t_offset            offset;             /* sector data position (file overlay) */
+    };
+
+struct disk_overlay {
+    struct disk_overlay_extent
+                        **hash;             /* extent hash table */
+    uint32              buckets;            /* hash table size (power of 2) */
+    uint32              extents;            /* extents allocated */
+    size_t              chunk_bytes;        /* bytes of data per extent */
+    FILE                *file;              /* data file (NULL for memory overlay) */
+    t_offset            file_size;          /* space allocated in data file */
+    };
+
+static t_uint64 _sim_disk_overlay_mask (uint32 first, uint32 count)
+{
+return ((count == OVERLAY_CHUNK_SECTS) ? ~((t_uint64)0) : ((((t_uint64)1) << count) - 1)) << first;
+}
+
+static struct disk_overlay_extent *_sim_disk_overlay_extent (struct disk_overlay *ov, t_lba chunk, t_bool create)
+{
+struct disk_overlay_extent *ext;
+uint32 bucket = (uint32)(chunk & (ov->buckets - 1));
+
+for (ext = ov->hash[bucket]; ext != NULL; ext = ext->next)
+    if (ext->chunk == chunk)
+        return ext;
+if (!create)
+    return NULL;
+if (ov->extents >= 2 * ov->buckets) {                   /* chains getting long? */
+    uint32 buckets = 2 * ov->buckets;
+    struct disk_overlay_extent **hash = (struct disk_overlay_extent **)calloc (buckets, sizeof (*hash));
+    uint32 i;
+
+    if (hash != NULL) {                                 /* rehash (or just live with longer chains) */
+        for (i = 0; i < ov->buckets; i++) {
+            while ((ext = ov->hash[i]) != NULL) {
+                ov->hash[i] = ext->next;
+                ext->next = hash[ext->chunk & (buckets - 1)];
+                hash[ext->chunk & (buckets - 1)] = ext;
+                }
+            }
+        free (ov->hash);
+        ov->hash = hash;
+        ov->buckets = buckets;
+        bucket = (uint32)(chunk & (ov->buckets - 1));
+        }
+    }
+ext = (struct disk_overlay_extent *)calloc (1, sizeof (*ext));
+if (ext == NULL)
+    return NULL;
+if (ov->file == NULL) {
+    ext->data = (uint8 *)malloc (ov->chunk_bytes);
+    if (ext->data == NULL) {
+        free (ext);
+        return NULL;
+        }
+    }
+else {
+    ext->offset = ov->file_size;
+    ov->file_size += ov->chunk_bytes;
+    }
+ext->chunk = chunk;
+ext->next = ov->hash[bucket];
+ov->hash[bucket] = ext;
+++ov->extents;
+return ext;
+}
+
+static t_stat _sim_disk_overlay_create (UNIT *uptr, t_bool use_file)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_overlay *ov = (struct disk_overlay *)calloc (1, sizeof (*ov));
+
+if (ov == NULL)
+    return SCPE_MEM;
+ov->buckets = OVERLAY_INIT_BUCKETS;
+ov->hash = (struct disk_overlay_extent **)calloc (ov->buckets, sizeof (*ov->hash));
+ov->chunk_bytes = OVERLAY_CHUNK_SECTS * (size_t)ctx->sector_size;
+if (use_file)
+    ov->file = tmpfile ();
+if ((ov->hash == NULL) || (use_file && (ov->file == NULL))) {
+    free (ov->hash);
+    free (ov);
+    return use_file ? SCPE_OPENERR : SCPE_MEM;
+    }
+ctx->overlay = ov;
+return SCPE_OK;
+}
+
+static void _sim_disk_overlay_free (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_overlay *ov = ctx->overlay;
+struct disk_overlay_extent *ext;
+uint32 i;
+
+if (ov == NULL)
+    return;
+sim_debug_unit (ctx->dbit, uptr, "discarding %u overlay extents (%u KB)\n", ov->extents, (uint32)((ov->extents * (t_offset)ov->chunk_bytes) / 1024));
+for (i = 0; i < ov->buckets; i++) {
+    while ((ext = ov->hash[i]) != NULL) {
+        ov->hash[i] = ext->next;
+        free (ext->data);
+        free (ext);
+        }
+    }
+if (ov->file)
+    fclose (ov->file);
+free (ov->hash);
+free (ov);
+ctx->overlay = NULL;
+}
+
+static t_stat _sim_disk_overlay_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_overlay *ov = ctx->overlay;
+t_seccnt done = 0;
+
+sim_debug_unit (ctx->dbit, uptr, "_sim_disk_overlay_wrsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), lba, sects);
+
+while (done < sects) {
+    t_lba sect = lba + done;
+    uint32 first = (uint32)(sect % OVERLAY_CHUNK_SECTS);
+    uint32 count = OVERLAY_CHUNK_SECTS - first;
+    struct disk_overlay_extent *ext = _sim_disk_overlay_extent (ov, sect / OVERLAY_CHUNK_SECTS, TRUE);
+    size_t bytes;
+
+    if (count > sects - done)
+        count = sects - done;
+    bytes = count * (size_t)ctx->sector_size;
+    if (ext == NULL)
+        return SCPE_MEM;
+    if (ov->file) {
+        if ((sim_fseeko (ov->file, ext->offset + first * (t_offset)ctx->sector_size, SEEK_SET)) ||
+            (fwrite (buf + done * (size_t)ctx->sector_size, 1, bytes, ov->file) != bytes))
+            return SCPE_IOERR;
+        }
+    else
+        memcpy (ext->data + first * (size_t)ctx->sector_size, buf + done * (size_t)ctx->sector_size, bytes);
+    ext->valid |= _sim_disk_overlay_mask (first, count);
+    done += count;
+    if (sectswritten)
+        *sectswritten = done;
+    }
+return SCPE_OK;
+}
+
+/* Merge overlay sectors into buf, optionally just determining whether
+   the whole range is present in the overlay */
+
+static t_stat _sim_disk_overlay_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt sects, t_bool *all_present)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_overlay *ov = ctx->overlay;
+t_seccnt done = 0;
+
+if (all_present)
+    *all_present = TRUE;
+while (done < sects) {
+    t_lba sect = lba + done;
+    uint32 first = (uint32)(sect % OVERLAY_CHUNK_SECTS);
+    uint32 count = OVERLAY_CHUNK_SECTS - first;
+    struct disk_overlay_extent *ext = _sim_disk_overlay_extent (ov, sect / OVERLAY_CHUNK_SECTS, FALSE);
+    uint32 i, run;
+
+    if (count > sects - done)
+        count = sects - done;
+    if (all_present) {
+        t_uint64 mask = _sim_disk_overlay_mask (first, count);
+
+        if ((ext == NULL) || ((ext->valid & mask) != mask)) {
+            *all_present = FALSE;
+            return SCPE_OK;
+            }
+        }
+    else if (ext != NULL) {
+        for (i = 0; i < count; i += run) {             /* copy runs of present sectors */
+            for (run = 0; (i + run < count) && (ext->valid & _sim_disk_overlay_mask (first + i + run, 1)); run++)
+                ;
+            if (run == 0) {
+                run = 1;
+                continue;
+                }
+            if (ov->file) {
+                size_t bytes = run * (size_t)ctx->sector_size;
+
+                if ((sim_fseeko (ov->file, ext->offset + (first + i) * (t_offset)ctx->sector_size, SEEK_SET)) ||
+                    (fread (buf + (done + i) * (size_t)ctx->sector_size, 1, bytes, ov->file) != bytes))
+                    return SCPE_IOERR;
+                }
+            else
+                memcpy (buf + (done + i) * (size_t)ctx->sector_size, ext->data + (first + i) * (size_t)ctx->sector_size, run * (size_t)ctx->sector_size);
+            }
+        }
+    done += count;
+    }
+return SCPE_OK;
+}
+
+/* SIMHZ compressed disk container
+
+   A SIMHZ container holds a SIMH format disk image (including its footer)
+   which has been split into fixed size clusters, each deflated
+   independently, so that any sector is reached by inflating only the
+   cluster which holds it.  Clusters which have never been written take
+   no space, so a mostly empty disk is a small file.  The container is
+   presented to the rest of this module as a stdio stream (via fopencookie
+   or funopen), so SIMHZ disks are read and written by the same code as
+   SIMH disks.
+
+   The file starts with a header:
+
+        char[8]     "SIMHDSKZ"
+        uint32      version
+        uint32      cluster size (uncompressed bytes per cluster)
+        uint64      index position (0 when the index isn't current)
+        uint64      uncompressed disk image size
+        uint32      parent path length (0 if none)
+        uint32      position of the first cluster record
+        char[]      parent path
+
+   which is followed by cluster records, each a 16 byte header (magic,
+   cluster number, compressed length and the space reserved for the
+   record) and the compressed data, and then by an index giving the
+   location of the current copy of each cluster.  All values are little
+   endian.  A cluster whose compressed length equals the cluster size is
+   stored uncompressed, and one with a compressed length of zero is all
+   zeros (so that it hides the parent's copy).
+
+   A differencing container (ATTACH -D with SIMHZ format) names a parent
+   SIMH or SIMHZ container, which is opened read only and supplies the
+   data of the clusters which the child hasn't written.
+
+   A modified cluster is rewritten in place when its compressed data fits
+   in the space reserved for it and is otherwise appended to the file.
+   The index is written whenever the unit is flushed or detached.  The
+   header's index position is cleared before the first cluster is written
+   after the index was written, so a container which wasn't closed cleanly
+   is recovered by scanning the cluster records.  The space held by
+   superseded clusters is reclaimed with SET DISK COMPACT=<unit>, which
+   rewrites the container while the unit remains attached.
+*/
+
+#if defined (SIM_DISK_SIMHZ)
+
+#define DZ_MAGIC            "SIMHDSKZ"
+#define DZ_VERSION          1
+#define DZ_HDR_SIZE         40                  /* fixed portion of the file header */
+#define DZ_CLU_MAGIC        0x554C435A          /* "ZCLU" cluster record */
+#define DZ_CLU_SIZE         16                  /* cluster record header size */
+#define DZ_IDX_MAGIC        0x5844495A          /* "ZIDX" index */
+#define DZ_IDX_SIZE         16                  /* index entry size */
+#define DZ_CLUSTER_SIZE     (64*1024)           /* cluster size for new containers */
+#define DZ_MAX_CLUSTER      (16*1024*1024)      /* largest cluster size accepted */
+#define DZ_MAX_PATH         4096                /* longest parent path accepted */
+#define DZ_NO_CLUSTER       0xFFFFFFFF
+
+typedef struct {
+    t_offset            offset;                 /* compressed data position, 0 if never written */
+    uint32              clen;                   /* compressed length */
+    uint32              slot;                   /* space reserved for the compressed data */
+    } DZ_CLUSTER;
+
+typedef struct dz_disk DZ_DISK;
+
+struct dz_disk {
+    DZ_DISK             *next;                  /* list of open containers */
+    FILE                *stream;                /* stream presented to sim_disk */
+    FILE                *f;                     /* container file */
+    char                *filename;
+    char                *parent_name;           /* parent container path (or NULL) */
+    FILE                *parent;                /* parent container stream (or NULL) */
+    t_offset            parent_size;
+    t_bool              writable;
+    uint32              cluster_size;           /* uncompressed bytes per cluster */
+    uint32              cluster_count;          /* clusters in table */
+    uint32              cluster_alloc;          /* clusters allocated */
+    DZ_CLUSTER          *clusters;
+    t_offset            data_start;             /* first cluster record */
+    t_offset            size;                   /* uncompressed size */
+    t_offset            pos;                    /* uncompressed stream position */
+    t_offset            end;                    /* where the next cluster record goes */
+    t_offset            index_offset;           /* index position, 0 if not current */
+    uint8               *buf;                   /* uncompressed cluster data */
+    uint8               *zbuf;                  /* compressed cluster data */
+    uLong               zbuf_size;
+    uint32              cluster;                /* cluster held in buf */
+    t_bool              dirty;                  /* buf modified since it was loaded */
+    };
+
+static DZ_DISK *dz_disks = NULL;                /* open containers */
+
+static void dz_put32 (uint8 *p, uint32 val)
+{
+p[0] = (uint8)val;
+p[1] = (uint8)(val >> 8);
+p[2] = (uint8)(val >> 16);
+p[3] = (uint8)(val >> 24);
+}
+
+static uint32 dz_get32 (const uint8 *p)
+{
+return (uint32)p[0] | ((uint32)p[1] << 8) | ((uint32)p[2] << 16) | ((uint32)p[3] << 24);
+}
+
+static void dz_put64 (uint8 *p, t_uint64 val)
+{
+dz_put32 (p, (uint32)val);
+dz_put32 (p + 4, (uint32)(val >> 32));
+}
+
+static t_uint64 dz_get64 (const uint8 *p)
+{
+return (t_uint64)dz_get32 (p) | ((t_uint64)dz_get32 (p + 4) << 32);
+}
+
+static t_bool dz_pread (FILE *f, t_offset pos, void *buf, size_t len)
+{
+return ((sim_fseeko (f, pos, SEEK_SET) == 0) &&
+        (fread (buf, 1, len, f) == len));
+}
+
+static t_bool dz_pwrite (FILE *f, t_offset pos, const void *buf, size_t len)
+{
+return ((sim_fseeko (f, pos, SEEK_SET) == 0) &&
+        (fwrite (buf, 1, len, f) == len));
+}
+
+static t_bool dz_write_header (DZ_DISK *z, FILE *f, t_offset index_offset)
+{
+uint8 hdr[DZ_HDR_SIZE];
+uint32 plen = z->parent_name ? (uint32)strlen (z->parent_name) : 0;
+
+memcpy (hdr, DZ_MAGIC, 8);
+dz_put32 (hdr + 8, DZ_VERSION);
+dz_put32 (hdr + 12, z->cluster_size);
+dz_put64 (hdr + 16, (t_uint64)index_offset);
+dz_put64 (hdr + 24, (t_uint64)z->size);
+dz_put32 (hdr + 32, plen);
+dz_put32 (hdr + 36, (uint32)z->data_start);
+return (dz_pwrite (f, 0, hdr, sizeof (hdr)) &&
+        ((plen == 0) || (fwrite (z->parent_name, 1, plen, f) == plen)));
+}
+
+static t_bool dz_grow_clusters (DZ_DISK *z, uint32 count)
+{
+DZ_CLUSTER *clusters;
+uint32 alloc;
+
+if (count <= z->cluster_count)
+    return TRUE;
+if (count > z->cluster_alloc) {
+    alloc = (z->cluster_alloc == 0) ? 256 : z->cluster_alloc;
+    while (alloc < count)
+        alloc *= 2;
+    clusters = (DZ_CLUSTER *)realloc (z->clusters, alloc * sizeof (*clusters));
+    if (clusters == NULL)
+        return FALSE;
+    z->clusters = clusters;
+    z->cluster_alloc = alloc;
+    }
+memset (z->clusters + z->cluster_count, 0, (count - z->cluster_count) * sizeof (*z->clusters));
+z->cluster_count = count;
+return TRUE;
+}
+
+static t_bool dz_valid_record (DZ_DISK *z, t_offset offset, uint32 clen, uint32 slot)
+{
+return ((clen <= slot) && (slot <= z->cluster_size) &&
+        (offset >= z->data_start + DZ_CLU_SIZE));
+}
+
+/* Read the index, checking that it describes clusters within the file */
+
+static t_bool dz_read_index (DZ_DISK *z, t_offset file_size)
+{
+uint8 hdr[8];
+uint8 ent[DZ_IDX_SIZE];
+uint32 i, count;
+
+if ((z->index_offset < z->data_start) ||
+    !dz_pread (z->f, z->index_offset, hdr, sizeof (hdr)) ||
+    (dz_get32 (hdr) != DZ_IDX_MAGIC))
+    return FALSE;
+count = dz_get32 (hdr + 4);
+if ((z->index_offset + sizeof (hdr) + (t_offset)count * DZ_IDX_SIZE > file_size) ||
+    !dz_grow_clusters (z, count))
+    return FALSE;
+for (i = 0; i < count; i++) {
+    DZ_CLUSTER *c = &z->clusters[i];
+
+    if (fread (ent, 1, sizeof (ent), z->f) != sizeof (ent))
+        return FALSE;
+    c->offset = (t_offset)dz_get64 (ent);
+    c->clen = dz_get32 (ent + 8);
+    c->slot = dz_get32 (ent + 12);
+    if ((c->offset != 0) &&
+        (!dz_valid_record (z, c->offset, c->clen, c->slot) ||
+         (c->offset + c->slot > z->index_offset)))
+        return FALSE;
+    }
+z->end = z->index_offset;
+return TRUE;
+}
+
+/* Rebuild the cluster table from the cluster records of a container
+   which wasn't closed cleanly.  Clusters only move towards the end of
+   the file, so later copies of a cluster supersede earlier ones.  The
+   scan stops at the first incomplete or unrecognized record. */
+
+static void dz_recover (DZ_DISK *z, t_offset file_size)
+{
+uint8 hdr[DZ_CLU_SIZE];
+t_offset pos = z->data_start;
+
+z->cluster_count = 0;
+while (dz_pread (z->f, pos, hdr, sizeof (hdr)) &&
+       (dz_get32 (hdr) == DZ_CLU_MAGIC)) {
+    uint32 n = dz_get32 (hdr + 4);
+    uint32 clen = dz_get32 (hdr + 8);
+    uint32 slot = dz_get32 (hdr + 12);
+
+    if ((n >= DZ_NO_CLUSTER) ||
+        !dz_valid_record (z, pos + DZ_CLU_SIZE, clen, slot) ||
+        (pos + DZ_CLU_SIZE + clen > file_size) ||  /* the slot past clen may be unwritten */
+        !dz_grow_clusters (z, n + 1))
+        break;
+    z->clusters[n].offset = pos + DZ_CLU_SIZE;
+    z->clusters[n].clen = clen;
+    z->clusters[n].slot = slot;
+    pos += DZ_CLU_SIZE + slot;
+    }
+z->end = pos;
+z->index_offset = 0;
+sim_messagef (SCPE_OK, "%s: recovered %u clusters of a SIMHZ container which wasn't closed cleanly\n", z->filename, z->cluster_count);
+}
+
+/* Note that the index is about to become stale */
+
+static t_bool dz_mark_dirty (DZ_DISK *z)
+{
+if (z->index_offset == 0)
+    return TRUE;
+z->index_offset = 0;
+return (dz_write_header (z, z->f, 0) && (fflush (z->f) == 0));
+}
+
+static t_bool dz_flush_cluster (DZ_DISK *z)
+{
+uint8 hdr[DZ_CLU_SIZE];
+DZ_CLUSTER *c;
+uLongf clen = z->zbuf_size;
+const uint8 *data = z->zbuf;
+uint32 i, slot;
+
+if (!z->dirty)
+    return TRUE;
+c = &z->clusters[z->cluster];
+for (i = 0; (i < z->cluster_size) && (z->buf[i] == 0); i++)
+    ;
+if (i == z->cluster_size)                       /* all zeros? */
+    clen = 0;
+else {
+    if (compress2 (z->zbuf, &clen, z->buf, z->cluster_size, Z_DEFAULT_COMPRESSION) != Z_OK)
+        return FALSE;
+    if (clen >= z->cluster_size) {              /* incompressible? */
+        clen = z->cluster_size;
+        data = z->buf;
+        }
+    }
+if (!dz_mark_dirty (z))
+    return FALSE;
+if ((c->offset != 0) && (clen <= c->slot))      /* fits where it is? */
+    slot = c->slot;
+else {
+    if ((c->offset != 0) &&                     /* the last record in the file */
+        (c->offset + c->slot == z->end))        /* grows in place */
+        z->end = c->offset - DZ_CLU_SIZE;
+    slot = (uint32)((clen + clen / 8 + 15) & ~15);  /* leave room to grow */
+    if (slot > z->cluster_size)
+        slot = z->cluster_size;
+    c->offset = z->end + DZ_CLU_SIZE;
+    z->end += DZ_CLU_SIZE + slot;
+    }
+dz_put32 (hdr, DZ_CLU_MAGIC);
+dz_put32 (hdr + 4, z->cluster);
+dz_put32 (hdr + 8, (uint32)clen);
+dz_put32 (hdr + 12, slot);
+if (!dz_pwrite (z->f, c->offset - DZ_CLU_SIZE, hdr, sizeof (hdr)) ||
+    (fwrite (data, 1, clen, z->f) != clen))
+    return FALSE;
+c->clen = (uint32)clen;
+c->slot = slot;
+z->dirty = FALSE;
+return TRUE;
+}
+
+/* Read cluster n into buf.  Clusters which have never been written come
+   from the parent container, or read as zeros if there isn't one. */
+
+static t_bool dz_read_cluster (DZ_DISK *z, uint32 n, uint8 *buf)
+{
+DZ_CLUSTER *c = (n < z->cluster_count) ? &z->clusters[n] : NULL;
+uLongf ulen = z->cluster_size;
+
+memset (buf, 0, z->cluster_size);
+if ((c == NULL) || (c->offset == 0)) {
+    t_offset start = (t_offset)n * z->cluster_size;
+
+    if (z->parent && (start < z->parent_size)) {
+        size_t len = z->cluster_size;
+
+        if ((t_offset)len > z->parent_size - start)
+            len = (size_t)(z->parent_size - start);
+        return dz_pread (z->parent, start, buf, len);
+        }
+    return TRUE;
+    }
+if (c->clen == 0)
+    return TRUE;
+if (c->clen == z->cluster_size)
+    return dz_pread (z->f, c->offset, buf, c->clen);
+return (dz_pread (z->f, c->offset, z->zbuf, c->clen) &&
+        (uncompress (buf, &ulen, z->zbuf, c->clen) == Z_OK) &&
+        (ulen == z->cluster_size));
+}
+
+static t_bool dz_load_cluster (DZ_DISK *z, uint32 n)
+{
+if (n == z->cluster)
+    return TRUE;
+if (!dz_flush_cluster (z) || !dz_grow_clusters (z, n + 1))
+    return FALSE;
+z->cluster = DZ_NO_CLUSTER;
+if (!dz_read_cluster (z, n, z->buf))
+    return FALSE;
+z->cluster = n;
+return TRUE;
+}
+
+static t_bool dz_write_index (DZ_DISK *z, FILE *f, t_offset pos)
+{
+uint8 hdr[8];
+uint8 ent[DZ_IDX_SIZE];
+uint32 i;
+
+dz_put32 (hdr, DZ_IDX_MAGIC);
+dz_put32 (hdr + 4, z->cluster_count);
+if (!dz_pwrite (f, pos, hdr, sizeof (hdr)))
+    return FALSE;
+for (i = 0; i < z->cluster_count; i++) {
+    dz_put64 (ent, (t_uint64)z->clusters[i].offset);
+    dz_put32 (ent + 8, z->clusters[i].clen);
+    dz_put32 (ent + 12, z->clusters[i].slot);
+    if (fwrite (ent, 1, sizeof (ent), f) != sizeof (ent))
+        return FALSE;
+    }
+return (fflush (f) == 0);                       /* index on disk before the header points to it */
+}
+
+/* Write the current cluster, the index and the header */
+
+static t_bool dz_sync (DZ_DISK *z)
+{
+if (!z->writable)
+    return TRUE;
+if (!dz_flush_cluster (z))
+    return FALSE;
+if (z->index_offset != 0)                       /* index is current? */
+    return TRUE;
+if (!dz_write_index (z, z->f, z->end))
+    return FALSE;
+z->index_offset = z->end;
+return (dz_write_header (z, z->f, z->index_offset) && (fflush (z->f) == 0));
+}
+
+static long dz_read (DZ_DISK *z, char *buf, size_t size)
+{
+size_t done = 0;
+
+while ((done < size) && (z->pos < z->size)) {
+    uint32 n = (uint32)(z->pos / z->cluster_size);
+    size_t offset = (size_t)(z->pos % z->cluster_size);
+    size_t len = z->cluster_size - offset;
+
+    if (len > size - done)
+        len = size - done;
+    if ((t_offset)len > z->size - z->pos)
+        len = (size_t)(z->size - z->pos);
+    if (!dz_load_cluster (z, n)) {
+        errno = EIO;
+        return (done > 0) ? (long)done : -1;
+        }
+    memcpy (buf + done, z->buf + offset, len);
+    done += len;
+    z->pos += len;
+    }
+return (long)done;
+}
+
+static long dz_write (DZ_DISK *z, const char *buf, size_t size)
+{
+size_t done = 0;
+
+if (!z->writable) {
+    errno = EBADF;
+    return -1;
+    }
+while (done < size) {
+    uint32 n = (uint32)(z->pos / z->cluster_size);
+    size_t offset = (size_t)(z->pos % z->cluster_size);
+    size_t len = z->cluster_size - offset;
+
+    if (len > size - done)
+        len = size - done;
+    if (!dz_load_cluster (z, n)) {
+        errno = EIO;
+        return (done > 0) ? (long)done : -1;
+        }
+    memcpy (z->buf + offset, buf + done, len);
+    z->dirty = TRUE;
+    done += len;
+    z->pos += len;
+    if (z->pos > z->size) {
+        z->size = z->pos;
+        if (!dz_mark_dirty (z)) {               /* size is only current in the header */
+            errno = EIO;
+            return -1;
+            }
+        }
+    }
+return (long)done;
+}
+
+static int dz_seek (DZ_DISK *z, t_offset *offset, int whence)
+{
+t_offset pos;
+
+switch (whence) {
+    case SEEK_SET:
+        pos = *offset;
+        break;
+    case SEEK_CUR:
+        pos = z->pos + *offset;
+        break;
+    case SEEK_END:
+        pos = z->size + *offset;
+        break;
+    default:
+        pos = -1;
+        break;
+    }
+if ((pos < 0) || (pos / z->cluster_size >= DZ_NO_CLUSTER)) {
+    errno = EINVAL;
+    return -1;
+    }
+*offset = z->pos = pos;
+return 0;
+}
+
+static void dz_free (DZ_DISK *z)
+{
+DZ_DISK **pz;
+
+for (pz = &dz_disks; *pz != NULL; pz = &(*pz)->next)
+    if (*pz == z) {
+        *pz = z->next;
+        break;
+        }
+if (z->parent)
+    fclose (z->parent);
+free (z->clusters);
+free (z->buf);
+free (z->zbuf);
+free (z->filename);
+free (z->parent_name);
+free (z);
+}
+
+static int dz_close (DZ_DISK *z)
+{
+t_bool ok = dz_sync (z);
+
+if (fclose (z->f) != 0)
+    ok = FALSE;
+dz_free (z);
+return ok ? 0 : -1;
+}
+
+#if defined (__GLIBC__)
+static ssize_t dz_cookie_read (void *cookie, char *buf, size_t size)
+{
+return (ssize_t)dz_read ((DZ_DISK *)cookie, buf, size);
+}
+
+static ssize_t dz_cookie_write (void *cookie, const char *buf, size_t size)
+{
+long r = dz_write ((DZ_DISK *)cookie, buf, size);
+
+return (r < 0) ? 0 : (ssize_t)r;                /* glibc expects 0 on error */
+}
+
+static int dz_cookie_seek (void *cookie, off64_t *offset, int whence)
+{
+t_offset pos = (t_offset)*offset;
+
+if (dz_seek ((DZ_DISK *)cookie, &pos, whence))
+    return -1;
+*offset = (off64_t)pos;
+return 0;
+}
+
+static int dz_cookie_close (void *cookie)
+{
+return dz_close ((DZ_DISK *)cookie);
+}
+#else
+static int dz_cookie_read (void *cookie, char *buf, int size)
+{
+return (int)dz_read ((DZ_DISK *)cookie, buf, (size_t)size);
+}
+
+static int dz_cookie_write (void *cookie, const char *buf, int size)
+{
+return (int)dz_write ((DZ_DISK *)cookie, buf, (size_t)size);
+}
+
+static fpos_t dz_cookie_seek (void *cookie, fpos_t offset, int whence)
+{
+t_offset pos = (t_offset)offset;
+
+if (dz_seek ((DZ_DISK *)cookie, &pos, whence))
+    return (fpos_t)-1;
+return (fpos_t)pos;
+}
+
+static int dz_cookie_close (void *cookie)
+{
+return dz_close ((DZ_DISK *)cookie);
+}
+#endif
+
+static t_bool dz_exists (const char *filename)
+{
+struct stat statb;
+
+return (sim_stat (filename, &statb) == 0);
+}
+
+static DZ_DISK *dz_find (FILE *stream)
+{
+DZ_DISK *z;
+
+for (z = dz_disks; z != NULL; z = z->next)
+    if (z->stream == stream)
+        return z;
+return NULL;
+}
+
+/* TRUE if the named file is a SIMHZ container */
+
+static t_bool sim_disk_simhz_check (const char *filename)
+{
+FILE *f = sim_fopen (filename, "rb");
+char magic[8];
+t_bool ret;
+
+if (f == NULL)
+    return FALSE;
+ret = ((fread (magic, 1, sizeof (magic), f) == sizeof (magic)) &&
+       (memcmp (magic, DZ_MAGIC, sizeof (magic)) == 0));
+fclose (f);
+return ret;
+}
+
+static FILE *sim_disk_simhz_open (const char *filename, const char *openmode);
+
+/* Open a parent container (SIMH or SIMHZ) read only.  A relative path
+   which isn't found is looked for in the child container's directory. */
+
+static FILE *dz_open_parent (const char *child, const char *parent)
+{
+FILE *f = NULL;
+char path[PATH_MAX + 1];
+const char *name = parent;
+
+if (!dz_exists (name) &&
+    (parent[0] != '/') && (parent[0] != '\\') && (strchr (parent, ':') == NULL)) {
+    const char *slash = strrchr (child, '/');
+
+    if (slash == NULL)
+        slash = strrchr (child, '\\');
+    if (slash != NULL) {
+        snprintf (path, sizeof (path), "%.*s%s", (int)(slash + 1 - child), child, parent);
+        name = path;
+        }
+    }
+if (sim_disk_simhz_check (name))
+    f = sim_disk_simhz_open (name, "rb");
+else
+    f = sim_fopen (name, "rb");
+if (f == NULL)
+    sim_messagef (SCPE_OPENERR, "Can't open parent disk container '%s' of '%s' - %s\n", name, child, strerror (errno));
+return f;
+}
+
+/* Create the DZ_DISK for an open container file, returning its stream.
+   An empty writable file is initialized as a new container with the
+   specified parent.  On failure NULL is returned and f is closed. */
+
+static FILE *dz_open_file (FILE *f, const char *filename, t_bool writable, const char *parent_name)
+{
+DZ_DISK *z = (DZ_DISK *)calloc (1, sizeof (*z));
+uint8 hdr[DZ_HDR_SIZE];
+t_offset file_size = sim_fsize_ex (f);
+FILE *zf = NULL;
+
+if ((z == NULL) || ((z->filename = strdup (filename)) == NULL)) {
+    free (z);
+    fclose (f);
+    return NULL;
+    }
+z->f = f;
+z->writable = writable;
+z->cluster = DZ_NO_CLUSTER;
+if (file_size == 0) {                           /* new container? */
+    z->cluster_size = DZ_CLUSTER_SIZE;
+    if (parent_name) {
+        z->parent_name = strdup (parent_name);
+        if ((z->parent_name == NULL) ||
+            ((z->parent = dz_open_parent (filename, parent_name)) == NULL))
+            goto Error;
+        z->size = z->parent_size = sim_fsize_ex (z->parent);
+        }
+    z->data_start = DZ_HDR_SIZE + (parent_name ? strlen (parent_name) : 0);
+    z->end = z->data_start;
+    if (!writable || !dz_write_header (z, z->f, 0))
+        goto Error;
+    }
+else {
+    uint32 plen;
+
+    if (!dz_pread (z->f, 0, hdr, sizeof (hdr)) ||
+        (memcmp (hdr, DZ_MAGIC, 8) != 0) ||
+        (dz_get32 (hdr + 8) != DZ_VERSION))
+        goto Error;
+    z->cluster_size = dz_get32 (hdr + 12);
+    z->index_offset = (t_offset)dz_get64 (hdr + 16);
+    z->size = (t_offset)dz_get64 (hdr + 24);
+    plen = dz_get32 (hdr + 32);
+    z->data_start = dz_get32 (hdr + 36);
+    if ((z->cluster_size < 512) || (z->cluster_size > DZ_MAX_CLUSTER) ||
+        (plen > DZ_MAX_PATH) || (z->data_start < DZ_HDR_SIZE + plen))
+        goto Error;
+    if (plen) {
+        z->parent_name = (char *)calloc (1, plen + 1);
+        if ((z->parent_name == NULL) ||
+            (fread (z->parent_name, 1, plen, z->f) != plen) ||
+            ((z->parent = dz_open_parent (filename, z->parent_name)) == NULL))
+            goto Error;
+        z->parent_size = sim_fsize_ex (z->parent);
+        }
+    if (!dz_read_index (z, file_size)) {        /* no usable index? */
+        dz_recover (z, file_size);
+        if (writable)
+            dz_sync (z);
+        }
+    }
+z->zbuf_size = compressBound (z->cluster_size);
+z->buf = (uint8 *)malloc (z->cluster_size);
+z->zbuf = (uint8 *)malloc (z->zbuf_size);
+if ((z->buf == NULL) || (z->zbuf == NULL))
+    goto Error;
+if (1) {
+#if defined (__GLIBC__)
+    cookie_io_functions_t io;
+
+    io.read = dz_cookie_read;
+    io.write = dz_cookie_write;
+    io.seek = dz_cookie_seek;
+    io.close = dz_cookie_close;
+    zf = fopencookie (z, writable ? "r+b" : "rb", io);
+#else
+    zf = funopen (z, dz_cookie_read, writable ? dz_cookie_write : NULL,
+                  dz_cookie_seek, dz_cookie_close);
+#endif
+    }
+if (zf == NULL)
+    goto Error;
+z->stream = zf;
+z->next = dz_disks;
+dz_disks = z;
+return zf;
+
+Error:
+fclose (z->f);
+dz_free (z);
+return NULL;
+}
+
+/* Open a SIMHZ container with a sim_fopen style mode ("rb", "rb+" or
+   "wb+", which creates a new empty container). */
+
+static FILE *sim_disk_simhz_open (const char *filename, const char *openmode)
+{
+t_bool create = (openmode[0] == 'w');
+t_bool writable = create || (strchr (openmode, '+') != NULL);
+FILE *f;
+
+if (!create && !sim_disk_simhz_check (filename)) {
+    errno = dz_exists (filename) ? EINVAL : ENOENT;
+    return NULL;
+    }
+f = sim_fopen (filename, create ? "wb+" : (writable ? "rb+" : "rb"));
+if (f == NULL)
+    return NULL;
+return dz_open_file (f, filename, writable, NULL);
+}
+
+/* Create a SIMHZ differencing container whose parent is a SIMH or SIMHZ
+   container */
+
+static FILE *sim_disk_simhz_create_diff (const char *filename, const char *parent)
+{
+FILE *f;
+
+if (dz_exists (filename)) {
+    errno = EEXIST;
+    return NULL;
+    }
+f = sim_fopen (filename, "wb+");
+if (f == NULL)
+    return NULL;
+f = dz_open_file (f, filename, TRUE, parent);
+if (f == NULL)
+    (void)remove (filename);
+return f;
+}
+
+/* Write the buffered cluster and the index of a stream opened by
+   sim_disk_simhz_open */
+
+static t_bool sim_disk_simhz_sync (FILE *stream)
+{
+DZ_DISK *z = dz_find (stream);
+
+return (z == NULL) || ((fflush (stream) == 0) && dz_sync (z));
+}
+
+/* Rewrite a container without the space held by superseded clusters (and
+   without zero clusters which no parent needs hiding).  The compressed
+   data is copied as is and the stream remains open. */
+
+static t_stat sim_disk_simhz_compact (FILE *stream, t_offset *old_size, t_offset *new_size)
+{
+DZ_DISK *z = dz_find (stream);
+char tmpname[PATH_MAX + 1];
+DZ_CLUSTER *clusters = NULL;
+FILE *f;
+t_offset pos;
+uint8 *data;
+uint8 hdr[DZ_CLU_SIZE];
+uint32 i;
+t_bool ok;
+
+if (z == NULL)
+    return SCPE_IERR;
+if (!z->writable)
+    return SCPE_RO;
+if ((fflush (stream) != 0) || !dz_sync (z))
+    return SCPE_IOERR;
+*old_size = sim_fsize_ex (z->f);
+snprintf (tmpname, sizeof (tmpname), "%s.compact", z->filename);
+clusters = (DZ_CLUSTER *)calloc (z->cluster_count + 1, sizeof (*clusters));
+data = (uint8 *)malloc (z->cluster_size);
+f = sim_fopen (tmpname, "wb+");
+ok = ((clusters != NULL) && (data != NULL) && (f != NULL) &&
+      dz_write_header (z, f, 0));
+pos = z->data_start;
+for (i = 0; ok && (i < z->cluster_count); i++) {
+    DZ_CLUSTER *c = &z->clusters[i];
+
+    if ((c->offset == 0) || ((c->clen == 0) && (z->parent == NULL)))
+        continue;
+    dz_put32 (hdr, DZ_CLU_MAGIC);
+    dz_put32 (hdr + 4, i);
+    dz_put32 (hdr + 8, c->clen);
+    dz_put32 (hdr + 12, c->clen);
+    ok = (((c->clen == 0) || dz_pread (z->f, c->offset, data, c->clen)) &&
+          dz_pwrite (f, pos, hdr, sizeof (hdr)) &&
+          (fwrite (data, 1, c->clen, f) == c->clen));
+    clusters[i].offset = pos + DZ_CLU_SIZE;
+    clusters[i].clen = clusters[i].slot = c->clen;
+    pos += DZ_CLU_SIZE + c->clen;
+    }
+free (data);
+if (ok) {
+    DZ_CLUSTER *old_clusters = z->clusters;
+
+    z->clusters = clusters;
+    ok = dz_write_index (z, f, pos) && dz_write_header (z, f, pos);
+    z->clusters = old_clusters;
+    }
+if (f != NULL)
+    ok = (fclose (f) == 0) && ok;
+if (ok) {                                       /* replace the container */
+    fclose (z->f);
+    (void)remove (z->filename);
+    if (rename (tmpname, z->filename) != 0) {
+        z->f = sim_fopen (tmpname, "rb+");      /* keep using the copy */
+        sim_messagef (SCPE_OK, "Can't rename '%s' to '%s' - %s\n", tmpname, z->filename, strerror (errno));
+        }
+    else
+        z->f = sim_fopen (z->filename, "rb+");
+    if (z->f == NULL) {
+        free (clusters);
+        z->writable = FALSE;
+        return SCPE_IOERR;
+        }
+    free (z->clusters);
+    z->clusters = clusters;
+    z->cluster_alloc = z->cluster_count + 1;
+    z->end = z->index_offset = pos;
+    *new_size = sim_fsize_ex (z->f);
+    return SCPE_OK;
+    }
+free (clusters);
+(void)remove (tmpname);
+return SCPE_IOERR;
+}
+
+/* Give a stream inherited across a fork (CLONE) container and parent
+   file descriptors of its own.  Cluster reads position the container
+   file explicitly, and the file offset is shared between the processes
+   which inherited the descriptor.  The clone never writes the container
+   (sim_disk_clone puts an overlay over it), so the private copies are
+   opened read only. */
+
+static t_stat sim_disk_simhz_clone (FILE *stream)
+{
+DZ_DISK *z = dz_find (stream);
+FILE *f, *parent = NULL;
+
+if (z == NULL)
+    return SCPE_IERR;
+f = sim_fopen (z->filename, "rb");
+if ((f == NULL) ||
+    (z->parent_name && ((parent = dz_open_parent (z->filename, z->parent_name)) == NULL))) {
+    if (f != NULL)
+        fclose (f);
+    return SCPE_OPENERR;
+    }
+fclose (z->f);
+z->f = f;
+if (z->parent)
+    fclose (z->parent);
+z->parent = parent;
+z->writable = FALSE;
+return SCPE_OK;
+}
+
+#else
+
+static t_bool sim_disk_simhz_check (const char *filename)
+{
+return FALSE;
+}
+
+static FILE *sim_disk_simhz_open (const char *filename, const char *openmode)
+{
+errno = ENOSYS;
+return NULL;
+}
+
+static FILE *sim_disk_simhz_create_diff (const char *filename, const char *parent)
+{
+errno = ENOSYS;
+return NULL;
+}
+
+static t_bool sim_disk_simhz_sync (FILE *stream)
+{
+return TRUE;
+}
+
+static t_stat sim_disk_simhz_compact (FILE *stream, t_offset *old_size, t_offset *new_size)
+{
+return SCPE_NOFNC;
+}
+
+static t_stat sim_disk_simhz_clone (FILE *stream)
+{
+return SCPE_NOFNC;
+}
+
+#endif /* SIM_DISK_SIMHZ */
+
+static t_stat sim_disk_simhz_implemented (void)
+{
+#if defined (SIM_DISK_SIMHZ)
+return SCPE_OK;
+#else
+return SCPE_NOFNC;
+#endif
+}
+
+
+/* Read Sectors */
+
+static t_stat _sim_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+t_offset da;
+uint32 err, tbc;
+size_t i;
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+sim_debug_unit (ctx->dbit, uptr, "_sim_disk_rdsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), lba, sects);
+
+da = ((t_offset)lba) * ctx->sector_size;
+tbc = sects * ctx->sector_size;
+if (sectsread)
+    *sectsread = 0;
+if (ctx->map)                                           /* memory mapped? */
+    return _sim_disk_map_rdsect (uptr, lba, buf, sectsread, sects);
+#if defined (SIM_DISK_PIO)
+if (DK_GET_FMT (uptr) != DKUF_F_SIMHZ) {                /* stream has a file descriptor? */
+    t_bool ioerr;
+
+    i = _sim_disk_pio (uptr->fileref, buf, tbc, da, FALSE, &ioerr);
+    if (ioerr)
+        return SCPE_IOERR;
+    if (i < tbc)                                        /* data beyond EOF reads as zeros */
+        memset (&buf[i], 0, tbc - i);
+    if (sectsread)
+        *sectsread = sects;
+    return SCPE_OK;
+    }
+#endif
+while (tbc) {
+    size_t sectbytes;
+
+    clearerr (uptr->fileref);
+    err = sim_fseeko (uptr->fileref, da, SEEK_SET);          /* set pos */
+    if (err)
+        return SCPE_IOERR;
+    i = sim_fread (buf, 1, tbc, uptr->fileref);
+    if (i < tbc)                 /* fill */
+        memset (&buf[i], 0, tbc-i);
+    if ((i == 0) &&             /* Reading at or past EOF? */
+        feof (uptr->fileref))   
+        i = tbc;                /* return 0's which have already been filled in buffer */
+    sectbytes = (i / ctx->sector_size) * ctx->sector_size;
+    if (i > sectbytes)
+        sectbytes += ctx->sector_size;
+    if (sectsread)
+        *sectsread += sectbytes / ctx->sector_size;
+    err = ferror (uptr->fileref);
+    if (err)
+        return SCPE_IOERR;
+    tbc -= sectbytes;
+    if ((tbc == 0) || (i == 0))
+        return SCPE_OK;
+    da += sectbytes;
+    buf += sectbytes;
+    }
+return SCPE_OK;
+}
+
+static t_stat _sim_disk_container_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+t_stat r;
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+uint32 f = DK_GET_FMT (uptr);
+t_seccnt sread = 0;
+
+if ((sects == 1) &&                                     /* Single sector reads */
+    (lba >= (uptr->capac*ctx->capac_factor)/(ctx->sector_size/((ctx->dptr->flags & DEV_SECTORS) ? ctx->sector_size : 1)))) {/* beyond the end of the disk */
+    memset (buf, '\0', ctx->sector_size);               /* are bad block management efforts - zero buffer */
+    if (sectsread)
+        *sectsread = 1;
+    return SCPE_OK;                                     /* return success */
+    }
+
+if ((0 == (ctx->sector_size & (ctx->storage_sector_size - 1))) ||   /* Sector Aligned & whole sector transfers */
+    ((0 == ((lba*ctx->sector_size) & (ctx->storage_sector_size - 1))) &&
+     (0 == ((sects*ctx->sector_size) & (ctx->storage_sector_size - 1)))) ||
+    (f == DKUF_F_STD) || (f == DKUF_F_VHD) ||                       /* or SIMH or VHD formats */
+    (f == DKUF_F_SIMHZ) ||                                          /* or SIMHZ format */
+    (ctx->map != NULL)) {                                           /* or memory mapped */
+    switch (f) {                                        /* case on format */
+        case DKUF_F_STD:                                /* SIMH format */
+        case DKUF_F_SIMHZ:                              /* SIMHZ format */
+            r = _sim_disk_rdsect (uptr, lba, buf, &sread, sects);
+            break;
+        case DKUF_F_VHD:                                /* VHD format */
+            r = sim_vhd_disk_rdsect (uptr, lba, buf, &sread, sects);
+            break;
+        case DKUF_F_RAW:                                /* Raw Physical Disk Access */
+            if (ctx->map)                               /* memory mapped? */
+                r = _sim_disk_map_rdsect (uptr, lba, buf, &sread, sects);
+            else
+                r = sim_os_disk_rdsect (uptr, lba, buf, &sread, sects);
+            break;
+        default:
+            return SCPE_NOFNC;
+        }
+    if (sectsread)
+        *sectsread = sread;
+    sim_buf_swap_data (buf, ctx->xfer_element_size, (sread * ctx->sector_size) / ctx->xfer_element_size);
+    return r;
+    }
+else { /* Unaligned and/or partial sector transfers in RAW mode */
+    size_t tbufsize = sects * ctx->sector_size + 2 * ctx->storage_sector_size;
+    uint8 *tbuf = (uint8*) malloc (tbufsize);
+    t_offset ssaddr = (lba * (t_offset)ctx->sector_size) & ~(t_offset)(ctx->storage_sector_size -1);
+    uint32 soffset = (uint32)((lba * (t_offset)ctx->sector_size) - ssaddr);
+    uint32 bytesread;
+
+    if (sectsread)
+        *sectsread = 0;
+    if (tbuf == NULL)
+        return SCPE_MEM;
+    r = sim_os_disk_read (uptr, ssaddr, tbuf, &bytesread, tbufsize & ~(ctx->storage_sector_size - 1));
+    sim_buf_swap_data (tbuf + soffset, ctx->xfer_element_size, (bytesread - soffset) / ctx->xfer_element_size);
+    memcpy (buf, tbuf + soffset, sects * ctx->sector_size);
+    if (sectsread) {
+        *sectsread = (bytesread - soffset) / ctx->sector_size;
+        if (*sectsread > sects)
+            *sectsread = sects;
+        }
+    free (tbuf);
+    return r;
+    }
+}
+
+/* Shared sector cache
+
+   SET DISK CACHE=size enables a sector cache which is shared by all of the
+   disk units in the simulator.  Units attached to the same container file
+   share the cached copies of its sectors, so blocks which several units
+   read (index files, directories, system images on shared disks) come
+   from the file only once.  The cache holds container data in memory byte
+   order, beneath any copy-on-write overlay, and the least recently used
+   sectors are replaced when it is full.
+
+   In WRITETHROUGH mode (the default) writes are made to the container and
+   the cached copies updated.  In WRITEBACK mode writes only update the
+   cache, and the modified sectors are written to the container when they
+   are replaced, when the unit is flushed (_sim_disk_io_flush) and when
+   it is detached.  A modified sector is written back through the unit
+   which last wrote it, and is only replaced by that unit (other units may
+   be using the same container with a different file handle in another
+   I/O thread).
+
+   Controllers for cartridge and pack drives can call sim_disk_set_track
+   after attaching a unit.  A cache miss on such a unit then reads the
+   whole track around the requested sectors, so that the rest of the track
+   is served from memory (the controller still does its own seek and
+   rotational timing).
+
+   Removable and CD-ROM devices, memory mapped (ATTACH -P) units and units
+   buffered in memory don't use the cache.
+*/
+
+typedef struct disk_cache_file DISK_CACHE_FILE;
+typedef struct disk_cache_entry DISK_CACHE_ENTRY;
+
+struct disk_cache_file {
+    DISK_CACHE_FILE     *next;              /* list of container files in use */
+    dev_t               dev;                /* container file identity */
+    ino_t               ino;
+    uint32              sector_size;
+    uint32              xfer_element_size;
+    uint32              users;              /* units attached to the file */
+    uint32              write_seq;          /* incremented by each write */
+    };
+
+struct disk_cache_entry {
+    DISK_CACHE_ENTRY    *hnext;             /* hash chain */
+    DISK_CACHE_ENTRY    *prev;              /* LRU list, most recently used first */
+    DISK_CACHE_ENTRY    *next;
+    DISK_CACHE_FILE     *file;
+    t_lba               lba;
+    UNIT                *dirty;             /* unit to write back through, NULL when clean */
+    uint8               data[1];            /* sector data */
+    };
+
+#define DISK_CACHE_COST(sz)     (offsetof (DISK_CACHE_ENTRY, data) + (sz))
+#define DISK_CACHE_SCAN         32          /* entries examined for one replacement */
+
+static struct {
+    t_offset            size;               /* configured size in bytes, 0 when disabled */
+    t_offset            used;               /* bytes held by entries */
+    t_bool              writeback;          /* defer container writes */
+    DISK_CACHE_ENTRY    **hash;
+    uint32              hash_mask;
+    DISK_CACHE_ENTRY    *head;              /* most recently used */
+    DISK_CACHE_ENTRY    *tail;              /* least recently used */
+    DISK_CACHE_FILE     *files;
+    uint32              entries;
+    double              hits;
+    double              misses;
+    double              writebacks;
+    double              readahead;          /* sectors read with a track but not requested */
+    } disk_cache;
+
+#if defined (SIM_ASYNCH_IO)
+static pthread_mutex_t disk_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#define DISK_CACHE_LOCK     pthread_mutex_lock (&disk_cache_lock)
+#define DISK_CACHE_UNLOCK   pthread_mutex_unlock (&disk_cache_lock)
+#else
+#define DISK_CACHE_LOCK
+#define DISK_CACHE_UNLOCK
+#endif
+
+static t_stat _sim_disk_container_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects);
+static void _sim_disk_io_flush (UNIT *uptr);
+
+static uint32 _disk_cache_hash (DISK_CACHE_FILE *file, t_lba lba)
+{
+return (uint32)((((size_t)file >> 4) ^ (lba * 2654435761u)) & disk_cache.hash_mask);
+}
+
+static DISK_CACHE_ENTRY *_disk_cache_find (DISK_CACHE_FILE *file, t_lba lba)
+{
+DISK_CACHE_ENTRY *e;
+
+if (disk_cache.hash == NULL)
+    return NULL;
+for (e = disk_cache.hash[_disk_cache_hash (file, lba)]; e != NULL; e = e->hnext)
+    if ((e->lba == lba) && (e->file == file))
+        return e;
+return NULL;
+}
+
+static void _disk_cache_unlink (DISK_CACHE_ENTRY *e)
+{
+if (e->prev)
+    e->prev->next = e->next;
+else
+    disk_cache.head = e->next;
+if (e->next)
+    e->next->prev = e->prev;
+else
+    disk_cache.tail = e->prev;
+}
+
+static void _disk_cache_link_head (DISK_CACHE_ENTRY *e)
+{
+e->prev = NULL;
+e->next = disk_cache.head;
+if (disk_cache.head)
+    disk_cache.head->prev = e;
+else
+    disk_cache.tail = e;
+disk_cache.head = e;
+}
+
+static void _disk_cache_set_dirty (DISK_CACHE_ENTRY *e, UNIT *uptr)
+{
+if (e->dirty)
+    ((struct disk_context *)e->dirty->disk_ctx)->cache_dirty--;
+e->dirty = uptr;
+if (e->dirty)
+    ((struct disk_context *)e->dirty->disk_ctx)->cache_dirty++;
+}
+
+static void _disk_cache_writeback (DISK_CACHE_ENTRY *e)
+{
+UNIT *uptr = e->dirty;
+
+if (uptr == NULL)
+    return;
+_disk_cache_set_dirty (e, NULL);
+_sim_disk_container_wrsect (uptr, e->lba, e->data, NULL, 1);
+disk_cache.writebacks += 1;
+}
+
+static void _disk_cache_remove (DISK_CACHE_ENTRY *e)
+{
+DISK_CACHE_ENTRY **pe = &disk_cache.hash[_disk_cache_hash (e->file, e->lba)];
+
+while (*pe != e)
+    pe = &(*pe)->hnext;
+*pe = e->hnext;
+_disk_cache_unlink (e);
+_disk_cache_set_dirty (e, NULL);
+disk_cache.used -= DISK_CACHE_COST (e->file->sector_size);
+disk_cache.entries--;
+free (e);
+}
+
+/* Make room for need more bytes.  uptr is the unit whose I/O thread is
+   running, and only its modified sectors can be written back. */
+
+static void _disk_cache_evict (UNIT *uptr, t_offset need)
+{
+while ((disk_cache.used + need > disk_cache.size) && disk_cache.tail) {
+    DISK_CACHE_ENTRY *e = disk_cache.tail;
+    int scan = DISK_CACHE_SCAN;
+
+    while (e && e->dirty && (e->dirty != uptr) && --scan)
+        e = e->prev;
+    if ((e == NULL) || (e->dirty && (e->dirty != uptr)))
+        return;                                         /* over size until those are flushed */
+    _disk_cache_writeback (e);
+    _disk_cache_remove (e);
+    }
+}
+
+/* Store a sector's data, marking it modified by dirty (or clean if NULL) */
+
+static t_bool _disk_cache_store (UNIT *uptr, DISK_CACHE_FILE *file, t_lba lba, const uint8 *data, UNIT *dirty)
+{
+DISK_CACHE_ENTRY *e = _disk_cache_find (file, lba);
+
+if (e == NULL) {
+    size_t cost = DISK_CACHE_COST (file->sector_size);
+    uint32 h;
+
+    if ((disk_cache.hash == NULL) || ((t_offset)cost > disk_cache.size))
+        return FALSE;
+    _disk_cache_evict (uptr, cost);
+    e = (DISK_CACHE_ENTRY *)malloc (cost);
+    if (e == NULL)
+        return FALSE;
+    e->file = file;
+    e->lba = lba;
+    e->dirty = NULL;
+    h = _disk_cache_hash (file, lba);
+    e->hnext = disk_cache.hash[h];
+    disk_cache.hash[h] = e;
+    disk_cache.used += cost;
+    disk_cache.entries++;
+    }
+else
+    _disk_cache_unlink (e);
+_disk_cache_link_head (e);
+memcpy (e->data, data, file->sector_size);
+_disk_cache_set_dirty (e, dirty);
+return TRUE;
+}
+
+/* Read the track holding the sectors lba through lba + sects - 1 and cache
+   the sectors of it which aren't cached yet.  Anything other than a
+   complete read of the track returns an error and leaves the caller to
+   read just the requested sectors. */
+
+static t_stat _sim_disk_cache_rdtrack (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt sects, uint32 seq)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+DISK_CACHE_FILE *file = ctx->cache_file;
+size_t ss = ctx->sector_size;
+t_seccnt tsects = ctx->track_sects;
+t_lba first = (lba / tsects) * tsects;
+t_seccnt sread = 0, j;
+uint8 *tbuf;
+t_stat r;
+
+if ((lba + sects > first + tsects) ||                   /* run crosses the track end? */
+    ((first + tsects) * (t_offset)ss >                  /* or track beyond the end of the disk? */
+     ((t_offset)uptr->capac) * ctx->capac_factor * ((ctx->dptr->flags & DEV_SECTORS) ? 512 : 1)))
+    return SCPE_IERR;
+tbuf = (uint8 *)malloc (tsects * ss);
+if (tbuf == NULL)
+    return SCPE_MEM;
+r = _sim_disk_container_rdsect (uptr, first, tbuf, &sread, tsects);
+if ((r == SCPE_OK) && (sread == tsects)) {
+    memcpy (buf, tbuf + (lba - first) * ss, sects * ss);
+    DISK_CACHE_LOCK;
+    if (seq == file->write_seq) {                       /* not written while being read? */
+        for (j = 0; j < tsects; j++)
+            if (!_disk_cache_find (file, first + j)) {
+                _disk_cache_store (uptr, file, first + j, tbuf + j * ss, NULL);
+                if ((first + j < lba) || (first + j >= lba + sects))
+                    disk_cache.readahead += 1;
+                }
+        }
+    DISK_CACHE_UNLOCK;
+    }
+else
+    r = SCPE_IOERR;
+free (tbuf);
+return r;
+}
+
+static t_stat _sim_disk_cache_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+DISK_CACHE_FILE *file = ctx->cache_file;
+size_t ss = ctx->sector_size;
+t_seccnt i = 0, run, sread;
+uint32 seq;
+t_stat r;
+
+if (sectsread)
+    *sectsread = 0;
+while (i < sects) {
+    DISK_CACHE_ENTRY *e;
+
+    DISK_CACHE_LOCK;
+    e = _disk_cache_find (file, lba + i);
+    if (e) {                                            /* hit? */
+        memcpy (buf + i * ss, e->data, ss);
+        _disk_cache_unlink (e);
+        _disk_cache_link_head (e);
+        disk_cache.hits += 1;
+        DISK_CACHE_UNLOCK;
+        ctx->cache_hits++;
+        ++i;
+        continue;
+        }
+    for (run = 1; (i + run < sects) && !_disk_cache_find (file, lba + i + run); run++)
+        ;                                               /* read the missing sectors together */
+    seq = file->write_seq;
+    disk_cache.misses += run;
+    DISK_CACHE_UNLOCK;
+    ctx->cache_misses += run;
+    if ((ctx->track_sects > run) &&                     /* read the whole track? */
+        (_sim_disk_cache_rdtrack (uptr, lba + i, buf + i * ss, run, seq) == SCPE_OK)) {
+        i += run;
+        continue;
+        }
+    sread = 0;
+    r = _sim_disk_container_rdsect (uptr, lba + i, buf + i * ss, &sread, run);
+    if ((r != SCPE_OK) || (sread < run)) {
+        if (sectsread)
+            *sectsread = i + sread;
+        return r;
+        }
+    DISK_CACHE_LOCK;
+    if (seq == file->write_seq) {                       /* not written while being read? */
+        for (sread = 0; sread < run; sread++)
+            if (!_disk_cache_find (file, lba + i + sread))
+                _disk_cache_store (uptr, file, lba + i + sread, buf + (i + sread) * ss, NULL);
+        }
+    DISK_CACHE_UNLOCK;
+    i += run;
+    }
+if (sectsread)
+    *sectsread = sects;
+return SCPE_OK;
+}
+
+/* Write sectors into the cache in WRITEBACK mode.  FALSE means that they
+   should be written to the container. */
+
+static t_bool _sim_disk_cache_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_bool stored = TRUE;
+t_seccnt i;
+
+DISK_CACHE_LOCK;
+ctx->cache_file->write_seq++;
+for (i = 0; (i < sects) && stored; i++)
+    stored = _disk_cache_store (uptr, ctx->cache_file, lba + i, buf + i * (size_t)ctx->sector_size, uptr);
+DISK_CACHE_UNLOCK;
+if (stored) {
+    t_offset end_write = ((t_offset)lba + sects) * ctx->sector_size;
+
+    if (ctx->highwater < end_write)
+        ctx->highwater = end_write;
+    }
+return stored;
+}
+
+/* Bring the cached copies up to date after a write to the container */
+
+static void _sim_disk_cache_update (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_seccnt i;
+
+DISK_CACHE_LOCK;
+ctx->cache_file->write_seq++;
+for (i = 0; i < sects; i++)
+    if (!_disk_cache_store (uptr, ctx->cache_file, lba + i, buf + i * (size_t)ctx->sector_size, NULL)) {
+        DISK_CACHE_ENTRY *e = _disk_cache_find (ctx->cache_file, lba + i);
+
+        if (e)                                          /* can't hold the new data? */
+            _disk_cache_remove (e);
+        }
+DISK_CACHE_UNLOCK;
+}
+
+/* Write back the sectors that this unit has modified */
+
+static void _sim_disk_cache_flush (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+DISK_CACHE_ENTRY *e;
+
+if ((ctx == NULL) || (ctx->cache_dirty == 0))
+    return;
+DISK_CACHE_LOCK;
+for (e = disk_cache.head; (e != NULL) && (ctx->cache_dirty > 0); e = e->next)
+    if (e->dirty == uptr)
+        _disk_cache_writeback (e);
+DISK_CACHE_UNLOCK;
+}
+
+static void _sim_disk_cache_attach (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+DISK_CACHE_FILE *file;
+struct stat statb;
+
+if (ctx->removable || ctx->is_cdrom || ctx->map ||      /* unsuitable unit? */
+    (uptr->flags & UNIT_BUFABLE) ||
+    (sim_stat (uptr->filename, &statb) != 0))
+    return;
+DISK_CACHE_LOCK;
+for (file = disk_cache.files; file != NULL; file = file->next)
+    if ((statb.st_ino != 0) && (file->dev == statb.st_dev) && (file->ino == statb.st_ino))
+        break;
+if (file == NULL) {
+    file = (DISK_CACHE_FILE *)calloc (1, sizeof (*file));
+    if (file != NULL) {
+        file->dev = statb.st_dev;
+        file->ino = statb.st_ino;
+        file->sector_size = ctx->sector_size;
+        file->xfer_element_size = ctx->xfer_element_size;
+        file->next = disk_cache.files;
+        disk_cache.files = file;
+        }
+    }
+if ((file != NULL) &&                                   /* the cached data is in a */
+    (file->sector_size == ctx->sector_size) &&          /* layout the unit can use? */
+    (file->xfer_element_size == ctx->xfer_element_size)) {
+    file->users++;
+    ctx->cache_file = file;
+    }
+DISK_CACHE_UNLOCK;
+}
+
+static void _sim_disk_cache_detach (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+DISK_CACHE_FILE *file = ctx->cache_file;
+DISK_CACHE_FILE **pf;
+DISK_CACHE_ENTRY *e, *next;
+
+if (file == NULL)
+    return;
+_sim_disk_cache_flush (uptr);
+DISK_CACHE_LOCK;
+ctx->cache_file = NULL;
+if (--file->users == 0) {                               /* last user? */
+    for (e = disk_cache.head; e != NULL; e = next) {
+        next = e->next;
+        if (e->file == file)
+            _disk_cache_remove (e);
+        }
+    for (pf = &disk_cache.files; *pf != file; pf = &(*pf)->next)
+        ;
+    *pf = file->next;
+    free (file);
+    }
+DISK_CACHE_UNLOCK;
+}
+
+/* Flush all modified sectors (with no unit I/O in progress) */
+
+static void _sim_disk_cache_flush_all (void)
+{
+DEVICE *dptr;
+uint32 i, j;
+
+for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {
+    if (DEV_TYPE (dptr) != DEV_DISK)
+        continue;
+    for (j = 0; j < dptr->numunits; j++) {
+        UNIT *uptr = &dptr->units[j];
+
+        if ((uptr->flags & UNIT_ATT) && (uptr->io_flush == _sim_disk_io_flush))
+            _sim_disk_io_flush (uptr);
+        }
+    }
+}
+
+static t_stat _sim_disk_cache_resize (t_offset size)
+{
+DISK_CACHE_ENTRY **hash = NULL;
+DISK_CACHE_ENTRY *e;
+uint32 hash_size = 1024;
+
+_sim_disk_cache_flush_all ();
+if (size > 0) {
+    while (((t_offset)hash_size * 4096 < size) && (hash_size < 0x40000000))
+        hash_size *= 2;                                 /* a chain per 4KB */
+    hash = (DISK_CACHE_ENTRY **)calloc (hash_size, sizeof (*hash));
+    if (hash == NULL)
+        return SCPE_MEM;
+    }
+DISK_CACHE_LOCK;
+disk_cache.size = size;
+_disk_cache_evict (NULL, 0);
+free (disk_cache.hash);
+disk_cache.hash = hash;
+disk_cache.hash_mask = hash_size - 1;
+for (e = disk_cache.head; e != NULL; e = e->next) {     /* rehash what remains */
+    uint32 h = _disk_cache_hash (e->file, e->lba);
+
+    e->hnext = hash[h];
+    hash[h] = e;
+    }
+if (size == 0) {
+    disk_cache.hits = disk_cache.misses = disk_cache.writebacks = 0;
+    disk_cache.hash_mask = 0;
+    }
+DISK_CACHE_UNLOCK;
+return SCPE_OK;
+}
+
+/* Group commit
+
+   SET DISK SYNC=msec makes disk writes durable without a host sync for
+   each of them.  The first write after a commit starts an interval of
+   msec milliseconds; at the end of it every disk unit written since its
+   last commit has its buffered data flushed and its container synced to
+   stable storage, so one sync covers all of the writes in the interval.
+   Guest visible barriers (MSCP FLUSH, SCSI SYNCHRONIZE CACHE) call
+   sim_disk_sync, which commits the unit at once and waits for it.  SET
+   DISK NOSYNC (the default) leaves the timing of writes to the host.
+
+   In asynchronous I/O builds the interval commits hand the sync itself
+   to a flusher thread, on a duplicate of the container's file
+   descriptor, so the simulator doesn't wait for the host disk.
+*/
+
+static t_stat _sim_disk_sync_svc (UNIT *uptr);
+static const char *_sim_disk_sync_description (DEVICE *dptr)
+{
+return "Disk group commit";
+}
+
+static UNIT sim_disk_sync_unit = { UDATA (&_sim_disk_sync_svc, 0, 0) };
+static DEVICE sim_disk_sync_dev = {
+    "INT-DISKSYNC", &sim_disk_sync_unit, NULL, NULL,
+    1, 0, 0, 0, 0, 0,
+    NULL, NULL, NULL, NULL, NULL, NULL,
+    NULL, DEV_NOSAVE, 0,
+    NULL, NULL, NULL, NULL, NULL, NULL,
+    _sim_disk_sync_description};
+
+static struct {
+    uint32              interval;           /* msec, 0 when disabled */
+    t_bool              registered;         /* sim_disk_sync_dev registered */
+    double              commits;            /* unit commits at the end of an interval */
+    double              barriers;           /* unit commits requested by the guest */
+#if defined (SIM_ASYNCH_IO)
+    t_bool              started;            /* flusher thread running */
+    pthread_t           thread;
+    int                 *fds;               /* descriptors waiting to be synced */
+    int                 nfds;
+    int                 fds_size;
+#endif
+    } disk_sync;
+
+#if defined (SIM_ASYNCH_IO)
+static pthread_mutex_t disk_sync_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t disk_sync_work = PTHREAD_COND_INITIALIZER;
+
+static void *_disk_sync_flusher (void *arg)
+{
+pthread_mutex_lock (&disk_sync_lock);
+while (1) {
+    int fd;
+
+    while (disk_sync.nfds == 0)
+        pthread_cond_wait (&disk_sync_work, &disk_sync_lock);
+    fd = disk_sync.fds[--disk_sync.nfds];
+    pthread_mutex_unlock (&disk_sync_lock);
+    _disk_fsync (fd);
+    _disk_close (fd);
+    pthread_mutex_lock (&disk_sync_lock);
+    }
+return NULL;
+}
+
+/* Queue a duplicate of fd for the flusher thread, FALSE if it can't be */
+
+static t_bool _disk_sync_queue (int fd)
+{
+t_bool queued = FALSE;
+
+pthread_mutex_lock (&disk_sync_lock);
+if (!disk_sync.started &&
+    (pthread_create (&disk_sync.thread, NULL, _disk_sync_flusher, NULL) == 0)) {
+    pthread_detach (disk_sync.thread);
+    disk_sync.started = TRUE;
+    }
+if (disk_sync.started && (disk_sync.nfds == disk_sync.fds_size)) {
+    int *fds = (int *)realloc (disk_sync.fds, (disk_sync.fds_size + 8) * sizeof (*fds));
+
+    if (fds != NULL) {
+        disk_sync.fds = fds;
+        disk_sync.fds_size += 8;
+        }
+    }
+if (disk_sync.started && (disk_sync.nfds < disk_sync.fds_size) &&
+    ((fd = _disk_dup (fd)) >= 0)) {
+    disk_sync.fds[disk_sync.nfds++] = fd;
+    pthread_cond_signal (&disk_sync_work);
+    queued = TRUE;
+    }
+pthread_mutex_unlock (&disk_sync_lock);
+return queued;
+}
+#endif
+
+/* Commit a unit's writes.  A barrier (wait TRUE) flushes everything the
+   unit buffers and syncs before returning.  Otherwise a plain container's
+   stream is flushed in place, without stopping its asynchronous I/O. */
+
+static void _sim_disk_commit (UNIT *uptr, t_bool wait)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+uint32 f = DK_GET_FMT (uptr);
+FILE *file = NULL;
+
+ctx->sync_writes = ctx->write_count;
+if (wait || ctx->cache_dirty || (f != DKUF_F_STD)
+#if defined (SIM_DISK_MMAP)
+    || ctx->map
+#endif
+    )
+    _sim_disk_io_flush (uptr);                          /* includes the RAW device sync */
+else
+    fflush (uptr->fileref);
+switch (f) {
+    case DKUF_F_STD:                                    /* Simh */
+    case DKUF_F_SIMHZ:                                  /* Compressed */
+        file = uptr->fileref;
+        break;
+    case DKUF_F_VHD:                                    /* Virtual Disk */
+        file = sim_vhd_disk_file (uptr->fileref);
+        break;
+        }
+if (file == NULL)
+    return;
+#if defined (SIM_ASYNCH_IO)
+if (!wait && _disk_sync_queue (_disk_fileno (file)))
+    return;
+#endif
+_disk_fsync (_disk_fileno (file));
+}
+
+static t_stat _sim_disk_sync_svc (UNIT *unotused)
+{
+uint32 i, j;
+DEVICE *dptr;
+
+for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {
+    if (DEV_TYPE (dptr) != DEV_DISK)
+        continue;
+    for (j = 0; j < dptr->numunits; j++) {
+        UNIT *uptr = &dptr->units[j];
+        struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+        if ((uptr->flags & UNIT_ATT) && (uptr->io_flush == _sim_disk_io_flush) &&
+            (ctx->write_count != ctx->sync_writes)) {
+            _sim_disk_commit (uptr, FALSE);
+            disk_sync.commits += 1;
+            }
+        }
+    }
+return SCPE_OK;
+}
+
+/* Start an interval after a write, if one isn't running */
+
+static void _sim_disk_sync_schedule (void)
+{
+if (disk_sync.interval && !sim_is_active (&sim_disk_sync_unit))
+    sim_activate_after (&sim_disk_sync_unit, disk_sync.interval * 1000);
+}
+
+/* Guest write barrier: make the unit's writes durable now */
+
+t_stat sim_disk_sync (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+if (!(uptr->flags & UNIT_ATT) || (uptr->io_flush != _sim_disk_io_flush))
+    return SCPE_UNATT;
+if (disk_sync.interval && (ctx->write_count != ctx->sync_writes)) {
+    _sim_disk_commit (uptr, TRUE);
+    disk_sync.barriers += 1;
+    }
+return SCPE_OK;
+}
+
+/* SET DISK COMPACT=<unit> */
+
+static t_stat _sim_disk_compact (CONST char *cptr)
+{
+UNIT *uptr = NULL;
+DEVICE *dptr = find_unit (cptr, &uptr);
+struct disk_context *ctx;
+t_offset old_size = 0, new_size = 0;
+struct stat statb;
+t_stat r;
+
+if ((dptr == NULL) || (uptr == NULL))
+    return sim_messagef (SCPE_NXUN, "Non-existent unit: %s\n", cptr);
+if (!(uptr->flags & UNIT_ATT) || (uptr->io_flush != _sim_disk_io_flush))
+    return sim_messagef (SCPE_UNATT, "%s: not an attached disk\n", sim_uname (uptr));
+if (DK_GET_FMT (uptr) != DKUF_F_SIMHZ)
+    return sim_messagef (SCPE_ARG, "%s: not attached to a SIMHZ container\n", sim_uname (uptr));
+ctx = (struct disk_context *)uptr->disk_ctx;
+_sim_disk_io_flush (uptr);                              /* write back everything buffered */
+#if defined (SIM_ASYNCH_IO)
+sim_disk_clr_async (uptr);
+#endif
+r = sim_disk_simhz_compact (uptr->fileref, &old_size, &new_size);
+#if defined (SIM_ASYNCH_IO)
+if (sim_asynch_enabled)
+    sim_disk_set_async (uptr, ctx->asynch_io_latency);
+#endif
+if (r != SCPE_OK)
+    return sim_messagef (r, "%s: Can't compact '%s': %s\n", sim_uname (uptr), uptr->filename, sim_error_text (r));
+if (ctx->cache_file && (sim_stat (uptr->filename, &statb) == 0)) {
+    DISK_CACHE_LOCK;
+    ctx->cache_file->dev = statb.st_dev;                /* the container is a new file */
+    ctx->cache_file->ino = statb.st_ino;
+    DISK_CACHE_UNLOCK;
+    }
+return sim_messagef (SCPE_OK, "%s: compacted '%s' from %uKB to %uKB\n", sim_uname (uptr), uptr->filename,
+                                 (uint32)(old_size >> 10), (uint32)(new_size >> 10));
+}
+
+/* SET DISK CACHE=size{K|M|G}, NOCACHE, WRITEBACK, WRITETHROUGH, SYNC{=msec},
+   NOSYNC and COMPACT=<unit> */
+
+t_stat sim_disk_set_cache (int32 flag, CONST char *cptr)
+{
+char gbuf[CBUFSIZE];
+char *cvptr;
+t_stat r;
+
+if ((cptr == NULL) || (*cptr == 0))
+    return SCPE_2FARG;
+while (*cptr != 0) {
+    cptr = get_glyph (cptr, gbuf, ',');
+    if ((cvptr = strchr (gbuf, '=')))
+        *cvptr++ = 0;
+    if (MATCH_CMD (gbuf, "CACHE") == 0) {
+        char *tptr;
+        t_offset size;
+
+        if ((cvptr == NULL) || (*cvptr == 0))
+            return sim_messagef (SCPE_2FARG, "Missing cache size\n");
+        size = (t_offset)strtotv (cvptr, (CONST char **)&tptr, 10);
+        if (tptr == cvptr)
+            return sim_messagef (SCPE_ARG, "Invalid cache size: %s\n", cvptr);
+        switch (*tptr) {
+            case 'K':
+                size <<= 10;
+                ++tptr;
+                break;
+            case 'G':
+                size <<= 30;
+                ++tptr;
+                break;
+            case 'M':
+                ++tptr;
+                /* fall through */
+            default:
+                size <<= 20;                            /* megabytes by default */
+                break;
+            }
+        if ((*tptr == 'B') && (tptr[-1] != 'B'))
+            ++tptr;
+        if ((*tptr != 0) || (size <= 0))
+            return sim_messagef (SCPE_ARG, "Invalid cache size: %s\n", cvptr);
+        r = _sim_disk_cache_resize (size);
+        if (r != SCPE_OK)
+            return r;
+        }
+    else if (MATCH_CMD (gbuf, "NOCACHE") == 0)
+        _sim_disk_cache_resize (0);
+    else if (MATCH_CMD (gbuf, "COMPACT") == 0) {
+        if ((cvptr == NULL) || (*cvptr == 0))
+            return sim_messagef (SCPE_2FARG, "Missing unit to compact\n");
+        r = _sim_disk_compact (cvptr);
+        if (r != SCPE_OK)
+            return r;
+        }
+    else if (MATCH_CMD (gbuf, "WRITEBACK") == 0)
+        disk_cache.writeback = TRUE;
+    else if (MATCH_CMD (gbuf, "WRITETHROUGH") == 0) {
+        _sim_disk_cache_flush_all ();
+        disk_cache.writeback = FALSE;
+        }
+    else if (MATCH_CMD (gbuf, "SYNC") == 0) {
+        uint32 msec = 1000;                             /* a second by default */
+
+        if ((cvptr != NULL) && (*cvptr != 0)) {
+            msec = (uint32) get_uint (cvptr, 10, 3600000, &r);
+            if ((r != SCPE_OK) || (msec == 0))
+                return sim_messagef (SCPE_ARG, "Invalid sync interval: %s\n", cvptr);
+            }
+        if (!disk_sync.registered) {
+            sim_register_internal_device (&sim_disk_sync_dev);
+            disk_sync.registered = TRUE;
+            }
+        disk_sync.interval = msec;
+        }
+    else if (MATCH_CMD (gbuf, "NOSYNC") == 0) {
+        if (sim_is_active (&sim_disk_sync_unit)) {      /* commit what's pending */
+            sim_cancel (&sim_disk_sync_unit);
+            _sim_disk_sync_svc (&sim_disk_sync_unit);
+            }
+        disk_sync.interval = 0;
+        }
+    else if (MATCH_CMD (gbuf, "DISCARD") == 0)
+        sim_disk_discard_zeros = TRUE;
+    else if (MATCH_CMD (gbuf, "NODISCARD") == 0)
+        sim_disk_discard_zeros = FALSE;
+    else
+        return sim_messagef (SCPE_ARG, "Unknown SET DISK argument: %s\n", gbuf);
+    }
+return SCPE_OK;
+}
+
+/* SHOW DISK */
+
+t_stat sim_disk_show_cache (FILE *st, DEVICE *dnotused, UNIT *unotused, int32 flag, CONST char *cptr)
+{
+double lookups = disk_cache.hits + disk_cache.misses;
+
+fprintf (st, "Zeroed disk sectors are %s\n", sim_disk_discard_zeros ? "released to the host (DISCARD)" : "written (NODISCARD)");
+if (disk_sync.interval)
+    fprintf (st, "Disk writes are committed every %u msec, %.0f interval and %.0f barrier commits\n",
+                 disk_sync.interval, disk_sync.commits, disk_sync.barriers);
+else
+    fprintf (st, "Disk writes are committed by the host (NOSYNC)\n");
+if (disk_cache.size == 0) {
+    fprintf (st, "Disk sector cache disabled\n");
+    return SCPE_OK;
+    }
+if (disk_cache.size & ((1 << 20) - 1))
+    fprintf (st, "Disk sector cache: %dKB", (int)(disk_cache.size >> 10));
+else
+    fprintf (st, "Disk sector cache: %dMB", (int)(disk_cache.size >> 20));
+fprintf (st, " %s, %u sectors (%dKB) cached\n", disk_cache.writeback ? "write-back" : "write-through",
+             disk_cache.entries, (int)(disk_cache.used >> 10));
+if (lookups > 0)
+    fprintf (st, "  %.0f hits, %.0f misses, %.1f%% hit rate, %.0f sectors written back\n",
+                 disk_cache.hits, disk_cache.misses, (100.0 * disk_cache.hits) / lookups, disk_cache.writebacks);
+if (disk_cache.readahead > 0)
+    fprintf (st, "  %.0f sectors read ahead with their tracks\n", disk_cache.readahead);
+return SCPE_OK;
+}
+
+/* Set the number of sectors per track read together on a cache miss */
+
+t_stat sim_disk_set_track (UNIT *uptr, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+if (!(uptr->flags & UNIT_ATT) || (ctx == NULL))
+    return SCPE_UNATT;
+ctx->track_sects = (sects > 1) ? sects : 0;
+return SCPE_OK;
+}
+
+/* Cache statistics for SHOW <unit>, NULL if the unit isn't using the cache */
+
+const char *sim_disk_cache_stats (UNIT *uptr)
+{
+static char buf[64];
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+double lookups;
+
+if ((disk_cache.size == 0) || !(uptr->flags & UNIT_ATT) ||
+    (uptr->io_flush != _sim_disk_io_flush) || (ctx->cache_file == NULL))
+    return NULL;
+lookups = (double)ctx->cache_hits + (double)ctx->cache_misses;
+if (lookups == 0)
+    return "cache hit rate 0%";
+sprintf (buf, "cache hit rate %.1f%% of %.0f sectors", (100.0 * ctx->cache_hits) / lookups, lookups);
+return buf;
+}
+
+/* Per unit samples for the metrics endpoint (attached disk units) */
+
+void sim_disk_publish_metrics (void)
+{
+int pass;
+
+for (pass = 0; pass < 8; pass++) {
+    DEVICE *dptr;
+    uint32 i, j;
+
+    for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {
+        if (DEV_TYPE (dptr) != DEV_DISK)
+            continue;
+        for (j = 0; j < dptr->numunits; j++) {
+            UNIT *uptr = &dptr->units[j];
+            struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+            char labels[CBUFSIZE];
+
+            if (!(uptr->flags & UNIT_ATT) || (uptr->io_flush != _sim_disk_io_flush))
+                continue;
+            snprintf (labels, sizeof (labels), "unit=\"%s\"", sim_uname (uptr));
+            switch (pass) {
+                case 0:
+                    sim_metric ("simh_disk_reads_total", "counter", ctx->read_count, "unit=\"%s\"", sim_uname (uptr));
+                    break;
+                case 1:
+                    sim_metric ("simh_disk_writes_total", "counter", ctx->write_count, "unit=\"%s\"", sim_uname (uptr));
+                    break;
+                case 2:
+                    sim_metric ("simh_disk_read_bytes_total", "counter", (double)ctx->read_bytes, "unit=\"%s\"", sim_uname (uptr));
+                    break;
+                case 3:
+                    sim_metric ("simh_disk_write_bytes_total", "counter", (double)ctx->write_bytes, "unit=\"%s\"", sim_uname (uptr));
+                    break;
+                case 4:
+                    sim_metric ("simh_disk_cache_hits_total", "counter", (double)ctx->cache_hits, "unit=\"%s\"", sim_uname (uptr));
+                    break;
+                case 5:
+                    sim_latency_publish ("simh_disk_read_latency_seconds", &ctx->read_host, labels);
+                    break;
+                case 6:
+                    sim_latency_publish ("simh_disk_write_latency_seconds", &ctx->write_host, labels);
+                    break;
+                case 7:
+                    sim_latency_publish ("simh_disk_queued_seconds", &ctx->queued, labels);
+                    break;
+                }
+            }
+        }
     }
-return SCPE_OK;
-#endif
 }
 
-/* Read Sectors */
+/* SHOW <dev> STATISTICS for an attached disk unit */
 
-static t_stat _sim_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+t_bool sim_disk_show_statistics (FILE *st, UNIT *uptr, t_bool clear)
 {
-t_offset da;
-uint32 err, tbc;
-size_t i;
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
-sim_debug_unit (ctx->dbit, uptr, "_sim_disk_rdsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), lba, sects);
-
-da = ((t_offset)lba) * ctx->sector_size;
-tbc = sects * ctx->sector_size;
-if (sectsread)
-    *sectsread = 0;
-while (tbc) {
-    size_t sectbytes;
-
-    clearerr (uptr->fileref);
-    err = sim_fseeko (uptr->fileref, da, SEEK_SET);          /* set pos */
-    if (err)
-        return SCPE_IOERR;
-    i = sim_fread (buf, 1, tbc, uptr->fileref);
-    if (i < tbc)                 /* fill */
-        memset (&buf[i], 0, tbc-i);
-    if ((i == 0) &&             /* Reading at or past EOF? */
-        feof (uptr->fileref))   
-        i = tbc;                /* return 0's which have already been filled in buffer */
-    sectbytes = (i / ctx->sector_size) * ctx->sector_size;
-    if (i > sectbytes)
-        sectbytes += ctx->sector_size;
-    if (sectsread)
-        *sectsread += sectbytes / ctx->sector_size;
-    err = ferror (uptr->fileref);
-    if (err)
-        return SCPE_IOERR;
-    tbc -= sectbytes;
-    if ((tbc == 0) || (i == 0))
-        return SCPE_OK;
-    da += sectbytes;
-    buf += sectbytes;
+if (!(uptr->flags & UNIT_ATT) || (uptr->io_flush != _sim_disk_io_flush))
+    return FALSE;
+fprintf (st, "%s: %.0f reads (%.0f bytes), %.0f writes (%.0f bytes)\n", sim_uname (uptr),
+             (double)ctx->read_host.count, (double)ctx->read_bytes,
+             (double)ctx->write_host.count, (double)ctx->write_bytes);
+sim_latency_fprint (st, "Read host time", &ctx->read_host);
+sim_latency_fprint (st, "Write host time", &ctx->write_host);
+sim_latency_fprint (st, "Queued for worker", &ctx->queued);
+if (clear) {
+    ctx->read_bytes = ctx->write_bytes = 0;
+    sim_latency_clear (&ctx->read_host);
+    sim_latency_clear (&ctx->write_host);
+    sim_latency_clear (&ctx->queued);
     }
-return SCPE_OK;
+return TRUE;
 }
 
-t_stat sim_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+static t_stat _sim_disk_do_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
 {
-t_stat r;
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-uint32 f = DK_GET_FMT (uptr);
+t_bool all_present;
 t_seccnt sread = 0;
+t_stat r;
 
 sim_debug_unit (ctx->dbit, uptr, "sim_disk_rdsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), lba, sects);
 
 ctx->read_count++;                                      /* record read operation */
-if ((sects == 1) &&                                     /* Single sector reads */
-    (lba >= (uptr->capac*ctx->capac_factor)/(ctx->sector_size/((ctx->dptr->flags & DEV_SECTORS) ? ctx->sector_size : 1)))) {/* beyond the end of the disk */
-    memset (buf, '\0', ctx->sector_size);               /* are bad block management efforts - zero buffer */
-    if (sectsread)
-        *sectsread = 1;
-    return SCPE_OK;                                     /* return success */
+if (ctx->overlay == NULL) {
+    if (ctx->cache_file && disk_cache.size)
+        return _sim_disk_cache_rdsect (uptr, lba, buf, sectsread, sects);
+    return _sim_disk_container_rdsect (uptr, lba, buf, sectsread, sects);
+    }
+r = _sim_disk_overlay_rdsect (uptr, lba, buf, sects, &all_present);
+if ((r == SCPE_OK) && !all_present) {                   /* need container data? */
+    if (ctx->cache_file && disk_cache.size)
+        r = _sim_disk_cache_rdsect (uptr, lba, buf, &sread, sects);
+    else
+        r = _sim_disk_container_rdsect (uptr, lba, buf, &sread, sects);
+    if (sread < sects)                                  /* overlay may hold sectors past the container's end */
+        memset (buf + sread * (size_t)ctx->sector_size, 0, (sects - sread) * (size_t)ctx->sector_size);
     }
+if (r == SCPE_OK)
+    r = _sim_disk_overlay_rdsect (uptr, lba, buf, sects, NULL);
+if (sectsread)
+    *sectsread = (r == SCPE_OK) ? sects : sread;
+return r;
+}
 
-if ((0 == (ctx->sector_size & (ctx->storage_sector_size - 1))) ||   /* Sector Aligned & whole sector transfers */
-    ((0 == ((lba*ctx->sector_size) & (ctx->storage_sector_size - 1))) &&
-     (0 == ((sects*ctx->sector_size) & (ctx->storage_sector_size - 1)))) ||
-    (f == DKUF_F_STD) || (f == DKUF_F_VHD)) {                       /* or SIMH or VHD formats */
-    switch (f) {                                        /* case on format */
-        case DKUF_F_STD:                                /* SIMH format */
-            r = _sim_disk_rdsect (uptr, lba, buf, &sread, sects);
-            break;
-        case DKUF_F_VHD:                                /* VHD format */
-            r = sim_vhd_disk_rdsect (uptr, lba, buf, &sread, sects);
-            break;
-        case DKUF_F_RAW:                                /* Raw Physical Disk Access */
-            r = sim_os_disk_rdsect (uptr, lba, buf, &sread, sects);
-            break;
-        default:
-            return SCPE_NOFNC;
-        }
-    if (sectsread)
-        *sectsread = sread;
-    sim_buf_swap_data (buf, ctx->xfer_element_size, (sread * ctx->sector_size) / ctx->xfer_element_size);
-    return r;
-    }
-else { /* Unaligned and/or partial sector transfers in RAW mode */
-    size_t tbufsize = sects * ctx->sector_size + 2 * ctx->storage_sector_size;
-    uint8 *tbuf = (uint8*) malloc (tbufsize);
-    t_offset ssaddr = (lba * (t_offset)ctx->sector_size) & ~(t_offset)(ctx->storage_sector_size -1);
-    uint32 soffset = (uint32)((lba * (t_offset)ctx->sector_size) - ssaddr);
-    uint32 bytesread;
+t_stat sim_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_uint64 start = sim_host_nsec ();
+t_seccnt sread = 0;
+t_stat r;
 
-    if (sectsread)
-        *sectsread = 0;
-    if (tbuf == NULL)
-        return SCPE_MEM;
-    r = sim_os_disk_read (uptr, ssaddr, tbuf, &bytesread, tbufsize & ~(ctx->storage_sector_size - 1));
-    sim_buf_swap_data (tbuf + soffset, ctx->xfer_element_size, (bytesread - soffset) / ctx->xfer_element_size);
-    memcpy (buf, tbuf + soffset, sects * ctx->sector_size);
-    if (sectsread) {
-        *sectsread = (bytesread - soffset) / ctx->sector_size;
-        if (*sectsread > sects)
-            *sectsread = sects;
-        }
-    free (tbuf);
-    return r;
-    }
+r = _sim_disk_do_rdsect (uptr, lba, buf, &sread, sects);
+sim_latency_record (&ctx->read_host, sim_host_nsec () - start);
+ctx->read_bytes += (t_uint64)sread * ctx->sector_size;
+if (sectsread)
+    *sectsread = sread;
+return r;
 }
 
 t_stat sim_disk_rdsect_a (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects, DISK_PCALLBACK callback)
@@ -772,6 +3082,19 @@ da = ((t_offset)lba) * ctx->sector_size;
 tbc = sects * ctx->sector_size;
 if (sectswritten)
     *sectswritten = 0;
+if (ctx->map && ((da + tbc) <= ctx->map_size))         /* memory mapped? */
+    return _sim_disk_map_wrsect (uptr, lba, buf, sectswritten, sects);
+#if defined (SIM_DISK_PIO)
+if ((DK_GET_FMT (uptr) != DKUF_F_SIMHZ) &&              /* stream has a file descriptor */
+    (sim_end || (ctx->xfer_element_size == 1))) {       /* and no byte swapping needed? */
+    t_bool ioerr;
+
+    i = _sim_disk_pio (uptr->fileref, buf, tbc, da, TRUE, &ioerr);
+    if (sectswritten)
+        *sectswritten = (t_seccnt)((i + ctx->sector_size - 1)/ctx->sector_size);
+    return ioerr ? SCPE_IOERR : SCPE_OK;
+    }
+#endif
 err = sim_fseeko (uptr->fileref, da, SEEK_SET);          /* set pos */
 if (err)
     return SCPE_IOERR;
@@ -784,12 +3107,10 @@ if (err)
 return SCPE_OK;
 }
 
-t_stat sim_disk_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+static t_stat _sim_disk_do_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-uint32 f = DK_GET_FMT (uptr);
 t_stat r;
-uint8 *tbuf = NULL;
 t_seccnt written = 0;
 
 sim_debug_unit (ctx->dbit, uptr, "sim_disk_wrsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr - ctx->dptr->units), lba, sects);
@@ -826,8 +3147,68 @@ if (uptr->dynflags & UNIT_DISK_CHK) {
             }
         }
     }
+if (ctx->overlay)                                       /* copy-on-write overlay? */
+    return _sim_disk_overlay_wrsect (uptr, lba, buf, sectswritten, sects);
+if (ctx->cache_file && disk_cache.size) {               /* shared sector cache? */
+    if (disk_cache.writeback && _sim_disk_cache_wrsect (uptr, lba, buf, sects)) {
+        if (sectswritten)
+            *sectswritten = sects;
+        return SCPE_OK;
+        }
+    r = _sim_disk_container_wrsect (uptr, lba, buf, &written, sects);
+    if (written > 0)
+        _sim_disk_cache_update (uptr, lba, buf, written);
+    if (sectswritten)
+        *sectswritten = written;
+    return r;
+    }
+return _sim_disk_container_wrsect (uptr, lba, buf, sectswritten, sects);
+}
+
+t_stat sim_disk_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_uint64 start = sim_host_nsec ();
+t_seccnt written = 0;
+t_stat r;
+
+#if defined (SIM_ASYNCH_IO)
+if (AIO_MAIN_THREAD)                                    /* not an I/O worker? */
+#endif
+    _sim_disk_sync_schedule ();
+r = _sim_disk_do_wrsect (uptr, lba, buf, &written, sects);
+sim_latency_record (&ctx->write_host, sim_host_nsec () - start);
+ctx->write_bytes += (t_uint64)written * ctx->sector_size;
+if (sectswritten)
+    *sectswritten = written;
+return r;
+}
+
+/* Write sectors (in memory byte order) to the container */
+
+static t_stat _sim_disk_container_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+uint32 f = DK_GET_FMT (uptr);
+t_stat r;
+uint8 *tbuf = NULL;
+t_seccnt written = 0;
+
+if (sectswritten)
+    *sectswritten = 0;
 switch (f) {                                            /* case on format */
     case DKUF_F_STD:                                    /* SIMH format */
+        if (((((t_offset)lba + sects) * ctx->sector_size <= ctx->highwater) ||  /* within the file? */
+             (ctx->footer &&                                                    /* (the footer follows */
+              (((t_offset)lba + sects) * ctx->sector_size <= ctx->container_size))) && /* the data) */
+            _sim_disk_is_zero (buf, sects * ctx->sector_size) &&
+            _sim_disk_punch (uptr->fileref, (t_offset)lba * ctx->sector_size, (t_offset)sects * ctx->sector_size)) {
+            written = sects;                            /* released rather than written */
+            r = SCPE_OK;
+            break;
+            }
+        /* fall through */
+    case DKUF_F_SIMHZ:                                  /* SIMHZ format (zero clusters take no space) */
         r = _sim_disk_wrsect (uptr, lba, buf, &written, sects);
         break;
     case DKUF_F_VHD:                                    /* VHD format */
@@ -846,7 +3227,10 @@ switch (f) {                                            /* case on format */
         return SCPE_NOFNC;
     }
 if (f == DKUF_F_RAW) {
-    if ((0 == (ctx->sector_size & (ctx->storage_sector_size - 1))) ||   /* Sector Aligned & whole sector transfers */
+    if (ctx->map &&                                                     /* memory mapped? */
+        ((((t_offset)lba + sects) * ctx->sector_size) <= ctx->map_size))
+        r = _sim_disk_map_wrsect (uptr, lba, buf, &written, sects);
+    else if ((0 == (ctx->sector_size & (ctx->storage_sector_size - 1))) ||   /* Sector Aligned & whole sector transfers */
         ((0 == ((lba*ctx->sector_size) & (ctx->storage_sector_size - 1))) &&
          (0 == ((sects*ctx->sector_size) & (ctx->storage_sector_size - 1))))) {
 
@@ -901,6 +3285,7 @@ t_stat r = SCPE_OK;
 AIO_CALLSETUP
     r =  sim_disk_wrsect (uptr, lba, buf, sectswritten, sects);
 AIO_CALL(DOP_WSEC, lba, buf, sectswritten, sects, callback);
+_sim_disk_sync_schedule ();                             /* queued writes count too */
 return r;
 }
 
@@ -911,6 +3296,7 @@ struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 switch (DK_GET_FMT (uptr)) {                            /* case on format */
     case DKUF_F_STD:                                    /* Simh */
     case DKUF_F_VHD:                                    /* VHD format */
+    case DKUF_F_SIMHZ:                                  /* SIMHZ format */
         ctx->media_removed = 1;
         return sim_disk_detach (uptr);
     case DKUF_F_RAW:                                    /* Raw Physical Disk Access */
@@ -925,19 +3311,45 @@ switch (DK_GET_FMT (uptr)) {                            /* case on format */
 t_stat sim_disk_erase (UNIT *uptr)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-uint8 *buf;
-t_lba lba;
 
-if (uptr->flags & UNIT_ATT)
+if (!(uptr->flags & UNIT_ATT))
     return SCPE_UNATT;
+return sim_disk_discard (uptr, 0, (t_seccnt)(ctx->container_size / ctx->sector_size));
+}
+
+/* Discard (zero) a range of sectors.  The zeros go through the normal
+   write path, so the copy-on-write overlay and the sector cache see
+   them, and the container releases the host storage they occupied
+   (see _sim_disk_punch). */
+
+#define DISCARD_CHUNK   (64 * 1024)                     /* bytes of zeros written at a time */
 
-buf = (uint8 *)calloc (1, ctx->storage_sector_size);
+t_stat sim_disk_discard (UNIT *uptr, t_lba lba, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_seccnt chunk, n, written;
+uint8 *buf;
+t_stat r = SCPE_OK;
+
+if (!(uptr->flags & UNIT_ATT))
+    return SCPE_UNATT;
+chunk = DISCARD_CHUNK / ctx->sector_size;
+if (chunk == 0)
+    chunk = 1;
+buf = (uint8 *)calloc (chunk, ctx->sector_size);
 if (buf == NULL)
     return SCPE_MEM;
-for (lba = 0; lba < ctx->container_size / ctx->sector_size; lba++)
-    sim_disk_wrsect (uptr, lba, buf, NULL, 1);          /* write sector */
+while ((sects > 0) && (r == SCPE_OK)) {
+    n = (sects < chunk) ? sects : chunk;
+    written = 0;
+    r = sim_disk_wrsect (uptr, lba, buf, &written, n);
+    if ((r == SCPE_OK) && (written < n))                /* past the end of the container? */
+        break;
+    lba += n;
+    sects -= n;
+    }
 free (buf);
-return SCPE_OK;
+return r;
 }
 
 /*
@@ -947,14 +3359,20 @@ return SCPE_OK;
 static void _sim_disk_io_flush (UNIT *uptr)
 {
 uint32 f = DK_GET_FMT (uptr);
-
-#if defined (SIM_ASYNCH_IO)
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
+#if defined (SIM_ASYNCH_IO)
 sim_disk_clr_async (uptr);
+#endif
+_sim_disk_cache_flush (uptr);                           /* write back cached sectors */
+#if defined (SIM_ASYNCH_IO)
 if (sim_asynch_enabled)
     sim_disk_set_async (uptr, ctx->asynch_io_latency);
 #endif
+#if defined (SIM_DISK_MMAP)
+if (ctx->map)                                           /* write back mapped data */
+    msync (ctx->map, (size_t)ctx->map_size, MS_SYNC);
+#endif
 switch (f) {                                            /* case on format */
     case DKUF_F_STD:                                    /* Simh */
         fflush (uptr->fileref);
@@ -962,6 +3380,9 @@ switch (f) {                                            /* case on format */
     case DKUF_F_VHD:                                    /* Virtual Disk */
         sim_vhd_disk_flush (uptr->fileref);
         break;
+    case DKUF_F_SIMHZ:                                  /* Compressed */
+        sim_disk_simhz_sync (uptr->fileref);            /* write cluster and index */
+        break;
     case DKUF_F_RAW:                                    /* Physical */
         sim_os_disk_flush_raw (uptr->fileref);
         break;
@@ -2264,8 +4685,6 @@ t_offset pseudo_filesystem_size = 0;        /* Dummy file system check return us
 
 typedef t_offset (*FILESYSTEM_CHECK)(UNIT *uptr, uint32, t_bool *);
 
-static t_offset get_filesystem_size (UNIT *uptr, t_bool *readonly)
-{
 static FILESYSTEM_CHECK checks[] = {
     &get_ods2_filesystem_size,
     &get_ods1_filesystem_size,
@@ -2279,6 +4698,171 @@ static FILESYSTEM_CHECK checks[] = {
                                            filesystem */
     NULL
     };
+static const char *check_names[] = {    /* parallels checks[] */
+    "an ODS2 (or ODS5) File system",
+    "an ODS1 File system",
+    "Ultrix partitions",
+    "an ISO 9660 filesystem",
+    "a RSTS File system",
+    "RT11 partitions"
+    };
+#define CHECK_ISO9660   3               /* checks[] index of get_iso9660_filesystem_size */
+
+/* File system probe cache
+
+   The probes above each read several scattered sectors, and an attach
+   asks for the file system size up to 3 times.  The result of the last
+   probe is remembered in the disk context until the unit is next
+   written.  It is also saved in the container's metadata (the simh
+   footer or the VHD footer) keyed by the container file's size and
+   modification time, so that attaching the same unchanged container
+   again doesn't probe at all.  The file times are restored after the
+   metadata is updated, and files modified in the last couple of seconds
+   aren't cached since their modification time can't be relied on to
+   change with the next write.
+
+   The cached record is 32 bytes:
+     0      'P'
+     1      checks[] index + 1, or 0xFF if no file system was found
+     2      0, or the unexpected sector size / 128 it matched with
+     3      0
+     4-11   file system size in bytes
+     12-19  container file size
+     20-27  container file modification time
+     28-31  0
+ */
+
+static void _probe_put64 (uint8 *p, t_uint64 val)
+{
+int i;
+
+for (i = 7; i >= 0; i--, val >>= 8)
+    p[i] = (uint8)val;
+}
+
+static t_uint64 _probe_get64 (const uint8 *p)
+{
+t_uint64 val = 0;
+int i;
+
+for (i = 0; i < 8; i++)
+    val = (val << 8) | p[i];
+return val;
+}
+
+static void _sim_disk_probe_record (UNIT *uptr, const struct stat *statb, uint8 rec[32])
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+memset (rec, 0, 32);
+rec[0] = 'P';
+rec[1] = (ctx->probe_check < 0) ? 0xFF : (uint8)(ctx->probe_check + 1);
+rec[2] = (uint8)(ctx->probe_sector_size / 128);
+_probe_put64 (rec + 4, (t_uint64)ctx->probe_size);
+_probe_put64 (rec + 12, (t_uint64)statb->st_size);
+_probe_put64 (rec + 20, (t_uint64)statb->st_mtime);
+}
+
+/* Return the remembered probe result, loading it from the container's
+   metadata if nothing has been written since attach */
+
+static t_bool _sim_disk_probe_lookup (UNIT *uptr, t_offset *size, t_bool *readonly)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+if (ctx->probe_valid && (ctx->probe_writes != ctx->write_count))
+    ctx->probe_valid = FALSE;
+if (!ctx->probe_valid && (ctx->write_count == 0) && (ctx->footer != NULL) &&
+    (ctx->footer->ProbeCache[0] == 'P')) {
+    const uint8 *rec = ctx->footer->ProbeCache;
+    struct stat statb;
+
+    if ((sim_stat (uptr->filename, &statb) == 0) &&
+        (_probe_get64 (rec + 12) == (t_uint64)statb.st_size) &&
+        (_probe_get64 (rec + 20) == (t_uint64)statb.st_mtime) &&
+        ((rec[1] == 0xFF) || (rec[1] <= sizeof (check_names) / sizeof (check_names[0])))) {
+        ctx->probe_check = (rec[1] == 0xFF) ? -1 : rec[1] - 1;
+        ctx->probe_sector_size = rec[2] * 128;
+        ctx->probe_size = (t_offset)_probe_get64 (rec + 4);
+        ctx->probe_writes = 0;
+        ctx->probe_valid = TRUE;
+        }
+    }
+if (!ctx->probe_valid)
+    return FALSE;
+*size = ctx->probe_size;
+if (readonly)
+    *readonly = sim_disk_wrp (uptr) ||
+                (ctx->probe_check == CHECK_ISO9660) ||
+                ((ctx->probe_check >= 0) && (ctx->probe_sector_size == 0) &&
+                 (NULL != match_ext (uptr->filename, "ISO")));
+if (ctx->probe_check >= 0) {
+    sim_messagef (SCPE_OK, "%s: '%s' Contains %s of %u sectors\n", sim_uname (uptr), uptr->filename,
+                           check_names[ctx->probe_check], (uint32)(ctx->probe_size / 512));
+    if (ctx->probe_sector_size != 0)
+        sim_messagef (SCPE_OK, "%s: with an unexpected sector size of %u bytes instead of %u bytes\n", 
+                               sim_uname (uptr), ctx->probe_sector_size, ctx->sector_size);
+    }
+return TRUE;
+}
+
+static t_offset _sim_disk_probe_remember (UNIT *uptr, t_offset size, int32 check, uint32 sector_size)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+ctx->probe_size = size;
+ctx->probe_check = check;
+ctx->probe_sector_size = sector_size;
+ctx->probe_writes = ctx->write_count;
+ctx->probe_valid = TRUE;
+return size;
+}
+
+/* Save the remembered probe result in a writable container's metadata
+   (at the end of attach) */
+
+static void _sim_disk_probe_save (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct simh_disk_footer *f = ctx->footer;
+struct stat statb;
+uint8 rec[32];
+t_stat r = SCPE_OK;
+
+if (!ctx->probe_valid || (ctx->probe_writes != ctx->write_count) ||
+    (f == NULL) || (uptr->flags & UNIT_RO) ||
+    (sim_stat (uptr->filename, &statb) != 0) ||
+    (statb.st_mtime + 2 > time (NULL)))             /* too recent to be a reliable key? */
+    return;
+_sim_disk_probe_record (uptr, &statb, rec);
+if (memcmp (f->ProbeCache, rec, sizeof (rec)) == 0)
+    return;
+memcpy (f->ProbeCache, rec, sizeof (rec));
+f->Checksum = NtoHl (eth_crc32 (0, f, sizeof (*f) - sizeof (f->Checksum)));
+switch (DK_GET_FMT (uptr)) {                            /* case on format */
+    case DKUF_F_STD:                                    /* SIMH format */
+    case DKUF_F_SIMHZ:                                  /* SIMHZ format */
+        if ((sim_fseeko ((FILE *)uptr->fileref, ctx->container_size, SEEK_SET) != 0) ||
+            (sim_fwrite (f, sizeof (*f), 1, (FILE *)uptr->fileref) != 1) ||
+            (fflush ((FILE *)uptr->fileref) != 0) ||
+            ((DK_GET_FMT (uptr) == DKUF_F_SIMHZ) && (sim_disk_simhz_sync ((FILE *)uptr->fileref) != SCPE_OK)))
+            r = SCPE_IOERR;
+        break;
+    case DKUF_F_VHD:                                    /* VHD format */
+        r = sim_vhd_disk_set_probe (uptr->fileref, rec);
+        break;
+    case DKUF_F_RAW:                                    /* Raw Physical Disk Access */
+        r = sim_os_disk_write (uptr, ctx->container_size, (uint8 *)f, NULL, sizeof (*f));
+        break;
+    default:
+        return;
+    }
+sim_set_file_times (uptr->filename, statb.st_atime, statb.st_mtime);
+sim_debug_unit (ctx->dbit, uptr, "_sim_disk_probe_save(%s) - %s\n", sim_uname (uptr), sim_error_text (r));
+}
+
+static t_offset get_filesystem_size (UNIT *uptr, t_bool *readonly)
+{
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 uint32 saved_sector_size = ctx->sector_size;
 t_offset ret_val = (t_offset)-1;
@@ -2288,6 +4872,8 @@ if (pseudo_filesystem_size != 0) {      /* Dummy file system size mechanism? */
     sim_messagef (SCPE_OK, "%s: '%s' Pseudo File System containing %u %d byte sectors\n", sim_uname (uptr), uptr->filename, (uint32)(pseudo_filesystem_size / ctx->sector_size), ctx->sector_size);
     return pseudo_filesystem_size;
     }
+if (_sim_disk_probe_lookup (uptr, &ret_val, readonly))
+    return ret_val;
 
 for (i = 0; checks[i] != NULL; i++)
     if ((ret_val = checks[i] (uptr, 0, readonly)) != (t_offset)-1) {
@@ -2300,7 +4886,7 @@ for (i = 0; checks[i] != NULL; i++)
             (*readonly == FALSE)        &&
             (NULL != match_ext (uptr->filename, "ISO")))
             *readonly = TRUE;
-        return ret_val;
+        return _sim_disk_probe_remember (uptr, ret_val, i, 0);
         }
 /* 
  * The only known interleaved disk devices have either 256 byte 
@@ -2320,6 +4906,8 @@ for (i = 0; checks[i] != NULL; i++) {
 if ((ret_val != (t_offset)-1) && (ctx->sector_size != saved_sector_size ))
     sim_messagef (SCPE_OK, "%s: with an unexpected sector size of %u bytes instead of %u bytes\n", 
                            sim_uname (uptr), ctx->sector_size, saved_sector_size);
+i = (ret_val != (t_offset)-1) ? i : -1;
+_sim_disk_probe_remember (uptr, ret_val, i, (i < 0) ? 0 : ctx->sector_size);
 ctx->sector_size = saved_sector_size;
 return ret_val;
 }
@@ -2339,6 +4927,7 @@ if (f == NULL)
 sim_debug_unit (ctx->dbit, uptr, "get_disk_footer(%s)\n", sim_uname (uptr));
 switch (DK_GET_FMT (uptr)) {                            /* case on format */
     case DKUF_F_STD:                                    /* SIMH format */
+    case DKUF_F_SIMHZ:                                  /* SIMHZ format */
         container_size = sim_fsize_ex (uptr->fileref);
         if ((container_size != (t_offset)-1) && (container_size > (t_offset)sizeof (*f)) &&
             (sim_fseeko (uptr->fileref, container_size - sizeof (*f), SEEK_SET) == 0) &&
@@ -2380,6 +4969,7 @@ switch (DK_GET_FMT (uptr)) {                            /* case on format */
                 f->SectorCount = NtoHl ((uint32)(container_size / NtoHl (f->SectorSize)));
             container_size += sizeof (*f);      /* Adjust since it is removed below */
             f->AccessFormat = DKUF_F_VHD;
+            memcpy (f->ProbeCache, sim_vhd_disk_get_probe (uptr->fileref), sizeof (f->ProbeCache));
             f->Checksum = NtoHl (eth_crc32 (0, f, sizeof (*f) - sizeof (f->Checksum)));
             }
         break;
@@ -2461,7 +5051,10 @@ memset (f->CreationTime, 0, sizeof (f->CreationTime));
 strlcpy ((char*)f->CreationTime, ctime (&now), sizeof (f->CreationTime));
 memset (f->DeviceName, 0, sizeof (f->DeviceName));
 strlcpy ((char*)f->DeviceName, dptr->name, sizeof (f->DeviceName));
-highwater = sim_fsize_name_ex (uptr->filename);
+if (f->AccessFormat == DKUF_F_SIMHZ)
+    highwater = sim_fsize_ex (uptr->fileref);           /* uncompressed size */
+else
+    highwater = sim_fsize_name_ex (uptr->filename);
 /* Align Initial Highwater to a sector boundary */
 highwater = ((highwater + ctx->sector_size - 1) / ctx->sector_size) * ctx->sector_size;
 f->Highwater[0] = NtoHl ((uint32)(highwater >> 32));
@@ -2471,11 +5064,15 @@ free (ctx->footer);
 ctx->footer = f;
 switch (f->AccessFormat) {
     case DKUF_F_STD:                                    /* SIMH format */
+    case DKUF_F_SIMHZ:                                  /* SIMHZ format */
         if (sim_fseeko ((FILE *)uptr->fileref, total_sectors * ctx->sector_size, SEEK_SET) == 0) {
             sim_fwrite (f, sizeof (*f), 1, (FILE *)uptr->fileref);
             fclose ((FILE *)uptr->fileref);
             sim_set_file_times (uptr->filename, statb.st_atime, statb.st_mtime);
-            uptr->fileref = sim_fopen (uptr->filename, "rb+");
+            if (f->AccessFormat == DKUF_F_SIMHZ)
+                uptr->fileref = sim_disk_simhz_open (uptr->filename, "rb+");
+            else
+                uptr->fileref = sim_fopen (uptr->filename, "rb+");
             }
         break;
     case DKUF_F_VHD:                                    /* VHD format */
@@ -2525,11 +5122,15 @@ f->Highwater[1] = NtoHl ((uint32)(highwater & 0xFFFFFFFF));
 f->Checksum = NtoHl (eth_crc32 (0, f, sizeof (*f) - sizeof (f->Checksum)));
 switch (f->AccessFormat) {
     case DKUF_F_STD:                                    /* SIMH format */
+    case DKUF_F_SIMHZ:                                  /* SIMHZ format */
         if (sim_fseeko ((FILE *)uptr->fileref, total_sectors * ctx->sector_size, SEEK_SET) == 0) {
             sim_fwrite (f, sizeof (*f), 1, (FILE *)uptr->fileref);
             fclose ((FILE *)uptr->fileref);
             sim_set_file_times (uptr->filename, statb.st_atime, statb.st_mtime);
-            uptr->fileref = sim_fopen (uptr->filename, "rb+");
+            if (f->AccessFormat == DKUF_F_SIMHZ)
+                uptr->fileref = sim_disk_simhz_open (uptr->filename, "rb+");
+            else
+                uptr->fileref = sim_fopen (uptr->filename, "rb+");
             }
         break;
     case DKUF_F_VHD:                                    /* VHD format */
@@ -2573,6 +5174,9 @@ t_bool created = FALSE, copied = FALSE, autosized = FALSE;
 t_bool auto_format = FALSE;
 t_offset container_size, filesystem_size, current_unit_size;
 size_t tmp_size = 1;
+t_bool memmap = ((sim_switches & SWMASK ('P')) != 0);
+t_bool overlay = ((sim_switches & (SWMASK ('S') | SWMASK ('R'))) == SWMASK ('S')) && ((uptr->flags & UNIT_RO) == 0);
+t_bool overlay_file = ((sim_switches & SWMASK ('T')) != 0);
 
 if (sim_disk_no_autosize) {
     dontchangecapac = TRUE;
@@ -2611,6 +5215,14 @@ if (sim_switches & SWMASK ('D')) {                      /* create difference dis
     cptr = get_glyph_nc (cptr, gbuf, 0);                /* get spec */
     if (*cptr == 0)                                     /* must be more */
         return SCPE_2FARG;
+    if ((DK_GET_FMT (uptr) == DKUF_F_SIMHZ) || sim_disk_simhz_check (cptr)) {
+        vhd = sim_disk_simhz_create_diff (gbuf, cptr);
+        if (vhd == NULL)
+            return sim_messagef (SCPE_ARG, "Unable to create differencing SIMHZ container: %s - %s\n", gbuf, strerror (errno));
+        fclose (vhd);
+        sim_disk_set_fmt (uptr, 0, "SIMHZ", NULL);
+        return sim_disk_attach (uptr, gbuf, sector_size, xfer_element_size, dontchangecapac, dbit, dtype, pdp11tracksize, completion_delay);
+        }
     vhd = sim_vhd_disk_create_diff (gbuf, cptr);
     if (vhd) {
         sim_vhd_disk_close (vhd);
@@ -2620,7 +5232,8 @@ if (sim_switches & SWMASK ('D')) {                      /* create difference dis
     }
 if (sim_switches & SWMASK ('C')) {                      /* create new disk container & copy contents? */
     char gbuf[CBUFSIZE];
-    const char *dest_fmt = ((DK_GET_FMT (uptr) == DKUF_F_AUTO) || (DK_GET_FMT (uptr) == DKUF_F_VHD)) ? "VHD" : "SIMH";
+    const char *dest_fmt = ((DK_GET_FMT (uptr) == DKUF_F_AUTO) || (DK_GET_FMT (uptr) == DKUF_F_VHD)) ? "VHD" : 
+                           (DK_GET_FMT (uptr) == DKUF_F_SIMHZ) ? "SIMHZ" : "SIMH";
     FILE *dest;
     int saved_sim_switches = sim_switches;
     int32 saved_sim_quiet = sim_quiet;
@@ -2643,13 +5256,17 @@ if (sim_switches & SWMASK ('C')) {                      /* create new disk conta
         return sim_messagef (r, "%s: Cannot open copy source: %s - %s\n", sim_uname (uptr), cptr, sim_error_text (r));
         }
     source_capac = uptr->capac;
+    _sim_disk_cache_detach (uptr);                      /* don't cache the copy's transfers */
     sim_messagef (SCPE_OK, "%s: Creating new %s '%s' disk container copied from '%s'\n", sim_uname (uptr), dest_fmt, gbuf, cptr);
     capac_factor = ((dptr->dwidth / dptr->aincr) >= 32) ? 8 : ((dptr->dwidth / dptr->aincr) == 16) ? 2 : 1; /* capacity units (quadword: 8, word: 2, byte: 1) */
     uptr->capac = target_capac;
     if (strcmp ("VHD", dest_fmt) == 0)
         dest = sim_vhd_disk_create (gbuf, ((t_offset)uptr->capac)*capac_factor*((dptr->flags & DEV_SECTORS) ? 512 : 1));
     else
-        dest = sim_fopen (gbuf, "wb+");
+        if (strcmp ("SIMHZ", dest_fmt) == 0)
+            dest = sim_disk_simhz_open (gbuf, "wb+");
+        else
+            dest = sim_fopen (gbuf, "wb+");
     if (!dest) {
         sim_disk_detach (uptr);
         return sim_messagef (r, "%s: Cannot create %s disk container '%s'\n", sim_uname (uptr), dest_fmt, gbuf);
@@ -2661,6 +5278,12 @@ if (sim_switches & SWMASK ('C')) {                      /* create new disk conta
         t_lba total_sectors = (t_lba)((target_capac*capac_factor)/(sector_size/((dptr->flags & DEV_SECTORS) ? 512 : 1)));
         t_seccnt sects = sectors_per_buffer;
         t_seccnt sects_read;
+        t_lba sects_skipped = 0;
+        t_bool src_holes = (DK_GET_FMT (uptr) == DKUF_F_STD);
+        /* SIMH file holes read as zeros (VHD writes skip zero blocks themselves) */
+        t_bool dest_sparse = (strcmp ("SIMH", dest_fmt) == 0);
+        uint32 start_msec = sim_os_msec ();
+        double elapsed;
 
         if (!copy_buf) {
             if (strcmp ("VHD", dest_fmt) == 0)
@@ -2677,30 +5300,53 @@ if (sim_switches & SWMASK ('C')) {                      /* create new disk conta
                         (t_lba)(((source_capac - target_capac)*capac_factor)/(sector_size/((dptr->flags & DEV_SECTORS) ? 512 : 1))));
             sim_messagef (SCPE_OK, "these additional sectors will be unavailable on the target drive\n");
             }
+        if (dest_sparse &&                              /* size the container up front */
+            (sim_set_fsize (dest, (t_addr)(((t_offset)total_sectors) * sector_size)) != 0))
+            dest_sparse = FALSE;                        /* so skipped sectors read as zeros */
         for (lba = 0; (lba < total_sectors) && (r == SCPE_OK); lba += sects_read) {
             uptr->capac = source_capac;
             sects = sectors_per_buffer;
             if (lba + sects > total_sectors)
                 sects = total_sectors - lba;
+            if (src_holes && dest_sparse) {             /* step over source file holes unread */
+                t_offset data = _sim_disk_next_data (uptr->fileref, ((t_offset)lba) * sector_size);
+                t_lba data_lba = (data == (t_offset)-1) ? total_sectors : (t_lba)(data / sector_size);
+
+                if (data_lba > lba) {
+                    sects_read = (t_seccnt)(((data_lba - lba) > sects) ? sects : (data_lba - lba));
+                    sects_skipped += sects_read;
+                    continue;
+                    }
+                }
             r = sim_disk_rdsect (uptr, lba, copy_buf, &sects_read, sects);
             if ((r == SCPE_OK) && (sects_read > 0)) {
-                uint32 saved_unit_flags = uptr->flags;
-                FILE *save_unit_fileref = uptr->fileref;
-                t_seccnt sects_written;
-
-                sim_disk_set_fmt (uptr, 0, dest_fmt, NULL);
-                uptr->fileref = dest;
-                uptr->capac = target_capac;
-                r = sim_disk_wrsect (uptr, lba, copy_buf, &sects_written, sects_read);
-                uptr->fileref = save_unit_fileref;
-                uptr->flags = saved_unit_flags;
-                if (sects_read != sects_written)
-                    r = SCPE_IOERR;
+                if (dest_sparse && _sim_disk_is_zero (copy_buf, sects_read * sector_size))
+                    sects_skipped += sects_read;        /* destination already reads as zeros */
+                else {
+                    uint32 saved_unit_flags = uptr->flags;
+                    FILE *save_unit_fileref = uptr->fileref;
+                    t_seccnt sects_written;
+
+                    sim_disk_set_fmt (uptr, 0, dest_fmt, NULL);
+                    uptr->fileref = dest;
+                    uptr->capac = target_capac;
+                    r = sim_disk_wrsect (uptr, lba, copy_buf, &sects_written, sects_read);
+                    uptr->fileref = save_unit_fileref;
+                    uptr->flags = saved_unit_flags;
+                    if (sects_read != sects_written)
+                        r = SCPE_IOERR;
+                    }
                 sim_messagef (SCPE_OK, "%s: Copied %u/%u sectors.  %d%% complete.\r", sim_uname (uptr), (uint32)(lba + sects_read), (uint32)total_sectors, (int)((((float)lba)*100)/total_sectors));
                 }
             }
-        if (r == SCPE_OK)
+        elapsed = (sim_os_msec () - start_msec) / 1000.0;
+        if (r == SCPE_OK) {
             sim_messagef (SCPE_OK, "\n%s: Copied %u sectors. Done.\n", sim_uname (uptr), (uint32)total_sectors);
+            if (sects_skipped)
+                sim_messagef (SCPE_OK, "%s: %u zero sectors were skipped\n", sim_uname (uptr), (uint32)sects_skipped);
+            sim_messagef (SCPE_OK, "%s: %.1f seconds, %.1f MB/sec\n", sim_uname (uptr), elapsed,
+                          (((double)total_sectors) * sector_size) / (1000000.0 * ((elapsed > 0.001) ? elapsed : 0.001)));
+            }
         else
             sim_messagef (r, "\n%s: Error copying: %s.\n", sim_uname (uptr), sim_error_text (r));
         if ((r == SCPE_OK) && (sim_switches & SWMASK ('V'))) {
@@ -2806,6 +5452,11 @@ else
 switch (DK_GET_FMT (uptr)) {                            /* case on format */
     case DKUF_F_AUTO:                                   /* SIMH format */
         auto_format = TRUE;
+        if (sim_disk_simhz_check (cptr)) {              /* SIMHZ container? */
+            sim_disk_set_fmt (uptr, 0, "SIMHZ", NULL);  /* set file format to SIMHZ */
+            open_function = sim_disk_simhz_open;
+            break;
+            }
         if (NULL != (uptr->fileref = sim_vhd_disk_open (cptr, "rb"))) { /* Try VHD */
             sim_disk_set_fmt (uptr, 0, "VHD", NULL);    /* set file format to VHD */
             sim_vhd_disk_close (uptr->fileref);         /* close vhd file*/
@@ -2829,6 +5480,12 @@ switch (DK_GET_FMT (uptr)) {                            /* case on format */
         open_function = sim_fopen;
         break;
     case DKUF_F_STD:                                    /* SIMH format */
+        if (sim_disk_simhz_check (cptr)) {              /* SIMHZ container? */
+            sim_disk_set_fmt (uptr, 0, "SIMHZ", NULL);  /* set file format to SIMHZ */
+            open_function = sim_disk_simhz_open;
+            auto_format = TRUE;
+            break;
+            }
         if (NULL != (uptr->fileref = sim_vhd_disk_open (cptr, "rb"))) { /* Try VHD first */
             sim_disk_set_fmt (uptr, 0, "VHD", NULL);    /* set file format to VHD */
             sim_vhd_disk_close (uptr->fileref);         /* close vhd file*/
@@ -2839,6 +5496,27 @@ switch (DK_GET_FMT (uptr)) {                            /* case on format */
             }
         open_function = sim_fopen;
         break;
+    case DKUF_F_SIMHZ:                                  /* SIMHZ format */
+        if (!sim_disk_simhz_check (cptr)) {             /* existing container of another format? */
+            if (NULL != (uptr->fileref = sim_vhd_disk_open (cptr, "rb"))) {
+                sim_disk_set_fmt (uptr, 0, "VHD", NULL);/* set file format to VHD */
+                sim_vhd_disk_close (uptr->fileref);     /* close vhd file*/
+                uptr->fileref = NULL;
+                open_function = sim_vhd_disk_open;
+                auto_format = TRUE;
+                break;
+                }
+            if (NULL != (uptr->fileref = sim_fopen (cptr, "rb"))) {
+                fclose (uptr->fileref);
+                uptr->fileref = NULL;
+                sim_disk_set_fmt (uptr, 0, "SIMH", NULL);/* set file format to SIMH */
+                open_function = sim_fopen;
+                auto_format = TRUE;
+                break;
+                }
+            }
+        open_function = sim_disk_simhz_open;
+        break;
     case DKUF_F_VHD:                                    /* VHD format */
         open_function = sim_vhd_disk_open;
         create_function = sim_vhd_disk_create;
@@ -2874,17 +5552,18 @@ sim_debug_unit (ctx->dbit, uptr, "sim_disk_attach(unit=%d,filename='%s')\n", (in
 ctx->auto_format = auto_format;                         /* save that we auto selected format */
 ctx->storage_sector_size = (uint32)sector_size;         /* Default */
 if ((sim_switches & SWMASK ('R')) ||                    /* read only? */
-    ((uptr->flags & UNIT_RO) != 0)) {
+    ((uptr->flags & UNIT_RO) != 0) || overlay) {        /* or container untouched beneath overlay? */
     if (((uptr->flags & UNIT_ROABLE) == 0) &&           /* allowed? */
-        ((uptr->flags & UNIT_RO) == 0))
+        ((uptr->flags & UNIT_RO) == 0) && !overlay)
         return sim_messagef (_err_return (uptr, SCPE_NORO), "%s: Read Only operation not allowed\n", /* no, error */
                                                         sim_uname (uptr));
     uptr->fileref = open_function (cptr, "rb");         /* open rd only */
     if (uptr->fileref == NULL)                          /* open fail? */
         return sim_messagef (_err_return (uptr, SCPE_OPENERR), "%s: Can't open '%s': %s\n", /* yes, error */
                                             sim_uname (uptr), cptr, strerror (errno));
-    uptr->flags = uptr->flags | UNIT_RO;                /* set rd only */
-    sim_messagef (SCPE_OK, "%s: Unit is read only\n", sim_uname (uptr));
+    uptr->flags = uptr->flags | UNIT_RO;                /* set rd only (until the overlay is in place) */
+    if (!overlay)
+        sim_messagef (SCPE_OK, "%s: Unit is read only\n", sim_uname (uptr));
     }
 else {                                                  /* normal */
     uptr->fileref = open_function (cptr, "rb+");        /* open r/w */
@@ -3302,11 +5981,62 @@ if ((uptr->flags & UNIT_RO) == 0) {
     }
 if (dtype && (created || (autosized && (ctx->footer == NULL))))
     store_disk_footer (uptr, dtype);
+_sim_disk_probe_save (uptr);
+
+ctx = (struct disk_context *)uptr->disk_ctx;            /* may have been reattached above */
+if (memmap && (ctx->map == NULL)) {                     /* memory map requested? */
+#if defined (SIM_DISK_MMAP)
+    struct stat statb;
+    int fd = -1;
+
+    if (DK_GET_FMT (uptr) == DKUF_F_STD) {              /* SIMH container */
+        fflush (uptr->fileref);
+        fd = fileno (uptr->fileref);
+        }
+    else
+        if (DK_GET_FMT (uptr) == DKUF_F_RAW)            /* RAW (fileref is a descriptor) */
+            fd = (int)((long)uptr->fileref);
+    if ((fd < 0) ||
+        (fstat (fd, &statb) != 0) ||
+        (!S_ISREG (statb.st_mode)) ||                   /* only regular files */
+        (ctx->container_size == 0) ||
+        ((t_offset)statb.st_size < ctx->container_size) ||/* which are fully populated */
+        ((t_offset)(size_t)ctx->container_size != ctx->container_size))
+        sim_messagef (SCPE_OK, "%s: container can't be memory mapped, using file I/O\n", sim_uname (uptr));
+    else {
+        void *map = mmap (NULL, (size_t)ctx->container_size,
+                          PROT_READ | ((uptr->flags & UNIT_RO) ? 0 : PROT_WRITE),
+                          MAP_SHARED, fd, 0);
+
+        if (map == MAP_FAILED)
+            sim_messagef (SCPE_OK, "%s: memory mapping failed: %s, using file I/O\n", sim_uname (uptr), strerror (errno));
+        else {
+            ctx->map = (uint8 *)map;
+            ctx->map_size = ctx->container_size;
+            sim_messagef (SCPE_OK, "%s: memory mapping disk container\n", sim_uname (uptr));
+            }
+        }
+#else
+    sim_messagef (SCPE_OK, "%s: memory mapped containers aren't supported on this host, using file I/O\n", sim_uname (uptr));
+#endif
+    }
+
+if (overlay) {
+    t_stat r = _sim_disk_overlay_create (uptr, overlay_file);
+
+    if (r != SCPE_OK) {
+        sim_disk_detach (uptr);
+        return sim_messagef (r, "%s: Can't create copy-on-write overlay: %s\n", sim_uname (uptr), sim_error_text (r));
+        }
+    uptr->flags = uptr->flags & ~UNIT_RO;               /* writes now land in the overlay */
+    sim_messagef (SCPE_OK, "%s: writes go to a %s copy-on-write overlay which is discarded at detach\n", sim_uname (uptr), overlay_file ? "file backed" : "memory");
+    }
 
 #if defined (SIM_ASYNCH_IO)
 sim_disk_set_async (uptr, completion_delay);
 #endif
 uptr->io_flush = _sim_disk_io_flush;
+_sim_disk_cache_attach (uptr);
 
 if (uptr->flags & UNIT_BUFABLE) {                       /* buffer in memory? */
     t_seccnt sectsread;
@@ -3335,6 +6065,85 @@ if (uptr->flags & UNIT_BUFABLE) {                       /* buffer in memory? */
 return SCPE_OK;
 }
 
+/* Prepare an attached unit in a process created by CLONE
+
+   The clone shares the container with the simulator it was forked from
+   (and its other clones), so writes from here on land in a private
+   copy-on-write overlay, just as ATTACH -S arranges.  An overlay which
+   already exists is copied if it is file backed since the file (unlike
+   a memory overlay) would otherwise still be shared.  Containers which
+   are read with an explicit seek are reopened so the clone has a file
+   position of its own.  The parent must not flush modified data to the
+   containers while it has running clones.  SCPE_NOFNC is returned for
+   a unit which sim_disk didn't attach.
+*/
+
+t_stat sim_disk_clone (UNIT *uptr)
+{
+struct disk_context *ctx;
+struct disk_overlay *ov;
+FILE *f;
+t_stat r = SCPE_OK;
+
+if ((uptr == NULL) || !(uptr->flags & UNIT_ATT))
+    return SCPE_UNATT;
+ctx = (struct disk_context *)uptr->disk_ctx;
+if ((ctx == NULL) || (uptr->io_flush != _sim_disk_io_flush))
+    return SCPE_NOFNC;                                  /* not attached by sim_disk */
+ov = ctx->overlay;
+if (ov && ov->file) {                                   /* file backed overlay? */
+    uint8 *buf = (uint8 *)malloc (ov->chunk_bytes);
+    t_offset pos;
+
+    f = tmpfile ();
+    if ((buf == NULL) || (f == NULL) || fflush (ov->file) || sim_fseeko (ov->file, 0, SEEK_SET))
+        r = SCPE_IOERR;
+    for (pos = 0; (r == SCPE_OK) && (pos < ov->file_size); pos += ov->chunk_bytes)
+        if ((fread (buf, 1, ov->chunk_bytes, ov->file) != ov->chunk_bytes) ||
+            (fwrite (buf, 1, ov->chunk_bytes, f) != ov->chunk_bytes))
+            r = SCPE_IOERR;
+    free (buf);
+    if (r != SCPE_OK) {
+        if (f != NULL)
+            fclose (f);
+        return sim_messagef (r, "%s: Can't copy the copy-on-write overlay\n", sim_uname (uptr));
+        }
+    fclose (ov->file);
+    ov->file = f;
+    }
+if (uptr->flags & UNIT_BUF)                             /* data is in (copy-on-write) memory */
+    return SCPE_OK;
+switch (DK_GET_FMT (uptr)) {                            /* private container stream */
+    case DKUF_F_STD:
+        if ((f = sim_fopen (uptr->filename, "rb")) == NULL)
+            r = SCPE_OPENERR;
+        else {
+            fclose (uptr->fileref);
+            uptr->fileref = f;
+            }
+        break;
+    case DKUF_F_SIMHZ:
+        r = sim_disk_simhz_clone (uptr->fileref);
+        break;
+    case DKUF_F_VHD:                                    /* the inherited handle is abandoned */
+        if ((f = sim_vhd_disk_open (uptr->filename, "rb")) == NULL)
+            r = SCPE_OPENERR;                           /* (closing it would write its BAT) */
+        else
+            uptr->fileref = f;
+        break;
+    default:                                            /* physical devices use positional I/O */
+        break;
+        }
+if (r != SCPE_OK)
+    return sim_messagef (r, "%s: Can't reopen %s\n", sim_uname (uptr), uptr->filename);
+if ((ctx->overlay == NULL) && ((uptr->flags & UNIT_RO) == 0)) {
+    r = _sim_disk_overlay_create (uptr, FALSE);
+    if (r != SCPE_OK)
+        return sim_messagef (r, "%s: Can't create copy-on-write overlay: %s\n", sim_uname (uptr), sim_error_text (r));
+    }
+return SCPE_OK;
+}
+
 t_stat sim_disk_detach (UNIT *uptr)
 {
 struct disk_context *ctx;
@@ -3354,6 +6163,7 @@ sim_debug_unit (ctx->dbit, uptr, "sim_disk_detach(unit=%d,filename='%s')\n", (in
 
 switch (DK_GET_FMT (uptr)) {                            /* case on format */
     case DKUF_F_STD:                                    /* Simh */
+    case DKUF_F_SIMHZ:                                  /* Compressed (closing writes the index) */
         close_function = fclose;
         break;
     case DKUF_F_VHD:                                    /* Virtual Disk */
@@ -3372,6 +6182,11 @@ if (!(uptr->flags & UNIT_ATT))                          /* attached? */
 if (NULL == find_dev_from_unit (uptr))
     return SCPE_OK;
 
+if (ctx->overlay) {                                     /* discard copy-on-write overlay */
+    _sim_disk_overlay_free (uptr);
+    uptr->flags = uptr->flags | UNIT_RO;                /* container was opened read only */
+    }
+
 if ((uptr->flags & UNIT_BUF) && (uptr->filebuf)) {
     uint32 cap = (uptr->hwmark + uptr->dptr->aincr - 1) / uptr->dptr->aincr;
 
@@ -3393,8 +6208,15 @@ auto_format = ctx->auto_format;
 
 if (uptr->io_flush)
     uptr->io_flush (uptr);                              /* flush buffered data */
+sim_disk_sync (uptr);                                   /* and commit it if SET DISK SYNC */
 
 sim_disk_clr_async (uptr);
+_sim_disk_cache_detach (uptr);
+
+#if defined (SIM_DISK_MMAP)
+if (ctx->map)
+    munmap (ctx->map, (size_t)ctx->map_size);
+#endif
 
 uptr->flags &= ~(UNIT_ATT | UNIT_RO);
 uptr->dynflags &= ~(UNIT_NO_FIO | UNIT_DISK_CHK);
@@ -3450,6 +6272,9 @@ if (strstr (sim_name, "-10") == NULL) {
     fprintf (st, "           Virtual Hard Disk (VHD) Image Format Specification\".  The\n");
     fprintf (st, "           VHD implementation includes support for 1) Fixed (Preallocated)\n");
     fprintf (st, "           disks, 2) Dynamically Expanding disks, and 3) Differencing disks.\n");
+    fprintf (st, "    SIMHZ  A SIMH disk stored in independently compressed 64KB clusters,\n");
+    fprintf (st, "           with unwritten clusters taking no space.  SIMHZ containers\n");
+    fprintf (st, "           can also be Differencing disks of a SIMH or SIMHZ parent.\n");
     fprintf (st, "    RAW    platform specific access to physical disk or CDROM drives\n\n");
     }
 else {
@@ -3520,7 +6345,8 @@ fprintf (st, "    -C          Create a disk container and copy its contents from
 fprintf (st, "                (simh, VHD, or RAW format).  The current (or specified with -F)\n");
 fprintf (st, "                container format will be the format of the created container.\n");
 fprintf (st, "                AUTO or VHD will create a VHD container, SIMH will create a.\n");
-fprintf (st, "                SIMH container. Add a -V switch to verify a copy operation.\n");
+fprintf (st, "                SIMH container and SIMHZ a SIMHZ container. Add a -V switch to\n");
+fprintf (st, "                verify a copy operation.\n");
 fprintf (st, "                Note: A copy will be performed between dissimilar sized\n");
 fprintf (st, "                containers.  Copying from a larger container to a smaller\n");
 fprintf (st, "                one will produce a truncated result.\n");
@@ -3529,11 +6355,22 @@ fprintf (st, "                operation.\n");
 fprintf (st, "    -X          When creating a VHD, create a fixed sized VHD (vs a Dynamically\n");
 fprintf (st, "                expanding one).\n");
 fprintf (st, "    -D          Create a Differencing VHD (relative to an already existing VHD\n");
-fprintf (st, "                disk)\n");
+fprintf (st, "                disk), or a Differencing SIMHZ container when the format is\n");
+fprintf (st, "                SIMHZ or the parent is a SIMHZ container\n");
 fprintf (st, "    -M          Merge a Differencing VHD into its parent VHD disk\n");
 fprintf (st, "    -O          Override consistency checks when attaching differencing disks\n");
 fprintf (st, "                which have unexpected parent disk GUID or timestamps\n\n");
 fprintf (st, "    -U          Fix inconsistencies which are overridden by the -O switch\n");
+fprintf (st, "    -P          Access a SIMH or RAW format container file through a memory\n");
+fprintf (st, "                mapping rather than with file reads and writes.  The\n");
+fprintf (st, "                container must already be its full size.\n");
+fprintf (st, "    -S          Open the container read only and keep everything written to\n");
+fprintf (st, "                the unit in a copy-on-write overlay.  Reads see the written\n");
+fprintf (st, "                data, but the container is never changed and the overlay is\n");
+fprintf (st, "                discarded when the unit is detached.  Works with any\n");
+fprintf (st, "                container format.\n");
+fprintf (st, "    -T          With -S, keep the overlay data in a temporary file rather\n");
+fprintf (st, "                than in memory.\n");
 if (strstr (sim_name, "-10") == NULL) {
     fprintf (st, "    -Y          Answer Yes to prompt to overwrite last track (on disk create)\n");
     fprintf (st, "    -N          Answer No to prompt to overwrite last track (on disk create)\n");
@@ -3628,6 +6465,7 @@ switch (DK_GET_FMT (uptr)) {                            /* case on format */
     case DKUF_F_STD:                                    /* SIMH format */
     case DKUF_F_VHD:                                    /* VHD format */
     case DKUF_F_RAW:                                    /* Raw Physical Disk Access */
+    case DKUF_F_SIMHZ:                                  /* SIMHZ format */
 #if defined(_WIN32)
         saved_errno = GetLastError ();
 #endif
@@ -3646,6 +6484,7 @@ if (!(uptr->flags & UNIT_ATTABLE))                      /* not attachable? */
     return SCPE_NOATT;
 switch (DK_GET_FMT (uptr)) {                            /* case on format */
     case DKUF_F_STD:                                    /* SIMH format */
+    case DKUF_F_SIMHZ:                                  /* SIMHZ format */
         clearerr (uptr->fileref);
         break;
     case DKUF_F_VHD:                                    /* VHD format */
@@ -4637,6 +7476,11 @@ static void sim_vhd_disk_flush (FILE *f)
 {
 }
 
+static FILE *sim_vhd_disk_file (FILE *f)
+{
+return NULL;
+}
+
 static t_offset sim_vhd_disk_size (FILE *f)
 {
 return (t_offset)-1;
@@ -4664,6 +7508,18 @@ static t_stat sim_vhd_disk_set_dtype (FILE *f, const char *dtype)
 return SCPE_NOFNC;
 }
 
+static t_stat sim_vhd_disk_set_probe (FILE *f, const uint8 probe[32])
+{
+return SCPE_NOFNC;
+}
+
+static const uint8 *sim_vhd_disk_get_probe (FILE *f)
+{
+static const uint8 none[32] = {0};
+
+return none;
+}
+
 static const char *sim_vhd_disk_get_dtype (FILE *f, uint32 *SectorSize, uint32 *xfer_element_size, char sim_name[64], time_t *creation_time)
 {
 *SectorSize = *xfer_element_size = 0;
@@ -4840,9 +7696,14 @@ typedef struct _VHD_Footer {
     uint32 DriveTransferElementSize;
     uint8 CreatingSimulator[64];
     /*
-    This field contains zeroes. It is 328 bytes in size.
+    This field is an extension to the VHD spec and holds a cached simh file
+    system probe result (see get_filesystem_size).
+    */
+    uint8 ProbeCache[32];
+    /*
+    This field contains zeroes. It is 296 bytes in size.
     */
-    uint8 Reserved[328];
+    uint8 Reserved[296];
     } VHD_Footer;
 
 /*
@@ -4984,11 +7845,22 @@ typedef struct VHD_IOData *VHDHANDLE;
 
 static t_stat ReadFilePosition(FILE *File, void *buf, size_t bufsize, uint32 *bytesread, uint64 position)
 {
-uint32 err = sim_fseeko (File, (t_offset)position, SEEK_SET);
+uint32 err;
 size_t i;
 
 if (bytesread)
     *bytesread = 0;
+#if defined (SIM_DISK_PIO)
+if (1) {
+    t_bool ioerr;
+
+    i = _sim_disk_pio (File, buf, bufsize, (t_offset)position, FALSE, &ioerr);
+    if (bytesread)
+        *bytesread = (uint32)i;
+    return (ioerr ? SCPE_IOERR : SCPE_OK);
+    }
+#endif
+err = sim_fseeko (File, (t_offset)position, SEEK_SET);
 if (!err) {
     i = fread (buf, 1, bufsize, File);
     if (bytesread)
@@ -5000,11 +7872,22 @@ return (err ? SCPE_IOERR : SCPE_OK);
 
 static t_stat WriteFilePosition(FILE *File, void *buf, size_t bufsize, uint32 *byteswritten, uint64 position)
 {
-uint32 err = sim_fseeko (File, (t_offset)position, SEEK_SET);
+uint32 err;
 size_t i;
 
 if (byteswritten)
     *byteswritten = 0;
+#if defined (SIM_DISK_PIO)
+if (1) {
+    t_bool ioerr;
+
+    i = _sim_disk_pio (File, buf, bufsize, (t_offset)position, TRUE, &ioerr);
+    if (byteswritten)
+        *byteswritten = (uint32)i;
+    return (ioerr ? SCPE_IOERR : SCPE_OK);
+    }
+#endif
+err = sim_fseeko (File, (t_offset)position, SEEK_SET);
 if (!err) {
     i = fwrite (buf, 1, bufsize, File);
     if (byteswritten)
@@ -5287,20 +8170,27 @@ struct VHD_IOData {
     VHD_Footer Footer;
     VHD_DynamicDiskHeader Dynamic;
     uint32 *BAT;
+    uint32 BATDirtyFirst;       /* first BAT entry not yet written back */
+    uint32 BATDirtyLast;        /* last BAT entry not yet written back */
+    t_bool BATDirty;            /* in memory BAT has been updated */
     FILE *File;
     char ParentVHDPath[512];
     struct VHD_IOData *Parent;
+    struct VHD_IOData **BlockOwner; /* differencing: chain level holding each block */
     };
 
+static t_stat WriteVirtualDiskBAT (VHDHANDLE hVHD);
+
 static t_stat sim_vhd_disk_implemented (void)
 {
 return SCPE_OK;
 }
 
+static t_stat WriteVirtualDiskFooter (VHDHANDLE hVHD);
+
 static t_stat sim_vhd_disk_set_dtype (FILE *f, const char *dtype, uint32 SectorSize, uint32 xfer_element_size)
 {
 VHDHANDLE hVHD  = (VHDHANDLE)f;
-int Status = 0;
 
 memset (hVHD->Footer.DriveType, '\0', sizeof hVHD->Footer.DriveType);
 memcpy (hVHD->Footer.DriveType, dtype, ((1+strlen (dtype)) < sizeof (hVHD->Footer.DriveType)) ? (1+strlen (dtype)) : sizeof (hVHD->Footer.DriveType));
@@ -5309,6 +8199,35 @@ hVHD->Footer.DriveTransferElementSize = NtoHl (xfer_element_size);
 hVHD->Footer.CreatingSimulator[sizeof (hVHD->Footer.CreatingSimulator) - 1] = '\0';  /* Force NUL termination */
 memset (hVHD->Footer.CreatingSimulator, 0, sizeof (hVHD->Footer.CreatingSimulator));
 strlcpy ((char *)hVHD->Footer.CreatingSimulator, sim_name, sizeof (hVHD->Footer.CreatingSimulator));
+return WriteVirtualDiskFooter (hVHD);
+}
+
+static t_stat sim_vhd_disk_set_probe (FILE *f, const uint8 probe[32])
+{
+VHDHANDLE hVHD  = (VHDHANDLE)f;
+t_stat r;
+
+memcpy (hVHD->Footer.ProbeCache, probe, sizeof (hVHD->Footer.ProbeCache));
+r = WriteVirtualDiskFooter (hVHD);
+if ((r == SCPE_OK) && (fflush (hVHD->File) != 0))
+    r = SCPE_IOERR;
+return r;
+}
+
+static const uint8 *sim_vhd_disk_get_probe (FILE *f)
+{
+VHDHANDLE hVHD  = (VHDHANDLE)f;
+
+return hVHD->Footer.ProbeCache;
+}
+
+/* Write the (updated) footer, and on a dynamic disk its copy at the
+   start of the file */
+
+static t_stat WriteVirtualDiskFooter (VHDHANDLE hVHD)
+{
+int Status = 0;
+
 hVHD->Footer.Checksum = 0;
 hVHD->Footer.Checksum = NtoHl (CalculateVhdFooterChecksum (&hVHD->Footer, sizeof(hVHD->Footer)));
 
@@ -5369,6 +8288,43 @@ if (creation_time)
 return (char *)(&hVHD->Footer.DriveType[0]);
 }
 
+/* Resolve, for every data block of a differencing disk, which level of
+   its parent chain holds the data (NULL when no level does and the block
+   reads as zeros).  Parents are opened first, so a differencing parent's
+   map is reused and each level costs one pass over its own BAT.  Reads
+   then go straight to the owning file rather than descending the chain.
+   No map is built (and reads descend the chain as before) when the levels
+   don't share a block layout. */
+static void VHDBuildBlockOwnerMap (VHDHANDLE hVHD)
+{
+VHDHANDLE Parent = hVHD->Parent;
+uint32 Blocks = NtoHl (hVHD->Dynamic.MaxTableEntries);
+t_bool ParentFixed = (NtoHl (Parent->Footer.DiskType) == VHD_DT_Fixed);
+uint32 i;
+
+if (!ParentFixed) {
+    if ((Parent->Dynamic.BlockSize != hVHD->Dynamic.BlockSize) ||
+        (NtoHl (Parent->Dynamic.MaxTableEntries) < Blocks)     ||
+        (Parent->Parent && !Parent->BlockOwner))
+        return;
+    }
+hVHD->BlockOwner = (VHDHANDLE *)calloc (Blocks, sizeof (*hVHD->BlockOwner));
+if (hVHD->BlockOwner == NULL)
+    return;
+for (i = 0; i < Blocks; i++) {
+    if (hVHD->BAT[i] != VHD_BAT_FREE_ENTRY)
+        hVHD->BlockOwner[i] = hVHD;
+    else {
+        if (Parent->BlockOwner)
+            hVHD->BlockOwner[i] = Parent->BlockOwner[i];
+        else {
+            if (ParentFixed || (Parent->BAT[i] != VHD_BAT_FREE_ENTRY))
+                hVHD->BlockOwner[i] = Parent;
+            }
+        }
+    }
+}
+
 static FILE *sim_vhd_disk_open (const char *szVHDPath, const char *DesiredAccess)
     {
     VHDHANDLE hVHD = (VHDHANDLE) calloc (1, sizeof(*hVHD));
@@ -5432,6 +8388,8 @@ static FILE *sim_vhd_disk_open (const char *szVHDPath, const char *DesiredAccess
         Status = errno;
         goto Cleanup_Return;
         }
+    if (hVHD->Parent)
+        VHDBuildBlockOwnerMap (hVHD);
 Cleanup_Return:
     if (Status) {
         sim_vhd_disk_close ((FILE *)hVHD);
@@ -5579,7 +8537,10 @@ VHDHANDLE hVHD = (VHDHANDLE)f;
 if (NULL != hVHD) {
     if (hVHD->Parent)
         sim_vhd_disk_close ((FILE *)hVHD->Parent);
+    if (hVHD->File)
+        WriteVirtualDiskBAT (hVHD);                     /* write back any BAT updates */
     free (hVHD->BAT);
+    free (hVHD->BlockOwner);
     if (hVHD->File) {
         fflush (hVHD->File);
         fclose (hVHD->File);
@@ -5594,8 +8555,17 @@ static void sim_vhd_disk_flush (FILE *f)
 {
 VHDHANDLE hVHD = (VHDHANDLE)f;
 
-if ((NULL != hVHD) && (hVHD->File))
+if ((NULL != hVHD) && (hVHD->File)) {
+    WriteVirtualDiskBAT (hVHD);                         /* write back any BAT updates */
     fflush (hVHD->File);
+    }
+}
+
+static FILE *sim_vhd_disk_file (FILE *f)
+{
+VHDHANDLE hVHD = (VHDHANDLE)f;
+
+return (NULL != hVHD) ? hVHD->File : NULL;
 }
 
 static t_offset sim_vhd_disk_size (FILE *f)
@@ -6169,7 +9139,27 @@ while (BytesToRead && (r == SCPE_OK)) {
 
     if (BlockNumber != (Offset + BytesToRead) / DynamicBlockSize)
         BytesInRead = (uint32)(((BlockNumber + 1) * DynamicBlockSize) - Offset);
-    if (hVHD->BAT[BlockNumber] == VHD_BAT_FREE_ENTRY) {
+    if (hVHD->BlockOwner) {                     /* parent chain resolved at open? */
+        VHDHANDLE Owner = hVHD->BlockOwner[BlockNumber];
+
+        if (Owner == NULL) {
+            memset (buf, 0, BytesInRead);
+            BytesThisRead = BytesInRead;
+            }
+        else {
+            uint64 BlockOffset = Offset;
+
+            if (NtoHl (Owner->Footer.DiskType) != VHD_DT_Fixed)
+                BlockOffset = VHD_Internal_SectorSize * ((uint64)(NtoHl (Owner->BAT[BlockNumber]) + BitMapSectors)) + (Offset % DynamicBlockSize);
+            if (ReadFilePosition(Owner->File,
+                                 buf,
+                                 BytesInRead,
+                                 &BytesThisRead,
+                                 BlockOffset))
+                r = SCPE_IOERR;
+            }
+        }
+    else if (hVHD->BAT[BlockNumber] == VHD_BAT_FREE_ENTRY) {
         if (!hVHD->Parent) {
             memset (buf, 0, BytesInRead);
             BytesThisRead = BytesInRead;
@@ -6241,13 +9231,7 @@ return SCPE_OK;
 static t_bool
 BufferIsZeros(void *Buffer, size_t BufferSize)
 {
-size_t i;
-char *c = (char *)Buffer;
-
-for (i=0; i<BufferSize; ++i)
-    if (c[i])
-        return FALSE;
-return TRUE;
+return _sim_disk_is_zero ((const uint8 *)Buffer, BufferSize);
 }
 
 static t_stat
@@ -6276,6 +9260,12 @@ if (Offset >= (uint64)NtoHll(hVHD->Footer.CurrentSize)) {
     return SCPE_IOERR;
     }
 if (NtoHl(hVHD->Footer.DiskType) == VHD_DT_Fixed) {
+    if (BufferIsZeros(buf, BytesToWrite) &&
+        _sim_disk_punch (hVHD->File, (t_offset)Offset, (t_offset)BytesToWrite)) {
+        if (BytesWritten)
+            *BytesWritten = BytesToWrite;
+        return SCPE_OK;
+        }
     if (WriteFilePosition(hVHD->File,
                           buf,
                           BytesToWrite,
@@ -6307,40 +9297,49 @@ while (BytesToWrite && (r == SCPE_OK)) {
         uint8 *BitMap = NULL;
         uint32 BitMapBufferSize = VHD_DATA_BLOCK_ALIGNMENT;
         uint8 *BitMapBuffer = NULL;
-        void *BlockData = NULL;
-        uint8 *BATUpdateBufferAddress;
-        uint32 BATUpdateBufferSize;
-        uint64 BATUpdateStorageAddress;
+        uint8 *BlockData;
+        uint8 *WriteBuffer;
+        uint32 WriteSize;
         uint64 BlockOffset;
 
         if (!hVHD->Parent && BufferIsZeros(buf, BytesInWrite)) {
             BytesThisWrite = BytesInWrite;
             goto IO_Done;
             }
-        /* Need to allocate a new Data Block. */
+        /* Need to allocate a new Data Block.  The block's bitmap, its
+           complete initial contents (zeros or the parent's data merged with
+           the data being written) and the relocated footer are assembled in
+           memory and written with a single write.  The BAT entry is only
+           updated in memory and written back when the disk is flushed or
+           closed (see WriteVirtualDiskBAT). */
         BlockOffset = sim_fsize_ex (hVHD->File);
         if (((int64)BlockOffset) == -1)
             return SCPE_IOERR;
         if ((BitMapSectors * VHD_Internal_SectorSize) > BitMapBufferSize)
             BitMapBufferSize = BitMapSectors * VHD_Internal_SectorSize;
-        BitMapBuffer = (uint8 *)calloc(1, BitMapBufferSize + DynamicBlockSize);
-        if (BitMapBufferSize > BitMapSectors * VHD_Internal_SectorSize)
-            BitMap = BitMapBuffer + BitMapBufferSize - BitMapBytes;
-        else
-            BitMap = BitMapBuffer;
+        BitMapBuffer = (uint8 *)calloc(1, BitMapBufferSize + DynamicBlockSize + sizeof(hVHD->Footer));
+        if (BitMapBuffer == NULL)
+            return SCPE_MEM;
+        BlockData = BitMapBuffer + BitMapBufferSize;
+        BitMap = BlockData - BitMapSectors * VHD_Internal_SectorSize;
         memset(BitMap, 0xFF, BitMapBytes);
-        BlockOffset -= sizeof(hVHD->Footer);
-        if (0 == (BlockOffset & (VHD_DATA_BLOCK_ALIGNMENT-1)))
-            {  // Already aligned, so use padded BitMapBuffer
-            if (WriteFilePosition(hVHD->File,
-                                  BitMapBuffer,
-                                  BitMapBufferSize + DynamicBlockSize,
-                                  NULL,
-                                  BlockOffset)) {
+        if (hVHD->Parent) { /* Need to populate data block contents from parent VHD */
+            if (ReadVirtualDisk(hVHD->Parent,
+                                BlockData,
+                                DynamicBlockSize,
+                                NULL,
+                                (Offset / DynamicBlockSize) * DynamicBlockSize)) {
                 free (BitMapBuffer);
                 return SCPE_IOERR;
                 }
-            BlockOffset += BitMapBufferSize;
+            }
+        memcpy (BlockData + (size_t)(Offset % DynamicBlockSize), buf, BytesInWrite);
+        memcpy (BlockData + DynamicBlockSize, &hVHD->Footer, sizeof(hVHD->Footer));
+        BlockOffset -= sizeof(hVHD->Footer);
+        if (0 == (BlockOffset & (VHD_DATA_BLOCK_ALIGNMENT-1)))
+            {  // Already aligned, so use padded BitMapBuffer
+            WriteBuffer = BitMapBuffer;
+            WriteSize = BitMapBufferSize + DynamicBlockSize + sizeof(hVHD->Footer);
             }
         else
             {
@@ -6351,80 +9350,55 @@ while (BytesToWrite && (r == SCPE_OK)) {
             BlockOffset += VHD_DATA_BLOCK_ALIGNMENT-1;
             BlockOffset &= ~(VHD_DATA_BLOCK_ALIGNMENT - 1);
             BlockOffset -= BitMapSectors * VHD_Internal_SectorSize;
-            if (WriteFilePosition(hVHD->File,
-                                  BitMap,
-                                  (BitMapSectors * VHD_Internal_SectorSize) + DynamicBlockSize,
-                                  NULL,
-                                  BlockOffset)) {
-                free (BitMapBuffer);
-                return SCPE_IOERR;
-                }
-            BlockOffset += BitMapSectors * VHD_Internal_SectorSize;
-            }
-        free(BitMapBuffer);
-        BitMapBuffer = BitMap = NULL;
-        /* the BAT block address is the beginning of the block bitmap */
-        BlockOffset -= BitMapSectors * VHD_Internal_SectorSize;
-        hVHD->BAT[BlockNumber] = NtoHl((uint32)(BlockOffset / VHD_Internal_SectorSize));
-        BlockOffset += (BitMapSectors * VHD_Internal_SectorSize) + DynamicBlockSize;
-        if (WriteFilePosition(hVHD->File,
-                              &hVHD->Footer,
-                              sizeof(hVHD->Footer),
-                              NULL,
-                              BlockOffset))
-            goto Fatal_IO_Error;
-        /* Since a large VHD can have a pretty large BAT, and we've only changed one longword bat entry
-           in the current BAT, we write just the aligned sector which contains the updated BAT entry */
-        BATUpdateBufferAddress = (uint8 *)hVHD->BAT - (size_t)NtoHll(hVHD->Dynamic.TableOffset) + 
-            (size_t)((((size_t)&hVHD->BAT[BlockNumber]) - (size_t)hVHD->BAT + (size_t)NtoHll(hVHD->Dynamic.TableOffset)) & ~(VHD_DATA_BLOCK_ALIGNMENT-1));
-        /* If the starting of the BAT isn't on a VHD_DATA_BLOCK_ALIGNMENT boundary and we've just updated 
-           a BAT entry early in the array, the buffer computed address might be before the start of the
-           BAT table.  If so, only write the BAT data needed */
-        if (BATUpdateBufferAddress < (uint8 *)hVHD->BAT) {
-            BATUpdateBufferAddress = (uint8 *)hVHD->BAT;
-            BATUpdateBufferSize = (uint32)((((size_t)&hVHD->BAT[BlockNumber]) - (size_t)hVHD->BAT) + 512) & ~511;
-            BATUpdateStorageAddress = NtoHll(hVHD->Dynamic.TableOffset);
+            WriteBuffer = BitMap;
+            WriteSize = (BitMapSectors * VHD_Internal_SectorSize) + DynamicBlockSize + sizeof(hVHD->Footer);
             }
-        else {
-            BATUpdateBufferSize = VHD_DATA_BLOCK_ALIGNMENT;
-            BATUpdateStorageAddress = NtoHll(hVHD->Dynamic.TableOffset) + BATUpdateBufferAddress - ((uint8 *)hVHD->BAT);
-            }
-        /* If the total BAT is smaller than one VHD_DATA_BLOCK_ALIGNMENT, then be sure to only write out the BAT data */
-        if ((size_t)(BATUpdateBufferAddress - (uint8 *)hVHD->BAT + BATUpdateBufferSize) > VHD_Internal_SectorSize * ((sizeof(*hVHD->BAT)*NtoHl(hVHD->Dynamic.MaxTableEntries) + VHD_Internal_SectorSize - 1)/VHD_Internal_SectorSize))
-            BATUpdateBufferSize = (uint32)(VHD_Internal_SectorSize * ((sizeof(*hVHD->BAT) * NtoHl(hVHD->Dynamic.MaxTableEntries) + VHD_Internal_SectorSize - 1)/VHD_Internal_SectorSize) - (BATUpdateBufferAddress - ((uint8 *)hVHD->BAT)));
         if (WriteFilePosition(hVHD->File,
-                              BATUpdateBufferAddress,
-                              BATUpdateBufferSize,
+                              WriteBuffer,
+                              WriteSize,
                               NULL,
-                              BATUpdateStorageAddress))
-            goto Fatal_IO_Error;
-        if (hVHD->Parent)
-            { /* Need to populate data block contents from parent VHD */
-            BlockData = malloc (NtoHl (hVHD->Dynamic.BlockSize));
-
-            if (ReadVirtualDisk(hVHD->Parent,
-                                (uint8*) BlockData,
-                                NtoHl (hVHD->Dynamic.BlockSize),
-                                NULL,
-                                (Offset / NtoHl (hVHD->Dynamic.BlockSize)) * NtoHl (hVHD->Dynamic.BlockSize)))
-                goto Fatal_IO_Error;
-            if (WriteVirtualDisk(hVHD,
-                                 (uint8*) BlockData,
-                                 NtoHl (hVHD->Dynamic.BlockSize),
-                                 NULL,
-                                 (Offset / NtoHl (hVHD->Dynamic.BlockSize)) * NtoHl (hVHD->Dynamic.BlockSize)))
-                goto Fatal_IO_Error;
-            free(BlockData);
+                              BlockOffset)) {
+            free (BitMapBuffer);
+            return SCPE_IOERR;
             }
-        continue;
-Fatal_IO_Error:
-        free (BitMap);
-        free (BlockData);
-        r = SCPE_IOERR;
+        /* the BAT block address is the beginning of the block bitmap */
+        BlockOffset += (BlockData - WriteBuffer) - BitMapSectors * VHD_Internal_SectorSize;
+        free(BitMapBuffer);
+        hVHD->BAT[BlockNumber] = NtoHl((uint32)(BlockOffset / VHD_Internal_SectorSize));
+        if (hVHD->BlockOwner)
+            hVHD->BlockOwner[BlockNumber] = hVHD;
+        if (!hVHD->BATDirty || (BlockNumber < hVHD->BATDirtyFirst))
+            hVHD->BATDirtyFirst = BlockNumber;
+        if (!hVHD->BATDirty || (BlockNumber > hVHD->BATDirtyLast))
+            hVHD->BATDirtyLast = BlockNumber;
+        hVHD->BATDirty = TRUE;
+        BytesThisWrite = BytesInWrite;
         }
     else {
         uint64 BlockOffset = VHD_Internal_SectorSize * ((uint64)(NtoHl(hVHD->BAT[BlockNumber]) + BitMapSectors)) + (Offset % DynamicBlockSize);
 
+        if (BufferIsZeros(buf, BytesInWrite)) {
+            /* A zeroed block of a dynamic disk is deallocated (it then reads
+               as zeros without any I/O) and its storage released.  Otherwise
+               just the zeroed data is released, leaving the block's bitmap
+               (and so any differencing disk's view of the parent) as is. */
+            if (!hVHD->Parent && (BytesInWrite == DynamicBlockSize) &&
+                _sim_disk_punch (hVHD->File, (t_offset)(BlockOffset - BitMapSectors * VHD_Internal_SectorSize),
+                                 (t_offset)(BitMapSectors * VHD_Internal_SectorSize + DynamicBlockSize))) {
+                hVHD->BAT[BlockNumber] = VHD_BAT_FREE_ENTRY;
+                if (!hVHD->BATDirty || (BlockNumber < hVHD->BATDirtyFirst))
+                    hVHD->BATDirtyFirst = BlockNumber;
+                if (!hVHD->BATDirty || (BlockNumber > hVHD->BATDirtyLast))
+                    hVHD->BATDirtyLast = BlockNumber;
+                hVHD->BATDirty = TRUE;
+                BytesThisWrite = BytesInWrite;
+                goto IO_Done;
+                }
+            if (_sim_disk_punch (hVHD->File, (t_offset)BlockOffset, (t_offset)BytesInWrite)) {
+                BytesThisWrite = BytesInWrite;
+                goto IO_Done;
+                }
+            }
         if (WriteFilePosition(hVHD->File,
                               buf,
                               BytesInWrite,
@@ -6443,6 +9417,32 @@ if (BytesWritten)
 return r;
 }
 
+/* Write back the sectors of the BAT which contain entries updated since
+   the last write back */
+
+static t_stat
+WriteVirtualDiskBAT(VHDHANDLE hVHD)
+{
+uint32 BATSize;
+uint32 First, Last;
+
+if (!hVHD->BATDirty)
+    return SCPE_OK;
+BATSize = VHD_Internal_SectorSize * ((sizeof(*hVHD->BAT) * NtoHl(hVHD->Dynamic.MaxTableEntries) + VHD_Internal_SectorSize - 1)/VHD_Internal_SectorSize);
+First = (uint32)((hVHD->BATDirtyFirst * sizeof(*hVHD->BAT)) & ~(VHD_Internal_SectorSize - 1));
+Last = (uint32)(((hVHD->BATDirtyLast * sizeof(*hVHD->BAT)) | (VHD_Internal_SectorSize - 1)) + 1);
+if (Last > BATSize)
+    Last = BATSize;
+if (WriteFilePosition(hVHD->File,
+                      ((uint8 *)hVHD->BAT) + First,
+                      Last - First,
+                      NULL,
+                      NtoHll(hVHD->Dynamic.TableOffset) + First))
+    return SCPE_IOERR;
+hVHD->BATDirty = FALSE;
+return SCPE_OK;
+}
+
 static t_stat
 WriteVirtualDiskSectors(VHDHANDLE hVHD,
                         uint8 *buf,
@@ -6578,6 +9578,10 @@ if (info->flag) {        /* zap type */
         info->stat = sim_messagef (SCPE_OPENERR, "Cannot change the disk type of a VHD container file: %s\n", FullPath);
         return;
         }
+    if (sim_disk_simhz_check (FullPath)) {
+        info->stat = sim_messagef (SCPE_OPENERR, "Cannot change the disk type of a SIMHZ container file: %s\n", FullPath);
+        return;
+        }
     if (sim_stat (FullPath, &statb)) {
         info->stat = sim_messagef (SCPE_OPENERR, "Cannot stat file: '%s' - %s\n", FullPath, strerror (errno));
         return;
@@ -6651,7 +9655,13 @@ if (info->flag == 0) {
     uptr->disk_ctx = &disk_ctx;
     sim_disk_set_fmt (uptr, 0, "VHD", NULL);
     container = sim_vhd_disk_open (FullPath, "r");
-    if (container == NULL) {
+    if ((container == NULL) && sim_disk_simhz_check (FullPath)) {
+        sim_disk_set_fmt (uptr, 0, "SIMHZ", NULL);
+        container = sim_disk_simhz_open (FullPath, "rb");
+        close_function = fclose;
+        size_function = sim_fsize_ex;
+        }
+    else if (container == NULL) {
         sim_disk_set_fmt (uptr, 0, "SIMH", NULL);
         container = sim_fopen (FullPath, "rb+");
         close_function = fclose;
@@ -6721,6 +9731,115 @@ if (stat == SCPE_OK)
 return sim_messagef (SCPE_OK, "No such file or directory: %s\n", cptr);
 }
 
+/* Disk I/O benchmark
+
+   Drives the workload described by the BENCHMARK options through
+   sim_disk_rdsect/sim_disk_wrsect, or through sim_disk_rdsect_a and
+   sim_disk_wrsect_a when ASYNC is requested, just as a device would.
+   SIZE is in sectors.  A WRITE workload rewrites the data already present
+   in each range (read beforehand, untimed) so the disk's contents are
+   preserved.
+
+   Asynchronous requests are serviced by the shared I/O pool.  Since the
+   simulator isn't running, the benchmark waits for the worker to finish,
+   migrates the completion event so the callback is dispatched, and then
+   drops the unit's activation so the device's service routine is never
+   entered. */
+
+static t_bool sim_disk_bench_done;
+static t_stat sim_disk_bench_stat;
+
+static void _sim_disk_bench_callback (UNIT *uptr, t_stat r)
+{
+sim_disk_bench_stat = r;
+sim_disk_bench_done = TRUE;
+}
+
+static t_stat _sim_disk_bench_io (UNIT *uptr, SIM_IO_BENCH *bp, t_lba lba, uint8 *buf, t_seccnt *sects_xfered, t_seccnt sects)
+{
+t_stat r;
+
+if (!bp->async)
+    return bp->write ? sim_disk_wrsect (uptr, lba, buf, sects_xfered, sects) :
+                       sim_disk_rdsect (uptr, lba, buf, sects_xfered, sects);
+sim_disk_bench_done = FALSE;
+sim_disk_bench_stat = SCPE_OK;
+if (bp->write)
+    r = sim_disk_wrsect_a (uptr, lba, buf, sects_xfered, sects, &_sim_disk_bench_callback);
+else
+    r = sim_disk_rdsect_a (uptr, lba, buf, sects_xfered, sects, &_sim_disk_bench_callback);
+#if defined (SIM_ASYNCH_IO)
+if (((struct disk_context *)uptr->disk_ctx)->asynch_io) {
+    _disk_cancel (uptr);                                /* wait for the worker */
+    while (!sim_disk_bench_done)                        /* then dispatch the completion */
+        AIO_UPDATE_QUEUE;
+    sim_cancel (uptr);
+    }
+#endif
+return sim_disk_bench_done ? sim_disk_bench_stat : r;
+}
+
+t_stat sim_disk_benchmark (UNIT *uptr, CONST char *cptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+DEVICE *dptr = find_dev_from_unit (uptr);
+SIM_IO_BENCH bench;
+t_lba total_sectors, span, lba = 0;
+uint8 *buf;
+char title[CBUFSIZE];
+t_stat r;
+
+if (!(uptr->flags & UNIT_ATT) || (ctx == NULL))
+    return sim_messagef (SCPE_UNATT, "%s: not attached\n", sim_uname (uptr));
+r = sim_io_bench_init (&bench, cptr, 1000, 1, (1024 * 1024) / ctx->sector_size);
+if (r != SCPE_OK)
+    return r;
+if (bench.write && (uptr->flags & UNIT_RO)) {
+    sim_io_bench_free (&bench);
+    return sim_messagef (SCPE_RO, "%s: attached read only\n", sim_uname (uptr));
+    }
+if (sim_is_active (uptr)) {
+    sim_io_bench_free (&bench);
+    return sim_messagef (SCPE_ARG, "%s: unit is busy\n", sim_uname (uptr));
+    }
+total_sectors = (t_lba)((((t_offset)uptr->capac) * ctx->capac_factor * ((dptr->flags & DEV_SECTORS) ? 512 : 1)) / ctx->sector_size);
+if (total_sectors < bench.size) {
+    sim_io_bench_free (&bench);
+    return sim_messagef (SCPE_ARG, "%s: SIZE exceeds the disk's %u sectors\n", sim_uname (uptr), (uint32)total_sectors);
+    }
+span = total_sectors - bench.size + 1;
+buf = (uint8 *)calloc (bench.size, ctx->sector_size);
+if (buf == NULL) {
+    sim_io_bench_free (&bench);
+    return SCPE_MEM;
+    }
+#if defined (SIM_ASYNCH_IO)
+if (bench.async && !ctx->asynch_io)
+    sim_printf ("%s: asynchronous I/O is disabled, ASYNC requests will complete synchronously\n", sim_uname (uptr));
+#endif
+srand (0);
+while (bench.done < bench.count) {
+    t_seccnt sects = 0;
+
+    if (bench.random)
+        lba = (t_lba)(((((t_uint64)rand ()) << 16) ^ (t_uint64)rand ()) % span);
+    else
+        if (lba >= span)
+            lba = 0;
+    if (bench.write)                                    /* preserve existing data */
+        sim_disk_rdsect (uptr, lba, buf, NULL, bench.size);
+    sim_io_bench_start (&bench);
+    r = _sim_disk_bench_io (uptr, &bench, lba, buf, &sects, bench.size);
+    sim_io_bench_stop (&bench, ((size_t)sects) * ctx->sector_size, r);
+    lba += bench.size;
+    }
+snprintf (title, sizeof (title), "%s benchmark of %s (%u byte sectors, %u sectors per transfer):", sim_uname (uptr), uptr->filename, (uint32)ctx->sector_size, (uint32)bench.size);
+sim_io_bench_report (&bench, title);
+free (buf);
+sim_io_bench_free (&bench);
+return SCPE_OK;
+}
+
 /* disk testing */
 
 #include <setjmp.h>
@@ -7079,7 +10198,7 @@ return SCPE_OK;
 
 t_stat sim_disk_test (DEVICE *dptr, const char *cptr)
 {
-const char *fmt[] = {"RAW", "VHD", "VHD", "SIMH", NULL};
+const char *fmt[] = {"RAW", "VHD", "VHD", "SIMH", "SIMHZ", NULL};
 uint32 sect_size[] = {576, 4096, 1024, 512, 256, 128, 64, 0};
 uint32 xfr_size[] = {1, 2, 4, 8, 0};
 int x, s, f;
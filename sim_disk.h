@@ -42,12 +42,13 @@ typedef uint32          t_lba;                          /* disk logical block ad
 /* Unit flags */
 
 #define DKUF_V_FMT      (UNIT_V_UF + 0)                 /* disk file format */
-#define DKUF_W_FMT      2                               /* 2b of formats */
+#define DKUF_W_FMT      3                               /* 3b of formats */
 #define DKUF_M_FMT      ((1u << DKUF_W_FMT) - 1)
 #define DKUF_F_AUTO      0                              /* Auto detect format format */
 #define DKUF_F_STD       1                              /* SIMH format */
 #define DKUF_F_RAW       2                              /* Raw Physical Disk Access */
 #define DKUF_F_VHD       3                              /* VHD format */
+#define DKUF_F_SIMHZ     4                              /* SIMHZ compressed format */
 #define DKUF_V_NOAUTOSIZE (DKUF_V_FMT + DKUF_W_FMT)     /* Don't Autosize disk option */
 #define DKUF_V_UF       (DKUF_V_NOAUTOSIZE + 1)
 #define DKUF_WLK        UNIT_WLK
@@ -58,6 +59,7 @@ typedef uint32          t_lba;                          /* disk logical block ad
 #define DK_F_STD        (DKUF_F_STD << DKUF_V_FMT)
 #define DK_F_RAW        (DKUF_F_RAW << DKUF_V_FMT)
 #define DK_F_VHD        (DKUF_F_VHD << DKUF_V_FMT)
+#define DK_F_SIMHZ      (DKUF_F_SIMHZ << DKUF_V_FMT)
 
 #define DK_GET_FMT(u)   (((u)->flags >> DKUF_V_FMT) & DKUF_M_FMT)
 
@@ -103,6 +105,7 @@ t_stat sim_disk_attach_ex2 (UNIT *uptr,
                                                         /* to try and fit the container/file system into */
                              size_t reserved_sectors);  /* Unused sectors beyond the file system */
 t_stat sim_disk_detach (UNIT *uptr);
+t_stat sim_disk_clone (UNIT *uptr);
 t_stat sim_disk_attach_help(FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr);
 t_stat sim_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects);
 t_stat sim_disk_rdsect_a (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects, DISK_PCALLBACK callback);
@@ -110,6 +113,7 @@ t_stat sim_disk_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritte
 t_stat sim_disk_wrsect_a (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects, DISK_PCALLBACK callback);
 t_stat sim_disk_unload (UNIT *uptr);
 t_stat sim_disk_erase (UNIT *uptr);
+t_stat sim_disk_discard (UNIT *uptr, t_lba lba, t_seccnt sects);
 t_stat sim_disk_set_fmt (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat sim_disk_show_fmt (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat sim_disk_set_capac (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
@@ -129,7 +133,15 @@ t_bool sim_disk_raw_support (void);
 void sim_disk_data_trace (UNIT *uptr, const uint8 *data, size_t lba, size_t len, const char* txt, int detail, uint32 reason);
 t_stat sim_disk_info_cmd (int32 flag, CONST char *ptr);
 t_stat sim_disk_set_noautosize (int32 flag, CONST char *cptr);
+t_stat sim_disk_set_cache (int32 flag, CONST char *cptr);
+t_stat sim_disk_show_cache (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
+const char *sim_disk_cache_stats (UNIT *uptr);
+t_stat sim_disk_set_track (UNIT *uptr, t_seccnt sects);
+t_stat sim_disk_sync (UNIT *uptr);
+void sim_disk_publish_metrics (void);
+t_bool sim_disk_show_statistics (FILE *st, UNIT *uptr, t_bool clear);
 t_stat sim_disk_test (DEVICE *dptr, const char *cptr);
+t_stat sim_disk_benchmark (UNIT *uptr, CONST char *cptr);
 
 #ifdef  __cplusplus
 }
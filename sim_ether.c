@@ -384,6 +384,9 @@
 /* Internal routine - forward declaration */
 static int _eth_get_system_id (char *buf, size_t buf_size);
 static void eth_get_nic_hw_addr(ETH_DEV* dev, const char *devname, int set_on);
+#if defined (HAVE_AFPACKET_NETWORK) && (defined (USE_NETWORK) || defined (USE_SHARED))
+static void _eth_afpacket_hw_addr (ETH_DEV *dev, const char *ifname);
+#endif
 
 static const unsigned char framer_oui[3] = { 0xaa, 0x00, 0x03 };
 
@@ -553,26 +556,200 @@ static const uint32 crcTable[256] = {
   0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
 };
 
+/* CRC32 kernels
+
+   eth_crc32 runs over every frame sent or received by the devices which
+   need the FCS appended (DEUNA/DELUA, LANCE, SGEC) as well as over disk
+   metadata, so the byte at a time table lookup is replaced by one of:
+
+     - a carry-less multiply folding kernel (x86 PCLMULQDQ)
+     - the ARMv8 CRC32 instructions
+     - slice-by-8, which consumes 8 bytes per step using 8 derived tables
+
+   The kernel is chosen at first use based on what the host processor
+   supports.  All kernels operate on the pre-inverted CRC state.
+*/
+
+typedef uint32 (*ETH_CRC32_KERNEL)(uint32 crc, const uint8 *buf, size_t len);
+
+static uint32 crcSlice[8][256];                         /* slice-by-8 tables ([0] == crcTable) */
+static uint32 _eth_crc32_select (uint32 crc, const uint8 *buf, size_t len);
+static ETH_CRC32_KERNEL _eth_crc32_kernel = &_eth_crc32_select;
+static const char *_eth_crc32_kernel_name = "Slice-by-8";
+
+static uint32 _eth_crc32_slice8 (uint32 crc, const uint8 *buf, size_t len)
+{
+while ((len > 0) && (((size_t)buf) & 7)) {               /* align to an 8 byte boundary */
+  crc = (crc >> 8) ^ crcSlice[0][(crc ^ *buf++) & 0xFF];
+  --len;
+  }
+while (len >= 8) {
+  uint32 lo = crc ^ ((uint32)buf[0] | ((uint32)buf[1] << 8) | ((uint32)buf[2] << 16) | ((uint32)buf[3] << 24));
+  uint32 hi = (uint32)buf[4] | ((uint32)buf[5] << 8) | ((uint32)buf[6] << 16) | ((uint32)buf[7] << 24);
+
+  crc = crcSlice[7][lo & 0xFF]         ^ crcSlice[6][(lo >> 8) & 0xFF] ^
+        crcSlice[5][(lo >> 16) & 0xFF] ^ crcSlice[4][lo >> 24]         ^
+        crcSlice[3][hi & 0xFF]         ^ crcSlice[2][(hi >> 8) & 0xFF] ^
+        crcSlice[1][(hi >> 16) & 0xFF] ^ crcSlice[0][hi >> 24];
+  buf += 8;
+  len -= 8;
+  }
+while (len-- > 0)
+  crc = (crc >> 8) ^ crcSlice[0][(crc ^ *buf++) & 0xFF];
+return crc;
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ >= 5)))
+#define ETH_CRC32_PCLMUL 1
+#include <wmmintrin.h>
+#include <cpuid.h>
+#define ETH_CRC32_PCLMUL_TARGET __attribute__((target("pclmul,sse2")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_AMD64))
+#define ETH_CRC32_PCLMUL 1
+#include <wmmintrin.h>
+#include <intrin.h>
+#define ETH_CRC32_PCLMUL_TARGET
+#endif
+
+#if defined(ETH_CRC32_PCLMUL)
+/* Fold 16 byte lanes of the message forward using carry-less multiplies
+   by x^(n*8+32) mod P (bit reflected), as described in Intel's "Fast CRC
+   Computation for Generic Polynomials Using PCLMULQDQ Instruction".  The
+   final 16 byte remainder and any tail bytes are finished with slice-by-8
+   instead of a Barrett reduction. */
+
+static int _eth_crc32_have_pclmul (void)
+{
+#if defined(_MSC_VER)
+int regs[4];
+
+__cpuid (regs, 1);
+return (regs[2] & (1 << 1)) != 0;                       /* ECX bit 1 = PCLMULQDQ */
+#else
+unsigned int eax, ebx, ecx, edx;
+
+if (!__get_cpuid (1, &eax, &ebx, &ecx, &edx))
+  return 0;
+return (ecx & bit_PCLMUL) != 0;
+#endif
+}
+
+ETH_CRC32_PCLMUL_TARGET
+static uint32 _eth_crc32_pclmul (uint32 crc, const uint8 *buf, size_t len)
+{
+const __m128i k1k2 = _mm_set_epi32 (0x00000001, 0xC6E41596, 0x00000001, 0x54442BD4); /* fold by 64 bytes */
+const __m128i k3k4 = _mm_set_epi32 (0x00000000, 0xCCAA009E, 0x00000001, 0x751997D0); /* fold by 16 bytes */
+__m128i x0, x1, x2, x3, t;
+uint8 rem[16];
+
+if (len < 64)
+  return _eth_crc32_slice8 (crc, buf, len);
+x0 = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)buf), _mm_cvtsi32_si128 ((int)crc));
+x1 = _mm_loadu_si128 ((const __m128i *)(buf + 16));
+x2 = _mm_loadu_si128 ((const __m128i *)(buf + 32));
+x3 = _mm_loadu_si128 ((const __m128i *)(buf + 48));
+buf += 64;
+len -= 64;
+#define _ETH_FOLD(x, k, data)                                          \
+    t = _mm_clmulepi64_si128 (x, k, 0x11);                             \
+    x = _mm_xor_si128 (_mm_xor_si128 (_mm_clmulepi64_si128 (x, k, 0x00), t), data)
+while (len >= 64) {
+  _ETH_FOLD (x0, k1k2, _mm_loadu_si128 ((const __m128i *)buf));
+  _ETH_FOLD (x1, k1k2, _mm_loadu_si128 ((const __m128i *)(buf + 16)));
+  _ETH_FOLD (x2, k1k2, _mm_loadu_si128 ((const __m128i *)(buf + 32)));
+  _ETH_FOLD (x3, k1k2, _mm_loadu_si128 ((const __m128i *)(buf + 48)));
+  buf += 64;
+  len -= 64;
+  }
+_ETH_FOLD (x0, k3k4, x1);                               /* reduce 4 lanes to 1 */
+_ETH_FOLD (x0, k3k4, x2);
+_ETH_FOLD (x0, k3k4, x3);
+while (len >= 16) {
+  _ETH_FOLD (x0, k3k4, _mm_loadu_si128 ((const __m128i *)buf));
+  buf += 16;
+  len -= 16;
+  }
+#undef _ETH_FOLD
+_mm_storeu_si128 ((__m128i *)rem, x0);
+crc = _eth_crc32_slice8 (0, rem, sizeof (rem));
+return _eth_crc32_slice8 (crc, buf, len);
+}
+#endif /* ETH_CRC32_PCLMUL */
+
+#if defined(__aarch64__) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ >= 10)))
+#define ETH_CRC32_ARMV8 1
+#include <arm_acle.h>
+#if defined(__clang__)
+#define ETH_CRC32_ARMV8_TARGET __attribute__((target("crc")))
+#else
+#define ETH_CRC32_ARMV8_TARGET __attribute__((target("+crc")))
+#endif
+#if defined(__linux__)
+#include <sys/auxv.h>
+#endif
+
+static int _eth_crc32_have_armv8 (void)
+{
+#if defined(__APPLE__) || defined(__ARM_FEATURE_CRC32)
+return 1;                                               /* architecturally present */
+#elif defined(__linux__) && defined(AT_HWCAP)
+return (getauxval (AT_HWCAP) & (1 << 7)) != 0;          /* HWCAP_CRC32 */
+#else
+return 0;
+#endif
+}
+
+ETH_CRC32_ARMV8_TARGET
+static uint32 _eth_crc32_armv8 (uint32 crc, const uint8 *buf, size_t len)
+{
+while ((len > 0) && (((size_t)buf) & 7)) {
+  crc = __crc32b (crc, *buf++);
+  --len;
+  }
+while (len >= 8) {
+  t_uint64 data;
+
+  memcpy (&data, buf, sizeof (data));
+  crc = __crc32d (crc, data);
+  buf += 8;
+  len -= 8;
+  }
+while (len-- > 0)
+  crc = __crc32b (crc, *buf++);
+return crc;
+}
+#endif /* ETH_CRC32_ARMV8 */
+
+static uint32 _eth_crc32_select (uint32 crc, const uint8 *buf, size_t len)
+{
+ETH_CRC32_KERNEL kernel = &_eth_crc32_slice8;
+int i, j;
+
+memcpy (crcSlice[0], crcTable, sizeof (crcSlice[0]));
+for (i = 0; i < 256; i++)
+  for (j = 1; j < 8; j++)
+    crcSlice[j][i] = (crcSlice[j - 1][i] >> 8) ^ crcSlice[0][crcSlice[j - 1][i] & 0xFF];
+#if defined(ETH_CRC32_PCLMUL)
+if (_eth_crc32_have_pclmul ()) {
+  kernel = &_eth_crc32_pclmul;
+  _eth_crc32_kernel_name = "PCLMULQDQ";
+  }
+#endif
+#if defined(ETH_CRC32_ARMV8)
+if (_eth_crc32_have_armv8 ()) {
+  kernel = &_eth_crc32_armv8;
+  _eth_crc32_kernel_name = "ARMv8 CRC32";
+  }
+#endif
+_eth_crc32_kernel = kernel;
+return kernel (crc, buf, len);
+}
+
 uint32 eth_crc32(uint32 crc, const void* vbuf, size_t len)
 {
   const uint32 mask = 0xFFFFFFFF;
-  const unsigned char* buf = (const unsigned char*)vbuf;
 
-  crc ^= mask;
-  while (len > 8) {
-    crc = (crc >> 8) ^ crcTable[ (crc ^ (*buf++)) & 0xFF ];
-    crc = (crc >> 8) ^ crcTable[ (crc ^ (*buf++)) & 0xFF ];
-    crc = (crc >> 8) ^ crcTable[ (crc ^ (*buf++)) & 0xFF ];
-    crc = (crc >> 8) ^ crcTable[ (crc ^ (*buf++)) & 0xFF ];
-    crc = (crc >> 8) ^ crcTable[ (crc ^ (*buf++)) & 0xFF ];
-    crc = (crc >> 8) ^ crcTable[ (crc ^ (*buf++)) & 0xFF ];
-    crc = (crc >> 8) ^ crcTable[ (crc ^ (*buf++)) & 0xFF ];
-    crc = (crc >> 8) ^ crcTable[ (crc ^ (*buf++)) & 0xFF ];
-    len -= 8;
-  }
-  while (0 != len--)
-    crc = (crc >> 8) ^ crcTable[ (crc ^ (*buf++)) & 0xFF ];
-  return(crc ^ mask);
+  return _eth_crc32_kernel (crc ^ mask, (const uint8 *)vbuf, len) ^ mask;
 }
 
 int eth_get_packet_crc32_data(const uint8 *msg, int len, uint8 *crcdata)
@@ -927,6 +1104,67 @@ t_stat eth_show (FILE* st, UNIT* uptr, int32 val, CONST void* desc)
   return SCPE_OK;
 }
 
+/* Per device samples for the metrics endpoint */
+
+void eth_publish_metrics (void)
+{
+  static const struct {
+    const char *name;
+    size_t offset;
+    } dev_metrics[] = {
+    { "simh_eth_tx_packets_total",          offsetof (ETH_DEV, packets_sent) },
+    { "simh_eth_rx_packets_total",          offsetof (ETH_DEV, packets_received) },
+    { "simh_eth_tx_errors_total",           offsetof (ETH_DEV, transmit_packet_errors) },
+    { "simh_eth_rx_errors_total",           offsetof (ETH_DEV, receive_packet_errors) },
+    { "simh_eth_loopback_packets_total",    offsetof (ETH_DEV, loopback_packets_processed) },
+    { "simh_eth_jumbo_fragmented_total",    offsetof (ETH_DEV, jumbo_fragmented) },
+    { "simh_eth_jumbo_dropped_total",       offsetof (ETH_DEV, jumbo_dropped) },
+    { "simh_eth_jumbo_truncated_total",     offsetof (ETH_DEV, jumbo_truncated) },
+    { "simh_eth_throttle_delays_total",     offsetof (ETH_DEV, throttle_count) },
+    };
+  size_t m;
+  int i;
+
+  for (m = 0; m < sizeof (dev_metrics) / sizeof (dev_metrics[0]); m++)
+    for (i = 0; i < eth_open_device_count; i++)
+      sim_metric (dev_metrics[m].name, "counter", *(uint32 *)((char *)eth_open_devices[i] + dev_metrics[m].offset),
+                  "device=\"%s\"", eth_open_devices[i]->dptr->name);
+#if defined (USE_READER_THREAD)
+  for (i = 0; i < eth_open_device_count; i++)
+    sim_metric ("simh_eth_rx_ring_dropped_total", "counter", eth_open_devices[i]->read_ring.loss,
+                "device=\"%s\"", eth_open_devices[i]->dptr->name);
+#endif
+}
+
+/* SHOW <dev> STATISTICS for the Ethernet ports a device has open */
+
+t_bool eth_show_statistics (FILE *st, DEVICE *dptr, t_bool clear)
+{
+  t_bool shown = FALSE;
+  int i;
+
+  for (i = 0; i < eth_open_device_count; i++) {
+    ETH_DEV *dev = eth_open_devices[i];
+
+    if (dev->dptr != dptr)
+      continue;
+    fprintf (st, "%s: %u packets sent, %u packets received on %s\n", dptr->name,
+                 dev->packets_sent, dev->packets_received, dev->name);
+    sim_latency_fprint (st, "Send host time", &dev->tx_host);
+    sim_latency_fprint (st, "Send queued", &dev->tx_queued);
+    sim_latency_fprint (st, "Read host time", &dev->rx_host);
+    sim_latency_fprint (st, "Receive queued", &dev->rx_queued);
+    if (clear) {
+      sim_latency_clear (&dev->tx_host);
+      sim_latency_clear (&dev->tx_queued);
+      sim_latency_clear (&dev->rx_host);
+      sim_latency_clear (&dev->rx_queued);
+      }
+    shown = TRUE;
+    }
+  return shown;
+}
+
 #endif
 /*============================================================================*/
 /*                        Non-implemented versions                            */
@@ -952,10 +1190,14 @@ t_stat eth_set_throttle (ETH_DEV* dev, uint32 time, uint32 burst, uint32 delay)
   {return SCPE_NOFNC;}
 t_stat eth_set_async (ETH_DEV *dev, int latency)
   {return SCPE_NOFNC;}
+t_stat eth_set_async_burst (ETH_DEV *dev, int burst)
+  {return SCPE_NOFNC;}
 t_stat eth_clr_async (ETH_DEV *dev)
   {return SCPE_NOFNC;}
 t_stat eth_write (ETH_DEV* dev, ETH_PACK* packet, ETH_PCALLBACK routine)
   {return SCPE_NOFNC;}
+t_stat eth_writev (ETH_DEV* dev, const ETH_IOVEC* iov, int iovcnt, ETH_IOREAD reader, ETH_PCALLBACK routine)
+  {return SCPE_NOFNC;}
 int eth_read (ETH_DEV* dev, ETH_PACK* packet, ETH_PCALLBACK routine)
   {return SCPE_NOFNC;}
 t_stat eth_filter (ETH_DEV* dev, int addr_count, ETH_MAC* const addresses,
@@ -976,6 +1218,10 @@ t_stat eth_show (FILE* st, UNIT* uptr, int32 val, CONST void* desc)
   fprintf(st, "  network support not available in simulator\n");
   return SCPE_OK;
   }
+void eth_publish_metrics (void)
+  {}
+t_bool eth_show_statistics (FILE *st, DEVICE *dptr, t_bool clear)
+  {return FALSE;}
 static int _eth_get_system_id (char *buf, size_t buf_size)
   {memset (buf, 0, buf_size); return 0;}
 t_stat sim_ether_test (DEVICE *dptr, const char *cptr)
@@ -1001,6 +1247,12 @@ const char *eth_capabilities(void)
 #endif
 #if defined (HAVE_SLIRP_NETWORK)
      ":NAT"
+#endif
+#if defined (HAVE_AFPACKET_NETWORK)
+     ":AFPACKET"
+#endif
+#if defined (HAVE_SHM_NETWORK)
+     ":SHM"
 #endif
      ":UDP";
  }
@@ -1176,6 +1428,22 @@ if (used < max) {
   ++used;
   }
 #endif
+#ifdef HAVE_AFPACKET_NETWORK
+if (used < max) {
+  sprintf(list[used].name, "%s", "afpacket:device");
+  sprintf(list[used].desc, "%s", "Integrated AF_PACKET mmap ring support");
+  list[used].eth_api = ETH_API_AFPACKET;
+  ++used;
+  }
+#endif
+#ifdef HAVE_SHM_NETWORK
+if (used < max) {
+  sprintf(list[used].name, "%s", "shm:switchname");
+  sprintf(list[used].desc, "%s", "Integrated shared memory switch support");
+  list[used].eth_api = ETH_API_SHM;
+  ++used;
+  }
+#endif
 #ifdef HAVE_VDE_NETWORK
 if (used < max) {
   sprintf(list[used].name, "%s", "vde:device{:switch-port-number}");
@@ -1759,6 +2027,12 @@ static void eth_get_nic_hw_addr(ETH_DEV* dev, const char *devname, int set_on)
 {
   memset(&dev->host_nic_phy_hw_addr, 0, sizeof(dev->host_nic_phy_hw_addr));
   dev->have_host_nic_phy_addr = 0;
+#if defined (HAVE_AFPACKET_NETWORK)
+  if (dev->eth_api == ETH_API_AFPACKET) {
+    _eth_afpacket_hw_addr (dev, devname + 9);
+    return;
+    }
+#endif
   if (dev->eth_api != ETH_API_PCAP)
     return;
 #if defined(_WIN32) || defined(__CYGWIN__)
@@ -1919,6 +2193,1070 @@ _eth_write(ETH_DEV* dev, ETH_PACK* packet, ETH_PCALLBACK routine);
 static void
 _eth_error(ETH_DEV* dev, const char* where);
 
+static void
+_eth_kernel_filter(ETH_DEV* dev);
+
+static int
+_eth_filter_match(const ETH_DEV* dev, const u_char* mac);
+
+#if defined (USE_READER_THREAD)
+static void
+_eth_rx_wakeup(ETH_DEV* dev);
+#else
+#define _eth_rx_wakeup(dev)
+#endif
+
+/* Tap transport
+
+   On Linux the tap device is opened with IFF_VNET_HDR when the kernel
+   supports it, so each frame is preceded by a virtio_net_hdr.  That lets
+   TCP/IPv4 segmentation offload and checksum offload be turned on for
+   the tap: the host stack then hands over TCP data as one large segment
+   per read, rather than a read per wire sized frame, and leaves partial
+   checksums for the "NIC" to finish.  A large segment takes the same path
+   as an offloaded frame captured from a host NIC: _eth_fix_ip_jumbo_offload
+   resegments it into standard frames for the simulated controller.  IPv6
+   segmentation is left to the host stack since that path only handles
+   IPv4.  Frames written to the tap carry an empty header, so the host
+   treats them as complete frames with good checksums.
+*/
+
+#define ETH_TAP_OPEN        ((void *)1)         /* tap handle: plain frames */
+#define ETH_TAP_OPEN_VNET   ((void *)2)         /* tap handle: frames follow a virtio_net_hdr */
+
+#if defined (HAVE_TAP_NETWORK)
+#if (defined(__linux) || defined(__linux__)) && defined (IFF_VNET_HDR) && defined (TUNSETOFFLOAD)
+#include <linux/virtio_net.h>
+#include <sys/uio.h>
+#define HAVE_TAP_VNET_HDR 1
+
+static uint16
+ip_checksum(uint16 *buffer, int size);
+#endif
+
+static int _eth_tap_read (ETH_DEV *dev)
+{
+struct pcap_pkthdr header;
+u_char buf[ETH_MAX_JUMBO_FRAME + 64];
+u_char *data = buf;
+int len;
+
+len = read(dev->fd_handle, buf, sizeof(buf));
+if (len <= 0)
+  return (len < 0) ? -1 : 0;
+#if defined (HAVE_TAP_VNET_HDR)
+if (dev->handle == ETH_TAP_OPEN_VNET) {
+  struct virtio_net_hdr *vnet = (struct virtio_net_hdr *)buf;
+
+  data += sizeof(*vnet);
+  len -= sizeof(*vnet);
+  if (len <= 0)
+    return 1;
+  /* A partial checksum holds the pseudo header sum, finish it as a NIC would.
+     Large segments get all of their checksums recomputed as they are resegmented. */
+  if ((vnet->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM) &&
+      (len <= ETH_MIN_JUMBO_FRAME) &&
+      (vnet->csum_start + vnet->csum_offset + 2 <= len)) {
+    uint16 sum = ip_checksum((uint16 *)(data + vnet->csum_start), len - vnet->csum_start);
+
+    memcpy(data + vnet->csum_start + vnet->csum_offset, &sum, sizeof(sum));
+    }
+  }
+#endif
+memset(&header, 0, sizeof(header));
+header.caplen = header.len = len;
+_eth_callback((u_char *)dev, &header, data);
+return 1;
+}
+
+static int _eth_tap_write (ETH_DEV *dev, ETH_PACK *packet)
+{
+#if defined (HAVE_TAP_VNET_HDR)
+if (dev->handle == ETH_TAP_OPEN_VNET) {
+  struct virtio_net_hdr vnet;
+  struct iovec iov[2];
+
+  memset(&vnet, 0, sizeof(vnet));       /* complete frame, no offloads */
+  iov[0].iov_base = (void *)&vnet;
+  iov[0].iov_len = sizeof(vnet);
+  iov[1].iov_base = (void *)packet->msg;
+  iov[1].iov_len = packet->len;
+  return (((int)(sizeof(vnet) + packet->len) == writev(dev->fd_handle, iov, 2)) ? 0 : -1);
+  }
+#endif
+return (((int)packet->len == write(dev->fd_handle, (void *)packet->msg, packet->len)) ? 0 : -1);
+}
+#endif /* HAVE_TAP_NETWORK */
+
+#if defined (HAVE_AFPACKET_NETWORK)
+/* Linux AF_PACKET transport
+
+   Frames move through TPACKET_V3 rings which are mmap'd and shared with
+   the kernel, so no libpcap is needed.  The receive ring is a set of
+   blocks which each hold many frames.  The kernel hands a block over when
+   it fills or when its retire timeout expires, and all of the frames in
+   it are dispatched before the block is given back.  Transmitted frames
+   are placed in the transmit ring's slots and the kernel is only kicked
+   once the writer thread has no more requests queued (or a batch has
+   accumulated), rather than with a send per frame.  Kernels which don't
+   support a TPACKET_V3 transmit ring just send each frame.
+
+   All of the devices in a simulator which attach to the same host
+   interface share one socket and its rings, so the kernel copies each
+   frame once rather than once per device.  Whichever reader thread
+   wakes first dispatches the held block for everyone: a unicast frame
+   is passed, straight from its ring slot, only to the device(s) whose
+   filter holds its destination and a multicast frame to each of them.
+   The kernel never returns a socket's own transmissions to it, so a
+   frame one sharing device sends is handed directly to the others,
+   just as separate sockets would have seen it.
+*/
+
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <net/if_arp.h>
+#include <linux/if_ether.h>
+
+#define AFP_RX_BLOCK_SIZE   (1 << 18)           /* 256KB blocks hold an offloaded 64KB frame */
+#define AFP_RX_BLOCKS       16                  /* receive ring blocks */
+#define AFP_RX_FRAME_SIZE   (1 << 11)           /* nominal, V3 packs variable sized frames */
+#define AFP_RX_RETIRE_MS    1                   /* max latency before a partial block is delivered */
+#define AFP_TX_FRAME_SIZE   (1 << 11)           /* holds TPACKET3_HDRLEN + ETH_FRAME_SIZE */
+#define AFP_TX_FRAMES       256                 /* transmit ring slots */
+#define AFP_TX_BATCH        32                  /* queued frames which force a kick anyway */
+
+typedef struct AFPACKET {
+  struct AFPACKET       *next;                  /* next shared socket */
+  char                  ifname[IFNAMSIZ];       /* host interface */
+  int                   refs;                   /* opens using this socket */
+  int                   nsubs;                  /* devices receiving from it */
+  ETH_DEV               *subs[ETH_MAX_DEVICE];
+  int                   fd;                     /* packet socket */
+  uint8                 *map;                   /* mmap'd receive ring, followed by transmit ring */
+  size_t                map_size;
+  uint32                rx_block;               /* block being dispatched */
+  uint32                rx_remaining;           /* frames left to dispatch in rx_block */
+  struct tpacket3_hdr   *rx_next;               /* next frame in rx_block, NULL if none held */
+  uint8                 *tx_ring;               /* transmit ring, NULL if unavailable */
+  uint32                tx_frame;               /* next transmit slot */
+  uint32                tx_pending;             /* frames queued since the last kick */
+#if defined (USE_READER_THREAD)
+  pthread_mutex_t       tx_lock;                /* writer thread vs reader thread jumbo fragments */
+  pthread_mutex_t       rx_lock;                /* receive ring and subs (recursive) */
+#endif
+  uint8                 vlan_frame[ETH_MAX_JUMBO_FRAME + 4]; /* frame with its 802.1Q tag restored */
+  } AFPACKET;
+
+#if defined (USE_READER_THREAD)
+static AFPACKET *_eth_afpacket_shared = NULL;
+static pthread_mutex_t _eth_afpacket_shared_lock = PTHREAD_MUTEX_INITIALIZER;
+
+#define _eth_afpacket_rx_lock(afp) pthread_mutex_lock (&(afp)->rx_lock)
+#define _eth_afpacket_rx_unlock(afp) pthread_mutex_unlock (&(afp)->rx_lock)
+#else
+#define _eth_afpacket_rx_lock(afp)
+#define _eth_afpacket_rx_unlock(afp)
+#endif
+
+static void _eth_afpacket_close (AFPACKET *afp)
+{
+if (!afp)
+  return;
+#if defined (USE_READER_THREAD)
+pthread_mutex_lock (&_eth_afpacket_shared_lock);
+if (afp->refs > 1) {                            /* still in use by another device? */
+  --afp->refs;
+  pthread_mutex_unlock (&_eth_afpacket_shared_lock);
+  return;
+  }
+if (afp->refs) {
+  AFPACKET **link = &_eth_afpacket_shared;
+
+  while (*link != afp)
+    link = &(*link)->next;
+  *link = afp->next;
+  }
+pthread_mutex_unlock (&_eth_afpacket_shared_lock);
+#endif
+if (afp->map && (afp->map != MAP_FAILED))
+  munmap (afp->map, afp->map_size);
+if (afp->fd >= 0)
+  close (afp->fd);
+#if defined (USE_READER_THREAD)
+pthread_mutex_destroy (&afp->tx_lock);
+pthread_mutex_destroy (&afp->rx_lock);
+#endif
+free (afp);
+}
+
+static t_stat _eth_afpacket_open (const char *ifname, void **handle, SOCKET *fd_handle, char *errbuf)
+{
+AFPACKET *afp;
+int version = TPACKET_V3;
+struct tpacket_req3 rx_req, tx_req;
+struct sockaddr_ll sll;
+struct packet_mreq mreq;
+struct ifreq ifr;
+size_t rx_size = (size_t)AFP_RX_BLOCK_SIZE * AFP_RX_BLOCKS;
+size_t tx_size = (size_t)AFP_TX_FRAME_SIZE * AFP_TX_FRAMES;
+int have_tx;
+int ifindex;
+
+while (isspace(*ifname))
+  ++ifname;
+if ((*ifname == '\0') || (strlen (ifname) >= IFNAMSIZ)) {
+  strlcpy (errbuf, "Invalid AF_PACKET interface name", PCAP_ERRBUF_SIZE);
+  return SCPE_OPENERR;
+  }
+ifindex = (int)if_nametoindex (ifname);
+if (ifindex == 0) {
+  snprintf (errbuf, PCAP_ERRBUF_SIZE, "%s: %s", ifname, strerror (errno));
+  return SCPE_OPENERR;
+  }
+#if defined (USE_READER_THREAD)
+pthread_mutex_lock (&_eth_afpacket_shared_lock);
+for (afp = _eth_afpacket_shared; afp; afp = afp->next)
+  if (strcmp (afp->ifname, ifname) == 0) {      /* already capturing this interface? */
+    ++afp->refs;
+    pthread_mutex_unlock (&_eth_afpacket_shared_lock);
+    *handle = (void *)afp;
+    *fd_handle = (SOCKET)afp->fd;
+    return SCPE_OK;
+    }
+pthread_mutex_unlock (&_eth_afpacket_shared_lock);
+#endif
+afp = (AFPACKET *)calloc (1, sizeof (*afp));
+if (!afp) {
+  strlcpy (errbuf, "Out of memory", PCAP_ERRBUF_SIZE);
+  return SCPE_MEM;
+  }
+afp->map = (uint8 *)MAP_FAILED;
+strlcpy (afp->ifname, ifname, sizeof (afp->ifname));
+#if defined (USE_READER_THREAD)
+if (1) {
+  pthread_mutexattr_t attr;
+
+  pthread_mutex_init (&afp->tx_lock, NULL);
+  pthread_mutexattr_init (&attr);
+  pthread_mutexattr_settype (&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init (&afp->rx_lock, &attr);     /* held across _eth_callback, which can transmit */
+  pthread_mutexattr_destroy (&attr);
+  }
+#endif
+afp->fd = socket (AF_PACKET, SOCK_RAW, htons (ETH_P_ALL));
+if ((afp->fd < 0) ||
+    (setsockopt (afp->fd, SOL_PACKET, PACKET_VERSION, &version, sizeof (version)) < 0)) {
+  snprintf (errbuf, PCAP_ERRBUF_SIZE, "AF_PACKET socket: %s", strerror (errno));
+  _eth_afpacket_close (afp);
+  return SCPE_OPENERR;
+  }
+memset (&rx_req, 0, sizeof (rx_req));
+rx_req.tp_block_size = AFP_RX_BLOCK_SIZE;
+rx_req.tp_block_nr = AFP_RX_BLOCKS;
+rx_req.tp_frame_size = AFP_RX_FRAME_SIZE;
+rx_req.tp_frame_nr = (uint32)(rx_size / AFP_RX_FRAME_SIZE);
+rx_req.tp_retire_blk_tov = AFP_RX_RETIRE_MS;
+if (setsockopt (afp->fd, SOL_PACKET, PACKET_RX_RING, &rx_req, sizeof (rx_req)) < 0) {
+  snprintf (errbuf, PCAP_ERRBUF_SIZE, "AF_PACKET receive ring: %s", strerror (errno));
+  _eth_afpacket_close (afp);
+  return SCPE_OPENERR;
+  }
+memset (&tx_req, 0, sizeof (tx_req));
+tx_req.tp_block_size = (uint32)tx_size;
+tx_req.tp_block_nr = 1;
+tx_req.tp_frame_size = AFP_TX_FRAME_SIZE;
+tx_req.tp_frame_nr = AFP_TX_FRAMES;
+have_tx = (setsockopt (afp->fd, SOL_PACKET, PACKET_TX_RING, &tx_req, sizeof (tx_req)) == 0);
+afp->map_size = rx_size + (have_tx ? tx_size : 0);
+afp->map = (uint8 *)mmap (NULL, afp->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, afp->fd, 0);
+if (afp->map == MAP_FAILED) {
+  snprintf (errbuf, PCAP_ERRBUF_SIZE, "AF_PACKET ring mmap: %s", strerror (errno));
+  _eth_afpacket_close (afp);
+  return SCPE_OPENERR;
+  }
+if (have_tx)
+  afp->tx_ring = afp->map + rx_size;
+/* Make sure the interface is up, and listen to everything on it */
+memset (&ifr, 0, sizeof (ifr));
+strlcpy (ifr.ifr_name, ifname, sizeof (ifr.ifr_name));
+if ((ioctl (afp->fd, SIOCGIFFLAGS, &ifr) == 0) && !(ifr.ifr_flags & IFF_UP)) {
+  ifr.ifr_flags |= IFF_UP;
+  if (ioctl (afp->fd, SIOCSIFFLAGS, &ifr)) {};
+  }
+memset (&sll, 0, sizeof (sll));
+sll.sll_family = AF_PACKET;
+sll.sll_protocol = htons (ETH_P_ALL);
+sll.sll_ifindex = ifindex;
+memset (&mreq, 0, sizeof (mreq));
+mreq.mr_ifindex = ifindex;
+mreq.mr_type = PACKET_MR_PROMISC;
+if ((bind (afp->fd, (struct sockaddr *)&sll, sizeof (sll)) < 0) ||
+    (setsockopt (afp->fd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof (mreq)) < 0)) {
+  snprintf (errbuf, PCAP_ERRBUF_SIZE, "%s: %s", ifname, strerror (errno));
+  _eth_afpacket_close (afp);
+  return SCPE_OPENERR;
+  }
+#if defined (USE_READER_THREAD)
+pthread_mutex_lock (&_eth_afpacket_shared_lock);
+afp->refs = 1;
+afp->next = _eth_afpacket_shared;
+_eth_afpacket_shared = afp;
+pthread_mutex_unlock (&_eth_afpacket_shared_lock);
+#endif
+*handle = (void *)afp;
+*fd_handle = (SOCKET)afp->fd;
+return SCPE_OK;
+}
+
+/* Start or stop passing received frames to dev */
+
+static void _eth_afpacket_subscribe (ETH_DEV *dev)
+{
+AFPACKET *afp = (AFPACKET *)dev->handle;
+int i;
+
+_eth_afpacket_rx_lock (afp);
+for (i = 0; i < afp->nsubs; i++)
+  if (afp->subs[i] == dev)
+    break;
+if ((i == afp->nsubs) && (afp->nsubs < ETH_MAX_DEVICE))
+  afp->subs[afp->nsubs++] = dev;
+_eth_afpacket_rx_unlock (afp);
+}
+
+static void _eth_afpacket_unsubscribe (ETH_DEV *dev)
+{
+AFPACKET *afp = (AFPACKET *)dev->handle;
+int i;
+
+_eth_afpacket_rx_lock (afp);
+for (i = 0; i < afp->nsubs; i++)
+  if (afp->subs[i] == dev) {
+    afp->subs[i] = afp->subs[--afp->nsubs];
+    break;
+    }
+if (afp->nsubs > 0)                             /* narrow the filter to those left */
+  _eth_kernel_filter (afp->subs[0]);
+_eth_afpacket_rx_unlock (afp);
+}
+
+/* Pass a frame to each device sharing afp which could want it, other than
+   the one which sent it.  got[] counts the frames each one was given. */
+
+static void _eth_afpacket_deliver (AFPACKET *afp, ETH_DEV *from, const struct pcap_pkthdr *header, const u_char *data, int *got)
+{
+int i;
+
+for (i = 0; i < afp->nsubs; i++) {
+  ETH_DEV *sub = afp->subs[i];
+
+  if (sub == from)
+    continue;
+  if ((data[0] & 0x01) || sub->promiscuous || _eth_filter_match (sub, data) ||
+      (sub->have_host_nic_phy_addr && (memcmp (data, sub->host_nic_phy_hw_addr, sizeof(ETH_MAC)) == 0))) {
+    _eth_callback ((u_char *)sub, header, data);
+    if (got)
+      ++got[i];
+    }
+  }
+}
+
+/* Dispatch up to max (-1 for all available) received frames to _eth_callback */
+
+static int _eth_afpacket_dispatch (ETH_DEV *dev, int max)
+{
+AFPACKET *afp = (AFPACKET *)dev->handle;
+int count = 0;
+int got[ETH_MAX_DEVICE];
+int i;
+
+memset (got, 0, sizeof (got));
+_eth_afpacket_rx_lock (afp);
+while ((max < 0) || (count < max)) {
+  struct tpacket_block_desc *block = (struct tpacket_block_desc *)(afp->map + (size_t)afp->rx_block * AFP_RX_BLOCK_SIZE);
+  struct tpacket3_hdr *hdr;
+  struct pcap_pkthdr header;
+  const u_char *data;
+
+  if (afp->rx_remaining == 0) {
+    if (afp->rx_next) {                     /* done with the held block? */
+      __sync_synchronize ();
+      block->hdr.bh1.block_status = TP_STATUS_KERNEL;   /* give it back */
+      afp->rx_next = NULL;
+      afp->rx_block = (afp->rx_block + 1) % AFP_RX_BLOCKS;
+      continue;
+      }
+    if (!(block->hdr.bh1.block_status & TP_STATUS_USER))
+      break;                                /* nothing more has arrived */
+    __sync_synchronize ();
+    afp->rx_remaining = block->hdr.bh1.num_pkts;
+    afp->rx_next = (struct tpacket3_hdr *)((uint8 *)block + block->hdr.bh1.offset_to_first_pkt);
+    continue;
+    }
+  hdr = afp->rx_next;
+  data = (const u_char *)hdr + hdr->tp_mac;
+  memset (&header, 0, sizeof (header));
+  header.caplen = hdr->tp_snaplen;
+  header.len = hdr->tp_len;
+  if ((hdr->tp_status & TP_STATUS_VLAN_VALID) && 
+      (header.caplen >= 12) && (header.caplen <= ETH_MAX_JUMBO_FRAME)) {
+    uint16 tpid = 0x8100;                   /* kernel stripped the tag, put it back */
+
+#if defined (TP_STATUS_VLAN_TPID_VALID)
+    if (hdr->tp_status & TP_STATUS_VLAN_TPID_VALID)
+      tpid = hdr->hv1.tp_vlan_tpid;
+#endif
+    memcpy (afp->vlan_frame, data, 12);
+    afp->vlan_frame[12] = (uint8)(tpid >> 8);
+    afp->vlan_frame[13] = (uint8)tpid;
+    afp->vlan_frame[14] = (uint8)(hdr->hv1.tp_vlan_tci >> 8);
+    afp->vlan_frame[15] = (uint8)hdr->hv1.tp_vlan_tci;
+    memcpy (&afp->vlan_frame[16], data + 12, header.caplen - 12);
+    header.caplen += 4;
+    header.len += 4;
+    data = afp->vlan_frame;
+    }
+  if ((afp->nsubs == 1) && (afp->subs[0] == dev))
+    _eth_callback ((u_char *)dev, &header, data);
+  else
+    _eth_afpacket_deliver (afp, NULL, &header, data, got);
+  ++count;
+  if (--afp->rx_remaining)
+    afp->rx_next = (struct tpacket3_hdr *)((uint8 *)hdr + hdr->tp_next_offset);
+  }
+for (i = 0; i < afp->nsubs; i++)                /* our own caller wakes dev */
+  if (got[i] && (afp->subs[i] != dev))
+    _eth_rx_wakeup (afp->subs[i]);
+_eth_afpacket_rx_unlock (afp);
+if (count == 0) {                           /* woken with nothing to read? */
+  int err = 0;
+  socklen_t errlen = sizeof (err);
+
+  if ((getsockopt (afp->fd, SOL_SOCKET, SO_ERROR, &err, &errlen) == 0) && (err != 0)) {
+    errno = err;
+    return -1;
+    }
+  }
+return count;
+}
+
+/* Hand a frame dev sent to the other devices sharing its socket */
+
+static void _eth_afpacket_loop (ETH_DEV *dev, const uint8 *msg, uint32 len)
+{
+AFPACKET *afp = (AFPACKET *)dev->handle;
+struct pcap_pkthdr header;
+int got[ETH_MAX_DEVICE];
+int i;
+
+memset (&header, 0, sizeof (header));
+header.caplen = header.len = len;
+memset (got, 0, sizeof (got));
+_eth_afpacket_rx_lock (afp);
+_eth_afpacket_deliver (afp, dev, &header, msg, got);
+for (i = 0; i < afp->nsubs; i++)
+  if (got[i])
+    _eth_rx_wakeup (afp->subs[i]);
+_eth_afpacket_rx_unlock (afp);
+}
+
+/* Returns 0 on success, -1 on error */
+
+static int _eth_afpacket_write (ETH_DEV *dev, const uint8 *msg, uint32 len, int more)
+{
+AFPACKET *afp = (AFPACKET *)dev->handle;
+struct tpacket3_hdr *hdr;
+int status = 0;
+
+if ((!afp->tx_ring) || (len > AFP_TX_FRAME_SIZE - TPACKET3_HDRLEN)) {
+  if ((int)len != send (afp->fd, msg, len, 0))
+    return -1;
+  if (afp->nsubs > 1)
+    _eth_afpacket_loop (dev, msg, len);
+  return 0;
+  }
+#if defined (USE_READER_THREAD)
+pthread_mutex_lock (&afp->tx_lock);
+#endif
+hdr = (struct tpacket3_hdr *)(afp->tx_ring + (size_t)afp->tx_frame * AFP_TX_FRAME_SIZE);
+if (hdr->tp_status & (TP_STATUS_SEND_REQUEST | TP_STATUS_SENDING)) {
+  /* Ring is full, a blocking kick waits for the kernel to drain it */
+  if (send (afp->fd, NULL, 0, 0) < 0)
+    status = -1;
+  afp->tx_pending = 0;
+  if (hdr->tp_status & (TP_STATUS_SEND_REQUEST | TP_STATUS_SENDING))
+    status = -1;
+  }
+if (status == 0) {
+  memcpy ((uint8 *)hdr + TPACKET3_HDRLEN - sizeof (struct sockaddr_ll), msg, len);
+  hdr->tp_len = len;
+  hdr->tp_snaplen = len;
+  hdr->tp_next_offset = 0;
+  __sync_synchronize ();
+  hdr->tp_status = TP_STATUS_SEND_REQUEST;
+  afp->tx_frame = (afp->tx_frame + 1) % AFP_TX_FRAMES;
+  if ((!more) || (++afp->tx_pending >= AFP_TX_BATCH)) {
+    if ((send (afp->fd, NULL, 0, MSG_DONTWAIT) < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK))
+      status = -1;
+    afp->tx_pending = 0;
+    }
+  }
+#if defined (USE_READER_THREAD)
+pthread_mutex_unlock (&afp->tx_lock);
+#endif
+if ((status == 0) && (afp->nsubs > 1))
+  _eth_afpacket_loop (dev, msg, len);
+return status;
+}
+
+static void _eth_afpacket_hw_addr (ETH_DEV *dev, const char *ifname)
+{
+struct ifreq ifr;
+
+memset (&ifr, 0, sizeof (ifr));
+strlcpy (ifr.ifr_name, ifname, sizeof (ifr.ifr_name));
+if ((ioctl ((int)dev->fd_handle, SIOCGIFHWADDR, &ifr) == 0) &&
+    (ifr.ifr_hwaddr.sa_family == ARPHRD_ETHER)) {
+  memcpy (dev->host_nic_phy_hw_addr, ifr.ifr_hwaddr.sa_data, sizeof (dev->host_nic_phy_hw_addr));
+  dev->have_host_nic_phy_addr = 1;
+  }
+}
+#endif /* HAVE_AFPACKET_NETWORK */
+
+#if defined (HAVE_SHM_NETWORK)
+/* Shared memory transport
+
+   Simulators on the same host which attach to the same shm:name join a
+   virtual switch held in a file which each of them maps, so frames move
+   between them without any system call.  Each attached device owns a port
+   with a receive ring.  A sender reserves a slot in the destination ring
+   with a compare-and-swap on the ring head, copies the frame in, and then
+   publishes the slot by storing its sequence number, so the ring's single
+   reader never takes a lock.  The switch remembers the port each source
+   address was last sent from.  Unicast frames to a learned address go to
+   that port alone, and broadcast, multicast and unknown destinations are
+   copied to every other port.  A reader with nothing to do sleeps on a
+   futex in its ring, and a sender only makes the wake up call when the
+   reader has said it is sleeping.  A full ring drops the frame, as a busy
+   switch would.
+*/
+
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <signal.h>
+
+#define SHM_MAGIC       0x53494D31              /* layout identifier */
+#define SHM_PORTS       32                      /* ports on a switch */
+#define SHM_SLOTS       256                     /* frames per port ring (power of 2) */
+#define SHM_SLOT_SIZE   2048                    /* slot holds a VLAN tagged ETH_MAX_PACKET */
+#define SHM_FRAME_MAX   (SHM_SLOT_SIZE - 2 * sizeof (uint32))
+#define SHM_LEARNED     256                     /* learned address entries (power of 2) */
+#define SHM_WAIT_MS     250                     /* reader thread idle wait */
+#define SHM_HASH(m)     (((m)[2] ^ (m)[3] ^ (m)[4] ^ ((m)[5] * 31)) & (SHM_LEARNED - 1))
+
+typedef struct {
+  volatile uint32       seq;                    /* n+1 once this slot holds ring frame n */
+  uint32                len;                    /* frame length */
+  uint8                 data[SHM_FRAME_MAX];
+  } SHM_SLOT;
+
+typedef struct {
+  volatile uint32       head;                   /* next frame senders will fill */
+  volatile uint32       tail;                   /* next frame the owner will read */
+  volatile uint32       doorbell;               /* futex word, bumped on each publish */
+  volatile uint32       sleeping;               /* owner is waiting on the doorbell */
+  volatile int32        pid;                    /* owning process, 0 if the port is free */
+  uint32                reserved[3];
+  SHM_SLOT              slot[SHM_SLOTS];
+  } SHM_RING;
+
+typedef struct {
+  uint8                 mac[6];
+  volatile uint16       port;                   /* port + 1, 0 if unused */
+  } SHM_ADDR;
+
+typedef struct {
+  volatile uint32       magic;
+  uint32                ports;
+  SHM_ADDR              learned[SHM_LEARNED];
+  SHM_RING              ring[SHM_PORTS];
+  } SHM_SWITCH;
+
+typedef struct ETH_SHM {
+  int                   fd;                     /* switch file */
+  SHM_SWITCH            *sw;                    /* mapped switch */
+  int                   port;                   /* our port */
+  } ETH_SHM;
+
+static void _eth_shm_close (ETH_SHM *shm)
+{
+if (!shm)
+  return;
+if (shm->sw && (shm->sw != MAP_FAILED)) {
+  if (shm->port >= 0)
+    shm->sw->ring[shm->port].pid = 0;           /* free our port */
+  munmap (shm->sw, sizeof (*shm->sw));
+  }
+if (shm->fd >= 0)
+  close (shm->fd);
+free (shm);
+}
+
+static t_stat _eth_shm_open (const char *name, void **handle, SOCKET *fd_handle, char *errbuf)
+{
+ETH_SHM *shm;
+struct stat st;
+char path[128];
+const char *c;
+int i;
+
+while (isspace(*name))
+  ++name;
+for (c = name; *c; ++c)
+  if (!isalnum (*c) && (*c != '-') && (*c != '_') && (*c != '.'))
+    break;
+if ((*name == '\0') || (*c != '\0') || (strlen (name) > 64)) {
+  strlcpy (errbuf, "Invalid shared memory switch name", PCAP_ERRBUF_SIZE);
+  return SCPE_OPENERR;
+  }
+snprintf (path, sizeof (path), "%s/simh-eth-%s",
+          ((0 == stat ("/dev/shm", &st)) && S_ISDIR (st.st_mode)) ? "/dev/shm" : "/tmp", name);
+shm = (ETH_SHM *)calloc (1, sizeof (*shm));
+if (!shm) {
+  strlcpy (errbuf, "Out of memory", PCAP_ERRBUF_SIZE);
+  return SCPE_MEM;
+  }
+shm->sw = (SHM_SWITCH *)MAP_FAILED;
+shm->port = -1;
+shm->fd = open (path, O_RDWR | O_CREAT, 0666);
+if ((shm->fd < 0) ||
+    (flock (shm->fd, LOCK_EX) < 0) ||
+    (fstat (shm->fd, &st) < 0) ||
+    (((size_t)st.st_size < sizeof (*shm->sw)) && (ftruncate (shm->fd, sizeof (*shm->sw)) < 0))) {
+  snprintf (errbuf, PCAP_ERRBUF_SIZE, "%s: %s", path, strerror (errno));
+  _eth_shm_close (shm);
+  return SCPE_OPENERR;
+  }
+shm->sw = (SHM_SWITCH *)mmap (NULL, sizeof (*shm->sw), PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd, 0);
+if (shm->sw == MAP_FAILED) {
+  snprintf (errbuf, PCAP_ERRBUF_SIZE, "%s mmap: %s", path, strerror (errno));
+  _eth_shm_close (shm);
+  return SCPE_OPENERR;
+  }
+/* The file lock serializes switch setup and port claims between simulators */
+if ((shm->sw->magic != SHM_MAGIC) || (shm->sw->ports != SHM_PORTS)) {
+  memset (shm->sw, 0, sizeof (*shm->sw));
+  shm->sw->ports = SHM_PORTS;
+  shm->sw->magic = SHM_MAGIC;
+  }
+for (i = 0; i < SHM_PORTS; i++) {
+  SHM_RING *ring = &shm->sw->ring[i];
+
+  if ((ring->pid == 0) ||                       /* free, or owner gone without closing? */
+      ((kill ((pid_t)ring->pid, 0) < 0) && (errno == ESRCH))) {
+    int j;
+
+    ring->head = ring->tail = 0;
+    for (j = 0; j < SHM_SLOTS; j++)
+      ring->slot[j].seq = 0;
+    ring->sleeping = 0;
+    __sync_synchronize ();
+    ring->pid = (int32)getpid ();
+    shm->port = i;
+    break;
+    }
+  }
+flock (shm->fd, LOCK_UN);
+if (shm->port < 0) {
+  snprintf (errbuf, PCAP_ERRBUF_SIZE, "%s: all %d switch ports are in use", path, SHM_PORTS);
+  _eth_shm_close (shm);
+  return SCPE_OPENERR;
+  }
+*handle = (void *)shm;
+*fd_handle = 0;
+return SCPE_OK;
+}
+
+/* Dispatch up to max (-1 for all available) received frames to _eth_callback,
+   waiting up to wait_ms for the first one to arrive */
+
+static int _eth_shm_dispatch (ETH_DEV *dev, int max, int wait_ms)
+{
+ETH_SHM *shm = (ETH_SHM *)dev->handle;
+SHM_RING *ring = &shm->sw->ring[shm->port];
+int count = 0;
+
+while ((max < 0) || (count < max)) {
+  uint32 tail = ring->tail;
+  SHM_SLOT *slot = &ring->slot[tail & (SHM_SLOTS - 1)];
+  struct pcap_pkthdr header;
+
+  if (slot->seq != tail + 1) {                  /* nothing published yet? */
+    uint32 doorbell = ring->doorbell;
+
+    if ((count > 0) || (wait_ms == 0))
+      break;
+    ring->sleeping = 1;
+    __sync_synchronize ();
+    if (slot->seq != tail + 1) {
+      struct timespec timeout;
+
+      timeout.tv_sec = wait_ms / 1000;
+      timeout.tv_nsec = (wait_ms % 1000) * 1000000;
+      syscall (SYS_futex, &ring->doorbell, FUTEX_WAIT, doorbell, &timeout, NULL, 0);
+      }
+    ring->sleeping = 0;
+    wait_ms = 0;                                /* only wait once */
+    continue;
+    }
+  __sync_synchronize ();
+  memset (&header, 0, sizeof (header));
+  header.caplen = header.len = slot->len;
+  _eth_callback ((u_char *)dev, &header, slot->data);
+  __sync_synchronize ();
+  ring->tail = tail + 1;                        /* hand the slot back */
+  ++count;
+  }
+return count;
+}
+
+static void _eth_shm_send (SHM_RING *ring, const uint8 *msg, uint32 len)
+{
+SHM_SLOT *slot;
+uint32 head;
+
+do {
+  head = ring->head;
+  if (head - ring->tail >= SHM_SLOTS)           /* ring full? */
+    return;                                     /*   drop the frame */
+  } while (!__sync_bool_compare_and_swap (&ring->head, head, head + 1));
+slot = &ring->slot[head & (SHM_SLOTS - 1)];
+slot->len = len;
+memcpy (slot->data, msg, len);
+__sync_synchronize ();
+slot->seq = head + 1;                           /* publish */
+__sync_fetch_and_add (&ring->doorbell, 1);
+if (ring->sleeping)
+  syscall (SYS_futex, &ring->doorbell, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+/* Returns 0 on success, -1 on error */
+
+static int _eth_shm_write (ETH_DEV *dev, const uint8 *msg, uint32 len)
+{
+ETH_SHM *shm = (ETH_SHM *)dev->handle;
+SHM_SWITCH *sw = shm->sw;
+SHM_ADDR *addr;
+int port;
+
+if ((len < 14) || (len > SHM_FRAME_MAX))
+  return -1;
+if (!(msg[6] & 1)) {                            /* learn where the source lives */
+  addr = &sw->learned[SHM_HASH (&msg[6])];
+  if ((addr->port != shm->port + 1) || memcmp (addr->mac, &msg[6], 6)) {
+    addr->port = 0;
+    __sync_synchronize ();
+    memcpy (addr->mac, &msg[6], 6);
+    __sync_synchronize ();
+    addr->port = (uint16)(shm->port + 1);
+    }
+  }
+if (!(msg[0] & 1)) {                            /* unicast to a learned address? */
+  addr = &sw->learned[SHM_HASH (msg)];
+  port = addr->port - 1;
+  if ((port >= 0) && (0 == memcmp (addr->mac, msg, 6)) && sw->ring[port].pid) {
+    if (port != shm->port)
+      _eth_shm_send (&sw->ring[port], msg, len);
+    return 0;
+    }
+  }
+for (port = 0; port < SHM_PORTS; port++)        /* flood */
+  if ((port != shm->port) && sw->ring[port].pid)
+    _eth_shm_send (&sw->ring[port], msg, len);
+return 0;
+}
+#endif /* HAVE_SHM_NETWORK */
+
+/* UDP transport
+
+   Frames are carried one per datagram on a connected UDP socket.  The
+   attach string may carry options after the addresses:
+
+       udp:sourceport:remotehost:remoteport{,BATCH=n}{,RCVBUF=bytes}
+
+   BATCH is the number of datagrams moved per system call.  Where the host
+   provides recvmmsg/sendmmsg, received datagrams are collected with one
+   recvmmsg and transmitted frames are held until the writer thread has
+   no more requests queued (or BATCH have accumulated) and then sent with
+   one sendmmsg.  Elsewhere datagrams are read and written individually.
+   RCVBUF sets the socket's SO_RCVBUF so that bursts (cluster state
+   transitions, served disk I/O) are absorbed by the host rather than
+   dropped while the reader thread is busy.
+*/
+
+#if defined(__linux__) && defined(_GNU_SOURCE) && !defined(DONT_USE_MMSG)
+#define ETH_UDP_MMSG 1
+#include <sys/uio.h>
+#endif
+
+#define ETH_UDP_DEFAULT_BATCH 32                /* datagrams per system call */
+#define ETH_UDP_MAX_BATCH     256
+#define ETH_UDP_MAX_RCVBUF    (64*1024*1024)
+#define ETH_UDP_SLOT_SIZE     (1 << 11)         /* batch buffer slot, holds ETH_FRAME_SIZE */
+
+typedef struct ETH_UDP {
+  int                   batch;                  /* datagrams per recvmmsg/sendmmsg */
+  int                   rcvbuf;                 /* requested SO_RCVBUF, 0 is the system default */
+#if defined (ETH_UDP_MMSG)
+  uint8                 *rx_buf;                /* batch receive buffers */
+  struct mmsghdr        *rx_msgs;
+  struct iovec          *rx_iov;
+  uint8                 *tx_buf;                /* batch transmit buffers */
+  struct mmsghdr        *tx_msgs;
+  struct iovec          *tx_iov;
+  int                   tx_pending;             /* frames held for the next sendmmsg */
+#if defined (USE_READER_THREAD)
+  pthread_mutex_t       tx_lock;                /* writer thread vs reader thread jumbo fragments */
+#endif
+#endif
+  } ETH_UDP;
+
+static void _eth_udp_close (ETH_UDP *udp)
+{
+if (!udp)
+  return;
+#if defined (ETH_UDP_MMSG)
+free (udp->rx_buf);
+free (udp->rx_msgs);
+free (udp->rx_iov);
+free (udp->tx_buf);
+free (udp->tx_msgs);
+free (udp->tx_iov);
+#if defined (USE_READER_THREAD)
+pthread_mutex_destroy (&udp->tx_lock);
+#endif
+#endif
+free (udp);
+}
+
+/* Parse the ,BATCH=n,RCVBUF=bytes options which follow the addresses.
+   The options are removed from devname. */
+
+static t_stat _eth_udp_options (char *devname, ETH_UDP *udp, char *errbuf)
+{
+char *opt = strchr (devname, ',');
+
+udp->batch = ETH_UDP_DEFAULT_BATCH;
+udp->rcvbuf = 0;
+if (opt == NULL)
+  return SCPE_OK;
+*opt++ = '\0';
+while (opt && *opt) {
+  char *next = strchr (opt, ',');
+  char *value = strchr (opt, '=');
+  unsigned long val;
+  char *end;
+
+  if (next)
+    *next++ = '\0';
+  if (value == NULL) {
+    snprintf (errbuf, PCAP_ERRBUF_SIZE, "Invalid udp option: %s", opt);
+    return SCPE_ARG;
+    }
+  *value++ = '\0';
+  val = strtoul (value, &end, 10);
+  if ((*end == 'K') || (*end == 'k')) {
+    val *= 1024;
+    ++end;
+    }
+  else {
+    if ((*end == 'M') || (*end == 'm')) {
+      val *= 1024*1024;
+      ++end;
+      }
+    }
+  if ((end == value) || (*end != '\0')) {
+    snprintf (errbuf, PCAP_ERRBUF_SIZE, "Invalid udp option value: %s=%s", opt, value);
+    return SCPE_ARG;
+    }
+  if (0 == strcasecmp (opt, "BATCH")) {
+    if ((val < 1) || (val > ETH_UDP_MAX_BATCH)) {
+      snprintf (errbuf, PCAP_ERRBUF_SIZE, "udp BATCH must be 1-%d", ETH_UDP_MAX_BATCH);
+      return SCPE_ARG;
+      }
+    udp->batch = (int)val;
+    }
+  else {
+    if (0 == strcasecmp (opt, "RCVBUF")) {
+      if (val > ETH_UDP_MAX_RCVBUF) {
+        snprintf (errbuf, PCAP_ERRBUF_SIZE, "udp RCVBUF must be at most %d", ETH_UDP_MAX_RCVBUF);
+        return SCPE_ARG;
+        }
+      udp->rcvbuf = (int)val;
+      }
+    else {
+      snprintf (errbuf, PCAP_ERRBUF_SIZE, "Unknown udp option: %s", opt);
+      return SCPE_ARG;
+      }
+    }
+  opt = next;
+  }
+return SCPE_OK;
+}
+
+static t_stat _eth_udp_setup (ETH_UDP *udp, SOCKET fd, char *errbuf)
+{
+if ((udp->rcvbuf > 0) &&
+    (setsockopt (fd, SOL_SOCKET, SO_RCVBUF, (char *)&udp->rcvbuf, sizeof (udp->rcvbuf)) != 0)) {
+  snprintf (errbuf, PCAP_ERRBUF_SIZE, "udp SO_RCVBUF: %s", strerror (errno));
+  return SCPE_OPENERR;
+  }
+#if defined (ETH_UDP_MMSG)
+if (1) {
+  int i;
+
+  udp->rx_buf = (uint8 *)malloc ((size_t)udp->batch * ETH_UDP_SLOT_SIZE);
+  udp->rx_msgs = (struct mmsghdr *)calloc (udp->batch, sizeof (*udp->rx_msgs));
+  udp->rx_iov = (struct iovec *)calloc (udp->batch, sizeof (*udp->rx_iov));
+  udp->tx_buf = (uint8 *)malloc ((size_t)udp->batch * ETH_UDP_SLOT_SIZE);
+  udp->tx_msgs = (struct mmsghdr *)calloc (udp->batch, sizeof (*udp->tx_msgs));
+  udp->tx_iov = (struct iovec *)calloc (udp->batch, sizeof (*udp->tx_iov));
+  if (!udp->rx_buf || !udp->rx_msgs || !udp->rx_iov || !udp->tx_buf || !udp->tx_msgs || !udp->tx_iov) {
+    strlcpy (errbuf, "Out of memory", PCAP_ERRBUF_SIZE);
+    return SCPE_MEM;
+    }
+  for (i = 0; i < udp->batch; i++) {
+    udp->rx_iov[i].iov_base = udp->rx_buf + (size_t)i * ETH_UDP_SLOT_SIZE;
+    udp->rx_iov[i].iov_len = ETH_UDP_SLOT_SIZE;
+    udp->rx_msgs[i].msg_hdr.msg_iov = &udp->rx_iov[i];
+    udp->rx_msgs[i].msg_hdr.msg_iovlen = 1;
+    udp->tx_iov[i].iov_base = udp->tx_buf + (size_t)i * ETH_UDP_SLOT_SIZE;
+    udp->tx_msgs[i].msg_hdr.msg_iov = &udp->tx_iov[i];
+    udp->tx_msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+  }
+#if defined (USE_READER_THREAD)
+pthread_mutex_init (&udp->tx_lock, NULL);
+#endif
+#endif
+return SCPE_OK;
+}
+
+/* Dispatch up to max received datagrams to _eth_callback.
+   Returns the number dispatched, 0 if none were available, or -1 on error */
+
+static int _eth_udp_dispatch (ETH_DEV *dev, int max)
+{
+ETH_UDP *udp = (ETH_UDP *)dev->handle;
+struct pcap_pkthdr header;
+int count = 0;
+
+memset (&header, 0, sizeof (header));
+#if defined (ETH_UDP_MMSG)
+while (count < max) {
+  int vlen = ((max - count) < udp->batch) ? (max - count) : udp->batch;
+  int i, n;
+
+  n = recvmmsg ((int)dev->fd_handle, udp->rx_msgs, vlen, MSG_DONTWAIT, NULL);
+  if (n < 0) {
+    if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))
+      break;
+    return (count > 0) ? count : -1;
+    }
+  for (i = 0; i < n; i++) {
+    if (udp->rx_msgs[i].msg_len == 0)
+      continue;
+    if (udp->rx_msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+      ++dev->jumbo_truncated;                   /* larger than any frame a peer sends */
+      continue;
+      }
+    header.caplen = header.len = udp->rx_msgs[i].msg_len;
+    _eth_callback ((u_char *)dev, &header, (u_char *)udp->rx_iov[i].iov_base);
+    }
+  count += n;
+  if (n < vlen)                                 /* socket drained */
+    break;
+  }
+#else
+while (count < max) {
+  u_char buf[ETH_MAX_JUMBO_FRAME];
+  int len = (int)sim_read_sock (dev->fd_handle, (char *)buf, (int32)sizeof(buf));
+
+  if (len <= 0) {
+    if ((len < 0) && (count == 0))
+      return -1;
+    break;
+    }
+  header.caplen = header.len = len;
+  _eth_callback ((u_char *)dev, &header, buf);
+  if (++count >= udp->batch)                     /* non blocking socket, read until drained */
+    break;
+  }
+#endif
+return count;
+}
+
+#if defined (ETH_UDP_MMSG)
+/* Send the held datagrams.  Returns 0 on success, -1 on error */
+
+static int _eth_udp_flush (ETH_UDP *udp, SOCKET fd)
+{
+int sent = 0;
+
+while (sent < udp->tx_pending) {
+  int n = sendmmsg ((int)fd, udp->tx_msgs + sent, udp->tx_pending - sent, 0);
+
+  if (n <= 0) {
+    if ((n < 0) && (errno == EINTR))
+      continue;
+    udp->tx_pending = 0;
+    return -1;
+    }
+  sent += n;
+  }
+udp->tx_pending = 0;
+return 0;
+}
+#endif
+
+/* Returns 0 on success, -1 on error */
+
+static int _eth_udp_write (ETH_DEV *dev, const uint8 *msg, uint32 len, int more)
+{
+#if defined (ETH_UDP_MMSG)
+ETH_UDP *udp = (ETH_UDP *)dev->handle;
+int status = 0;
+
+if (udp->batch <= 1)
+  return ((int32)len == sim_write_sock (dev->fd_handle, (char *)msg, (int32)len)) ? 0 : -1;
+#if defined (USE_READER_THREAD)
+pthread_mutex_lock (&udp->tx_lock);
+#endif
+if (len > ETH_UDP_SLOT_SIZE) {                  /* oversized, send it directly after what's held */
+  status = _eth_udp_flush (udp, dev->fd_handle);
+  if ((int32)len != sim_write_sock (dev->fd_handle, (char *)msg, (int32)len))
+    status = -1;
+  }
+else {
+  memcpy (udp->tx_iov[udp->tx_pending].iov_base, msg, len);
+  udp->tx_iov[udp->tx_pending].iov_len = len;
+  ++udp->tx_pending;
+  if ((!more) || (udp->tx_pending >= udp->batch))
+    status = _eth_udp_flush (udp, dev->fd_handle);
+  }
+#if defined (USE_READER_THREAD)
+pthread_mutex_unlock (&udp->tx_lock);
+#endif
+return status;
+#else
+return ((int32)len == sim_write_sock (dev->fd_handle, (char *)msg, (int32)len)) ? 0 : -1;
+#endif
+}
+
 #if defined(HAVE_SLIRP_NETWORK)
 static void _slirp_callback (void *opaque, const unsigned char *buf, int len)
 {
@@ -1931,6 +3269,137 @@ _eth_callback((u_char *)opaque, &header, buf);
 #endif
 
 #if defined (USE_READER_THREAD)
+/* Received packet ring
+
+   The reader thread is the only producer and eth_read (on the simulator
+   thread) is the only consumer of received packets, so each side owns one
+   free running index and packets change hands without taking dev->lock.
+   A memory barrier orders the slot contents against each index update.
+   Frames are padded, checksum adjusted and CRC'd directly in their ring
+   slot, and eth_read copies them straight out of it.  The producer may
+   not advance the consumer's index, so when the ring is full the newly
+   arrived frame is the one that is dropped.
+*/
+
+#if defined (_WIN32)
+#define _eth_ring_barrier() MemoryBarrier ()
+#elif defined (__GNUC__)
+#define _eth_ring_barrier() __sync_synchronize ()
+#else
+static pthread_mutex_t _eth_ring_barrier_lock = PTHREAD_MUTEX_INITIALIZER;
+#define _eth_ring_barrier()                             \
+    do {                                                \
+      pthread_mutex_lock (&_eth_ring_barrier_lock);     \
+      pthread_mutex_unlock (&_eth_ring_barrier_lock);   \
+      } while (0)
+#endif
+
+static t_stat _eth_ring_init (ETH_RING *ring, uint32 size)
+{
+memset (ring, 0, sizeof (*ring));
+ring->item = (ETH_ITEM *)calloc (size, sizeof (*ring->item));
+if (!ring->item) {
+  sim_printf ("Eth: failed to allocate receive ring[%d]\n", (int)size);
+  return SCPE_MEM;
+  }
+ring->size = size;
+return SCPE_OK;
+}
+
+static void _eth_ring_destroy (ETH_RING *ring)
+{
+free (ring->item);
+memset (ring, 0, sizeof (*ring));
+}
+
+static uint32 _eth_ring_count (ETH_RING *ring)
+{
+return ring->tail - ring->head;
+}
+
+/* Producer: next free slot, or NULL when full */
+static ETH_ITEM *_eth_ring_reserve (ETH_RING *ring)
+{
+if ((ring->item == NULL) || (ring->tail - ring->head >= ring->size)) {
+  ++ring->loss;
+  return NULL;
+  }
+return &ring->item[ring->tail & (ring->size - 1)];
+}
+
+/* Producer: publish the slot returned by _eth_ring_reserve */
+static void _eth_ring_commit (ETH_RING *ring)
+{
+uint32 count;
+
+_eth_ring_barrier ();                               /* slot contents visible before the index */
+ring->tail = ring->tail + 1;
+count = ring->tail - ring->head;
+if (count > ring->high)
+  ring->high = count;
+}
+
+/* Consumer: oldest filled slot, or NULL when empty */
+static ETH_ITEM *_eth_ring_peek (ETH_RING *ring)
+{
+if (ring->head == ring->tail)
+  return NULL;
+_eth_ring_barrier ();                               /* see the index before the slot contents */
+return &ring->item[ring->head & (ring->size - 1)];
+}
+
+/* Consumer: return the slot from _eth_ring_peek to the producer */
+static void _eth_ring_release (ETH_RING *ring)
+{
+_eth_ring_barrier ();                               /* done with slot before the producer can refill it */
+ring->head = ring->head + 1;
+}
+
+#if defined (USE_BPF)
+/* Consumer: discard everything currently queued */
+static void _eth_ring_clear (ETH_RING *ring)
+{
+ring->head = ring->tail;
+}
+#endif
+
+#if defined (HAVE_TAP_NETWORK) || defined (HAVE_VDE_NETWORK)
+/* Check whether more input is already waiting so that several frames 
+   can be collected for each reader thread wakeup */
+static int _eth_more_input (SOCKET fd)
+{
+fd_set setl;
+struct timeval timeout;
+
+FD_ZERO(&setl);
+FD_SET(fd, &setl);
+timeout.tv_sec = 0;
+timeout.tv_usec = 0;
+return (select(1+fd, &setl, NULL, NULL, &timeout) > 0);
+}
+#endif
+
+/* Queue the device's automatic poll once received frames are waiting */
+static void _eth_rx_wakeup (ETH_DEV *dev)
+{
+int count;
+
+if (!dev->asynch_io)
+  return;
+count = _eth_ring_count (&dev->read_ring);
+if (count != 0) {
+  sim_debug(dev->dbit, dev->dptr, "Queueing automatic poll\n");
+  /* With a latency, the first frame waiting starts the clock and later
+     arrivals don't push the poll back, unless enough are waiting to make
+     it worth running at once. */
+  if ((dev->asynch_io_latency == 0) ||
+      (dev->asynch_io_burst && (count >= dev->asynch_io_burst)))
+    sim_activate_abs (dev->dptr->units, 0);
+  else
+    sim_activate (dev->dptr->units, dev->asynch_io_latency);
+  }
+}
+
 static void *
 _eth_reader(void *arg)
 {
@@ -1956,6 +3425,7 @@ switch (dev->eth_api) {
   case ETH_API_VDE:
   case ETH_API_UDP:
   case ETH_API_NAT:
+  case ETH_API_AFPACKET:
     do_select = 1;
     select_fd = dev->fd_handle;
     break;
@@ -1965,8 +3435,8 @@ sim_debug(dev->dbit, dev->dptr, "Reader Thread Starting\n");
 
 /* Boost Priority for this I/O thread vs the CPU instruction execution 
    thread which, in general, won't be readily yielding the processor 
-   when this thread needs to run */
-sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
+   when this thread needs to run, and place it as configured */
+sim_os_set_thread_placement (SIM_THREAD_IO);
 
 while (dev->handle) {
 #if defined (_WIN32)
@@ -2013,23 +3483,11 @@ while (dev->handle) {
 #ifdef HAVE_TAP_NETWORK
       case ETH_API_TAP:
         if (1) {
-          struct pcap_pkthdr header;
-          int len;
-          u_char buf[ETH_MAX_JUMBO_FRAME];
+          int batch = 0;
 
-          memset(&header, 0, sizeof(header));
-          len = read(dev->fd_handle, buf, sizeof(buf));
-          if (len > 0) {
-            status = 1;
-            header.caplen = header.len = len;
-            _eth_callback((u_char *)dev, &header, buf);
-            }
-          else {
-            if (len < 0)
-              status = -1;
-            else
-              status = 0;
-            }
+          do {
+            status = _eth_tap_read (dev);
+            } while ((status > 0) && (++batch < ETH_READ_BATCH) && _eth_more_input (select_fd));
           }
         break;
 #endif /* HAVE_TAP_NETWORK */
@@ -2038,21 +3496,24 @@ while (dev->handle) {
         if (1) {
           struct pcap_pkthdr header;
           int len;
+          int batch = 0;
           u_char buf[ETH_MAX_JUMBO_FRAME];
 
-          memset(&header, 0, sizeof(header));
-          len = vde_recv((VDECONN *)dev->handle, buf, sizeof(buf), 0);
-          if (len > 0) {
-            status = 1;
-            header.caplen = header.len = len;
-            _eth_callback((u_char *)dev, &header, buf);
-            }
-          else {
-            if (len < 0)
-              status = -1;
-            else
-              status = 0;
-            }
+          do {
+            memset(&header, 0, sizeof(header));
+            len = vde_recv((VDECONN *)dev->handle, buf, sizeof(buf), 0);
+            if (len > 0) {
+              status = 1;
+              header.caplen = header.len = len;
+              _eth_callback((u_char *)dev, &header, buf);
+              }
+            else {
+              if (len < 0)
+                status = -1;
+              else
+                status = 0;
+              }
+            } while ((status > 0) && (++batch < ETH_READ_BATCH) && _eth_more_input (select_fd));
           }
         break;
 #endif /* HAVE_VDE_NETWORK */
@@ -2062,39 +3523,22 @@ while (dev->handle) {
         status = 1;
         break;
 #endif /* HAVE_SLIRP_NETWORK */
+#ifdef HAVE_AFPACKET_NETWORK
+      case ETH_API_AFPACKET:
+        status = _eth_afpacket_dispatch (dev, -1);  /* whole blocks of frames */
+        break;
+#endif /* HAVE_AFPACKET_NETWORK */
+#ifdef HAVE_SHM_NETWORK
+      case ETH_API_SHM:
+        status = _eth_shm_dispatch (dev, -1, SHM_WAIT_MS);  /* sleeps in the ring when idle */
+        break;
+#endif /* HAVE_SHM_NETWORK */
       case ETH_API_UDP:
-        if (1) {
-          struct pcap_pkthdr header;
-          int len;
-          u_char buf[ETH_MAX_JUMBO_FRAME];
-
-          memset(&header, 0, sizeof(header));
-          len = (int)sim_read_sock (select_fd, (char *)buf, (int32)sizeof(buf));
-          if (len > 0) {
-            status = 1;
-            header.caplen = header.len = len;
-            _eth_callback((u_char *)dev, &header, buf);
-            }
-          else {
-            if (len < 0)
-              status = -1;
-            else
-              status = 0;
-            }
-          }
+        status = _eth_udp_dispatch (dev, ETH_READ_RING_SIZE); /* BATCH datagrams per call */
         break;
       }
-    if ((status > 0) && (dev->asynch_io)) {
-      int wakeup_needed;
-
-      pthread_mutex_lock (&dev->lock);
-      wakeup_needed = (dev->read_queue.count != 0);
-      pthread_mutex_unlock (&dev->lock);
-      if (wakeup_needed) {
-        sim_debug(dev->dbit, dev->dptr, "Queueing automatic poll\n");
-        sim_activate_abs (dev->dptr->units, dev->asynch_io_latency);
-        }
-      }
+    if (status > 0)
+      _eth_rx_wakeup (dev);
     if (status < 0) {
       ++dev->receive_packet_errors;
       _eth_error (dev, "_eth_reader");
@@ -2123,11 +3567,12 @@ _eth_writer(void *arg)
 {
 ETH_DEV* volatile dev = (ETH_DEV*)arg;
 ETH_WRITE_REQUEST *request = NULL;
+t_uint64 start;
 
 /* Boost Priority for this I/O thread vs the CPU instruction execution 
    thread which in general won't be readily yielding the processor when 
-   this thread needs to run */
-sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
+   this thread needs to run, and place it as configured */
+sim_os_set_thread_placement (SIM_THREAD_IO);
 
 sim_debug(dev->dbit, dev->dptr, "Writer Thread Starting\n");
 
@@ -2139,6 +3584,7 @@ while (dev->handle) {
       break;
     /* Pull buffer off request list */
     dev->write_requests = request->next;
+    dev->write_more = (dev->write_requests != NULL);
     pthread_mutex_unlock (&dev->writer_lock);
 
     if (dev->throttle_delay != ETH_THROT_DISABLED_DELAY) {
@@ -2151,7 +3597,11 @@ while (dev->handle) {
         }
       dev->throttle_packet_time = sim_os_msec();
       }
+    start = sim_host_nsec ();
+    sim_latency_record (&dev->tx_queued, start - request->queued_nsec);
     dev->write_status = _eth_write(dev, &request->packet, NULL);
+    sim_latency_record (&dev->tx_host, sim_host_nsec () - start);
+    dev->write_more = 0;
 
     pthread_mutex_lock (&dev->writer_lock);
     /* Put buffer on free buffer list */
@@ -2180,14 +3630,9 @@ char *msg = "Eth: Can't operate asynchronously, must poll.\n"
             " *** Build with USE_READER_THREAD defined and link with pthreads for asynchronous operation. ***\n";
 return sim_messagef (SCPE_NOFNC, "%s", msg);
 #else
-int wakeup_needed;
-
 dev->asynch_io = 1;
-dev->asynch_io_latency = latency;
-pthread_mutex_lock (&dev->lock);
-wakeup_needed = (dev->read_queue.count != 0);
-pthread_mutex_unlock (&dev->lock);
-if (wakeup_needed) {
+dev->asynch_io_latency = latency;
+if (_eth_ring_count (&dev->read_ring) != 0) {
   sim_debug(dev->dbit, dev->dptr, "Queueing automatic poll\n");
   sim_activate_abs (dev->dptr->units, dev->asynch_io_latency);
   }
@@ -2195,6 +3640,18 @@ if (wakeup_needed) {
 return SCPE_OK;
 }
 
+t_stat eth_set_async_burst (ETH_DEV *dev, int burst)
+{
+#if !defined(USE_READER_THREAD) || !defined(SIM_ASYNCH_IO)
+return SCPE_NOFNC;
+#else
+if (!dev) return SCPE_UNATT;
+
+dev->asynch_io_burst = burst;
+return SCPE_OK;
+#endif
+}
+
 t_stat eth_clr_async (ETH_DEV *dev)
 {
 #if !defined(USE_READER_THREAD) || !defined(SIM_ASYNCH_IO)
@@ -2232,9 +3689,38 @@ if (bufsz < ETH_MAX_JUMBO_FRAME)
 
 /* attempt to connect device */
 memset(errbuf, 0, PCAP_ERRBUF_SIZE);
+if (0 == strncmp("afpacket:", savname, 9)) {
+#if defined(HAVE_AFPACKET_NETWORK)
+  if (!strcmp(savname, "afpacket:device"))
+    return sim_messagef (SCPE_OPENERR, "Eth: Must specify actual host interface name (i.e. afpacket:eth0)\n");
+  if (SCPE_OK == _eth_afpacket_open (savname + 9, handle, fd_handle, errbuf))
+    *eth_api = ETH_API_AFPACKET;
+  else
+    if (errbuf[0] == 0)
+      strlcpy(errbuf, "AF_PACKET open failed", PCAP_ERRBUF_SIZE);
+#else
+  strlcpy(errbuf, "No support for afpacket: devices", PCAP_ERRBUF_SIZE);
+#endif /* defined(HAVE_AFPACKET_NETWORK) */
+  }
+else
+if (0 == strncmp("shm:", savname, 4)) {
+#if defined(HAVE_SHM_NETWORK)
+  if (!strcmp(savname, "shm:switchname"))
+    return sim_messagef (SCPE_OPENERR, "Eth: Must specify actual switch name (i.e. shm:cluster)\n");
+  if (SCPE_OK == _eth_shm_open (savname + 4, handle, fd_handle, errbuf))
+    *eth_api = ETH_API_SHM;
+  else
+    if (errbuf[0] == 0)
+      strlcpy(errbuf, "Shared memory switch open failed", PCAP_ERRBUF_SIZE);
+#else
+  strlcpy(errbuf, "No support for shm: devices", PCAP_ERRBUF_SIZE);
+#endif /* defined(HAVE_SHM_NETWORK) */
+  }
+else
 if (0 == strncmp("tap:", savname, 4)) {
   int  tun = -1;    /* TUN/TAP Socket */
   int  on = 1;
+  int  vnet = 0;    /* frames carry a virtio_net_hdr */
   const char *devname = savname + 4;
 
   while (isspace(*devname))
@@ -2251,9 +3737,21 @@ if (0 == strncmp("tap:", savname, 4)) {
     /* Set up interface flags */
     strlcpy(ifr.ifr_name, devname, sizeof(ifr.ifr_name));
     ifr.ifr_flags = IFF_TAP|IFF_NO_PI;
+#if defined (HAVE_TAP_VNET_HDR)
+    /* Prefer frames with a virtio_net_hdr so offloads can be enabled */
+    ifr.ifr_flags |= IFF_VNET_HDR;
+    if (ioctl(tun, TUNSETIFF, &ifr) >= 0) {
+      vnet = 1;
+      (void)ioctl(tun, TUNSETOFFLOAD, TUN_F_CSUM|TUN_F_TSO4);
+      }
+    else {
+      ifr.ifr_flags &= ~IFF_VNET_HDR;
+      strlcpy(ifr.ifr_name, devname, sizeof(ifr.ifr_name));
+      }
+#endif
 
     /* Send interface requests to TUN/TAP driver. */
-    if (ioctl(tun, TUNSETIFF, &ifr) >= 0) {
+    if (vnet || (ioctl(tun, TUNSETIFF, &ifr) >= 0)) {
       if (ioctl(tun, FIONBIO, &on)) {
         strlcpy(errbuf, strerror(errno), PCAP_ERRBUF_SIZE);
         close(tun);
@@ -2325,7 +3823,7 @@ if (0 == strncmp("tap:", savname, 4)) {
 #endif /* !defined(__linux) && !defined(HAVE_BSDTUNTAP) */
   if (0 == errbuf[0]) {
     *eth_api = ETH_API_TAP;
-    *handle = (void *)1;  /* Flag used to indicated open */
+    *handle = vnet ? ETH_TAP_OPEN_VNET : ETH_TAP_OPEN;  /* Flag used to indicated open */
     }
   }
 else { /* !tap: */
@@ -2384,27 +3882,49 @@ else { /* !tap: */
       if (0 == strncmp("udp:", savname, 4)) {
         char localport[CBUFSIZE], host[CBUFSIZE], port[CBUFSIZE];
         char hostport[2*CBUFSIZE];
-        const char *devname = savname + 4;
+        char devname[CBUFSIZE];
+        const char *cptr = savname + 4;
+        ETH_UDP *udp;
 
         if (!strcmp(savname, "udp:sourceport:remotehost:remoteport"))
           return sim_messagef (SCPE_OPENERR, "Eth: Must specify actual udp host and ports(i.e. udp:1224:somehost.com:2234)\n");
 
-        while (isspace(*devname))
-          ++devname;
-        if (SCPE_OK != sim_parse_addr_ex (devname, host, sizeof(host), "localhost", port, sizeof(port), localport, sizeof(localport), NULL))
+        while (isspace(*cptr))
+          ++cptr;
+        strlcpy (devname, cptr, sizeof(devname));
+        udp = (ETH_UDP *)calloc (1, sizeof (*udp));
+        if (!udp)
+          return SCPE_MEM;
+        if (SCPE_OK != _eth_udp_options (devname, udp, errbuf)) {
+          _eth_udp_close (udp);
+          return SCPE_OPENERR;
+          }
+        if (SCPE_OK != sim_parse_addr_ex (devname, host, sizeof(host), "localhost", port, sizeof(port), localport, sizeof(localport), NULL)) {
+          _eth_udp_close (udp);
           return SCPE_OPENERR;
+          }
 
         if (localport[0] == '\0')
           strcpy (localport, port);
         sprintf (hostport, "%s:%s", host, port);
         if ((SCPE_OK == sim_parse_addr (hostport, NULL, 0, NULL, NULL, 0, NULL, "localhost")) &&
-            (0 == strcmp (localport, port)))
+            (0 == strcmp (localport, port))) {
+          _eth_udp_close (udp);
           return sim_messagef (SCPE_OPENERR, "Eth: Must specify different udp localhost ports\n");
+          }
         *fd_handle = sim_connect_sock_ex (localport, hostport, NULL, NULL, SIM_SOCK_OPT_DATAGRAM);
-        if (INVALID_SOCKET == *fd_handle)
+        if (INVALID_SOCKET == *fd_handle) {
+          _eth_udp_close (udp);
+          return SCPE_OPENERR;
+          }
+        if (SCPE_OK != _eth_udp_setup (udp, *fd_handle, errbuf)) {
+          sim_close_sock (*fd_handle);
+          *fd_handle = 0;
+          _eth_udp_close (udp);
           return SCPE_OPENERR;
+          }
         *eth_api = ETH_API_UDP;
-        *handle = (void *)1;  /* Flag used to indicated open */
+        *handle = (void *)udp;
         }
       else { /* not udp:, so attempt to open the parameter as if it were an explicit device name */
 #if defined(HAVE_PCAP_NETWORK)
@@ -2581,7 +4101,7 @@ dev->dbit = dbit;
 if (1) {
   pthread_attr_t attr;
 
-  ethq_init (&dev->read_queue, 200);         /* initialize FIFO queue */
+  _eth_ring_init (&dev->read_ring, ETH_READ_RING_SIZE); /* initialize receive ring */
   pthread_mutex_init (&dev->lock, NULL);
   pthread_mutex_init (&dev->writer_lock, NULL);
   pthread_mutex_init (&dev->self_lock, NULL);
@@ -2598,10 +4118,19 @@ if (1) {
     }
   }
 #endif /* defined(__hpux) */
+#if defined (HAVE_AFPACKET_NETWORK)
+  if (dev->eth_api == ETH_API_AFPACKET)
+    _eth_afpacket_subscribe (dev);              /* receive ring is ready */
+#endif
   pthread_create (&dev->reader_thread, &attr, _eth_reader, (void *)dev);
   pthread_create (&dev->writer_thread, &attr, _eth_writer, (void *)dev);
   pthread_attr_destroy(&attr);
   }
+#else
+#if defined (HAVE_AFPACKET_NETWORK)
+if (dev->eth_api == ETH_API_AFPACKET)
+  _eth_afpacket_subscribe (dev);
+#endif
 #endif /* defined (USE_READER_THREAD */
 _eth_add_to_open_list (dev);
 /* 
@@ -2637,7 +4166,18 @@ switch (eth_api) {
 #endif
   case ETH_API_UDP:
     sim_close_sock(pcap_fd);
+    _eth_udp_close((ETH_UDP *)pcap);
+    break;
+#ifdef HAVE_AFPACKET_NETWORK
+  case ETH_API_AFPACKET:
+    _eth_afpacket_close((AFPACKET *)pcap);
     break;
+#endif
+#ifdef HAVE_SHM_NETWORK
+  case ETH_API_SHM:
+    _eth_shm_close((ETH_SHM *)pcap);
+    break;
+#endif
   }
 return SCPE_OK;
 }
@@ -2650,6 +4190,11 @@ SOCKET pcap_fd;
 /* make sure device exists */
 if (!dev) return SCPE_UNATT;
 
+#if defined (HAVE_AFPACKET_NETWORK)
+if ((dev->eth_api == ETH_API_AFPACKET) && dev->handle)
+  _eth_afpacket_unsubscribe (dev);          /* no more frames from a shared socket */
+#endif
+
 /* close the device */
 pcap_fd = dev->fd_handle;                   /* save handle to possibly close later */
 pcap = (pcap_t *)dev->handle;
@@ -2676,7 +4221,7 @@ if (1) {
     free(buffer);
     }
   }
-ethq_destroy (&dev->read_queue);         /* release FIFO queue */
+_eth_ring_destroy (&dev->read_ring);     /* release receive ring */
 #endif
 
 _eth_close_port (dev->eth_api, pcap, pcap_fd);
@@ -2724,16 +4269,32 @@ fprintf (st, "    eth0   en0                                  (No description av
 #if defined(HAVE_TAP_NETWORK)
 fprintf (st, "    eth1   tap:tapN                             (Integrated Tun/Tap support)\n");
 #endif
+#if defined(HAVE_AFPACKET_NETWORK)
+fprintf (st, "    eth2   afpacket:device                      (Integrated AF_PACKET mmap ring support)\n");
+#endif
 #if defined(HAVE_VDE_NETWORK)
-fprintf (st, "    eth2   vde:device{:switch-port-number}      (Integrated VDE support)\n");
+fprintf (st, "    eth3   vde:device{:switch-port-number}      (Integrated VDE support)\n");
 #endif
 #if defined(HAVE_SLIRP_NETWORK)
-fprintf (st, "    eth3   nat:{optional-nat-parameters}        (Integrated NAT (SLiRP) support)\n");
+fprintf (st, "    eth4   nat:{optional-nat-parameters}        (Integrated NAT (SLiRP) support)\n");
+#endif
+fprintf (st, "    eth5   udp:sourceport:remotehost:remoteport (Integrated UDP bridge support)\n");
+#if defined(HAVE_SHM_NETWORK)
+fprintf (st, "    eth6   shm:switchname                       (Integrated shared memory switch support)\n");
 #endif
-fprintf (st, "    eth4   udp:sourceport:remotehost:remoteport (Integrated UDP bridge support)\n");
 fprintf (st, "   sim> ATTACH %s eth0\n\n", dptr->name);
 fprintf (st, "or equivalently:\n\n");
 fprintf (st, "   sim> ATTACH %s en0\n\n", dptr->name);
+fprintf (st, "The udp: transport accepts optional parameters after the addresses:\n\n");
+fprintf (st, "   sim> ATTACH %s udp:1224:somehost.com:2234,BATCH=32,RCVBUF=4M\n\n", dptr->name);
+fprintf (st, "BATCH is the number of datagrams moved per system call (1-%d, default %d)\n", ETH_UDP_MAX_BATCH, ETH_UDP_DEFAULT_BATCH);
+fprintf (st, "and RCVBUF sets the socket receive buffer size in bytes (K or M suffix).\n\n");
+#if defined(HAVE_SHM_NETWORK)
+fprintf (st, "The shm: transport connects simulators on the same host which attach to the\n");
+fprintf (st, "same switch name, without the frames passing through the host's kernel:\n\n");
+fprintf (st, "   sim> ATTACH %s shm:cluster\n\n", dptr->name);
+fprintf (st, "A switch has %d ports.\n\n", SHM_PORTS);
+#endif
 #if defined(HAVE_SLIRP_NETWORK)
 sim_slirp_attach_help (st, dptr, uptr, flag, cptr);
 #endif
@@ -2948,6 +4509,12 @@ switch (dev->eth_api) {
   case ETH_API_NAT:
       netname = "nat";
       break;
+  case ETH_API_AFPACKET:
+      netname = "afpacket";
+      break;
+  case ETH_API_SHM:
+      netname = "shm";
+      break;
   }
 sprintf(msg, "%s(%s): ", where, netname);
 switch (dev->eth_api) {
@@ -2995,8 +4562,15 @@ if (dev->error_needs_reset) {
 
   r = _eth_open_port(dev->name, &dev->eth_api, &dev->handle, &dev->fd_handle, errbuf, dev->bpf_filter, (void *)dev, dev->dptr, dev->dbit);
   dev->error_needs_reset = FALSE;
-  if (r == SCPE_OK)
+  if (r == SCPE_OK) {
+#if defined (HAVE_AFPACKET_NETWORK)
+    if (dev->eth_api == ETH_API_AFPACKET)
+      _eth_afpacket_subscribe (dev);
+#endif
+    dev->kernel_filter = 0;
+    _eth_kernel_filter (dev);                   /* new handle, filter it again */
     sim_printf ("%s ReOpened: %s \n", msg, dev->name);
+    }
   else
     sim_printf ("%s ReOpen Attempt Failed: %s - %s\n", msg, dev->name, errbuf);
   ++dev->error_reopen_count;
@@ -3053,7 +4627,7 @@ if ((packet->len >= ETH_MIN_PACKET) && (packet->len <= ETH_MAX_PACKET)) {
 #endif
 #ifdef HAVE_TAP_NETWORK
     case ETH_API_TAP:
-      status = (((int)packet->len == write(dev->fd_handle, (void *)packet->msg, packet->len)) ? 0 : -1);
+      status = _eth_tap_write (dev, packet);
       break;
 #endif
 #ifdef HAVE_VDE_NETWORK
@@ -3078,8 +4652,26 @@ if ((packet->len >= ETH_MIN_PACKET) && (packet->len <= ETH_MAX_PACKET)) {
       break;
 #endif
     case ETH_API_UDP:
-      status = (((int32)packet->len == sim_write_sock (dev->fd_handle, (char *)packet->msg, (int32)packet->len)) ? 0 : -1);
+#if defined (USE_READER_THREAD)
+      status = _eth_udp_write (dev, packet->msg, packet->len, dev->write_more);
+#else
+      status = _eth_udp_write (dev, packet->msg, packet->len, 0);
+#endif
+      break;
+#ifdef HAVE_AFPACKET_NETWORK
+    case ETH_API_AFPACKET:
+#if defined (USE_READER_THREAD)
+      status = _eth_afpacket_write (dev, packet->msg, packet->len, dev->write_more);
+#else
+      status = _eth_afpacket_write (dev, packet->msg, packet->len, 0);
+#endif
+      break;
+#endif
+#ifdef HAVE_SHM_NETWORK
+    case ETH_API_SHM:
+      status = _eth_shm_write (dev, packet->msg, packet->len);
       break;
+#endif
     }
   ++dev->packets_sent;              /* basic bookkeeping */
   /* On error, correct loopback bookkeeping */
@@ -3107,35 +4699,35 @@ if (routine)
 return ((status == 0) ? SCPE_OK : SCPE_IOERR);
 }
 
-t_stat eth_write(ETH_DEV* dev, ETH_PACK* packet, ETH_PCALLBACK routine)
-{
 #ifdef USE_READER_THREAD
+static ETH_WRITE_REQUEST *_eth_write_get_request (ETH_DEV* dev)
+{
 ETH_WRITE_REQUEST *request;
-int write_queue_size = 1;
-
-/* make sure device exists */
-if ((!dev) || (dev->eth_api == ETH_API_NONE)) return SCPE_UNATT;
-
-if (packet->len > sizeof (packet->msg)) /* packet ovesized? */
-    return SCPE_IERR;                   /* that's no good! */
 
-/* Get a buffer */
 pthread_mutex_lock (&dev->writer_lock);
 if (NULL != (request = dev->write_buffers))
   dev->write_buffers = request->next;
 pthread_mutex_unlock (&dev->writer_lock);
 if (NULL == request)
   request = (ETH_WRITE_REQUEST *)malloc(sizeof(*request));
+return request;
+}
 
-/* Copy buffer contents */
-request->packet.len = packet->len;
-request->packet.used = packet->used;
-request->packet.status = packet->status;
-request->packet.crc_len = packet->crc_len;
-memcpy(request->packet.msg, packet->msg, packet->len);
+static void _eth_write_free_request (ETH_DEV* dev, ETH_WRITE_REQUEST *request)
+{
+pthread_mutex_lock (&dev->writer_lock);
+request->next = dev->write_buffers;
+dev->write_buffers = request;
+pthread_mutex_unlock (&dev->writer_lock);
+}
+
+static t_stat _eth_write_queue_request (ETH_DEV* dev, ETH_WRITE_REQUEST *request, ETH_PCALLBACK routine)
+{
+int write_queue_size = 1;
 
 /* Insert buffer at the end of the write list (to make sure that */
 /* packets make it to the wire in the order they were presented here) */
+request->queued_nsec = sim_host_nsec ();
 pthread_mutex_lock (&dev->writer_lock);
 request->next = NULL;
 if (dev->write_requests) {
@@ -3161,8 +4753,92 @@ pthread_cond_signal (&dev->writer_cond);
 if (routine)
   (routine)(dev->write_status);
 return dev->write_status;
+}
+#endif
+
+t_stat eth_write(ETH_DEV* dev, ETH_PACK* packet, ETH_PCALLBACK routine)
+{
+#ifdef USE_READER_THREAD
+ETH_WRITE_REQUEST *request;
+
+/* make sure device exists */
+if ((!dev) || (dev->eth_api == ETH_API_NONE)) return SCPE_UNATT;
+
+if (packet->len > sizeof (packet->msg)) /* packet ovesized? */
+    return SCPE_IERR;                   /* that's no good! */
+
+/* Get a buffer */
+request = _eth_write_get_request (dev);
+
+/* Copy buffer contents */
+request->packet.len = packet->len;
+request->packet.used = packet->used;
+request->packet.status = packet->status;
+request->packet.crc_len = packet->crc_len;
+memcpy(request->packet.msg, packet->msg, packet->len);
+
+return _eth_write_queue_request (dev, request, routine);
+#else
+t_uint64 start = sim_host_nsec ();
+t_stat status = _eth_write(dev, packet, routine);
+
+if (dev)
+  sim_latency_record (&dev->tx_host, sim_host_nsec () - start);
+return status;
+#endif
+}
+
+/* Write a packet whose data is still in bus memory, as a list of segments
+   read with the device's bus read routine.  The segments are read straight
+   into the packet that is handed to the writer thread, so a frame is
+   copied once on its way to the wire rather than first into a device
+   buffer and then again into a write request.  Nothing is sent if a
+   segment can't be read; SCPE_NXM is returned so the device can report
+   its bus error. */
+
+t_stat eth_writev(ETH_DEV* dev, const ETH_IOVEC* iov, int iovcnt, ETH_IOREAD reader, ETH_PCALLBACK routine)
+{
+#ifdef USE_READER_THREAD
+ETH_WRITE_REQUEST *request;
+ETH_PACK *packet;
+#else
+ETH_PACK local;
+ETH_PACK *packet = &local;
+#endif
+uint32 len = 0;
+int i;
+
+/* make sure device exists */
+if ((!dev) || (dev->eth_api == ETH_API_NONE)) return SCPE_UNATT;
+
+for (i = 0; i < iovcnt; i++)
+  len += iov[i].len;
+if (len > sizeof (packet->msg))         /* packet ovesized? */
+    return SCPE_IERR;                   /* that's no good! */
+
+#ifdef USE_READER_THREAD
+request = _eth_write_get_request (dev);
+packet = &request->packet;
+#endif
+packet->oversize = NULL;
+packet->len = 0;
+for (i = 0; i < iovcnt; i++) {
+  if (reader (iov[i].ba, (int32)iov[i].len, &packet->msg[packet->len])) {
+#ifdef USE_READER_THREAD
+    _eth_write_free_request (dev, request);
+#endif
+    return SCPE_NXM;
+    }
+  packet->len += iov[i].len;
+  }
+packet->used = 0;
+packet->status = 0;
+packet->crc_len = 0;
+
+#ifdef USE_READER_THREAD
+return _eth_write_queue_request (dev, request, routine);
 #else
-return _eth_write(dev, packet, routine);
+return eth_write (dev, packet, routine);
 #endif
 }
 
@@ -3664,13 +5340,49 @@ eth_packet_trace(dev, response.msg, response.len, "loopbackforward");
 return 1;
 }
 
+/* The filter addresses are also kept in a small open addressed hash
+   table so that the receive path can match a destination or source
+   address with one or two compares instead of scanning the whole list.
+   The table is rebuilt by eth_filter_hash_ex whenever the filter set
+   changes. */
+
+#define ETH_FILTER_HASH(mac) ((((mac)[3] << 2) ^ ((mac)[4] << 1) ^ (mac)[5]) & (ETH_FILTER_SLOTS - 1))
+
+static void _eth_filter_slots (ETH_DEV *dev)
+{
+int i, h;
+
+memset (dev->filter_slot, 0, sizeof (dev->filter_slot));
+for (i = 0; i < dev->addr_count; i++) {
+  h = ETH_FILTER_HASH(dev->filter_address[i]);
+  while (dev->filter_slot[h] != 0) {
+    if (memcmp (dev->filter_address[dev->filter_slot[h] - 1], dev->filter_address[i], sizeof(ETH_MAC)) == 0)
+      break;                                    /* duplicate address */
+    h = (h + 1) & (ETH_FILTER_SLOTS - 1);
+    }
+  if (dev->filter_slot[h] == 0)
+    dev->filter_slot[h] = (uint8)(i + 1);
+  }
+}
+
+static int _eth_filter_match (const ETH_DEV *dev, const u_char *mac)
+{
+int h = ETH_FILTER_HASH(mac);
+
+while (dev->filter_slot[h] != 0) {
+  if (memcmp (dev->filter_address[dev->filter_slot[h] - 1], mac, sizeof(ETH_MAC)) == 0)
+    return 1;
+  h = (h + 1) & (ETH_FILTER_SLOTS - 1);
+  }
+return 0;
+}
+
 static void
 _eth_callback(u_char* info, const struct pcap_pkthdr* header, const u_char* data)
 {
 ETH_DEV*  dev = (ETH_DEV*) info;
 int to_me;
 int from_me = 0;
-int i;
 int bpf_used;
 
 if (LOOPBACK_PHYSICAL_RESPONSE(dev, data)) {
@@ -3700,14 +5412,14 @@ switch (dev->eth_api) {
   case ETH_API_VDE:
   case ETH_API_UDP:
   case ETH_API_NAT:
+  case ETH_API_AFPACKET:
+  case ETH_API_SHM:
     bpf_used = 0;
     to_me = 0;
     eth_packet_trace (dev, data, header->len, "received");
 
-    for (i = 0; i < dev->addr_count; i++) {
-      if (memcmp(data, dev->filter_address[i], 6) == 0) to_me = 1;
-      if (memcmp(&data[6], dev->filter_address[i], 6) == 0) from_me = 1;
-    }
+    to_me = _eth_filter_match (dev, data);
+    from_me = _eth_filter_match (dev, &data[6]);
 
     /* all multicast mode? */
     if (dev->all_multicast && (data[0] & 0x01)) to_me = 1;
@@ -3762,34 +5474,36 @@ if (bpf_used ? to_me : (to_me && !from_me)) {
     return;  
 #if defined (USE_READER_THREAD)
   if (1) {
-    int crc_len = 0;
-    uint8 crc_data[4];
+    ETH_ITEM *item = _eth_ring_reserve (&dev->read_ring);
     uint32 len = header->len;
-    u_char *moved_data = NULL;
 
-    if (header->len < ETH_MIN_PACKET) {   /* Pad runt packets before CRC append */
-      moved_data = (u_char *)malloc(ETH_MIN_PACKET);
-      memcpy(moved_data, data, len);
-      memset(moved_data + len, 0, ETH_MIN_PACKET-len);
+    if (item == NULL) {
+      eth_packet_trace (dev, data, len, "dropped - receive ring full");
+      return;
+      }
+    /* Build the frame in place in its ring slot */
+    memcpy(item->packet.msg, data, len);
+    if (len < ETH_MIN_PACKET) {           /* Pad runt packets before CRC append */
+      memset(&item->packet.msg[len], 0, ETH_MIN_PACKET-len);
       len = ETH_MIN_PACKET;
-      data = moved_data;
       }
 
     /* If necessary, fix IP header checksums for packets originated locally */
     /* but were presumed to be traversing a NIC which was going to handle that task */
     /* This must be done before any needed CRC calculation */
-    _eth_fix_ip_xsum_offload(dev, (const u_char*)data, len);
-    
-    if (dev->need_crc)
-      crc_len = eth_get_packet_crc32_data(data, len, crc_data);
+    _eth_fix_ip_xsum_offload(dev, item->packet.msg, len);
 
-    eth_packet_trace (dev, data, len, "rcvqd");
+    item->type = ETH_ITM_NORMAL;
+    item->packet.len = len;
+    item->packet.used = 0;
+    item->packet.status = 0;
+    item->packet.crc_len = dev->need_crc ? eth_add_packet_crc32(item->packet.msg, len) : 0;
 
-    pthread_mutex_lock (&dev->lock);
-    ethq_insert_data(&dev->read_queue, ETH_ITM_NORMAL, data, 0, len, crc_len, crc_data, 0);
+    eth_packet_trace (dev, item->packet.msg, len, "rcvqd");
+
+    item->queued_nsec = sim_host_nsec ();
+    _eth_ring_commit (&dev->read_ring);
     ++dev->packets_received;
-    pthread_mutex_unlock (&dev->lock);
-    free(moved_data);
     }
 #else /* !USE_READER_THREAD */
   /* set data in passed read packet */
@@ -3826,6 +5540,9 @@ if (bpf_used ? to_me : (to_me && !from_me)) {
 int eth_read(ETH_DEV* dev, ETH_PACK* packet, ETH_PCALLBACK routine)
 {
 int status;
+#if !defined (USE_READER_THREAD)
+t_uint64 start;
+#endif
 
 /* make sure device exists */
 
@@ -3836,6 +5553,7 @@ if (!packet) return 0;
 
 packet->len = 0;
 #if !defined (USE_READER_THREAD)
+start = sim_host_nsec ();
 /* set read packet */
 dev->read_packet = packet;
 
@@ -3852,25 +5570,7 @@ do {
 #endif
 #ifdef HAVE_TAP_NETWORK
     case ETH_API_TAP:
-      if (1) {
-        struct pcap_pkthdr header;
-        int len;
-        u_char buf[ETH_MAX_JUMBO_FRAME];
-
-        memset(&header, 0, sizeof(header));
-        len = read(dev->fd_handle, buf, sizeof(buf));
-        if (len > 0) {
-          status = 1;
-          header.caplen = header.len = len;
-          _eth_callback((u_char *)dev, &header, buf);
-          }
-        else {
-          if (len < 0)
-            status = -1;
-          else
-            status = 0;
-          }
-        }
+      status = _eth_tap_read (dev);
       break;
 #endif /* HAVE_TAP_NETWORK */
 #ifdef HAVE_VDE_NETWORK
@@ -3896,26 +5596,18 @@ do {
         }
       break;
 #endif /* HAVE_VDE_NETWORK */
+#ifdef HAVE_AFPACKET_NETWORK
+    case ETH_API_AFPACKET:
+      status = _eth_afpacket_dispatch (dev, 1);
+      break;
+#endif /* HAVE_AFPACKET_NETWORK */
+#ifdef HAVE_SHM_NETWORK
+    case ETH_API_SHM:
+      status = _eth_shm_dispatch (dev, 1, 0);
+      break;
+#endif /* HAVE_SHM_NETWORK */
     case ETH_API_UDP:
-      if (1) {
-        struct pcap_pkthdr header;
-        int len;
-        u_char buf[ETH_MAX_JUMBO_FRAME];
-
-        memset(&header, 0, sizeof(header));
-        len = (int)sim_read_sock (dev->fd_handle, (char *)buf, (int32)sizeof(buf));
-        if (len > 0) {
-          status = 1;
-          header.caplen = header.len = len;
-          _eth_callback((u_char *)dev, &header, buf);
-          }
-        else {
-          if (len < 0)
-            status = -1;
-          else
-            status = 0;
-          }
-        }
+      status = _eth_udp_dispatch (dev, 1);
       break;
     }
   } while ((status > 0) && (0 == packet->len));
@@ -3923,20 +5615,24 @@ if (status < 0) {
   ++dev->receive_packet_errors;
   _eth_error (dev, "eth_reader");
   }
+if (packet->len)
+  sim_latency_record (&dev->rx_host, sim_host_nsec () - start);
 
 #else /* USE_READER_THREAD */
 
   status = 0;
-  pthread_mutex_lock (&dev->lock);
-  if (dev->read_queue.count > 0) {
-    ETH_ITEM* item = &dev->read_queue.item[dev->read_queue.head];
-    packet->len = item->packet.len;
-    packet->crc_len = item->packet.crc_len;
-    memcpy(packet->msg, item->packet.msg, ((packet->len > packet->crc_len) ? packet->len : packet->crc_len));
-    status = 1;
-    ethq_remove(&dev->read_queue);
-  }
-  pthread_mutex_unlock (&dev->lock);  
+  if (1) {
+    ETH_ITEM* item = _eth_ring_peek (&dev->read_ring);
+
+    if (item) {
+      sim_latency_record (&dev->rx_queued, sim_host_nsec () - item->queued_nsec);
+      packet->len = item->packet.len;
+      packet->crc_len = item->packet.crc_len;
+      memcpy(packet->msg, item->packet.msg, ((packet->len > packet->crc_len) ? packet->len : packet->crc_len));
+      status = 1;
+      _eth_ring_release (&dev->read_ring);
+      }
+    }
   if ((status) && (routine))
     routine(0);
 #endif
@@ -4036,6 +5732,174 @@ sim_debug(dev->dbit, dev->dptr, "BPF string is: |%s|\n", buf);
 return SCPE_OK;
 }
 
+/* Transports other than pcap deliver every frame to _eth_callback, which
+   then discards the ones the simulated interface doesn't want.  Where the
+   host can do this filtering itself, hand it a filter so that unwanted
+   traffic is dropped in the kernel before it costs us a wakeup and a copy:
+
+     TAP        the tun driver's TX filter (exact addresses + all multicast)
+     AF_PACKET  a classic BPF socket filter on the Ethernet header
+     UDP        the same BPF filter, offset past the UDP header
+
+   VDE, NAT and SHM frames never pass through a kernel socket filter, so
+   those remain filtered only in user space.  The kernel filter is always
+   a superset of what _eth_callback accepts (multicast hash matching and
+   reflection handling are still done there), so it never changes what
+   the simulator sees, only how much the host has to deliver. */
+
+#if defined(__linux) || defined(__linux__)
+#include <linux/filter.h>
+#endif
+#if defined(SO_ATTACH_FILTER) && defined(BPF_MAXINSNS)
+#define ETH_SOCK_FILTER 1
+#define ETH_SOCK_FILTER_MAX (5*ETH_MAX_DEVICE*(ETH_FILTER_MAX+1)+3)
+
+/* Build a BPF program that accepts frames sent to one of the filter
+   addresses of any of the ndevs devices sharing the socket (or to the
+   host NIC's address, which reflected frames carry) and, when any
+   multicast can be wanted, every multicast frame.  offset is where the
+   Ethernet header starts in the data the filter sees.  Returns the
+   program length, or 0 if every frame must be passed. */
+
+static int _eth_sock_filter_build (ETH_DEV **devs, int ndevs, uint32 offset, struct sock_filter *code)
+{
+ETH_MAC seen[ETH_MAX_DEVICE*(ETH_FILTER_MAX+1)];
+int nseen = 0, multicast = 0;
+int d, i, j, n = 0;
+
+for (d = 0; d < ndevs; d++) {
+  ETH_DEV *dev = devs[d];
+
+  if (dev->promiscuous)
+    return 0;
+  if (dev->all_multicast || dev->hash_filter)
+    multicast = 1;
+  for (i = 0; i <= dev->addr_count; i++) {
+    const u_char *mac;
+
+    if (i == dev->addr_count) {
+      if (!dev->have_host_nic_phy_addr)
+        break;
+      mac = dev->host_nic_phy_hw_addr;
+      }
+    else
+      mac = dev->filter_address[i];
+    for (j = 0; j < nseen; j++)
+      if (memcmp (seen[j], mac, sizeof(ETH_MAC)) == 0)
+        break;
+    if (j < nseen)
+      continue;                                 /* already tested */
+    memcpy (seen[nseen++], mac, sizeof(ETH_MAC));
+    code[n++] = (struct sock_filter)BPF_STMT(BPF_LD|BPF_W|BPF_ABS, offset);
+    code[n++] = (struct sock_filter)BPF_JUMP(BPF_JMP|BPF_JEQ|BPF_K, 
+                                             ((uint32)mac[0] << 24) | ((uint32)mac[1] << 16) | ((uint32)mac[2] << 8) | mac[3], 0, 3);
+    code[n++] = (struct sock_filter)BPF_STMT(BPF_LD|BPF_H|BPF_ABS, offset + 4);
+    code[n++] = (struct sock_filter)BPF_JUMP(BPF_JMP|BPF_JEQ|BPF_K, ((uint32)mac[4] << 8) | mac[5], 0, 1);
+    code[n++] = (struct sock_filter)BPF_STMT(BPF_RET|BPF_K, 0xFFFFFFFF);    /* accept whole frame */
+    }
+  }
+if (multicast) {
+  code[n++] = (struct sock_filter)BPF_STMT(BPF_LD|BPF_B|BPF_ABS, offset);
+  code[n++] = (struct sock_filter)BPF_JUMP(BPF_JMP|BPF_JSET|BPF_K, 0x01, 0, 1);
+  code[n++] = (struct sock_filter)BPF_STMT(BPF_RET|BPF_K, 0xFFFFFFFF);
+  }
+code[n++] = (struct sock_filter)BPF_STMT(BPF_RET|BPF_K, 0);             /* reject */
+return n;
+}
+
+static void _eth_sock_filter (ETH_DEV **devs, int ndevs, int fd, uint32 offset)
+{
+struct sock_filter code[ETH_SOCK_FILTER_MAX];
+struct sock_fprog prog;
+int d, len, dummy = 0;
+
+len = _eth_sock_filter_build (devs, ndevs, offset, code);
+if (len == 0) {
+  if (devs[0]->kernel_filter)
+    setsockopt (fd, SOL_SOCKET, SO_DETACH_FILTER, &dummy, sizeof(dummy));
+  }
+else {
+  prog.len = (unsigned short)len;
+  prog.filter = code;
+  if (setsockopt (fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) != 0) {
+    sim_debug(devs[0]->dbit, devs[0]->dptr, "SO_ATTACH_FILTER failed: %s\n", strerror(errno));
+    len = 0;
+    }
+  }
+for (d = 0; d < ndevs; d++)
+  devs[d]->kernel_filter = len;
+}
+#endif
+
+#if defined(HAVE_TAP_NETWORK) && defined(TUNSETTXFILTER)
+/* The tun driver matches the first 8 entries of its TX filter exactly,
+   provided the unicast addresses come first, and hashes any further
+   multicast entries, which still yields a superset. */
+
+static void _eth_tap_filter (ETH_DEV *dev)
+{
+union {
+  struct tun_filter tf;
+  u_char buf[sizeof(struct tun_filter) + ETH_FILTER_MAX * sizeof(ETH_MAC)];
+  } f;
+ETH_MAC *addr = (ETH_MAC *)&f.buf[sizeof(struct tun_filter)];
+int i, n = 0;
+
+memset (&f, 0, sizeof(f));
+if (!dev->promiscuous) {
+  for (i = 0; i < dev->addr_count; i++)
+    if (!(dev->filter_address[i][0] & 0x01))
+      memcpy (addr[n++], dev->filter_address[i], sizeof(ETH_MAC));
+  for (i = 0; i < dev->addr_count; i++)
+    if (dev->filter_address[i][0] & 0x01)
+      memcpy (addr[n++], dev->filter_address[i], sizeof(ETH_MAC));
+  if (dev->all_multicast || dev->hash_filter)
+    f.tf.flags = TUN_FLT_ALLMULTI;
+  }
+f.tf.count = (unsigned short)n;                 /* 0 = pass everything */
+if (ioctl ((int)dev->fd_handle, TUNSETTXFILTER, &f) >= 0)
+  dev->kernel_filter = n;
+else {
+  sim_debug(dev->dbit, dev->dptr, "TUNSETTXFILTER failed: %s\n", strerror(errno));
+  dev->kernel_filter = 0;
+  }
+}
+#endif
+
+static void _eth_kernel_filter (ETH_DEV *dev)
+{
+switch (dev->eth_api) {
+#if defined(ETH_SOCK_FILTER) && defined(HAVE_AFPACKET_NETWORK)
+  case ETH_API_AFPACKET:
+    if (1) {
+      AFPACKET *afp = (AFPACKET *)dev->handle;
+
+      if (!afp)
+        break;
+      _eth_afpacket_rx_lock (afp);
+      if (afp->nsubs > 0)                       /* one filter for everyone sharing it */
+        _eth_sock_filter (afp->subs, afp->nsubs, afp->fd, 0);
+      else
+        _eth_sock_filter (&dev, 1, afp->fd, 0);
+      _eth_afpacket_rx_unlock (afp);
+      }
+    break;
+#endif
+#if defined(ETH_SOCK_FILTER)
+  case ETH_API_UDP:
+    _eth_sock_filter (&dev, 1, (int)dev->fd_handle, 8); /* past the UDP header */
+    break;
+#endif
+#if defined(HAVE_TAP_NETWORK) && defined(TUNSETTXFILTER)
+  case ETH_API_TAP:
+    _eth_tap_filter (dev);
+    break;
+#endif
+  default:
+    break;
+  }
+}
+
 t_stat eth_filter(ETH_DEV* dev, int addr_count, ETH_MAC* const addresses,
                   ETH_BOOL all_multicast, ETH_BOOL promiscuous)
 {
@@ -4090,6 +5954,8 @@ if (match_broadcast) {
   }
 dev->addr_count = addr_count;
 
+_eth_filter_slots (dev);
+
 /* store other flags */
 dev->all_multicast = all_multicast;
 dev->promiscuous   = promiscuous;
@@ -4202,13 +6068,14 @@ if (dev->eth_api == ETH_API_PCAP) {
     pcap_freecode(&bpf);
     }
 #ifdef USE_READER_THREAD
-  pthread_mutex_lock (&dev->lock);
-  ethq_clear (&dev->read_queue); /* Empty FIFO Queue when filter list changes */
-  pthread_mutex_unlock (&dev->lock);
+  _eth_ring_clear (&dev->read_ring); /* Empty receive ring when filter list changes */
 #endif
   }
 #endif /* USE_BPF */
 
+/* let the host kernel drop what we would discard anyway */
+_eth_kernel_filter (dev);
+
 return SCPE_OK;
 }
 
@@ -4251,13 +6118,31 @@ if (dev->loopback_packets_processed)
 fprintf(st, "  Asynch Interrupts:       %s\n", dev->asynch_io?"Enabled":"Disabled");
 if (dev->asynch_io)
   fprintf(st, "  Interrupt Latency:       %d uSec\n", dev->asynch_io_latency);
+if (dev->asynch_io && dev->asynch_io_burst)
+  fprintf(st, "  Interrupt Burst:         %d frames\n", dev->asynch_io_burst);
 if (dev->throttle_count)
   fprintf(st, "  Throttle Delays:         %d\n", dev->throttle_count);
-fprintf(st, "  Read Queue: Count:       %d\n", dev->read_queue.count);
-fprintf(st, "  Read Queue: High:        %d\n", dev->read_queue.high);
-fprintf(st, "  Read Queue: Loss:        %d\n", dev->read_queue.loss);
+fprintf(st, "  Read Queue: Size:        %d\n", (int)dev->read_ring.size);
+fprintf(st, "  Read Queue: Count:       %d\n", (int)_eth_ring_count (&dev->read_ring));
+fprintf(st, "  Read Queue: High:        %d\n", (int)dev->read_ring.high);
+fprintf(st, "  Read Queue: Loss:        %d\n", (int)dev->read_ring.loss);
 fprintf(st, "  Peak Write Queue Size:   %d\n", dev->write_queue_peak);
 #endif
+if (dev->need_crc)
+  fprintf(st, "  CRC32 Implementation:    %s\n", _eth_crc32_kernel_name);
+if ((dev->eth_api == ETH_API_UDP) && dev->handle) {
+  ETH_UDP *udp = (ETH_UDP *)dev->handle;
+  int rcvbuf = 0;
+  socklen_t size = (socklen_t)sizeof (rcvbuf);
+
+#if defined (ETH_UDP_MMSG)
+  fprintf(st, "  UDP Batch Size:          %d (recvmmsg/sendmmsg)\n", udp->batch);
+#else
+  fprintf(st, "  UDP Batch Size:          %d\n", udp->batch);
+#endif
+  if (0 == getsockopt (dev->fd_handle, SOL_SOCKET, SO_RCVBUF, (char *)&rcvbuf, &size))
+    fprintf(st, "  UDP Receive Buffer:      %d%s\n", rcvbuf, udp->rcvbuf ? "" : " (default)");
+  }
 if (dev->error_needs_reset)
   fprintf(st, "  In Error Needs Reset:    True\n");
 if (dev->error_reopen_count)
@@ -4280,6 +6165,12 @@ if (dev->promiscuous)
   fprintf(st, "  Promiscuous mode:        Enabled\n");
 if (dev->bpf_filter)
   fprintf(st, "  BPF Filter: %s\n", dev->bpf_filter);
+if (dev->kernel_filter)
+  fprintf(st, "  Kernel Filter: %d %s\n", dev->kernel_filter, (dev->eth_api == ETH_API_TAP) ? "addresses" : "instructions");
+#if defined(HAVE_AFPACKET_NETWORK)
+if ((dev->eth_api == ETH_API_AFPACKET) && dev->handle && (((AFPACKET *)dev->handle)->nsubs > 1))
+  fprintf(st, "  Shared Capture:          %d devices\n", ((AFPACKET *)dev->handle)->nsubs);
+#endif
 #if defined(HAVE_SLIRP_NETWORK)
 if (dev->eth_api == ETH_API_NAT)
   sim_slirp_show ((SLIRP *)dev->handle, st);
@@ -4400,6 +6291,8 @@ for (eth_num=0; eth_num<eth_device_count; eth_num++) {
 
   if ((0 == memcmp (eth_list[eth_num].name, "nat:", 4)) ||
       (0 == memcmp (eth_list[eth_num].name, "tap:", 4)) ||
+      (0 == memcmp (eth_list[eth_num].name, "afpacket:", 9)) ||
+      (0 == memcmp (eth_list[eth_num].name, "shm:", 4)) ||
       (0 == memcmp (eth_list[eth_num].name, "vde:", 4)) ||
       (0 == memcmp (eth_list[eth_num].name, "udp:", 4)))
       continue;
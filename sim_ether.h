@@ -95,6 +95,19 @@ extern "C" {
 #undef USE_READER_THREAD
 #endif
 
+/* Linux AF_PACKET TPACKET_V3 mmap'd ring transport (doesn't need libpcap) */
+#if (defined(__linux) || defined(__linux__)) && !defined(DONT_USE_AFPACKET_NETWORK)
+#include <linux/if_packet.h>
+#if defined(TPACKET3_HDRLEN)
+#define HAVE_AFPACKET_NETWORK 1
+#endif
+#endif
+
+/* Shared memory virtual switch between simulators on the same host */
+#if (defined(__linux) || defined(__linux__)) && !defined(DONT_USE_SHM_NETWORK)
+#define HAVE_SHM_NETWORK 1
+#endif
+
 /* make common winpcap code a bit easier to read in this file */
 #if defined(_WIN32) || defined(VMS) || defined(__CYGWIN__)
 #define PCAP_READ_TIMEOUT -1
@@ -158,6 +171,7 @@ extern "C" {
 #define ETH_PROMISC            1                        /* promiscuous mode = true */
 #define ETH_TIMEOUT           -1                        /* read timeout in milliseconds (immediate) */
 #define ETH_FILTER_MAX        20                        /* maximum address filters */
+#define ETH_FILTER_SLOTS      64                        /* filter address hash slots (power of 2) */
 #define ETH_DEV_NAME_MAX     256                        /* maximum device name size */
 #define ETH_DEV_DESC_MAX     256                        /* maximum device description size */
 #define ETH_MIN_PACKET        60                        /* minimum ethernet packet size */
@@ -219,6 +233,7 @@ struct eth_item {
 #define ETH_ITM_SETUP    0
 #define ETH_ITM_LOOPBACK 1
 #define ETH_ITM_NORMAL   2
+  t_uint64            queued_nsec;                      /* host time the frame was queued */
   struct eth_packet   packet;
 };
 
@@ -232,6 +247,15 @@ struct eth_queue {
   struct eth_item*    item;
 };
 
+struct eth_ring {                                       /* single producer/single consumer packet ring */
+  uint32              size;                             /* slot count (power of 2) */
+  volatile uint32     head;                             /* next slot to consume (advanced by consumer only) */
+  volatile uint32     tail;                             /* next slot to fill (advanced by producer only) */
+  uint32              loss;                             /* frames dropped because the ring was full */
+  uint32              high;                             /* high water mark */
+  struct eth_item*    item;
+};
+
 typedef unsigned char ETH_MAC[6];
 
 struct eth_list {
@@ -247,8 +271,16 @@ typedef void (*ETH_PCALLBACK)(int status);
 typedef struct eth_list ETH_LIST;
 typedef struct eth_queue ETH_QUE;
 typedef struct eth_item ETH_ITEM;
+typedef struct eth_ring ETH_RING;
+typedef int32 (*ETH_IOREAD)(uint32 ba, int32 bc, uint8 *buf);   /* bus read (Map_ReadB) */
+struct eth_iovec {
+  uint32  ba;                                           /* bus address of segment */
+  uint32  len;                                          /* segment length in bytes */
+  };
+typedef struct eth_iovec ETH_IOVEC;
 struct eth_write_request {
   struct eth_write_request *next;
+  t_uint64 queued_nsec;                                 /* host time the request was queued */
   ETH_PACK packet;
   };
 typedef struct eth_write_request ETH_WRITE_REQUEST;
@@ -265,11 +297,15 @@ struct eth_device {
 #define ETH_API_VDE  3                                  /* VDE API in use */
 #define ETH_API_UDP  4                                  /* UDP API in use */
 #define ETH_API_NAT  5                                  /* NAT (SLiRP) API in use */
+#define ETH_API_AFPACKET 6                              /* Linux AF_PACKET mmap ring API in use */
+#define ETH_API_SHM  7                                  /* shared memory switch API in use */
   ETH_PCALLBACK read_callback;                          /* read callback function */
   ETH_PCALLBACK write_callback;                         /* write callback function */
   ETH_PACK*     read_packet;                            /* read packet */
   ETH_MAC       filter_address[ETH_FILTER_MAX];         /* filtering addresses */
   int           addr_count;                             /* count of filtering addresses */
+  uint8         filter_slot[ETH_FILTER_SLOTS];          /* filter_address index+1 by MAC hash, 0 = empty */
+  int           kernel_filter;                          /* instructions in host kernel filter, 0 = none */
   ETH_BOOL      promiscuous;                            /* promiscuous mode flag */
   ETH_BOOL      all_multicast;                          /* receive all multicast messages */
   ETH_BOOL      hash_filter;                            /* filter using AUTODIN II multicast hash */
@@ -288,6 +324,10 @@ struct eth_device {
   uint32        loopback_packets_processed;             /* Total Loopback Packets Processed */
   uint32        transmit_packet_errors;                 /* Total Send Packet Errors */
   uint32        receive_packet_errors;                  /* Total Read Packet Errors */
+  SIM_LATENCY   tx_host;                                /* host time of each packet send */
+  SIM_LATENCY   tx_queued;                              /* time sends waited for the writer thread */
+  SIM_LATENCY   rx_host;                                /* host time of each successful read */
+  SIM_LATENCY   rx_queued;                              /* time received frames waited for eth_read */
   int32         error_waiting_threads;                  /* Count of threads currently waiting after an error */
   ETH_BOOL      error_needs_reset;                      /* Flag indicating to force reset */
 #define ETH_ERROR_REOPEN_THRESHOLD 10                   /* Attempt ReOpen after 20 send/receive errors */
@@ -313,7 +353,10 @@ struct eth_device {
 #if defined (USE_READER_THREAD)
   int           asynch_io;                              /* Asynchronous Interrupt scheduling enabled */
   int           asynch_io_latency;                      /* instructions to delay pending interrupt */
-  ETH_QUE       read_queue;
+  int           asynch_io_burst;                        /* queued frames which interrupt at once */
+  ETH_RING      read_ring;                              /* received packets (reader thread -> eth_read) */
+#define ETH_READ_RING_SIZE 256                          /* received packet slots (power of 2) */
+#define ETH_READ_BATCH      64                          /* max frames read per reader thread wakeup */
   pthread_mutex_t     lock;
   pthread_t     reader_thread;                          /* Reader Thread Id */
   pthread_t     writer_thread;                          /* Writer Thread Id */
@@ -324,6 +367,7 @@ struct eth_device {
   int write_queue_peak;
   ETH_WRITE_REQUEST *write_buffers;
   t_stat write_status;
+  int write_more;                                       /* writer thread has more requests queued */
 #endif
 };
 
@@ -337,6 +381,9 @@ t_stat eth_close  (ETH_DEV* dev);                       /* close ethernet interf
 t_stat eth_attach_help(FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr);
 t_stat eth_write  (ETH_DEV* dev, ETH_PACK* packet,      /* write sychronous packet; */
                    ETH_PCALLBACK routine);              /*  callback when done */
+t_stat eth_writev (ETH_DEV* dev, const ETH_IOVEC* iov,  /* write packet gathered from */
+                   int iovcnt, ETH_IOREAD reader,       /*  bus memory segments; */
+                   ETH_PCALLBACK routine);              /*  callback when done */
 int eth_read      (ETH_DEV* dev, ETH_PACK* packet,      /* read single packet; */
                    ETH_PCALLBACK routine);              /*  callback when done*/
 t_stat eth_filter (ETH_DEV* dev, int addr_count,        /* set filter on incoming packets */
@@ -359,6 +406,7 @@ t_stat eth_check_address_conflict (ETH_DEV* dev,
 const char *eth_version (void);                         /* Version of dynamically loaded library (pcap) */
 void eth_setcrc   (ETH_DEV* dev, int need_crc);         /* enable/disable CRC mode */
 t_stat eth_set_async (ETH_DEV* dev, int latency);       /* set read behavior to be async */
+t_stat eth_set_async_burst (ETH_DEV* dev, int burst);   /* set frames which end async latency */
 t_stat eth_clr_async (ETH_DEV* dev);                    /* set read behavior to be not async */
 t_stat eth_set_throttle (ETH_DEV* dev, uint32 time, uint32 burst, uint32 delay); /* set transmit throttle parameters */
 uint32 eth_crc32(uint32 crc, const void* vbuf, size_t len); /* Compute Ethernet Autodin II CRC for buffer */
@@ -371,6 +419,9 @@ t_stat eth_show_devices (FILE* st, DEVICE *dptr,        /* show ethernet devices
                          UNIT* uptr, int32 val, CONST char* desc);
 int eth_devices (int max, ETH_LIST* dev, ETH_BOOL framers); /* get ethernet devices on host */
 void eth_show_dev (FILE*st, ETH_DEV* dev);              /* show ethernet device state */
+void eth_publish_metrics (void);                        /* add metrics endpoint samples */
+t_bool eth_show_statistics (FILE *st, DEVICE *dptr,     /* show latency statistics */
+                            t_bool clear);
 
 void eth_mac_fmt (ETH_MAC* const add, char* buffer);    /* format ethernet mac address */
 t_stat eth_mac_scan (ETH_MAC* mac, const char* strmac); /* scan string for mac, put in mac */
@@ -52,8 +52,20 @@
    sim_buf_copy_swapped -    copy data swapping elements along the way
    sim_buf_swap_data -       swap data elements inplace in buffer if needed
    sim_byte_swap_data -      swap data elements inplace in buffer
+   sim_mem_load_bytes -      store a byte stream into a word array memory
    sim_shmem_open            create or attach to a shared memory region
    sim_shmem_close           close a shared memory region
+   sim_mmap_open             map a file into memory
+   sim_mmap_open_readonly    map an existing file into memory for reading
+   sim_mmap_close            unmap a memory mapped file
+   sim_load_image_open       get the whole of a load file as one buffer
+   sim_load_image_close      release a load file buffer
+   sim_mem_alloc             allocate zeroed, lazily committed guest memory
+   sim_mem_realloc           resize guest memory preserving its contents
+   sim_mem_free              release guest memory
+   sim_mem_set               set guest memory options (SET MEMORY)
+   sim_mem_show              show guest memory host usage (SHOW MEMORY)
+   sim_hist_open             create or reopen a memory mapped instruction history
    sim_chdir                 change working directory
    sim_mkdir                 create a directory
    sim_rmdir                 remove a directory
@@ -64,6 +76,22 @@
    sim_get_filelist          get a list of files matching a pattern
    sim_free_filelist         free a filelist
    sim_print_filelist        print the elements of a filelist
+   sim_io_pool_register      attach a unit to the shared asynch I/O worker pool
+   sim_io_pool_submit        queue a unit's pending operation to the pool
+   sim_io_pool_unregister    detach a unit from the shared asynch I/O pool
+   sim_io_pool_busy          report whether pool operations are in flight
+   sim_spool_attach          attach a unit with spooled (buffered) output
+   sim_spool_putc            spool a character
+   sim_spool_write           spool a buffer
+   sim_spool_flush           hand spooled output to the writer
+   sim_spool_close           write out spooled output (from detach_unit)
+   sim_spool_set             set spool file rotation options
+   sim_spool_show            show spool options and statistics
+   sim_io_bench_init         parse a BENCHMARK workload description
+   sim_io_bench_start        note the start of a benchmark operation
+   sim_io_bench_stop         record a benchmark operation's completion
+   sim_io_bench_report       report benchmark throughput and latency
+   sim_io_bench_free         release benchmark state
 
    sim_fopen and sim_fseek are OS-dependent.  The other routines are not.
    sim_fsize is always a 32b routine (it is used only with small capacity random
@@ -105,7 +133,10 @@ t_bool sim_toffset_64;              /* Large File (>2GB) file I/O Support availa
    fread and fwrite.  If the host is little endian, or the data items
    are size char, then the calls are passed directly to fread or
    fwrite.  Otherwise, these routines perform the necessary byte swaps.
-   Sim_fread swaps in place, sim_fwrite uses an intermediate buffer.
+   Sim_fread swaps in place, sim_fwrite uses an intermediate buffer
+   (one per thread, reused across calls).  The common 2, 4 and 8 byte
+   element sizes are swapped with the compiler's byte swap intrinsics,
+   which loops the compiler can vectorize.
 */
 
 int32 sim_finit (void)
@@ -119,6 +150,73 @@ sim_taddr_64 = sim_toffset_64 && (sizeof(t_addr) > sizeof(int32));
 return sim_end;
 }
 
+#if defined (__GNUC__)
+#define SIM_BSWAP16(v)  __builtin_bswap16 (v)
+#define SIM_BSWAP32(v)  __builtin_bswap32 (v)
+#define SIM_BSWAP64(v)  __builtin_bswap64 (v)
+#elif defined (_MSC_VER)
+#define SIM_BSWAP16(v)  _byteswap_ushort (v)
+#define SIM_BSWAP32(v)  _byteswap_ulong (v)
+#define SIM_BSWAP64(v)  _byteswap_uint64 (v)
+#else
+#define SIM_BSWAP16(v)  ((uint16)(((v) >> 8) | ((v) << 8)))
+#define SIM_BSWAP32(v)  ((((v) >> 24) & 0xFF) | (((v) >> 8) & 0xFF00) | (((v) & 0xFF00) << 8) | ((v) << 24))
+#define SIM_BSWAP64(v)  ((((t_uint64)SIM_BSWAP32 ((uint32)(v))) << 32) | SIM_BSWAP32 ((uint32)((v) >> 32)))
+#endif
+
+/* Swap count elements of size bytes from sbuf to dbuf (which may be
+   the same buffer).  memcpy is used to load and store elements so the
+   buffers need not be aligned; compilers reduce it to plain moves. */
+
+static void _sim_swap_elements (void *dbuf, const void *sbuf, size_t size, size_t count)
+{
+const unsigned char *sptr = (const unsigned char *)sbuf;
+unsigned char *dptr = (unsigned char *)dbuf;
+size_t j, k;
+
+switch (size) {
+    case 2:
+        for (j = 0; j < count; j++, sptr += 2, dptr += 2) {
+            uint16 v;
+
+            memcpy (&v, sptr, sizeof (v));
+            v = SIM_BSWAP16 (v);
+            memcpy (dptr, &v, sizeof (v));
+            }
+        break;
+    case 4:
+        for (j = 0; j < count; j++, sptr += 4, dptr += 4) {
+            uint32 v;
+
+            memcpy (&v, sptr, sizeof (v));
+            v = SIM_BSWAP32 (v);
+            memcpy (dptr, &v, sizeof (v));
+            }
+        break;
+    case 8:
+        for (j = 0; j < count; j++, sptr += 8, dptr += 8) {
+            t_uint64 v;
+
+            memcpy (&v, sptr, sizeof (v));
+            v = SIM_BSWAP64 (v);
+            memcpy (dptr, &v, sizeof (v));
+            }
+        break;
+    default:
+        for (j = 0; j < count; j++, sptr += size, dptr += size) {
+            if (dptr != sptr)
+                memcpy (dptr, sptr, size);
+            for (k = 0; k < size / 2; k++) {            /* swap end-for-end */
+                unsigned char by = dptr[k];
+
+                dptr[k] = dptr[size - 1 - k];
+                dptr[size - 1 - k] = by;
+                }
+            }
+        break;
+    }
+}
+
 /* Copy little endian data to local buffer swapping if needed */
 void sim_buf_swap_data (void *bptr, size_t size, size_t count)
 {
@@ -129,21 +227,9 @@ sim_byte_swap_data (bptr, size, count);
 
 void sim_byte_swap_data (void *bptr, size_t size, size_t count)
 {
-uint32 j;
-int32 k;
-unsigned char by, *sptr, *dptr;
-
 if (sim_end || (count == 0) || (size == sizeof (char)))
     return;
-for (j = 0, dptr = sptr = (unsigned char *) bptr;       /* loop on items */
-     j < count; j++) { 
-    for (k = (int32)(size - 1); k >= (((int32) size + 1) / 2); k--) {
-        by = *sptr;                                     /* swap end-for-end */
-        *sptr++ = *(dptr + k);
-        *(dptr + k) = by;
-        }
-    sptr = dptr = dptr + size;                          /* next item */
-    }
+_sim_swap_elements (bptr, bptr, size, count);
 }
 
 size_t sim_fread (void *bptr, size_t size, size_t count, FILE *fptr)
@@ -161,36 +247,45 @@ return c;
 
 void sim_buf_copy_swapped (void *dbuf, const void *sbuf, size_t size, size_t count)
 {
-size_t j;
-int32 k;
-const unsigned char *sptr = (const unsigned char *)sbuf;
-unsigned char *dptr = (unsigned char *)dbuf;
+if (sim_end || (size == sizeof (char))) {
+    memcpy (dbuf, sbuf, size * count);
+    return;
+    }
+_sim_swap_elements (dbuf, sbuf, size, count);
+}
+
+/* Store count bytes of a little endian byte stream at byte address addr
+   of a memory held as an array of size byte, host order words (as the
+   PDP-11 and VAX M arrays are).  On a little endian host that is just a
+   copy. */
+
+void sim_mem_load_bytes (void *mem, size_t size, t_addr addr, const void *src, size_t count)
+{
+uint8 *mptr = (uint8 *)mem;
+const uint8 *sptr = (const uint8 *)src;
 
 if (sim_end || (size == sizeof (char))) {
-    memcpy (dptr, sptr, size * count);
+    memcpy (mptr + addr, sptr, count);
     return;
     }
-for (j = 0; j < count; j++) {                           /* loop on items */
-    for (k = (int32)(size - 1); k >= 0; k--)
-        *(dptr + k) = *sptr++;
-    dptr = dptr + size;
+while (count--) {
+    mptr[(addr & ~(t_addr)(size - 1)) + (size - 1 - (addr & (size - 1)))] = *sptr++;
+    ++addr;
     }
 }
 
+static AIO_TLS unsigned char sim_flip[FLIP_SIZE];       /* per thread flip buffer */
+
 size_t sim_fwrite (const void *bptr, size_t size, size_t count, FILE *fptr)
 {
 size_t c, nelem, nbuf, lcnt, total;
 int32 i;
 const unsigned char *sptr;
-unsigned char *sim_flip;
 
 if ((size == 0) || (count == 0))                        /* check arguments */
     return 0;
 if (sim_end || (size == sizeof (char)))                 /* le or byte? */
     return fwrite (bptr, size, count, fptr);            /* done */
-sim_flip = (unsigned char *)malloc(FLIP_SIZE);
-if (!sim_flip)
-    return 0;
 nelem = FLIP_SIZE / size;                               /* elements in buffer */
 nbuf = count / nelem;                                   /* number buffers */
 lcnt = count % nelem;                                   /* count in last buf */
@@ -201,15 +296,12 @@ sptr = (const unsigned char *) bptr;                    /* init input ptr */
 for (i = (int32)nbuf; i > 0; i--) {                     /* loop on buffers */
     c = (i == 1)? lcnt: nelem;
     sim_buf_copy_swapped (sim_flip, sptr, size, c);
-    sptr = sptr + size * count;
+    sptr = sptr + size * c;
     c = fwrite (sim_flip, size, c, fptr);
-    if (c == 0) {
-        free(sim_flip);
+    if (c == 0)
         return total;
-        }
     total = total + c;
     }
-free(sim_flip);
 return total;
 }
 
@@ -932,6 +1024,756 @@ return FALSE;
 #endif /* defined (__linux__) || defined (__APPLE__) */
 #endif /* defined (_WIN32) */
 
+/* Memory mapped files
+
+   sim_mmap_open maps a file into memory, creating (or resizing) it to
+   'size' bytes first, or mapping it at its existing size when 'size' is
+   zero.  Modified pages are written back by the host, so the contents
+   survive the simulator exiting or crashing.
+
+   sim_mmap_open_readonly maps an existing, non empty file which is only
+   read through the mapping.
+*/
+
+#if defined (_WIN32)
+
+struct SIM_MMAP {
+    HANDLE hFile;
+    HANDLE hMapping;
+    void *base;
+    };
+
+t_stat sim_mmap_open (const char *filename, t_offset size, SIM_MMAP **map, void **addr, t_offset *mapsize)
+{
+char namebuf[PATH_MAX + 1];
+LARGE_INTEGER fsize;
+SIM_MMAP *m;
+
+*map = NULL;
+*addr = NULL;
+if (NULL == _sim_expand_homedir (filename, namebuf, sizeof (namebuf)))
+    return SCPE_ARG;
+m = (SIM_MMAP *)calloc (1, sizeof (*m));
+if (m == NULL)
+    return SCPE_MEM;
+m->hMapping = NULL;
+m->hFile = CreateFileA (namebuf, GENERIC_READ|GENERIC_WRITE, FILE_SHARE_READ, NULL, size ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+if (m->hFile == INVALID_HANDLE_VALUE) {
+    free (m);
+    return sim_messagef (SCPE_OPENERR, "Can't open '%s': %s\n", filename, sim_get_os_error_text (GetLastError ()));
+    }
+if (size) {
+    fsize.QuadPart = (LONGLONG)size;
+    if ((!SetFilePointerEx (m->hFile, fsize, NULL, FILE_BEGIN)) ||
+        (!SetEndOfFile (m->hFile))) {
+        sim_mmap_close (m);
+        return sim_messagef (SCPE_OPENERR, "Can't extend '%s' to %" LL_FMT "d bytes: %s\n", filename, (LL_TYPE)size, sim_get_os_error_text (GetLastError ()));
+        }
+    }
+if ((!GetFileSizeEx (m->hFile, &fsize)) || (fsize.QuadPart == 0) ||
+    ((t_offset)(size_t)fsize.QuadPart != (t_offset)fsize.QuadPart)) {
+    sim_mmap_close (m);
+    return sim_messagef (SCPE_OPENERR, "'%s' can't be memory mapped\n", filename);
+    }
+m->hMapping = CreateFileMappingA (m->hFile, NULL, PAGE_READWRITE, 0, 0, NULL);
+if (m->hMapping != NULL)
+    m->base = MapViewOfFile (m->hMapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+if (m->base == NULL) {
+    DWORD LastError = GetLastError ();
+
+    sim_mmap_close (m);
+    return sim_messagef (SCPE_OPENERR, "Can't memory map '%s': %s\n", filename, sim_get_os_error_text (LastError));
+    }
+*map = m;
+*addr = m->base;
+*mapsize = (t_offset)fsize.QuadPart;
+return SCPE_OK;
+}
+
+t_stat sim_mmap_open_readonly (const char *filename, SIM_MMAP **map, const void **addr, t_offset *mapsize)
+{
+char namebuf[PATH_MAX + 1];
+LARGE_INTEGER fsize;
+SIM_MMAP *m;
+
+*map = NULL;
+*addr = NULL;
+if (NULL == _sim_expand_homedir (filename, namebuf, sizeof (namebuf)))
+    return SCPE_ARG;
+m = (SIM_MMAP *)calloc (1, sizeof (*m));
+if (m == NULL)
+    return SCPE_MEM;
+m->hMapping = NULL;
+m->hFile = CreateFileA (namebuf, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+if (m->hFile == INVALID_HANDLE_VALUE) {
+    free (m);
+    return sim_messagef (SCPE_OPENERR, "Can't open '%s': %s\n", filename, sim_get_os_error_text (GetLastError ()));
+    }
+if ((!GetFileSizeEx (m->hFile, &fsize)) || (fsize.QuadPart == 0) ||
+    ((t_offset)(size_t)fsize.QuadPart != (t_offset)fsize.QuadPart)) {
+    sim_mmap_close (m);
+    return sim_messagef (SCPE_OPENERR, "'%s' can't be memory mapped\n", filename);
+    }
+m->hMapping = CreateFileMappingA (m->hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+if (m->hMapping != NULL)
+    m->base = MapViewOfFile (m->hMapping, FILE_MAP_READ, 0, 0, 0);
+if (m->base == NULL) {
+    DWORD LastError = GetLastError ();
+
+    sim_mmap_close (m);
+    return sim_messagef (SCPE_OPENERR, "Can't memory map '%s': %s\n", filename, sim_get_os_error_text (LastError));
+    }
+*map = m;
+*addr = m->base;
+*mapsize = (t_offset)fsize.QuadPart;
+return SCPE_OK;
+}
+
+static t_stat _sim_mmap_stream (FILE *fptr, size_t size, SIM_MMAP **map, const void **addr)
+{
+SIM_MMAP *m;
+
+*map = NULL;
+m = (SIM_MMAP *)calloc (1, sizeof (*m));
+if (m == NULL)
+    return SCPE_MEM;
+m->hFile = INVALID_HANDLE_VALUE;                        /* the stream owns the file */
+m->hMapping = CreateFileMappingA ((HANDLE)_get_osfhandle (_fileno (fptr)), NULL, PAGE_READONLY, 0, 0, NULL);
+if (m->hMapping != NULL)
+    m->base = MapViewOfFile (m->hMapping, FILE_MAP_READ, 0, 0, size);
+if (m->base == NULL) {
+    sim_mmap_close (m);
+    return SCPE_OPENERR;
+    }
+*map = m;
+*addr = m->base;
+return SCPE_OK;
+}
+
+void sim_mmap_close (SIM_MMAP *map)
+{
+if (map == NULL)
+    return;
+if (map->base != NULL) {
+    FlushViewOfFile (map->base, 0);
+    UnmapViewOfFile (map->base);
+    }
+if (map->hMapping != NULL)
+    CloseHandle (map->hMapping);
+if (map->hFile != INVALID_HANDLE_VALUE)
+    CloseHandle (map->hFile);
+free (map);
+}
+
+#elif defined (__linux__) || defined (__APPLE__) || defined (__CYGWIN__) || defined (__FreeBSD__) || defined(__NetBSD__) || defined (__OpenBSD__)
+#include <sys/mman.h>
+
+struct SIM_MMAP {
+    int fd;
+    size_t size;
+    void *base;
+    };
+
+t_stat sim_mmap_open (const char *filename, t_offset size, SIM_MMAP **map, void **addr, t_offset *mapsize)
+{
+char namebuf[PATH_MAX + 1];
+struct stat statb;
+SIM_MMAP *m;
+
+*map = NULL;
+*addr = NULL;
+if (NULL == _sim_expand_homedir (filename, namebuf, sizeof (namebuf)))
+    return SCPE_ARG;
+m = (SIM_MMAP *)calloc (1, sizeof (*m));
+if (m == NULL)
+    return SCPE_MEM;
+m->base = MAP_FAILED;
+m->fd = open (namebuf, size ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR, 0666);
+if (m->fd == -1) {
+    free (m);
+    return sim_messagef (SCPE_OPENERR, "Can't open '%s': %s\n", filename, strerror (errno));
+    }
+if (size && ftruncate (m->fd, (off_t)size)) {           /* sparse until written */
+    int last_errno = errno;
+
+    sim_mmap_close (m);
+    return sim_messagef (SCPE_OPENERR, "Can't extend '%s' to %" LL_FMT "d bytes: %s\n", filename, (LL_TYPE)size, strerror (last_errno));
+    }
+if ((fstat (m->fd, &statb) != 0) ||
+    (!S_ISREG (statb.st_mode)) ||
+    (statb.st_size == 0) ||
+    ((t_offset)(size_t)statb.st_size != (t_offset)statb.st_size)) {
+    sim_mmap_close (m);
+    return sim_messagef (SCPE_OPENERR, "'%s' can't be memory mapped\n", filename);
+    }
+m->size = (size_t)statb.st_size;
+m->base = mmap (NULL, m->size, PROT_READ | PROT_WRITE, MAP_SHARED, m->fd, 0);
+if (m->base == MAP_FAILED) {
+    int last_errno = errno;
+
+    sim_mmap_close (m);
+    return sim_messagef (SCPE_OPENERR, "Can't memory map '%s': %s\n", filename, strerror (last_errno));
+    }
+*map = m;
+*addr = m->base;
+*mapsize = (t_offset)m->size;
+return SCPE_OK;
+}
+
+t_stat sim_mmap_open_readonly (const char *filename, SIM_MMAP **map, const void **addr, t_offset *mapsize)
+{
+char namebuf[PATH_MAX + 1];
+struct stat statb;
+SIM_MMAP *m;
+
+*map = NULL;
+*addr = NULL;
+if (NULL == _sim_expand_homedir (filename, namebuf, sizeof (namebuf)))
+    return SCPE_ARG;
+m = (SIM_MMAP *)calloc (1, sizeof (*m));
+if (m == NULL)
+    return SCPE_MEM;
+m->base = MAP_FAILED;
+m->fd = open (namebuf, O_RDONLY);
+if (m->fd == -1) {
+    free (m);
+    return sim_messagef (SCPE_OPENERR, "Can't open '%s': %s\n", filename, strerror (errno));
+    }
+if ((fstat (m->fd, &statb) != 0) ||
+    (!S_ISREG (statb.st_mode)) ||
+    (statb.st_size == 0) ||
+    ((t_offset)(size_t)statb.st_size != (t_offset)statb.st_size)) {
+    sim_mmap_close (m);
+    return sim_messagef (SCPE_OPENERR, "'%s' can't be memory mapped\n", filename);
+    }
+m->size = (size_t)statb.st_size;
+m->base = mmap (NULL, m->size, PROT_READ, MAP_PRIVATE, m->fd, 0);
+if (m->base == MAP_FAILED) {
+    int last_errno = errno;
+
+    sim_mmap_close (m);
+    return sim_messagef (SCPE_OPENERR, "Can't memory map '%s': %s\n", filename, strerror (last_errno));
+    }
+*map = m;
+*addr = m->base;
+*mapsize = (t_offset)m->size;
+return SCPE_OK;
+}
+
+static t_stat _sim_mmap_stream (FILE *fptr, size_t size, SIM_MMAP **map, const void **addr)
+{
+SIM_MMAP *m;
+
+*map = NULL;
+m = (SIM_MMAP *)calloc (1, sizeof (*m));
+if (m == NULL)
+    return SCPE_MEM;
+m->fd = -1;                                             /* the stream owns the file */
+m->size = size;
+m->base = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fileno (fptr), 0);
+if (m->base == MAP_FAILED) {
+    sim_mmap_close (m);
+    return SCPE_OPENERR;
+    }
+*map = m;
+*addr = m->base;
+return SCPE_OK;
+}
+
+void sim_mmap_close (SIM_MMAP *map)
+{
+if (map == NULL)
+    return;
+if (map->base != MAP_FAILED) {
+    msync (map->base, map->size, MS_ASYNC);
+    munmap (map->base, map->size);
+    }
+if (map->fd != -1)
+    close (map->fd);
+free (map);
+}
+
+#else
+
+t_stat sim_mmap_open (const char *filename, t_offset size, SIM_MMAP **map, void **addr, t_offset *mapsize)
+{
+*map = NULL;
+*addr = NULL;
+return sim_messagef (SCPE_NOFNC, "Memory mapped files aren't supported on this host\n");
+}
+
+t_stat sim_mmap_open_readonly (const char *filename, SIM_MMAP **map, const void **addr, t_offset *mapsize)
+{
+*map = NULL;
+*addr = NULL;
+return sim_messagef (SCPE_NOFNC, "Memory mapped files aren't supported on this host\n");
+}
+
+static t_stat _sim_mmap_stream (FILE *fptr, size_t size, SIM_MMAP **map, const void **addr)
+{
+*map = NULL;
+return SCPE_NOFNC;
+}
+
+void sim_mmap_close (SIM_MMAP *map)
+{
+}
+
+#endif
+
+/* Load images
+
+   sim_load_image_open gives a simulator's loader the whole of an open
+   load file as one read only buffer, so that it can parse the image in
+   place and deposit it in bulk rather than a getc and a memory write at
+   a time.  Regular files are memory mapped; if the file can't be mapped
+   it is read into an allocated buffer instead.  Either way the data
+   starts at the beginning of the file.
+*/
+
+t_stat sim_load_image_open (FILE *fptr, SIM_LOAD_IMAGE *image)
+{
+t_offset size = sim_fsize_ex (fptr);
+const void *addr;
+size_t alloc = 0;
+
+memset (image, 0, sizeof (*image));
+if (size == 0)                                          /* empty? */
+    return SCPE_OK;
+if (((t_offset)(size_t)size == size) &&
+    (_sim_mmap_stream (fptr, (size_t)size, &image->map, &addr) == SCPE_OK)) {
+    image->data = (const uint8 *)addr;
+    image->size = (size_t)size;
+    return SCPE_OK;
+    }
+if (sim_fseek (fptr, 0, SEEK_SET))                      /* can't map, read it */
+    return SCPE_IOERR;
+while (!feof (fptr) && !ferror (fptr)) {
+    if (image->size == alloc) {
+        uint8 *buf = (uint8 *)realloc (image->buf, alloc + 65536);
+
+        if (buf == NULL) {
+            sim_load_image_close (image);
+            return SCPE_MEM;
+            }
+        image->buf = buf;
+        alloc += 65536;
+        }
+    image->size += fread (image->buf + image->size, 1, alloc - image->size, fptr);
+    }
+if (ferror (fptr)) {
+    sim_load_image_close (image);
+    return SCPE_IOERR;
+    }
+image->data = image->buf;
+return SCPE_OK;
+}
+
+void sim_load_image_close (SIM_LOAD_IMAGE *image)
+{
+sim_mmap_close (image->map);
+free (image->buf);
+memset (image, 0, sizeof (*image));
+}
+
+/* Guest memory
+
+   Simulated main memory can be hundreds of megabytes.  sim_mem_alloc
+   returns zeroed memory without touching it: host pages are committed
+   (and zeroed by the host) as the simulator first references them, so
+   a large configuration costs nothing at startup.  Regions of
+   SIM_MEM_HUGE bytes or more are aligned to, and where the host supports
+   it advised for, huge pages to cut host TLB misses.  sim_mem_realloc
+   preserves the contents (up to the smaller size) and zeroes any growth.
+   Memory from these routines must be released with sim_mem_free.
+
+   Identical guests (several instances booted from the same image) hold
+   many identical pages: kernel code, ROMs, zeroed memory and whatever
+   was restored from a common saved state.  When sharing is enabled
+   (SET MEMORY SHARING) guest memory is offered to the host's page
+   merging (KSM on Linux), which maps identical pages from all instances
+   to one copy on write host page.  The guest sees no difference in
+   contents, but writes to merged pages take longer, which lets one
+   instance learn about another's memory, and merging splits the huge
+   pages which help host TLB performance.  So it is off by default.
+   Merging only happens while the host has it enabled
+   (/sys/kernel/mm/ksm/run).
+*/
+
+#define SIM_MEM_HUGE    (2*1024*1024)
+
+typedef struct SIM_MEM_BLOCK {
+    void                    *base;
+    size_t                  size;
+    struct SIM_MEM_BLOCK    *next;
+    } SIM_MEM_BLOCK;
+
+static SIM_MEM_BLOCK *sim_mem_blocks = NULL;            /* live allocations (one per memory array) */
+static t_bool sim_mem_sharing = FALSE;                  /* offer guest memory for host page merging */
+
+#if defined (_WIN32)
+
+static void *_sim_mem_map (size_t size)
+{
+void *mem = NULL;
+SIZE_T large = GetLargePageMinimum ();
+
+if ((large != 0) && (size >= SIM_MEM_HUGE) && ((size % large) == 0))
+    mem = VirtualAlloc (NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);/* needs SeLockMemoryPrivilege */
+if (mem == NULL)
+    mem = VirtualAlloc (NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);/* demand zero pages */
+return mem;
+}
+
+static void _sim_mem_unmap (void *mem, size_t size)
+{
+VirtualFree (mem, 0, MEM_RELEASE);
+}
+
+static void _sim_mem_share (void *mem, size_t size, t_bool share)
+{
+}                                                       /* Windows combines pages on its own */
+
+#elif defined (__linux__) || defined (__APPLE__) || defined (__CYGWIN__) || defined (__FreeBSD__) || defined(__NetBSD__) || defined (__OpenBSD__)
+#include <sys/mman.h>
+#if !defined (MAP_ANONYMOUS) && defined (MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#if !defined (MAP_NORESERVE)
+#define MAP_NORESERVE 0
+#endif
+
+static void _sim_mem_share (void *mem, size_t size, t_bool share)
+{
+#if defined (MADV_MERGEABLE)
+madvise (mem, size, share ? MADV_MERGEABLE : MADV_UNMERGEABLE);
+#endif
+}
+
+static void *_sim_mem_map (size_t size)
+{
+size_t len = size;
+uint8 *mem, *base;
+
+if (size >= SIM_MEM_HUGE)
+    len = size + SIM_MEM_HUGE;                          /* room to align */
+mem = (uint8 *)mmap (NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+if (mem == (uint8 *)MAP_FAILED)
+    return NULL;
+if (len == size) {
+    _sim_mem_share (mem, size, sim_mem_sharing);
+    return mem;
+    }
+base = (uint8 *)((((size_t)mem) + SIM_MEM_HUGE - 1) & ~((size_t)SIM_MEM_HUGE - 1));
+if (base != mem)                                        /* trim unaligned head */
+    munmap (mem, base - mem);
+if ((mem + len) != (base + size))                       /* and tail */
+    munmap (base + size, (mem + len) - (base + size));
+#if defined (MADV_HUGEPAGE)
+madvise (base, size, MADV_HUGEPAGE);
+#endif
+_sim_mem_share (base, size, sim_mem_sharing);
+return base;
+}
+
+static void _sim_mem_unmap (void *mem, size_t size)
+{
+munmap (mem, size);
+}
+
+#else
+
+static void *_sim_mem_map (size_t size)
+{
+return calloc (size, 1);
+}
+
+static void _sim_mem_unmap (void *mem, size_t size)
+{
+free (mem);
+}
+
+static void _sim_mem_share (void *mem, size_t size, t_bool share)
+{
+}
+
+#endif
+
+void *sim_mem_alloc (size_t size)
+{
+SIM_MEM_BLOCK *blk;
+
+if (size == 0)
+    return NULL;
+blk = (SIM_MEM_BLOCK *)malloc (sizeof (*blk));
+if (blk == NULL)
+    return NULL;
+blk->base = _sim_mem_map (size);
+if (blk->base == NULL) {
+    free (blk);
+    return NULL;
+    }
+blk->size = size;
+blk->next = sim_mem_blocks;
+sim_mem_blocks = blk;
+return blk->base;
+}
+
+static SIM_MEM_BLOCK **_sim_mem_find (void *mem)
+{
+SIM_MEM_BLOCK **pblk;
+
+for (pblk = &sim_mem_blocks; *pblk != NULL; pblk = &(*pblk)->next)
+    if ((*pblk)->base == mem)
+        break;
+return pblk;
+}
+
+void sim_mem_free (void *mem)
+{
+SIM_MEM_BLOCK **pblk, *blk;
+
+if (mem == NULL)
+    return;
+pblk = _sim_mem_find (mem);
+blk = *pblk;
+if (blk == NULL)                                        /* not ours? */
+    return;
+*pblk = blk->next;
+_sim_mem_unmap (blk->base, blk->size);
+free (blk);
+}
+
+void *sim_mem_realloc (void *mem, size_t size)
+{
+SIM_MEM_BLOCK *blk = (mem != NULL) ? *_sim_mem_find (mem) : NULL;
+void *nmem;
+
+if ((mem != NULL) && (blk == NULL))                     /* not ours? */
+    return NULL;
+nmem = sim_mem_alloc (size);
+if (nmem == NULL)                                       /* old memory remains valid */
+    return NULL;
+if (blk != NULL) {
+    memcpy (nmem, mem, (blk->size < size) ? blk->size : size);
+    sim_mem_free (mem);
+    }
+return nmem;
+}
+
+/* SET MEMORY {NO}SHARING */
+
+t_stat sim_mem_set (int32 flag, CONST char *cptr)
+{
+char gbuf[CBUFSIZE];
+SIM_MEM_BLOCK *blk;
+t_bool share;
+
+if ((cptr == NULL) || (*cptr == 0))
+    return SCPE_2FARG;
+cptr = get_glyph (cptr, gbuf, 0);
+if (*cptr != 0)
+    return SCPE_2MARG;
+if (MATCH_CMD (gbuf, "SHARING") == 0)
+    share = TRUE;
+else if (MATCH_CMD (gbuf, "NOSHARING") == 0)
+    share = FALSE;
+else
+    return sim_messagef (SCPE_ARG, "Unknown MEMORY option: %s\n", gbuf);
+if (share != sim_mem_sharing) {                         /* apply to existing memory too */
+    for (blk = sim_mem_blocks; blk != NULL; blk = blk->next)
+        _sim_mem_share (blk->base, blk->size, share);
+    sim_mem_sharing = share;
+    }
+return SCPE_OK;
+}
+
+/* Host usage of guest memory
+
+   On Linux, resident pages come from mincore and merged pages from the
+   KSM counts in /proc/self/smaps (apportioned when a host mapping spans
+   more than one memory array).  Elsewhere only the sizes are known.
+*/
+
+#if defined (__linux__)
+static t_bool _sim_mem_usage (SIM_MEM_BLOCK *blk, double *resident, double *merged)
+{
+size_t page = (size_t)sysconf (_SC_PAGESIZE);
+size_t i, pages = (blk->size + page - 1) / page;
+unsigned char *vec = (unsigned char *)malloc (pages);
+char line[256];
+FILE *f;
+unsigned long start = 0, end = 0, lo, hi;
+unsigned long base = (unsigned long)blk->base, limit = base + blk->size;
+double kb;
+
+*resident = *merged = 0.0;
+if ((vec != NULL) && (mincore (blk->base, blk->size, vec) == 0)) {
+    for (i = 0; i < pages; i++)
+        if (vec[i] & 1)
+            *resident += (double)page;
+    }
+free (vec);
+f = fopen ("/proc/self/smaps", "r");
+if (f == NULL)
+    return FALSE;
+while (fgets (line, sizeof (line), f)) {
+    if (sscanf (line, "%lx-%lx ", &lo, &hi) == 2) {     /* mapping header */
+        start = lo;
+        end = hi;
+        continue;
+        }
+    if ((strncmp (line, "KSM:", 4) != 0) ||
+        (end <= base) || (start >= limit) ||
+        (sscanf (line + 4, "%lf", &kb) != 1))
+        continue;
+    lo = MAX (start, base);
+    hi = MIN (end, limit);
+    *merged += (kb * 1024.0 * (double)(hi - lo)) / (double)(end - start);
+    }
+fclose (f);
+return TRUE;
+}
+
+static void _sim_mem_show_host (FILE *st)
+{
+char line[256];
+FILE *f;
+int run = -1;
+unsigned long merging = 0, zero = 0;
+
+f = fopen ("/sys/kernel/mm/ksm/run", "r");
+if (f != NULL) {
+    if (fscanf (f, "%d", &run) != 1)
+        run = -1;
+    fclose (f);
+    }
+if (run == 1)
+    fprintf (st, "Host page merging (KSM) is running\n");
+else if (run == -1)
+    fprintf (st, "Host page merging (KSM) isn't available\n");
+else
+    fprintf (st, "Host page merging (KSM) is stopped, pages are shared only after it's\n"
+                 "started (echo 1 >/sys/kernel/mm/ksm/run)\n");
+f = fopen ("/proc/self/ksm_stat", "r");
+if (f == NULL)
+    return;
+while (fgets (line, sizeof (line), f)) {
+    sscanf (line, "ksm_merging_pages %lu", &merging);
+    sscanf (line, "ksm_zero_pages %lu", &zero);
+    }
+fclose (f);
+fprintf (st, "This instance has %lu merged pages and %lu pages mapped to the zero page\n", merging, zero);
+}
+#else
+static t_bool _sim_mem_usage (SIM_MEM_BLOCK *blk, double *resident, double *merged)
+{
+*resident = *merged = 0.0;
+return FALSE;
+}
+
+static void _sim_mem_show_host (FILE *st)
+{
+}
+#endif
+
+static const char *_sim_mem_fmt (double bytes)
+{
+static char buf[4][16];
+static int next = 0;
+char *bp = buf[next++ & 3];
+
+if (bytes >= 1024.0*1024.0*1024.0)
+    sprintf (bp, "%.1fGB", bytes / (1024.0*1024.0*1024.0));
+else if (bytes >= 1024.0*1024.0)
+    sprintf (bp, "%.1fMB", bytes / (1024.0*1024.0));
+else
+    sprintf (bp, "%.0fKB", bytes / 1024.0);
+return bp;
+}
+
+t_stat sim_mem_show (FILE *st, DEVICE *dnotused, UNIT *unotused, int32 flag, CONST char *cptr)
+{
+char gbuf[CBUFSIZE];
+SIM_MEM_BLOCK *blk;
+double size = 0.0, resident = 0.0, merged = 0.0, r, m;
+t_bool known = FALSE;
+
+if ((cptr != NULL) && (*cptr != 0)) {
+    cptr = get_glyph (cptr, gbuf, 0);
+    if ((*cptr != 0) || (MATCH_CMD (gbuf, "SHARING") != 0))
+        return SCPE_ARG;
+    }
+fprintf (st, "Guest memory %s offered to the host for page sharing (%sSHARING)\n",
+             sim_mem_sharing ? "is" : "isn't", sim_mem_sharing ? "" : "NO");
+_sim_mem_show_host (st);
+for (blk = sim_mem_blocks; blk != NULL; blk = blk->next) {
+    known = _sim_mem_usage (blk, &r, &m);
+    if (known)
+        fprintf (st, "  %10s at %p: %10s resident, %10s shared\n", _sim_mem_fmt ((double)blk->size), blk->base,
+                     _sim_mem_fmt (r), _sim_mem_fmt (m));
+    else
+        fprintf (st, "  %10s at %p\n", _sim_mem_fmt ((double)blk->size), blk->base);
+    size += (double)blk->size;
+    resident += r;
+    merged += m;
+    }
+if (sim_mem_blocks == NULL)
+    fprintf (st, "No guest memory has been allocated\n");
+else if (known)
+    fprintf (st, "Total %s, %s resident, %s (%.1f%% of resident) shared with other pages\n",
+                 _sim_mem_fmt (size), _sim_mem_fmt (resident), _sim_mem_fmt (merged),
+                 (resident > 0.0) ? (100.0 * merged) / resident : 0.0);
+return SCPE_OK;
+}
+
+/* Memory mapped instruction history
+
+   A history file is a SIM_HIST_HDR followed by a ring of fixed size
+   records.  The header's 'next' field is the index of the next record
+   to be written and is kept current by the CPU as it records each
+   instruction, so a file left behind by a crashed simulator can be
+   mapped again (with 'entries' zero) and displayed.
+*/
+
+t_stat sim_hist_open (const char *filename, uint32 rec_size, uint32 entries, int32 switches, SIM_MMAP **map, SIM_HIST_HDR **hdr)
+{
+t_offset size = 0, mapsize;
+SIM_HIST_HDR *h;
+t_stat r;
+
+*hdr = NULL;
+if (entries)
+    size = (t_offset)sizeof (SIM_HIST_HDR) + (t_offset)entries * rec_size;
+if ((t_offset)(size_t)size != size)
+    return sim_messagef (SCPE_ARG, "A %u entry history is too large for this host\n", entries);
+r = sim_mmap_open (filename, size, map, (void **)&h, &mapsize);
+if (r != SCPE_OK)
+    return r;
+if (entries) {                                          /* new history? */
+    memcpy (h->magic, SIM_HIST_MAGIC, sizeof (h->magic));
+    strlcpy (h->sim_name, sim_name, sizeof (h->sim_name));
+    h->rec_size = rec_size;
+    h->entries = entries;
+    h->next = 0;
+    h->switches = (uint32)switches;
+    }
+else {                                                  /* existing history */
+    if ((mapsize < (t_offset)sizeof (SIM_HIST_HDR)) ||
+        (memcmp (h->magic, SIM_HIST_MAGIC, sizeof (h->magic)) != 0) ||
+        (strncmp (h->sim_name, sim_name, sizeof (h->sim_name)) != 0) ||
+        (h->rec_size != rec_size) ||
+        (h->entries == 0) || (h->next >= h->entries) ||
+        (mapsize < (t_offset)sizeof (SIM_HIST_HDR) + (t_offset)h->entries * rec_size)) {
+        sim_mmap_close (*map);
+        *map = NULL;
+        return sim_messagef (SCPE_FMT, "'%s' isn't a %s instruction history file\n", filename, sim_name);
+        }
+    }
+*hdr = h;
+return SCPE_OK;
+}
+
 #if defined(__VAX)
 /* 
  * We privide a 'basic' snprintf, which 'might' overrun a buffer, but
@@ -1272,6 +2114,780 @@ else
 }
 #endif /* !defined(_WIN32) */
 
+#if defined (SIM_ASYNCH_IO)
+/* Shared asynchronous I/O worker pool
+
+   Rather than dedicating a thread to every asynchronously attached disk
+   or tape unit, units share a small pool of at most SIM_IO_POOL_THREADS
+   worker threads.  Each unit supplies a SIM_IO_REQ (embedded in its
+   device context) and a work routine which performs whatever operation
+   is pending for the unit and then signals completion exactly as the
+   per-unit threads did (io_done + sim_activate).
+
+   A unit has at most one operation outstanding, and a request is never
+   serviced by two workers at once: a submit which arrives while the
+   request is still running (the completion was signalled but the worker
+   hasn't yet returned) is deferred and requeued when the worker finishes.
+   Per-unit ordering is therefore preserved.  Workers are created lazily as
+   units register and are shut down when the last unit unregisters.
+*/
+
+static pthread_mutex_t sim_io_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sim_io_pool_work = PTHREAD_COND_INITIALIZER;  /* queue non-empty or exit */
+static pthread_cond_t sim_io_pool_idle = PTHREAD_COND_INITIALIZER;  /* a request went idle */
+static pthread_t sim_io_pool_thread[SIM_IO_POOL_THREADS];
+static SIM_IO_REQ *sim_io_pool_current[SIM_IO_POOL_THREADS];        /* request each worker is running */
+static int sim_io_pool_threads = 0;                                 /* workers started */
+static int sim_io_pool_units = 0;                                   /* registered requests */
+static t_bool sim_io_pool_exit = FALSE;
+static SIM_IO_REQ *sim_io_pool_head = NULL;
+static SIM_IO_REQ *sim_io_pool_tail = NULL;
+
+static void _sim_io_pool_enqueue (SIM_IO_REQ *req)
+{
+req->next = NULL;
+req->queued = TRUE;
+if (sim_io_pool_tail)
+    sim_io_pool_tail->next = req;
+else
+    sim_io_pool_head = req;
+sim_io_pool_tail = req;
+pthread_cond_signal (&sim_io_pool_work);
+}
+
+static void *_sim_io_pool_worker (void *arg)
+{
+int slot = (int)(size_t)arg;
+SIM_IO_REQ *req;
+uint32 placement_gen;
+
+/* Boost Priority for the I/O threads vs the CPU instruction execution
+   thread which in general won't be readily yielding the processor when
+   an I/O thread needs to run, and place it as configured */
+sim_os_set_thread_placement (SIM_THREAD_IO);
+placement_gen = sim_thread_placement_gen;
+
+pthread_mutex_lock (&sim_io_pool_lock);
+while (1) {
+    while ((sim_io_pool_head == NULL) && !sim_io_pool_exit)
+        pthread_cond_wait (&sim_io_pool_work, &sim_io_pool_lock);
+    if (sim_io_pool_head == NULL)                       /* exiting and drained? */
+        break;
+    if (placement_gen != sim_thread_placement_gen) {    /* placement changed? */
+        placement_gen = sim_thread_placement_gen;
+        sim_os_set_thread_placement (SIM_THREAD_IO);
+        }
+    req = sim_io_pool_head;
+    sim_io_pool_head = req->next;
+    if (sim_io_pool_head == NULL)
+        sim_io_pool_tail = NULL;
+    req->next = NULL;
+    req->queued = FALSE;
+    req->running = TRUE;
+    sim_io_pool_current[slot] = req;
+    pthread_mutex_unlock (&sim_io_pool_lock);
+    req->work (req->uptr);
+    pthread_mutex_lock (&sim_io_pool_lock);
+    sim_io_pool_current[slot] = NULL;
+    req->running = FALSE;
+    if (req->resubmit) {
+        req->resubmit = FALSE;
+        _sim_io_pool_enqueue (req);
+        }
+    pthread_cond_broadcast (&sim_io_pool_idle);
+    }
+pthread_mutex_unlock (&sim_io_pool_lock);
+return NULL;
+}
+
+/* Return the pool slot of the calling thread, or -1 if it isn't a worker */
+
+static int _sim_io_pool_self (void)
+{
+int i;
+
+for (i = 0; i < sim_io_pool_threads; i++)
+    if (pthread_equal (pthread_self (), sim_io_pool_thread[i]))
+        return i;
+return -1;
+}
+
+void sim_io_pool_register (SIM_IO_REQ *req, UNIT *uptr, void (*work)(UNIT *uptr))
+{
+pthread_mutex_lock (&sim_io_pool_lock);
+req->next = NULL;
+req->uptr = uptr;
+req->work = work;
+req->queued = req->running = req->resubmit = FALSE;
+++sim_io_pool_units;
+if ((sim_io_pool_threads < SIM_IO_POOL_THREADS) &&
+    (sim_io_pool_threads < sim_io_pool_units)) {
+    pthread_attr_t attr;
+
+    pthread_attr_init (&attr);
+    pthread_attr_setscope (&attr, PTHREAD_SCOPE_SYSTEM);
+    if (0 == pthread_create (&sim_io_pool_thread[sim_io_pool_threads], &attr,
+                             _sim_io_pool_worker, (void *)(size_t)sim_io_pool_threads))
+        ++sim_io_pool_threads;
+    pthread_attr_destroy (&attr);
+    }
+if (sim_io_pool_threads == 0)                           /* no threads at all? */
+    abort ();                                           /* can't operate, stop */
+pthread_mutex_unlock (&sim_io_pool_lock);
+}
+
+void sim_io_pool_submit (SIM_IO_REQ *req)
+{
+pthread_mutex_lock (&sim_io_pool_lock);
+if (req->queued || req->resubmit)
+    abort ();                                           /* horrible mistake, stop */
+if (req->running)
+    req->resubmit = TRUE;                               /* requeue when worker is done */
+else
+    _sim_io_pool_enqueue (req);
+pthread_mutex_unlock (&sim_io_pool_lock);
+}
+
+/* Report whether any pool request is queued or being serviced */
+
+t_bool sim_io_pool_busy (void)
+{
+t_bool busy;
+int i;
+
+pthread_mutex_lock (&sim_io_pool_lock);
+busy = (sim_io_pool_head != NULL);
+for (i = 0; (i < sim_io_pool_threads) && !busy; i++)
+    busy = (sim_io_pool_current[i] != NULL);
+pthread_mutex_unlock (&sim_io_pool_lock);
+return busy;
+}
+
+void sim_io_pool_unregister (SIM_IO_REQ *req)
+{
+int i, self;
+
+pthread_mutex_lock (&sim_io_pool_lock);
+self = _sim_io_pool_self ();
+while (req->queued || req->resubmit ||                  /* wait until idle */
+       (req->running && ((self < 0) || (sim_io_pool_current[self] != req))))
+    pthread_cond_wait (&sim_io_pool_idle, &sim_io_pool_lock);
+req->uptr = NULL;
+if ((--sim_io_pool_units == 0) && (self < 0)) {         /* last one & not on a worker? */
+    sim_io_pool_exit = TRUE;
+    pthread_cond_broadcast (&sim_io_pool_work);
+    pthread_mutex_unlock (&sim_io_pool_lock);
+    for (i = 0; i < sim_io_pool_threads; i++)
+        pthread_join (sim_io_pool_thread[i], NULL);
+    pthread_mutex_lock (&sim_io_pool_lock);
+    sim_io_pool_threads = 0;
+    sim_io_pool_exit = FALSE;
+    }
+pthread_mutex_unlock (&sim_io_pool_lock);
+}
+#endif
+
+/* Spooled sequential output (line printers and punches)
+
+   Output devices which emit a character at a time would otherwise call
+   stdio on the simulator thread for every character and fflush the file
+   on each periodic flush, stalling the simulation whenever the output
+   file lives on a slow or network filesystem.  sim_spool_attach attaches
+   a unit and gives it a pair of in-memory buffers: the simulator fills
+   one while the other is written out.  With asynchronous I/O available
+   the writing is done by the shared I/O worker pool, otherwise it is done
+   inline when a buffer is handed off.
+
+   A buffer is handed off when it fills, when a form feed is spooled, on
+   the periodic flush (sim_flush_interval) and when the simulator stops.
+   Detaching the unit writes everything out before the file is closed.
+   While a unit is spooling, its fileref belongs to the writer.
+
+   SET <unit> SPOOL=option[;option...] options:
+
+        ROTATE=n[K|M|G]         start a new file once the current one
+                                reaches n bytes (0 or NOROTATE never)
+        KEEP=n                  rotated files to keep (file.1 is newest)
+        COMPRESS | NOCOMPRESS   gzip rotated files (file.1.gz ...)
+*/
+
+#if defined (HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+#define SIM_SPOOL_BUFSIZE   (256 * 1024)                    /* bytes per buffer */
+#define SIM_SPOOL_KEEP      4                               /* default rotated files kept */
+
+struct SIM_SPOOL {
+    t_offset            rotate_size;                        /* rotate at this size (0 = never) */
+    uint32              keep;                               /* rotated files kept */
+    t_bool              compress;                           /* gzip rotated files */
+    t_bool              active;                             /* unit attached and spooling */
+    t_bool              can_rotate;                         /* output is a regular file */
+    char                *fill;                              /* buffer the simulator fills */
+    size_t              fill_cnt;
+    char                *drain;                             /* buffer being written out */
+    size_t              drain_cnt;
+    t_offset            file_size;                          /* bytes in the current file */
+    t_uint64            bytes;                              /* bytes written since attach */
+    uint32              writes;                             /* buffers written */
+    uint32              rotations;                          /* files rotated */
+    uint32              stalls;                             /* simulator waited for the writer */
+    volatile int        error;                              /* pending write error (errno) */
+#if defined (SIM_ASYNCH_IO)
+    SIM_IO_REQ          io_req;
+    pthread_mutex_t     lock;
+    pthread_cond_t      done;                               /* writer finished a buffer */
+    t_bool              busy;                               /* drain buffer owned by the writer */
+#endif
+    };
+
+static SIM_SPOOL *_spool_get (UNIT *uptr)
+{
+SIM_SPOOL *sp = (SIM_SPOOL *)uptr->spool;
+
+if (sp == NULL) {
+    sp = (SIM_SPOOL *)calloc (1, sizeof (*sp));
+    if (sp == NULL)
+        return NULL;
+    sp->keep = SIM_SPOOL_KEEP;
+#if defined (SIM_ASYNCH_IO)
+    pthread_mutex_init (&sp->lock, NULL);
+    pthread_cond_init (&sp->done, NULL);
+#endif
+    uptr->spool = sp;
+    }
+return sp;
+}
+
+static char *_spool_name (const char *filename, uint32 gen, t_bool compressed)
+{
+size_t len = strlen (filename) + 16;
+char *name = (char *)malloc (len);
+
+if (name) {
+    if (gen == 0)
+        strlcpy (name, filename, len);
+    else
+        snprintf (name, len, "%s.%u%s", filename, gen, compressed ? ".gz" : "");
+    }
+return name;
+}
+
+#if defined (HAVE_ZLIB)
+static int _spool_gzip (const char *src, const char *dst)
+{
+FILE *in = sim_fopen (src, "rb");
+gzFile out;
+char buf[16384];
+size_t n;
+int stat = 0;
+
+if (in == NULL)
+    return -1;
+out = gzopen (dst, "wb");
+if (out == NULL) {
+    fclose (in);
+    return -1;
+    }
+while ((n = fread (buf, 1, sizeof (buf), in)) > 0)
+    if (gzwrite (out, buf, (unsigned)n) != (int)n) {
+        stat = -1;
+        break;
+        }
+if (ferror (in))
+    stat = -1;
+fclose (in);
+if (gzclose (out) != Z_OK)
+    stat = -1;
+return stat;
+}
+#endif
+
+/* Rotate the spool file: file.n-1 -> file.n ... file -> file.1, then
+   start an empty file.  Runs on the writer. */
+
+static void _spool_rotate (UNIT *uptr, SIM_SPOOL *sp)
+{
+uint32 gen;
+char *from, *to;
+t_bool compress = sp->compress;
+
+fclose (uptr->fileref);
+uptr->fileref = NULL;
+if (sp->keep > 0) {
+    to = _spool_name (uptr->filename, sp->keep, compress);
+    if (to)
+        remove (to);
+    free (to);
+    for (gen = sp->keep; gen > 1; gen--) {
+        from = _spool_name (uptr->filename, gen - 1, compress);
+        to = _spool_name (uptr->filename, gen, compress);
+        if (from && to)
+            rename (from, to);
+        free (from);
+        free (to);
+        }
+    to = _spool_name (uptr->filename, 1, compress);
+    if (to) {
+#if defined (HAVE_ZLIB)
+        if (compress) {
+            if (_spool_gzip (uptr->filename, to) != 0)
+                sp->error = errno ? errno : EIO;
+            }
+        else
+#endif
+            if (rename (uptr->filename, to) != 0)
+                sp->error = errno;
+        }
+    free (to);
+    }
+uptr->fileref = sim_fopen (uptr->filename, "wb");
+if (uptr->fileref == NULL) {
+    sp->error = errno;
+    sp->active = FALSE;                                 /* nowhere left to write */
+    }
+sp->file_size = 0;
+++sp->rotations;
+}
+
+/* Write out the drain buffer */
+
+static void _spool_drain (UNIT *uptr)
+{
+SIM_SPOOL *sp = (SIM_SPOOL *)uptr->spool;
+
+if ((sp->drain_cnt > 0) && (uptr->fileref != NULL)) {
+    if ((fwrite (sp->drain, 1, sp->drain_cnt, uptr->fileref) != sp->drain_cnt) ||
+        (fflush (uptr->fileref) == EOF)) {
+        sp->error = errno ? errno : EIO;
+        clearerr (uptr->fileref);
+        }
+    sp->file_size += sp->drain_cnt;
+    sp->bytes += sp->drain_cnt;
+    ++sp->writes;
+    sp->drain_cnt = 0;
+    if (sp->can_rotate && (sp->rotate_size > 0) && (sp->file_size >= sp->rotate_size))
+        _spool_rotate (uptr, sp);
+    }
+#if defined (SIM_ASYNCH_IO)
+pthread_mutex_lock (&sp->lock);
+sp->busy = FALSE;
+pthread_cond_signal (&sp->done);
+pthread_mutex_unlock (&sp->lock);
+#endif
+}
+
+/* Hand the fill buffer to the writer.  If the writer is still busy with
+   the previous buffer, either keep filling (block FALSE) or wait for it. */
+
+static void _spool_submit (UNIT *uptr, SIM_SPOOL *sp, t_bool block)
+{
+char *buf;
+
+#if defined (SIM_ASYNCH_IO)
+pthread_mutex_lock (&sp->lock);
+if (sp->busy) {
+    if (!block) {
+        pthread_mutex_unlock (&sp->lock);
+        return;
+        }
+    ++sp->stalls;
+    while (sp->busy)
+        pthread_cond_wait (&sp->done, &sp->lock);
+    }
+if (sp->fill_cnt == 0) {
+    pthread_mutex_unlock (&sp->lock);
+    return;
+    }
+buf = sp->drain;
+sp->drain = sp->fill;
+sp->drain_cnt = sp->fill_cnt;
+sp->fill = buf;
+sp->fill_cnt = 0;
+sp->busy = TRUE;
+pthread_mutex_unlock (&sp->lock);
+sim_io_pool_submit (&sp->io_req);
+#else
+if (sp->fill_cnt == 0)
+    return;
+buf = sp->drain;
+sp->drain = sp->fill;
+sp->drain_cnt = sp->fill_cnt;
+sp->fill = buf;
+sp->fill_cnt = 0;
+_spool_drain (uptr);
+#endif
+}
+
+/* Write out everything spooled so far and wait for it */
+
+static void _spool_sync (UNIT *uptr, SIM_SPOOL *sp)
+{
+_spool_submit (uptr, sp, TRUE);
+#if defined (SIM_ASYNCH_IO)
+pthread_mutex_lock (&sp->lock);
+while (sp->busy)
+    pthread_cond_wait (&sp->done, &sp->lock);
+pthread_mutex_unlock (&sp->lock);
+#endif
+}
+
+static t_stat _spool_status (SIM_SPOOL *sp)
+{
+if (sp->error == 0)
+    return SCPE_OK;
+errno = sp->error;                                      /* report it once */
+sp->error = 0;
+return SCPE_IOERR;
+}
+
+t_stat sim_spool_attach (UNIT *uptr, CONST char *cptr)
+{
+SIM_SPOOL *sp;
+t_stat r;
+
+r = attach_unit (uptr, cptr);
+if (r != SCPE_OK)
+    return r;
+sp = _spool_get (uptr);
+if (sp == NULL)                                         /* no memory? */
+    return SCPE_OK;                                     /* write directly */
+sp->fill = (char *)malloc (SIM_SPOOL_BUFSIZE);
+sp->drain = (char *)malloc (SIM_SPOOL_BUFSIZE);
+if ((sp->fill == NULL) || (sp->drain == NULL)) {
+    free (sp->fill);
+    free (sp->drain);
+    sp->fill = sp->drain = NULL;
+    return SCPE_OK;
+    }
+sp->fill_cnt = sp->drain_cnt = 0;
+sp->can_rotate = sim_can_seek (uptr->fileref);
+sp->file_size = sp->can_rotate ? sim_ftell (uptr->fileref) : 0;
+sp->bytes = 0;
+sp->writes = sp->rotations = sp->stalls = 0;
+sp->error = 0;
+#if defined (SIM_ASYNCH_IO)
+sp->busy = FALSE;
+sim_io_pool_register (&sp->io_req, uptr, _spool_drain);
+#endif
+sp->active = TRUE;
+return SCPE_OK;
+}
+
+/* Stop spooling: called by detach_unit before the file is closed */
+
+t_stat sim_spool_close (UNIT *uptr)
+{
+SIM_SPOOL *sp = (SIM_SPOOL *)uptr->spool;
+
+if ((sp == NULL) || (sp->fill == NULL))
+    return SCPE_OK;
+if (sp->active)
+    _spool_sync (uptr, sp);
+#if defined (SIM_ASYNCH_IO)
+sim_io_pool_unregister (&sp->io_req);
+#endif
+sp->active = FALSE;
+free (sp->fill);
+free (sp->drain);
+sp->fill = sp->drain = NULL;
+return _spool_status (sp);
+}
+
+t_stat sim_spool_putc (UNIT *uptr, int32 c)
+{
+SIM_SPOOL *sp = (SIM_SPOOL *)uptr->spool;
+
+if ((sp == NULL) || !sp->active) {                      /* not spooling? */
+    if ((sp != NULL) && (sp->error != 0))
+        return _spool_status (sp);
+    if (uptr->fileref == NULL)
+        return SCPE_UNATT;
+    if ((fputc (c, uptr->fileref) == EOF) || ferror (uptr->fileref)) {
+        clearerr (uptr->fileref);
+        return SCPE_IOERR;
+        }
+    return SCPE_OK;
+    }
+sp->fill[sp->fill_cnt++] = (char)c;
+if (sp->fill_cnt == SIM_SPOOL_BUFSIZE)                  /* full? */
+    _spool_submit (uptr, sp, TRUE);
+else if (c == '\f')                                     /* page done? */
+    _spool_submit (uptr, sp, FALSE);
+return _spool_status (sp);
+}
+
+t_stat sim_spool_write (UNIT *uptr, const void *buf, size_t size)
+{
+SIM_SPOOL *sp = (SIM_SPOOL *)uptr->spool;
+const char *cbuf = (const char *)buf;
+t_bool page = FALSE;
+
+if ((sp == NULL) || !sp->active) {                      /* not spooling? */
+    if ((sp != NULL) && (sp->error != 0))
+        return _spool_status (sp);
+    if (uptr->fileref == NULL)
+        return SCPE_UNATT;
+    if ((fwrite (buf, 1, size, uptr->fileref) != size) || ferror (uptr->fileref)) {
+        clearerr (uptr->fileref);
+        return SCPE_IOERR;
+        }
+    return SCPE_OK;
+    }
+while (size > 0) {
+    size_t n = MIN (size, SIM_SPOOL_BUFSIZE - sp->fill_cnt);
+
+    if (memchr (cbuf, '\f', n))
+        page = TRUE;
+    memcpy (sp->fill + sp->fill_cnt, cbuf, n);
+    sp->fill_cnt += n;
+    cbuf += n;
+    size -= n;
+    if (sp->fill_cnt == SIM_SPOOL_BUFSIZE)
+        _spool_submit (uptr, sp, TRUE);
+    }
+if (page)
+    _spool_submit (uptr, sp, FALSE);
+return _spool_status (sp);
+}
+
+/* Periodic and stop flush: with wait TRUE the data is on the file
+   when this returns */
+
+t_stat sim_spool_flush (UNIT *uptr, t_bool wait)
+{
+SIM_SPOOL *sp = (SIM_SPOOL *)uptr->spool;
+
+if ((sp == NULL) || !sp->active)
+    return SCPE_OK;
+if (wait)
+    _spool_sync (uptr, sp);
+else
+    _spool_submit (uptr, sp, FALSE);
+return SCPE_OK;
+}
+
+t_stat sim_spool_set (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+SIM_SPOOL *sp;
+char gbuf[CBUFSIZE];
+t_stat r;
+
+if ((cptr == NULL) || (*cptr == '\0'))
+    return SCPE_MISVAL;
+sp = _spool_get (uptr);
+if (sp == NULL)
+    return SCPE_MEM;
+while (*cptr) {
+    char *vptr;
+    CONST char *tptr;
+
+    cptr = get_glyph (cptr, gbuf, ';');
+    vptr = strchr (gbuf, '=');
+    if (vptr)
+        *vptr++ = '\0';
+    if ((vptr != NULL) && (MATCH_CMD (gbuf, "ROTATE") == 0)) {
+        t_offset size = (t_offset)strtotv (vptr, &tptr, 10);
+
+        if (tptr == vptr)
+            return sim_messagef (SCPE_ARG, "Invalid ROTATE size: %s\n", vptr);
+        switch (*tptr) {
+            case 'G':
+                size *= 1024;
+                /* fall through */
+            case 'M':
+                size *= 1024;
+                /* fall through */
+            case 'K':
+                size *= 1024;
+                ++tptr;
+            }
+        if (*tptr != '\0')
+            return sim_messagef (SCPE_ARG, "Invalid ROTATE size: %s\n", vptr);
+        sp->rotate_size = size;
+        }
+    else if ((vptr == NULL) && (MATCH_CMD (gbuf, "NOROTATE") == 0))
+        sp->rotate_size = 0;
+    else if ((vptr != NULL) && (MATCH_CMD (gbuf, "KEEP") == 0)) {
+        uint32 keep = (uint32)get_uint (vptr, 10, 99, &r);
+
+        if (r != SCPE_OK)
+            return sim_messagef (SCPE_ARG, "Invalid KEEP: %s (0 - 99)\n", vptr);
+        sp->keep = keep;
+        }
+    else if ((vptr == NULL) && (MATCH_CMD (gbuf, "COMPRESS") == 0)) {
+#if defined (HAVE_ZLIB)
+        sp->compress = TRUE;
+#else
+        return sim_messagef (SCPE_NOFNC, "Spool file compression is not available in this build\n");
+#endif
+        }
+    else if ((vptr == NULL) && (MATCH_CMD (gbuf, "NOCOMPRESS") == 0))
+        sp->compress = FALSE;
+    else
+        return sim_messagef (SCPE_ARG, "Unknown SPOOL option: %s%s%s\n", gbuf, vptr ? "=" : "", vptr ? vptr : "");
+    }
+return SCPE_OK;
+}
+
+t_stat sim_spool_show (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+SIM_SPOOL *sp = (SIM_SPOOL *)uptr->spool;
+
+if ((sp == NULL) || (sp->rotate_size == 0))
+    fprintf (st, "spool not rotated");
+else
+    fprintf (st, "spool rotated at %" LL_FMT "d bytes, keeping %u%s", (LL_TYPE)sp->rotate_size,
+             sp->keep, sp->compress ? " compressed" : "");
+if ((sp != NULL) && sp->active)
+    fprintf (st, ", %" LL_FMT "u bytes in %u writes, %u rotations, %u stalls",
+             (unsigned LL_TYPE)sp->bytes, sp->writes, sp->rotations, sp->stalls);
+return SCPE_OK;
+}
+
+/* I/O benchmark support
+
+   The BENCHMARK command (sim_disk_benchmark and sim_tape_benchmark)
+   drives a workload through a unit's normal library I/O routines.  The
+   workload description, per operation latency collection and the final
+   report are common to both and are handled here.
+
+   Workload keywords:
+
+        READ | WRITE            operation (default READ)
+        SEQUENTIAL | RANDOM     positioning (default SEQUENTIAL)
+        SYNC | ASYNC            synchronous or asynchronous API (default SYNC)
+        COUNT=n                 operations to perform
+        SIZE=n                  transfer size (sectors or bytes as the caller defines)
+*/
+
+static t_uint64 _sim_io_bench_nsec (void)
+{
+struct timespec now;
+
+#if defined(CLOCK_MONOTONIC)
+if (clock_gettime (CLOCK_MONOTONIC, &now) != 0)
+#endif
+    clock_gettime (CLOCK_REALTIME, &now);
+return (((t_uint64)now.tv_sec) * 1000000000) + now.tv_nsec;
+}
+
+t_stat sim_io_bench_init (SIM_IO_BENCH *bp, CONST char *cptr, uint32 default_count, uint32 default_size, uint32 max_size)
+{
+char gbuf[CBUFSIZE];
+t_stat r;
+
+memset (bp, 0, sizeof (*bp));
+bp->count = default_count;
+bp->size = default_size;
+while (cptr && *cptr) {
+    char *vptr;
+
+    cptr = get_glyph (cptr, gbuf, 0);
+    vptr = strchr (gbuf, '=');
+    if (vptr)
+        *vptr++ = '\0';
+    if ((vptr == NULL) && (MATCH_CMD (gbuf, "READ") == 0))
+        bp->write = FALSE;
+    else if ((vptr == NULL) && (MATCH_CMD (gbuf, "WRITE") == 0))
+        bp->write = TRUE;
+    else if ((vptr == NULL) && (MATCH_CMD (gbuf, "SEQUENTIAL") == 0))
+        bp->random = FALSE;
+    else if ((vptr == NULL) && (MATCH_CMD (gbuf, "RANDOM") == 0))
+        bp->random = TRUE;
+    else if ((vptr == NULL) && (MATCH_CMD (gbuf, "SYNC") == 0))
+        bp->async = FALSE;
+    else if ((vptr == NULL) && (MATCH_CMD (gbuf, "ASYNC") == 0))
+        bp->async = TRUE;
+    else if ((vptr != NULL) && (MATCH_CMD (gbuf, "COUNT") == 0)) {
+        bp->count = (uint32)get_uint (vptr, 10, 0xFFFFFFFF, &r);
+        if ((r != SCPE_OK) || (bp->count == 0))
+            return sim_messagef (SCPE_ARG, "Invalid COUNT: %s\n", vptr);
+        }
+    else if ((vptr != NULL) && (MATCH_CMD (gbuf, "SIZE") == 0)) {
+        bp->size = (uint32)get_uint (vptr, 10, max_size, &r);
+        if ((r != SCPE_OK) || (bp->size == 0))
+            return sim_messagef (SCPE_ARG, "Invalid SIZE: %s (1 - %u)\n", vptr, max_size);
+        }
+    else
+        return sim_messagef (SCPE_ARG, "Unknown BENCHMARK option: %s%s%s\n", gbuf, vptr ? "=" : "", vptr ? vptr : "");
+    }
+bp->latency = (double *)calloc (bp->count, sizeof (*bp->latency));
+if (bp->latency == NULL)
+    return SCPE_MEM;
+return SCPE_OK;
+}
+
+void sim_io_bench_start (SIM_IO_BENCH *bp)
+{
+bp->op_start = _sim_io_bench_nsec ();
+if (bp->done == 0)
+    bp->start = bp->op_start;
+}
+
+void sim_io_bench_stop (SIM_IO_BENCH *bp, size_t bytes, t_stat r)
+{
+t_uint64 now = _sim_io_bench_nsec ();
+
+if (bp->done < bp->count)
+    bp->latency[bp->done++] = (now - bp->op_start) / 1000.0;
+bp->stop = now;
+bp->bytes += bytes;
+if (r != SCPE_OK)
+    ++bp->errors;
+}
+
+static int _sim_io_bench_cmp (const void *pa, const void *pb)
+{
+double a = *(const double *)pa;
+double b = *(const double *)pb;
+
+return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+static double _sim_io_bench_pct (SIM_IO_BENCH *bp, double pct)
+{
+uint32 i = (uint32)((pct * bp->done) / 100.0);
+
+if (i >= bp->done)
+    i = bp->done - 1;
+return bp->latency[i];
+}
+
+void sim_io_bench_report (SIM_IO_BENCH *bp, const char *title)
+{
+double secs, total = 0.0;
+uint32 i;
+
+if (bp->done == 0) {
+    sim_printf ("%s: no operations completed\n", title);
+    return;
+    }
+secs = (bp->stop - bp->start) / 1000000000.0;
+for (i = 0; i < bp->done; i++)
+    total += bp->latency[i];
+qsort (bp->latency, bp->done, sizeof (*bp->latency), _sim_io_bench_cmp);
+sim_printf ("%s\n", title);
+sim_printf ("  %s %s %s, %u operations of %u, %s bytes in %.4f seconds\n",
+            bp->random ? "Random" : "Sequential", bp->write ? "write" : "read",
+            bp->async ? "(asynchronous)" : "(synchronous)", bp->done, bp->count,
+            sim_fmt_numeric ((double)bp->bytes), secs);
+if (bp->errors)
+    sim_printf ("  %u operations reported errors\n", bp->errors);
+if (secs > 0.0)
+    sim_printf ("  %.0f IOPS, %.2f MB/s\n", bp->done / secs, (bp->bytes / (1024.0 * 1024.0)) / secs);
+sim_printf ("  Latency (usecs): min %.1f, avg %.1f, p50 %.1f, p90 %.1f, p99 %.1f, max %.1f\n",
+            bp->latency[0], total / bp->done, _sim_io_bench_pct (bp, 50.0),
+            _sim_io_bench_pct (bp, 90.0), _sim_io_bench_pct (bp, 99.0), bp->latency[bp->done - 1]);
+}
+
+void sim_io_bench_free (SIM_IO_BENCH *bp)
+{
+free (bp->latency);
+bp->latency = NULL;
+}
+
 /* Trim trailing spaces from a string
 
     Inputs:
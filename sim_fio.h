@@ -94,12 +94,99 @@ void sim_print_filelist (char **filelist);
 void sim_buf_swap_data (void *bptr, size_t size, size_t count);
 void sim_byte_swap_data (void *bptr, size_t size, size_t count);
 void sim_buf_copy_swapped (void *dptr, const void *bptr, size_t size, size_t count);
+void sim_mem_load_bytes (void *mem, size_t size, t_addr addr, const void *src, size_t count);
 const char *sim_get_os_error_text (int error);
 typedef struct SHMEM SHMEM;
 t_stat sim_shmem_open (const char *name, size_t size, SHMEM **shmem, void **addr);
 void sim_shmem_close (SHMEM *shmem);
 int32 sim_shmem_atomic_add (int32 *ptr, int32 val);
 t_bool sim_shmem_atomic_cas (int32 *ptr, int32 oldv, int32 newv);
+typedef struct SIM_MMAP SIM_MMAP;
+t_stat sim_mmap_open (const char *filename, t_offset size, SIM_MMAP **map, void **addr, t_offset *mapsize);
+t_stat sim_mmap_open_readonly (const char *filename, SIM_MMAP **map, const void **addr, t_offset *mapsize);
+void sim_mmap_close (SIM_MMAP *map);
+typedef struct {
+    const uint8     *data;          /* file contents */
+    size_t          size;           /* file size in bytes */
+    SIM_MMAP        *map;           /* mapping (NULL if read into buf) */
+    uint8           *buf;           /* allocated copy (NULL if mapped) */
+    } SIM_LOAD_IMAGE;
+t_stat sim_load_image_open (FILE *fptr, SIM_LOAD_IMAGE *image);
+void sim_load_image_close (SIM_LOAD_IMAGE *image);
+void *sim_mem_alloc (size_t size);
+void *sim_mem_realloc (void *mem, size_t size);
+void sim_mem_free (void *mem);
+t_stat sim_mem_set (int32 flag, CONST char *cptr);
+t_stat sim_mem_show (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
+
+/* Memory mapped instruction history file header (records follow it) */
+
+#define SIM_HIST_MAGIC      "SIMHHST1"
+
+typedef struct {
+    char                magic[8];                           /* SIM_HIST_MAGIC */
+    char                sim_name[64];                       /* simulator which wrote it */
+    uint32              rec_size;                           /* bytes per record */
+    uint32              entries;                            /* records in the ring */
+    volatile uint32     next;                               /* next record to be written */
+    uint32              switches;                           /* history options */
+    uint8               spare[168];                         /* pad to 256 bytes */
+    } SIM_HIST_HDR;
+t_stat sim_hist_open (const char *filename, uint32 rec_size, uint32 entries, int32 switches, SIM_MMAP **map, SIM_HIST_HDR **hdr);
+
+#if defined (SIM_ASYNCH_IO)
+/* Shared asynchronous I/O worker pool (used by sim_disk and sim_tape) */
+
+#define SIM_IO_POOL_THREADS 4                               /* max worker threads */
+
+typedef struct SIM_IO_REQ SIM_IO_REQ;
+struct SIM_IO_REQ {
+    SIM_IO_REQ          *next;                              /* pending queue link */
+    UNIT                *uptr;                              /* owning unit */
+    void                (*work)(UNIT *uptr);                /* performs the unit's pending op */
+    t_bool              queued;                             /* on the pending queue */
+    t_bool              running;                            /* being serviced by a worker */
+    t_bool              resubmit;                           /* submitted while running */
+    };
+void sim_io_pool_register (SIM_IO_REQ *req, UNIT *uptr, void (*work)(UNIT *uptr));
+void sim_io_pool_submit (SIM_IO_REQ *req);
+void sim_io_pool_unregister (SIM_IO_REQ *req);
+t_bool sim_io_pool_busy (void);
+#endif
+
+/* Spooled sequential output (used by line printers and punches) */
+
+typedef struct SIM_SPOOL SIM_SPOOL;
+t_stat sim_spool_attach (UNIT *uptr, CONST char *cptr);
+t_stat sim_spool_close (UNIT *uptr);
+t_stat sim_spool_putc (UNIT *uptr, int32 c);
+t_stat sim_spool_write (UNIT *uptr, const void *buf, size_t size);
+t_stat sim_spool_flush (UNIT *uptr, t_bool wait);
+t_stat sim_spool_set (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat sim_spool_show (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+
+/* I/O benchmark support (used by sim_disk and sim_tape) */
+
+typedef struct SIM_IO_BENCH SIM_IO_BENCH;
+struct SIM_IO_BENCH {
+    t_bool              write;                              /* write (vs read) workload */
+    t_bool              random;                             /* random (vs sequential) positioning */
+    t_bool              async;                              /* issue via the asynchronous API */
+    uint32              count;                              /* operations to perform */
+    uint32              size;                               /* transfer size (caller's units) */
+    uint32              done;                               /* operations completed */
+    uint32              errors;                             /* operations which failed */
+    t_uint64            bytes;                              /* data transferred */
+    t_uint64            start;                              /* first operation start (nsecs) */
+    t_uint64            stop;                               /* last operation completion (nsecs) */
+    t_uint64            op_start;                           /* current operation start (nsecs) */
+    double              *latency;                           /* per operation latency (usecs) */
+    };
+t_stat sim_io_bench_init (SIM_IO_BENCH *bp, CONST char *cptr, uint32 default_count, uint32 default_size, uint32 max_size);
+void sim_io_bench_start (SIM_IO_BENCH *bp);
+void sim_io_bench_stop (SIM_IO_BENCH *bp, size_t bytes, t_stat r);
+void sim_io_bench_report (SIM_IO_BENCH *bp, const char *title);
+void sim_io_bench_free (SIM_IO_BENCH *bp);
 
 extern t_bool sim_taddr_64;         /* t_addr is > 32b and Large File Support available */
 extern t_bool sim_toffset_64;       /* Large File (>2GB) file I/O support */
@@ -84,6 +84,8 @@ return 0;
 #include <unistd.h>
 #define msleep(n) usleep(1000*n)
 #include <sys/wait.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #if defined (__APPLE__)
 #define HAVE_STRUCT_TIMESPEC 1   /* OSX defined the structure but doesn't tell us */
 #endif
@@ -118,6 +120,23 @@ return 0;
 
 #endif /* NOT _WIN32 */
 
+#if defined(_WIN32)
+#define _panel_memory_barrier() MemoryBarrier ()
+#elif defined(__GNUC__)
+#define _panel_memory_barrier() __sync_synchronize ()
+#else
+#define _panel_memory_barrier()
+#endif
+
+/* Register snapshot published by the simulator's PUBLISH command.  
+   This layout must match the PUBLISH_DATA structure in sim_console.c */
+typedef struct {
+    volatile int            sequence;       /* odd while an update is in progress */
+    unsigned int            count;          /* number of values which follow */
+    unsigned long long      time;           /* simulation time of the snapshot */
+    unsigned long long      values[1];      /* register values in request order */
+    } PUBLISH_DATA;
+
 typedef struct {
     char *name;
     char *device_name;
@@ -167,6 +186,24 @@ struct PANEL {
     int                     callback_thread_running;
     void                    *callback_context;
     int                     usecs_between_callbacks;
+    int                     use_shared_memory;
+    int                     shm_published;
+    char                    shm_name[64];
+    void                    *shm_base;
+    size_t                  shm_size;
+    volatile PUBLISH_DATA   *shm_data;
+    int                     shm_sequence;
+    unsigned long long      *shm_values;
+    size_t                  shm_value_count;
+    pthread_mutex_t         bulk_lock;
+    char                    bulk_name[64];
+    unsigned int            bulk_generation;
+    void                    *bulk_base;
+    void                    *bulk_data;
+    size_t                  bulk_size;
+#if defined(_WIN32)
+    HANDLE                  bulk_mapping;
+#endif
     pthread_t               debugflush_thread;
     int                     debugflush_thread_running;
     unsigned int            sample_frequency;
@@ -203,11 +240,16 @@ struct PANEL {
  *   io_command_lock     To serialize frontpanel application command requests
  *                        acquired and released in: _panel_get_registers, 
  *                                                  _panel_sendf_completion
+ *   bulk_lock           Serializes use of the bulk memory transfer segment
+ *                        acquired and released in: _panel_mem_bulk
  *
  *  Condition Var:  Sync Mutex:  Purpose & Duration:
  *   io_done        io_lock
  *   startup_done   io_lock      Indicate background thread setup is complete.
  *                               Once signaled, it is immediately destroyed.
+ *
+ *  The shared memory register mapping (shm_*) is only established, 
+ *  referenced and released by the callback thread.
  */
 
 static const char *sim_prompt = "sim> ";
@@ -215,6 +257,11 @@ static const char *register_repeat_prefix = "repeat every ";
 static const char *register_repeat_stop = "repeat stop";
 static const char *register_repeat_stop_all = "repeat stop all";
 static const char *register_repeat_units = " usecs ";
+static const char *register_publish_prefix = "publish ";
+static const char *register_publish_every = " every ";
+static const char *register_publish_stop = "publish stop";
+static const char *bulk_examine = "bulk examine";
+static const char *bulk_deposit = "bulk deposit";
 static const char *register_get_prefix = "show time";
 static const char *register_collect_prefix = "collect ";
 static const char *register_collect_mid1 = " samples every ";
@@ -231,6 +278,7 @@ static const char *command_status = "ECHO Status:%STATUS%-%TSTATUS%";
 static const char *command_done_echo = "# COMMAND-DONE";
 static int little_endian;
 static void *_panel_reader(void *arg);
+static void _panel_bulk_close (PANEL *p);
 static void *_panel_callback(void *arg);
 static void *_panel_debugflusher(void *arg);
 static int sim_panel_set_error (PANEL *p, const char *fmt, ...);
@@ -904,6 +952,7 @@ _panel_debug (p, DBG_XMT|DBG_RCV, "Connected to simulator on %s after %dms", NUL
 pthread_mutex_init (&p->io_lock, NULL);
 pthread_mutex_init (&p->io_send_lock, NULL);
 pthread_mutex_init (&p->io_command_lock, NULL);
+pthread_mutex_init (&p->bulk_lock, NULL);
 pthread_cond_init (&p->io_done, NULL);
 pthread_cond_init (&p->startup_done, NULL);
 if (sizeof(mantra) != _panel_send (p, (char *)mantra, sizeof(mantra))) {
@@ -1074,6 +1123,8 @@ if (panel) {
     pthread_mutex_destroy (&panel->io_lock);
     pthread_mutex_destroy (&panel->io_send_lock);
     pthread_mutex_destroy (&panel->io_command_lock);
+    _panel_bulk_close (panel);
+    pthread_mutex_destroy (&panel->bulk_lock);
     pthread_cond_destroy (&panel->io_done);
 #if defined(_WIN32)
     if (panel->hProcess) {
@@ -1110,6 +1161,7 @@ if (panel) {
         }
     free (panel->regs);
     free (panel->reg_query);
+    free (panel->shm_values);
     free (panel->io_response);
     free (panel->halt_reason);
     free (panel->simulator_version);
@@ -1416,6 +1468,32 @@ pthread_mutex_unlock (&panel->io_lock);
 return 0;
 }
 
+int
+sim_panel_set_shared_memory (PANEL *panel, int enable)
+{
+if (!panel || (panel->State == Error)) {
+    sim_panel_set_error (NULL, "Invalid Panel");
+    return -1;
+    }
+if (enable && panel->parent) {
+    sim_panel_set_error (NULL, "Shared memory register transport is only available for simulator panels");
+    return -1;
+    }
+pthread_mutex_lock (&panel->io_lock);
+if (enable && !panel->shm_name[0])
+#if defined(_WIN32)
+    sprintf (panel->shm_name, "simh-panel-%u-%u", (unsigned int)GetCurrentProcessId (), (unsigned int)panel->dwProcessId);
+#else
+    sprintf (panel->shm_name, "simh-panel-%u-%u", (unsigned int)getpid (), (unsigned int)panel->pidProcess);
+#endif
+if (panel->use_shared_memory != (enable != 0)) {
+    panel->use_shared_memory = (enable != 0);
+    panel->new_register = 1;                    /* reestablish register delivery */
+    }
+pthread_mutex_unlock (&panel->io_lock);
+return 0;
+}
+
 int
 sim_panel_set_sampling_parameters_ex (PANEL *panel,
                                       unsigned int sample_frequency,
@@ -1955,6 +2033,170 @@ if (_panel_sendf (panel, &cmd_stat, NULL, (panel->radix == 16) ? "DEPOSIT -H %ll
 return 0;
 }
 
+static void
+_panel_bulk_close (PANEL *p)
+{
+if (p->bulk_base) {
+#if defined(_WIN32)
+    UnmapViewOfFile (p->bulk_base);
+    CloseHandle (p->bulk_mapping);
+#else
+    char path[sizeof (p->bulk_name) + 1];
+
+    munmap (p->bulk_base, p->bulk_size);
+    sprintf (path, "/%s", p->bulk_name);
+    shm_unlink (path);
+#endif
+    }
+p->bulk_base = NULL;
+p->bulk_data = NULL;
+p->bulk_size = 0;
+}
+
+static int
+_panel_bulk_open (PANEL *p, size_t size)
+{
+#if defined(_WIN32)
+SYSTEM_INFO SysInfo;
+
+sprintf (p->bulk_name, "simh-bulk-%u-%u-%u", (unsigned int)GetCurrentProcessId (), (unsigned int)p->dwProcessId, ++p->bulk_generation);
+GetSystemInfo (&SysInfo);
+p->bulk_mapping = CreateFileMappingA (INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE|SEC_COMMIT, 0, (DWORD)(size+SysInfo.dwPageSize), p->bulk_name);
+if (p->bulk_mapping == NULL)
+    return -1;
+p->bulk_base = MapViewOfFile (p->bulk_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+if (p->bulk_base == NULL) {
+    CloseHandle (p->bulk_mapping);
+    return -1;
+    }
+*((DWORD *)p->bulk_base) = (DWORD)size;         /* size in first page as sim_shmem_open expects */
+p->bulk_data = (char *)p->bulk_base + SysInfo.dwPageSize;
+#elif defined(__linux__) || defined(__APPLE__)
+char path[sizeof (p->bulk_name) + 1];
+void *base;
+int fd;
+
+sprintf (p->bulk_name, "simh-bulk-%u-%u-%u", (unsigned int)getpid (), (unsigned int)p->pidProcess, ++p->bulk_generation);
+sprintf (path, "/%s", p->bulk_name);
+fd = shm_open (path, O_CREAT | O_EXCL | O_RDWR, 0600);
+if (fd == -1)
+    return -1;
+if (ftruncate (fd, (off_t)size)) {
+    close (fd);
+    shm_unlink (path);
+    return -1;
+    }
+base = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+close (fd);                             /* the mapping keeps the segment */
+if (base == MAP_FAILED) {
+    shm_unlink (path);
+    return -1;
+    }
+p->bulk_base = p->bulk_data = base;
+#else
+return -1;
+#endif
+p->bulk_size = size;
+return 0;
+}
+
+/* Move count consecutive memory values between the simulator and the
+   caller's buffer in a single request.  The values travel through a 
+   shared memory segment which both processes map, so only the request 
+   and its status cross the socket. */
+static int
+_panel_mem_bulk (PANEL *panel, 
+                 int deposit,
+                 size_t addr_size,
+                 const void *addr,
+                 size_t count,
+                 size_t value_size,
+                 void *values)
+{
+char *response = NULL;
+unsigned long long address = 0;
+size_t bytes = count * value_size;
+int cmd_stat;
+
+if (!panel || (panel->State == Error)) {
+    sim_panel_set_error (NULL, "Invalid Panel");
+    return -1;
+    }
+if ((value_size != 1) && (value_size != 2) && (value_size != 4) && (value_size != 8)) {
+    sim_panel_set_error (NULL, "Invalid value size: %u", (unsigned int)value_size);
+    return -1;
+    }
+if (count == 0)
+    return 0;
+if (little_endian)
+    memcpy (&address, addr, addr_size);
+else
+    memcpy (((char *)&address) + sizeof(address)-addr_size, addr, addr_size);
+pthread_mutex_lock (&panel->bulk_lock);
+if (panel->bulk_size < bytes) {
+    _panel_bulk_close (panel);
+    if (_panel_bulk_open (panel, bytes)) {
+        pthread_mutex_unlock (&panel->bulk_lock);
+        sim_panel_set_error (NULL, "Can't create a %u byte bulk transfer segment", (unsigned int)bytes);
+        return -1;
+        }
+    }
+if (deposit)
+    memcpy (panel->bulk_data, values, bytes);
+if ((_panel_sendf (panel, &cmd_stat, &response, (panel->radix == 16) ? "%s %s %u %u %u %s %llx" : "%s %s %u %u %u %s %llo", 
+                          deposit ? bulk_deposit : bulk_examine, panel->bulk_name, (unsigned int)panel->bulk_size, 
+                          (unsigned int)value_size, (unsigned int)count, 
+                          panel->device_name ? panel->device_name : "", address)) ||
+    (cmd_stat)) {
+    pthread_mutex_unlock (&panel->bulk_lock);
+    sim_panel_set_error (NULL, "Bulk %s failed: %s", deposit ? "deposit" : "examine", response ? response : "");
+    free (response);
+    return -1;
+    }
+if (!deposit)
+    memcpy (values, panel->bulk_data, bytes);
+pthread_mutex_unlock (&panel->bulk_lock);
+free (response);
+return 0;
+}
+
+/**
+
+   sim_panel_mem_examine_bulk
+   sim_panel_mem_deposit_bulk
+
+        addr_size    the size (in local storage) of the buffer which 
+                     contains the first memory address of the data
+        addr         a pointer to the buffer containing the first memory 
+                     address of the data
+        count        the number of consecutive memory locations
+        value_size   the size (in local storage) of each value (1, 2, 4 or 8)
+        values       a pointer to the buffer which receives or contains 
+                     count values
+ */
+
+int
+sim_panel_mem_examine_bulk (PANEL *panel, 
+                            size_t addr_size,
+                            const void *addr,
+                            size_t count,
+                            size_t value_size,
+                            void *values)
+{
+return _panel_mem_bulk (panel, 0, addr_size, addr, count, value_size, values);
+}
+
+int
+sim_panel_mem_deposit_bulk (PANEL *panel, 
+                            size_t addr_size,
+                            const void *addr,
+                            size_t count,
+                            size_t value_size,
+                            const void *values)
+{
+return _panel_mem_bulk (panel, 1, addr_size, addr, count, value_size, (void *)values);
+}
+
 /**
 
    sim_panel_mem_deposit_instruction
@@ -2437,6 +2679,192 @@ pthread_mutex_unlock (&p->io_lock);
 return NULL;
 }
 
+static void
+_panel_shmem_close (PANEL *p)
+{
+if (p->shm_base) {
+#if defined(_WIN32)
+    UnmapViewOfFile (p->shm_base);
+#else
+    munmap (p->shm_base, p->shm_size);
+#endif
+    }
+p->shm_base = NULL;
+p->shm_data = NULL;
+}
+
+static int
+_panel_shmem_open (PANEL *p, size_t value_count)
+{
+#if defined(_WIN32)
+HANDLE hMapping;
+SYSTEM_INFO SysInfo;
+
+hMapping = OpenFileMappingA (FILE_MAP_READ, FALSE, p->shm_name);
+if (hMapping == NULL)
+    return -1;
+p->shm_base = MapViewOfFile (hMapping, FILE_MAP_READ, 0, 0, 0);
+CloseHandle (hMapping);                 /* the view keeps the section */
+if (p->shm_base == NULL)
+    return -1;
+GetSystemInfo (&SysInfo);
+p->shm_data = (PUBLISH_DATA *)((char *)p->shm_base + SysInfo.dwPageSize);
+#elif defined(__linux__) || defined(__APPLE__)
+char path[sizeof (p->shm_name) + 1];
+struct stat statb;
+void *base;
+int fd;
+
+sprintf (path, "/%s", p->shm_name);
+fd = shm_open (path, O_RDONLY, 0);
+if (fd == -1)
+    return -1;
+if ((fstat (fd, &statb)) || 
+    ((size_t)statb.st_size < sizeof (PUBLISH_DATA))) {
+    close (fd);
+    return -1;
+    }
+base = mmap (NULL, (size_t)statb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+close (fd);                             /* the mapping keeps the segment */
+if (base == MAP_FAILED)
+    return -1;
+p->shm_base = base;
+p->shm_size = (size_t)statb.st_size;
+p->shm_data = (PUBLISH_DATA *)base;
+#else
+return -1;
+#endif
+if (p->shm_data->count != value_count) {
+    _panel_shmem_close (p);
+    return -1;
+    }
+if (p->shm_value_count < value_count) {
+    unsigned long long *values = (unsigned long long *)realloc (p->shm_values, value_count * sizeof (*values));
+
+    if (values == NULL) {
+        _panel_shmem_close (p);
+        return -1;
+        }
+    p->shm_values = values;
+    }
+p->shm_value_count = value_count;
+p->shm_sequence = -1;
+return 0;
+}
+
+/* Ask the simulator to publish the panel's registers in shared memory 
+   rather than sending a repeated text register dump.  Panels with 
+   indirect or bit sampled registers still need the text protocol.
+   Returns 0 when the shared memory snapshot is being delivered. */
+static int
+_panel_publish_registers (PANEL *p)
+{
+size_t i, cmd_size, value_count = 0;
+const char *dev = NULL;
+char *cmd, *c;
+int cmd_stat;
+
+_panel_shmem_close (p);                 /* simulator may recreate the segment */
+pthread_mutex_lock (&p->io_lock);
+cmd_size = strlen (register_publish_prefix) + strlen (p->shm_name) + 
+           strlen (register_publish_every) + 20 + strlen (register_repeat_units) + 1;
+for (i=0; i<p->reg_count; i++) {
+    if (p->regs[i].indirect || p->regs[i].bits)
+        break;
+    cmd_size += 32 + strlen (p->regs[i].name) + (p->regs[i].device_name ? strlen (p->regs[i].device_name) : 0);
+    }
+if ((!p->use_shared_memory) || (p->reg_count == 0) || (i != p->reg_count) || 
+    (NULL == (cmd = (char *)_panel_malloc (cmd_size)))) {
+    pthread_mutex_unlock (&p->io_lock);
+    if (p->shm_published) {             /* stop a previous publication */
+        p->shm_published = 0;
+        _panel_sendf (p, &cmd_stat, NULL, "%s", register_publish_stop);
+        }
+    return -1;
+    }
+sprintf (cmd, "%s%s%s%d%s", register_publish_prefix, p->shm_name, register_publish_every, 
+                            p->usecs_between_callbacks, register_repeat_units);
+c = cmd + strlen (cmd);
+for (i=0; i<p->reg_count; i++) {
+    const char *reg_dev = p->regs[i].device_name ? p->regs[i].device_name : "";
+    int first = 0;
+
+    if ((dev == NULL) || strcmp (dev, reg_dev)) {   /* devices are different */
+        sprintf (c, "%s%s%s", dev ? ";" : "", reg_dev, *reg_dev ? " " : "");
+        c += strlen (c);
+        dev = reg_dev;
+        first = 1;
+        }
+    sprintf (c, "%s%s", first ? "" : ",", p->regs[i].name);
+    c += strlen (c);
+    if (p->regs[i].element_count > 0) {
+        sprintf (c, "[0:%d]", (int)(p->regs[i].element_count-1));
+        c += strlen (c);
+        value_count += p->regs[i].element_count;
+        }
+    else
+        ++value_count;
+    }
+pthread_mutex_unlock (&p->io_lock);
+if ((_panel_sendf (p, &cmd_stat, NULL, "%s", cmd)) || (cmd_stat)) {
+    _panel_debug (p, DBG_THR, "Shared memory register publishing unavailable", NULL, 0);
+    free (cmd);
+    return -1;
+    }
+free (cmd);
+p->shm_published = 1;
+_panel_sendf (p, &cmd_stat, NULL, "%s", register_repeat_stop);  /* any prior text delivery */
+if (_panel_shmem_open (p, value_count)) {
+    _panel_debug (p, DBG_THR, "Can't map shared memory register segment %s", NULL, 0, p->shm_name);
+    p->shm_published = 0;
+    _panel_sendf (p, &cmd_stat, NULL, "%s", register_publish_stop);
+    return -1;
+    }
+_panel_debug (p, DBG_THR, "Registers published in shared memory segment %s", NULL, 0, p->shm_name);
+return 0;
+}
+
+/* Copy a consistent snapshot out of shared memory into the register 
+   buffers.  Called with io_lock held.  Returns 1 when new data arrived. */
+static int
+_panel_shmem_update (PANEL *p)
+{
+volatile PUBLISH_DATA *pub = p->shm_data;
+unsigned long long time = 0;
+size_t i, j, v;
+int seq, tries;
+
+for (tries = 0; tries < 100; tries++) {
+    seq = pub->sequence;
+    _panel_memory_barrier ();
+    if (seq == p->shm_sequence)         /* nothing new? */
+        return 0;
+    if (seq & 1)                        /* update in progress? */
+        continue;
+    for (v = 0; v < p->shm_value_count; v++)
+        p->shm_values[v] = pub->values[v];
+    time = pub->time;
+    _panel_memory_barrier ();
+    if (seq == pub->sequence)           /* not changed while copying? */
+        break;
+    }
+if (tries == 100)
+    return 0;
+p->shm_sequence = seq;
+p->simulation_time = time;
+for (i = v = 0; i < p->reg_count; i++) {
+    size_t elements = p->regs[i].element_count ? p->regs[i].element_count : 1;
+
+    for (j = 0; (j < elements) && (v < p->shm_value_count); j++, v++) {
+        if (little_endian)
+            memcpy ((char *)(p->regs[i].addr) + (j * p->regs[i].size), &p->shm_values[v], p->regs[i].size);
+        else
+            memcpy ((char *)(p->regs[i].addr) + (j * p->regs[i].size), ((char *)&p->shm_values[v]) + sizeof(p->shm_values[v])-p->regs[i].size, p->regs[i].size);
+        }
+    }
+return 1;
+}
+
 static void *
 _panel_callback(void *arg)
 {
@@ -2480,7 +2908,30 @@ while ((p->sock != INVALID_SOCKET) &&
     /*  1) update the query string if it has changed                            */
     /*     (only really happens at startup)                                     */
     /*  2) update register state by polling if the simulator is halted          */
-    msleep (500);
+    /* with shared memory delivery, the snapshot is also polled in between      */
+    if (p->shm_data) {
+        int wait_msecs = (interval < 1000) ? 1 : interval / 1000;
+        int waited;
+
+        for (waited = 0; waited < 500; waited += wait_msecs) {
+            int updated;
+
+            msleep (wait_msecs);
+            pthread_mutex_lock (&p->io_lock);
+            if ((p->usecs_between_callbacks == 0) || (p->State == Error)) {
+                pthread_mutex_unlock (&p->io_lock);
+                break;
+                }
+            updated = _panel_shmem_update (p);
+            pthread_mutex_unlock (&p->io_lock);
+            if (updated && p->callback)
+                p->callback (p, p->simulation_time_base + p->simulation_time, p->callback_context);
+            }
+        }
+    else
+        msleep (500);
+    if (new_register && (0 == _panel_publish_registers (p)))
+        new_register = 0;                       /* shared memory replaces the repeat */
     pthread_mutex_lock (&p->io_lock);
     if (new_register) {
         size_t repeat_data = strlen (register_repeat_prefix) +  /* prefix */
@@ -2533,6 +2984,12 @@ while ((p->sock != INVALID_SOCKET) &&
     }
 pthread_mutex_unlock (&p->io_lock);
 /* stop any established repeating activity in the simulator */
+_panel_shmem_close (p);
+if (p->shm_published) {
+    _panel_debug (p, DBG_THR, "Stopping Register Publishing before exiting", NULL, 0);
+    p->shm_published = 0;
+    _panel_sendf (p, &cmd_stat, NULL, "%s", register_publish_stop);
+    }
 if (p->parent == NULL) {        /* Top level panel? */
     _panel_debug (p, DBG_THR, "Stopping All Repeats before exiting", NULL, 0);
     _panel_sendf (p, &cmd_stat, NULL, "%s", register_repeat_stop_all);
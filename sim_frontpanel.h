@@ -56,7 +56,7 @@ extern "C" {
 
 #if !defined(__VAX)         /* Unsupported platform */
 
-#define SIM_FRONTPANEL_VERSION   12
+#define SIM_FRONTPANEL_VERSION   14
 
 /**
 
@@ -225,6 +225,25 @@ sim_panel_set_display_callback_interval (PANEL *panel,
                                          void *context, 
                                          int usecs_between_callbacks);
 
+/**
+
+    sim_panel_set_shared_memory 
+
+        enable              1 to have register values delivered through 
+                            shared memory, 0 to use the text protocol
+
+    When enabled, the simulator publishes the panel's register values
+    in a shared memory segment at the display callback interval and
+    the panel reads them directly, avoiding the formatting and parsing 
+    of register output text.  Control commands still use the text 
+    protocol.  Panels with indirect or bit sampled registers, or 
+    hosts without shared memory support, silently continue using 
+    the text protocol.  Only available for simulator panels.
+ */
+
+int
+sim_panel_set_shared_memory (PANEL *panel, int enable);
+
 /**
 
     When a front panel application wants to get averaged bit sample
@@ -424,6 +443,42 @@ sim_panel_mem_deposit (PANEL *panel,
                        size_t value_size,
                        const void *value);
 
+/**
+
+   sim_panel_mem_examine_bulk
+   sim_panel_mem_deposit_bulk
+
+        addr_size    the size (in local storage) of the buffer which 
+                     contains the first memory address of the data
+        addr         a pointer to the buffer containing the first memory 
+                     address of the data
+        count        the number of consecutive memory locations
+        value_size   the size (in local storage) of each value (1, 2, 4 or 8)
+        values       a pointer to the buffer which receives or contains 
+                     count values
+
+    The whole range moves in a single request through a shared memory 
+    segment, so large regions can be transferred without a command 
+    round trip per location.  These may be used while the simulator 
+    is running.
+ */
+
+int
+sim_panel_mem_examine_bulk (PANEL *panel, 
+                            size_t addr_size,
+                            const void *addr,
+                            size_t count,
+                            size_t value_size,
+                            void *values);
+
+int
+sim_panel_mem_deposit_bulk (PANEL *panel, 
+                            size_t addr_size,
+                            const void *addr,
+                            size_t count,
+                            size_t value_size,
+                            const void *values);
+
 /**
 
    sim_panel_mem_deposit_instruction
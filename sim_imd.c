@@ -47,25 +47,54 @@
 static t_stat commentParse(DISK_INFO *myDisk, uint8 comment[], uint32 buffLen);
 static t_stat diskParse(DISK_INFO *myDisk, uint32 isVerbose);
 static t_stat diskFormat(DISK_INFO *myDisk);
+static void diskFreeTracks(DISK_INFO *myDisk);
+static void diskIoFlush(UNIT *uptr);
+
+static DISK_INFO *imd_open_disks = NULL;    /* List of open disks */
 
 /* Open an existing IMD disk image.  It will be opened and parsed, and after this
  * call, will be ready for sector read/write. The result is the corresponding
  * DISK_INFO or NULL if an error occurred.
+ *
+ * The sector data is loaded into the track cache.  If the image is attached to
+ * a unit of the device, modified tracks are written back when SCP flushes the
+ * unit, as well as when the disk is closed.
  */
 DISK_INFO *diskOpenEx(FILE *fileref, uint32 isVerbose, DEVICE *device, uint32 debugmask, uint32 verbosedebugmask)
 {
     DISK_INFO *myDisk = NULL;
+    uint32 i;
 
-    myDisk = (DISK_INFO *)malloc(sizeof(DISK_INFO));
+    myDisk = (DISK_INFO *)calloc(1, sizeof(DISK_INFO));
+    if (myDisk == NULL)
+        return NULL;
     myDisk->file = fileref;
     myDisk->device = device;
     myDisk->debugmask = debugmask;
     myDisk->verbosedebugmask = verbosedebugmask;
 
     if (diskParse(myDisk, isVerbose) != SCPE_OK) {
+        diskFreeTracks(myDisk);
         free(myDisk);
-        myDisk = NULL;
+        return NULL;
+    }
+
+    for (i = 0; (device != NULL) && (i < device->numunits); i++) {
+        UNIT *uptr = &device->units[i];
+
+        if ((uptr->flags & UNIT_ATT) && (uptr->fileref == fileref)) {
+            myDisk->uptr = uptr;
+            if (uptr->flags & UNIT_RO)
+                myDisk->flags |= FD_FLAG_WRITELOCK;
+            if (uptr->io_flush == NULL) {
+                uptr->io_flush = diskIoFlush;
+                uptr->dynflags |= UNIT_SYNC_FLUSH;
+            }
+            break;
+        }
     }
+    myDisk->next = imd_open_disks;
+    imd_open_disks = myDisk;
 
     return myDisk;
 }
@@ -106,7 +135,22 @@ static t_stat commentParse(DISK_INFO *myDisk, uint8 comment[], uint32 buffLen)
 }
 
 static uint32 headerOk(IMD_HEADER imd) {
-    return (imd.cyl < MAX_CYL) && (imd.head < MAX_HEAD);
+    return (imd.cyl < MAX_CYL) && (imd.head < MAX_HEAD) && (imd.nsects <= MAX_SPT);
+}
+
+/* Release the track cache. */
+static void diskFreeTracks(DISK_INFO *myDisk)
+{
+    uint32 i, j;
+
+    for(i=0;i<MAX_CYL;i++) {
+        for(j=0;j<MAX_HEAD;j++) {
+            free(myDisk->track[i][j].data);
+        }
+    }
+    memset(myDisk->track, 0, sizeof(myDisk->track));
+    myDisk->ntracks = 0;
+    myDisk->nsides = 1;
 }
 
 /* Parse an IMD image.  This sets up sim_imd to be able to do sector read/write and
@@ -121,6 +165,9 @@ static t_stat diskParse(DISK_INFO *myDisk, uint32 isVerbose)
     uint32 sectorSize, sectorHeadwithFlags, sectRecordType;
     uint32 hdrBytes, i;
     uint8 start_sect;
+    uint8 *sectorData;
+    TRACK_INFO *trk;
+    t_offset trackOffset;
 
     uint32 TotalSectorCount = 0;
     IMD_HEADER imd;
@@ -129,11 +176,12 @@ static t_stat diskParse(DISK_INFO *myDisk, uint32 isVerbose)
         return (SCPE_OPENERR);
     }
 
-    memset(myDisk->track, 0, (sizeof(TRACK_INFO)*MAX_CYL*MAX_HEAD));
+    diskFreeTracks(myDisk);
 
     if (commentParse(myDisk, comment, sizeof(comment)) != SCPE_OK) {
         return (SCPE_OPENERR);
     }
+    myDisk->dataStart = sim_ftell(myDisk->file);
 
     if(isVerbose)
         sim_printf("%s\n", comment);
@@ -148,7 +196,8 @@ static t_stat diskParse(DISK_INFO *myDisk, uint32 isVerbose)
     }
 
     do {
-        sim_debug(myDisk->debugmask, myDisk->device, "start of track %d at file offset %ld\n", myDisk->ntracks, ftell(myDisk->file));
+        trackOffset = sim_ftell(myDisk->file);
+        sim_debug(myDisk->debugmask, myDisk->device, "start of track %d at file offset %ld\n", myDisk->ntracks, (long)trackOffset);
 
         hdrBytes = sim_fread(&imd, 1, 5, myDisk->file);
   
@@ -190,14 +239,30 @@ static t_stat diskParse(DISK_INFO *myDisk, uint32 isVerbose)
             return (SCPE_IERR);
         }
 
-        myDisk->track[imd.cyl][imd.head].mode = imd.mode;
-        myDisk->track[imd.cyl][imd.head].nsects = imd.nsects;
-        myDisk->track[imd.cyl][imd.head].sectsize = sectorSize;
+        trk = &myDisk->track[imd.cyl][imd.head];
+        if (trk->fileLen != 0) {    /* A later copy of a track replaces the earlier one */
+            for(i=0;myDisk->trackOrder[i] != ((imd.cyl << 1) | imd.head);i++);
+            memmove(&myDisk->trackOrder[i], &myDisk->trackOrder[i + 1], (myDisk->ntracks - i - 1) * sizeof(myDisk->trackOrder[0]));
+            myDisk->ntracks--;
+            free(trk->data);
+            memset(trk, 0, sizeof(*trk));
+        }
+
+        trk->mode = imd.mode;
+        trk->nsects = imd.nsects;
+        trk->sectsize = sectorSize;
+        trk->mapFlags = sectorHeadwithFlags & (IMD_FLAG_SECT_HEAD_MAP | IMD_FLAG_SECT_CYL_MAP);
+        trk->fileOffset = trackOffset;
+        if ((imd.nsects != 0) && ((trk->data = (uint8 *)malloc(imd.nsects * sectorSize)) == NULL)) {
+            sim_printf("SIM_IMD: Memory allocation failure.\n");
+            return (SCPE_MEM);
+        }
 
         if (sim_fread(sectorMap, 1, imd.nsects, myDisk->file) != imd.nsects) {
             sim_printf("SIM_IMD: Corrupt file [Sector Map].\n");
             return (SCPE_OPENERR);
         }
+        memcpy(trk->sectorMap, sectorMap, imd.nsects);
         myDisk->track[imd.cyl][imd.head].start_sector = imd.nsects;
         sim_debug(myDisk->debugmask, myDisk->device, "\tSector Map: ");
         for(i=0;i<imd.nsects;i++) {
@@ -256,26 +321,22 @@ static t_stat diskParse(DISK_INFO *myDisk, uint32 isVerbose)
             myDisk->track[imd.cyl][imd.head].logicalHead[i] = sectorHeadMap[i];
             /* AGN Logical cylinder mapping */
             myDisk->track[imd.cyl][imd.head].logicalCyl[i] = sectorCylMap[i];
+            if (sectorMap[i]-start_sect >= MAX_SPT) {
+                sim_printf("SIM_IMD: ERROR: Illegal sector offset %d\n", sectorMap[i]-start_sect);
+                return (SCPE_OPENERR);
+            }
+            sectorData = trk->data + i * sectorSize;
             switch(sectRecordType) {
                 case SECT_RECORD_UNAVAILABLE:   /* Data could not be read from the original media */
-                    if (sectorMap[i]-start_sect < MAX_SPT)
-                        myDisk->track[imd.cyl][imd.head].sectorOffsetMap[sectorMap[i]-start_sect] = 0xBADBAD;
-                    else {
-                        sim_printf("SIM_IMD: ERROR: Illegal sector offset %d\n", sectorMap[i]-start_sect);
-                        return (SCPE_OPENERR);
-                    }
+                    memset(sectorData, 0, sectorSize);
                     break;
                 case SECT_RECORD_NORM:          /* Normal Data */
                 case SECT_RECORD_NORM_DAM:      /* Normal Data with deleted address mark */
                 case SECT_RECORD_NORM_ERR:      /* Normal Data with read error */
                 case SECT_RECORD_NORM_DAM_ERR:  /* Normal Data with deleted address mark with read error */
 /*                  sim_debug(myDisk->debugmask, myDisk->device, "Uncompressed Data\n"); */
-                    if (sectorMap[i]-start_sect < MAX_SPT) {
-                        myDisk->track[imd.cyl][imd.head].sectorOffsetMap[sectorMap[i]-start_sect] = ftell(myDisk->file);
-                        (void)sim_fseek(myDisk->file, sectorSize, SEEK_CUR);
-                    }
-                    else {
-                        sim_printf("SIM_IMD: ERROR: Illegal sector offset %d\n", sectorMap[i]-start_sect);
+                    if (sim_fread(sectorData, 1, sectorSize, myDisk->file) != sectorSize) {
+                        sim_printf("SIM_IMD: Corrupt file [Sector Data].\n");
                         return (SCPE_OPENERR);
                     }
                     break;
@@ -283,64 +344,224 @@ static t_stat diskParse(DISK_INFO *myDisk, uint32 isVerbose)
                 case SECT_RECORD_NORM_DAM_COMP: /* Compressed Normal Data with deleted address mark */
                 case SECT_RECORD_NORM_COMP_ERR: /* Compressed Normal Data */
                 case SECT_RECORD_NORM_DAM_COMP_ERR: /* Compressed Normal Data with deleted address mark */
-                    if (sectorMap[i]-start_sect < MAX_SPT) {
-                        myDisk->track[imd.cyl][imd.head].sectorOffsetMap[sectorMap[i]-start_sect] = ftell(myDisk->file);
-                        myDisk->flags |= FD_FLAG_WRITELOCK; /* Write-protect the disk if any sectors are compressed. */
-                        if (1) {
-                            uint8 cdata = (uint8)fgetc(myDisk->file);
-
-                            sim_debug(myDisk->debugmask, myDisk->device, "Compressed Data = 0x%02x", cdata);
-                            }
-                    }
-                    else {
-                        sim_printf("SIM_IMD: ERROR: Illegal sector offset %d\n", sectorMap[i]-start_sect);
-                        return (SCPE_OPENERR);
-                    }
+                    if (1) {
+                        uint8 cdata = (uint8)fgetc(myDisk->file);
+
+                        sim_debug(myDisk->debugmask, myDisk->device, "Compressed Data = 0x%02x", cdata);
+                        memset(sectorData, cdata, sectorSize);
+                        }
                     break;
                 default:
                     sim_printf("SIM_IMD: ERROR: unrecognized sector record type %d\n", sectRecordType);
                     return (SCPE_OPENERR);
                     break;
             }
+            trk->recordType[i] = (uint8)sectRecordType;
+            trk->physSector[sectorMap[i]-start_sect] = (uint8)(i + 1);
             sim_debug(myDisk->debugmask, myDisk->device, "\n");
         }
 
-        myDisk->ntracks++;
+        trk->fileLen = (uint32)(sim_ftell(myDisk->file) - trackOffset);
+        myDisk->trackOrder[myDisk->ntracks++] = (uint16)((imd.cyl << 1) | imd.head);
 
     } while (!feof(myDisk->file));
+    myDisk->dataEnd = sim_ftell(myDisk->file);
 
     sim_debug(myDisk->debugmask, myDisk->device, "Processed %d sectors\n", TotalSectorCount);
 
     for(i=0;i<myDisk->ntracks;i++) {
         uint8 j;
-        sim_debug(myDisk->verbosedebugmask, myDisk->device, "Track %3d: ", i);
-        for(j=0;j<myDisk->track[i >> 1][i & 1].nsects;j++) {
-            sim_debug(myDisk->verbosedebugmask, myDisk->device, "0x%05x ", myDisk->track[i >> 1][i & 1].sectorOffsetMap[j]);
+        trk = &myDisk->track[myDisk->trackOrder[i] >> 1][myDisk->trackOrder[i] & 1];
+        sim_debug(myDisk->verbosedebugmask, myDisk->device, "Track %3d: C:%d/H:%d at 0x%05x: ", i,
+                  myDisk->trackOrder[i] >> 1, myDisk->trackOrder[i] & 1, (uint32)trk->fileOffset);
+        for(j=0;j<trk->nsects;j++) {
+            sim_debug(myDisk->verbosedebugmask, myDisk->device, "%d ", trk->sectorMap[j]);
         }
         sim_debug(myDisk->verbosedebugmask, myDisk->device, "\n");
     }
-    if(myDisk->flags & FD_FLAG_WRITELOCK) {
-        sim_printf("Disk write-protected because the image contains compressed sectors. Use IMDU to uncompress.\n");
-    }
 
     return SCPE_OK;
 }
 
 /*
  * This function closes the IMD image.  After closing, the sector read/write operations are not
- * possible.
+ * possible.  Modified tracks are written back first.
  *
  * The IMD file is not actually closed, we leave that to SIMH.
  */
 t_stat diskClose(DISK_INFO **myDisk)
 {
+    DISK_INFO **dpp;
+    UNIT *uptr;
+
     if(*myDisk == NULL)
         return SCPE_OPENERR;
+    diskFlush(*myDisk);
+    for(dpp = &imd_open_disks; *dpp != NULL; dpp = &(*dpp)->next) {
+        if(*dpp == *myDisk) {
+            *dpp = (*myDisk)->next;
+            break;
+        }
+    }
+    uptr = (*myDisk)->uptr;
+    if((uptr != NULL) && (uptr->io_flush == diskIoFlush)) {
+        uptr->io_flush = NULL;
+        uptr->dynflags &= ~UNIT_SYNC_FLUSH;
+    }
+    diskFreeTracks(*myDisk);
     free(*myDisk);
     *myDisk = NULL;
     return SCPE_OK;
 }
 
+/* Length of a sector record in the IMD file. */
+static uint32 sectRecordLen(uint8 sectRecordType, uint32 sectsize)
+{
+    switch(sectRecordType) {
+        case SECT_RECORD_UNAVAILABLE:
+            return 1;
+        case SECT_RECORD_NORM_COMP:
+        case SECT_RECORD_NORM_DAM_COMP:
+        case SECT_RECORD_NORM_COMP_ERR:
+        case SECT_RECORD_NORM_DAM_COMP_ERR:
+            return 2;
+        default:
+            return 1 + sectsize;
+    }
+}
+
+/* Encode a cached track as a track record of the IMD file and return its
+ * length.  If buf is NULL, only the length is computed.
+ */
+static uint32 trackEncode(TRACK_INFO *trk, uint32 Cyl, uint32 Head, uint8 *buf)
+{
+    uint32 len, i;
+    uint8 sectsize = 0;
+
+    len = 5 + trk->nsects;
+    if(trk->mapFlags & IMD_FLAG_SECT_HEAD_MAP)
+        len += trk->nsects;
+    if(trk->mapFlags & IMD_FLAG_SECT_CYL_MAP)
+        len += trk->nsects;
+    for(i=0;i<trk->nsects;i++) {
+        len += sectRecordLen(trk->recordType[i], trk->sectsize);
+    }
+    if(buf == NULL)
+        return len;
+
+    while((128u << sectsize) < trk->sectsize)
+        sectsize++;
+    *buf++ = trk->mode;
+    *buf++ = (uint8)Cyl;
+    *buf++ = (uint8)Head | trk->mapFlags;
+    *buf++ = trk->nsects;
+    *buf++ = sectsize;
+    memcpy(buf, trk->sectorMap, trk->nsects);
+    buf += trk->nsects;
+    if(trk->mapFlags & IMD_FLAG_SECT_HEAD_MAP) {
+        memcpy(buf, trk->logicalHead, trk->nsects);
+        buf += trk->nsects;
+    }
+    if(trk->mapFlags & IMD_FLAG_SECT_CYL_MAP) {
+        memcpy(buf, trk->logicalCyl, trk->nsects);
+        buf += trk->nsects;
+    }
+    for(i=0;i<trk->nsects;i++) {
+        uint8 *sectorData = trk->data + i * trk->sectsize;
+
+        *buf++ = trk->recordType[i];
+        switch(sectRecordLen(trk->recordType[i], trk->sectsize)) {
+            case 1:                     /* No data */
+                break;
+            case 2:                     /* Compressed */
+                *buf++ = sectorData[0];
+                break;
+            default:
+                memcpy(buf, sectorData, trk->sectsize);
+                buf += trk->sectsize;
+                break;
+        }
+    }
+    return len;
+}
+
+/* Write the modified tracks back to the IMD file.  Track records which keep
+ * their location and length are rewritten in place.  From the first one that
+ * doesn't (a newly formatted track, or a compressed sector which has been
+ * written) on, the rest of the file is rewritten.
+ */
+t_stat diskFlush(DISK_INFO *myDisk)
+{
+    t_offset pos;
+    uint8 *buf = NULL;
+    uint32 i, len, buflen = 0;
+    t_bool rewrite = FALSE;
+    t_stat r = SCPE_OK;
+
+    if(myDisk == NULL)
+        return SCPE_OPENERR;
+    if(!myDisk->dirty)
+        return SCPE_OK;
+
+    pos = myDisk->dataStart;
+    for(i=0;i<myDisk->ntracks;i++) {
+        uint32 Cyl = myDisk->trackOrder[i] >> 1;
+        uint32 Head = myDisk->trackOrder[i] & 1;
+        TRACK_INFO *trk = &myDisk->track[Cyl][Head];
+
+        len = trackEncode(trk, Cyl, Head, NULL);
+        if((trk->fileOffset != pos) || (trk->fileLen != len))
+            rewrite = TRUE;
+        if(rewrite || trk->dirty) {
+            if(len > buflen) {
+                free(buf);
+                buflen = len;
+                if((buf = (uint8 *)malloc(buflen)) == NULL) {
+                    r = SCPE_MEM;
+                    break;
+                }
+            }
+            trackEncode(trk, Cyl, Head, buf);
+            if((sim_fseeko(myDisk->file, pos, SEEK_SET) != 0) ||
+               (sim_fwrite(buf, 1, len, myDisk->file) != len)) {
+                r = SCPE_IOERR;
+                break;
+            }
+            sim_debug(myDisk->debugmask, myDisk->device, "Wrote back C:%d/H:%d, offset=0x%08x, len=%d\n", Cyl, Head, (uint32)pos, len);
+            trk->fileOffset = pos;
+            trk->fileLen = len;
+            trk->dirty = 0;
+        }
+        pos += len;
+    }
+    free(buf);
+
+    if((r == SCPE_OK) && (fflush(myDisk->file) == EOF))
+        r = SCPE_IOERR;
+    if((r == SCPE_OK) && (pos != myDisk->dataEnd)) {
+        if(sim_set_fsize(myDisk->file, (t_addr)pos) == -1)
+            r = SCPE_IOERR;
+        else
+            myDisk->dataEnd = pos;
+    }
+    if(r == SCPE_OK)
+        myDisk->dirty = 0;
+    else
+        sim_printf("SIM_IMD: Error writing back disk image: %s\n", sim_error_text(r));
+    return r;
+}
+
+/* Unit flush routine, called by SCP. */
+static void diskIoFlush(UNIT *uptr)
+{
+    DISK_INFO *myDisk;
+
+    for(myDisk = imd_open_disks; myDisk != NULL; myDisk = myDisk->next) {
+        if(myDisk->uptr == uptr)
+            diskFlush(myDisk);
+    }
+}
+
 #define MAX_COMMENT_LEN 256
 
 /*
@@ -489,6 +710,20 @@ t_stat sectSeek(DISK_INFO *myDisk,
     return(SCPE_OK);
 }
 
+/* Locate a sector in the track cache, NULL if the track has no such sector. */
+static uint8 *sectLocate(TRACK_INFO *trk, uint32 Sector, uint8 **recordType)
+{
+    uint32 phys;
+
+    if((Sector < trk->start_sector) || (Sector - trk->start_sector >= MAX_SPT))
+        return NULL;
+    phys = trk->physSector[Sector - trk->start_sector];
+    if(phys == 0)
+        return NULL;
+    *recordType = &trk->recordType[phys - 1];
+    return trk->data + (phys - 1) * trk->sectsize;
+}
+
 /* Read a sector from an IMD image. */
 t_stat sectRead(DISK_INFO *myDisk,
              uint32 Cyl,
@@ -499,9 +734,9 @@ t_stat sectRead(DISK_INFO *myDisk,
              uint32 *flags,
              uint32 *readlen)
 {
-    uint32 sectorFileOffset;
+    uint8 *sectorData;
+    uint8 *recordType;
     uint8 sectRecordType;
-    uint8 start_sect;
     *readlen = 0;
     *flags = 0;
 
@@ -528,15 +763,16 @@ t_stat sectRead(DISK_INFO *myDisk,
         return(SCPE_IOERR);
     }
 
-    start_sect = myDisk->track[Cyl][Head].start_sector;
-
-    sectorFileOffset = myDisk->track[Cyl][Head].sectorOffsetMap[Sector-start_sect];
-
-    sim_debug(myDisk->debugmask, myDisk->device, "Reading C:%d/H:%d/S:%d, len=%d, offset=0x%08x\n", Cyl, Head, Sector, buflen, sectorFileOffset);
+    sectorData = sectLocate(&myDisk->track[Cyl][Head], Sector, &recordType);
+    if(sectorData == NULL) {
+        sim_debug(myDisk->debugmask, myDisk->device, "%s: sector not found\n", __FUNCTION__);
+        *flags |= IMD_DISK_IO_ERROR_GENERAL;
+        return(SCPE_IOERR);
+    }
 
-    (void)sim_fseek(myDisk->file, sectorFileOffset-1, SEEK_SET);
+    sim_debug(myDisk->debugmask, myDisk->device, "Reading C:%d/H:%d/S:%d, len=%d\n", Cyl, Head, Sector, buflen);
 
-    sectRecordType = (uint8)fgetc(myDisk->file);
+    sectRecordType = *recordType;
     switch(sectRecordType) {
         case SECT_RECORD_UNAVAILABLE:   /* Data could not be read from the original media */
             *flags |= IMD_DISK_IO_ERROR_GENERAL;
@@ -549,9 +785,7 @@ t_stat sectRead(DISK_INFO *myDisk,
         case SECT_RECORD_NORM_DAM:      /* Normal Data with deleted address mark */
 
 /*          sim_debug(myDisk->debugmask, myDisk->device, "Uncompressed Data\n"); */
-            if (sim_fread(buf, 1, myDisk->track[Cyl][Head].sectsize, myDisk->file) != myDisk->track[Cyl][Head].sectsize) {
-                sim_printf("SIM_IMD[%s]: sim_fread error for SECT_RECORD_NORM_DAM.\n", __FUNCTION__);
-            }
+            memcpy(buf, sectorData, myDisk->track[Cyl][Head].sectsize);
             *readlen = myDisk->track[Cyl][Head].sectsize;
             break;
         case SECT_RECORD_NORM_COMP_ERR: /* Compressed Normal Data */
@@ -561,7 +795,7 @@ t_stat sectRead(DISK_INFO *myDisk,
         case SECT_RECORD_NORM_COMP:     /* Compressed Normal Data */
         case SECT_RECORD_NORM_DAM_COMP: /* Compressed Normal Data with deleted address mark */
 /*          sim_debug(myDisk->debugmask, myDisk->device, "Compressed Data\n"); */
-            memset(buf, fgetc(myDisk->file), myDisk->track[Cyl][Head].sectsize);
+            memcpy(buf, sectorData, myDisk->track[Cyl][Head].sectsize);
             *readlen = myDisk->track[Cyl][Head].sectsize;
             *flags |= IMD_DISK_IO_COMPRESSED;
             break;
@@ -594,9 +828,9 @@ t_stat sectWrite(DISK_INFO *myDisk,
               uint32 *flags,
               uint32 *writelen)
 {
-    uint32 sectorFileOffset;
+    uint8 *sectorData;
+    uint8 *recordType;
     uint8 sectRecordType;
-    uint8 start_sect;
     *writelen = 0;
 
     sim_debug(myDisk->debugmask, myDisk->device, "Writing C:%d/H:%d/S:%d, len=%d\n", Cyl, Head, Sector, buflen);
@@ -619,7 +853,7 @@ t_stat sectWrite(DISK_INFO *myDisk,
     }
 
     if(myDisk->flags & FD_FLAG_WRITELOCK) {
-        sim_printf("Disk write-protected because the image contains compressed sectors. Use IMDU to uncompress.\n");
+        sim_printf("Disk write-protected, cannot write sectors.\n");
         *flags = IMD_DISK_IO_ERROR_WPROT;
         return(SCPE_IOERR);
     }
@@ -631,11 +865,12 @@ t_stat sectWrite(DISK_INFO *myDisk,
         return(SCPE_IOERR);
     }
 
-    start_sect = myDisk->track[Cyl][Head].start_sector;
-
-    sectorFileOffset = myDisk->track[Cyl][Head].sectorOffsetMap[Sector-start_sect];
-
-    (void)sim_fseek(myDisk->file, sectorFileOffset-1, SEEK_SET);
+    sectorData = sectLocate(&myDisk->track[Cyl][Head], Sector, &recordType);
+    if(sectorData == NULL) {
+        sim_debug(myDisk->debugmask, myDisk->device, "%s: sector not found\n", __FUNCTION__);
+        *flags = IMD_DISK_IO_ERROR_GENERAL;
+        return(SCPE_IOERR);
+    }
 
     if (*flags & IMD_DISK_IO_ERROR_GENERAL) {
         sectRecordType = SECT_RECORD_UNAVAILABLE;
@@ -651,8 +886,12 @@ t_stat sectWrite(DISK_INFO *myDisk,
         sectRecordType = SECT_RECORD_NORM;
     }
 
-    fputc(sectRecordType, myDisk->file);
-    sim_fwrite(buf, 1, myDisk->track[Cyl][Head].sectsize, myDisk->file);
+    /* The track is written back to the file later, rewriting the rest of the file if
+     * the sector was compressed. */
+    *recordType = sectRecordType;
+    memcpy(sectorData, buf, myDisk->track[Cyl][Head].sectsize);
+    myDisk->track[Cyl][Head].dirty = 1;
+    myDisk->dirty = 1;
     *writelen = myDisk->track[Cyl][Head].sectsize;
 
     return(SCPE_OK);
@@ -665,7 +904,7 @@ t_stat sectWrite(DISK_INFO *myDisk,
  * does not involve changing the disk image size.)
  *
  * Any existing data on the disk image will be destroyed when Track 0, Head 0 is formatted.
- * At that time, the IMD file is truncated.  So for the trackWrite to be used to sucessfully
+ * At that time, all tracks are discarded and the IMD file will be truncated.  So for the trackWrite to be used to sucessfully
  * format a disk image, then format program must format tracks starting with Cyl 0, Head 0,
  * and proceed sequentially through all tracks/heads on the disk.
  *
@@ -689,12 +928,8 @@ t_stat trackWrite(DISK_INFO *myDisk,
                uint8 fillbyte,
                uint32 *flags)
 {
-    FILE *fileref;
-    IMD_HEADER track_header = { 0 };
-    uint8 *sectorData;
-    t_addr comment;
+    TRACK_INFO *trk;
     unsigned long i;
-    unsigned long dataLen;
     uint8 sectsize = 0;
 
     *flags = 0;
@@ -711,26 +946,19 @@ t_stat trackWrite(DISK_INFO *myDisk,
         return(SCPE_IOERR);
     }
 
-    fileref = myDisk->file;
-
     sim_debug(myDisk->debugmask, myDisk->device, "Formatting C:%d/H:%d/N:%d, len=%d, Fill=0x%02x\n", Cyl, Head, numSectors, sectorLen, fillbyte);
 
-    /* Truncate the IMD file when formatting Cyl 0, Head 0 */
-    if((Cyl == 0) && (Head == 0))
-    {
-        /* Skip over IMD comment field. */
-        commentParse(myDisk, NULL, 0);
+    /* Discard all tracks when formatting Cyl 0, Head 0.  The IMD file is truncated
+     * after the comment field when the disk is written back. */
+    if((Cyl == 0) && (Head == 0)) {
+        diskFreeTracks(myDisk);
+        myDisk->dirty = 1;
+    }
 
-        /* Truncate the IMD file after the comment field. */
-        if (((comment = (t_addr)ftell (fileref)) == (t_addr)-1) ||
-            (sim_set_fsize(fileref, comment) == -1)) {
-            sim_printf("Disk truncation failed.\n");
-            *flags |= IMD_DISK_IO_ERROR_GENERAL;
-            return(SCPE_IOERR);
-        }
-        /* Flush and re-parse the IMD file. */
-        fflush(fileref);
-        diskParse(myDisk, 0);
+    if((Cyl >= MAX_CYL) || (Head >= MAX_HEAD) || (numSectors > MAX_SPT)) {
+        sim_printf("SIM_IMD: ERROR: Invalid track C:%d/H:%d/N:%d\n", Cyl, Head, numSectors);
+        *flags |= IMD_DISK_IO_ERROR_GENERAL;
+        return(SCPE_IOERR);
     }
 
     /* Check to make sure the Cyl / Head is not already formatted. */
@@ -740,11 +968,6 @@ t_stat trackWrite(DISK_INFO *myDisk,
         return(SCPE_IOERR);
     }
 
-    track_header.mode = mode;
-    track_header.cyl = Cyl;
-    track_header.head = Head;
-    track_header.nsects = numSectors;
-
     for (i = (sectorLen >> 8); i; i >>= 1) {
         sectsize++;
     }
@@ -753,33 +976,44 @@ t_stat trackWrite(DISK_INFO *myDisk,
         sim_printf("SIM_IMD: ERROR: Invalid sectsize %d\n", sectsize);
         return(SCPE_IERR);
     }
-    track_header.sectsize = sectsize;
-
-    /* Forward to end of the file, write track header and sector map. */
-    (void)sim_fseek(myDisk->file, 0, SEEK_END);
-    sim_fwrite(&track_header, 1, sizeof(IMD_HEADER), fileref);
-    sim_fwrite(sectorMap, 1, numSectors, fileref);
 
-    /* Compute data length, and fill a sector buffer with the
-     * sector record type as the first byte, and fill the sector
-     * data with the fillbyte.
-     */
-    dataLen = sectorLen + 1;
-    sectorData = (uint8 *)malloc(dataLen);
-    memset(sectorData, fillbyte, dataLen);
-    sectorData[0] = SECT_RECORD_NORM;
-
-    /* For each sector on the track, write the record type and sector data. */
+    /* Add the track to the cache with each sector filled with the fillbyte. */
+    trk = &myDisk->track[Cyl][Head];
+    free(trk->data);
+    memset(trk, 0, sizeof(*trk));
+    trk->mode = mode;
+    trk->nsects = (uint8)numSectors;
+    trk->sectsize = 128 << sectsize;
+    if((numSectors != 0) && ((trk->data = (uint8 *)malloc(numSectors * trk->sectsize)) == NULL)) {
+        *flags |= IMD_DISK_IO_ERROR_GENERAL;
+        return(SCPE_MEM);
+    }
+    memset(trk->data, fillbyte, numSectors * trk->sectsize);
+    memcpy(trk->sectorMap, sectorMap, numSectors);
+    trk->start_sector = (uint8)numSectors;
     for(i=0;i<numSectors;i++) {
-        sim_fwrite(sectorData, 1, dataLen, fileref);
+        if(sectorMap[i] < trk->start_sector)
+            trk->start_sector = sectorMap[i];
     }
+    for(i=0;i<numSectors;i++) {
+        if(sectorMap[i] - trk->start_sector < MAX_SPT)
+            trk->physSector[sectorMap[i] - trk->start_sector] = (uint8)(i + 1);
+        trk->logicalHead[i] = (uint8)Head;
+        trk->logicalCyl[i] = (uint8)Cyl;
+        trk->recordType[i] = SECT_RECORD_NORM;
+    }
+    trk->dirty = 1;
 
-    /* Flush the file, and free the sector buffer. */
-    fflush(fileref);
-    free(sectorData);
-
-    /* Now that the disk track/sector layout has been modified, re-parse the disk image. */
-    diskParse(myDisk, 0);
+    /* The new track goes after any existing tracks in the file. */
+    for(i=0;i<myDisk->ntracks;i++) {
+        if(myDisk->trackOrder[i] == ((Cyl << 1) | Head))
+            break;
+    }
+    if(i == myDisk->ntracks)
+        myDisk->trackOrder[myDisk->ntracks++] = (uint16)((Cyl << 1) | Head);
+    if((Head + 1) > myDisk->nsides)
+        myDisk->nsides = Head + 1;
+    myDisk->dirty = 1;
 
     return(SCPE_OK);
 }
@@ -91,30 +91,49 @@ typedef struct {
 #define IMAGE_TYPE_IMD          2               /* ImageDisk "IMD" image file.              */
 #define IMAGE_TYPE_CPT          3               /* CP/M Transfer "CPT" image file.          */
 
+/* The whole image is held in memory while it is open.  Sector reads and
+ * writes only touch the track cache, and modified tracks are written back
+ * to the file by diskFlush(), which SCP calls periodically through the
+ * unit's io_flush routine, and by diskClose().
+ */
 typedef struct {
     uint8 mode;
     uint8 nsects;
     uint32 sectsize;
-    uint32 sectorOffsetMap[MAX_SPT];
+    uint8 physSector[MAX_SPT];      /* Logical sector to physical position + 1, 0 if absent */
     uint8 start_sector;
     uint8 logicalHead[MAX_SPT];
     uint8 logicalCyl[MAX_SPT];
+    uint8 sectorMap[MAX_SPT];       /* Sector numbers in physical order */
+    uint8 recordType[MAX_SPT];      /* SECT_RECORD_xxx in physical order */
+    uint8 mapFlags;                 /* IMD_FLAG_SECT_HEAD_MAP/IMD_FLAG_SECT_CYL_MAP */
+    uint8 dirty;                    /* Track modified since last written back */
+    uint8 *data;                    /* nsects * sectsize bytes of sector data */
+    t_offset fileOffset;            /* Location of the track record in the file */
+    uint32 fileLen;                 /* Length of the track record in the file */
 } TRACK_INFO;
 
-typedef struct {
+typedef struct disk_info {
     FILE *file;
     uint32 ntracks;
     uint8 nsides;
     uint8 flags;
+    uint8 dirty;                    /* Some track needs to be written back */
     DEVICE *device;
+    UNIT *uptr;                     /* Unit attached to file, if known */
+    struct disk_info *next;         /* List of open disks */
     uint32 debugmask;
     uint32 verbosedebugmask;
+    t_offset dataStart;             /* File offset of the first track record */
+    t_offset dataEnd;               /* File offset after the last track record */
+    uint16 trackOrder[MAX_CYL * MAX_HEAD];  /* (Cyl << 1) | Head in file order */
     TRACK_INFO track[MAX_CYL][MAX_HEAD];
 } DISK_INFO;
 
 extern DISK_INFO *diskOpen(FILE *fileref, uint32 isVerbose);
 extern DISK_INFO *diskOpenEx(FILE *fileref, uint32 isVerbose, DEVICE *device, uint32 debugmask, uint32 verbosedebugmask);
 extern t_stat diskClose(DISK_INFO **myDisk);
+extern t_stat diskFlush(DISK_INFO *myDisk);
 extern t_stat diskCreate(FILE *fileref, const char *ctlr_comment);
 extern uint32 imdGetSides(DISK_INFO *myDisk);
 extern uint32 imdIsWriteLocked(DISK_INFO *myDisk);
@@ -54,10 +54,17 @@
 #define CMD_SNDDIAG     0x1D                            /* send diagnostic */
 #define CMD_SPACE       0x11                            /* space */
 #define CMD_WRFMARK     0x10                            /* write filemarks */
+#define CMD_UNMAP       0x42                            /* unmap */
+#define CMD_SYNCCACHE   0x35                            /* synchronize cache */
 
 #define CMD_READ6_TAPE_FIXED    0x01                    /* Fixed record size read */
 #define CMD_READ6_TAPE_SILI     0x02                    /* Suppress Incorrect Length Indicator */
 
+/* SCSI messages */
+
+#define MSG_SIMPLE_TAG  0x20                            /* simple queue tag */
+#define MSG_HEAD_TAG    0x21                            /* head of queue tag */
+#define MSG_ORDERED_TAG 0x22                            /* ordered queue tag */
 
 /* SCSI status codes */
 
@@ -77,7 +84,10 @@
 
 #define ASC_OK          0                               /* no additional sense information */
 #define ASC_INVCOM      0x20                            /* invalid command operation code */
+#define ASC_LBAOOR      0x21                            /* logical block address out of range */
 #define ASC_INVCDB      0x24                            /* invalid field in cdb */
+#define ASC_INVPARM     0x26                            /* invalid field in parameter list */
+#define ASC_WRPROT      0x27                            /* write protected */
 #define ASC_NOMEDIA     0x3A                            /* media not present */
 
 #define PUTL(b,x,v)     b[x] = (v >> 24) & 0xFF; \
@@ -149,6 +159,7 @@ sim_debug (SCSI_DBG_BUS, bus->dptr,
 bus->phase = SCSI_DATO;                                 /* bus free state */
 bus->initiator = -1;
 bus->target = -1;
+bus->tagged = FALSE;
 bus->buf_t = bus->buf_b = 0;
 }
 
@@ -163,6 +174,15 @@ if (bus->target != -1)                                  /* target selected? */
     bus->phase = SCSI_MSGO;                             /* go to msg out phase */
 }
 
+/* Assert the attention signal for identify and queue tag messages
+   (select with ATN3) */
+
+void scsi_set_atn3 (SCSI_BUS *bus)
+{
+scsi_set_atn (bus);
+bus->tagged = TRUE;                                     /* tag follows identify */
+}
+
 /* Clear the attention signal */
 
 void scsi_release_atn (SCSI_BUS *bus)
@@ -247,8 +267,24 @@ if (data[0] & 0x80) {                                   /* identify */
     sim_debug (SCSI_DBG_MSG, bus->dptr,
         "Identify, LUN = %d\n", bus->lun);
     scsi_set_req (bus);                                 /* request data */
+    if (bus->tagged) {                                  /* queue tag follows? */
+        bus->tagged = FALSE;
+        return 1;                                       /* stay in msg out */
+        }
     used = 1;                                           /* message length */
     }
+else if ((data[0] >= MSG_SIMPLE_TAG) && (data[0] <= MSG_ORDERED_TAG)) { /* queue tag */
+    /* Targets never disconnect, so each tagged command runs to completion
+       in the order received which satisfies simple, head of queue and
+       ordered semantics alike */
+    if (len < 2)
+        return 0;                                       /* need more */
+    sim_debug (SCSI_DBG_MSG, bus->dptr,
+        "%s queue tag %02X\n", (data[0] == MSG_SIMPLE_TAG) ? "Simple" :
+        ((data[0] == MSG_HEAD_TAG) ? "Head of queue" : "Ordered"), data[1]);
+    scsi_set_req (bus);                                 /* request data */
+    used = 2;
+    }
 else if (data[0] == 0x1) {                              /* extended message */
     if (len < 2)
         return 0;                                       /* need more */
@@ -727,6 +763,17 @@ scsi_debug_cmd (bus, "Prevent/Allow Medium Removal\n");
 scsi_status (bus, STS_OK, KEY_OK, ASC_OK);
 }
 
+/* Command - Synchronize Cache */
+
+void scsi_sync_cache (SCSI_BUS *bus, uint8 *data, uint32 len)
+{
+UNIT *uptr = bus->dev[bus->target];
+
+scsi_debug_cmd (bus, "Synchronize Cache\n");
+sim_disk_sync (uptr);                                   /* commit writes (SET DISK SYNC) */
+scsi_status (bus, STS_OK, KEY_OK, ASC_OK);
+}
+
 /* Command - Read Capacity */
 
 void scsi_read_capacity (SCSI_BUS *bus, uint8 *data, uint32 len)
@@ -1020,6 +1067,59 @@ else if (bus->phase == SCSI_DATO) {
     }
 }
 
+/* Command - Unmap
+
+   The parameter list is limited to one block (a header and up to 31
+   descriptors on a 512 byte block device).  Each unmapped range reads
+   back as zeros and its storage is released by the container. */
+
+void scsi_unmap_disk (SCSI_BUS *bus, uint8 *data, uint32 len)
+{
+UNIT *uptr = bus->dev[bus->target];
+SCSI_DEV *dev = (SCSI_DEV *)uptr->up7;
+uint32 plen, dlen, i;
+
+if (bus->phase == SCSI_CMD) {
+    scsi_debug_cmd (bus, "Unmap - CMD\n");
+    memcpy (&bus->cmd[0], &data[0], 10);
+    plen = GETW (bus->cmd, 7);
+    if (plen == 0)                                      /* nothing to unmap */
+        scsi_status (bus, STS_OK, KEY_OK, ASC_OK);
+    else if ((plen < 8) || (plen > dev->block_size))
+        scsi_status (bus, STS_CHK, KEY_ILLREQ, ASC_INVCDB);
+    else if (sim_disk_wrp (uptr))
+        scsi_status (bus, STS_CHK, KEY_PROT, ASC_WRPROT);
+    else {
+        bus->buf_b = plen;
+        scsi_set_phase (bus, SCSI_DATO);                /* data out phase next */
+        scsi_set_req (bus);                             /* request data */
+        }
+    }
+else if (bus->phase == SCSI_DATO) {
+    plen = GETW (bus->cmd, 7);
+    dlen = GETW (bus->buf, 2);                          /* block descriptor data length */
+    if (dlen > plen - 8)
+        dlen = plen - 8;
+    memset (&bus->cmd[0], 0, 10);
+    for (i = 8; i + 16 <= dlen + 8; i += 16) {
+        t_lba lba = (t_lba)GETL (bus->buf, i + 4);
+        t_seccnt sects = (t_seccnt)GETL (bus->buf, i + 8);
+
+        scsi_debug_cmd (bus, "Unmap - DATO, lba %d blocks %d\n", lba, sects);
+        if ((GETL (bus->buf, i) != 0) || (lba > dev->lbn) || (sects > dev->lbn - lba)) {
+            scsi_status (bus, STS_CHK, KEY_ILLREQ, ASC_LBAOOR);
+            return;
+            }
+        if ((sects > 0) && (uptr->flags & UNIT_ATT) &&
+            (sim_disk_discard (uptr, lba, sects) != SCPE_OK)) {
+            scsi_status (bus, STS_CHK, KEY_ILLREQ, ASC_INVPARM);
+            return;
+            }
+        }
+    scsi_status (bus, STS_OK, KEY_OK, ASC_OK);
+    }
+}
+
 /* Command - Erase */
 
 void scsi_erase (SCSI_BUS *bus, uint8 *data, uint32 len)
@@ -1260,6 +1360,14 @@ switch (data[0]) {
         scsi_write10_disk (bus, data, len);
         break;
 
+    case CMD_UNMAP:                                     /* optional */
+        scsi_unmap_disk (bus, data, len);
+        break;
+
+    case CMD_SYNCCACHE:                                 /* optional */
+        scsi_sync_cache (bus, data, len);
+        break;
+
     default:
         sim_printf ("SCSI: unknown disk command %02X\n", data[0]);
         scsi_status (bus, STS_CHK, KEY_ILLREQ, ASC_INVCOM);
@@ -1623,6 +1731,7 @@ sim_debug (SCSI_DBG_BUS, bus->dptr, "Bus reset\n");
 bus->phase = SCSI_DATO;
 bus->buf_t = bus->buf_b = 0;
 bus->atn = FALSE;
+bus->tagged = FALSE;
 bus->initiator = -1;
 bus->target = -1;
 bus->lun = 0;
@@ -100,6 +100,7 @@ struct scsi_bus_t {
     uint32 buf_t;                                       /* buffer top ptr */
     uint32 phase;                                       /* current bus phase */
     uint32 lun;                                         /* selected lun */
+    t_bool tagged;                                      /* queue tag follows identify */
     uint32 status;
     uint32 sense_key;
     uint32 sense_code;
@@ -113,6 +114,7 @@ typedef struct scsi_dev_t SCSI_DEV;
 t_bool scsi_arbitrate (SCSI_BUS *bus, uint32 initiator);
 void scsi_release (SCSI_BUS *bus);
 void scsi_set_atn (SCSI_BUS *bus);
+void scsi_set_atn3 (SCSI_BUS *bus);
 void scsi_release_atn (SCSI_BUS *bus);
 t_bool scsi_select (SCSI_BUS *bus, uint32 target);
 uint32 scsi_write (SCSI_BUS *bus, uint8 *data, uint32 len);
@@ -46,6 +46,7 @@
      sim_read_serial        read from a serial port
      sim_write_serial       write to a serial port
      sim_close_serial       close a serial port
+     sim_serial_fd          return the host descriptor for readiness polling
      sim_show_serial        shows the available host serial ports
 
 
@@ -110,6 +111,15 @@
    The serial port indicated by "port" is closed.
 
 
+   int sim_serial_fd (SERHANDLE port)
+   ----------------------------------
+
+   Returns the host file descriptor of the serial port indicated by "port"
+   if the host can report input readiness on it with the same facility used
+   for sockets (poll, epoll, kqueue).  Otherwise -1 is returned and the
+   caller must read the port to find out whether input is available.
+
+
    int sim_serial_devices (int max, SERIAL_LIST* list)
    ---------------------------------------------------
 
@@ -919,6 +929,14 @@ free (port);
 }
 
 
+/* Get the readiness descriptor of a serial port (none on Windows) */
+
+int sim_serial_fd (SERHANDLE port)
+{
+return -1;
+}
+
+
 
 #elif defined (__unix__) || defined(__APPLE__) || defined(__hpux)
 
@@ -1380,6 +1398,18 @@ free (port);
 }
 
 
+/* Get the readiness descriptor of a serial port.
+
+   The port is opened non-blocking, so its descriptor can join a poll set
+   and be read only when input has arrived.
+*/
+
+int sim_serial_fd (SERHANDLE port)
+{
+return port->port;
+}
+
+
 #elif defined (VMS)
 
 /* VMS implementation */
@@ -1816,6 +1846,14 @@ sys$dassgn (port->port);                                /* close the port */
 free (port);
 }
 
+
+/* Get the readiness descriptor of a serial port (none on VMS) */
+
+int sim_serial_fd (SERHANDLE port)
+{
+return -1;
+}
+
 #else
 
 /* Non-implemented stubs */
@@ -1874,5 +1912,13 @@ static void sim_close_os_serial (SERHANDLE port)
 }
 
 
+/* Get the readiness descriptor of a serial port */
+
+int sim_serial_fd (SERHANDLE port)
+{
+return -1;
+}
+
+
 
 #endif                                                  /* end else !implemented */
@@ -79,7 +79,9 @@ extern "C" {
    sim_accept_conn      accept connection
    sim_read_sock        read from socket
    sim_write_sock       write from socket
+   sim_write_sock_v     write two buffers to socket in one operation
    sim_close_sock       close socket
+   sim_release_sock     close socket without shutting down the connection
    sim_setnonblock      set socket non-blocking
 */
 
@@ -120,11 +122,21 @@ int sim_write_sock (SOCKET sock, char *msg, int nbytes)
 return 0;
 }
 
+int sim_write_sock_v (SOCKET sock, const char *msg1, int nbytes1, const char *msg2, int nbytes2)
+{
+return 0;
+}
+
 void sim_close_sock (SOCKET sock)
 {
 return;
 }
 
+void sim_release_sock (SOCKET sock)
+{
+return;
+}
+
 #else                                                   /* endif unimpl */
 
 /* UNIX, Win32, Macintosh, VMS, OS2 (Berkeley socket) routines */
@@ -1067,6 +1079,13 @@ if (preferred->ai_family == AF_INET6) {
     sta = setsockopt (newsock, IPPROTO_IPV6, IPV6_V6ONLY, (char *)&off, sizeof(off));
     }
 #endif
+#if defined (SO_REUSEPORT)
+if (opt_flags & SIM_SOCK_OPT_REUSEPORT) {
+    int on = 1;
+
+    sta = setsockopt (newsock, SOL_SOCKET, SO_REUSEPORT, (char *)&on, sizeof(on));
+    }
+#endif
 if (opt_flags & SIM_SOCK_OPT_REUSEADDR) {
     int on = 1;
 
@@ -1168,7 +1187,7 @@ if ((!(opt_flags & SIM_SOCK_OPT_DATAGRAM)) && (opt_flags & SIM_SOCK_OPT_NODELAY)
         return sim_err_sock (newsock, "setnodelay");
         }
     }
-if (!(opt_flags & SIM_SOCK_OPT_DATAGRAM)) {
+if (!(opt_flags & (SIM_SOCK_OPT_DATAGRAM | SIM_SOCK_OPT_NOKEEPALIVE))) {
     int keepalive = 1;
 
     /* enable TCP Keep Alives */
@@ -1250,10 +1269,12 @@ if ((opt_flags & SIM_SOCK_OPT_NODELAY)) {
         return sim_err_sock (newsock, "setnodelay");
     }
 
-/* enable TCP Keep Alives */
-sta = setsockopt (newsock, SOL_SOCKET, SO_KEEPALIVE, (char *)&keepalive, sizeof(keepalive));
-if (sta == -1) 
-    return sim_err_sock (newsock, "setsockopt KEEPALIVE");
+if (!(opt_flags & SIM_SOCK_OPT_NOKEEPALIVE)) {
+    /* enable TCP Keep Alives */
+    sta = setsockopt (newsock, SOL_SOCKET, SO_KEEPALIVE, (char *)&keepalive, sizeof(keepalive));
+    if (sta == -1) 
+        return sim_err_sock (newsock, "setsockopt KEEPALIVE");
+    }
 
 return newsock;
 }
@@ -1410,12 +1431,66 @@ if (sbytes == SOCKET_ERROR) {
 return sbytes;
 }
 
+/* Gather write of two buffers (typically both segments of a wrapped
+   ring buffer) with a single system call.  Returns the total number of
+   bytes sent, 0 if the socket would block, or SOCKET_ERROR */
+
+int sim_write_sock_v (SOCKET sock, const char *msg1, int nbytes1, const char *msg2, int nbytes2)
+{
+int err, sbytes;
+#if defined (_WIN32)
+WSABUF bufs[2];
+DWORD sent;
+
+bufs[0].buf = (char *)msg1;
+bufs[0].len = (u_long)nbytes1;
+bufs[1].buf = (char *)msg2;
+bufs[1].len = (u_long)nbytes2;
+sbytes = (0 == WSASend (sock, bufs, 2, &sent, 0, NULL, NULL)) ? (int)sent : SOCKET_ERROR;
+#elif defined (VMS)
+sbytes = sim_write_sock (sock, msg1, nbytes1);
+if (sbytes == nbytes1) {
+    int sbytes2 = sim_write_sock (sock, msg2, nbytes2);
+
+    if (sbytes2 > 0)
+        sbytes += sbytes2;
+    }
+#else
+struct iovec iov[2];
+
+iov[0].iov_base = (void *)msg1;
+iov[0].iov_len = (size_t)nbytes1;
+iov[1].iov_base = (void *)msg2;
+iov[1].iov_len = (size_t)nbytes2;
+sbytes = (int)writev (sock, iov, 2);
+#endif
+if (sbytes == SOCKET_ERROR) {
+    err = WSAGetLastError ();
+    if (err == WSAEWOULDBLOCK)                          /* no data */
+        return 0;
+#if defined(EAGAIN)
+    if (err == EAGAIN)                                  /* no data */
+        return 0;
+#endif
+    }
+return sbytes;
+}
+
 void sim_close_sock (SOCKET sock)
 {
 shutdown(sock, SD_BOTH);
 closesocket (sock);
 }
 
+/* Close this process's descriptor for a socket which is shared with
+   another process (after a fork), leaving the connection itself to
+   the other process */
+
+void sim_release_sock (SOCKET sock)
+{
+closesocket (sock);
+}
+
 #endif                                                  /* end else !implemented */
 
 #ifdef  __cplusplus
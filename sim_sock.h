@@ -66,6 +66,9 @@ extern "C" {
 #include <arpa/inet.h>                                  /* for inet_addr and inet_ntoa */
 #include <netdb.h>
 #include <sys/time.h>                                   /* for EMX */
+#if !defined (VMS)
+#include <sys/uio.h>                                    /* for writev */
+#endif
 
 #define WSAGetLastError()       errno                   /* Windows macros */
 #define WSASetLastError(err) errno = err
@@ -121,6 +124,8 @@ int sim_addr_acl_check (const char *validate_addr, const char *acl);
 #define SIM_SOCK_OPT_DATAGRAM       0x0002
 #define SIM_SOCK_OPT_NODELAY        0x0004
 #define SIM_SOCK_OPT_BLOCKING       0x0008
+#define SIM_SOCK_OPT_REUSEPORT      0x0010
+#define SIM_SOCK_OPT_NOKEEPALIVE    0x0020
 SOCKET sim_master_sock_ex (const char *hostport, int *parse_status, int opt_flags);
 #define sim_master_sock(hostport, parse_status) sim_master_sock_ex(hostport, parse_status, ((sim_switches & SWMASK ('U')) ? SIM_SOCK_OPT_REUSEADDR : 0))
 SOCKET sim_connect_sock_ex (const char *sourcehostport, const char *hostport, const char *default_host, const char *default_port, int opt_flags);
@@ -130,7 +135,9 @@ SOCKET sim_accept_conn_ex (SOCKET master, char **connectaddr, int opt_flags);
 int sim_check_conn (SOCKET sock, int rd);
 int sim_read_sock (SOCKET sock, char *buf, int nbytes);
 int sim_write_sock (SOCKET sock, const char *msg, int nbytes);
+int sim_write_sock_v (SOCKET sock, const char *msg1, int nbytes1, const char *msg2, int nbytes2);
 void sim_close_sock (SOCKET sock);
+void sim_release_sock (SOCKET sock);
 const char *sim_get_err_sock (const char *emsg);
 SOCKET sim_err_sock (SOCKET sock, const char *emsg);
 int sim_getnames_sock (SOCKET sock, char **socknamebuf, char **peernamebuf);
@@ -101,6 +101,13 @@
 #include <pthread.h>
 #endif
 
+#if defined (HAVE_ZLIB) &&                                                        \
+    (defined (__GLIBC__) || defined (__APPLE__) ||                                \
+     defined (__FreeBSD__) || defined (__NetBSD__) || defined (__OpenBSD__))
+#define SIM_TAPE_SIMHZ 1                        /* SIMHZ containers are supported */
+#include <zlib.h>
+#endif
+
 static struct sim_tape_fmt {
     const char          *name;                          /* name */
     int32               uflags;                         /* unit flags */
@@ -116,6 +123,7 @@ static struct sim_tape_fmt {
     { "ANSI",       UNIT_RO, 0,                     0                 },
     { "FIXED",      UNIT_RO, 0,                     0                 },
     { "DOS11",      UNIT_RO, 0,                     0                 },
+    { "SIMHZ",      0,       sizeof (t_mtrlnt) - 1, sizeof (t_mtrlnt) },
     { NULL,         0,       0,                     0                 }
     };
 
@@ -131,6 +139,7 @@ static const uint32 bpi [] = {                          /* tape density table, i
 #define BPI_COUNT       (sizeof (bpi) / sizeof (bpi [0]))   /* count of density table entries */
 
 static t_stat sim_tape_ioerr (UNIT *uptr);
+static t_stat sim_tape_wb_flush (UNIT *uptr);
 static t_stat sim_tape_wrdata (UNIT *uptr, uint32 dat);
 static t_stat sim_tape_aws_wrdata (UNIT *uptr, uint8 *buf, t_mtrlnt bc);
 static uint32 sim_tape_tpc_map (UNIT *uptr, t_addr *map, uint32 mapsize);
@@ -140,6 +149,8 @@ static void sim_tape_data_trace (UNIT *uptr, const uint8 *data, size_t len, cons
 static t_stat tape_erase_fwd (UNIT *uptr, t_mtrlnt gap_size);
 static t_stat tape_erase_rev (UNIT *uptr, t_mtrlnt gap_size);
 
+#define MT_WB_SIZE      65536                           /* write-behind buffer size */
+
 struct tape_context {
     DEVICE              *dptr;              /* Device for unit (access to debug flags) */
     uint32              dbit;               /* debugging bit for trace */
@@ -148,12 +159,11 @@ struct tape_context {
     t_bool              asynch_io;          /* Asynchronous Interrupt scheduling enabled */
     int                 asynch_io_latency;  /* instructions to delay pending interrupt */
     pthread_mutex_t     lock;
-    pthread_t           io_thread;          /* I/O Thread Id */
+    SIM_IO_REQ          io_req;             /* Shared I/O worker pool request */
     pthread_mutex_t     io_lock;
-    pthread_cond_t      io_cond;
     pthread_cond_t      io_done;
-    pthread_cond_t      startup_cond;
     int                 io_top;
+    t_uint64            io_submit_nsec;     /* host time the pending operation was queued */
     uint8               *buf;
     uint32              *bc;
     uint32              *fc;
@@ -165,6 +175,25 @@ struct tape_context {
     TAPE_PCALLBACK      callback;
     t_stat              io_status;
 #endif
+    t_addr              *idx_pos;           /* record index: object boundary positions */
+    uint32              *idx_tmk;           /* record index: tape marks before each boundary */
+    uint32              idx_count;          /* record index: objects indexed */
+    uint32              idx_alloc;          /* record index: boundaries allocated */
+    uint8               *ra_buf;            /* read-ahead buffer */
+    uint32              ra_size;            /* read-ahead buffer size */
+    uint32              ra_len;             /* read-ahead bytes valid */
+    t_addr              ra_start;           /* read-ahead buffer file position */
+    t_addr              ra_cur;             /* read-ahead file position */
+    t_bool              ra_eof;             /* read-ahead read hit EOF */
+    uint8               *wb_buf;            /* write-behind buffer */
+    uint32              wb_len;             /* write-behind bytes pending */
+    t_addr              wb_start;           /* write-behind buffer file position */
+    void                *simhz;             /* SIMHZ container state */
+    t_uint64            read_bytes;         /* record bytes read */
+    t_uint64            write_bytes;        /* record bytes written */
+    SIM_LATENCY         read_host;          /* host time of each record read */
+    SIM_LATENCY         write_host;         /* host time of each record write */
+    SIM_LATENCY         queued;             /* asynch requests' wait for an I/O worker */
     };
 #define tape_ctx up8                        /* Field in Unit structure which points to the tape_context */
 
@@ -198,7 +227,8 @@ if ((callback == NULL) || !(ctx->asynch_io))
         ctx->bpi = _bpi;                                                \
         ctx->objupdate = _obj;                                          \
         ctx->callback = _callback;                                      \
-        pthread_cond_signal (&ctx->io_cond);                            \
+        ctx->io_submit_nsec = sim_host_nsec ();                         \
+        sim_io_pool_submit (&ctx->io_req);                              \
         pthread_mutex_unlock (&ctx->io_lock);                           \
         }                                                               \
     else                                                                \
@@ -223,89 +253,76 @@ if ((callback == NULL) || !(ctx->asynch_io))
 #define TOP_RWND 16             /* sim_tape_rewind_a */
 #define TOP_POSN 17             /* sim_tape_position_a */
 
-static void *
-_tape_io(void *arg)
+/* Perform the pending operation for a unit.  This runs on one of the
+   shared I/O pool worker threads (see sim_io_pool_submit in sim_fio.c). */
+
+static void
+_tape_io (UNIT *uptr)
 {
-UNIT* volatile uptr = (UNIT*)arg;
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
 
-    /* Boost Priority for this I/O thread vs the CPU instruction execution 
-       thread which in general won't be readily yielding the processor when 
-       this thread needs to run */
-    sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
+    sim_debug_unit (ctx->dbit, uptr, "_tape_io(unit=%d, top=%d)\n", (int)(uptr-ctx->dptr->units), ctx->io_top);
 
-    sim_debug_unit (ctx->dbit, uptr, "_tape_io(unit=%d) starting\n", (int)(uptr-ctx->dptr->units));
+    sim_latency_record (&ctx->queued, sim_host_nsec () - ctx->io_submit_nsec);
 
-    pthread_mutex_lock (&ctx->io_lock);
-    pthread_cond_signal (&ctx->startup_cond);   /* Signal we're ready to go */
-    while (1) {
-        pthread_cond_wait (&ctx->io_cond, &ctx->io_lock);
-        if (ctx->io_top == TOP_DONE)
+    switch (ctx->io_top) {
+        case TOP_RDRF:
+            ctx->io_status = sim_tape_rdrecf (uptr, ctx->buf, ctx->bc, ctx->max);
             break;
-        pthread_mutex_unlock (&ctx->io_lock);
-        switch (ctx->io_top) {
-            case TOP_RDRF:
-                ctx->io_status = sim_tape_rdrecf (uptr, ctx->buf, ctx->bc, ctx->max);
-                break;
-            case TOP_RDRR:
-                ctx->io_status = sim_tape_rdrecr (uptr, ctx->buf, ctx->bc, ctx->max);
-                break;
-            case TOP_WREC:
-                ctx->io_status = sim_tape_wrrecf (uptr, ctx->buf, ctx->vbc);
-                break;
-            case TOP_WTMK:
-                ctx->io_status = sim_tape_wrtmk (uptr);
-                break;
-            case TOP_WEOM:
-                ctx->io_status = sim_tape_wreom (uptr);
-                break;
-            case TOP_WEMR:
-                ctx->io_status = sim_tape_wreomrw (uptr);
-                break;
-            case TOP_WGAP:
-                ctx->io_status = sim_tape_wrgap (uptr, ctx->gaplen);
-                break;
-            case TOP_SPRF:
-                ctx->io_status = sim_tape_sprecf (uptr, ctx->bc);
-                break;
-            case TOP_SRSF:
-                ctx->io_status = sim_tape_sprecsf (uptr, ctx->vbc, ctx->bc);
-                break;
-            case TOP_SPRR:
-                ctx->io_status = sim_tape_sprecr (uptr, ctx->bc);
-                break;
-            case TOP_SRSR:
-                ctx->io_status = sim_tape_sprecsr (uptr, ctx->vbc, ctx->bc);
-                break;
-            case TOP_SPFF:
-                ctx->io_status = sim_tape_spfilef (uptr, ctx->vbc, ctx->bc);
-                break;
-            case TOP_SFRF:
-                ctx->io_status = sim_tape_spfilebyrecf (uptr, ctx->vbc, ctx->bc, ctx->fc, ctx->max);
-                break;
-            case TOP_SPFR:
-                ctx->io_status = sim_tape_spfiler (uptr, ctx->vbc, ctx->bc);
-                break;
-            case TOP_SFRR:
-                ctx->io_status = sim_tape_spfilebyrecr (uptr, ctx->vbc, ctx->bc, ctx->fc);
-                break;
-            case TOP_RWND:
-                ctx->io_status = sim_tape_rewind (uptr);
-                break;
-            case TOP_POSN:
-                ctx->io_status = sim_tape_position (uptr, ctx->vbc, ctx->gaplen, ctx->bc, ctx->bpi, ctx->fc, ctx->objupdate);
-                break;
-            }
-        pthread_mutex_lock (&ctx->io_lock);
-        ctx->io_top = TOP_DONE;
-        pthread_cond_signal (&ctx->io_done);
-        sim_activate (uptr, ctx->asynch_io_latency);
-    }
+        case TOP_RDRR:
+            ctx->io_status = sim_tape_rdrecr (uptr, ctx->buf, ctx->bc, ctx->max);
+            break;
+        case TOP_WREC:
+            ctx->io_status = sim_tape_wrrecf (uptr, ctx->buf, ctx->vbc);
+            break;
+        case TOP_WTMK:
+            ctx->io_status = sim_tape_wrtmk (uptr);
+            break;
+        case TOP_WEOM:
+            ctx->io_status = sim_tape_wreom (uptr);
+            break;
+        case TOP_WEMR:
+            ctx->io_status = sim_tape_wreomrw (uptr);
+            break;
+        case TOP_WGAP:
+            ctx->io_status = sim_tape_wrgap (uptr, ctx->gaplen);
+            break;
+        case TOP_SPRF:
+            ctx->io_status = sim_tape_sprecf (uptr, ctx->bc);
+            break;
+        case TOP_SRSF:
+            ctx->io_status = sim_tape_sprecsf (uptr, ctx->vbc, ctx->bc);
+            break;
+        case TOP_SPRR:
+            ctx->io_status = sim_tape_sprecr (uptr, ctx->bc);
+            break;
+        case TOP_SRSR:
+            ctx->io_status = sim_tape_sprecsr (uptr, ctx->vbc, ctx->bc);
+            break;
+        case TOP_SPFF:
+            ctx->io_status = sim_tape_spfilef (uptr, ctx->vbc, ctx->bc);
+            break;
+        case TOP_SFRF:
+            ctx->io_status = sim_tape_spfilebyrecf (uptr, ctx->vbc, ctx->bc, ctx->fc, ctx->max);
+            break;
+        case TOP_SPFR:
+            ctx->io_status = sim_tape_spfiler (uptr, ctx->vbc, ctx->bc);
+            break;
+        case TOP_SFRR:
+            ctx->io_status = sim_tape_spfilebyrecr (uptr, ctx->vbc, ctx->bc, ctx->fc);
+            break;
+        case TOP_RWND:
+            ctx->io_status = sim_tape_rewind (uptr);
+            break;
+        case TOP_POSN:
+            ctx->io_status = sim_tape_position (uptr, ctx->vbc, ctx->gaplen, ctx->bc, ctx->bpi, ctx->fc, ctx->objupdate);
+            break;
+        }
+    pthread_mutex_lock (&ctx->io_lock);
+    ctx->io_top = TOP_DONE;
+    pthread_cond_signal (&ctx->io_done);
+    sim_activate (uptr, ctx->asynch_io_latency);
     pthread_mutex_unlock (&ctx->io_lock);
-
-    sim_debug_unit (ctx->dbit, uptr, "_tape_io(unit=%d) exiting\n", (int)(uptr-ctx->dptr->units));
-
-    return NULL;
 }
 
 /* This routine is called in the context of the main simulator thread before 
@@ -377,8 +394,198 @@ return FALSE;
         (_callback) (uptr, r);
 #endif
 
+/* Record index
+
+   SIMH, E11 and AWS format images are scanned record by record when they
+   are attached (see sim_tape_validate_tape).  While that scan runs, the
+   boundaries of the objects it finds are saved, so that multi-record and
+   file spacing can move across runs of data records without touching the
+   image.  Only objects which were read in both directions and found to
+   end where they began are indexed, so the index stops at the first gap,
+   bad record or inconsistency and everything beyond it is handled by the
+   normal record at a time routines.
+
+   idx_pos[i] is the starting position of object i, and idx_pos[idx_count]
+   is the end of the last indexed object.  idx_tmk[i] is the number of
+   tape marks among objects 0 to i-1, so a range of objects contains only
+   data records when its end points have equal tape mark counts.
+
+   Writes and erases discard the index entries which they overwrite, and
+   an object written at the end of the index is appended to it.
+*/
+
+static t_bool _sim_tape_index_fmt (UNIT *uptr)
+{
+uint32 f = MT_GET_FMT (uptr);
+
+return ((f == MTUF_F_STD) || (f == MTUF_F_E11) || (f == MTUF_F_AWS) || (f == MTUF_F_SIMHZ));
+}
+
+static void _sim_tape_index_free (struct tape_context *ctx)
+{
+free (ctx->idx_pos);
+free (ctx->idx_tmk);
+ctx->idx_pos = NULL;
+ctx->idx_tmk = NULL;
+ctx->idx_count = ctx->idx_alloc = 0;
+}
+
+/* Start an empty index at BOT, returns FALSE if the format isn't indexed */
+
+static t_bool _sim_tape_index_reset (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if (ctx == NULL)
+    return FALSE;
+_sim_tape_index_free (ctx);
+if (!_sim_tape_index_fmt (uptr))
+    return FALSE;
+ctx->idx_alloc = 1024;
+ctx->idx_pos = (t_addr *)malloc (ctx->idx_alloc * sizeof (*ctx->idx_pos));
+ctx->idx_tmk = (uint32 *)malloc (ctx->idx_alloc * sizeof (*ctx->idx_tmk));
+if ((ctx->idx_pos == NULL) || (ctx->idx_tmk == NULL)) {
+    _sim_tape_index_free (ctx);
+    return FALSE;
+    }
+ctx->idx_pos[0] = 0;
+ctx->idx_tmk[0] = 0;
+return TRUE;
+}
+
+/* Append the object occupying [start, end) if start is the end of the index,
+   returns FALSE if it wasn't appended */
+
+static t_bool _sim_tape_index_add (UNIT *uptr, t_addr start, t_addr end, t_bool tapemark)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 n;
+
+if ((ctx == NULL) || (ctx->idx_pos == NULL))
+    return FALSE;
+n = ctx->idx_count;
+if ((ctx->idx_pos[n] != start) || (end <= start))
+    return FALSE;
+if (n + 2 > ctx->idx_alloc) {
+    t_addr *npos = (t_addr *)realloc (ctx->idx_pos, 2 * ctx->idx_alloc * sizeof (*npos));
+    uint32 *ntmk;
+
+    if (npos == NULL) {
+        _sim_tape_index_free (ctx);
+        return FALSE;
+        }
+    ctx->idx_pos = npos;
+    ntmk = (uint32 *)realloc (ctx->idx_tmk, 2 * ctx->idx_alloc * sizeof (*ntmk));
+    if (ntmk == NULL) {
+        _sim_tape_index_free (ctx);
+        return FALSE;
+        }
+    ctx->idx_tmk = ntmk;
+    ctx->idx_alloc *= 2;
+    }
+ctx->idx_pos[n + 1] = end;
+ctx->idx_tmk[n + 1] = ctx->idx_tmk[n] + (tapemark ? 1 : 0);
+ctx->idx_count = n + 1;
+return TRUE;
+}
+
+/* Find the boundary at pos, returns -1 if pos isn't an indexed boundary */
+
+static int32 _sim_tape_index_find (struct tape_context *ctx, t_addr pos)
+{
+uint32 lo = 0, hi = ctx->idx_count;
+
+if ((ctx->idx_pos == NULL) || (pos > ctx->idx_pos[hi]))
+    return -1;
+while (lo < hi) {
+    uint32 mid = lo + (hi - lo) / 2;
+
+    if (ctx->idx_pos[mid] < pos)
+        lo = mid + 1;
+    else
+        hi = mid;
+    }
+return (ctx->idx_pos[lo] == pos) ? (int32)lo : -1;
+}
+
+/* Drop the objects which extend beyond pos (it is about to be overwritten) */
+
+static void _sim_tape_index_trunc (UNIT *uptr, t_addr pos)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 lo = 0, hi;
+
+if ((ctx == NULL) || (ctx->idx_pos == NULL))
+    return;
+hi = ctx->idx_count;
+while (lo < hi) {                                       /* find the last boundary <= pos */
+    uint32 mid = lo + (hi - lo + 1) / 2;
+
+    if (ctx->idx_pos[mid] <= pos)
+        lo = mid;
+    else
+        hi = mid - 1;
+    }
+ctx->idx_count = lo;
+}
+
+/* Space over up to count data records using the index.  Stops before any
+   tape mark or unindexed object, which the caller then handles normally.
+   Returns the number of records spaced over. */
+
+static uint32 _sim_tape_index_skip (UNIT *uptr, t_bool reverse, uint32 count)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+int32 i = _sim_tape_index_find (ctx, uptr->pos);
+uint32 lo, hi, target;
+
+if ((i < 0) || (count == 0))
+    return 0;
+if (reverse) {
+    if (MT_TST_PNU (uptr) || (i == 0))
+        return 0;
+    lo = (count >= (uint32)i) ? 0 : (uint32)i - count;
+    hi = (uint32)i;
+    while (lo < hi) {                                   /* earliest boundary with no tape mark after it */
+        uint32 mid = lo + (hi - lo) / 2;
+
+        if (ctx->idx_tmk[mid] == ctx->idx_tmk[i])
+            hi = mid;
+        else
+            lo = mid + 1;
+        }
+    target = lo;
+    }
+else {
+    lo = (uint32)i;
+    hi = ((ctx->idx_count - (uint32)i) <= count) ? ctx->idx_count : (uint32)i + count;
+    if (uptr->tape_eom > 0) {                           /* objects at or beyond EOM read as EOM */
+        while ((hi > lo) && (ctx->idx_pos[hi - 1] >= uptr->tape_eom))
+            --hi;
+        }
+    while (lo < hi) {                                   /* latest boundary with no tape mark before it */
+        uint32 mid = lo + (hi - lo + 1) / 2;
+
+        if (ctx->idx_tmk[mid] == ctx->idx_tmk[i])
+            lo = mid;
+        else
+            hi = mid - 1;
+        }
+    target = lo;
+    }
+if (target == (uint32)i)
+    return 0;
+MT_CLR_PNU (uptr);
+uptr->pos = ctx->idx_pos[target];
+sim_debug_unit (MTSE_DBG_POS, uptr, "index: spaced %s over %u records, pos: %" T_ADDR_FMT "u\n",
+                reverse ? "reverse" : "forward", reverse ? (uint32)i - target : target - (uint32)i, uptr->pos);
+return reverse ? (uint32)i - target : target - (uint32)i;
+}
+
 #define MIN_RECORD_SIZE    14   /* Mag tape records <14 bytes are considered noise */
 #define MAX_RECORD_SIZE 65535   /* DEC tape controllers have a 16-bit byte count reg */
+#define RA_DEFAULT_SIZE (256*1024) /* default read-ahead buffer size */
+#define RA_MAX_SIZE (16*1024*1024) /* largest read-ahead buffer size */
 
 typedef struct VOL1 {
     char type[3];               /* VOL  */
@@ -443,13 +650,46 @@ typedef struct TAPE_RECORD {
     uint8 data[1];
     } TAPE_RECORD;
 
+/* Data records of a memory tape aren't held in memory.  Each file's data
+   blocks are described by a TAPE_SOURCE and are read from the file when
+   the record is read.  Text files need an offset for each block, since
+   block boundaries depend on the line structure, binary files don't. */
+
+#define SRC_BINARY      0           /* fixed size blocks, last one possibly short */
+#define SRC_ANSI_TEXT   1           /* blocks built by ansi_fill_text_buffer */
+#define SRC_FIXED_TEXT  2           /* one line per block, space padded */
+
+typedef struct TAPE_SOURCE {
+    char *filename;         /* source file */
+    uint32 type;            /* SRC_BINARY, SRC_ANSI_TEXT or SRC_FIXED_TEXT */
+    t_offset size;          /* file size */
+    uint32 block_size;      /* block size */
+    uint32 record_size;     /* binary: pad short blocks to a multiple of this */
+    uint32 skip;            /* ANSI text: line ending bytes dropped */
+    t_bool fixed_text;      /* ANSI text: unformatted byte stream */
+    t_bool ebcdic;          /* FIXED text: convert to EBCDIC */
+    t_offset *offsets;      /* text: file position of each block */
+    } TAPE_SOURCE;
+
+typedef struct TAPE_EXTENT {
+    uint32 first;           /* first record number */
+    uint32 count;           /* number of records */
+    TAPE_RECORD *rec;       /* one record held in memory (label or tape mark) */
+    TAPE_SOURCE *src;       /* or count records read from a file */
+    } TAPE_EXTENT;
+
 typedef struct MEMORY_TAPE {
     uint32 ansi_type;       /* ANSI-VMS, ANSI-RT11, ANSI-RSTS, ANSI-RSX11, etc. */
     uint32 file_count;      /* number of labeled files */
-    uint32 record_count;    /* number of entries in the record array */
-    uint32 array_size;      /* allocated size of records array */
+    uint32 record_count;    /* number of records on the tape */
+    uint32 extent_count;    /* number of entries in the extent array */
+    uint32 array_size;      /* allocated size of extent array */
     uint32 block_size;      /* tape block size */
-    TAPE_RECORD **records;
+    TAPE_EXTENT *extents;
+    uint32 last_extent;     /* extent of the most recent lookup */
+    TAPE_SOURCE *src_open;  /* source of the open src_file */
+    FILE *src_file;
+    char *src_line;         /* FIXED text line buffer */
     VOL1 vol1;
     } MEMORY_TAPE;
 
@@ -514,6 +754,12 @@ static void sim_tape_add_ansi_entry (const char *directory,
                                      const struct stat *filestat,
                                      void *context);
 static t_bool memory_tape_add_block (MEMORY_TAPE *tape, uint8 *block, uint32 size);
+static t_bool memory_tape_add_source (MEMORY_TAPE *tape, TAPE_SOURCE *src, uint32 count);
+static TAPE_SOURCE *memory_tape_new_source (const char *filename, uint32 type, uint32 block_size);
+static t_bool memory_tape_source_offset (TAPE_SOURCE *src, uint32 n, t_offset offset);
+static void memory_tape_free_source (TAPE_SOURCE *src);
+static uint32 memory_tape_record_size (MEMORY_TAPE *tape, uint32 recnum);
+static t_bool memory_tape_read_record (MEMORY_TAPE *tape, uint32 recnum, uint8 *buf);
 
 typedef struct DOS11_HDR {
     uint16 fname[2];        /* File name (RAD50 - 6 characters) */
@@ -533,6 +779,10 @@ static void sim_tape_add_dos11_entry (const char *directory,
                                       void *context);
 
 static t_stat sim_export_tape (UNIT *uptr, const char *export_file);
+#if defined (SIM_TAPE_SIMHZ)
+static FILE *sim_tape_simhz_open (FILE *f, t_bool writable, void **handle);
+static t_bool sim_tape_simhz_sync (void *handle);
+#endif
 static FILE *tape_open_and_check_file(const char *filename);
 static int tape_classify_file_contents (FILE *f, size_t *max_record_size, t_bool *lf_line_endings, t_bool *crlf_line_endings);
 
@@ -545,23 +795,13 @@ t_stat sim_tape_set_async (UNIT *uptr, int latency)
 return sim_messagef (SCPE_NOFNC, "Tape: can't operate asynchronously\r\n");
 #else
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
-pthread_attr_t attr;
 
 ctx->asynch_io = sim_asynch_enabled;
 ctx->asynch_io_latency = latency;
 if (ctx->asynch_io) {
     pthread_mutex_init (&ctx->io_lock, NULL);
-    pthread_cond_init (&ctx->io_cond, NULL);
     pthread_cond_init (&ctx->io_done, NULL);
-    pthread_cond_init (&ctx->startup_cond, NULL);
-    pthread_attr_init(&attr);
-    pthread_attr_setscope(&attr, PTHREAD_SCOPE_SYSTEM);
-    pthread_mutex_lock (&ctx->io_lock);
-    pthread_create (&ctx->io_thread, &attr, _tape_io, (void *)uptr);
-    pthread_attr_destroy(&attr);
-    pthread_cond_wait (&ctx->startup_cond, &ctx->io_lock); /* Wait for thread to stabilize */
-    pthread_mutex_unlock (&ctx->io_lock);
-    pthread_cond_destroy (&ctx->startup_cond);
+    sim_io_pool_register (&ctx->io_req, uptr, _tape_io);
     }
 uptr->a_check_completion = _tape_completion_dispatch;
 uptr->a_is_active = _tape_is_active;
@@ -584,33 +824,563 @@ if (!ctx) return SCPE_UNATT;
 
 if (ctx->asynch_io) {
     pthread_mutex_lock (&ctx->io_lock);
+    while (ctx->io_top != TOP_DONE)                     /* let any pending op finish */
+        pthread_cond_wait (&ctx->io_done, &ctx->io_lock);
     ctx->asynch_io = FALSE;
-    pthread_cond_signal (&ctx->io_cond);
     pthread_mutex_unlock (&ctx->io_lock);
-    pthread_join (ctx->io_thread, NULL);
+    sim_io_pool_unregister (&ctx->io_req);
     pthread_mutex_destroy (&ctx->io_lock);
-    pthread_cond_destroy (&ctx->io_cond);
     pthread_cond_destroy (&ctx->io_done);
     }
 return SCPE_OK;
 #endif
 }
 
+/* SIMHZ compressed tape container
+
+   A SIMHZ image holds a SIMH format tape image which has been split into
+   fixed size frames, each deflated independently, so that any position on
+   the tape is reached by inflating only the frame which holds it.  The
+   container is presented to the rest of this module as a stdio stream (via
+   fopencookie or funopen), so SIMHZ tapes are read, written and positioned
+   with exactly the same code as SIMH tapes.
+
+   The file starts with a 32 byte header:
+
+        char[8]     "SIMHTAPZ"
+        uint32      version
+        uint32      frame size (uncompressed bytes per frame)
+        uint64      index position (0 when the index isn't current)
+        uint64      uncompressed tape image size
+
+   which is followed by frame records, each a 16 byte header (magic, frame
+   number, uncompressed length and compressed length) and the compressed
+   data, and then by an index giving the location of the current copy of
+   each frame.  All values are little endian.
+
+   A modified frame is appended to the file rather than rewritten in place
+   and the index is written whenever the unit is flushed or detached.  The
+   header's index position is cleared before the first frame is appended
+   after the index was written, so an image which wasn't closed cleanly is
+   recovered by scanning the frame records.  Space held by superseded
+   frames is reclaimed by copying the tape (ATTACH -X -Z).
+*/
+
+#if defined (SIM_TAPE_SIMHZ)
+
+#define SIMHZ_MAGIC         "SIMHTAPZ"
+#define SIMHZ_VERSION       1
+#define SIMHZ_HDR_SIZE      32                  /* file header size */
+#define SIMHZ_FRM_MAGIC     0x4D52465A          /* "ZFRM" frame record */
+#define SIMHZ_FRM_SIZE      16                  /* frame record header size */
+#define SIMHZ_IDX_MAGIC     0x5844495A          /* "ZIDX" index */
+#define SIMHZ_IDX_SIZE      16                  /* index entry size */
+#define SIMHZ_FRAME_SIZE    (128*1024)          /* frame size for new images */
+#define SIMHZ_MAX_FRAME     (16*1024*1024)      /* largest frame size accepted */
+#define SIMHZ_NO_FRAME      0xFFFFFFFF
+
+typedef struct {
+    t_offset            offset;                 /* compressed data position, 0 if never written */
+    uint32              ulen;                   /* uncompressed length */
+    uint32              clen;                   /* compressed length */
+    } SIMHZ_FRAME;
+
+typedef struct {
+    FILE                *f;                     /* container file */
+    t_bool              writable;
+    uint32              frame_size;             /* uncompressed bytes per frame */
+    uint32              frame_count;            /* frames in table */
+    uint32              frame_alloc;            /* frames allocated */
+    SIMHZ_FRAME         *frames;
+    t_offset            size;                   /* uncompressed size */
+    t_offset            pos;                    /* uncompressed stream position */
+    t_offset            end;                    /* where the next frame record goes */
+    t_offset            index_offset;           /* index position, 0 if not current */
+    uint8               *buf;                   /* uncompressed frame data */
+    uint8               *zbuf;                  /* compressed frame data */
+    uLong               zbuf_size;
+    uint32              frame;                  /* frame held in buf */
+    t_bool              dirty;                  /* buf modified since it was loaded */
+    } SIMHZ;
+
+static void simhz_put32 (uint8 *p, uint32 val)
+{
+p[0] = (uint8)val;
+p[1] = (uint8)(val >> 8);
+p[2] = (uint8)(val >> 16);
+p[3] = (uint8)(val >> 24);
+}
+
+static uint32 simhz_get32 (const uint8 *p)
+{
+return (uint32)p[0] | ((uint32)p[1] << 8) | ((uint32)p[2] << 16) | ((uint32)p[3] << 24);
+}
+
+static void simhz_put64 (uint8 *p, t_uint64 val)
+{
+simhz_put32 (p, (uint32)val);
+simhz_put32 (p + 4, (uint32)(val >> 32));
+}
+
+static t_uint64 simhz_get64 (const uint8 *p)
+{
+return (t_uint64)simhz_get32 (p) | ((t_uint64)simhz_get32 (p + 4) << 32);
+}
+
+static t_bool simhz_pread (SIMHZ *z, t_offset pos, void *buf, size_t len)
+{
+return ((sim_fseeko (z->f, pos, SEEK_SET) == 0) &&
+        (fread (buf, 1, len, z->f) == len));
+}
+
+static t_bool simhz_pwrite (SIMHZ *z, t_offset pos, const void *buf, size_t len)
+{
+return ((sim_fseeko (z->f, pos, SEEK_SET) == 0) &&
+        (fwrite (buf, 1, len, z->f) == len));
+}
+
+static t_bool simhz_write_header (SIMHZ *z)
+{
+uint8 hdr[SIMHZ_HDR_SIZE];
+
+memcpy (hdr, SIMHZ_MAGIC, 8);
+simhz_put32 (hdr + 8, SIMHZ_VERSION);
+simhz_put32 (hdr + 12, z->frame_size);
+simhz_put64 (hdr + 16, (t_uint64)z->index_offset);
+simhz_put64 (hdr + 24, (t_uint64)z->size);
+return simhz_pwrite (z, 0, hdr, sizeof (hdr));
+}
+
+static t_bool simhz_grow_frames (SIMHZ *z, uint32 count)
+{
+SIMHZ_FRAME *frames;
+uint32 alloc;
+
+if (count <= z->frame_count)
+    return TRUE;
+if (count > z->frame_alloc) {
+    alloc = (z->frame_alloc == 0) ? 64 : z->frame_alloc;
+    while (alloc < count)
+        alloc *= 2;
+    frames = (SIMHZ_FRAME *)realloc (z->frames, alloc * sizeof (*frames));
+    if (frames == NULL)
+        return FALSE;
+    z->frames = frames;
+    z->frame_alloc = alloc;
+    }
+memset (z->frames + z->frame_count, 0, (count - z->frame_count) * sizeof (*z->frames));
+z->frame_count = count;
+return TRUE;
+}
+
+/* Read the index, checking that it describes frames within the file */
+
+static t_bool simhz_read_index (SIMHZ *z, t_offset file_size)
+{
+uint8 hdr[8];
+uint8 ent[SIMHZ_IDX_SIZE];
+uint32 i, count;
+
+if ((z->index_offset < SIMHZ_HDR_SIZE) ||
+    !simhz_pread (z, z->index_offset, hdr, sizeof (hdr)) ||
+    (simhz_get32 (hdr) != SIMHZ_IDX_MAGIC))
+    return FALSE;
+count = simhz_get32 (hdr + 4);
+if ((z->index_offset + sizeof (hdr) + (t_offset)count * SIMHZ_IDX_SIZE > file_size) ||
+    !simhz_grow_frames (z, count))
+    return FALSE;
+for (i = 0; i < count; i++) {
+    SIMHZ_FRAME *fr = &z->frames[i];
+
+    if (fread (ent, 1, sizeof (ent), z->f) != sizeof (ent))
+        return FALSE;
+    fr->offset = (t_offset)simhz_get64 (ent);
+    fr->ulen = simhz_get32 (ent + 8);
+    fr->clen = simhz_get32 (ent + 12);
+    if ((fr->ulen > z->frame_size) ||
+        ((fr->offset != 0) && (fr->offset + fr->clen > z->index_offset)))
+        return FALSE;
+    }
+z->end = z->index_offset;
+return TRUE;
+}
+
+/* Rebuild the frame table from the frame records of an image which
+   wasn't closed cleanly.  Later copies of a frame supersede earlier ones
+   and the scan stops at the first incomplete or unrecognized record. */
+
+static void simhz_recover (SIMHZ *z, t_offset file_size)
+{
+uint8 hdr[SIMHZ_FRM_SIZE];
+t_offset pos = SIMHZ_HDR_SIZE;
+
+z->frame_count = 0;
+z->size = 0;
+while (simhz_pread (z, pos, hdr, sizeof (hdr)) &&
+       (simhz_get32 (hdr) == SIMHZ_FRM_MAGIC)) {
+    uint32 n = simhz_get32 (hdr + 4);
+    uint32 ulen = simhz_get32 (hdr + 8);
+    uint32 clen = simhz_get32 (hdr + 12);
+    t_offset frame_end = (t_offset)n * z->frame_size + ulen;
+
+    if ((n >= SIMHZ_NO_FRAME) ||
+        (ulen > z->frame_size) ||
+        (pos + SIMHZ_FRM_SIZE + clen > file_size) ||
+        !simhz_grow_frames (z, n + 1))
+        break;
+    z->frames[n].offset = pos + SIMHZ_FRM_SIZE;
+    z->frames[n].ulen = ulen;
+    z->frames[n].clen = clen;
+    if (frame_end > z->size)
+        z->size = frame_end;
+    pos += SIMHZ_FRM_SIZE + clen;
+    }
+z->end = pos;
+z->index_offset = 0;
+}
+
+/* Note that the index is about to become stale */
+
+static t_bool simhz_mark_dirty (SIMHZ *z)
+{
+if (z->index_offset == 0)
+    return TRUE;
+z->index_offset = 0;
+return (simhz_write_header (z) && (fflush (z->f) == 0));
+}
+
+static t_bool simhz_flush_frame (SIMHZ *z)
+{
+uint8 hdr[SIMHZ_FRM_SIZE];
+t_offset start = (t_offset)z->frame * z->frame_size;
+uint32 ulen = z->frame_size;
+uLongf clen = z->zbuf_size;
+
+if (!z->dirty)
+    return TRUE;
+if (start + ulen > z->size)
+    ulen = (uint32)(z->size - start);
+if ((compress2 (z->zbuf, &clen, z->buf, ulen, Z_DEFAULT_COMPRESSION) != Z_OK) ||
+    !simhz_mark_dirty (z))
+    return FALSE;
+if ((z->frames[z->frame].offset != 0) &&                /* the last record in the file */
+    (z->frames[z->frame].offset + z->frames[z->frame].clen == z->end))   /* is rewritten in place */
+    z->end = z->frames[z->frame].offset - SIMHZ_FRM_SIZE;
+simhz_put32 (hdr, SIMHZ_FRM_MAGIC);
+simhz_put32 (hdr + 4, z->frame);
+simhz_put32 (hdr + 8, ulen);
+simhz_put32 (hdr + 12, (uint32)clen);
+if (!simhz_pwrite (z, z->end, hdr, sizeof (hdr)) ||
+    (fwrite (z->zbuf, 1, clen, z->f) != clen))
+    return FALSE;
+z->frames[z->frame].offset = z->end + SIMHZ_FRM_SIZE;
+z->frames[z->frame].ulen = ulen;
+z->frames[z->frame].clen = (uint32)clen;
+z->end += SIMHZ_FRM_SIZE + clen;
+z->dirty = FALSE;
+return TRUE;
+}
+
+/* Make frame n the current frame.  Frames which have never been written
+   read as zeros. */
+
+static t_bool simhz_load_frame (SIMHZ *z, uint32 n)
+{
+SIMHZ_FRAME *fr;
+uLongf ulen = z->frame_size;
+
+if (n == z->frame)
+    return TRUE;
+if (!simhz_flush_frame (z) || !simhz_grow_frames (z, n + 1))
+    return FALSE;
+z->frame = SIMHZ_NO_FRAME;
+memset (z->buf, 0, z->frame_size);
+fr = &z->frames[n];
+if (fr->offset != 0) {
+    if ((fr->clen > z->zbuf_size) ||
+        !simhz_pread (z, fr->offset, z->zbuf, fr->clen) ||
+        (uncompress (z->buf, &ulen, z->zbuf, fr->clen) != Z_OK) ||
+        (ulen != fr->ulen))
+        return FALSE;
+    }
+z->frame = n;
+return TRUE;
+}
+
+/* Write the current frame, the index and the header */
+
+static t_bool simhz_sync (SIMHZ *z)
+{
+uint8 hdr[8];
+uint8 ent[SIMHZ_IDX_SIZE];
+uint32 i;
+
+if (!z->writable)
+    return TRUE;
+if (!simhz_flush_frame (z))
+    return FALSE;
+if (z->index_offset != 0)                       /* index is current? */
+    return TRUE;
+simhz_put32 (hdr, SIMHZ_IDX_MAGIC);
+simhz_put32 (hdr + 4, z->frame_count);
+if (!simhz_pwrite (z, z->end, hdr, sizeof (hdr)))
+    return FALSE;
+for (i = 0; i < z->frame_count; i++) {
+    simhz_put64 (ent, (t_uint64)z->frames[i].offset);
+    simhz_put32 (ent + 8, z->frames[i].ulen);
+    simhz_put32 (ent + 12, z->frames[i].clen);
+    if (fwrite (ent, 1, sizeof (ent), z->f) != sizeof (ent))
+        return FALSE;
+    }
+if (fflush (z->f) != 0)                         /* index on disk before the header points to it */
+    return FALSE;
+z->index_offset = z->end;
+return (simhz_write_header (z) && (fflush (z->f) == 0));
+}
+
+static long simhz_read (SIMHZ *z, char *buf, size_t size)
+{
+size_t done = 0;
+
+while ((done < size) && (z->pos < z->size)) {
+    uint32 n = (uint32)(z->pos / z->frame_size);
+    size_t offset = (size_t)(z->pos % z->frame_size);
+    size_t len = z->frame_size - offset;
+
+    if (len > size - done)
+        len = size - done;
+    if ((t_offset)len > z->size - z->pos)
+        len = (size_t)(z->size - z->pos);
+    if (!simhz_load_frame (z, n)) {
+        errno = EIO;
+        return (done > 0) ? (long)done : -1;
+        }
+    memcpy (buf + done, z->buf + offset, len);
+    done += len;
+    z->pos += len;
+    }
+return (long)done;
+}
+
+static long simhz_write (SIMHZ *z, const char *buf, size_t size)
+{
+size_t done = 0;
+
+if (!z->writable) {
+    errno = EBADF;
+    return -1;
+    }
+while (done < size) {
+    uint32 n = (uint32)(z->pos / z->frame_size);
+    size_t offset = (size_t)(z->pos % z->frame_size);
+    size_t len = z->frame_size - offset;
+
+    if (len > size - done)
+        len = size - done;
+    if (!simhz_load_frame (z, n)) {
+        errno = EIO;
+        return (done > 0) ? (long)done : -1;
+        }
+    memcpy (z->buf + offset, buf + done, len);
+    z->dirty = TRUE;
+    done += len;
+    z->pos += len;
+    if (z->pos > z->size)
+        z->size = z->pos;
+    }
+return (long)done;
+}
+
+static int simhz_seek (SIMHZ *z, t_offset *offset, int whence)
+{
+t_offset pos;
+
+switch (whence) {
+    case SEEK_SET:
+        pos = *offset;
+        break;
+    case SEEK_CUR:
+        pos = z->pos + *offset;
+        break;
+    case SEEK_END:
+        pos = z->size + *offset;
+        break;
+    default:
+        pos = -1;
+        break;
+    }
+if ((pos < 0) || (pos / z->frame_size >= SIMHZ_NO_FRAME)) {
+    errno = EINVAL;
+    return -1;
+    }
+*offset = z->pos = pos;
+return 0;
+}
+
+static int simhz_close (SIMHZ *z)
+{
+t_bool ok = simhz_sync (z);
+
+if (fclose (z->f) != 0)
+    ok = FALSE;
+free (z->frames);
+free (z->buf);
+free (z->zbuf);
+free (z);
+return ok ? 0 : -1;
+}
+
+#if defined (__GLIBC__)
+static ssize_t simhz_cookie_read (void *cookie, char *buf, size_t size)
+{
+return (ssize_t)simhz_read ((SIMHZ *)cookie, buf, size);
+}
+
+static ssize_t simhz_cookie_write (void *cookie, const char *buf, size_t size)
+{
+long r = simhz_write ((SIMHZ *)cookie, buf, size);
+
+return (r < 0) ? 0 : (ssize_t)r;                /* glibc expects 0 on error */
+}
+
+static int simhz_cookie_seek (void *cookie, off64_t *offset, int whence)
+{
+t_offset pos = (t_offset)*offset;
+
+if (simhz_seek ((SIMHZ *)cookie, &pos, whence))
+    return -1;
+*offset = (off64_t)pos;
+return 0;
+}
+
+static int simhz_cookie_close (void *cookie)
+{
+return simhz_close ((SIMHZ *)cookie);
+}
+#else
+static int simhz_cookie_read (void *cookie, char *buf, int size)
+{
+return (int)simhz_read ((SIMHZ *)cookie, buf, (size_t)size);
+}
+
+static int simhz_cookie_write (void *cookie, const char *buf, int size)
+{
+return (int)simhz_write ((SIMHZ *)cookie, buf, (size_t)size);
+}
+
+static fpos_t simhz_cookie_seek (void *cookie, fpos_t offset, int whence)
+{
+t_offset pos = (t_offset)offset;
+
+if (simhz_seek ((SIMHZ *)cookie, &pos, whence))
+    return (fpos_t)-1;
+return (fpos_t)pos;
+}
+
+static int simhz_cookie_close (void *cookie)
+{
+return simhz_close ((SIMHZ *)cookie);
+}
+#endif
+
+/* Open a SIMHZ container on an already open file, returning a stream
+   which reads and writes the uncompressed tape image.  An empty writable
+   file is initialized as an empty container.  On failure NULL is returned
+   and f remains open.  */
+
+static FILE *sim_tape_simhz_open (FILE *f, t_bool writable, void **handle)
+{
+SIMHZ *z = (SIMHZ *)calloc (1, sizeof (*z));
+uint8 hdr[SIMHZ_HDR_SIZE];
+t_offset file_size = sim_fsize_ex (f);
+FILE *zf = NULL;
+
+if (z == NULL)
+    return NULL;
+z->f = f;
+z->writable = writable;
+z->frame = SIMHZ_NO_FRAME;
+if (file_size == 0) {                           /* new container? */
+    z->frame_size = SIMHZ_FRAME_SIZE;
+    z->end = SIMHZ_HDR_SIZE;
+    if (!writable || !simhz_write_header (z))
+        goto Error;
+    }
+else {
+    if (!simhz_pread (z, 0, hdr, sizeof (hdr)) ||
+        (memcmp (hdr, SIMHZ_MAGIC, 8) != 0) ||
+        (simhz_get32 (hdr + 8) != SIMHZ_VERSION))
+        goto Error;
+    z->frame_size = simhz_get32 (hdr + 12);
+    z->index_offset = (t_offset)simhz_get64 (hdr + 16);
+    z->size = (t_offset)simhz_get64 (hdr + 24);
+    if ((z->frame_size < 512) || (z->frame_size > SIMHZ_MAX_FRAME))
+        goto Error;
+    if (!simhz_read_index (z, file_size))       /* no usable index? */
+        simhz_recover (z, file_size);
+    }
+z->zbuf_size = compressBound (z->frame_size);
+z->buf = (uint8 *)malloc (z->frame_size);
+z->zbuf = (uint8 *)malloc (z->zbuf_size);
+if ((z->buf == NULL) || (z->zbuf == NULL))
+    goto Error;
+if (1) {
+#if defined (__GLIBC__)
+    cookie_io_functions_t io;
+
+    io.read = simhz_cookie_read;
+    io.write = simhz_cookie_write;
+    io.seek = simhz_cookie_seek;
+    io.close = simhz_cookie_close;
+    zf = fopencookie (z, writable ? "r+b" : "rb", io);
+#else
+    zf = funopen (z, simhz_cookie_read, writable ? simhz_cookie_write : NULL,
+                  simhz_cookie_seek, simhz_cookie_close);
+#endif
+    }
+if (zf == NULL)
+    goto Error;
+if (handle)
+    *handle = z;
+return zf;
+
+Error:
+free (z->frames);
+free (z->buf);
+free (z->zbuf);
+free (z);
+return NULL;
+}
+
+static t_bool sim_tape_simhz_sync (void *handle)
+{
+return simhz_sync ((SIMHZ *)handle);
+}
+
+#endif /* SIM_TAPE_SIMHZ */
+
 /* 
    This routine is called when the simulator stops and any time
    the asynch mode is changed (enabled or disabled)
 */
 static void _sim_tape_io_flush (UNIT *uptr)
 {
-#if defined (SIM_ASYNCH_IO)
+#if defined (SIM_ASYNCH_IO) || defined (SIM_TAPE_SIMHZ)
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+#endif
 
+#if defined (SIM_ASYNCH_IO)
 sim_tape_clr_async (uptr);
 if (sim_asynch_enabled)
     sim_tape_set_async (uptr, ctx->asynch_io_latency);
 #endif
-if (MT_GET_FMT (uptr) < MTUF_F_ANSI)
+(void)sim_tape_wb_flush (uptr);
+if (!MT_IS_MEMORY_TAPE (MT_GET_FMT (uptr)))
     fflush (uptr->fileref);
+#if defined (SIM_TAPE_SIMHZ)
+if ((MT_GET_FMT (uptr) == MTUF_F_SIMHZ) && (ctx != NULL) && (ctx->simhz != NULL))
+    sim_tape_simhz_sync (ctx->simhz);                   /* write the frame index */
+#endif
 }
 
 static const char *_sim_tape_format_name (UNIT *uptr)
@@ -645,6 +1415,7 @@ t_stat r;
 t_bool auto_format = FALSE;
 t_bool had_debug = (sim_deb != NULL);
 uint32 starting_dctrl = uptr->dctrl;
+uint32 ra_size = RA_DEFAULT_SIZE;
 int32 saved_switches = sim_switches;
 MEMORY_TAPE *tape = NULL;
 
@@ -679,8 +1450,18 @@ if (sim_switches & SWMASK ('B')) {                      /* Record Size (blocking
         }
     sim_switches = sim_switches & ~(SWMASK ('B'));      /* Record Blocking Factor */
     }
+if (sim_switches & SWMASK ('K')) {                      /* Read-ahead buffer size? */
+    cptr = get_glyph (cptr, gbuf, 0);                   /* get spec */
+    if (*cptr == 0)                                     /* must be more */
+        return sim_messagef (SCPE_2FARG, "Missing Read-ahead Size and/or filename to attach\n");
+    ra_size = (uint32) get_uint (gbuf, 10, RA_MAX_SIZE / 1024, &r);
+    if (r != SCPE_OK)
+        return sim_messagef (SCPE_ARG, "Invalid Read-ahead Size: %s\n", gbuf);
+    ra_size *= 1024;
+    sim_switches = sim_switches & ~(SWMASK ('K'));      /* Read-ahead size already processed */
+    }
 if (sim_switches & SWMASK ('E'))                        /* On-disk tape image file must exist? */
-    if (MT_GET_FMT (uptr) >= MTUF_F_ANSI)               /* Does not apply to MEMORY_TAPE images */
+    if (MT_IS_MEMORY_TAPE (MT_GET_FMT (uptr)))          /* Does not apply to MEMORY_TAPE images */
         sim_messagef (SCPE_ARG, "The -E option is ignored for %s format\n", _sim_tape_format_name (uptr));
 if (fmts[MT_GET_FMT (uptr)].uflags & UNIT_RO)           /* Force ReadOnly attach for TPC, */
     sim_switches |= SWMASK ('R');                       /*     TAR, ANSI, FIXED and DOS11 */
@@ -742,23 +1523,8 @@ switch (MT_GET_FMT (uptr)) {
             t_bool crlf_line_endings;
             uint8 *block = NULL;
             int error = FALSE;
-            static const uint8 ascii2ebcdic[128] = {
-                0000,0001,0002,0003,0067,0055,0056,0057,
-                0026,0005,0045,0013,0014,0015,0016,0017,
-                0020,0021,0022,0023,0074,0075,0062,0046,
-                0030,0031,0077,0047,0034,0035,0036,0037,
-                0100,0117,0177,0173,0133,0154,0120,0175,
-                0115,0135,0134,0116,0153,0140,0113,0141,
-                0360,0361,0362,0363,0364,0365,0366,0367,
-                0370,0371,0172,0136,0114,0176,0156,0157,
-                0174,0301,0302,0303,0304,0305,0306,0307,
-                0310,0311,0321,0322,0323,0324,0325,0326,
-                0327,0330,0331,0342,0343,0344,0345,0346,
-                0347,0350,0351,0112,0340,0132,0137,0155,
-                0171,0201,0202,0203,0204,0205,0206,0207,
-                0210,0211,0221,0222,0223,0224,0225,0226,
-                0227,0230,0231,0242,0243,0244,0245,0246,
-                0247,0250,0251,0300,0152,0320,0241,0007};
+            TAPE_SOURCE *src = NULL;
+            uint32 count = 0;
 
             memset (&statb, 0, sizeof (statb));
             tape = memory_create_tape ();
@@ -786,17 +1552,11 @@ switch (MT_GET_FMT (uptr)) {
                     break;
                     }
                 tape->block_size = uptr->recsize;
-                block = (uint8 *)malloc (tape->block_size);
-                while (!feof (f) && !error) {
-                    size_t data_read = fread (block, 1, tape->block_size, f);
-                    if (data_read == tape->block_size)
-                        error = memory_tape_add_block (tape, block, tape->block_size);
-                    else {
-                        if (data_read != 0) {
-                            r = sim_messagef (SCPE_ARG, "Read %u bytes of data when expecting %u bytes\n", (uint32)data_read, (uint32)tape->block_size);
-                            error = TRUE;
-                            }
-                        }
+                src = memory_tape_new_source (cptr, SRC_BINARY, tape->block_size);
+                error = (src == NULL);
+                if (!error) {
+                    src->size = (t_offset)statb.st_size;
+                    count = (uint32)(src->size / tape->block_size);
                     }
                 }
             else {                                              /* text file */
@@ -809,28 +1569,25 @@ switch (MT_GET_FMT (uptr)) {
                     }
                 tape->block_size = uptr->recsize;
                 block = (uint8 *)calloc (1, tape->block_size + 3);
-                while (!feof (f) && !error) {
-                    if (fgets ((char *)block, tape->block_size + 3, f)) {
-                        size_t len = strlen ((char *)block);
-
-                        while ((len > 0) && 
-                               ((block[len - 1] == '\r') || (block[len - 1] == '\n')))
-                            --len;
-                        memset (block + len, ' ', tape->block_size - len);
-                        if (sim_switches & SWMASK ('C')) {
-                            uint32 i;
-
-                            for (i = 0; i < tape->block_size; i++)
-                                block[i] = ascii2ebcdic[block[i]];
-                            }
-                        error = memory_tape_add_block (tape, block, tape->block_size);
-                        }
+                src = memory_tape_new_source (cptr, SRC_FIXED_TEXT, tape->block_size);
+                error = ((block == NULL) || (src == NULL));
+                if (!error)
+                    src->ebcdic = ((sim_switches & SWMASK ('C')) != 0);
+                while (!feof (f) && !error) {           /* find where each line starts */
+                    t_offset offset = sim_ftell (f);
+
+                    if (fgets ((char *)block, tape->block_size + 3, f))
+                        error = memory_tape_source_offset (src, count++, offset);
                     else
                         error = ferror (f);
                     }
                 }
             free (block);
             fclose (f);
+            if ((count > 0) && !error)
+                error = memory_tape_add_source (tape, src, count);
+            else
+                memory_tape_free_source (src);
             if (error)
                 r = sim_messagef (SCPE_IERR, "Error processing input file %s\n", cptr);
             else {
@@ -898,7 +1655,7 @@ switch (MT_GET_FMT (uptr)) {
         break;
     }
 if (r != SCPE_OK) {                                     /* error? */
-    if (MT_GET_FMT (uptr) >= MTUF_F_ANSI) {
+    if (MT_IS_MEMORY_TAPE (MT_GET_FMT (uptr))) {
         r = sim_messagef (r, "Error opening %s format internal tape image generated from: '%s'\n", _sim_tape_format_name (uptr), cptr);
         memory_free_tape (uptr->fileref);
         uptr->fileref = NULL;
@@ -947,12 +1704,43 @@ switch (MT_GET_FMT (uptr)) {                            /* case on format */
         uptr->hwmark = (t_addr)sim_fsize (uptr->fileref);
         break;
 
+    case MTUF_F_SIMHZ:                                  /* SIMHZ */
+#if defined (SIM_TAPE_SIMHZ)
+        if (1) {
+            FILE *zf = sim_tape_simhz_open (uptr->fileref, ((uptr->flags & UNIT_RO) == 0), &ctx->simhz);
+
+            if (zf == NULL) {                           /* not a usable container? */
+                sim_tape_detach (uptr);
+                r = sim_messagef (SCPE_FMT, "'%s' is not a valid SIMHZ format tape image\n", cptr);
+                }
+            else
+                uptr->fileref = zf;                     /* the stream now owns the file */
+            }
+#else
+        sim_tape_detach (uptr);
+        r = sim_messagef (SCPE_NOFNC, "SIMHZ format tapes are not supported by this build\n");
+#endif
+        break;
+
     default:
         break;
         }
 
 if (r == SCPE_OK) {
 
+    if ((ra_size > 0) &&                                /* read ahead wanted */
+        ((MT_GET_FMT (uptr) == MTUF_F_STD) ||           /*   and a SIMH */
+         (MT_GET_FMT (uptr) == MTUF_F_E11))) {          /*   or E11 image? */
+        ctx->ra_buf = (uint8 *)malloc (ra_size);
+        if (ctx->ra_buf != NULL)                        /* without memory just read the file */
+            ctx->ra_size = ra_size;
+        }
+    if (!(uptr->flags & UNIT_RO) &&                     /* writable SIMH, E11 */
+        ((MT_GET_FMT (uptr) == MTUF_F_STD) ||           /*   or P7B image? */
+         (MT_GET_FMT (uptr) == MTUF_F_E11) ||
+         (MT_GET_FMT (uptr) == MTUF_F_P7B)))
+        ctx->wb_buf = (uint8 *)malloc (MT_WB_SIZE);     /* without memory just write the file */
+
     sim_tape_validate_tape (uptr);
 
     sim_tape_rewind (uptr);
@@ -997,7 +1785,7 @@ if (ctx)
 sim_tape_clr_async (uptr);
 
 MT_CLR_INMRK (uptr);                                    /* Not within a TAR tapemark */
-if (MT_GET_FMT (uptr) >= MTUF_F_ANSI) {
+if (MT_IS_MEMORY_TAPE (MT_GET_FMT (uptr))) {
     memory_free_tape ((void *)uptr->fileref);
     uptr->fileref = NULL;
     uptr->flags &= ~UNIT_ATT;
@@ -1024,6 +1812,11 @@ uptr->tape_eom = 0;
 uptr->pos = 0;
 MT_CLR_PNU (uptr);
 MT_CLR_INMRK (uptr);                                    /* Not within a TAR tapemark */
+if (ctx) {
+    _sim_tape_index_free (ctx);
+    free (ctx->ra_buf);
+    free (ctx->wb_buf);
+    }
 free (uptr->tape_ctx);
 uptr->tape_ctx = NULL;
 uptr->io_flush = NULL;
@@ -1057,13 +1850,16 @@ fprintf (st, "    -Q          Suppress informative messages during attach activi
 fprintf (st, "    -F          Open the indicated tape container in a specific format\n");
 fprintf (st, "                (default is SIMH, alternatives are E11, TPC, P7B, AWS, TAR,\n");
 fprintf (st, "                ANSI-VMS, ANSI-RT11, ANSI-RSX11, ANSI-RSTS, ANSI-VAR, FIXED,\n");
-fprintf (st, "                DOS11)\n");
+fprintf (st, "                DOS11, SIMHZ)\n");
 fprintf (st, "    -B          For TAR format tapes, the record size for data read from the\n");
 fprintf (st, "                specified file.  This record size will be used for all but \n");
 fprintf (st, "                possibly the last record which will be what remains unread.\n");
 fprintf (st, "                The default TAR record size is 10240.  For FIXED format tapes\n");
 fprintf (st, "                -B specifies the record size for binary data or the maximum \n");
 fprintf (st, "                record size for text data\n");
+fprintf (st, "    -K          For SIMH and E11 format tapes, the size in KB of the buffer\n");
+fprintf (st, "                used to read ahead when reading forward (default 256, 0\n");
+fprintf (st, "                disables read ahead).\n");
 fprintf (st, "    -V          Display some summary information about the record structure\n");
 fprintf (st, "                observed in the tape image observed during the attach\n");
 fprintf (st, "                validation pass\n");
@@ -1074,7 +1870,8 @@ fprintf (st, "                while the tape image is scanned.\n");
 fprintf (st, "    -C          Causes FIXED format tape data sets derived from text files to\n");
 fprintf (st, "                be converted from ASCII to EBCDIC.\n");
 fprintf (st, "    -X          Extract a copy of the attached tape and convert it to a SIMH\n");
-fprintf (st, "                format tape image.\n\n");
+fprintf (st, "                format tape image.\n");
+fprintf (st, "    -Z          With -X, write the extracted copy as a SIMHZ format tape image.\n\n");
 fprintf (st, "Notes:  ANSI-VMS, ANSI-RT11, ANSI-RSTS, ANSI-RSX11, ANSI-VAR formats allows\n");
 fprintf (st, "        one or several files to be presented to as a read only ANSI Level 3\n");
 fprintf (st, "        labeled tape with file labels that make each individual file\n");
@@ -1092,13 +1889,19 @@ fprintf (st, "        placed in an otherwise unused word in the header which som
 fprintf (st, "        operating systems will be able to process. If the resulting\n");
 fprintf (st, "        filename is NULL, a filename in the range 000000 - 999999 will be\n");
 fprintf (st, "        generated based of the file position on the tape.\n\n");
+fprintf (st, "        SIMHZ format is a SIMH format tape image stored as independently\n");
+fprintf (st, "        compressed frames, so that any part of the tape can be read or\n");
+fprintf (st, "        written without decompressing the rest.  Rewritten frames are\n");
+fprintf (st, "        appended to the file, so an image which has been written over\n");
+fprintf (st, "        many times can be compacted by copying it with -XZ.\n\n");
 fprintf (st, "Examples:\n\n");
 fprintf (st, "  sim> ATTACH %s -F ANSI-VMS Hobbyist-USE-ONLY-VA.TXT\n", dptr->name);
 fprintf (st, "  sim> ATTACH %s -F ANSI-RSX11 *.TXT,*.ini,*.exe\n", dptr->name);
 fprintf (st, "  sim> ATTACH %s -FX ANSI-RSTS RSTS.tap *.TXT,*.SAV\n", dptr->name);
 fprintf (st, "  sim> ATTACH %s -F ANSI-RT11 *.TXT,*.TSK\n", dptr->name);
 fprintf (st, "  sim> ATTACH %s -FB FIXED 80 SOMEFILE.TXT\n", dptr->name);
-fprintf (st, "  sim> ATTACH %s -F DOS11 *.LDA,*.TXT\n\n", dptr->name);
+fprintf (st, "  sim> ATTACH %s -F DOS11 *.LDA,*.TXT\n", dptr->name);
+fprintf (st, "  sim> ATTACH %s -XZ BACKUP.tapz BACKUP.tap\n\n", dptr->name);
 return SCPE_OK;
 }
 
@@ -1112,20 +1915,150 @@ if (sim_deb && ((uptr->dctrl | ctx->dptr->dctrl) & reason))
     sim_data_trace(ctx->dptr, uptr, (detail ? data : NULL), "", len, txt, reason);
 }
 
+/* Write-behind buffer
+
+   Records, tape marks and gaps written forward to SIMH, E11 and P7B
+   images are collected in a per unit buffer, so that writing a tape of
+   small records costs one file write per buffer full rather than a seek
+   and two or three small writes per record.  The pending data is written
+   out before anything else positions or sizes the file (sim_tape_seek,
+   sim_tape_size), when a write doesn't continue where the pending data
+   ends, and when the unit's I/O is flushed (simulator stop, the periodic
+   flush of attached files and detach).
+*/
+
+static t_stat sim_tape_wb_flush (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 len;
+
+if ((ctx == NULL) || (ctx->wb_len == 0))
+    return MTSE_OK;
+len = ctx->wb_len;
+ctx->wb_len = 0;
+if ((sim_fseek (uptr->fileref, ctx->wb_start, SEEK_SET) != 0) ||
+    (sim_fwrite (ctx->wb_buf, 1, len, uptr->fileref) != len))
+    return MTSE_IOERR;
+return MTSE_OK;
+}
+
 static int sim_tape_seek (UNIT *uptr, t_addr pos)
 {
-if (MT_GET_FMT (uptr) < MTUF_F_ANSI)
+if (sim_tape_wb_flush (uptr) != MTSE_OK)
+    return -1;
+if (!MT_IS_MEMORY_TAPE (MT_GET_FMT (uptr)))
     return sim_fseek (uptr->fileref, pos, SEEK_SET);
 return 0;
 }
 
+/* Write count elements of size bytes at file position pos, through the
+   write-behind buffer when the unit has one.  Like sim_fwrite, elements
+   are stored little endian whatever the host's byte order. */
+
+static t_stat sim_tape_wbwrite (UNIT *uptr, t_addr pos, const void *bptr, size_t size, size_t count)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+size_t bytes = size * count;
+
+if ((ctx != NULL) && (ctx->wb_buf != NULL) && (bytes <= MT_WB_SIZE)) {
+    if ((ctx->wb_len > 0) &&                            /* not appending to the pending data? */
+        ((ctx->wb_start + ctx->wb_len != pos) ||
+         (ctx->wb_len + bytes > MT_WB_SIZE)) &&
+        (sim_tape_wb_flush (uptr) != MTSE_OK))
+        return MTSE_IOERR;
+    if (ctx->wb_len == 0)
+        ctx->wb_start = pos;
+    sim_buf_copy_swapped (ctx->wb_buf + ctx->wb_len, bptr, size, count);
+    ctx->wb_len += (uint32)bytes;
+    return MTSE_OK;
+    }
+if ((sim_tape_seek (uptr, pos) != 0) ||
+    (sim_fwrite (bptr, size, count, uptr->fileref) != count))
+    return MTSE_IOERR;
+return MTSE_OK;
+}
+
 static t_offset sim_tape_size (UNIT *uptr)
 {
-if (MT_GET_FMT (uptr) < MTUF_F_ANSI)
+(void)sim_tape_wb_flush (uptr);
+if (!MT_IS_MEMORY_TAPE (MT_GET_FMT (uptr)))
     return sim_fsize_ex (uptr->fileref); /* True on-disk tape images: file size  */
 return uptr->tape_eom;                   /* Virtual tape images: record/TM count */
 }
 
+/* Read-ahead buffer
+
+   Forward reads and spacing of SIMH and E11 format images go through a
+   per unit buffer (sized with ATTACH -K), so that streaming a tape costs
+   one file read per buffer full rather than a seek and two or three small
+   reads per record.  sim_tape_rdseek and sim_tape_rdread stand in for
+   sim_tape_seek and sim_fread in those paths and sim_tape_rdeof for feof.
+   Reverse reads and everything that writes the image use the file
+   directly; writes, erases and rewinds discard the buffer contents.
+
+   With asynchronous I/O enabled, tape operations (and so the buffer
+   refills) are performed by the I/O worker thread.
+*/
+
+static void sim_tape_ra_invalidate (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if (ctx != NULL)
+    ctx->ra_len = 0;
+}
+
+static int sim_tape_rdseek (UNIT *uptr, t_addr pos)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if ((ctx == NULL) || (ctx->ra_buf == NULL))
+    return sim_tape_seek (uptr, pos);
+ctx->ra_cur = pos;                                      /* the file is positioned when needed */
+ctx->ra_eof = FALSE;
+return 0;
+}
+
+static size_t sim_tape_rdread (UNIT *uptr, void *bptr, size_t size, size_t count)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+size_t bytes = size * count;
+size_t avail, n;
+
+if ((ctx == NULL) || (ctx->ra_buf == NULL))
+    return sim_fread (bptr, size, count, uptr->fileref);
+if ((ctx->ra_cur < ctx->ra_start) ||                    /* not all in the buffer? */
+    (ctx->ra_cur + bytes > ctx->ra_start + ctx->ra_len)) {
+    if (sim_tape_seek (uptr, ctx->ra_cur))
+        return 0;
+    if (bytes > ctx->ra_size) {                         /* larger than the buffer? */
+        ctx->ra_len = 0;
+        n = sim_fread (bptr, size, count, uptr->fileref);
+        ctx->ra_eof = (feof (uptr->fileref) != 0);
+        ctx->ra_cur += n * size;
+        return n;
+        }
+    ctx->ra_start = ctx->ra_cur;
+    ctx->ra_len = (uint32)fread (ctx->ra_buf, 1, ctx->ra_size, uptr->fileref);
+    }
+avail = (size_t)(ctx->ra_start + ctx->ra_len - ctx->ra_cur);
+n = (avail >= bytes) ? count : avail / size;
+if (n < count)
+    ctx->ra_eof = TRUE;
+sim_buf_copy_swapped (bptr, ctx->ra_buf + (size_t)(ctx->ra_cur - ctx->ra_start), size, n);
+ctx->ra_cur += n * size;
+return n;
+}
+
+static t_bool sim_tape_rdeof (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if ((ctx == NULL) || (ctx->ra_buf == NULL))
+    return (feof (uptr->fileref) != 0);
+return ctx->ra_eof;
+}
+
 /* Read record length forward (internal routine).
 
    Inputs:
@@ -1244,7 +2177,7 @@ if ((uptr->tape_eom > 0) &&
     return MTSE_EOM;                                    /*     and quit with I/O error status */
     }
 
-if (sim_tape_seek (uptr, uptr->pos)) {                  /* set the initial tape position; if it fails */
+if (sim_tape_rdseek (uptr, uptr->pos)) {                /* set the initial tape position; if it fails */
     MT_SET_PNU (uptr);                                  /*   then set position not updated */
     return sim_tape_ioerr (uptr);                       /*     and quit with I/O error status */
     }
@@ -1252,6 +2185,7 @@ if (sim_tape_seek (uptr, uptr->pos)) {                  /* set the initial tape
 switch (f) {                                       /* otherwise the read method depends on the tape format */
 
     case MTUF_F_STD:
+    case MTUF_F_SIMHZ:
     case MTUF_F_E11:
         runaway_counter = 25 * 12 * bpi [MT_DENS (uptr->dynflags)]; /* set the largest legal gap size in bytes */
 
@@ -1268,7 +2202,7 @@ switch (f) {                                       /* otherwise the read method
 
         do {                                            /* loop until a record, gap, or error is seen */
             if (bufcntr == bufcap) {                    /* if the buffer is empty then refill it */
-                if (feof (uptr->fileref)) {             /* if we hit the EOF while reading a gap */
+                if (sim_tape_rdeof (uptr)) {            /* if we hit the EOF while reading a gap */
                     if (sizeof_gap > 0)                 /*   then if detection is enabled */
                         status = MTSE_RUNAWAY;          /*     then report a tape runaway */
                     else                                /*   otherwise report the physical EOF */
@@ -1283,10 +2217,10 @@ switch (f) {                                       /* otherwise the read method
                     bufcap = sizeof (buffer)            /*   to the full size of the buffer */
                                / sizeof (buffer [0]);
 
-                bufcap = sim_fread (buffer,             /* fill the buffer */
-                                    sizeof (t_mtrlnt),  /*   with tape metadata */
-                                    bufcap,
-                                    uptr->fileref);
+                bufcap = sim_tape_rdread (uptr,         /* fill the buffer */
+                                          buffer,       /*   with tape metadata */
+                                          sizeof (t_mtrlnt),
+                                          bufcap);
 
                 if (ferror (uptr->fileref)) {           /* if a file I/O error occurred */
                     if (bufcntr == 0)                   /*   then if this is the initial read */
@@ -1340,7 +2274,7 @@ switch (f) {                                       /* otherwise the read method
             else if (*bc == MTR_FHGAP) {                /* otherwise if the value if a half gap */
                 uptr->pos -= sizeof (t_mtrlnt) / 2;     /*   then back up and resync */
 
-                if (sim_tape_seek (uptr, uptr->pos)) {  /* set the tape position; if it fails */
+                if (sim_tape_rdseek (uptr, uptr->pos)) {/* set the tape position; if it fails */
                     status = sim_tape_ioerr (uptr);     /*   then quit with I/O error status */
                     break;
                     }
@@ -1355,7 +2289,7 @@ switch (f) {                                       /* otherwise the read method
                 saved_pos = uptr->pos;                  /* Save data position */
                 sbc = MTR_L (*bc);                      /* extract the record length */
                 uptr->pos = uptr->pos + sizeof (t_mtrlnt)     /* position to the start */
-                  + (f == MTUF_F_STD ? (sbc + 1) & ~1 : sbc); /*   of the record */
+                  + (f == MTUF_F_E11 ? sbc : (sbc + 1) & ~1); /*   of the record */
                 }
             }
         while (*bc == MTR_GAP && runaway_counter > 0);  /* continue until data or runaway occurs */
@@ -1366,15 +2300,15 @@ switch (f) {                                       /* otherwise the read method
         if (status == MTSE_OK) {        /* Validate the reverse record size for data records */
             t_mtrlnt rev_lnt;
 
-            if (sim_tape_seek (uptr, uptr->pos - sizeof (t_mtrlnt))) {  /*   then seek to the end of record size; if it fails */
+            if (sim_tape_rdseek (uptr, uptr->pos - sizeof (t_mtrlnt))) {  /*   then seek to the end of record size; if it fails */
                 status = sim_tape_ioerr (uptr);         /*     then quit with I/O error status */
                 break;
                 }
 
-            (void)sim_fread (&rev_lnt,                  /* get the reverse length */
-                             sizeof (t_mtrlnt),
-                             1,
-                             uptr->fileref);
+            (void)sim_tape_rdread (uptr,                /* get the reverse length */
+                                   &rev_lnt,
+                                   sizeof (t_mtrlnt),
+                                   1);
 
             if (ferror (uptr->fileref)) {               /* if a file I/O error occurred */
                 status = sim_tape_ioerr (uptr);         /* report the error and quit */
@@ -1386,7 +2320,7 @@ switch (f) {                                       /* otherwise the read method
                 MT_SET_PNU (uptr);                      /* pos not upd */
                 break;
                 }
-            if (sim_tape_seek (uptr, saved_pos))        /*   then seek back to the beginning of the data; if it fails */
+            if (sim_tape_rdseek (uptr, saved_pos))      /*   then seek back to the beginning of the data; if it fails */
                 status = sim_tape_ioerr (uptr);         /*     then quit with I/O error status */
             }
         break;                                          /* otherwise the operation succeeded */
@@ -1521,10 +2455,9 @@ switch (f) {                                       /* otherwise the read method
             if (uptr->pos >= tape->record_count)
                 status = MTSE_EOM;
             else {
-                if (tape->records[uptr->pos]->size == 0)
+                *bc = memory_tape_record_size (tape, (uint32)uptr->pos);
+                if (*bc == 0)
                     status = MTSE_TMK;
-                else
-                    *bc = tape->records[uptr->pos]->size;
                 ++uptr->pos;
                 }
             }
@@ -1618,6 +2551,7 @@ if (sim_tape_bot (uptr))                                /* if the unit is positi
 switch (f) {                                            /* otherwise the read method depends on the tape format */
 
     case MTUF_F_STD:
+    case MTUF_F_SIMHZ:
     case MTUF_F_E11:
         runaway_counter = 25 * 12 * bpi [MT_DENS (uptr->dynflags)]; /* set the largest legal gap size in bytes */
 
@@ -1690,7 +2624,7 @@ switch (f) {                                            /* otherwise the read me
             else {                                      /* otherwise it's a record marker */
                 sbc = MTR_L (*bc);                      /* extract the record length */
                 uptr->pos = uptr->pos - sizeof (t_mtrlnt)/* position to the start */
-                  - (f == MTUF_F_STD ? (sbc + 1) & ~1 : sbc);/*   of the record */
+                  - (f == MTUF_F_E11 ? sbc : (sbc + 1) & ~1);/*   of the record */
 
                 if (sim_tape_seek (uptr,                /* seek to the start of the data area; if it fails */
                                uptr->pos + sizeof (t_mtrlnt))) {/* then return with I/O error status */
@@ -1856,10 +2790,9 @@ switch (f) {                                            /* otherwise the read me
             MEMORY_TAPE *tape = (MEMORY_TAPE *)uptr->fileref;
 
             --uptr->pos;
-            if (tape->records[uptr->pos]->size == 0)
+            *bc = memory_tape_record_size (tape, (uint32)uptr->pos);
+            if (*bc == 0)
                 status = MTSE_TMK;
-            else
-                *bc = tape->records[uptr->pos]->size;
             }
         break;
 
@@ -1907,7 +2840,7 @@ return status;
    data record error    updated
 */
 
-t_stat sim_tape_rdrecf (UNIT *uptr, uint8 *buf, t_mtrlnt *bc, t_mtrlnt max)
+static t_stat _sim_tape_rdrecf (UNIT *uptr, uint8 *buf, t_mtrlnt *bc, t_mtrlnt max)
 {
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
 uint32 f = MT_GET_FMT (uptr);
@@ -1932,8 +2865,8 @@ if (rbc > max) {                                        /* rec out of range? */
     uptr->pos = opos;
     return MTSE_INVRL;
     }
-if (f < MTUF_F_ANSI) {
-    i = (t_mtrlnt) sim_fread (buf, sizeof (uint8), rbc, uptr->fileref); /* read record */
+if (!MT_IS_MEMORY_TAPE (f)) {
+    i = (t_mtrlnt) sim_tape_rdread (uptr, buf, sizeof (uint8), rbc); /* read record */
     if (ferror (uptr->fileref)) {                           /* error? */
         MT_SET_PNU (uptr);
         uptr->pos = opos;
@@ -1943,8 +2876,9 @@ if (f < MTUF_F_ANSI) {
 else {
     MEMORY_TAPE *tape = (MEMORY_TAPE *)uptr->fileref;
 
-    memcpy (buf, tape->records[uptr->pos - 1]->data, rbc);
     i = rbc;
+    if (memory_tape_read_record (tape, (uint32)(uptr->pos - 1), buf))
+        tbc |= MTR_ERF;                                 /* source file read error */
     }
 for ( ; i < rbc; i++)                                   /* fill with 0's */
     buf[i] = 0;
@@ -1954,6 +2888,19 @@ sim_tape_data_trace(uptr, buf, rbc, "Record Read", (uptr->dctrl | ctx->dptr->dct
 return (MTR_F (tbc)? MTSE_RECE: MTSE_OK);
 }
 
+t_stat sim_tape_rdrecf (UNIT *uptr, uint8 *buf, t_mtrlnt *bc, t_mtrlnt max)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+t_uint64 start = sim_host_nsec ();
+t_stat st = _sim_tape_rdrecf (uptr, buf, bc, max);
+
+if (ctx) {
+    sim_latency_record (&ctx->read_host, sim_host_nsec () - start);
+    ctx->read_bytes += *bc;
+    }
+return st;
+}
+
 t_stat sim_tape_rdrecf_a (UNIT *uptr, uint8 *buf, t_mtrlnt *bc, t_mtrlnt max, TAPE_PCALLBACK callback)
 {
 t_stat r = SCPE_OK;
@@ -1986,7 +2933,7 @@ return r;
    data record error    updated
 */
 
-t_stat sim_tape_rdrecr (UNIT *uptr, uint8 *buf, t_mtrlnt *bc, t_mtrlnt max)
+static t_stat _sim_tape_rdrecr (UNIT *uptr, uint8 *buf, t_mtrlnt *bc, t_mtrlnt max)
 {
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
 uint32 f = MT_GET_FMT (uptr);
@@ -2006,7 +2953,7 @@ if (st != MTSE_OK) {
 *bc = rbc = MTR_L (tbc);                                /* strip error flag */
 if (rbc > max)                                          /* rec out of range? */
     return MTSE_INVRL;
-if (f < MTUF_F_ANSI) {
+if (!MT_IS_MEMORY_TAPE (f)) {
     i = (t_mtrlnt) sim_fread (buf, sizeof (uint8), rbc, uptr->fileref); /* read record */
     if (ferror (uptr->fileref))                             /* error? */
         return sim_tape_ioerr (uptr);
@@ -2014,8 +2961,9 @@ if (f < MTUF_F_ANSI) {
 else {
     MEMORY_TAPE *tape = (MEMORY_TAPE *)uptr->fileref;
 
-    memcpy (buf, tape->records[uptr->pos]->data, rbc);
     i = rbc;
+    if (memory_tape_read_record (tape, (uint32)uptr->pos, buf))
+        tbc |= MTR_ERF;                                 /* source file read error */
     }
 for ( ; i < rbc; i++)                                   /* fill with 0's */
     buf[i] = 0;
@@ -2025,6 +2973,19 @@ sim_tape_data_trace(uptr, buf, rbc, "Record Read Reverse", (uptr->dctrl | ctx->d
 return (MTR_F (tbc)? MTSE_RECE: MTSE_OK);
 }
 
+t_stat sim_tape_rdrecr (UNIT *uptr, uint8 *buf, t_mtrlnt *bc, t_mtrlnt max)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+t_uint64 start = sim_host_nsec ();
+t_stat st = _sim_tape_rdrecr (uptr, buf, bc, max);
+
+if (ctx) {
+    sim_latency_record (&ctx->read_host, sim_host_nsec () - start);
+    ctx->read_bytes += *bc;
+    }
+return st;
+}
+
 t_stat sim_tape_rdrecr_a (UNIT *uptr, uint8 *buf, t_mtrlnt *bc, t_mtrlnt max, TAPE_PCALLBACK callback)
 {
 t_stat r = SCPE_OK;
@@ -2051,12 +3012,13 @@ return r;
    data record          updated
 */
 
-t_stat sim_tape_wrrecf (UNIT *uptr, uint8 *buf, t_mtrlnt bc)
+static t_stat _sim_tape_wrrecf (UNIT *uptr, uint8 *buf, t_mtrlnt bc)
 {
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
 uint32 f = MT_GET_FMT (uptr);
 t_mtrlnt sbc;
 t_stat status = MTSE_OK;
+t_addr start = uptr->pos;
 
 if (ctx == NULL)                                        /* if not properly attached? */
     return sim_messagef (SCPE_IERR, "Bad Attach\n");    /*   that's a problem */
@@ -2071,18 +3033,17 @@ if (sim_tape_wrp (uptr))                                /* write prot? */
     return MTSE_WRP;
 if (sbc == 0)                                           /* nothing to do? */
     return MTSE_OK;
-if (sim_tape_seek (uptr, uptr->pos))                    /* set pos */
-    return MTSE_IOERR;
 switch (f) {                                            /* case on format */
 
     case MTUF_F_STD:                                    /* standard */
+    case MTUF_F_SIMHZ:                                  /* compressed standard */
         sbc = MTR_L ((bc + 1) & ~1);                    /* pad odd length */
         /* fall through into the E11 handler */
     case MTUF_F_E11:                                    /* E11 */
-        (void)sim_fwrite (&bc, sizeof (t_mtrlnt), 1, uptr->fileref);
-        (void)sim_fwrite (buf, sizeof (uint8), sbc, uptr->fileref);
-        (void)sim_fwrite (&bc, sizeof (t_mtrlnt), 1, uptr->fileref);
-        if (ferror (uptr->fileref)) {                   /* error? */
+        if ((sim_tape_wbwrite (uptr, uptr->pos, &bc, sizeof (t_mtrlnt), 1) != MTSE_OK) ||
+            (sim_tape_wbwrite (uptr, uptr->pos + sizeof (t_mtrlnt), buf, sizeof (uint8), sbc) != MTSE_OK) ||
+            (sim_tape_wbwrite (uptr, uptr->pos + sizeof (t_mtrlnt) + sbc, &bc, sizeof (t_mtrlnt), 1) != MTSE_OK) ||
+            ferror (uptr->fileref)) {                   /* error? */
             MT_SET_PNU (uptr);
             return sim_tape_ioerr (uptr);
             }
@@ -2091,9 +3052,9 @@ switch (f) {                                            /* case on format */
 
     case MTUF_F_P7B:                                    /* Pierce 7B */
         buf[0] = buf[0] | P7B_SOR;                      /* mark start of rec */
-        (void)sim_fwrite (buf, sizeof (uint8), sbc, uptr->fileref);
-        (void)sim_fwrite (buf, sizeof (uint8), 1, uptr->fileref); /* delimit rec */
-        if (ferror (uptr->fileref)) {                   /* error? */
+        if ((sim_tape_wbwrite (uptr, uptr->pos, buf, sizeof (uint8), sbc) != MTSE_OK) ||
+            (sim_tape_wbwrite (uptr, uptr->pos + sbc, buf, sizeof (uint8), 1) != MTSE_OK) || /* delimit rec */
+            ferror (uptr->fileref)) {                   /* error? */
             MT_SET_PNU (uptr);
             return sim_tape_ioerr (uptr);
             }
@@ -2107,10 +3068,50 @@ switch (f) {                                            /* case on format */
         }
 if (uptr->pos > uptr->tape_eom)
     uptr->tape_eom = uptr->pos;         /* update EOM as needed */
+sim_tape_ra_invalidate (uptr);
+_sim_tape_index_trunc (uptr, start);
+_sim_tape_index_add (uptr, start, uptr->pos, FALSE);
 sim_tape_data_trace(uptr, buf, sbc, "Record Written", (uptr->dctrl | ctx->dptr->dctrl) & MTSE_DBG_DAT, MTSE_DBG_STR);
 return MTSE_OK;
 }
 
+t_stat sim_tape_wrrecf (UNIT *uptr, uint8 *buf, t_mtrlnt bc)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+t_uint64 start = sim_host_nsec ();
+t_stat st = _sim_tape_wrrecf (uptr, buf, bc);
+
+if (ctx) {
+    sim_latency_record (&ctx->write_host, sim_host_nsec () - start);
+    if (st == MTSE_OK)
+        ctx->write_bytes += MTR_L (bc);
+    }
+return st;
+}
+
+/* SHOW <dev> STATISTICS for an attached tape unit */
+
+t_bool sim_tape_show_statistics (FILE *st, UNIT *uptr, t_bool clear)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if (!(uptr->flags & UNIT_ATT) || (ctx == NULL))
+    return FALSE;
+fprintf (st, "%s: %.0f record reads (%.0f bytes), %.0f record writes (%.0f bytes)\n", sim_uname (uptr),
+             (double)ctx->read_host.count, (double)ctx->read_bytes,
+             (double)ctx->write_host.count, (double)ctx->write_bytes);
+sim_latency_fprint (st, "Read host time", &ctx->read_host);
+sim_latency_fprint (st, "Write host time", &ctx->write_host);
+sim_latency_fprint (st, "Queued for worker", &ctx->queued);
+if (clear) {
+    ctx->read_bytes = ctx->write_bytes = 0;
+    sim_latency_clear (&ctx->read_host);
+    sim_latency_clear (&ctx->write_host);
+    sim_latency_clear (&ctx->queued);
+    }
+return TRUE;
+}
+
 t_stat sim_tape_wrrecf_a (UNIT *uptr, uint8 *buf, t_mtrlnt bc, TAPE_PCALLBACK callback)
 {
 t_stat r = SCPE_OK;
@@ -2177,9 +3178,8 @@ if (ctx == NULL)                                        /* if not properly attac
     return sim_messagef (SCPE_IERR, "Bad Attach\n");    /*   that's a problem */
 if (sim_tape_wrp (uptr))                                /* write prot? */
     return MTSE_WRP;
-(void)sim_tape_seek (uptr, uptr->pos);                  /* set pos */
-(void)sim_fwrite (&dat, sizeof (t_mtrlnt), 1, uptr->fileref);
-if (ferror (uptr->fileref)) {                           /* error? */
+if ((sim_tape_wbwrite (uptr, uptr->pos, &dat, sizeof (t_mtrlnt), 1) != MTSE_OK) ||
+    ferror (uptr->fileref)) {                           /* error? */
     MT_SET_PNU (uptr);
     return sim_tape_ioerr (uptr);
     }
@@ -2195,6 +3195,8 @@ return MTSE_OK;
 t_stat sim_tape_wrtmk (UNIT *uptr)
 {
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+t_addr start = uptr->pos;
+t_stat r;
 
 if (ctx == NULL)                                        /* if not properly attached? */
     return sim_messagef (SCPE_IERR, "Bad Attach\n");    /*   that's a problem */
@@ -2204,8 +3206,14 @@ if (MT_GET_FMT (uptr) == MTUF_F_P7B) {                  /* P7B? */
     return sim_tape_wrrecf (uptr, &buf, 1);             /* write char */
     }
 if (MT_GET_FMT (uptr) == MTUF_F_AWS)                    /* AWS? */
-    return sim_tape_aws_wrdata (uptr, NULL, 0);
-return sim_tape_wrdata (uptr, MTR_TMK);
+    r = sim_tape_aws_wrdata (uptr, NULL, 0);
+else
+    r = sim_tape_wrdata (uptr, MTR_TMK);
+sim_tape_ra_invalidate (uptr);
+_sim_tape_index_trunc (uptr, start);
+if (r == MTSE_OK)
+    _sim_tape_index_add (uptr, start, uptr->pos, TRUE);
+return r;
 }
 
 t_stat sim_tape_wrtmk_a (UNIT *uptr, TAPE_PCALLBACK callback)
@@ -2231,6 +3239,8 @@ if (sim_tape_wrp (uptr))                                /* write prot? */
     return MTSE_WRP;
 if (MT_GET_FMT (uptr) == MTUF_F_P7B)                    /* cant do P7B */
     return MTSE_FMT;
+sim_tape_ra_invalidate (uptr);
+_sim_tape_index_trunc (uptr, uptr->pos);
 if (MT_GET_FMT (uptr) == MTUF_F_AWS) {
     sim_set_fsize (uptr->fileref, uptr->pos);
     result = MTSE_OK;
@@ -2394,10 +3404,14 @@ if ((uptr->flags & UNIT_ATT) == 0)                      /* if the unit is not at
 else if (sim_tape_wrp (uptr))                           /* otherwise if the unit is write protected */
     return MTSE_WRP;                                    /*   then we cannot write */
 
-else if (gap_size == 0 || format != MTUF_F_STD)         /* otherwise if zero length or gaps aren't supported */
+else if (gap_size == 0 ||                               /* otherwise if zero length */
+         ((format != MTUF_F_STD) && (format != MTUF_F_SIMHZ)))  /*   or gaps aren't supported */
     return MTSE_OK;                                     /*   then take no action */
 
+(void)sim_tape_wb_flush (uptr);                         /* pending writes count toward the size */
 file_size = sim_fsize (uptr->fileref);                  /* get the file size */
+sim_tape_ra_invalidate (uptr);
+_sim_tape_index_trunc (uptr, gap_pos);                  /* the gap overwrites what follows */
 
 if (sim_tape_seek (uptr, uptr->pos)) {                  /* position the tape; if it fails */
     MT_SET_PNU (uptr);                                  /*   then set position not updated */
@@ -2594,10 +3608,13 @@ if ((uptr->flags & UNIT_ATT) == 0)                      /* if the unit is not at
 else if (sim_tape_wrp (uptr))                           /* otherwise if the unit is write protected */
     return MTSE_WRP;                                    /*   then we cannot write */
 
-else if ((gap_size == 0) || (format != MTUF_F_STD))     /* otherwise if the gap length is zero or unsupported */
+else if ((gap_size == 0) ||                             /* otherwise if the gap length is zero */
+         ((format != MTUF_F_STD) && (format != MTUF_F_SIMHZ)))  /*   or unsupported */
     return MTSE_OK;                                     /*   then take no action */
 
 gap_pos = uptr->pos;                                    /* save the starting position */
+sim_tape_ra_invalidate (uptr);
+_sim_tape_index_trunc (uptr, (gap_pos > gap_size) ? gap_pos - gap_size : 0);
 
 if (gap_size == meta_size) {                            /* if the request is for a single metadatum */
     if (sim_tape_bot (uptr))                            /*   then if the unit is positioned at the BOT */
@@ -2839,6 +3856,9 @@ if (ctx == NULL)                                        /* if not properly attac
 sim_debug_unit (ctx->dbit, uptr, "sim_tape_sprecsf(unit=%d, count=%d)\n", (int)(uptr-ctx->dptr->units), count);
 
 while (*skipped < count) {                              /* loopo */
+    *skipped += _sim_tape_index_skip (uptr, FALSE, count - *skipped);
+    if (*skipped >= count)                              /* indexed records cover the rest? */
+        break;
     st = sim_tape_sprecf (uptr, &tbc);                  /* spc rec */
     if (st != MTSE_OK)
         return st;
@@ -2936,6 +3956,9 @@ if (ctx == NULL)                                        /* if not properly attac
 sim_debug_unit (ctx->dbit, uptr, "sim_tape_sprecsr(unit=%d, count=%d)\n", (int)(uptr-ctx->dptr->units), count);
 
 while (*skipped < count) {                              /* loopo */
+    *skipped += _sim_tape_index_skip (uptr, TRUE, count - *skipped);
+    if (*skipped >= count)                              /* indexed records cover the rest? */
+        break;
     st = sim_tape_sprecr (uptr, &tbc);                  /* spc rec rev */
     if (st != MTSE_OK)
         return st;
@@ -3181,6 +4204,7 @@ if (uptr->flags & UNIT_ATT) {
     }
 uptr->pos = 0;
 if (uptr->flags & UNIT_ATT) {
+    sim_tape_ra_invalidate (uptr);
     (void)sim_tape_seek (uptr, uptr->pos);
     }
 MT_CLR_PNU (uptr);
@@ -3325,7 +4349,8 @@ if (uptr->flags & UNIT_ATT)
 if (cptr == NULL)
     return SCPE_ARG;
 for (f = 0; fmts[f].name; f++) {
-    if (MATCH_CMD(fmts[f].name, cptr) == 0) {
+    if ((MATCH_CMD(fmts[f].name, cptr) == 0) &&
+        !isalnum (cptr[strlen (fmts[f].name)])) {       /* SIMH isn't a prefix of SIMHZ */
         uint32 a = 0;
 
         if (f == MTUF_F_ANSI) {
@@ -3497,6 +4522,7 @@ t_addr pos_r;
 t_addr pos_fa;
 t_addr pos_sa;
 t_mtrlnt max = MTR_MAXLEN;
+t_bool indexing;
 
 if (!(uptr->flags & UNIT_ATT))
     return SCPE_UNATT;
@@ -3516,13 +4542,17 @@ if (rec_sizes == NULL) {
     }
 
 r = sim_tape_rewind (uptr);
+indexing = _sim_tape_index_reset (uptr);
 while (r == SCPE_OK) {
     if (stop_cpu) { /* SIGINT? */
         stop_cpu = FALSE;
         break;
         }
     pos_f = uptr->pos;
-    r_f = sim_tape_rdrecf (uptr, buf_f, &bc_f, max);
+    if (MT_IS_MEMORY_TAPE (MT_GET_FMT (uptr)))      /* memory tapes are consistent by construction */
+        r_f = sim_tape_sprecf (uptr, &bc_f);        /*   and their data is read on demand */
+    else
+        r_f = sim_tape_rdrecf (uptr, buf_f, &bc_f, max);
     pos_fa = uptr->pos;
     switch (r_f) {
     case MTSE_OK:                                   /* no error */
@@ -3537,6 +4567,10 @@ while (r == SCPE_OK) {
                 ++unique_record_sizes;
             ++rec_sizes[bc_f];
             }
+        if (MT_IS_MEMORY_TAPE (MT_GET_FMT (uptr))) {
+            r = SCPE_OK;
+            break;
+            }
         r_r = sim_tape_rdrecr (uptr, buf_r, &bc_r, max);
         pos_r = uptr->pos;
         if (r_r != r_f) {
@@ -3557,7 +4591,7 @@ while (r == SCPE_OK) {
         memset (buf_f, 0, bc_f);
         memset (buf_r, 0, bc_r);
         if (pos_f != pos_r) {
-            if (MT_GET_FMT (uptr) == MTUF_F_STD) {
+            if ((MT_GET_FMT (uptr) == MTUF_F_STD) || (MT_GET_FMT (uptr) == MTUF_F_SIMHZ)) {
                 ++gaps;
                 gap_bytes += (uint32)(pos_r - pos_f);
                 }
@@ -3583,6 +4617,10 @@ while (r == SCPE_OK) {
             sim_printf ("Unexpected tape file position after forward and skip record: (%" T_ADDR_FMT "u, %" T_ADDR_FMT "u)\n", pos_fa, pos_sa);
             break;
             }
+        if (indexing && (pos_f == pos_r))               /* cleanly framed in both directions? */
+            indexing = _sim_tape_index_add (uptr, pos_f, pos_fa, (r_f == MTSE_TMK));
+        else
+            indexing = FALSE;                           /* index stops at the first gap */
         r = SCPE_OK;
         break;
     case MTSE_INVRL:                                /* invalid rec lnt */
@@ -3603,7 +4641,7 @@ while (r == SCPE_OK) {
 uptr->tape_eom = uptr->pos;
 if (!stop_cpu) {            /* if SIGINT didn't interrupt the scan */
     sim_messagef (SCPE_OK, "%s: Tape Image %s'%s' scanned as %s format\n", sim_uname (uptr),
-                           ((MT_GET_FMT (uptr) >= MTUF_F_ANSI) ? "made from " : ""), uptr->filename,
+                           (MT_IS_MEMORY_TAPE (MT_GET_FMT (uptr)) ? "made from " : ""), uptr->filename,
                            _sim_tape_format_name (uptr));
     remaining_data = (uint32)(sim_tape_size (uptr) - (t_offset)uptr->tape_eom);
     if ((r != MTSE_EOM) || (sim_switches & SWMASK ('V')) || (sim_switches & SWMASK ('L')) ||
@@ -3626,7 +4664,7 @@ if (!stop_cpu) {            /* if SIGINT didn't interrupt the scan */
             sim_messagef (SCPE_OK, "Read Tape Record Returned Unexpected Status: %s\n", sim_tape_error_text (r));
         if (remaining_data > fmts[MT_GET_FMT (uptr)].eom_remnant)
             sim_messagef (SCPE_OK, "%u %s of unexamined data remain in the tape image file\n",
-                                   remaining_data, (MT_GET_FMT (uptr) < MTUF_F_ANSI) ? "bytes" : "records");
+                                   remaining_data, !MT_IS_MEMORY_TAPE (MT_GET_FMT (uptr)) ? "bytes" : "records");
         }
     if (unique_record_sizes > 2 * tapemark_total) {
         sim_messagef (SCPE_OK, "A potentially unreasonable number of record sizes(%u) vs tape marks (%u) have been found\n", unique_record_sizes, tapemark_total);
@@ -4141,6 +5179,8 @@ sprintf (name, "%s.simh", filename);
 (void)remove (name);
 sprintf (name, "%s.2.simh", filename);
 (void)remove (name);
+sprintf (name, "%s.simhz", filename);
+(void)remove (name);
 sprintf (name, "%s.e11", filename);
 (void)remove (name);
 sprintf (name, "%s.2.e11", filename);
@@ -4291,6 +5331,126 @@ for (t = classify_tests; t->testname != NULL; t++) {
 return SCPE_OK;
 }
 
+/* Tape I/O benchmark
+
+   Drives the workload described by the BENCHMARK options through
+   sim_tape_rdrecf/sim_tape_wrrecf, or sim_tape_rdrecf_a/sim_tape_wrrecf_a
+   when ASYNC is requested.  SIZE is the record length written (reads
+   accept records of any length).  Tapes are only benchmarked
+   sequentially: a READ workload starts at BOT, skips tape marks and
+   rewinds whenever it reaches the end of the recorded data;  a WRITE
+   workload replaces the tape's contents (so it must be confirmed with
+   -F) with COUNT records followed by a tape mark and end of medium.
+   The tape is left rewound.
+
+   Asynchronous completions are dispatched as in sim_disk_benchmark. */
+
+static t_bool sim_tape_bench_done;
+static t_stat sim_tape_bench_stat;
+
+static void _sim_tape_bench_callback (UNIT *uptr, t_stat r)
+{
+sim_tape_bench_stat = r;
+sim_tape_bench_done = TRUE;
+}
+
+static t_stat _sim_tape_bench_io (UNIT *uptr, SIM_IO_BENCH *bp, uint8 *buf, t_mtrlnt *bc, t_mtrlnt max)
+{
+t_stat r;
+
+if (!bp->async)
+    return bp->write ? sim_tape_wrrecf (uptr, buf, *bc) : sim_tape_rdrecf (uptr, buf, bc, max);
+sim_tape_bench_done = FALSE;
+sim_tape_bench_stat = MTSE_OK;
+if (bp->write)
+    r = sim_tape_wrrecf_a (uptr, buf, *bc, &_sim_tape_bench_callback);
+else
+    r = sim_tape_rdrecf_a (uptr, buf, bc, max, &_sim_tape_bench_callback);
+#if defined (SIM_ASYNCH_IO)
+if (((struct tape_context *)uptr->tape_ctx)->asynch_io) {
+    _tape_cancel (uptr);                                /* wait for the worker */
+    while (!sim_tape_bench_done)                        /* then dispatch the completion */
+        AIO_UPDATE_QUEUE;
+    sim_cancel (uptr);
+    }
+#endif
+return sim_tape_bench_done ? sim_tape_bench_stat : r;
+}
+
+t_stat sim_tape_benchmark (UNIT *uptr, CONST char *cptr)
+{
+SIM_IO_BENCH bench;
+t_mtrlnt i, bc, max = MTR_MAXLEN;
+t_bool data_seen = FALSE;
+uint8 *buf;
+char title[CBUFSIZE];
+t_stat r;
+
+if (!(uptr->flags & UNIT_ATT) || (uptr->tape_ctx == NULL))
+    return sim_messagef (SCPE_UNATT, "%s: not attached\n", sim_uname (uptr));
+r = sim_io_bench_init (&bench, cptr, 1000, 512, MTR_MAXLEN);
+if (r != SCPE_OK)
+    return r;
+if (bench.random)
+    r = sim_messagef (SCPE_ARG, "%s: tapes can only be benchmarked sequentially\n", sim_uname (uptr));
+else if (bench.write && sim_tape_wrp (uptr))
+    r = sim_messagef (SCPE_RO, "%s: write protected\n", sim_uname (uptr));
+else if (bench.write && !(sim_switches & SWMASK ('F')))
+    r = sim_messagef (SCPE_ARG, "%s: a WRITE benchmark overwrites the tape, specify -F to proceed\n", sim_uname (uptr));
+else if (sim_is_active (uptr))
+    r = sim_messagef (SCPE_ARG, "%s: unit is busy\n", sim_uname (uptr));
+if (r != SCPE_OK) {
+    sim_io_bench_free (&bench);
+    return r;
+    }
+buf = (uint8 *)malloc (bench.write ? bench.size : max);
+if (buf == NULL) {
+    sim_io_bench_free (&bench);
+    return SCPE_MEM;
+    }
+if (bench.write)
+    for (i = 0; i < bench.size; i++)
+        buf[i] = (uint8)i;
+#if defined (SIM_ASYNCH_IO)
+if (bench.async && !((struct tape_context *)uptr->tape_ctx)->asynch_io)
+    sim_printf ("%s: asynchronous I/O is disabled, ASYNC requests will complete synchronously\n", sim_uname (uptr));
+#endif
+sim_tape_rewind (uptr);
+while (bench.done < bench.count) {
+    bc = bench.size;
+    sim_io_bench_start (&bench);
+    r = _sim_tape_bench_io (uptr, &bench, buf, &bc, max);
+    if (!bench.write) {
+        if (r == MTSE_TMK)                              /* skip tape marks */
+            continue;
+        if ((r == MTSE_EOM) || (r == MTSE_LEOT)) {      /* end of data? */
+            if (!data_seen)
+                break;
+            sim_tape_rewind (uptr);                     /* start over */
+            continue;
+            }
+        data_seen = TRUE;
+        }
+    sim_io_bench_stop (&bench, (r == MTSE_OK) ? bc : 0, (r == MTSE_OK) ? SCPE_OK : SCPE_IOERR);
+    }
+if (bench.write) {
+    sim_tape_wrtmk (uptr);
+    sim_tape_wreom (uptr);
+    }
+sim_tape_rewind (uptr);
+if (!bench.write && !data_seen)
+    r = sim_messagef (SCPE_FMT, "%s: tape contains no data records\n", sim_uname (uptr));
+else {
+    if (bench.write)
+        snprintf (title, sizeof (title), "%s benchmark of %s (%u byte records):", sim_uname (uptr), uptr->filename, (uint32)bench.size);
+    else
+        snprintf (title, sizeof (title), "%s benchmark of %s:", sim_uname (uptr), uptr->filename);
+    sim_io_bench_report (&bench, title);
+    }
+free (buf);
+sim_io_bench_free (&bench);
+return r;
+}
 
 #include <setjmp.h>
 
@@ -4364,6 +5524,14 @@ SIM_TEST(sim_tape_test_process_tape_file (dptr->units, "TapeTestFile1", "e11", 0
 sim_switches = saved_switches;
 SIM_TEST(sim_tape_test_process_tape_file (dptr->units, "TapeTestFile1", "simh", 0));
 
+#if defined (SIM_TAPE_SIMHZ)
+sim_switches = saved_switches | SWMASK ('X') | SWMASK ('Z');    /* convert the SIMH image to SIMHZ */
+SIM_TEST(sim_tape_test_process_tape_file (dptr->units, "TapeTestFile1.simhz TapeTestFile1", "simh", 0));
+
+sim_switches = saved_switches;
+SIM_TEST(sim_tape_test_process_tape_file (dptr->units, "TapeTestFile1", "simhz", 0));
+#endif
+
 sim_switches = saved_switches;
 if ((sim_switches & SWMASK ('D')) == 0)
     SIM_TEST(sim_tape_test_remove_tape_files (dptr->units, "TapeTestFile1"));
@@ -4546,30 +5714,247 @@ static void ansi_fill_text_buffer (FILE *f, char *buf, size_t buf_size, size_t r
     free (tmp);
     }
 
+static const uint8 ascii2ebcdic[128] = {
+    0000,0001,0002,0003,0067,0055,0056,0057,
+    0026,0005,0045,0013,0014,0015,0016,0017,
+    0020,0021,0022,0023,0074,0075,0062,0046,
+    0030,0031,0077,0047,0034,0035,0036,0037,
+    0100,0117,0177,0173,0133,0154,0120,0175,
+    0115,0135,0134,0116,0153,0140,0113,0141,
+    0360,0361,0362,0363,0364,0365,0366,0367,
+    0370,0371,0172,0136,0114,0176,0156,0157,
+    0174,0301,0302,0303,0304,0305,0306,0307,
+    0310,0311,0321,0322,0323,0324,0325,0326,
+    0327,0330,0331,0342,0343,0344,0345,0346,
+    0347,0350,0351,0112,0340,0132,0137,0155,
+    0171,0201,0202,0203,0204,0205,0206,0207,
+    0210,0211,0221,0222,0223,0224,0225,0226,
+    0227,0230,0231,0242,0243,0244,0245,0246,
+    0247,0250,0251,0300,0152,0320,0241,0007};
+
+/* Make a FIXED format record from a line of text */
+
+static void fixed_text_record (uint8 *block, const char *line, uint32 block_size, t_bool ebcdic)
+{
+size_t len = strlen (line);
+
+while ((len > 0) && 
+       ((line[len - 1] == '\r') || (line[len - 1] == '\n')))
+    --len;
+if (len > block_size)
+    len = block_size;
+memcpy (block, line, len);
+memset (block + len, ' ', block_size - len);
+if (ebcdic) {
+    uint32 i;
+
+    for (i = 0; i < block_size; i++)
+        block[i] = ascii2ebcdic[block[i] & 0x7F];
+    }
+}
+
+static void memory_tape_free_source (TAPE_SOURCE *src)
+{
+if (src == NULL)
+    return;
+free (src->offsets);
+free (src->filename);
+free (src);
+}
+
+static TAPE_EXTENT *memory_tape_new_extent (MEMORY_TAPE *tape)
+{
+TAPE_EXTENT *ext;
+
+if (tape->array_size <= tape->extent_count) {
+    TAPE_EXTENT *new_extents;
+    new_extents = (TAPE_EXTENT *)realloc (tape->extents, (tape->array_size + 1000) * sizeof (*tape->extents));
+    if (new_extents == NULL)
+        return NULL;                /* no memory error */
+    tape->extents = new_extents;
+    memset (tape->extents + tape->array_size, 0, 1000 * sizeof (*tape->extents));
+    tape->array_size += 1000;
+    }
+ext = &tape->extents[tape->extent_count];
+ext->first = tape->record_count;
+return ext;
+}
+
 static t_bool memory_tape_add_block (MEMORY_TAPE *tape, uint8 *block, uint32 size)
 {
+TAPE_EXTENT *ext;
 TAPE_RECORD *rec;
 
 ASSURE((size == 0) == (block == NULL));
 
-if (tape->array_size <= tape->record_count) {
-    TAPE_RECORD **new_records;
-    new_records = (TAPE_RECORD **)realloc (tape->records, (tape->array_size + 1000) * sizeof (*tape->records));
-    if (new_records == NULL)
-        return TRUE;                /* no memory error */
-    tape->records = new_records;
-    memset (tape->records + tape->array_size, 0, 1000 * sizeof (*tape->records));
-    tape->array_size += 1000;
-    }
+ext = memory_tape_new_extent (tape);
+if (ext == NULL)
+    return TRUE;                    /* no memory error */
 rec = (TAPE_RECORD *)malloc (sizeof (*rec) + size);
 if (rec == NULL)
     return TRUE;                    /* no memory error */
 rec->size = size;
 memcpy (rec->data, block, size);
-tape->records[tape->record_count++] = rec;
+ext->rec = rec;
+ext->count = 1;
+++tape->extent_count;
+++tape->record_count;
 return FALSE;
 }
 
+/* Add count data records read from src when they're needed.  The tape
+   owns src from here on, even if an error is returned. */
+
+static t_bool memory_tape_add_source (MEMORY_TAPE *tape, TAPE_SOURCE *src, uint32 count)
+{
+TAPE_EXTENT *ext = memory_tape_new_extent (tape);
+
+if (ext == NULL) {
+    memory_tape_free_source (src);
+    return TRUE;                    /* no memory error */
+    }
+ext->src = src;
+ext->count = count;
+++tape->extent_count;
+tape->record_count += count;
+return FALSE;
+}
+
+static TAPE_SOURCE *memory_tape_new_source (const char *filename, uint32 type, uint32 block_size)
+{
+TAPE_SOURCE *src = (TAPE_SOURCE *)calloc (1, sizeof (*src));
+
+if (src == NULL)
+    return NULL;
+src->filename = (char *)malloc (strlen (filename) + 1);
+if (src->filename == NULL) {
+    free (src);
+    return NULL;
+    }
+strcpy (src->filename, filename);
+src->type = type;
+src->block_size = block_size;
+return src;
+}
+
+/* Record the starting position of text block n of src */
+
+static t_bool memory_tape_source_offset (TAPE_SOURCE *src, uint32 n, t_offset offset)
+{
+if ((n & (n - 1)) == 0) {           /* 0 or a power of 2? grow the array */
+    t_offset *new_offsets = (t_offset *)realloc (src->offsets, (n ? 2 * n : 1) * sizeof (*src->offsets));
+
+    if (new_offsets == NULL)
+        return TRUE;                /* no memory error */
+    src->offsets = new_offsets;
+    }
+src->offsets[n] = offset;
+return FALSE;
+}
+
+static TAPE_EXTENT *memory_tape_find_extent (MEMORY_TAPE *tape, uint32 recnum)
+{
+TAPE_EXTENT *ext = &tape->extents[tape->last_extent];
+uint32 lo, hi;
+
+if ((recnum >= ext->first) && (recnum < ext->first + ext->count))
+    return ext;                     /* sequential access stays in one extent */
+lo = 0;
+hi = tape->extent_count - 1;
+while (lo < hi) {                   /* last extent starting at or before recnum */
+    uint32 mid = lo + (hi - lo + 1) / 2;
+
+    if (tape->extents[mid].first <= recnum)
+        lo = mid;
+    else
+        hi = mid - 1;
+    }
+tape->last_extent = lo;
+return &tape->extents[lo];
+}
+
+static uint32 memory_tape_source_size (TAPE_SOURCE *src, uint32 n)
+{
+t_offset remaining;
+uint32 size, runt;
+
+if (src->type != SRC_BINARY)
+    return src->block_size;
+remaining = src->size - (t_offset)n * src->block_size;
+size = (remaining < (t_offset)src->block_size) ? (uint32)remaining : src->block_size;
+if (src->record_size > 0) {         /* Pad short records with zeros */
+    runt = size % src->record_size;
+    if (runt > 0)
+        size += src->record_size - runt;
+    }
+return size;
+}
+
+static uint32 memory_tape_record_size (MEMORY_TAPE *tape, uint32 recnum)
+{
+TAPE_EXTENT *ext = memory_tape_find_extent (tape, recnum);
+
+if (ext->rec)
+    return ext->rec->size;
+return memory_tape_source_size (ext->src, recnum - ext->first);
+}
+
+/* Read a record's data, returns TRUE if the source file couldn't be read
+   (the missing data reads as zeros) */
+
+static t_bool memory_tape_read_record (MEMORY_TAPE *tape, uint32 recnum, uint8 *buf)
+{
+TAPE_EXTENT *ext = memory_tape_find_extent (tape, recnum);
+TAPE_SOURCE *src = ext->src;
+uint32 n = recnum - ext->first;
+uint32 size;
+size_t data_size;
+
+if (ext->rec) {
+    memcpy (buf, ext->rec->data, ext->rec->size);
+    return FALSE;
+    }
+size = memory_tape_source_size (src, n);
+memset (buf, 0, size);
+if (tape->src_open != src) {        /* one source file is kept open */
+    if (tape->src_file)
+        fclose (tape->src_file);
+    tape->src_open = NULL;
+    tape->src_file = fopen (src->filename, "rb");
+    if (tape->src_file == NULL)
+        return TRUE;
+    tape->src_open = src;
+    }
+switch (src->type) {
+    case SRC_BINARY:
+        if (0 != sim_fseeko (tape->src_file, (t_offset)n * src->block_size, SEEK_SET))
+            return TRUE;
+        data_size = src->block_size;
+        if ((t_offset)data_size > src->size - (t_offset)n * src->block_size)
+            data_size = (size_t)(src->size - (t_offset)n * src->block_size);
+        return (fread (buf, 1, data_size, tape->src_file) < data_size);
+
+    case SRC_ANSI_TEXT:
+        if (0 != sim_fseeko (tape->src_file, src->offsets[n], SEEK_SET))
+            return TRUE;
+        ansi_fill_text_buffer (tape->src_file, (char *)buf, src->block_size, src->skip, src->fixed_text);
+        return FALSE;
+
+    case SRC_FIXED_TEXT:
+        if (tape->src_line == NULL) {
+            tape->src_line = (char *)calloc (1, tape->block_size + 3);
+            if (tape->src_line == NULL)
+                return TRUE;
+            }
+        if ((0 != sim_fseeko (tape->src_file, src->offsets[n], SEEK_SET)) ||
+            (NULL == fgets (tape->src_line, src->block_size + 3, tape->src_file)))
+            return TRUE;
+        fixed_text_record (buf, tape->src_line, src->block_size, src->ebcdic);
+        return FALSE;
+    }
+return TRUE;
+}
+
 static void memory_free_tape (void *vtape)
 {
 uint32 i;
@@ -4577,11 +5962,14 @@ MEMORY_TAPE *tape = (MEMORY_TAPE *)vtape;
 
 if (tape == NULL)
     return;
-for (i = 0; i < tape->record_count; i++) {
-    free (tape->records[i]);
-    tape->records[i] = NULL;
+for (i = 0; i < tape->extent_count; i++) {
+    free (tape->extents[i].rec);
+    memory_tape_free_source (tape->extents[i].src);
     }
-free (tape->records);
+free (tape->extents);
+if (tape->src_file)
+    fclose (tape->src_file);
+free (tape->src_line);
 free (tape);
 }
 
@@ -4748,17 +6136,21 @@ hdr.fname3 = dos11_ascR50 (&fname[6]);
 memory_tape_add_block (tape, (uint8 *)&hdr, sizeof (hdr));
 
 rewind (f);
-block = (uint8 *)calloc (tape->block_size, 1);
 
-if (lf_line_endings || crlf_line_endings)
+if (lf_line_endings || crlf_line_endings) {
+    block = (uint8 *)calloc (tape->block_size, 1);
     error = dos11_copy_ascii_file (f, tape, (char *)block, tape->block_size);
-else {
-    size_t data_read;
-
-    while (!feof (f) && !error) {
-        data_read = fread (block, 1, tape->block_size, f);
-        if (data_read > 0)
-            error = memory_tape_add_block (tape, block, data_read);
+    }
+else {                                  /* binary data is read when needed */
+    TAPE_SOURCE *src = memory_tape_new_source (FullPath, SRC_BINARY, tape->block_size);
+
+    error = (src == NULL);
+    if (!error) {
+        src->size = sim_fsize_ex (f);
+        if (src->size > 0)
+            error = memory_tape_add_source (tape, src, (uint32)((src->size + tape->block_size - 1) / tape->block_size));
+        else
+            memory_tape_free_source (src);
         }
     } 
 
@@ -4886,6 +6278,7 @@ HDR1 hdr1;
 HDR2 hdr2;
 HDR3 hdr3;
 HDR4 hdr4;
+TAPE_SOURCE *src = NULL;
 
 f = tape_open_and_check_file (filename);
 if (f == NULL)
@@ -4959,37 +6352,37 @@ if ((0 != memcmp (hdr4.extra_name_used, "00", 2)) && !(ansi->nohdr3) && !(ansi->
     memory_tape_add_block (tape, (uint8 *)&hdr4, sizeof (hdr4));
 memory_tape_add_block (tape, NULL, 0);        /* Tape Mark */
 rewind (f);
-block = (uint8 *)calloc (tape->block_size, 1);
-while (!feof (f) && !error) {
-    size_t data_read = tape->block_size;
-
-    if (lf_line_endings || crlf_line_endings)           /* Text file? */
-        ansi_fill_text_buffer (f, (char *)block, tape->block_size, 
-                               crlf_line_endings ? ansi->skip_crlf_line_endings : ansi->skip_lf_line_endings, 
-                               ansi->fixed_text);
-
-    else {                                              /* Binary file */
-        size_t runt = 0;
-
-        data_read = fread (block, 1, tape->block_size, f);
-        if (max_record_size > 0)                /* always will be true but XCode thinks otherwise */
-            runt = data_read % max_record_size; /* data_read (=0) % anypositivenumber == 0 */
-        /* Pad short records with zeros */
-        if (runt > 0) {
-            size_t nPad = max_record_size - runt;
-            memset (block + data_read, 0, nPad);
-            data_read += nPad;
-            }
+if (lf_line_endings || crlf_line_endings) {             /* Text file? */
+    src = memory_tape_new_source (filename, SRC_ANSI_TEXT, tape->block_size);
+    block = (uint8 *)calloc (tape->block_size, 1);
+    error = ((src == NULL) || (block == NULL));
+    if (!error) {
+        src->skip = (uint32)(crlf_line_endings ? ansi->skip_crlf_line_endings : ansi->skip_lf_line_endings);
+        src->fixed_text = ansi->fixed_text;
         }
-
-    if (data_read > 0) {
-        error = memory_tape_add_block (tape, block, data_read);
-        if (!error)
+    while (!feof (f) && !error) {                       /* find where each block starts */
+        error = memory_tape_source_offset (src, block_count, (t_offset)ftell (f));
+        if (!error) {
+            ansi_fill_text_buffer (f, (char *)block, tape->block_size, src->skip, src->fixed_text);
             ++block_count;
+            }
+        }
+    }
+else {                                                  /* Binary file */
+    src = memory_tape_new_source (filename, SRC_BINARY, tape->block_size);
+    error = (src == NULL);
+    if (!error) {
+        src->size = sim_fsize_ex (f);
+        src->record_size = (uint32)max_record_size;     /* Pad short records with zeros */
+        block_count = (int)((src->size + tape->block_size - 1) / tape->block_size);
         }
     }
 fclose (f);
 free (block);
+if ((block_count > 0) && !error)                        /* data is read when needed */
+    error = memory_tape_add_source (tape, src, (uint32)block_count);
+else
+    memory_tape_free_source (src);
 memory_tape_add_block (tape, NULL, 0);        /* Tape Mark */
 memcpy (hdr1.type, "EOF", sizeof (hdr1.type));
 memcpy (hdr2.type, "EOF", sizeof (hdr2.type));
@@ -5037,9 +6430,24 @@ t_mtrlnt max = MTR_MAXLEN;
 
 if ((export_file == NULL) || (*export_file == '\0'))
     return sim_messagef (SCPE_ARG, "Missing tape export file specification\n");
-f = fopen (export_file, "wb");
+#if !defined (SIM_TAPE_SIMHZ)
+if (sim_switches & SWMASK ('Z'))
+    return sim_messagef (SCPE_NOFNC, "SIMHZ format tapes are not supported by this build\n");
+#endif
+f = fopen (export_file, (sim_switches & SWMASK ('Z')) ? "wb+" : "wb");
 if (f == NULL)
     return sim_messagef (SCPE_OPENERR, "Can't open SIMH tape image file: %s - %s\n", export_file, strerror (errno));
+#if defined (SIM_TAPE_SIMHZ)
+if (sim_switches & SWMASK ('Z')) {                      /* compressed export? */
+    FILE *zf = sim_tape_simhz_open (f, TRUE, NULL);
+
+    if (zf == NULL) {
+        fclose (f);
+        return sim_messagef (SCPE_IOERR, "Can't create SIMHZ tape image file: %s\n", export_file);
+        }
+    f = zf;
+    }
+#endif
 
 buf = (uint8 *)calloc (max, 1);
 if (buf == NULL) {
@@ -5075,7 +6483,8 @@ while (r == SCPE_OK) {
 if (r == MTSE_EOM)
     r = SCPE_OK;
 free (buf);
-fclose (f);
+if ((fclose (f) != 0) && (r == SCPE_OK))                /* SIMHZ writes its index on close */
+    r = sim_messagef (SCPE_IOERR, "Error writing file: %s - %s\n", export_file, strerror (errno));
 uptr->pos = saved_pos;
 return r;
 }
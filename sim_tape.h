@@ -99,10 +99,12 @@ typedef struct {
 #define MTUF_F_P7B      3                               /* P7B format */
 #define MTUF_F_AWS      4                               /* AWS format */
 #define MTUF_F_TAR      5                               /* TAR format */
-/* MT_GET_FMT() >= MTUF_F_ANSI is a MEMORY_TAPE image */
+/* MT_IS_MEMORY_TAPE(MT_GET_FMT()) is a MEMORY_TAPE image */
 #define MTUF_F_ANSI     6                               /* ANSI format */
 #define MTUF_F_FIXED    7                               /* FIXED format */
 #define MTUF_F_DOS11    8                               /* DOS11 format */
+#define MTUF_F_SIMHZ    9                               /* compressed SIMH format */
+#define MT_IS_MEMORY_TAPE(f) (((f) >= MTUF_F_ANSI) && ((f) <= MTUF_F_DOS11))
 
 #define MTAT_F_VMS      0                               /* VMS ANSI type */
 #define MTAT_F_RSX11    1                               /* RSX-11 ANSI type */
@@ -232,9 +234,11 @@ t_stat sim_tape_set_dens (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat sim_tape_show_dens (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat sim_tape_density_supported (char *string, size_t string_size, int32 valid_bits);
 const char *sim_tape_error_text (t_stat stat);
+t_bool sim_tape_show_statistics (FILE *st, UNIT *uptr, t_bool clear);
 t_stat sim_tape_set_asynch (UNIT *uptr, int latency);
 t_stat sim_tape_clr_asynch (UNIT *uptr);
 t_stat sim_tape_test (DEVICE *dptr, const char *cptr);
+t_stat sim_tape_benchmark (UNIT *uptr, CONST char *cptr);
 t_stat sim_tape_add_debug (DEVICE *dptr);
 
 #ifdef  __cplusplus
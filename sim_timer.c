@@ -64,6 +64,7 @@
    sim_rtc_init -           initialize calibration
    sim_rtc_calb -           calibrate clock
    sim_idle -               virtual machine idle
+   sim_idle_spin -          idle a detected spin loop
    sim_os_msec  -           return elapsed time in msec
    sim_os_sleep -           sleep specified number of seconds
    sim_os_ms_sleep -        sleep specified number of milliseconds
@@ -147,7 +148,18 @@ return real_sim_os_ms_sleep (msec);
 
 #endif /* defined(MS_MIN_GRANULARITY) && (MS_MIN_GRANULARITY != 1) */
 
+/* Tickless idling sleeps for precisely the time until the next event    */
+/* (rather than a whole number of minimum host sleep intervals) in a     */
+/* wait which asynchronous I/O completions can end early.                */
+#if defined(SIM_ASYNCH_IO) && !(defined(MS_MIN_GRANULARITY) && (MS_MIN_GRANULARITY != 1))
+#define SIM_IDLE_TICKLESS 1
+#define SIM_IDLE_MIN_US   100               /* shorter waits aren't worth a sleep */
+static t_bool sim_idle_tickless = TRUE;
+static uint32 _sim_idle_us_sleep (uint32 usec);
+#endif
+
 t_bool sim_idle_enab = FALSE;                       /* global flag */
+t_bool sim_idle_spin_enab = FALSE;                  /* spin loop detection flag */
 volatile t_bool sim_idle_wait = FALSE;              /* global flag */
 
 int32 sim_vm_initial_ips = SIM_INITIAL_IPS;
@@ -166,6 +178,16 @@ static uint32 sim_os_clock_resoluton_ms = 0;
 static uint32 sim_os_tick_hz = 0;
 static uint32 sim_idle_stable = SIM_IDLE_STDFLT;
 static uint32 sim_idle_calib_pct = 100;
+static uint32 sim_idle_spin_iters = SIM_IDLE_SPIN_ITERS;/* iterations which make a spin loop */
+static t_addr sim_idle_spin_pc = 0;                 /* loop being watched */
+static uint32 sim_idle_spin_state = 0;              /* its state signature */
+static uint32 sim_idle_spin_count = 0;              /* unchanged iterations seen */
+static uint32 sim_idle_spin_detects = 0;            /* spin loops detected */
+static uint32 sim_idle_spin_idles = 0;              /* detections which idled */
+static t_bool sim_fastforward = FALSE;              /* clocks run on virtual time */
+static uint32 sim_fastforward_ips = 0;              /* virtual instructions per second */
+static double sim_fastforward_skipped = 0;          /* instructions skipped while idle */
+static t_bool sim_fastboot_active = FALSE;          /* fast forward started for a boot ROM */
 static double sim_timer_stop_time = 0;
 static uint32 sim_rom_delay = 0;
 static uint32 sim_throt_ms_start = 0;
@@ -180,6 +202,14 @@ static double sim_throt_inst_start;
 static uint32 sim_throt_sleep_time = 0;
 static int32 sim_throt_wait = 0;
 static uint32 sim_throt_delay = 3;
+static double sim_throt_pi_integral = 0;            /* accumulated pacing error (ns) */
+static t_uint64 sim_throt_pi_ns = 0;                /* end of last pacing wait (ns) */
+static double sim_throt_pi_inst = 0;                /* sim_gtime() at sim_throt_pi_ns */
+static double sim_throt_achieved_inst = 0;          /* smoothed instructions per interval */
+static double sim_throt_achieved_ns = 0;            /* smoothed interval length (ns) */
+static double sim_throt_jitter_ns = 0;              /* smoothed pacing interval error */
+static void _sim_throt_pace_reset (void);
+static double _sim_throt_desired_cps (void);
 #define CLK_TPS 100
 #define CLK_INIT (sim_precalibrate_ips/CLK_TPS)
 static int32 sim_int_clk_tps;
@@ -240,7 +270,6 @@ t_bool sim_asynch_timer = FALSE;
 
 #if defined (SIM_ASYNCH_CLOCKS)
 UNIT * volatile sim_wallclock_queue = QUEUE_LIST_END;
-UNIT * volatile sim_wallclock_entry = NULL;
 #endif
 
 #define sleep1Samples       100
@@ -285,26 +314,29 @@ return sim_os_sleep_min_ms;
 #endif /* defined(MS_MIN_GRANULARITY) && (MS_MIN_GRANULARITY != 1) */
 
 #if defined(SIM_ASYNCH_IO)
-uint32 sim_idle_ms_sleep (unsigned int msec)
+static uint32 _sim_idle_us_sleep (uint32 usec)
 {
 struct timespec start_time, end_time, done_time, delta_time;
-uint32 delta_ms;
+uint32 delta_us;
 t_bool timedout = FALSE;
 
 clock_gettime(CLOCK_REALTIME, &start_time);
 end_time = start_time;
-end_time.tv_sec += (msec/1000);
-end_time.tv_nsec += 1000000*(msec%1000);
+end_time.tv_sec += (usec/1000000);
+end_time.tv_nsec += 1000*(usec%1000000);
 if (end_time.tv_nsec >= 1000000000) {
   end_time.tv_sec += end_time.tv_nsec/1000000000;
   end_time.tv_nsec = end_time.tv_nsec%1000000000;
   }
 pthread_mutex_lock (&sim_asynch_lock);
 sim_idle_wait = TRUE;
-if (pthread_cond_timedwait (&sim_asynch_wake, &sim_asynch_lock, &end_time))
-    timedout = TRUE;
+if (sim_asynch_queue != QUEUE_LIST_END)   /* doorbell already rung? */
+    sim_asynch_check = 0;                 /* just go process it */
 else
-    sim_asynch_check = 0;                 /* force check of asynch queue now */
+    if (pthread_cond_timedwait (&sim_asynch_wake, &sim_asynch_lock, &end_time))
+        timedout = TRUE;
+    else
+        sim_asynch_check = 0;             /* force check of asynch queue now */
 sim_idle_wait = FALSE;
 pthread_mutex_unlock (&sim_asynch_lock);
 clock_gettime(CLOCK_REALTIME, &done_time);
@@ -312,8 +344,13 @@ if (!timedout) {
     AIO_UPDATE_QUEUE;
     }
 sim_timespec_diff (&delta_time, &done_time, &start_time);
-delta_ms = (uint32)((delta_time.tv_sec * 1000) + ((delta_time.tv_nsec + 500000) / 1000000));
-return delta_ms;
+delta_us = (uint32)((delta_time.tv_sec * 1000000) + ((delta_time.tv_nsec + 500) / 1000));
+return delta_us;
+}
+
+uint32 sim_idle_ms_sleep (unsigned int msec)
+{
+return (_sim_idle_us_sleep (msec * 1000) + 500) / 1000;
 }
 #else
 uint32 sim_idle_ms_sleep (unsigned int msec)
@@ -722,6 +759,287 @@ return SCPE_OK;
 }
 #endif
 
+/* Thread placement
+
+   The host threads of a simulator are grouped into classes: the
+   instruction execution thread (which also runs the command interpreter),
+   the I/O threads (the disk and tape I/O pool, network readers and
+   writers and multiplexer polling) and the wall clock timer thread.
+   Each class can be restricted to a set of host processors and given a
+   priority with SET ASYNCH.  A thread applies the settings for its class
+   by calling sim_os_set_thread_placement when it starts.  Settings for
+   the instruction execution thread take effect immediately, and the
+   long lived I/O pool threads pick up changes when they next have work.
+
+   A NUMA node (NODEn) may be given in place of a processor list.  For
+   the instruction execution thread, this also makes the node the
+   preferred one for process memory, and moves memory already allocated
+   (simulated memory included) to it.
+*/
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#define SIM_MAX_HOST_CPUS       1024
+#define SIM_MAX_HOST_NODES      64
+#define PRIORITY_UNCHANGED      2
+
+typedef struct {
+    const char  *name;                                  /* keyword prefix */
+    const char  *desc;                                  /* description */
+    t_bool      placed;                                 /* affinity specified */
+    int         node;                                   /* NUMA node or -1 */
+    int         priority;                               /* PRIORITY_xxx */
+    uint8       cpus[SIM_MAX_HOST_CPUS / 8];            /* processor bitmap */
+    } SIM_THREAD_PLACE;
+
+static SIM_THREAD_PLACE sim_thread_place[SIM_THREAD_CLASSES] = {
+    { "CPU",   "Instruction execution thread", FALSE, -1, PRIORITY_UNCHANGED },
+    { "IO",    "I/O threads",                  FALSE, -1, PRIORITY_ABOVE_NORMAL },
+    { "TIMER", "Wall clock timer thread",      FALSE, -1, PRIORITY_UNCHANGED }
+    };
+
+volatile uint32 sim_thread_placement_gen = 0;           /* bumped on any change */
+
+static t_stat _sim_os_set_thread_affinity (const uint8 *cpus)
+{
+#if defined(__linux__) && defined(_GNU_SOURCE) && defined(CPU_SET)
+cpu_set_t set;
+int i;
+
+CPU_ZERO (&set);
+for (i = 0; (i < SIM_MAX_HOST_CPUS) && (i < CPU_SETSIZE); i++)
+    if (cpus[i >> 3] & (1 << (i & 7)))
+        CPU_SET (i, &set);
+return (sched_setaffinity (0, sizeof (set), &set) == 0) ? SCPE_OK : SCPE_IERR;
+#elif defined(_WIN32)
+DWORD_PTR mask = 0;
+int i;
+
+for (i = 0; i < (int)(8 * sizeof (mask)); i++)
+    if (cpus[i >> 3] & (1 << (i & 7)))
+        mask |= ((DWORD_PTR)1) << i;
+return (SetThreadAffinityMask (GetCurrentThread (), mask) != 0) ? SCPE_OK : SCPE_IERR;
+#else
+return SCPE_NOFNC;
+#endif
+}
+
+static t_stat _sim_os_bind_memory (int node)
+{
+#if defined(__linux__) && defined(SYS_set_mempolicy) && defined(SYS_migrate_pages)
+unsigned long new_nodes[SIM_MAX_HOST_NODES / (8 * sizeof (unsigned long))];
+unsigned long old_nodes[SIM_MAX_HOST_NODES / (8 * sizeof (unsigned long))];
+const int bits = 8 * sizeof (unsigned long);
+
+memset (new_nodes, 0, sizeof (new_nodes));
+memset (old_nodes, 0xFF, sizeof (old_nodes));
+new_nodes[node / bits] |= 1UL << (node % bits);
+if (syscall (SYS_set_mempolicy, 1 /* MPOL_PREFERRED */, new_nodes, (unsigned long)SIM_MAX_HOST_NODES))
+    return SCPE_IERR;
+if (syscall (SYS_migrate_pages, 0, (unsigned long)SIM_MAX_HOST_NODES, old_nodes, new_nodes) < 0)
+    return SCPE_IERR;
+return SCPE_OK;
+#else
+return SCPE_NOFNC;
+#endif
+}
+
+t_stat sim_os_set_thread_placement (int thread_class)
+{
+SIM_THREAD_PLACE *tp;
+
+if ((thread_class < 0) || (thread_class >= SIM_THREAD_CLASSES))
+    return SCPE_ARG;
+tp = &sim_thread_place[thread_class];
+if (tp->priority != PRIORITY_UNCHANGED)
+    sim_os_set_thread_priority (tp->priority);
+if (!tp->placed)
+    return SCPE_OK;
+return _sim_os_set_thread_affinity (tp->cpus);
+}
+
+/* Parse a processor list (n, n-m, separated by commas) into a bitmap */
+
+static t_stat _sim_parse_cpu_list (const char *cptr, uint8 *cpus)
+{
+unsigned long lo, hi;
+char *end;
+
+memset (cpus, 0, SIM_MAX_HOST_CPUS / 8);
+while (*cptr) {
+    if (!sim_isdigit (*cptr))
+        return SCPE_ARG;
+    lo = hi = strtoul (cptr, &end, 10);
+    if (*end == '-') {
+        if (!sim_isdigit (end[1]))
+            return SCPE_ARG;
+        hi = strtoul (end + 1, &end, 10);
+        }
+    if ((lo > hi) || (hi >= SIM_MAX_HOST_CPUS))
+        return SCPE_ARG;
+    while (*end && sim_isspace (*end))
+        ++end;
+    if (*end == ',')
+        ++end;
+    else if (*end)
+        return SCPE_ARG;
+    for ( ; lo <= hi; lo++)
+        cpus[lo >> 3] |= (uint8)(1 << (lo & 7));
+    cptr = end;
+    }
+return SCPE_OK;
+}
+
+static t_stat _sim_node_cpus (int node, uint8 *cpus)
+{
+char path[PATH_MAX + 1], list[CBUFSIZE];
+FILE *f;
+
+snprintf (path, sizeof (path), "/sys/devices/system/node/node%d/cpulist", node);
+f = fopen (path, "r");
+if (f == NULL)
+    return sim_messagef (SCPE_ARG, "NUMA node %d is not available on this host\n", node);
+if (fgets (list, sizeof (list), f) == NULL)
+    list[0] = '\0';
+fclose (f);
+list[strcspn (list, "\r\n")] = '\0';
+return _sim_parse_cpu_list (list, cpus);
+}
+
+/* Set thread placement: SET ASYNCH {class}AFFINITY=list|NODEn|ALL
+                                    {class}PRIORITY=BELOW|NORMAL|ABOVE */
+
+t_stat sim_set_thread_placement (CONST char *cptr)
+{
+char gbuf[CBUFSIZE], *val;
+t_bool cpu_changed = FALSE;
+t_stat r;
+
+while (*cptr) {
+    int cls, first, last, node = -1, prio = PRIORITY_UNCHANGED;
+    t_bool affinity;
+    uint8 cpus[SIM_MAX_HOST_CPUS / 8];
+    size_t len;
+
+    cptr = get_glyph (cptr, gbuf, 0);
+    val = strchr (gbuf, '=');
+    if ((val == NULL) || (val[1] == '\0'))
+        return sim_messagef (SCPE_ARG, "Missing value: %s\n", gbuf);
+    *val++ = '\0';
+    len = strlen (gbuf);
+    if ((len >= 8) && (strcmp (gbuf + len - 8, "AFFINITY") == 0))
+        affinity = TRUE;
+    else if ((len >= 8) && (strcmp (gbuf + len - 8, "PRIORITY") == 0))
+        affinity = FALSE;
+    else
+        return sim_messagef (SCPE_ARG, "Unknown placement setting: %s\n", gbuf);
+    gbuf[len - 8] = '\0';                               /* leave class prefix */
+    if (gbuf[0] == '\0') {                              /* no prefix means I/O and timer */
+        first = SIM_THREAD_IO;
+        last = SIM_THREAD_TIMER;
+        }
+    else {
+        for (cls = 0; cls < SIM_THREAD_CLASSES; cls++)
+            if (strcmp (gbuf, sim_thread_place[cls].name) == 0)
+                break;
+        if (cls == SIM_THREAD_CLASSES)
+            return sim_messagef (SCPE_ARG, "Unknown thread class: %s\n", gbuf);
+        first = last = cls;
+        }
+    if (affinity) {
+        if (strcmp (val, "ALL") == 0)
+            memset (cpus, 0xFF, sizeof (cpus));
+        else if (strncmp (val, "NODE", 4) == 0) {
+            node = (int)get_uint (val + 4, 10, SIM_MAX_HOST_NODES - 1, &r);
+            if (r != SCPE_OK)
+                return sim_messagef (SCPE_ARG, "Invalid NUMA node: %s\n", val + 4);
+            r = _sim_node_cpus (node, cpus);
+            if (r != SCPE_OK)
+                return r;
+            }
+        else if (_sim_parse_cpu_list (val, cpus) != SCPE_OK)
+            return sim_messagef (SCPE_ARG, "Invalid processor list: %s\n", val);
+        }
+    else {
+        if (MATCH_CMD (val, "BELOW") == 0)
+            prio = PRIORITY_BELOW_NORMAL;
+        else if (MATCH_CMD (val, "NORMAL") == 0)
+            prio = PRIORITY_NORMAL;
+        else if (MATCH_CMD (val, "ABOVE") == 0)
+            prio = PRIORITY_ABOVE_NORMAL;
+        else
+            return sim_messagef (SCPE_ARG, "Invalid priority: %s\n", val);
+        }
+    for (cls = first; cls <= last; cls++) {
+        SIM_THREAD_PLACE *tp = &sim_thread_place[cls];
+
+        if (affinity) {
+            tp->placed = TRUE;                          /* ALL must be applied too */
+            tp->node = node;
+            memcpy (tp->cpus, cpus, sizeof (cpus));
+            }
+        else
+            tp->priority = prio;
+        if (cls == SIM_THREAD_CPU)
+            cpu_changed = TRUE;
+        }
+    if (affinity && (node >= 0) && (first == SIM_THREAD_CPU)) {
+        r = _sim_os_bind_memory (node);
+        if (r == SCPE_NOFNC)
+            sim_messagef (SCPE_OK, "Memory can't be bound to a NUMA node on this host\n");
+        else if (r != SCPE_OK)
+            sim_messagef (SCPE_OK, "Memory binding to NUMA node %d failed: %s\n", node, strerror (errno));
+        }
+    }
+++sim_thread_placement_gen;
+if (cpu_changed) {
+    r = sim_os_set_thread_placement (SIM_THREAD_CPU);
+    if (r == SCPE_NOFNC)
+        return sim_messagef (r, "Thread affinity is not available on this host\n");
+    if (r != SCPE_OK)
+        return sim_messagef (r, "Can't set instruction thread affinity: %s\n", strerror (errno));
+    }
+return SCPE_OK;
+}
+
+/* Show thread placement */
+
+void sim_show_thread_placement (FILE *st)
+{
+static const char *prio_name[] = {"below normal", "normal", "above normal", "unchanged"};
+int cls, i, lo;
+
+for (cls = 0; cls < SIM_THREAD_CLASSES; cls++) {
+    SIM_THREAD_PLACE *tp = &sim_thread_place[cls];
+    const char *sep = "";
+
+    fprintf (st, "%s: ", tp->desc);
+    for (i = 0; (i < SIM_MAX_HOST_CPUS / 8) && (tp->cpus[i] == 0xFF); i++)
+        ;
+    if ((!tp->placed) || (i == SIM_MAX_HOST_CPUS / 8))
+        fprintf (st, "any processor");
+    else {
+        fprintf (st, "processors ");
+        for (i = 0; i < SIM_MAX_HOST_CPUS; i++) {
+            if (0 == (tp->cpus[i >> 3] & (1 << (i & 7))))
+                continue;
+            for (lo = i; (i + 1 < SIM_MAX_HOST_CPUS) && (tp->cpus[(i + 1) >> 3] & (1 << ((i + 1) & 7))); i++)
+                ;
+            if (lo == i)
+                fprintf (st, "%s%d", sep, lo);
+            else
+                fprintf (st, "%s%d-%d", sep, lo, i);
+            sep = ",";
+            }
+        if (tp->node >= 0)
+            fprintf (st, " (NUMA node %d)", tp->node);
+        }
+    fprintf (st, ", priority %s\n", prio_name[1 + tp->priority]);
+    }
+}
+
 #if defined(MS_MIN_GRANULARITY) && (MS_MIN_GRANULARITY != 1)
 /* Make sure to use the substitute routines */
 #undef sim_idle_ms_sleep
@@ -758,33 +1076,22 @@ static void _rtcn_configure_calibrated_clock (int32 newtmr);
 static t_bool _sim_coschedule_cancel (UNIT *uptr);
 static t_bool _sim_wallclock_cancel (UNIT *uptr);
 static t_bool _sim_wallclock_is_active (UNIT *uptr);
+static t_stat _sim_poll_group_service (UNIT *uptr, int32 tmr);
+
+typedef struct {
+    UNIT            *uptr;
+    SIM_POLL_READY  ready;
+    t_bool          busy;                               /* ready on its last tick */
+    } SIM_POLL_ENTRY;
+
+static SIM_POLL_ENTRY *sim_poll_group = NULL;
+static int32 sim_poll_group_count = 0;
+static int32 sim_poll_group_size = 0;
+static uint32 sim_poll_group_runs = 0;                  /* services run */
+static uint32 sim_poll_group_skips = 0;                 /* idle polls skipped */
 t_stat sim_timer_show_idle_mode (FILE* st, UNIT* uptr, int32 val, CONST void *  desc);
 
 
-#if defined(SIM_ASYNCH_CLOCKS)
-static int sim_timespec_compare (struct timespec *a, struct timespec *b)
-{
-while (a->tv_nsec >= 1000000000) {
-    a->tv_nsec -= 1000000000;
-    ++a->tv_sec;
-    }
-while (b->tv_nsec >= 1000000000) {
-    b->tv_nsec -= 1000000000;
-    ++b->tv_sec;
-    }
-if (a->tv_sec < b->tv_sec)
-    return -1;
-if (a->tv_sec > b->tv_sec)
-    return 1;
-if (a->tv_nsec < b->tv_nsec)
-    return -1;
-if (a->tv_nsec > b->tv_nsec)
-    return 1;
-else
-    return 0;
-}
-#endif /* defined(SIM_ASYNCH_CLOCKS) */
-
 /* OS independent clock calibration package */
 
 static uint32 sim_idle_cyc_ms = 0;                          /* Cycles per millisecond while not idling */
@@ -975,6 +1282,16 @@ if (rtc->clock_catchup_pending) {                   /* catchup tick? */
     rtc->clock_catchup_pending = FALSE;
     }
 rtc->ticks += 1;                                    /* count ticks */
+if (sim_fastforward) {                              /* virtual time? */
+    rtc->currd = MAX (1, (int32)(sim_fastforward_ips / ticksper));
+    if (rtc->ticks >= ticksper) {                   /* 1 sec yet? */
+        rtc->ticks = 0;
+        rtc->elapsed += 1;
+        rtc->gtime = sim_gtime ();
+        rtc->based = rtc->currd;
+        }
+    return rtc->currd;                              /* no wall clock calibration */
+    }
 if (rtc->ticks < ticksper)                          /* 1 sec yet? */
     return rtc->currd;
 catchup_ticks_curr = rtc->clock_catchup_ticks_curr;
@@ -1148,7 +1465,7 @@ sim_throttle_unit.action = &sim_throt_svc;
 sim_register_clock_unit_tmr (&SIM_INTERNAL_UNIT, SIM_INTERNAL_CLK);
 sim_idle_enab = FALSE;                                  /* init idle off */
 sim_idle_rate_ms = sim_os_ms_sleep_init ();             /* get OS timer rate */
-sim_set_rom_delay_factor (sim_get_rom_delay_factor ()); /* initialize ROM delay factor */
+                                                        /* ROM delay factor is calibrated on first use */
 
 sim_stop_time = clock_last = clock_start = sim_os_msec ();
 sim_os_clock_resoluton_ms = 1000;
@@ -1160,7 +1477,8 @@ do {
     if ((clock_diff > 0) && (clock_diff < sim_os_clock_resoluton_ms))
         sim_os_clock_resoluton_ms = clock_diff;
     clock_last = clock_now;
-    } while (clock_now < clock_start + 100);
+    } while ((clock_now < clock_start + 100) &&
+             (sim_os_clock_resoluton_ms > 1));          /* 1ms is as fine as sim_os_msec resolves */
 if ((sim_idle_rate_ms != 0) && (sim_os_clock_resoluton_ms != 0))
     sim_os_tick_hz = 1000/(sim_os_clock_resoluton_ms * (sim_idle_rate_ms/sim_os_clock_resoluton_ms));
 else {
@@ -1200,6 +1518,13 @@ fprintf (st, "Execution Rate:                 %s %s/sec\n", sim_fmt_numeric (ins
 if (sim_idle_enab) {
     fprintf (st, "Idling:                         Enabled\n");
     fprintf (st, "Time before Idling starts:      %d seconds\n", sim_idle_stable);
+#if defined(SIM_IDLE_TICKLESS)
+    fprintf (st, "Idle Sleep Granularity:         %s\n", sim_idle_tickless ? "Tickless (time to next event)" : "Minimum Host Sleep Time");
+#endif
+    }
+if (sim_fastforward) {
+    fprintf (st, "Fast Forward Virtual Rate:      %s %s/sec\n", sim_fmt_numeric ((double)sim_fastforward_ips), sim_vm_interval_units);
+    fprintf (st, "Fast Forward Idle Skipped:      %s %s\n", sim_fmt_numeric (sim_fastforward_skipped), sim_vm_interval_units);
     }
 if (sim_throt_type != SIM_THROT_NONE) {
     sim_show_throt (st, NULL, uptr, val, desc);
@@ -1372,11 +1697,16 @@ for (tmr=0; tmr<=SIM_NTIMERS; ++tmr) {
                 fprintf (st, " after %d tick%s", accum, (accum > 1) ? "s" : "");
             if (uptr->usecs_remaining)
                 fprintf (st, " plus %.0f usecs", uptr->usecs_remaining);
+            if (uptr->dynflags & UNIT_POLL_GROUP)
+                fprintf (st, " (poll group)");
             fprintf (st, "\n");
             accum = accum + uptr->time;
             }
         }
     }
+if (sim_poll_group_count)
+    fprintf (st, "%s poll group: %d unit%s, %u services run, %u idle polls skipped\n", sim_name,
+             sim_poll_group_count, (sim_poll_group_count > 1) ? "s" : "", sim_poll_group_runs, sim_poll_group_skips);
 #if defined (SIM_ASYNCH_IO)
 pthread_mutex_unlock (&sim_timer_lock);
 #endif /* SIM_ASYNCH_IO */
@@ -1387,6 +1717,7 @@ REG sim_timer_reg[] = {
     { DRDATAD (IDLE_CYC_MS,      sim_idle_cyc_ms,        32, "Cycles Per Millisecond"), PV_RSPC|REG_RO},
     { DRDATAD (IDLE_CYC_SLEEP,   sim_idle_cyc_sleep,     32, "Cycles Per Minimum Sleep"), PV_RSPC|REG_RO},
     { DRDATAD (IDLE_STABLE,      sim_idle_stable,        32, "IDLE stability delay"), PV_RSPC},
+    { DRDATAD (IDLE_SPIN_ITERS,  sim_idle_spin_iters,    32, "Spin loop iterations before idling"), PV_RSPC},
     { DRDATAD (ROM_DELAY,        sim_rom_delay,          32, "ROM memory reference delay"), PV_RSPC|REG_RO},
     { DRDATAD (TICK_RATE_0,      rtcs[0].hz,             32, "Timer 0 Ticks Per Second") },
     { DRDATAD (TICK_SIZE_0,      rtcs[0].currd,          32, "Timer 0 Tick Size") },
@@ -1446,6 +1777,16 @@ fprintf (st, "Calibrated Ticks%s", sim_catchup_ticks ? " with Catchup Ticks" : "
 return SCPE_OK;
 }
 
+#if defined(SIM_IDLE_TICKLESS)
+/* Set/Clear tickless idling */
+
+t_stat sim_timer_set_tickless (int32 flag, CONST char *cptr)
+{
+sim_idle_tickless = (flag != 0);
+return SCPE_OK;
+}
+#endif
+
 /* Set idle calibration threshold */
 
 t_stat sim_timer_set_idle_pct (int32 flag, CONST char *cptr)
@@ -1501,6 +1842,8 @@ return SCPE_OK;
 t_stat sim_timer_set_async (int32 flag, CONST char *cptr)
 {
 if (flag) {
+    if (sim_fastforward)
+        return sim_messagef (SCPE_NOFNC, "Asynchronous clocks aren't available in fast forward mode\n");
     if (sim_asynch_enabled && (!sim_asynch_timer)) {
         sim_asynch_timer = TRUE;
         sim_timer_change_asynch ();
@@ -1515,6 +1858,92 @@ else {
 return SCPE_OK;
 }
 
+/* Set/Clear virtual time fast forward */
+
+t_stat sim_timer_set_fastforward (int32 flag, CONST char *cptr)
+{
+int32 tmr;
+
+if (flag) {
+    uint32 ips = (uint32)sim_vm_initial_ips;
+
+    if ((cptr != NULL) && (*cptr != 0)) {
+        t_stat r;
+
+        ips = (uint32) get_uint (cptr, 10, 0x7FFFFFFF, &r);
+        if ((r != SCPE_OK) || (ips == 0))
+            return sim_messagef (SCPE_ARG, "Invalid FASTFORWARD rate: %s\n", cptr);
+        }
+    if (sim_throt_type != SIM_THROT_NONE) {
+        sim_set_throt (0, NULL);
+        sim_printf ("Throttling disabled\n");
+        }
+#if defined (SIM_ASYNCH_CLOCKS)
+    if (sim_asynch_timer) {
+        sim_timer_set_async (0, NULL);
+        sim_printf ("Asynchronous clocks disabled\n");
+        }
+#endif
+    sim_fastforward_ips = ips;
+    sim_fastforward = TRUE;
+    }
+else {
+    if ((cptr != NULL) && (*cptr != 0))
+        return sim_messagef (SCPE_ARG, "Unexpected NOFASTFORWARD argument: %s\n", cptr);
+    if (!sim_fastforward)
+        return SCPE_OK;
+    sim_fastforward = FALSE;
+    }
+for (tmr=0; tmr<=SIM_NTIMERS; tmr++) {                  /* restart calibration from now */
+    RTC *rtc = &rtcs[tmr];
+
+    if (rtc->hz == 0)
+        continue;
+    if (sim_fastforward)
+        rtc->currd = MAX (1, (int32)(sim_fastforward_ips / rtc->hz));
+    rtc->vtime = rtc->rtime = sim_os_msec ();
+    rtc->nxintv = 1000;
+    rtc->gtime = sim_gtime ();
+    rtc->based = rtc->currd;
+    if (rtc->clock_catchup_eligible) {
+        rtc->clock_catchup_base_time = sim_timenow_double ();
+        rtc->calib_tick_time = 0.0;
+        }
+    }
+return SCPE_OK;
+}
+
+/* Boot ROM fast forward
+
+   Console ROMs test the machine on power-up with timing loops and
+   interval timer waits which presume the instruction rate of the real
+   hardware, so simulators slow ROM execution down to that rate.  A
+   simulator can instead run its power-up ROM on virtual time at that
+   rate: the ROM sees exactly the timing it expects and runs as fast
+   as the host allows.  The simulator ends it when the ROM hands off
+   to the loaded software.  A fast forward, throttle or asynchronous
+   clock setting of the user's own is left alone.
+*/
+
+t_bool sim_timer_fastboot_start (uint32 ips)
+{
+char rate[16];
+
+if (sim_fastforward || sim_asynch_timer || (sim_throt_type != SIM_THROT_NONE))
+    return FALSE;
+sprintf (rate, "%u", ips);
+sim_fastboot_active = (sim_timer_set_fastforward (1, rate) == SCPE_OK);
+return sim_fastboot_active;
+}
+
+void sim_timer_fastboot_end (void)
+{
+if (!sim_fastboot_active)
+    return;
+sim_fastboot_active = FALSE;
+sim_timer_set_fastforward (0, NULL);
+}
+
 static CTAB set_timer_tab[] = {
 #if defined (SIM_ASYNCH_CLOCKS)
     { "ASYNCH",     &sim_timer_set_async, 1 },
@@ -1522,7 +1951,13 @@ static CTAB set_timer_tab[] = {
 #endif
     { "CATCHUP",    &sim_timer_set_catchup,  1 },
     { "NOCATCHUP",  &sim_timer_set_catchup,  0 },
+#if defined(SIM_IDLE_TICKLESS)
+    { "TICKLESS",   &sim_timer_set_tickless, 1 },
+    { "NOTICKLESS", &sim_timer_set_tickless, 0 },
+#endif
     { "CALIB",      &sim_timer_set_idle_pct, 0 },
+    { "FASTFORWARD",   &sim_timer_set_fastforward, 1 },
+    { "NOFASTFORWARD", &sim_timer_set_fastforward, 0 },
     { "STOP",       &sim_timer_set_stop, 0 },
     { NULL, NULL, 0 }
     };
@@ -1640,6 +2075,26 @@ if (_rtcn_tick_catchup_check (rtc, -1)) {               /* Check for slow clock
     sim_interval -= sin_cyc;
     return FALSE;
     }
+if (sim_fastforward) {                                  /* virtual time? */
+    if ((sim_clock_queue == QUEUE_LIST_END) ||          /* clock queue empty? */
+        ((sim_clock_queue->flags & UNIT_IDLE) == 0)) {  /*   or event not idle-able? */
+        sim_interval -= sin_cyc;
+        return FALSE;
+        }
+#if defined(SIM_ASYNCH_IO)
+    if (sim_asynch_enabled && sim_io_pool_busy ()) {    /* I/O in flight? */
+        sim_idle_ms_sleep (1);                          /* let it complete at this virtual time */
+        return TRUE;
+        }
+#endif
+    sim_debug (DBG_IDL, &sim_timer_dev, "fast forward %d %s to event on %s\n", sim_interval, sim_vm_interval_units, sim_uname(sim_clock_queue));
+    if (sim_interval > 0) {
+        sim_fastforward_skipped += sim_interval;
+        sim_interval = 0;                               /* next event is due now */
+        }
+    sim_idle_end_time = sim_gtime();                    /* save idle completed time */
+    return TRUE;
+    }
 if ((!sim_idle_enab)                             ||     /* idling disabled */
     ((sim_clock_queue == QUEUE_LIST_END) &&             /* or clock queue empty? */
      (!sim_asynch_timer))||                             /*     and not asynch? */
@@ -1687,6 +2142,37 @@ if ((sim_idle_rate_ms == 0) || (sim_idle_cyc_ms == 0)) {/* not possible? */
     sim_debug (DBG_IDL, &sim_timer_dev, "not possible idle_rate_ms=%d - cyc/ms=%d\n", sim_idle_rate_ms, sim_idle_cyc_ms);
     return FALSE;
     }
+#if defined(SIM_IDLE_TICKLESS)
+if (sim_idle_tickless && !rtc->clock_catchup_eligible) {
+    uint32 w_us = (sim_interval <= 0) ? 0 : (uint32)((((double)sim_interval) * 1000.0) / sim_idle_cyc_ms);/* usecs to next event */
+    uint32 act_us;
+
+    if (w_us < SIM_IDLE_MIN_US) {                       /* too short to sleep? */
+        sim_interval -= sin_cyc;
+        if (!in_nowait)
+            sim_debug (DBG_IDL, &sim_timer_dev, "no wait, too short: %d usecs\n", w_us);
+        in_nowait = TRUE;
+        return FALSE;
+        }
+    if (w_us > 1000000)                                 /* too long a wait (runaway calibration) */
+        sim_debug (DBG_TIK, &sim_timer_dev, "waiting too long: w_us=%d usecs, sim_interval=%d, rtc->currd=%d\n", w_us, sim_interval, rtc->currd);
+    in_nowait = FALSE;
+    sim_debug (DBG_IDL, &sim_timer_dev, "sleeping for %d usecs - pending event%s%s in %d %s\n", w_us, 
+               (sim_clock_queue == QUEUE_LIST_END) ? "" : " on ", (sim_clock_queue == QUEUE_LIST_END) ? "" : sim_uname(sim_clock_queue), sim_interval, sim_vm_interval_units);
+    SIM_HOST_MARK_BEGIN (SIM_MARK_IDLE, NULL);
+    act_us = _sim_idle_us_sleep (w_us);                 /* wait (or until I/O completes) */
+    SIM_HOST_MARK_END (SIM_MARK_IDLE);
+    sim_perf.idle_count++;
+    sim_perf.idle_nsec += (t_uint64)act_us * 1000;
+    rtc->clock_time_idled += (act_us + 500) / 1000;
+    act_cyc = (int32)((((double)act_us) * sim_idle_cyc_ms) / 1000.0);
+    sim_interval = sim_interval - act_cyc;              /* count down sim_interval to reflect idle period */
+    sim_idle_end_time = sim_gtime();                    /* save idle completed time */
+    sim_debug (DBG_IDL, &sim_timer_dev, "slept for %d usecs - pending event%s%s in %d %s\n", act_us, 
+               (sim_clock_queue == QUEUE_LIST_END) ? "" : " on ", (sim_clock_queue == QUEUE_LIST_END) ? "" : sim_uname(sim_clock_queue), sim_interval, sim_vm_interval_units);
+    return TRUE;
+    }
+#endif
 w_ms = (uint32) sim_interval / sim_idle_cyc_ms;         /* ms to wait */
 /* When the host system has a clock tick which is less frequent than the    */
 /* simulated system's clock, idling will cause delays which will miss       */
@@ -1712,7 +2198,11 @@ if (sim_clock_queue == QUEUE_LIST_END)
 else
     sim_debug (DBG_IDL, &sim_timer_dev, "sleeping for %d ms - pending event on %s in %d %s\n", w_ms, sim_uname(sim_clock_queue), sim_interval, sim_vm_interval_units);
 cyc_since_idle = sim_gtime() - sim_idle_end_time;       /* time since prior idle */
+SIM_HOST_MARK_BEGIN (SIM_MARK_IDLE, NULL);
 act_ms = sim_idle_ms_sleep (w_ms);                      /* wait */
+SIM_HOST_MARK_END (SIM_MARK_IDLE);
+sim_perf.idle_count++;
+sim_perf.idle_nsec += (t_uint64)act_ms * 1000000;
 rtc->clock_time_idled += act_ms;
 act_cyc = act_ms * sim_idle_cyc_ms;
 if (cyc_since_idle > sim_idle_cyc_sleep)
@@ -1728,14 +2218,62 @@ else
 return TRUE;
 }
 
-/* Set idling - implicitly disables throttling */
+/* sim_idle_spin - idle a guest which spins in a polling loop
+
+   Guests without an idle instruction (or which don't use it) wait by
+   spinning in a short loop, polling a device status register or a
+   memory location which only an interrupt will change.  A simulator
+   can call this routine each time it takes a backward branch.  The
+   state argument is a simulator defined signature of anything the loop
+   could be changing: the general registers and a count of the memory
+   and I/O stores performed, typically.  When the same branch is taken
+   sim_idle_spin_iters times in a row with an unchanged state, nothing
+   the guest can observe will change before the next event, so the
+   loop is idled until then just as if the guest had executed a wait
+   instruction.  The loop keeps running after the idle and is detected
+   again if the event didn't end it.
+
+   Inputs:
+        tmr =   calibrated timer to use
+        pc =    branch target address
+        state = signature of the loop's side effects
+   Outputs:
+        TRUE if the simulator idled
+*/
+
+t_bool sim_idle_spin (uint32 tmr, t_addr pc, uint32 state)
+{
+if ((pc != sim_idle_spin_pc) || (state != sim_idle_spin_state)) {
+    sim_idle_spin_pc = pc;                              /* start watching this loop */
+    sim_idle_spin_state = state;
+    sim_idle_spin_count = 0;
+    return FALSE;
+    }
+if (++sim_idle_spin_count < sim_idle_spin_iters)
+    return FALSE;
+sim_idle_spin_count = 0;
+++sim_idle_spin_detects;
+sim_debug (DBG_IDL, &sim_timer_dev, "spin loop detected at 0x%" LL_FMT "X\n", (LL_TYPE)pc);
+if (!sim_idle (tmr, 0))
+    return FALSE;
+++sim_idle_spin_idles;
+return TRUE;
+}
+
+/* Set idling - implicitly disables throttling
+
+   SET <cpu> IDLE=SPIN also enables spin loop detection in simulators
+   which call sim_idle_spin.
+*/
 
 t_stat sim_set_idle (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 {
 t_stat r;
 uint32 v;
 
-if (cptr && *cptr) {
+if (cptr && *cptr && (MATCH_CMD (cptr, "SPIN") == 0))
+    sim_idle_spin_enab = TRUE;
+else if (cptr && *cptr) {
     v = (uint32) get_uint (cptr, 10, SIM_IDLE_STMAX, &r);
     if ((r != SCPE_OK) || (v < SIM_IDLE_STMIN))
         return sim_messagef (SCPE_ARG, "Invalid Stability value: %s.  Valid values range from %d to %d.\n", cptr, SIM_IDLE_STMIN, SIM_IDLE_STMAX);
@@ -1754,6 +2292,7 @@ return SCPE_OK;
 t_stat sim_clr_idle (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 {
 sim_idle_enab = FALSE;
+sim_idle_spin_enab = FALSE;
 return SCPE_OK;
 }
 
@@ -1765,8 +2304,12 @@ if (sim_idle_enab)
     fprintf (st, "idle enabled");
 else
     fprintf (st, "idle disabled");
+if (sim_idle_spin_enab)
+    fprintf (st, ", spin loop detection after %u iterations", sim_idle_spin_iters);
 if (sim_switches & SWMASK ('D'))
     fprintf (st, ", stability wait = %ds, minimum sleep resolution = %dms", sim_idle_stable, sim_os_sleep_min_ms);
+if (sim_idle_spin_detects)
+    fprintf (st, "\n%u spin loops detected, %u idled", sim_idle_spin_detects, sim_idle_spin_idles);
 return SCPE_OK;
 }
 
@@ -1790,6 +2333,10 @@ else if (sim_idle_rate_ms == 0) {
 else {
     if (*cptr == '\0')
         return sim_messagef (SCPE_ARG, "Missing throttle mode specification\n");
+    if (sim_fastforward) {
+        sim_timer_set_fastforward (0, NULL);
+        sim_printf ("Fast forward disabled\n");
+        }
     val = strtotv (cptr, &tptr, 10);
     if (cptr == tptr)
         return sim_messagef (SCPE_ARG, "Invalid throttle specification: %s\n", cptr);
@@ -1847,21 +2394,15 @@ else {
 
     case SIM_THROT_MCYC:
         fprintf (st, "Throttle:                      %d mega%s\n", sim_throt_val, sim_vm_interval_units);
-        if (sim_throt_wait)
-            fprintf (st, "Throttling by sleeping for:    %d ms every %d %s\n", sim_throt_sleep_time, sim_throt_wait, sim_vm_interval_units);
         break;
 
     case SIM_THROT_KCYC:
         fprintf (st, "Throttle:                      %d kilo%s\n", sim_throt_val, sim_vm_interval_units);
-        if (sim_throt_wait)
-            fprintf (st, "Throttling by sleeping for:    %d ms every %d %s\n", sim_throt_sleep_time, sim_throt_wait, sim_vm_interval_units);
         break;
 
     case SIM_THROT_PCT:
-        if (sim_throt_wait) {
+        if (sim_throt_wait)
             fprintf (st, "Throttle:                      %d%% of %s %s per second\n", sim_throt_val, sim_fmt_numeric (sim_throt_peak_cps), sim_vm_interval_units);
-            fprintf (st, "Throttling by sleeping for:    %d ms every %d %s\n", sim_throt_sleep_time, sim_throt_wait, sim_vm_interval_units);
-            }
         else
             fprintf (st, "Throttle:                      %d%%\n", sim_throt_val);
         break;
@@ -1878,6 +2419,17 @@ else {
     if (sim_throt_type != SIM_THROT_NONE) {
         if (sim_throt_state != SIM_THROT_STATE_THROTTLE)
             fprintf (st, "Throttle State:                %s - wait: %d\n", (sim_throt_state == SIM_THROT_STATE_INIT) ? "Waiting for Init" : "Timing", sim_throt_wait);
+        else {
+            if (sim_throt_type != SIM_THROT_SPC) {
+                double d_cps = _sim_throt_desired_cps ();
+                double a_cps = (sim_throt_achieved_ns > 0.0) ? (sim_throt_achieved_inst * 1000000000.0) / sim_throt_achieved_ns : 0.0;
+
+                fprintf (st, "Throttling by pacing every:    %d %s (%d usec)\n", sim_throt_wait, sim_vm_interval_units, SIM_THROT_SLICE_NS / 1000);
+                fprintf (st, "Throttle Target Rate:          %s %s per second\n", sim_fmt_numeric (d_cps), sim_vm_interval_units);
+                fprintf (st, "Throttle Achieved Rate:        %s %s per second (%.2f%%)\n", sim_fmt_numeric (a_cps), sim_vm_interval_units, (100.0 * a_cps) / d_cps);
+                fprintf (st, "Throttle Jitter:               %.1f usec\n", sim_throt_jitter_ns / 1000.0);
+                }
+            }
         }
     }
 return SCPE_OK;
@@ -1890,6 +2442,7 @@ if (sim_throt_type != SIM_THROT_NONE) {
         /* Reset recalibration reference times */
         sim_throt_ms_start = sim_os_msec ();
         sim_throt_inst_start = sim_gtime ();
+        _sim_throt_pace_reset ();
         /* Start with prior calibrated delay */
         sim_activate (&sim_throttle_unit, sim_throt_wait);
         }
@@ -1906,6 +2459,695 @@ void sim_throt_cancel (void)
 sim_cancel (&sim_throttle_unit);
 }
 
+/* Host monotonic time in nanoseconds used for throttle pacing */
+
+static t_uint64 _sim_throt_nsec (void)
+{
+struct timespec now;
+
+#if defined(CLOCK_MONOTONIC)
+if (clock_gettime (CLOCK_MONOTONIC, &now) != 0)
+#endif
+    clock_gettime (CLOCK_REALTIME, &now);
+return (((t_uint64)now.tv_sec) * 1000000000) + now.tv_nsec;
+}
+
+/* Host monotonic time in nanoseconds */
+
+t_uint64 sim_host_nsec (void)
+{
+return _sim_throt_nsec ();
+}
+
+/* Host time accounting
+
+   sim_perf accumulates where host time goes while the simulator runs:
+   in sim_instr, dispatching events (per device totals are kept in each
+   DEVICE), queueing asynchronous I/O completions, idle sleeping and
+   throttle waiting.  Throttle waits happen within the throttle unit's
+   event service so they are part of the event total too.
+*/
+
+SIM_PERF sim_perf;
+
+void sim_perf_clear (void)
+{
+DEVICE *dptr;
+uint32 i;
+
+memset (&sim_perf, 0, sizeof (sim_perf));
+sim_perf.start_nsec = sim_host_nsec ();
+for (i = 0; (dptr = sim_devices[i]) != NULL; i++)
+    dptr->perf_events = dptr->perf_nsec = 0;
+for (i = 0; sim_internal_device_count && (dptr = sim_internal_devices[i]); ++i)
+    dptr->perf_events = dptr->perf_nsec = 0;
+}
+
+static void _sim_perf_line (FILE *st, const char *what, t_uint64 nsec, t_uint64 count, const char *counted)
+{
+fprintf (st, "  %-30s %10.3f s %6.2f%%", what, nsec / 1000000000.0,
+             sim_perf.run_nsec ? (100.0 * nsec) / sim_perf.run_nsec : 0.0);
+if (counted)
+    fprintf (st, "  %s %s", sim_fmt_numeric ((double)count), counted);
+fprintf (st, "\n");
+}
+
+static void _sim_perf_device (FILE *st, DEVICE *dptr, t_bool machine)
+{
+if (dptr->perf_events == 0)
+    return;
+if (machine) {
+    fprintf (st, "device.%s.events=%" LL_FMT "u\n", dptr->name, (LL_TYPE)dptr->perf_events);
+    fprintf (st, "device.%s.nsec=%" LL_FMT "u\n", dptr->name, (LL_TYPE)dptr->perf_nsec);
+    }
+else
+    fprintf (st, "  %-16s %14s %12.3f %10.0f\n", dptr->name, sim_fmt_numeric ((double)dptr->perf_events),
+                 dptr->perf_nsec / 1000000.0, (double)dptr->perf_nsec / dptr->perf_events);
+}
+
+/* SHOW PERFORMANCE
+
+   -M   machine readable (name=value lines)
+   -C   clear the counters after displaying them
+*/
+
+t_stat sim_show_performance (FILE *st, DEVICE *dnotused, UNIT *unotused, int32 flag, CONST char *cptr)
+{
+t_uint64 other = sim_perf.event_nsec + sim_perf.aio_nsec + sim_perf.idle_nsec;
+t_uint64 insts_nsec = (sim_perf.run_nsec > other) ? sim_perf.run_nsec - other : 0;
+t_uint64 events_nsec = (sim_perf.event_nsec > sim_perf.throt_nsec) ? sim_perf.event_nsec - sim_perf.throt_nsec : 0;
+t_bool machine = ((sim_switches & SWMASK ('M')) != 0);
+DEVICE *dptr;
+uint32 i;
+
+if (cptr && (*cptr != 0))
+    return SCPE_2MARG;
+if (sim_perf.start_nsec == 0)
+    sim_perf_clear ();
+if (machine) {
+    fprintf (st, "elapsed_nsec=%" LL_FMT "u\n", (LL_TYPE)(sim_host_nsec () - sim_perf.start_nsec));
+    fprintf (st, "run_nsec=%" LL_FMT "u\n", (LL_TYPE)sim_perf.run_nsec);
+    fprintf (st, "instructions=%.0f\n", sim_perf.run_insts);
+    fprintf (st, "instruction_nsec=%" LL_FMT "u\n", (LL_TYPE)insts_nsec);
+    fprintf (st, "event_count=%" LL_FMT "u\n", (LL_TYPE)sim_perf.event_count);
+    fprintf (st, "event_nsec=%" LL_FMT "u\n", (LL_TYPE)sim_perf.event_nsec);
+    fprintf (st, "aio_count=%" LL_FMT "u\n", (LL_TYPE)sim_perf.aio_count);
+    fprintf (st, "aio_nsec=%" LL_FMT "u\n", (LL_TYPE)sim_perf.aio_nsec);
+    fprintf (st, "idle_count=%" LL_FMT "u\n", (LL_TYPE)sim_perf.idle_count);
+    fprintf (st, "idle_nsec=%" LL_FMT "u\n", (LL_TYPE)sim_perf.idle_nsec);
+    fprintf (st, "throttle_count=%" LL_FMT "u\n", (LL_TYPE)sim_perf.throt_count);
+    fprintf (st, "throttle_nsec=%" LL_FMT "u\n", (LL_TYPE)sim_perf.throt_nsec);
+    }
+else {
+    fprintf (st, "%-32s %10.3f s of %.3f s elapsed\n", "Host time while running:", sim_perf.run_nsec / 1000000000.0,
+                 (sim_host_nsec () - sim_perf.start_nsec) / 1000000000.0);
+    _sim_perf_line (st, "Executing instructions:", insts_nsec, 0, NULL);
+    _sim_perf_line (st, "Processing events:", events_nsec, sim_perf.event_count, "events");
+    _sim_perf_line (st, "Asynchronous I/O completions:", sim_perf.aio_nsec, sim_perf.aio_count, "completions");
+    _sim_perf_line (st, "Idle sleeping:", sim_perf.idle_nsec, sim_perf.idle_count, "sleeps");
+    _sim_perf_line (st, "Throttle waiting:", sim_perf.throt_nsec, sim_perf.throt_count, "waits");
+    fprintf (st, "%-32s %s\n", "Instructions executed:", sim_fmt_numeric (sim_perf.run_insts));
+    if (sim_perf.run_nsec)
+        fprintf (st, "%-32s %.2f million %s per second (%.2f while executing)\n", "Achieved rate:",
+                     (sim_perf.run_insts * 1000.0) / sim_perf.run_nsec, sim_vm_interval_units,
+                     insts_nsec ? (sim_perf.run_insts * 1000.0) / insts_nsec : 0.0);
+    if (sim_perf.event_count)
+        fprintf (st, "\n  %-16s %14s %12s %10s\n", "Device", "Events", "Host ms", "ns/event");
+    }
+for (i = 0; (dptr = sim_devices[i]) != NULL; i++)
+    _sim_perf_device (st, dptr, machine);
+for (i = 0; sim_internal_device_count && (dptr = sim_internal_devices[i]); ++i)
+    _sim_perf_device (st, dptr, machine);
+if (sim_switches & SWMASK ('C'))
+    sim_perf_clear ();
+return SCPE_OK;
+}
+
+/* Timed phases (PERF command)
+
+   A script brackets the interesting parts of its work, typically the
+   individual diagnostics it runs, with PERF START and PERF STOP.  Each
+   phase records the instructions executed, the host time spent in
+   sim_instr and the elapsed host time.  The phases can be saved as a
+   baseline and a later run compared against it, so that a slowdown
+   in the simulator's hot paths shows up as a failing script.
+
+   PERF START name              begin timing the named phase
+   PERF STOP                    end the current phase
+   PERF SHOW                    display the recorded phases
+   PERF CLEAR                   discard the recorded phases
+   PERF SAVE file               write the recorded phases to a baseline file
+   PERF COMPARE file {percent}  compare against a baseline (default 10%)
+*/
+
+typedef struct PERF_PHASE {
+    char                name[64];
+    double              insts;                      /* instructions executed */
+    t_uint64            run_nsec;                   /* host time in sim_instr */
+    t_uint64            wall_nsec;                  /* elapsed host time */
+    } PERF_PHASE;
+
+static PERF_PHASE *sim_perf_phases = NULL;
+static uint32 sim_perf_phase_count = 0;
+static t_bool sim_perf_phase_active = FALSE;
+static double sim_perf_phase_insts;                 /* values at phase start */
+static t_uint64 sim_perf_phase_run;
+static t_uint64 sim_perf_phase_wall;
+
+#define PERF_DFLT_THRESHOLD 10.0                    /* percent */
+
+static double _sim_perf_mips (double insts, t_uint64 nsec)
+{
+return nsec ? (insts * 1000.0) / nsec : 0.0;
+}
+
+static void _sim_perf_phase_end (void)
+{
+PERF_PHASE *ph = &sim_perf_phases[sim_perf_phase_count - 1];
+
+ph->insts = sim_perf.run_insts - sim_perf_phase_insts;
+ph->run_nsec = sim_perf.run_nsec - sim_perf_phase_run;
+ph->wall_nsec = sim_host_nsec () - sim_perf_phase_wall;
+sim_perf_phase_active = FALSE;
+}
+
+static PERF_PHASE *_sim_perf_find (PERF_PHASE *phases, uint32 count, const char *name)
+{
+uint32 i;
+
+for (i = 0; i < count; i++)
+    if (strcmp (phases[i].name, name) == 0)
+        return &phases[i];
+return NULL;
+}
+
+static void _sim_perf_show (FILE *st)
+{
+uint32 i;
+
+fprintf (st, "%-20s %16s %10s %10s %10s\n", "Phase", "Instructions", "Run s", "Elapsed s", "MIPS");
+for (i = 0; i < sim_perf_phase_count; i++) {
+    PERF_PHASE *ph = &sim_perf_phases[i];
+
+    if (sim_perf_phase_active && (i == sim_perf_phase_count - 1)) {
+        fprintf (st, "%-20s %16s\n", ph->name, "(running)");
+        continue;
+        }
+    fprintf (st, "%-20s %16.0f %10.3f %10.3f %10.2f\n", ph->name, ph->insts,
+                 ph->run_nsec / 1000000000.0, ph->wall_nsec / 1000000000.0,
+                 _sim_perf_mips (ph->insts, ph->run_nsec));
+    }
+}
+
+static t_stat _sim_perf_save (const char *filename)
+{
+FILE *f;
+uint32 i;
+
+f = sim_fopen (filename, "w");
+if (f == NULL)
+    return sim_messagef (SCPE_OPENERR, "Can't create baseline file %s: %s\n", filename, strerror (errno));
+fprintf (f, "# %s performance baseline: phase instructions run_nsec elapsed_nsec\n", sim_name);
+for (i = 0; i < sim_perf_phase_count; i++)
+    fprintf (f, "%s %.0f %" LL_FMT "u %" LL_FMT "u\n", sim_perf_phases[i].name, sim_perf_phases[i].insts,
+                (LL_TYPE)sim_perf_phases[i].run_nsec, (LL_TYPE)sim_perf_phases[i].wall_nsec);
+fclose (f);
+return SCPE_OK;
+}
+
+static t_stat _sim_perf_compare (const char *filename, double threshold)
+{
+FILE *f;
+char line[CBUFSIZE];
+PERF_PHASE base;
+PERF_PHASE *ph;
+double base_mips, mips, change;
+LL_TYPE run_nsec, wall_nsec;
+int32 slower = 0, compared = 0;
+
+f = sim_fopen (filename, "r");
+if (f == NULL)
+    return sim_messagef (SCPE_OPENERR, "Can't open baseline file %s: %s\n", filename, strerror (errno));
+sim_printf ("%-20s %12s %12s %8s\n", "Phase", "Baseline", "Current", "Change");
+while (fgets (line, sizeof (line), f)) {
+    if ((line[0] == '#') ||
+        (sscanf (line, "%63s %lf %" LL_FMT "u %" LL_FMT "u", base.name, &base.insts, &run_nsec, &wall_nsec) != 4))
+        continue;
+    base.run_nsec = (t_uint64)run_nsec;
+    ph = _sim_perf_find (sim_perf_phases, sim_perf_phase_count, base.name);
+    if ((ph == NULL) || (sim_perf_phase_active && (ph == &sim_perf_phases[sim_perf_phase_count - 1]))) {
+        sim_printf ("%-20s %12.2f %12s\n", base.name, _sim_perf_mips (base.insts, base.run_nsec), "(not run)");
+        continue;
+        }
+    base_mips = _sim_perf_mips (base.insts, base.run_nsec);
+    mips = _sim_perf_mips (ph->insts, ph->run_nsec);
+    change = (base_mips > 0.0) ? (100.0 * (mips - base_mips)) / base_mips : 0.0;
+    ++compared;
+    sim_printf ("%-20s %12.2f %12.2f %+7.1f%%%s\n", base.name, base_mips, mips, change,
+                (change < -threshold) ? "  *** SLOWER" : "");
+    if (change < -threshold)
+        ++slower;
+    }
+fclose (f);
+if (compared == 0)
+    return sim_messagef (SCPE_ARG, "No recorded phases match the baseline in %s\n", filename);
+if (slower)
+    return sim_messagef (SCPE_AFAIL, "%d of %d phases are more than %.1f%% slower than the baseline\n",
+                         slower, compared, threshold);
+return SCPE_OK;
+}
+
+t_stat sim_perf_cmd (int32 flag, CONST char *cptr)
+{
+char gbuf[CBUFSIZE];
+double threshold = PERF_DFLT_THRESHOLD;
+
+GET_SWITCHES (cptr);                                    /* get switches */
+cptr = get_glyph (cptr, gbuf, 0);
+if (MATCH_CMD (gbuf, "START") == 0) {
+    PERF_PHASE *ph;
+
+    cptr = get_glyph_nc (cptr, gbuf, 0);
+    if (gbuf[0] == '\0')
+        return sim_messagef (SCPE_2FARG, "Missing phase name\n");
+    if (*cptr)
+        return sim_messagef (SCPE_2MARG, "Too many arguments: %s\n", cptr);
+    if (strlen (gbuf) >= sizeof (ph->name))
+        return sim_messagef (SCPE_ARG, "Phase name too long: %s\n", gbuf);
+    if (sim_perf_phase_active)
+        _sim_perf_phase_end ();
+    if (sim_perf.start_nsec == 0)
+        sim_perf_clear ();
+    ph = _sim_perf_find (sim_perf_phases, sim_perf_phase_count, gbuf);
+    if (ph == NULL) {
+        ph = (PERF_PHASE *)realloc (sim_perf_phases, (sim_perf_phase_count + 1) * sizeof (*ph));
+        if (ph == NULL)
+            return SCPE_MEM;
+        sim_perf_phases = ph;
+        ph = &sim_perf_phases[sim_perf_phase_count++];
+        }
+    else {                                              /* restarting a phase moves it last */
+        PERF_PHASE tmp = *ph;
+
+        memmove (ph, ph + 1, (&sim_perf_phases[sim_perf_phase_count] - (ph + 1)) * sizeof (*ph));
+        sim_perf_phases[sim_perf_phase_count - 1] = tmp;
+        ph = &sim_perf_phases[sim_perf_phase_count - 1];
+        }
+    memset (ph, 0, sizeof (*ph));
+    strlcpy (ph->name, gbuf, sizeof (ph->name));
+    sim_perf_phase_insts = sim_perf.run_insts;
+    sim_perf_phase_run = sim_perf.run_nsec;
+    sim_perf_phase_wall = sim_host_nsec ();
+    sim_perf_phase_active = TRUE;
+    return SCPE_OK;
+    }
+if (*cptr && ((MATCH_CMD (gbuf, "STOP") == 0) || (MATCH_CMD (gbuf, "SHOW") == 0) ||
+              (MATCH_CMD (gbuf, "CLEAR") == 0)))
+    return sim_messagef (SCPE_2MARG, "Too many arguments: %s\n", cptr);
+if (MATCH_CMD (gbuf, "STOP") == 0) {
+    if (!sim_perf_phase_active)
+        return sim_messagef (SCPE_ARG, "No phase is being timed\n");
+    _sim_perf_phase_end ();
+    return SCPE_OK;
+    }
+if (MATCH_CMD (gbuf, "SHOW") == 0) {
+    if (sim_perf_phase_count == 0)
+        return sim_messagef (SCPE_OK, "No phases have been recorded\n");
+    _sim_perf_show (stdout);
+    if (sim_log)
+        _sim_perf_show (sim_log);
+    return SCPE_OK;
+    }
+if (MATCH_CMD (gbuf, "CLEAR") == 0) {
+    free (sim_perf_phases);
+    sim_perf_phases = NULL;
+    sim_perf_phase_count = 0;
+    sim_perf_phase_active = FALSE;
+    return SCPE_OK;
+    }
+if ((MATCH_CMD (gbuf, "SAVE") == 0) || (MATCH_CMD (gbuf, "COMPARE") == 0)) {
+    t_bool save = (MATCH_CMD (gbuf, "SAVE") == 0);
+    char filename[CBUFSIZE];
+
+    cptr = get_glyph_nc (cptr, filename, 0);
+    if (filename[0] == '\0')
+        return sim_messagef (SCPE_2FARG, "Missing baseline file name\n");
+    if (sim_perf_phase_active)
+        _sim_perf_phase_end ();
+    if (sim_perf_phase_count == 0)
+        return sim_messagef (SCPE_ARG, "No phases have been recorded\n");
+    if (save) {
+        if (*cptr)
+            return sim_messagef (SCPE_2MARG, "Too many arguments: %s\n", cptr);
+        return _sim_perf_save (filename);
+        }
+    if (*cptr) {
+        char *eptr;
+
+        cptr = get_glyph (cptr, gbuf, '%');
+        threshold = strtod (gbuf, &eptr);
+        if ((*eptr != '\0') || (threshold < 0.0) || *cptr)
+            return sim_messagef (SCPE_ARG, "Invalid threshold: %s\n", gbuf);
+        }
+    return _sim_perf_compare (filename, threshold);
+    }
+return sim_messagef (SCPE_ARG, "PERF needs START, STOP, SHOW, CLEAR, SAVE or COMPARE: %s\n", gbuf);
+}
+
+/* Host profiler markers */
+
+#if defined (HAVE_SYS_SDT_H)
+#include <sys/sdt.h>
+#endif
+#if defined (HAVE_ITTNOTIFY)
+#include <ittnotify.h>
+
+#define SIM_ITT_NAMES   128                         /* distinct event names tracked */
+
+static __itt_domain *sim_itt_domain = NULL;
+static __itt_string_handle *sim_itt_kinds[SIM_MARK_KINDS];
+static struct {
+    const char          *name;                      /* device name (compared by address) */
+    __itt_string_handle *handle;
+    } sim_itt_names[SIM_ITT_NAMES];
+
+static __itt_string_handle *_sim_itt_handle (uint32 kind, const char *name)
+{
+static const char *kinds[SIM_MARK_KINDS] = {"event", "aio", "idle", "throttle"};
+uint32 i;
+
+if (sim_itt_domain == NULL) {
+    sim_itt_domain = __itt_domain_create ("simh");
+    for (i = 0; i < SIM_MARK_KINDS; i++)
+        sim_itt_kinds[i] = __itt_string_handle_create (kinds[i]);
+    }
+if ((kind != SIM_MARK_EVENT) || (name == NULL))
+    return sim_itt_kinds[kind];
+for (i = 0; (i < SIM_ITT_NAMES) && sim_itt_names[i].name; i++)
+    if (sim_itt_names[i].name == name)
+        return sim_itt_names[i].handle;
+if (i == SIM_ITT_NAMES)                             /* table full, use the generic name */
+    return sim_itt_kinds[kind];
+sim_itt_names[i].name = name;
+sim_itt_names[i].handle = __itt_string_handle_create (name);
+return sim_itt_names[i].handle;
+}
+#endif
+
+void sim_host_mark_begin (uint32 kind, const char *name)
+{
+#if defined (HAVE_SYS_SDT_H)
+switch (kind) {
+    case SIM_MARK_EVENT:
+        DTRACE_PROBE1 (simh, event__begin, name);
+        break;
+    case SIM_MARK_AIO:
+        DTRACE_PROBE (simh, aio__begin);
+        break;
+    case SIM_MARK_IDLE:
+        DTRACE_PROBE (simh, idle__begin);
+        break;
+    case SIM_MARK_THROTTLE:
+        DTRACE_PROBE (simh, throttle__begin);
+        break;
+    }
+#endif
+#if defined (HAVE_ITTNOTIFY)
+if (kind < SIM_MARK_KINDS) {
+    __itt_string_handle *handle = _sim_itt_handle (kind, name);  /* creates the domain */
+
+    __itt_task_begin (sim_itt_domain, __itt_null, __itt_null, handle);
+    }
+#endif
+}
+
+void sim_host_mark_end (uint32 kind)
+{
+#if defined (HAVE_SYS_SDT_H)
+switch (kind) {
+    case SIM_MARK_EVENT:
+        DTRACE_PROBE (simh, event__end);
+        break;
+    case SIM_MARK_AIO:
+        DTRACE_PROBE (simh, aio__end);
+        break;
+    case SIM_MARK_IDLE:
+        DTRACE_PROBE (simh, idle__end);
+        break;
+    case SIM_MARK_THROTTLE:
+        DTRACE_PROBE (simh, throttle__end);
+        break;
+    }
+#endif
+#if defined (HAVE_ITTNOTIFY)
+if ((kind < SIM_MARK_KINDS) && sim_itt_domain)
+    __itt_task_end (sim_itt_domain);
+#endif
+}
+
+/* Latency histograms */
+
+static uint32 _sim_latency_index (t_uint64 nsec)
+{
+uint32 msb = 0, shift;
+t_uint64 v;
+
+if (nsec < SIM_LATENCY_SUB)
+    return (uint32)nsec;
+for (v = nsec; v >>= 1; )
+    ++msb;
+shift = msb - SIM_LATENCY_SUB_BITS;
+if ((shift + 1) * SIM_LATENCY_SUB >= SIM_LATENCY_BUCKETS)
+    return SIM_LATENCY_BUCKETS - 1;
+return (shift + 1) * SIM_LATENCY_SUB + (uint32)((nsec >> shift) - SIM_LATENCY_SUB);
+}
+
+/* Smallest value too large for bucket index */
+
+static t_uint64 _sim_latency_limit (uint32 index)
+{
+uint32 shift;
+
+if (index < SIM_LATENCY_SUB)
+    return index + 1;
+shift = index / SIM_LATENCY_SUB - 1;
+return ((t_uint64)(SIM_LATENCY_SUB + index % SIM_LATENCY_SUB) + 1) << shift;
+}
+
+void sim_latency_record (SIM_LATENCY *lat, t_uint64 nsec)
+{
+++lat->bucket[_sim_latency_index (nsec)];
+++lat->count;
+lat->sum_nsec += nsec;
+if (nsec > lat->max_nsec)
+    lat->max_nsec = nsec;
+}
+
+void sim_latency_clear (SIM_LATENCY *lat)
+{
+memset (lat, 0, sizeof (*lat));
+}
+
+/* Value below which pct percent of the recorded values fall (to the
+   histogram's precision) */
+
+t_uint64 sim_latency_percentile (const SIM_LATENCY *lat, double pct)
+{
+double want = (lat->count * pct) / 100.0;
+double seen = 0;
+uint32 i;
+
+if (lat->count == 0)
+    return 0;
+for (i = 0; i < SIM_LATENCY_BUCKETS; i++) {
+    seen += lat->bucket[i];
+    if ((seen >= want) && (seen > 0)) {
+        t_uint64 limit = _sim_latency_limit (i) - 1;
+
+        return (limit < lat->max_nsec) ? limit : lat->max_nsec;
+        }
+    }
+return lat->max_nsec;
+}
+
+static const char *_sim_fmt_nsec (char *buf, t_uint64 nsec)
+{
+if (nsec < 1000)
+    sprintf (buf, "%uns", (unsigned int)nsec);
+else if (nsec < 1000000)
+    sprintf (buf, "%.1fus", nsec / 1000.0);
+else if (nsec < 1000000000)
+    sprintf (buf, "%.2fms", nsec / 1000000.0);
+else
+    sprintf (buf, "%.3fs", nsec / 1000000000.0);
+return buf;
+}
+
+void sim_latency_fprint (FILE *st, const char *what, const SIM_LATENCY *lat)
+{
+char mean[32], p50[32], p90[32], p99[32], max[32];
+
+if (lat->count == 0)
+    return;
+fprintf (st, "  %-18s %10s  mean %-8s p50 %-8s p90 %-8s p99 %-8s max %s\n", what,
+             sim_fmt_numeric ((double)lat->count),
+             _sim_fmt_nsec (mean, lat->sum_nsec / lat->count),
+             _sim_fmt_nsec (p50, sim_latency_percentile (lat, 50.0)),
+             _sim_fmt_nsec (p90, sim_latency_percentile (lat, 90.0)),
+             _sim_fmt_nsec (p99, sim_latency_percentile (lat, 99.0)),
+             _sim_fmt_nsec (max, lat->max_nsec));
+}
+
+/* Metrics endpoint histogram.  Buckets are reported at power of two
+   nanosecond boundaries from about 1us to 1s, which line up with the
+   histogram's own buckets. */
+
+void sim_latency_publish (const char *family, const SIM_LATENCY *lat, const char *labels)
+{
+char name[CBUFSIZE];
+double cumulative = 0;
+uint32 i = 0, power;
+
+snprintf (name, sizeof (name), "%s_bucket", family);
+for (power = 10; power <= 30; power++) {
+    t_uint64 limit = (t_uint64)1 << power;
+
+    for ( ; (i < SIM_LATENCY_BUCKETS) && (_sim_latency_limit (i) <= limit); i++)
+        cumulative += lat->bucket[i];
+    sim_metric (name, "histogram", cumulative, "%s,le=\"%g\"", labels, limit / 1000000000.0);
+    }
+sim_metric (name, "histogram", (double)lat->count, "%s,le=\"+Inf\"", labels);
+snprintf (name, sizeof (name), "%s_sum", family);
+sim_metric (name, "histogram", lat->sum_nsec / 1000000000.0, "%s", labels);
+snprintf (name, sizeof (name), "%s_count", family);
+sim_metric (name, "histogram", (double)lat->count, "%s", labels);
+}
+
+/* Timing and throttling samples for the metrics endpoint.  Rates are
+   computed over the interval since the previous snapshot. */
+
+void sim_timer_publish_metrics (void)
+{
+static t_uint64 last_nsec = 0, last_idle_nsec = 0;
+static double last_insts = 0;
+static const char *throt_types[] = {"none", "mcyc", "kcyc", "pct", "spc"};
+t_uint64 now = sim_host_nsec ();
+double insts = sim_gtime ();
+
+sim_metric ("simh_instructions_total", "counter", insts, NULL);
+if (last_nsec && (now > last_nsec) && (insts >= last_insts)) {
+    sim_metric ("simh_instructions_per_second", "gauge", ((insts - last_insts) * 1000000000.0) / (now - last_nsec), NULL);
+    if (sim_perf.idle_nsec >= last_idle_nsec)
+        sim_metric ("simh_idle_ratio", "gauge", (double)(sim_perf.idle_nsec - last_idle_nsec) / (now - last_nsec), NULL);
+    }
+last_nsec = now;
+last_insts = insts;
+last_idle_nsec = sim_perf.idle_nsec;
+sim_metric ("simh_idle_enabled", "gauge", sim_idle_enab ? 1 : 0, NULL);
+if (sim_perf.start_nsec) {
+    sim_metric ("simh_host_seconds_total", "counter", (now - sim_perf.start_nsec) / 1000000000.0, NULL);
+    sim_metric ("simh_idle_seconds_total", "counter", sim_perf.idle_nsec / 1000000000.0, NULL);
+    sim_metric ("simh_throttle_wait_seconds_total", "counter", sim_perf.throt_nsec / 1000000000.0, NULL);
+    sim_metric ("simh_event_seconds_total", "counter", sim_perf.event_nsec / 1000000000.0, NULL);
+    sim_metric ("simh_events_total", "counter", (double)sim_perf.event_count, NULL);
+    }
+sim_metric ("simh_throttle_setting", "gauge", sim_throt_val, "type=\"%s\"",
+            (sim_throt_type < sizeof (throt_types) / sizeof (throt_types[0])) ? throt_types[sim_throt_type] : "unknown");
+sim_metric ("simh_throttle_active", "gauge", ((sim_throt_type != SIM_THROT_NONE) && (sim_throt_state == SIM_THROT_STATE_THROTTLE)) ? 1 : 0, NULL);
+}
+
+static double _sim_throt_desired_cps (void)
+{
+if (sim_throt_type == SIM_THROT_MCYC)
+    return (double) sim_throt_val * 1000000.0;
+if (sim_throt_type == SIM_THROT_KCYC)
+    return (double) sim_throt_val * 1000.0;
+return (sim_throt_peak_cps * sim_throt_val) / 100.0;
+}
+
+static void _sim_throt_pace_reset (void)
+{
+sim_throt_pi_integral = 0;
+sim_throt_pi_ns = _sim_throt_nsec ();
+sim_throt_pi_inst = sim_gtime ();
+}
+
+/* Wait until the host time reaches deadline_ns.  The bulk of the wait
+   is slept, a remainder shorter than a worthwhile sleep is spun.  A wait
+   ended early (by an I/O completion) just leaves a residue which the
+   pacing integral carries into the next interval. */
+
+static void _sim_throt_wait_until (t_uint64 deadline_ns)
+{
+t_uint64 now = _sim_throt_nsec ();
+t_uint64 start = now;
+
+if (now >= deadline_ns)
+    return;
+sim_perf.throt_count++;
+SIM_HOST_MARK_BEGIN (SIM_MARK_THROTTLE, NULL);
+#if defined(SIM_IDLE_TICKLESS)
+if ((deadline_ns - now) > SIM_THROT_SPIN_NS) {
+    _sim_idle_us_sleep ((uint32)((deadline_ns - now - SIM_THROT_SPIN_NS) / 1000));
+    now = _sim_throt_nsec ();
+    }
+#else
+if ((deadline_ns - now) >= ((t_uint64)sim_idle_rate_ms * 1000000)) {
+    sim_idle_ms_sleep ((unsigned int)((deadline_ns - now) / 1000000));
+    now = _sim_throt_nsec ();
+    }
+#endif
+if ((now < deadline_ns) && ((deadline_ns - now) <= SIM_THROT_SPIN_NS)) {
+    while ((now = _sim_throt_nsec ()) < deadline_ns)
+        ;                                       /* spin out the remainder */
+    }
+SIM_HOST_MARK_END (SIM_MARK_THROTTLE);
+sim_perf.throt_nsec += now - start;
+}
+
+/* Dynamic throttle pacing
+
+   Each pacing interval runs sim_throt_wait instructions, which at the
+   desired rate should take SIM_THROT_SLICE_NS.  The wait at the end of
+   an interval is a PI controller output: the proportional term is this
+   interval's rate error expressed as time (target less measured run
+   time), the integral term is the residual error accumulated from
+   oversleeping, early wakeups and intervals that ran slow.  Clamping the
+   integral keeps a slow host or a host side stall from producing a
+   catch-up burst.
+*/
+
+static void _sim_throt_pace (double d_cps)
+{
+double now_inst = sim_gtime ();
+double insts = now_inst - sim_throt_pi_inst;
+double target_ns = (insts * 1000000000.0) / d_cps;
+t_uint64 start_ns = _sim_throt_nsec ();
+double wait_ns, interval_ns, err_ns;
+t_uint64 end_ns;
+
+wait_ns = (SIM_THROT_PI_KP * (target_ns - (double)(start_ns - sim_throt_pi_ns))) + 
+          (SIM_THROT_PI_KI * sim_throt_pi_integral);
+if (wait_ns > 0.0)
+    _sim_throt_wait_until (start_ns + (t_uint64)wait_ns);
+end_ns = _sim_throt_nsec ();
+interval_ns = (double)(end_ns - sim_throt_pi_ns);
+err_ns = target_ns - interval_ns;
+sim_throt_pi_integral += err_ns;
+if (sim_throt_pi_integral > SIM_THROT_PI_ILIMIT_NS)
+    sim_throt_pi_integral = SIM_THROT_PI_ILIMIT_NS;
+if (sim_throt_pi_integral < -SIM_THROT_PI_ILIMIT_NS)
+    sim_throt_pi_integral = -SIM_THROT_PI_ILIMIT_NS;
+sim_throt_achieved_inst += SIM_THROT_EWMA * (insts - sim_throt_achieved_inst);
+sim_throt_achieved_ns += SIM_THROT_EWMA * (interval_ns - sim_throt_achieved_ns);
+sim_throt_jitter_ns += SIM_THROT_EWMA * (fabs (err_ns) - sim_throt_jitter_ns);
+sim_throt_pi_ns = end_ns;
+sim_throt_pi_inst = now_inst;
+sim_throt_wait = (int32)((d_cps * SIM_THROT_SLICE_NS) / 1000000000.0);
+if (sim_throt_wait < SIM_THROT_WMIN)
+    sim_throt_wait = SIM_THROT_WMIN;
+}
+
 /* Throttle service
 
    Throttle service has three distinct states used while dynamically
@@ -1987,13 +3229,7 @@ switch (sim_throt_state) {
             }
         else {                                          /* long enough */
             a_cps = (((double) delta_inst) * 1000.0) / (double) delta_ms;
-            if (sim_throt_type == SIM_THROT_MCYC)       /* calc desired cps */
-                d_cps = (double) sim_throt_val * 1000000.0;
-            else
-                if (sim_throt_type == SIM_THROT_KCYC)
-                    d_cps = (double) sim_throt_val * 1000.0;
-                else
-                    d_cps = (sim_throt_peak_cps * sim_throt_val) / 100.0;
+            d_cps = _sim_throt_desired_cps ();          /* calc desired cps */
             if (d_cps >= a_cps) {
                 /* the initial throttling calibration measures a slower cps rate than the desired cps rate, */
                 sim_debug (DBG_THR, &sim_timer_dev, "sim_throt_svc() CPU too slow.  Values a_cps = %f, d_cps = %f\n", 
@@ -2035,6 +3271,15 @@ switch (sim_throt_state) {
             sim_throt_ms_start = sim_throt_ms_stop;
             sim_throt_inst_start = sim_gtime();
             sim_throt_state = SIM_THROT_STATE_THROTTLE;
+            if (sim_throt_type != SIM_THROT_SPC) {      /* dynamic throttling is paced */
+                _sim_throt_pace_reset ();
+                sim_throt_wait = (int32)((d_cps * SIM_THROT_SLICE_NS) / 1000000000.0);
+                if (sim_throt_wait < SIM_THROT_WMIN)
+                    sim_throt_wait = SIM_THROT_WMIN;
+                sim_throt_achieved_inst = (double)sim_throt_wait;
+                sim_throt_achieved_ns = ((double)sim_throt_wait * 1000000000.0) / d_cps;
+                sim_throt_jitter_ns = 0;
+                }
             sim_debug (DBG_THR, &sim_timer_dev, "sim_throt_svc() Throttle values a_cps = %f, d_cps = %f, wait = %d, sleep = %d ms\n", 
                                                 a_cps, d_cps, sim_throt_wait, sim_throt_sleep_time);
             sim_throt_cps = d_cps;                  /* save the desired rate */
@@ -2057,57 +3302,32 @@ switch (sim_throt_state) {
         break;
 
     case SIM_THROT_STATE_THROTTLE:                      /* throttling */
-        sim_idle_ms_sleep (sim_throt_sleep_time);
-        delta_ms = sim_os_msec () - sim_throt_ms_start;
-        if (delta_ms >= 10000) {                        /* recompute every 10 sec */
-            double delta_insts = sim_gtime() - sim_throt_inst_start;
-
-            a_cps = (delta_insts * 1000.0) / (double) delta_ms;
-            if (sim_throt_type != SIM_THROT_SPC) {      /* when not dynamic throttling */
-                if (sim_throt_type == SIM_THROT_MCYC)   /* calc desired cps */
-                    d_cps = (double) sim_throt_val * 1000000.0;
-                else
-                    if (sim_throt_type == SIM_THROT_KCYC)
-                        d_cps = (double) sim_throt_val * 1000.0;
-                    else
-                        d_cps = (sim_throt_peak_cps * sim_throt_val) / 100.0;
-                if (fabs(100.0 * (d_cps - a_cps) / d_cps) > (double)sim_throt_drift_pct) {
-                    sim_debug (DBG_THR, &sim_timer_dev, "sim_throt_svc() Recalibrating throttle based on values a_cps = %f, d_cps = %f deviating by %.2f%% from the desired value\n", 
+        if (sim_throt_type != SIM_THROT_SPC) {          /* dynamic throttling? */
+            d_cps = _sim_throt_desired_cps ();
+            _sim_throt_pace (d_cps);
+            delta_ms = sim_os_msec () - sim_throt_ms_start;
+            if (delta_ms >= 10000) {                    /* check drift every 10 sec */
+                a_cps = ((sim_gtime() - sim_throt_inst_start) * 1000.0) / (double) delta_ms;
+                if (fabs(100.0 * (d_cps - a_cps) / d_cps) > (double)sim_throt_drift_pct)
+                    sim_debug (DBG_THR, &sim_timer_dev, "sim_throt_svc() Throttle rate a_cps = %f, d_cps = %f deviating by %.2f%% from the desired value\n", 
                                                         a_cps, d_cps, fabs(100.0 * (d_cps - a_cps) / d_cps));
-                    if ((a_cps > d_cps) &&                      /* too fast? */
-                        ((100.0 * (a_cps - d_cps) / d_cps) > (100 - sim_throt_drift_pct))) {
-                        sim_debug (DBG_THR, &sim_timer_dev, "sim_throt_svc() Restarting calibrating throttle going too fast: a_cps = %f, d_cps = %f deviating by %.2f%% from the desired value\n", 
-                                                            a_cps, d_cps, fabs(100.0 * (d_cps - a_cps) / d_cps));
-                        while (1) {
-                            sim_throt_wait = (int32)            /* cycles between sleeps */
-                                ((sim_throt_peak_cps * d_cps * ((double) sim_throt_sleep_time)) /
-                                 (1000.0 * (sim_throt_peak_cps - d_cps)));
-                            if (sim_throt_wait >= SIM_THROT_WMIN)/* long enough? */
-                                break;
-                            sim_throt_sleep_time += sim_os_sleep_inc_ms;
-                            sim_debug (DBG_THR, &sim_timer_dev, "sim_throt_svc() Wait too small, increasing sleep time to %d ms.  Values a_cps = %f, d_cps = %f, wait = %d\n", 
-                                                                sim_throt_sleep_time, sim_throt_peak_cps, d_cps, sim_throt_wait);
-                            }
-                        }
-                    else {                                      /* slow or within reasonable range */
-                        sim_debug (DBG_THR, &sim_timer_dev, "sim_throt_svc() Adjusting wait before sleep interval by %d\n", 
-                                                            (int32)(((d_cps - a_cps) * (double)sim_throt_wait) / d_cps));
-                        sim_throt_wait += (int32)(((d_cps - a_cps) * (double)sim_throt_wait) / d_cps);
-                        }
-                    sim_debug (DBG_THR, &sim_timer_dev, "sim_throt_svc() Throttle values a_cps = %f, d_cps = %f, wait = %d, sleep = %d ms\n", 
-                                                        a_cps, d_cps, sim_throt_wait, sim_throt_sleep_time);
-                    sim_throt_cps = d_cps;                      /* save the desired rate */
-                    sim_throt_ms_start = sim_os_msec ();
-                    sim_throt_inst_start = sim_gtime();
-                    }
-                }
-            else {                                      /* record instruction rate */
-                sim_throt_cps = (int32)a_cps;
-                sim_debug (DBG_THR, &sim_timer_dev, "sim_throt_svc() Recalibrating Special %d/%u Cycles Per Second of %f\n", 
-                                                    sim_throt_wait, sim_throt_sleep_time, sim_throt_cps);
-                sim_throt_inst_start = sim_gtime();
                 sim_throt_ms_start = sim_os_msec ();
+                sim_throt_inst_start = sim_gtime();
                 }
+            break;
+            }
+        sim_perf.throt_count++;
+        SIM_HOST_MARK_BEGIN (SIM_MARK_THROTTLE, NULL);
+        sim_perf.throt_nsec += (t_uint64)sim_idle_ms_sleep (sim_throt_sleep_time) * 1000000;
+        SIM_HOST_MARK_END (SIM_MARK_THROTTLE);
+        delta_ms = sim_os_msec () - sim_throt_ms_start;
+        if (delta_ms >= 10000) {                        /* record instruction rate every 10 sec */
+            a_cps = ((sim_gtime() - sim_throt_inst_start) * 1000.0) / (double) delta_ms;
+            sim_throt_cps = (int32)a_cps;
+            sim_debug (DBG_THR, &sim_timer_dev, "sim_throt_svc() Recalibrating Special %d/%u Cycles Per Second of %f\n", 
+                                                sim_throt_wait, sim_throt_sleep_time, sim_throt_cps);
+            sim_throt_inst_start = sim_gtime();
+            sim_throt_ms_start = sim_os_msec ();
             }
         break;
         }
@@ -2182,8 +3402,12 @@ if ((stat == SCPE_OK)                               &&
             stat = sim_timer_activate_after (cptr, cptr->usecs_remaining);
             }
         else {
-            sim_debug (DBG_QUE, &sim_timer_dev, "Activating %s now %s%s\n", sim_uname (cptr), (sptr != QUEUE_LIST_END) ? "- next: " : "", (sptr != QUEUE_LIST_END) ? sim_uname (sptr) : "");
-            stat = _sim_activate (cptr, 0);
+            if (cptr->dynflags & UNIT_POLL_GROUP)
+                stat = _sim_poll_group_service (cptr, tmr);
+            else {
+                sim_debug (DBG_QUE, &sim_timer_dev, "Activating %s now %s%s\n", sim_uname (cptr), (sptr != QUEUE_LIST_END) ? "- next: " : "", (sptr != QUEUE_LIST_END) ? sim_uname (sptr) : "");
+                stat = _sim_activate (cptr, 0);
+                }
             }
         if (stat != SCPE_OK) {
             sim_debug (DBG_QUE, &sim_timer_dev, "Activating %s failed: %s\n", sim_uname (cptr), sim_error_text (stat));
@@ -2258,7 +3482,7 @@ static t_bool _rtcn_tick_catchup_check (RTC *rtc, int32 time)
 int32 tmr;
 t_bool bReturn = FALSE;
 
-if (!sim_catchup_ticks)
+if ((!sim_catchup_ticks) || sim_fastforward)
     return FALSE;
 if (time == -1) {
     for (tmr=0; tmr<=SIM_NTIMERS; tmr++) {
@@ -2367,6 +3591,7 @@ struct sched_param sched_priority;
 pthread_getschedparam (pthread_self(), &sched_policy, &sched_priority);
 ++sched_priority.sched_priority;
 pthread_setschedparam (pthread_self(), sched_policy, &sched_priority);
+sim_os_set_thread_placement (SIM_THREAD_TIMER);
 
 sim_debug (DBG_TIM, &sim_timer_dev, "_timer_thread() - starting\n");
 
@@ -2376,34 +3601,10 @@ pthread_cond_signal (&sim_timer_startup_cond);   /* Signal we're ready to go */
 while (sim_asynch_timer && sim_is_running) {
     struct timespec start_time, stop_time;
     struct timespec due_time;
-    double wait_usec;
+    double wait_usec, d_stop, d_due;
     int32 inst_delay;
     double inst_per_sec;
-    UNIT *uptr, *cptr, *prvptr;
-
-    if (sim_wallclock_entry) {                          /* something to insert in queue? */
-
-        sim_debug (DBG_TIM, &sim_timer_dev, "_timer_thread() - timing %s for %s\n", 
-                   sim_uname(sim_wallclock_entry), sim_fmt_secs (sim_wallclock_entry->a_usec_delay/1000000.0));
-
-        uptr = sim_wallclock_entry;
-        sim_wallclock_entry = NULL;
-
-        prvptr = NULL;
-        for (cptr = sim_wallclock_queue; cptr != QUEUE_LIST_END; cptr = cptr->a_next) {
-            if (uptr->a_due_time < cptr->a_due_time)
-                break;
-            prvptr = cptr;
-            }
-        if (prvptr == NULL) {                           /* insert at head */
-            cptr = uptr->a_next = sim_wallclock_queue;
-            sim_wallclock_queue = uptr;
-            }
-        else {
-            cptr = uptr->a_next = prvptr->a_next;       /* insert at prvptr */
-            prvptr->a_next = uptr;
-            }
-        }
+    UNIT *uptr;
 
     /* determine wait time */
     if (sim_wallclock_queue != QUEUE_LIST_END) {
@@ -2429,18 +3630,25 @@ while (sim_asynch_timer && sim_is_running) {
             continue;                                   /* wait again */
         inst_per_sec = sim_timer_inst_per_sec ();
 
-        uptr = sim_wallclock_queue;
-        sim_wallclock_queue = uptr->a_next;
-        uptr->a_next = NULL;                            /* hygiene */
-
         clock_gettime(CLOCK_REALTIME, &stop_time);
-        if (1 != sim_timespec_compare (&due_time, &stop_time))
-            inst_delay = 0;
-        else
-            inst_delay = (int32)(inst_per_sec*(_timespec_to_double(&due_time)-_timespec_to_double(&stop_time)));
-        sim_debug (DBG_TIM, &sim_timer_dev, "_timer_thread() - slept %.0fms - activating(%s,%d)\n", 
-                   1000.0*(_timespec_to_double (&stop_time)-_timespec_to_double (&start_time)), sim_uname(uptr), inst_delay);
-        sim_activate (uptr, inst_delay);
+        d_stop = _timespec_to_double (&stop_time);
+        /* expire everything that has come due in one pass, the asynch */
+        /* queue then wakes the simulator thread once for the batch */
+        do {
+            uptr = sim_wallclock_queue;
+            sim_wallclock_queue = uptr->a_next;
+            uptr->a_next = NULL;                        /* hygiene */
+
+            d_due = uptr->a_due_time-(((double)sim_idle_rate_ms)*0.0005);
+            if (d_due <= d_stop)
+                inst_delay = 0;
+            else
+                inst_delay = (int32)(inst_per_sec*(d_due-d_stop));
+            sim_debug (DBG_TIM, &sim_timer_dev, "_timer_thread() - slept %.0fms - activating(%s,%d)\n", 
+                       1000.0*(d_stop-_timespec_to_double (&start_time)), sim_uname(uptr), inst_delay);
+            sim_activate (uptr, inst_delay);
+            } while ((sim_wallclock_queue != QUEUE_LIST_END) &&
+                     ((sim_wallclock_queue->a_due_time-(((double)sim_idle_rate_ms)*0.0005)) <= d_stop));
         }
     else {/* Something wants to adjust the queue since the wait condition was signaled */
         }
@@ -2833,7 +4041,7 @@ if (sim_calb_tmr != -1) {
         if ((uptr != crtc->timer_unit) &&                   /* Not scheduling calibrated timer */
             (inst_til_tick > 0)) {                          /* and tick not pending? */
             if (inst_delay_d > (double)inst_til_calib) {    /* long wait? */
-                stat = sim_clock_coschedule_tmr (uptr, sim_calb_tmr, ticks_til_calib - 1);
+                stat = sim_clock_coschedule_tmr (uptr, sim_calb_tmr, ticks_til_calib);/* fires on that tick */
                 uptr->usecs_remaining = (stat == SCPE_OK) ? usec_delay - usecs_til_calib : 0.0;
                 sim_debug (DBG_TIM, &sim_timer_dev, "sim_timer_activate_after(%s, %.0f usecs) - coscheduling with with calibrated timer(%d), ticks=%d, usecs_remaining=%.0f usecs, inst_til_tick=%d, ticks_til_calib=%d, usecs_til_calib=%u\n", 
                            sim_uname(uptr), usec_delay, sim_calb_tmr, ticks_til_calib, uptr->usecs_remaining, inst_til_tick, ticks_til_calib, usecs_til_calib);
@@ -2899,19 +4107,10 @@ if ((sim_asynch_timer) &&
         prvptr = cptr;
         }
     if (prvptr == NULL) {                           /* inserting at head */
-        uptr->a_next = QUEUE_LIST_END;              /* Temporarily mark as active */
-        if (sim_timer_thread_running) {
-            while (sim_wallclock_entry) {               /* wait for any prior entry has been digested */
-                sim_debug (DBG_TIM, &sim_timer_dev, "sim_timer_activate_after(%s, %.0f usecs) - queue insert entry %s busy waiting for 1ms\n", 
-                           sim_uname(uptr), usec_delay, sim_uname(sim_wallclock_entry));
-                pthread_mutex_unlock (&sim_timer_lock);
-                sim_os_ms_sleep (1);
-                pthread_mutex_lock (&sim_timer_lock);
-                }
-            }
-        sim_wallclock_entry = uptr;
+        uptr->a_next = sim_wallclock_queue;
+        sim_wallclock_queue = uptr;
         pthread_mutex_unlock (&sim_timer_lock);
-        pthread_cond_signal (&sim_timer_wake);      /* wake the timer thread to deal with it */
+        pthread_cond_signal (&sim_timer_wake);      /* timer thread must recompute its wait */
         return SCPE_OK;
         }
     else {                                          /* inserting at prvptr */
@@ -2930,6 +4129,81 @@ sim_debug (DBG_CHK, &sim_timer_dev, "sim_timer_activate_after(%s, %.0f usecs) -
 return stat;
 }
 
+/* Poll group
+
+   Units which poll for host activity on every clock tick (multiplexers
+   waiting for a connection, mostly) can join the poll group along with a
+   readiness routine.  When such a unit comes due on the coschedule queue
+   the tick calls its readiness routine and runs its service routine
+   directly, only if there is something to do.  Otherwise the unit simply
+   stays on the coschedule queue for the next tick, so an idle unit costs
+   one readiness test per tick rather than an event queue insertion and a
+   pass through sim_process_event.  A unit which has just been busy gets
+   one more service after it goes idle, so that it sees the effects of its
+   last activity (a line dropping, for instance).
+*/
+
+static SIM_POLL_ENTRY *_sim_poll_group_find (UNIT *uptr)
+{
+int32 i;
+
+for (i = 0; i < sim_poll_group_count; i++)
+    if (sim_poll_group[i].uptr == uptr)
+        return &sim_poll_group[i];
+return NULL;
+}
+
+t_stat sim_poll_group_add (UNIT *uptr, SIM_POLL_READY ready)
+{
+SIM_POLL_ENTRY *pe = _sim_poll_group_find (uptr);
+
+if (pe == NULL) {
+    if (sim_poll_group_count == sim_poll_group_size) {
+        pe = (SIM_POLL_ENTRY *)realloc (sim_poll_group, (sim_poll_group_size + 8) * sizeof (*pe));
+        if (pe == NULL)
+            return SCPE_MEM;
+        sim_poll_group = pe;
+        sim_poll_group_size += 8;
+        }
+    pe = &sim_poll_group[sim_poll_group_count++];
+    }
+pe->uptr = uptr;
+pe->ready = ready;
+pe->busy = TRUE;
+uptr->dynflags |= UNIT_POLL_GROUP;
+return SCPE_OK;
+}
+
+t_stat sim_poll_group_remove (UNIT *uptr)
+{
+SIM_POLL_ENTRY *pe = _sim_poll_group_find (uptr);
+
+if (pe != NULL)
+    *pe = sim_poll_group[--sim_poll_group_count];
+uptr->dynflags &= ~UNIT_POLL_GROUP;
+return SCPE_OK;
+}
+
+/* Called from the tick for a poll group unit which has come due */
+
+static t_stat _sim_poll_group_service (UNIT *uptr, int32 tmr)
+{
+SIM_POLL_ENTRY *pe = _sim_poll_group_find (uptr);
+t_bool busy = (pe == NULL) || (pe->ready == NULL) || pe->ready (uptr);
+
+if ((!busy) && (!pe->busy)) {
+    ++sim_poll_group_skips;
+    return sim_clock_coschedule_tmr (uptr, tmr, 0);     /* look again next tick */
+    }
+if (pe != NULL)
+    pe->busy = busy;
+++sim_poll_group_runs;
+sim_debug (DBG_QUE, &sim_timer_dev, "Polling %s now\n", sim_uname (uptr));
+if (uptr->action == NULL)
+    return SCPE_IERR;
+return uptr->action (uptr);
+}
+
 /* Clock coscheduling routines */
 
 t_stat sim_register_clock_unit_tmr (UNIT *uptr, int32 tmr)
@@ -3160,28 +4434,21 @@ for (tmr=0; tmr<=SIM_NTIMERS; tmr++) {
 if (uptr->a_next) {
     UNIT *cptr;
 
-    if (uptr == sim_wallclock_entry) {  /* Pending on the queue? */
-        sim_wallclock_entry = NULL;
+    if (uptr == sim_wallclock_queue) {
+        sim_wallclock_queue = uptr->a_next;
         uptr->a_next = NULL;
-        sim_debug (DBG_QUE, &sim_timer_dev, "Canceled Queue Pending Timer Event for %s\n", sim_uname(uptr));
+        sim_debug (DBG_QUE, &sim_timer_dev, "Canceled Top Timer Event for %s\n", sim_uname(uptr));
+        pthread_cond_signal (&sim_timer_wake);
         }
     else {
-        if (uptr == sim_wallclock_queue) {
-            sim_wallclock_queue = uptr->a_next;
-            uptr->a_next = NULL;
-            sim_debug (DBG_QUE, &sim_timer_dev, "Canceled Top Timer Event for %s\n", sim_uname(uptr));
-            pthread_cond_signal (&sim_timer_wake);
-            }
-        else {
-            for (cptr = sim_wallclock_queue;
-                (cptr != QUEUE_LIST_END);
-                cptr = cptr->a_next) {
-                if (cptr->a_next == (uptr)) {
-                    cptr->a_next = (uptr)->a_next;
-                    uptr->a_next = NULL;
-                    sim_debug (DBG_QUE, &sim_timer_dev, "Canceled Timer Event for %s\n", sim_uname(uptr));
-                    break;
-                    }
+        for (cptr = sim_wallclock_queue;
+            (cptr != QUEUE_LIST_END);
+            cptr = cptr->a_next) {
+            if (cptr->a_next == (uptr)) {
+                cptr->a_next = (uptr)->a_next;
+                uptr->a_next = NULL;
+                sim_debug (DBG_QUE, &sim_timer_dev, "Canceled Timer Event for %s\n", sim_uname(uptr));
+                break;
                 }
             }
         }
@@ -3229,15 +4496,6 @@ if (uptr->a_is_active == &_sim_wallclock_is_active) {
     double d_result;
 
     pthread_mutex_lock (&sim_timer_lock);
-    if (uptr == sim_wallclock_entry) {
-        d_result = uptr->a_due_gtime - sim_gtime ();
-        if (d_result < 0.0)
-            d_result = 0.0;
-        if (d_result > (double)0x7FFFFFFE)
-            d_result = (double)0x7FFFFFFE;
-        pthread_mutex_unlock (&sim_timer_lock);
-        return ((int32)d_result) + 1;
-        }
     for (cptr = sim_wallclock_queue;
          cptr != QUEUE_LIST_END;
          cptr = cptr->a_next)
@@ -3305,15 +4563,6 @@ if (!sim_is_active (uptr)) {
 #if defined(SIM_ASYNCH_CLOCKS)
 if (uptr->a_is_active == &_sim_wallclock_is_active) {
     pthread_mutex_lock (&sim_timer_lock);
-    if (uptr == sim_wallclock_entry) {
-        result = uptr->a_due_gtime - sim_gtime ();
-        if (result < 0.0)
-            result = 0.0;
-        pthread_mutex_unlock (&sim_timer_lock);
-        result = uptr->usecs_remaining + (1000000.0 * (result / sim_timer_inst_per_sec ())) + 1;
-        sim_debug (DBG_QUE, &sim_timer_dev, "sim_timer_activate_time_usecs(%s) wallclock_entry - %.0f usecs, inst_per_sec=%.0f\n", sim_uname (uptr), result, sim_timer_inst_per_sec ());
-        return result;
-        }
     for (cptr = sim_wallclock_queue;
          cptr != QUEUE_LIST_END;
          cptr = cptr->a_next)
@@ -3348,7 +4597,7 @@ if (uptr->cancel == &_sim_coschedule_cancel) {
             else
                 accum += cptr->time;
             if (cptr == uptr) {
-                result = uptr->usecs_remaining + ceil(1000000.0 * ((rtc->currd * accum) + sim_activate_time (&sim_timer_units[tmr]) - 1) / sim_timer_inst_per_sec ());
+                result = uptr->usecs_remaining + ceil(1000000.0 * ((rtc->currd * (accum - ((accum > 0) ? 1 : 0))) + sim_activate_time (&sim_timer_units[tmr]) - 1) / sim_timer_inst_per_sec ());
                 sim_debug (DBG_QUE, &sim_timer_dev, "sim_timer_activate_time_usecs(%s) coscheduled - %.0f usecs, inst_per_sec=%.0f, tmr=%d, ticksize=%d, ticks=%d, inst_til_tick=%d, usecs_remaining=%.0f\n", sim_uname (uptr), result, sim_timer_inst_per_sec (), tmr, rtc->currd, accum, sim_activate_time (&sim_timer_units[tmr]) - 1, uptr->usecs_remaining);
                 return result;
                 }
@@ -3399,6 +4648,9 @@ SIM_NOINLINE int32 sim_rom_read_with_delay (int32 val)
 {
 uint32 i, l = sim_rom_delay;
 
+if (l == 0)                                             /* not yet calibrated? */
+    l = sim_get_rom_delay_factor ();
+
 for (i = 0; i < l; i++)
     rom_loopval |= (rom_loopval + val) ^ _rom_swapb (_rom_swapb (rom_loopval + val));
 return val + rom_loopval;
@@ -3414,6 +4666,8 @@ SIM_NOINLINE uint32 sim_get_rom_delay_factor (void)
 
 if (sim_rom_delay == 0) {
     uint32 i, ts, te, c = 10000, samples = 0;
+    double start = sim_timenow_double ();
+
     while (1) {
         c = c * 2;
         te = sim_os_msec();
@@ -3438,6 +4692,7 @@ if (sim_rom_delay == 0) {
         }
     if (sim_rom_delay < 5)
         sim_rom_delay = 5;
+    sim_startup_record ("ROM delay calibration", start);
     }
 return sim_rom_delay;
 }
@@ -84,6 +84,7 @@ int clock_gettime(int clock_id, struct timespec *tp);
 #define SIM_IDLE_STMIN  2                           /* min sec for stability */
 #define SIM_IDLE_STDFLT 20                          /* dft sec for stability */
 #define SIM_IDLE_STMAX  600                         /* max sec for stability */
+#define SIM_IDLE_SPIN_ITERS 32                      /* dft spin loop iterations before idling */
 
 #define SIM_THROT_WINIT           1000              /* cycles to skip */
 #define SIM_THROT_WST             10000             /* initial wait */
@@ -99,6 +100,68 @@ int clock_gettime(int clock_id, struct timespec *tp);
 #define SIM_THROT_STATE_INIT      0                 /* Starting */
 #define SIM_THROT_STATE_TIME      1                 /* Checking Time */
 #define SIM_THROT_STATE_THROTTLE  2                 /* Throttling  */
+#define SIM_THROT_SLICE_NS        1000000           /* dynamic throttle pacing interval */
+#define SIM_THROT_SPIN_NS         100000            /* waits shorter than this are spun */
+#define SIM_THROT_PI_KP           1.0               /* pacing proportional gain */
+#define SIM_THROT_PI_KI           0.5               /* pacing integral gain */
+#define SIM_THROT_PI_ILIMIT_NS    20000000.0        /* pacing integral clamp (anti-windup) */
+#define SIM_THROT_EWMA            (1.0/1024.0)      /* achieved rate & jitter smoothing */
+
+/* Host time accounting (SHOW PERFORMANCE) */
+
+typedef struct SIM_PERF {
+    t_uint64            start_nsec;                 /* host time accounting started */
+    t_uint64            run_nsec;                   /* host time spent in sim_instr */
+    double              run_insts;                  /* instructions executed there */
+    t_uint64            event_count;                /* events dispatched */
+    t_uint64            event_nsec;                 /*   host time in their service routines */
+    t_uint64            aio_count;                  /* asynchronous I/O completions */
+    t_uint64            aio_nsec;                   /*   host time queueing them */
+    t_uint64            idle_count;                 /* idle sleeps */
+    t_uint64            idle_nsec;                  /*   host time slept */
+    t_uint64            throt_count;                /* throttle waits */
+    t_uint64            throt_nsec;                 /*   host time waited */
+    } SIM_PERF;
+
+/* Host profiler markers
+
+   A build with SIM_HOST_MARKERS defined brackets event dispatch,
+   asynchronous I/O completions, idle sleeps and throttle waits with
+   markers a host profiler can attribute time to: static probes from
+   sys/sdt.h (HAVE_SYS_SDT_H) for perf, bpftrace and SystemTap, and
+   Intel ITT tasks (HAVE_ITTNOTIFY) for VTune.  Otherwise the markers
+   compile to nothing. */
+
+#define SIM_MARK_EVENT          0                   /* event service, name is the device */
+#define SIM_MARK_AIO            1                   /* asynchronous I/O completions */
+#define SIM_MARK_IDLE           2                   /* idle sleep */
+#define SIM_MARK_THROTTLE       3                   /* throttle wait */
+#define SIM_MARK_KINDS          4
+
+#if defined (SIM_HOST_MARKERS)
+#define SIM_HOST_MARK_BEGIN(kind, name) sim_host_mark_begin (kind, name)
+#define SIM_HOST_MARK_END(kind)         sim_host_mark_end (kind)
+#else
+#define SIM_HOST_MARK_BEGIN(kind, name)
+#define SIM_HOST_MARK_END(kind)
+#endif
+
+/* Latency histogram (SHOW <dev> STATISTICS)
+
+   Values are host nanoseconds kept in log linear buckets: each power of
+   two range is split in SIM_LATENCY_SUB linear sub-buckets, so every
+   bucket is within 1/SIM_LATENCY_SUB of the values it holds. */
+
+#define SIM_LATENCY_SUB_BITS    3
+#define SIM_LATENCY_SUB         (1 << SIM_LATENCY_SUB_BITS)
+#define SIM_LATENCY_BUCKETS     (SIM_LATENCY_SUB * 38)  /* up to 2^40 ns (~18 minutes) */
+
+typedef struct SIM_LATENCY {
+    t_uint64            count;                      /* values recorded */
+    t_uint64            sum_nsec;                   /* their total */
+    t_uint64            max_nsec;                   /* and the largest */
+    uint32              bucket[SIM_LATENCY_BUCKETS];
+    } SIM_LATENCY;
 
 #define TIMER_DBG_IDLE  0x001                       /* Debug Flag for Idle Debugging */
 #define TIMER_DBG_QUEUE 0x002                       /* Debug Flag for Asynch Queue Debugging */
@@ -122,6 +185,9 @@ t_stat sim_set_timers (int32 arg, CONST char *cptr);
 t_stat sim_show_timers (FILE* st, DEVICE *dptr, UNIT* uptr, int32 val, CONST char* desc);
 t_stat sim_show_clock_queues (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_bool sim_idle (uint32 tmr, int sin_cyc);
+t_bool sim_idle_spin (uint32 tmr, t_addr pc, uint32 state);
+t_bool sim_timer_fastboot_start (uint32 ips);
+void sim_timer_fastboot_end (void);
 t_stat sim_set_throt (int32 arg, CONST char *cptr);
 t_stat sim_show_throt (FILE *st, DEVICE *dnotused, UNIT *unotused, int32 flag, CONST char *cptr);
 t_stat sim_set_idle (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
@@ -148,6 +214,9 @@ t_stat sim_clock_coschedule (UNIT *uptr, int32 interval);
 t_stat sim_clock_coschedule_abs (UNIT *uptr, int32 interval);
 t_stat sim_clock_coschedule_tmr (UNIT *uptr, int32 tmr, int32 ticks);
 t_stat sim_clock_coschedule_tmr_abs (UNIT *uptr, int32 tmr, int32 ticks);
+typedef t_bool (*SIM_POLL_READY)(UNIT *uptr);       /* poll group readiness test */
+t_stat sim_poll_group_add (UNIT *uptr, SIM_POLL_READY ready);
+t_stat sim_poll_group_remove (UNIT *uptr);
 double sim_timer_inst_per_sec (void);
 void sim_timer_precalibrate_execution_rate (void);
 int32 sim_rtcn_tick_size (int32 tmr);
@@ -157,17 +226,39 @@ t_bool sim_timer_idle_capable (uint32 *host_ms_sleep_1, uint32 *host_tick_ms);
 #define PRIORITY_NORMAL         0
 #define PRIORITY_ABOVE_NORMAL   1
 t_stat sim_os_set_thread_priority (int below_normal_above);
+#define SIM_THREAD_CPU          0                       /* instruction execution thread */
+#define SIM_THREAD_IO           1                       /* I/O threads */
+#define SIM_THREAD_TIMER        2                       /* wall clock timer thread */
+#define SIM_THREAD_CLASSES      3
+extern volatile uint32 sim_thread_placement_gen;
+t_stat sim_os_set_thread_placement (int thread_class);
+t_stat sim_set_thread_placement (CONST char *cptr);
+void sim_show_thread_placement (FILE *st);
 uint32 sim_get_rom_delay_factor (void);
 void sim_set_rom_delay_factor (uint32 delay);
 int32 sim_rom_read_with_delay (int32 val);
 double sim_host_speed_factor (void);
+t_uint64 sim_host_nsec (void);
+void sim_perf_clear (void);
+void sim_timer_publish_metrics (void);
+void sim_latency_record (SIM_LATENCY *lat, t_uint64 nsec);
+void sim_latency_clear (SIM_LATENCY *lat);
+t_uint64 sim_latency_percentile (const SIM_LATENCY *lat, double pct);
+void sim_latency_fprint (FILE *st, const char *what, const SIM_LATENCY *lat);
+void sim_latency_publish (const char *family, const SIM_LATENCY *lat, const char *labels);
+t_stat sim_show_performance (FILE *st, DEVICE *dnotused, UNIT *unotused, int32 flag, CONST char *cptr);
+t_stat sim_perf_cmd (int32 flag, CONST char *cptr);
+void sim_host_mark_begin (uint32 kind, const char *name);
+void sim_host_mark_end (uint32 kind);
 
 extern t_bool sim_idle_enab;                        /* idle enabled flag */
+extern t_bool sim_idle_spin_enab;                   /* spin loop idle detection flag */
 extern volatile t_bool sim_idle_wait;               /* idle waiting flag */
 extern t_bool sim_asynch_timer;
 extern DEVICE sim_timer_dev;
 extern UNIT * volatile sim_clock_cosched_queue[SIM_NTIMERS+1];
 extern const t_bool rtc_avail;
+extern SIM_PERF sim_perf;
 
 #ifdef  __cplusplus
 }
@@ -344,6 +344,28 @@
 #include <ctype.h>
 #include <math.h>
 
+#if defined(__linux) || defined(__linux__)
+#include <sys/epoll.h>
+#define TMXR_READY_EPOLL 1
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+#include <sys/types.h>
+#include <sys/event.h>
+#include <sys/time.h>
+#define TMXR_READY_KQUEUE 1
+#endif
+#if defined(TMXR_READY_EPOLL) || defined(TMXR_READY_KQUEUE)
+#define TMXR_READY_SET 1
+#endif
+#if !defined(_WIN32) && !defined(VMS)
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#define TMXR_SHM_LINKS 1
+#endif
+
 /* Telnet protocol constants - negatives are for init'ing signed char data */
 
 /* Commands */
@@ -706,6 +728,522 @@ if (lp->datagram) {
 return loop_read_ex (lp, buf, bufsize);
 }
 
+/* Shared memory links.
+
+   A line attached with SHM=name is joined to whichever line in another
+   simulator on the same host attaches to the same name, with the data
+   passed through a file which both of them map.  The file holds one byte
+   ring for each direction.  Each ring has a single writer and a single
+   reader, so moving data needs neither a lock nor a system call; the file
+   lock is only taken while an end is being claimed.  The link runs as a
+   byte stream, so packet lines get the same length prefixed framing they
+   get on a TCP stream.  A line is connected while both ends are attached
+   and is disconnected when the other end detaches or its process exits.
+*/
+
+#define TMXR_SHM_MAGIC  0x544D5831                      /* layout identifier */
+#define TMXR_SHM_SIZE   65536                           /* bytes per ring (power of 2) */
+
+typedef struct {
+    volatile uint32     head;                           /* bytes written */
+    volatile uint32     tail;                           /* bytes read */
+    uint8               data[TMXR_SHM_SIZE];
+    } TMXR_SHM_RING;
+
+typedef struct {
+    volatile uint32     magic;
+    volatile int32      pid[2];                         /* process attached at each end, 0 if none */
+    uint32              reserved;
+    TMXR_SHM_RING       ring[2];                        /* ring[n] is read by end n */
+    } TMXR_SHM_LINK;
+
+struct tmxr_shm {
+    int                 fd;                             /* link file */
+    TMXR_SHM_LINK       *link;                          /* mapped link */
+    int                 end;                            /* our end of the link */
+    char                *name;                          /* link name */
+    };
+
+#if defined(TMXR_SHM_LINKS)
+
+static void tmxr_shm_close (TMLN *lp)
+{
+struct tmxr_shm *shm = lp->shmlink;
+
+if (shm == NULL)
+    return;
+lp->shmlink = NULL;
+if (shm->link != (TMXR_SHM_LINK *)MAP_FAILED) {
+    if (shm->end >= 0)
+        shm->link->pid[shm->end] = 0;                   /* release our end */
+    munmap ((void *)shm->link, sizeof (*shm->link));
+    }
+if (shm->fd >= 0)
+    close (shm->fd);
+free (shm->name);
+free (shm);
+}
+
+static t_stat tmxr_shm_open (TMLN *lp, const char *name)
+{
+struct tmxr_shm *shm;
+struct stat st;
+char path[PATH_MAX];
+const char *c;
+int i;
+
+for (c = name; *c; ++c)
+    if (!isalnum (*c) && (*c != '-') && (*c != '_') && (*c != '.'))
+        break;
+if ((*name == '\0') || (*c != '\0') || (strlen (name) > 64))
+    return sim_messagef (SCPE_ARG, "Invalid shared memory link name: %s\n", name);
+snprintf (path, sizeof (path), "%s/simh-tmxr-%s",
+          ((0 == stat ("/dev/shm", &st)) && S_ISDIR (st.st_mode)) ? "/dev/shm" : "/tmp", name);
+shm = (struct tmxr_shm *)calloc (1, sizeof (*shm));
+if (shm == NULL)
+    return SCPE_MEM;
+shm->link = (TMXR_SHM_LINK *)MAP_FAILED;
+shm->end = -1;
+shm->name = (char *)malloc (1 + strlen (name));
+if (shm->name == NULL) {
+    free (shm);
+    return SCPE_MEM;
+    }
+strcpy (shm->name, name);
+lp->shmlink = shm;
+shm->fd = open (path, O_RDWR | O_CREAT, 0666);
+if ((shm->fd < 0) ||
+    (flock (shm->fd, LOCK_EX) < 0) ||
+    (fstat (shm->fd, &st) < 0) ||
+    (((size_t)st.st_size < sizeof (*shm->link)) && (ftruncate (shm->fd, sizeof (*shm->link)) < 0))) {
+    sim_messagef (SCPE_OPENERR, "Can't open shared memory link %s: %s\n", path, strerror (errno));
+    tmxr_shm_close (lp);
+    return SCPE_OPENERR;
+    }
+shm->link = (TMXR_SHM_LINK *)mmap (NULL, sizeof (*shm->link), PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd, 0);
+if (shm->link == (TMXR_SHM_LINK *)MAP_FAILED) {
+    sim_messagef (SCPE_OPENERR, "Can't map shared memory link %s: %s\n", path, strerror (errno));
+    tmxr_shm_close (lp);
+    return SCPE_OPENERR;
+    }
+if (shm->link->magic != TMXR_SHM_MAGIC) {               /* new or foreign file? */
+    memset ((void *)shm->link, 0, sizeof (*shm->link));
+    shm->link->magic = TMXR_SHM_MAGIC;
+    }
+for (i = 0; i < 2; i++) {                               /* claim a free end */
+    if ((shm->link->pid[i] == 0) ||                     /* free, or owner gone without detaching? */
+        ((kill ((pid_t)shm->link->pid[i], 0) < 0) && (errno == ESRCH))) {
+        shm->link->ring[i].tail = shm->link->ring[i].head;  /* discard stale input */
+        __sync_synchronize ();
+        shm->link->pid[i] = (int32)getpid ();
+        shm->end = i;
+        break;
+        }
+    }
+flock (shm->fd, LOCK_UN);
+if (shm->end < 0) {
+    tmxr_shm_close (lp);
+    return sim_messagef (SCPE_OPENERR, "Shared memory link %s already has both ends attached\n", name);
+    }
+return SCPE_OK;
+}
+
+/* Return TRUE if the other end of the link is attached */
+
+static t_bool tmxr_shm_peer (TMLN *lp)
+{
+int32 pid = lp->shmlink->link->pid[lp->shmlink->end ^ 1];
+
+if (pid == 0)
+    return FALSE;
+return !((kill ((pid_t)pid, 0) < 0) && (errno == ESRCH));
+}
+
+static int32 tmxr_shm_read (TMLN *lp, char *buf, int32 length)
+{
+TMXR_SHM_RING *ring = &lp->shmlink->link->ring[lp->shmlink->end];
+uint32 tail = ring->tail;
+uint32 avail = ring->head - tail;
+uint32 offset, chunk;
+
+if (!lp->conn)
+    return 0;
+if (avail == 0)                                         /* nothing to read */
+    return tmxr_shm_peer (lp) ? 0 : -1;                 /* disconnect once the peer has gone */
+__sync_synchronize ();                                  /* read the data after the head */
+if (avail > (uint32)length)
+    avail = (uint32)length;
+offset = tail & (TMXR_SHM_SIZE - 1);
+chunk = MIN (avail, TMXR_SHM_SIZE - offset);
+memcpy (buf, &ring->data[offset], chunk);
+memcpy (buf + chunk, ring->data, avail - chunk);
+__sync_synchronize ();                                  /* finish reading before freeing the space */
+ring->tail = tail + avail;
+return (int32)avail;
+}
+
+static int32 tmxr_shm_write (TMLN *lp, const char *buf, int32 length, const char *wrap_buf, int32 wrap_length)
+{
+TMXR_SHM_RING *ring = &lp->shmlink->link->ring[lp->shmlink->end ^ 1];
+uint32 head = ring->head;
+uint32 space = TMXR_SHM_SIZE - (head - ring->tail);
+uint32 written = 0;
+int32 seg;
+
+if (!lp->conn)
+    return lp->txbfd ? length : 0;                      /* nobody listening, as for a socket */
+__sync_synchronize ();                                  /* write the data after reading the tail */
+for (seg = 0; seg < 2; seg++) {                         /* data, then any wrapped data */
+    uint32 count = (uint32)(seg ? wrap_length : length);
+    const char *from = seg ? wrap_buf : buf;
+    uint32 offset, chunk;
+
+    if (count > space - written)
+        count = space - written;
+    if (count == 0)
+        break;
+    offset = (head + written) & (TMXR_SHM_SIZE - 1);
+    chunk = MIN (count, TMXR_SHM_SIZE - offset);
+    memcpy (&ring->data[offset], from, chunk);
+    memcpy (ring->data, from + chunk, count - chunk);
+    written += count;
+    if ((seg == 0) && (count < (uint32)length))         /* ring full? */
+        break;
+    }
+__sync_synchronize ();                                  /* publish the data before the head */
+ring->head = head + written;
+return (int32)written;
+}
+
+#else /* !TMXR_SHM_LINKS */
+
+static void tmxr_shm_close (TMLN *lp)
+{
+}
+
+static t_stat tmxr_shm_open (TMLN *lp, const char *name)
+{
+return sim_messagef (SCPE_NOFNC, "Shared memory links are not supported on this host\n");
+}
+
+static t_bool tmxr_shm_peer (TMLN *lp)
+{
+return FALSE;
+}
+
+static int32 tmxr_shm_read (TMLN *lp, char *buf, int32 length)
+{
+return -1;
+}
+
+static int32 tmxr_shm_write (TMLN *lp, const char *buf, int32 length, const char *wrap_buf, int32 wrap_length)
+{
+return -1;
+}
+
+#endif /* TMXR_SHM_LINKS */
+
+/* Socket readiness set.
+
+   Rather than issuing a read on every connected socket each time
+   tmxr_poll_rx runs, the host is asked once per poll (via epoll or
+   kqueue) which of the multiplexer's sockets have pending input, and
+   only those lines are read.  A line's socket joins its multiplexer's
+   set the first time a poll sees it and leaves just before tmxr_reset_ln
+   closes it.  Host serial ports whose descriptor sim_serial_fd reports
+   join the same set and leave it before sim_close_serial.  Loopback,
+   framer and shared memory lines, serial ports without a descriptor, and
+   hosts without a readiness facility, are read on every poll as before.
+*/
+
+#if defined(TMXR_READY_SET)
+static void *tmxr_ready_events = NULL;                  /* event buffer shared by all muxes */
+static int32 tmxr_ready_events_size = 0;
+
+/* Descriptor to watch for a line, 0 if it must always be read */
+
+static SOCKET _tmxr_ready_handle (TMLN *lp)
+{
+if (lp->loopback || lp->framer || lp->shmlink)
+    return 0;
+if (lp->serport) {
+    int fd = sim_serial_fd (lp->serport);
+
+    return (fd > 0) ? (SOCKET)fd : 0;
+    }
+return lp->sock;
+}
+
+static void _tmxr_ready_add (TMXR *mp, TMLN *lp, SOCKET handle)
+{
+#if defined(TMXR_READY_EPOLL)
+struct epoll_event ev;
+
+memset (&ev, 0, sizeof (ev));
+ev.events = EPOLLIN;
+ev.data.u32 = (uint32)(lp - mp->ldsc);
+if (0 == epoll_ctl (mp->ready_fd, EPOLL_CTL_ADD, (int)handle, &ev))
+    lp->ready_sock = handle;
+#else
+struct kevent ev;
+
+EV_SET (&ev, handle, EVFILT_READ, EV_ADD, 0, 0, (void *)(size_t)(lp - mp->ldsc));
+if (0 == kevent (mp->ready_fd, &ev, 1, NULL, 0, NULL))
+    lp->ready_sock = handle;
+#endif
+}
+
+static void _tmxr_ready_remove (TMLN *lp)
+{
+TMXR *mp = lp->mp;
+
+if (lp->ready_sock == 0)
+    return;
+if ((mp != NULL) && (mp->ready_fd > 0)) {
+#if defined(TMXR_READY_EPOLL)
+    struct epoll_event ev;                              /* pre 2.6.9 kernels insist on one */
+
+    epoll_ctl (mp->ready_fd, EPOLL_CTL_DEL, (int)lp->ready_sock, &ev);
+#else
+    struct kevent ev;
+
+    EV_SET (&ev, lp->ready_sock, EVFILT_READ, EV_DELETE, 0, 0, NULL);
+    kevent (mp->ready_fd, &ev, 1, NULL, 0, NULL);
+#endif
+    }
+lp->ready_sock = 0;
+}
+
+static void _tmxr_ready_close (TMXR *mp)
+{
+int32 i;
+
+for (i = 0; i < mp->lines; i++)
+    mp->ldsc[i].ready_sock = mp->ldsc[i].conn_watch[0] = mp->ldsc[i].conn_watch[1] = 0;
+if (mp->ready_fd > 0)
+    close (mp->ready_fd);
+mp->ready_fd = 0;
+if (mp->conn_fd > 0)
+    close (mp->conn_fd);
+mp->conn_fd = 0;
+}
+
+/* Mark the lines of a mux which need to be read by tmxr_poll_rx.
+   Returns FALSE if no readiness set is available (read every line). */
+
+static t_bool _tmxr_ready_poll (TMXR *mp)
+{
+int32 i, n, socks = 0;
+TMLN *lp;
+SOCKET handle;
+
+if (mp->ready_fd == 0) {                                /* first poll? */
+#if defined(TMXR_READY_EPOLL)
+    mp->ready_fd = epoll_create (mp->lines);
+#else
+    mp->ready_fd = kqueue ();
+#endif
+    if (mp->ready_fd <= 0)
+        mp->ready_fd = -1;                              /* unavailable, don't retry */
+    }
+if (mp->ready_fd < 0)
+    return FALSE;
+for (i = 0; i < mp->lines; i++) {
+    lp = mp->ldsc + i;
+    handle = _tmxr_ready_handle (lp);
+    if (lp->ready_sock != handle) {                     /* socket or port changed? */
+        _tmxr_ready_remove (lp);
+        if (handle)
+            _tmxr_ready_add (mp, lp, handle);
+        }
+    if (handle && (lp->ready_sock == handle)) {
+        lp->rx_ready = FALSE;                           /* read only if reported */
+        ++socks;
+        }
+    else
+        lp->rx_ready = TRUE;                            /* always read */
+    }
+if (socks == 0)
+    return TRUE;
+if (tmxr_ready_events_size < socks) {
+#if defined(TMXR_READY_EPOLL)
+    tmxr_ready_events = realloc (tmxr_ready_events, socks * sizeof (struct epoll_event));
+#else
+    tmxr_ready_events = realloc (tmxr_ready_events, socks * sizeof (struct kevent));
+#endif
+    if (tmxr_ready_events == NULL) {
+        tmxr_ready_events_size = 0;
+        for (i = 0; i < mp->lines; i++)
+            mp->ldsc[i].rx_ready = TRUE;
+        return TRUE;
+        }
+    tmxr_ready_events_size = socks;
+    }
+if (1) {
+#if defined(TMXR_READY_EPOLL)
+    struct epoll_event *ev = (struct epoll_event *)tmxr_ready_events;
+
+    n = epoll_wait (mp->ready_fd, ev, socks, 0);
+    for (i = 0; i < n; i++)
+        if ((int32)ev[i].data.u32 < mp->lines)
+            mp->ldsc[ev[i].data.u32].rx_ready = TRUE;
+#else
+    struct kevent *ev = (struct kevent *)tmxr_ready_events;
+    struct timespec zero = {0, 0};
+
+    n = kevent (mp->ready_fd, NULL, 0, ev, socks, &zero);
+    for (i = 0; i < n; i++)
+        if ((int32)(size_t)ev[i].udata < mp->lines)
+            mp->ldsc[(size_t)ev[i].udata].rx_ready = TRUE;
+#endif
+    if (n < 0) {                                        /* poll failed? */
+        for (i = 0; i < mp->lines; i++)
+            mp->ldsc[i].rx_ready = TRUE;                /* read everything */
+        }
+    }
+return TRUE;
+}
+/* Connection readiness set.
+
+   Line specific listeners and outgoing connections still in progress
+   are kept in a second per-mux set, so tmxr_poll_conn only calls
+   accept or sim_check_conn for the lines the host reports activity on
+   (a listener is readable, a connecting socket is writable or failed).
+   Index 0 of conn_watch/conn_ready is the line's listener, index 1 its
+   connecting socket.  Watches are resynchronized on every poll and
+   dropped by _tmxr_conn_unwatch before either socket is closed.
+*/
+
+static void _tmxr_conn_watch (TMXR *mp, TMLN *lp, int32 kind, SOCKET sock)
+{
+uint32 tag = (uint32)(((lp - mp->ldsc) << 1) | kind);
+#if defined(TMXR_READY_EPOLL)
+struct epoll_event ev;
+
+memset (&ev, 0, sizeof (ev));
+ev.events = kind ? EPOLLOUT : EPOLLIN;
+ev.data.u32 = tag;
+if (0 == epoll_ctl (mp->conn_fd, EPOLL_CTL_ADD, (int)sock, &ev))
+    lp->conn_watch[kind] = sock;
+#else
+struct kevent ev;
+
+EV_SET (&ev, sock, kind ? EVFILT_WRITE : EVFILT_READ, EV_ADD, 0, 0, (void *)(size_t)tag);
+if (0 == kevent (mp->conn_fd, &ev, 1, NULL, 0, NULL))
+    lp->conn_watch[kind] = sock;
+#endif
+}
+
+static void _tmxr_conn_drop (TMXR *mp, TMLN *lp, int32 kind)
+{
+if (lp->conn_watch[kind] == 0)
+    return;
+if ((mp != NULL) && (mp->conn_fd > 0)) {
+#if defined(TMXR_READY_EPOLL)
+    struct epoll_event ev;
+
+    epoll_ctl (mp->conn_fd, EPOLL_CTL_DEL, (int)lp->conn_watch[kind], &ev);
+#else
+    struct kevent ev;
+
+    EV_SET (&ev, lp->conn_watch[kind], kind ? EVFILT_WRITE : EVFILT_READ, EV_DELETE, 0, 0, NULL);
+    kevent (mp->conn_fd, &ev, 1, NULL, 0, NULL);
+#endif
+    }
+lp->conn_watch[kind] = 0;
+}
+
+static void _tmxr_conn_unwatch (TMLN *lp)
+{
+_tmxr_conn_drop (lp->mp, lp, 0);
+_tmxr_conn_drop (lp->mp, lp, 1);
+}
+
+/* Mark the lines whose listener or connecting socket need attention.
+   Returns FALSE if no readiness set is available (check every line). */
+
+static t_bool _tmxr_conn_poll (TMXR *mp)
+{
+int32 i, kind, n, socks = 0;
+TMLN *lp;
+SOCKET sock;
+
+if (mp->conn_fd == 0) {                                 /* first poll? */
+#if defined(TMXR_READY_EPOLL)
+    mp->conn_fd = epoll_create (mp->lines);
+#else
+    mp->conn_fd = kqueue ();
+#endif
+    if (mp->conn_fd <= 0)
+        mp->conn_fd = -1;                               /* unavailable, don't retry */
+    }
+if (mp->conn_fd < 0)
+    return FALSE;
+for (i = 0; i < mp->lines; i++) {
+    lp = mp->ldsc + i;
+    for (kind = 0; kind < 2; kind++) {
+        sock = kind ? lp->connecting : lp->master;
+        if (lp->conn_watch[kind] != sock) {             /* socket changed? */
+            _tmxr_conn_drop (mp, lp, kind);
+            if (sock)
+                _tmxr_conn_watch (mp, lp, kind, sock);
+            }
+        if (sock && (lp->conn_watch[kind] == sock)) {
+            lp->conn_ready[kind] = FALSE;               /* check only if reported */
+            ++socks;
+            }
+        else
+            lp->conn_ready[kind] = TRUE;                /* always check */
+        }
+    }
+if (socks == 0)
+    return TRUE;
+if (tmxr_ready_events_size < socks) {
+#if defined(TMXR_READY_EPOLL)
+    tmxr_ready_events = realloc (tmxr_ready_events, socks * sizeof (struct epoll_event));
+#else
+    tmxr_ready_events = realloc (tmxr_ready_events, socks * sizeof (struct kevent));
+#endif
+    if (tmxr_ready_events == NULL) {
+        tmxr_ready_events_size = 0;
+        return FALSE;
+        }
+    tmxr_ready_events_size = socks;
+    }
+if (1) {
+#if defined(TMXR_READY_EPOLL)
+    struct epoll_event *ev = (struct epoll_event *)tmxr_ready_events;
+
+    n = epoll_wait (mp->conn_fd, ev, socks, 0);
+    for (i = 0; i < n; i++)
+        if ((int32)(ev[i].data.u32 >> 1) < mp->lines)
+            mp->ldsc[ev[i].data.u32 >> 1].conn_ready[ev[i].data.u32 & 1] = TRUE;
+#else
+    struct kevent *ev = (struct kevent *)tmxr_ready_events;
+    struct timespec zero = {0, 0};
+
+    n = kevent (mp->conn_fd, NULL, 0, ev, socks, &zero);
+    for (i = 0; i < n; i++)
+        if ((int32)((size_t)ev[i].udata >> 1) < mp->lines)
+            mp->ldsc[(size_t)ev[i].udata >> 1].conn_ready[(size_t)ev[i].udata & 1] = TRUE;
+#endif
+    if (n < 0)                                          /* poll failed? */
+        return FALSE;                                   /* check everything */
+    }
+return TRUE;
+}
+#else
+#define _tmxr_ready_remove(lp)
+#define _tmxr_ready_close(mp)
+#define _tmxr_ready_poll(mp) FALSE
+#define _tmxr_conn_unwatch(lp)
+#define _tmxr_conn_poll(mp) FALSE
+#endif
+
+/* Socket options for a line's connections */
+
+#define _tmxr_sockopts(lp) (((lp)->packet ? SIM_SOCK_OPT_NODELAY : 0) | (lp)->sockopts)
+
 /* Read from a line.
 
    Up to "length" characters are read into the character buffer associated with
@@ -724,6 +1262,8 @@ int32 i = lp->rxbpi;
 
 if (lp->loopback)
     return loop_read (lp, &(lp->rxb[i]), length);
+if (lp->shmlink)                                        /* shared memory link? */
+    return tmxr_shm_read (lp, &(lp->rxb[i]), length);
 if (lp->serport)                                        /* serial port connection? */
     return sim_read_serial (lp->serport, &(lp->rxb[i]), length, &(lp->rbr[i]));
 else {
@@ -740,9 +1280,14 @@ else {
    Up to "length" characters are written from the character buffer associated
    with "lp".  The actual number of characters written is returned.  If an error
    occurred while writing, -1 is returned.
+
+   When the buffered data wraps, "wrap_length" counts the characters at the
+   start of the buffer which follow the first "length" characters.  Stream
+   socket lines send both segments with a single gather write, other lines
+   only write the first segment.
 */
 
-static int32 tmxr_write (TMLN *lp, int32 length)
+static int32 tmxr_write (TMLN *lp, int32 length, int32 wrap_length)
 {
 int32 written = 0;
 int32 i = lp->txbpr;
@@ -759,9 +1304,14 @@ if (lp->serport) {                                      /* serial port connectio
 else {
     if (lp->framer)
         written = tmxr_framer_write (lp,  &(lp->txb[i]), length);
+    else if (lp->shmlink)                                   /* shared memory link */
+        written = tmxr_shm_write (lp, &(lp->txb[i]), length, lp->txb, wrap_length);
     else {
         if (lp->sock) {                                     /* Telnet connection */
-            written = sim_write_sock (lp->sock, &(lp->txb[i]), length);
+            if ((wrap_length > 0) && (!lp->datagram))
+                written = sim_write_sock_v (lp->sock, &(lp->txb[i]), length, lp->txb, wrap_length);
+            else
+                written = sim_write_sock (lp->sock, &(lp->txb[i]), length);
 
             if (written == SOCKET_ERROR) {                  /* did an error occur? */
                 lp->txdone = TRUE;
@@ -790,25 +1340,6 @@ return written;
 }
 
 
-/* Remove a character from the read buffer.
-
-   The character at position "p" in the read buffer associated with line "lp" is
-   removed by moving all of the following received characters down one position.
-   The receive break status array is adjusted accordingly.
-*/
-
-static void tmxr_rmvrc (TMLN *lp, int32 p)
-{
-for ( ; p < lp->rxbpi; p++) {                           /* work from "p" through end of buffer */
-    lp->rxb[p] = lp->rxb[p + 1];                        /* slide following character down */
-    lp->rbr[p] = lp->rbr[p + 1];                        /* adjust break status too */
-    }
-
-lp->rbr[p] = 0;                                         /* clear potential break from vacated slot */
-lp->rxbpi = lp->rxbpi - 1;                              /* drop buffer insert index */
-}
-
-
 /* Find a line descriptor indicated by unit or number.
 
    If "uptr" is NULL, then the line descriptor is determined by the line number
@@ -935,6 +1466,8 @@ if (mp->logfiletmpl[0])                                 /* logfile info */
     sprintf (growstring(&tptr, 7 + strlen (mp->logfiletmpl)), ",Log=%s", mp->logfiletmpl);
 if (mp->buffered)
     sprintf (growstring(&tptr, 10 + 10), ",Buffered=%d", mp->buffered);
+if (mp->txcoalesce)
+    sprintf (growstring(&tptr, 10 + 10), ",Coalesce=%u", mp->txcoalesce);
 while ((*tptr == ',') || (*tptr == ' '))
     memmove (tptr, tptr+1, strlen(tptr+1)+1);
 for (i=0; i<mp->lines; ++i) {
@@ -984,7 +1517,7 @@ tptr = (char *) calloc (1, 1);
 if (tptr == NULL)                                       /* no more mem? */
     return tptr;
 
-if (lp->destination || lp->port || lp->txlogname || (lp->conn == TMXR_LINE_DISABLED)) {
+if (lp->destination || lp->port || lp->txlogname || lp->shmlink || (lp->conn == TMXR_LINE_DISABLED)) {
     if ((lp->mp->lines > 1) || (lp->port))
         sprintf (growstring(&tptr, 32), "Line=%d", (int)(lp-lp->mp->ldsc));
     if (lp->conn == TMXR_LINE_DISABLED)
@@ -999,6 +1532,12 @@ if (lp->destination || lp->port || lp->txlogname || (lp->conn == TMXR_LINE_DISAB
         sprintf (growstring(&tptr, 8), ",%s", lp->datagram ? "UDP" : "TCP");
     if (lp->mp->packet != lp->packet)
         sprintf (growstring(&tptr, 8), ",Packet");
+    if (lp->sockopts & SIM_SOCK_OPT_NODELAY)
+        sprintf (growstring(&tptr, 16), ",NoDelay");
+    if (lp->sockopts & SIM_SOCK_OPT_NOKEEPALIVE)
+        sprintf (growstring(&tptr, 16), ",NoKeepAlive");
+    if (lp->sockopts & SIM_SOCK_OPT_REUSEPORT)
+        sprintf (growstring(&tptr, 16), ",ReusePort");
     if (lp->port) {
         sprintf (growstring(&tptr, 32 + strlen (lp->port)), ",%s%s%s", lp->port, 
                                                                        ((lp->mp->notelnet != lp->notelnet) && (!lp->datagram)) ? (lp->notelnet ? ";notelnet" : ";telnet") : "", 
@@ -1027,6 +1566,8 @@ if (lp->destination || lp->port || lp->txlogname || (lp->conn == TMXR_LINE_DISAB
         sprintf (growstring(&tptr, 12 + strlen (lp->txlogname)), ",Log=%s", lp->txlogname);
     if (lp->loopback)
         sprintf (growstring(&tptr, 12 ), ",Loopback");
+    if (lp->shmlink)
+        sprintf (growstring(&tptr, 6 + strlen (lp->shmlink->name)), ",SHM=%s", lp->shmlink->name);
     }
 if (*tptr == '\0') {
     free (tptr);
@@ -1070,6 +1611,7 @@ TMLN *lp;
 int32 *op;
 int32 i, j;
 int32 ringing = -1;
+t_bool conn_set;
 char *address;
 char msg[512];
 uint32 poll_time = sim_os_msec ();
@@ -1112,7 +1654,7 @@ if (mp->last_poll_time == 0) {                          /* first poll initializa
         }
     }
 
-if (sim_is_running && 
+if (sim_is_running && (!mp->conn_backlog) &&           /* not draining the listener and */
     ((poll_time - mp->last_poll_time) < mp->poll_interval*1000))
     return -1;                                          /* too soon to try */
 
@@ -1129,9 +1671,12 @@ if (mp->master) {
         mp->ring_sock = INVALID_SOCKET;
         address = mp->ring_ipad;
         mp->ring_ipad = NULL;
+        mp->conn_backlog = FALSE;
         }
-    else
+    else {
         newsock = sim_accept_conn_ex (mp->master, &address, (mp->packet ? SIM_SOCK_OPT_NODELAY : 0));/* poll connect */
+        mp->conn_backlog = (newsock != INVALID_SOCKET); /* keep accepting until drained */
+        }
 
     if (newsock != INVALID_SOCKET) {                    /* got a live one? */
         snprintf (msg, sizeof (msg) - 1, "tmxr_poll_conn() - Connection from %s", address);
@@ -1163,6 +1708,7 @@ if (mp->master) {
                 if ((lp->conn == FALSE) &&                  /* is the line available? */
                     (lp->destination == NULL) &&
                     (lp->master == 0) &&
+                    (lp->shmlink == NULL) &&
                     (lp->ser_connect_pending == FALSE) &&
                     (lp->modem_control ? ((lp->modembits & TMXR_MDM_DTR) != 0) : TRUE))
                     break;                                  /* yes, so stop search */
@@ -1173,7 +1719,7 @@ if (mp->master) {
 
                 for (j = 0; j < mp->lines; j++, i++) {      /* find next avail line */
                     lp = mp->ldsc + j;                      /* get pointer to line descriptor */
-                    if (lp->framer)
+                    if (lp->framer || lp->shmlink)
                         continue;
                     
                     if ((lp->conn == FALSE) &&              /* is the line available? */
@@ -1246,6 +1792,7 @@ if (mp->master) {
     }
 
 /* Look for per line listeners or outbound connecting sockets */
+conn_set = _tmxr_conn_poll (mp);                        /* find lines with connection activity */
 for (i = 0; i < mp->lines; i++) {                       /* check each line in sequence */
     int j, r = rand();
     lp = mp->ldsc + i;                                  /* get pointer to line descriptor */
@@ -1269,6 +1816,17 @@ for (i = 0; i < mp->lines; i++) {                       /* check each line in se
         continue;
         }
 
+    /* Shared memory link: connected while the other end is attached */
+    if (lp->shmlink) {
+        if ((!lp->conn) && tmxr_shm_peer (lp)) {
+            lp->conn = TRUE;                            /* record connection */
+            lp->cnms = sim_os_msec ();
+            tmxr_init_line (lp);
+            return i;
+            }
+        continue;
+        }
+
     /* Don't service network connections for loopbacked lines */
 
     if (lp->loopback)
@@ -1286,12 +1844,14 @@ for (i = 0; i < mp->lines; i++) {                       /* check each line in se
     for (j=0; j<2; j++)
         switch ((j+r)&1) {
             case 0:
-                if (lp->connecting) {                           /* connecting? */
+                if (lp->connecting &&                           /* connecting and */
+                    ((!conn_set) || lp->conn_ready[1])) {       /* progress reported? */
                     char *sockname, *peername;
 
                     switch (sim_check_conn(lp->connecting, FALSE))
                         {
                         case 1:                                 /* successful connection */
+                            _tmxr_conn_unwatch (lp);            /* leave connection set */
                             lp->conn = TRUE;                    /* record connection */
                             lp->sock = lp->connecting;          /* it now looks normal */
                             lp->connecting = 0;
@@ -1319,8 +1879,9 @@ for (i = 0; i < mp->lines; i++) {                       /* check each line in se
                     }
                 break;
             case 1:
-                if (lp->master) {                                   /* Check for a pending Telnet/tcp connection */
-                    while (INVALID_SOCKET != (newsock = sim_accept_conn_ex (lp->master, &address, (lp->packet ? SIM_SOCK_OPT_NODELAY : 0)))) {/* got a live one? */
+                if (lp->master &&                                   /* Check for a pending Telnet/tcp connection */
+                    ((!conn_set) || lp->conn_ready[0])) {
+                    while (INVALID_SOCKET != (newsock = sim_accept_conn_ex (lp->master, &address, _tmxr_sockopts (lp)))) {/* got a live one? */
                         char *sockname, *peername;
 
                         sim_getnames_sock (newsock, &sockname, &peername);
@@ -1356,6 +1917,7 @@ for (i = 0; i < mp->lines; i++) {                       /* check each line in se
                             if (lp->connecting) {
                                 snprintf (msg, sizeof (msg) -1, "tmxr_poll_conn() - aborting outgoing line connection attempt to: %s", lp->destination);
                                 tmxr_debug_connect_line (lp, msg);
+                                _tmxr_conn_unwatch (lp);            /* leave connection set */
                                 sim_close_sock (lp->connecting);    /* abort our as yet unconnnected socket */
                                 lp->connecting = 0;
                                 }
@@ -1401,7 +1963,7 @@ for (i = 0; i < mp->lines; i++) {                       /* check each line in se
         snprintf (msg, sizeof (msg) - 1, "tmxr_poll_conn() - establishing outgoing connection to: %s", lp->destination);
         tmxr_debug_connect_line (lp, msg);
         lp->connecting = sim_connect_sock_ex (lp->datagram ? lp->port : NULL, lp->destination, "localhost", NULL, (lp->datagram ? SIM_SOCK_OPT_DATAGRAM : 0)  | 
-                                                                                                                  (lp->mp->packet ? SIM_SOCK_OPT_NODELAY : 0));
+                                                                                                                  (lp->mp->packet ? SIM_SOCK_OPT_NODELAY : 0) | lp->sockopts);
         }
 
     }
@@ -1434,6 +1996,7 @@ tmxr_debug_connect_line (lp, msg);
 
 if (lp->serport) {
     if (closeserial) {
+        _tmxr_ready_remove (lp);                        /* leave readiness set */
         sim_close_serial (lp->serport);
         lp->serport = 0;
         lp->ser_connect_pending = FALSE;
@@ -1453,6 +2016,7 @@ if (lp->serport) {
     }
 else                                                    /* Telnet connection */
     if (lp->sock) {
+        _tmxr_ready_remove (lp);                        /* leave readiness set */
         sim_close_sock (lp->sock);                      /* close socket */
         free (lp->telnet_sent_opts);
         lp->telnet_sent_opts = NULL;
@@ -1461,8 +2025,15 @@ else                                                    /* Telnet connection */
         lp->cnms = 0;
         lp->xmte = 1;
         }
+    else
+        if (lp->shmlink) {                              /* shared memory link? */
+            lp->conn = FALSE;                           /* reconnects while the peer is attached */
+            lp->cnms = 0;
+            lp->xmte = 1;
+            }
 free(lp->ipad);
 lp->ipad = NULL;
+_tmxr_conn_unwatch (lp);                                /* leave connection set */
 if ((lp->destination) && (!lp->serport)) {
     if (lp->connecting) {
         sim_close_sock (lp->connecting);
@@ -1472,7 +2043,7 @@ if ((lp->destination) && (!lp->serport)) {
         sprintf (msg, "tmxr_reset_ln_ex() - connecting to %s", lp->destination);
         tmxr_debug_connect_line (lp, msg);
         lp->connecting = sim_connect_sock_ex (lp->datagram ? lp->port : NULL, lp->destination, "localhost", NULL, (lp->datagram ? SIM_SOCK_OPT_DATAGRAM : 0) | 
-                                                                                                                  (lp->packet ? SIM_SOCK_OPT_NODELAY : 0));
+                                                                                                                  _tmxr_sockopts (lp));
         }
     }
 tmxr_init_line (lp);                                /* initialize line state */
@@ -1827,7 +2398,7 @@ if (lp->framer) {
 before_modem_bits = lp->modembits;
 lp->modembits |= bits_to_set;
 lp->modembits &= ~bits_to_clear;
-if ((lp->sock) || (lp->serport) || (lp->loopback)) {
+if ((lp->sock) || (lp->serport) || (lp->loopback) || (lp->shmlink)) {
     if (lp->modembits & TMXR_MDM_DTR) {
         incoming_state = TMXR_MDM_DSR;
         if (lp->modembits & TMXR_MDM_RTS)
@@ -1926,7 +2497,7 @@ if (lp->mp && lp->modem_control) {                  /* This API ONLY works on mo
                 sprintf (msg, "tmxr_set_get_modem_bits() - establishing outgoing connection to: %s", lp->destination);
                 tmxr_debug_connect_line (lp, msg);
                 lp->connecting = sim_connect_sock_ex (lp->datagram ? lp->port : NULL, lp->destination, "localhost", NULL, (lp->datagram ? SIM_SOCK_OPT_DATAGRAM : 0) | 
-                                                                                                                          (lp->packet ? SIM_SOCK_OPT_NODELAY : 0));
+                                                                                                                          _tmxr_sockopts (lp));
                 }
             }
         }
@@ -2175,15 +2746,19 @@ return SCPE_LOST;
 
 void tmxr_poll_rx (TMXR *mp)
 {
-int32 i, nbytes, j;
+int32 i, nbytes, j, k;
 TMLN *lp;
+t_bool ready;
 
 tmxr_debug_trace (mp, "tmxr_poll_rx()");
+ready = _tmxr_ready_poll (mp);                          /* find lines with input */
 for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
     lp = mp->ldsc + i;                                  /* get line desc */
-    if (!(lp->sock || lp->serport || lp->loopback || lp->framer) || 
+    if (!(lp->sock || lp->serport || lp->loopback || lp->framer || lp->shmlink) || 
         !(lp->rcve))                                    /* skip if not connected */
         continue;
+    if (ready && !lp->rx_ready)                         /* no input pending? */
+        continue;
 
     nbytes = 0;
     if (lp->rxbpi == 0)                                 /* need input? */
@@ -2211,34 +2786,51 @@ for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
         lp->rxbpi = lp->rxbpi + nbytes;                 /* adv pointers */
         lp->rxcnt = lp->rxcnt + nbytes;
 
-/* Examine new data, remove TELNET cruft before making input available */
+/* Examine new data, remove TELNET cruft before making input available.
+   Characters are examined at "j" and the ones kept are packed down to "k",
+   so the buffer is compacted in a single pass.  Runs of ordinary characters
+   are found with memchr and are left where they are until some earlier
+   character has been removed. */
 
         if (!lp->notelnet) {                            /* Are we looking for telnet interpretation? */
-            for (; j < lp->rxbpi; ) {                   /* loop thru char */
+            for (k = j; j < lp->rxbpi; ) {              /* loop thru char */
                 u_char tmp = (u_char)lp->rxb[j];        /* get char */
                 switch (lp->tsta) {                     /* case tlnt state */
 
                 case TNS_NORM:                          /* normal */
                     if (tmp == TN_IAC) {                /* IAC? */
                         lp->tsta = TNS_IAC;             /* change state */
-                        tmxr_rmvrc (lp, j);             /* remove char */
-                        break;
+                        j = j + 1;                      /* remove char */
+                        }
+                    else {                              /* run of data up to next IAC */
+                        char *nxt = (char *)memchr (&lp->rxb[j], TN_IAC, lp->rxbpi - j);
+                        int32 run = (nxt != NULL) ? (int32)(nxt - &lp->rxb[j]) : lp->rxbpi - j;
+
+                        if (lp->dstb &&                 /* no bin and CR in run? */
+                            ((nxt = (char *)memchr (&lp->rxb[j], TN_CR, run)) != NULL)) {
+                            run = (int32)(nxt - &lp->rxb[j]) + 1;/* stop after CR */
+                            lp->tsta = TNS_CRPAD;       /* skip pad char */
+                            }
+                        if (k != j) {                   /* something removed before? */
+                            memmove (&lp->rxb[k], &lp->rxb[j], run);
+                            memmove (&lp->rbr[k], &lp->rbr[j], run);
+                            }
+                        k = k + run;                    /* keep run */
+                        j = j + run;
                         }
-                    if ((tmp == TN_CR) && lp->dstb)     /* CR, no bin */
-                        lp->tsta = TNS_CRPAD;           /* skip pad char */
-                    j = j + 1;                          /* advance j */
                     break;
 
                 case TNS_IAC:                           /* IAC prev */
                     if (tmp == TN_IAC) {                /* IAC + IAC */
                         lp->tsta = TNS_NORM;            /* treat as normal */
-                        j = j + 1;                      /* advance j */
-                        break;                          /* keep IAC */
+                        lp->rxb[k] = lp->rxb[j];        /* keep IAC */
+                        lp->rbr[k++] = lp->rbr[j++];
+                        break;
                         }
                     if (tmp == TN_BRK) {                /* IAC + BRK? */
                         lp->tsta = TNS_NORM;            /* treat as normal */
-                        lp->rxb[j] = 0;                 /* char is null */
-                        lp->rbr[j] = 1;                 /* flag break */
+                        lp->rxb[k] = 0;                 /* char is null */
+                        lp->rbr[k++] = 1;               /* flag break */
                         j = j + 1;                      /* advance j */
                         break;
                         }
@@ -2267,7 +2859,7 @@ for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
                         lp->tsta = TNS_NORM;            /* ignore */
                         break;
                         }
-                    tmxr_rmvrc (lp, j);                 /* remove char */
+                    j = j + 1;                          /* remove char */
                     break;
 
                 case TNS_WILL:                          /* IAC+WILL prev */
@@ -2324,7 +2916,7 @@ for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
                             lp->dstb = 1;
                             }
                         }
-                    tmxr_rmvrc (lp, j);                 /* remove it */
+                    j = j + 1;                          /* remove it */
                     lp->tsta = TNS_NORM;                /* next normal */
                     break;
 
@@ -2346,7 +2938,7 @@ for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
                     lp->tsta = TNS_NORM;                /* next normal */
                     if ((tmp == TN_LF) ||               /* CR + LF ? */
                         (tmp == TN_NUL))                /* CR + NUL? */
-                        tmxr_rmvrc (lp, j);             /* remove it */
+                        j = j + 1;                      /* remove it */
                     break;
 
                 case TNS_DO:                            /* pending DO request */
@@ -2396,11 +2988,13 @@ for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
                         }
                     /* fall through */
                 case TNS_SKIP: default:                 /* skip char */
-                    tmxr_rmvrc (lp, j);                 /* remove char */
+                    j = j + 1;                          /* remove char */
                     lp->tsta = TNS_NORM;                /* next normal */
                     break;
                     }                                   /* end case state */
                 }                                       /* end for char */
+            memset (&lp->rbr[k], 0, lp->rxbpi - k);     /* clear break status from vacated slots */
+            lp->rxbpi = k;                              /* drop buffer insert index */
             if (nbytes != (lp->rxbpi-lp->rxbpr)) {
                 tmxr_debug (TMXR_DBG_RCV, lp, "Remaining", &(lp->rxb[lp->rxbpr]), lp->rxbpi-lp->rxbpr);
                 }
@@ -2509,6 +3103,58 @@ if ((lp->conn && (TXBUF_AVAIL(lp) > 1)) ||              /* connected and room fo
 return SCPE_STALL;                                      /* char not sent */
 }
 
+/* Store a buffer of characters in line buffer
+
+   Inputs:
+        *lp     =       pointer to line descriptor
+        *buf    =       pointer to characters
+        size    =       number of characters
+        *sent   =       pointer to count of characters stored
+   Outputs:
+        status  =       ok, connection lost, or stall
+
+   Implementation notes:
+
+    1. Characters are stored as by tmxr_putc_ln, so telnet IAC doubling,
+       logging and expect processing all still apply.  When the line
+       buffer fills, the buffered data is sent and the store retried
+       once before SCPE_STALL is returned.
+    2. When output is rate limited, at most the characters the line
+       speed allows in TMXR_PUT_BUF_USECS are stored per call.  Once
+       written, the line's next transmit time advances by the whole
+       burst, so the average output rate still matches the line speed.
+    3. The number of characters actually stored is returned in *sent,
+       which may be less than size even when SCPE_OK is returned.
+*/
+
+#define TMXR_PUT_BUF_USECS 10000    /* rate limited burst duration */
+
+t_stat tmxr_put_buf_ln (TMLN *lp, const uint8 *buf, size_t size, size_t *sent)
+{
+size_t budget = size;
+t_stat r = SCPE_OK;
+
+*sent = 0;
+if ((lp->txbps) && (lp->txdeltausecs)) {                /* rate limiting output? */
+    budget = TMXR_PUT_BUF_USECS / lp->txdeltausecs;
+    if (budget == 0)
+        budget = 1;
+    if (budget > size)
+        budget = size;
+    }
+while (*sent < budget) {
+    r = tmxr_putc_ln (lp, buf[*sent]);
+    if (r == SCPE_STALL) {                              /* full? */
+        tmxr_send_buffered_data (lp);                   /* flush and try again */
+        r = tmxr_putc_ln (lp, buf[*sent]);
+        }
+    if (r != SCPE_OK)
+        break;
+    ++*sent;
+    }
+return r;
+}
+
 /* Store packet in line buffer
 
    Inputs:
@@ -2616,16 +3262,31 @@ t_stat r;
 
 tmxr_debug_trace_line (lp, "tmxr_send_buffered_data()");
 nbytes = tmxr_tqln(lp);                                 /* avail bytes */
+if (nbytes && lp->mp && lp->mp->txcoalesce &&           /* coalescing output? */
+    lp->sock && (!lp->datagram) && (!lp->packet) &&
+    sim_is_running && (nbytes < lp->txbsz / 2)) {       /*   and buffer not filling? */
+    double now = sim_gtime ();
+
+    if (lp->txcoalesce_time == 0.0)                     /* start of window */
+        lp->txcoalesce_time = now;
+    if ((now - lp->txcoalesce_time) < ((lp->mp->txcoalesce * sim_timer_inst_per_sec ()) / USECS_PER_SECOND))
+        return nbytes + tmxr_tpqln (lp);                /* hold for more output */
+    }
+lp->txcoalesce_time = 0.0;
 if (nbytes) {                                           /* >0? write */
     if (lp->txbpr < lp->txbpi)                          /* no wrap? */
-        sbytes = tmxr_write (lp, nbytes);               /* write all data */
-    else
-        sbytes = tmxr_write (lp, lp->txbsz - lp->txbpr);/* write to end buf */
+        sbytes = tmxr_write (lp, nbytes, 0);            /* write all data */
+    else                                                /* write to end buf and wrapped data */
+        sbytes = tmxr_write (lp, lp->txbsz - lp->txbpr, lp->txbpi);
     if (sbytes >= 0) {                                  /* ok? */
-        tmxr_debug (TMXR_DBG_XMT, lp, "Sent", &(lp->txb[lp->txbpr]), sbytes);
+        int32 tbytes = MIN (sbytes, lp->txbsz - lp->txbpr);
+
+        tmxr_debug (TMXR_DBG_XMT, lp, "Sent", &(lp->txb[lp->txbpr]), tbytes);
+        if (sbytes > tbytes)                            /* gathered wrapped data? */
+            tmxr_debug (TMXR_DBG_XMT, lp, "Sent", lp->txb, sbytes - tbytes);
         lp->txbpr = (lp->txbpr + sbytes);               /* update remove ptr */
         if (lp->txbpr >= lp->txbsz)                     /* wrap? */
-            lp->txbpr = 0;
+            lp->txbpr -= lp->txbsz;
         lp->txcnt = lp->txcnt + sbytes;                 /* update counts */
         nbytes = nbytes - sbytes;
         if ((nbytes == 0) && (lp->datagram))            /* if Empty buffer on datagram line */
@@ -2638,7 +3299,7 @@ if (nbytes) {                                           /* >0? write */
         return nbytes;                                  /*  done now. */
         }
     if (nbytes && (lp->txbpr == 0))     {               /* more data and wrap? */
-        sbytes = tmxr_write (lp, nbytes);
+        sbytes = tmxr_write (lp, nbytes, 0);
         if (sbytes > 0) {                               /* ok */
             tmxr_debug (TMXR_DBG_XMT, lp, "Sent", lp->txb, sbytes);
             lp->txbpr = (lp->txbpr + sbytes);           /* update remove ptr */
@@ -2709,7 +3370,13 @@ if (lp->framer) {
     free (lp->framer);
     lp->framer = NULL;
     }
+if (lp->shmlink) {
+    if (lp->conn)
+        tmxr_reset_ln (lp);
+    tmxr_shm_close (lp);
+    }
 if (close_listener && lp->master) {
+    _tmxr_conn_unwatch (lp);                /* leave connection set */
     sim_close_sock (lp->master);
     lp->master = 0;
     free (lp->port);
@@ -2731,6 +3398,7 @@ if (close_connecting) {
 if (lp->serport) {                          /* close current serial connection */
     tmxr_reset_ln (lp);
     sim_control_serial (lp->serport, 0, TMXR_MDM_DTR|TMXR_MDM_RTS, NULL);/* drop DTR and RTS */
+    _tmxr_ready_remove (lp);                /* leave readiness set */
     sim_close_serial (lp->serport);
     lp->serport = 0;
     free (lp->serconfig);
@@ -2907,6 +3575,7 @@ char tbuf[CBUFSIZE], listen[CBUFSIZE], destination[CBUFSIZE],
      port[CBUFSIZE], option[CBUFSIZE], speed[CBUFSIZE], dev_name[CBUFSIZE],
      acl[CBUFSIZE];
 char framer[CBUFSIZE],fr_eth[CBUFSIZE];
+char shmname[CBUFSIZE];
 int num;
 int8 fr_mode;
 int32 fr_speed;
@@ -2916,6 +3585,7 @@ SOCKET sock;
 SERHANDLE serport;
 CONST char *tptr = cptr;
 t_bool nolog, notelnet, listennotelnet, nomessage, listennomessage, modem_control, loopback, datagram, packet, disabled;
+int sockopts;
 TMLN *lp;
 t_stat r = SCPE_OK;
 
@@ -2947,9 +3617,11 @@ while (*tptr) {
     memset(option,      '\0', sizeof(option));
     memset(speed,       '\0', sizeof(speed));
     memset(framer,      '\0', sizeof(framer));
+    memset(shmname,     '\0', sizeof(shmname));
     nolog = loopback = disabled = FALSE;
     datagram = mp->datagram;
     packet = mp->packet;
+    sockopts = 0;
     if (mp->buffered)
         sprintf(buffered, "%d", mp->buffered);
     if (line != -1) {
@@ -3005,6 +3677,23 @@ while (*tptr) {
                     }
                 continue;
                 }
+            if (0 == MATCH_CMD (gbuf, "COALESCE")) {
+                if ((NULL == cptr) || ('\0' == *cptr))
+                    mp->txcoalesce = 1000;
+                else {
+                    i = (int32) get_uint (cptr, 10, 1000000, &r);
+                    if (r || (i == 0))
+                        return sim_messagef (SCPE_ARG, "Invalid Coalesce Specifier: %s\n", cptr);
+                    mp->txcoalesce = (uint32)i;
+                    }
+                continue;
+                }
+            if (0 == MATCH_CMD (gbuf, "NOCOALESCE")) {
+                if ((NULL != cptr) && ('\0' != *cptr))
+                    return sim_messagef (SCPE_2MARG, "Unexpected NoCoalesce Specifier: %s\n", cptr);
+                mp->txcoalesce = 0;
+                continue;
+                }
             if (0 == MATCH_CMD (gbuf, "NOLOG")) {
                 if ((NULL != cptr) && ('\0' != *cptr))
                     return sim_messagef (SCPE_2MARG, "Unexpected NoLog Specifier: %s\n", cptr);
@@ -3035,6 +3724,30 @@ while (*tptr) {
                 packet = TRUE;
                 continue;
                 }
+            if (0 == MATCH_CMD (gbuf, "NODELAY")) {
+                if ((NULL != cptr) && ('\0' != *cptr))
+                    return sim_messagef (SCPE_2MARG, "Unexpected NoDelay Specifier: %s\n", cptr);
+                sockopts |= SIM_SOCK_OPT_NODELAY;
+                continue;
+                }
+            if (0 == MATCH_CMD (gbuf, "NOKEEPALIVE")) {
+                if ((NULL != cptr) && ('\0' != *cptr))
+                    return sim_messagef (SCPE_2MARG, "Unexpected NoKeepAlive Specifier: %s\n", cptr);
+                sockopts |= SIM_SOCK_OPT_NOKEEPALIVE;
+                continue;
+                }
+            if (0 == MATCH_CMD (gbuf, "KEEPALIVE")) {
+                if ((NULL != cptr) && ('\0' != *cptr))
+                    return sim_messagef (SCPE_2MARG, "Unexpected KeepAlive Specifier: %s\n", cptr);
+                sockopts &= ~SIM_SOCK_OPT_NOKEEPALIVE;
+                continue;
+                }
+            if (0 == MATCH_CMD (gbuf, "REUSEPORT")) {
+                if ((NULL != cptr) && ('\0' != *cptr))
+                    return sim_messagef (SCPE_2MARG, "Unexpected ReusePort Specifier: %s\n", cptr);
+                sockopts |= SIM_SOCK_OPT_REUSEPORT;
+                continue;
+                }
             if ((0 == MATCH_CMD (gbuf, "STREAM")) || (0 == MATCH_CMD (gbuf, "TCP"))) {
                 if ((NULL != cptr) && ('\0' != *cptr))
                     return sim_messagef (SCPE_2MARG, "Unexpected Stream Specifier: %s\n", cptr);
@@ -3054,6 +3767,14 @@ while (*tptr) {
                 nomessage = notelnet = datagram = TRUE;
                 continue;
                 }
+            if (0 == MATCH_CMD (gbuf, "SHM")) {
+                if ((NULL == cptr) || ('\0' == *cptr))
+                    return sim_messagef (SCPE_2FARG, "Missing Shared Memory Link Specifier\n");
+                strlcpy (shmname, cptr, sizeof(shmname));
+                nomessage = notelnet = TRUE;
+                datagram = FALSE;
+                continue;
+                }
             if (0 == MATCH_CMD (gbuf, "DISABLED")) {
                 if ((NULL != cptr) && ('\0' != *cptr))
                     return sim_messagef (SCPE_2FARG, "Unexpected Disabled Specifier: %s\n", cptr);
@@ -3162,8 +3883,14 @@ while (*tptr) {
             }
         }
     if (disabled) {
+        if (destination[0] || listen[0] || loopback || framer[0] || shmname[0])
+            return sim_messagef (SCPE_ARG, "Can't disable line with%s%s%s%s%s%s%s%s%s\n", destination[0] ? " CONNECT=" : "", destination, listen[0] ? " " : "", listen, loopback ? " LOOPBACK" : "", framer[0] ? " SYNC=" : "", framer, shmname[0] ? " SHM=" : "", shmname);
+        }
+    if (shmname[0]) {
         if (destination[0] || listen[0] || loopback || framer[0])
-            return sim_messagef (SCPE_ARG, "Can't disable line with%s%s%s%s%s%s%s\n", destination[0] ? " CONNECT=" : "", destination, listen[0] ? " " : "", listen, loopback ? " LOOPBACK" : "", framer[0] ? " SYNC=" : "", framer);
+            return sim_messagef (SCPE_ARG, "Can't combine SHM=%s with%s%s%s%s%s%s%s\n", shmname, 
+                    destination[0] ? " CONNECT=" : "", destination, listen[0] ? " " : "", listen, 
+                    loopback ? " LOOPBACK" : "", framer[0] ? " SYNC=" : "", framer);
         }
     if (destination[0]) {
         /* Validate destination */
@@ -3259,6 +3986,8 @@ while (*tptr) {
             return sim_messagef (SCPE_ARG, "Must specify line to disable\n");
         if (framer[0])
             return sim_messagef (SCPE_ARG, "Must specify line for framer\n");
+        if (shmname[0])
+            return sim_messagef (SCPE_ARG, "Must specify line for shared memory link\n");
         if (modem_control != mp->modem_control)
             return SCPE_ARG;
         if (logfiletmpl[0]) {
@@ -3345,6 +4074,7 @@ while (*tptr) {
                 if (lp->serport) {                          /* serial port attached? */
                     tmxr_reset_ln (lp);                     /* close current serial connection */
                     sim_control_serial (lp->serport, 0, TMXR_MDM_DTR|TMXR_MDM_RTS, NULL);/* drop DTR and RTS */
+                    _tmxr_ready_remove (lp);                /* leave readiness set */
                     sim_close_serial (lp->serport);
                     lp->serport = 0;
                     free (lp->serconfig);
@@ -3406,8 +4136,9 @@ while (*tptr) {
                         return sim_messagef (SCPE_ARG, "Missing listen port for Datagram socket\n");
                     }
                 lp->packet = packet;
+                lp->sockopts = sockopts;
                 sock = sim_connect_sock_ex (datagram ? listen : NULL, hostport, "localhost", NULL, (datagram ? SIM_SOCK_OPT_DATAGRAM : 0) | 
-                                                                                                   (packet ? SIM_SOCK_OPT_NODELAY : 0));
+                                                                                                   (packet ? SIM_SOCK_OPT_NODELAY : 0) | sockopts);
                 if (sock != INVALID_SOCKET) {
                     _mux_detach_line (lp, FALSE, TRUE);
                     lp->destination = (char *)malloc(1+strlen(hostport));
@@ -3522,6 +4253,7 @@ while (*tptr) {
         lp->rxb = (char *)realloc(lp->rxb, lp->rxbsz);
         lp->rbr = (char *)realloc(lp->rbr, lp->rxbsz);
         lp->packet = packet;
+        lp->sockopts = sockopts;
         if (nolog) {
             free(lp->txlogname);
             lp->txlogname = NULL;
@@ -3530,10 +4262,20 @@ while (*tptr) {
                 lp->txlog = NULL;
                 }
             }
+        if (shmname[0]) {
+            _mux_detach_line (lp, TRUE, TRUE);
+            r = tmxr_shm_open (lp, shmname);
+            if (r != SCPE_OK)
+                return r;
+            lp->datagram = FALSE;
+            lp->notelnet = lp->nomessage = TRUE;
+            tmxr_init_line (lp);                            /* connects when the peer attaches */
+            }
         if ((listen[0]) && (!datagram)) {
             if ((mp->lines == 1) && (mp->master))
                 return sim_messagef (SCPE_ARG, "Single Line MUX can have either line specific OR MUX listener but NOT both\n");
-            sock = sim_master_sock (listen, &r);            /* make master socket */
+            sock = sim_master_sock_ex (listen, &r, ((sim_switches & SWMASK ('U')) ? SIM_SOCK_OPT_REUSEADDR : 0) | 
+                                                   (sockopts & SIM_SOCK_OPT_REUSEPORT));/* make master socket */
             if (r)
                 return sim_messagef (SCPE_ARG, "Invalid Listen Specification: %s\n", listen);
             if (sock == INVALID_SOCKET)                     /* open error */
@@ -3582,7 +4324,7 @@ while (*tptr) {
                             return sim_messagef (SCPE_ARG, "Missing listen port for Datagram socket\n");
                         }
                     sock = sim_connect_sock_ex (datagram ? listen : NULL, hostport, "localhost", NULL, (datagram ? SIM_SOCK_OPT_DATAGRAM : 0) | 
-                                                                                                       (packet ? SIM_SOCK_OPT_NODELAY : 0));
+                                                                                                       (packet ? SIM_SOCK_OPT_NODELAY : 0) | sockopts);
                     if (sock != INVALID_SOCKET) {
                         _mux_detach_line (lp, FALSE, TRUE);
                         lp->destination = (char *)malloc(1+strlen(hostport));
@@ -3744,8 +4486,8 @@ int wait_count = 0;
 
 /* Boost Priority for this I/O thread vs the CPU instruction execution 
    thread which, in general, won't be readily yielding the processor when 
-   this thread needs to run */
-sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
+   this thread needs to run, and place it as configured */
+sim_os_set_thread_placement (SIM_THREAD_IO);
 
 sim_debug (TMXR_DBG_ASY, dptr, "_tmxr_poll() - starting\n");
 
@@ -3959,8 +4701,8 @@ int wait_count = 0;
 
 /* Boost Priority for this I/O thread vs the CPU instruction execution 
    thread which, in general, won't be readily yielding the processor when 
-   this thread needs to run */
-sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
+   this thread needs to run, and place it as configured */
+sim_os_set_thread_placement (SIM_THREAD_IO);
 
 sim_debug (TMXR_DBG_ASY, dptr, "_tmxr_serial_poll() - starting\n");
 
@@ -4089,8 +4831,8 @@ int wait_count = 0;
 
 /* Boost Priority for this I/O thread vs the CPU instruction execution 
    thread which, in general, won't be readily yielding the processor when 
-   this thread needs to run */
-sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
+   this thread needs to run, and place it as configured */
+sim_os_set_thread_placement (SIM_THREAD_IO);
 
 sim_debug (TMXR_DBG_ASY, dptr, "_tmxr_serial_line_poll() - starting\n");
 
@@ -4319,6 +5061,80 @@ pthread_mutex_unlock (&sim_tmxr_poll_lock);
 #endif
 }
 
+/* Replace an inherited listen socket with one on the port offset from it */
+
+static t_stat _tmxr_clone_listen (SOCKET *master, char **port, int32 port_offset)
+{
+char host[CBUFSIZE], pbuf[CBUFSIZE], listen[2*CBUFSIZE+2];
+SOCKET sock;
+t_stat r;
+
+sim_release_sock (*master);
+*master = 0;
+if (sim_parse_addr (*port, host, sizeof (host), NULL, pbuf, sizeof (pbuf), NULL, NULL))
+    return sim_messagef (SCPE_ARG, "Invalid listen port: %s\n", *port);
+if (host[0])
+    sprintf (listen, "%s:%d", host, atoi (pbuf) + port_offset);
+else
+    sprintf (listen, "%d", atoi (pbuf) + port_offset);
+sock = sim_master_sock (listen, &r);
+if ((r != SCPE_OK) || (sock == INVALID_SOCKET))
+    return sim_messagef (SCPE_OPENERR, "Can't listen on port: %s\n", listen);
+sim_messagef (SCPE_OK, "Listening on port %s\n", listen);
+*port = (char *)realloc (*port, 1 + strlen (listen));
+strcpy (*port, listen);
+*master = sock;
+return SCPE_OK;
+}
+
+/* Rebind the multiplexers in a process created by CLONE
+
+   The sockets inherited across the fork still belong to the simulator
+   which was cloned.  Connections are dropped from this process without
+   shutting them down (outgoing connections are then made afresh), and
+   each listener is reopened on its port plus port_offset.  Serial port
+   lines remain shared.
+*/
+
+t_stat tmxr_clone (int32 port_offset)
+{
+int i, j;
+t_stat r = SCPE_OK;
+
+for (i=0; i<tmxr_open_device_count; ++i) {
+    TMXR *mp = tmxr_open_devices[i];
+
+    _tmxr_ready_close (mp);                         /* readiness sets are shared with the parent */
+    for (j = 0; j < mp->lines; ++j) {
+        TMLN *lp = mp->ldsc + j;
+
+        if (lp->serport)
+            continue;
+        if (lp->sock) {
+            _tmxr_ready_remove (lp);
+            sim_release_sock (lp->sock);
+            lp->sock = 0;
+            lp->conn = FALSE;
+            }
+        if (lp->connecting) {
+            sim_release_sock (lp->connecting);
+            lp->connecting = 0;
+            }
+        lp->txbpr = lp->txbpi = 0;                  /* parent's pending output stays there */
+        tmxr_reset_ln (lp);
+        if (lp->master && lp->port && (_tmxr_clone_listen (&lp->master, &lp->port, port_offset) != SCPE_OK))
+            r = SCPE_OPENERR;
+        }
+    if (mp->ring_sock != INVALID_SOCKET) {
+        sim_release_sock (mp->ring_sock);
+        mp->ring_sock = INVALID_SOCKET;
+        }
+    if (mp->master && mp->port && (_tmxr_clone_listen (&mp->master, &mp->port, port_offset) != SCPE_OK))
+        r = SCPE_OPENERR;
+    }
+return r;
+}
+
 static t_stat _tmxr_locate_line_send_expect (const char *cptr, TMLN **lp, SEND **snd, EXPECT **exp)
 {
 char gbuf[CBUFSIZE];
@@ -4500,6 +5316,45 @@ if (tmxr_open_device_count)
 return SCPE_OK;
 }
 
+/* Per line samples for the metrics endpoint (lines of open multiplexers) */
+
+void tmxr_publish_metrics (void)
+{
+static const struct {
+    const char *name;
+    const char *type;
+    size_t offset;
+    } line_metrics[] = {
+    { "simh_mux_line_connected",          "gauge",   offsetof (TMLN, conn) },
+    { "simh_mux_line_rx_bytes_total",     "counter", offsetof (TMLN, rxcnt) },
+    { "simh_mux_line_tx_bytes_total",     "counter", offsetof (TMLN, txcnt) },
+    { "simh_mux_line_rx_packets_total",   "counter", offsetof (TMLN, rxpcnt) },
+    { "simh_mux_line_tx_packets_total",   "counter", offsetof (TMLN, txpcnt) },
+    { "simh_mux_line_tx_dropped_total",   "counter", offsetof (TMLN, txdrp) },
+    { "simh_mux_line_tx_stalls_total",    "counter", offsetof (TMLN, txstall) },
+    };
+size_t m;
+int i, j;
+
+for (m = 0; m < sizeof (line_metrics) / sizeof (line_metrics[0]); m++) {
+    for (i = 0; i < tmxr_open_device_count; i++) {
+        TMXR *mp = tmxr_open_devices[i];
+
+        for (j = 0; j < mp->lines; j++) {
+            TMLN *lp = &mp->ldsc[j];
+            double value;
+
+            if (line_metrics[m].offset == offsetof (TMLN, conn))
+                value = lp->conn ? 1 : 0;
+            else
+                value = *(int32 *)((char *)lp + line_metrics[m].offset);
+            sim_metric (line_metrics[m].name, line_metrics[m].type, value, "device=\"%s\",line=\"%d\"",
+                        mp->dptr ? sim_dname (mp->dptr) : "", j);
+            }
+        }
+    }
+}
+
 
 t_stat tmxr_show_open_device (FILE* st, TMXR *mp)
 {
@@ -4526,6 +5381,8 @@ if (mp->modem_control)
     fprintf(st, ", ModemControl=enabled");
 if (mp->buffered)
     fprintf(st, ", Buffered=%d", mp->buffered);
+if (mp->txcoalesce)
+    fprintf(st, ", Coalesce=%u usecs", mp->txcoalesce);
 for (j = 1; j < mp->lines; j++)
     if (o_uptr != mp->ldsc[j].o_uptr)
         break;
@@ -4694,7 +5551,13 @@ for (i = 0; i < mp->lines; i++) {  /* loop thru conn */
             }
         lp->conn = FALSE;
         }
+    if (lp->shmlink) {                                  /* shared memory link? */
+        if (lp->conn)
+            tmxr_reset_ln (lp);
+        tmxr_shm_close (lp);
+        }
     if (lp->master) {
+        _tmxr_conn_unwatch (lp);                        /* leave connection set */
         sim_close_sock (lp->master);                    /* close master socket */
         lp->master = 0;
         free (lp->port);
@@ -4722,6 +5585,7 @@ if (mp->ring_sock != INVALID_SOCKET) {
     mp->ring_ipad = NULL;
     mp->ring_start_time = 0;
     }
+_tmxr_ready_close (mp);
 _tmxr_remove_from_open_list (mp);
 return SCPE_OK;
 }
@@ -4834,7 +5698,7 @@ return _sim_activate (uptr, interval);
 
 t_stat tmxr_activate_abs (UNIT *uptr, int32 interval)
 {
-AIO_VALIDATE(uptr);             /* Can't call asynchronously */
+AIO_ACTIVATE (tmxr_activate_abs, uptr, interval);   /* Defer to main thread if called asynchronously */
 sim_cancel (uptr);
 return tmxr_activate (uptr, interval);
 }
@@ -4921,6 +5785,81 @@ sim_cancel (uptr);
 return tmxr_clock_coschedule_tmr (uptr, tmr, ticks);
 }
 
+/* Poll group readiness test for a multiplexer's connection poll unit
+
+   Returns FALSE only when nothing can have changed since the last poll:
+   the connection poll interval hasn't elapsed, and no line is connected,
+   connecting, listening on its own port, or has data buffered.  Anything
+   else (including a mux which hasn't been polled yet) says poll now.
+*/
+
+t_bool tmxr_poll_ready (UNIT *uptr)
+{
+TMXR *mp = (TMXR *)uptr->tmxr;
+int32 i;
+
+if ((mp == NULL) || (mp->last_poll_time == 0))
+    return TRUE;
+if (mp->master &&
+    (mp->conn_backlog ||
+     ((sim_os_msec () - mp->last_poll_time) >= (uint32)(mp->poll_interval * 1000))))
+    return TRUE;
+if (mp->ring_sock != INVALID_SOCKET)
+    return TRUE;
+for (i = 0; i < mp->lines; i++) {
+    TMLN *lp = &mp->ldsc[i];
+
+    if (lp->conn || lp->sock || lp->connecting || lp->master ||
+        lp->destination || lp->serport || lp->loopback ||
+        lp->framer || lp->shmlink)
+        return TRUE;
+    if ((lp->rxbpi != lp->rxbpr) || (lp->txbpi != lp->txbpr) ||
+        (lp->send.extoff < lp->send.insoff))
+        return TRUE;
+    }
+return FALSE;
+}
+
+/* Readiness test for a multiplexer whose poll only has work when input
+   arrives
+
+   Like tmxr_poll_ready, but a connected line whose socket is in the
+   mux's readiness set only counts when the host reports input pending
+   on it, which includes the peer closing the connection.  Lines which
+   are read on every poll, lines with buffered data, and lines on hosts
+   without a readiness set count whenever they are connected.  Devices
+   with their own pending work check for it before calling this.
+*/
+
+t_bool tmxr_input_ready (TMXR *mp)
+{
+int32 i;
+t_bool ready;
+
+if ((mp == NULL) || (mp->last_poll_time == 0))
+    return TRUE;
+if (mp->master &&
+    (mp->conn_backlog ||
+     ((sim_os_msec () - mp->last_poll_time) >= (uint32)(mp->poll_interval * 1000))))
+    return TRUE;
+if (mp->ring_sock != INVALID_SOCKET)
+    return TRUE;
+ready = _tmxr_ready_poll (mp);                          /* find lines with input */
+for (i = 0; i < mp->lines; i++) {
+    TMLN *lp = &mp->ldsc[i];
+
+    if (lp->connecting || lp->master || lp->destination || lp->serport ||
+        lp->loopback || lp->framer || lp->shmlink)
+        return TRUE;
+    if ((lp->rxbpi != lp->rxbpr) || (lp->txbpi != lp->txbpr) ||
+        (lp->send.extoff < lp->send.insoff))
+        return TRUE;
+    if ((lp->conn || lp->sock) && (!ready || lp->rx_ready))
+        return TRUE;
+    }
+return FALSE;
+}
+
 /* Generic Multiplexer attach help */
 
 t_stat tmxr_attach_help(FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr)
@@ -5000,6 +5939,17 @@ else {
         fprintf (st, "Line buffering for all lines on the %s device can be disabled with:\n\n", dptr->name);
     fprintf (st, "   sim> ATTACH %s NoBuffer\n\n", dptr->name);
     fprintf (st, "The default buffer size is 32k bytes, the max buffer size is 1024k bytes\n\n");
+    fprintf (st, "Output to Telnet/TCP lines of the %s device can be held briefly so that it\n", dptr->name);
+    fprintf (st, "is sent in larger segments with fewer TCP packets with:\n\n");
+    fprintf (st, "   sim> ATTACH %s Coalesce{=usecs}\n\n", dptr->name);
+    fprintf (st, "Output is held for at most the specified simulated time (default 1000 usecs)\n");
+    fprintf (st, "or until the line's buffer is half full.  Coalescing is disabled with:\n\n");
+    fprintf (st, "   sim> ATTACH %s NoCoalesce\n\n", dptr->name);
+    fprintf (st, "The host socket options of a line's TCP connections can be adjusted with\n");
+    fprintf (st, "NoDelay (disable the Nagle algorithm), NoKeepAlive (don't send TCP\n");
+    fprintf (st, "keepalives, KeepAlive restores the default) and ReusePort (allow the line's\n");
+    fprintf (st, "listen port to be shared where the host supports SO_REUSEPORT):\n\n");
+    fprintf (st, "   sim> ATTACH %s Line=n,NoDelay,NoKeepAlive,ReusePort,port\n\n", dptr->name);
     fprintf (st, "The outbound traffic for the lines of the %s device can be logged to files\n", dptr->name);
     fprintf (st, "with:\n\n");
     fprintf (st, "   sim> ATTACH %s Log=LogFileName\n\n", dptr->name);
@@ -5163,6 +6113,10 @@ else {
 fprintf (st, "When operating in LOOPBACK mode, all outgoing data arrives as input and\n");
 fprintf (st, "outgoing modem signals (if enabled) (DTR and RTS) are reflected in the\n");
 fprintf (st, "incoming modem signals (DTR->(DCD and DSR), RTS->CTS)\n\n");
+fprintf (st, "A line can be connected to a line of a simulator running on the same host\n");
+fprintf (st, "through shared memory, by attaching both of them to the same link name:\n\n");
+fprintf (st, "   sim> ATTACH %s Line=%s,SHM=name\n\n", dptr->name, single_line ? "0" : "n");
+fprintf (st, "The line is connected while both ends are attached.\n\n");
 if (single_line)            /* Single Line Multiplexer */
     fprintf (st, "The connection configured for the %s device is unconfigured by:\n\n", dptr->name);
 else
@@ -5324,6 +6278,9 @@ if ((lp->port) && (!lp->datagram)) {
 if (lp->serport)                                        /* serial connection? */
     fprintf (st, "Connected to serial port %s\n", lp->destination);  /* print port name */
 
+if (lp->shmlink)                                        /* shared memory link? */
+    fprintf (st, "Shared memory link %s\n", lp->shmlink->name);
+
 if (lp->cnms) {
     ctime = (sim_os_msec () - lp->cnms) / 1000;
     hr = ctime / 3600;
@@ -5366,7 +6323,8 @@ static const char *dsab = "off";
 
 if (ln >= 0)
     fprintf (st, "Line %d:", ln);
-if ((!lp->sock) && (!lp->connecting) && (!lp->serport) && (!lp->framer))
+if ((!lp->sock) && (!lp->connecting) && (!lp->serport) && (!lp->framer) &&
+    ((!lp->shmlink) || (!lp->conn)))
     fprintf (st, " not connected\n");
 else {
     if (ln >= 0)
@@ -5783,13 +6741,14 @@ if (mp == NULL)
     return SCPE_IERR;
 for (i = any = 0; i < mp->lines; i++) {
     if ((mp->ldsc[i].sock != 0) || 
-        (mp->ldsc[i].serport != 0) || mp->ldsc[i].modem_control) {
-        if ((mp->ldsc[i].sock != 0) || (mp->ldsc[i].serport != 0))
+        (mp->ldsc[i].serport != 0) || (mp->ldsc[i].shmlink != NULL) || mp->ldsc[i].modem_control) {
+        if ((mp->ldsc[i].sock != 0) || (mp->ldsc[i].serport != 0) ||
+            ((mp->ldsc[i].shmlink != NULL) && mp->ldsc[i].conn))
             any++;
         if (val)
             tmxr_fconns (st, &mp->ldsc[i], i);
         else
-            if ((mp->ldsc[i].sock != 0) || (mp->ldsc[i].serport != 0))
+            if ((mp->ldsc[i].sock != 0) || (mp->ldsc[i].serport != 0) || (mp->ldsc[i].shmlink != NULL))
                 tmxr_fstats (st, &mp->ldsc[i], i);
         }
     }
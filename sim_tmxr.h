@@ -126,6 +126,7 @@ typedef struct SERPORT *SERHANDLE;
 
 /* Internal struct */
 struct framer_data;    
+struct tmxr_shm;
 
 typedef struct tmln TMLN;
 typedef struct tmxr TMXR;
@@ -201,6 +202,7 @@ struct tmln {
     t_bool              halfduplex;                     /* Line in half-duplex mode */
     t_bool              datagram;                       /* Line is datagram packet oriented */
     t_bool              packet;                         /* Line is packet oriented */
+    int                 sockopts;                       /* extra SIM_SOCK_OPT_* flags for line sockets */
     int32               lpbpr;                          /* loopback buf remove */
     int32               lpbpi;                          /* loopback buf insert */
     int32               lpbcnt;                         /* loopback buf used count */
@@ -212,6 +214,12 @@ struct tmln {
     EXPECT              expect;                         /* Expect rules */
     SEND                send;                           /* Send input state */
     struct framer_data  *framer;                        /* ddcmp framer data */
+    struct tmxr_shm     *shmlink;                       /* shared memory link data */
+    SOCKET              ready_sock;                     /* socket in the mux readiness set */
+    t_bool              rx_ready;                       /* input reported pending - private */
+    SOCKET              conn_watch[2];                  /* listener and connecting socket in the connection set - private */
+    t_bool              conn_ready[2];                  /* connection activity reported - private */
+    double              txcoalesce_time;                /* time unsent output was first held - private */
     };
 
 struct tmxr {
@@ -240,6 +248,10 @@ struct tmxr {
     t_bool              port_speed_control;             /* multiplexer programmatically sets port speed */
     t_bool              packet;                         /* Lines are packet oriented */
     t_bool              datagram;                       /* Lines use datagram packet transport */
+    int                 ready_fd;                       /* host readiness set (epoll/kqueue) */
+    int                 conn_fd;                        /* host connection readiness set (epoll/kqueue) */
+    t_bool              conn_backlog;                   /* listener may have more pending connections */
+    uint32              txcoalesce;                     /* transmit coalescing window (usecs) */
     };
 
 int32 tmxr_poll_conn (TMXR *mp);
@@ -251,6 +263,7 @@ t_stat tmxr_get_packet_ln (TMLN *lp, const uint8 **pbuf, size_t *psize);
 t_stat tmxr_get_packet_ln_ex (TMLN *lp, const uint8 **pbuf, size_t *psize, uint8 frame_byte);
 void tmxr_poll_rx (TMXR *mp);
 t_stat tmxr_putc_ln (TMLN *lp, int32 chr);
+t_stat tmxr_put_buf_ln (TMLN *lp, const uint8 *buf, size_t size, size_t *sent);
 t_stat tmxr_put_packet_ln (TMLN *lp, const uint8 *buf, size_t size);
 t_stat tmxr_put_packet_ln_ex (TMLN *lp, const uint8 *buf, size_t size, uint8 frame_byte);
 void tmxr_poll_tx (TMXR *mp);
@@ -317,6 +330,8 @@ t_stat tmxr_clock_coschedule (UNIT *uptr, int32 interval);
 t_stat tmxr_clock_coschedule_abs (UNIT *uptr, int32 interval);
 t_stat tmxr_clock_coschedule_tmr (UNIT *uptr, int32 tmr, int32 ticks);
 t_stat tmxr_clock_coschedule_tmr_abs (UNIT *uptr, int32 tmr, int32 ticks);
+t_bool tmxr_poll_ready (UNIT *uptr);
+t_bool tmxr_input_ready (TMXR *mp);
 t_stat tmxr_change_async (void);
 t_stat tmxr_locate_line_send (const char *dev_line, SEND **snd);
 t_stat tmxr_locate_line_expect (const char *dev_line, EXPECT **exp);
@@ -325,6 +340,8 @@ const char *tmxr_send_line_name (const SEND *snd);
 const char *tmxr_expect_line_name (const EXPECT *exp);
 t_stat tmxr_startup (void);
 t_stat tmxr_shutdown (void);
+void tmxr_publish_metrics (void);
+t_stat tmxr_clone (int32 port_offset);
 t_stat tmxr_sock_test (DEVICE *dptr, const char *cptr);
 t_stat tmxr_start_poll (void);
 t_stat tmxr_stop_poll (void);
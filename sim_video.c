@@ -371,10 +371,35 @@ DEVICE *vid_dev;
 t_bool vid_key_state[SDL_NUM_SCANCODES];
 VID_DISPLAY *next;
 t_bool vid_blending;
-SDL_Rect *vid_dst_last;
-uint32 *vid_data_last;
+uint32 *vid_fb;                                         /* persistent frame buffer */
+uint8 *vid_dirty;                                       /* tiles modified since the last upload */
+int32 vid_tiles_x;                                      /* tiles per row */
+int32 vid_tiles_y;                                      /* tile rows */
+t_bool vid_draw_pending;                                /* EVENT_DRAW queued and not yet processed */
+t_bool vid_fb_dirty;                                    /* some tile is dirty */
+t_bool vid_refresh_pending;                             /* refresh requested (SET VIDEO FPS mode) */
+t_bool vid_hidden;                                      /* window minimized or hidden */
 };
 
+/* Drawing
+
+   Each display has a persistent frame buffer which vid_draw_window writes
+   into directly, noting the VID_TILE x VID_TILE pixel tiles it touched.
+   A single EVENT_DRAW is queued when the first tile becomes dirty and
+   when the event thread gets to it, only the dirty tiles are uploaded to
+   the texture.  Any number of draws between uploads therefore cost one
+   event and no allocation. */
+
+#define VID_TILE_SHIFT  5
+#define VID_TILE        (1 << VID_TILE_SHIFT)
+
+/* When SET VIDEO FPS=n is in effect the event thread instead composites
+   each display at most n times a second on its own schedule.  Draws and
+   refresh requests then only mark the display and never queue events. */
+
+static uint32 vid_fps = 0;                              /* frame rate cap (0 = refresh on request) */
+static Uint32 vid_next_frame = 0;                       /* SDL_GetTicks() time of the next frame */
+
 SDL_Thread *vid_thread_handle = NULL;                   /* event thread handle */
 
 static VID_DISPLAY vid_first;
@@ -704,6 +729,21 @@ vptr->vid_height = height;
 vptr->vid_mouse_captured = FALSE;
 vptr->vid_cursor_visible = (vptr->vid_flags & SIM_VID_INPUTCAPTURED);
 vptr->vid_blending = FALSE;
+vptr->vid_draw_pending = FALSE;
+vptr->vid_fb_dirty = FALSE;
+vptr->vid_refresh_pending = FALSE;
+vptr->vid_hidden = FALSE;
+vptr->vid_tiles_x = (width + VID_TILE - 1) >> VID_TILE_SHIFT;
+vptr->vid_tiles_y = (height + VID_TILE - 1) >> VID_TILE_SHIFT;
+vptr->vid_fb = (uint32 *)calloc ((size_t)width * height, sizeof (*vptr->vid_fb));
+vptr->vid_dirty = (uint8 *)calloc ((size_t)vptr->vid_tiles_x * vptr->vid_tiles_y, sizeof (*vptr->vid_dirty));
+if ((vptr->vid_fb == NULL) || (vptr->vid_dirty == NULL)) {
+    free (vptr->vid_fb);
+    vptr->vid_fb = NULL;
+    free (vptr->vid_dirty);
+    vptr->vid_dirty = NULL;
+    return SCPE_MEM;
+    }
 
 if (!vid_active) {
     vid_key_events.head = 0;
@@ -722,8 +762,13 @@ memset (motion_callback, 0, sizeof motion_callback);
 memset (button_callback, 0, sizeof button_callback);
 
 stat = vid_create_window (vptr);
-if (stat != SCPE_OK)
+if (stat != SCPE_OK) {
+    free (vptr->vid_fb);
+    vptr->vid_fb = NULL;
+    free (vptr->vid_dirty);
+    vptr->vid_dirty = NULL;
     return stat;
+    }
 
 sim_debug (SIM_VID_DBG_VIDEO|SIM_VID_DBG_KEY|SIM_VID_DBG_MOUSE, vptr->vid_dev, "vid_open() - Success\n");
 
@@ -780,6 +825,10 @@ while (vptr->vid_ready)
     sim_os_ms_sleep (10);
 
 vptr->vid_active_window = FALSE;
+free (vptr->vid_fb);
+vptr->vid_fb = NULL;
+free (vptr->vid_dirty);
+vptr->vid_dirty = NULL;
 if (!vid_active && vid_mouse_events.sem) {
     SDL_DestroySemaphore(vid_mouse_events.sem);
     vid_mouse_events.sem = NULL;
@@ -873,51 +922,50 @@ return SDL_MapRGBA (vptr->vid_format, r, g, b, a);
 void vid_draw_window (VID_DISPLAY *vptr, int32 x, int32 y, int32 w, int32 h, uint32 *buf)
 {
 SDL_Event user_event;
-SDL_Rect *vid_dst, *last;
-uint32 *vid_data;
+int32 row, tx, ty, bw = w;
+t_bool queue;
 
 sim_debug (SIM_VID_DBG_VIDEO, vptr->vid_dev, "vid_draw(%d, %d, %d, %d)\n", x, y, w, h);
 
-SDL_LockMutex (vptr->vid_draw_mutex);                         /* Synchronize to check region dimensions */
-last = vptr->vid_dst_last;
-if (last                               &&               /* As yet unprocessed draw rectangle? */
-    (last->x == x) && (last->y == y) &&                 /* AND identical position? */
-    (last->w == w) && (last->h == h)) {                 /* AND identical dimensions? */
-    memcpy (vptr->vid_data_last, buf, w*h*sizeof(*buf));/* Replace region contents */
-    SDL_UnlockMutex (vptr->vid_draw_mutex);                   /* Done */
+if (x < 0) {                                            /* clip to the display */
+    buf -= x;
+    w += x;
+    x = 0;
+    }
+if (y < 0) {
+    buf -= y * bw;
+    h += y;
+    y = 0;
+    }
+if (x + w > vptr->vid_width)
+    w = vptr->vid_width - x;
+if (y + h > vptr->vid_height)
+    h = vptr->vid_height - y;
+if ((w <= 0) || (h <= 0) || (vptr->vid_fb == NULL))
     return;
-    }
+SDL_LockMutex (vptr->vid_draw_mutex);
+for (row = 0; row < h; row++)
+    memcpy (&vptr->vid_fb[(y + row) * vptr->vid_width + x], &buf[row * bw], w * sizeof (*buf));
+for (ty = y >> VID_TILE_SHIFT; ty <= ((y + h - 1) >> VID_TILE_SHIFT); ty++)
+    for (tx = x >> VID_TILE_SHIFT; tx <= ((x + w - 1) >> VID_TILE_SHIFT); tx++)
+        vptr->vid_dirty[ty * vptr->vid_tiles_x + tx] = 1;
+vptr->vid_fb_dirty = TRUE;
+queue = ((vid_fps == 0) && !vptr->vid_draw_pending);   /* need to queue an upload? */
+if (queue)
+    vptr->vid_draw_pending = TRUE;
 SDL_UnlockMutex (vptr->vid_draw_mutex);
-
-vid_dst = (SDL_Rect *)malloc (sizeof(*vid_dst));
-if (!vid_dst) {
-    sim_printf ("%s: vid_draw() memory allocation error\n", vid_dname(vptr->vid_dev));
-    return;
-    }
-vid_dst->x = x;
-vid_dst->y = y;
-vid_dst->w = w;
-vid_dst->h = h;
-vid_data = (uint32 *)malloc (w*h*sizeof(*buf));
-if (!vid_data) {
-    sim_printf ("%s: vid_draw() memory allocation error\n", vid_dname(vptr->vid_dev));
-    free (vid_dst);
+if (!queue)
     return;
-    }
-memcpy (vid_data, buf, w*h*sizeof(*buf));
 user_event.type = SDL_USEREVENT;
 user_event.user.windowID = vptr->vid_windowID;
 user_event.user.code = EVENT_DRAW;
-user_event.user.data1 = (void *)vid_dst;
-user_event.user.data2 = (void *)vid_data;
-SDL_LockMutex (vptr->vid_draw_mutex);         /* protect vid_dst_last & vid_data_last */
-vptr->vid_dst_last = vid_dst;
-vptr->vid_data_last = vid_data;
-SDL_UnlockMutex (vptr->vid_draw_mutex);       /* done protection */
+user_event.user.data1 = NULL;
+user_event.user.data2 = NULL;
 if (SDL_PushEvent (&user_event) < 0) {
     sim_printf ("%s: vid_draw() SDL_PushEvent error: %s\n", vid_dname(vptr->vid_dev), SDL_GetError());
-    free (vid_dst);
-    free (vid_data);
+    SDL_LockMutex (vptr->vid_draw_mutex);
+    vptr->vid_draw_pending = FALSE;                     /* let the next draw try again */
+    SDL_UnlockMutex (vptr->vid_draw_mutex);
     }
 }
 
@@ -1025,6 +1073,10 @@ void vid_refresh_window (VID_DISPLAY *vptr)
 {
 SDL_Event user_event;
 
+if (vid_fps) {                                          /* frame rate capped? */
+    vptr->vid_refresh_pending = TRUE;                   /* next frame will present */
+    return;
+    }
 sim_debug (SIM_VID_DBG_VIDEO, vptr->vid_dev, "vid_refresh() - Queueing Refresh Event\n");
 
 user_event.type = SDL_USEREVENT;
@@ -1698,31 +1750,337 @@ SDL_WarpMouseInWindow (NULL, vid_cursor_x, vid_cursor_y);
 SDL_PumpEvents ();
 }
 
-void vid_draw_region (VID_DISPLAY *vptr, SDL_UserEvent *event)
+/* Recording
+
+   SET VIDEO RECORD=file records the first display to a file without
+   slowing the event thread.  While it uploads dirty tiles, the event
+   thread copies the same rectangles into a slot of a small ring.  A
+   writer thread applies each slot to its own copy of the display and
+   appends the complete frame to the file.  If the ring is full the frame
+   is dropped and the next one is captured whole, so the writer's copy
+   never goes stale.  The file holds headerless ARGB8888 frames, one after
+   another, in the form read by ffmpeg -f rawvideo.  Frames are written
+   when the display changes, or at every frame with SET VIDEO FPS=n. */
+
+#define VID_REC_SLOTS   8                               /* frames in flight to the writer */
+
+typedef struct {
+    int32 nrects;                                       /* changed rectangles */
+    SDL_Rect *rects;
+    uint32 *pixels;                                     /* their pixels, packed */
+    size_t used;                                        /* pixels in use */
+    t_bool complete;                                    /* slot holds the whole display */
+    } VID_REC_SLOT;
+
+typedef struct {
+    VID_DISPLAY *vptr;                                  /* display being recorded */
+    FILE *file;
+    char filename[CBUFSIZE];
+    int32 width;
+    int32 height;
+    uint32 *frame;                                      /* writer's copy of the display */
+    VID_REC_SLOT slots[VID_REC_SLOTS];
+    int32 head;                                         /* next slot to fill (event thread) */
+    int32 tail;                                         /* next slot to write (writer) */
+    uint32 queued;                                      /* slots handed to the writer */
+    uint32 written;                                     /* slots the writer has finished */
+    SDL_sem *free_slots;
+    SDL_sem *full_slots;
+    SDL_Thread *thread;
+    t_bool keyframe;                                    /* next frame must be complete */
+    t_bool io_error;
+    uint32 frames;                                      /* frames written */
+    uint32 dropped;                                     /* frames dropped with the ring full */
+    } VID_RECORDER;
+
+static VID_RECORDER *vid_rec = NULL;                    /* active recording, if any */
+
+static void vid_record_free (VID_RECORDER *rec)
+{
+int32 i;
+
+for (i = 0; i < VID_REC_SLOTS; i++) {
+    free (rec->slots[i].rects);
+    free (rec->slots[i].pixels);
+    }
+if (rec->free_slots)
+    SDL_DestroySemaphore (rec->free_slots);
+if (rec->full_slots)
+    SDL_DestroySemaphore (rec->full_slots);
+if (rec->file)
+    fclose (rec->file);
+free (rec->frame);
+free (rec);
+}
+
+static void vid_record_write (VID_RECORDER *rec)
+{
+size_t n = (size_t)rec->width * rec->height;
+
+if (rec->io_error)
+    return;
+if (fwrite (rec->frame, sizeof (*rec->frame), n, rec->file) != n)
+    rec->io_error = TRUE;
+else
+    ++rec->frames;
+}
+
+/* Writer thread: apply each captured slot to the frame and write it out.
+   A post with no slot behind it is the request to stop.  (head == tail
+   both when the ring is empty and when it is full, hence the counts.) */
+
+static int vid_record_thread (void *arg)
+{
+VID_RECORDER *rec = (VID_RECORDER *)arg;
+VID_REC_SLOT *slot;
+uint32 *src;
+int32 i, row;
+
+vid_record_write (rec);                                 /* the display as recording began */
+while (1) {
+    SDL_SemWait (rec->full_slots);
+    if (rec->written == rec->queued)                    /* stop requested and all written */
+        break;
+    slot = &rec->slots[rec->tail];
+    src = slot->pixels;
+    for (i = 0; i < slot->nrects; i++) {
+        SDL_Rect *r = &slot->rects[i];
+
+        for (row = 0; row < r->h; row++) {
+            memcpy (&rec->frame[(r->y + row) * rec->width + r->x], src, r->w * sizeof (*src));
+            src += r->w;
+            }
+        }
+    vid_record_write (rec);
+    rec->tail = (rec->tail + 1) % VID_REC_SLOTS;
+    ++rec->written;
+    SDL_SemPost (rec->free_slots);
+    }
+return 0;
+}
+
+/* Copy one uploaded rectangle into the slot being filled.
+   Called by the event thread with the draw mutex held. */
+
+static void vid_record_rect (VID_REC_SLOT *slot, VID_DISPLAY *vptr, const SDL_Rect *r)
+{
+int32 row;
+
+if (slot->complete)
+    return;
+slot->rects[slot->nrects++] = *r;
+for (row = 0; row < r->h; row++) {
+    memcpy (&slot->pixels[slot->used], &vptr->vid_fb[(r->y + row) * vptr->vid_width + r->x], r->w * sizeof (*slot->pixels));
+    slot->used += r->w;
+    }
+}
+
+/* Claim a slot for the frame about to be uploaded.  Returns NULL when
+   this display isn't being recorded or the writer is behind.  Called by
+   the event thread with the draw mutex held. */
+
+static VID_REC_SLOT *vid_record_begin (VID_DISPLAY *vptr)
 {
-SDL_Rect *vid_dst = (SDL_Rect *)event->data1;
-uint32 *buf = (uint32 *)event->data2;
+VID_RECORDER *rec = vid_rec;
+VID_REC_SLOT *slot;
 
-sim_debug (SIM_VID_DBG_VIDEO, vptr->vid_dev, "Draw Region Event: (%d,%d,%d,%d)\n", vid_dst->x, vid_dst->x, vid_dst->w, vid_dst->h);
+if ((rec == NULL) || (rec->vptr != vptr))
+    return NULL;
+if (SDL_SemTryWait (rec->free_slots) != 0) {            /* ring full? */
+    ++rec->dropped;
+    rec->keyframe = TRUE;                               /* resync with a complete frame */
+    return NULL;
+    }
+slot = &rec->slots[rec->head];
+slot->nrects = 0;
+slot->used = 0;
+slot->complete = FALSE;
+if (rec->keyframe) {
+    SDL_Rect all;
+
+    all.x = all.y = 0;
+    all.w = vptr->vid_width;
+    all.h = vptr->vid_height;
+    vid_record_rect (slot, vptr, &all);
+    slot->complete = TRUE;
+    rec->keyframe = FALSE;
+    }
+return slot;
+}
+
+/* Hand the filled slot to the writer */
+
+static void vid_record_end (void)
+{
+VID_RECORDER *rec = vid_rec;
+
+rec->head = (rec->head + 1) % VID_REC_SLOTS;
+++rec->queued;
+SDL_SemPost (rec->full_slots);
+}
+
+static t_stat vid_record_start (const char *filename)
+{
+VID_DISPLAY *vptr = &vid_first;
+VID_RECORDER *rec;
+size_t frame_size;
+int32 i;
+
+if (vid_rec != NULL)
+    return sim_messagef (SCPE_ARG, "Already recording to %s\n", vid_rec->filename);
+if (!vid_active || !vptr->vid_ready || (vptr->vid_fb == NULL))
+    return sim_messagef (SCPE_UDIS, "No video display is active\n");
+rec = (VID_RECORDER *)calloc (1, sizeof (*rec));
+if (rec == NULL)
+    return SCPE_MEM;
+rec->vptr = vptr;
+rec->width = vptr->vid_width;
+rec->height = vptr->vid_height;
+strlcpy (rec->filename, filename, sizeof (rec->filename));
+frame_size = (size_t)rec->width * rec->height;
+rec->frame = (uint32 *)malloc (frame_size * sizeof (*rec->frame));
+for (i = 0; (rec->frame != NULL) && (i < VID_REC_SLOTS); i++) {
+    rec->slots[i].rects = (SDL_Rect *)malloc ((size_t)vptr->vid_tiles_x * vptr->vid_tiles_y * sizeof (SDL_Rect));
+    rec->slots[i].pixels = (uint32 *)malloc (frame_size * sizeof (*rec->slots[i].pixels));
+    if ((rec->slots[i].rects == NULL) || (rec->slots[i].pixels == NULL))
+        break;
+    }
+if (i < VID_REC_SLOTS) {
+    vid_record_free (rec);
+    return SCPE_MEM;
+    }
+rec->file = sim_fopen (filename, "wb");
+if (rec->file == NULL) {
+    vid_record_free (rec);
+    return sim_messagef (SCPE_OPENERR, "Can't open recording file %s: %s\n", filename, strerror (errno));
+    }
+rec->free_slots = SDL_CreateSemaphore (VID_REC_SLOTS);
+rec->full_slots = SDL_CreateSemaphore (0);
+if ((rec->free_slots == NULL) || (rec->full_slots == NULL)) {
+    vid_record_free (rec);
+    return sim_messagef (SCPE_IERR, "Can't create recording semaphores: %s\n", SDL_GetError ());
+    }
+SDL_LockMutex (vptr->vid_draw_mutex);
+memcpy (rec->frame, vptr->vid_fb, frame_size * sizeof (*rec->frame));
+rec->thread = SDL_CreateThread (vid_record_thread, "simh-video-record", rec);
+if (rec->thread != NULL)
+    vid_rec = rec;
+SDL_UnlockMutex (vptr->vid_draw_mutex);
+if (rec->thread == NULL) {
+    vid_record_free (rec);
+    return sim_messagef (SCPE_IERR, "Can't create recording thread: %s\n", SDL_GetError ());
+    }
+sim_messagef (SCPE_OK, "Recording %dx%d frames to %s\n", rec->width, rec->height, rec->filename);
+sim_messagef (SCPE_OK, "Convert with: ffmpeg -f rawvideo -pixel_format %s -video_size %dx%d -framerate %u -i %s output.mp4\n",
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+              "argb",
+#else
+              "bgra",
+#endif
+              rec->width, rec->height, vid_fps ? vid_fps : 30, rec->filename);
+return SCPE_OK;
+}
+
+/* Stop recording, after the writer has caught up */
+
+static t_stat vid_record_stop (void)
+{
+VID_RECORDER *rec = vid_rec;
+t_stat r;
+
+if (rec == NULL)
+    return SCPE_OK;
+if (rec->vptr->vid_draw_mutex)
+    SDL_LockMutex (rec->vptr->vid_draw_mutex);
+if (rec->keyframe) {                                    /* last frame dropped? */
+    SDL_SemWait (rec->free_slots);                      /* wait for the writer to free a slot */
+    SDL_SemPost (rec->free_slots);
+    if (vid_record_begin (rec->vptr))                   /* and record the display as it ends */
+        vid_record_end ();
+    }
+vid_rec = NULL;                                         /* no more captures */
+if (rec->vptr->vid_draw_mutex)
+    SDL_UnlockMutex (rec->vptr->vid_draw_mutex);
+SDL_SemPost (rec->full_slots);
+SDL_WaitThread (rec->thread, NULL);
+if (rec->io_error)
+    r = sim_messagef (SCPE_IOERR, "Error writing recording %s after %u frames\n", rec->filename, rec->frames);
+else
+    r = sim_messagef (SCPE_OK, "Recorded %u frames to %s (%u dropped)\n", rec->frames, rec->filename, rec->dropped);
+vid_record_free (rec);
+return r;
+}
+
+void vid_draw_region (VID_DISPLAY *vptr, SDL_UserEvent *event)
+{
+SDL_Rect vid_dst;
+int32 tx, ty, run;
+uint8 *dirty;
+int rects = 0;
+VID_REC_SLOT *rec_slot;
 
 SDL_LockMutex (vptr->vid_draw_mutex);
-if (vid_dst == vptr->vid_dst_last) {
-    vptr->vid_dst_last = NULL;
-    vptr->vid_data_last = NULL;
+vptr->vid_draw_pending = FALSE;
+if (!vptr->vid_fb_dirty) {                              /* nothing since the last upload? */
+    SDL_UnlockMutex (vptr->vid_draw_mutex);
+    return;
     }
+vptr->vid_fb_dirty = FALSE;
+rec_slot = vid_record_begin (vptr);
+for (ty = 0; ty < vptr->vid_tiles_y; ty++) {
+    dirty = &vptr->vid_dirty[ty * vptr->vid_tiles_x];
+    for (tx = 0; tx < vptr->vid_tiles_x; tx += run) {
+        if (!dirty[tx]) {
+            run = 1;
+            continue;
+            }
+        for (run = 0; ((tx + run) < vptr->vid_tiles_x) && dirty[tx + run]; run++)
+            dirty[tx + run] = 0;                        /* gather adjacent dirty tiles */
+        vid_dst.x = tx << VID_TILE_SHIFT;
+        vid_dst.y = ty << VID_TILE_SHIFT;
+        vid_dst.w = run << VID_TILE_SHIFT;
+        if (vid_dst.x + vid_dst.w > vptr->vid_width)
+            vid_dst.w = vptr->vid_width - vid_dst.x;
+        vid_dst.h = VID_TILE;
+        if (vid_dst.y + vid_dst.h > vptr->vid_height)
+            vid_dst.h = vptr->vid_height - vid_dst.y;
+        ++rects;
+        if (rec_slot)
+            vid_record_rect (rec_slot, vptr, &vid_dst);
+        if (SDL_UpdateTexture (vptr->vid_texture, &vid_dst, &vptr->vid_fb[vid_dst.y * vptr->vid_width + vid_dst.x], vptr->vid_width*sizeof(*vptr->vid_fb)))
+            sim_printf ("%s: vid_draw_region() - SDL_UpdateTexture error: %s\n", vid_dname(vptr->vid_dev), SDL_GetError());
+        else
+            if (vptr->vid_blending)
+                SDL_RenderCopy (vptr->vid_renderer, vptr->vid_texture, &vid_dst, &vid_dst);
+        }
+    }
+if (rec_slot)
+    vid_record_end ();
 SDL_UnlockMutex (vptr->vid_draw_mutex);
+sim_debug (SIM_VID_DBG_VIDEO, vptr->vid_dev, "Draw Region Event: %d region%s uploaded\n", rects, (rects == 1) ? "" : "s");
+}
+
+/* Composite one frame of a display when running with a frame rate cap */
 
-if (vptr->vid_blending) {
-    SDL_UpdateTexture(vptr->vid_texture, vid_dst, buf, vid_dst->w*sizeof(*buf));
-    SDL_RenderCopy (vptr->vid_renderer, vptr->vid_texture, vid_dst, vid_dst); 
+static void vid_render_frame (VID_DISPLAY *vptr)
+{
+if ((!vptr->vid_ready) || (vptr->vid_texture == NULL) || vptr->vid_hidden)
+    return;                                             /* nothing visible to render */
+if (vptr->vid_fb_dirty) {
+    vid_draw_region (vptr, NULL);
+    vptr->vid_refresh_pending = TRUE;
     }
 else
-    if (SDL_UpdateTexture(vptr->vid_texture, vid_dst, buf, vid_dst->w*sizeof(*buf)))
-        sim_printf ("%s: vid_draw_region() - SDL_UpdateTexture error: %s\n", vid_dname(vptr->vid_dev), SDL_GetError());
-
-free (vid_dst);
-free (buf);
-event->data1 = NULL;
+    if (vid_rec && (vid_rec->vptr == vptr)) {          /* unchanged frame still recorded */
+        SDL_LockMutex (vptr->vid_draw_mutex);
+        if (vid_record_begin (vptr))
+            vid_record_end ();
+        SDL_UnlockMutex (vptr->vid_draw_mutex);
+        }
+if (vptr->vid_refresh_pending) {
+    vptr->vid_refresh_pending = FALSE;
+    vid_update (vptr);
+    }
 }
 
 static int vid_new_window (VID_DISPLAY *vptr)
@@ -1780,8 +2138,6 @@ else
     SDL_SetWindowTitle (vptr->vid_window, vptr->vid_title);
 
 memset (&vptr->vid_key_state, 0, sizeof(vptr->vid_key_state));
-vptr->vid_dst_last = NULL;
-vptr->vid_data_last = NULL;
 
 vid_active++;
 return 1;
@@ -1820,6 +2176,8 @@ return SCPE_OK;
 static void vid_destroy (VID_DISPLAY *vptr)
 {
 VID_DISPLAY *parent;
+if (vid_rec && (vid_rec->vptr == vptr))
+    vid_record_stop ();                                 /* while the frame buffer remains */
 vptr->vid_ready = FALSE;
 if (vptr->vid_cursor) {
     SDL_FreeCursor (vptr->vid_cursor);
@@ -1978,7 +2336,24 @@ vptr0->vid_ready = TRUE;
 sim_debug (SIM_VID_DBG_VIDEO|SIM_VID_DBG_KEY|SIM_VID_DBG_MOUSE|SIM_VID_DBG_CURSOR, vptr0->vid_dev, "vid_thread() - Started\n");
 
 while (vid_active) {
-    int status = SDL_WaitEvent (&event);
+    int status;
+
+    if (vid_fps) {                                      /* frame rate capped? */
+        Uint32 now = SDL_GetTicks ();
+
+        if ((Sint32)(now - vid_next_frame) >= 0) {      /* frame due? */
+            VID_DISPLAY *vptr;
+
+            for (vptr = &vid_first; vptr != NULL; vptr = vptr->next)
+                vid_render_frame (vptr);
+            vid_next_frame = now + 1000 / vid_fps;
+            }
+        status = SDL_WaitEventTimeout (&event, (int)(vid_next_frame - now));
+        if (status == 0)                                /* time for the next frame */
+            continue;
+        }
+    else
+        status = SDL_WaitEvent (&event);
     if (status == 1) {
         VID_DISPLAY *vptr;
         switch (event.type) {
@@ -2027,6 +2402,17 @@ while (vid_active) {
                         case SDL_WINDOWEVENT_EXPOSED:
                             vid_update (vptr);
                             break;
+                        case SDL_WINDOWEVENT_MINIMIZED:
+                        case SDL_WINDOWEVENT_HIDDEN:
+                            vptr->vid_hidden = TRUE;    /* stop rendering */
+                            break;
+                        case SDL_WINDOWEVENT_RESTORED:
+                        case SDL_WINDOWEVENT_MAXIMIZED:
+                        case SDL_WINDOWEVENT_SHOWN:
+                            vptr->vid_hidden = FALSE;
+                            vid_draw_region (vptr, NULL);   /* catch up */
+                            vid_update (vptr);
+                            break;
                         }
                     }
                 break;
@@ -2034,7 +2420,7 @@ while (vid_active) {
             case SDL_USEREVENT:
                 /* There are 9 user events generated */
                 /* EVENT_REDRAW to update the display */
-                /* EVENT_DRAW   to update a region in the display texture */
+                /* EVENT_DRAW   to upload dirty regions to the display texture */
                 /* EVENT_SHOW   to display the current SDL video capabilities */
                 /* EVENT_CURSOR to change the current cursor */
                 /* EVENT_WARP   to warp the cursor position */
@@ -2057,7 +2443,8 @@ while (vid_active) {
                         break;
                         }
                     if (event.user.code == EVENT_REDRAW) {
-                        vid_update (vptr);
+                        if (!vptr->vid_hidden)
+                            vid_update (vptr);
                         event.user.code = 0;    /* Mark as done */
                         while (SDL_PeepEvents (&event, 1, SDL_GETEVENT, SDL_USEREVENT, SDL_USEREVENT)) {
                             if ((event.user.code == EVENT_REDRAW) &&
@@ -2199,6 +2586,47 @@ t_stat vid_set_release_key (FILE* st, UNIT* uptr, int32 val, CONST void* desc)
 return SCPE_NOFNC;
 }
 
+/* SET VIDEO FPS=n
+   SET VIDEO RECORD=file
+   SET VIDEO NORECORD
+
+   n = 0 reverts to refreshing whenever the simulator asks */
+
+t_stat vid_set_video (int32 flag, CONST char *cptr)
+{
+char gbuf[CBUFSIZE];
+uint32 fps;
+t_stat r;
+
+if ((cptr == NULL) || (*cptr == 0))
+    return SCPE_2FARG;
+while (*cptr) {
+    cptr = get_glyph_nc (cptr, gbuf, ',');              /* keep the case of file names */
+    if (strncasecmp (gbuf, "RECORD=", 7) == 0) {
+        if (gbuf[7] == 0)
+            return sim_messagef (SCPE_2FARG, "Missing recording file name\n");
+        r = vid_record_start (&gbuf[7]);
+        if (r != SCPE_OK)
+            return r;
+        }
+    else if (strcasecmp (gbuf, "NORECORD") == 0) {
+        r = vid_record_stop ();
+        if (r != SCPE_OK)
+            return r;
+        }
+    else if (strncasecmp (gbuf, "FPS=", 4) == 0) {
+        fps = (uint32)get_uint (&gbuf[4], 10, 1000, &r);
+        if (r != SCPE_OK)
+            return sim_messagef (SCPE_ARG, "Invalid frame rate: %s (0 - 1000)\n", &gbuf[4]);
+        vid_fps = fps;
+        vid_next_frame = SDL_GetTicks ();
+        }
+    else
+        return sim_messagef (SCPE_ARG, "Unknown VIDEO option: %s\n", gbuf);
+    }
+return SCPE_OK;
+}
+
 t_stat vid_show_release_key (FILE* st, UNIT* uptr, int32 val, CONST void* desc)
 {
 VID_DISPLAY *vptr;
@@ -2217,6 +2645,12 @@ int i;
 VID_DISPLAY *vptr;
 
 fprintf (st, "Video support using SDL: %s\n", vid_version());
+if (vid_fps)
+    fprintf (st, "  Display refresh capped at %u frames per second\n", vid_fps);
+else
+    fprintf (st, "  Display refreshed when requested by the simulator\n");
+if (vid_rec)
+    fprintf (st, "  Recording to %s: %u frames written, %u dropped\n", vid_rec->filename, vid_rec->frames, vid_rec->dropped);
 #if defined (SDL_MAIN_AVAILABLE)
 fprintf (st, "  SDL Events being processed on the main process thread\n");
 #endif
@@ -2728,6 +3162,11 @@ t_stat vid_set_release_key (FILE* st, UNIT* uptr, int32 val, CONST void* desc)
 return SCPE_NOFNC;
 }
 
+t_stat vid_set_video (int32 flag, CONST char *cptr)
+{
+return sim_messagef (SCPE_NOFNC, "video support unavailable\n");
+}
+
 t_stat vid_show_release_key (FILE* st, UNIT* uptr, int32 val, CONST void* desc)
 {
 fprintf (st, "no release key");
@@ -38,102 +38,71 @@
  * This routine is very heavily used in the network
  * code and should be modified for each CPU to be as fast as possible.
  *
- * XXX Since we will never span more than 1 mbuf, we can optimise this
+ * Since we will never span more than 1 mbuf, the data is summed as one
+ * run of 32 bit words into a 64 bit accumulator, which cannot overflow
+ * for any packet, and the carries are folded back in once at the end.
+ * The one's complement sum of the 32 bit words folds to the same value
+ * as the sum of the 16 bit words they hold, in either byte order.  The
+ * loads go through memcpy so the data may start on any byte boundary,
+ * and compilers turn the unrolled loop into wide or vector loads.
  */
 
-#define ADDCARRY(x)  (x > 65535 ? x -= 65535 : x)
-#define REDUCE {l_util.l = sum; sum = l_util.s[0] + l_util.s[1];        \
-        (void)ADDCARRY(sum);}
-
 int cksum(struct mbuf *m, int len)
 {
-        register uint16_t *w;
-        register int sum = 0;
-        register int mlen = 0;
-        int byte_swapped = 0;
-
+        const uint8_t *p;
+        uint64_t sum = 0;
+        int mlen;
         union {
                 uint8_t  c[2];
                 uint16_t s;
         } s_util;
-        union {
-                uint16_t s[2];
-                uint32_t l;
-        } l_util;
-
-        if (m->m_len == 0)
-           goto cont;
-        w = mtod(m, uint16_t *);
 
         mlen = m->m_len;
-
         if (len < mlen)
            mlen = len;
 #ifdef DEBUG
-        len -= mlen;
-#endif
-        /*
-         * Force to even boundary.
-         */
-        if ((1 & (uintptr_t)w) && (mlen > 0)) {
-                REDUCE;
-                sum <<= 8;
-                s_util.c[0] = *(uint8_t *)w;
-                w = (uint16_t *)((int8_t *)w + 1);
-                mlen--;
-                byte_swapped = 1;
-        }
-        /*
-         * Unroll the loop to make overhead from
-         * branches &c small.
-         */
-        while ((mlen -= 32) >= 0) {
-                sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-                sum += w[4]; sum += w[5]; sum += w[6]; sum += w[7];
-                sum += w[8]; sum += w[9]; sum += w[10]; sum += w[11];
-                sum += w[12]; sum += w[13]; sum += w[14]; sum += w[15];
-                w += 16;
-        }
-        mlen += 32;
-        while ((mlen -= 8) >= 0) {
-                sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-                w += 4;
-        }
-        mlen += 8;
-        if (mlen == 0 && byte_swapped == 0)
-           goto cont;
-        REDUCE;
-        while ((mlen -= 2) >= 0) {
-                sum += *w++;
+        if (len > mlen) {
+                DEBUG_ERROR("cksum: out of data\n");
+                DEBUG_ERROR(" len = %d\n", len - mlen);
         }
+#endif
+        if (mlen <= 0)
+           return 0xffff;
+        p = mtod(m, const uint8_t *);
 
-        if (byte_swapped) {
-                REDUCE;
-                sum <<= 8;
-                if (mlen == -1) {
-                        s_util.c[1] = *(uint8_t *)w;
-                        sum += s_util.s;
-                        mlen = 0;
-                } else
+        while (mlen >= 16) {
+                uint32_t w[4];
 
-                   mlen = -1;
-        } else if (mlen == -1)
-           s_util.c[0] = *(uint8_t *)w;
+                memcpy(w, p, sizeof(w));
+                sum += (uint64_t)w[0] + w[1] + w[2] + w[3];
+                p += 16;
+                mlen -= 16;
+        }
+        while (mlen >= 4) {
+                uint32_t w;
 
-cont:
-#ifdef DEBUG
-        if (len) {
-                DEBUG_ERROR("cksum: out of data\n");
-                DEBUG_ERROR(" len = %d\n", len);
+                memcpy(&w, p, sizeof(w));
+                sum += w;
+                p += 4;
+                mlen -= 4;
         }
-#endif
-        if (mlen == -1) {
-                /* The last mbuf has odd # of bytes. Follow the
+        if (mlen >= 2) {
+                memcpy(&s_util.s, p, sizeof(s_util.s));
+                sum += s_util.s;
+                p += 2;
+                mlen -= 2;
+        }
+        if (mlen) {
+                /* The mbuf has odd # of bytes. Follow the
                  standard (the odd byte may be shifted left by 8 bits
                            or not as determined by endian-ness of the machine) */
+                s_util.c[0] = *p;
                 s_util.c[1] = 0;
                 sum += s_util.s;
         }
-        REDUCE;
-        return (~sum & 0xffff);
+        sum = (sum >> 32) + (sum & 0xffffffff);
+        sum = (sum >> 32) + (sum & 0xffffffff);
+        sum = (sum >> 16) + (sum & 0xffff);
+        sum = (sum >> 16) + (sum & 0xffff);
+        return (~(int)sum & 0xffff);
 }
@@ -17,7 +17,12 @@
 
 #include <slirp.h>
 
-#define MBUF_THRESH 30
+/*
+ * Enough mbufs stay on the free list for a full 64KB TCP window of
+ * segments in each direction, so bulk transfers through NAT reuse
+ * them instead of calling malloc() and free() per segment
+ */
+#define MBUF_THRESH 256
 
 /*
  * Find a nice value for msize
@@ -96,9 +96,14 @@ sbappend(struct socket *so, struct mbuf *m)
 
         /*
          * We only write if there's nothing in the buffer,
-         * ottherwise it'll arrive out of order, and hence corrupt
+         * ottherwise it'll arrive out of order, and hence corrupt.
+         * A full sized segment is part of a bulk transfer, so it is
+         * left in the buffer, and sowrite passes the whole run of
+         * segments to the host in one larger send once the pending
+         * input has been processed.
          */
-        if (!so->so_rcv.sb_cc)
+        if (!so->so_rcv.sb_cc &&
+            !(so->so_tcpcb && (m->m_len >= so->so_tcpcb->t_maxseg)))
            ret = slirp_send(so, m->m_data, m->m_len, 0);
 
         if (ret <= 0) {
@@ -38,8 +38,10 @@ typedef uint32_t tcp_seq;
 #define      PR_SLOWHZ       2               /* 2 slow timeouts per second (approx) */
 #define      PR_FASTHZ       5               /* 5 fast timeouts per second (not important) */
 
-#define TCP_SNDSPACE 8192
-#define TCP_RCVSPACE 8192
+/* Socket buffers sized to the largest unscaled window so bulk transfers
+   are not held to one 8KB window per round trip */
+#define TCP_SNDSPACE 65536
+#define TCP_RCVSPACE 65536
 
 /*
  * TCP header.
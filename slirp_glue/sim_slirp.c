@@ -41,6 +41,9 @@
 #include "sim_slirp.h"
 #include "sim_sock.h"
 #include "libslirp.h"
+#if !defined(_WIN32)
+#include <poll.h>
+#endif
 
 #if !defined (USE_READER_THREAD)
 #define pthread_mutex_init(mtx, val)
@@ -155,6 +158,7 @@ struct sim_slirp {
     GArray *gpollfds;
     SOCKET db_chime;            /* write packet doorbell */
     struct slirp_write_request *write_requests;
+    struct slirp_write_request *write_requests_tail;
     struct slirp_write_request *write_buffers;
     pthread_mutex_t write_buffer_lock;
     void *opaque;               /* opaque value passed during packet delivery */
@@ -476,18 +480,13 @@ memcpy(request->msg, msg, len);
 /* packets make it to the wire in the order they were presented here) */
 pthread_mutex_lock (&slirp->write_buffer_lock);
 request->next = NULL;
-if (slirp->write_requests) {
-    struct slirp_write_request *last_request = slirp->write_requests;
-
-    while (last_request->next) {
-        last_request = last_request->next;
-        }
-    last_request->next = request;
-    }
+if (slirp->write_requests)
+    slirp->write_requests_tail->next = request;
 else {
     slirp->write_requests = request;
     wake_needed = 1;
     }
+slirp->write_requests_tail = request;
 pthread_mutex_unlock (&slirp->write_buffer_lock);
 
 if (wake_needed)
@@ -537,6 +536,7 @@ while (rtmp) {
 slirp_connection_info (slirp->slirp, (Monitor *)st);
 }
 
+#if defined(_WIN32)                 /* select() based wait */
 #if !defined(MAX)
 #define MAX(a,b) (((a)>(b)) ? (a) : (b))
 #endif
@@ -589,21 +589,56 @@ for (i = 0; i < pollfds->len; i++) {
     pfd->revents = revents & pfd->events;
     }
 }
+#endif /* defined(_WIN32) */
+
+/* Wait for activity on the NAT sockets
+
+   Where the host has poll(), a GPollFD has the layout of a struct pollfd
+   and the G_IO_* values are the POLL* values, so the array slirp fills in
+   is handed to poll() as it stands.  Unlike select() this has no
+   FD_SETSIZE limit on descriptor numbers and costs time in proportion to
+   the sockets in use rather than to the highest descriptor, which matters
+   once a guest has many connections open through NAT.
+*/
 
 int sim_slirp_select (SLIRP *slirp, int ms_timeout)
 {
 int select_ret = 0;
 uint32 slirp_timeout = ms_timeout;
+#if defined(_WIN32)
 struct timeval timeout;
 fd_set rfds, wfds, xfds;
 fd_set save_rfds, save_wfds, save_xfds;
 int nfds;
+#endif
 
 if (!slirp)                         /* Not active? */
     return -1;                      /* That's an error */
 /* Populate the GPollFDs from slirp */
 g_array_set_size (slirp->gpollfds, 1);  /* Leave the doorbell chime alone */
 slirp_pollfds_fill(slirp->gpollfds, &slirp_timeout);
+#if !defined(_WIN32)
+select_ret = poll ((struct pollfd *)slirp->gpollfds->data, (nfds_t)slirp->gpollfds->len, (int)slirp_timeout);
+if (select_ret > 0) {
+    guint i;
+
+    if (g_array_index(slirp->gpollfds, GPollFD, 0).revents & G_IO_IN) {
+        char buf[32];
+        /* consume the doorbell wakeup ring */
+        (void)recv (slirp->db_chime, buf, sizeof (buf), 0);
+        }
+    sim_debug (slirp->dbit, slirp->dptr, "Poll returned %d\r\n", select_ret);
+    for (i = 0; i < slirp->gpollfds->len; i++) {
+        GPollFD *pfd = &g_array_index(slirp->gpollfds, GPollFD, i);
+
+        if (pfd->revents)
+            sim_debug (slirp->dbit, slirp->dptr, "%d: events=0x%X, revents=0x%X\r\n", pfd->fd, pfd->events, pfd->revents);
+        }
+    }
+else
+    if (select_ret < 0)
+        select_ret = 0;             /* interrupted, just dispatch */
+#else
 timeout.tv_sec  = slirp_timeout / 1000;
 timeout.tv_usec = (slirp_timeout % 1000) * 1000;
 
@@ -635,29 +670,35 @@ if (select_ret) {
             sim_debug (slirp->dbit, slirp->dptr, "%d: save_xfd=%d, xfd=%d\r\n", i, FD_ISSET(i, &save_xfds), FD_ISSET(i, &xfds));
             }
     }
+#endif
 return select_ret + 1;  /* Force dispatch even on timeout */
 }
 
 void sim_slirp_dispatch (SLIRP *slirp)
 {
-struct slirp_write_request *request;
+struct slirp_write_request *requests, *request;
 
 /* first deliver any transmit packets which are pending */
 
+/* Take the whole pending list in one step so a burst of packets */
+/* costs two lock round trips rather than two per packet */
 pthread_mutex_lock (&slirp->write_buffer_lock);
-while (NULL != (request = slirp->write_requests)) {
-    /* Pull buffer off request list */
-    slirp->write_requests = request->next;
-    pthread_mutex_unlock (&slirp->write_buffer_lock);
-
-    slirp_input (slirp->slirp, (const uint8_t *)request->msg, (int)request->len);
+requests = slirp->write_requests;
+slirp->write_requests = slirp->write_requests_tail = NULL;
+pthread_mutex_unlock (&slirp->write_buffer_lock);
 
+if (requests) {
+    for (request = requests; ; request = request->next) {
+        slirp_input (slirp->slirp, (const uint8_t *)request->msg, (int)request->len);
+        if (request->next == NULL)
+            break;
+        }
+    /* Put the buffers on the free buffer list */
     pthread_mutex_lock (&slirp->write_buffer_lock);
-    /* Put buffer on free buffer list */
     request->next = slirp->write_buffers;
-    slirp->write_buffers = request;
+    slirp->write_buffers = requests;
+    pthread_mutex_unlock (&slirp->write_buffer_lock);
     }
-pthread_mutex_unlock (&slirp->write_buffer_lock);
 
 slirp_pollfds_poll(slirp->gpollfds, 0);
 